@@ -727,3 +727,112 @@ void TF_ImportGraphDefOptionsSetValidateColocationConstraints(
     TF_ImportGraphDefOptions* opts, unsigned char enable) {
   opts->opts.validate_colocation_constraints = enable;
 }
+
+struct TF_SessionCallable {
+  tensorflow::Session::CallableHandle handle;
+  int ninputs;
+  int noutputs;
+};
+
+TF_SessionCallable* TF_SessionMakeCallable(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    int ninputs, const TF_Output* outputs, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets, TF_Status* status) {
+  if (session->extend_before_run &&
+      !tensorflow::ExtendSessionGraphHelper(session, status)) {
+    return nullptr;
+  }
+
+  tensorflow::CallableOptions callable_options;
+  if (run_options != nullptr &&
+      !callable_options.mutable_run_options()->ParseFromArray(
+          run_options->data, run_options->length)) {
+    status->status = InvalidArgument("Unparseable RunOptions proto");
+    return nullptr;
+  }
+  for (int i = 0; i < ninputs; ++i) {
+    callable_options.add_feed(
+        tensorflow::strings::StrCat(inputs[i].oper->node.name(), ":",
+                                    inputs[i].index));
+  }
+  for (int i = 0; i < noutputs; ++i) {
+    callable_options.add_fetch(
+        tensorflow::strings::StrCat(outputs[i].oper->node.name(), ":",
+                                    outputs[i].index));
+  }
+  for (int i = 0; i < ntargets; ++i) {
+    callable_options.add_target(target_opers[i]->node.name());
+  }
+
+  tensorflow::Session::CallableHandle handle;
+  status->status = session->session->MakeCallable(callable_options, &handle);
+  if (!status->status.ok()) return nullptr;
+  return new TF_SessionCallable{handle, ninputs, noutputs};
+}
+
+void TF_SessionRunCallable(TF_Session* session, TF_SessionCallable* callable,
+                           TF_Tensor* const* input_values,
+                           TF_Tensor** output_values, TF_Buffer* run_metadata,
+                           TF_Status* status) {
+  using tensorflow::Tensor;
+
+  if (run_metadata != nullptr && run_metadata->data != nullptr) {
+    status->status =
+        InvalidArgument("Passing non-empty run_metadata is invalid.");
+    return;
+  }
+  std::vector<Tensor> feed_tensors(callable->ninputs);
+  for (int i = 0; i < callable->ninputs; ++i) {
+    status->status =
+        tensorflow::TF_TensorToTensor(input_values[i], &feed_tensors[i]);
+    if (!status->status.ok()) return;
+  }
+
+  std::vector<Tensor> fetch_tensors;
+  tensorflow::RunMetadata run_metadata_proto;
+  status->status = session->session->RunCallable(
+      callable->handle, feed_tensors, &fetch_tensors,
+      run_metadata != nullptr ? &run_metadata_proto : nullptr);
+  if (!status->status.ok()) return;
+  if (run_metadata != nullptr) {
+    status->status =
+        tensorflow::MessageToBuffer(run_metadata_proto, run_metadata);
+    if (!status->status.ok()) return;
+  }
+
+  for (int i = 0; i < callable->noutputs; ++i) {
+    const Tensor& src = fetch_tensors[i];
+    TF_Tensor* dst = output_values[i];
+    // Outputs of types that can't be copied bytewise, like strings, always get
+    // a new tensor.
+    if (dst != nullptr && src.IsInitialized() &&
+        tensorflow::DataTypeCanUseMemcpy(src.dtype()) &&
+        static_cast<tensorflow::DataType>(TF_TensorType(dst)) == src.dtype() &&
+        TF_NumDims(dst) == src.dims() &&
+        TF_TensorByteSize(dst) == src.TotalBytes()) {
+      bool same_shape = true;
+      for (int d = 0; d < src.dims(); ++d) {
+        same_shape &= TF_Dim(dst, d) == src.dim_size(d);
+      }
+      if (same_shape) {
+        tensorflow::StringPiece data = src.tensor_data();
+        if (!data.empty() && data.data() != TF_TensorData(dst)) {
+          memcpy(TF_TensorData(dst), data.data(), data.size());
+        }
+        continue;
+      }
+    }
+    if (dst != nullptr) {
+      TF_DeleteTensor(dst);
+    }
+    output_values[i] = tensorflow::TF_TensorFromTensor(src, &status->status);
+    if (!status->status.ok()) return;
+  }
+}
+
+void TF_SessionReleaseCallable(TF_Session* session,
+                               TF_SessionCallable* callable,
+                               TF_Status* status) {
+  status->status = session->session->ReleaseCallable(callable->handle);
+  delete callable;
+}
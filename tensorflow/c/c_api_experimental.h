@@ -297,6 +297,45 @@ TF_CAPI_EXPORT extern void
 TF_ImportGraphDefOptionsSetValidateColocationConstraints(
     TF_ImportGraphDefOptions* opts, unsigned char enable);
 
+// A prepared call of a session, which runs the graph for a fixed set of
+// inputs, outputs and target operations. Unlike TF_SessionRun, running it
+// doesn't look up the inputs and outputs by name or prune the graph again, so
+// it suits serving the same signature many times.
+typedef struct TF_SessionCallable TF_SessionCallable;
+
+// Prepares a call of `session` that feeds `inputs`, fetches `outputs` and runs
+// `target_opers`. `run_options` may be NULL, or point to a serialized
+// RunOptions protocol buffer that applies to every run of the callable.
+//
+// On success, returns a callable that must be released with
+// TF_SessionReleaseCallable. On failure, returns NULL.
+TF_CAPI_EXPORT extern TF_SessionCallable* TF_SessionMakeCallable(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    int ninputs, const TF_Output* outputs, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets, TF_Status* status);
+
+// Runs `callable` with `input_values`, one for each input it was made with.
+// Tensors created with TF_NewTensor from caller memory are fed without a copy,
+// so the caller can keep reusing that memory for every run.
+//
+// `output_values` holds one tensor for each output of the callable. An entry
+// that is NULL on entry receives a new tensor. An entry that holds a tensor of
+// the output's type and shape on entry receives the output in place, so the
+// caller can keep reusing its output buffers as well. Other entries are
+// deleted and replaced by a new tensor. In all cases, the caller owns the
+// tensors in `output_values`.
+//
+// `run_metadata` may be NULL, or point to an empty, freshly allocated
+// TF_Buffer that is filled with a serialized RunMetadata protocol buffer.
+TF_CAPI_EXPORT extern void TF_SessionRunCallable(
+    TF_Session* session, TF_SessionCallable* callable,
+    TF_Tensor* const* input_values, TF_Tensor** output_values,
+    TF_Buffer* run_metadata, TF_Status* status);
+
+// Releases the resources of `callable`, which must not be used afterwards.
+TF_CAPI_EXPORT extern void TF_SessionReleaseCallable(
+    TF_Session* session, TF_SessionCallable* callable, TF_Status* status);
+
 #ifdef __cplusplus
 } /* end extern "C" */
 #endif
@@ -84,6 +84,55 @@ TEST(CAPI_EXPERIMENTAL, IsStateful) {
   EXPECT_EQ(id, 0);
 }
 
+TEST(CAPI_EXPERIMENTAL, SessionRunCallable) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+  TF_Operation* feed = Placeholder(graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add = Add(feed, two, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  CSession csession(graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Session* session = csession.mutable_session();
+  TF_Output input{feed, 0};
+  TF_Output output{add, 0};
+  TF_SessionCallable* callable = TF_SessionMakeCallable(
+      session, /*run_options=*/nullptr, &input, 1, &output, 1,
+      /*target_opers=*/nullptr, 0, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  // The first run creates the output tensor, and the next ones reuse it.
+  TF_Tensor* input_value = Int32Tensor(3);
+  TF_Tensor* output_value = nullptr;
+  TF_SessionRunCallable(session, callable, &input_value, &output_value,
+                        /*run_metadata=*/nullptr, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  ASSERT_NE(output_value, nullptr);
+  EXPECT_EQ(5, *static_cast<int32_t*>(TF_TensorData(output_value)));
+  void* output_data = TF_TensorData(output_value);
+
+  *static_cast<int32_t*>(TF_TensorData(input_value)) = 40;
+  TF_Tensor* reused_output_value = output_value;
+  TF_SessionRunCallable(session, callable, &input_value, &output_value,
+                        /*run_metadata=*/nullptr, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  EXPECT_EQ(reused_output_value, output_value);
+  EXPECT_EQ(output_data, TF_TensorData(output_value));
+  EXPECT_EQ(42, *static_cast<int32_t*>(TF_TensorData(output_value)));
+
+  TF_SessionReleaseCallable(session, callable, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteTensor(input_value);
+  TF_DeleteTensor(output_value);
+  csession.CloseAndDelete(s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 class ShapeInferenceTest : public ::testing::Test {
  protected:
   ShapeInferenceTest()
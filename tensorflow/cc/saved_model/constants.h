@@ -24,6 +24,9 @@ constexpr char kSavedModelAssetsDirectory[] = "assets";
 /// SavedModel assets.extra directory.
 constexpr char kSavedModelAssetsExtraDirectory[] = "assets.extra";
 
+/// SavedModel assets.extra file of requests to replay to warm up the model.
+constexpr char kSavedModelWarmupRequestsFilename[] = "tf_warmup_requests";
+
 /// SavedModel assets key for graph collection-def.
 constexpr char kSavedModelAssetsKey[] = "saved_model_assets";
 
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 
 namespace tensorflow {
@@ -95,6 +96,26 @@ static Status ValidateSavedTensors(const GraphDef& graph_def) {
   return Status::OK();
 }
 
+// Makes the RestoreV2 ops in 'graph_def' read the checkpoint from
+// 'num_threads' threads each, rather than from the op thread.
+void SetRestoreThreads(int64 num_threads, GraphDef* graph_def) {
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    if (node.op() == "RestoreV2") {
+      (*node.mutable_attr())["num_threads"].set_i(num_threads);
+    }
+  }
+}
+
+// Makes the RestoreV2 ops in 'graph_def' restore read-only views of the
+// memory-mapped checkpoint where possible, rather than copies.
+void SetRestoreMemoryMap(GraphDef* graph_def) {
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    if (node.op() == "RestoreV2") {
+      (*node.mutable_attr())["memory_map"].set_b(true);
+    }
+  }
+}
+
 Status LoadMetaGraphIntoSession(const MetaGraphDef& meta_graph_def,
                                 const SessionOptions& session_options,
                                 std::unique_ptr<Session>* session) {
@@ -256,9 +277,31 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
+  const uint64 read_meta_graph_walltime =
+      GetLatencyMicroseconds(read_start_microseconds);
+
+  int64 restore_threads;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_SAVED_MODEL_RESTORE_THREADS",
+                                         /*default_val=*/0, &restore_threads));
+  if (restore_threads > 0) {
+    SetRestoreThreads(restore_threads,
+                      bundle->meta_graph_def.mutable_graph_def());
+  }
+  bool memory_map_variables;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_SAVED_MODEL_MEMORY_MAP_VARIABLES",
+                                        /*default_val=*/false,
+                                        &memory_map_variables));
+  if (memory_map_variables) {
+    SetRestoreMemoryMap(bundle->meta_graph_def.mutable_graph_def());
+  }
+
+  const uint64 create_session_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(LoadMetaGraphIntoSession(
       bundle->meta_graph_def, session_options, &bundle->session));
+  const uint64 create_session_walltime =
+      GetLatencyMicroseconds(create_session_start_microseconds);
 
+  const uint64 restore_start_microseconds = Env::Default()->NowMicros();
   std::vector<AssetFileDef> asset_file_defs;
   TF_RETURN_IF_ERROR(
       internal::GetAssetFileDefs(bundle->meta_graph_def, &asset_file_defs));
@@ -269,6 +312,8 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                  asset_file_defs, bundle->session.get()));
   // Record walltime spent in restoring graph from disk, but postpone metric
   // increments until graph init finishes.
+  const uint64 restore_variables_walltime =
+      GetLatencyMicroseconds(restore_start_microseconds);
   const uint64 restore_graph_walltime =
       GetLatencyMicroseconds(read_start_microseconds);
 
@@ -279,11 +324,26 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
   TF_RETURN_IF_ERROR(RunInitOp(run_options, export_dir, bundle->meta_graph_def,
                                asset_file_defs, bundle->session.get(),
                                init_op_name));
+  const uint64 init_graph_walltime =
+      GetLatencyMicroseconds(graph_init_start_microseconds);
   load_latency_by_stage->GetCell(export_dir, "restore_graph")
       ->Add(restore_graph_walltime);
+  // The stages that make up "restore_graph".
+  load_latency_by_stage->GetCell(export_dir, "read_meta_graph")
+      ->Add(read_meta_graph_walltime);
+  load_latency_by_stage->GetCell(export_dir, "create_session")
+      ->Add(create_session_walltime);
+  load_latency_by_stage->GetCell(export_dir, "restore_variables")
+      ->Add(restore_variables_walltime);
   // Record wall time spent in init op.
   load_latency_by_stage->GetCell(export_dir, "init_graph")
-      ->Add(GetLatencyMicroseconds(graph_init_start_microseconds));
+      ->Add(init_graph_walltime);
+  LOG(INFO) << "SavedModel load stages (microseconds): read_meta_graph: "
+            << read_meta_graph_walltime
+            << ", create_session: " << create_session_walltime
+            << ", restore_variables: " << restore_variables_walltime
+            << " (" << restore_threads << " reader threads per op)"
+            << ", init_graph: " << init_graph_walltime;
   return Status::OK();
 }
 
@@ -101,6 +101,18 @@ class SavedModelBundleLite : public SavedModelBundleInterface {
 /// the set of tags used at SavedModel build time. Stores a SavedModel bundle in
 /// *bundle with a session and the requested MetaGraphDef, if found.
 ///
+/// Setting the TF_SAVED_MODEL_RESTORE_THREADS environment variable to a
+/// positive number makes each RestoreV2 op read the variables from that many
+/// threads, which speeds up restoring large models. The wall time of each load
+/// stage is logged and exported in
+/// /tensorflow/cc/saved_model/load_latency_by_stage.
+///
+/// Setting TF_SAVED_MODEL_MEMORY_MAP_VARIABLES to true makes the variables
+/// read-only views of the memory-mapped checkpoint, so that processes serving
+/// the same model share one copy of it in host memory. Only the variables
+/// saved with a data_alignment of 64 (see SaveV2) are mapped, and they must
+/// never be assigned to after loading.
+///
 /// NOTE: Prefer the overload that takes a SavedModelBundleLite* in new code.
 Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
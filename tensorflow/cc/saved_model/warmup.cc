@@ -0,0 +1,177 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/warmup.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/protobuf/master.pb.h"
+
+namespace tensorflow {
+namespace {
+
+// A request ready to be passed to Session::Run.
+struct WarmupRequest {
+  RunOptions run_options;
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_tensor_names;
+  std::vector<string> target_node_names;
+};
+
+Status ReadWarmupRequests(const string& requests_file, int max_num_requests,
+                          std::vector<WarmupRequest>* requests) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(requests_file, &file));
+  io::SequentialRecordReader reader(file.get());
+  tstring record;
+  while (requests->size() < max_num_requests) {
+    Status status = reader.ReadRecord(&record);
+    if (errors::IsOutOfRange(status)) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(status);
+    RunStepRequest proto;
+    if (!proto.ParseFromString(string(record))) {
+      return errors::InvalidArgument("Invalid RunStepRequest in ",
+                                     requests_file);
+    }
+    WarmupRequest request;
+    request.run_options = proto.options();
+    for (const NamedTensorProto& feed : proto.feed()) {
+      Tensor tensor;
+      if (!tensor.FromProto(feed.tensor())) {
+        return errors::InvalidArgument("Invalid tensor for ", feed.name(),
+                                       " in ", requests_file);
+      }
+      request.inputs.emplace_back(feed.name(), std::move(tensor));
+    }
+    request.output_tensor_names.assign(proto.fetch().begin(),
+                                       proto.fetch().end());
+    request.target_node_names.assign(proto.target().begin(),
+                                     proto.target().end());
+    requests->push_back(std::move(request));
+  }
+  return Status::OK();
+}
+
+// Runs all `requests` once on `thread_pool`, and returns the 99th percentile
+// of their latencies.
+Status RunWarmupRound(Session* session,
+                      const std::vector<WarmupRequest>& requests,
+                      thread::ThreadPool* thread_pool,
+                      int64* p99_latency_micros) {
+  mutex mu;
+  Status status;
+  std::vector<int64> latencies_micros(requests.size());
+  BlockingCounter counter(requests.size());
+  for (int i = 0; i < requests.size(); ++i) {
+    thread_pool->Schedule([&, i]() {
+      const WarmupRequest& request = requests[i];
+      const uint64 start_micros = Env::Default()->NowMicros();
+      std::vector<Tensor> outputs;
+      RunMetadata run_metadata;
+      Status s = session->Run(request.run_options, request.inputs,
+                              request.output_tensor_names,
+                              request.target_node_names, &outputs,
+                              &run_metadata);
+      latencies_micros[i] = Env::Default()->NowMicros() - start_micros;
+      if (!s.ok()) {
+        mutex_lock l(mu);
+        status.Update(s);
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  TF_RETURN_IF_ERROR(status);
+
+  const int p99_index = (latencies_micros.size() - 1) * 99 / 100;
+  std::nth_element(latencies_micros.begin(),
+                   latencies_micros.begin() + p99_index,
+                   latencies_micros.end());
+  *p99_latency_micros = latencies_micros[p99_index];
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ReplayWarmupRequests(Session* session, const string& requests_file,
+                            const WarmupOptions& options, WarmupStats* stats) {
+  if (options.num_threads < 1 || options.max_num_rounds < 1) {
+    return errors::InvalidArgument(
+        "Warmup needs at least one thread and one round");
+  }
+  *stats = WarmupStats();
+  std::vector<WarmupRequest> requests;
+  TF_RETURN_IF_ERROR(
+      ReadWarmupRequests(requests_file, options.max_num_requests, &requests));
+  stats->num_requests = requests.size();
+  if (requests.empty()) {
+    return Status::OK();
+  }
+
+  thread::ThreadPool thread_pool(Env::Default(), "saved_model_warmup",
+                                 options.num_threads);
+  int64 previous_p99_latency_micros = -1;
+  while (stats->num_rounds < options.max_num_rounds) {
+    TF_RETURN_IF_ERROR(RunWarmupRound(session, requests, &thread_pool,
+                                      &stats->p99_latency_micros));
+    ++stats->num_rounds;
+    if (previous_p99_latency_micros >= 0 &&
+        std::abs(stats->p99_latency_micros - previous_p99_latency_micros) <=
+            options.p99_latency_tolerance * previous_p99_latency_micros) {
+      stats->stabilized = true;
+      break;
+    }
+    previous_p99_latency_micros = stats->p99_latency_micros;
+  }
+  LOG(INFO) << "Replayed " << stats->num_requests << " warmup requests from "
+            << requests_file << " in " << stats->num_rounds
+            << " rounds. The p99 latency of the last round was "
+            << stats->p99_latency_micros << " us"
+            << (stats->stabilized ? "." : ", and it didn't stabilize.");
+  return Status::OK();
+}
+
+Status WarmUpSavedModel(const string& export_dir,
+                        const SavedModelBundleInterface& bundle,
+                        const WarmupOptions& options, WarmupStats* stats) {
+  *stats = WarmupStats();
+  const string requests_file =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                   kSavedModelWarmupRequestsFilename);
+  if (!Env::Default()->FileExists(requests_file).ok()) {
+    VLOG(1) << "No warmup requests found at " << requests_file;
+    return Status::OK();
+  }
+  return ReplayWarmupRequests(bundle.GetSession(), requests_file, options,
+                              stats);
+}
+
+}  // namespace tensorflow
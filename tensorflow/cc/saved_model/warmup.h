@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/// Warms up a loaded SavedModel by replaying recorded requests, so that the
+/// first real requests don't pay for lazy initialization such as allocator
+/// growth, kernel instantiation, autotuning and compilation.
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_WARMUP_H_
+#define TENSORFLOW_CC_SAVED_MODEL_WARMUP_H_
+
+#include <string>
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+
+/// Options for replaying warmup requests.
+struct WarmupOptions {
+  /// Number of threads that replay the requests concurrently.
+  int num_threads = 4;
+
+  /// Largest number of requests read from the warmup file.
+  int max_num_requests = 1000;
+
+  /// Largest number of times all requests are replayed.
+  int max_num_rounds = 10;
+
+  /// Warmup ends once the 99th percentile latency of a round is within this
+  /// fraction of that of the previous round.
+  float p99_latency_tolerance = 0.1f;
+};
+
+/// What replaying the warmup requests did.
+struct WarmupStats {
+  int num_requests = 0;
+  int num_rounds = 0;
+  /// The 99th percentile latency of the last round.
+  int64 p99_latency_micros = 0;
+  /// Whether the 99th percentile latency stabilized before max_num_rounds.
+  bool stabilized = false;
+};
+
+/// Replays the requests in `requests_file` on `session`, in rounds, until
+/// the 99th percentile latency of a round stabilizes. The file is a TFRecord
+/// file of serialized RunStepRequest protos. Each one names the tensors it
+/// feeds and fetches and the ops it targets like Session::Run does, and may
+/// set RunOptions. Record requests for every signature and batch size that
+/// will be served, so that all of them are warm.
+///
+/// Returns an error if the file can't be read or a request fails.
+Status ReplayWarmupRequests(Session* session, const string& requests_file,
+                            const WarmupOptions& options, WarmupStats* stats);
+
+/// Warms up `bundle`, loaded from `export_dir`, with the requests in the
+/// assets.extra/tf_warmup_requests file of the SavedModel, if there is one.
+/// Call it before marking the model as ready to serve.
+Status WarmUpSavedModel(const string& export_dir,
+                        const SavedModelBundleInterface& bundle,
+                        const WarmupOptions& options, WarmupStats* stats);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_WARMUP_H_
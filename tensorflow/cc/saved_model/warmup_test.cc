@@ -0,0 +1,111 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/warmup.h"
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/master.pb.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kTestDataSharded[] =
+    "cc/saved_model/testdata/half_plus_two/00000123";
+
+class WarmupTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    export_dir_ = io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+    TF_ASSERT_OK(LoadSavedModel(SessionOptions(), RunOptions(), export_dir_,
+                                {kSavedModelTagServe}, &bundle_));
+  }
+
+  // Writes a request feeding x with `batch_size` values, and fetching
+  // `fetch`, for each batch size.
+  string WriteRequests(const std::vector<int>& batch_sizes,
+                       const string& fetch) {
+    const string requests_file =
+        io::JoinPath(testing::TmpDir(), "warmup_requests");
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(Env::Default()->NewWritableFile(requests_file, &file));
+    io::RecordWriter writer(file.get());
+    for (int batch_size : batch_sizes) {
+      RunStepRequest request;
+      NamedTensorProto* feed = request.add_feed();
+      feed->set_name("x:0");
+      Tensor x(DT_FLOAT, TensorShape({batch_size, 1}));
+      test::FillIota<float>(&x, 0.0f);
+      x.AsProtoTensorContent(feed->mutable_tensor());
+      request.add_fetch(fetch);
+      TF_CHECK_OK(writer.WriteRecord(request.SerializeAsString()));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+    return requests_file;
+  }
+
+  string export_dir_;
+  SavedModelBundle bundle_;
+};
+
+TEST_F(WarmupTest, ReplaysRequests) {
+  const string requests_file = WriteRequests({1, 4, 16}, "y:0");
+  WarmupOptions options;
+  options.max_num_rounds = 3;
+  WarmupStats stats;
+  TF_ASSERT_OK(ReplayWarmupRequests(bundle_.session.get(), requests_file,
+                                    options, &stats));
+  EXPECT_EQ(3, stats.num_requests);
+  EXPECT_GE(stats.num_rounds, 1);
+  EXPECT_LE(stats.num_rounds, 3);
+}
+
+TEST_F(WarmupTest, LimitsNumRequests) {
+  const string requests_file = WriteRequests({1, 2, 3, 4}, "y:0");
+  WarmupOptions options;
+  options.max_num_requests = 2;
+  options.max_num_rounds = 1;
+  WarmupStats stats;
+  TF_ASSERT_OK(ReplayWarmupRequests(bundle_.session.get(), requests_file,
+                                    options, &stats));
+  EXPECT_EQ(2, stats.num_requests);
+  EXPECT_EQ(1, stats.num_rounds);
+  EXPECT_FALSE(stats.stabilized);
+}
+
+TEST_F(WarmupTest, FailsOnInvalidRequest) {
+  const string requests_file = WriteRequests({1}, "does_not_exist:0");
+  WarmupStats stats;
+  EXPECT_FALSE(ReplayWarmupRequests(bundle_.session.get(), requests_file,
+                                    WarmupOptions(), &stats)
+                   .ok());
+}
+
+TEST_F(WarmupTest, SkipsModelsWithoutWarmupRequests) {
+  WarmupStats stats;
+  TF_ASSERT_OK(WarmUpSavedModel(export_dir_, bundle_, WarmupOptions(), &stats));
+  EXPECT_EQ(0, stats.num_requests);
+  EXPECT_EQ(0, stats.num_rounds);
+}
+
+}  // namespace
+}  // namespace tensorflow
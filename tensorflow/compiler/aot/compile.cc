@@ -147,6 +147,7 @@ Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
       flags.target_triple, flags.target_cpu, flags.target_features,
       flags.entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
+  aot_opts.set_max_parallelism(flags.max_parallelism);
 
   return CompileXla(client, computation, aot_opts, compile_result);
 }
@@ -215,6 +216,18 @@ Status Main(const MainFlags& flags) {
     return errors::InvalidArgument("Must specify --config");
   }
   TF_RETURN_IF_ERROR(ReadProtoFile(flags.config, &config));
+  if (flags.batch_size > 0 && config.feed_size() > 0 &&
+      config.feed(0).shape().dim_size() > 0) {
+    // The leading dimension of the first feed is taken to be the batch
+    // dimension, and is replaced in all the feeds that share it.
+    const int64 batch_size = config.feed(0).shape().dim(0).size();
+    for (tf2xla::Feed& feed : *config.mutable_feed()) {
+      if (feed.shape().dim_size() > 0 &&
+          feed.shape().dim(0).size() == batch_size) {
+        feed.mutable_shape()->mutable_dim(0)->set_size(flags.batch_size);
+      }
+    }
+  }
   TF_RETURN_IF_ERROR(ValidateConfig(config));
   if (flags.dump_fetch_nodes) {
     std::set<string> nodes;
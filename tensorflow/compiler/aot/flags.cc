@@ -55,6 +55,11 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "http://clang.llvm.org/docs/CrossCompilation.html#cpu-fpu-abi"},
       {"target_features", &flags->target_features,
        "Target features, e.g. +avx2, +neon, etc."},
+      {"max_parallelism", &flags->max_parallelism,
+       "If greater than 1, large ops are split into up to this many "
+       "partitions, which run in parallel on the thread pool passed to "
+       "set_thread_pool() of the generated class, or one after the other if "
+       "there is none."},
       {"entry_point", &flags->entry_point,
        "Name of the generated function.  If multiple generated object files "
        "will be linked into the same binary, each will need a unique entry "
@@ -77,6 +82,11 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "Output session module proto."},
       {"mlir_components", &flags->mlir_components,
        "The MLIR components to enable. Currently only Bridge is supported."},
+      {"batch_size", &flags->batch_size,
+       "If positive, the leading dimension of the first feed in the config is "
+       "taken to be the batch dimension, and is replaced with this in every "
+       "feed that has the same leading dimension, so that the same config can "
+       "be compiled for several batch sizes."},
       {"experimental_quantize", &flags->experimental_quantize,
        "If set, quantization passes will run and dump the result before HLO "
        "code generation."},
@@ -43,6 +43,8 @@ struct MainFlags {
   string out_session_module;
   string mlir_components;
   bool experimental_quantize = false;
+  int32 max_parallelism = 1;
+  int32 batch_size = 0;
 
   // C++ codegen options
   bool gen_name_to_index = false;
@@ -35,6 +35,8 @@ limitations under the License.
 #include "tensorflow/compiler/aot/tests/test_graph_tffunction_mlir_bridge.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfgather_mlir_bridge.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmul_mlir_bridge.h"
+#include "tensorflow/compiler/aot/tests/test_graph_tfmatmul_parallel_mlir_bridge.h"
+#include "tensorflow/compiler/aot/tests/test_graph_tfmatmul_parallel_mlir_bridge_batch4.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd_mlir_bridge.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd_with_profiling_mlir_bridge.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfsplits_mlir_bridge.h"
@@ -51,6 +53,8 @@ limitations under the License.
 #include "tensorflow/compiler/aot/tests/test_graph_tffunction.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfgather.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmul.h"
+#include "tensorflow/compiler/aot/tests/test_graph_tfmatmul_parallel.h"
+#include "tensorflow/compiler/aot/tests/test_graph_tfmatmul_parallel_batch4.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd_with_profiling.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfsplits.h"
@@ -339,6 +343,51 @@ TEST(TFCompileTest, MatMul2_SetArg) {
   EXPECT_EQ(matmul.result0_data(), matmul.results()[0]);
 }
 
+TEST(TFCompileTest, ParallelMatMul) {
+  const float arg0[2][3] = {{1, 2, 3}, {4, 5, 6}};
+  const float arg1[3][2] = {{7, 8}, {9, 10}, {11, 12}};
+  const float results[4] = {58, 64, 139, 154};
+
+  // Without a thread pool, the partitions run one after the other.
+  foo::bar::ParallelMatMulComp matmul;
+  std::copy(&arg0[0][0], &arg0[0][0] + 6, matmul.arg0_data());
+  std::copy(&arg1[0][0], &arg1[0][0] + 6, matmul.arg1_data());
+  EXPECT_TRUE(matmul.Run());
+  EXPECT_EQ(matmul.error_msg(), "");
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(matmul.result0(i / 2, i % 2), results[i]);
+  }
+
+  Eigen::ThreadPool tp(4);
+  Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
+  matmul.set_thread_pool(&device);
+  EXPECT_TRUE(matmul.Run());
+  EXPECT_EQ(matmul.error_msg(), "");
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(matmul.result0(i / 2, i % 2), results[i]);
+  }
+}
+
+TEST(TFCompileTest, MatMulBatchVariant) {
+  Eigen::ThreadPool tp(4);
+  Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
+
+  // The leading dimension of the first feed is the batch dimension; the
+  // second feed's leading dimension differs, so it keeps its shape.
+  foo::bar::ParallelMatMulCompBatch4 matmul;
+  matmul.set_thread_pool(&device);
+  const float arg0[4][3] = {{1, 2, 3}, {4, 5, 6}, {1, 0, 0}, {0, 0, 1}};
+  const float arg1[3][2] = {{7, 8}, {9, 10}, {11, 12}};
+  std::copy(&arg0[0][0], &arg0[0][0] + 12, matmul.arg0_data());
+  std::copy(&arg1[0][0], &arg1[0][0] + 6, matmul.arg1_data());
+  EXPECT_TRUE(matmul.Run());
+  EXPECT_EQ(matmul.error_msg(), "");
+  const float results[8] = {58, 64, 139, 154, 7, 8, 11, 12};
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(matmul.result0(i / 2, i % 2), results[i]);
+  }
+}
+
 TEST(TFCompileTest, MatMulAndAdd1) {
   Eigen::ThreadPool tp(1);
   Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
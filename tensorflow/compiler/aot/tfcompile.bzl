@@ -40,6 +40,8 @@ def tf_library(
         enable_xla_hlo_profiling = False,
         enable_tracemes = False,
         mlir_components = "None",
+        max_parallelism = 1,
+        batch_sizes = None,
         deps = None,
         tags = []):
     """Runs tfcompile to compile a TensorFlow graph into executable code with fast
@@ -96,6 +98,14 @@ def tf_library(
         Xprof to construct profiler timelines.
       mlir_components: When the value is "None", no components use MLIR. When
         the value is "Bridge", use MLIR to translate GraphDef to HLO.
+      max_parallelism: If greater than 1, large ops are split into up to this
+        many partitions, which run in parallel on the thread pool passed to
+        set_thread_pool() of the generated class.
+      batch_sizes: An optional list of batch sizes to also compile the graph
+        for. For each batch size b, the leading dimension of the first feed,
+        and of every feed that has the same leading dimension, is set to b,
+        and a class named <cpp_class>Batch<b> is generated in
+        <name>_batch<b>.h, which is part of the same cc_library.
       deps: a list of deps to include on the build rules for the generated
         library, added to the standard deps if standard_runtime_deps is True.
       tags: tags to apply to subsidiary build rules.
@@ -204,6 +214,11 @@ def tf_library(
 
     mlir_flag = "--mlir_components=" + mlir_components
 
+    if max_parallelism > 1:
+        parallelism_flag = "--max_parallelism=" + str(max_parallelism)
+    else:
+        parallelism_flag = ""
+
     srcs = [tfcompile_graph, config]
     debug_info_flag = ""
     if debug_info:
@@ -219,6 +234,20 @@ def tf_library(
                                    "--xla_cpu_enable_fast_min_max=true " +
                                    "$${XLA_FLAGS:-}' ")
 
+    tfcompile_cmd = (
+        default_fast_math_xla_flags +
+        "CUDA_VISIBLE_DEVICES='' " +
+        "$(location " + tfcompile_tool + ")" +
+        " --graph=$(location " + tfcompile_graph + ")" +
+        debug_info_flag +
+        " --config=$(location " + config + ")" +
+        " --target_triple=" + target_llvm_triple() +
+        " " + parallelism_flag
+    )
+    tfcompile_cmd_flags = (
+        " " + flags + " " + profiling_flag + " " + mlir_flag + " " + traceme_flag
+    )
+
     native.genrule(
         name = ("gen_" + name),
         srcs = srcs,
@@ -228,19 +257,13 @@ def tf_library(
             function_object_file,
         ],
         cmd = (
-            default_fast_math_xla_flags +
-            "CUDA_VISIBLE_DEVICES='' " +
-            "$(location " + tfcompile_tool + ")" +
-            " --graph=$(location " + tfcompile_graph + ")" +
-            debug_info_flag +
-            " --config=$(location " + config + ")" +
+            tfcompile_cmd +
             " --entry_point=" + ep +
             " --cpp_class=" + cpp_class +
-            " --target_triple=" + target_llvm_triple() +
             " --out_header=$(@D)/" + header_file +
             " --out_metadata_object=$(@D)/" + metadata_object_file +
             " --out_function_object=$(@D)/" + function_object_file +
-            " " + flags + " " + profiling_flag + " " + mlir_flag + " " + traceme_flag
+            tfcompile_cmd_flags
         ),
         tools = [tfcompile_tool],
         visibility = visibility,
@@ -258,6 +281,42 @@ def tf_library(
         tags = tags,
     )
 
+    # Rules that compile the graph for each of the other batch sizes, with
+    # their own entry points and classes.
+    variant_headers = []
+    variant_objects = []
+    for batch_size in batch_sizes or []:
+        variant = name + "_batch" + str(batch_size)
+        variant_header = variant + ".h"
+        variant_metadata_object = variant + "_tfcompile_metadata.o"
+        variant_function_object = variant + "_tfcompile_function.o"
+        native.genrule(
+            name = ("gen_" + variant),
+            srcs = srcs,
+            outs = [
+                variant_header,
+                variant_metadata_object,
+                variant_function_object,
+            ],
+            cmd = (
+                tfcompile_cmd +
+                " --batch_size=" + str(batch_size) +
+                " --entry_point=" + ep + "_batch" + str(batch_size) +
+                " --cpp_class=" + cpp_class + "Batch" + str(batch_size) +
+                " --out_header=$(@D)/" + variant_header +
+                " --out_metadata_object=$(@D)/" + variant_metadata_object +
+                " --out_function_object=$(@D)/" + variant_function_object +
+                tfcompile_cmd_flags
+            ),
+            tools = [tfcompile_tool],
+            visibility = visibility,
+            testonly = testonly,
+            local = 1,
+            tags = tags,
+        )
+        variant_headers.append(variant_header)
+        variant_objects += [variant_function_object, variant_metadata_object]
+
     # Rule that runs tfcompile to produce the SessionModule proto, useful for
     # debugging.  TODO(b/64813587): Once the SessionModule proto is
     # deterministic, move this into the main rule above.
@@ -292,8 +351,8 @@ def tf_library(
     # kernel implementations.
     native.cc_library(
         name = name,
-        srcs = [function_object_file, metadata_object_file],
-        hdrs = [header_file],
+        srcs = [function_object_file, metadata_object_file] + variant_objects,
+        hdrs = [header_file] + variant_headers,
         visibility = visibility,
         testonly = testonly,
         deps = [
@@ -312,6 +371,7 @@ def tf_library(
             # TODO(cwhipkey): only depend on kernel code that the model actually
             # needed.
             "//tensorflow/compiler/xla/service/cpu:runtime_conv2d",
+            "//tensorflow/compiler/xla/service/cpu:runtime_fork_join",
             "//tensorflow/compiler/xla/service/cpu:runtime_key_value_sort",
             "//tensorflow/compiler/xla/service/cpu:runtime_matmul",
             "//tensorflow/compiler/xla/service/cpu:runtime_single_threaded_conv2d",
@@ -129,7 +129,13 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags
                 ->tf_xla_disable_resource_variable_safety_checks_for_debugging,
            "Disable resource variables related safety checks when clustering "
-           "(this is unsound).")};
+           "(this is unsound)."),
+      Flag("tf_xla_clustering_profile",
+           &mark_for_compilation_flags->tf_xla_clustering_profile,
+           "(experimental) Path of an XlaClusteringProfile measured for the "
+           "model. The ops of the clusters that ran slower with XLA than with "
+           "TensorFlow kernels, or that were recompiled too often, are not "
+           "clustered.")};
   flag_list->insert(flag_list->end(), new_flags.begin(), new_flags.end());
 }
 
@@ -140,6 +146,7 @@ void AllocateAndParseFlags() {
   build_ops_flags->tf_xla_check_cluster_input_numerics = false;
   build_ops_flags->tf_xla_check_cluster_output_numerics = false;
   build_ops_flags->tf_xla_disable_constant_folding = false;
+  build_ops_flags->tf_xla_shape_bucket_size = 0;
 
   mark_for_compilation_flags = new MarkForCompilationPassFlags;
   mark_for_compilation_flags->xla_auto_jit_flag.optimization_level_single_gpu =
@@ -163,6 +170,9 @@ void AllocateAndParseFlags() {
 
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
+  ops_flags->tf_xla_persistent_cache_dir = "";
+  ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_max_async_compilations = 2;
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -194,6 +204,11 @@ void AllocateAndParseFlags() {
             &build_ops_flags->tf_xla_disable_constant_folding,
             "If true then disables constant folding on TF graph before XLA "
             "compilation."),
+       Flag("tf_xla_shape_bucket_size",
+            &build_ops_flags->tf_xla_shape_bucket_size,
+            "If positive, pad the batch dimension of the inputs to XLA "
+            "clusters whose rows are computed independently up to a multiple "
+            "of this, to bound the number of recompilations."),
 
        Flag("tf_xla_compile_on_demand", &device_flags->tf_xla_compile_on_demand,
             "Switch a device into 'on-demand' mode, where instead of "
@@ -207,6 +222,20 @@ void AllocateAndParseFlags() {
 
        Flag("tf_xla_always_defer_compilation",
             &ops_flags->tf_xla_always_defer_compilation, ""),
+       Flag("tf_xla_persistent_cache_dir",
+            &ops_flags->tf_xla_persistent_cache_dir,
+            "If non-empty, persist the XLA computations built from the "
+            "clusters in this directory, which may be shared by several "
+            "processes, and read them back instead of building them again."),
+       Flag("tf_xla_async_compilation",
+            &ops_flags->tf_xla_async_compilation,
+            "If true, compile clusters on background threads instead of "
+            "blocking the step, and run them in the TF executor until they "
+            "are compiled."),
+       Flag("tf_xla_max_async_compilations",
+            &ops_flags->tf_xla_max_async_compilations,
+            "Maximum number of clusters compiled on background threads at "
+            "once."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
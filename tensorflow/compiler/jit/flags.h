@@ -78,6 +78,10 @@ struct MarkForCompilationPassFlags {
   // variable concurrency semantics.  This is unsound in general, but can be
   // used as a debugging aid.
   bool tf_xla_disable_resource_variable_safety_checks_for_debugging;
+
+  // If non-empty, the path of an XlaClusteringProfile for the model. The nodes
+  // of the clusters it shows to be slower with XLA are not clustered.
+  string tf_xla_clustering_profile;
 };
 
 // Flags associated with the XLA bridge's xla_device module.
@@ -97,6 +101,18 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile always refuses to compile the cluster, which means the
   // XLA clusters always run in the TF executor.  Defaults to false.
   bool tf_xla_always_defer_compilation;
+
+  // If non-empty, the XLA computations built from the clusters are persisted
+  // in this directory, so that other processes don't need to build them again.
+  string tf_xla_persistent_cache_dir;
+
+  // If true, _XlaCompile compiles the clusters on a background thread instead
+  // of blocking the step, and they run in the TF executor until they are
+  // compiled.  Only applies to clusters that aren't required to compile.
+  bool tf_xla_async_compilation;
+
+  // The maximum number of clusters compiled on background threads at once.
+  int32 tf_xla_max_async_compilations;
 };
 
 // Flags for the build_xla_ops pass.
@@ -120,6 +136,12 @@ struct BuildXlaOpsPassFlags {
   // Disables all constant folding. The primary use for this is for testing to
   // guarantee that tests are run on XLA and not on TF's CPU implementation.
   bool tf_xla_disable_constant_folding;
+
+  // If positive, the batch dimension of the inputs to eligible XLA clusters is
+  // padded up to a multiple of this, and the outputs are sliced back, so that
+  // varying batch sizes share a bounded number of compiled executables.  See
+  // ShapeBucketingPass.
+  int32 tf_xla_shape_bucket_size;
 };
 
 // Flags for the IntroduceFloatingPointJitter pass.
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
 #include "tensorflow/compiler/jit/union_find.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
+#include "tensorflow/compiler/jit/xla_clustering_profile.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/resource_operation_table.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -106,6 +107,10 @@ class MarkForCompilationPassImpl {
     std::atomic<int64>* fuel;
 
     bool dump_graphs;
+
+    // Nodes that a clustering profile (--tf_xla_clustering_profile) shows to
+    // have been slower with XLA. They are not clustered.
+    absl::flat_hash_set<string> nodes_slower_with_xla;
   };
 
   MarkForCompilationPassImpl(DebugOptions debug_options, Graph* graph,
@@ -1206,6 +1211,12 @@ Status MarkForCompilationPassImpl::FindCompilationCandidates() {
       continue;
     }
 
+    if (debug_options_.nodes_slower_with_xla.contains(node->name())) {
+      VLOG(2) << "Not clustering " << node->name()
+              << ": its cluster was slower with XLA in the clustering profile";
+      continue;
+    }
+
     if (!allowlist.empty() && !allowlist.contains(node->def().op())) {
       VLOG(1) << "Rejecting TF operation " << node->def().op()
               << " as it is not listed in --tf_xla_ops_to_cluster.";
@@ -1709,6 +1720,19 @@ std::atomic<int64>* GetPointerToFuel(int64 initial_value) {
 
   return fuel;
 }
+
+Status ReadNodesSlowerWithXla(const string& profile_path,
+                              absl::flat_hash_set<string>* nodes) {
+  if (profile_path.empty()) {
+    return Status::OK();
+  }
+  XlaClusteringProfile profile;
+  TF_RETURN_IF_ERROR(ReadClusteringProfile(profile_path, &profile));
+  *nodes = GetNodesSlowerWithXla(profile);
+  VLOG(1) << "Not clustering " << nodes->size() << " nodes slower with XLA in "
+          << profile_path;
+  return Status::OK();
+}
 }  // anonymous namespace
 
 bool IsCompilable(FunctionLibraryRuntime* flr, const NodeDef& ndef,
@@ -1759,6 +1783,8 @@ Status MarkForCompilationPass::Run(
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
+  TF_RETURN_IF_ERROR(ReadNodesSlowerWithXla(
+      flags->tf_xla_clustering_profile, &debug_options.nodes_slower_with_xla));
 
   return MarkForCompilation(options, debug_options);
 }
@@ -1777,6 +1803,8 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
+  TF_RETURN_IF_ERROR(ReadNodesSlowerWithXla(
+      flags->tf_xla_clustering_profile, &debug_options.nodes_slower_with_xla));
 
   return MarkForCompilation(options, debug_options);
 }
@@ -0,0 +1,403 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing_pass.h"
+
+#include <map>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/cc/framework/scope_internal.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/dump_graph.h"
+
+namespace tensorflow {
+namespace {
+
+// How an op that reads a batched tensor, i.e. one whose leading dimension is
+// the batch dimension of the cluster input, computes its output.
+enum class RowwiseKind {
+  // Unary elementwise ops.
+  kUnary,
+  // Binary elementwise ops, which may broadcast.
+  kBinary,
+  // Ops that only compute row i of the output from row i of input 0, as long
+  // as their other inputs aren't batched.
+  kFirstInput,
+};
+
+const absl::flat_hash_map<string, RowwiseKind>& RowwiseOps() {
+  static const auto* ops = new absl::flat_hash_map<string, RowwiseKind>({
+      {"Abs", RowwiseKind::kUnary},
+      {"Cast", RowwiseKind::kUnary},
+      {"Ceil", RowwiseKind::kUnary},
+      {"Cos", RowwiseKind::kUnary},
+      {"Elu", RowwiseKind::kUnary},
+      {"Erf", RowwiseKind::kUnary},
+      {"Exp", RowwiseKind::kUnary},
+      {"Expm1", RowwiseKind::kUnary},
+      {"Floor", RowwiseKind::kUnary},
+      {"Identity", RowwiseKind::kUnary},
+      {"LeakyRelu", RowwiseKind::kUnary},
+      {"Log", RowwiseKind::kUnary},
+      {"Log1p", RowwiseKind::kUnary},
+      {"LogicalNot", RowwiseKind::kUnary},
+      {"Neg", RowwiseKind::kUnary},
+      {"Reciprocal", RowwiseKind::kUnary},
+      {"Relu", RowwiseKind::kUnary},
+      {"Relu6", RowwiseKind::kUnary},
+      {"Round", RowwiseKind::kUnary},
+      {"Rsqrt", RowwiseKind::kUnary},
+      {"Selu", RowwiseKind::kUnary},
+      {"Sigmoid", RowwiseKind::kUnary},
+      {"Sign", RowwiseKind::kUnary},
+      {"Sin", RowwiseKind::kUnary},
+      {"Snapshot", RowwiseKind::kUnary},
+      {"Softplus", RowwiseKind::kUnary},
+      {"Softsign", RowwiseKind::kUnary},
+      {"Sqrt", RowwiseKind::kUnary},
+      {"Square", RowwiseKind::kUnary},
+      {"StopGradient", RowwiseKind::kUnary},
+      {"Tanh", RowwiseKind::kUnary},
+      {"Add", RowwiseKind::kBinary},
+      {"AddV2", RowwiseKind::kBinary},
+      {"BiasAdd", RowwiseKind::kBinary},
+      {"Div", RowwiseKind::kBinary},
+      {"Equal", RowwiseKind::kBinary},
+      {"Greater", RowwiseKind::kBinary},
+      {"GreaterEqual", RowwiseKind::kBinary},
+      {"Less", RowwiseKind::kBinary},
+      {"LessEqual", RowwiseKind::kBinary},
+      {"LogicalAnd", RowwiseKind::kBinary},
+      {"LogicalOr", RowwiseKind::kBinary},
+      {"Maximum", RowwiseKind::kBinary},
+      {"Minimum", RowwiseKind::kBinary},
+      {"Mul", RowwiseKind::kBinary},
+      {"NotEqual", RowwiseKind::kBinary},
+      {"Pow", RowwiseKind::kBinary},
+      {"RealDiv", RowwiseKind::kBinary},
+      {"SquaredDifference", RowwiseKind::kBinary},
+      {"Sub", RowwiseKind::kBinary},
+      {"AvgPool", RowwiseKind::kFirstInput},
+      {"Conv2D", RowwiseKind::kFirstInput},
+      {"DepthwiseConv2dNative", RowwiseKind::kFirstInput},
+      {"MatMul", RowwiseKind::kFirstInput},
+      {"MaxPool", RowwiseKind::kFirstInput},
+  });
+  return *ops;
+}
+
+PartialTensorShape GetShape(const GraphShapeInfo& shape_info, const Node* n,
+                            int output) {
+  auto it = shape_info.find(n->name());
+  if (it == shape_info.end() || output >= it->second.size()) {
+    return PartialTensorShape();
+  }
+  return it->second[output].shape;
+}
+
+// Returns true if `n`, which reads at least one batched tensor, computes row i
+// of its output only from row i of its batched inputs.
+bool IsRowwise(const Node& n, const std::vector<const Edge*>& inputs,
+               const std::vector<bool>& batched,
+               const GraphShapeInfo& shape_info) {
+  auto it = RowwiseOps().find(n.type_string());
+  if (it == RowwiseOps().end() || n.num_outputs() != 1) {
+    return false;
+  }
+  auto is_batched = [&](int i) { return batched[inputs[i]->src()->id()]; };
+  auto shape = [&](int i) {
+    return GetShape(shape_info, inputs[i]->src(), inputs[i]->src_output());
+  };
+
+  switch (it->second) {
+    case RowwiseKind::kUnary:
+      return inputs.size() == 1;
+
+    case RowwiseKind::kBinary: {
+      if (inputs.size() != 2) return false;
+      const PartialTensorShape a = shape(0);
+      const PartialTensorShape b = shape(1);
+      if (is_batched(0) && is_batched(1)) {
+        return !a.unknown_rank() && a.dims() == b.dims();
+      }
+      // The unbatched operand must not be broadcast along the batch
+      // dimension, i.e. it must either have a lower rank, or the same rank
+      // and a leading dimension of 1.
+      const PartialTensorShape& batched_shape = is_batched(0) ? a : b;
+      const PartialTensorShape& other_shape = is_batched(0) ? b : a;
+      if (batched_shape.unknown_rank() || other_shape.unknown_rank()) {
+        return false;
+      }
+      return other_shape.dims() < batched_shape.dims() ||
+             (other_shape.dims() == batched_shape.dims() &&
+              other_shape.dim_size(0) == 1);
+    }
+
+    case RowwiseKind::kFirstInput: {
+      for (int i = 1; i < inputs.size(); ++i) {
+        if (is_batched(i)) return false;
+      }
+      if (n.type_string() == "MatMul") {
+        bool transpose_a;
+        if (!GetNodeAttr(n.attrs(), "transpose_a", &transpose_a).ok() ||
+            transpose_a) {
+          return false;
+        }
+      }
+      return is_batched(0);
+    }
+  }
+  return false;
+}
+
+// Returns true if every row of the outputs of `fbody` that depend on argument
+// `batched_arg` only depends on the same row of that argument.  Sets
+// `batched_outputs` to the indices of those outputs.
+Status AnalyzeCluster(const FunctionBody& fbody, int batched_arg,
+                      const std::map<int, InferredShape>& arg_shapes,
+                      const FunctionLibraryDefinition& flib_def,
+                      bool* is_rowwise, std::vector<int>* batched_outputs) {
+  *is_rowwise = false;
+  batched_outputs->clear();
+
+  GraphShapeInfo shape_info;
+  TF_RETURN_IF_ERROR(
+      InferShapes(fbody.graph, arg_shapes, &flib_def, &shape_info));
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*fbody.graph, &order, NodeComparatorName());
+  std::vector<bool> batched(fbody.graph->num_node_ids(), false);
+  for (Node* n : order) {
+    if (n->IsArg()) {
+      int index;
+      TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &index));
+      batched[n->id()] = index == batched_arg;
+      continue;
+    }
+
+    std::vector<const Edge*> inputs;
+    TF_RETURN_IF_ERROR(n->input_edges(&inputs));
+    if (absl::c_none_of(inputs, [&](const Edge* e) {
+          return batched[e->src()->id()];
+        })) {
+      continue;
+    }
+
+    if (n->IsRetval()) {
+      int index;
+      TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &index));
+      batched_outputs->push_back(index);
+      continue;
+    }
+    if (!IsRowwise(*n, inputs, batched, shape_info)) {
+      VLOG(3) << "Not bucketing " << fbody.fdef.signature().name()
+              << " because of " << n->name() << " (" << n->type_string()
+              << ")";
+      batched_outputs->clear();
+      return Status::OK();
+    }
+    batched[n->id()] = true;
+  }
+
+  *is_rowwise = true;
+  return Status::OK();
+}
+
+// Pads input `input_index` of the cluster `n` along dimension 0 up to a
+// multiple of `bucket_size`, and slices the padding back off outputs
+// `batched_outputs`.
+Status BucketCluster(Graph* g, Node* n, int input_index, int input_rank,
+                     const std::vector<int>& batched_outputs,
+                     int bucket_size) {
+  const Edge* input_edge;
+  TF_RETURN_IF_ERROR(n->input_edge(input_index, &input_edge));
+  Output input(input_edge->src(), input_edge->src_output());
+
+  string host_name;
+  if (!n->assigned_device_name().empty()) {
+    TF_RETURN_IF_ERROR(DeviceNameUtils::DeviceNameToCpuDeviceName(
+        n->assigned_device_name(), &host_name));
+  }
+
+  Status status;
+  const int first_new_node_id = g->num_node_ids();
+  Scope root = NewInternalScope(g, &status, /*refiner=*/nullptr)
+                   .NewSubScope(absl::StrCat(n->name(), "/shape_bucketing"));
+  Scope device_scope = root.WithDevice(n->requested_device())
+                           .WithAssignedDevice(n->assigned_device_name());
+  Scope host_scope = root.WithAssignedDevice(host_name);
+
+  // bucketed_batch_size = ceil(batch_size / bucket_size) * bucket_size
+  Output shape = ops::Shape(device_scope.WithOpName("shape"), input);
+  Output batch_size = ops::StridedSlice(
+      host_scope.WithOpName("batch_size"), shape, {0}, {1}, {1},
+      ops::StridedSlice::ShrinkAxisMask(1));
+  Output num_buckets = ops::FloorDiv(
+      host_scope.WithOpName("num_buckets"),
+      ops::Add(host_scope.WithOpName("round_up"), batch_size, bucket_size - 1),
+      bucket_size);
+  Output bucketed_batch_size = ops::Mul(
+      host_scope.WithOpName("bucketed_batch_size"), num_buckets, bucket_size);
+
+  std::vector<Output> paddings;
+  paddings.push_back(ops::Stack(
+      host_scope.WithOpName("batch_padding"),
+      {0, ops::Sub(host_scope.WithOpName("padding_size"), bucketed_batch_size,
+                   batch_size)}));
+  for (int i = 1; i < input_rank; ++i) {
+    paddings.push_back(
+        ops::Const(host_scope.WithOpName("no_padding_", i), {0, 0}));
+  }
+  Output padded_input =
+      ops::Pad(device_scope.WithOpName("padded_input"), input,
+               ops::Stack(host_scope.WithOpName("paddings"), paddings));
+
+  Output end = ops::ExpandDims(host_scope.WithOpName("end"), batch_size, 0);
+  for (int output : batched_outputs) {
+    std::vector<const Edge*> out_edges;
+    for (const Edge* e : n->out_edges()) {
+      if (e->src_output() == output) out_edges.push_back(e);
+    }
+    Output unpadded_output = ops::StridedSlice(
+        device_scope.WithOpName("unpadded_output_", output),
+        Output(n, output), {0}, end, {1});
+    for (const Edge* e : out_edges) {
+      TF_RETURN_IF_ERROR(g->UpdateEdge(unpadded_output.node(), 0, e->dst(),
+                                       e->dst_input()));
+    }
+  }
+  TF_RETURN_IF_ERROR(root.status());
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(g->UpdateEdge(padded_input.node(), 0, n, input_index));
+
+  // Keep the new constants in the frame of the cluster input.
+  for (int id = first_new_node_id; id < g->num_node_ids(); ++id) {
+    Node* new_node = g->FindNodeId(id);
+    if (new_node != nullptr && new_node->IsConstant()) {
+      g->AddControlEdge(input.node(), new_node);
+    }
+  }
+  return Status::OK();
+}
+
+// Returns the input of the cluster `n` to bucket, or -1 if `n` has no single
+// non-constant input with an unknown leading dimension.  Sets `input_rank` to
+// its rank.
+xla::StatusOr<int> FindBatchedInput(const Node& n,
+                                    const GraphShapeInfo& shape_info,
+                                    int* input_rank) {
+  int num_constant_inputs, num_resource_inputs;
+  TF_RETURN_IF_ERROR(
+      GetNodeAttr(n.attrs(), kXlaNumConstantArgsAttr, &num_constant_inputs));
+  TF_RETURN_IF_ERROR(
+      GetNodeAttr(n.attrs(), kXlaNumResourceArgsAttr, &num_resource_inputs));
+
+  std::vector<const Edge*> inputs;
+  TF_RETURN_IF_ERROR(n.input_edges(&inputs));
+  int batched_input = -1;
+  for (int i = num_constant_inputs; i < inputs.size() - num_resource_inputs;
+       ++i) {
+    const Edge* e = inputs[i];
+    const PartialTensorShape shape =
+        GetShape(shape_info, e->src(), e->src_output());
+    if (shape.unknown_rank()) return -1;
+    if (shape.dims() == 0 || shape.dim_size(0) >= 0) continue;
+    if (batched_input >= 0 || e->src()->IsSwitch()) return -1;
+    batched_input = i;
+    *input_rank = shape.dims();
+  }
+  return batched_input;
+}
+}  // namespace
+
+Status ShapeBucketingPass::Run(const GraphOptimizationPassOptions& options) {
+  const int bucket_size =
+      bucket_size_ ? *bucket_size_
+                   : GetBuildXlaOpsPassFlags()->tf_xla_shape_bucket_size;
+  if (bucket_size <= 0) {
+    return Status::OK();
+  }
+
+  Graph* graph = options.graph->get();
+  std::vector<Node*> clusters;
+  absl::c_copy_if(graph->op_nodes(), std::back_inserter(clusters),
+                  [](const Node* n) { return IsXlaCompiledKernel(*n); });
+  if (clusters.empty()) {
+    return Status::OK();
+  }
+
+  GraphShapeInfo shape_info;
+  TF_RETURN_IF_ERROR(
+      InferShapes(graph, /*arg_shapes=*/{}, options.flib_def, &shape_info));
+
+  bool changed = false;
+  for (Node* n : clusters) {
+    int input_rank;
+    TF_ASSIGN_OR_RETURN(int batched_input,
+                        FindBatchedInput(*n, shape_info, &input_rank));
+    if (batched_input < 0) continue;
+
+    const FunctionDef* fdef = options.flib_def->Find(n->type_string());
+    TF_RET_CHECK(fdef != nullptr) << "Could not find " << n->type_string();
+    std::unique_ptr<FunctionBody> fbody;
+    TF_RETURN_IF_ERROR(FunctionDefToBodyHelper(*fdef, AttrSlice(&fdef->attr()),
+                                               options.flib_def, &fbody));
+
+    std::map<int, InferredShape> arg_shapes;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      auto it = shape_info.find(e->src()->name());
+      if (it != shape_info.end() && e->src_output() < it->second.size()) {
+        arg_shapes[e->dst_input()] = it->second[e->src_output()];
+      }
+    }
+
+    bool is_rowwise;
+    std::vector<int> batched_outputs;
+    TF_RETURN_IF_ERROR(AnalyzeCluster(*fbody, batched_input, arg_shapes,
+                                      *options.flib_def, &is_rowwise,
+                                      &batched_outputs));
+    if (!is_rowwise) continue;
+
+    VLOG(2) << "Bucketing the batch dimension of input " << batched_input
+            << " of " << n->name() << " to multiples of " << bucket_size;
+    TF_RETURN_IF_ERROR(BucketCluster(graph, n, batched_input, input_rank,
+                                     batched_outputs, bucket_size));
+    changed = true;
+  }
+
+  if (changed) {
+    FixupSourceAndSinkEdges(graph);
+    if (VLOG_IS_ON(1)) {
+      DumpGraphToFile("shape_bucketing", *graph, options.flib_def);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,58 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_PASS_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_PASS_H_
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// Bounds the number of times an XLA cluster is recompiled for a varying batch
+// size.  XLA compiles a new executable for every distinct input shape, so a
+// model served with arbitrary batch sizes would otherwise compile one
+// executable per batch size it sees.
+//
+// For every cluster produced by EncapsulateSubgraphsPass that has exactly one
+// non-constant input whose leading dimension is unknown, and that only
+// computes each row of its outputs from the same row of that input (i.e. is
+// built from elementwise ops, MatMuls with the input on the left, convolutions
+// and pools), this pass rewrites
+//
+//   cluster(x) => StridedSlice(cluster(Pad(x, bucketed(n) - n)), :n)
+//
+// for every output of the cluster that is computed from `x`, where n is the
+// leading dimension of `x` and bucketed(n) rounds it up to a multiple of the
+// bucket size.  The padded rows are zero, and are dropped from the outputs.
+// Clusters that reduce, reshape or otherwise mix rows are left unchanged.
+class ShapeBucketingPass : public GraphOptimizationPass {
+ public:
+  // If bucket_size is not nullopt then *bucket_size overrides the
+  // --tf_xla_shape_bucket_size flag.  The pass does nothing unless the bucket
+  // size is positive.
+  explicit ShapeBucketingPass(absl::optional<int> bucket_size = absl::nullopt)
+      : bucket_size_(bucket_size) {}
+
+  Status Run(const GraphOptimizationPassOptions& options) override;
+
+ private:
+  absl::optional<int> bucket_size_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_PASS_H_
@@ -0,0 +1,126 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing_pass.h"
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
+#include "tensorflow/compiler/jit/node_matchers.h"
+#include "tensorflow/compiler/jit/test_util.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::testing::FindNodeByName;
+using ::tensorflow::testing::matchers::Inputs;
+using ::tensorflow::testing::matchers::Name;
+using ::tensorflow::testing::matchers::NodeWith;
+using ::tensorflow::testing::matchers::Op;
+using ::tensorflow::testing::matchers::Out;
+using ::testing::_;
+
+// Returns a library with `cluster_0(x: float) -> out: float`, computing `op`
+// of `x` and `y`, where `y` is a constant of shape `y_shape`.
+FunctionDefLibrary CreateClusterLibrary(const string& op,
+                                        const TensorShape& y_shape) {
+  Tensor y(DT_FLOAT, y_shape);
+  y.flat<float>().setConstant(2.0f);
+  FunctionDefLibrary fdef_lib;
+  *fdef_lib.add_function() = FunctionDefHelper::Create(
+      /*function_name=*/"cluster_0", /*in_def=*/{"x: float"},
+      /*out_def=*/{"out: float"}, /*attr_def=*/{},
+      /*node_def=*/
+      {{{"y"}, "Const", {}, {{"dtype", DT_FLOAT}, {"value", y}}},
+       {{"out"}, op, {"x", "y:output:0"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/{{"out", "out:z:0"}});
+  return fdef_lib;
+}
+
+// Builds `out = Identity(cluster_0(x))`, where `x` has shape `x_shape`, and
+// runs ShapeBucketingPass on it.
+Status RunShapeBucketing(const FunctionDefLibrary& fdef_lib,
+                         const PartialTensorShape& x_shape,
+                         std::unique_ptr<Graph>* result) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  TF_RETURN_IF_ERROR(root.graph()->AddFunctionLibrary(fdef_lib));
+  Output x = ops::Placeholder(root.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape(x_shape));
+  Node* call;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder("cluster", "cluster_0", root.graph()->op_registry())
+          .Input(x.node())
+          .Attr(kXlaCompiledKernelAttr, true)
+          .Attr(kXlaNumConstantArgsAttr, 0)
+          .Attr(kXlaNumResourceArgsAttr, 0)
+          .Finalize(root.graph(), &call));
+  ops::Identity(root.WithOpName("out"), Output(call, 0));
+
+  auto graph = absl::make_unique<Graph>(OpRegistry::Global());
+  TF_RETURN_IF_ERROR(root.ToGraph(graph.get()));
+  FunctionLibraryDefinition flib_def(graph->op_registry(), fdef_lib);
+
+  GraphOptimizationPassWrapper wrapper;
+  GraphOptimizationPassOptions opt_options =
+      wrapper.CreateGraphOptimizationPassOptions(&graph);
+  opt_options.flib_def = &flib_def;
+
+  ShapeBucketingPass pass(/*bucket_size=*/8);
+  TF_RETURN_IF_ERROR(pass.Run(opt_options));
+  *result = std::move(graph);
+  return Status::OK();
+}
+
+TEST(ShapeBucketingPassTest, PadsRowwiseCluster) {
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(RunShapeBucketing(CreateClusterLibrary("Mul", TensorShape({4})),
+                                 PartialTensorShape({-1, 4}), &graph));
+
+  auto cluster = NodeWith(
+      Name("cluster"),
+      Inputs(Out(NodeWith(Op("Pad"), Inputs(Out(NodeWith(Name("x"))), _)))));
+  EXPECT_THAT(FindNodeByName(graph.get(), "out"),
+              NodeWith(Inputs(Out(NodeWith(Op("StridedSlice"),
+                                           Inputs(Out(cluster), _, _, _))))));
+}
+
+TEST(ShapeBucketingPassTest, DoesNotPadBroadcastAlongBatch) {
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(
+      RunShapeBucketing(CreateClusterLibrary("Mul", TensorShape({3, 4})),
+                        PartialTensorShape({-1, 4}), &graph));
+
+  EXPECT_THAT(FindNodeByName(graph.get(), "out"),
+              NodeWith(Inputs(Out(NodeWith(
+                  Name("cluster"), Inputs(Out(NodeWith(Name("x")))))))));
+}
+
+TEST(ShapeBucketingPassTest, DoesNotPadStaticBatch) {
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(RunShapeBucketing(CreateClusterLibrary("Mul", TensorShape({4})),
+                                 PartialTensorShape({2, 4}), &graph));
+
+  EXPECT_THAT(FindNodeByName(graph.get(), "out"),
+              NodeWith(Inputs(Out(NodeWith(
+                  Name("cluster"), Inputs(Out(NodeWith(Name("x")))))))));
+}
+
+}  // namespace
+}  // namespace tensorflow
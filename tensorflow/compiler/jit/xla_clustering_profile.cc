@@ -0,0 +1,127 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_clustering_profile.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/jit/xla_cluster_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Clusters compiled more often than this didn't amortize their compilation,
+// like those XlaCompilationCache considers megamorphic.
+constexpr int32 kMaxCompileCount = 10;
+
+int64 NodeTimeUs(const NodeExecStats& node_stats) {
+  return node_stats.all_end_rel_micros();
+}
+
+}  // namespace
+
+void AddClustersToProfile(const GraphDef& clustered_graph,
+                          const StepStats& tf_step_stats,
+                          const StepStats& xla_step_stats,
+                          XlaClusteringProfile* profile) {
+  absl::flat_hash_map<string, int64> tf_time_us;
+  for (const DeviceStepStats& device_stats : tf_step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : device_stats.node_stats()) {
+      tf_time_us[node_stats.node_name()] += NodeTimeUs(node_stats);
+    }
+  }
+
+  std::map<string, XlaClusteringProfile::Cluster> clusters;
+  for (const NodeDef& node : clustered_graph.node()) {
+    auto it = node.attr().find(kXlaClusterAttr);
+    if (it == node.attr().end()) {
+      continue;
+    }
+    XlaClusteringProfile::Cluster& cluster = clusters[it->second.s()];
+    cluster.set_name(it->second.s());
+    cluster.add_node_names(node.name());
+    auto time_it = tf_time_us.find(node.name());
+    if (time_it != tf_time_us.end()) {
+      cluster.set_tf_time_us(cluster.tf_time_us() + time_it->second);
+    }
+  }
+
+  // BuildXlaOpsPass names the ops that compile and run a cluster after it,
+  // e.g. "cluster_0/xla_run".
+  absl::flat_hash_set<string> measured;
+  for (const DeviceStepStats& device_stats : xla_step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : device_stats.node_stats()) {
+      const string& node_name = node_stats.node_name();
+      auto slash = node_name.find('/');
+      if (slash == string::npos) {
+        continue;
+      }
+      auto it = clusters.find(node_name.substr(0, slash));
+      if (it != clusters.end()) {
+        it->second.set_xla_time_us(it->second.xla_time_us() +
+                                   NodeTimeUs(node_stats));
+        measured.insert(it->first);
+      }
+    }
+  }
+
+  for (auto& name_and_cluster : clusters) {
+    if (!measured.contains(name_and_cluster.first)) {
+      VLOG(1) << "No XLA measurement for " << name_and_cluster.first;
+      continue;
+    }
+    *profile->add_clusters() = std::move(name_and_cluster.second);
+  }
+}
+
+void AddCompilationToProfile(const XlaJitCompilationActivity& activity,
+                             XlaClusteringProfile* profile) {
+  for (XlaClusteringProfile::Cluster& cluster : *profile->mutable_clusters()) {
+    if (cluster.name() == activity.cluster_name()) {
+      cluster.set_compile_count(
+          std::max(cluster.compile_count(), activity.compile_count()));
+    }
+  }
+}
+
+absl::flat_hash_set<string> GetNodesSlowerWithXla(
+    const XlaClusteringProfile& profile) {
+  absl::flat_hash_set<string> nodes;
+  for (const XlaClusteringProfile::Cluster& cluster : profile.clusters()) {
+    if (cluster.xla_time_us() < cluster.tf_time_us() &&
+        cluster.compile_count() <= kMaxCompileCount) {
+      continue;
+    }
+    VLOG(2) << "Cluster " << cluster.name() << " took "
+            << cluster.xla_time_us() << "us with XLA and "
+            << cluster.tf_time_us() << "us without, and was compiled "
+            << cluster.compile_count() << " times";
+    nodes.insert(cluster.node_names().begin(), cluster.node_names().end());
+  }
+  return nodes;
+}
+
+Status ReadClusteringProfile(const string& path,
+                             XlaClusteringProfile* profile) {
+  return ReadTextOrBinaryProto(Env::Default(), path, profile);
+}
+
+}  // namespace tensorflow
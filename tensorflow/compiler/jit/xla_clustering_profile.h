@@ -0,0 +1,56 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_CLUSTERING_PROFILE_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_CLUSTERING_PROFILE_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/jit/xla_activity.pb.h"
+#include "tensorflow/compiler/jit/xla_clustering_profile.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// Adds the clusters of `clustered_graph`, a graph as marked by
+// MarkForCompilationPass, to `profile`. Their TensorFlow time is that of their
+// nodes in `tf_step_stats`, a step run without XLA, and their XLA time that of
+// the ops BuildXlaOpsPass created for them in `xla_step_stats`, a step of the
+// clustered graph. Clusters missing from `xla_step_stats` aren't added.
+void AddClustersToProfile(const GraphDef& clustered_graph,
+                          const StepStats& tf_step_stats,
+                          const StepStats& xla_step_stats,
+                          XlaClusteringProfile* profile);
+
+// Records the compile count reported by `activity` on the cluster of the same
+// name in `profile`.
+void AddCompilationToProfile(const XlaJitCompilationActivity& activity,
+                             XlaClusteringProfile* profile);
+
+// Returns the nodes of the clusters in `profile` that ran slower with XLA than
+// with TensorFlow kernels, or that were recompiled too often to pay off.
+absl::flat_hash_set<string> GetNodesSlowerWithXla(
+    const XlaClusteringProfile& profile);
+
+// Reads a text or binary XlaClusteringProfile from `path`.
+Status ReadClusteringProfile(const string& path,
+                             XlaClusteringProfile* profile);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_CLUSTERING_PROFILE_H_
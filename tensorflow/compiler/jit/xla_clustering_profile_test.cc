@@ -0,0 +1,100 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_clustering_profile.h"
+
+#include "tensorflow/compiler/jit/xla_cluster_util.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+void AddNode(const string& name, const string& cluster, GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op("Relu");
+  if (!cluster.empty()) {
+    SetAttrValue(cluster, &(*node->mutable_attr())[kXlaClusterAttr]);
+  }
+}
+
+void AddNodeStats(const string& name, int64 time_us, StepStats* step_stats) {
+  if (step_stats->dev_stats_size() == 0) {
+    step_stats->add_dev_stats()->set_device("/device:CPU:0");
+  }
+  NodeExecStats* node_stats =
+      step_stats->mutable_dev_stats(0)->add_node_stats();
+  node_stats->set_node_name(name);
+  node_stats->set_all_end_rel_micros(time_us);
+}
+
+TEST(XlaClusteringProfileTest, ComparesClustersWithTheirNodes) {
+  GraphDef graph;
+  AddNode("a", "cluster_0", &graph);
+  AddNode("b", "cluster_0", &graph);
+  AddNode("c", "cluster_1", &graph);
+  AddNode("d", "cluster_1", &graph);
+  AddNode("e", "", &graph);
+  AddNode("f", "cluster_2", &graph);
+
+  StepStats tf_step_stats;
+  AddNodeStats("a", 10, &tf_step_stats);
+  AddNodeStats("b", 10, &tf_step_stats);
+  AddNodeStats("c", 5, &tf_step_stats);
+  AddNodeStats("d", 5, &tf_step_stats);
+  AddNodeStats("e", 100, &tf_step_stats);
+  AddNodeStats("f", 100, &tf_step_stats);
+  StepStats xla_step_stats;
+  AddNodeStats("cluster_0/xla_compile", 1, &xla_step_stats);
+  AddNodeStats("cluster_0/xla_run", 8, &xla_step_stats);
+  AddNodeStats("cluster_1/xla_compile", 1, &xla_step_stats);
+  AddNodeStats("cluster_1/xla_run", 12, &xla_step_stats);
+  AddNodeStats("e", 100, &xla_step_stats);
+
+  XlaClusteringProfile profile;
+  AddClustersToProfile(graph, tf_step_stats, xla_step_stats, &profile);
+  // cluster_2 didn't run with XLA, so there is nothing to compare.
+  ASSERT_EQ(profile.clusters_size(), 2);
+  EXPECT_EQ(profile.clusters(0).name(), "cluster_0");
+  EXPECT_EQ(profile.clusters(0).tf_time_us(), 20);
+  EXPECT_EQ(profile.clusters(0).xla_time_us(), 9);
+  EXPECT_EQ(profile.clusters(1).name(), "cluster_1");
+  EXPECT_EQ(profile.clusters(1).tf_time_us(), 10);
+  EXPECT_EQ(profile.clusters(1).xla_time_us(), 13);
+
+  absl::flat_hash_set<string> slower = GetNodesSlowerWithXla(profile);
+  EXPECT_EQ(slower, absl::flat_hash_set<string>({"c", "d"}));
+}
+
+TEST(XlaClusteringProfileTest, RecompiledClustersAreSlower) {
+  XlaClusteringProfile profile;
+  XlaClusteringProfile::Cluster* cluster = profile.add_clusters();
+  cluster->set_name("cluster_0");
+  cluster->add_node_names("a");
+  cluster->set_tf_time_us(20);
+  cluster->set_xla_time_us(10);
+  EXPECT_TRUE(GetNodesSlowerWithXla(profile).empty());
+
+  XlaJitCompilationActivity activity;
+  activity.set_cluster_name("cluster_0");
+  activity.set_compile_count(100);
+  AddCompilationToProfile(activity, &profile);
+  EXPECT_EQ(profile.clusters(0).compile_count(), 100);
+  EXPECT_EQ(GetNodesSlowerWithXla(profile), absl::flat_hash_set<string>({"a"}));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
+#include <map>
 #include <numeric>
 
 #include "absl/base/call_once.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/compile_mlir_util.h"
@@ -40,8 +43,11 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
 #include "tensorflow/core/public/version.h"
@@ -53,9 +59,14 @@ constexpr int64 XlaCompilationCache::kDefaultCompilationThreshold;
 
 XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
                                          DeviceType device_type)
-    : client_(client), device_type_(std::move(device_type)) {}
+    : client_(client),
+      device_type_(std::move(device_type)),
+      persistent_cache_dir_(
+          GetXlaOpsCommonFlags().tf_xla_persistent_cache_dir) {}
 
 XlaCompilationCache::~XlaCompilationCache() {
+  // Wait for the background compilations, which use this cache.
+  async_compiler_threads_.reset();
   // Ensure any use of our programs have completed by waiting for all stream
   // executors to complete.
   for (auto* executor : client_->backend().stream_executors()) {
@@ -150,6 +161,180 @@ XlaCompilationCache::BuildSignature(
   return std::move(signature);
 }
 
+void XlaCompilationCache::SerializeCompilationResult(
+    const XlaCompiler::CompilationResult& result,
+    XlaSerializedCompilationResult* serialized) {
+  serialized->Clear();
+  for (int index : result.input_mapping) {
+    serialized->add_input_mapping(index);
+  }
+  for (const xla::Shape& shape : result.xla_input_shapes) {
+    *serialized->add_xla_input_shapes() = shape.ToProto();
+  }
+  *serialized->mutable_xla_output_shape() = result.xla_output_shape.ToProto();
+  for (const XlaCompiler::OutputDescription& output : result.outputs) {
+    auto* serialized_output = serialized->add_outputs();
+    serialized_output->set_type(output.type);
+    output.shape.AsProto(serialized_output->mutable_shape());
+    serialized_output->set_is_constant(output.is_constant);
+    if (output.is_constant) {
+      output.constant_value.AsProtoTensorContent(
+          serialized_output->mutable_constant_value());
+    }
+    serialized_output->set_input_index(output.input_index);
+    serialized_output->set_is_tensor_list(output.is_tensor_list);
+  }
+  *serialized->mutable_host_compute_metadata() = result.host_compute_metadata;
+  for (const XlaCompiler::ResourceUpdate& update : result.resource_updates) {
+    auto* serialized_update = serialized->add_resource_updates();
+    serialized_update->set_input_index(update.input_index);
+    serialized_update->set_type(update.type);
+    update.shape.AsProto(serialized_update->mutable_shape());
+    serialized_update->set_modified(update.modified);
+    for (const string& gradient : update.tensor_array_gradients_accessed) {
+      serialized_update->add_tensor_array_gradients_accessed(gradient);
+    }
+  }
+  if (result.computation != nullptr) {
+    *serialized->mutable_computation() = result.computation->proto();
+  }
+}
+
+Status XlaCompilationCache::DeserializeCompilationResult(
+    const XlaSerializedCompilationResult& serialized,
+    XlaCompiler::CompilationResult* result) {
+  *result = XlaCompiler::CompilationResult();
+  result->input_mapping.assign(serialized.input_mapping().begin(),
+                               serialized.input_mapping().end());
+  for (const xla::ShapeProto& shape : serialized.xla_input_shapes()) {
+    result->xla_input_shapes.emplace_back(shape);
+  }
+  result->xla_output_shape = xla::Shape(serialized.xla_output_shape());
+  for (const auto& serialized_output : serialized.outputs()) {
+    XlaCompiler::OutputDescription output;
+    output.type = serialized_output.type();
+    if (!TensorShape::IsValid(serialized_output.shape())) {
+      return errors::DataLoss("Invalid output shape ",
+                              serialized_output.shape().DebugString());
+    }
+    output.shape = TensorShape(serialized_output.shape());
+    output.is_constant = serialized_output.is_constant();
+    if (output.is_constant &&
+        !output.constant_value.FromProto(serialized_output.constant_value())) {
+      return errors::DataLoss("Invalid constant output");
+    }
+    output.input_index = serialized_output.input_index();
+    output.is_tensor_list = serialized_output.is_tensor_list();
+    result->outputs.push_back(std::move(output));
+  }
+  result->host_compute_metadata = serialized.host_compute_metadata();
+  for (const auto& serialized_update : serialized.resource_updates()) {
+    XlaCompiler::ResourceUpdate update;
+    update.input_index = serialized_update.input_index();
+    update.type = serialized_update.type();
+    if (!TensorShape::IsValid(serialized_update.shape())) {
+      return errors::DataLoss("Invalid resource update shape ",
+                              serialized_update.shape().DebugString());
+    }
+    update.shape = TensorShape(serialized_update.shape());
+    update.modified = serialized_update.modified();
+    update.tensor_array_gradients_accessed.insert(
+        serialized_update.tensor_array_gradients_accessed().begin(),
+        serialized_update.tensor_array_gradients_accessed().end());
+    result->resource_updates.push_back(std::move(update));
+  }
+  if (serialized.has_computation()) {
+    result->computation =
+        std::make_shared<xla::XlaComputation>(serialized.computation());
+  }
+  return Status::OK();
+}
+
+string XlaCompilationCache::PersistentCacheFileName(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    const Signature& signature,
+    const XlaCompiler::CompileOptions& compile_options) const {
+  string key = absl::StrCat(
+      tf_git_version(), ";", client_->platform()->Name(), ";",
+      options.device_type.type_string(), ";", options.graph_def_version, ";",
+      options.allow_cpu_custom_calls, options.custom_fake_quant_op_calls,
+      compile_options.use_tuple_arg,
+      compile_options.return_updated_values_for_all_resources,
+      compile_options.always_return_tuple,
+      compile_options.is_entry_computation,
+      compile_options.add_token_input_output,
+      compile_options.alias_resource_update, ";", signature.name, ";");
+  for (const auto& arg : signature.arg_shapes) {
+    absl::StrAppend(&key, DataTypeString(arg.first), "[",
+                    absl::StrJoin(arg.second, ","), "];");
+  }
+  for (const Tensor& value : signature.arg_values) {
+    absl::StrAppend(&key, DataTypeString(value.dtype()),
+                    value.shape().DebugString(), "=", value.tensor_data(), ";");
+  }
+
+  // The name of a cluster doesn't identify it across processes, so the key
+  // also covers its definition and the functions it calls, in name order.
+  const FunctionDef* fdef =
+      options.flib_def != nullptr ? options.flib_def->Find(function.name())
+                                  : nullptr;
+  if (fdef != nullptr) {
+    const FunctionDefLibrary library =
+        options.flib_def->ReachableDefinitions(*fdef).ToProto();
+    std::map<string, const FunctionDef*> functions;
+    functions.emplace(function.name(), fdef);
+    for (const FunctionDef& reachable : library.function()) {
+      functions.emplace(reachable.signature().name(), &reachable);
+    }
+    for (const auto& entry : functions) {
+      string serialized;
+      SerializeToStringDeterministic(*entry.second, &serialized);
+      absl::StrAppend(&key, entry.first, "=", Fingerprint64(serialized), ";");
+    }
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return io::JoinPath(
+      persistent_cache_dir_,
+      absl::StrFormat("%016x%016x.pb", fingerprint.high64, fingerprint.low64));
+}
+
+bool XlaCompilationCache::ReadFromPersistentCache(
+    const string& file_name, XlaCompiler::CompilationResult* result) const {
+  Env* env = Env::Default();
+  if (!env->FileExists(file_name).ok()) return false;
+  XlaSerializedCompilationResult serialized;
+  Status status = ReadBinaryProto(env, file_name, &serialized);
+  if (status.ok()) status = DeserializeCompilationResult(serialized, result);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to read XLA compilation result from " << file_name
+                 << ": " << status;
+    *result = XlaCompiler::CompilationResult();
+    return false;
+  }
+  return true;
+}
+
+void XlaCompilationCache::WriteToPersistentCache(
+    const string& file_name,
+    const XlaCompiler::CompilationResult& result) const {
+  XlaSerializedCompilationResult serialized;
+  SerializeCompilationResult(result, &serialized);
+  // Write to a temporary file first, so that concurrent readers in other
+  // processes never see a partial entry.
+  Env* env = Env::Default();
+  string tmp_name;
+  if (!env->LocalTempFilename(&tmp_name)) return;
+  tmp_name = io::JoinPath(persistent_cache_dir_, io::Basename(tmp_name));
+  Status status = WriteBinaryProto(env, tmp_name, serialized);
+  if (status.ok()) status = env->RenameFile(tmp_name, file_name);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write XLA compilation result to " << file_name
+                 << ": " << status;
+    env->DeleteFile(tmp_name).IgnoreError();
+  }
+}
+
 Status XlaCompilationCache::BuildExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& result,
@@ -184,6 +369,22 @@ Status XlaCompilationCache::Compile(
     CompileMode compile_mode,
     const XlaCompiler::CompilationResult** out_compilation_result,
     xla::LocalExecutable** out_executable) {
+  if (compile_mode == CompileMode::kAsync) {
+    // The compilation may outlive this call, so it works on copies of the
+    // arguments. Unlike kLazy, every miss is compiled right away, as it doesn't
+    // hold up the caller.
+    std::vector<XlaCompiler::Argument> async_args(args.begin(), args.end());
+    auto compile_fn = [compile_options, function, async_args](
+                          XlaCompiler* compiler,
+                          XlaCompiler::CompilationResult* result) {
+      return compiler->CompileFunction(compile_options, function, async_args,
+                                       result);
+    };
+    return CompileImpl(options, function, args, compile_options, compile_fn,
+                       /*compile_threshold=*/1, /*compile_async=*/true,
+                       out_compilation_result, out_executable);
+  }
+
   absl::optional<int64> compile_threshold;
   if (compile_mode == CompileMode::kLazy) {
     compile_threshold = kDefaultCompilationThreshold;
@@ -192,9 +393,10 @@ Status XlaCompilationCache::Compile(
                         XlaCompiler::CompilationResult* result) {
     return compiler->CompileFunction(compile_options, function, args, result);
   };
-  return CompileImpl(options, function, args, compile_fn,
+  return CompileImpl(options, function, args, compile_options, compile_fn,
                      /*compile_threshold=*/compile_threshold,
-                     out_compilation_result, out_executable);
+                     /*compile_async=*/false, out_compilation_result,
+                     out_executable);
 }
 
 static bool ShouldBeMegamorphic(int64 compile_count, int64 execution_count) {
@@ -298,9 +500,10 @@ Status XlaCompilationCache::CompileSingleOp(
         compile_options.use_tuple_arg, *options.flib_def, debug_info,
         options.shape_representation_fn, result);
   };
-  return CompileImpl(options, name, args, compile_op,
+  return CompileImpl(options, name, args, compile_options, compile_op,
                      /*compile_threshold=*/absl::nullopt,
-                     out_compilation_result, out_executable);
+                     /*compile_async=*/false, out_compilation_result,
+                     out_executable);
 }
 
 namespace {
@@ -317,12 +520,138 @@ void LogOnceXlaCompiledFirstCluster() {
 }
 }  // namespace
 
+Status XlaCompilationCache::CompileAndBuildExecutable(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    const Signature& signature,
+    const XlaCompiler::CompileOptions& compile_options,
+    const std::function<Status(XlaCompiler* compiler,
+                               XlaCompiler::CompilationResult*)>& compile_fn,
+    XlaCompiler::CompilationResult* compilation_result,
+    std::unique_ptr<xla::LocalExecutable>* executable) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  const uint64 compile_start_us = env->NowMicros();
+
+  string persistent_cache_file;
+  bool used_persistent_cache = false;
+  if (!persistent_cache_dir_.empty()) {
+    persistent_cache_file = PersistentCacheFileName(options, function,
+                                                    signature, compile_options);
+    used_persistent_cache =
+        ReadFromPersistentCache(persistent_cache_file, compilation_result);
+    VLOG(1) << "Persistent XLA compilation cache "
+            << (used_persistent_cache ? "hit" : "miss") << " for "
+            << function.name() << " in " << persistent_cache_file;
+  }
+  if (!used_persistent_cache) {
+    XlaCompiler compiler(options);
+    TF_RETURN_IF_ERROR(compile_fn(&compiler, compilation_result));
+    if (!persistent_cache_file.empty()) {
+      WriteToPersistentCache(persistent_cache_file, *compilation_result);
+    }
+  }
+  CHECK_EQ(executable->get(), nullptr);
+  const Status status =
+      BuildExecutable(options, *compilation_result, executable);
+
+  const uint64 compile_end_us = env->NowMicros();
+  const uint64 compile_time_us = compile_end_us - compile_start_us;
+  metrics::UpdateXlaCompilationTime(compile_time_us);
+  {
+    mutex_lock lock(cluster_compile_stats_mu_);
+    auto it = cluster_compile_stats_.find(function.name());
+    it->second.compile_count++;
+    it->second.cumulative_compile_time_us += compile_time_us;
+    LogOnceXlaCompiledFirstCluster();
+    VLOG(1) << "compiled " << function.name() << " "
+            << it->second.compile_count
+            << " times, compile time: " << compile_time_us
+            << " us, cumulative: " << it->second.cumulative_compile_time_us
+            << " us ("
+            << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
+                                                             1.0e6)
+            << " / "
+            << tensorflow::strings::HumanReadableElapsedTime(
+                   it->second.cumulative_compile_time_us / 1.0e6)
+            << ")";
+
+    XlaJitCompilationActivity jit_compilation_activity;
+    jit_compilation_activity.set_cluster_name(function.name());
+    jit_compilation_activity.set_compile_count(it->second.compile_count);
+    jit_compilation_activity.set_compile_time_us(compile_time_us);
+    jit_compilation_activity.set_cumulative_compile_time_us(
+        it->second.cumulative_compile_time_us);
+    jit_compilation_activity.set_used_persistent_cache(used_persistent_cache);
+
+    TF_RETURN_IF_ERROR(
+        BroadcastXlaActivity(std::move(jit_compilation_activity)));
+  }
+  return status;
+}
+
+bool XlaCompilationCache::ScheduleAsyncCompilation(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    const Signature& signature,
+    const XlaCompiler::CompileOptions& compile_options,
+    const std::function<Status(XlaCompiler* compiler,
+                               XlaCompiler::CompilationResult*)>& compile_fn,
+    Entry* entry) {
+  const int max_compilations =
+      std::max(1, GetXlaOpsCommonFlags().tf_xla_max_async_compilations);
+  {
+    mutex_lock lock(async_compilation_mu_);
+    if (num_pending_async_compilations_ >= max_compilations) {
+      VLOG(2) << "Not compiling cluster " << function.name()
+              << " yet because " << num_pending_async_compilations_
+              << " clusters are already being compiled.";
+      return false;
+    }
+    if (async_compiler_threads_ == nullptr) {
+      async_compiler_threads_ = absl::make_unique<thread::ThreadPool>(
+          Env::Default(), "xla_async_compilation", max_compilations);
+    }
+    ++num_pending_async_compilations_;
+  }
+
+  // The compilation outlives the kernel that requested it, so it can't use
+  // its function library or allocator.
+  std::shared_ptr<FunctionLibraryDefinition> flib_def;
+  XlaCompiler::Options async_options = options;
+  if (options.flib_def != nullptr) {
+    flib_def = std::make_shared<FunctionLibraryDefinition>(*options.flib_def);
+    async_options.flib_def = flib_def.get();
+  }
+  async_options.device_allocator = nullptr;
+
+  VLOG(1) << "Compiling cluster " << function.name() << " in the background";
+  async_compiler_threads_->Schedule([this, async_options, flib_def, function,
+                                     signature, compile_options, compile_fn,
+                                     entry]() {
+    XlaCompiler::CompilationResult compilation_result;
+    std::unique_ptr<xla::LocalExecutable> executable;
+    Status status = CompileAndBuildExecutable(
+        async_options, function, signature, compile_options, compile_fn,
+        &compilation_result, &executable);
+    {
+      mutex_lock lock(entry->mu);
+      entry->compiling = false;
+      entry->compiled = true;
+      entry->compilation_status = status;
+      entry->compilation_result = std::move(compilation_result);
+      entry->executable = std::move(executable);
+    }
+    mutex_lock lock(async_compilation_mu_);
+    --num_pending_async_compilations_;
+  });
+  return true;
+}
+
 Status XlaCompilationCache::CompileImpl(
     const XlaCompiler::Options& options, const NameAttrList& function,
     absl::Span<const XlaCompiler::Argument> args,
+    const XlaCompiler::CompileOptions& compile_options,
     const std::function<Status(XlaCompiler* compiler,
                                XlaCompiler::CompilationResult*)>& compile_fn,
-    absl::optional<int64> compile_threshold,
+    absl::optional<int64> compile_threshold, bool compile_async,
     const XlaCompiler::CompilationResult** out_compilation_result,
     xla::LocalExecutable** out_executable) {
   DCHECK_NE(out_executable, nullptr);
@@ -432,52 +761,23 @@ Status XlaCompilationCache::CompileImpl(
       return Status::OK();
     }
 
-    tensorflow::Env* env = tensorflow::Env::Default();
-    const uint64 compile_start_us = env->NowMicros();
-    // Do the actual JIT compilation without holding the lock (it can take
-    // a long time.)
+    if (compile_async) {
+      // Let the caller run the cluster in the TF executor while it is
+      // compiled in the background.
+      if (!entry->compiling &&
+          ScheduleAsyncCompilation(options, function, signature,
+                                   compile_options, compile_fn, entry)) {
+        entry->compiling = true;
+      }
+      *out_compilation_result = nullptr;
+      *out_executable = nullptr;
+      return Status::OK();
+    }
 
-    XlaCompiler compiler(options);
     entry->compiled = true;
-
-    entry->compilation_status =
-        compile_fn(&compiler, &entry->compilation_result);
-    TF_RETURN_IF_ERROR(entry->compilation_status);
-    CHECK_EQ(entry->executable.get(), nullptr);
-    entry->compilation_status =
-        BuildExecutable(options, entry->compilation_result, &entry->executable);
-
-    const uint64 compile_end_us = env->NowMicros();
-    const uint64 compile_time_us = compile_end_us - compile_start_us;
-    metrics::UpdateXlaCompilationTime(compile_time_us);
-    {
-      mutex_lock lock(cluster_compile_stats_mu_);
-      auto it = cluster_compile_stats_.find(function.name());
-      it->second.compile_count++;
-      it->second.cumulative_compile_time_us += compile_time_us;
-      LogOnceXlaCompiledFirstCluster();
-      VLOG(1) << "compiled " << function.name() << " "
-              << it->second.compile_count
-              << " times, compile time: " << compile_time_us
-              << " us, cumulative: " << it->second.cumulative_compile_time_us
-              << " us ("
-              << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
-                                                               1.0e6)
-              << " / "
-              << tensorflow::strings::HumanReadableElapsedTime(
-                     it->second.cumulative_compile_time_us / 1.0e6)
-              << ")";
-
-      XlaJitCompilationActivity jit_compilation_activity;
-      jit_compilation_activity.set_cluster_name(function.name());
-      jit_compilation_activity.set_compile_count(it->second.compile_count);
-      jit_compilation_activity.set_compile_time_us(compile_time_us);
-      jit_compilation_activity.set_cumulative_compile_time_us(
-          it->second.cumulative_compile_time_us);
-
-      TF_RETURN_IF_ERROR(
-          BroadcastXlaActivity(std::move(jit_compilation_activity)));
-    }
+    entry->compilation_status = CompileAndBuildExecutable(
+        options, function, signature, compile_options, compile_fn,
+        &entry->compilation_result, &entry->executable);
   }
   TF_RETURN_IF_ERROR(entry->compilation_status);
   *out_compilation_result = &entry->compilation_result;
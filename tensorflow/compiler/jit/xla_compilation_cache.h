@@ -20,6 +20,7 @@ limitations under the License.
 #include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
@@ -42,6 +43,11 @@ namespace tensorflow {
 //
 // Currently no cache eviction policy is implemented and the cache grows without
 // bound.
+//
+// If --tf_xla_persistent_cache_dir is set, the XLA computations built from the
+// TensorFlow subgraphs are also written to that directory, which may be on a
+// shared file system, and are read back instead of lowering the subgraph again
+// in later processes. Only the executables are then built.
 class XlaCompilationCache : public ResourceBase {
  public:
   XlaCompilationCache(xla::LocalClient* client, DeviceType device_type);
@@ -50,6 +56,7 @@ class XlaCompilationCache : public ResourceBase {
   enum class CompileMode {
     kLazy,
     kStrict,
+    kAsync,
   };
 
   // Compiles a function into a XlaCompiler::CompilationResult that can be used
@@ -62,7 +69,11 @@ class XlaCompilationCache : public ResourceBase {
   // heuristics, the compilation cache may decide not to compile the cluster at
   // this time.  In this case it returns null into both `out_compilation_result`
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
-  // cache always attempts the compilation on a cache miss.
+  // cache always attempts the compilation on a cache miss.  If `compile_mode`
+  // is `kAsync` then a cache miss starts the compilation on a background
+  // thread and returns null like `kLazy`, until the compilation is done.  At
+  // most --tf_xla_max_async_compilations clusters are compiled at once; a miss
+  // beyond that is compiled on a later request.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
@@ -122,26 +133,77 @@ class XlaCompilationCache : public ResourceBase {
       const NameAttrList& function,
       absl::Span<const XlaCompiler::Argument> args);
 
+  // Converts a compilation result to and from the form it is persisted in.
+  static void SerializeCompilationResult(
+      const XlaCompiler::CompilationResult& result,
+      XlaSerializedCompilationResult* serialized);
+  static Status DeserializeCompilationResult(
+      const XlaSerializedCompilationResult& serialized,
+      XlaCompiler::CompilationResult* result);
+
  private:
   // Common implementation of Compile and CompileSingleOp.
   Status CompileImpl(
       const XlaCompiler::Options& options, const NameAttrList& function,
       absl::Span<const XlaCompiler::Argument> args,
+      const XlaCompiler::CompileOptions& compile_options,
       const std::function<Status(XlaCompiler* compiler,
                                  XlaCompiler::CompilationResult*)>& compile_fn,
-      absl::optional<int64> compile_threshold,
+      absl::optional<int64> compile_threshold, bool compile_async,
       const XlaCompiler::CompilationResult** out_compilation_result,
       xla::LocalExecutable** out_executable);
 
+  struct Entry;
+
+  // Builds the XLA computation for `signature` with `compile_fn`, or reads it
+  // from the persistent cache, and builds its executable. Updates the compile
+  // stats of `function`.
+  Status CompileAndBuildExecutable(
+      const XlaCompiler::Options& options, const NameAttrList& function,
+      const Signature& signature,
+      const XlaCompiler::CompileOptions& compile_options,
+      const std::function<Status(XlaCompiler* compiler,
+                                 XlaCompiler::CompilationResult*)>& compile_fn,
+      XlaCompiler::CompilationResult* compilation_result,
+      std::unique_ptr<xla::LocalExecutable>* executable);
+
+  // Compiles `entry` on a background thread, unless too many compilations are
+  // already running. Returns true if the compilation was scheduled.
+  bool ScheduleAsyncCompilation(
+      const XlaCompiler::Options& options, const NameAttrList& function,
+      const Signature& signature,
+      const XlaCompiler::CompileOptions& compile_options,
+      const std::function<Status(XlaCompiler* compiler,
+                                 XlaCompiler::CompilationResult*)>& compile_fn,
+      Entry* entry);
+
   // Takes `result` which has been compiled from a Tensorflow subgraph to a
   // XLA computation already, and generates an XLA LocalExecutable `executable`.
   Status BuildExecutable(const XlaCompiler::Options& options,
                          const XlaCompiler::CompilationResult& result,
                          std::unique_ptr<xla::LocalExecutable>* executable);
 
+  // Returns the name of the file that holds the compilation result for
+  // `signature` in the persistent cache. It is a fingerprint of everything
+  // the result depends on, including the definition of the function.
+  string PersistentCacheFileName(
+      const XlaCompiler::Options& options, const NameAttrList& function,
+      const Signature& signature,
+      const XlaCompiler::CompileOptions& compile_options) const;
+
+  // Reads the compilation result from the persistent cache, if it is there.
+  bool ReadFromPersistentCache(const string& file_name,
+                               XlaCompiler::CompilationResult* result) const;
+  void WriteToPersistentCache(
+      const string& file_name,
+      const XlaCompiler::CompilationResult& result) const;
+
   xla::LocalClient* const client_;
   const DeviceType device_type_;
 
+  // The directory of the persistent cache, or empty if it is disabled.
+  const string persistent_cache_dir_;
+
   // The value associated with a cache entry.
   struct Entry {
     mutex mu;
@@ -149,6 +211,9 @@ class XlaCompilationCache : public ResourceBase {
     // Have we tried compiling this entry?
     bool compiled = false;
 
+    // Is this entry being compiled on a background thread?
+    bool compiling TF_GUARDED_BY(mu) = false;
+
     // The number of times a compilation with this signature has been requested.
     int64 request_count = 0;
 
@@ -189,6 +254,12 @@ class XlaCompilationCache : public ResourceBase {
   absl::flat_hash_map<string, ClusterCompileStats> cluster_compile_stats_
       TF_GUARDED_BY(cluster_compile_stats_mu_);
 
+  mutex async_compilation_mu_;
+  // The threads of the background compilations, created on the first one.
+  std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
+  int64 num_pending_async_compilations_ TF_GUARDED_BY(async_compilation_mu_) =
+      0;
+
   // The number of times a lazy compilation must be requested for a specific
   // signature before  we attempt to compile it.
   static constexpr int64 kDefaultCompilationThreshold = 2;
@@ -16,6 +16,10 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
 #include "tensorflow/compiler/tf2xla/shape_util.h"
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -52,6 +56,61 @@ TEST(XlaCompilationCacheTest, SignatureEquality) {
   }
 }
 
+TEST(XlaCompilationCacheTest, SerializeCompilationResult) {
+  xla::XlaBuilder builder("add");
+  const xla::Shape shape = xla::ShapeUtil::MakeShape(xla::F32, {2});
+  xla::XlaOp param = xla::Parameter(&builder, 0, shape, "param");
+  xla::Tuple(&builder, {xla::Add(param, param)});
+  TF_ASSERT_OK_AND_ASSIGN(xla::XlaComputation computation, builder.Build());
+
+  XlaCompiler::CompilationResult result;
+  result.input_mapping = {1};
+  result.xla_input_shapes = {shape};
+  result.xla_output_shape = xla::ShapeUtil::MakeTupleShape({shape});
+  result.outputs.resize(2);
+  result.outputs[0].type = DT_FLOAT;
+  result.outputs[0].shape = TensorShape({2});
+  result.outputs[1].type = DT_INT32;
+  result.outputs[1].shape = TensorShape({});
+  result.outputs[1].is_constant = true;
+  result.outputs[1].constant_value = test::AsScalar<int32>(7);
+  result.resource_updates.resize(1);
+  result.resource_updates[0].input_index = 0;
+  result.resource_updates[0].type = DT_FLOAT;
+  result.resource_updates[0].shape = TensorShape({2});
+  result.resource_updates[0].modified = true;
+  result.resource_updates[0].tensor_array_gradients_accessed = {"grad"};
+  result.computation =
+      std::make_shared<xla::XlaComputation>(std::move(computation));
+
+  XlaSerializedCompilationResult serialized;
+  XlaCompilationCache::SerializeCompilationResult(result, &serialized);
+  XlaCompiler::CompilationResult deserialized;
+  TF_ASSERT_OK(XlaCompilationCache::DeserializeCompilationResult(
+      serialized, &deserialized));
+
+  EXPECT_EQ(deserialized.input_mapping, result.input_mapping);
+  ASSERT_EQ(deserialized.xla_input_shapes.size(), 1);
+  EXPECT_TRUE(xla::ShapeUtil::Equal(deserialized.xla_input_shapes[0], shape));
+  EXPECT_TRUE(xla::ShapeUtil::Equal(deserialized.xla_output_shape,
+                                    result.xla_output_shape));
+  ASSERT_EQ(deserialized.outputs.size(), 2);
+  EXPECT_EQ(deserialized.outputs[0].type, DT_FLOAT);
+  EXPECT_EQ(deserialized.outputs[0].shape, TensorShape({2}));
+  EXPECT_FALSE(deserialized.outputs[0].is_constant);
+  EXPECT_TRUE(deserialized.outputs[1].is_constant);
+  test::ExpectTensorEqual<int32>(deserialized.outputs[1].constant_value,
+                                 test::AsScalar<int32>(7));
+  ASSERT_EQ(deserialized.resource_updates.size(), 1);
+  EXPECT_EQ(deserialized.resource_updates[0].shape, TensorShape({2}));
+  EXPECT_TRUE(deserialized.resource_updates[0].modified);
+  EXPECT_EQ(deserialized.resource_updates[0].tensor_array_gradients_accessed,
+            std::set<string>({"grad"}));
+  ASSERT_NE(deserialized.computation, nullptr);
+  EXPECT_EQ(deserialized.computation->proto().SerializeAsString(),
+            result.computation->proto().SerializeAsString());
+}
+
 static void BM_BuildSignature(int iters, int n_args) {
   NameAttrList fn;
   fn.set_name("afunction");
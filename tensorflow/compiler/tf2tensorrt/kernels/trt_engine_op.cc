@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/convert/convert_nodes.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
@@ -38,8 +39,12 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -138,6 +143,22 @@ class TRTEngineOp : public AsyncOpKernel {
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
+  // Returns the path prefix of the files of this segment in the persistent
+  // engine cache, or an empty string if the cache is disabled.  The prefix
+  // identifies the segment, its conversion parameters, the TensorRT version
+  // and the GPU model, since engines are only valid for those.
+  string EngineCachePrefix(OpKernelContext* ctx);
+
+  // Adds the engines of this segment found in the persistent engine cache to
+  // `cache_res`.
+  void LoadCachedEngines(OpKernelContext* ctx,
+                         TRTEngineCacheResource* cache_res);
+
+  // Writes `engine`, built for `input_shapes`, to the persistent engine cache.
+  void SaveEngineToCache(OpKernelContext* ctx,
+                         const std::vector<TensorShape>& input_shapes,
+                         nvinfer1::ICudaEngine* engine);
+
   std::vector<string> input_nodes_;
   std::vector<string> output_nodes_;
 
@@ -174,6 +195,14 @@ class TRTEngineOp : public AsyncOpKernel {
   int max_cached_engines_;
 
   int64 workspace_size_;
+
+  // Directory of the persistent engine cache, from TF_TRT_ENGINE_CACHE_DIR,
+  // or empty if the engines built by this op are not cached on disk.
+  string engine_cache_dir_;
+
+  // Fingerprint of segment_graph_def_, when engine_cache_dir_ is set.
+  uint64 segment_fingerprint_ = 0;
+
   mutex engine_mutex_;
   FunctionLibraryRuntime::Handle func_handle_;
 
@@ -371,6 +400,22 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
                 errors::InvalidArgument(
                     "Explicit batch mode does not support calibration"));
   }
+
+  // Engines built while calibrating or collecting profiles are not final, and
+  // static engines are not built at runtime.
+  if (!static_engine_ && !calibration_mode_ && !profile_generation_mode_) {
+    OP_REQUIRES_OK(context, ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR", "",
+                                                 &engine_cache_dir_));
+  }
+  if (!engine_cache_dir_.empty()) {
+    string serialized_graph_def;
+    OP_REQUIRES(context,
+                SerializeToStringDeterministic(segment_graph_def_,
+                                               &serialized_graph_def),
+                errors::Internal("Failed to serialize the segment of ",
+                                 name()));
+    segment_fingerprint_ = Fingerprint64(serialized_graph_def);
+  }
 }
 
 void TRTEngineOp::ExecuteNativeSegment(OpKernelContext* ctx,
@@ -729,10 +774,131 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
       std::string(kTfTrtContainerName), std::string(resource_name), cache_res,
       {[this, ctx](TRTEngineCacheResource** cr) -> Status {
         *cr = new TRTEngineCacheResource(ctx, this->max_cached_engines_);
+        // Load the engines built by previous runs before any is built.
+        LoadCachedEngines(ctx, *cr);
         return Status::OK();
       }});
 }
 
+string TRTEngineOp::EngineCachePrefix(OpKernelContext* ctx) {
+  if (engine_cache_dir_.empty() || ctx->op_device_context() == nullptr) {
+    return "";
+  }
+  const string& gpu_model = ctx->op_device_context()
+                                ->stream()
+                                ->parent()
+                                ->GetDeviceDescription()
+                                .name();
+  const string key =
+      StrCat(segment_fingerprint_, "|", static_cast<int>(precision_mode_), "|",
+             static_cast<int>(use_implicit_batch_), "|",
+             static_cast<int>(use_calibration_), "|", workspace_size_, "|",
+             getInferLibVersion(), "|", gpu_model);
+  return io::JoinPath(engine_cache_dir_,
+                      StrCat("trt_engine_", absl::Hex(Fingerprint64(key),
+                                                      absl::kZeroPad16)));
+}
+
+void TRTEngineOp::LoadCachedEngines(OpKernelContext* ctx,
+                                    TRTEngineCacheResource* cache_res) {
+  const string prefix = EngineCachePrefix(ctx);
+  if (prefix.empty() || cache_res->allocator_ == nullptr) return;
+  std::vector<string> filenames;
+  Status status =
+      ctx->env()->GetMatchingPaths(StrCat(prefix, "_*.trtengine"), &filenames);
+  if (!status.ok()) {
+    LOG_WARNING_WITH_PREFIX << "Listing the cached engines of " << name()
+                            << " failed: " << status;
+    return;
+  }
+  for (const string& filename : filenames) {
+    // Explicit batch mode uses a single engine for all the profiles.
+    if (!use_implicit_batch_ && cache_res->cache_.size() > 0) break;
+    string contents;
+    TRTEngineInstance engine_instance;
+    status = ReadFileToString(ctx->env(), filename, &contents);
+    if (!status.ok() || !engine_instance.ParseFromString(contents)) {
+      LOG_WARNING_WITH_PREFIX << "Reading the cached engine " << filename
+                              << " failed: " << status;
+      continue;
+    }
+    std::vector<TensorShape> engine_input_shapes;
+    for (const TensorShapeProto& shape : engine_instance.input_shapes()) {
+      engine_input_shapes.emplace_back(shape);
+    }
+    TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+    infer->setGpuAllocator(cache_res->allocator_.get());
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine(infer->deserializeCudaEngine(
+        engine_instance.serialized_engine().data(),
+        engine_instance.serialized_engine().size(), nullptr));
+    if (!engine) {
+      LOG_WARNING_WITH_PREFIX << "Deserializing the cached engine " << filename
+                              << " failed";
+      continue;
+    }
+    std::vector<TrtUniquePtrType<nvinfer1::IExecutionContext>> exec_contexts;
+    if (cache_res->cache_.size() == 0) {
+      // As in InitializeTRTResource, the profiles are restored from the first
+      // engine; this is a no-op in implicit batch mode.
+      status = cache_res->profiles_.RestoreProfiles(engine.get());
+      if (status.ok()) {
+        status = cache_res->profiles_.CreateExecutionContexts(engine.get(),
+                                                              exec_contexts);
+      }
+      if (!status.ok()) {
+        LOG_WARNING_WITH_PREFIX << "Restoring the cached engine " << filename
+                                << " failed: " << status;
+        continue;
+      }
+    } else {
+      exec_contexts.emplace_back(engine->createExecutionContext());
+    }
+    cache_res->cache_.emplace(
+        engine_input_shapes,
+        absl::make_unique<EngineContext>(std::move(engine),
+                                         std::move(exec_contexts)));
+    VLOG(1) << "Loaded cached engine " << filename << " for " << name();
+  }
+}
+
+void TRTEngineOp::SaveEngineToCache(
+    OpKernelContext* ctx, const std::vector<TensorShape>& input_shapes,
+    nvinfer1::ICudaEngine* engine) {
+  const string prefix = EngineCachePrefix(ctx);
+  if (prefix.empty()) return;
+  TrtUniquePtrType<nvinfer1::IHostMemory> serialized(engine->serialize());
+  if (!serialized) {
+    LOG_WARNING_WITH_PREFIX << "Serializing the engine of " << name()
+                            << " failed";
+    return;
+  }
+  TRTEngineInstance engine_instance;
+  for (const TensorShape& shape : input_shapes) {
+    shape.AsProto(engine_instance.add_input_shapes());
+  }
+  engine_instance.set_serialized_engine(
+      static_cast<const char*>(serialized->data()), serialized->size());
+  // Write to a temporary file first, so that concurrent processes never read
+  // a partial engine.
+  const string filename = StrCat(
+      prefix, "_",
+      absl::Hex(Fingerprint64(TensorShapeUtils::ShapeListString(input_shapes)),
+                absl::kZeroPad16),
+      ".trtengine");
+  const string tmp_filename =
+      StrCat(filename, ".", ctx->env()->NowMicros(), ".tmp");
+  Status status = WriteStringToFile(ctx->env(), tmp_filename,
+                                    engine_instance.SerializeAsString());
+  if (status.ok()) {
+    status = ctx->env()->RenameFile(tmp_filename, filename);
+  }
+  if (!status.ok()) {
+    LOG_WARNING_WITH_PREFIX << "Writing the engine of " << name() << " to "
+                            << filename << " failed: " << status;
+    ctx->env()->DeleteFile(tmp_filename).IgnoreError();
+  }
+}
+
 StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
@@ -773,6 +939,7 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
   static EngineContext empty_context;
 
   mutex_lock lock(engine_mutex_);
+  mutex_lock cache_lock(cache_res->mu_);
   // Using first input to get batch size is reliable - VerifyInputShapes()
   // guarantees that the first input is not a scalar. As such we can always use
   // the first input to get the batch size for implicit batch mode. For explicit
@@ -900,6 +1067,7 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     }
     TrtUniquePtrType<nvinfer1::ICudaEngine> engine =
         std::move(result.ValueOrDie());
+    SaveEngineToCache(ctx, input_concrete_shapes, engine.get());
     std::vector<TrtUniquePtrType<nvinfer1::IExecutionContext>> exec_context;
     TF_RETURN_IF_ERROR(cache_res->profiles_.CreateExecutionContexts(
         engine.get(), exec_context));
@@ -991,6 +1159,7 @@ Status TRTEngineOp::AllocateCalibrationResources(
       // Transfer the ownership of the engine to the engine cache, so we can
       // dump it out during conversion for TF 2.0.
       mutex_lock lock(this->engine_mutex_);
+      mutex_lock cache_lock(cache_res->mu_);
       this->calibrator_ = std::move(cres->calibrator_);
       TrtUniquePtrType<nvinfer1::IExecutionContext> exec_context(
           cres->engine_->createExecutionContext());
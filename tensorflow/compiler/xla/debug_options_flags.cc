@@ -72,6 +72,9 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_force_host_platform_device_count(1);
   opts.set_xla_gpu_deterministic_reductions(false);
   opts.set_xla_cpu_enable_xprof_traceme(false);
+  opts.set_xla_cpu_parallel_codegen_split_count(1);
+  opts.set_xla_gpu_host_memory_offload_bytes(0);
+  opts.set_xla_gpu_autotune_max_fusions(0);
   opts.set_xla_gpu_unsafe_fallback_to_driver_on_ptxas_not_found(false);
 
   return opts;
@@ -137,6 +140,13 @@ static void AllocateFlags() {
     };
   };
 
+  auto int64_setter_for = [](void (DebugOptions::*member_setter)(int64)) {
+    return [member_setter](int64 value) {
+      (flag_values->*member_setter)(value);
+      return true;
+    };
+  };
+
   auto string_setter_for =
       [](void (DebugOptions::*member_setter)(const string& value)) {
         return [member_setter](const string& value) {
@@ -561,6 +571,28 @@ static void AllocateFlags() {
       flag_values->xla_cpu_enable_xprof_traceme(),
       "If true, XLA CPU generates code to call "
       "TraceMe::Activity{Start|End} around HLO operations."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      flag_values->xla_cpu_parallel_codegen_split_count(),
+      "If greater than 1, split the optimized LLVM module into this many parts "
+      "and generate machine code for them in parallel on the XLA CPU "
+      "backend."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_host_memory_offload_bytes",
+      int64_setter_for(&DebugOptions::set_xla_gpu_host_memory_offload_bytes),
+      flag_values->xla_gpu_host_memory_offload_bytes(),
+      "If positive, offload up to this many bytes of temporary buffers to "
+      "pinned host memory on the XLA GPU backend, using memory space "
+      "assignment to schedule the copies between device and host."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_autotune_max_fusions",
+      int32_setter_for(&DebugOptions::set_xla_gpu_autotune_max_fusions),
+      flag_values->xla_gpu_autotune_max_fusions(),
+      "If positive, benchmark up to this many of the largest fusions on the "
+      "device, fused and unfused, and unfuse those that run faster unfused on "
+      "the XLA GPU backend."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_unsafe_fallback_to_driver_on_ptxas_not_found",
       bool_setter_for(
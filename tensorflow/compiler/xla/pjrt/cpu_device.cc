@@ -13,22 +13,113 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
 #include "tensorflow/compiler/xla/pjrt/cpu_device.h"
 
+#include <algorithm>
+#include <set>
+#include <vector>
+
 #include "absl/strings/str_cat.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/client/client_library.h"
 #include "tensorflow/compiler/xla/service/platform_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 
 static const char kCpuPlatformName[] = "cpu";
 
+struct CpuDevice::IntraOpThreadPool {
+  IntraOpThreadPool(int numa_node, int num_threads) {
+    tensorflow::ThreadOptions thread_options;
+    thread_options.numa_node = numa_node;
+    pool = absl::make_unique<tensorflow::thread::ThreadPool>(
+        tensorflow::Env::Default(), thread_options,
+        absl::StrCat("XLAEigen_numa", numa_node), num_threads,
+        /*low_latency_hint=*/true);
+    device = absl::make_unique<Eigen::ThreadPoolDevice>(
+        pool->AsEigenThreadPool(), pool->NumThreads());
+  }
+
+  std::unique_ptr<tensorflow::thread::ThreadPool> pool;
+  std::unique_ptr<Eigen::ThreadPoolDevice> device;
+};
+
 CpuDevice::CpuDevice(int id,
-                     std::unique_ptr<LocalDeviceState> local_device_state)
+                     std::unique_ptr<LocalDeviceState> local_device_state,
+                     int numa_node, int num_threads)
     : Device(id, std::move(local_device_state), kCpuPlatformName,
-             /*device_kind=*/kCpuPlatformName) {}
+             /*device_kind=*/kCpuPlatformName) {
+  if (numa_node != tensorflow::port::kNUMANoAffinity) {
+    intra_op_thread_pool_ =
+        absl::make_unique<IntraOpThreadPool>(numa_node, num_threads);
+  }
+}
+
+CpuDevice::CpuDevice(int id,
+                     std::unique_ptr<LocalDeviceState> local_device_state)
+    : CpuDevice(id, std::move(local_device_state),
+                tensorflow::port::kNUMANoAffinity, /*num_threads=*/0) {}
+
+CpuDevice::~CpuDevice() = default;
+
+const Eigen::ThreadPoolDevice* CpuDevice::intra_op_thread_pool() const {
+  return intra_op_thread_pool_ ? intra_op_thread_pool_->device.get()
+                               : nullptr;
+}
 
-StatusOr<std::shared_ptr<PjRtClient>> GetCpuClient(bool asynchronous) {
+namespace {
+
+// Allocates the buffers of each device from the NUMA node it runs on.
+class NumaMemoryAllocator : public se::StreamExecutorMemoryAllocator {
+ public:
+  NumaMemoryAllocator(const se::Platform* platform,
+                      absl::Span<se::StreamExecutor* const> executors,
+                      std::vector<int> numa_nodes)
+      : se::StreamExecutorMemoryAllocator(platform, executors),
+        numa_nodes_(std::move(numa_nodes)) {}
+
+  StatusOr<se::OwningDeviceMemory> Allocate(int device_ordinal, uint64 size,
+                                            bool retry_on_failure,
+                                            int64 memory_space) override {
+    if (size == 0) {
+      return se::OwningDeviceMemory();
+    }
+    void* data = tensorflow::port::NUMAMalloc(
+        numa_nodes_.at(device_ordinal), size,
+        tensorflow::Allocator::kAllocatorAlignment);
+    if (data == nullptr) {
+      return ResourceExhausted(
+          "Failed to allocate %d bytes on NUMA node %d for CPU device %d",
+          size, numa_nodes_.at(device_ordinal), device_ordinal);
+    }
+    return se::OwningDeviceMemory(se::DeviceMemoryBase(data, size),
+                                  device_ordinal, this);
+  }
+
+  using se::StreamExecutorMemoryAllocator::Allocate;
+
+  Status Deallocate(int device_ordinal, se::DeviceMemoryBase mem) override {
+    if (!mem.is_null()) {
+      tensorflow::port::NUMAFree(mem.opaque(), mem.size());
+    }
+    return Status::OK();
+  }
+
+ private:
+  const std::vector<int> numa_nodes_;
+};
+
+}  // namespace
+
+StatusOr<std::shared_ptr<PjRtClient>> GetCpuClient(bool asynchronous,
+                                                   int num_devices) {
   TF_ASSIGN_OR_RETURN(se::Platform * platform,
                       PlatformUtil::GetPlatform("Host"));
   if (platform->VisibleDeviceCount() <= 0) {
@@ -36,11 +127,37 @@ StatusOr<std::shared_ptr<PjRtClient>> GetCpuClient(bool asynchronous) {
   }
   LocalClientOptions options;
   options.set_platform(platform);
+  if (num_devices > 0) {
+    std::set<int> allowed_devices;
+    for (int i = 0; i < num_devices; ++i) {
+      allowed_devices.insert(i);
+    }
+    options.set_allowed_devices(allowed_devices);
+  }
   TF_ASSIGN_OR_RETURN(LocalClient * client,
                       ClientLibrary::GetOrCreateLocalClient(options));
+  // The local client is shared by the process, so it may have been created
+  // with fewer devices by an earlier call.
+  if (client->device_count() < num_devices) {
+    return FailedPrecondition(
+        "The CPU client was already created with %d devices; %d were asked "
+        "for.",
+        client->device_count(), num_devices);
+  }
+
+  // With several devices on a multi-socket host, give each device a share of
+  // the cores of one NUMA node, round-robin, so that partitions don't contend
+  // for the same cores and memory bandwidth.
+  const int device_count = client->device_count();
+  const int num_numa_nodes = tensorflow::port::NUMANumNodes();
+  const bool numa_aware = device_count > 1 && num_numa_nodes > 1;
+  const int num_threads =
+      std::max(1, tensorflow::port::MaxParallelism() / device_count);
 
   std::vector<std::unique_ptr<Device>> devices;
-  for (int i = 0; i < client->device_count(); ++i) {
+  std::vector<se::StreamExecutor*> executors;
+  std::vector<int> numa_nodes;
+  for (int i = 0; i < device_count; ++i) {
     se::StreamExecutorConfig config;
     config.ordinal = i;
     // 8MiB stacks seem to be necessary for running LAPACK/OpenBLAS
@@ -52,13 +169,23 @@ StatusOr<std::shared_ptr<PjRtClient>> GetCpuClient(bool asynchronous) {
     auto device_state = absl::make_unique<LocalDeviceState>(
         executor, client, LocalDeviceState::kSynchronous, asynchronous,
         /*allow_event_reuse=*/false);
-    auto device = absl::make_unique<CpuDevice>(i, std::move(device_state));
+    const int numa_node = numa_aware ? i % num_numa_nodes
+                                     : tensorflow::port::kNUMANoAffinity;
+    auto device = absl::make_unique<CpuDevice>(i, std::move(device_state),
+                                               numa_node, num_threads);
     devices.push_back(std::move(device));
+    executors.push_back(executor);
+    numa_nodes.push_back(numa_node);
   }
 
+  std::unique_ptr<se::DeviceMemoryAllocator> allocator;
+  if (numa_aware) {
+    allocator = absl::make_unique<NumaMemoryAllocator>(platform, executors,
+                                                       std::move(numa_nodes));
+  }
   return std::make_shared<PjRtClient>(
       kCpuPlatformName, client, std::move(devices), /*host_id=*/0,
-      /*allocator=*/nullptr, /*host_memory_allocator=*/nullptr,
+      std::move(allocator), /*host_memory_allocator=*/nullptr,
       /*should_stage_host_to_device_transfers=*/false,
       /*gpu_run_options=*/nullptr);
 }
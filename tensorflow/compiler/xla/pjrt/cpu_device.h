@@ -25,10 +25,30 @@ namespace xla {
 
 class CpuDevice : public Device {
  public:
+  // If `numa_node` is not port::kNUMANoAffinity, the device runs its Eigen
+  // subcomputations on its own pool of `num_threads` threads pinned to that
+  // NUMA node, rather than on the client's pool.
+  CpuDevice(int id, std::unique_ptr<LocalDeviceState> local_device_state,
+            int numa_node, int num_threads);
   CpuDevice(int id, std::unique_ptr<LocalDeviceState> local_device_state);
+  ~CpuDevice() override;
+
+  const Eigen::ThreadPoolDevice* intra_op_thread_pool() const override;
+
+ private:
+  // Defined in the .cc file to avoid having to include Eigen in the header.
+  struct IntraOpThreadPool;
+  std::unique_ptr<IntraOpThreadPool> intra_op_thread_pool_;
 };
 
-StatusOr<std::shared_ptr<PjRtClient>> GetCpuClient(bool asynchronous);
+// If `num_devices` is positive, the client has that many CPU devices, which
+// can be used to run SPMD-partitioned or replicated programs, e.g. one
+// partition per socket. Otherwise it has as many as
+// --xla_force_host_platform_device_count asks for. On hosts with several
+// NUMA nodes, the devices are spread across the nodes, and each runs on and
+// allocates from its own node.
+StatusOr<std::shared_ptr<PjRtClient>> GetCpuClient(bool asynchronous,
+                                                   int num_devices = 0);
 
 }  // namespace xla
 
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/client/executable_build_options.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
 #include "tensorflow/compiler/xla/client/xla_computation.h"
+#include "tensorflow/compiler/xla/executable_run_options.h"
 #include "tensorflow/compiler/xla/layout.h"
 #include "tensorflow/compiler/xla/pjrt/local_device_state.h"
 #include "tensorflow/compiler/xla/pjrt/tracked_device_buffer.h"
@@ -91,6 +92,12 @@ class Device {
 
   virtual std::string DebugString() const;
 
+  // The thread pool on which to run the Eigen subcomputations of programs
+  // that execute on this device, or nullptr to use the client's pool.
+  virtual const Eigen::ThreadPoolDevice* intra_op_thread_pool() const {
+    return nullptr;
+  }
+
   PjRtClient* client() const { return client_; }
 
  private:
@@ -549,12 +549,13 @@ PYBIND11_MODULE(xla_extension, m) {
 
   m.def(
       "get_cpu_client",
-      [](bool asynchronous) -> StatusOr<std::shared_ptr<PyClient>> {
+      [](bool asynchronous,
+         int num_devices) -> StatusOr<std::shared_ptr<PyClient>> {
         TF_ASSIGN_OR_RETURN(std::shared_ptr<PjRtClient> client,
-                            GetCpuClient(asynchronous));
+                            GetCpuClient(asynchronous, num_devices));
         return std::make_shared<PyClient>(std::move(client));
       },
-      py::arg("asynchronous") = true);
+      py::arg("asynchronous") = true, py::arg("num_devices") = 0);
   m.def("get_interpreter_client", []() -> StatusOr<std::shared_ptr<PyClient>> {
     TF_ASSIGN_OR_RETURN(std::shared_ptr<PjRtClient> client,
                         GetInterpreterClient());
@@ -82,6 +82,14 @@ class FilteredPassManager : public llvm::legacy::PassManager {
 
 std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::operator()(
     llvm::Module& module) const {
+  OptimizeModule(module);
+  std::unique_ptr<llvm::MemoryBuffer> memory_buffer =
+      EmitObjectFile(module, target_machine_);
+  RunPostCodegenHook(*memory_buffer);
+  return memory_buffer;
+}
+
+void CompilerFunctor::OptimizeModule(llvm::Module& module) const {
   FilteredPassManager module_passes(disable_expensive_passes_);
   llvm::legacy::FunctionPassManager function_passes(&module);
 
@@ -125,37 +133,42 @@ std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::operator()(
 
   runtime::RewriteIRRuntimeFunctions(&module, fast_math_flags_);
 
-  // Buffer for holding machine code prior to constructing the ObjectFile.
-  llvm::SmallVector<char, 0> stream_buffer;
-  llvm::raw_svector_ostream ostream(stream_buffer);
-
   VLOG(2) << "IR after optimizations";
   XLA_VLOG_LINES(2, llvm_ir::DumpModuleToString(module));
 
   if (post_optimization_hook_) {
     post_optimization_hook_(module);
   }
+}
+
+/*static*/ std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::EmitObjectFile(
+    llvm::Module& module, llvm::TargetMachine* target_machine) {
+  // Buffer for holding machine code prior to constructing the ObjectFile.
+  llvm::SmallVector<char, 0> stream_buffer;
+  llvm::raw_svector_ostream ostream(stream_buffer);
 
   // Generate code.
   llvm::MCContext* mc_context;
   llvm::legacy::PassManager codegen_passes;
-  target_machine_->addPassesToEmitMC(codegen_passes, mc_context, ostream);
+  target_machine->addPassesToEmitMC(codegen_passes, mc_context, ostream);
   codegen_passes.run(module);
 
-  std::unique_ptr<llvm::MemoryBuffer> memory_buffer(
+  return std::unique_ptr<llvm::MemoryBuffer>(
       new llvm::SmallVectorMemoryBuffer(std::move(stream_buffer)));
+}
 
+void CompilerFunctor::RunPostCodegenHook(
+    const llvm::MemoryBuffer& memory_buffer) const {
   if (post_codegen_hook_) {
     llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> obj_file =
-        llvm::object::ObjectFile::createObjectFile(*memory_buffer);
+        llvm::object::ObjectFile::createObjectFile(
+            memory_buffer.getMemBufferRef());
     if (obj_file) {
       post_codegen_hook_(*obj_file.get());
     } else {
       LOG(WARNING) << "Could convert memory buffer to object file!";
     }
   }
-
-  return memory_buffer;
 }
 
 static std::vector<llvm::VecDesc> VectorFunctionsForTargetLibraryInfoImpl() {
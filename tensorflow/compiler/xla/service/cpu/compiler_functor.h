@@ -52,6 +52,23 @@ class CompilerFunctor {
   std::unique_ptr<llvm::MemoryBuffer> operator()(
       llvm::Module& module) const;  // NOLINT
 
+  // The steps of operator(), for callers that generate code for parts of the
+  // optimized module in parallel.
+
+  // Runs the IR-level optimizations and the pre/post optimization hooks on
+  // `module`.
+  void OptimizeModule(llvm::Module& module) const;  // NOLINT
+
+  // Generates machine code for the optimized `module`.  Uses no state of the
+  // functor, so it may run concurrently on modules in different LLVMContexts,
+  // as long as each uses its own `target_machine`.
+  static std::unique_ptr<llvm::MemoryBuffer> EmitObjectFile(
+      llvm::Module& module,  // NOLINT
+      llvm::TargetMachine* target_machine);
+
+  // Runs the post-codegen hook on the object file in `memory_buffer`.
+  void RunPostCodegenHook(const llvm::MemoryBuffer& memory_buffer) const;
+
  private:
   // Populates the given pass manager with TargetLibraryInfo and
   // TargetTransformInfo passes.
@@ -70,12 +70,21 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   // The relocation model used for compilation.
   RelocationModel relocation_model() const { return relocation_model_; }
 
+  // If greater than 1, the compiled code splits large ops into up to this many
+  // partitions, which run in parallel on the thread pool in the
+  // ExecutableRunOptions, or one after the other if there is none.
+  int max_parallelism() const { return max_parallelism_; }
+  void set_max_parallelism(int max_parallelism) {
+    max_parallelism_ = max_parallelism;
+  }
+
  private:
   const string triple_;
   const string cpu_name_;
   const string features_;
   const string entry_point_name_;
   const RelocationModel relocation_model_;
+  int max_parallelism_ = 1;
 };
 
 class CpuAotCompilationResult : public AotCompilationResult {
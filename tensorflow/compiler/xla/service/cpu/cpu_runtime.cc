@@ -19,7 +19,11 @@ limitations under the License.
 #include <cstring>
 #include <functional>
 #include <limits>
+#include <numeric>
+#include <tuple>
+#include <utility>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -127,6 +131,8 @@ extern const char* const kAllToAllSymbolName = "__xla_cpu_runtime_AllToAll";
 extern const char* const kCollectivePermuteSymbolName =
     "__xla_cpu_runtime_CollectivePermute";
 extern const char* const kReplicaIdSymbolName = "__xla_cpu_runtime_ReplicaId";
+extern const char* const kPartitionIdSymbolName =
+    "__xla_cpu_runtime_PartitionId";
 
 }  // namespace runtime
 }  // namespace cpu
@@ -595,32 +601,86 @@ int GetDeviceOrdinal(const xla::ExecutableRunOptions* run_options) {
   }
 }
 
+// Returns the replica and the partition that run on the device.
+std::pair<int, int> LogicalIdForDevice(
+    const xla::DeviceAssignment& device_assignment, int device_ordinal) {
+  for (int replica = 0; replica < device_assignment.replica_count();
+       ++replica) {
+    for (int partition = 0; partition < device_assignment.computation_count();
+         ++partition) {
+      if (device_assignment(replica, partition) == device_ordinal) {
+        return {replica, partition};
+      }
+    }
+  }
+  LOG(FATAL) << "Device " << device_ordinal
+             << " is not in the device assignment";
+}
+
+// Returns the IDs in the group of `groups` that contains `id`, or all IDs
+// below `id_count` if there are no groups.
+std::vector<xla::int64> ParticipatingIds(
+    const std::vector<xla::ReplicaGroup>& groups, xla::int64 id,
+    xla::int64 id_count) {
+  if (groups.empty()) {
+    std::vector<xla::int64> ids(id_count);
+    std::iota(ids.begin(), ids.end(), 0);
+    return ids;
+  }
+  for (const xla::ReplicaGroup& group : groups) {
+    if (absl::c_linear_search(group.replica_ids(), id)) {
+      return std::vector<xla::int64>(group.replica_ids().begin(),
+                                     group.replica_ids().end());
+    }
+  }
+  LOG(FATAL) << "ID " << id << " is not in any replica group";
+}
+
+// Without a channel, the collective runs across the replicas in `group` that
+// compute the same partition. With a channel, it runs across all the
+// partitions of those replicas, or, if `use_global_device_ids` is set, across
+// the devices in `group` named by replica * partition_count + partition.
 xla::RendezvousKey GetRendezvousKey(
     const xla::ExecutableRunOptions* run_options,
     std::vector<xla::ReplicaGroup> group, xla::int32 channel_id_present,
-    xla::int64 op_id) {
+    xla::int32 use_global_device_ids, xla::int64 op_id) {
   const xla::DeviceAssignment& device_assignment =
       *run_options->device_assignment();
-  xla::int32 replica_count = device_assignment.replica_count();
-  int device_ordinal = GetDeviceOrdinal(run_options);
-  CHECK_EQ(device_assignment.computation_count(), 1);
-  std::vector<xla::int64> participating_replicas =
-      xla::GetParticipatingReplicas(xla::GlobalDeviceId(device_ordinal), group,
-                                    replica_count,
-                                    *run_options->device_assignment())
-          .ValueOrDie();
+  const int replica_count = device_assignment.replica_count();
+  const int partition_count = device_assignment.computation_count();
+  int replica_id;
+  int partition_id;
+  std::tie(replica_id, partition_id) =
+      LogicalIdForDevice(device_assignment, GetDeviceOrdinal(run_options));
   xla::RendezvousKey::CollectiveOpKind op_kind =
       channel_id_present ? xla::RendezvousKey::kCrossModule
                          : xla::RendezvousKey::kCrossReplica;
   std::vector<xla::GlobalDeviceId> participating_devices;
-  participating_devices.reserve(participating_replicas.size());
-  for (xla::int64 replica : participating_replicas) {
-    participating_devices.push_back(
-        xla::GlobalDeviceId(device_assignment(replica, 0)));
+  if (channel_id_present && use_global_device_ids) {
+    for (xla::int64 id : ParticipatingIds(
+             group, replica_id * partition_count + partition_id,
+             replica_count * partition_count)) {
+      participating_devices.push_back(xla::GlobalDeviceId(
+          device_assignment(id / partition_count, id % partition_count)));
+    }
+  } else {
+    for (xla::int64 replica :
+         ParticipatingIds(group, replica_id, replica_count)) {
+      if (!channel_id_present) {
+        participating_devices.push_back(
+            xla::GlobalDeviceId(device_assignment(replica, partition_id)));
+        continue;
+      }
+      for (int partition = 0; partition < partition_count; ++partition) {
+        participating_devices.push_back(
+            xla::GlobalDeviceId(device_assignment(replica, partition)));
+      }
+    }
   }
-  return xla::RendezvousKey{
-      run_options->run_id(), std::move(participating_devices),
-      static_cast<int>(participating_replicas.size()), op_kind, op_id};
+  const int num_participants = participating_devices.size();
+  return xla::RendezvousKey{run_options->run_id(),
+                            std::move(participating_devices), num_participants,
+                            op_kind, op_id};
 }
 
 }  // namespace
@@ -631,6 +691,8 @@ TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_AllToAll(
     xla::int32 replica_groups_str_size, xla::int32 num_buffers,
     xla::int64 buffer_size, void** source_buffers, void** destination_buffers) {
   int device_ordinal = GetDeviceOrdinal(run_options);
+  // Only all-to-alls across replicas are supported.
+  CHECK_EQ(run_options->device_assignment()->computation_count(), 1);
   xla::int32 replica_id = run_options->device_assignment()
                               ->ReplicaIdForDeviceOrdinal(device_ordinal)
                               .ValueOrDie();
@@ -639,7 +701,8 @@ TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_AllToAll(
   std::vector<xla::ReplicaGroup> group =
       xla::ParseReplicaGroupsOnly(replica_groups_serialized).ValueOrDie();
   xla::RendezvousKey rendezvous_key =
-      GetRendezvousKey(run_options, group, channel_id_present, op_id);
+      GetRendezvousKey(run_options, group, channel_id_present,
+                       /*use_global_device_ids=*/0, op_id);
 
   AllToAllParticipantData participant(rendezvous_key, device_ordinal,
                                       run_options->stream());
@@ -670,16 +733,17 @@ TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_AllToAll(
 TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_AllReduce(
     const xla::ExecutableRunOptions* run_options,
     const void* replica_groups_str, xla::int32 replica_groups_str_size,
-    xla::int32 channel_id_present, xla::int64 op_id, xla::int32 reduction_kind,
-    const void* shape_ptr, xla::int32 shape_length, xla::int32 num_buffers,
-    void** input_buffers, void** output_buffers) {
+    xla::int32 channel_id_present, xla::int32 use_global_device_ids,
+    xla::int64 op_id, xla::int32 reduction_kind, const void* shape_ptr,
+    xla::int32 shape_length, xla::int32 num_buffers, void** input_buffers,
+    void** output_buffers) {
   int device_ordinal = GetDeviceOrdinal(run_options);
   absl::string_view replica_groups_serialized(
       static_cast<const char*>(replica_groups_str), replica_groups_str_size);
   std::vector<xla::ReplicaGroup> group =
       xla::ParseReplicaGroupsOnly(replica_groups_serialized).ValueOrDie();
-  xla::RendezvousKey rendezvous_key =
-      GetRendezvousKey(run_options, group, channel_id_present, op_id);
+  xla::RendezvousKey rendezvous_key = GetRendezvousKey(
+      run_options, group, channel_id_present, use_global_device_ids, op_id);
   auto shape_str = ShapeString(shape_ptr, shape_length);
   VLOG(2) << "All-reduce input/output shape : " << shape_str;
 
@@ -726,6 +790,15 @@ TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ReplicaId(
   std::memcpy(output_buffer, &replica_id, 4);
 }
 
+TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_PartitionId(
+    const xla::ExecutableRunOptions* run_options, void* output_buffer) {
+  xla::int32 partition_id =
+      LogicalIdForDevice(*run_options->device_assignment(),
+                         GetDeviceOrdinal(run_options))
+          .second;
+  std::memcpy(output_buffer, &partition_id, 4);
+}
+
 TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_CollectivePermute(
     const xla::ExecutableRunOptions* run_options, xla::int32 channel_id_present,
     xla::int64 op_id, xla::int32 byte_size, void* input_buffer,
@@ -735,25 +808,38 @@ TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_CollectivePermute(
   absl::string_view source_target_pairs_serialized(
       static_cast<const char*>(source_target_pairs), source_target_pairs_size);
   auto pairs = absl::StrSplit(source_target_pairs_serialized, ',');
-  xla::int32 replica_id = run_options->device_assignment()
-                              ->ReplicaIdForDeviceOrdinal(device_ordinal)
-                              .ValueOrDie();
+  int replica_id;
+  int partition_id;
+  std::tie(replica_id, partition_id) =
+      LogicalIdForDevice(*run_options->device_assignment(), device_ordinal);
+  // With a channel and several partitions, the pairs name the partitions of
+  // this replica, as produced by SPMD partitioning.
+  const bool cross_partition =
+      channel_id_present &&
+      run_options->device_assignment()->computation_count() > 1;
+  const int id = cross_partition ? partition_id : replica_id;
   std::vector<int> copy_to;
   for (auto& p : pairs) {
     std::vector<std::string> mapping = absl::StrSplit(p, '=');
     CHECK_EQ(mapping.size(), 2);
     int from = std::stoi(mapping[0]);
     int to = std::stoi(mapping[1]);
-    if (from == replica_id) {
+    if (from == id) {
       copy_to.push_back(to);
     }
   }
+  std::vector<xla::ReplicaGroup> group;
+  if (cross_partition) {
+    group.emplace_back();
+    group.back().add_replica_ids(replica_id);
+  }
   xla::RendezvousKey rendezvous_key =
-      GetRendezvousKey(run_options, {}, channel_id_present, op_id);
+      GetRendezvousKey(run_options, group, channel_id_present,
+                       /*use_global_device_ids=*/0, op_id);
 
   CollectivePermuteParticipantData participant(rendezvous_key, device_ordinal,
                                                run_options->stream());
-  participant.replica_id = replica_id;
+  participant.replica_id = id;
   participant.source_data = se::DeviceMemoryBase(input_buffer, byte_size);
   participant.destination_data = se::DeviceMemoryBase(output_buffer, byte_size);
   participant.replica_ids_to_copy_to = copy_to;
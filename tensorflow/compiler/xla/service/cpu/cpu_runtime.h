@@ -76,6 +76,7 @@ extern const char* const kTopKF32SymbolName;
 extern const char* const kAllReduceSymbolName;
 extern const char* const kCollectivePermuteSymbolName;
 extern const char* const kReplicaIdSymbolName;
+extern const char* const kPartitionIdSymbolName;
 extern const char* const kTracingStartSymbolName;
 extern const char* const kTracingEndSymbolName;
 extern const char* const kAllToAllSymbolName;
@@ -168,14 +169,16 @@ extern void __xla_cpu_runtime_ReleaseOutfeedBufferAfterPopulation(
 // participating_replicas: array of replica IDs participating in the reduction,
 // cf. GetParticipatingReplicas.
 // channel_id_present, op_id: whether op_id is a channel ID or a module ID.
+// use_global_device_ids: whether the replica groups hold global device IDs.
 // reduction_kind: operator used for a reduction, cf. ReductionKind.
 // shape_ptr: shape of all input/output buffers.
 extern void __xla_cpu_runtime_AllReduce(
     const xla::ExecutableRunOptions* run_options,
     const void* replica_groups_str, xla::int32 replica_groups_str_size,
-    xla::int32 channel_id_present, xla::int64 op_id, xla::int32 reduction_kind,
-    const void* shape_ptr, xla::int32 shape_length, xla::int32 num_buffers,
-    void** input_buffers, void** output_buffers);
+    xla::int32 channel_id_present, xla::int32 use_global_device_ids,
+    xla::int64 op_id, xla::int32 reduction_kind, const void* shape_ptr,
+    xla::int32 shape_length, xla::int32 num_buffers, void** input_buffers,
+    void** output_buffers);
 
 extern void __xla_cpu_runtime_CollectivePermute(
     const xla::ExecutableRunOptions* run_options, xla::int32 channel_id_present,
@@ -193,6 +196,10 @@ extern void __xla_cpu_runtime_AllToAll(
 extern void __xla_cpu_runtime_ReplicaId(
     const xla::ExecutableRunOptions* run_options, void* output_buffer);
 
+// Write the partition ID into the output buffer.
+extern void __xla_cpu_runtime_PartitionId(
+    const xla::ExecutableRunOptions* run_options, void* output_buffer);
+
 }  // extern "C"
 
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_RUNTIME_H_
@@ -1316,6 +1316,9 @@ Status IrEmitter::HandleAllReduceMultipleReplica(HloInstruction* crs) {
 
        /*channel_id_present=*/
        b_.getInt32(static_cast<int32>(crs->channel_id().has_value())),
+       /*use_global_device_ids=*/
+       b_.getInt32(static_cast<int32>(
+           Cast<HloAllReduceInstruction>(crs)->use_global_device_ids())),
        /*op_id=*/
        b_.getInt64(crs->channel_id().has_value()
                        ? *crs->channel_id()
@@ -1334,7 +1337,8 @@ Status IrEmitter::HandleAllReduceMultipleReplica(HloInstruction* crs) {
 }
 
 Status IrEmitter::HandleAllReduce(HloInstruction* crs) {
-  if (hlo_module_config_.replica_count() == 1) {
+  if (hlo_module_config_.replica_count() == 1 &&
+      hlo_module_config_.num_partitions() == 1) {
     return HandleAllReduceSingleReplica(crs);
   }
   return HandleAllReduceMultipleReplica(crs);
@@ -1447,6 +1451,20 @@ Status IrEmitter::HandleReplicaId(HloInstruction* hlo) {
   return Status::OK();
 }
 
+Status IrEmitter::HandlePartitionId(HloInstruction* hlo) {
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(hlo));
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice output_slice,
+                      assignment_.GetUniqueSlice(hlo, {}));
+  llvm::Value* output_buffer = EmitBufferPointer(output_slice, hlo->shape());
+  llvm::Type* i8_ptr_type = llvm::Type::getInt8PtrTy(module_->getContext());
+  EmitCallToFunc(
+      runtime::kPartitionIdSymbolName,
+      {/*run_options=*/GetExecutableRunOptionsArgument(),
+       /*output_buffer=*/b_.CreateBitCast(output_buffer, i8_ptr_type)},
+      b_.getVoidTy());
+  return Status::OK();
+}
+
 Status IrEmitter::HandleParameter(HloInstruction* parameter) {
   VLOG(2) << "HandleParameter: " << parameter->ToString();
   return EmitTargetAddressForOp(parameter);
@@ -1806,8 +1824,22 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
       MinimumAlignmentForPrimitiveType(reduce->shape().element_type()));
 
   if (is_reduction_over_minor_dimension) {
-    // TODO(sanjoy): Implement vectorized reduction over the minor dimension.
-    *failure_reason = "reduction over minor dimension not implemented";
+    if (arg->shape().dimensions(LayoutUtil::Minor(arg->shape().layout(), 0)) <
+        vectorization_factor) {
+      *failure_reason =
+          "minor dimension is smaller than the vectorization factor";
+      return false;
+    }
+    TF_RETURN_IF_ERROR(EmitVectorizedReduceOverMinorDimension(
+        reduce, arg, init_value, dimensions, reduction_generator,
+        vectorization_factor, element_alignment));
+    return true;
+  }
+
+  if (ShouldEmitParallelLoopFor(*reduce) &&
+      num_dynamic_loop_bounds_ >= reduce->shape().rank()) {
+    *failure_reason =
+        "the minor output dimension is partitioned across parallel tasks";
     return false;
   }
 
@@ -1837,15 +1869,8 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   llvm_ir::ForLoopNest loop_nest(IrName(reduce), &b_);
   std::vector<llvm::Value*> array_multi_index(
       reduce->shape().dimensions_size());
-  for (int i = LayoutUtil::MinorToMajor(reduce->shape()).size() - 1; i > 0;
-       --i) {
-    int64 dimension = LayoutUtil::Minor(reduce->shape().layout(), i);
-    int64 start_index = 0;
-    int64 end_index = reduce->shape().dimensions(dimension);
-    std::unique_ptr<llvm_ir::ForLoop> loop = loop_nest.AddLoop(
-        start_index, end_index, absl::StrFormat("dim.%d", dimension));
-    array_multi_index[dimension] = loop->GetIndVarValue();
-  }
+  AddOutputLoopsForVectorizedReduce(*reduce, /*num_minor_dims_to_skip=*/1,
+                                    &loop_nest, &array_multi_index);
 
   int64 innermost_dimension = LayoutUtil::Minor(reduce->shape().layout(), 0);
   int64 innermost_dimension_size =
@@ -1926,6 +1951,196 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   return true;
 }
 
+void IrEmitter::AddOutputLoopsForVectorizedReduce(
+    const HloInstruction& reduce, int64 num_minor_dims_to_skip,
+    llvm_ir::ForLoopNest* loop_nest,
+    std::vector<llvm::Value*>* output_multi_index) {
+  std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds;
+  if (ShouldEmitParallelLoopFor(reduce)) {
+    dynamic_loop_bounds = compute_function_->GetDynamicLoopBounds();
+  }
+  const Shape& shape = reduce.shape();
+  for (int i = shape.rank() - 1; i >= num_minor_dims_to_skip; --i) {
+    int64 dimension = LayoutUtil::Minor(shape.layout(), i);
+    int bounds_index = shape.rank() - 1 - i;
+    std::unique_ptr<llvm_ir::ForLoop> loop;
+    if (bounds_index < dynamic_loop_bounds.size()) {
+      loop = loop_nest->AddLoop(absl::StrFormat("dim.%d", dimension),
+                                dynamic_loop_bounds[bounds_index].first,
+                                dynamic_loop_bounds[bounds_index].second);
+    } else {
+      loop = loop_nest->AddLoop(0, shape.dimensions(dimension),
+                                absl::StrFormat("dim.%d", dimension));
+    }
+    (*output_multi_index)[dimension] = loop->GetIndVarValue();
+  }
+}
+
+Status IrEmitter::EmitVectorizedReduceOverMinorDimension(
+    HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+    absl::Span<const int64> dimensions,
+    const ReductionGenerator& reduction_generator, int vectorization_factor,
+    unsigned element_alignment) {
+  CHECK(!reduce->shape().IsTuple());
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(reduce));
+
+  // We're reducing over the most minor dimension R0 of the input, and possibly
+  // over other dimensions R1.  With VS the vectorization stride, we lower the
+  // reduction loop as:
+  //
+  //  for (d in D) {
+  //    vector_acc = init
+  //    scalar_acc = init
+  //    for (r1 in R1) {
+  //      for (r0 in R0 with stride VS) {
+  //        vector_acc = elementwise_reduce(vector_acc, input[d, r1, r0])
+  //      }
+  //      for (r0 in the R0 % VS remaining elements) {
+  //        scalar_acc = reduce(scalar_acc, input[d, r1, r0])
+  //      }
+  //    }
+  //    output[d] = reduce(scalar_acc, horizontal_reduce(vector_acc))
+  //  }
+  //
+  // This reassociates the reduction and applies init more than once, which,
+  // like the GPU backend's reduction emitter, relies on init being an identity
+  // of the reduction function.
+  const PrimitiveType element_type = reduce->shape().element_type();
+  const int64 minor_dimension = LayoutUtil::Minor(arg->shape().layout(), 0);
+  const int64 minor_dimension_size = arg->shape().dimensions(minor_dimension);
+  const int64 vectorized_end =
+      (minor_dimension_size / vectorization_factor) * vectorization_factor;
+  std::vector<int64> outer_reduced_dimensions;
+  for (int64 dimension : dimensions) {
+    if (dimension != minor_dimension) {
+      outer_reduced_dimensions.push_back(dimension);
+    }
+  }
+
+  llvm_ir::ForLoopNest loop_nest(IrName(reduce), &b_);
+  std::vector<llvm::Value*> output_multi_index(
+      reduce->shape().dimensions_size());
+  AddOutputLoopsForVectorizedReduce(*reduce, /*num_minor_dims_to_skip=*/0,
+                                    &loop_nest, &output_multi_index);
+  if (llvm::BasicBlock* innermost_body_bb =
+          loop_nest.GetInnerLoopBodyBasicBlock()) {
+    SetToFirstInsertPoint(innermost_body_bb, &b_);
+  }
+  llvm_ir::IrArray::Index output_index(output_multi_index, reduce->shape(),
+                                       b_.getInt64Ty());
+
+  ShardedVectorType vector_type =
+      CreateShardedVectorType(element_type, vectorization_factor);
+  llvm::Value* init_value_ssa = Load(GetEmittedValueFor(init_value));
+  ShardedVector vector_accumulator;
+  vector_accumulator.reserve(vector_type.size());
+  for (llvm::Type* shard_type : vector_type) {
+    llvm::Value* accumulator_shard = llvm_ir::EmitAllocaAtFunctionEntry(
+        shard_type, "vector_accumulator", &b_, 0);
+    llvm::Value* initial_value = init_value_ssa;
+    if (auto vector_shard_type = llvm::dyn_cast<llvm::VectorType>(shard_type)) {
+      initial_value =
+          VectorSplat(vector_shard_type->getNumElements(), init_value_ssa);
+    }
+    AlignedStore(initial_value, accumulator_shard, element_alignment);
+    vector_accumulator.push_back(accumulator_shard);
+  }
+  llvm::Value* scalar_accumulator = llvm_ir::EmitAllocaAtFunctionEntry(
+      init_value_ssa->getType(), "scalar_accumulator", &b_, 0);
+  Store(init_value_ssa, scalar_accumulator);
+
+  llvm_ir::ForLoopNest reduction_loop_nest(IrName(reduce, "reduction"), &b_);
+  std::vector<llvm::Value*> input_multi_index =
+      reduction_loop_nest.AddLoopsForShapeOnDimensions(
+          arg->shape(), outer_reduced_dimensions, "reduction_dim");
+  if (llvm::BasicBlock* innermost_body_bb =
+          reduction_loop_nest.GetInnerLoopBodyBasicBlock()) {
+    SetToFirstInsertPoint(innermost_body_bb, &b_);
+  }
+  llvm_ir::IrArray::Index::const_iterator it = output_index.begin();
+  for (int64 dimension = 0; dimension < input_multi_index.size(); ++dimension) {
+    if (!absl::c_linear_search(dimensions, dimension)) {
+      input_multi_index[dimension] = *it++;
+    }
+  }
+  CHECK(output_index.end() == it);
+  llvm_ir::IrArray arg_array(GetIrArrayFor(arg));
+
+  {
+    llvm_ir::ForLoopNest vector_loop_nest(IrName(reduce, "vectorized"), &b_);
+    std::unique_ptr<llvm_ir::ForLoop> loop =
+        vector_loop_nest.AddLoop(0, vectorized_end, vectorization_factor,
+                                 absl::StrFormat("dim.%d", minor_dimension));
+    SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &b_);
+    input_multi_index[minor_dimension] = loop->GetIndVarValue();
+    llvm_ir::IrArray::Index input_index(input_multi_index, arg->shape(),
+                                        b_.getInt64Ty());
+    llvm::Value* input_address = BitCast(
+        arg_array.EmitArrayElementAddress(input_index, &b_), b_.getInt8PtrTy());
+    for (int i = 0; i < vector_accumulator.size(); i++) {
+      auto input_address_typed =
+          BitCast(input_address, vector_accumulator[i]->getType());
+      auto current_accumulator_value =
+          AlignedLoad(vector_accumulator[i], element_alignment);
+      auto addend = AlignedLoad(input_address_typed, element_alignment);
+      arg_array.AnnotateLoadStoreInstructionWithMetadata(addend);
+      auto reduced_result =
+          reduction_generator(&b_, current_accumulator_value, addend);
+      AlignedStore(reduced_result, vector_accumulator[i], element_alignment);
+      if (i != (vector_accumulator.size() - 1)) {
+        input_address = ConstInBoundsGEP1_32(reduced_result->getType(),
+                                             input_address_typed, 1);
+      }
+    }
+    SetToFirstInsertPoint(vector_loop_nest.GetOuterLoopExitBasicBlock(), &b_);
+  }
+
+  if (vectorized_end < minor_dimension_size) {
+    llvm_ir::ForLoopNest epilogue_loop_nest(IrName(reduce, "epilogue"), &b_);
+    std::unique_ptr<llvm_ir::ForLoop> loop =
+        epilogue_loop_nest.AddLoop(vectorized_end, minor_dimension_size,
+                                   absl::StrFormat("dim.%d", minor_dimension));
+    SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &b_);
+    input_multi_index[minor_dimension] = loop->GetIndVarValue();
+    llvm_ir::IrArray::Index input_index(input_multi_index, arg->shape(),
+                                        b_.getInt64Ty());
+    llvm::Value* addend = arg_array.EmitReadArrayElement(input_index, &b_);
+    Store(reduction_generator(&b_, Load(scalar_accumulator), addend),
+          scalar_accumulator);
+    SetToFirstInsertPoint(epilogue_loop_nest.GetOuterLoopExitBasicBlock(),
+                          &b_);
+  }
+
+  if (llvm::BasicBlock* exit_bb =
+          reduction_loop_nest.GetOuterLoopExitBasicBlock()) {
+    SetToFirstInsertPoint(exit_bb, &b_);
+  }
+
+  // Reduce the shards of the vector accumulator into the scalar one.
+  llvm::Value* result = Load(scalar_accumulator);
+  for (llvm::Value* accumulator_shard : vector_accumulator) {
+    llvm::Value* shard_value =
+        AlignedLoad(accumulator_shard, element_alignment);
+    auto vector_shard_type =
+        llvm::dyn_cast<llvm::VectorType>(shard_value->getType());
+    if (vector_shard_type == nullptr) {
+      result = reduction_generator(&b_, result, shard_value);
+      continue;
+    }
+    for (int i = 0; i < vector_shard_type->getNumElements(); i++) {
+      result = reduction_generator(&b_, result,
+                                   b_.CreateExtractElement(shard_value, i));
+    }
+  }
+  llvm_ir::IrArray target_array = GetIrArrayFor(reduce);
+  target_array.EmitWriteArrayElement(output_index, result, &b_);
+
+  if (llvm::BasicBlock* exit_bb = loop_nest.GetOuterLoopExitBasicBlock()) {
+    SetToFirstInsertPoint(exit_bb, &b_);
+  }
+  return Status::OK();
+}
+
 Status IrEmitter::HandleReduce(HloInstruction* reduce) {
   auto arg = reduce->mutable_operand(0);
   auto init_value = reduce->mutable_operand(1);
@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/llvm_ir/alias_analysis.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/ir_array.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/ir_builder_mixin.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/llvm_loop.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/loop_emitter.h"
 #include "tensorflow/compiler/xla/service/name_uniquer.h"
@@ -174,6 +175,7 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   Status HandleAfterAll(HloInstruction* after_all) override;
   Status HandleAddDependency(HloInstruction* add_dependency) override;
   Status HandleReplicaId(HloInstruction* hlo) override;
+  Status HandlePartitionId(HloInstruction* hlo) override;
   Status HandleRng(HloInstruction* rng) override;
   Status HandleRngGetAndUpdateState(HloInstruction* rng_state) override;
   Status FinishVisit(HloInstruction* root) override;
@@ -408,6 +410,27 @@ class IrEmitter : public DfsHloVisitorWithDefault,
       HloInstruction* arg, absl::Span<const int64> dimensions,
       unsigned element_alignment);
 
+  // Emits a vectorized reduction over the most minor dimension of "arg".  Each
+  // output element is reduced into a sharded vector accumulator that walks the
+  // minor dimension "vectorization_factor" elements at a time, and a scalar
+  // accumulator for the remaining elements, which are then combined with a
+  // horizontal reduction.  Helper function for EmitVectorizedReduce.
+  Status EmitVectorizedReduceOverMinorDimension(
+      HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+      absl::Span<const int64> dimensions,
+      const ReductionGenerator& reduction_generator, int vectorization_factor,
+      unsigned element_alignment);
+
+  // Adds loops to "loop_nest" over the dimensions of the output of "reduce",
+  // from the most major one to the "num_minor_dims_to_skip"-th most minor one,
+  // and sets the corresponding entries of "output_multi_index".  Loops over
+  // dimensions that are partitioned across parallel tasks use the dynamic loop
+  // bounds of the compute function.
+  void AddOutputLoopsForVectorizedReduce(
+      const HloInstruction& reduce, int64 num_minor_dims_to_skip,
+      llvm_ir::ForLoopNest* loop_nest,
+      std::vector<llvm::Value*>* output_multi_index);
+
   // Tries to emit a fast concatenate operation using memcpy.  Returns true if
   // successful, and false on failure.  On failure, sets "failure_reason" to a
   // string describing why it could not emit a fast concatenate.
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
@@ -24,10 +25,103 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 
 namespace xla {
 namespace cpu {
 
+namespace {
+
+// Returns the shape whose size bounds the memory traffic of 'instruction'.
+// That is its output shape, except for reductions, which read an operand that
+// is typically much larger than their output.
+const Shape& CostShape(const HloInstruction* instruction) {
+  return instruction->opcode() == HloOpcode::kReduce
+             ? instruction->operand(0)->shape()
+             : instruction->shape();
+}
+
+// Reductions whose output is too small to be partitioned across
+// 'target_parallel_task_count' tasks can still be parallelized if they reduce
+// the most major dimension of their operand, of size K: that dimension is split
+// into [P, K/P] by a bitcast, which preserves the layout, and 'reduce' is
+// replaced by a reduce over P of the partial results of a reduce that keeps P
+// as its most major output dimension. Returns that partial reduce, which can
+// be partitioned P ways, or nullptr if 'reduce' can't be split.
+HloInstruction* SplitReduceForParallelTasks(HloInstruction* reduce,
+                                            int64 target_parallel_task_count) {
+  HloInstruction* operand = reduce->mutable_operand(0);
+  const Shape& operand_shape = operand->shape();
+  if (operand_shape.rank() == 0 || !LayoutUtil::HasLayout(operand_shape)) {
+    return nullptr;
+  }
+  const int64 split_dim = LayoutUtil::Major(operand_shape.layout(), 0);
+  if (!absl::c_linear_search(reduce->dimensions(), split_dim)) {
+    return nullptr;
+  }
+  const int64 split_dim_size = operand_shape.dimensions(split_dim);
+  int64 num_parts = std::min(target_parallel_task_count, split_dim_size);
+  while (num_parts > 1 && split_dim_size % num_parts != 0) {
+    --num_parts;
+  }
+  if (num_parts <= 1) {
+    return nullptr;
+  }
+
+  // The operand shape with 'split_dim' replaced by [num_parts, K/P], which
+  // shifts the dimensions after it by one.
+  auto split_dimension_number = [&](int64 dim) {
+    return dim < split_dim ? dim : dim + 1;
+  };
+  std::vector<int64> split_dimensions;
+  for (int64 dim = 0; dim < operand_shape.rank(); ++dim) {
+    if (dim == split_dim) {
+      split_dimensions.push_back(num_parts);
+      split_dimensions.push_back(split_dim_size / num_parts);
+    } else {
+      split_dimensions.push_back(operand_shape.dimensions(dim));
+    }
+  }
+  std::vector<int64> split_minor_to_major;
+  for (int64 dim : operand_shape.layout().minor_to_major()) {
+    split_minor_to_major.push_back(split_dimension_number(dim));
+  }
+  split_minor_to_major.push_back(split_dim);
+  const Shape split_shape = ShapeUtil::MakeShapeWithLayout(
+      operand_shape.element_type(), split_dimensions, split_minor_to_major);
+
+  std::vector<int64> partial_reduce_dimensions;
+  int64 parts_dim = 0;
+  for (int64 dim = 0; dim < operand_shape.rank(); ++dim) {
+    if (absl::c_linear_search(reduce->dimensions(), dim)) {
+      partial_reduce_dimensions.push_back(split_dimension_number(dim));
+    } else if (dim < split_dim) {
+      ++parts_dim;
+    }
+  }
+  const Shape partial_shape = ShapeUtil::FilterDimensions(
+      [&](int64 dim) {
+        return !absl::c_linear_search(partial_reduce_dimensions, dim);
+      },
+      split_shape);
+
+  HloComputation* computation = reduce->parent();
+  HloInstruction* bitcast = computation->AddInstruction(
+      HloInstruction::CreateBitcast(split_shape, operand));
+  HloInstruction* partial_reduce =
+      computation->AddInstruction(HloInstruction::CreateReduce(
+          partial_shape, bitcast, reduce->mutable_operand(1),
+          partial_reduce_dimensions, reduce->to_apply()));
+  HloInstruction* final_reduce =
+      computation->AddInstruction(HloInstruction::CreateReduce(
+          reduce->shape(), partial_reduce, reduce->mutable_operand(1),
+          {parts_dim}, reduce->to_apply()));
+  TF_CHECK_OK(computation->ReplaceInstruction(reduce, final_reduce));
+  return partial_reduce;
+}
+
+}  // namespace
+
 class SimpleCostModel : public ParallelCostModel {
  public:
   SimpleCostModel(const int64 max_parallelism,
@@ -37,7 +131,7 @@ class SimpleCostModel : public ParallelCostModel {
 
   int64 GetParallelTaskCount(HloInstruction* instruction) override {
     // Simple cost model based on hlo size and typical L2 cache size.
-    const int64 instruction_cost = shape_size_(instruction->shape());
+    const int64 instruction_cost = shape_size_(CostShape(instruction));
     const int64 min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     // Return target parallel task count in [1, max_parallelism_].
     return std::min(max_parallelism_,
@@ -79,7 +173,7 @@ class DefaultCostModel : public ParallelCostModel {
           max_parallelism_,
           std::ceil(std::sqrt(tensorflow::port::MaxParallelism())));
       // Use shape size instruction cost and L2 cache size min per-thread cost.
-      instruction_cost = shape_size_(instruction->shape());
+      instruction_cost = shape_size_(CostShape(instruction));
       min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     } else {
       // Use max parallelism for compute bound instructions.
@@ -219,8 +313,22 @@ bool ParallelTaskAssigner::AssignParallelTasksHelper(
     // Assign feasible dimension partitions (based on actual dimension sizes).
     auto dim_partition_counts = ShapePartitionAssigner(instruction->shape())
                                     .Run(target_parallel_task_count);
-    const int64 total_partition_count =
+    int64 total_partition_count =
         ShapePartitionAssigner::GetTotalPartitionCount(dim_partition_counts);
+    if (total_partition_count <= 1 &&
+        instruction->opcode() == HloOpcode::kReduce) {
+      // Split the reduction instead, and partition the partial reduce along
+      // its most major dimension, which holds the parts.
+      if (HloInstruction* partial_reduce = SplitReduceForParallelTasks(
+              instruction, target_parallel_task_count)) {
+        instruction = partial_reduce;
+        const Shape& shape = instruction->shape();
+        total_partition_count =
+            shape.dimensions(LayoutUtil::Major(shape.layout(), 0));
+        dim_partition_counts = {total_partition_count};
+        changed = true;
+      }
+    }
     if (total_partition_count <= 1) {
       // Feasible partition calculation resulting in no partitioning, so skip.
       continue;
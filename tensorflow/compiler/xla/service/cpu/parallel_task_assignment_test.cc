@@ -191,5 +191,52 @@ TEST_F(ParallelTaskAssignmentTest, AllReduceNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, ReduceToScalarIsSplitAcrossTasks) {
+  // The reduction function is made expensive enough for the reduce to be
+  // compute bound, so that it is assigned max_parallelism_ tasks regardless of
+  // the number of cores of the host.
+  constexpr char hlo_string[] = R"(
+  HloModule TestTaskParallel_reduce
+    sum_of_powers {
+      lhs = f32[] parameter(0)
+      rhs = f32[] parameter(1)
+      p2 = f32[] multiply(rhs, rhs)
+      p4 = f32[] multiply(p2, p2)
+      p8 = f32[] multiply(p4, p4)
+      p16 = f32[] multiply(p8, p8)
+      p32 = f32[] multiply(p16, p16)
+      p64 = f32[] multiply(p32, p32)
+      p128 = f32[] multiply(p64, p64)
+      ROOT add = f32[] add(lhs, p128)
+    }
+
+    ENTRY Reduce {
+      input = f32[4194304]{0} parameter(0)
+      zero = f32[] constant(0)
+      ROOT reduce = f32[] reduce(input, zero), dimensions={0},
+        to_apply=sum_of_powers
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+
+  // The largest divisor of 4194304 that is at most max_parallelism_ is 8.
+  HloInstruction* root = m->entry_computation()->root_instruction();
+  ASSERT_EQ(root->opcode(), HloOpcode::kReduce);
+  EXPECT_TRUE(ShapeUtil::IsScalar(root->shape()));
+  HloInstruction* call = root->mutable_operand(0);
+  ASSERT_EQ(call->opcode(), HloOpcode::kCall);
+  HloInstruction* partial_reduce = call->to_apply()->root_instruction();
+  ASSERT_EQ(partial_reduce->opcode(), HloOpcode::kReduce);
+  EXPECT_TRUE(ShapeUtil::Equal(partial_reduce->shape(),
+                               ShapeUtil::MakeShape(F32, {8})));
+  EXPECT_THAT(partial_reduce->outer_dimension_partitions(),
+              ::testing::ElementsAre(8));
+  EXPECT_EQ(call->operand(0)->opcode(), HloOpcode::kBitcast);
+}
+
 }  // namespace
 }  // namespace xla
@@ -23,6 +23,8 @@ limitations under the License.
 #include <utility>
 
 #include "absl/memory/memory.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "llvm/IR/Operator.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/orc_jit_memory_mapper.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d.h"
@@ -48,7 +51,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/windows_compatibility.h"
 #include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 namespace cpu {
@@ -91,11 +96,18 @@ SimpleOrcJIT::SimpleOrcJIT(
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
     std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
-    : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+    : target_options_(target_options),
+      opt_level_(opt_level),
+      target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       data_layout_(target_machine_->createDataLayout()),
       symbol_resolver_(llvm::orc::createLegacyLookupResolver(
           execution_session_,
           [this](llvm::StringRef name) -> llvm::JITSymbol {
+            // Parts of a module added with AddModuleInParallel refer to each
+            // other's symbols.
+            if (auto symbol = this->FindSymbolInParts(std::string(name))) {
+              return symbol;
+            }
             return this->ResolveRuntimeSymbol(std::string(name));
           },
           [](llvm::Error Err) {
@@ -121,13 +133,12 @@ SimpleOrcJIT::SimpleOrcJIT(
           [this](VModuleKeyT, const llvm::object::ObjectFile& object) {
             this->NotifyObjectFreed(object);
           }),
-      compile_layer_(
-          object_layer_,
-          CompilerFunctor(target_machine_.get(), opt_level, optimize_for_size,
-                          disable_expensive_passes, fast_math_flags,
-                          std::move(pre_optimization_hook),
-                          std::move(post_optimization_hook),
-                          std::move(post_codegen_hook))),
+      compiler_functor_(target_machine_.get(), opt_level, optimize_for_size,
+                        disable_expensive_passes, fast_math_flags,
+                        std::move(pre_optimization_hook),
+                        std::move(post_optimization_hook),
+                        std::move(post_codegen_hook)),
+      compile_layer_(object_layer_, compiler_functor_),
       gdb_jit_event_listener_(
           llvm::JITEventListener::createGDBRegistrationListener()) {
   VLOG(1) << "CPU target: " << target_machine_->getTargetCPU().str()
@@ -182,12 +193,81 @@ SimpleOrcJIT::VModuleKeyT SimpleOrcJIT::AddModule(
   return key;
 }
 
+std::vector<SimpleOrcJIT::VModuleKeyT> SimpleOrcJIT::AddModuleInParallel(
+    std::unique_ptr<llvm::Module> module, int num_parts) {
+  // Optimize before splitting, so that the inliner still sees every callee.
+  compiler_functor_.OptimizeModule(*module);
+
+  // Modules in one LLVMContext can't be compiled concurrently, so the parts
+  // are moved to a context per thread as bitcode.  Locals referenced from
+  // other parts are made external (with hidden visibility) by SplitModule.
+  std::vector<std::string> parts;
+  llvm::SplitModule(
+      *module, num_parts,
+      [&](std::unique_ptr<llvm::Module> part) {
+        std::string bitcode;
+        llvm::raw_string_ostream ostream(bitcode);
+        llvm::WriteBitcodeToFile(*part, ostream);
+        ostream.flush();
+        parts.push_back(std::move(bitcode));
+      },
+      /*PreserveLocals=*/false);
+  module.reset();
+  VLOG(1) << "Generating code for " << parts.size() << " parts in parallel";
+
+  // TargetMachines aren't thread-safe, so every part gets its own.
+  std::vector<std::unique_ptr<llvm::TargetMachine>> target_machines;
+  for (int i = 0; i < parts.size(); ++i) {
+    target_machines.push_back(
+        InferTargetMachineForJIT(target_options_, opt_level_));
+  }
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(parts.size());
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "xla_cpu_codegen", parts.size());
+    for (int i = 0; i < parts.size(); ++i) {
+      pool.Schedule([&, i] {
+        llvm::LLVMContext context;
+        std::unique_ptr<llvm::Module> part = cantFail(llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(parts[i], "part"), context));
+        objects[i] = CompilerFunctor::EmitObjectFile(
+            *part, target_machines[i].get());
+      });
+    }
+  }
+
+  std::vector<VModuleKeyT> keys;
+  for (std::unique_ptr<llvm::MemoryBuffer>& object : objects) {
+    compiler_functor_.RunPostCodegenHook(*object);
+    auto key = execution_session_.allocateVModule();
+    cantFail(object_layer_.addObject(key, std::move(object)));
+    module_keys_.push_back(key);
+    part_keys_.push_back(key);
+    keys.push_back(key);
+  }
+  return keys;
+}
+
 void SimpleOrcJIT::RemoveModule(SimpleOrcJIT::VModuleKeyT key) {
   module_keys_.erase(std::remove(module_keys_.begin(), module_keys_.end(), key),
                      module_keys_.end());
+  part_keys_.erase(std::remove(part_keys_.begin(), part_keys_.end(), key),
+                   part_keys_.end());
   cantFail(compile_layer_.removeModule(key));
 }
 
+llvm::JITSymbol SimpleOrcJIT::FindSymbolInParts(const std::string& name) {
+  for (VModuleKeyT key : part_keys_) {
+    // The symbols SplitModule made external are hidden, so they aren't
+    // exported.
+    if (auto symbol = object_layer_.findSymbolIn(
+            key, name, /*ExportedSymbolsOnly=*/false)) {
+      return symbol;
+    }
+  }
+  return nullptr;
+}
+
 llvm::JITSymbol SimpleOrcJIT::FindCompiledSymbol(const std::string& name) {
 #ifdef _WIN32
   // The symbol lookup of ObjectLinkingLayer uses the SymbolRef::SF_Exported
@@ -244,6 +324,7 @@ bool RegisterKnownJITSymbols() {
   REGISTER_CPU_RUNTIME_SYMBOL(CollectivePermute);
   REGISTER_CPU_RUNTIME_SYMBOL(AllToAll);
   REGISTER_CPU_RUNTIME_SYMBOL(ReplicaId);
+  REGISTER_CPU_RUNTIME_SYMBOL(PartitionId);
   REGISTER_CPU_RUNTIME_SYMBOL(MKLConvF32);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenConvF16);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenConvF32);
@@ -39,9 +39,9 @@ namespace cpu {
 // This class wraps Orc's functionality into a single interface that only
 // exposes what we need for XLA.
 //
-// Supports JIT-ing multiple modules but without cross-module linking.
-// Implements eager compilation - the module is lowered to binary as soon as
-// it's added to the JIT.
+// Supports JIT-ing multiple modules, but only resolves references between them
+// for modules added with AddModuleInParallel.  Implements eager compilation -
+// the module is lowered to binary as soon as it's added to the JIT.
 class SimpleOrcJIT {
  public:
   using ObjLayerT = llvm::orc::LegacyRTDyldObjectLinkingLayer;
@@ -73,6 +73,12 @@ class SimpleOrcJIT {
   // remove this module.
   VModuleKeyT AddModule(std::unique_ptr<llvm::Module> module);
 
+  // Like AddModule, but after optimizing `module` as a whole, splits it into
+  // at most `num_parts` modules and generates machine code for them in
+  // parallel.  Returns the keys of the parts.
+  std::vector<VModuleKeyT> AddModuleInParallel(
+      std::unique_ptr<llvm::Module> module, int num_parts);
+
   // Remove a module from the JIT and free the memory associated with it.
   void RemoveModule(VModuleKeyT key);
 
@@ -95,17 +101,26 @@ class SimpleOrcJIT {
  private:
   llvm::JITSymbol ResolveRuntimeSymbol(const std::string& name);
 
+  // Looks up `name` in the parts of the modules added with
+  // AddModuleInParallel.
+  llvm::JITSymbol FindSymbolInParts(const std::string& name);
+
   void NotifyObjectFinalized(
       const llvm::object::ObjectFile& object,
       const llvm::RuntimeDyld::LoadedObjectInfo& object_info);
   void NotifyObjectFreed(const llvm::object::ObjectFile& object);
 
   std::vector<VModuleKeyT> module_keys_;
+  // The subset of module_keys_ added by AddModuleInParallel.
+  std::vector<VModuleKeyT> part_keys_;
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   const llvm::DataLayout data_layout_;
   llvm::orc::ExecutionSession execution_session_;
   std::shared_ptr<llvm::orc::SymbolResolver> symbol_resolver_;
   ObjLayerT object_layer_;
+  CompilerFunctor compiler_functor_;
   CompileLayerT compile_layer_;
   int64 size_of_generated_code_in_bytes_ = 0;
 
@@ -0,0 +1,132 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
+#include "tensorflow/compiler/xla/service/hlo_module_config.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/service/platform_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Returns a module with a chain of `num_loops` while loops.  The bodies of the
+// loops aren't inlined into the entry computation, so they end up in separate
+// LLVM functions that the module can be split between.
+std::string MakeModuleWithLoops(int num_loops) {
+  std::string hlo_text = "HloModule Loops\n";
+  for (int i = 0; i < num_loops; ++i) {
+    absl::StrAppend(
+        &hlo_text,
+        absl::StrReplaceAll(R"(
+body_$i {
+  p = (s32[], f32[1024]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  x = f32[1024] get-tuple-element(p), index=1
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  scale = f32[] constant($i)
+  scales = f32[1024] broadcast(scale), dimensions={}
+  y = f32[1024] multiply(x, scales)
+  z = f32[1024] tanh(y)
+  ROOT t = (s32[], f32[1024]) tuple(next_i, z)
+}
+
+cond_$i {
+  p = (s32[], f32[1024]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  n = s32[] constant(3)
+  ROOT lt = pred[] compare(i, n), direction=LT
+}
+)",
+                            {{"$i", absl::StrCat(i + 1)}}));
+  }
+  absl::StrAppend(&hlo_text, R"(
+ENTRY main {
+  x_0 = f32[1024] parameter(0)
+  zero = s32[] constant(0)
+)");
+  for (int i = 1; i <= num_loops; ++i) {
+    absl::StrAppend(
+        &hlo_text,
+        absl::StrReplaceAll(R"(
+  init_$i = (s32[], f32[1024]) tuple(zero, x_$p)
+  while_$i = (s32[], f32[1024]) while(init_$i), condition=cond_$i, body=body_$i
+  x_$i = f32[1024] get-tuple-element(while_$i), index=1
+)",
+                            {{"$i", absl::StrCat(i)},
+                             {"$p", absl::StrCat(i - 1)}}));
+  }
+  absl::StrAppend(&hlo_text, absl::StrCat("  ROOT result = f32[1024] copy(x_",
+                                          num_loops, ")\n}\n"));
+  return hlo_text;
+}
+
+class CpuParallelCodegenTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_parallel_codegen_split_count(4);
+    return debug_options;
+  }
+};
+
+TEST_F(CpuParallelCodegenTest, MatchesReference) {
+  EXPECT_TRUE(RunAndCompare(MakeModuleWithLoops(8), ErrorSpec{1e-5, 1e-5}));
+}
+
+// Measures how long the CPU backend takes to generate code for a module with
+// many functions, with its LLVM module split into `split_count` parts.
+void BM_ParallelCodegen(int num_iters, int split_count) {
+  tensorflow::testing::StopTiming();
+
+  se::Platform* platform = PlatformUtil::GetPlatform("Host").ValueOrDie();
+  se::StreamExecutor* executor =
+      platform->ExecutorForDevice(0).ValueOrDie();
+
+  HloModuleConfig config;
+  DebugOptions debug_options = GetDebugOptionsFromFlags();
+  debug_options.set_xla_cpu_parallel_codegen_split_count(split_count);
+  config.set_debug_options(debug_options);
+  std::unique_ptr<HloModule> module =
+      ParseAndReturnUnverifiedModule(MakeModuleWithLoops(200), config)
+          .ValueOrDie();
+
+  CpuCompiler compiler;
+  std::unique_ptr<HloModule> optimized_module =
+      compiler.RunHloPasses(std::move(module), executor, nullptr)
+          .ValueOrDie();
+
+  tensorflow::testing::StartTiming();
+  for (int i = 0; i < num_iters; ++i) {
+    compiler.RunBackend(optimized_module->Clone(), executor, nullptr)
+        .ValueOrDie();
+  }
+}
+
+BENCHMARK(BM_ParallelCodegen)->Arg(1)->Arg(4)->Arg(8);
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -42,6 +42,10 @@ Status BufferAllocations::TearDown(
   for (BufferAllocation::Index i = 0; i < num_buffers; ++i) {
     const BufferAllocation& allocation = buffer_assignment->GetAllocation(i);
     se::DeviceMemoryBase buffer_address = GetDeviceAddress(allocation.index());
+    // Buffers in host memory belong to the GpuExecutable's pool.
+    if (allocation.color() == kHostMemorySpace) {
+      continue;
+    }
     // Deallocate buffers marked "maybe_live_out" but aren't actually live out,
     // and temp buffers.
     if ((allocation.maybe_live_out() &&
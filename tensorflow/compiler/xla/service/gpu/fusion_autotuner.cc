@@ -0,0 +1,295 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/fusion_autotuner.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/service/call_inliner.h"
+#include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
+#include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
+#include "tensorflow/compiler/xla/service/hlo_clone_context.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/service_executable_run_options.h"
+#include "tensorflow/compiler/xla/service/shaped_buffer.h"
+#include "tensorflow/compiler/xla/service/stream_pool.h"
+#include "tensorflow/compiler/xla/service/transfer_manager.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// How many times each variant of a fusion runs. The first run only warms up.
+constexpr int kNumRuns = 4;
+
+// A fusion is only unfused if that makes it at least this much faster, so that
+// noise in the measurements doesn't decide.
+constexpr double kMinUnfusedSpeedup = 1.1;
+
+struct FusionTimes {
+  int64 fused_ns;
+  int64 unfused_ns;
+};
+
+using FusionCacheKey = std::pair<const se::StreamExecutor*, std::string>;
+
+static tensorflow::mutex autotune_cache_mu(tensorflow::LINKER_INITIALIZED);
+static auto& autotune_cache TF_GUARDED_BY(autotune_cache_mu) =
+    *new absl::flat_hash_map<FusionCacheKey, FusionTimes>();
+
+bool IsAutotunable(const HloInstruction& instr) {
+  if (instr.opcode() != HloOpcode::kFusion ||
+      (!instr.IsLoopFusion() && !instr.IsInputFusion())) {
+    return false;
+  }
+  return absl::c_all_of(instr.operands(), [](const HloInstruction* operand) {
+    return operand->shape().IsArray();
+  });
+}
+
+// The bytes that a fusion reads and writes, which is what unfused instructions
+// have to read and write at least, so the largest fusions have the most to
+// gain or lose.
+int64 BytesAccessed(const HloInstruction& fusion) {
+  int64 bytes = 0;
+  ShapeUtil::ForEachSubshape(
+      fusion.shape(), [&](const Shape& subshape, const ShapeIndex& /*index*/) {
+        if (subshape.IsArray()) {
+          bytes += ShapeUtil::ByteSizeOf(subshape);
+        }
+      });
+  for (const HloInstruction* operand : fusion.operands()) {
+    bytes += ShapeUtil::ByteSizeOf(operand->shape());
+  }
+  return bytes;
+}
+
+// Returns a module that runs `fusion` on its parameters, either as it is or
+// with its fused instructions unfused.
+std::unique_ptr<HloModule> ExtractFusion(const HloInstruction& fusion,
+                                         bool unfused) {
+  ProgramShape program_shape;
+  for (const HloInstruction* operand : fusion.operands()) {
+    *program_shape.add_parameters() = operand->shape();
+  }
+  *program_shape.mutable_result() = fusion.shape();
+  HloModuleConfig config(program_shape, /*ignore_layouts=*/false);
+  config.set_debug_options(fusion.GetModule()->config().debug_options());
+  auto module = absl::make_unique<HloModule>(
+      absl::StrCat(fusion.name(), unfused ? "_unfused" : "_fused"), config);
+
+  HloCloneContext context(module.get());
+  if (unfused) {
+    module->AddEntryComputation(
+        fusion.fused_instructions_computation()->Clone("unfused", &context));
+  } else {
+    HloComputation::Builder builder("fused");
+    std::vector<HloInstruction*> parameters;
+    for (int64 i = 0; i < fusion.operand_count(); ++i) {
+      parameters.push_back(builder.AddInstruction(
+          HloInstruction::CreateParameter(i, fusion.operand(i)->shape(),
+                                          absl::StrCat("param_", i))));
+    }
+    builder.AddInstruction(
+        fusion.CloneWithNewOperands(fusion.shape(), parameters, &context));
+    module->AddEntryComputation(builder.Build());
+  }
+  return module;
+}
+
+// Compiles `module` and returns the fastest time in nanoseconds that it took
+// to run on `stream`, on randomly initialized parameters.
+StatusOr<int64> TimeModule(std::unique_ptr<HloModule> module,
+                           const FusionAutotuner::CompileFn& compile,
+                           se::Stream* stream,
+                           se::DeviceMemoryAllocator* allocator) {
+  se::StreamExecutor* stream_exec = stream->parent();
+  const int device_ordinal = stream_exec->device_ordinal();
+  std::vector<Shape> parameter_shapes;
+  for (const HloInstruction* parameter :
+       module->entry_computation()->parameter_instructions()) {
+    parameter_shapes.push_back(parameter->shape());
+  }
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<Executable> executable,
+                      compile(std::move(module)));
+
+  TF_ASSIGN_OR_RETURN(TransferManager * transfer_manager,
+                      TransferManager::GetForPlatform(stream_exec->platform()));
+  std::vector<ScopedShapedBuffer> arguments;
+  int64 rng_state = 0;
+  for (const Shape& shape : parameter_shapes) {
+    TF_ASSIGN_OR_RETURN(ScopedShapedBuffer argument,
+                        transfer_manager->AllocateScopedShapedBuffer(
+                            shape, allocator, device_ordinal));
+    se::DeviceMemoryBase buffer = argument.root_buffer();
+    switch (shape.element_type()) {
+      case F16:
+      case F32:
+      case F64:
+      case S8:
+        InitializeBuffer(stream, shape.element_type(), &rng_state, buffer);
+        break;
+      default:
+        stream->ThenMemZero(&buffer, buffer.size());
+        break;
+    }
+    arguments.push_back(std::move(argument));
+  }
+  std::vector<const ShapedBuffer*> argument_ptrs;
+  for (const ScopedShapedBuffer& argument : arguments) {
+    argument_ptrs.push_back(&argument);
+  }
+
+  ExecutableRunOptions run_options;
+  run_options.set_device_ordinal(device_ordinal);
+  run_options.set_stream(stream);
+  run_options.set_allocator(allocator);
+  StreamPool stream_pool;
+  ServiceExecutableRunOptions service_run_options(
+      run_options, [&](int /*device_ordinal*/) -> StatusOr<StreamPool::Ptr> {
+        return stream_pool.BorrowStream(stream_exec);
+      });
+
+  int64 best_ns = std::numeric_limits<int64>::max();
+  for (int run = 0; run < kNumRuns; ++run) {
+    se::Timer timer(stream_exec);
+    stream->InitTimer(&timer).ThenStartTimer(&timer);
+    TF_ASSIGN_OR_RETURN(ScopedShapedBuffer result,
+                        executable->ExecuteAsyncOnStream(
+                            &service_run_options, argument_ptrs,
+                            /*hlo_execution_profile=*/nullptr));
+    stream->ThenStopTimer(&timer);
+    TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+    if (run > 0) {
+      best_ns = std::min<int64>(best_ns, timer.Nanoseconds());
+    }
+  }
+  return best_ns;
+}
+
+StatusOr<FusionTimes> AutotuneFusion(const HloInstruction& fusion,
+                                     const FusionAutotuner::CompileFn& compile,
+                                     se::Stream* stream,
+                                     se::DeviceMemoryAllocator* allocator) {
+  // Don't run autotuning concurrently on the same GPU.
+  tensorflow::mutex_lock gpu_lock = LockGpu(stream->parent());
+
+  FusionCacheKey key = std::make_pair(
+      stream->parent(), fusion.ToString(HloPrintOptions::Canonical()));
+  tensorflow::mutex_lock cache_lock(autotune_cache_mu);
+  auto it = autotune_cache.find(key);
+  if (it != autotune_cache.end()) {
+    VLOG(4) << "Autotuning cache hit for " << fusion.name();
+    return it->second;
+  }
+  VLOG(4) << "Autotuning cache miss for " << fusion.name();
+
+  FusionTimes times;
+  TF_ASSIGN_OR_RETURN(times.fused_ns,
+                      TimeModule(ExtractFusion(fusion, /*unfused=*/false),
+                                 compile, stream, allocator));
+  TF_ASSIGN_OR_RETURN(times.unfused_ns,
+                      TimeModule(ExtractFusion(fusion, /*unfused=*/true),
+                                 compile, stream, allocator));
+  CHECK(autotune_cache.emplace(key, times).second);
+  return times;
+}
+
+// Replaces `fusion` with its fused instructions.
+Status Unfuse(HloInstruction* fusion) {
+  HloComputation* computation = fusion->parent();
+  HloComputation* unfused = computation->parent()->AddEmbeddedComputation(
+      fusion->fused_instructions_computation()->Clone("unfused"));
+  HloInstruction* call = computation->AddInstruction(HloInstruction::CreateCall(
+      fusion->shape(), fusion->operands(), unfused));
+  TF_RETURN_IF_ERROR(computation->ReplaceInstruction(fusion, call));
+  return CallInliner::Inline(call).status();
+}
+
+}  // namespace
+
+StatusOr<bool> FusionAutotuner::Run(HloModule* module) {
+  XLA_SCOPED_LOGGING_TIMER("FusionAutotuner");
+
+  const DebugOptions& debug_options = module->config().debug_options();
+  const int max_fusions = debug_options.xla_gpu_autotune_max_fusions();
+  if (max_fusions <= 0 || debug_options.xla_gpu_autotune_level() == 0) {
+    VLOG(2) << "Fusion auto-tuning disabled, FusionAutotuner returning early";
+    return false;
+  }
+
+  std::vector<HloInstruction*> fusions;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    for (HloInstruction* instr : computation->instructions()) {
+      if (IsAutotunable(*instr)) {
+        fusions.push_back(instr);
+      }
+    }
+  }
+  absl::c_stable_sort(fusions, [](const HloInstruction* a,
+                                  const HloInstruction* b) {
+    return BytesAccessed(*a) > BytesAccessed(*b);
+  });
+  if (fusions.size() > max_fusions) {
+    fusions.resize(max_fusions);
+  }
+
+  se::DeviceMemoryAllocator* allocator = allocator_;
+  if (allocator == nullptr) {
+    allocator = stream_exec_->GetAllocator();
+  }
+  TF_ASSIGN_OR_RETURN(se::Stream* const stream,
+                      allocator->GetStream(stream_exec_->device_ordinal()));
+
+  bool changed = false;
+  for (HloInstruction* fusion : fusions) {
+    StatusOr<FusionTimes> times_or =
+        AutotuneFusion(*fusion, compile_, stream, allocator);
+    if (!times_or.ok()) {
+      LOG(WARNING) << "Failed to autotune " << fusion->name()
+                   << ", keeping it fused: " << times_or.status();
+      continue;
+    }
+    const FusionTimes& times = times_or.ValueOrDie();
+    VLOG(2) << fusion->name() << " takes " << times.fused_ns
+            << "ns fused and " << times.unfused_ns << "ns unfused";
+    if (times.unfused_ns * kMinUnfusedSpeedup < times.fused_ns) {
+      VLOG(1) << "Unfusing " << fusion->name();
+      TF_RETURN_IF_ERROR(Unfuse(fusion));
+    } else {
+      FusionBackendConfig config;
+      config.set_autotuned_fused_time_ns(times.fused_ns);
+      config.set_autotuned_unfused_time_ns(times.unfused_ns);
+      TF_RETURN_IF_ERROR(fusion->set_backend_config(config));
+    }
+    changed = true;
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,66 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_AUTOTUNER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_AUTOTUNER_H_
+
+#include <functional>
+#include <memory>
+
+#include "tensorflow/compiler/xla/service/executable.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/stream_executor/device_memory_allocator.h"
+
+namespace xla {
+namespace gpu {
+
+// Benchmarks the largest fusions on the device, both as they are and with
+// their instructions unfused, and unfuses those that run faster unfused, e.g.
+// because fusing duplicated an expensive producer into many consumers.
+//
+// At most --xla_gpu_autotune_max_fusions fusions are benchmarked, ordered by
+// the bytes they read and write. The timings are cached per device and per
+// fusion, and recorded in the FusionBackendConfig of the fusions that are
+// kept, so they show in HLO dumps and execution profiles.
+class FusionAutotuner : public HloModulePass {
+ public:
+  // Compiles a module, which has already been through the HLO passes, to an
+  // executable that runs on `stream_exec`.
+  using CompileFn = std::function<StatusOr<std::unique_ptr<Executable>>(
+      std::unique_ptr<HloModule>)>;
+
+  FusionAutotuner(se::StreamExecutor* stream_exec,
+                  se::DeviceMemoryAllocator* allocator, CompileFn compile)
+      : stream_exec_(stream_exec),
+        allocator_(allocator),
+        compile_(std::move(compile)) {}
+
+  absl::string_view name() const override { return "fusion-autotuner"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  se::StreamExecutor* stream_exec_;
+  se::DeviceMemoryAllocator* allocator_;
+  CompileFn compile_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_AUTOTUNER_H_
@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gather_expander.h"
 #include "tensorflow/compiler/xla/service/gpu/alias_passthrough_params.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_batchnorm_rewriter.h"
+#include "tensorflow/compiler/xla/service/gpu/fusion_autotuner.h"
 #include "tensorflow/compiler/xla/service/gpu/fusion_merger.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
@@ -58,6 +59,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_sanitize_constant_names.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_scatter_expander.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offloader.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_context.h"
@@ -300,6 +302,22 @@ Status GpuCompiler::OptimizeHloModule(
     fusion.AddPass<HloDCE>();
     TF_RETURN_IF_ERROR(fusion.Run(hlo_module).status());
 
+    // Check the fusion decisions for the largest fusions on the device, which
+    // needs a device to run on.
+    if (stream_exec != nullptr) {
+      HloPassPipeline fusion_autotuning("fusion_autotuning");
+      fusion_autotuning.AddPass<FusionAutotuner>(
+          stream_exec, device_allocator,
+          [&](std::unique_ptr<HloModule> module)
+              -> StatusOr<std::unique_ptr<Executable>> {
+            TF_RETURN_IF_ERROR(PrepareHloModuleForIrEmitting(module.get()));
+            return RunBackend(std::move(module), stream_exec,
+                              device_allocator);
+          });
+      fusion_autotuning.AddPass<HloDCE>();
+      TF_RETURN_IF_ERROR(fusion_autotuning.Run(hlo_module).status());
+    }
+
     HloPassPipeline horizontal_fusion("horizontal_fusion");
     horizontal_fusion.AddPass<GpuHorizontalFusion>();
     horizontal_fusion.AddPass<HloCSE>(/*is_layout_sensitive=*/true,
@@ -489,6 +507,11 @@ static Status CompileModuleToLlvmIrImpl(
   (*llvm_module)->setTargetTriple(target_triple);
   (*llvm_module)->setDataLayout(data_layout);
 
+  TF_RETURN_IF_ERROR(
+      HostMemoryOffloader(pointer_size, can_share_buffer_function)
+          .Run(hlo_module)
+          .status());
+
   std::unique_ptr<StreamAssignment> stream_assignment =
       AssignStreams(*hlo_module);
   TF_ASSIGN_OR_RETURN(
@@ -31,6 +31,10 @@ extern const int64 kXlaAllocatedBufferAlignBytes;
 // Minimum alignment for constant buffers.
 extern const int64 kConstantBufferAlignBytes;
 
+// The memory space, and buffer color, of the temp buffers that are offloaded
+// to pinned host memory. Memory space 0 is device memory.
+extern const int64 kHostMemorySpace;
+
 }  // namespace gpu
 }  // namespace xla
 
@@ -90,6 +90,27 @@ GpuExecutable::~GpuExecutable() {
       CHECK(pair.first->SynchronizeAllActivity());
     }
   }
+
+  // Host buffers still in use are returned to the pool by host callbacks, so
+  // wait for those before freeing the pool.
+  std::set<se::StreamExecutor*> host_buffer_executors;
+  {
+    tensorflow::mutex_lock lock(host_buffers_mutex_);
+    for (const auto& pair : free_host_buffers_) {
+      host_buffer_executors.insert(pair.first.first);
+    }
+  }
+  for (se::StreamExecutor* executor : host_buffer_executors) {
+    CHECK(executor->SynchronizeAllActivity());
+  }
+  {
+    tensorflow::mutex_lock lock(host_buffers_mutex_);
+    for (const auto& pair : free_host_buffers_) {
+      for (void* buffer : pair.second) {
+        pair.first.first->HostMemoryDeallocate(buffer);
+      }
+    }
+  }
 }
 
 Status GpuExecutable::CheckCompatibilityWithServiceExecutableRunOptions(
@@ -385,6 +406,12 @@ StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
   buffers.reserve(num_buffers);
   for (int64 i = 0; i < num_buffers; ++i) {
     const BufferAllocation& allocation = assignment_->GetAllocation(i);
+    if (allocation.color() == kHostMemorySpace) {
+      TF_ASSIGN_OR_RETURN(se::DeviceMemoryBase buffer,
+                          AcquireHostBuffer(allocation, executor));
+      buffers.push_back(buffer);
+      continue;
+    }
     TF_ASSIGN_OR_RETURN(
         se::DeviceMemoryBase buffer,
         BufferForAllocation(arguments, globals, allocation, memory_allocator,
@@ -395,6 +422,57 @@ StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
   return {{buffers, executor->device_ordinal(), memory_allocator}};
 }
 
+StatusOr<se::DeviceMemoryBase> GpuExecutable::AcquireHostBuffer(
+    const BufferAllocation& allocation, se::StreamExecutor* executor) {
+  // HostMemoryOffloader only moves temporaries to host memory; parameters and
+  // outputs always stay on the device.
+  TF_RET_CHECK(allocation.IsPreallocatedTempBuffer())
+      << "Only temp buffers can live in host memory: "
+      << allocation.ToString();
+  {
+    tensorflow::mutex_lock lock(host_buffers_mutex_);
+    std::vector<void*>& free_buffers =
+        free_host_buffers_[{executor, allocation.index()}];
+    if (!free_buffers.empty()) {
+      void* buffer = free_buffers.back();
+      free_buffers.pop_back();
+      return se::DeviceMemoryBase(buffer, allocation.size());
+    }
+  }
+  // Pinned host memory is mapped into the device's address space, so kernels
+  // access it directly over the interconnect.
+  void* buffer = executor->HostMemoryAllocate(allocation.size());
+  if (buffer == nullptr) {
+    return ResourceExhausted(
+        "Failed to allocate %d bytes of pinned host memory for allocation %d",
+        allocation.size(), allocation.index());
+  }
+  return se::DeviceMemoryBase(buffer, allocation.size());
+}
+
+void GpuExecutable::ReleaseHostBuffers(
+    const BufferAllocations& buffer_allocations, se::Stream* stream) {
+  std::vector<std::pair<BufferAllocation::Index, void*>> host_buffers;
+  for (const BufferAllocation& allocation : assignment_->Allocations()) {
+    if (allocation.color() == kHostMemorySpace) {
+      host_buffers.emplace_back(
+          allocation.index(),
+          buffer_allocations.GetDeviceAddress(allocation.index()).opaque());
+    }
+  }
+  if (host_buffers.empty()) {
+    return;
+  }
+  se::StreamExecutor* executor = stream->parent();
+  stream->ThenDoHostCallback([this, executor, host_buffers]() {
+    tensorflow::mutex_lock lock(host_buffers_mutex_);
+    for (const auto& host_buffer : host_buffers) {
+      free_host_buffers_[{executor, host_buffer.first}].push_back(
+          host_buffer.second);
+    }
+  });
+}
+
 // Returns `true` if the entire tuple contents is aliased.
 static bool EntireTupleContentsAliased(
     const Shape& output_shape, const ShapeIndex& index,
@@ -553,6 +631,7 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStream(
   TF_RETURN_IF_ERROR(ExecuteThunks(run_options, buffer_allocations,
                                    block_host_until_done,
                                    hlo_execution_profile));
+  ReleaseHostBuffers(buffer_allocations, run_options->stream());
 
   // Free all temporary allocations.
   TF_RETURN_IF_ERROR(
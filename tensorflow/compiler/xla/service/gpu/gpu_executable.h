@@ -133,6 +133,17 @@ class GpuExecutable : public Executable {
       se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
       int64 arg_idx);
 
+  // Returns a pinned host buffer for an allocation that HostMemoryOffloader
+  // placed in host memory. The buffer must be handed back to
+  // ReleaseHostBuffers once the computation using it has run.
+  StatusOr<se::DeviceMemoryBase> AcquireHostBuffer(
+      const BufferAllocation& allocation, se::StreamExecutor* executor);
+
+  // Returns the host buffers in `buffer_allocations` to the pool once the work
+  // enqueued on `stream` so far is done.
+  void ReleaseHostBuffers(const BufferAllocations& buffer_allocations,
+                          se::Stream* stream);
+
   // The LLVM IR, in string format, of the unoptimized module generated for
   // this GpuExecutable. We save a string instead of an llvm::Module* because
   // leaving llvm::Module* in a singleton can cause the heap checker to emit
@@ -169,6 +180,14 @@ class GpuExecutable : public Executable {
   std::map<stream_executor::StreamExecutor*, BufferAllocToDeviceMemoryMap>
       module_globals_ TF_GUARDED_BY(module_handle_mutex_);
 
+  // Free pinned host buffers for the allocations in host memory, keyed by
+  // executor and allocation index. They are kept across runs, as pinning host
+  // memory is much slower than allocating device memory.
+  tensorflow::mutex host_buffers_mutex_;
+  std::map<std::pair<stream_executor::StreamExecutor*, BufferAllocation::Index>,
+           std::vector<void*>>
+      free_host_buffers_ TF_GUARDED_BY(host_buffers_mutex_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(GpuExecutable);
 };
 
@@ -196,7 +196,12 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
 
   // Initialize thunk_launch_order_, the total order of thunk launches.
   HloComputation* entry_computation = module.entry_computation();
-  if (stream_assignment.StreamCount() == 1) {
+  if (module.has_schedule()) {
+    // Keep the schedule that passes like memory space assignment already
+    // relied on, e.g. to overlap asynchronous copies with computation.
+    schedule->thunk_launch_order_ =
+        module.schedule().sequence(entry_computation).instructions();
+  } else if (stream_assignment.StreamCount() == 1) {
     // All kernels are launched on a single stream, so there's no loss of
     // concurrency by optimizing for minimal memory usage.
     TF_ASSIGN_OR_RETURN(
@@ -39,7 +39,8 @@ namespace gpu {
 class GpuHloSchedule {
  public:
   // Constructs an GpuHloSchedule for the given module, based on the given
-  // stream assignment.
+  // stream assignment. If the module already has a schedule, the thunks are
+  // launched in its order.
   static StatusOr<std::unique_ptr<GpuHloSchedule>> Build(
       const HloModule& module, const StreamAssignment& stream_assignment,
       int64 pointer_size);
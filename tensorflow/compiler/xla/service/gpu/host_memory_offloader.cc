@@ -0,0 +1,90 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offloader.h"
+
+#include <memory>
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_alias_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_live_range.h"
+#include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
+#include "tensorflow/compiler/xla/service/memory_space_assignment.h"
+#include "tensorflow/compiler/xla/service/memory_space_propagation.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Bounds on the number of instructions that a copy between device and host
+// memory overlaps with. Copies over PCIe are slow, so they may start long
+// before the buffer is used.
+constexpr int64 kMinOverlapCount = 2;
+constexpr int64 kMaxOverlapCount = 64;
+
+}  // namespace
+
+StatusOr<bool> HostMemoryOffloader::Run(HloModule* module) {
+  const int64 max_bytes =
+      module->config().debug_options().xla_gpu_host_memory_offload_bytes();
+  if (max_bytes <= 0) {
+    return false;
+  }
+
+  const int64 pointer_size = pointer_size_;
+  auto size_fn = [pointer_size](const BufferValue& buffer) {
+    return ShapeUtil::ByteSizeOf(buffer.shape(), pointer_size);
+  };
+  if (!module->has_schedule()) {
+    TF_ASSIGN_OR_RETURN(HloSchedule schedule, ScheduleModule(module, size_fn));
+    TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
+  }
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloAliasAnalysis> alias_analysis,
+                      HloAliasAnalysis::Run(module, can_share_buffer_));
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<HloLiveRange> hlo_live_range,
+      HloLiveRange::Run(module->schedule(), *alias_analysis,
+                        module->entry_computation()));
+
+  InstructionCountPrefetchIntervalPicker prefetch_interval_picker(
+      kMinOverlapCount, kMaxOverlapCount);
+  MemorySpaceAssignment::Options options;
+  options.alternate_memory_space = kHostMemorySpace;
+  options.max_size_in_bytes = max_bytes;
+  options.alignment_in_bytes = kXlaAllocatedBufferAlignBytes;
+  options.prefetch_interval_picker = &prefetch_interval_picker;
+  options.size_fn = size_fn;
+  options.is_allowed_in_alternate_mem_fn = [](const HloValue&) {
+    return true;
+  };
+  // The parameters and outputs of the entry computation stay in device
+  // memory, so only temp buffers are offloaded.
+  options.enable_cross_program_prefetch = false;
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<PresetAssignments> preset_assignments,
+                      MemorySpaceAssignment::Run(module, *hlo_live_range,
+                                                 *alias_analysis, options));
+  VLOG(1) << "Placed " << preset_assignments->chunks().size()
+          << " positions in host memory";
+
+  // Make the fused computations agree with the memory spaces of the operands
+  // and outputs of their fusions.
+  TF_RETURN_IF_ERROR(MemorySpacePropagation().Run(module).status());
+  return true;
+}
+
+}  // namespace gpu
+}  // namespace xla
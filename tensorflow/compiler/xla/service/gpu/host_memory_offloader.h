@@ -0,0 +1,59 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOADER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOADER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_dataflow_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Offloads temp buffers to pinned host memory, so that models whose
+// temporaries don't fit in device memory can still run.
+//
+// This runs memory space assignment with pinned host memory, kHostMemorySpace,
+// as the alternate memory space, limited to xla_gpu_host_memory_offload_bytes.
+// Memory space assignment sets the memory space of the buffers it places in
+// host memory, and moves them between device and host memory with
+// copy-start/copy-done pairs, which are scheduled to overlap with computation
+// and run on a stream of their own. Kernels access the buffers left in host
+// memory through unified addressing.
+//
+// The pass schedules the module if it isn't scheduled yet, and the thunks are
+// then launched in that order. It does nothing if
+// xla_gpu_host_memory_offload_bytes is not positive.
+class HostMemoryOffloader : public HloModulePass {
+ public:
+  HostMemoryOffloader(int64 pointer_size,
+                      HloDataflowAnalysis::CanShareBuffer can_share_buffer)
+      : pointer_size_(pointer_size),
+        can_share_buffer_(std::move(can_share_buffer)) {}
+
+  absl::string_view name() const override { return "host-memory-offloader"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const int64 pointer_size_;
+  const HloDataflowAnalysis::CanShareBuffer can_share_buffer_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOADER_H_
@@ -0,0 +1,99 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offloader.h"
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class HostMemoryOffloaderTest : public HloTestBase {
+ protected:
+  HloModuleConfig ConfigWithBudget(int64 max_bytes) {
+    HloModuleConfig config;
+    DebugOptions debug_options = GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_host_memory_offload_bytes(max_bytes);
+    config.set_debug_options(debug_options);
+    return config;
+  }
+
+  StatusOr<bool> RunOffloader(HloModule* module) {
+    return HostMemoryOffloader(/*pointer_size=*/8,
+                               /*can_share_buffer=*/nullptr)
+        .Run(module);
+  }
+};
+
+// `early` is computed first and only used by the root, so it is idle while
+// the chain of negates runs.
+const char* const kHloString = R"(
+HloModule Module
+
+ENTRY entry {
+  p0 = f32[1024]{0} parameter(0)
+  early = f32[1024]{0} exponential(p0)
+  n0 = f32[1024]{0} negate(p0)
+  n1 = f32[1024]{0} negate(n0)
+  n2 = f32[1024]{0} negate(n1)
+  n3 = f32[1024]{0} negate(n2)
+  n4 = f32[1024]{0} negate(n3)
+  n5 = f32[1024]{0} negate(n4)
+  ROOT add = f32[1024]{0} add(early, n5)
+}
+)";
+
+TEST_F(HostMemoryOffloaderTest, DisabledByDefault) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module,
+      ParseAndReturnVerifiedModule(kHloString, ConfigWithBudget(0)));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunOffloader(module.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_FALSE(module->has_schedule());
+}
+
+TEST_F(HostMemoryOffloaderTest, OffloadsTempsOnly) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module,
+      ParseAndReturnVerifiedModule(kHloString, ConfigWithBudget(1 << 20)));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunOffloader(module.get()));
+  EXPECT_TRUE(changed);
+
+  HloComputation* entry = module->entry_computation();
+  int64 num_offloaded = 0;
+  for (const HloInstruction* instruction : entry->instructions()) {
+    ShapeUtil::ForEachSubshape(
+        instruction->shape(),
+        [&](const Shape& subshape, const ShapeIndex& /*index*/) {
+          if (subshape.has_layout() &&
+              subshape.layout().memory_space() == kHostMemorySpace) {
+            ++num_offloaded;
+          }
+        });
+  }
+  EXPECT_GT(num_offloaded, 0);
+  EXPECT_NE(entry->parameter_instruction(0)->shape().layout().memory_space(),
+            kHostMemorySpace);
+  EXPECT_NE(entry->root_instruction()->shape().layout().memory_space(),
+            kHostMemorySpace);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -755,6 +755,30 @@ Status IrEmitterUnnested::HandleCopy(HloInstruction* copy) {
   return IrEmitter::HandleCopy(copy);
 }
 
+Status IrEmitterUnnested::HandleCopyStart(HloInstruction* copy_start) {
+  // The copy between device and host memory is issued on the stream of the
+  // copy-start, and the tuple buffer of the copy-start is never read.
+  const HloInstruction* operand = copy_start->operand(0);
+  TF_RET_CHECK(Layout::Equal().IgnoreMemorySpace()(
+      operand->shape().layout(), copy_start->shape().tuple_shapes(0).layout()));
+  AddThunkToThunkSequence(absl::make_unique<DeviceToDeviceCopyThunk>(
+      GetThunkInfo(copy_start),
+      /*source_address=*/GetAllocationSlice(*operand),
+      /*destination_buffer=*/GetAllocationSlice(*copy_start, {0}),
+      /*mem_size=*/ByteSizeOf(operand->shape())));
+  return Status::OK();
+}
+
+Status IrEmitterUnnested::HandleCopyDone(HloInstruction* copy_done) {
+  // The copy-done aliases the destination of its copy-start, so there is
+  // nothing to compute. It still needs a thunk, though: the thunk schedule
+  // makes it wait for the copy, which keeps the thunks after it on its stream
+  // from reusing the memory of the source before the copy is done.
+  AddThunkToThunkSequence(absl::make_unique<SequentialThunk>(
+      GetThunkInfo(copy_done), std::vector<std::unique_ptr<Thunk>>()));
+  return Status::OK();
+}
+
 Status IrEmitterUnnested::EmitExtraOutputsForReduce(
     const HloInstruction* unnested_hlo, const IrArray::Index& index,
     bool use_linear_index,
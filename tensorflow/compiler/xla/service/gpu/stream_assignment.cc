@@ -73,6 +73,13 @@ int ComputeStreamToAssign(
     return kInvalidStreamNum;
   }
 
+  if (hlo.opcode() == HloOpcode::kCopyDone) {
+    // The copy runs on the stream of its copy-start. Its copy-done only waits
+    // for it, and stays on the main stream, so that its users don't follow the
+    // copy-start to the copy stream.
+    return 0;
+  }
+
   const auto& debug_options = hlo.GetModule()->config().debug_options();
   if (debug_options.xla_gpu_disable_multi_streaming()) {
     return 0;
@@ -137,7 +144,15 @@ std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
   // TODO(b/111791052): If we remove such a common variable, we will need to
   // clean up the code here.
   int stream_num_for_rng = kInvalidStreamNum;
+  // Asynchronous copies, inserted by memory space assignment, run on a stream
+  // of their own, so that they overlap with the computation even when
+  // multi-streaming is disabled.
+  std::vector<const HloInstruction*> copy_starts;
   for (const auto* hlo : computation.MakeInstructionPostOrder()) {
+    if (hlo->opcode() == HloOpcode::kCopyStart) {
+      copy_starts.push_back(hlo);
+      continue;
+    }
     // If we ever enable fusion of RNG instructions, we will need to extend this
     // code to look inside a fused instruction.
     int stream_num = (hlo->opcode() == HloOpcode::kRng &&
@@ -156,6 +171,10 @@ std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
       seen_gemms.push_back(hlo);
     }
   }
+  const int copy_stream_num = stream_assignment->StreamCount();
+  for (const auto* copy_start : copy_starts) {
+    stream_assignment->AssignStreamToHlo(copy_start, copy_stream_num);
+  }
   return stream_assignment;
 }
 
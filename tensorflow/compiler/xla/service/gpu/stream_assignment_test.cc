@@ -139,5 +139,33 @@ TEST_F(StreamAssignmentTest, LatticeMatMul) {
             assignment->StreamNumberForHlo(*d31));
 }
 
+TEST_F(StreamAssignmentTest, CopyStartOnCopyStream) {
+  // Multi-streaming is disabled by default, but the asynchronous copies still
+  // get a stream of their own.
+  const char* const hlo_string = R"(
+  HloModule Module
+
+  ENTRY entry {
+    p0 = f32[2,2]{1,0} parameter(0)
+    negate = f32[2,2]{1,0} negate(p0)
+    copy-start = (f32[2,2]{1,0:S(1)}, f32[2,2]{1,0}, u32[]) copy-start(negate)
+    exponential = f32[2,2]{1,0} exponential(negate)
+    copy-done = f32[2,2]{1,0:S(1)} copy-done(copy-start)
+    ROOT add = f32[2,2]{1,0} add(exponential, copy-done)
+  }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  HloComputation* entry = module->entry_computation();
+  const HloInstruction* copy_start =
+      entry->GetInstructionWithName("copy-start");
+  const HloInstruction* copy_done = entry->GetInstructionWithName("copy-done");
+  EXPECT_EQ(assignment->StreamCount(), 2);
+  EXPECT_EQ(assignment->StreamNumberForHlo(*copy_start), 1);
+  EXPECT_EQ(assignment->StreamNumberForHlo(*copy_done), 0);
+  EXPECT_EQ(assignment->StreamNumberForHlo(*entry->root_instruction()), 0);
+}
+
 }  // namespace gpu
 }  // namespace xla
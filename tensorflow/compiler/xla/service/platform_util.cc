@@ -178,6 +178,11 @@ PlatformUtil::GetStreamExecutors(
     // across multiple devices.
     device_count =
         GetDebugOptionsFromFlags().xla_force_host_platform_device_count();
+    // Host devices are only logical, so any that are explicitly allowed can
+    // be created.
+    if (allowed_devices && !allowed_devices->empty()) {
+      device_count = std::max(device_count, *allowed_devices->rbegin() + 1);
+    }
   }
   std::vector<se::StreamExecutor*> stream_executors(device_count, nullptr);
   VLOG(1) << "Initializing devices";
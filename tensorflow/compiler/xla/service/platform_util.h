@@ -51,7 +51,8 @@ class PlatformUtil {
   // Returns a vector of StreamExecutors for the given platform.
   // If populated, only the devices in allowed_devices will have
   // their StreamExecutors initialized, otherwise all StreamExecutors will be
-  // initialized and returned.
+  // initialized and returned. On the host platform, the devices in
+  // allowed_devices are created even if there are fewer host devices.
   //
   // If the platform has no visible devices, a not-found error is returned.
   static StatusOr<std::vector<se::StreamExecutor*>> GetStreamExecutors(
@@ -40,10 +40,11 @@ constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
-                           bool garbage_collection)
+                           bool garbage_collection, bool small_allocation_cache)
     : garbage_collection_(garbage_collection),
       sub_allocator_(sub_allocator),
       name_(name),
+      small_allocation_cache_(small_allocation_cache),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1) {
   if (allow_growth) {
@@ -76,6 +77,11 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  if (small_allocation_cache_) {
+    cache_shards_.reset(new CacheShard[kNumCacheShards]);
+    live_shards_.reset(new LiveShard[kNumCacheShards]);
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -210,6 +216,10 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   }
   void* r =
       AllocateRawInternal(unused_alignment, num_bytes, false, freed_by_count);
+  if (r == nullptr && FlushCaches()) {
+    r = AllocateRawInternal(unused_alignment, num_bytes, false,
+                            freed_by_count);
+  }
   if (r != nullptr) {
     return r;
   } else {
@@ -230,6 +240,14 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  // Chunks in the caches carry no free time, so they must not be handed to
+  // callers that depend on one.
+  if (small_allocation_cache_ && num_bytes > 0 &&
+      num_bytes <= kMaxCachedAllocationSize && timing_counter_ == nullptr &&
+      allocation_attr.freed_by_func == nullptr) {
+    void* ptr = AllocateCached(RoundedBytes(num_bytes));
+    if (ptr != nullptr) return ptr;
+  }
   if (!allocation_attr.retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -240,6 +258,10 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
     }
     void* result = AllocateRawInternal(unused_alignment, num_bytes,
                                        dump_log_on_failure, freed_by_count);
+    if (result == nullptr && FlushCaches()) {
+      result = AllocateRawInternal(unused_alignment, num_bytes,
+                                   dump_log_on_failure, freed_by_count);
+    }
     if (result == nullptr) {
       static std::atomic<int32> log_counter{0};
       int32 counter_value = log_counter.load(std::memory_order_relaxed);
@@ -615,12 +637,145 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 }
 
 void BFCAllocator::DeallocateRaw(void* ptr) {
+  if (small_allocation_cache_ && ptr != nullptr && DeallocateCached(ptr)) {
+    VLOG(1) << "DeallocateRaw " << Name() << " " << ptr << " to cache";
+    return;
+  }
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
 
+namespace {
+
+// Spreads threads over the cache shards round-robin.
+int ThreadCacheShard() {
+  static std::atomic<int> next_shard{0};
+  thread_local int shard = next_shard.fetch_add(1, std::memory_order_relaxed);
+  return shard;
+}
+
+}  // namespace
+
+void* BFCAllocator::AllocateCached(size_t rounded_bytes) {
+  void* ptr;
+  {
+    CacheShard& shard = cache_shards_[ThreadCacheShard() % kNumCacheShards];
+    mutex_lock l(shard.mu);
+    std::vector<void*>& free_chunks =
+        shard.free_chunks[rounded_bytes / kMinAllocationSize - 1];
+    if (free_chunks.empty()) {
+      mutex_lock bl(lock_);
+      RefillCache(rounded_bytes, &free_chunks);
+      if (free_chunks.empty()) return nullptr;
+    }
+    ptr = free_chunks.back();
+    free_chunks.pop_back();
+  }
+  cached_bytes_.fetch_sub(rounded_bytes, std::memory_order_relaxed);
+  num_cached_allocs_.fetch_add(1, std::memory_order_relaxed);
+  LiveShard& live = live_shards_[(reinterpret_cast<uintptr_t>(ptr) >>
+                                  kMinAllocationBits) %
+                                 kNumCacheShards];
+  mutex_lock l(live.mu);
+  live.sizes[ptr] = rounded_bytes;
+  return ptr;
+}
+
+bool BFCAllocator::DeallocateCached(void* ptr) {
+  size_t rounded_bytes;
+  {
+    LiveShard& live = live_shards_[(reinterpret_cast<uintptr_t>(ptr) >>
+                                    kMinAllocationBits) %
+                                   kNumCacheShards];
+    mutex_lock l(live.mu);
+    auto it = live.sizes.find(ptr);
+    if (it == live.sizes.end()) return false;
+    rounded_bytes = it->second;
+    live.sizes.erase(it);
+  }
+  if (timing_counter_ != nullptr) {
+    // The chunk was handed out before the timing counter was set; it must
+    // get a free time like any other chunk from now on.
+    DeallocateRawInternal(ptr);
+    retry_helper_.NotifyDealloc();
+    return true;
+  }
+  cached_bytes_.fetch_add(rounded_bytes, std::memory_order_relaxed);
+  CacheShard& shard = cache_shards_[ThreadCacheShard() % kNumCacheShards];
+  mutex_lock l(shard.mu);
+  std::vector<void*>& free_chunks =
+      shard.free_chunks[rounded_bytes / kMinAllocationSize - 1];
+  free_chunks.push_back(ptr);
+  if (free_chunks.size() > 2 * kCacheBatchSize) {
+    // Return the oldest half of the cache to the bins in one batch.
+    {
+      mutex_lock bl(lock_);
+      for (int i = 0; i < kCacheBatchSize; ++i) {
+        ReleaseCachedChunk(free_chunks[i]);
+      }
+    }
+    free_chunks.erase(free_chunks.begin(),
+                      free_chunks.begin() + kCacheBatchSize);
+    cached_bytes_.fetch_sub(kCacheBatchSize * rounded_bytes,
+                            std::memory_order_relaxed);
+    retry_helper_.NotifyDealloc();
+  }
+  return true;
+}
+
+void BFCAllocator::RefillCache(size_t rounded_bytes,
+                               std::vector<void*>* free_chunks) {
+  const BinNum bin_num = BinNumForSize(rounded_bytes);
+  for (int i = 0; i < kCacheBatchSize; ++i) {
+    void* ptr = FindChunkPtr(bin_num, rounded_bytes, rounded_bytes, 0);
+    if (ptr == nullptr) {
+      // Leave growing the allocator and handling out-of-memory to the
+      // uncached path.
+      break;
+    }
+    // The chunk is counted as allocated once it leaves the cache.
+    --stats_.num_allocs;
+    cached_bytes_.fetch_add(rounded_bytes, std::memory_order_relaxed);
+    free_chunks->push_back(ptr);
+  }
+}
+
+void BFCAllocator::ReleaseCachedChunk(void* ptr) {
+  BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
+  CHECK(h != kInvalidChunkHandle);
+  MarkFree(h);
+  if (timing_counter_) {
+    InsertFreeChunkIntoBin(h);
+    timestamped_chunks_.push_back(h);
+  } else {
+    InsertFreeChunkIntoBin(TryToCoalesce(h, false));
+  }
+}
+
+bool BFCAllocator::FlushCaches() {
+  if (!small_allocation_cache_) return false;
+  bool flushed = false;
+  for (int s = 0; s < kNumCacheShards; ++s) {
+    CacheShard& shard = cache_shards_[s];
+    mutex_lock l(shard.mu);
+    mutex_lock bl(lock_);
+    for (int c = 0; c < kNumCachedSizes; ++c) {
+      std::vector<void*>& free_chunks = shard.free_chunks[c];
+      const size_t rounded_bytes = (c + 1) * kMinAllocationSize;
+      for (void* ptr : free_chunks) {
+        ReleaseCachedChunk(ptr);
+      }
+      cached_bytes_.fetch_sub(free_chunks.size() * rounded_bytes,
+                              std::memory_order_relaxed);
+      flushed |= !free_chunks.empty();
+      free_chunks.clear();
+    }
+  }
+  return flushed;
+}
+
 void BFCAllocator::DeallocateRawInternal(void* ptr) {
   if (ptr == nullptr) {
     VLOG(2) << "tried to deallocate nullptr";
@@ -1141,11 +1296,16 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  // Chunks in the caches are in use as far as the bins are concerned.
+  stats.bytes_in_use -= cached_bytes_.load(std::memory_order_relaxed);
+  stats.num_allocs += num_cached_allocs_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
+  num_cached_allocs_.store(0, std::memory_order_relaxed);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
@@ -23,6 +23,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -49,9 +50,16 @@ class MemoryDump;
 class BFCAllocator : public Allocator {
  public:
   // Takes ownership of sub_allocator.
+  //
+  // If `small_allocation_cache` is true, freed chunks of up to
+  // kMaxCachedAllocationSize bytes are kept in sharded caches that
+  // AllocateRaw and DeallocateRaw serve without taking the allocator-wide
+  // lock.  Allocations served from a cache report their rounded size as
+  // RequestedSize, and cached chunks count towards peak_bytes_in_use.
   BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                bool allow_growth, const string& name,
-               bool garbage_collection = false);
+               bool garbage_collection = false,
+               bool small_allocation_cache = false);
   ~BFCAllocator() override;
 
   string Name() override { return name_; }
@@ -466,6 +474,47 @@ class BFCAllocator : public Allocator {
     size_t total_chunks_in_bin = 0;
   };
 
+  // The small allocation cache.  Chunks in a cache stay in use as far as the
+  // bins are concerned, so the region and bin invariants are unaffected.
+  // Lock order: CacheShard::mu before lock_.
+  static constexpr size_t kMaxCachedAllocationSize = 4096;
+  static constexpr int kNumCachedSizes =
+      kMaxCachedAllocationSize / kMinAllocationSize;
+  static constexpr int kNumCacheShards = 16;
+  // Chunks moved between a cache and the bins per acquisition of lock_.
+  static constexpr int kCacheBatchSize = 16;
+
+  struct CacheShard {
+    mutex mu;
+    // Free chunks, indexed by size / kMinAllocationSize - 1.
+    std::vector<void*> free_chunks[kNumCachedSizes] TF_GUARDED_BY(mu);
+  };
+
+  // Chunks handed out from a cache, sharded by address.
+  struct LiveShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, size_t> sizes TF_GUARDED_BY(mu);
+  };
+
+  // Returns nullptr if the cache of the calling thread has no chunk of
+  // `rounded_bytes` and none could be moved into it.
+  void* AllocateCached(size_t rounded_bytes);
+
+  // Returns false if `ptr` was not handed out from a cache.
+  bool DeallocateCached(void* ptr);
+
+  // Moves up to kCacheBatchSize free chunks of `rounded_bytes` from the bins
+  // to `free_chunks`.
+  void RefillCache(size_t rounded_bytes, std::vector<void*>* free_chunks)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns a cached chunk to the bins.
+  void ReleaseCachedChunk(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns every cached chunk to the bins.  Returns false if there were
+  // none.
+  bool FlushCaches() TF_LOCKS_EXCLUDED(lock_);
+
   // Computes and returns a BinDebugInfo for each Bin.
   std::array<BinDebugInfo, kNumBins> get_bin_debug_info()
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
@@ -534,6 +583,14 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  const bool small_allocation_cache_;
+  std::unique_ptr<CacheShard[]> cache_shards_;
+  std::unique_ptr<LiveShard[]> live_shards_;
+  // Bytes of the chunks that sit unused in a cache, and the number of
+  // allocations served from a cache since the last ClearStats().
+  std::atomic<int64> cached_bytes_{0};
+  std::atomic<int64> num_cached_allocs_{0};
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -59,13 +60,55 @@ void CollectiveParamResolverLocal::CompleteGroupAsync(
 }
 
 namespace {
+// Returns true if the all-reduce of `cp` spans several tasks with several
+// devices each, which NcclHierarchicalReduce reduces within each task before
+// reducing across tasks, and that implementation is available.
+bool UseHierarchicalReduce(const CollectiveParams* cp) {
+  if (cp->group.num_tasks < 2 || !cp->instance.same_num_devices_per_task ||
+      cp->group.group_size < 2 * cp->group.num_tasks) {
+    return false;
+  }
+  CollectiveImplementationInterface* col_impl;
+  return CollectiveRegistry::LookupParamResolverInstance(
+             "NcclHierarchicalReduce", &col_impl)
+      .ok();
+}
+
+// Returns true if `cp` asks for a sparse all-reduce with the "sparse"
+// communication hint, and RingSparseReduce supports it.
+bool UseSparseReduce(const CollectiveParams* cp) {
+  if (cp->instance.impl_details.communication_hint != "sparse" ||
+      cp->group.device_type.type_string() != DEVICE_CPU ||
+      cp->merge_op == nullptr ||
+      cp->merge_op->type_string() != "Add") {
+    return false;
+  }
+  switch (cp->instance.data_type) {
+    case DT_HALF:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+    case DT_INT32:
+    case DT_INT64:
+      break;
+    default:
+      return false;
+  }
+  CollectiveImplementationInterface* col_impl;
+  return CollectiveRegistry::LookupParamResolverInstance("RingSparseReduce",
+                                                         &col_impl)
+      .ok();
+}
+
 const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
   switch (cp->instance.type) {
     case BROADCAST_COLLECTIVE:
       return "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      if (UseSparseReduce(cp)) return "RingSparseReduce";
+      if (!nccl) return "RingReduce";
+      return UseHierarchicalReduce(cp) ? "NcclHierarchicalReduce"
+                                       : "NcclReduce";
 
     case GATHER_COLLECTIVE:
       return "RingGather";
@@ -502,6 +545,23 @@ void CollectiveParamResolverLocal::InitInstanceSharedParams(
   // GetDeviceAttributesAsync will use those fields to launch RPCs.
   CompleteTaskIsLocal(task_name_, &ir->shared);
 
+  // Reuse the order established for an earlier instance of the group, if any.
+  bool reused_device_order = false;
+  {
+    mutex_lock gl(gr->mu);
+    auto it = gr->device_orders.find(ir->shared.instance.gpu_ring_order);
+    if (it != gr->device_orders.end()) {
+      ir->shared.instance.device_names = it->second.device_names;
+      ir->shared.instance.task_names = it->second.task_names;
+      reused_device_order = true;
+    }
+  }
+  if (reused_device_order) {
+    VLOG(2) << "Reused device order for " << ir->shared.name;
+    done(Status::OK());
+    return;
+  }
+
   // Because the callback may execute in a different thread, we release
   // ir->out_mu here.  Before releasing, we mark it as unavailable for other
   // threads.
@@ -527,6 +587,13 @@ void CollectiveParamResolverLocal::InitInstanceSharedParams(
             ir->out_cv.notify_all();
             if (s.ok()) {
               CompleteDefaultRanking(gr, cp, ir, *attributes);
+              {
+                mutex_lock gl(gr->mu);
+                gr->device_orders.emplace(
+                    ir->shared.instance.gpu_ring_order,
+                    GroupRec::DeviceOrder{ir->shared.instance.device_names,
+                                          ir->shared.instance.task_names});
+              }
               done(Status::OK());
             } else {
               done(s);
@@ -716,6 +783,11 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
   //
   // After enough testing, we may simplify this logic to use NCCL whenever
   // available.
+  //
+  // Reductions across several tasks with several devices each use NCCL
+  // hierarchically, see `UseHierarchicalReduce`. Reductions of mostly zero
+  // tensors on CPU may ask for RingSparseReduce with `communication_hint`,
+  // see `UseSparseReduce`.
   CollectiveImplementationInterface* col_impl;
   bool use_nccl =
       (nccl_ || cp->instance.impl_details.communication_hint == "nccl") &&
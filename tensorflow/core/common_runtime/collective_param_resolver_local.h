@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/framework/collective.h"
@@ -75,6 +76,17 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
     std::set<string> task_set TF_GUARDED_BY(mu);
     std::vector<string> task_list TF_GUARDED_BY(mu);
     std::vector<StatusCallback> waiting TF_GUARDED_BY(mu);
+
+    // The default rank orders of the devices and tasks established for
+    // instances of the group, by gpu_ring_order.  Establishing an order needs
+    // the attributes of all the devices, which may take RPCs, so it is done
+    // once per group rather than once per instance.
+    struct DeviceOrder {
+      std::vector<string> device_names;
+      std::vector<string> task_names;
+    };
+    mutable std::unordered_map<string, DeviceOrder> device_orders
+        TF_GUARDED_BY(mu);
   };
 
   // Finds the GroupRec that corresponds to cp->group_key.
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 
+#include <algorithm>
 #include <atomic>
 
 #include "tensorflow/core/common_runtime/collective_executor_mgr.h"
@@ -86,6 +87,17 @@ class CollectiveParamResolverLocalTest : public ::testing::Test {
     }
   }
 
+  // Reverses the device order cached for the instances of a group.
+  void ReverseCachedDeviceOrder(int32 group_key) {
+    mutex_lock l(prl_->group_mu_);
+    auto& gr = prl_->group_table_[group_key];
+    mutex_lock gl(gr->mu);
+    ASSERT_EQ(gr->device_orders.size(), 1);
+    auto& order = gr->device_orders.begin()->second;
+    std::reverse(order.device_names.begin(), order.device_names.end());
+    std::reverse(order.task_names.begin(), order.task_names.end());
+  }
+
   string task_name_;
   std::unique_ptr<DeviceMgr> device_mgr_;
   std::unique_ptr<DeviceResolverLocal> drl_;
@@ -214,6 +226,61 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
   }
 }
 
+void InitializeCollectiveParamsForReduction(int instance_key, int device_idx,
+                                            CollectiveParams* cp) {
+  cp->group.group_key = 1;
+  cp->group.group_size = 3;
+  cp->group.device_type = DeviceType("CPU");
+  cp->group.num_tasks = 1;
+  cp->instance.instance_key = instance_key;
+  cp->instance.type = REDUCTION_COLLECTIVE;
+  cp->instance.data_type = DataType(DT_FLOAT);
+  cp->instance.shape = TensorShape({5});
+  cp->instance.device_names.push_back(strings::StrCat(
+      "/job:localhost/replica:0/task:0/device:CPU:", device_idx));
+  cp->instance.impl_details.subdiv_offsets.push_back(0);
+  cp->is_source = false;
+}
+
+TEST_F(CollectiveParamResolverLocalTest, ReusesDeviceOrderOfGroup) {
+  for (int instance_key : {7, 8}) {
+    CollectiveParams cps[NUM_DEVS];
+    Status statuses[NUM_DEVS];
+    Notification note[NUM_DEVS];
+    for (int i = 0; i < NUM_DEVS; ++i) {
+      CollectiveParams* cp = &cps[i];
+      InitializeCollectiveParamsForReduction(instance_key, i, cp);
+      Env::Default()->SchedClosure([this, i, cp, &note, &statuses]() {
+        prl_->CompleteParamsAsync(cp->instance.device_names[0], cp,
+                                  nullptr /*CancellationManager*/,
+                                  [&statuses, &note, i](const Status& s) {
+                                    statuses[i] = s;
+                                    note[i].Notify();
+                                  });
+      });
+    }
+    for (int i = 0; i < NUM_DEVS; ++i) {
+      note[i].WaitForNotification();
+    }
+    for (int i = 0; i < NUM_DEVS; ++i) {
+      TF_ASSERT_OK(statuses[i]);
+      ASSERT_EQ(cps[i].instance.device_names.size(), NUM_DEVS);
+      // The second instance gets the order cached for the first, reversed
+      // below, rather than establishing its own.
+      for (int j = 0; j < NUM_DEVS; ++j) {
+        const int device_idx = instance_key == 7 ? j : NUM_DEVS - 1 - j;
+        EXPECT_EQ(strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:",
+                                  device_idx),
+                  cps[i].instance.device_names[j]);
+      }
+      EXPECT_EQ(cps[i].default_rank, instance_key == 7 ? i : NUM_DEVS - 1 - i);
+    }
+    if (instance_key == 7) {
+      ReverseCachedDeviceOrder(/*group_key=*/1);
+    }
+  }
+}
+
 void InitializeCollectiveParamsForBroadcast(int instance_key, int device_idx,
                                             bool is_source,
                                             CollectiveParams* cp) {
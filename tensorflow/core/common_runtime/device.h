@@ -31,6 +31,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -51,6 +52,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class StepArenaAllocator;
+
 class Device : public DeviceBase {
  public:
   // Callback type that takes a Status and returns void.
@@ -151,6 +154,25 @@ class Device : public DeviceBase {
     return Status::OK();
   }
 
+  // Fills in `device_context_map`, indexed by node ID, with a DeviceContext
+  // for each node of `graph` that should run with a context other than the
+  // one returned by TryGetDeviceContext(), e.g. on a different stream.  The
+  // caller sizes the map to `graph->num_node_ids()` and fills it with
+  // nullptr; nodes left as nullptr use the default context.
+  //
+  // The caller takes ownership of one reference on each non-null
+  // DeviceContext* and should call Unref().
+  virtual Status FillContextMap(
+      const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+    return Status::OK();
+  }
+
+  // Returns a new allocator for the temporaries and intermediate outputs of
+  // the kernels run by one executor invocation on this device, or nullptr if
+  // the device does not use one.  The caller calls Release() on it when the
+  // invocation finishes.
+  virtual StepArenaAllocator* NewStepArenaAllocator() { return nullptr; }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -53,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/subgraph.h"
 #include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/grappler/costs/step_stats_costs.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/refcount.h"
@@ -73,6 +75,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
@@ -86,6 +89,12 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+auto* direct_session_executor_cache = monitoring::Counter<1>::New(
+    "/tensorflow/core/direct_session_executor_cache",
+    "The number of lookups of the executors for a DirectSession::Run() "
+    "signature, and of evictions from the cache of executors.",
+    "result");
+
 Status NewThreadPoolFromThreadPoolOptions(
     const SessionOptions& options,
     const ThreadPoolOptionProto& thread_pool_options, int pool_number,
@@ -152,6 +161,83 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// The phases of a step that make up the fixed overhead of Session::Run() and
+// RunCallable(), besides kExecute, which runs the kernels.
+enum class StepPhase {
+  kGetExecutors,   // Looking up the executors for the feeds and fetches.
+  kCallFrame,      // Checking the feeds and setting up the call frame.
+  kRunSetup,       // Debugger, collectives, thread pool and RunHandler.
+  kExecutorArgs,   // Executor arguments, stats and cancellation manager.
+  kExecute,        // Creating the rendezvous and running the executors.
+  kRunFinish,      // Saving tensors, cost model and partition graphs.
+  kFetchOutputs,   // Moving the fetched tensors out of the call frame.
+  kNumPhases,
+};
+
+constexpr const char* kStepPhaseNames[] = {
+    "get_executors", "call_frame", "run_setup",     "executor_args",
+    "execute",       "run_finish", "fetch_outputs",
+};
+
+constexpr const char* kStepPhaseTraceNames[] = {
+    "DirectSession::GetExecutors", "DirectSession::CallFrame",
+    "DirectSession::RunSetup",     "DirectSession::ExecutorArgs",
+    "DirectSession::Execute",      "DirectSession::RunFinish",
+    "DirectSession::FetchOutputs",
+};
+
+// Records the time spent in consecutive phases of a step into the
+// /tensorflow/core/direct_session_phase_time_nanos_histogram metric, and
+// traces each phase as a TraceMe activity when verbose tracing is on.
+class StepPhaseTimer {
+ public:
+  explicit StepPhaseTimer(Env* env) : env_(env) {}
+  ~StepPhaseTimer() { EndTrace(); }
+
+  // Ends the current phase, if any, and starts `phase`.
+  void StartPhase(StepPhase phase) {
+    const uint64 now_nanos = env_->NowNanos();
+    RecordPhase(now_nanos);
+    phase_ = phase;
+    phase_start_nanos_ = now_nanos;
+    activity_id_ = profiler::TraceMe::ActivityStart(
+        kStepPhaseTraceNames[static_cast<int>(phase)],
+        profiler::TraceMeLevel::kVerbose);
+  }
+
+  // Ends the current phase, if any. Phases left by an error are not recorded.
+  void EndPhase() {
+    RecordPhase(env_->NowNanos());
+    phase_ = StepPhase::kNumPhases;
+  }
+
+ private:
+  void RecordPhase(uint64 now_nanos) {
+    if (phase_ == StepPhase::kNumPhases) return;
+    EndTrace();
+    static monitoring::SamplerCell* const* cells = [] {
+      auto* cells = new monitoring::SamplerCell*[static_cast<int>(
+          StepPhase::kNumPhases)];
+      for (int i = 0; i < static_cast<int>(StepPhase::kNumPhases); ++i) {
+        cells[i] = metrics::GetDirectSessionPhaseTimeHistogram(
+            kStepPhaseNames[i]);
+      }
+      return cells;
+    }();
+    cells[static_cast<int>(phase_)]->Add(now_nanos - phase_start_nanos_);
+  }
+
+  void EndTrace() {
+    profiler::TraceMe::ActivityEnd(activity_id_);
+    activity_id_ = 0;
+  }
+
+  Env* const env_;
+  StepPhase phase_ = StepPhase::kNumPhases;
+  uint64 phase_start_nanos_ = 0;
+  uint64 activity_id_ = 0;
+};
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -338,6 +424,13 @@ DirectSession::DirectSession(const SessionOptions& options,
       run_in_caller_thread_ = true;
     }
   }
+  if (options_.config.experimental().run_in_caller_thread()) {
+    run_in_caller_thread_ = true;
+  }
+  executor_cache_capacity_ =
+      std::max(0, options_.config.experimental().executor_cache_capacity());
+  reuse_executors_for_fetch_subsets_ =
+      options_.config.experimental().reuse_executors_for_fetch_subsets();
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
   const Status status =
@@ -382,6 +475,8 @@ DirectSession::~DirectSession() {
   for (auto& it : executors_) {
     it.second.reset();
   }
+  executors_lru_index_.clear();
+  executors_lru_.clear();
   callables_.clear();
   for (auto d : device_mgr_->ListDevices()) {
     d->op_segment()->RemoveHold(session_handle_);
@@ -497,6 +592,8 @@ Status DirectSession::RunInternal(
     RunMetadata* run_metadata,
     const thread::ThreadPoolOptions& threadpool_options) {
   const uint64 start_time_usecs = options_.env->NowMicros();
+  StepPhaseTimer phase_timer(options_.env);
+  phase_timer.StartPhase(StepPhase::kRunSetup);
   const int64 executor_step_count = executors_and_keys->step_count.fetch_add(1);
   RunState run_state(step_id, &devices_);
   const size_t num_executors = executors_and_keys->items.size();
@@ -570,8 +667,15 @@ Status DirectSession::RunInternal(
 
   if (inline_execution_requested) {
     // We allow using the caller thread only when having a single executor
-    // specified.
-    if (executors_and_keys->items.size() > 1) {
+    // specified, or when the session runs every step in the caller thread and
+    // all executors are on CPU devices. The latter make progress from the
+    // callbacks of the intra-process rendezvous, whichever one runs first.
+    bool can_run_all_inline =
+        options_.config.experimental().run_in_caller_thread();
+    for (const auto& item : executors_and_keys->items) {
+      can_run_all_inline &= item.device->device_type() == DEVICE_CPU;
+    }
+    if (executors_and_keys->items.size() > 1 && !can_run_all_inline) {
       pool = thread_pools_[0].first;
     } else {
       VLOG(1) << "Executing Session::Run() synchronously!";
@@ -636,6 +740,7 @@ Status DirectSession::RunInternal(
   const bool can_execute_synchronously =
       executors_and_keys->items.size() == 1 && call_timeout == 0;
 
+  phase_timer.StartPhase(StepPhase::kExecutorArgs);
   Executor::Args args;
   args.step_id = step_id;
   args.call_frame = call_frame;
@@ -664,7 +769,9 @@ Status DirectSession::RunInternal(
           ((measure_step_count + 1) % build_cost_model_every == 0);
     }
   }
-  if (do_trace || update_cost_model ||
+  const bool estimate_op_costs =
+      run_options.experimental().estimate_op_costs() && run_metadata != nullptr;
+  if (do_trace || update_cost_model || estimate_op_costs ||
       run_options.report_tensor_allocations_upon_oom()) {
     run_state.collector.reset(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
@@ -688,15 +795,22 @@ Status DirectSession::RunInternal(
 
   Status run_status;
 
+  // A step run to completion in the caller thread keeps off the threads of
+  // the devices too.
+  const bool use_device_thread_pools =
+      pool != nullptr ||
+      !options_.config.experimental().run_in_caller_thread();
   auto set_threadpool_args_for_item =
-      [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
-                                  Executor::Args* args) {
+      [&default_runner, &handler, use_device_thread_pools](
+          const PerPartitionExecutorsAndLib& item, Executor::Args* args) {
         // TODO(azaks): support partial run.
         // TODO(azaks): if the device picks its own threadpool, we need to
         // assign
         //     less threads to the main compute pool by default.
         thread::ThreadPool* device_thread_pool =
-            item.device->tensorflow_device_thread_pool();
+            use_device_thread_pools
+                ? item.device->tensorflow_device_thread_pool()
+                : nullptr;
         // TODO(crk): Investigate usage of RunHandlerPool when using device
         // specific thread pool(s).
         if (!device_thread_pool) {
@@ -712,6 +826,7 @@ Status DirectSession::RunInternal(
         }
       };
 
+  phase_timer.StartPhase(StepPhase::kExecute);
   if (can_execute_synchronously) {
     PrivateIntraProcessRendezvous rendezvous(device_mgr_.get());
     args.rendezvous = &rendezvous;
@@ -748,6 +863,7 @@ Status DirectSession::RunInternal(
       run_status = run_state.status;
     }
   }
+  phase_timer.StartPhase(StepPhase::kRunFinish);
 
   if (step_cancellation_manager.IsCancelled()) {
     run_status.Update(errors::Cancelled("Run call was cancelled"));
@@ -771,6 +887,16 @@ Status DirectSession::RunInternal(
     run_state.collector->Finalize();
   }
 
+  if (estimate_op_costs) {
+    std::unordered_map<string, const Graph*> device_to_graph;
+    for (const PerPartitionExecutorsAndLib& partition :
+         executors_and_keys->items) {
+      device_to_graph[partition.device->name()] = partition.graph.get();
+    }
+    grappler::AnnotateStepStatsWithEstimatedCosts(
+        device_to_graph, run_metadata->mutable_step_stats());
+  }
+
   // Build and return the cost model as instructed.
   if (update_cost_model) {
     // Build the cost model
@@ -809,6 +935,7 @@ Status DirectSession::RunInternal(
       }
     }
   }
+  phase_timer.EndPhase();
   metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
 
   return Status::OK();
@@ -834,6 +961,8 @@ Status DirectSession::Run(const RunOptions& run_options,
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("Run()"));
   direct_session_runs->GetCell()->IncrementBy(1);
+  StepPhaseTimer phase_timer(options_.env);
+  phase_timer.StartPhase(StepPhase::kGetExecutors);
 
   // Extract the inputs names for this run of the session.
   std::vector<string> input_tensor_names;
@@ -846,7 +975,7 @@ Status DirectSession::Run(const RunOptions& run_options,
   metrics::RecordGraphInputTensors(input_size);
 
   // Check if we already have an executor for these arguments.
-  ExecutorsAndKeys* executors_and_keys;
+  std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
   RunStateArgs run_state_args(run_options.debug_options());
   run_state_args.collective_graph_key =
       run_options.experimental().collective_graph_key();
@@ -858,6 +987,7 @@ Status DirectSession::Run(const RunOptions& run_options,
     mutex_lock l(collective_graph_key_lock_);
     collective_graph_key_ = executors_and_keys->collective_graph_key;
   }
+  phase_timer.StartPhase(StepPhase::kCallFrame);
 
   // Configure a call frame for the step, which we use to feed and
   // fetch values to and from the executors.
@@ -887,10 +1017,12 @@ Status DirectSession::Run(const RunOptions& run_options,
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
+  phase_timer.EndPhase();
 
   TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
-                                 executors_and_keys, run_metadata,
+                                 executors_and_keys.get(), run_metadata,
                                  threadpool_options));
+  phase_timer.StartPhase(StepPhase::kFetchOutputs);
 
   // Receive outputs.
   if (outputs) {
@@ -931,6 +1063,7 @@ Status DirectSession::Run(const RunOptions& run_options,
     }
     metrics::RecordGraphOutputTensors(output_size);
   }
+  phase_timer.EndPhase();
 
   return Status::OK();
 }
@@ -946,7 +1079,7 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
   thread::ThreadPool* pool = thread_pools_[0].first;
 
   // Check if we already have an executor for these arguments.
-  ExecutorsAndKeys* executors_and_keys;
+  std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
   // TODO(cais): TFDBG support for partial runs.
   DebugOptions debug_options;
   RunStateArgs run_state_args(debug_options);
@@ -1463,7 +1596,8 @@ Status DirectSession::CreateExecutors(
 
 Status DirectSession::GetOrCreateExecutors(
     gtl::ArraySlice<string> inputs, gtl::ArraySlice<string> outputs,
-    gtl::ArraySlice<string> target_nodes, ExecutorsAndKeys** executors_and_keys,
+    gtl::ArraySlice<string> target_nodes,
+    std::shared_ptr<ExecutorsAndKeys>* executors_and_keys,
     RunStateArgs* run_state_args) {
   int64 handle_name_counter_value = -1;
   if (LogMemory::IsEnabled() || run_state_args->is_partial_run) {
@@ -1489,10 +1623,14 @@ Status DirectSession::GetOrCreateExecutors(
 
   // See if we already have the executors for this run.
   {
-    mutex_lock l(executor_lock_);  // could use reader lock
+    mutex_lock l(executor_lock_);
     auto it = executors_.find(key);
     if (it != executors_.end()) {
-      *executors_and_keys = it->second.get();
+      *executors_and_keys = it->second;
+      MarkExecutorsUsed(it->second.get());
+      static monitoring::CounterCell* hit_cell =
+          direct_session_executor_cache->GetCell("hit");
+      hit_cell->IncrementBy(1);
       return Status::OK();
     }
   }
@@ -1514,6 +1652,12 @@ Status DirectSession::GetOrCreateExecutors(
       absl::StrJoin(inputs_sorted, ","), "->",
       absl::StrJoin(outputs_sorted, ","), "/", absl::StrJoin(tn_sorted, ","),
       "/", run_state_args->is_partial_run, "/", debug_tensor_watches_summary);
+  // The signature without its fetches, used to find cached executors whose
+  // fetches include the requested ones.
+  const string feeds_and_targets_key = strings::StrCat(
+      absl::StrJoin(inputs_sorted, ","), "/", absl::StrJoin(tn_sorted, ","),
+      "/", run_state_args->is_partial_run, "/", debug_tensor_watches_summary,
+      "/", run_state_args->collective_graph_key);
   // Set the handle, if its needed to log memory or for partial run.
   if (handle_name_counter_value >= 0) {
     run_state_args->handle =
@@ -1525,10 +1669,31 @@ Status DirectSession::GetOrCreateExecutors(
     mutex_lock l(executor_lock_);
     auto it = executors_.find(sorted_key);
     if (it != executors_.end()) {
-      *executors_and_keys = it->second.get();
+      *executors_and_keys = it->second;
+      AddExecutorsKey(key, it->second);
+      direct_session_executor_cache->GetCell("hit")->IncrementBy(1);
       return Status::OK();
     }
+    // A partial run may feed or fetch any of its declared tensors, so it
+    // is never served by the executors of another signature. Neither are
+    // repeated fetches, since Run() detects them by comparing the number of
+    // fetches with that of the executors.
+    if (reuse_executors_for_fetch_subsets_ &&
+        !run_state_args->is_partial_run &&
+        std::adjacent_find(outputs_sorted.begin(), outputs_sorted.end()) ==
+            outputs_sorted.end()) {
+      std::shared_ptr<ExecutorsAndKeys> superset =
+          FindExecutorsForFetchSubset(feeds_and_targets_key, outputs_sorted);
+      if (superset != nullptr) {
+        *executors_and_keys = superset;
+        AddExecutorsKey(sorted_key, superset);
+        AddExecutorsKey(key, superset);
+        direct_session_executor_cache->GetCell("subset_hit")->IncrementBy(1);
+        return Status::OK();
+      }
+    }
   }
+  direct_session_executor_cache->GetCell("miss")->IncrementBy(1);
 
   // Nothing found, so create the executors and store in the cache.
   // The executor_lock_ is intentionally released while executors are
@@ -1564,17 +1729,74 @@ Status DirectSession::GetOrCreateExecutors(
   auto insert_result = executors_.emplace(
       sorted_key, std::shared_ptr<ExecutorsAndKeys>(std::move(ek)));
   if (insert_result.second) {
+    // The function library outlives the executors even if they are evicted,
+    // since kernels cached in the devices' OpSegments may refer to it.
     functions_.push_back(std::move(func_info));
+    if (!run_state_args->is_partial_run) {
+      executors_lru_.push_front(
+          {insert_result.first->second, {sorted_key}, feeds_and_targets_key});
+      executors_lru_index_.emplace(insert_result.first->second.get(),
+                                   executors_lru_.begin());
+    }
   }
+  *executors_and_keys = insert_result.first->second;
 
   // Insert the value under the original key, so the fast path lookup will work
   // if the user uses the same order of inputs, outputs, and targets again.
-  executors_.emplace(key, insert_result.first->second);
-  *executors_and_keys = insert_result.first->second.get();
+  AddExecutorsKey(key, *executors_and_keys);
+
+  // Evict the least recently used executors. Runs that are using them keep
+  // them alive until they finish.
+  while (executor_cache_capacity_ > 0 &&
+         executors_lru_.size() > executor_cache_capacity_) {
+    const CachedExecutors& evicted = executors_lru_.back();
+    for (const string& evicted_key : evicted.keys) {
+      executors_.erase(evicted_key);
+    }
+    executors_lru_index_.erase(evicted.executors_and_keys.get());
+    executors_lru_.pop_back();
+    direct_session_executor_cache->GetCell("eviction")->IncrementBy(1);
+  }
 
   return Status::OK();
 }
 
+std::shared_ptr<DirectSession::ExecutorsAndKeys>
+DirectSession::FindExecutorsForFetchSubset(const string& feeds_and_targets_key,
+                                           gtl::ArraySlice<string> outputs) {
+  for (const CachedExecutors& cached : executors_lru_) {
+    if (cached.feeds_and_targets_key != feeds_and_targets_key) continue;
+    const auto& output_name_to_index =
+        cached.executors_and_keys->output_name_to_index;
+    bool has_all_outputs = true;
+    for (const string& output : outputs) {
+      if (output_name_to_index.find(output) == output_name_to_index.end()) {
+        has_all_outputs = false;
+        break;
+      }
+    }
+    if (has_all_outputs) return cached.executors_and_keys;
+  }
+  return nullptr;
+}
+
+void DirectSession::AddExecutorsKey(
+    const string& key,
+    const std::shared_ptr<ExecutorsAndKeys>& executors_and_keys) {
+  if (executors_.emplace(key, executors_and_keys).second) {
+    auto it = executors_lru_index_.find(executors_and_keys.get());
+    if (it != executors_lru_index_.end()) it->second->keys.push_back(key);
+  }
+  MarkExecutorsUsed(executors_and_keys.get());
+}
+
+void DirectSession::MarkExecutorsUsed(
+    const ExecutorsAndKeys* executors_and_keys) {
+  auto it = executors_lru_index_.find(executors_and_keys);
+  if (it == executors_lru_index_.end()) return;
+  executors_lru_.splice(executors_lru_.begin(), executors_lru_, it->second);
+}
+
 Status DirectSession::CreateGraphs(
     const BuildGraphOptions& subgraph_options,
     std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
@@ -1861,11 +2083,13 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   RunCallableCallFrame(DirectSession* session,
                        ExecutorsAndKeys* executors_and_keys,
                        const std::vector<Tensor>* feed_tensors,
-                       std::vector<Tensor>* fetch_tensors)
+                       std::vector<Tensor>* fetch_tensors,
+                       const std::vector<Tensor>* output_buffers)
       : session_(session),
         executors_and_keys_(executors_and_keys),
         feed_tensors_(feed_tensors),
-        fetch_tensors_(fetch_tensors) {}
+        fetch_tensors_(fetch_tensors),
+        output_buffers_(output_buffers) {}
 
   size_t num_args() const override {
     return executors_and_keys_->input_types.size();
@@ -1887,15 +2111,36 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     if (index > fetch_tensors_->size()) {
       return errors::Internal("RetVal index out of bounds: ", index);
     }
-    (*fetch_tensors_)[index] = val;
+    if (output_buffers_ == nullptr) {
+      (*fetch_tensors_)[index] = val;
+      return Status::OK();
+    }
+    const Tensor& buffer = (*output_buffers_)[index];
+    if (!val.SharesBufferWith(buffer)) {
+      if (TF_PREDICT_FALSE(val.dtype() != buffer.dtype() ||
+                           val.shape() != buffer.shape())) {
+        return errors::InvalidArgument(
+            "Fetched value ", index, " has dtype ", DataTypeString(val.dtype()),
+            " and shape ", val.shape().DebugString(),
+            ", but its bound output buffer has dtype ",
+            DataTypeString(buffer.dtype()), " and shape ",
+            buffer.shape().DebugString());
+      }
+      if (val.TotalBytes() > 0) {
+        memcpy(const_cast<char*>(buffer.tensor_data().data()),
+               val.tensor_data().data(), val.TotalBytes());
+      }
+    }
+    (*fetch_tensors_)[index] = buffer;
     return Status::OK();
   }
 
  private:
   DirectSession* const session_;                   // Not owned.
   ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
-  const std::vector<Tensor>* const feed_tensors_;  // Not owned.
-  std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+  const std::vector<Tensor>* const feed_tensors_;    // Not owned.
+  std::vector<Tensor>* const fetch_tensors_;         // Not owned.
+  const std::vector<Tensor>* const output_buffers_;  // Not owned.
 };
 
 ::tensorflow::Status DirectSession::RunCallable(
@@ -1912,9 +2157,12 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("RunCallable()"));
   direct_session_runs->GetCell()->IncrementBy(1);
+  StepPhaseTimer phase_timer(options_.env);
+  phase_timer.StartPhase(StepPhase::kCallFrame);
 
   // Check if we already have an executor for these arguments.
   std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
+  std::shared_ptr<const std::vector<Tensor>> output_buffers;
   const int64 step_id = step_id_counter_.fetch_add(1);
 
   {
@@ -1922,7 +2170,9 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     if (handle >= next_callable_handle_) {
       return errors::InvalidArgument("No such callable handle: ", handle);
     }
-    executors_and_keys = callables_[handle].executors_and_keys;
+    const Callable& callable = callables_[handle];
+    executors_and_keys = callable.executors_and_keys;
+    output_buffers = callable.output_buffers;
   }
 
   if (!executors_and_keys) {
@@ -1942,6 +2192,23 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         "Expected ", executors_and_keys->input_types.size(),
         " feed tensors, but got ", feed_tensors.size());
   }
+  // The graph may have been specialized for the shapes of the feeds.
+  const CallableOptions& callable_options =
+      executors_and_keys->callable_options;
+  if (!callable_options.feed_shapes().empty()) {
+    for (int i = 0; i < feed_tensors.size(); ++i) {
+      auto it = callable_options.feed_shapes().find(callable_options.feed(i));
+      if (it == callable_options.feed_shapes().end()) continue;
+      const PartialTensorShape feed_shape(it->second);
+      if (!feed_shape.IsCompatibleWith(feed_tensors[i].shape())) {
+        return errors::InvalidArgument(
+            "Feed tensor ", callable_options.feed(i), " has shape ",
+            feed_tensors[i].shape().DebugString(),
+            " but the callable was created for shape ",
+            feed_shape.DebugString());
+      }
+    }
+  }
   if (fetch_tensors != nullptr) {
     fetch_tensors->resize(executors_and_keys->output_types.size());
   } else if (!executors_and_keys->output_types.empty()) {
@@ -1981,15 +2248,18 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   // A specialized CallFrame implementation that takes advantage of the
   // optimized RunCallable interface.
   RunCallableCallFrame call_frame(this, executors_and_keys.get(),
-                                  actual_feed_tensors, fetch_tensors);
+                                  actual_feed_tensors, fetch_tensors,
+                                  output_buffers.get());
 
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
+  phase_timer.EndPhase();
 
   TF_RETURN_IF_ERROR(RunInternal(
       step_id, executors_and_keys->callable_options.run_options(), &call_frame,
       executors_and_keys.get(), run_metadata, threadpool_options));
+  phase_timer.StartPhase(StepPhase::kFetchOutputs);
 
   if (fetch_tensors != nullptr) {
     size_t output_size = 0;
@@ -1998,10 +2268,56 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     }
     metrics::RecordGraphOutputTensors(output_size);
   }
+  phase_timer.EndPhase();
 
   return Status::OK();
 }
 
+::tensorflow::Status DirectSession::BindCallableOutputs(
+    CallableHandle handle, const std::vector<Tensor>& output_buffers) {
+  mutex_lock l(callables_lock_);
+  if (handle >= next_callable_handle_) {
+    return errors::InvalidArgument("No such callable handle: ", handle);
+  }
+  auto it = callables_.find(handle);
+  if (it == callables_.end()) {
+    return errors::InvalidArgument(
+        "Attempted to bind outputs after handle was released: ", handle);
+  }
+  Callable& callable = it->second;
+  if (output_buffers.empty()) {
+    callable.output_buffers.reset();
+    return Status::OK();
+  }
+  const ExecutorsAndKeys& ek = *callable.executors_and_keys;
+  if (output_buffers.size() != ek.output_types.size()) {
+    return errors::InvalidArgument("Expected ", ek.output_types.size(),
+                                   " output buffers, but got ",
+                                   output_buffers.size());
+  }
+  if (!ek.callable_options.fetch_devices().empty()) {
+    return errors::InvalidArgument(
+        "Output buffers cannot be bound to a callable with fetch_devices.");
+  }
+  for (size_t i = 0; i < output_buffers.size(); ++i) {
+    const Tensor& buffer = output_buffers[i];
+    if (buffer.dtype() != ek.output_types[i]) {
+      return errors::InvalidArgument(
+          "Output buffer ", i, " has dtype ", DataTypeString(buffer.dtype()),
+          ", but the fetched value has dtype ",
+          DataTypeString(ek.output_types[i]));
+    }
+    if (!DataTypeCanUseMemcpy(buffer.dtype()) || !buffer.IsInitialized()) {
+      return errors::InvalidArgument(
+          "Output buffer ", i, " must be an initialized tensor of a type that "
+          "can be copied with memcpy, got ", buffer.DebugString());
+    }
+  }
+  callable.output_buffers =
+      std::make_shared<const std::vector<Tensor>>(output_buffers);
+  return Status::OK();
+}
+
 ::tensorflow::Status DirectSession::ReleaseCallable(CallableHandle handle) {
   mutex_lock l(callables_lock_);
   if (handle >= next_callable_handle_) {
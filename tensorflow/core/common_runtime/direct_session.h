@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DIRECT_SESSION_H_
 
 #include <atomic>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -131,6 +132,10 @@ class DirectSession : public Session {
       std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options) override;
 
+  ::tensorflow::Status BindCallableOutputs(
+      CallableHandle handle,
+      const std::vector<Tensor>& output_buffers) override;
+
   ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
 
   ::tensorflow::Status Finalize() override;
@@ -140,6 +145,7 @@ class DirectSession : public Session {
  private:
   // For access to collective_graph_key_.
   friend class DirectSessionCollectiveTest;
+  friend class DirectSessionExecutorCacheTest;
 
   // We create one executor and its dependent library runtime for
   // every partition.
@@ -243,7 +249,26 @@ class DirectSession : public Session {
   ::tensorflow::Status GetOrCreateExecutors(
       gtl::ArraySlice<string> inputs, gtl::ArraySlice<string> outputs,
       gtl::ArraySlice<string> target_nodes,
-      ExecutorsAndKeys** executors_and_keys, RunStateArgs* run_state_args);
+      std::shared_ptr<ExecutorsAndKeys>* executors_and_keys,
+      RunStateArgs* run_state_args);
+
+  // Returns the cached executors of a signature whose feeds and targets
+  // match `feeds_and_targets_key` and whose fetches include all of
+  // `outputs`, or nullptr if there are none.
+  std::shared_ptr<ExecutorsAndKeys> FindExecutorsForFetchSubset(
+      const string& feeds_and_targets_key, gtl::ArraySlice<string> outputs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
+
+  // Caches `executors_and_keys` under `key` as well, and marks it as used.
+  void AddExecutorsKey(
+      const string& key,
+      const std::shared_ptr<ExecutorsAndKeys>& executors_and_keys)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
+
+  // Marks `executors_and_keys` as the most recently used of the cached
+  // executors.
+  void MarkExecutorsUsed(const ExecutorsAndKeys* executors_and_keys)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
 
   // Creates a set of executors to run the subgraph defined by
   // `callable_options`.
@@ -367,10 +392,30 @@ class DirectSession : public Session {
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       TF_GUARDED_BY(executor_lock_);
 
+  // The executors cached for Run() signatures, most recently used first,
+  // with the keys under which each is stored in `executors_`. When the list
+  // grows past `executor_cache_capacity_`, the last entry is erased from
+  // both. Executors of partial runs are not in the list, since PRun() looks
+  // them up again by key, so they are never evicted.
+  struct CachedExecutors {
+    std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
+    std::vector<string> keys;
+    // The sorted feeds and targets, and the options of the signature.
+    string feeds_and_targets_key;
+  };
+  std::list<CachedExecutors> executors_lru_ TF_GUARDED_BY(executor_lock_);
+  std::unordered_map<const ExecutorsAndKeys*,
+                     std::list<CachedExecutors>::iterator>
+      executors_lru_index_ TF_GUARDED_BY(executor_lock_);
+  size_t executor_cache_capacity_ = 0;  // Zero if unbounded.
+  bool reuse_executors_for_fetch_subsets_ = false;
+
   class RunCallableCallFrame;
   struct Callable {
     std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
     std::shared_ptr<FunctionInfo> function_info;
+    // Caller-owned buffers into which the outputs are copied, if bound.
+    std::shared_ptr<const std::vector<Tensor>> output_buffers;
     ~Callable();
   };
   mutex callables_lock_;
@@ -435,6 +480,9 @@ class DirectSession : public Session {
   // 5. RunOptions.experimental.use_run_handler_pool is unspecified or false.
   // Otherwise run in global thread pool, session owned thread pool or handler
   // pool according to other specifications of RunOptions and ConfigProto.
+  //
+  // ConfigProto.experimental.run_in_caller_thread also sets this, and then
+  // allows several executors as long as they all run on CPU devices.
   bool run_in_caller_thread_ = false;
 
   TF_DISALLOW_COPY_AND_ASSIGN(DirectSession);
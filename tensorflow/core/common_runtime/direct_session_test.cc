@@ -21,6 +21,7 @@ limitations under the License.
 #include <string>
 #include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -44,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/test.h"
@@ -198,6 +201,50 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_CallableBoundOutputs) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({}, {y_ + ":0"}, {y_neg_}), &handle));
+
+  Tensor buffer(DT_FLOAT, TensorShape({2, 1}));
+  TF_ASSERT_OK(session->BindCallableOutputs(handle, {buffer}));
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_TRUE(outputs[0].SharesBufferWith(buffer));
+    EXPECT_FLOAT_EQ(5.0, buffer.matrix<float>()(0, 0));
+  }
+
+  // The fetched value must have the shape of the buffer.
+  TF_ASSERT_OK(session->BindCallableOutputs(
+      handle, {Tensor(DT_FLOAT, TensorShape({1, 2}))}));
+  Status s = session->RunCallable(handle, {}, &outputs, nullptr);
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "bound output buffer"));
+
+  s = session->BindCallableOutputs(handle,
+                                   {Tensor(DT_INT32, TensorShape({2, 1}))});
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+  s = session->BindCallableOutputs(handle, {buffer, buffer});
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+
+  // Unbinding returns tensors allocated by the step again.
+  TF_ASSERT_OK(session->BindCallableOutputs(handle, {}));
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  EXPECT_FALSE(outputs[0].SharesBufferWith(buffer));
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+  s = session->BindCallableOutputs(handle, {buffer});
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
@@ -800,6 +847,45 @@ TEST_F(DirectSessionMinusAXTest, UseRunHandlerPool) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, RecordsStepPhaseTimes) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  const std::vector<string> phases = {
+      "get_executors", "call_frame", "run_setup",    "executor_args",
+      "execute",       "run_finish", "fetch_outputs"};
+  auto num_samples = [&phases]() {
+    std::vector<double> num_samples;
+    for (const string& phase : phases) {
+      num_samples.push_back(
+          metrics::GetDirectSessionPhaseTimeHistogram(phase)->value().num());
+    }
+    return num_samples;
+  };
+  const std::vector<double> before_run = num_samples();
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  const std::vector<double> after_run = num_samples();
+  for (int i = 0; i < phases.size(); ++i) {
+    EXPECT_EQ(before_run[i] + 1, after_run[i]) << phases[i];
+  }
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(
+      session->MakeCallable(MakeCallableOptions({}, {y_ + ":0"}, {}), &handle));
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  const std::vector<double> after_run_callable = num_samples();
+  for (int i = 0; i < phases.size(); ++i) {
+    // RunCallable() uses the executors of the callable.
+    const double expected_delta = phases[i] == "get_executors" ? 0 : 1;
+    EXPECT_EQ(after_run[i] + expected_delta, after_run_callable[i])
+        << phases[i];
+  }
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   GraphDef def;
   Graph g(OpRegistry::Global());
@@ -995,6 +1081,67 @@ TEST(DirectSessionTest, MultipleFeedTest_Callable) {
   EXPECT_TRUE(absl::StrContains(s.error_message(), "fed more than once"));
 }
 
+TEST(DirectSessionTest, SpecializedCallable) {
+  GraphDef def;
+  Graph g(OpRegistry::Global());
+  Node* x;
+  TF_ASSERT_OK(NodeBuilder("x", "Placeholder")
+                   .Attr("dtype", DT_FLOAT)
+                   .Attr("shape", PartialTensorShape())
+                   .Finalize(&g, &x));
+  Node* mode;
+  TF_ASSERT_OK(NodeBuilder("mode", "Placeholder")
+                   .Attr("dtype", DT_BOOL)
+                   .Attr("shape", PartialTensorShape({}))
+                   .Finalize(&g, &mode));
+  // y = mode ? x : -x
+  Node* switch_node = test::graph::Switch(&g, x, mode);
+  Node* neg = test::graph::Unary(&g, "Neg", switch_node, 0);
+  Node* identity = test::graph::Identity(&g, switch_node, 1);
+  Node* y = test::graph::Merge(&g, neg, identity);
+  g.ToGraphDef(&def);
+
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  Tensor x_value = test::AsTensor<float>({1.0, 2.0}, {2});
+  for (bool mode_value : {true, false}) {
+    CallableOptions callable_options =
+        MakeCallableOptions({"x:0"}, {y->name() + ":0"}, {});
+    TensorShape({2}).AsProto(&(*callable_options.mutable_feed_shapes())["x:0"]);
+    test::AsScalar<bool>(mode_value).AsProtoTensorContent(
+        &(*callable_options.mutable_constant_feeds())["mode:0"]);
+    Session::CallableHandle handle;
+    TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {x_value}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    test::ExpectTensorEqual<float>(
+        test::AsTensor<float>(mode_value ? std::vector<float>({1.0, 2.0})
+                                         : std::vector<float>({-1.0, -2.0}),
+                              {2}),
+        outputs[0]);
+
+    // The callable only accepts the shape it was specialized for.
+    Status s = session->RunCallable(
+        handle, {test::AsTensor<float>({1.0, 2.0, 3.0}, {3})}, &outputs,
+        nullptr);
+    EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+    TF_ASSERT_OK(session->ReleaseCallable(handle));
+  }
+
+  // A tensor can't be both fed and constant.
+  CallableOptions callable_options =
+      MakeCallableOptions({"x:0", "mode:0"}, {y->name() + ":0"}, {});
+  test::AsScalar<bool>(true).AsProtoTensorContent(
+      &(*callable_options.mutable_constant_feeds())["mode:0"]);
+  Session::CallableHandle handle;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      session->MakeCallable(callable_options, &handle)));
+}
+
 TEST(DirectSessionTest, TestTensorConnectionUseTwice) {
   Graph graph(OpRegistry::Global());
 
@@ -1468,6 +1615,140 @@ TEST(DirectSessionTest, SyncSession) {
             static_cast<int64>(outputs[0].scalar<int64>()()));
 }
 
+TEST(DirectSessionTest, RunInCallerThread_MultiplePartitions) {
+  Graph g(OpRegistry::Global());
+  Tensor vx(DT_INT64, TensorShape({}));
+  vx.scalar<int64>()() = 17;
+  Node* x = test::graph::Constant(&g, vx);
+  x->set_assigned_device_name("/job:localhost/replica:0/task:0/cpu:0");
+  Node* y0 = test::graph::Unary(&g, "ThreadID", x);
+  y0->set_assigned_device_name("/job:localhost/replica:0/task:0/cpu:0");
+  Node* y1 = test::graph::Unary(&g, "ThreadID", x);
+  y1->set_assigned_device_name("/job:localhost/replica:0/task:0/cpu:1");
+  GraphDef def;
+  g.ToGraphDef(&def);
+  SessionOptions options = DefaultSessionOptions();
+  options.config.set_use_per_session_threads(true);
+  options.config.mutable_experimental()->set_run_in_caller_thread(true);
+  std::unique_ptr<Session> sess(NewSession(options));
+  TF_ASSERT_OK(sess->Create(def));
+  for (int i = 0; i < 2; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(sess->Run({}, {y0->name() + ":0", y1->name() + ":0"}, {},
+                           &outputs));
+    ASSERT_EQ(2, outputs.size());
+    std::hash<std::thread::id> hasher;
+    const int64 caller = static_cast<int64>(hasher(std::this_thread::get_id()));
+    EXPECT_EQ(caller, outputs[0].scalar<int64>()());
+    EXPECT_EQ(caller, outputs[1].scalar<int64>()());
+  }
+}
+
+class DirectSessionExecutorCacheTest : public ::testing::Test {
+ protected:
+  // Returns the number of distinct executors that `session` has cached for
+  // Run() and PRunSetup() signatures.
+  static size_t NumCachedExecutors(Session* session) {
+    DirectSession* direct_session = static_cast<DirectSession*>(session);
+    mutex_lock l(direct_session->executor_lock_);
+    std::unordered_set<const void*> executors;
+    for (const auto& it : direct_session->executors_) {
+      executors.insert(it.second.get());
+    }
+    return executors.size();
+  }
+
+  // Creates a graph that computes "a" = -x, "b" = x and "c" = -(-x) from
+  // a constant x = 3.
+  GraphDef CreateGraph() {
+    Graph g(OpRegistry::Global());
+    Tensor vx(DT_FLOAT, TensorShape({}));
+    vx.scalar<float>()() = 3.0;
+    Node* x = test::graph::Constant(&g, vx);
+    Node* a = test::graph::Unary(&g, "Neg", x);
+    Node* b = test::graph::Identity(&g, x);
+    Node* c = test::graph::Unary(&g, "Neg", a);
+    a_ = a->name() + ":0";
+    b_ = b->name() + ":0";
+    c_ = c->name() + ":0";
+    GraphDef def;
+    g.ToGraphDef(&def);
+    return def;
+  }
+
+  // Fetches `fetches` and checks their values.
+  void RunAndCheck(Session* session, const std::vector<string>& fetches) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, fetches, {}, &outputs));
+    ASSERT_EQ(fetches.size(), outputs.size());
+    for (int i = 0; i < fetches.size(); ++i) {
+      const float expected = fetches[i] == a_ ? -3.0 : 3.0;
+      EXPECT_FLOAT_EQ(expected, outputs[i].scalar<float>()());
+    }
+  }
+
+  string a_, b_, c_;
+};
+
+TEST_F(DirectSessionExecutorCacheTest, EvictsLeastRecentlyUsed) {
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_executor_cache_capacity(2);
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_ASSERT_OK(session->Create(CreateGraph()));
+
+  RunAndCheck(session.get(), {a_, b_});
+  RunAndCheck(session.get(), {c_});
+  // Hits the executors of the first signature with another fetch order.
+  RunAndCheck(session.get(), {b_, a_});
+  EXPECT_EQ(2, NumCachedExecutors(session.get()));
+
+  // Evicts {c}, the least recently used signature.
+  RunAndCheck(session.get(), {a_});
+  EXPECT_EQ(2, NumCachedExecutors(session.get()));
+  RunAndCheck(session.get(), {b_, a_});
+  EXPECT_EQ(2, NumCachedExecutors(session.get()));
+
+  // Rebuilds the executors of {c}.
+  RunAndCheck(session.get(), {c_});
+  EXPECT_EQ(2, NumCachedExecutors(session.get()));
+
+  // Partial runs are not evicted.
+  string handle;
+  TF_ASSERT_OK(session->PRunSetup({}, {a_, b_}, {}, &handle));
+  RunAndCheck(session.get(), {b_});
+  RunAndCheck(session.get(), {c_});
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->PRun(handle, {}, {a_, b_}, &outputs));
+  ASSERT_EQ(2, outputs.size());
+  EXPECT_FLOAT_EQ(-3.0, outputs[0].scalar<float>()());
+  EXPECT_FLOAT_EQ(3.0, outputs[1].scalar<float>()());
+  EXPECT_EQ(3, NumCachedExecutors(session.get()));
+}
+
+TEST_F(DirectSessionExecutorCacheTest, ReusesExecutorsForFetchSubsets) {
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_reuse_executors_for_fetch_subsets(
+      true);
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_ASSERT_OK(session->Create(CreateGraph()));
+
+  RunAndCheck(session.get(), {a_, b_});
+  RunAndCheck(session.get(), {b_});
+  RunAndCheck(session.get(), {a_});
+  RunAndCheck(session.get(), {b_});
+  EXPECT_EQ(1, NumCachedExecutors(session.get()));
+
+  // Repeated fetches get their own executors.
+  RunAndCheck(session.get(), {a_, a_});
+  EXPECT_EQ(2, NumCachedExecutors(session.get()));
+
+  // "c" is not fetched by the cached executors.
+  RunAndCheck(session.get(), {a_, c_});
+  EXPECT_EQ(3, NumCachedExecutors(session.get()));
+  RunAndCheck(session.get(), {c_});
+  EXPECT_EQ(3, NumCachedExecutors(session.get()));
+}
+
 REGISTER_OP("Darth").Input("x: float").Output("y: float").Doc(R"doc(
 Darth promises one return value.
 
@@ -2399,6 +2680,41 @@ TEST(DirectSessionTest, FeedAndFetchTensorsInDeviceMemory) {
   }
 }
 
+TEST(DirectSessionTest, TimeOpsOnDevice) {
+  SessionOptions options;
+  options.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_time_ops_on_device(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  const string gpu_device_name = GPUDeviceName(session.get());
+  if (gpu_device_name.empty()) {
+    LOG(INFO) << "Skipping test since no GPU is available";
+    return;
+  }
+  TF_ASSERT_OK(session->Create(CreateGraphForYEqualsXSquared()));
+
+  Tensor input(DT_FLOAT, TensorShape({1024, 1024}));
+  input.flat<float>().setConstant(2.0f);
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::SOFTWARE_TRACE);
+  RunMetadata run_metadata;
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run(run_options, {{"x", input}}, {"y:0"}, {},
+                            &outputs, &run_metadata));
+
+  int num_timed_nodes = 0;
+  for (const DeviceStepStats& dev_stats :
+       run_metadata.step_stats().dev_stats()) {
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      if (node_stats.node_name() != "y") continue;
+      EXPECT_EQ(dev_stats.device(), gpu_device_name);
+      EXPECT_GT(node_stats.device_compute_nanos(), 0);
+      ++num_timed_nodes;
+    }
+  }
+  EXPECT_EQ(num_timed_nodes, 1);
+}
+
 GraphDef CreateIdentityGraphDef(DataType dtype) {
   GraphDef def;
 
@@ -2586,11 +2902,56 @@ TEST(DirectSessionTest,
   TestFeedAndFetchTensorsInDeviceMemoryForAllDataTypes(opts);
 }
 
+// Measures the latency of a callable running a chain of `depth` cheap
+// nodes, with or without ConfigProto.experimental.run_in_caller_thread.
+void BM_ChainCallable(int iters, int depth, int run_in_caller_thread) {
+  testing::StopTiming();
+  Graph g(OpRegistry::Global());
+  Tensor value(DT_FLOAT, TensorShape({16}));
+  value.flat<float>().setConstant(1.0);
+  // The chain starts from a feed, so that it is not constant folded.
+  Node* placeholder;
+  TF_CHECK_OK(NodeBuilder(g.NewName("Placeholder"), "Placeholder")
+                  .Attr("shape", value.shape())
+                  .Attr("dtype", DT_FLOAT)
+                  .Finalize(&g, &placeholder));
+  Node* node = placeholder;
+  for (int i = 0; i < depth; ++i) {
+    node = test::graph::Unary(&g, "Neg", node);
+  }
+  GraphDef gd;
+  g.ToGraphDef(&gd);
+  SessionOptions opts;
+  opts.config.mutable_experimental()->set_run_in_caller_thread(
+      run_in_caller_thread);
+  std::unique_ptr<Session> session(NewSession(opts));
+  TF_CHECK_OK(session->Create(gd));
+  Session::CallableHandle handle;
+  TF_CHECK_OK(session->MakeCallable(
+      MakeCallableOptions({placeholder->name() + ":0"},
+                          {node->name() + ":0"}, {}),
+      &handle));
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->RunCallable(handle, {value}, &outputs, nullptr));
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(session->RunCallable(handle, {value}, &outputs, nullptr));
+  }
+  testing::StopTiming();
+  TF_CHECK_OK(session->ReleaseCallable(handle));
+}
+BENCHMARK(BM_ChainCallable)
+    ->ArgPair(16, 0)
+    ->ArgPair(16, 1)
+    ->ArgPair(256, 0)
+    ->ArgPair(256, 1);
+
 // A simple benchmark for the overhead of `DirectSession::Run()` calls
 // with varying numbers of feeds/fetches.
 void FeedFetchBenchmarkHelper(int iters, int num_feeds, bool use_make_callable,
                               int inter_op_threads,
-                              bool use_single_threaded_executor) {
+                              bool use_single_threaded_executor,
+                              bool bind_output_buffers = false) {
   testing::StopTiming();
 
   Tensor value(DT_FLOAT, TensorShape());
@@ -2643,14 +3004,28 @@ void FeedFetchBenchmarkHelper(int iters, int num_feeds, bool use_make_callable,
       callable_options.add_fetch(output);
     }
     TF_CHECK_OK(session->MakeCallable(callable_options, &handle));
+    std::vector<Tensor> output_values;
+    if (bind_output_buffers) {
+      std::vector<Tensor> output_buffers(num_feeds,
+                                         Tensor(DT_FLOAT, TensorShape()));
+      TF_CHECK_OK(session->BindCallableOutputs(handle, output_buffers));
+    }
 
+    EnableCPUAllocatorStats(true);
+    cpu_allocator()->ClearStats();
     testing::StartTiming();
     for (int i = 0; i < iters; ++i) {
-      std::vector<Tensor> output_values;
+      if (!bind_output_buffers) output_values.clear();
       TF_CHECK_OK(
           session->RunCallable(handle, input_tensors, &output_values, nullptr));
     }
     testing::StopTiming();
+    absl::optional<AllocatorStats> stats = cpu_allocator()->GetStats();
+    EnableCPUAllocatorStats(false);
+    if (stats) {
+      testing::SetLabel(strings::StrCat(
+          static_cast<double>(stats->num_allocs) / iters, " allocs/call"));
+    }
   } else {
     {
       // NOTE(mrry): Ignore the first run, which will incur the graph
@@ -2692,8 +3067,16 @@ void BM_FeedFetchCallableSingleThreadExecutor(int iters, int num_feeds) {
                            /* use_single_threaded_executor */ true);
 }
 
+void BM_FeedFetchCallableBoundOutputs(int iters, int num_feeds) {
+  FeedFetchBenchmarkHelper(iters, num_feeds, /* use_make_callable */ true,
+                           /* inter_op_threads */ 0,
+                           /* use_single_threaded_executor */ false,
+                           /* bind_output_buffers */ true);
+}
+
 BENCHMARK(BM_FeedFetch)->Arg(1)->Arg(2)->Arg(5)->Arg(10);
 BENCHMARK(BM_FeedFetchCallable)->Arg(1)->Arg(2)->Arg(5)->Arg(10);
+BENCHMARK(BM_FeedFetchCallableBoundOutputs)->Arg(1)->Arg(2)->Arg(5)->Arg(10);
 BENCHMARK(BM_FeedFetchCallableSingleThread)->Arg(1)->Arg(2)->Arg(5)->Arg(10);
 BENCHMARK(BM_FeedFetchCallableSingleThreadExecutor)
     ->Arg(1)
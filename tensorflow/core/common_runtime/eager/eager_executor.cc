@@ -29,6 +29,13 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+int64 MaxRemoteBatchSize() {
+  int64 max_batch_size;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_MAX_REMOTE_BATCH_SIZE", 64,
+                                  &max_batch_size));
+  return std::max<int64>(max_batch_size, 1);
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async)
@@ -40,7 +47,8 @@ EagerExecutor::EagerExecutor(bool async)
                     : nullptr),
       last_eager_client_(nullptr),
       enable_async_wait_for_remote_function_(
-          IsAsyncWaitForRemoteFunctionEnabled()) {}
+          IsAsyncWaitForRemoteFunctionEnabled()),
+      max_remote_batch_size_(MaxRemoteBatchSize()) {}
 
 EagerExecutor::~EagerExecutor() {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -153,7 +161,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -235,7 +243,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -269,7 +277,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -323,6 +331,10 @@ void EagerExecutor::Run() {
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
+    // The remote nodes pending right after curr_item that can be sent to the
+    // worker together with it. Only nodes that are already pending are
+    // batched, so batching never delays a node.
+    std::vector<core::RefCountPtr<NodeItem>> batch;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -338,8 +350,28 @@ void EagerExecutor::Run() {
       // and register a notification for its completion.
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
+      const AsyncRemoteExecuteNode* last_node =
+          curr_item->node->AsAsyncRemoteExecuteNode();
+      for (int i = 1; last_node != nullptr && i < node_queue_.size() &&
+                      i < max_remote_batch_size_;
+           ++i) {
+        const AsyncRemoteExecuteNode* next_node =
+            node_queue_[i]->node->AsAsyncRemoteExecuteNode();
+        if (next_node == nullptr || !last_node->CanBatchWith(*next_node)) {
+          break;
+        }
+        batch.emplace_back(node_queue_[i].get());
+        batch.back()->Ref();
+        last_node = next_node;
+      }
+    }
+    Status status;
+    if (batch.empty()) {
+      status = RunItem(std::move(curr_item), /*from_queue=*/true);
+    } else {
+      batch.insert(batch.begin(), std::move(curr_item));
+      status = RunRemoteBatch(std::move(batch));
     }
-    Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
     if (!status.ok()) {
       VLOG(1) << "Failed to run item: " << status;
     }
@@ -352,28 +384,11 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
            << item->node->DebugString();
   AsyncRemoteExecuteNode* async_remote_node =
       item->node->AsAsyncRemoteExecuteNode();
-  if (enable_async_wait_for_remote_function_) {
-    if (async_remote_node != nullptr) {
-      if (last_eager_client_ != nullptr &&
-          async_remote_node->eager_client() != nullptr &&
-          last_eager_client_ != async_remote_node->eager_client()) {
-        // Running a remote function, need to sync if the function is going to
-        // different device than last time we run remote distributed function.
-        DVLOG(3) << "Executing Sync Executor for node" << item->id;
-        tensorflow::Status status = async_remote_node->SyncExecutors();
-        if (!status.ok()) {
-          NodeDone(item, status, from_queue);
-          return status;
-        }
-        last_eager_client_ = nullptr;
-      }
-      if (async_remote_node->eager_client() != nullptr &&
-          async_remote_node->needs_remote_inputs() &&
-          async_remote_node->allow_multiple_pending_requests()) {
-        // We are running remote distributed function, update
-        // last_remote_device_name_.
-        last_eager_client_ = async_remote_node->eager_client();
-      }
+  if (async_remote_node != nullptr) {
+    tensorflow::Status status = MaybeSyncExecutors(async_remote_node);
+    if (!status.ok()) {
+      NodeDone(item, status, from_queue);
+      return status;
     }
   }
 
@@ -399,6 +414,72 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
   return status();
 }
 
+Status EagerExecutor::RunRemoteBatch(
+    std::vector<core::RefCountPtr<NodeItem>> items) {
+  DVLOG(3) << "Running " << items.size() << " remote nodes: [id "
+           << items.front()->id << " to " << items.back()->id << "]";
+  AsyncRemoteExecuteNode* first_node =
+      items.front()->node->AsAsyncRemoteExecuteNode();
+  // The nodes after the first one go to the same worker and don't need remote
+  // inputs, so the first one is the only one that may need to sync.
+  tensorflow::Status sync_status = MaybeSyncExecutors(first_node);
+  if (!sync_status.ok()) {
+    NodeDone(items.front(), sync_status, /*from_queue=*/true);
+    return sync_status;
+  }
+
+  std::vector<AsyncRemoteExecuteNode*> next_nodes;
+  std::vector<StatusCallback> dones;
+  {
+    tensorflow::mutex_lock l(node_queue_mutex_);
+    if (!status_.ok()) {
+      return status_;
+    }
+    for (core::RefCountPtr<NodeItem>& item : items) {
+      DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
+      node_queue_.pop_front();
+      item->state = NodeState::kSCHEDULED;
+      if (item->node->AsAsyncRemoteExecuteNode() != first_node) {
+        next_nodes.push_back(item->node->AsAsyncRemoteExecuteNode());
+      }
+      NodeItem* async_ref = item.get();
+      async_ref->Ref();
+      dones.push_back([this, async_ref](const Status& status) {
+        core::RefCountPtr<NodeItem> async_item(async_ref);
+        NodeDone(async_item, status, false);
+      });
+      unfinished_nodes_.emplace_hint(unfinished_nodes_.end(), item->id,
+                                     std::move(item));
+    }
+  }
+
+  first_node->RunAsyncBatch(next_nodes, std::move(dones));
+
+  // Return the status of the executor in case we are in an error state.
+  return status();
+}
+
+Status EagerExecutor::MaybeSyncExecutors(AsyncRemoteExecuteNode* node) {
+  if (!enable_async_wait_for_remote_function_) {
+    return Status::OK();
+  }
+  if (last_eager_client_ != nullptr && node->eager_client() != nullptr &&
+      last_eager_client_ != node->eager_client()) {
+    // Running a remote function, need to sync if the function is going to
+    // different device than last time we run remote distributed function.
+    DVLOG(3) << "Executing Sync Executor for node " << node->DebugString();
+    TF_RETURN_IF_ERROR(node->SyncExecutors());
+    last_eager_client_ = nullptr;
+  }
+  if (node->eager_client() != nullptr && node->needs_remote_inputs() &&
+      node->allow_multiple_pending_requests()) {
+    // We are running remote distributed function, update
+    // last_remote_device_name_.
+    last_eager_client_ = node->eager_client();
+  }
+  return Status::OK();
+}
+
 Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
                                        bool from_queue) {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -408,7 +489,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
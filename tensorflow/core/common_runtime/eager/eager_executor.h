@@ -17,9 +17,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <vector>
 
@@ -99,6 +99,22 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
   virtual bool needs_remote_inputs() const = 0;
   virtual bool allow_multiple_pending_requests() const = 0;
   virtual Status SyncExecutors() = 0;
+
+  // Remote nodes that are pending back to back can be sent to their worker in
+  // a single request, which runs them in order. Returns true if `next`, the
+  // node pending right after this one, can be sent in the same request.
+  virtual bool CanBatchWith(const AsyncRemoteExecuteNode& next) const {
+    return false;
+  }
+
+  // Runs this node and `next_nodes` in a single request. Each node in
+  // `next_nodes` can be batched with the one before it. `dones` holds the
+  // callback of this node followed by those of `next_nodes`.
+  virtual void RunAsyncBatch(
+      const std::vector<AsyncRemoteExecuteNode*>& next_nodes,
+      std::vector<StatusCallback> dones) {
+    LOG(FATAL) << "RunAsyncBatch is not supported by " << DebugString();
+  }
 };
 
 // A class for handling async execution (see TFE_ContextSetAsync).
@@ -107,7 +123,8 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
 // device of the input handle. Fix that.
 // TODO(agarwal): Implement support for control dependencies.
 // TODO(agarwal): Support out-of-order execution and dispatching multiple
-// EagerNode in parallel.
+// local EagerNodes in parallel. Consecutive remote nodes for the same worker
+// are already dispatched together, see AsyncRemoteExecuteNode::CanBatchWith.
 // TODO(agarwal): Implement optimizations over EagerNode traces.
 class EagerExecutor {
  public:
@@ -204,6 +221,14 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+
+  // Runs `items`, the async remote nodes at the front of node_queue_, in a
+  // single request.
+  Status RunRemoteBatch(std::vector<core::RefCountPtr<NodeItem>> items);
+
+  // Syncs the executors before running `node` if the last remote function
+  // with remote inputs ran on a different worker.
+  Status MaybeSyncExecutors(AsyncRemoteExecuteNode* node);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -221,7 +246,7 @@ class EagerExecutor {
   condition_variable nodes_pending_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -258,6 +283,10 @@ class EagerExecutor {
 
   const bool enable_async_wait_for_remote_function_;
 
+  // The largest number of pending remote nodes sent to a worker in a single
+  // request. 1 disables batching.
+  const int64 max_remote_batch_size_;
+
   // Callbacks to run on destruction.
   std::unordered_map<intptr_t, std::vector<std::function<void()>>> cleanups_;
 };
@@ -289,7 +289,28 @@ Status EagerOperation::Reset(
   DCHECK(inputs_.empty());
   ClearInferenceState();
   bool is_function = false;
-  TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, &is_function));
+  auto cached_metadata = op_metadata_cache_.find(op);
+  if (cached_metadata != op_metadata_cache_.end()) {
+    attr_types_ = cached_metadata->second.attr_types;
+    op_def_ = cached_metadata->second.op_def;
+    colocation_exempt_ = cached_metadata->second.colocation_exempt;
+  } else {
+    TF_RETURN_IF_ERROR(ResolveOpMetadata(op, remote, &is_function));
+  }
+  attrs_.Reset(op);
+  use_xla_ = false;
+  stack_trace_.reset();
+  is_function_ = is_function;
+  cancellation_manager_ = nullptr;
+  executor_ = executor ? executor : &ctx_.Executor();
+  remote_func_params_ = remote_func_params;
+  op_name_ = op;
+  return SetDeviceName(device_name);
+}
+
+Status EagerOperation::ResolveOpMetadata(const char* op, bool remote,
+                                         bool* is_function) {
+  TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, is_function));
 
   // Don't update the device of direct function calls.
   // Particularly, if the user did not explicitly request any device for this
@@ -297,12 +318,14 @@ Status EagerOperation::Reset(
   // for nodes inside the function. This is undesirable for multi-device
   // functions since the not-explicitly-placed nodes inside the body will all
   // end up on this default device.
-  colocation_exempt_ = is_function;
-  if (!is_function) {
+  colocation_exempt_ = *is_function;
+  if (!*is_function) {
     const auto& exempt_ops = InputColocationExemptionRegistry::Global()->Get();
     colocation_exempt_ = exempt_ops.find(op) != exempt_ops.end();
 
     TF_RETURN_IF_ERROR(OpDefForOp(op, &op_def_));
+    op_metadata_cache_.emplace(
+        op, OpMetadata{attr_types_, op_def_, colocation_exempt_});
   } else if (!remote && !ctx_.FindFunctionByName(op)) {
     return errors::NotFound(
         "'", op,
@@ -312,15 +335,7 @@ Status EagerOperation::Reset(
         ". Make sure the operation or function is "
         "registered in the binary running in this process.");
   }
-  attrs_.Reset(op);
-  use_xla_ = false;
-  stack_trace_.reset();
-  is_function_ = is_function;
-  cancellation_manager_ = nullptr;
-  executor_ = executor ? executor : &ctx_.Executor();
-  remote_func_params_ = remote_func_params;
-  op_name_ = op;
-  return SetDeviceName(device_name);
+  return Status::OK();
 }
 
 Status EagerOperation::MaybeInferSingleInputAttrs(TensorHandle* handle) {
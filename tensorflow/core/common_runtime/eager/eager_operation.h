@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EAGER_OPERATION_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EAGER_OPERATION_H_
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/common_runtime/eager/thread_local_free_list.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
@@ -44,6 +46,15 @@ class EagerOperation : public ImmediateExecutionOperation {
     }
   }
 
+  // Operations that aren't reused, e.g. those a remote worker creates for
+  // every enqueued op, recycle their memory.
+  static void* operator new(size_t size) {
+    return ThreadLocalFreeList<EagerOperation>::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    ThreadLocalFreeList<EagerOperation>::Deallocate(ptr, size);
+  }
+
   void Release() override { delete this; }
 
   void Clear() override;
@@ -186,6 +197,10 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   const tensorflow::OpDef* GetOpDef(Status* status);
 
+  // Looks up the metadata of 'op' for Reset(), and caches it if 'op' is a
+  // primitive op.
+  Status ResolveOpMetadata(const char* op, bool remote, bool* is_function);
+
   void ClearInferenceState() {
     op_def_ = nullptr;
     inference_arg_idx_ = 0;
@@ -200,6 +215,14 @@ class EagerOperation : public ImmediateExecutionOperation {
   void InferMixedTypeInputListAttrs(const OpDef::ArgDef& input_def,
                                     const std::vector<DataType>& dtypes);
 
+  // The metadata of a primitive op, which Reset() would otherwise look up in
+  // the global op registries, under their locks, every time.
+  struct OpMetadata {
+    const AttrTypeMap* attr_types;
+    const tensorflow::OpDef* op_def;
+    bool colocation_exempt;
+  };
+
   tensorflow::EagerContext& ctx_;
   const char* op_name_ = nullptr;
   AttrBuilder attrs_;
@@ -240,6 +263,12 @@ class EagerOperation : public ImmediateExecutionOperation {
   int inference_arg_idx_;  // arg definition index for the next input to be
                            // added
   gtl::FlatSet<std::string> inference_attrs_;  // attributes inferred so far
+
+  // The metadata of the primitive ops this operation was reset to so far, by
+  // op name. Ops are never unregistered, so the entries stay valid for the
+  // life of the operation, which typically is reused for every op a thread
+  // executes eagerly.
+  absl::flat_hash_map<string, OpMetadata> op_metadata_cache_;
 };
 
 inline void EagerOperation::UpdateInput(int i, TensorHandle* h) {
@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle_data.h"
+#include "tensorflow/core/common_runtime/eager/thread_local_free_list.h"
 #include "tensorflow/core/common_runtime/function.h"
 #if !defined(IS_MOBILE_PLATFORM)
 #include "tensorflow/core/distributed_runtime/eager/remote_tensor_handle_data.h"
@@ -109,6 +110,14 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
                                               Device* d, EagerContext* ctx);
 #endif  // IS_MOBILE_PLATFORM
 
+  // Every eager op creates and destroys handles, so their memory is recycled.
+  static void* operator new(size_t size) {
+    return ThreadLocalFreeList<TensorHandle>::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    ThreadLocalFreeList<TensorHandle>::Deallocate(ptr, size);
+  }
+
   void Release() override;
 
   tensorflow::DataType DataType() const override;
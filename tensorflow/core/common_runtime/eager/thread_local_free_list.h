@@ -0,0 +1,99 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_THREAD_LOCAL_FREE_LIST_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_THREAD_LOCAL_FREE_LIST_H_
+
+#include <cstddef>
+#include <new>
+
+namespace tensorflow {
+
+// Recycles the memory of objects of type T that are created and destroyed at
+// a high rate, e.g. for every eager op, to save the malloc and free calls.
+// Each thread keeps up to `kMaxSize` freed blocks of sizeof(T) bytes, and
+// hands them out to the next allocations on that thread. Blocks freed on
+// another thread than the one that allocated them simply move to the free
+// list of the freeing thread.
+//
+// T uses it by overloading its class-specific operator new and delete:
+//
+//   static void* operator new(size_t size) {
+//     return ThreadLocalFreeList<T>::Allocate(size);
+//   }
+//   static void operator delete(void* ptr, size_t size) {
+//     ThreadLocalFreeList<T>::Deallocate(ptr, size);
+//   }
+//
+// Allocations of any other size, e.g. of subclasses of T, go to the global
+// operator new and delete.
+template <typename T, int kMaxSize = 256>
+class ThreadLocalFreeList {
+ public:
+  static void* Allocate(size_t size) {
+    FreeList& free_list = GetFreeList();
+    if (size != sizeof(T) || free_list.head == nullptr) {
+      return ::operator new(size);
+    }
+    Block* block = free_list.head;
+    free_list.head = block->next;
+    --free_list.size;
+    return block;
+  }
+
+  static void Deallocate(void* ptr, size_t size) {
+    FreeList& free_list = GetFreeList();
+    if (size != sizeof(T) || free_list.size >= kMaxSize) {
+      ::operator delete(ptr);
+      return;
+    }
+    Block* block = static_cast<Block*>(ptr);
+    block->next = free_list.head;
+    free_list.head = block;
+    ++free_list.size;
+  }
+
+ private:
+  static_assert(sizeof(T) >= sizeof(void*),
+                "T is too small to hold a free list entry");
+
+  struct Block {
+    Block* next;
+  };
+
+  struct FreeList {
+    ~FreeList() {
+      while (head != nullptr) {
+        Block* block = head;
+        head = block->next;
+        ::operator delete(block);
+      }
+      // Objects destroyed later during the exit of this thread free their
+      // memory right away.
+      size = kMaxSize;
+    }
+
+    Block* head = nullptr;
+    int size = 0;
+  };
+
+  static FreeList& GetFreeList() {
+    static thread_local FreeList free_list;
+    return free_list;
+  }
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_THREAD_LOCAL_FREE_LIST_H_
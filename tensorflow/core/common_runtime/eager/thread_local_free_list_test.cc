@@ -0,0 +1,80 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/eager/thread_local_free_list.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+struct Pooled {
+  static void* operator new(size_t size) {
+    return ThreadLocalFreeList<Pooled, 2>::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    ThreadLocalFreeList<Pooled, 2>::Deallocate(ptr, size);
+  }
+  virtual ~Pooled() {}
+
+  int64 value = 0;
+};
+
+struct LargerPooled : public Pooled {
+  int64 other_value = 0;
+};
+
+TEST(ThreadLocalFreeListTest, ReusesFreedMemory) {
+  Pooled* first = new Pooled;
+  Pooled* second = new Pooled;
+  delete first;
+  delete second;
+
+  // The most recently freed block is handed out first.
+  Pooled* third = new Pooled;
+  EXPECT_EQ(third, second);
+  Pooled* fourth = new Pooled;
+  EXPECT_EQ(fourth, first);
+  delete third;
+  delete fourth;
+}
+
+TEST(ThreadLocalFreeListTest, KeepsAtMostMaxSizeBlocks) {
+  Pooled* pooled[3] = {new Pooled, new Pooled, new Pooled};
+  for (Pooled* p : pooled) {
+    delete p;
+  }
+  // Only the first two freed blocks are kept.
+  Pooled* first = new Pooled;
+  Pooled* second = new Pooled;
+  EXPECT_EQ(first, pooled[1]);
+  EXPECT_EQ(second, pooled[0]);
+  delete first;
+  delete second;
+}
+
+TEST(ThreadLocalFreeListTest, SubclassesUseGlobalAllocator) {
+  Pooled* pooled = new Pooled;
+  delete pooled;
+  Pooled* larger = new LargerPooled;
+  EXPECT_NE(larger, pooled);
+  delete larger;
+  Pooled* reused = new Pooled;
+  EXPECT_EQ(reused, pooled);
+  delete reused;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -25,10 +25,12 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/kernel_params_block.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -116,6 +118,12 @@ void SetMemory(NodeExecStatsInterface* stats, OpKernelContext* ctx) {
   stats->SetMemory(ctx);
 }
 
+void SetDeviceComputeTime(NodeExecStatsInterface* stats,
+                          OpKernelContext* ctx) {
+  if (!stats) return;
+  stats->SetDeviceComputeTime(ctx);
+}
+
 }  // namespace nodestats
 
 // Time the execution of kernels (in CPU cycles).  Used to dynamically identify
@@ -128,6 +136,11 @@ struct KernelTimer {
   }
 };
 
+// The estimated cost (in CPU cycles) of the inexpensive nodes that a thread
+// runs inline after a node makes them ready, and of the batches in which the
+// further inexpensive nodes are dispatched. Roughly a few threadpool hops.
+constexpr uint64 kInlineBudgetCycles = 50 * 1000;
+
 // TODO(b/152925936): Re-evaluate these constants with current usage patterns.
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
@@ -149,19 +162,34 @@ class ExecutorImpl : public Executor {
   friend class ExecutorState;
 
   // Stores execution time information about the kernels in an executor's graph.
+  //
+  // The kernels that may be expensive are timed on every execution while they
+  // are considered expensive, and on a sample of their executions otherwise.
+  // The timings of each node are counted in a histogram over exponentially
+  // growing buckets, whose median drives the node's cost estimate. Unlike a
+  // moving average, the median is not skewed by the occasional slow execution,
+  // and it follows a kernel whose cost changes in either direction.
   class KernelStats {
    public:
     KernelStats() = default;
 
     void Initialize(const GraphView& gview) {
-      is_expensive_ = absl::make_unique<std::atomic<bool>[]>(gview.num_nodes());
+      const int32 num_nodes = gview.num_nodes();
+      may_be_expensive_ = absl::make_unique<bool[]>(num_nodes);
+      is_expensive_ = absl::make_unique<std::atomic<bool>[]>(num_nodes);
       cost_estimates_ =
-          absl::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
-      for (int32 i = 0; i < gview.num_nodes(); ++i) {
+          absl::make_unique<std::atomic_uint_fast64_t[]>(num_nodes);
+      num_executions_ = absl::make_unique<std::atomic<uint32>[]>(num_nodes);
+      cost_histograms_ = absl::make_unique<std::atomic<uint32>[]>(
+          static_cast<size_t>(num_nodes) * kNumCostBuckets);
+      for (int32 i = 0; i < num_nodes; ++i) {
         if (gview.node(i)) {
-          is_expensive_[i] =
+          may_be_expensive_[i] =
               gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
-          cost_estimates_[i] = kInitialCostEstimateCycles;
+          is_expensive_[i] = may_be_expensive_[i];
+          cost_estimates_[i] = may_be_expensive_[i]
+                                   ? kInitialCostEstimateCycles
+                                   : kInexpensiveCostEstimateCycles;
         }
       }
     }
@@ -170,45 +198,110 @@ class ExecutorImpl : public Executor {
     // executor uses this flag to optimize graph execution, for example
     // by "inlining" inexpensive kernels.
     bool IsExpensive(const NodeItem& node) const {
-      return is_expensive_[node.node_id] &&
-             (cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
-              kOpIsExpensiveThresholdCycles);
+      return is_expensive_[node.node_id].load(std::memory_order_relaxed);
     }
 
-    // Updates the dynamic cost estimate, which is used to determine whether the
-    // given node is expensive. The new cost estimate is a weighted average of
-    // the old cost estimate and the latest cost.
-    //
-    // NOTE: We currently only expect updates to the cost estimate when
-    // `is_expensive_[node.node_id]` is true (or at least, it *was* true, when
-    // we started to execute the kernel. As a result, we expect that a kernel
-    // can only ever transition from "expensive" to "inexpensive", but not vice
-    // versa.
+    // Returns the estimated cost of the given node, in CPU cycles.
+    uint64 CostEstimate(const NodeItem& node) const {
+      return cost_estimates_[node.node_id].load(std::memory_order_relaxed);
+    }
+
+    // Returns true if the next execution of the given node should be timed and
+    // passed to `UpdateCostEstimate()`.
+    bool ShouldTime(const NodeItem& node) {
+      const int32 id = node.node_id;
+      if (!may_be_expensive_[id]) return false;
+      if (is_expensive_[id].load(std::memory_order_relaxed)) return true;
+      // N.B. The counter is updated without a read-modify-write, because a
+      // lost increment only shifts the sample.
+      const uint32 n = num_executions_[id].load(std::memory_order_relaxed);
+      num_executions_[id].store(n + 1, std::memory_order_relaxed);
+      return n % kInexpensiveSampleInterval == 0;
+    }
+
+    // Records the cost of one execution of the given node, and updates the
+    // estimate once enough executions have been recorded.
     void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
-      // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
-      // updates may result in one or more updates being ignored.  This does not
-      // affect correctness but may slow down the update frequency.
-      std::atomic_uint_fast64_t& cost_estimate = cost_estimates_[node.node_id];
-      uint64 new_estimate = (kCostDecay - 1) *
-                                cost_estimate.load(std::memory_order_relaxed) /
-                                kCostDecay +
-                            (elapsed_cycles / kCostDecay);
-      cost_estimate.store(new_estimate, std::memory_order_relaxed);
-      if (new_estimate < kOpIsExpensiveThresholdCycles) {
-        is_expensive_[node.node_id].store(false, std::memory_order_relaxed);
+      // N.B. Updates to the histogram are atomic but unlocked. Simultaneous
+      // updates may lose a sample or a halving, which does not affect
+      // correctness.
+      std::atomic<uint32>* histogram =
+          &cost_histograms_[static_cast<size_t>(node.node_id) *
+                            kNumCostBuckets];
+      histogram[CostBucket(elapsed_cycles)].fetch_add(
+          1, std::memory_order_relaxed);
+
+      uint32 counts[kNumCostBuckets];
+      uint32 total = 0;
+      for (int b = 0; b < kNumCostBuckets; ++b) {
+        counts[b] = histogram[b].load(std::memory_order_relaxed);
+        total += counts[b];
+      }
+      if (total < kMinSamples) return;
+      if (total >= kMaxSamples) {
+        // Decay the histogram, so that it reflects the recent executions.
+        for (int b = 0; b < kNumCostBuckets; ++b) {
+          histogram[b].store(counts[b] / 2, std::memory_order_relaxed);
+        }
+      }
+
+      int median = 0;
+      uint32 seen = 0;
+      for (; median < kNumCostBuckets - 1; ++median) {
+        seen += counts[median];
+        if (2 * seen >= total) break;
       }
+      const uint64 new_estimate = BucketCost(median);
+      cost_estimates_[node.node_id].store(new_estimate,
+                                          std::memory_order_relaxed);
+      is_expensive_[node.node_id].store(
+          new_estimate > kOpIsExpensiveThresholdCycles,
+          std::memory_order_relaxed);
     }
 
    private:
+    // Returns the histogram bucket of a cost. Bucket 0 holds the costs below
+    // kFirstBucketCycles, and each further bucket spans twice the range of the
+    // previous one. The last bucket is unbounded.
+    static int CostBucket(uint64 cycles) {
+      int bucket = 0;
+      for (uint64 bound = kFirstBucketCycles;
+           bucket < kNumCostBuckets - 1 && cycles >= bound; bound *= 2) {
+        ++bucket;
+      }
+      return bucket;
+    }
+
+    // Returns the cost that represents the executions in a bucket.
+    static uint64 BucketCost(int bucket) {
+      if (bucket == 0) return kFirstBucketCycles / 2;
+      const uint64 lower = kFirstBucketCycles << (bucket - 1);
+      return bucket == kNumCostBuckets - 1 ? 2 * lower : lower + lower / 2;
+    }
+
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
     // Operations start out "expensive".
     static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
     static constexpr uint64 kOpIsExpensiveThresholdCycles = 5000;
-    static constexpr uint64 kCostDecay = 10;
-
+    // The estimate for kernels that declare themselves inexpensive, which are
+    // never timed.
+    static constexpr uint64 kInexpensiveCostEstimateCycles = 1000;
+    // One in this many executions of an inexpensive kernel is timed.
+    static constexpr uint32 kInexpensiveSampleInterval = 64;
+    static constexpr int kNumCostBuckets = 12;
+    static constexpr uint64 kFirstBucketCycles = 512;
+    // The number of samples needed before the histogram replaces the initial
+    // estimate, and the number at which it is decayed.
+    static constexpr uint32 kMinSamples = 3;
+    static constexpr uint32 kMaxSamples = 64;
+
+    std::unique_ptr<bool[]> may_be_expensive_;
     std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+    std::unique_ptr<std::atomic<uint32>[]> num_executions_;
+    // kNumCostBuckets counts per node, indexed by node ID.
+    std::unique_ptr<std::atomic<uint32>[]> cost_histograms_;
   };
 
   ImmutableExecutorState immutable_state_;
@@ -289,7 +382,7 @@ class ExecutorState {
   void Process(TaggedNode node, int64 scheduled_nsec);
 
   Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
-                     EntryVector* outputs, NodeExecStatsInterface* stats);
+                     KernelParamsBlock* block, NodeExecStatsInterface* stats);
   void ProcessAsync(const NodeItem& item, const OpKernelContext::Params& params,
                     const TaggedNode& tagged_node, Entry* first_input,
                     NodeExecStatsInterface* stats);
@@ -315,14 +408,20 @@ class ExecutorState {
                 NodeExecStatsInterface* stats,
                 TaggedNodeReadyQueue* inline_ready);
 
-  // Schedule all the expensive nodes in '*ready', and put all the inexpensive
-  // nodes in 'ready' into 'inline_ready'.
+  // Schedule all the expensive nodes in '*ready', and put the inexpensive
+  // nodes in 'ready' into 'inline_ready' up to an estimated cost of
+  // kInlineBudgetCycles. The remaining inexpensive nodes, or all of them if
+  // 'inline_ready' is null, are scheduled in batches.
   //
   // This method will clear `*ready` before returning.
   //
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Schedules the nodes in '*batch' to run one after the other in a single
+  // closure, and clears '*batch'.
+  void ScheduleBatch(TaggedNodeSeq* batch, int64 scheduled_nsec);
+
   // Clean up when this executor is done.
   void Finish();
   void ScheduleFinish();
@@ -346,6 +445,9 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  // Allocator for the step-local tensors of stateless kernels, if the device
+  // provides one. Released when this executor invocation finishes.
+  StepArenaAllocator* step_arena_;
   StepStatsCollectorInterface* const stats_collector_;
   const tracing::EventCollector* const event_collector_;
   Context context_;
@@ -394,6 +496,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       session_metadata_(immutable_state.params().session_metadata),
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
+      step_arena_(immutable_state.params().device->NewStepArenaAllocator()),
       stats_collector_(args.stats_collector),
       event_collector_(
           tracing::GetEventCollector(tracing::EventCategory::kCompute)),
@@ -421,6 +524,9 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (step_arena_) {
+    step_arena_->Release();
+  }
 }
 
 template <class PropagatorStateType>
@@ -516,10 +622,10 @@ bool MightTrace(const tracing::EventCollector* event_collector,
 
 template <class PropagatorStateType>
 Status ExecutorState<PropagatorStateType>::ProcessSync(
-    const NodeItem& item, OpKernelContext::Params* params, EntryVector* outputs,
-    NodeExecStatsInterface* stats) {
+    const NodeItem& item, OpKernelContext::Params* params,
+    KernelParamsBlock* block, NodeExecStatsInterface* stats) {
   Status s;
-  OpKernelContext ctx(params, item.num_outputs);
+  OpKernelContext ctx(params, item.num_outputs, block->context_outputs());
   nodestats::SetOpStart(stats);
 
   OpKernel* op_kernel = item.kernel;
@@ -538,7 +644,7 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
     device->Compute(op_kernel, &ctx);
   } else {
     // In the common case, avoid creating any tracing objects.
-    if (is_expensive) {
+    if (kernel_stats_->ShouldTime(item)) {
       KernelTimer timer;
       device->Compute(op_kernel, &ctx);
       kernel_stats_->UpdateCostEstimate(item, timer.ElapsedCycles());
@@ -547,9 +653,11 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
     }
   }
   nodestats::SetOpEnd(stats);
+  EntryVector* outputs = block->outputs();
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
   nodestats::SetMemory(stats, &ctx);
+  nodestats::SetDeviceComputeTime(stats, &ctx);
   return s;
 }
 
@@ -572,6 +680,7 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
     EntryVector outputs(state->item->num_outputs);
     Status s = ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
     nodestats::SetMemory(stats, &state->ctx);
+    nodestats::SetDeviceComputeTime(stats, &state->ctx);
     if (vlog_) {
       VLOG(2) << "Async kernel done: " << state->item->node_id << " step "
               << step_id_ << " " << SummarizeNodeDef(state->item->kernel->def())
@@ -646,9 +755,12 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   TaggedNodeSeq ready;
   TaggedNodeReadyQueue inline_ready;
 
-  // Parameters passed to OpKernel::Compute.
-  TensorValueVec inputs;
-  AllocatorAttributeVec input_alloc_attrs;
+  // Parameters passed to OpKernel::Compute, in a block that keeps the capacity
+  // of its vectors across calls.
+  KernelParamsBlock* block = KernelParamsBlock::Acquire(
+      immutable_state_.max_num_inputs(), immutable_state_.max_num_outputs());
+  TensorValueVec& inputs = *block->inputs();
+  AllocatorAttributeVec& input_alloc_attrs = *block->input_alloc_attrs();
 
   OpKernelContext::Params params;
   params.step_id = step_id_;
@@ -702,7 +814,8 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   Status s;
   NodeExecStatsInterface* stats = nullptr;
 
-  EntryVector outputs(1);
+  EntryVector& outputs = *block->outputs();
+  outputs.resize(1);
 
   bool completed = false;
   inline_ready.push_back(tagged_node);
@@ -714,6 +827,12 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
 
     propagator_.MaybeMarkStarted(tagged_node);
 
+    // Nodes that the device placed on another stream carry their own context.
+    DeviceContext* node_device_context = immutable_state_.device_context(id);
+    params.op_device_context = node_device_context != nullptr
+                                   ? node_device_context
+                                   : device_context_;
+
     params.track_allocations = false;
     stats = nullptr;
     if (stats_collector_ && !tagged_node.get_is_dead()) {
@@ -768,12 +887,14 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
       params.output_attr_array = item.output_attrs();
       params.forward_from_array = item.forward_from();
       params.outputs_required_array = item.outputs_required.get();
+      params.step_arena_allocator = item.is_stateful ? nullptr : step_arena_;
+      params.outputs_escape_step = item.outputs_may_escape_step;
 
       if (item.kernel_is_async) {
         ProcessAsync(item, params, tagged_node, first_input, stats);
         launched_asynchronously = true;
       } else {
-        s = ProcessSync(item, &params, &outputs, stats);
+        s = ProcessSync(item, &params, block, stats);
       }
     }
 
@@ -809,6 +930,7 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
       completed = NodeDone(s, &ready, stats, &inline_ready);
     }
   }  // while !inline_ready.empty()
+  KernelParamsBlock::Release(block);
 
   // This thread of computation is done if completed = true.
   if (completed) ScheduleFinish();
@@ -1127,29 +1249,47 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       }
     }
   } else {
+    // Inexpensive nodes run inline on this thread until their estimated cost
+    // exceeds the inline budget. The others are dispatched in batches of
+    // about that cost, so that each batch pays for one threadpool hop.
     const TaggedNode* curr_expensive_node = nullptr;
-    if (inline_ready == nullptr) {
-      // Schedule to run all the ready ops in thread pool.
-      for (auto& tagged_node : *ready) {
-        runner_([=]() { Process(tagged_node, scheduled_nsec); });
-      }
-    } else {
-      for (auto& tagged_node : *ready) {
-        const NodeItem& item = *tagged_node.node_item;
-        if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+    TaggedNodeSeq batch;
+    uint64 inline_cost = 0;
+    uint64 batch_cost = 0;
+    for (auto& tagged_node : *ready) {
+      const NodeItem& item = *tagged_node.node_item;
+      if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+        const uint64 cost =
+            tagged_node.get_is_dead() ? 0 : kernel_stats_->CostEstimate(item);
+        if (inline_ready != nullptr &&
+            (inline_cost == 0 || inline_cost + cost <= kInlineBudgetCycles)) {
           // Inline this inexpensive node.
           inline_ready->push_back(tagged_node);
+          inline_cost += cost;
         } else {
-          if (curr_expensive_node) {
-            // Dispatch to another thread since there is plenty of work to
-            // do for this thread.
-            runner_(std::bind(&ExecutorState::Process, this,
-                              *curr_expensive_node, scheduled_nsec));
+          batch.push_back(tagged_node);
+          batch_cost += cost;
+          if (batch_cost >= kInlineBudgetCycles) {
+            ScheduleBatch(&batch, scheduled_nsec);
+            batch_cost = 0;
           }
-          curr_expensive_node = &tagged_node;
         }
+      } else if (inline_ready == nullptr) {
+        // Schedule to run the expensive op in thread pool.
+        runner_([=]() { Process(tagged_node, scheduled_nsec); });
+      } else {
+        if (curr_expensive_node) {
+          // Dispatch to another thread since there is plenty of work to
+          // do for this thread.
+          runner_(std::bind(&ExecutorState::Process, this,
+                            *curr_expensive_node, scheduled_nsec));
+        }
+        curr_expensive_node = &tagged_node;
       }
     }
+    if (!batch.empty()) {
+      ScheduleBatch(&batch, scheduled_nsec);
+    }
     if (curr_expensive_node) {
       if (inline_ready->empty()) {
         inline_ready->push_back(*curr_expensive_node);
@@ -1164,6 +1304,22 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ScheduleBatch(TaggedNodeSeq* batch,
+                                                       int64 scheduled_nsec) {
+  if (batch->size() == 1) {
+    const TaggedNode tagged_node = batch->front();
+    runner_([=]() { Process(tagged_node, scheduled_nsec); });
+  } else {
+    runner_([this, batch = std::move(*batch), scheduled_nsec]() {
+      for (auto& tagged_node : batch) {
+        Process(tagged_node, scheduled_nsec);
+      }
+    });
+  }
+  batch->clear();
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -514,6 +514,35 @@ BENCHMARK(BM_const_identity)->ArgPair(1, 100);
 BENCHMARK(BM_const_identity)->ArgPair(100, 1);
 BENCHMARK(BM_const_identity)->ArgPair(100, 100);
 
+// Create a graph of 'width' independent chains of 'depth' scalar additions.
+// Each addition is much cheaper than a threadpool hop, so the benchmark shows
+// the per-node overhead of the executor, and how well it runs cheap successors
+// inline and batches cheap nodes that become ready together.
+static void BM_cheap_op_chains(int iters, int width, int depth) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* one = test::graph::Constant(g, V(1.0));
+  for (int i = 0; i < width; ++i) {
+    Node* v = one;
+    for (int j = 0; j < depth; ++j) {
+      v = test::graph::Add(g, v, one);
+    }
+  }
+#ifdef PLATFORM_GOOGLE
+  SetBenchmarkLabel(strings::StrCat("Nodes = ", 1 + width * depth));
+  SetBenchmarkItemsProcessed((1 + width * depth) * static_cast<int64>(iters));
+#endif  // PLATFORM_GOOGLE
+  FixupSourceAndSinkEdges(g);
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+// One long chain.
+BENCHMARK(BM_cheap_op_chains)->ArgPair(1, 1024);
+// Fan-out of short chains.
+BENCHMARK(BM_cheap_op_chains)->ArgPair(256, 4);
+BENCHMARK(BM_cheap_op_chains)->ArgPair(1024, 1);
+
 static void BM_FeedInputFetchOutput(int iters) {
   testing::StopTiming();
   Graph* g = new Graph(OpRegistry::Global());
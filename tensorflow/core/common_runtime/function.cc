@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/function_body_cache.h"
 #include "tensorflow/core/common_runtime/gradients.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
@@ -409,13 +410,13 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
     uint64 instantiation_counter = 0;
     std::unique_ptr<const Graph> graph = nullptr;
     const FunctionLibraryDefinition* lib_def = nullptr;  // Not owned.
-    FunctionBody* func_graph = nullptr;
+    // May be shared with other runtimes, see FunctionBodyCache.
+    std::shared_ptr<const FunctionBody> func_graph;
     Executor* exec = nullptr;
     FunctionLibraryRuntimeOverlay* overlay_flr = nullptr;
     string executor_type;
 
     ~Item() {
-      delete this->func_graph;
       delete this->exec;
       delete this->overlay_flr;
     }
@@ -581,7 +582,7 @@ const FunctionBody* FunctionLibraryRuntimeImpl::GetFunctionBody(Handle h) {
   tf_shared_lock l(mu_);
   auto iter = items_->find(local_handle);
   CHECK(iter != items_->end());
-  return iter->second->func_graph;
+  return iter->second->func_graph.get();
 }
 
 Status FunctionLibraryRuntimeImpl::GetRetTypes(Handle h,
@@ -774,7 +775,7 @@ Status FunctionLibraryRuntimeImpl::Instantiate(
 
   const FunctionLibraryDefinition* lib_def =
       options.lib_def ? options.lib_def : base_lib_def_;
-  std::unique_ptr<FunctionBody> fbody;
+  std::shared_ptr<const FunctionBody> fbody;
   if (function_name == kGradientOp) {
     const AttrValue* f = attrs.Find(kFuncAttr);
     if (f == nullptr) {
@@ -788,13 +789,20 @@ Status FunctionLibraryRuntimeImpl::Instantiate(
     if (!grad.empty()) {
       return Instantiate(grad, AttrSlice(&func.attr()), options, handle);
     }
-    TF_RETURN_IF_ERROR(InstantiateSymbolicGradient(func, lib_def, &fbody));
+    std::unique_ptr<FunctionBody> g_body;
+    TF_RETURN_IF_ERROR(InstantiateSymbolicGradient(func, lib_def, &g_body));
+    fbody = std::move(g_body);
   } else {
     const FunctionDef* fdef = lib_def->Find(function_name);
     if (fdef == nullptr) {
       return errors::NotFound("Function ", function_name, " is not defined.");
     }
-    TF_RETURN_IF_ERROR(FunctionDefToBody(*fdef, attrs, lib_def, &fbody));
+    TF_RETURN_IF_ERROR(FunctionBodyCache::Global()->GetOrCreate(
+        *fdef, attrs, lib_def,
+        [this, fdef, &attrs, lib_def](std::unique_ptr<FunctionBody>* body) {
+          return FunctionDefToBody(*fdef, attrs, lib_def, body);
+        },
+        &fbody));
   }
 
   LocalHandle local_handle;
@@ -807,7 +815,7 @@ Status FunctionLibraryRuntimeImpl::Instantiate(
     } else {
       *handle = parent_->AddHandle(key, device_name_, next_handle_);
       Item* item = new Item;
-      item->func_graph = fbody.release();
+      item->func_graph = std::move(fbody);
       item->instantiation_counter = 1;
       item->executor_type = ExecutorType(options, attrs);
       if (options.lib_def) {
@@ -910,7 +918,7 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
   string executor_type;
   {
     tf_shared_lock l(mu_);
-    fbody = (*item)->func_graph;
+    fbody = (*item)->func_graph.get();
     flr = (*item)->overlay_flr
               ? static_cast<FunctionLibraryRuntime*>((*item)->overlay_flr)
               : static_cast<FunctionLibraryRuntime*>(this);
@@ -0,0 +1,125 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/function_body_cache.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Returns true if the nodes of `fbody` only use ops of the global registry,
+// in which case the body doesn't depend on `lib_def`.
+bool IsShareable(const FunctionBody& fbody,
+                 const FunctionLibraryDefinition* lib_def) {
+  if (lib_def->default_registry() != OpRegistry::Global()) return false;
+  for (const Node* node : fbody.graph->nodes()) {
+    if (lib_def->Contains(node->type_string())) return false;
+    const OpRegistrationData* op_reg_data;
+    if (!OpRegistry::Global()->LookUp(node->type_string(), &op_reg_data).ok() ||
+        &op_reg_data->op_def != &node->op_def()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+/* static */ FunctionBodyCache* FunctionBodyCache::Global() {
+  static FunctionBodyCache* cache = new FunctionBodyCache;
+  return cache;
+}
+
+Status FunctionBodyCache::GetOrCreate(
+    const FunctionDef& fdef, AttrSlice attrs,
+    const FunctionLibraryDefinition* lib_def,
+    const std::function<Status(std::unique_ptr<FunctionBody>*)>& create,
+    std::shared_ptr<const FunctionBody>* fbody) {
+  string serialized_fdef;
+  if (!SerializeToStringDeterministic(fdef, &serialized_fdef)) {
+    std::unique_ptr<FunctionBody> body;
+    TF_RETURN_IF_ERROR(create(&body));
+    *fbody = std::move(body);
+    return Status::OK();
+  }
+  const string attrs_key = Canonicalize(fdef.signature().name(), attrs);
+  const string key =
+      strings::StrCat(attrs_key.size(), ":", attrs_key, serialized_fdef);
+  {
+    mutex_lock l(mu_);
+    auto it = bodies_.find(key);
+    if (it != bodies_.end()) {
+      std::shared_ptr<const FunctionBody> cached = it->second.lock();
+      if (cached != nullptr) {
+        *fbody = std::move(cached);
+        return Status::OK();
+      }
+    }
+  }
+
+  std::unique_ptr<FunctionBody> body;
+  TF_RETURN_IF_ERROR(create(&body));
+  if (!IsShareable(*body, lib_def)) {
+    *fbody = std::move(body);
+    return Status::OK();
+  }
+  // The graph of `body` looks up its ops in `lib_def`, which may not outlive
+  // the other users of the body, so the shared body gets a copy of the graph
+  // that looks them up in the global registry.
+  Graph* graph = new Graph(OpRegistry::Global());
+  CopyGraph(*body->graph, graph);
+  std::shared_ptr<const FunctionBody> shared = std::make_shared<FunctionBody>(
+      body->fdef, body->arg_types, body->ret_types, graph);
+
+  mutex_lock l(mu_);
+  std::weak_ptr<const FunctionBody>& entry = bodies_[key];
+  std::shared_ptr<const FunctionBody> cached = entry.lock();
+  if (cached != nullptr) {
+    // Another runtime instantiated the same body concurrently.
+    *fbody = std::move(cached);
+  } else {
+    entry = shared;
+    *fbody = std::move(shared);
+  }
+  if (bodies_.size() > sweep_size_) {
+    for (auto it = bodies_.begin(); it != bodies_.end();) {
+      if (it->second.expired()) {
+        bodies_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    sweep_size_ = std::max<size_t>(64, 2 * bodies_.size());
+  }
+  return Status::OK();
+}
+
+int FunctionBodyCache::NumCachedBodies() {
+  mutex_lock l(mu_);
+  int num_bodies = 0;
+  for (const auto& entry : bodies_) {
+    if (!entry.second.expired()) ++num_bodies;
+  }
+  return num_bodies;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,75 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_BODY_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_BODY_CACHE_H_
+
+#include <functional>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/function_body.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A process-wide cache of the bodies of instantiated functions.
+//
+// The same functions are instantiated by many FunctionLibraryRuntimes, e.g.
+// the runtime of each device of a ProcessFunctionLibraryRuntime, or the
+// runtimes cloned for each tf.data iterator.  A body that only uses
+// registered ops doesn't depend on the library it was instantiated from, so
+// it is shared by all the runtimes that instantiate the same FunctionDef with
+// the same attrs.  The bodies are refcounted, and leave the cache once no
+// runtime uses them.
+//
+// Executors are not shared: their kernels are bound to a device and to the
+// runtime that created them.
+class FunctionBodyCache {
+ public:
+  // Returns the cache shared by all FunctionLibraryRuntimes of the process.
+  static FunctionBodyCache* Global();
+
+  FunctionBodyCache() = default;
+
+  // Sets `*fbody` to the body of `fdef` instantiated with `attrs`.  Unless
+  // the body is cached, calls `create` to instantiate it from `lib_def`, and
+  // caches the body if it can be shared.
+  Status GetOrCreate(
+      const FunctionDef& fdef, AttrSlice attrs,
+      const FunctionLibraryDefinition* lib_def,
+      const std::function<Status(std::unique_ptr<FunctionBody>*)>& create,
+      std::shared_ptr<const FunctionBody>* fbody);
+
+  // Returns the number of cached bodies that are still in use.
+  int NumCachedBodies();
+
+ private:
+  mutex mu_;
+  // The bodies keyed by their canonical attrs and serialized FunctionDef.
+  absl::flat_hash_map<string, std::weak_ptr<const FunctionBody>> bodies_
+      TF_GUARDED_BY(mu_);
+  // Number of entries of `bodies_` above which the unused bodies are dropped.
+  size_t sweep_size_ TF_GUARDED_BY(mu_) = 64;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FunctionBodyCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_BODY_CACHE_H_
@@ -0,0 +1,109 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/function_body_cache.h"
+
+#include "tensorflow/core/common_runtime/function_def_utils.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FunctionBodyCacheTest : public ::testing::Test {
+ protected:
+  FunctionBodyCacheTest() {
+    FunctionDefLibrary proto;
+    *proto.add_function() = test::function::XTimesTwo();
+    *proto.add_function() = test::function::XTimesFour();
+    lib_def_.reset(new FunctionLibraryDefinition(OpRegistry::Global(), proto));
+    other_lib_def_.reset(
+        new FunctionLibraryDefinition(OpRegistry::Global(), proto));
+  }
+
+  // Gets the body of `name` for T=`dtype`, instantiated from `lib_def`.
+  Status GetBody(const string& name, DataType dtype,
+                 const FunctionLibraryDefinition* lib_def,
+                 std::shared_ptr<const FunctionBody>* fbody) {
+    const FunctionDef* fdef = lib_def->Find(name);
+    AttrValueMap attrs;
+    attrs["T"].set_type(dtype);
+    return cache_.GetOrCreate(
+        *fdef, AttrSlice(&attrs), lib_def,
+        [&](std::unique_ptr<FunctionBody>* body) {
+          ++num_created_;
+          return FunctionDefToBodyHelper(*fdef, AttrSlice(&attrs), lib_def,
+                                         body);
+        },
+        fbody);
+  }
+
+  FunctionBodyCache cache_;
+  std::unique_ptr<FunctionLibraryDefinition> lib_def_;
+  std::unique_ptr<FunctionLibraryDefinition> other_lib_def_;
+  int num_created_ = 0;
+};
+
+TEST_F(FunctionBodyCacheTest, SharesBodiesAcrossLibraries) {
+  std::shared_ptr<const FunctionBody> body;
+  TF_ASSERT_OK(GetBody("XTimesTwo", DT_FLOAT, lib_def_.get(), &body));
+  std::shared_ptr<const FunctionBody> other_body;
+  TF_ASSERT_OK(
+      GetBody("XTimesTwo", DT_FLOAT, other_lib_def_.get(), &other_body));
+  EXPECT_EQ(body, other_body);
+  EXPECT_EQ(num_created_, 1);
+  EXPECT_EQ(cache_.NumCachedBodies(), 1);
+  // The shared body doesn't depend on the library it was created from.
+  lib_def_.reset();
+  const OpRegistrationData* op_reg_data;
+  EXPECT_FALSE(
+      body->graph->op_registry()->LookUp("XTimesTwo", &op_reg_data).ok());
+  EXPECT_EQ(body->arg_nodes.size(), 1);
+  EXPECT_EQ(body->ret_nodes.size(), 1);
+
+  // Other attrs get another body.
+  std::shared_ptr<const FunctionBody> int_body;
+  TF_ASSERT_OK(GetBody("XTimesTwo", DT_INT32, other_lib_def_.get(), &int_body));
+  EXPECT_NE(body, int_body);
+  EXPECT_EQ(num_created_, 2);
+  EXPECT_EQ(cache_.NumCachedBodies(), 2);
+}
+
+TEST_F(FunctionBodyCacheTest, DropsUnusedBodies) {
+  std::shared_ptr<const FunctionBody> body;
+  TF_ASSERT_OK(GetBody("XTimesTwo", DT_FLOAT, lib_def_.get(), &body));
+  EXPECT_EQ(cache_.NumCachedBodies(), 1);
+  body.reset();
+  EXPECT_EQ(cache_.NumCachedBodies(), 0);
+  TF_ASSERT_OK(GetBody("XTimesTwo", DT_FLOAT, lib_def_.get(), &body));
+  EXPECT_EQ(num_created_, 2);
+}
+
+TEST_F(FunctionBodyCacheTest, DoesNotShareBodiesCallingFunctions) {
+  // XTimesFour calls XTimesTwo, whose signature is owned by the library.
+  std::shared_ptr<const FunctionBody> body;
+  TF_ASSERT_OK(GetBody("XTimesFour", DT_FLOAT, lib_def_.get(), &body));
+  std::shared_ptr<const FunctionBody> other_body;
+  TF_ASSERT_OK(
+      GetBody("XTimesFour", DT_FLOAT, other_lib_def_.get(), &other_body));
+  EXPECT_NE(body, other_body);
+  EXPECT_EQ(num_created_, 2);
+  EXPECT_EQ(cache_.NumCachedBodies(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -73,6 +73,26 @@ bool GPUBFCAllocator::GetGarbageCollectionValue() {
   return true;
 }
 
+bool GPUBFCAllocator::GetSmallAllocationCacheValue() {
+  const char* enable_small_allocation_cache =
+      std::getenv("TF_ENABLE_GPU_SMALL_ALLOCATION_CACHE");
+  if (enable_small_allocation_cache == nullptr) {
+    return false;
+  }
+  if (strcmp("false", enable_small_allocation_cache) == 0) {
+    return false;
+  } else if (strcmp("true", enable_small_allocation_cache) == 0) {
+    return true;
+  }
+
+  LOG(ERROR)
+      << "The TF_ENABLE_GPU_SMALL_ALLOCATION_CACHE environment variable is set"
+      << " but could not be parsed: \"" << enable_small_allocation_cache
+      << "\". Valid values are \"true\" or \"false\"."
+      << " Using the default value \"false\".";
+  return false;
+}
+
 GPUBFCAllocator::GPUBFCAllocator(GPUMemAllocator* sub_allocator,
                                  size_t total_memory, const string& name)
     : GPUBFCAllocator(sub_allocator, total_memory, GPUOptions(), name) {}
@@ -83,6 +103,7 @@ GPUBFCAllocator::GPUBFCAllocator(GPUMemAllocator* sub_allocator,
                                  const string& name)
     : BFCAllocator(sub_allocator, total_memory,
                    GPUBFCAllocator::GetAllowGrowthValue(gpu_options), name,
-                   GPUBFCAllocator::GetGarbageCollectionValue()) {}
+                   GPUBFCAllocator::GetGarbageCollectionValue(),
+                   GPUBFCAllocator::GetSmallAllocationCacheValue()) {}
 
 }  // namespace tensorflow
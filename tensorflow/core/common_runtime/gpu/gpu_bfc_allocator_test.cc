@@ -217,6 +217,42 @@ TEST(GPUBFCAllocatorTest, AllocatedVsRequested) {
   a.DeallocateRaw(t1);
 }
 
+TEST(GPUBFCAllocatorTest, SmallAllocationCache) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  BFCAllocator a(sub_allocator, 1 << 20, /*allow_growth=*/false, "GPU_0_bfc",
+                 /*garbage_collection=*/false,
+                 /*small_allocation_cache=*/true);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 4);
+    for (int t = 0; t < 4; t++) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 1000; i++) {
+          void* p = a.AllocateRaw(1, 1 + (i * 37 + t) % 4096);
+          ASSERT_NE(nullptr, p);
+          ptrs.push_back(p);
+          if (ptrs.size() > 32) {
+            a.DeallocateRaw(ptrs.front());
+            ptrs.erase(ptrs.begin());
+          }
+        }
+        for (void* p : ptrs) a.DeallocateRaw(p);
+      });
+    }
+  }
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  EXPECT_EQ(4000, stats->num_allocs);
+  EXPECT_EQ(0, stats->bytes_in_use);
+
+  // Chunks left in the caches are returned before an allocation fails.
+  void* p = a.AllocateRaw(1, (1 << 20) - 4096);
+  EXPECT_NE(nullptr, p);
+  a.DeallocateRaw(p);
+}
+
 TEST(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   PlatformGpuId platform_gpu_id(0);
   GPUMemAllocator* sub_allocator = new GPUMemAllocator(
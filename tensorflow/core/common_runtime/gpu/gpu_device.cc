@@ -30,6 +30,7 @@ limitations under the License.
 #include <algorithm>
 #include <list>
 #include <map>
+#include <memory>
 #include <tuple>
 #include <vector>
 
@@ -42,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -376,6 +378,104 @@ class BaseGPUDevice::StreamGroupFactory {
   TF_DISALLOW_COPY_AND_ASSIGN(StreamGroupFactory);
 };
 
+namespace {
+// Forwards to the process-wide GPU allocator, attaching a safe allocation
+// frontier to every request that does not supply one.  Used when a device
+// runs kernels on several compute streams: the allocator itself is not
+// stream-aware, so without a frontier it could hand memory that a kernel on
+// one stream still reads to a kernel on another stream.
+class StreamSafeAllocator : public Allocator {
+ public:
+  // Does not take ownership of `allocator` or `freed_by_func`.
+  StreamSafeAllocator(Allocator* allocator,
+                      std::function<uint64()>* freed_by_func)
+      : allocator_(allocator), freed_by_func_(freed_by_func) {}
+
+  string Name() override { return allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    AllocationAttributes attr(
+        allocation_attr.retry_on_failure,
+        allocation_attr.allocation_will_be_logged,
+        allocation_attr.freed_by_func != nullptr ? allocation_attr.freed_by_func
+                                                 : freed_by_func_);
+    return allocator_->AllocateRaw(alignment, num_bytes, attr);
+  }
+
+  void DeallocateRaw(void* ptr) override { allocator_->DeallocateRaw(ptr); }
+
+  bool TracksAllocationSizes() const override {
+    return allocator_->TracksAllocationSizes();
+  }
+
+  size_t RequestedSize(const void* ptr) const override {
+    return allocator_->RequestedSize(ptr);
+  }
+
+  size_t AllocatedSize(const void* ptr) const override {
+    return allocator_->AllocatedSize(ptr);
+  }
+
+  int64 AllocationId(const void* ptr) const override {
+    return allocator_->AllocationId(ptr);
+  }
+
+  absl::optional<AllocatorStats> GetStats() override {
+    return allocator_->GetStats();
+  }
+
+  void ClearStats() override { allocator_->ClearStats(); }
+
+  void SetSafeFrontier(uint64 count) override {
+    allocator_->SetSafeFrontier(count);
+  }
+
+ private:
+  Allocator* allocator_;                     // not owned
+  std::function<uint64()>* freed_by_func_;  // not owned
+};
+
+// The largest supported GPUOptions.experimental.num_compute_streams.
+constexpr int kMaxComputeStreams = 8;
+}  // namespace
+
+// Recycles the timers that time ops on a GPU, since each one owns a pair of
+// events that are costly to create.  Timers go back to the pool once the
+// last reference to them is released, so they can outlive the device.
+class GPUOpTimerPool : public std::enable_shared_from_this<GPUOpTimerPool> {
+ public:
+  // Returns a timer initialized on `stream`, or nullptr on failure.
+  std::shared_ptr<se::Timer> Get(se::Stream* stream) {
+    std::unique_ptr<se::Timer> timer;
+    {
+      mutex_lock l(mu_);
+      if (!free_timers_.empty()) {
+        timer = std::move(free_timers_.back());
+        free_timers_.pop_back();
+      }
+    }
+    if (timer == nullptr) {
+      timer.reset(new se::Timer(stream->parent()));
+      if (!stream->InitTimer(timer.get()).ok()) return nullptr;
+    }
+    std::shared_ptr<GPUOpTimerPool> pool = shared_from_this();
+    return std::shared_ptr<se::Timer>(timer.release(),
+                                      [pool](se::Timer* timer) {
+                                        mutex_lock l(pool->mu_);
+                                        pool->free_timers_.emplace_back(timer);
+                                      });
+  }
+
+ private:
+  mutex mu_;
+  std::vector<std::unique_ptr<se::Timer>> free_timers_ TF_GUARDED_BY(mu_);
+};
+
 BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
                              Bytes memory_limit, const DeviceLocality& locality,
                              TfGpuId tf_gpu_id,
@@ -395,15 +495,20 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
 
 BaseGPUDevice::~BaseGPUDevice() {
   delete gpu_device_info_;
-  gpu_allocator_->DeallocateRaw(scratch_);
-  device_context_->Unref();
+  for (char* scratch : scratch_) {
+    gpu_allocator_->DeallocateRaw(scratch);
+  }
+  for (GPUDeviceContext* device_context : device_contexts_) {
+    device_context->Unref();
+  }
 }
 
 // This should be idempotent if already initialized.
 Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
-  if (!scratch_) {
-    DCHECK(stream_);
+  for (int i = 0; i < scratch_.size(); ++i) {
+    if (scratch_[i]) continue;
+    DCHECK(streams_[i]);
     size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
     ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
     void* scratch_buffer = gpu_allocator_->AllocateRaw(
@@ -416,11 +521,21 @@ Status BaseGPUDevice::InitScratchBuffers() {
         se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
     TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
         &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
-    scratch_ = static_cast<char*>(scratch_buffer);
+    scratch_[i] = static_cast<char*>(scratch_buffer);
   }
   return Status::OK();
 }
 
+GPUDeviceContext* BaseGPUDevice::NewDeviceContext(int stream_id) {
+  StreamGroup* group = streams_[stream_id];
+  return new GPUDeviceContext(stream_id, group->compute,
+#if TENSORFLOW_USE_ROCM
+                              group->nccl,
+#endif
+                              group->host_to_device, group->device_to_host,
+                              group->device_to_device);
+}
+
 Status BaseGPUDevice::Init(const SessionOptions& options) {
   auto executor_status = GpuIdUtil::ExecutorForTfGpuId(tf_gpu_id_);
   if (!executor_status.status().ok()) {
@@ -430,42 +545,72 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
 
   executor_ = executor_status.ValueOrDie();
 
-  stream_ = StreamGroupFactory::Global().GetOrCreate(
-      tf_gpu_id_, 0, executor_, options.config.gpu_options());
-  device_context_ =
-      new GPUDeviceContext(0, stream_->compute,
-#if TENSORFLOW_USE_ROCM
-                           stream_->nccl,
-#endif
-                           stream_->host_to_device, stream_->device_to_host,
-                           stream_->device_to_device);
+  int num_compute_streams =
+      options.config.gpu_options().experimental().num_compute_streams();
+  if (num_compute_streams == 0) num_compute_streams = 1;
+  if (num_compute_streams < 1 || num_compute_streams > kMaxComputeStreams) {
+    LOG(ERROR) << "Illegal GPUOptions.experimental.num_compute_streams="
+               << num_compute_streams << " set to 1 instead.";
+    num_compute_streams = 1;
+  }
+  for (int i = 0; i < num_compute_streams; ++i) {
+    streams_.push_back(StreamGroupFactory::Global().GetOrCreate(
+        tf_gpu_id_, i, executor_, options.config.gpu_options()));
+    device_contexts_.push_back(NewDeviceContext(i));
+  }
+  stream_ = streams_[0];
+  device_context_ = device_contexts_[0];
+  scratch_.resize(num_compute_streams, nullptr);
+  const bool multi_stream = num_compute_streams > 1;
 
   em_ = EventMgrFactory::Singleton()->GetEventMgr(executor_,
                                                   options.config.gpu_options());
+  if (options.config.gpu_options().experimental().time_ops_on_device()) {
+    op_timer_pool_ = std::make_shared<GPUOpTimerPool>();
+  }
 
   GPUKernelTracker::Params tracker_params(
       options.config.gpu_options().experimental().kernel_tracker_max_interval(),
       options.config.gpu_options().experimental().kernel_tracker_max_bytes(),
       options.config.gpu_options().experimental().kernel_tracker_max_pending());
+  // Several compute streams need the timestamped allocator to reuse memory
+  // safely across streams.
   timestamped_allocator_ =
-      options.config.gpu_options().experimental().timestamped_allocator();
+      options.config.gpu_options().experimental().timestamped_allocator() ||
+      multi_stream;
   pending_cap_ = tracker_params.max_pending;
+  if (multi_stream) {
+    // Track every kernel, so that a stream with no pending tracking events
+    // has really finished all its work.
+    tracker_params.max_interval = 0;
+    tracker_params.max_bytes = 0;
+  }
   if (timestamped_allocator_ ||
       (tracker_params.max_interval > 0 || tracker_params.max_bytes > 0 ||
        tracker_params.max_pending > 0)) {
-    SharedCounter* timing_counter = nullptr;
     if (timestamped_allocator_) {
       // In this case the SharedCounter was already created and set in the
       // associated Allocator, with ownership by GPUProcessState.
       // The GPUKernelTracker will use this SharedCounter, instead of
       // owning its own.
-      timing_counter =
+      timing_counter_ =
           GPUProcessState::singleton()->GPUAllocatorCounter(tf_gpu_id_);
-      DCHECK(timing_counter);
+      DCHECK(timing_counter_);
+    }
+    for (StreamGroup* group : streams_) {
+      // With several streams no single tracker knows the safe frontier, so
+      // SafeAllocFrontier() advances the allocator's frontier instead.
+      kernel_trackers_.emplace_back(new GPUKernelTracker(
+          tracker_params, Env::Default(), group->compute, timing_counter_,
+          (timestamped_allocator_ && !multi_stream) ? gpu_allocator_ : nullptr,
+          em_));
     }
-    kernel_tracker_.reset(new GPUKernelTracker(
-        tracker_params, Env::Default(), stream_->compute, timing_counter,
-        timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
+  }
+  if (multi_stream) {
+    freed_by_func_ = [this]() { return SafeAllocFrontier(0); };
+    stream_safe_allocator_.reset(
+        new StreamSafeAllocator(gpu_allocator_, &freed_by_func_));
+    gpu_allocator_ = stream_safe_allocator_.get();
   }
 
   gpu_device_info_ = new GpuDeviceInfo;
@@ -556,17 +701,33 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
             << ComputeOpKernelDebugString(*op_kernel, stream_id);
   }
 
-  if (kernel_tracker_.get()) {
+  GPUKernelTracker* tracker =
+      kernel_trackers_.empty() ? nullptr : kernel_trackers_[stream_id].get();
+  if (tracker) {
     context->set_record_memory_consumption(true);
     if (pending_cap_ > 0) {
-      kernel_tracker_->PauseWhilePendingExceeds(pending_cap_);
+      tracker->PauseWhilePendingExceeds(pending_cap_);
     }
   }
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  for (se::Stream* wait_stream : gpu_device_context->wait_streams()) {
+    stream->ThenWaitFor(wait_stream);
+  }
   ScopedMemoryDebugAnnotation op_annotation(op_kernel->name_view().data(),
                                             context->step_id());
+  // Ops are only timed when step stats are collected, which is when the
+  // executor passes the time on to them.
+  std::shared_ptr<se::Timer> op_timer;
+  if (op_timer_pool_ != nullptr && context->stats_collector() != nullptr) {
+    op_timer = op_timer_pool_->Get(stream);
+    if (op_timer != nullptr) stream->ThenStartTimer(op_timer.get());
+  }
   op_kernel->Compute(context);
   if (context->status().ok()) {
+    if (op_timer != nullptr && stream->ThenStopTimer(op_timer.get()).ok()) {
+      context->set_device_compute_time(
+          [op_timer]() -> int64 { return op_timer->Nanoseconds(); });
+    }
     if (sync_every_op_) {
       // Note: GPUUtil::Sync() only syncs the default stream.
       // We need to either sync the stream used by this op, or
@@ -581,9 +742,7 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
       VLOG(1) << "GpuDevice::ComputeHelper scheduled "
               << ComputeOpKernelDebugString(*op_kernel, stream_id);
     }
-    if (kernel_tracker_) {
-      GPUKernelTracker* tracker = kernel_tracker_.get();
-      DCHECK(tracker);
+    if (tracker) {
       uint64 queued_count = tracker->MaybeQueue(context);
       if (queued_count > 0) {
         em_->ThenExecute(stream, [tracker, queued_count]() {
@@ -619,6 +778,9 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
           << stream_id << "]";
 
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  for (se::Stream* wait_stream : gpu_device_context->wait_streams()) {
+    stream->ThenWaitFor(wait_stream);
+  }
   op_kernel->ComputeAsync(context, std::move(done));
 }
 
@@ -740,6 +902,27 @@ Status BaseGPUDevice::MakeTensorFromProto(const TensorProto& tensor_proto,
   }
 }
 
+Status BaseGPUDevice::MakeTensorFromHostTensor(
+    const Tensor& host_tensor, const AllocatorAttributes alloc_attrs,
+    Tensor* tensor) {
+  if (host_tensor.dtype() == DT_VARIANT) {
+    return errors::Unimplemented(
+        "MakeTensorFromHostTensor() does not support DT_VARIANT tensors");
+  }
+  ScopedMemoryDebugAnnotation op_annotation("MakeTensorFromHostTensor",
+                                            "dynamic", host_tensor.dtype(),
+                                            &host_tensor.shape());
+  Notification n;
+  Status status;
+  TF_RETURN_IF_ERROR(MaybeCopyTensorToGPU(alloc_attrs, host_tensor, tensor,
+                                          [&n, &status](const Status& s) {
+                                            status = s;
+                                            n.Notify();
+                                          }));
+  n.WaitForNotification();
+  return status;
+}
+
 void BaseGPUDevice::CopyTensorInSameDevice(const Tensor* input_tensor,
                                            Tensor* output_tensor,
                                            const DeviceContext* device_context,
@@ -991,11 +1174,11 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
+  DCHECK_LT(stream_id, static_cast<int>(streams_.size()));
   const gpuStream_t* gpu_stream = reinterpret_cast<const gpuStream_t*>(
-      stream_->compute->implementation()->GpuStreamMemberHack());
+      streams_[stream_id]->compute->implementation()->GpuStreamMemberHack());
   concrete_device->Reinitialize(context, gpu_stream, tf_gpu_id_, allocator,
-                                scratch_);
+                                scratch_[stream_id]);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1012,7 +1195,6 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
@@ -1862,18 +2044,74 @@ Status BaseGPUDeviceFactory::GetValidDeviceIds(
 }
 
 uint64 BaseGPUDevice::SafeAllocFrontier(uint64 old_value) {
-  if (timestamped_allocator_) {
-    return kernel_tracker_->LastTerminatedCount(old_value);
-  } else {
+  if (!timestamped_allocator_) {
     return 0;
   }
+  if (kernel_trackers_.size() == 1) {
+    return kernel_trackers_[0]->LastTerminatedCount(old_value);
+  }
+  // Memory freed at a count is safe once every stream has finished the
+  // kernels queued before that count.  Idle streams have finished all of
+  // theirs, so they do not hold the frontier back.
+  uint64 frontier = timing_counter_->get();
+  for (auto& tracker : kernel_trackers_) {
+    if (!tracker->AllTerminated()) {
+      frontier = std::min(frontier, tracker->LastTerminatedCount(old_value));
+    }
+  }
+  gpu_allocator_->SetSafeFrontier(frontier);
+  return frontier;
 }
 
 int BaseGPUDevice::PendingKernels() {
-  if (kernel_tracker_) {
-    return kernel_tracker_->NumPending();
+  int num_pending = 0;
+  for (auto& tracker : kernel_trackers_) {
+    num_pending += tracker->NumPending();
+  }
+  return num_pending;
+}
+
+Status BaseGPUDevice::FillContextMap(
+    const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+  if (streams_.size() == 1) {
+    return Status::OK();
+  }
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = streams_.size();
+  std::unordered_map<int, int> node_to_stream_id;
+  TF_RETURN_IF_ERROR(
+      gpu_stream_util::AssignStreams(graph, opts, &node_to_stream_id));
+  for (const Node* n : graph->nodes()) {
+    auto it = node_to_stream_id.find(n->id());
+    if (it == node_to_stream_id.end()) continue;
+    const int stream_id = it->second;
+    // Data and control dependencies on nodes of other streams become waits
+    // for those streams before the node's kernels are enqueued.
+    gtl::InlinedVector<se::Stream*, 2> wait_streams;
+    for (const Edge* e : n->in_edges()) {
+      auto src_it = node_to_stream_id.find(e->src()->id());
+      if (src_it == node_to_stream_id.end() || src_it->second == stream_id) {
+        continue;
+      }
+      se::Stream* wait_stream = streams_[src_it->second]->compute;
+      if (std::find(wait_streams.begin(), wait_streams.end(), wait_stream) ==
+          wait_streams.end()) {
+        wait_streams.push_back(wait_stream);
+      }
+    }
+    GPUDeviceContext* device_context;
+    if (wait_streams.empty()) {
+      device_context = device_contexts_[stream_id];
+      device_context->Ref();
+    } else {
+      device_context = NewDeviceContext(stream_id);
+      for (se::Stream* wait_stream : wait_streams) {
+        device_context->add_wait_stream(wait_stream);
+      }
+    }
+    (*device_context_map)[n->id()] = device_context;
   }
-  return 0;
+  return Status::OK();
 }
 
 void BaseGPUDevice::TestOnlyReset() {
@@ -20,6 +20,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_DEVICE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_DEVICE_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -48,6 +49,7 @@ limitations under the License.
 
 namespace tensorflow {
 class GPUKernelTracker;
+class GPUOpTimerPool;
 
 class BaseGPUDevice : public LocalDevice {
  public:
@@ -73,10 +75,22 @@ class BaseGPUDevice : public LocalDevice {
                              const AllocatorAttributes alloc_attrs,
                              Tensor* tensor) override;
 
+  Status MakeTensorFromHostTensor(const Tensor& host_tensor,
+                                  const AllocatorAttributes alloc_attrs,
+                                  Tensor* tensor) override;
+
   void CopyTensorInSameDevice(const Tensor* input_tensor, Tensor* output_tensor,
                               const DeviceContext* device_context,
                               StatusCallback done) override;
 
+  // Assigns the nodes of `graph` to the compute streams of this device when
+  // GPUOptions.experimental.num_compute_streams is greater than one.  Nodes
+  // with inputs produced on other streams get a context that makes their
+  // stream wait for those streams.
+  Status FillContextMap(
+      const Graph* graph,
+      std::vector<DeviceContext*>* device_context_map) override;
+
   // The caller owns the returned device.
   PerOpGpuDevice* MakeGpuDevice() override;
 
@@ -111,7 +125,7 @@ class BaseGPUDevice : public LocalDevice {
   uint64 SafeAllocFrontier(uint64 old_value) override;
 
   // Returns the number of kernels that have been queued for execution on
-  // the compute stream and are not yet known to have completed.
+  // the compute streams and are not yet known to have completed.
   int PendingKernels();
 
   int priority() const { return stream_->priority; }
@@ -140,23 +154,39 @@ class BaseGPUDevice : public LocalDevice {
   };
   class StreamGroupFactory;
 
+  // The stream group and default context of compute stream 0.
   StreamGroup* stream_;
-  mutex scratch_init_mutex_;
-  char* scratch_ = nullptr;
   GPUDeviceContext* device_context_;
+  // Indexed by compute stream ID.
+  gtl::InlinedVector<StreamGroup*, 4> streams_;
+  gtl::InlinedVector<GPUDeviceContext*, 4> device_contexts_;
+  mutex scratch_init_mutex_;
+  gtl::InlinedVector<char*, 4> scratch_;
   GpuDeviceInfo* gpu_device_info_ = nullptr;
   mutex trace_mu_;
   TfGpuId tf_gpu_id_;
   const bool sync_every_op_ = false;
   EventMgr* em_ = nullptr;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
-  std::unique_ptr<GPUKernelTracker> kernel_tracker_;
+  // One tracker per compute stream, or empty if kernels are not tracked.
+  std::vector<std::unique_ptr<GPUKernelTracker>> kernel_trackers_;
+  SharedCounter* timing_counter_ = nullptr;  // not owned
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
+  // Set if GPUOptions.experimental.time_ops_on_device is true.
+  std::shared_ptr<GPUOpTimerPool> op_timer_pool_;
+  // With several compute streams, gpu_allocator_ points to this wrapper of
+  // the process-wide allocator, which only reuses memory once every stream
+  // is done with it.
+  std::unique_ptr<Allocator> stream_safe_allocator_;
+  std::function<uint64()> freed_by_func_;
 
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
 
+  // Returns a new context whose kernels run on compute stream `stream_id`.
+  GPUDeviceContext* NewDeviceContext(int stream_id);
+
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
                           int stream_id, Allocator* allocator);
 
@@ -254,6 +284,14 @@ class GPUKernelTracker {
     return num_pending_;
   }
 
+  // Returns true if every tracked kernel is known to have terminated.  Unlike
+  // NumPending() this does not depend on the kernel weights, which are zero
+  // when no pending cap is set.
+  bool AllTerminated() {
+    mutex_lock l(mu_);
+    return (last_completed_ + 1) % pending_kernels_.size() == first_available_;
+  }
+
   // Yield current thread until number of pending kernels no longer
   // exceeds the cap.
   void PauseWhilePendingExceeds(int cap) TF_LOCKS_EXCLUDED(mu_) {
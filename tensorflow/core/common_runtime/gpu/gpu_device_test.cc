@@ -20,11 +20,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -552,6 +555,64 @@ TEST_F(GPUKernelTrackerTest, CappingOnly) {
   EXPECT_EQ(timing_counter_->get(), kernel_tracker_->LastTerminatedCount(0));
 }
 
+// Copies a tensor from GPU 0 to every other GPU at once and reports the
+// aggregate bandwidth, with `num_dev_to_dev_copy_streams` copy streams.
+static void BM_DeviceToDeviceCopy(int iters, int num_streams) {
+  testing::StopTiming();
+  SessionOptions options;
+  ConfigProto* config = &options.config;
+  (*config->mutable_device_count())["GPU"] = 8;
+  config->mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_num_dev_to_dev_copy_streams(num_streams);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_CHECK_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      options, kDeviceNamePrefix, &devices));
+  if (devices.size() < 2) {
+    LOG(WARNING) << "BM_DeviceToDeviceCopy needs at least two GPUs.";
+    devices.clear();
+    BaseGPUDevice::TestOnlyReset();
+    GPUProcessState::singleton()->TestOnlyReset();
+    return;
+  }
+
+  constexpr int64 kNumElements = 16 << 20;
+  std::vector<Tensor> tensors;
+  for (const auto& device : devices) {
+    tensors.emplace_back(device->GetAllocator(AllocatorAttributes()), DT_FLOAT,
+                         TensorShape({kNumElements}));
+  }
+  Device* src = devices[0].get();
+  DeviceContext* src_context =
+      src->tensorflow_gpu_device_info()->default_context;
+
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    BlockingCounter pending(devices.size() - 1);
+    for (int d = 1; d < devices.size(); ++d) {
+      Device* dst = devices[d].get();
+      GPUUtil::DeviceToDeviceCopy(
+          src_context, dst->tensorflow_gpu_device_info()->default_context, src,
+          dst, AllocatorAttributes(), AllocatorAttributes(), &tensors[0],
+          &tensors[d], /*dev_to_dev_stream_index=*/d,
+          [&pending](const Status& s) {
+            TF_CHECK_OK(s);
+            pending.DecrementCount();
+          });
+    }
+    pending.Wait();
+  }
+  testing::StopTiming();
+  testing::BytesProcessed(static_cast<int64>(iters) * (devices.size() - 1) *
+                          kNumElements * sizeof(float));
+
+  tensors.clear();
+  devices.clear();
+  BaseGPUDevice::TestOnlyReset();
+  GPUProcessState::singleton()->TestOnlyReset();
+}
+BENCHMARK(BM_DeviceToDeviceCopy)->Arg(1)->Arg(4);
+
 }  // namespace tensorflow
 
 #endif
@@ -94,13 +94,24 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      use_host_callbacks_(
+          gpu_options.experimental().event_mgr_use_host_callbacks()),
       threadpool_(Env::Default(), "GPU_Event_Manager", kNumThreads) {
   gpu_event_mgr::InitThreadpoolLabels(&threadpool_);
-  StartPollingLoop();
+  if (!use_host_callbacks_) {
+    StartPollingLoop();
+  }
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    // Host callbacks refer to this object.
+    mutex_lock l(mu_);
+    while (pending_host_callbacks_ > 0) {
+      host_callbacks_done_.wait(l);
+    }
+  }
 
   // Events are owned by this object.
   for (auto& e : free_events_) {
@@ -184,6 +195,23 @@ void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   if (was_empty) events_pending_.notify_all();
 }
 
+void EventMgr::ThenExecuteWithHostCallback(se::Stream* stream,
+                                           std::function<void()> func) {
+  {
+    mutex_lock l(mu_);
+    ++pending_host_callbacks_;
+  }
+  // Host callbacks run on a driver thread, which must not be blocked or call
+  // back into the driver, so func runs on threadpool_ as in FreeMemory().
+  stream->ThenDoHostCallback([this, func = std::move(func)]() mutable {
+    threadpool_.Schedule(std::move(func));
+    mutex_lock l(mu_);
+    if (--pending_host_callbacks_ == 0) {
+      host_callbacks_done_.notify_all();
+    }
+  });
+}
+
 // This function must be called periodically to check whether pending
 // events have recorded, and then retire them.  Initial observations
 // suggest that typical behavior in a TensorFlow program is to have
@@ -68,6 +68,10 @@ class EventMgr {
   // func must be brief and non-blocking since it executes in the one
   // thread used for all such callbacks and also buffer deletions.
   inline void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_) {
+      ThenExecuteWithHostCallback(stream, std::move(func));
+      return;
+    }
     ToFreeVector to_free;
     {
       mutex_lock l(mu_);
@@ -83,6 +87,8 @@ class EventMgr {
   friend class EventMgrFactory;
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  // If true, there is no polling loop and ThenExecute uses host callbacks.
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -113,6 +119,10 @@ class EventMgr {
     QueueInUse(stream, {nullptr, std::move(func)});
   }
 
+  // Enqueues a host callback on stream that hands func to threadpool_.
+  void ThenExecuteWithHostCallback(se::Stream* stream,
+                                   std::function<void()> func);
+
   // This function should be called at roughly the same tempo as
   // QueueTensors() to check whether pending events have recorded,
   // and then retire them.  It appends InUse elements that need cleanup
@@ -136,6 +146,10 @@ class EventMgr {
   std::deque<InUse> used_events_ TF_GUARDED_BY(mu_);
 
   bool stop_polling_ TF_GUARDED_BY(mu_);
+
+  // Host callbacks that have been enqueued but have not run yet.
+  int64 pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_;
   std::unique_ptr<Notification> polling_stopped_;
 
   // The main PollLoop for the event manager runs in this threadpool.
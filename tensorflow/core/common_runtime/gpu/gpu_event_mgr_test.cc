@@ -138,6 +138,32 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_mgr_use_host_callbacks(true);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  std::atomic<int> count(0);
+  bool in_callback_thread = false;
+  Notification note;
+  for (int i = 0; i < 10; ++i) {
+    em.ThenExecute(stream.get(), [&count, &in_callback_thread, &note]() {
+      gpu_event_mgr::WarnIfInCallback(
+          [&in_callback_thread] { in_callback_thread = true; });
+      if (++count == 10) note.Notify();
+    });
+  }
+  note.WaitForNotification();
+  EXPECT_TRUE(in_callback_thread);
+  // No events are recorded for the polling loop.
+  EXPECT_EQ(0, th.queue_size());
+  EXPECT_EQ(0, th.free_size());
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -467,6 +493,32 @@ BENCHMARK(BM_no_ops)->Arg(4);
 BENCHMARK(BM_no_ops)->Arg(8);
 BENCHMARK(BM_no_ops)->Arg(32);
 
+// Measures the time from enqueueing a callback on an idle stream until it
+// runs, with the polling loop or with host callbacks.
+static void BM_callback_latency(int iters, int use_host_callbacks) {
+  testing::StopTiming();
+#ifdef PLATFORM_GOOGLE
+  BenchmarkUseRealTime();
+#else
+  testing::UseRealTime();
+#endif  // PLATFORM_GOOGLE
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_mgr_use_host_callbacks(
+      use_host_callbacks);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    Notification note;
+    em.ThenExecute(stream.get(), [&note]() { note.Notify(); });
+    note.WaitForNotification();
+  }
+}
+BENCHMARK(BM_callback_latency)->Arg(0)->Arg(1);
+
 // Benchmark functions are defined at top level.  In order to provide a real,
 // persistent GPUDevice to the following function it also needs to be at top
 // level.  But then we can't clean it up without a cuda runtime error, so we
@@ -16,13 +16,20 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_ALLOCATOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_ALLOCATOR_H_
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/stream_executor.h"
 
 namespace tensorflow {
 // Allocator for pinned CPU RAM that is made known to GPU for the
 // purpose of efficient DMA with a GPU.
+//
+// If NUMA is enabled, memory is allocated on `numa_node` and then registered
+// with the GPU, so that staging buffers live next to the GPUs that use them.
+// Otherwise, or if registration fails, the GPU runtime allocates it.
 class GpuHostAllocator : public SubAllocator {
  public:
   // Note: stream_exec cannot be null.
@@ -31,7 +38,9 @@ class GpuHostAllocator : public SubAllocator {
                             const std::vector<Visitor>& free_visitors)
       : SubAllocator(alloc_visitors, free_visitors),
         stream_exec_(stream_exec),
-        numa_node_(numa_node) {
+        numa_node_(numa_node),
+        bind_to_numa_node_(numa_node != port::kNUMANoAffinity &&
+                           port::NUMAEnabled()) {
     CHECK(stream_exec_ != nullptr);
   }
   ~GpuHostAllocator() override {}
@@ -39,7 +48,12 @@ class GpuHostAllocator : public SubAllocator {
   void* Alloc(size_t alignment, size_t num_bytes) override {
     void* ptr = nullptr;
     if (num_bytes > 0) {
-      ptr = stream_exec_->HostMemoryAllocate(num_bytes);
+      if (bind_to_numa_node_) {
+        ptr = AllocOnNumaNode(alignment, num_bytes);
+      }
+      if (ptr == nullptr) {
+        ptr = stream_exec_->HostMemoryAllocate(num_bytes);
+      }
       if (ptr == nullptr) {
         LOG(WARNING) << "could not allocate pinned host memory of size: "
                      << num_bytes;
@@ -53,13 +67,44 @@ class GpuHostAllocator : public SubAllocator {
   void Free(void* ptr, size_t num_bytes) override {
     if (ptr != nullptr) {
       VisitFree(ptr, numa_node_, num_bytes);
+      if (bind_to_numa_node_) {
+        mutex_lock l(mu_);
+        if (numa_ptrs_.erase(ptr) > 0) {
+          if (!stream_exec_->HostMemoryUnregister(ptr)) {
+            LOG(WARNING) << "could not unregister pinned host memory at "
+                         << ptr;
+          }
+          port::NUMAFree(ptr, num_bytes);
+          return;
+        }
+      }
       stream_exec_->HostMemoryDeallocate(ptr);
     }
   }
 
  private:
+  void* AllocOnNumaNode(size_t alignment, size_t num_bytes) {
+    void* ptr = port::NUMAMalloc(numa_node_, num_bytes, alignment);
+    if (ptr == nullptr) return nullptr;
+    if (!stream_exec_->HostMemoryRegister(ptr, num_bytes)) {
+      LOG(WARNING) << "could not register host memory on NUMA node "
+                   << numa_node_ << ", falling back to unbound memory";
+      port::NUMAFree(ptr, num_bytes);
+      return nullptr;
+    }
+    mutex_lock l(mu_);
+    numa_ptrs_.insert(ptr);
+    return ptr;
+  }
+
   se::StreamExecutor* stream_exec_;  // not owned, non-null
   const int numa_node_;
+  const bool bind_to_numa_node_;
+
+  mutex mu_;
+  // Memory from AllocOnNumaNode, which must be unregistered and freed with
+  // port::NUMAFree.
+  absl::flat_hash_set<void*> numa_ptrs_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(GpuHostAllocator);
 };
@@ -26,14 +26,18 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/common_runtime/memory_timeline.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
+#include "tensorflow/core/common_runtime/slab_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/log_memory.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/env_var.h"
@@ -53,6 +57,11 @@ bool useCudaMemoryGuardAllocator() {
          std::strcmp(debug_allocator_str, "memory_guard") == 0;
 }
 
+void RecordGpuHostMemory(const string& event, size_t num_bytes) {
+  metrics::GetGpuHostMemoryCounter(event)->IncrementBy(1);
+  metrics::GetGpuHostMemoryBytesCounter(event)->IncrementBy(num_bytes);
+}
+
 }  // namespace
 
 /*static*/ GPUProcessState* GPUProcessState::singleton(GPUProcessState* ps) {
@@ -93,10 +102,22 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
   AllocatorParts& allocator_parts = gpu_allocators_[tf_gpu_id.value()];
   if (allocator_parts.allocator == nullptr) {
     // Validate allocator types.
-    if (!allocator_type.empty() && allocator_type != "BFC") {
+    if (!allocator_type.empty() && allocator_type != "BFC" &&
+        allocator_type != "SLAB") {
       LOG(ERROR) << "Invalid allocator type: " << allocator_type;
       return nullptr;
     }
+    // Freed memory may only be reused once the kernels that last touched it
+    // are known to be done, which only BFCAllocator keeps track of.
+    bool use_slab_allocator = allocator_type == "SLAB";
+    if (use_slab_allocator &&
+        (options.experimental().timestamped_allocator() ||
+         options.experimental().num_compute_streams() > 1)) {
+      LOG(WARNING) << "The SLAB allocator does not support "
+                   << "timestamped_allocator or num_compute_streams > 1; "
+                   << "using BFC instead.";
+      use_slab_allocator = false;
+    }
 
     PlatformGpuId platform_gpu_id;
     TF_CHECK_OK(GpuIdManager::TfToPlatformGpuId(tf_gpu_id, &platform_gpu_id));
@@ -111,12 +132,22 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
         (options.per_process_gpu_memory_fraction() > 1.0 ||
          options.experimental().use_unified_memory()),
         gpu_visitors_[bus_id], {});
-    GPUBFCAllocator* gpu_bfc_allocator =
-        new GPUBFCAllocator(sub_allocator, total_bytes, options,
-                            strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc"));
-    Allocator* gpu_allocator = gpu_bfc_allocator;
+    GPUBFCAllocator* gpu_bfc_allocator = nullptr;
+    Allocator* gpu_allocator;
+    if (use_slab_allocator) {
+      gpu_allocator = new SlabAllocator(
+          sub_allocator, total_bytes,
+          strings::StrCat("GPU_", tf_gpu_id.value(), "_slab"),
+          SlabAllocator::Options());
+    } else {
+      gpu_bfc_allocator = new GPUBFCAllocator(
+          sub_allocator, total_bytes, options,
+          strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc"));
+      gpu_allocator = gpu_bfc_allocator;
+    }
     SharedCounter* timing_counter = nullptr;
-    if (options.experimental().timestamped_allocator()) {
+    if (gpu_bfc_allocator != nullptr &&
+        options.experimental().timestamped_allocator()) {
       timing_counter = new SharedCounter;
       gpu_bfc_allocator->SetTimingCounter(timing_counter);
     }
@@ -135,6 +166,8 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
       gpu_allocator =
           new GPUcudaMallocAllocator(gpu_allocator, platform_gpu_id);
     }
+    gpu_allocator = MemoryTimelineAllocator::MaybeWrap(gpu_allocator,
+                                                       /*owns_allocator=*/true);
 
     Allocator* recording_allocator = nullptr;
     if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
@@ -176,6 +209,11 @@ SharedCounter* GPUProcessState::GPUAllocatorCounter(TfGpuId tf_gpu_id) {
   }
 
   AllocatorParts& allocator_parts = gpu_allocators_[tf_gpu_id.value()];
+  if (allocator_parts.bfc_allocator == nullptr) {
+    LOG(ERROR) << "GPU allocator " << tf_gpu_id.value()
+               << " does not support a timing counter";
+    return nullptr;
+  }
   if (allocator_parts.counter.get() == nullptr) {
     SharedCounter* timing_counter = new SharedCounter;
     allocator_parts.bfc_allocator->SetTimingCounter(timing_counter);
@@ -193,7 +231,9 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
       !process_state_->ProcessState::FLAGS_brain_mem_reg_gpu_dma) {
     return process_state_->GetCPUAllocator(numa_node);
   }
-  if (numa_node == port::kNUMANoAffinity) {
+  // Without NUMA support all nodes share one pool, as its memory would not
+  // be bound to any of them anyway.
+  if (numa_node == port::kNUMANoAffinity || !port::NUMAEnabled()) {
     numa_node = 0;
   }
   {
@@ -204,12 +244,12 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     tf_shared_lock lock(mu_);
 
     if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types &&
-        !gpu_host_allocators_.empty() &&
-        gpu_host_allocators_[0].recording_allocator != nullptr) {
-      return gpu_host_allocators_[0].recording_allocator.get();
+        static_cast<int>(gpu_host_allocators_.size()) > numa_node &&
+        gpu_host_allocators_[numa_node].recording_allocator != nullptr) {
+      return gpu_host_allocators_[numa_node].recording_allocator.get();
     }
     if (static_cast<int>(gpu_host_allocators_.size()) > numa_node) {
-      return gpu_host_allocators_[0].allocator.get();
+      return gpu_host_allocators_[numa_node].allocator.get();
     }
   }
 
@@ -232,15 +272,25 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
   CHECK_NE(nullptr, se);
 
   while (static_cast<int>(gpu_host_allocators_.size()) <= numa_node) {
-    while (gpu_host_alloc_visitors_.size() <= numa_node) {
+    const int node = gpu_host_allocators_.size();
+    while (gpu_host_alloc_visitors_.size() <= node) {
       gpu_host_alloc_visitors_.push_back({});
     }
-    while (gpu_host_free_visitors_.size() <= numa_node) {
+    while (gpu_host_free_visitors_.size() <= node) {
       gpu_host_free_visitors_.push_back({});
     }
+    std::vector<SubAllocator::Visitor> alloc_visitors =
+        gpu_host_alloc_visitors_[node];
+    alloc_visitors.push_back([](void* ptr, int index, size_t num_bytes) {
+      RecordGpuHostMemory("pinned", num_bytes);
+    });
+    std::vector<SubAllocator::Visitor> free_visitors =
+        gpu_host_free_visitors_[node];
+    free_visitors.push_back([](void* ptr, int index, size_t num_bytes) {
+      RecordGpuHostMemory("unpinned", num_bytes);
+    });
     SubAllocator* sub_allocator =
-        new GpuHostAllocator(se, numa_node, gpu_host_alloc_visitors_[numa_node],
-                             gpu_host_free_visitors_[numa_node]);
+        new GpuHostAllocator(se, node, alloc_visitors, free_visitors);
     // TODO(zheng-xq): evaluate whether 64GB by default is the best choice.
     int64 gpu_host_mem_limit_in_mb = -1;
     Status status = ReadInt64FromEnvVar("TF_GPU_HOST_MEM_LIMIT_IN_MB",
@@ -255,6 +305,29 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
         new BFCAllocator(sub_allocator, gpu_host_mem_limit,
                          true /*allow_growth*/, "gpu_host_bfc" /*name*/);
 
+    // Pinning host memory takes milliseconds, so optionally pin the expected
+    // staging working set up front.  The BFC allocator keeps the region and
+    // serves later requests of any size from it.
+    int64 gpu_host_mem_prewarm_in_mb = 0;
+    status = ReadInt64FromEnvVar("TF_GPU_HOST_MEM_PREWARM_IN_MB", 0,
+                                 &gpu_host_mem_prewarm_in_mb);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetGpuHostAllocator: " << status.error_message();
+    }
+    if (gpu_host_mem_prewarm_in_mb > 0) {
+      void* ptr = allocator->AllocateRaw(
+          Allocator::kAllocatorAlignment,
+          gpu_host_mem_prewarm_in_mb * (1LL << 20),
+          AllocationAttributes(/*retry_on_failure=*/false,
+                               /*allocation_will_be_logged=*/false, nullptr));
+      if (ptr == nullptr) {
+        LOG(WARNING) << "Could not prewarm " << gpu_host_mem_prewarm_in_mb
+                     << "MiB of pinned host memory on NUMA node " << node;
+      } else {
+        allocator->DeallocateRaw(ptr);
+      }
+    }
+
     if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
       // Wrap the allocator to track allocation ids for better logging
       // at the cost of performance.
@@ -278,9 +351,9 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     }
   }
   if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
-    return gpu_host_allocators_[0].recording_allocator.get();
+    return gpu_host_allocators_[numa_node].recording_allocator.get();
   } else {
-    return gpu_host_allocators_[0].allocator.get();
+    return gpu_host_allocators_[numa_node].allocator.get();
   }
 }
 
@@ -143,7 +143,7 @@ class GPUProcessState {
   struct AllocatorParts {
     std::unique_ptr<Allocator> allocator;
     std::unique_ptr<SharedCounter> counter;
-    GPUBFCAllocator* bfc_allocator;
+    GPUBFCAllocator* bfc_allocator;  // nullptr if not a BFC allocator
     SubAllocator* sub_allocator;  // owned by allocator
     std::unique_ptr<Allocator> recording_allocator;
   };
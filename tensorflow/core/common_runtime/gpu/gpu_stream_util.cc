@@ -0,0 +1,76 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <vector>
+
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                     std::unordered_map<int, int>* node_to_stream_id) {
+  if (graph == nullptr) {
+    return errors::InvalidArgument("Bad graph argument supplied.");
+  }
+  if (node_to_stream_id == nullptr) {
+    return errors::InvalidArgument("Bad node_to_stream_id argument supplied.");
+  }
+  if (opts.max_streams < 1) {
+    return errors::InvalidArgument("Must set max_streams >= 1, got ",
+                                   opts.max_streams);
+  }
+  node_to_stream_id->clear();
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+
+  // Indexed by node ID: true once a consumer has continued the stream of the
+  // node, so that its other consumers start new branches.
+  std::vector<bool> continued(graph->num_node_ids(), false);
+  int next_stream = 0;
+  for (Node* n : order) {
+    if (!n->IsOp()) continue;
+    int stream_id = -1;
+    if (opts.max_streams == 1) {
+      stream_id = 0;
+    } else {
+      for (const Edge* e : n->in_edges()) {
+        if (e->IsControlEdge() || !e->src()->IsOp()) continue;
+        const int src_id = e->src()->id();
+        // Loop back edges come from nodes that are not yet assigned.
+        auto it = node_to_stream_id->find(src_id);
+        if (it != node_to_stream_id->end() && !continued[src_id]) {
+          continued[src_id] = true;
+          stream_id = it->second;
+          break;
+        }
+      }
+      if (stream_id < 0) {
+        stream_id = next_stream;
+        next_stream = (next_stream + 1) % opts.max_streams;
+      }
+    }
+    (*node_to_stream_id)[n->id()] = stream_id;
+    VLOG(2) << "Assigned node " << n->name() << " to stream " << stream_id;
+  }
+  return Status::OK();
+}
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
@@ -0,0 +1,107 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <set>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class GpuStreamUtilTest : public ::testing::Test {
+ protected:
+  GpuStreamUtilTest() : graph_(OpRegistry::Global()) {}
+
+  Node* Const(float value) {
+    return test::graph::Constant(&graph_, test::AsScalar<float>(value));
+  }
+
+  int StreamOf(const Node* n) const { return node_to_stream_id_.at(n->id()); }
+
+  Status Assign(int max_streams) {
+    gpu_stream_util::AssignStreamsOpts opts;
+    opts.max_streams = max_streams;
+    return gpu_stream_util::AssignStreams(&graph_, opts, &node_to_stream_id_);
+  }
+
+  Graph graph_;
+  std::unordered_map<int, int> node_to_stream_id_;
+};
+
+TEST_F(GpuStreamUtilTest, BogusOpts) {
+  EXPECT_FALSE(Assign(/*max_streams=*/0).ok());
+  gpu_stream_util::AssignStreamsOpts opts;
+  EXPECT_FALSE(gpu_stream_util::AssignStreams(nullptr, opts,
+                                              &node_to_stream_id_)
+                   .ok());
+  EXPECT_FALSE(gpu_stream_util::AssignStreams(&graph_, opts, nullptr).ok());
+}
+
+TEST_F(GpuStreamUtilTest, SingleStream) {
+  Node* a = Const(1.0f);
+  Node* b = Const(2.0f);
+  Node* sum = test::graph::Add(&graph_, a, b);
+  TF_ASSERT_OK(Assign(/*max_streams=*/1));
+  EXPECT_EQ(node_to_stream_id_.size(), 3);
+  EXPECT_EQ(StreamOf(a), 0);
+  EXPECT_EQ(StreamOf(b), 0);
+  EXPECT_EQ(StreamOf(sum), 0);
+}
+
+TEST_F(GpuStreamUtilTest, ChainStaysOnOneStream) {
+  Node* a = Const(1.0f);
+  Node* b = test::graph::Unary(&graph_, "Neg", a);
+  Node* c = test::graph::Unary(&graph_, "Neg", b);
+  TF_ASSERT_OK(Assign(/*max_streams=*/4));
+  EXPECT_EQ(StreamOf(b), StreamOf(a));
+  EXPECT_EQ(StreamOf(c), StreamOf(a));
+}
+
+TEST_F(GpuStreamUtilTest, BranchesUseDifferentStreams) {
+  Node* a = Const(1.0f);
+  Node* left = test::graph::Unary(&graph_, "Neg", a);
+  Node* right = test::graph::Unary(&graph_, "Neg", a);
+  Node* join = test::graph::Add(&graph_, left, right);
+  TF_ASSERT_OK(Assign(/*max_streams=*/4));
+  EXPECT_NE(StreamOf(left), StreamOf(right));
+  // The join continues one of the branches instead of opening a new stream.
+  EXPECT_TRUE(StreamOf(join) == StreamOf(left) ||
+              StreamOf(join) == StreamOf(right));
+}
+
+TEST_F(GpuStreamUtilTest, StreamsAreBounded) {
+  std::vector<Node*> nodes;
+  for (int i = 0; i < 8; ++i) {
+    nodes.push_back(Const(static_cast<float>(i)));
+  }
+  TF_ASSERT_OK(Assign(/*max_streams=*/3));
+  std::set<int> streams;
+  for (Node* n : nodes) {
+    EXPECT_GE(StreamOf(n), 0);
+    EXPECT_LT(StreamOf(n), 3);
+    streams.insert(StreamOf(n));
+  }
+  EXPECT_EQ(streams.size(), 3);
+}
+
+}  // namespace
+}  // namespace tensorflow
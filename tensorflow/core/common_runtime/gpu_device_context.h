@@ -59,6 +59,13 @@ class GPUDeviceContext : public DeviceContext {
   }
   int stream_id() const { return stream_id_; }
 
+  // Compute streams whose pending work must finish before kernels that use
+  // this context may start, because they produce this context's inputs.
+  const gtl::InlinedVector<se::Stream*, 2>& wait_streams() const {
+    return wait_streams_;
+  }
+  void add_wait_stream(se::Stream* stream) { wait_streams_.push_back(stream); }
+
   void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
                              Tensor* device_tensor, StatusCallback done,
                              bool sync_dst_compute) const override;
@@ -92,6 +99,8 @@ class GPUDeviceContext : public DeviceContext {
   se::Stream* device_to_host_stream_;
   // Streams to use for copying data between GPUs.
   gtl::InlinedVector<se::Stream*, 4> device_to_device_stream_;
+  // Other compute streams that stream_ waits for before each kernel.
+  gtl::InlinedVector<se::Stream*, 2> wait_streams_;
 };
 
 }  // namespace tensorflow
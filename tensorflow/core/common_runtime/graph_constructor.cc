@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 
 #include <algorithm>
+#include <functional>
+#include <queue>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -42,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
@@ -96,7 +99,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          thread_pool(in.thread_pool) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -149,6 +153,10 @@ class GraphConstructor {
     bool add_default_attributes = true;
 
     string default_device;
+
+    // If non-null, the NodeDefs are prepared in parallel on this thread pool
+    // when they can be modified in place.  Not owned.
+    thread::ThreadPool* thread_pool = nullptr;
   };
 
   typedef gtl::ArraySlice<const NodeDef*> NodeDefSlice;
@@ -208,6 +216,10 @@ class GraphConstructor {
   Status ValidateInputMapAndControlDependencies();
   Status BuildNodeIndex();
   Status InitFromEdges();
+  // Adds the default attributes to and validates all the NodeDefs in
+  // parallel, when they can be modified in place.  Sets
+  // `node_defs_prepared_` on success.
+  Status PrepareNodeDefs();
   Status Convert();
   Status AddBackEdges();
   Status UpdateVersionDef();
@@ -278,6 +290,9 @@ class GraphConstructor {
   // Returns the i^th node in the graph. Must not be called after
   // consume_node_def(i).
   virtual const NodeDef& get_node_def(int i) const = 0;
+  // Returns the i^th node in the graph for modification in place, or nullptr
+  // if the nodes are not owned. Must not be called after consume_node_def(i).
+  virtual NodeDef* mutable_node_def(int i) = 0;
   // Destructively reads the i^th node in the graph, avoiding a copy if
   // possible. After calling this method, the result of get_node_def(i) is
   // undefined.
@@ -344,8 +359,13 @@ class GraphConstructor {
   gtl::FlatMap<string, string> uniquified_names_;
 
   // Index of NodeDefs in node_defs_ with all inputs already converted. We use a
-  // (sorted) set so nodes are created in the order defined in the GraphDef.
-  std::set<int> ready_;
+  // min-heap so nodes are created in the order defined in the GraphDef,
+  // without allocating a tree node for each of them.
+  std::priority_queue<int, std::vector<int>, std::greater<int>> ready_;
+
+  // True if PrepareNodeDefs() already added the default attributes to and
+  // validated the NodeDefs.
+  bool node_defs_prepared_ = false;
 
   // Mapping between index within node_defs_ and the number of inputs that
   // still need to be converted.
@@ -414,6 +434,7 @@ class NodeDefCopyingGraphConstructor : public GraphConstructor {
  private:
   size_t node_def_count() const override { return node_defs_.size(); }
   const NodeDef& get_node_def(int i) const override { return *node_defs_[i]; }
+  NodeDef* mutable_node_def(int i) override { return nullptr; }
   NodeDef consume_node_def(int i) override { return *node_defs_[i]; }
   const VersionDef* versions() const override { return versions_; }
   const FunctionDefLibrary* library() const override { return library_; }
@@ -444,6 +465,11 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
         << "NodeDef " << i << " accessed after it was consumed.";
     return graph_def_.node(i);
   }
+  NodeDef* mutable_node_def(int i) override {
+    CHECK(!is_consumed_[i])
+        << "NodeDef " << i << " accessed after it was consumed.";
+    return graph_def_.mutable_node(i);
+  }
   NodeDef consume_node_def(int i) override {
     CHECK(!is_consumed_[i]) << "NodeDef " << i << " consumed twice.";
     is_consumed_[i] = true;
@@ -540,7 +566,7 @@ void GraphConstructor::UpdatePendingCountAndReady(int processed,
       CHECK_GT(*current_pending_count, 0);
       (*current_pending_count)--;
       if (*current_pending_count == 0) {
-        ready_.insert(output);
+        ready_.push(output);
       }
     }
   }
@@ -642,6 +668,7 @@ Status GraphConstructor::ValidateInputMapAndControlDependencies() {
 }
 
 Status GraphConstructor::BuildNodeIndex() {
+  gdef_nodes_.reserve(node_def_count());
   // Validate the node names and add them to gdef_nodes_ and gdef_prefixes_.
   for (int n = 0; n < node_def_count(); ++n) {
     const NodeDef& node_def = get_node_def(n);
@@ -690,7 +717,9 @@ Status GraphConstructor::InitFromEdges() {
   const int num_nodes = node_def_count();
   pending_count_.reserve(num_nodes);
   outputs_.resize(num_nodes);
-  gtl::FlatSet<string> next_iteration_nodes;
+  // The NodeDefs are not consumed until Convert(), so their names can be
+  // referenced instead of copied.
+  gtl::FlatSet<StringPiece, StringPieceHasher> next_iteration_nodes;
   for (int n = 0; n < node_def_count(); ++n) {
     const NodeDef& node_def = get_node_def(n);
     if (IsNextIteration(node_def)) {
@@ -715,7 +744,7 @@ Status GraphConstructor::InitFromEdges() {
           num_control_edges++;
         } else {
           TensorId id(ParseTensorName(input_name));
-          if (next_iteration_nodes.find(string(id.first)) !=
+          if (next_iteration_nodes.find(id.first) !=
               next_iteration_nodes.end()) {
             has_loop_back_edge = true;
           }
@@ -746,13 +775,50 @@ Status GraphConstructor::InitFromEdges() {
       }
     }
     if (pending_count == 0) {
-      ready_.insert(n);
+      ready_.push(n);
     }
     pending_count_.push_back(pending_count);
   }
   return Status::OK();
 }
 
+Status GraphConstructor::PrepareNodeDefs() {
+  if (opts_.importing || opts_.thread_pool == nullptr) return Status::OK();
+  const int num_nodes = node_def_count();
+  std::vector<NodeDef*> node_defs(num_nodes);
+  for (int n = 0; n < num_nodes; ++n) {
+    node_defs[n] = mutable_node_def(n);
+    if (node_defs[n] == nullptr) return Status::OK();
+  }
+
+  // Each node gets its own status, so that the error reported is the one of
+  // the first invalid node, whatever the sharding.
+  std::vector<Status> statuses(num_nodes);
+  const OpRegistryInterface* op_registry = g_->op_registry();
+  auto prepare = [&](int64 start, int64 limit) {
+    for (int64 n = start; n < limit; ++n) {
+      NodeDef* node_def = node_defs[n];
+      const OpDef* op_def;
+      statuses[n] = op_registry->LookUpOpDef(node_def->op(), &op_def);
+      if (!statuses[n].ok()) continue;
+      if (opts_.add_default_attributes) {
+        AddDefaultsToNodeDef(*op_def, node_def);
+      }
+      if (opts_.validate_nodes) {
+        statuses[n] = ValidateNodeDef(*node_def, *op_def);
+      }
+    }
+  };
+  // Looking up the OpDef and validating the attrs of a node take a few
+  // microseconds.
+  opts_.thread_pool->ParallelFor(num_nodes, /*cost_per_unit=*/5000, prepare);
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  node_defs_prepared_ = true;
+  return Status::OK();
+}
+
 Status GraphConstructor::ValidateColocationConstraints(
     const NodeDef& node_def) {
   if (!opts_.validate_colocation_constraints || !opts_.importing)
@@ -1112,6 +1178,7 @@ Status GraphConstructor::Convert() {
     // avoid unnecessarily copying `*library()` here.
     TF_RETURN_IF_ERROR(g_->AddFunctionLibrary(*library()));
   }
+  TF_RETURN_IF_ERROR(PrepareNodeDefs());
 
   std::vector<InputInfo> inputs;
   int processed = 0;
@@ -1123,8 +1190,8 @@ Status GraphConstructor::Convert() {
   // inputs, pending_counts_ with the number of inputs for each node and
   // outputs_ with the outputs of each node).
   while (!ready_.empty()) {
-    int o = *ready_.begin();
-    ready_.erase(ready_.begin());
+    int o = ready_.top();
+    ready_.pop();
     ++processed;
     inputs.clear();
     bool has_data_back_edge = false;
@@ -1230,7 +1297,7 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
-    } else {
+    } else if (!node_defs_prepared_) {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
           g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -1013,6 +1015,39 @@ TEST_F(GraphConstructorTest, ImportGraphDef) {
   EXPECT_EQ(17, graph_.num_edges());
 }
 
+TEST_F(GraphConstructorTest, ConvertGraphDefOnThreadPool) {
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  opts.thread_pool = &thread_pool;
+
+  GraphDef def;
+  for (int i = 0; i < 100; ++i) {
+    NodeDef* node = def.add_node();
+    node->set_name(strings::StrCat("A", i));
+    node->set_op("TestDefaultAttr");
+  }
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, std::move(def), &graph_));
+  Node* a = FindNode("A99");
+  ASSERT_TRUE(a != nullptr);
+  int value = 0;
+  TF_ASSERT_OK(GetNodeAttr(a->attrs(), "default_int", &value));
+  EXPECT_EQ(31415, value);
+
+  // The error of the first invalid node is reported.
+  Graph graph(OpRegistry::Global());
+  def.Clear();
+  for (int i = 0; i < 100; ++i) {
+    NodeDef* node = def.add_node();
+    node->set_name(strings::StrCat("B", i));
+    node->set_op(i >= 60 ? "Unknown" : "TestDefaultAttr");
+    if (i >= 50) (*node->mutable_attr())["x"].set_i(i);
+  }
+  Status s = ConvertGraphDefToGraph(opts, std::move(def), &graph);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "{{node B50}}")) << s;
+}
+
 TEST_F(GraphConstructorTest, ImportGraphDef_DefaultAttrs) {
   GraphDef def;
   ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -35,8 +36,10 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/collective_order.h"
@@ -54,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/util/util.h"
 
 #ifndef IS_MOBILE_PLATFORM
+#include "tensorflow/core/common_runtime/optimized_graph_cache.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
@@ -339,6 +343,46 @@ class TensorConnectionPruneRewrite : public subgraph::PruneRewrite {
   NodeBuilder::NodeOut from_tensor_;
 };
 
+// Replaces a tensor with a Const holding the value it has in the callable.
+class ConstantFeedPruneRewrite : public subgraph::PruneRewrite {
+ public:
+  ConstantFeedPruneRewrite(const string* endpoint_name,
+                           const TensorProto* value)
+      : subgraph::PruneRewrite(endpoint_name, nullptr /* device_info */),
+        value_(value) {}
+
+  Status AddNode(Graph* g, NodeBuilder::NodeOut feed_tensor,
+                 Node** out_node) override {
+    Tensor value;
+    if (!value.FromProto(*value_)) {
+      return errors::InvalidArgument("Invalid value for constant feed \"",
+                                     endpoint_name(), "\"");
+    }
+    const DataType dtype =
+        BaseType(feed_tensor.node->output_type(feed_tensor.index));
+    if (value.dtype() != dtype) {
+      return errors::InvalidArgument(
+          "Constant feed \"", endpoint_name(), "\" has type ",
+          DataTypeString(value.dtype()), " but the tensor has type ",
+          DataTypeString(dtype));
+    }
+    TF_RETURN_IF_ERROR(
+        NodeBuilder(strings::StrCat("_constant_feed_", feed_tensor.node->name(),
+                                    "_", feed_tensor.index),
+                    "Const")
+            .Attr("dtype", dtype)
+            .Attr("value", value)
+            .Finalize(g, out_node));
+
+    (*out_node)->set_assigned_device_name(
+        feed_tensor.node->assigned_device_name());
+    return Status::OK();
+  }
+
+ private:
+  const TensorProto* value_;
+};
+
 template <class Map>
 Status LookupDevice(const DeviceSet& device_set, const string& tensor_name,
                     const Map& tensor2device,
@@ -579,6 +623,22 @@ Status GraphExecutionState::PruneGraph(
         &tensor_connection.to_tensor(), {from_node, from_id.second}));
   }
 
+  // Sort the constant feeds, so that the rewritten graph is deterministic.
+  std::map<string, const TensorProto*> constant_feeds;
+  for (const auto& constant_feed : options.callable_options.constant_feeds()) {
+    constant_feeds.emplace(constant_feed.first, &constant_feed.second);
+  }
+  for (const string& feed : options.callable_options.feed()) {
+    if (constant_feeds.count(feed) > 0) {
+      return errors::InvalidArgument("Tensor \"", feed,
+                                     "\" is both fed and a constant feed.");
+    }
+  }
+  for (const auto& constant_feed : constant_feeds) {
+    feed_rewrites.emplace_back(new ConstantFeedPruneRewrite(
+        &constant_feed.first, constant_feed.second));
+  }
+
   std::vector<string> target_node_names(
       options.callable_options.target().begin(),
       options.callable_options.target().end());
@@ -588,10 +648,10 @@ Status GraphExecutionState::PruneGraph(
 
   CHECK_EQ(out_rewrite_metadata->feed_types.size(),
            options.callable_options.feed_size() +
-               options.callable_options.tensor_connection_size());
-  for (int i = 0; i < options.callable_options.tensor_connection_size(); ++i) {
-    out_rewrite_metadata->feed_types.pop_back();
-  }
+               options.callable_options.tensor_connection_size() +
+               constant_feeds.size());
+  out_rewrite_metadata->feed_types.resize(
+      options.callable_options.feed_size());
   return Status::OK();
 }
 
@@ -631,6 +691,108 @@ Status GraphExecutionState::InitBaseGraph(std::unique_ptr<Graph>&& new_graph) {
   return Status::OK();
 }
 
+#ifndef IS_MOBILE_PLATFORM
+namespace {
+
+// Specializes the graph of `item` for the inputs of the callable that are
+// known when it is created: the constant feeds become Consts, and the fed
+// Placeholders get their known shapes, so that the optimizers fold the
+// computations that depend on them and prune the branches they rule out.
+Status SpecializeForCallable(const CallableOptions& callable_options,
+                             grappler::GrapplerItem* item) {
+  // Tensors other than the first output of a node are only rewritten when
+  // the graph is pruned.
+  std::unordered_map<string, PartialTensorShape> feed_shapes;
+  for (const auto& feed_shape : callable_options.feed_shapes()) {
+    const TensorId id = ParseTensorName(feed_shape.first);
+    if (id.index() == 0) {
+      feed_shapes.emplace(string(id.node()),
+                          PartialTensorShape(feed_shape.second));
+    }
+  }
+  std::unordered_map<string, const TensorProto*> constant_feeds;
+  for (const auto& constant_feed : callable_options.constant_feeds()) {
+    const TensorId id = ParseTensorName(constant_feed.first);
+    if (id.index() == 0) {
+      constant_feeds.emplace(string(id.node()), &constant_feed.second);
+    }
+  }
+  if (feed_shapes.empty() && constant_feeds.empty()) return Status::OK();
+
+  for (NodeDef& node : *item->graph.mutable_node()) {
+    auto constant_it = constant_feeds.find(node.name());
+    if (constant_it != constant_feeds.end()) {
+      Tensor value;
+      if (!value.FromProto(*constant_it->second)) {
+        return errors::InvalidArgument("Invalid value for constant feed \"",
+                                       node.name(), "\"");
+      }
+      // Ops defined in the function library are left to the pruning, which
+      // checks the type of the value.
+      const OpDef* op_def = nullptr;
+      DataType dtype;
+      if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+          !OutputTypeForNode(node, *op_def, 0, &dtype).ok()) {
+        continue;
+      }
+      if (value.dtype() != BaseType(dtype)) {
+        return errors::InvalidArgument(
+            "Constant feed \"", node.name(), "\" has type ",
+            DataTypeString(value.dtype()), " but the tensor has type ",
+            DataTypeString(BaseType(dtype)));
+      }
+      NodeDef const_node;
+      const_node.set_name(node.name());
+      const_node.set_op("Const");
+      const_node.set_device(node.device());
+      AddNodeAttr("dtype", value.dtype(), &const_node);
+      AddNodeAttr("value", value, &const_node);
+      node = std::move(const_node);
+      // The callable still replaces the node when the graph is pruned.
+      item->keep_ops.push_back(node.name());
+      continue;
+    }
+
+    auto shape_it = feed_shapes.find(node.name());
+    if (shape_it == feed_shapes.end() || node.attr().count("shape") == 0) {
+      continue;
+    }
+    PartialTensorShape shape;
+    TF_RETURN_IF_ERROR(GetNodeAttr(node, "shape", &shape));
+    PartialTensorShape merged_shape;
+    if (!shape.MergeWith(shape_it->second, &merged_shape).ok()) {
+      return errors::InvalidArgument(
+          "Feed shape ", shape_it->second.DebugString(), " of \"",
+          node.name(), "\" is incompatible with its shape ",
+          shape.DebugString());
+    }
+    merged_shape.AsProto((*node.mutable_attr())["shape"].mutable_shape());
+    shape_it->second = merged_shape;
+  }
+
+  // Give the fake feeds the known shapes, setting the unknown dimensions to 0
+  // like the other fake feeds.
+  for (auto& feed : item->feed) {
+    auto shape_it = feed_shapes.find(feed.first);
+    if (shape_it == feed_shapes.end() || feed.second.dtype() == DT_INVALID ||
+        shape_it->second.unknown_rank()) {
+      continue;
+    }
+    PartialTensorShape partial_shape = shape_it->second;
+    for (int i = 0; i < partial_shape.dims(); ++i) {
+      if (partial_shape.dim_size(i) < 0) partial_shape.set_dim(i, 0);
+    }
+    TensorShape shape;
+    if (partial_shape.AsTensorShape(&shape)) {
+      feed.second = Tensor(feed.second.dtype(), shape);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+#endif  // IS_MOBILE_PLATFORM
+
 Status GraphExecutionState::OptimizeGraph(
     const BuildGraphOptions& options, std::unique_ptr<Graph>* optimized_graph,
     std::unique_ptr<FunctionLibraryDefinition>* optimized_flib) {
@@ -747,6 +909,11 @@ Status GraphExecutionState::OptimizeGraph(
       }
     }
 
+    // The specialized graph is part of the key of the optimized graph cache,
+    // so each specialization of a callable is cached separately.
+    TF_RETURN_IF_ERROR(
+        SpecializeForCallable(options.callable_options, &item));
+
     Device* cpu_device = nullptr;
     for (const auto& device : device_set_->devices()) {
       if (device->parsed_name().id == 0 &&
@@ -755,11 +922,31 @@ Status GraphExecutionState::OptimizeGraph(
         cpu_device = device;
       }
     }
-    grappler::VirtualCluster cluster(device_set_);
+    // Reuse the graph optimized by an earlier session if it is cached.
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(
-        grappler::RunMetaOptimizer(std::move(item), session_options_->config,
-                                   cpu_device, &cluster, &new_graph));
+    std::unique_ptr<OptimizedGraphCache> cache;
+    string cache_key;
+    const string& cache_dir =
+        session_options_->config.experimental().optimized_graph_cache_dir();
+    if (!cache_dir.empty()) {
+      cache = absl::make_unique<OptimizedGraphCache>(session_options_->env,
+                                                     cache_dir);
+      cache_key = OptimizedGraphCache::Key(item, *device_set_,
+                                           session_options_->config);
+    }
+    if (cache == nullptr || !cache->Lookup(cache_key, &new_graph)) {
+      grappler::VirtualCluster cluster(device_set_);
+      TF_RETURN_IF_ERROR(
+          grappler::RunMetaOptimizer(std::move(item), session_options_->config,
+                                     cpu_device, &cluster, &new_graph));
+      if (cache != nullptr) {
+        const Status s = cache->Insert(cache_key, new_graph);
+        if (!s.ok()) {
+          LOG(WARNING) << "Failed to cache the optimized graph in "
+                       << cache_dir << ": " << s;
+        }
+      }
+    }
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
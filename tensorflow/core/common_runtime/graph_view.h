@@ -83,6 +83,10 @@ struct NodeItem {
                                                      // node.
   bool is_any_input_ref_typed : 1;  // True iff any IsRefType(dt) for dt in this
                                     // node's input types.
+  bool is_stateful : 1;              // True iff the node's op is stateful.
+  bool outputs_may_escape_step : 1;  // True iff a consumer of the node's
+                                     // outputs may hold on to them beyond
+                                     // the executor invocation.
 
   // The kernel for this node.
   OpKernel* kernel = nullptr;
@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
+#include <algorithm>
+
 #include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
@@ -31,6 +35,30 @@ namespace {
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
+
+// Returns true if the tensors produced by "node" may outlive the executor
+// invocation because a consumer may hold on to them, as do fetches, sends and
+// the ops that assign variables.
+bool OutputsMayEscapeStep(const Node* node) {
+  for (const Edge* e : node->out_edges()) {
+    if (e->IsControlEdge()) continue;
+    const Node* dst = e->dst();
+    if (dst->op_def().is_stateful() || dst->IsRetval() ||
+        IsTransferNode(dst) || IsRefType(dst->input_type(e->dst_input()))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Estimated costs, in units of roughly a microsecond, used to partition a
+// static schedule.  Kernels only report whether they are expensive, so the
+// estimates are coarse.
+constexpr int64 kInexpensiveNodeCost = 1;
+constexpr int64 kExpensiveNodeCost = 20;
+// The extra delay before a node can start when one of its inputs is produced
+// in another partition.
+constexpr int64 kCrossPartitionCost = 5;
 }  // namespace
 
 ImmutableExecutorState::~ImmutableExecutorState() {
@@ -40,6 +68,9 @@ ImmutableExecutorState::~ImmutableExecutorState() {
       params_.delete_kernel(item->kernel);
     }
   }
+  for (DeviceContext* device_context : device_context_map_) {
+    if (device_context != nullptr) device_context->Unref();
+  }
 }
 
 namespace {
@@ -128,6 +159,8 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
 
     item->input_start = frame_info->total_inputs;
     frame_info->total_inputs += n->num_inputs();
+    max_num_inputs_ = std::max(max_num_inputs_, n->num_inputs());
+    max_num_outputs_ = std::max(max_num_outputs_, n->num_outputs());
 
     Status s = params_.create_kernel(n->properties(), &item->kernel);
     if (!s.ok()) {
@@ -192,6 +225,8 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
         (IsEnter(n) || IsExit(n) || IsNextIteration(n));
     item->is_transfer_node = IsTransferNode(n);
     item->is_initialization_op = IsInitializationOp(n);
+    item->is_stateful = n->op_def().is_stateful();
+    item->outputs_may_escape_step = OutputsMayEscapeStep(n);
     item->is_recv_or_switch = IsRecv(n) || IsSwitch(n);
     item->is_next_iteration = IsNextIteration(n);
 
@@ -257,7 +292,17 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
-  return gview_.SetAllocAttrs(&graph, params_.device);
+  TF_RETURN_IF_ERROR(gview_.SetAllocAttrs(&graph, params_.device));
+
+  std::vector<DeviceContext*> device_context_map(graph.num_node_ids(),
+                                                 nullptr);
+  TF_RETURN_IF_ERROR(
+      params_.device->FillContextMap(&graph, &device_context_map));
+  if (std::any_of(device_context_map.begin(), device_context_map.end(),
+                  [](DeviceContext* dc) { return dc != nullptr; })) {
+    device_context_map_ = std::move(device_context_map);
+  }
+  return Status::OK();
 }
 
 namespace {
@@ -344,6 +389,85 @@ Status ImmutableExecutorState::BuildControlFlowInfo(const Graph* g,
   return Status::OK();
 }
 
+Status ImmutableExecutorState::BuildStaticSchedule(const Graph& graph,
+                                                   int max_partitions) {
+  if (requires_control_flow_) {
+    return errors::Unimplemented(
+        "A static schedule cannot be built for a graph with control flow.");
+  }
+  if (max_partitions < 1) {
+    return errors::InvalidArgument("max_partitions must be positive, got ",
+                                   max_partitions);
+  }
+
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+
+  auto schedule = absl::make_unique<StaticSchedule>();
+  const int num_nodes = gview_.num_nodes();
+  schedule->partition_of.assign(num_nodes, -1);
+  schedule->num_remote_inputs.assign(num_nodes, 0);
+
+  // The estimated times at which each node, and the last node placed in each
+  // partition, finish.
+  std::vector<int64> node_finish(num_nodes, 0);
+  std::vector<int64> partition_finish;
+  for (const Node* n : order) {
+    if (n->IsSource() || n->IsSink()) continue;
+    const int id = n->id();
+    const NodeItem* item = gview_.node(id);
+
+    // Consider every existing partition, and a new one if there is room.
+    const int num_partitions = partition_finish.size();
+    const int num_candidates = std::min(num_partitions + 1, max_partitions);
+    int best = -1;
+    int64 best_start = 0;
+    for (int p = 0; p < num_candidates; ++p) {
+      int64 start = p < num_partitions ? partition_finish[p] : 0;
+      for (const Edge* e : n->in_edges()) {
+        const Node* src = e->src();
+        if (src->IsSource()) continue;
+        int64 ready = node_finish[src->id()];
+        if (schedule->partition_of[src->id()] != p) {
+          ready += kCrossPartitionCost;
+        }
+        start = std::max(start, ready);
+      }
+      if (best < 0 || start < best_start) {
+        best = p;
+        best_start = start;
+      }
+    }
+    if (best == num_partitions) {
+      partition_finish.push_back(0);
+      schedule->partitions.emplace_back();
+    }
+
+    schedule->partition_of[id] = best;
+    node_finish[id] = best_start + (item->kernel->IsExpensive()
+                                        ? kExpensiveNodeCost
+                                        : kInexpensiveNodeCost);
+    partition_finish[best] = node_finish[id];
+    schedule->partitions[best].push_back(item);
+  }
+
+  for (const Node* n : graph.nodes()) {
+    const int partition = schedule->partition_of[n->id()];
+    if (partition < 0) continue;
+    for (const Edge* e : n->in_edges()) {
+      if (e->src()->IsSource()) continue;
+      if (schedule->partition_of[e->src()->id()] != partition) {
+        ++schedule->num_remote_inputs[n->id()];
+      }
+    }
+  }
+
+  VLOG(1) << "Built a static schedule with " << schedule->partitions.size()
+          << " partitions for " << graph.num_op_nodes() << " nodes.";
+  static_schedule_ = std::move(schedule);
+  return Status::OK();
+}
+
 void ImmutableExecutorState::InitializePending(const Graph* graph,
                                                const ControlFlowInfo& cf_info) {
   for (auto& it : cf_info.unique_frame_names) {
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
@@ -74,6 +75,23 @@ class ImmutableExecutorState {
     int32 parallel_iterations;
   };
 
+  // A schedule of the nodes of a graph without control flow, computed once so
+  // that each execution can run the nodes from flat lists instead of tracking
+  // which nodes are ready.
+  struct StaticSchedule {
+    // The nodes run by each thread, in a topological order.
+    std::vector<std::vector<const NodeItem*>> partitions;
+
+    // Indexed by node ID: the partition that runs the node, or -1 for the
+    // source and sink nodes, which are not scheduled.
+    std::vector<int32> partition_of;
+
+    // Indexed by node ID: the number of data and control edges into the node
+    // from nodes in other partitions.  A node waits only for these edges;
+    // its predecessors in its own partition have already run.
+    std::vector<int32> num_remote_inputs;
+  };
+
   explicit ImmutableExecutorState(const LocalExecutorParams& p)
       : params_(p), gview_() {}
   ~ImmutableExecutorState();
@@ -85,6 +103,19 @@ class ImmutableExecutorState {
   // a tensor buffer.
   Status SetAllocAttrs();
 
+  // Builds the static schedule of `graph`, which must be the graph that this
+  // state was initialized from, with at most `max_partitions` partitions.
+  //
+  // The nodes are list-scheduled in a topological order: each node is placed
+  // in the partition where it can start earliest, given estimates of its cost
+  // and of the cost of waiting for a predecessor in another partition.  Chains
+  // of dependent nodes therefore stay in one partition, and a new partition is
+  // only opened for independent work.
+  //
+  // Returns an `Unimplemented` error if the graph requires control flow
+  // support.
+  Status BuildStaticSchedule(const Graph& graph, int max_partitions);
+
   const LocalExecutorParams& params() const { return params_; }
   const GraphView& graph_view() const { return gview_; }
   const std::vector<PendingCounts::Handle>& pending_ids() const {
@@ -101,6 +132,22 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // The largest numbers of inputs and outputs of a node of the graph, which
+  // size the buffers that the executor reuses from one node to the next.
+  int max_num_inputs() const { return max_num_inputs_; }
+  int max_num_outputs() const { return max_num_outputs_; }
+
+  // Returns the DeviceContext that the device assigned to node `id` in
+  // `Device::FillContextMap()`, or nullptr if the node uses the default one.
+  DeviceContext* device_context(int id) const {
+    return device_context_map_.empty() ? nullptr : device_context_map_[id];
+  }
+
+  // Returns the schedule built by `BuildStaticSchedule()`, or nullptr.
+  const StaticSchedule* static_schedule() const {
+    return static_schedule_.get();
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -132,6 +179,8 @@ class ImmutableExecutorState {
   LocalExecutorParams params_;
   GraphView gview_;
   bool requires_control_flow_;
+  int max_num_inputs_ = 0;
+  int max_num_outputs_ = 0;
   std::vector<PendingCounts::Handle> pending_ids_;
 
   // Root nodes (with no in edges) that should form the initial ready queue
@@ -152,9 +201,15 @@ class ImmutableExecutorState {
   // pending counts for the nodes in the graph, indexed by node ID.
   std::unique_ptr<std::atomic<int32>[]> atomic_pending_counts_;
 
+  // Indexed by node ID, or empty if the device uses a single context.  Holds
+  // one reference on each non-null entry.
+  std::vector<DeviceContext*> device_context_map_;
+
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  std::unique_ptr<StaticSchedule> static_schedule_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ImmutableExecutorState);
 };
 
@@ -0,0 +1,63 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/kernel_params_block.h"
+
+#include <memory>
+#include <vector>
+
+namespace tensorflow {
+
+namespace {
+
+// The free blocks of the calling thread.  A thread only holds several blocks
+// if it nests executors, e.g. for functions run inline.
+std::vector<std::unique_ptr<KernelParamsBlock>>* FreeBlocks() {
+  thread_local std::vector<std::unique_ptr<KernelParamsBlock>> free_blocks;
+  return &free_blocks;
+}
+
+}  // namespace
+
+KernelParamsBlock* KernelParamsBlock::Acquire(int max_num_inputs,
+                                              int max_num_outputs) {
+  std::vector<std::unique_ptr<KernelParamsBlock>>* free_blocks = FreeBlocks();
+  KernelParamsBlock* block;
+  if (free_blocks->empty()) {
+    block = new KernelParamsBlock;
+  } else {
+    block = free_blocks->back().release();
+    free_blocks->pop_back();
+  }
+  block->Reset(max_num_inputs, max_num_outputs);
+  return block;
+}
+
+void KernelParamsBlock::Release(KernelParamsBlock* block) {
+  FreeBlocks()->emplace_back(block);
+}
+
+void KernelParamsBlock::Reset(int max_num_inputs, int max_num_outputs) {
+  // Unlike clear(), resize() keeps the heap storage of an InlinedVector.
+  inputs_.resize(0);
+  input_alloc_attrs_.resize(0);
+  context_outputs_.resize(0);
+  outputs_.resize(0);
+  inputs_.reserve(max_num_inputs);
+  input_alloc_attrs_.reserve(max_num_inputs);
+  context_outputs_.reserve(max_num_outputs);
+  outputs_.reserve(max_num_outputs);
+}
+
+}  // namespace tensorflow
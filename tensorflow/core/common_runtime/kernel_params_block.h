@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_PARAMS_BLOCK_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_PARAMS_BLOCK_H_
+
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+
+// Storage for the inputs and outputs of the kernels run by an executor.
+//
+// The vectors that hold the inputs and outputs of a kernel are inlined for up
+// to 4 values, and allocated on the heap for kernels with more.  The executor
+// thus runs the kernels with the vectors of a block, which keep their capacity
+// from one kernel to the next, and from one step to the next since blocks are
+// recycled: once warmed up, setting up a kernel doesn't allocate.
+//
+// Blocks are pooled per thread, so a block must be released on the thread
+// that acquired it, and must not be used by kernels that outlive the call
+// that acquired it, e.g. asynchronous kernels.
+class KernelParamsBlock {
+ public:
+  // Returns a block of the calling thread with room for the inputs and
+  // outputs of any kernel with at most `max_num_inputs` inputs and
+  // `max_num_outputs` outputs.  Nested acquisitions return distinct blocks.
+  static KernelParamsBlock* Acquire(int max_num_inputs, int max_num_outputs);
+
+  // Returns `block` to the pool of the calling thread.
+  static void Release(KernelParamsBlock* block);
+
+  KernelParamsBlock() = default;
+
+  // Clears the values of the block, and reserves room for the given numbers
+  // of inputs and outputs.  Only allocates if the block never had that room.
+  void Reset(int max_num_inputs, int max_num_outputs);
+
+  // The inputs of a kernel, for `OpKernelContext::Params`.
+  gtl::InlinedVector<TensorValue, 4>* inputs() { return &inputs_; }
+  gtl::InlinedVector<AllocatorAttributes, 4>* input_alloc_attrs() {
+    return &input_alloc_attrs_;
+  }
+
+  // The storage of the outputs of an `OpKernelContext`.
+  gtl::InlinedVector<TensorValue, 4>* context_outputs() {
+    return &context_outputs_;
+  }
+
+  // The outputs of a kernel, as propagated by the executor.
+  EntryVector* outputs() { return &outputs_; }
+
+ private:
+  gtl::InlinedVector<TensorValue, 4> inputs_;
+  gtl::InlinedVector<AllocatorAttributes, 4> input_alloc_attrs_;
+  gtl::InlinedVector<TensorValue, 4> context_outputs_;
+  EntryVector outputs_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(KernelParamsBlock);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_PARAMS_BLOCK_H_
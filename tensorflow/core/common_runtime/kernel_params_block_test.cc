@@ -0,0 +1,130 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/kernel_params_block.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace {
+
+// Counts the allocations of the calling thread while `counting_allocations`.
+thread_local bool counting_allocations = false;
+thread_local int num_allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  if (counting_allocations) ++num_allocations;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) std::abort();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace tensorflow {
+namespace {
+
+class DummyDevice : public DeviceBase {
+ public:
+  explicit DummyDevice(Env* env) : DeviceBase(env) {}
+};
+
+// Sets up the inputs and outputs of a kernel with `num_inputs` inputs and
+// `num_outputs` outputs, as the executor does.
+void RunKernel(KernelParamsBlock* block, OpKernelContext::Params* params,
+               int num_inputs, int num_outputs) {
+  block->inputs()->resize(num_inputs);
+  block->input_alloc_attrs()->resize(num_inputs);
+  params->inputs = block->inputs();
+  params->input_alloc_attrs = block->input_alloc_attrs();
+  OpKernelContext ctx(params, num_outputs, block->context_outputs());
+  if (block->outputs()->size() < num_outputs) {
+    block->outputs()->resize(num_outputs);
+  }
+}
+
+TEST(KernelParamsBlockTest, RecyclesBlocks) {
+  KernelParamsBlock* block = KernelParamsBlock::Acquire(2, 2);
+  KernelParamsBlock::Release(block);
+  KernelParamsBlock* reused = KernelParamsBlock::Acquire(2, 2);
+  EXPECT_EQ(reused, block);
+  // Nested acquisitions get their own block.
+  KernelParamsBlock* nested = KernelParamsBlock::Acquire(2, 2);
+  EXPECT_NE(nested, reused);
+  KernelParamsBlock::Release(nested);
+  KernelParamsBlock::Release(reused);
+}
+
+TEST(KernelParamsBlockTest, ResetClearsAndReserves) {
+  KernelParamsBlock block;
+  block.inputs()->resize(3);
+  block.outputs()->resize(3);
+  block.Reset(16, 32);
+  EXPECT_TRUE(block.inputs()->empty());
+  EXPECT_TRUE(block.outputs()->empty());
+  EXPECT_GE(block.inputs()->capacity(), 16);
+  EXPECT_GE(block.input_alloc_attrs()->capacity(), 16);
+  EXPECT_GE(block.context_outputs()->capacity(), 32);
+  EXPECT_GE(block.outputs()->capacity(), 32);
+}
+
+TEST(KernelParamsBlockTest, ContextGivesOutputStorageBack) {
+  DummyDevice device(Env::Default());
+  OpKernelContext::Params params;
+  params.device = &device;
+  gtl::InlinedVector<TensorValue, 4> storage;
+  storage.reserve(8);
+  const TensorValue* data = storage.data();
+  {
+    OpKernelContext ctx(&params, 8, &storage);
+    EXPECT_EQ(ctx.num_outputs(), 8);
+    EXPECT_EQ(ctx.release_output(7).tensor, nullptr);
+  }
+  EXPECT_TRUE(storage.empty());
+  EXPECT_EQ(storage.data(), data);
+}
+
+TEST(KernelParamsBlockTest, SteadyStateDoesNotAllocate) {
+  DummyDevice device(Env::Default());
+  OpKernelContext::Params params;
+  params.device = &device;
+  // Kernels with more inputs and outputs than the inlined capacity.
+  constexpr int kMaxInputs = 16;
+  constexpr int kMaxOutputs = 12;
+  auto run_step = [&]() {
+    KernelParamsBlock* block =
+        KernelParamsBlock::Acquire(kMaxInputs, kMaxOutputs);
+    RunKernel(block, &params, kMaxInputs, 1);
+    RunKernel(block, &params, 2, kMaxOutputs);
+    RunKernel(block, &params, kMaxInputs, kMaxOutputs);
+    KernelParamsBlock::Release(block);
+  };
+
+  run_step();
+  counting_allocations = true;
+  num_allocations = 0;
+  for (int i = 0; i < 10; ++i) run_step();
+  counting_allocations = false;
+  EXPECT_EQ(num_allocations, 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,312 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_timeline.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kUnknownOp[] = "unknown";
+
+}  // namespace
+
+MemoryTimeline::MemoryTimeline(const string& name, const Options& options)
+    : name_(name),
+      options_(options),
+      shards_(new Shard[kNumShards]),
+      random_(random::New64()) {
+  bytes_until_sample_ = NextSampleDistance();
+  next_checkpoint_micros_ =
+      Env::Default()->NowMicros() + options_.checkpoint_interval_micros;
+}
+
+MemoryTimeline::Shard& MemoryTimeline::ShardFor(const void* ptr) {
+  // Allocations are at least 64-byte aligned by most allocators.
+  return shards_[(reinterpret_cast<uintptr_t>(ptr) >> 6) % kNumShards];
+}
+
+int64 MemoryTimeline::NextSampleDistance() {
+  if (options_.sampling_interval_bytes <= 1) return 1;
+  mutex_lock l(random_mu_);
+  random::SimplePhilox random(&random_);
+  // Exponentially distributed distances make every allocated byte equally
+  // likely to be sampled, whatever the sizes and order of the allocations.
+  const double distance =
+      -std::log(1.0 - random.RandDouble()) * options_.sampling_interval_bytes;
+  return std::max<int64>(static_cast<int64>(distance), 1);
+}
+
+int64 MemoryTimeline::SampledBytes(int64 num_bytes) const {
+  if (options_.sampling_interval_bytes <= 1) return num_bytes;
+  // An allocation of `num_bytes` bytes is sampled with probability
+  // 1 - exp(-num_bytes / sampling_interval_bytes).
+  const double probability = -std::expm1(
+      -static_cast<double>(num_bytes) / options_.sampling_interval_bytes);
+  return static_cast<int64>(num_bytes / probability);
+}
+
+void MemoryTimeline::RecordAllocation(const void* ptr, size_t num_bytes) {
+  if (ptr == nullptr || num_bytes == 0) return;
+  const int64 bytes = static_cast<int64>(num_bytes);
+  const int64 before =
+      bytes_until_sample_.fetch_sub(bytes, std::memory_order_relaxed);
+  // Only the allocation that crosses the sampling point is sampled.
+  if (before <= 0 || before > bytes) return;
+  bytes_until_sample_.store(NextSampleDistance(), std::memory_order_relaxed);
+
+  const MemoryDebugAnnotation& annotation =
+      ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  LiveSample sample;
+  sample.op_name = annotation.pending_op_name != nullptr
+                       ? annotation.pending_op_name
+                       : kUnknownOp;
+  sample.step_id = annotation.pending_step_id;
+  sample.bytes = bytes;
+  sample.sampled_bytes = SampledBytes(bytes);
+  sample.alloc_micros = Env::Default()->NowMicros();
+  sample.checkpoint = num_checkpoints_.load(std::memory_order_relaxed);
+  {
+    Shard& shard = ShardFor(ptr);
+    mutex_lock l(shard.mu);
+    shard.samples[ptr] = sample;
+  }
+  num_live_samples_.fetch_add(1, std::memory_order_relaxed);
+  const int64 live_bytes =
+      live_bytes_.fetch_add(sample.sampled_bytes, std::memory_order_relaxed) +
+      sample.sampled_bytes;
+  AddEvent(MemoryTimelineEvent::kAllocation, sample, live_bytes);
+  MaybeCheckpoint(sample.alloc_micros);
+}
+
+void MemoryTimeline::RecordDeallocation(const void* ptr) {
+  if (ptr == nullptr ||
+      num_live_samples_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  LiveSample sample;
+  {
+    Shard& shard = ShardFor(ptr);
+    mutex_lock l(shard.mu);
+    auto it = shard.samples.find(ptr);
+    if (it == shard.samples.end()) return;
+    sample = std::move(it->second);
+    shard.samples.erase(it);
+  }
+  num_live_samples_.fetch_sub(1, std::memory_order_relaxed);
+  const int64 live_bytes =
+      live_bytes_.fetch_sub(sample.sampled_bytes, std::memory_order_relaxed) -
+      sample.sampled_bytes;
+  AddEvent(MemoryTimelineEvent::kDeallocation, sample, live_bytes);
+}
+
+void MemoryTimeline::AddEvent(MemoryTimelineEvent::Type type,
+                              const LiveSample& sample, int64 live_bytes) {
+  MemoryTimelineEvent event;
+  event.type = type;
+  event.time_micros = type == MemoryTimelineEvent::kAllocation
+                          ? sample.alloc_micros
+                          : Env::Default()->NowMicros();
+  event.op_name = sample.op_name;
+  event.step_id = sample.step_id;
+  event.bytes = sample.bytes;
+  event.sampled_bytes = sample.sampled_bytes;
+  event.live_bytes = live_bytes;
+  profiler::TraceMe::InstantActivity(
+      [this, &event]() {
+        return profiler::TraceMeEncode(
+            event.type == MemoryTimelineEvent::kAllocation
+                ? "MemoryTimelineAllocation"
+                : "MemoryTimelineDeallocation",
+            {{"allocator_name", name_},
+             {"tf_op", event.op_name},
+             {"id", event.step_id},
+             {"requested_bytes", event.bytes},
+             {"sampled_bytes", event.sampled_bytes},
+             {"live_bytes", event.live_bytes}});
+      },
+      /*level=*/profiler::TraceMeLevel::kInfo);
+
+  if (options_.max_events <= 0) return;
+  mutex_lock l(events_mu_);
+  if (events_.size() < static_cast<size_t>(options_.max_events)) {
+    events_.push_back(std::move(event));
+  } else {
+    events_[next_event_] = std::move(event);
+    next_event_ = (next_event_ + 1) % events_.size();
+  }
+}
+
+std::vector<MemoryTimelineEvent> MemoryTimeline::Events() const {
+  mutex_lock l(events_mu_);
+  std::vector<MemoryTimelineEvent> events;
+  events.reserve(events_.size());
+  events.insert(events.end(), events_.begin() + next_event_, events_.end());
+  events.insert(events.end(), events_.begin(), events_.begin() + next_event_);
+  return events;
+}
+
+void MemoryTimeline::MaybeCheckpoint(int64 now_micros) {
+  if (options_.checkpoint_interval_micros <= 0) return;
+  int64 next = next_checkpoint_micros_.load(std::memory_order_relaxed);
+  if (now_micros < next) return;
+  // Only the thread that moves the deadline takes the checkpoint.
+  if (next_checkpoint_micros_.compare_exchange_strong(
+          next, now_micros + options_.checkpoint_interval_micros,
+          std::memory_order_relaxed)) {
+    Checkpoint();
+  }
+}
+
+void MemoryTimeline::Checkpoint() {
+  mutex_lock l(checkpoint_mu_);
+  const int64 checkpoint = num_checkpoints_.load(std::memory_order_relaxed);
+  struct OpBytes {
+    int64 bytes = 0;
+    int64 num_allocations = 0;
+  };
+  absl::flat_hash_map<string, OpBytes> long_lived;
+  for (int i = 0; i < kNumShards; ++i) {
+    Shard& shard = shards_[i];
+    mutex_lock shard_lock(shard.mu);
+    for (const auto& entry : shard.samples) {
+      const LiveSample& sample = entry.second;
+      if (sample.checkpoint >= checkpoint) continue;
+      OpBytes& op_bytes = long_lived[sample.op_name];
+      op_bytes.bytes += sample.sampled_bytes;
+      ++op_bytes.num_allocations;
+    }
+  }
+  num_checkpoints_.store(checkpoint + 1, std::memory_order_relaxed);
+
+  for (const auto& entry : long_lived) history_[entry.first];
+  absl::flat_hash_set<string> previous_suspects;
+  for (const MemoryLeakSuspect& suspect : leak_suspects_) {
+    previous_suspects.insert(suspect.op_name);
+  }
+  leak_suspects_.clear();
+  const size_t history_size = std::max(options_.leak_checkpoints, 1) + 1;
+  for (auto it = history_.begin(); it != history_.end();) {
+    std::deque<int64>& history = it->second;
+    auto op_bytes = long_lived.find(it->first);
+    history.push_back(op_bytes != long_lived.end() ? op_bytes->second.bytes
+                                                   : 0);
+    if (history.size() > history_size) history.pop_front();
+    if (std::all_of(history.begin(), history.end(),
+                    [](int64 bytes) { return bytes == 0; })) {
+      history_.erase(it++);
+      continue;
+    }
+    bool grew = history.size() == history_size &&
+                history.back() - history.front() >=
+                    options_.leak_min_growth_bytes;
+    for (size_t i = 1; grew && i < history.size(); ++i) {
+      grew = history[i] > history[i - 1];
+    }
+    if (grew) {
+      MemoryLeakSuspect suspect;
+      suspect.op_name = it->first;
+      suspect.long_lived_bytes = history.back();
+      suspect.growth_bytes = history.back() - history.front();
+      suspect.num_allocations = op_bytes->second.num_allocations;
+      leak_suspects_.push_back(std::move(suspect));
+    }
+    ++it;
+  }
+  std::sort(leak_suspects_.begin(), leak_suspects_.end(),
+            [](const MemoryLeakSuspect& a, const MemoryLeakSuspect& b) {
+              return a.growth_bytes > b.growth_bytes;
+            });
+
+  for (const MemoryLeakSuspect& suspect : leak_suspects_) {
+    if (previous_suspects.contains(suspect.op_name)) continue;
+    LOG(WARNING) << "Allocator (" << name_ << "): the long-lived allocations "
+                 << "of op " << suspect.op_name << " grew by "
+                 << strings::HumanReadableNumBytes(suspect.growth_bytes)
+                 << " to "
+                 << strings::HumanReadableNumBytes(suspect.long_lived_bytes)
+                 << " over the last " << history_size - 1
+                 << " memory timeline checkpoints, which may be a leak.";
+    profiler::TraceMe::InstantActivity(
+        [this, &suspect]() {
+          return profiler::TraceMeEncode(
+              "MemoryLeakSuspect",
+              {{"allocator_name", name_},
+               {"tf_op", suspect.op_name},
+               {"long_lived_bytes", suspect.long_lived_bytes},
+               {"growth_bytes", suspect.growth_bytes}});
+        },
+        /*level=*/profiler::TraceMeLevel::kInfo);
+  }
+}
+
+std::vector<MemoryLeakSuspect> MemoryTimeline::LeakSuspects() const {
+  mutex_lock l(checkpoint_mu_);
+  return leak_suspects_;
+}
+
+MemoryTimelineAllocator::MemoryTimelineAllocator(
+    Allocator* allocator, bool owns_allocator,
+    const MemoryTimeline::Options& options)
+    : allocator_(allocator),
+      owns_allocator_(owns_allocator),
+      timeline_(allocator->Name(), options) {}
+
+MemoryTimelineAllocator::~MemoryTimelineAllocator() {
+  if (owns_allocator_) delete allocator_;
+}
+
+/*static*/ Allocator* MemoryTimelineAllocator::MaybeWrap(
+    Allocator* allocator, bool owns_allocator) {
+  MemoryTimeline::Options options;
+  Status status = ReadInt64FromEnvVar(
+      "TF_MEMORY_TIMELINE_SAMPLING_INTERVAL_BYTES", 0,
+      &options.sampling_interval_bytes);
+  if (!status.ok()) {
+    LOG(ERROR) << "MemoryTimelineAllocator: " << status.error_message();
+    return allocator;
+  }
+  if (options.sampling_interval_bytes <= 0) return allocator;
+  VLOG(1) << "Recording a memory timeline of " << allocator->Name()
+          << " sampled every " << options.sampling_interval_bytes
+          << " bytes";
+  return new MemoryTimelineAllocator(allocator, owns_allocator, options);
+}
+
+void* MemoryTimelineAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  timeline_.RecordAllocation(ptr, num_bytes);
+  return ptr;
+}
+
+void MemoryTimelineAllocator::DeallocateRaw(void* ptr) {
+  timeline_.RecordDeallocation(ptr);
+  allocator_->DeallocateRaw(ptr);
+}
+
+}  // namespace tensorflow
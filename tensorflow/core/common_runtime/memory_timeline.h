@@ -0,0 +1,237 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_TIMELINE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_TIMELINE_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocation or deallocation recorded by a MemoryTimeline.
+struct MemoryTimelineEvent {
+  enum Type { kAllocation, kDeallocation };
+  Type type = kAllocation;
+  int64 time_micros = 0;
+  // The op and step that made the allocation, from the
+  // ScopedMemoryDebugAnnotation current at that time.
+  string op_name;
+  int64 step_id = 0;
+  // The requested size of the allocation, and the number of allocated bytes
+  // that the sample stands for.
+  int64 bytes = 0;
+  int64 sampled_bytes = 0;
+  // The estimated number of bytes in use after the event.
+  int64 live_bytes = 0;
+};
+
+// An op whose long-lived allocations grew at each of the last leak
+// checkpoints of a MemoryTimeline.
+struct MemoryLeakSuspect {
+  string op_name;
+  // The estimated bytes of the live allocations of the op that survived at
+  // least one checkpoint, at the last checkpoint, and their growth over the
+  // checked checkpoints.
+  int64 long_lived_bytes = 0;
+  int64 growth_bytes = 0;
+  // The number of sampled allocations behind `long_lived_bytes`.
+  int64 num_allocations = 0;
+};
+
+// A compact timeline of the memory of an allocator, cheap enough to keep on
+// for the whole life of a job.
+//
+// Allocations are sampled on average once every `sampling_interval_bytes`
+// allocated bytes, so that large allocations are more likely to be sampled,
+// and each sample is weighted by the number of bytes it stands for.  Sampled
+// allocations and their deallocations are kept in a bounded ring buffer and
+// reported to the profiler as TraceMe events, attributed to the op and step
+// of the current ScopedMemoryDebugAnnotation.
+//
+// At each leak checkpoint, the live sampled allocations that already
+// survived the previous checkpoint are summed up by op.  An op whose sum grew
+// at each of the last `leak_checkpoints` checkpoints becomes a leak suspect,
+// which catches slow memory creep that no single MemoryDump shows.
+class MemoryTimeline {
+ public:
+  struct Options {
+    // The mean number of allocated bytes between two sampled allocations.  If
+    // at most 1, every allocation is sampled.
+    int64 sampling_interval_bytes = 1 << 20;
+
+    // The number of events kept in the ring buffer.
+    int64 max_events = 1 << 14;
+
+    // The period of the leak checkpoints, taken by the first sampled
+    // allocation after it elapses.  If 0, checkpoints are only taken by
+    // Checkpoint().
+    int64 checkpoint_interval_micros = 60 * 1000 * 1000;
+
+    // An op is a leak suspect if its long-lived bytes grew at each of the
+    // last `leak_checkpoints` checkpoints, by at least `leak_min_growth_bytes`
+    // in total.
+    int leak_checkpoints = 5;
+    int64 leak_min_growth_bytes = 1 << 20;
+  };
+
+  MemoryTimeline(const string& name, const Options& options);
+
+  // Records the allocation of `num_bytes` bytes at `ptr`, if it is sampled.
+  void RecordAllocation(const void* ptr, size_t num_bytes);
+
+  // Records the deallocation of `ptr`, if its allocation was sampled.
+  void RecordDeallocation(const void* ptr);
+
+  // Takes a leak checkpoint now.
+  void Checkpoint();
+
+  // Returns the events of the ring buffer, oldest first.
+  std::vector<MemoryTimelineEvent> Events() const;
+
+  // Returns the leak suspects of the last checkpoint, by decreasing growth.
+  std::vector<MemoryLeakSuspect> LeakSuspects() const;
+
+  // Returns the estimated number of bytes in use.
+  int64 live_bytes() const {
+    return live_bytes_.load(std::memory_order_relaxed);
+  }
+
+  const string& name() const { return name_; }
+
+ private:
+  struct LiveSample {
+    string op_name;
+    int64 step_id = 0;
+    int64 bytes = 0;
+    int64 sampled_bytes = 0;
+    int64 alloc_micros = 0;
+    // The number of checkpoints taken before the allocation.
+    int64 checkpoint = 0;
+  };
+
+  struct Shard {
+    mutex mu;
+    absl::flat_hash_map<const void*, LiveSample> samples TF_GUARDED_BY(mu);
+  };
+
+  static constexpr int kNumShards = 16;
+
+  Shard& ShardFor(const void* ptr);
+
+  // Returns the number of bytes to allocate before the next sample.
+  int64 NextSampleDistance();
+
+  // Returns the number of allocated bytes that a sampled allocation of
+  // `num_bytes` bytes stands for.
+  int64 SampledBytes(int64 num_bytes) const;
+
+  void AddEvent(MemoryTimelineEvent::Type type, const LiveSample& sample,
+                int64 live_bytes);
+
+  void MaybeCheckpoint(int64 now_micros);
+
+  const string name_;
+  const Options options_;
+
+  std::atomic<int64> bytes_until_sample_;
+  std::atomic<int64> num_live_samples_{0};
+  std::atomic<int64> live_bytes_{0};
+  std::atomic<int64> next_checkpoint_micros_;
+  std::atomic<int64> num_checkpoints_{0};
+  std::unique_ptr<Shard[]> shards_;
+
+  mutex random_mu_;
+  random::PhiloxRandom random_ TF_GUARDED_BY(random_mu_);
+
+  mutable mutex events_mu_;
+  std::vector<MemoryTimelineEvent> events_ TF_GUARDED_BY(events_mu_);
+  // The index of the oldest event once `events_` is full.
+  size_t next_event_ TF_GUARDED_BY(events_mu_) = 0;
+
+  mutable mutex checkpoint_mu_;
+  // The long-lived bytes of each op at the last checkpoints, oldest first.
+  absl::flat_hash_map<string, std::deque<int64>> history_
+      TF_GUARDED_BY(checkpoint_mu_);
+  std::vector<MemoryLeakSuspect> leak_suspects_ TF_GUARDED_BY(checkpoint_mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryTimeline);
+};
+
+// An Allocator wrapper that records the allocations of the wrapped allocator
+// in a MemoryTimeline.
+class MemoryTimelineAllocator : public Allocator {
+ public:
+  MemoryTimelineAllocator(Allocator* allocator, bool owns_allocator,
+                          const MemoryTimeline::Options& options);
+  ~MemoryTimelineAllocator() override;
+
+  // Wraps `allocator` if the TF_MEMORY_TIMELINE_SAMPLING_INTERVAL_BYTES
+  // environment variable is positive, and returns `allocator` otherwise.
+  static Allocator* MaybeWrap(Allocator* allocator, bool owns_allocator);
+
+  string Name() override { return allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override {
+    return allocator_->TracksAllocationSizes();
+  }
+  bool AllocatesOpaqueHandle() const override {
+    return allocator_->AllocatesOpaqueHandle();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return allocator_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return allocator_->AllocatedSize(ptr);
+  }
+  int64 AllocationId(const void* ptr) const override {
+    return allocator_->AllocationId(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override {
+    return allocator_->GetStats();
+  }
+  void ClearStats() override { allocator_->ClearStats(); }
+  void SetSafeFrontier(uint64 count) override {
+    allocator_->SetSafeFrontier(count);
+  }
+
+  MemoryTimeline* timeline() { return &timeline_; }
+
+ private:
+  Allocator* const allocator_;
+  const bool owns_allocator_;
+  MemoryTimeline timeline_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryTimelineAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_TIMELINE_H_
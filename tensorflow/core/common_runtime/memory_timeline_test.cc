@@ -0,0 +1,155 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_timeline.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+MemoryTimeline::Options SampleEverything() {
+  MemoryTimeline::Options options;
+  options.sampling_interval_bytes = 1;
+  options.checkpoint_interval_micros = 0;
+  return options;
+}
+
+TEST(MemoryTimelineTest, RecordsAnnotatedEvents) {
+  MemoryTimelineAllocator allocator(cpu_allocator(), false,
+                                    SampleEverything());
+  void* first;
+  void* second;
+  {
+    ScopedMemoryDebugAnnotation annotation("first_op", 7);
+    first = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  }
+  {
+    ScopedMemoryDebugAnnotation annotation("second_op", 8);
+    second = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  }
+  allocator.DeallocateRaw(first);
+  EXPECT_EQ(allocator.timeline()->live_bytes(), 256);
+  allocator.DeallocateRaw(second);
+  EXPECT_EQ(allocator.timeline()->live_bytes(), 0);
+
+  const std::vector<MemoryTimelineEvent> events =
+      allocator.timeline()->Events();
+  ASSERT_EQ(events.size(), 4);
+  EXPECT_EQ(events[0].type, MemoryTimelineEvent::kAllocation);
+  EXPECT_EQ(events[0].op_name, "first_op");
+  EXPECT_EQ(events[0].step_id, 7);
+  EXPECT_EQ(events[0].bytes, 1024);
+  EXPECT_EQ(events[0].live_bytes, 1024);
+  EXPECT_EQ(events[1].op_name, "second_op");
+  EXPECT_EQ(events[1].live_bytes, 1280);
+  EXPECT_EQ(events[2].type, MemoryTimelineEvent::kDeallocation);
+  EXPECT_EQ(events[2].op_name, "first_op");
+  EXPECT_EQ(events[3].live_bytes, 0);
+}
+
+TEST(MemoryTimelineTest, RingBufferKeepsLatestEvents) {
+  MemoryTimeline::Options options = SampleEverything();
+  options.max_events = 3;
+  MemoryTimeline timeline("test", options);
+  std::vector<char> buffer(5);
+  for (int i = 0; i < 5; ++i) {
+    timeline.RecordAllocation(&buffer[i], i + 1);
+  }
+  const std::vector<MemoryTimelineEvent> events = timeline.Events();
+  ASSERT_EQ(events.size(), 3);
+  EXPECT_EQ(events[0].bytes, 3);
+  EXPECT_EQ(events[1].bytes, 4);
+  EXPECT_EQ(events[2].bytes, 5);
+}
+
+TEST(MemoryTimelineTest, SamplingEstimatesLiveBytes) {
+  MemoryTimeline::Options options;
+  options.sampling_interval_bytes = 64 << 10;
+  options.checkpoint_interval_micros = 0;
+  MemoryTimeline timeline("test", options);
+  constexpr int kNumAllocations = 100000;
+  constexpr int kBytes = 1024;
+  std::vector<char> buffer(kNumAllocations);
+  for (int i = 0; i < kNumAllocations; ++i) {
+    timeline.RecordAllocation(&buffer[i], kBytes);
+  }
+  // About 1500 samples, so the estimate is within a few percent.
+  const double expected = static_cast<double>(kNumAllocations) * kBytes;
+  EXPECT_NEAR(timeline.live_bytes() / expected, 1.0, 0.15);
+  EXPECT_LT(timeline.Events().size(), kNumAllocations / 10);
+}
+
+TEST(MemoryTimelineTest, DetectsGrowingLongLivedAllocations) {
+  MemoryTimeline::Options options = SampleEverything();
+  options.leak_checkpoints = 3;
+  options.leak_min_growth_bytes = 2048;
+  MemoryTimelineAllocator allocator(cpu_allocator(), false, options);
+  MemoryTimeline* timeline = allocator.timeline();
+  std::vector<void*> leaked;
+  void* steady = nullptr;
+  {
+    ScopedMemoryDebugAnnotation annotation("steady");
+    steady = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1 << 20);
+  }
+  for (int step = 0; step < 6; ++step) {
+    {
+      ScopedMemoryDebugAnnotation annotation("leaky", step);
+      leaked.push_back(
+          allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1024));
+    }
+    {
+      ScopedMemoryDebugAnnotation annotation("transient", step);
+      allocator.DeallocateRaw(
+          allocator.AllocateRaw(Allocator::kAllocatorAlignment, 4096));
+    }
+    timeline->Checkpoint();
+    // The first allocation is long-lived at the second checkpoint, and the
+    // growth is checked over four checkpoints.
+    if (step < 4) {
+      EXPECT_TRUE(timeline->LeakSuspects().empty()) << step;
+    }
+  }
+
+  const std::vector<MemoryLeakSuspect> suspects = timeline->LeakSuspects();
+  ASSERT_EQ(suspects.size(), 1);
+  EXPECT_EQ(suspects[0].op_name, "leaky");
+  EXPECT_EQ(suspects[0].long_lived_bytes, 5 * 1024);
+  EXPECT_EQ(suspects[0].growth_bytes, 3 * 1024);
+  EXPECT_EQ(suspects[0].num_allocations, 5);
+
+  for (void* ptr : leaked) allocator.DeallocateRaw(ptr);
+  allocator.DeallocateRaw(steady);
+  timeline->Checkpoint();
+  EXPECT_TRUE(timeline->LeakSuspects().empty());
+}
+
+static void BM_MemoryTimelineAllocator(int iters, int sampling_interval) {
+  MemoryTimeline::Options options;
+  options.sampling_interval_bytes = sampling_interval;
+  MemoryTimelineAllocator allocator(cpu_allocator(), false, options);
+  for (int i = 0; i < iters; ++i) {
+    allocator.DeallocateRaw(
+        allocator.AllocateRaw(Allocator::kAllocatorAlignment, 4096));
+  }
+}
+BENCHMARK(BM_MemoryTimelineAllocator)->Arg(1 << 10)->Arg(1 << 20);
+
+}  // namespace
+}  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/mkl_tfconversion_pass.h"
 
+#include <map>
 #include <memory>
 #include <queue>
 #include <set>
@@ -53,6 +54,8 @@ namespace tensorflow {
 //     We will insert C such that A->C->B. (C will be the last node.)
 //
 //  Note that case 1 applies to all outputs of A that are input to B.
+//  When an output of A is input to several such nodes, they share a single
+//  conversion node, so that the layout of that output is converted once.
 //  In other words, the conversions will be required for every output
 //  of A that is input to B. For example, let us say the output of A
 //  is A1, A2, A3, of which A1 and A2 are in Mkl format, but A3 is not
@@ -107,15 +110,18 @@ class MklToTfConversionPass : public GraphOptimizationPass {
     return mkl_op_registry::IsMklElementWiseOp(op_name, T);
   }
 
-  // Insert layout conversion node on the edge pointed by 'e' from graph 'g'.
+  // Insert a single layout conversion node on the edges pointed by 'edges'
+  // from graph 'g'. All the edges must start at the same output of the same
+  // node.
   //
-  // Edge will be deleted once a call to this function is successful.
-  // Any attempt to use the edge after this call
+  // Edges will be deleted once a call to this function is successful.
+  // Any attempt to use the edges after this call
   // will lead to undefined behaviors.
   //
   // @return Success:OK() if insertion is successful, otherwise returns
   //         appropriate error status code.
-  Status InsertConversionNodeOnEdge(std::unique_ptr<Graph>* g, Edge*);
+  Status InsertConversionNodeOnEdges(std::unique_ptr<Graph>* g,
+                                     const std::vector<Edge*>& edges);
 
   // For element-wise ops, we need to sanitize the inputs. For this, we add a
   // new node at the input of the replacement element-wise node that checks
@@ -139,36 +145,41 @@ const OptimizationPassRegistry::Grouping kMklTfConvPassGroup =
 REGISTER_OPTIMIZATION(kMklTfConvPassGroup, 2, MklToTfConversionPass);
 #endif  // ENABLE_MKL
 
-Status MklToTfConversionPass::InsertConversionNodeOnEdge(
-    std::unique_ptr<Graph>* g, Edge* e) {
-  CHECK_NOTNULL(e);
+Status MklToTfConversionPass::InsertConversionNodeOnEdges(
+    std::unique_ptr<Graph>* g, const std::vector<Edge*>& edges) {
+  CHECK(!edges.empty());
 
-  Node* src = e->src();
-  Node* dst = e->dst();
+  Node* src = edges[0]->src();
+  const int src_output = edges[0]->src_output();
 
   CHECK_NOTNULL(src);
-  CHECK_NOTNULL(dst);
 
   Node* conversion_node = nullptr;
-  DataType src_datatype = src->output_type(e->src_output());
-  DataType dst_datatype = dst->input_type(e->dst_input());
+  DataType src_datatype = src->output_type(src_output);
   string data_format;
 
   // We compare source and destination datatypes only when both are found.
-  if (src_datatype != dst_datatype) {
-    string err_msg = "T attribute of " + src->name() + ":" +
-                     std::to_string(e->src_output()) + " and " + dst->name() +
-                     ":" + std::to_string(e->dst_input()) +
-                     " do not"
-                     " match. Will not insert MklToTf node in such case.";
-    return Status(error::Code::INVALID_ARGUMENT, err_msg.c_str());
+  for (const Edge* e : edges) {
+    CHECK_EQ(e->src(), src);
+    CHECK_EQ(e->src_output(), src_output);
+    Node* dst = e->dst();
+    CHECK_NOTNULL(dst);
+    DataType dst_datatype = dst->input_type(e->dst_input());
+    if (src_datatype != dst_datatype) {
+      string err_msg = "T attribute of " + src->name() + ":" +
+                       std::to_string(src_output) + " and " + dst->name() +
+                       ":" + std::to_string(e->dst_input()) +
+                       " do not"
+                       " match. Will not insert MklToTf node in such case.";
+      return Status(error::Code::INVALID_ARGUMENT, err_msg.c_str());
+    }
   }
 
   TF_CHECK_OK(
       NodeBuilder((*g)->NewName("Mkl2Tf"), "_MklToTf")
-          .Input(src, e->src_output())
+          .Input(src, src_output)
           .Input(src, DataIndexToMetaDataIndex(
-                          e->src_output(),
+                          src_output,
                           src->num_outputs()))  // Get an Mkl tensor slot
                                                 // from the Tf tensor slot.
           .Device(src->def().device())  // We want to get conversion node
@@ -193,17 +204,20 @@ Status MklToTfConversionPass::InsertConversionNodeOnEdge(
   conversion_node->AddAttr("_kernel",
                            mkl_op_registry::kMklLayoutDependentOpLabel);
 
-  // Now that we have added edge from src->conversion_node, let's add edge from
-  // output of conversion_node to the dest node. Since conversion_node
+  // Now that we have added edge from src->conversion_node, let's add edges
+  // from output of conversion_node to the dest nodes. Since conversion_node
   // has only 1 output, the src_output of conversion_node is 0.
-  CHECK_NOTNULL((*g)->AddEdge(conversion_node, 0, dst, e->dst_input()));
+  for (Edge* e : edges) {
+    Node* dst = e->dst();
+    CHECK_NOTNULL((*g)->AddEdge(conversion_node, 0, dst, e->dst_input()));
 
-  VLOG(1) << "MklToTfConversionPass: Inserting Conversion node on: "
-          << src->type_string() << " and " << dst->type_string()
-          << " successful.";
+    VLOG(1) << "MklToTfConversionPass: Inserting Conversion node on: "
+            << src->type_string() << " and " << dst->type_string()
+            << " successful.";
 
-  // Remove src->dst edge now.
-  (*g)->RemoveEdge(e);
+    // Remove src->dst edge now.
+    (*g)->RemoveEdge(e);
+  }
   return Status::OK();
 }
 
@@ -309,8 +323,10 @@ bool MklToTfConversionPass::RunPass(std::unique_ptr<Graph>* g) {
   // followed by a non-Mkl op node, we will just iterate over edge
   // set of the graph.
   // edge set whose source and destination are candidates for
-  // inserting conversion node
-  std::vector<Edge*> candidate_edges;
+  // inserting conversion node, grouped by the output they read so that
+  // each output is converted only once.
+  std::vector<std::vector<Edge*>> candidate_edges;
+  std::map<std::pair<int, int>, size_t> candidate_index;
 
   for (const Edge* e : (*g)->edges()) {
     Node* src = e->src();
@@ -347,19 +363,27 @@ bool MklToTfConversionPass::RunPass(std::unique_ptr<Graph>* g) {
     if (src_is_mkl_op && !dst_is_mkl_op) {
       VLOG(1) << "MklToTfConversionPass: Scheduled nodes " << src->name()
               << " and " << dst->name() << " for inserting conversion nodes";
-      candidate_edges.push_back(const_cast<Edge*>(e));
+      auto it = candidate_index
+                    .emplace(std::make_pair(src->id(), e->src_output()),
+                             candidate_edges.size())
+                    .first;
+      if (it->second == candidate_edges.size()) {
+        candidate_edges.emplace_back();
+      }
+      candidate_edges[it->second].push_back(const_cast<Edge*>(e));
     }
   }
 
   // Process all candidate edges and insert conversion nodes on them.
-  for (Edge* e : candidate_edges) {
+  for (const std::vector<Edge*>& edges : candidate_edges) {
     // Even if we insert conversion node on a single edge, we
     // need to return true.
-    string src_name = e->src()->name();
-    string dst_name = e->dst()->name();
-    if (InsertConversionNodeOnEdge(g, e) == Status::OK()) {
+    string src_name = edges[0]->src()->name();
+    const size_t num_edges = edges.size();
+    if (InsertConversionNodeOnEdges(g, edges) == Status::OK()) {
       VLOG(1) << "MklToTfConversionPass: Inserted conversion "
-              << "node on edge between " << src_name << " and " << dst_name;
+              << "node on " << num_edges << " output edge(s) of "
+              << src_name;
       result = true;
     }
   }
@@ -0,0 +1,164 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/optimized_graph_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/validate.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/optimized_graph_cache.pb.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the version of TensorFlow recorded in the entries it writes.
+string Version() {
+  return strings::StrCat(TF_VERSION_STRING, "/", TF_GRAPH_DEF_VERSION);
+}
+
+// Appends `value` to `out`, prefixed with its length so that the
+// concatenation of several values is unambiguous.
+void AppendField(StringPiece value, string* out) {
+  strings::StrAppend(out, value.size(), ":", value);
+}
+
+void AppendProto(const protobuf::MessageLite& proto, string* out) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AppendField(serialized, out);
+}
+
+}  // namespace
+
+OptimizedGraphCache::OptimizedGraphCache(Env* env, const string& directory)
+    : env_(env), directory_(directory) {}
+
+string OptimizedGraphCache::Key(const grappler::GrapplerItem& item,
+                                const DeviceSet& devices,
+                                const ConfigProto& config) {
+  string key_input;
+  AppendProto(item.graph, &key_input);
+  AppendField(strings::StrCat(item.fetch.size()), &key_input);
+  for (const string& fetch : item.fetch) {
+    AppendField(fetch, &key_input);
+  }
+  AppendField(strings::StrCat(item.feed.size()), &key_input);
+  for (const auto& feed : item.feed) {
+    AppendField(feed.first, &key_input);
+    AppendField(strings::StrCat(feed.second.dtype(), ",",
+                                feed.second.shape().DebugString()),
+                &key_input);
+  }
+
+  // The incarnations of the devices change in every process, so only the
+  // attributes that the optimizers may look at are part of the key.
+  std::vector<const Device*> sorted_devices(devices.devices().begin(),
+                                            devices.devices().end());
+  std::sort(sorted_devices.begin(), sorted_devices.end(),
+            [](const Device* a, const Device* b) {
+              return a->name() < b->name();
+            });
+  AppendField(strings::StrCat(sorted_devices.size()), &key_input);
+  for (const Device* device : sorted_devices) {
+    const DeviceAttributes& attributes = device->attributes();
+    AppendField(attributes.name(), &key_input);
+    AppendField(attributes.device_type(), &key_input);
+    AppendField(strings::StrCat(attributes.memory_limit()), &key_input);
+    AppendProto(attributes.locality(), &key_input);
+    AppendField(attributes.physical_device_desc(), &key_input);
+  }
+
+  // Where the cache is kept does not change the optimized graph.
+  ConfigProto key_config = config;
+  key_config.mutable_experimental()->clear_optimized_graph_cache_dir();
+  AppendProto(key_config, &key_input);
+
+  const Fprint128 fingerprint = Fingerprint128(key_input);
+  return strings::StrCat(strings::Hex(fingerprint.high64, strings::kZeroPad16),
+                         strings::Hex(fingerprint.low64, strings::kZeroPad16));
+}
+
+string OptimizedGraphCache::EntryPath(const string& key) const {
+  return io::JoinPath(directory_, strings::StrCat(key, ".pb"));
+}
+
+bool OptimizedGraphCache::Lookup(const string& key, GraphDef* graph) const {
+  const string path = EntryPath(key);
+  if (!env_->FileExists(path).ok()) {
+    VLOG(1) << "No optimized graph cached in " << path;
+    return false;
+  }
+  OptimizedGraphCacheEntry entry;
+  Status s = ReadBinaryProto(env_, path, &entry);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring the optimized graph cached in " << path << ": "
+                 << s;
+    return false;
+  }
+  if (entry.key() != key) {
+    LOG(WARNING) << "Ignoring the optimized graph cached in " << path
+                 << ", whose key is " << entry.key();
+    return false;
+  }
+  if (entry.tensorflow_version() != Version()) {
+    VLOG(1) << "Ignoring the optimized graph cached in " << path
+            << ", which was written by TensorFlow "
+            << entry.tensorflow_version();
+    return false;
+  }
+  const FunctionLibraryDefinition flib_def(OpRegistry::Global(),
+                                           entry.graph().library());
+  s = graph::ValidateGraphDefAgainstOpRegistry(entry.graph(), flib_def);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring the optimized graph cached in " << path << ": "
+                 << s;
+    return false;
+  }
+  VLOG(1) << "Read the optimized graph cached in " << path;
+  graph->Swap(entry.mutable_graph());
+  return true;
+}
+
+Status OptimizedGraphCache::Insert(const string& key,
+                                   const GraphDef& graph) const {
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+  OptimizedGraphCacheEntry entry;
+  entry.set_key(key);
+  entry.set_tensorflow_version(Version());
+  *entry.mutable_graph() = graph;
+  const string path = EntryPath(key);
+  const string temp_path =
+      strings::StrCat(path, ".tmp", strings::Hex(random::New64()));
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env_, temp_path, entry));
+  Status s = env_->RenameFile(temp_path, path);
+  if (!s.ok()) {
+    env_->DeleteFile(temp_path).IgnoreError();
+    return s;
+  }
+  VLOG(1) << "Cached the optimized graph in " << path;
+  return Status::OK();
+}
+
+}  // namespace tensorflow
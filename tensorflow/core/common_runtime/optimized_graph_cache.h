@@ -0,0 +1,64 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_GRAPH_CACHE_H_
+
+#include <string>
+
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+
+// A cache of the graphs optimized by Grappler, kept in a directory so that
+// it outlives the process. Each entry is a file that holds an
+// `OptimizedGraphCacheEntry`, named after the fingerprint of everything that
+// the optimized graph depends on.
+//
+// Several processes may share a directory: entries are written to a
+// temporary file that is then renamed, so readers never see partial entries.
+class OptimizedGraphCache {
+ public:
+  OptimizedGraphCache(Env* env, const string& directory);
+
+  // Returns the key of the graph that Grappler optimizes from `item`, for
+  // `devices` with the session `config`.
+  static string Key(const grappler::GrapplerItem& item,
+                    const DeviceSet& devices, const ConfigProto& config);
+
+  // Reads the graph cached under `key` into `graph`. Returns false if there
+  // is no entry, or if the entry was written by another version of
+  // TensorFlow or does not validate against the registered ops.
+  bool Lookup(const string& key, GraphDef* graph) const;
+
+  // Caches `graph` under `key`, replacing any existing entry.
+  Status Insert(const string& key, const GraphDef& graph) const;
+
+ private:
+  string EntryPath(const string& key) const;
+
+  Env* const env_;
+  const string directory_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(OptimizedGraphCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_GRAPH_CACHE_H_
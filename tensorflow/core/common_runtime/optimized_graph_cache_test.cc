@@ -0,0 +1,127 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/optimized_graph_cache.h"
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/optimized_graph_cache.pb.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+class OptimizedGraphCacheTest : public ::testing::Test {
+ protected:
+  OptimizedGraphCacheTest()
+      : device_(DeviceFactory::NewDevice("CPU", {},
+                                         "/job:localhost/replica:0/task:0")),
+        directory_(io::JoinPath(
+            testing::TmpDir(), "optimized_graph_cache",
+            ::testing::UnitTest::GetInstance()->current_test_info()->name())),
+        cache_(Env::Default(), directory_) {
+    devices_.AddDevice(device_.get());
+    NodeDef* node = item_.graph.add_node();
+    node->set_name("x");
+    node->set_op("NoOp");
+    item_.fetch.push_back("x");
+  }
+
+  string Key() const {
+    return OptimizedGraphCache::Key(item_, devices_, config_);
+  }
+
+  std::unique_ptr<Device> device_;
+  DeviceSet devices_;
+  grappler::GrapplerItem item_;
+  ConfigProto config_;
+  const string directory_;
+  OptimizedGraphCache cache_;
+};
+
+TEST_F(OptimizedGraphCacheTest, Key) {
+  const string key = Key();
+  EXPECT_EQ(key, Key());
+
+  // Where the cache is does not matter.
+  config_.mutable_experimental()->set_optimized_graph_cache_dir("/tmp/other");
+  EXPECT_EQ(key, Key());
+
+  config_.mutable_graph_options()->set_infer_shapes(true);
+  const string config_key = Key();
+  EXPECT_NE(key, config_key);
+
+  item_.fetch.push_back("y");
+  EXPECT_NE(config_key, Key());
+
+  DeviceSet no_devices;
+  EXPECT_NE(OptimizedGraphCache::Key(item_, devices_, config_),
+            OptimizedGraphCache::Key(item_, no_devices, config_));
+}
+
+TEST_F(OptimizedGraphCacheTest, InsertAndLookup) {
+  const string key = Key();
+  GraphDef graph;
+  EXPECT_FALSE(cache_.Lookup(key, &graph));
+
+  TF_ASSERT_OK(cache_.Insert(key, item_.graph));
+  ASSERT_TRUE(cache_.Lookup(key, &graph));
+  ASSERT_EQ(1, graph.node_size());
+  EXPECT_EQ("x", graph.node(0).name());
+
+  // Replaces the entry.
+  item_.graph.mutable_node(0)->set_name("y");
+  TF_ASSERT_OK(cache_.Insert(key, item_.graph));
+  ASSERT_TRUE(cache_.Lookup(key, &graph));
+  EXPECT_EQ("y", graph.node(0).name());
+}
+
+TEST_F(OptimizedGraphCacheTest, IgnoresStaleEntries) {
+  const string key = Key();
+  TF_ASSERT_OK(cache_.Insert(key, item_.graph));
+  const string path = io::JoinPath(directory_, key + ".pb");
+  OptimizedGraphCacheEntry entry;
+  TF_ASSERT_OK(ReadBinaryProto(Env::Default(), path, &entry));
+
+  GraphDef graph;
+  OptimizedGraphCacheEntry other_version = entry;
+  other_version.set_tensorflow_version("0.0.0/0");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), path, other_version));
+  EXPECT_FALSE(cache_.Lookup(key, &graph));
+
+  OptimizedGraphCacheEntry other_key = entry;
+  other_key.set_key("0");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), path, other_key));
+  EXPECT_FALSE(cache_.Lookup(key, &graph));
+
+  OptimizedGraphCacheEntry unknown_op = entry;
+  unknown_op.mutable_graph()->mutable_node(0)->set_op("NoSuchOp");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), path, unknown_op));
+  EXPECT_FALSE(cache_.Lookup(key, &graph));
+
+  TF_ASSERT_OK(
+      WriteStringToFile(Env::Default(), path, "not an optimized graph"));
+  EXPECT_FALSE(cache_.Lookup(key, &graph));
+
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), path, entry));
+  EXPECT_TRUE(cache_.Lookup(key, &graph));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/base/call_once.h"
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/common_runtime/memory_timeline.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/log_memory.h"
@@ -122,6 +123,8 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
       // at the cost of performance.
       allocator = new TrackingAllocator(allocator, true);
     }
+    allocator =
+        MemoryTimelineAllocator::MaybeWrap(allocator, /*owns_allocator=*/false);
     cpu_allocators_.push_back(allocator);
     if (cpu_allocators_.size() < cpu_allocators_cache_.max_size()) {
       cpu_allocators_cache_[cpu_allocators_.size() - 1] = allocator;
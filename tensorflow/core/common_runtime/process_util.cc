@@ -22,10 +22,15 @@ limitations under the License.
 #endif  // INTEL_MKL
 #include <string.h>
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
@@ -90,6 +95,34 @@ thread::ThreadPool* ComputePool(const SessionOptions& options) {
   return compute_pool;
 }
 
+thread::ThreadPool* NumaComputePool(const SessionOptions& options,
+                                    int numa_node) {
+  static mutex* mu = new mutex;
+  static std::vector<thread::ThreadPool*>* pools =
+      new std::vector<thread::ThreadPool*>;
+  DCHECK_GE(numa_node, 0);
+  mutex_lock l(*mu);
+  if (numa_node >= static_cast<int>(pools->size())) {
+    pools->resize(numa_node + 1, nullptr);
+  }
+  thread::ThreadPool*& pool = (*pools)[numa_node];
+  if (pool == nullptr) {
+    int32 num_threads = options.config.inter_op_parallelism_threads();
+    if (num_threads <= 0) num_threads = GetEnvNumInterOpThreads();
+    if (num_threads <= 0) num_threads = port::MaxParallelism(numa_node);
+    ThreadOptions thread_opts;
+    thread_opts.numa_node = numa_node;
+    VLOG(1) << "NUMA node " << numa_node
+            << " inter op parallelism threads: " << num_threads;
+    pool = new thread::ThreadPool(
+        options.env, thread_opts,
+        strings::StrCat("numa_", numa_node, "_Compute"), num_threads,
+        !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr);
+  }
+  return pool;
+}
+
 int32 NumInterOpThreadsFromEnvironment() {
   int32 num;
   const char* val = std::getenv("TF_NUM_INTEROP_THREADS");
@@ -30,6 +30,14 @@ namespace tensorflow {
 // using 'options'.  Caller does not take ownership over threadpool.
 thread::ThreadPool* ComputePool(const SessionOptions& options);
 
+// Returns a process-wide ThreadPool for scheduling the compute operations of
+// devices on `numa_node`, whose threads are bound to that node.  The pool is
+// created on first use with the number of threads in `options`, or by default
+// the parallelism available on `numa_node`.  Caller does not take ownership
+// over threadpool.
+thread::ThreadPool* NumaComputePool(const SessionOptions& options,
+                                    int numa_node);
+
 // Returns the TF_NUM_INTEROP_THREADS environment value, or 0 if not specified.
 int32 NumInterOpThreadsFromEnvironment();
 
@@ -34,5 +34,19 @@ TEST(ProcessUtilTest, ThreadPool) {
   delete pool;
 }
 
+TEST(ProcessUtilTest, NumaComputePool) {
+  SessionOptions opts;
+  opts.config.set_inter_op_parallelism_threads(3);
+
+  thread::ThreadPool* pool = NumaComputePool(opts, 0);
+  EXPECT_EQ(3, pool->NumThreads());
+  // The pool of each node is created once.
+  opts.config.set_inter_op_parallelism_threads(5);
+  EXPECT_EQ(pool, NumaComputePool(opts, 0));
+  thread::ThreadPool* pool1 = NumaComputePool(opts, 1);
+  EXPECT_NE(pool, pool1);
+  EXPECT_EQ(5, pool1->NumThreads());
+}
+
 }  // anonymous namespace
 }  // namespace tensorflow
@@ -115,6 +115,13 @@ class RenamedDevice : public Device {
                                                    tensor);
   }
 
+  Status MakeTensorFromHostTensor(const Tensor& host_tensor,
+                                  const AllocatorAttributes alloc_attrs,
+                                  Tensor* tensor) override {
+    return underlying_device_->MakeTensorFromHostTensor(host_tensor,
+                                                        alloc_attrs, tensor);
+  }
+
   void CopyTensorInSameDevice(const Tensor* input_tensor, Tensor* output_tensor,
                               const DeviceContext* device_context,
                               StatusCallback done) override {
@@ -143,6 +150,12 @@ class RenamedDevice : public Device {
     return underlying_device_->TryGetDeviceContext(out_context);
   }
 
+  Status FillContextMap(
+      const Graph* graph,
+      std::vector<DeviceContext*>* device_context_map) override {
+    return underlying_device_->FillContextMap(graph, device_context_map);
+  }
+
   // Returns the resource manager associated w/ this device.
   ResourceMgr* resource_manager() override {
     if (isolate_session_state_) {
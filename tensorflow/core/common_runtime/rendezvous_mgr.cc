@@ -106,10 +106,16 @@ void SameWorkerRecvDone(const DeviceMgr* device_mgr,
     }
   }
 
+  // Copies from one device to different peers go out on different
+  // device-to-device streams, so that they can use separate links and copy
+  // engines, while copies over the same link are serialized on one stream
+  // instead of contending for it.
+  const int dev_to_dev_stream_index =
+      dst_device->parsed_name().has_id ? dst_device->parsed_name().id : 0;
   CopyTensor::ViaDMA(
       parsed.edge_name, send_args.device_context, recv_args.device_context,
       src_device, dst_device, send_args.alloc_attrs, recv_args.alloc_attrs, &in,
-      out, 0 /*dev_to_dev_stream_index*/, std::move(done), sync_dst_compute);
+      out, dev_to_dev_stream_index, std::move(done), sync_dst_compute);
 }
 
 void IntraProcessRecvAsyncImpl(const DeviceMgr* device_mgr,
@@ -42,6 +42,13 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 
 namespace tensorflow {
+namespace {
+// Reductions of chunks on devices without a GPU stream run synchronously in
+// the thread that drives the ring. Chunks of at least this size are instead
+// reduced on another thread, so that the transfers of the other fields can be
+// dispatched while the reduction runs.
+constexpr int64 kMinAsyncReduceBytes = 64 * 1024;
+}  // namespace
 
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
 
@@ -212,6 +219,9 @@ bool RingReducer::RunAsyncParts() {
   int field_done_count = 0;
   int send_pending_count = 0;
   int recv_pending_count = 0;
+  int reduce_pending_count = 0;
+  // Whether the reduction of each field was dispatched to another thread.
+  std::vector<bool> reduce_pending(rfv_.size(), false);
   std::atomic<bool> aborted(false);
 
   {
@@ -254,6 +264,26 @@ bool RingReducer::RunAsyncParts() {
             --recv_pending_count;
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
+              if (gpu_info == nullptr &&
+                  static_cast<int64>(rf->chunk.TotalBytes()) >=
+                      kMinAsyncReduceBytes) {
+                reduce_pending[rf - rfv_.data()] = true;
+                col_ctx_->col_exec->RunClosure(
+                    [this, rf, &ready_queue, &aborted]() {
+                      Status s = collective_util::ComputeBinOp(
+                          col_ctx_->op_ctx, col_ctx_->op_params,
+                          col_ctx_->device, col_params_->merge_op.get(),
+                          &rf->chunk, &rf->tmp_chunk);
+                      if (!s.ok()) {
+                        aborted = true;
+                        StartAbort(s);
+                      }
+                      ready_queue.Enqueue(rf);
+                    });
+                dispatched = true;
+                ++reduce_pending_count;
+                break;
+              }
               Status s = collective_util::ComputeBinOp(
                   col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
                   col_params_->merge_op.get(), &rf->chunk, &rf->tmp_chunk);
@@ -266,6 +296,11 @@ bool RingReducer::RunAsyncParts() {
             }
             break;
           case RF_REDUCE:
+            if (reduce_pending[rf - rfv_.data()]) {
+              CHECK_GT(reduce_pending_count, 0);
+              reduce_pending[rf - rfv_.data()] = false;
+              --reduce_pending_count;
+            }
             if (!rf->second_pass && col_params_->final_op.get() &&
                 rf->is_final) {
               rf->action = RF_FINALIZE;
@@ -325,12 +360,19 @@ bool RingReducer::RunAsyncParts() {
     if (aborted) {
       // All of the pending data actions should be aborted; field the
       // callbacks and clear the queue before quitting.
-      while ((send_pending_count > 0) || (recv_pending_count > 0)) {
+      while ((send_pending_count > 0) || (recv_pending_count > 0) ||
+             (reduce_pending_count > 0)) {
         RingField* rf = ready_queue.Dequeue();
         switch (rf->action) {
           case RF_RECV:
             --recv_pending_count;
             break;
+          case RF_REDUCE:
+            if (reduce_pending[rf - rfv_.data()]) {
+              reduce_pending[rf - rfv_.data()] = false;
+              --reduce_pending_count;
+            }
+            break;
           case RF_SEND:
             --send_pending_count;
             break;
@@ -343,6 +385,7 @@ bool RingReducer::RunAsyncParts() {
 
   CHECK_EQ(send_pending_count, 0);
   CHECK_EQ(recv_pending_count, 0);
+  CHECK_EQ(reduce_pending_count, 0);
 
   VLOG(2) << this << " device=" << col_ctx_->device_name << " finish;"
           << " final value " << TensorDebugString(ca_->Value());
@@ -0,0 +1,289 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/ring_sparse_reducer.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace {
+
+// Parts of a block, each sent as a separate tensor.
+enum BlockPart { kHeader = 0, kIndices = 1, kValues = 2 };
+
+// Value of the header for blocks that hold the whole tensor.
+constexpr int64 kDenseBlock = -1;
+
+template <typename T>
+Status AddBlock(const Tensor& header, const Tensor& indices,
+                const Tensor& values, Tensor* output) {
+  const int64 num_rows = header.flat<int64>()(0);
+  if (num_rows == kDenseBlock) {
+    output->flat<T>() += values.flat<T>();
+    return Status::OK();
+  }
+  if (num_rows == 0) return Status::OK();
+  auto out = output->flat_outer_dims<T>();
+  auto in = values.flat_outer_dims<T>();
+  auto idx = indices.flat<int64>();
+  for (int64 i = 0; i < num_rows; ++i) {
+    const int64 row = idx(i);
+    if (row < 0 || row >= out.dimension(0)) {
+      return errors::Internal("RingSparseReducer received row ", row,
+                              " of a tensor with ", out.dimension(0),
+                              " rows");
+    }
+    out.template chip<0>(row) += in.template chip<0>(i);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+bool RingSparseReducer::IsSupportedType(DataType dtype) {
+  switch (dtype) {
+    case DT_HALF:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+    case DT_INT32:
+    case DT_INT64:
+      return true;
+    default:
+      return false;
+  }
+}
+
+Status RingSparseReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = &col_ctx->col_params;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+Allocator* RingSparseReducer::allocator() const {
+  return col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0));
+}
+
+// Note that this function is blocking and must not run in any thread
+// which cannot be blocked.
+void RingSparseReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this doesn't require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  const int group_size = col_params_->group.group_size;
+  const int rank = col_params_->default_rank;
+  if (!IsSupportedType(col_ctx_->output->dtype())) {
+    done(errors::Internal("RingSparseReducer does not support ",
+                          DataTypeString(col_ctx_->output->dtype())));
+    return;
+  }
+
+  // blocks[r] is the contribution of the device of rank r. Each step sends
+  // the block received in the previous step.
+  std::vector<Block> blocks(group_size);
+  Encode(*col_ctx_->input, &blocks[rank]);
+  Status status;
+  for (int step = 0; step < group_size - 1 && status.ok(); ++step) {
+    const int send_rank = (rank - step + group_size) % group_size;
+    const int recv_rank = (rank - step - 1 + group_size) % group_size;
+    status = Exchange(step, send_rank, blocks[send_rank], recv_rank,
+                      &blocks[recv_rank]);
+  }
+  if (status.ok()) status = Accumulate(blocks);
+  if (status.ok() && col_params_->final_op) {
+    std::unique_ptr<CollectiveAdapter> ca(
+        MakeCollectiveAdapter(col_ctx_->output, 1, allocator()));
+    Tensor group_size_val = ca->Scalar(group_size);
+    status = collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op.get(), col_ctx_->output, &group_size_val);
+  }
+  done(status);
+}
+
+void RingSparseReducer::Encode(const Tensor& input, Block* block) {
+  block->header = Tensor(allocator(), DT_INT64, TensorShape({1}));
+  const int64 total_bytes = input.TotalBytes();
+  const int64 num_rows = input.dims() > 0 ? input.dim_size(0) : 0;
+  const int64 row_bytes = num_rows > 0 ? total_bytes / num_rows : 0;
+  const char* data = input.tensor_data().data();
+  std::vector<int64> nonzero;
+  for (int64 r = 0; r < num_rows; ++r) {
+    const char* row = data + r * row_bytes;
+    if (std::any_of(row, row + row_bytes, [](char c) { return c != 0; })) {
+      nonzero.push_back(r);
+    }
+  }
+  const int64 sparse_bytes =
+      static_cast<int64>(nonzero.size()) * (row_bytes + sizeof(int64));
+  if (num_rows == 0 || sparse_bytes >= total_bytes) {
+    block->header.flat<int64>()(0) = kDenseBlock;
+    block->values = Tensor(allocator(), input.dtype(), input.shape());
+    memcpy(const_cast<char*>(block->values.tensor_data().data()), data,
+           total_bytes);
+    return;
+  }
+  const int64 n = nonzero.size();
+  block->header.flat<int64>()(0) = n;
+  TensorShape values_shape = input.shape();
+  values_shape.set_dim(0, n);
+  block->indices = Tensor(allocator(), DT_INT64, TensorShape({n}));
+  block->values = Tensor(allocator(), input.dtype(), values_shape);
+  char* values = const_cast<char*>(block->values.tensor_data().data());
+  for (int64 i = 0; i < n; ++i) {
+    block->indices.flat<int64>()(i) = nonzero[i];
+    memcpy(values + i * row_bytes, data + nonzero[i] * row_bytes, row_bytes);
+  }
+}
+
+Status RingSparseReducer::Exchange(int step, int send_rank,
+                                   const Block& to_send, int recv_rank,
+                                   Block* received) {
+  mutex mu;
+  Status send_status;
+  int num_pending = 0;
+  Notification sends_done;
+  auto send_done = [&mu, &send_status, &num_pending,
+                    &sends_done](const Status& s) {
+    mutex_lock l(mu);
+    send_status.Update(s);
+    if (--num_pending == 0) sends_done.Notify();
+  };
+  const int64 num_send_rows = to_send.header.flat<int64>()(0);
+  std::vector<std::pair<int, const Tensor*>> parts = {
+      {kHeader, &to_send.header}};
+  if (num_send_rows > 0) parts.push_back({kIndices, &to_send.indices});
+  if (num_send_rows != 0) parts.push_back({kValues, &to_send.values});
+  num_pending = parts.size();
+  for (const auto& part : parts) {
+    Send(step, part.first, send_rank, part.second, send_done);
+  }
+
+  received->header = Tensor(allocator(), DT_INT64, TensorShape({1}));
+  Status s = Recv(step, kHeader, recv_rank, &received->header);
+  if (s.ok()) {
+    const Tensor& output = *col_ctx_->output;
+    const int64 n = received->header.flat<int64>()(0);
+    const int64 max_rows = output.dims() > 0 ? output.dim_size(0) : 0;
+    if (n == kDenseBlock) {
+      received->values = Tensor(allocator(), output.dtype(), output.shape());
+      s = Recv(step, kValues, recv_rank, &received->values);
+    } else if (n < 0 || n > max_rows) {
+      s = errors::Internal("RingSparseReducer received a block of ", n,
+                           " rows for a tensor of shape ",
+                           output.shape().DebugString());
+    } else if (n > 0) {
+      TensorShape values_shape = output.shape();
+      values_shape.set_dim(0, n);
+      received->indices = Tensor(allocator(), DT_INT64, TensorShape({n}));
+      received->values = Tensor(allocator(), output.dtype(), values_shape);
+      s = Recv(step, kIndices, recv_rank, &received->indices);
+      if (s.ok()) s = Recv(step, kValues, recv_rank, &received->values);
+    }
+  }
+  // Pending sends, and the receives of the other devices, only complete once
+  // the collective is aborted.
+  if (!s.ok()) col_ctx_->col_exec->StartAbort(s);
+  sends_done.WaitForNotification();
+  s.Update(send_status);
+  return s;
+}
+
+void RingSparseReducer::Send(int step, int part, int rank,
+                             const Tensor* tensor, const StatusCallback& done) {
+  const int send_to = (col_params_->default_rank + 1) %
+                      col_params_->group.group_size;
+  col_ctx_->col_exec->PostToPeer(
+      col_params_->instance.device_names[send_to],
+      col_params_->instance.task_names[send_to],
+      strings::StrCat("RingSparseReduce:", col_ctx_->exec_key, ":", step, ":",
+                      part, ":", rank),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), tensor,
+      col_ctx_->device_locality, done);
+}
+
+Status RingSparseReducer::Recv(int step, int part, int rank, Tensor* tensor) {
+  const int group_size = col_params_->group.group_size;
+  const int recv_from = (col_params_->default_rank + group_size - 1) %
+                        group_size;
+  Notification note;
+  Status status;
+  col_ctx_->col_exec->RecvFromPeer(
+      col_params_->instance.device_names[recv_from],
+      col_params_->instance.task_names[recv_from],
+      col_params_->task.is_local[recv_from],
+      strings::StrCat("RingSparseReduce:", col_ctx_->exec_key, ":", step, ":",
+                      part, ":", rank),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), tensor,
+      col_ctx_->device_locality, 0 /*stream_index*/,
+      [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status RingSparseReducer::Accumulate(const std::vector<Block>& blocks) {
+  Tensor* output = col_ctx_->output;
+  memset(const_cast<char*>(output->tensor_data().data()), 0,
+         output->TotalBytes());
+  for (const Block& block : blocks) {
+    Status s;
+    switch (output->dtype()) {
+#define HANDLE_TYPE(T)                                                    \
+  case DataTypeToEnum<T>::value:                                          \
+    s = AddBlock<T>(block.header, block.indices, block.values, output); \
+    break;
+      HANDLE_TYPE(Eigen::half);
+      HANDLE_TYPE(float);
+      HANDLE_TYPE(double);
+      HANDLE_TYPE(int32);
+      HANDLE_TYPE(int64);
+#undef HANDLE_TYPE
+      default:
+        s = errors::Internal("RingSparseReducer does not support ",
+                             DataTypeString(output->dtype()));
+    }
+    TF_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
+namespace {
+REGISTER_COLLECTIVE(RingSparseReduce, RingSparseReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,92 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RING_SPARSE_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_RING_SPARSE_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+class Device;
+
+// Sum all-reduce of tensors whose rows along the first dimension are mostly
+// zero, e.g. the gradients of embedding lookups.
+//
+// Each device encodes its input as the indices and values of its nonzero
+// rows, or sends it whole if that is not smaller, and the blocks of all
+// devices are passed around the ring in `group_size - 1` steps. Every device
+// then adds the blocks in rank order, so that all devices compute the same
+// sum. The encoding is lossless and chosen independently for each block.
+//
+// Only supports CPU devices and the Add merge op, see
+// CollectiveParamResolverLocal::AssignCollectiveType.
+class RingSparseReducer : public CollectiveImplementationInterface {
+ public:
+  RingSparseReducer() = default;
+  ~RingSparseReducer() override = default;
+
+  // Returns true if `dtype` can be reduced by this implementation.
+  static bool IsSupportedType(DataType dtype);
+
+  void Run(StatusCallback done) override;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override {
+    return Status::OK();
+  }
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+ private:
+  // The contribution of one device. `header` holds the number of rows in
+  // `indices` and `values`, or -1 if `values` is the whole tensor.
+  struct Block {
+    Tensor header;
+    Tensor indices;
+    Tensor values;
+  };
+
+  void Encode(const Tensor& input, Block* block);
+
+  // Sends `to_send` to the next device in the ring while receiving the block
+  // of the previous device into `received`.
+  Status Exchange(int step, int send_rank, const Block& to_send,
+                  int recv_rank, Block* received);
+
+  void Send(int step, int part, int rank, const Tensor* tensor,
+            const StatusCallback& done);
+  Status Recv(int step, int part, int rank, Tensor* tensor);
+
+  Status Accumulate(const std::vector<Block>& blocks);
+
+  Allocator* allocator() const;
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_ = nullptr;  // Not owned
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_RING_SPARSE_REDUCER_H_
@@ -0,0 +1,234 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/ring_sparse_reducer.h"
+
+#include <atomic>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/unbounded_work_queue.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+static int64 kStepId = 123;
+
+std::unique_ptr<OpKernel> GetDiv(DataType dtype, Device* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder("div_node", "Div")
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class RingSparseReducerTest : public ::testing::Test {
+ protected:
+  ~RingSparseReducerTest() override {
+    if (col_exec_) col_exec_->Unref();
+  }
+
+  void Init(int num_workers, int num_devices_per_worker) {
+    std::vector<std::unique_ptr<Device>> local_devices;
+    SessionOptions sess_opts;
+    sess_opts.env = Env::Default();
+    for (int wi = 0; wi < num_workers; ++wi) {
+      for (int di = 0; di < num_devices_per_worker; ++di) {
+        string task_name = strings::StrCat("/job:worker/replica:0/task:", wi);
+        string dev_name = strings::StrCat(task_name, "/device:CPU:", di);
+        local_devices.push_back(absl::make_unique<ThreadPoolDevice>(
+            sess_opts, dev_name, Bytes(4 << 20), DeviceLocality(),
+            cpu_allocator()));
+        col_params_.instance.device_names.push_back(dev_name);
+        col_params_.instance.task_names.push_back(task_name);
+        col_params_.task.is_local.push_back(true);
+      }
+    }
+    dev_mgr_ = absl::make_unique<StaticDeviceMgr>(std::move(local_devices));
+    dev_resolver_ = absl::make_unique<DeviceResolverLocal>(dev_mgr_.get());
+    work_queue_ = std::make_shared<UnboundedWorkQueue>(Env::Default(), "test");
+    rma_ = new CollectiveRemoteAccessLocal(dev_mgr_.get(), dev_resolver_.get(),
+                                           work_queue_, kStepId);
+    col_exec_ = new BaseCollectiveExecutor(&col_exec_mgr_, rma_, kStepId,
+                                           dev_mgr_.get(), &gpu_ring_order_);
+    col_params_.name = "test_collective";
+    col_params_.instance.instance_key = 17;
+    col_params_.instance.type = REDUCTION_COLLECTIVE;
+    col_params_.group.device_type = DEVICE_CPU;
+    col_params_.group.group_size = num_workers * num_devices_per_worker;
+    col_params_.instance.impl_details.communication_hint = "sparse";
+  }
+
+  // Runs the reduction of `inputs`, one per device, and returns the outputs.
+  std::vector<Tensor> Reduce(const std::vector<Tensor>& inputs,
+                             bool divide) {
+    const int group_size = inputs.size();
+    std::vector<Tensor> outputs(group_size);
+    std::vector<Status> statuses(group_size);
+    std::atomic<int> num_done(0);
+    Notification all_done;
+    for (int rank = 0; rank < group_size; ++rank) {
+      SchedClosure([this, rank, divide, group_size, &inputs, &outputs,
+                    &statuses, &num_done, &all_done] {
+        statuses[rank] =
+            RunDevice(rank, divide, inputs[rank], &outputs[rank]);
+        if (++num_done == group_size) all_done.Notify();
+      });
+    }
+    all_done.WaitForNotification();
+    for (const Status& s : statuses) TF_EXPECT_OK(s);
+    return outputs;
+  }
+
+  Status RunDevice(int rank, bool divide, const Tensor& input,
+                   Tensor* output) {
+    Device* device = nullptr;
+    TF_CHECK_OK(dev_mgr_->LookupDevice(
+        col_params_.instance.device_names[rank], &device));
+    CollectiveParams col_params;
+    col_params.name = col_params_.name;
+    col_params.group = col_params_.group;
+    col_params.instance.type = col_params_.instance.type;
+    col_params.instance.data_type = input.dtype();
+    col_params.instance.instance_key = col_params_.instance.instance_key;
+    col_params.instance.device_names = col_params_.instance.device_names;
+    col_params.instance.task_names = col_params_.instance.task_names;
+    col_params.task.is_local = col_params_.task.is_local;
+    col_params.default_rank = rank;
+    if (divide) col_params.final_op = GetDiv(input.dtype(), device);
+
+    Tensor input_copy = tensor::DeepCopy(input);
+    *output = Tensor(device->GetAllocator(AllocatorAttributes()),
+                     input.dtype(), input.shape());
+    OpKernelContext::Params op_params;
+    op_params.step_id = kStepId;
+    op_params.device = device;
+    gtl::InlinedVector<TensorValue, 4> inputs;
+    inputs.push_back(TensorValue(&input_copy));
+    op_params.inputs = &inputs;
+    gtl::InlinedVector<AllocatorAttributes, 4> input_aa(
+        {AllocatorAttributes()});
+    op_params.input_alloc_attrs = &input_aa;
+    DeviceContext* dev_ctx = new DeviceContext;
+    core::ScopedUnref unref_ctx(dev_ctx);
+    op_params.op_device_context = dev_ctx;
+    AllocatorAttributes generic_alloc_attr;
+    op_params.output_attr_array = &generic_alloc_attr;
+    OpKernelContext ctx(&op_params, 1);
+
+    string exec_key =
+        strings::StrCat(col_params.instance.instance_key, ":0:0");
+    RingSparseReducer* reducer = new RingSparseReducer;
+    core::ScopedUnref unref(reducer);
+    auto col_ctx = std::make_shared<CollectiveContext>(
+        col_exec_, dev_mgr_.get(), &ctx, &op_params, col_params, exec_key,
+        kStepId, &input_copy, output);
+    TF_RETURN_IF_ERROR(reducer->InitializeCollectiveContext(col_ctx));
+    Notification note;
+    Status status;
+    reducer->Run([&note, &status](Status s) {
+      status = s;
+      note.Notify();
+    });
+    note.WaitForNotification();
+    return status;
+  }
+
+  TestCollectiveExecutorMgr col_exec_mgr_;
+  CollectiveExecutor* col_exec_ = nullptr;
+  CollectiveRemoteAccessLocal* rma_;
+  std::unique_ptr<DeviceResolverLocal> dev_resolver_;
+  std::shared_ptr<UnboundedWorkQueue> work_queue_;
+  std::unique_ptr<DeviceMgr> dev_mgr_;
+  string gpu_ring_order_;
+  CollectiveParams col_params_;
+};
+
+// Returns a [num_rows, 3] tensor whose row `r` is `r * scale` if r is in
+// `rows`, and zero otherwise.
+Tensor RowsTensor(int num_rows, const std::vector<int>& rows, float scale) {
+  Tensor t(DT_FLOAT, TensorShape({num_rows, 3}));
+  t.flat<float>().setZero();
+  for (int r : rows) {
+    for (int c = 0; c < 3; ++c) t.matrix<float>()(r, c) = r * scale + c;
+  }
+  return t;
+}
+
+TEST_F(RingSparseReducerTest, SparseInputs) {
+  Init(2, 2);
+  std::vector<Tensor> inputs = {
+      RowsTensor(100, {0, 7}, 1), RowsTensor(100, {7}, 2),
+      RowsTensor(100, {}, 3), RowsTensor(100, {99, 3, 50}, 4)};
+  Tensor expected(DT_FLOAT, TensorShape({100, 3}));
+  expected.flat<float>().setZero();
+  for (const Tensor& t : inputs) expected.flat<float>() += t.flat<float>();
+  for (const Tensor& output : Reduce(inputs, /*divide=*/false)) {
+    test::ExpectTensorEqual<float>(expected, output);
+  }
+}
+
+TEST_F(RingSparseReducerTest, MixedSparseAndDenseInputs) {
+  Init(1, 3);
+  std::vector<int> all_rows(10);
+  for (int r = 0; r < 10; ++r) all_rows[r] = r;
+  std::vector<Tensor> inputs = {RowsTensor(10, all_rows, 1),
+                                RowsTensor(10, {2}, 2),
+                                RowsTensor(10, {}, 3)};
+  Tensor expected(DT_FLOAT, TensorShape({10, 3}));
+  expected.flat<float>() = (inputs[0].flat<float>() +
+                            inputs[1].flat<float>() + inputs[2].flat<float>()) /
+                           3.0f;
+  for (const Tensor& output : Reduce(inputs, /*divide=*/true)) {
+    test::ExpectTensorNear<float>(expected, output, 1e-6);
+  }
+}
+
+TEST_F(RingSparseReducerTest, ScalarInputs) {
+  Init(1, 2);
+  std::vector<Tensor> inputs = {test::AsScalar<int64>(3),
+                                test::AsScalar<int64>(-5)};
+  for (const Tensor& output : Reduce(inputs, /*divide=*/false)) {
+    test::ExpectTensorEqual<int64>(test::AsScalar<int64>(-2), output);
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
 
@@ -139,6 +140,16 @@ Status InferShapesForFunctionSubNode(const Node* node, ShapeRefiner* refiner,
 Status ShapeRefiner::InferShapesForFunction(
     const FunctionDef* function_def, AttrSlice attributes,
     ExtendedInferenceContext* outer_context) {
+  // The graph of a function is instantiated once, so the output shapes of a
+  // call only depend on its input shapes.
+  auto cache_key = std::make_pair(
+      function_def, FunctionInputShapesKey(outer_context->get_context()));
+  auto cached = function_output_shapes_.find(cache_key);
+  if (cached != function_output_shapes_.end()) {
+    return RestoreFunctionOutputShapes(cached->second,
+                                       outer_context->get_context());
+  }
+
   const Graph* graph;
   auto it = functions_.find(function_def);
   if (it != functions_.end()) {
@@ -178,6 +189,13 @@ Status ShapeRefiner::InferShapesForFunction(
     ReverseDFS(*graph, {}, node_shape_inference_lambda);
   }
 
+  // The output handle shapes may refer to the contexts of the function nodes,
+  // so they are saved before the contexts are deleted.
+  if (inference_status.ok()) {
+    SaveFunctionOutputShapes(outer_context->get_context(),
+                             &function_output_shapes_[cache_key]);
+  }
+
   // Delete the contexts created for the functions nodes to save memory.
   for (const Node* node : function_nodes) {
     node_to_context_.erase(node);
@@ -186,6 +204,89 @@ Status ShapeRefiner::InferShapesForFunction(
   return inference_status;
 }
 
+/* static */ string ShapeRefiner::FunctionInputShapesKey(InferenceContext* c) {
+  string key;
+  absl::flat_hash_map<std::size_t, int> unknown_dims;
+  auto append_shape = [c, &key, &unknown_dims](ShapeHandle s) {
+    if (s.SameHandle(ShapeHandle())) {
+      key.append("-");
+    } else if (!c->RankKnown(s)) {
+      key.append("?");
+    } else {
+      key.append("[");
+      for (int i = 0; i < c->Rank(s); ++i) {
+        DimensionHandle d = c->Dim(s, i);
+        if (c->ValueKnown(d)) {
+          strings::StrAppend(&key, c->Value(d), ",");
+        } else {
+          const int id =
+              unknown_dims.emplace(d.Handle(), unknown_dims.size())
+                  .first->second;
+          strings::StrAppend(&key, "d", id, ",");
+        }
+      }
+      key.append("]");
+    }
+  };
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    append_shape(c->input(i));
+    const auto* handle_data = c->input_handle_shapes_and_types(i);
+    if (handle_data != nullptr) {
+      key.append("{");
+      for (const ShapeAndType& shape_and_type : *handle_data) {
+        strings::StrAppend(&key, static_cast<int>(shape_and_type.dtype), ":");
+        append_shape(shape_and_type.shape);
+      }
+      key.append("}");
+    }
+    key.append(";");
+  }
+  return key;
+}
+
+/* static */ void ShapeRefiner::SaveFunctionOutputShapes(
+    InferenceContext* c, FunctionOutputShapes* shapes) {
+  shapes->outputs.resize(c->num_outputs());
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    FunctionOutputShapes::Output& output = shapes->outputs[i];
+    output.is_set = !c->output(i).SameHandle(ShapeHandle());
+    if (output.is_set) c->ShapeHandleToProto(c->output(i), &output.shape);
+    const auto* handle_data = c->output_handle_shapes_and_types(i);
+    output.has_handle_data = handle_data != nullptr;
+    if (output.has_handle_data) {
+      for (const ShapeAndType& shape_and_type : *handle_data) {
+        output.handle_data.emplace_back(TensorShapeProto(),
+                                        shape_and_type.dtype);
+        c->ShapeHandleToProto(shape_and_type.shape,
+                              &output.handle_data.back().first);
+      }
+    }
+  }
+}
+
+/* static */ Status ShapeRefiner::RestoreFunctionOutputShapes(
+    const FunctionOutputShapes& shapes, InferenceContext* c) {
+  for (int i = 0; i < shapes.outputs.size(); ++i) {
+    const FunctionOutputShapes::Output& output = shapes.outputs[i];
+    if (output.is_set) {
+      ShapeHandle shape;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromShapeProto(output.shape, &shape));
+      c->set_output(i, shape);
+    }
+    if (output.has_handle_data) {
+      std::vector<ShapeAndType> handle_data;
+      for (const auto& shape_and_type : output.handle_data) {
+        ShapeHandle shape;
+        TF_RETURN_IF_ERROR(
+            c->MakeShapeFromShapeProto(shape_and_type.first, &shape));
+        handle_data.emplace_back(shape, shape_and_type.second);
+      }
+      c->set_output_handle_shapes_and_types(i, handle_data);
+    }
+  }
+  return Status::OK();
+}
+
 Status ShapeRefiner::AddNode(const Node* node) {
   // Create the inference context for this node with the existing input shapes.
   std::unique_ptr<InferenceContext> ic(new InferenceContext(
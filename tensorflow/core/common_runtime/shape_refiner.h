@@ -15,12 +15,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
@@ -142,7 +144,8 @@ class ShapeRefiner {
   // Without function library, function inference always yields unknown shapes.
   // With this enabled, shape inference can take more time since it descends
   // into all function calls. It doesn't do inference once for each function
-  // definition, but once for each function call.
+  // definition, but once for each function call, unless a call with the same
+  // input shapes was already inferred.
   // The function library must outlive the shape refiner.
   void set_function_library_for_shape_inference(
       const tensorflow::FunctionLibraryDefinition* lib) {
@@ -184,6 +187,29 @@ class ShapeRefiner {
                                 AttrSlice attributes,
                                 ExtendedInferenceContext* outer_context);
 
+  // The output shapes inferred for a call of a function, and the shapes and
+  // types of its output handles.
+  struct FunctionOutputShapes {
+    struct Output {
+      bool is_set = false;
+      TensorShapeProto shape;
+      bool has_handle_data = false;
+      std::vector<std::pair<TensorShapeProto, DataType>> handle_data;
+    };
+    std::vector<Output> outputs;
+  };
+
+  // Returns a key that identifies the input shapes of `c`, and the shapes of
+  // its input handles.  Unknown dimensions are numbered in order of
+  // appearance, so that the key also captures which of them are the same.
+  static string FunctionInputShapesKey(shape_inference::InferenceContext* c);
+
+  // Saves the outputs of `c` to `shapes`, or sets them from `shapes`.
+  static void SaveFunctionOutputShapes(shape_inference::InferenceContext* c,
+                                       FunctionOutputShapes* shapes);
+  static Status RestoreFunctionOutputShapes(
+      const FunctionOutputShapes& shapes, shape_inference::InferenceContext* c);
+
   // Attempts to evaluate the 'dst_idx'-th input to 'node'. If the input edge
   // value can be evaluated, 'evaluated' is set to true and the value returned
   // in 'result'. Otherwise 'evaluated' is set to false.
@@ -265,6 +291,13 @@ class ShapeRefiner {
                       hash<const FunctionDef*>>
       functions_;
 
+  // Caches the output shapes inferred for each function, keyed by
+  // FunctionInputShapesKey() of the call, so that calls of a function with
+  // the same input shapes are only inferred once.
+  absl::flat_hash_map<std::pair<const FunctionDef*, string>,
+                      FunctionOutputShapes>
+      function_output_shapes_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ShapeRefiner);
 };
 
@@ -0,0 +1,417 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/slab_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+// How often, in allocations, to look for idle memory to trim.
+constexpr int64 kTrimCheckInterval = 1024;
+}  // namespace
+
+constexpr size_t SlabAllocator::kMinAllocationSize;
+
+SlabAllocator::SlabAllocator(SubAllocator* sub_allocator, size_t total_memory,
+                             const string& name, const Options& options)
+    : sub_allocator_(sub_allocator),
+      name_(name),
+      options_(options),
+      memory_limit_(total_memory) {
+  CHECK_GE(options_.slab_size, 4 * kMinAllocationSize);
+  CHECK_EQ(options_.slab_size % kMinAllocationSize, 0);
+  // Four size classes per power of two, each a multiple of
+  // kMinAllocationSize, which bounds the internal fragmentation of any
+  // request above 1KiB by 25%.
+  const size_t max_size = std::max(memory_limit_, options_.slab_size);
+  size_t size = kMinAllocationSize;
+  while (true) {
+    class_sizes_.push_back(size);
+    if (size <= options_.slab_size / 4) ++num_slab_classes_;
+    if (size >= max_size) break;
+    const size_t step = size_t{1} << (Log2Floor64(size) - 2);
+    size += std::max(kMinAllocationSize, step);
+  }
+  classes_.resize(class_sizes_.size());
+  for (int i = 0; i < class_sizes_.size(); ++i) {
+    classes_[i].size = class_sizes_[i];
+    if (i < num_slab_classes_) {
+      classes_[i].slots_per_slab = options_.slab_size / class_sizes_[i];
+    }
+  }
+  stats_.bytes_limit = static_cast<int64>(memory_limit_);
+}
+
+SlabAllocator::~SlabAllocator() {
+  mutex_lock l(mu_);
+  for (auto& it : slabs_) {
+    sub_allocator_->Free(it.first, options_.slab_size);
+  }
+  for (SizeClass& size_class : classes_) {
+    for (const Region& region : size_class.cached_regions) {
+      sub_allocator_->Free(region.ptr, region.size);
+    }
+  }
+  for (auto& it : allocations_) {
+    if (it.second.slab == nullptr) {
+      sub_allocator_->Free(const_cast<void*>(it.first),
+                           class_sizes_[it.second.size_class]);
+    }
+  }
+}
+
+int SlabAllocator::SizeClassFor(size_t num_bytes) const {
+  return std::lower_bound(class_sizes_.begin(), class_sizes_.end(),
+                          num_bytes) -
+         class_sizes_.begin();
+}
+
+void* SlabAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
+                                 const AllocationAttributes& allocation_attr) {
+  VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  if (!allocation_attr.retry_on_failure) {
+    void* result = AllocateRawInternal(num_bytes, VLOG_IS_ON(2));
+    if (result == nullptr) {
+      static std::atomic<int32> log_counter{0};
+      int32 counter_value = log_counter.load(std::memory_order_relaxed);
+      if (counter_value < 10) {
+        log_counter.store(counter_value + 1, std::memory_order_relaxed);
+        LOG(WARNING)
+            << "Allocator (" << Name() << ") ran out of memory trying "
+            << "to allocate " << strings::HumanReadableNumBytes(num_bytes)
+            << ". The caller indicates that this is not a failure, but"
+            << " may mean that there could be performance gains if more"
+            << " memory were available.";
+      }
+    }
+    return result;
+  }
+  void* result = AllocateRawInternal(num_bytes, false);
+  if (result == nullptr) {
+    static const int64 kMaxMillisToWait = 10000;  // 10 seconds
+    result = retry_helper_.AllocateRaw(
+        [this](size_t a, size_t nb, bool v) {
+          return AllocateRawInternal(nb, v);
+        },
+        kMaxMillisToWait, unused_alignment, num_bytes);
+  }
+  return result;
+}
+
+void* SlabAllocator::AllocateRawInternal(size_t num_bytes,
+                                         bool dump_log_on_failure) {
+  if (num_bytes == 0) {
+    VLOG(2) << "tried to allocate 0 bytes";
+    return nullptr;
+  }
+  const int size_class = SizeClassFor(num_bytes);
+  mutex_lock l(mu_);
+  ++num_allocs_;
+  if (options_.idle_trim_allocations > 0 &&
+      num_allocs_ - last_trim_ >= kTrimCheckInterval) {
+    last_trim_ = num_allocs_;
+    TrimLocked(num_allocs_ - options_.idle_trim_allocations);
+  }
+
+  void* ptr = nullptr;
+  if (size_class < num_slab_classes_) {
+    ptr = AllocateFromSlab(size_class);
+  } else if (size_class < classes_.size()) {
+    ptr = AllocateRegion(size_class);
+  }
+  if (ptr == nullptr) {
+    if (dump_log_on_failure) {
+      LOG(WARNING)
+          << "Allocator (" << Name() << ") ran out of memory trying "
+          << "to allocate " << strings::HumanReadableNumBytes(num_bytes)
+          << "\nCurrent allocation summary follows.";
+      DumpMemoryLogLocked();
+    }
+    return nullptr;
+  }
+
+  SizeClass& c = classes_[size_class];
+  ++c.num_in_use;
+  AllocationInfo& info = allocations_[ptr];
+  info.requested_size = num_bytes;
+  info.size_class = size_class;
+  info.allocation_id = next_allocation_id_++;
+  requested_bytes_in_use_ += num_bytes;
+  ++stats_.num_allocs;
+  stats_.bytes_in_use += c.size;
+  stats_.peak_bytes_in_use =
+      std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+  stats_.largest_alloc_size =
+      std::max<int64>(stats_.largest_alloc_size, num_bytes);
+  return ptr;
+}
+
+void* SlabAllocator::AllocateFromSlab(int size_class) {
+  SizeClass& c = classes_[size_class];
+  Slab* slab = nullptr;
+  if (!c.partial_slabs.empty()) {
+    slab = *c.partial_slabs.begin();
+  } else {
+    if (!empty_slabs_.empty()) {
+      // Reuse the most recently emptied slab, which is the most likely to
+      // be reused again soon and the least likely to be trimmed.
+      slab = empty_slabs_.back();
+      empty_slabs_.pop_back();
+    } else {
+      char* base = static_cast<char*>(Reserve(options_.slab_size));
+      if (base == nullptr) return nullptr;
+      auto new_slab = absl::make_unique<Slab>();
+      new_slab->base = base;
+      slab = new_slab.get();
+      slabs_[base] = std::move(new_slab);
+    }
+    slab->size_class = size_class;
+    slab->num_slots = c.slots_per_slab;
+    slab->next_unused_slot = 0;
+    ++c.num_slabs;
+    c.partial_slabs.insert(slab);
+  }
+  int32 slot;
+  if (!slab->free_slots.empty()) {
+    slot = slab->free_slots.back();
+    slab->free_slots.pop_back();
+  } else {
+    slot = slab->next_unused_slot++;
+  }
+  if (slab->free_slots.empty() && slab->next_unused_slot == slab->num_slots) {
+    c.partial_slabs.erase(slab);
+  }
+  void* ptr = slab->base + slot * c.size;
+  allocations_[ptr].slab = slab;
+  return ptr;
+}
+
+void* SlabAllocator::AllocateRegion(int size_class) {
+  SizeClass& c = classes_[size_class];
+  void* ptr = nullptr;
+  if (!c.cached_regions.empty()) {
+    ptr = c.cached_regions.back().ptr;
+    c.cached_regions.pop_back();
+  } else {
+    ptr = Reserve(c.size);
+    if (ptr == nullptr) return nullptr;
+  }
+  allocations_[ptr].slab = nullptr;
+  return ptr;
+}
+
+void* SlabAllocator::Reserve(size_t num_bytes) {
+  if (stats_.bytes_reserved + num_bytes > memory_limit_) {
+    TrimLocked(num_allocs_ + 1);
+    if (stats_.bytes_reserved + num_bytes > memory_limit_) {
+      return nullptr;
+    }
+  }
+  void* ptr = sub_allocator_->Alloc(kMinAllocationSize, num_bytes);
+  if (ptr == nullptr) {
+    // The sub-allocator may be out of memory because of what we cache.
+    if (TrimLocked(num_allocs_ + 1) > 0) {
+      ptr = sub_allocator_->Alloc(kMinAllocationSize, num_bytes);
+    }
+    if (ptr == nullptr) return nullptr;
+  }
+  stats_.bytes_reserved += num_bytes;
+  stats_.peak_bytes_reserved =
+      std::max(stats_.peak_bytes_reserved, stats_.bytes_reserved);
+  return ptr;
+}
+
+void SlabAllocator::Release(void* ptr, size_t num_bytes) {
+  sub_allocator_->Free(ptr, num_bytes);
+  stats_.bytes_reserved -= num_bytes;
+}
+
+void SlabAllocator::DeallocateRaw(void* ptr) {
+  VLOG(1) << "DeallocateRaw " << Name() << " " << ptr;
+  if (ptr == nullptr) {
+    VLOG(2) << "tried to deallocate nullptr";
+    return;
+  }
+  {
+    mutex_lock l(mu_);
+    auto it = allocations_.find(ptr);
+    CHECK(it != allocations_.end())
+        << "Asked to deallocate a pointer not allocated by " << Name();
+    const AllocationInfo info = it->second;
+    allocations_.erase(it);
+    SizeClass& c = classes_[info.size_class];
+    --c.num_in_use;
+    requested_bytes_in_use_ -= info.requested_size;
+    stats_.bytes_in_use -= c.size;
+
+    Slab* slab = info.slab;
+    if (slab == nullptr) {
+      c.cached_regions.push_back({ptr, c.size, num_allocs_});
+    } else {
+      if (slab->free_slots.empty() &&
+          slab->next_unused_slot == slab->num_slots) {
+        c.partial_slabs.insert(slab);
+      }
+      slab->free_slots.push_back(
+          (static_cast<char*>(ptr) - slab->base) / c.size);
+      if (static_cast<int32>(slab->free_slots.size()) ==
+          slab->next_unused_slot) {
+        // Any size class may reuse the slab from now on.
+        c.partial_slabs.erase(slab);
+        --c.num_slabs;
+        slab->size_class = -1;
+        slab->free_slots.clear();
+        slab->idle_since = num_allocs_;
+        empty_slabs_.push_back(slab);
+      }
+    }
+  }
+  retry_helper_.NotifyDealloc();
+}
+
+size_t SlabAllocator::Trim() {
+  mutex_lock l(mu_);
+  return TrimLocked(num_allocs_ + 1);
+}
+
+size_t SlabAllocator::TrimLocked(int64 idle_before) {
+  size_t released = 0;
+  auto slab_end = std::partition(
+      empty_slabs_.begin(), empty_slabs_.end(),
+      [idle_before](const Slab* slab) {
+        return slab->idle_since >= idle_before;
+      });
+  for (auto it = slab_end; it != empty_slabs_.end(); ++it) {
+    char* base = (*it)->base;
+    Release(base, options_.slab_size);
+    slabs_.erase(base);
+    released += options_.slab_size;
+  }
+  empty_slabs_.erase(slab_end, empty_slabs_.end());
+  for (SizeClass& c : classes_) {
+    auto region_end = std::partition(
+        c.cached_regions.begin(), c.cached_regions.end(),
+        [idle_before](const Region& r) { return r.idle_since >= idle_before; });
+    for (auto it = region_end; it != c.cached_regions.end(); ++it) {
+      Release(it->ptr, it->size);
+      released += it->size;
+    }
+    c.cached_regions.erase(region_end, c.cached_regions.end());
+  }
+  if (released > 0) {
+    VLOG(1) << "Trimmed " << strings::HumanReadableNumBytes(released)
+            << " from " << Name();
+  }
+  return released;
+}
+
+size_t SlabAllocator::RequestedSize(const void* ptr) const {
+  mutex_lock l(mu_);
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end())
+      << "Asked for requested size of pointer we never allocated: " << ptr;
+  return it->second.requested_size;
+}
+
+size_t SlabAllocator::AllocatedSize(const void* ptr) const {
+  mutex_lock l(mu_);
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end())
+      << "Asked for allocated size of pointer we never allocated: " << ptr;
+  return class_sizes_[it->second.size_class];
+}
+
+int64 SlabAllocator::AllocationId(const void* ptr) const {
+  mutex_lock l(mu_);
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end())
+      << "Asked for allocation id of pointer we never allocated: " << ptr;
+  return it->second.allocation_id;
+}
+
+absl::optional<AllocatorStats> SlabAllocator::GetStats() {
+  mutex_lock l(mu_);
+  AllocatorStats stats = stats_;
+  int64 largest_free_block = empty_slabs_.empty() ? 0 : options_.slab_size;
+  for (const SizeClass& c : classes_) {
+    if (!c.cached_regions.empty()) {
+      largest_free_block = std::max<int64>(largest_free_block, c.size);
+    }
+  }
+  stats.largest_free_block_bytes = largest_free_block;
+  return stats;
+}
+
+void SlabAllocator::ClearStats() {
+  mutex_lock l(mu_);
+  stats_.num_allocs = 0;
+  stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  stats_.largest_alloc_size = 0;
+}
+
+void SlabAllocator::DumpMemoryLog() {
+  mutex_lock l(mu_);
+  DumpMemoryLogLocked();
+}
+
+void SlabAllocator::DumpMemoryLogLocked() {
+  int64 cached_bytes = empty_slabs_.size() * options_.slab_size;
+  for (int i = 0; i < classes_.size(); ++i) {
+    const SizeClass& c = classes_[i];
+    const int64 cached = c.cached_regions.size() * c.size;
+    cached_bytes += cached;
+    if (c.num_in_use == 0 && c.num_slabs == 0 && cached == 0) continue;
+    if (i < num_slab_classes_) {
+      LOG(INFO) << "Size class " << strings::HumanReadableNumBytes(c.size)
+                << ": " << c.num_slabs << " slabs, " << c.num_in_use << " of "
+                << c.num_slabs * c.slots_per_slab << " slots in use, "
+                << c.partial_slabs.size() << " partially used slabs.";
+    } else {
+      LOG(INFO) << "Size class " << strings::HumanReadableNumBytes(c.size)
+                << ": " << c.num_in_use << " regions in use, "
+                << c.cached_regions.size() << " cached.";
+    }
+  }
+  LOG(INFO) << "Empty slabs: " << empty_slabs_.size();
+  LOG(INFO) << "Bytes reserved: "
+            << strings::HumanReadableNumBytes(stats_.bytes_reserved)
+            << ", in use: "
+            << strings::HumanReadableNumBytes(stats_.bytes_in_use)
+            << ", requested: "
+            << strings::HumanReadableNumBytes(requested_bytes_in_use_)
+            << ", cached free: "
+            << strings::HumanReadableNumBytes(cached_bytes);
+  // Memory reserved from the sub-allocator that holds no requested bytes:
+  // rounding to size classes, free slots of partially used slabs, and cached
+  // free memory.
+  const double fragmentation =
+      stats_.bytes_reserved > 0
+          ? 1.0 - static_cast<double>(requested_bytes_in_use_) /
+                      stats_.bytes_reserved
+          : 0.0;
+  LOG(INFO) << "Fragmentation: " << fragmentation;
+  LOG(INFO) << "Stats: \n" << stats_.DebugString();
+}
+
+}  // namespace tensorflow
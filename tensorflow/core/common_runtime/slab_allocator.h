@@ -0,0 +1,193 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_ALLOCATOR_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/allocator_retry.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A memory allocator that rounds every request up to one of a fixed set of
+// size classes, spaced four to a power of two.
+//
+// Small requests are carved from fixed-size slabs, each serving a single size
+// class.  Allocations come from the lowest-addressed slab that has a free
+// slot, so live objects pack into few slabs and the others drain.  A slab
+// that becomes empty can be reused by any size class.  Large requests get a
+// region of their own, which is cached for reuse by the same size class once
+// freed.
+//
+// Unlike BFCAllocator, memory is handed back to the sub-allocator: empty
+// slabs and cached regions that stay unused for a while are trimmed, and all
+// of them are released before an allocation is allowed to fail.  This keeps
+// long-running jobs whose tensor shapes vary from pinning a growing, mostly
+// free heap.
+class SlabAllocator : public Allocator {
+ public:
+  struct Options {
+    // The size of each slab.  Requests larger than a quarter of this get a
+    // region of their own.
+    size_t slab_size = 2 << 20;
+
+    // Empty slabs and cached regions that are not reused within this many
+    // allocations are returned to the sub-allocator.  If 0, free memory is
+    // only returned when an allocation would otherwise fail.
+    int64 idle_trim_allocations = 10000;
+  };
+
+  // Takes ownership of sub_allocator.  Holds at most `total_memory` bytes of
+  // it at a time.
+  SlabAllocator(SubAllocator* sub_allocator, size_t total_memory,
+                const string& name, const Options& options);
+  ~SlabAllocator() override;
+
+  string Name() override { return name_; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+
+  void DeallocateRaw(void* ptr) override;
+
+  bool TracksAllocationSizes() const override { return true; }
+
+  size_t RequestedSize(const void* ptr) const override;
+
+  size_t AllocatedSize(const void* ptr) const override;
+
+  int64 AllocationId(const void* ptr) const override;
+
+  absl::optional<AllocatorStats> GetStats() override;
+
+  void ClearStats() override;
+
+  // Returns all empty slabs and cached regions to the sub-allocator, and
+  // returns the number of bytes released.
+  size_t Trim();
+
+  // Logs, for each size class, how much memory it holds and uses, followed
+  // by the fragmentation of the whole allocator.
+  void DumpMemoryLog();
+
+ private:
+  // Allocation granularity and alignment, as in BFCAllocator.
+  static constexpr size_t kMinAllocationSize = 256;
+
+  struct Slab {
+    char* base = nullptr;
+    int size_class = -1;  // -1 while empty.
+    int32 num_slots = 0;
+    // Slots in [next_unused_slot, num_slots) have not been handed out since
+    // the slab was assigned to its size class; free_slots holds the others
+    // that are free.
+    int32 next_unused_slot = 0;
+    std::vector<int32> free_slots;
+    // The value of num_allocs_ when the slab became empty.
+    int64 idle_since = 0;
+  };
+
+  struct Region {
+    void* ptr = nullptr;
+    size_t size = 0;
+    int64 idle_since = 0;
+  };
+
+  struct AllocationInfo {
+    size_t requested_size;
+    int size_class;
+    int64 allocation_id;
+    Slab* slab;  // nullptr for regions.
+  };
+
+  // Orders the slabs of a size class by address.
+  struct SlabLess {
+    bool operator()(const Slab* a, const Slab* b) const {
+      return a->base < b->base;
+    }
+  };
+
+  struct SizeClass {
+    size_t size = 0;
+    int32 slots_per_slab = 0;  // 0 for region size classes.
+    // Slabs of this class with at least one free slot.
+    std::set<Slab*, SlabLess> partial_slabs;
+    int64 num_slabs = 0;
+    int64 num_in_use = 0;
+    // Freed regions of exactly `size` bytes.
+    std::vector<Region> cached_regions;
+  };
+
+  void* AllocateRawInternal(size_t num_bytes, bool dump_log_on_failure);
+  void* AllocateFromSlab(int size_class) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void* AllocateRegion(int size_class) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Obtains `num_bytes` from the sub-allocator if the memory limit allows it,
+  // trimming all free memory first if that is what it takes.
+  void* Reserve(size_t num_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Release(void* ptr, size_t num_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the index of the smallest size class that fits `num_bytes`.
+  int SizeClassFor(size_t num_bytes) const;
+
+  // Returns free memory that has been idle since before `idle_before` to the
+  // sub-allocator.
+  size_t TrimLocked(int64 idle_before) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  void DumpMemoryLogLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::unique_ptr<SubAllocator> sub_allocator_;
+  const string name_;
+  const Options options_;
+  const size_t memory_limit_;
+  AllocatorRetry retry_helper_;
+
+  // Sizes of the size classes, in increasing order.  Immutable.
+  std::vector<size_t> class_sizes_;
+  int num_slab_classes_ = 0;
+
+  mutable mutex mu_;
+  std::vector<SizeClass> classes_ TF_GUARDED_BY(mu_);
+  std::map<char*, std::unique_ptr<Slab>> slabs_ TF_GUARDED_BY(mu_);
+  std::vector<Slab*> empty_slabs_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<const void*, AllocationInfo> allocations_
+      TF_GUARDED_BY(mu_);
+  int64 next_allocation_id_ TF_GUARDED_BY(mu_) = 1;
+  int64 num_allocs_ TF_GUARDED_BY(mu_) = 0;
+  int64 last_trim_ TF_GUARDED_BY(mu_) = 0;
+  int64 requested_bytes_in_use_ TF_GUARDED_BY(mu_) = 0;
+  AllocatorStats stats_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SlabAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_ALLOCATOR_H_
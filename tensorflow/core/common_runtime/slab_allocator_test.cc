@@ -0,0 +1,168 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/slab_allocator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Allocates from the host heap and counts the bytes it hands out.
+class CountingSubAllocator : public SubAllocator {
+ public:
+  CountingSubAllocator() : SubAllocator({}, {}) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes) override {
+    void* ptr = port::AlignedMalloc(num_bytes, alignment);
+    if (ptr != nullptr) bytes_held += num_bytes;
+    return ptr;
+  }
+
+  void Free(void* ptr, size_t num_bytes) override {
+    bytes_held -= num_bytes;
+    port::AlignedFree(ptr);
+  }
+
+  int64 bytes_held = 0;
+};
+
+constexpr size_t kSlabSize = 64 << 10;
+
+SlabAllocator::Options TestOptions() {
+  SlabAllocator::Options options;
+  options.slab_size = kSlabSize;
+  options.idle_trim_allocations = 0;
+  return options;
+}
+
+TEST(SlabAllocatorTest, RoundsToSizeClasses) {
+  SlabAllocator a(new CountingSubAllocator, 1 << 24, "test", TestOptions());
+  void* p1 = a.AllocateRaw(4, 1);
+  void* p2 = a.AllocateRaw(4, 1100);
+  void* p3 = a.AllocateRaw(4, 100 << 10);
+  EXPECT_EQ(256, a.AllocatedSize(p1));
+  EXPECT_EQ(1280, a.AllocatedSize(p2));
+  EXPECT_EQ(1100, a.RequestedSize(p2));
+  EXPECT_GE(a.AllocatedSize(p3), 100 << 10);
+  EXPECT_LE(a.AllocatedSize(p3), 125 << 10);
+  EXPECT_NE(a.AllocationId(p1), a.AllocationId(p2));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p2) % 256);
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p2);
+  a.DeallocateRaw(p3);
+  EXPECT_EQ(0, a.GetStats()->bytes_in_use);
+}
+
+TEST(SlabAllocatorTest, EmptySlabsAreSharedAcrossSizeClasses) {
+  auto* sub_allocator = new CountingSubAllocator;
+  SlabAllocator a(sub_allocator, 1 << 24, "test", TestOptions());
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) ptrs.push_back(a.AllocateRaw(4, 1024));
+  const int64 held = sub_allocator->bytes_held;
+  for (void* p : ptrs) a.DeallocateRaw(p);
+  ptrs.clear();
+  // A different size class reuses the emptied slab instead of growing.
+  for (int i = 0; i < 16; ++i) ptrs.push_back(a.AllocateRaw(4, 4096));
+  EXPECT_EQ(held, sub_allocator->bytes_held);
+  for (void* p : ptrs) a.DeallocateRaw(p);
+}
+
+TEST(SlabAllocatorTest, TrimReturnsFreeMemory) {
+  auto* sub_allocator = new CountingSubAllocator;
+  SlabAllocator a(sub_allocator, 1 << 24, "test", TestOptions());
+  void* small = a.AllocateRaw(4, 512);
+  void* large = a.AllocateRaw(4, 1 << 20);
+  void* kept = a.AllocateRaw(4, 512);
+  a.DeallocateRaw(small);
+  a.DeallocateRaw(large);
+  // The slab still holds `kept`, so only the large region is released.
+  EXPECT_EQ(1 << 20, a.Trim());
+  EXPECT_EQ(kSlabSize, sub_allocator->bytes_held);
+  a.DeallocateRaw(kept);
+  EXPECT_EQ(kSlabSize, a.Trim());
+  EXPECT_EQ(0, sub_allocator->bytes_held);
+  EXPECT_EQ(0, a.GetStats()->bytes_reserved);
+}
+
+TEST(SlabAllocatorTest, IdleMemoryIsTrimmed) {
+  auto* sub_allocator = new CountingSubAllocator;
+  SlabAllocator::Options options = TestOptions();
+  options.idle_trim_allocations = 100;
+  SlabAllocator a(sub_allocator, 1 << 24, "test", options);
+  a.DeallocateRaw(a.AllocateRaw(4, 1 << 20));
+  EXPECT_EQ(1 << 20, sub_allocator->bytes_held);
+  // Keep allocating from one slab until the idle region is trimmed.
+  for (int i = 0; i < 2048; ++i) a.DeallocateRaw(a.AllocateRaw(4, 256));
+  EXPECT_EQ(kSlabSize, sub_allocator->bytes_held);
+}
+
+TEST(SlabAllocatorTest, TrimsCachedMemoryBeforeFailing) {
+  auto* sub_allocator = new CountingSubAllocator;
+  // Room for four 1MiB regions.
+  SlabAllocator a(sub_allocator, 4 << 20, "test", TestOptions());
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) ptrs.push_back(a.AllocateRaw(4, 1 << 20));
+  for (void* p : ptrs) a.DeallocateRaw(p);
+  // A different size class fits only once the cached regions are released.
+  void* p = a.AllocateRaw(4, 3 << 20);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(a.AllocatedSize(p), sub_allocator->bytes_held);
+  a.DeallocateRaw(p);
+
+  AllocationAttributes no_retry(/*retry_on_failure=*/false,
+                                /*allocation_will_be_logged=*/false, nullptr);
+  EXPECT_EQ(nullptr, a.AllocateRaw(4, 5 << 20, no_retry));
+}
+
+TEST(SlabAllocatorTest, Stats) {
+  SlabAllocator a(new CountingSubAllocator, 1 << 24, "test", TestOptions());
+  void* p = a.AllocateRaw(4, 1000);
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  EXPECT_EQ(1, stats->num_allocs);
+  EXPECT_EQ(1024, stats->bytes_in_use);
+  EXPECT_EQ(kSlabSize, stats->bytes_reserved);
+  EXPECT_EQ(1 << 24, *stats->bytes_limit);
+  a.DeallocateRaw(p);
+  a.ClearStats();
+  stats = a.GetStats();
+  EXPECT_EQ(0, stats->num_allocs);
+  EXPECT_EQ(0, stats->peak_bytes_in_use);
+}
+
+void BM_Allocation(int iters, int max_bytes) {
+  SlabAllocator a(new CountingSubAllocator, 1LL << 30, "bench",
+                  SlabAllocator::Options());
+  std::vector<size_t> sizes;
+  for (size_t size = 64; size <= max_bytes; size *= 3) sizes.push_back(size);
+  std::vector<void*> live(16, nullptr);
+  for (int i = 0; i < iters; ++i) {
+    void*& slot = live[i % live.size()];
+    if (slot != nullptr) a.DeallocateRaw(slot);
+    slot = a.AllocateRaw(4, sizes[i % sizes.size()]);
+  }
+  for (void* p : live) {
+    if (p != nullptr) a.DeallocateRaw(p);
+  }
+}
+BENCHMARK(BM_Allocation)->Arg(1 << 16)->Arg(1 << 22);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,836 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_schedule_executor.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+#include "tensorflow/core/framework/log_memory.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/annotated_traceme.h"
+#include "tensorflow/core/profiler/lib/connected_traceme.h"
+#include "tensorflow/core/profiler/lib/scoped_annotation.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/tensor_slice_reader_cache.h"
+
+namespace tensorflow {
+
+const char* const kStaticScheduleExecutor = "STATIC_SCHEDULE_EXECUTOR";
+
+namespace {
+
+typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
+typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
+
+// Returns an `Unimplemented` error if `graph` contains nodes that the static
+// schedule executor cannot run: control flow ops, whose outputs may be dead,
+// and ops with reference-typed inputs or outputs, which require locking.
+Status CheckSupportsStaticSchedule(const Graph& graph) {
+  for (const Node* n : graph.op_nodes()) {
+    if (n->IsControlFlow()) {
+      return errors::Unimplemented("Node ", n->name(),
+                                   " is a control flow op.");
+    }
+    for (const DataType dt : n->input_types()) {
+      if (IsRefType(dt)) {
+        return errors::Unimplemented("Node ", n->name(),
+                                     " has a reference-typed input.");
+      }
+    }
+    for (const DataType dt : n->output_types()) {
+      if (IsRefType(dt)) {
+        return errors::Unimplemented("Node ", n->name(),
+                                     " has a reference-typed output.");
+      }
+    }
+  }
+  return Status::OK();
+}
+
+int GetMaxPartitions() {
+  int64 max_partitions;
+  const Status s = ReadInt64FromEnvVar("TF_STATIC_SCHEDULE_MAX_THREADS",
+                                       port::MaxParallelism(), &max_partitions);
+  if (!s.ok() || max_partitions < 1) {
+    LOG(WARNING) << "Ignoring invalid TF_STATIC_SCHEDULE_MAX_THREADS: " << s;
+    return port::MaxParallelism();
+  }
+  return max_partitions;
+}
+
+// Returns true if `item` might be traced. See `MightTrace()` in executor.cc.
+bool MightTrace(bool is_expensive) {
+  if (profiler::ScopedAnnotation::IsEnabled()) return true;
+  return profiler::TraceMe::Active(profiler::GetTFTraceMeLevel(is_expensive));
+}
+
+class StaticScheduleExecutorImpl : public Executor {
+ public:
+  explicit StaticScheduleExecutorImpl(const LocalExecutorParams& p)
+      : immutable_state_(p) {}
+
+  Status Initialize(const Graph& graph) {
+    TF_RETURN_IF_ERROR(CheckSupportsStaticSchedule(graph));
+    TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
+    return immutable_state_.BuildStaticSchedule(graph, GetMaxPartitions());
+  }
+
+  void RunAsync(const Args& args, DoneCallback done) override;
+
+ private:
+  ImmutableExecutorState immutable_state_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticScheduleExecutorImpl);
+};
+
+// The state associated with one invocation of StaticScheduleExecutorImpl::Run.
+//
+// Each partition of the schedule is run by one closure, which executes its
+// nodes in order.  When the next node still waits for an input from another
+// partition, the closure parks the partition and returns instead of blocking
+// the thread.  The node that delivers the last such input then schedules the
+// partition to resume.
+class StaticScheduleExecutorState {
+ public:
+  StaticScheduleExecutorState(const Executor::Args& args,
+                              const ImmutableExecutorState& immutable_state);
+  ~StaticScheduleExecutorState();
+
+  void RunAsync(Executor::DoneCallback done);
+
+ private:
+  // The progress of a partition within the current invocation.
+  struct Partition {
+    mutex mu;
+    // The index of the next node to run.
+    int next TF_GUARDED_BY(mu) = 0;
+    // True if the partition waits for the inputs of its next node, and no
+    // closure is running it.
+    bool parked TF_GUARDED_BY(mu) = false;
+  };
+
+  struct AsyncState;
+
+  // Runs the nodes of partition `p`, starting at its next node, until the
+  // partition completes, parks, or launches an asynchronous kernel.
+  void RunPartition(int p);
+
+  void InitParams(OpKernelContext::Params* params, TensorValueVec* inputs,
+                  AllocatorAttributeVec* input_alloc_attrs);
+
+  Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
+                     EntryVector* outputs);
+  void ProcessAsync(int partition, const NodeItem& item,
+                    const OpKernelContext::Params& params);
+
+  // Before item->kernel, fills its "inputs".
+  Status PrepareInputs(const NodeItem& item, TensorValueVec* inputs,
+                       AllocatorAttributeVec* input_alloc_attrs);
+
+  // After item->kernel computation is done, processes its outputs.
+  Status ProcessOutputs(const NodeItem& item, OpKernelContext* ctx,
+                        Entry* outputs);
+
+  // Called after each node finishes, or is skipped because the step has been
+  // aborted, in which case `outputs` is nullptr.  Clears the node's inputs,
+  // propagates its outputs and releases its successors in other partitions.
+  void NodeDone(const Status& s, const NodeItem& item, EntryVector* outputs);
+
+  // Decrements the number of remote inputs that `dst_id` waits for, and
+  // resumes its partition if it was parked on the node.
+  void ReleaseRemoteInput(int dst_id);
+
+  // Records the first error of the step, and aborts the rest of it.
+  void Abort(const Status& s);
+
+  void PartitionDone();
+
+  // Clean up when this executor is done.
+  void Finish();
+  void ScheduleFinish();
+
+  const ImmutableExecutorState& immutable_state_;
+  const ImmutableExecutorState::StaticSchedule& schedule_;
+
+  // Contains the device context assigned by the device at the beginning of a
+  // step.
+  DeviceContext* device_context_ = nullptr;
+
+  // true if LogMemory::IsEnabled(). Used to check memory enabled cheaply.
+  const bool log_memory_;
+
+  const int64 step_id_;
+  // Not owned.
+  RendezvousInterface* rendezvous_;
+  CollectiveExecutor* collective_executor_;
+  SessionState* session_state_;
+  const string session_handle_;
+  const SessionMetadata* session_metadata_;
+  TensorStore* tensor_store_;
+  // Step-local container.
+  ScopedStepContainer* step_container_;
+  // Allocator for the step-local tensors of stateless kernels, if the device
+  // provides one. Released when this executor invocation finishes.
+  StepArenaAllocator* step_arena_;
+  StepStatsCollectorInterface* const stats_collector_;
+  Context context_;
+  checkpoint::TensorSliceReaderCacheWrapper slice_reader_cache_;
+  CallFrameInterface* call_frame_;
+  CancellationManager* cancellation_manager_;
+  // If not null, use this device to schedule intra-op operation
+  std::unique_ptr<DeviceBase> user_device_;
+  Executor::Args::Runner runner_;
+  const bool sync_on_finish_;
+  const bool run_all_kernels_inline_;
+
+  // The inputs of every node, laid out as in `SimplePropagatorState`.
+  std::vector<Entry> input_tensors_;
+
+  // Indexed by node ID: the number of inputs from other partitions that the
+  // node still waits for.
+  std::unique_ptr<std::atomic<int32>[]> pending_;
+
+  std::unique_ptr<Partition[]> partitions_;
+  std::atomic<int> num_running_partitions_;
+
+  // Set once a node fails. The nodes that have not started are skipped.
+  std::atomic<bool> aborted_{false};
+
+  // Invoked when the execution finishes.
+  Executor::DoneCallback done_cb_;
+
+  // Available via OpKernelContext to every OpKernel invocation.
+  mutex num_deferred_ops_mu_;
+  int64 num_deferred_ops_ TF_GUARDED_BY(num_deferred_ops_mu_) = 0;
+  bool finish_when_deferred_ops_done_ TF_GUARDED_BY(num_deferred_ops_mu_) =
+      false;
+
+  mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticScheduleExecutorState);
+};
+
+StaticScheduleExecutorState::StaticScheduleExecutorState(
+    const Executor::Args& args, const ImmutableExecutorState& immutable_state)
+    : immutable_state_(immutable_state),
+      schedule_(*immutable_state.static_schedule()),
+      log_memory_(LogMemory::IsEnabled()),
+      step_id_(args.step_id),
+      rendezvous_(args.rendezvous),
+      collective_executor_(args.collective_executor),
+      session_state_(args.session_state),
+      session_handle_(args.session_handle),
+      session_metadata_(immutable_state.params().session_metadata),
+      tensor_store_(args.tensor_store),
+      step_container_(args.step_container),
+      step_arena_(immutable_state.params().device->NewStepArenaAllocator()),
+      stats_collector_(args.stats_collector),
+      context_(ContextKind::kThread),
+      call_frame_(args.call_frame),
+      cancellation_manager_(args.cancellation_manager),
+      runner_(args.runner),
+      sync_on_finish_(args.sync_on_finish),
+      run_all_kernels_inline_(args.run_all_kernels_inline),
+      input_tensors_(immutable_state.get_root_frame_info().total_inputs),
+      pending_(new std::atomic<int32>[schedule_.num_remote_inputs.size()]),
+      partitions_(new Partition[schedule_.partitions.size()]),
+      num_running_partitions_(schedule_.partitions.size()) {
+  if (args.user_intra_op_threadpool != nullptr) {
+    Device* device = immutable_state_.params().device;
+    user_device_ = RenamedDevice::NewRenamedDevice(
+        device->name(), device, false, false, args.user_intra_op_threadpool);
+  }
+  for (size_t i = 0; i < schedule_.num_remote_inputs.size(); ++i) {
+    pending_[i].store(schedule_.num_remote_inputs[i],
+                      std::memory_order_relaxed);
+  }
+}
+
+StaticScheduleExecutorState::~StaticScheduleExecutorState() {
+  if (device_context_) {
+    device_context_->Unref();
+  }
+  if (step_arena_) {
+    step_arena_->Release();
+  }
+}
+
+void StaticScheduleExecutorState::RunAsync(Executor::DoneCallback done) {
+  // Ask the device to fill in the device context map.
+  Device* device = immutable_state_.params().device;
+  const Status get_context_status =
+      device->TryGetDeviceContext(&device_context_);
+  if (!get_context_status.ok()) {
+    delete this;
+    done(get_context_status);
+    return;
+  }
+
+  const int num_partitions = schedule_.partitions.size();
+  if (num_partitions == 0) {
+    delete this;
+    done(Status::OK());
+    return;
+  }
+  done_cb_ = std::move(done);
+  // The last partition to finish deletes this state, possibly while the
+  // others are being scheduled, so schedule them with a copy of the runner.
+  Executor::Args::Runner runner = runner_;
+  for (int p = 0; p < num_partitions; ++p) {
+    runner([this, p]() { RunPartition(p); });
+  }
+}
+
+void StaticScheduleExecutorState::InitParams(
+    OpKernelContext::Params* params, TensorValueVec* inputs,
+    AllocatorAttributeVec* input_alloc_attrs) {
+  params->step_id = step_id_;
+  // Override device's threadpool if user provides an intra_op_threadpool
+  Device* device = immutable_state_.params().device;
+  if (user_device_) {
+    params->device = user_device_.get();
+  } else {
+    params->device = device;
+  }
+  params->log_memory = log_memory_;
+  params->rendezvous = rendezvous_;
+  params->collective_executor = collective_executor_;
+  params->session_state = session_state_;
+  params->session_handle = session_handle_;
+  params->session_metadata = session_metadata_;
+  params->tensor_store = tensor_store_;
+  params->cancellation_manager = cancellation_manager_;
+  params->call_frame = call_frame_;
+  params->function_library = immutable_state_.params().function_library;
+  params->resource_manager = device->resource_manager();
+  params->step_container = step_container_;
+  params->slice_reader_cache = &slice_reader_cache_;
+  params->inputs = inputs;
+  params->input_alloc_attrs = input_alloc_attrs;
+  params->runner = &runner_;
+  params->run_all_kernels_inline = run_all_kernels_inline_;
+  params->stats_collector = stats_collector_;
+  params->inc_num_deferred_ops_function = [this]() {
+    mutex_lock lock(num_deferred_ops_mu_);
+    num_deferred_ops_++;
+  };
+  params->dec_num_deferred_ops_function = [this]() {
+    bool finish_when_deferred_ops_done = false;
+    {
+      mutex_lock lock(num_deferred_ops_mu_);
+      num_deferred_ops_--;
+      if (num_deferred_ops_ == 0) {
+        finish_when_deferred_ops_done = finish_when_deferred_ops_done_;
+      }
+    }
+    // Invoke Finish if the graph processing has completed. Finish is always
+    // called exactly once per invocation, either here if there are any
+    // deferred ops, or in ScheduleFinish if there aren't any deferred ops.
+    if (finish_when_deferred_ops_done) Finish();
+  };
+  // The graph has no control flow, so every node runs in the root frame.
+  params->frame_iter = FrameAndIter(0, 0);
+  params->is_input_dead = false;
+
+  // Set the device_context for this device, if it exists.
+  params->op_device_context = device_context_;
+}
+
+void StaticScheduleExecutorState::RunPartition(int p) {
+  profiler::TraceMeConsumer activity(
+      // From TraceMeProducer in KernelAndDeviceFunc::RunAsync,
+      // DirectSession::RunInternal or GraphMgr::ExecuteAsync.
+      [&] {
+        return profiler::TraceMeEncode("StaticScheduleExecutorState::Process",
+                                       {{"id", step_id_}, {"partition", p}});
+      },
+      profiler::ContextType::kTfExecutor, step_id_,
+      profiler::TraceMeLevel::kInfo);
+  WithContext wc(context_);
+
+  const std::vector<const NodeItem*>& nodes = schedule_.partitions[p];
+  Partition& partition = partitions_[p];
+  int next;
+  {
+    mutex_lock l(partition.mu);
+    next = partition.next;
+  }
+
+  // Parameters passed to OpKernel::Compute.
+  TensorValueVec inputs;
+  AllocatorAttributeVec input_alloc_attrs;
+  OpKernelContext::Params params;
+  InitParams(&params, &inputs, &input_alloc_attrs);
+
+  EntryVector outputs(1);
+
+  const int num_nodes = nodes.size();
+  for (int i = next; i < num_nodes; ++i) {
+    const NodeItem& item = *nodes[i];
+    const int id = item.node_id;
+
+    // Checks the pending count again under the lock, so that the node that
+    // delivers the last input either sees the partition parked, or the
+    // partition sees the input.
+    if (pending_[id].load(std::memory_order_acquire) != 0) {
+      mutex_lock l(partition.mu);
+      if (pending_[id].load(std::memory_order_acquire) != 0) {
+        partition.next = i;
+        partition.parked = true;
+        return;
+      }
+    }
+
+    if (TF_PREDICT_FALSE(aborted_.load(std::memory_order_relaxed))) {
+      NodeDone(Status::OK(), item, nullptr);
+      continue;
+    }
+
+    if (outputs.size() < item.num_outputs) outputs.resize(item.num_outputs);
+    Status s;
+    if (TF_PREDICT_FALSE(item.is_noop)) {
+      // Nothing to compute.
+    } else if (item.const_tensor != nullptr) {
+      Entry& output = outputs[0];
+      output.state = Entry::State::HAS_CONST_TENSOR;
+      output.const_tensor = item.const_tensor;
+      output.alloc_attr = item.output_attrs()[0];
+    } else {
+      s = PrepareInputs(item, &inputs, &input_alloc_attrs);
+      if (s.ok()) {
+        // Set up compute params.
+        params.op_kernel = item.kernel;
+        params.output_attr_array = item.output_attrs();
+        params.forward_from_array = item.forward_from();
+        params.outputs_required_array = item.outputs_required.get();
+        params.step_arena_allocator = item.is_stateful ? nullptr : step_arena_;
+        params.outputs_escape_step = item.outputs_may_escape_step;
+
+        if (item.kernel_is_async) {
+          {
+            mutex_lock l(partition.mu);
+            partition.next = i + 1;
+          }
+          // The kernel's done callback resumes this partition.
+          ProcessAsync(p, item, params);
+          return;
+        }
+        s = ProcessSync(item, &params, &outputs);
+      }
+    }
+    NodeDone(s, item, &outputs);
+  }
+  PartitionDone();
+}
+
+Status StaticScheduleExecutorState::ProcessSync(
+    const NodeItem& item, OpKernelContext::Params* params,
+    EntryVector* outputs) {
+  OpKernelContext ctx(params, item.num_outputs);
+  OpKernel* op_kernel = item.kernel;
+  Device* device = immutable_state_.params().device;
+  const bool is_expensive = op_kernel->IsExpensive();
+  if (TF_PREDICT_FALSE(MightTrace(is_expensive))) {
+    profiler::AnnotatedTraceMe activity(
+        [op_kernel, &ctx] {
+          return op_kernel->TraceString(
+              ctx, /*verbose=*/profiler::TfOpDetailsEnabled());
+        },
+        profiler::GetTFTraceMeLevel(is_expensive));
+    device->Compute(op_kernel, &ctx);
+  } else {
+    device->Compute(op_kernel, &ctx);
+  }
+  return ProcessOutputs(item, &ctx, outputs->data());
+}
+
+// State kept alive for executing an asynchronous node in another thread. As in
+// executor.cc, the inputs and their attributes are copied, because
+// `OpKernelContext` refers to them until the kernel is done.
+struct StaticScheduleExecutorState::AsyncState {
+  AsyncState(const OpKernelContext::Params& p, const NodeItem* _item,
+             int _partition)
+      : saved_inputs(*p.inputs),
+        saved_input_alloc_attrs(*p.input_alloc_attrs),
+        params(p),
+        item(_item),
+        partition(_partition),
+        // ParamsButClearingEigenGPUDevice does equivalent of
+        //   params.eigen_gpu_device = nullptr;
+        ctx(ParamsButClearingEigenGPUDevice(&params), item->num_outputs) {
+    params.inputs = &saved_inputs;
+    params.input_alloc_attrs = &saved_input_alloc_attrs;
+  }
+
+  TensorValueVec saved_inputs;
+  AllocatorAttributeVec saved_input_alloc_attrs;
+  OpKernelContext::Params params;
+  const NodeItem* item;
+  const int partition;
+  OpKernelContext ctx;
+
+ private:
+  OpKernelContext::Params* ParamsButClearingEigenGPUDevice(
+      OpKernelContext::Params* p) {
+    // Ensure OpKernelContext constructor will make a new eigen GPU device if
+    // necessary.
+    p->eigen_gpu_device = nullptr;  // Force allocation
+    return p;
+  }
+};
+
+void StaticScheduleExecutorState::ProcessAsync(
+    int partition, const NodeItem& item,
+    const OpKernelContext::Params& params) {
+  AsyncOpKernel* async_kernel = item.kernel->AsAsync();
+  DCHECK(async_kernel != nullptr);
+  AsyncState* state = new AsyncState(params, &item, partition);
+
+  auto done = [this, state]() {
+    EntryVector outputs(state->item->num_outputs);
+    const Status s = ProcessOutputs(*state->item, &state->ctx, outputs.data());
+    NodeDone(s, *state->item, &outputs);
+    const int partition = state->partition;
+    delete state;
+    runner_([this, partition]() { RunPartition(partition); });
+  };
+  {
+    profiler::AnnotatedTraceMe activity(
+        [async_kernel, state] {
+          return async_kernel->TraceString(
+              state->ctx, /*verbose=*/profiler::TfOpDetailsEnabled());
+        },
+        profiler::GetTFTraceMeLevel(async_kernel->IsExpensive()));
+    immutable_state_.params().device->ComputeAsync(async_kernel, &state->ctx,
+                                                   std::move(done));
+  }
+}
+
+Status StaticScheduleExecutorState::PrepareInputs(
+    const NodeItem& item, TensorValueVec* inputs,
+    AllocatorAttributeVec* input_alloc_attrs) {
+  inputs->resize(item.num_inputs);
+  input_alloc_attrs->resize(item.num_inputs);
+
+  Entry* first_input = input_tensors_.data() + item.input_start;
+  for (int i = 0; i < item.num_inputs; ++i) {
+    Entry* entry = first_input + i;
+    (*input_alloc_attrs)[i] = entry->alloc_attr;
+
+    // i-th input.
+    TensorValue* inp = &(*inputs)[i];
+    inp->mutex_if_ref = nullptr;
+    switch (entry->state) {
+      case Entry::State::HAS_VALUE:
+        inp->tensor = entry->val.get();
+        break;
+      case Entry::State::HAS_CONST_TENSOR:
+        // NOTE(mrry): This `const_cast` is necessary because `TensorValue`
+        // stores a non-const `Tensor*`, and relies on the `OpKernelContext`
+        // accessors making dynamic checks that prevent using an immutable
+        // tensor as a mutable tensor.
+        inp->tensor = const_cast<Tensor*>(entry->const_tensor);
+        break;
+      default:
+        return AttachDef(errors::Internal("Missing ", i, "-th input"),
+                         item.kernel->def());
+    }
+  }
+  return Status::OK();
+}
+
+Status StaticScheduleExecutorState::ProcessOutputs(const NodeItem& item,
+                                                   OpKernelContext* ctx,
+                                                   Entry* outputs) {
+  Status s = ctx->status();
+  if (!s.ok()) {
+    return AttachDef(s, item.kernel->def());
+  }
+
+  for (int i = 0; i < item.num_outputs; ++i) {
+    const TensorValue val = ctx->release_output(i);
+    Entry* out = &outputs[i];
+    DCHECK(out->state == Entry::State::NO_VALUE);
+
+    if (val.tensor == nullptr) {
+      // Unless the executor has marked the output as not required, the node
+      // must produce a tensor value at i-th output.
+      if (!(item.outputs_required && !item.outputs_required[i])) {
+        s.Update(errors::Internal("Missing ", i, "-th output from ",
+                                  FormatNodeDefForError(item.kernel->def())));
+      }
+      continue;
+    }
+
+    // Set the allocator attributes of the output entry.
+    out->alloc_attr = ctx->output_alloc_attr(i);
+
+    // Sanity check of output tensor types. We need to inspect this safely as
+    // we are in the tensor buffer.
+    const DataType dtype = val.dtype_safe();
+    if (dtype == item.output_type(i) && !val.is_ref()) {
+      // NOTE that std::move is used here, so val.tensor goes to
+      // uninitialized state (val.tensor->IsInitialized return false).
+      out->state = Entry::State::HAS_VALUE;
+      out->val.Init(std::move(*val.tensor));
+      if (log_memory_) {
+        LogMemory::RecordTensorOutput(ctx->op_kernel().name(), ctx->step_id(),
+                                      i, *out->val);
+      }
+    } else {
+      s.Update(
+          errors::Internal("Output ", i, " of type ", DataTypeString(dtype),
+                           " does not match declared output type ",
+                           DataTypeString(item.output_type(i)), " for node ",
+                           FormatNodeDefForError(item.kernel->def())));
+    }
+    if (!val.is_ref()) {
+      // If OpKernelContext returns outputs via pass-by-value, we
+      // don't need this trouble.
+      delete val.tensor;
+    }
+  }
+  return s;
+}
+
+void StaticScheduleExecutorState::NodeDone(const Status& s,
+                                           const NodeItem& item,
+                                           EntryVector* outputs) {
+  // Clears inputs.
+  Entry* first_input = input_tensors_.data() + item.input_start;
+  for (int i = 0; i < item.num_inputs; ++i) {
+    (first_input + i)->ClearVal();
+  }
+
+  if (TF_PREDICT_FALSE(!s.ok())) {
+    // Sets `aborted_` before any successor is released, so that none of them
+    // runs without its inputs.
+    Abort(s);
+  } else if (outputs != nullptr) {
+    // NOTE: As in `SimplePropagatorState`, the inputs are written before the
+    // remote successors are released below.
+    for (const EdgeInfo& e : item.output_edges()) {
+      if (e.is_last) {
+        input_tensors_[e.input_slot] = std::move((*outputs)[e.output_slot]);
+      } else {
+        input_tensors_[e.input_slot] = (*outputs)[e.output_slot];
+      }
+    }
+  }
+  if (outputs != nullptr) {
+    // Clear outputs without deallocating the `outputs` vector.
+    for (int i = 0; i < item.num_outputs; ++i) {
+      (*outputs)[i].ClearVal();
+    }
+  }
+
+  const int partition = schedule_.partition_of[item.node_id];
+  for (const EdgeInfo& e : item.output_edges()) {
+    if (schedule_.partition_of[e.dst_id] != partition) {
+      ReleaseRemoteInput(e.dst_id);
+    }
+  }
+  for (const ControlEdgeInfo& e : item.output_control_edges()) {
+    if (schedule_.partition_of[e.dst_id] != partition) {
+      ReleaseRemoteInput(e.dst_id);
+    }
+  }
+}
+
+void StaticScheduleExecutorState::ReleaseRemoteInput(int dst_id) {
+  if (pending_[dst_id].fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+  const int p = schedule_.partition_of[dst_id];
+  Partition& partition = partitions_[p];
+  {
+    mutex_lock l(partition.mu);
+    if (!partition.parked ||
+        schedule_.partitions[p][partition.next]->node_id != dst_id) {
+      return;
+    }
+    partition.parked = false;
+  }
+  runner_([this, p]() { RunPartition(p); });
+}
+
+void StaticScheduleExecutorState::Abort(const Status& s) {
+  bool abort_run = false;
+  {
+    mutex_lock l(mu_);
+    if (status_.ok()) {
+      // If this is the first node to fail in this run, we are responsible for
+      // aborting all other execution in the step.
+      abort_run = true;
+
+      // If execution has been cancelled, mark cancelled or aborted errors as
+      // being derived, so that the original error is exposed to users.
+      if (cancellation_manager_ && cancellation_manager_->IsCancelled() &&
+          (errors::IsCancelled(s) || errors::IsAborted(s))) {
+        status_ = StatusGroup::MakeDerived(s);
+      } else {
+        status_ = s;
+      }
+    }
+  }
+  aborted_.store(true, std::memory_order_relaxed);
+
+  if (abort_run) {
+    VLOG(1) << "[" << immutable_state_.params().device->name()
+            << "] Executor start aborting: " << s;
+    if (rendezvous_) {
+      rendezvous_->StartAbort(s);
+    }
+    if (collective_executor_) {
+      collective_executor_->StartAbort(s);
+    }
+    if (cancellation_manager_) {
+      cancellation_manager_->StartCancel();
+    }
+  }
+}
+
+void StaticScheduleExecutorState::PartitionDone() {
+  if (num_running_partitions_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    ScheduleFinish();
+  }
+}
+
+void StaticScheduleExecutorState::ScheduleFinish() {
+  // If there are in-flight deferred ops, wait for `num_deferred_ops_` to reach
+  // 0 to invoke Finish(). Otherwise, invoke Finish() directly.
+  {
+    mutex_lock lock(num_deferred_ops_mu_);
+    if (num_deferred_ops_ > 0) {
+      finish_when_deferred_ops_done_ = true;
+      return;
+    }
+  }
+  Finish();
+}
+
+void StaticScheduleExecutorState::Finish() {
+  mu_.lock();
+  auto status = status_;
+  auto done_cb = std::move(done_cb_);
+  auto runner = std::move(runner_);
+  mu_.unlock();
+  CHECK(done_cb != nullptr);
+  Device* device = immutable_state_.params().device;
+
+  // See `ExecutorState::Finish()` for the handling of devices that do not
+  // allow sync on completion.
+  if (!device->AllowsSyncOnCompletion()) {
+    status.Update(device->RefreshStatus());
+    if (!status.ok()) {
+      if (rendezvous_) {
+        rendezvous_->StartAbort(status);
+      }
+      if (collective_executor_) {
+        collective_executor_->StartAbort(status);
+      }
+      if (cancellation_manager_) {
+        cancellation_manager_->StartCancel();
+      }
+    }
+    delete this;
+    runner([status, done_cb = std::move(done_cb)]() { done_cb(status); });
+    return;
+  }
+
+  if (sync_on_finish_ && status.ok()) {
+    // Block until the device has finished all queued operations. For
+    // devices like GPUs that continue to execute Ops after their Compute
+    // methods have completed, this ensures that control is not returned to
+    // the user until the step (and its side-effects) has actually completed.
+    device->Sync([this, runner = std::move(runner),
+                  done_cb = std::move(done_cb)](const Status& status) mutable {
+      delete this;
+      runner([status, done_cb = std::move(done_cb)]() { done_cb(status); });
+    });
+  } else {
+    delete this;
+    runner([status, done_cb = std::move(done_cb)]() { done_cb(status); });
+  }
+}
+
+void StaticScheduleExecutorImpl::RunAsync(const Args& args,
+                                          DoneCallback done) {
+  (new StaticScheduleExecutorState(args, immutable_state_))
+      ->RunAsync(std::move(done));
+}
+
+}  // namespace
+
+Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                 const Graph& graph, Executor** executor) {
+  auto impl = absl::make_unique<StaticScheduleExecutorImpl>(params);
+  const Status s = impl->Initialize(graph);
+  if (errors::IsUnimplemented(s)) {
+    VLOG(1) << "Using the default executor instead of a static schedule: "
+            << s;
+    impl.reset();
+    return NewLocalExecutor(params, graph, executor);
+  }
+  TF_RETURN_IF_ERROR(s);
+  *executor = impl.release();
+  return Status::OK();
+}
+
+namespace {
+
+class StaticScheduleExecutorRegistrar {
+ public:
+  StaticScheduleExecutorRegistrar() {
+    ExecutorFactory::Register(kStaticScheduleExecutor, new Factory());
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewStaticScheduleExecutor(params, graph, &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static StaticScheduleExecutorRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,47 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_EXECUTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_EXECUTOR_H_
+
+#include "tensorflow/core/common_runtime/executor.h"
+
+namespace tensorflow {
+
+// The name under which the static schedule executor is registered with
+// `ExecutorFactory`.
+extern const char* const kStaticScheduleExecutor;
+
+// Creates a new `Executor` that runs `graph` from a schedule computed once,
+// when the executor is created.
+//
+// The nodes are partitioned into lists, each of which is run in order by one
+// closure on `Executor::Args::runner`.  A node only waits for its inputs from
+// other partitions, which it tracks with a single atomic counter, so each
+// execution avoids the ready queues and pending counts of the default
+// executor.  This suits small inference graphs with fixed shapes, whose
+// kernels take about as long as dispatching them dynamically.
+//
+// Graphs with control flow or reference-typed edges are run by the default
+// executor instead, as are graphs whose Recv nodes may produce dead tensors.
+// Per-node step stats are not collected.
+//
+// The maximum number of partitions defaults to the available parallelism, and
+// can be set with the TF_STATIC_SCHEDULE_MAX_THREADS environment variable.
+Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                 const Graph& graph, Executor** executor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_EXECUTOR_H_
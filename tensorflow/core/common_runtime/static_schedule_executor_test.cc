@@ -0,0 +1,276 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_schedule_executor.h"
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+#define ALICE "/job:j/replica:0/task:0/cpu:0"
+
+static uint64 kIncarnation = 1;
+
+Rendezvous::ParsedKey Key(const string& name) {
+  Rendezvous::ParsedKey result;
+  TF_CHECK_OK(Rendezvous::ParseKey(
+      Rendezvous::CreateKey(ALICE, kIncarnation, ALICE, name,
+                            FrameAndIter(0, 0)),
+      &result));
+  return result;
+}
+
+Tensor V(const float val) {
+  Tensor tensor(DT_FLOAT, TensorShape({}));
+  tensor.scalar<float>()() = val;
+  return tensor;
+}
+
+float V(const Tensor& tensor) {
+  CHECK_EQ(tensor.dtype(), DT_FLOAT);
+  return tensor.scalar<float>()();
+}
+
+class StaticScheduleExecutorTest : public ::testing::Test {
+ protected:
+  StaticScheduleExecutorTest()
+      : device_(DeviceFactory::NewDevice("CPU", {},
+                                         "/job:localhost/replica:0/task:0")) {
+    SessionOptions options;
+    thread_pool_ = ComputePool(options);
+    rendez_ = NewLocalRendezvous();
+  }
+
+  ~StaticScheduleExecutorTest() override {
+    CHECK(rendez_->Unref());
+    delete exec_;
+  }
+
+  LocalExecutorParams Params(int version) {
+    LocalExecutorParams params;
+    params.device = device_.get();
+    params.create_kernel =
+        [this, version](const std::shared_ptr<const NodeProperties>& props,
+                        OpKernel** kernel) {
+          return CreateNonCachedKernel(device_.get(), nullptr, props, version,
+                                       kernel);
+        };
+    params.delete_kernel = [](OpKernel* kernel) {
+      DeleteNonCachedKernel(kernel);
+    };
+    return params;
+  }
+
+  // Resets exec_ with a static schedule executor of at most `max_threads`
+  // partitions for `graph`.
+  void Create(std::unique_ptr<const Graph> graph, int max_threads) {
+    setenv("TF_STATIC_SCHEDULE_MAX_THREADS",
+           strings::StrCat(max_threads).c_str(), 1 /* replace */);
+    delete exec_;
+    exec_ = nullptr;
+    TF_CHECK_OK(NewStaticScheduleExecutor(
+        Params(graph->versions().producer()), *graph, &exec_));
+  }
+
+  Status Run() {
+    Executor::Args args;
+    args.rendezvous = rendez_;
+    args.runner = [this](std::function<void()> fn) {
+      thread_pool_->Schedule(std::move(fn));
+    };
+    return exec_->Run(args);
+  }
+
+  thread::ThreadPool* thread_pool_ = nullptr;
+  std::unique_ptr<Device> device_;
+  Executor* exec_ = nullptr;
+  Rendezvous* rendez_ = nullptr;
+};
+
+TEST_F(StaticScheduleExecutorTest, SimpleAdd) {
+  // c = a + b
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, ALICE);
+  auto in1 = test::graph::Recv(g.get(), "b", "float", ALICE, 1, ALICE);
+  auto tmp = test::graph::Add(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", ALICE, 1, ALICE);
+  Create(std::move(g), 4);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key("a"), args, V(1.0), false));
+  TF_ASSERT_OK(rendez_->Send(Key("b"), args, V(2.0), false));
+  TF_ASSERT_OK(Run());
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(Key("c"), args, &out, &is_dead));
+  EXPECT_EQ(3.0, V(out));
+}
+
+// Builds a tree that adds `n` copies of the input "a", so that the
+// independent sums can run in different partitions.
+void BuildTree(int n, Graph* g) {
+  auto in = test::graph::Recv(g, "a", "float", ALICE, 1, ALICE);
+  std::vector<Node*> nodes;
+  for (int i = 0; i < n; ++i) {
+    nodes.push_back(test::graph::Identity(g, in, 0));
+  }
+  while (nodes.size() > 1) {
+    std::vector<Node*> sums;
+    for (size_t i = 0; i + 1 < nodes.size(); i += 2) {
+      sums.push_back(test::graph::Add(g, nodes[i], nodes[i + 1]));
+    }
+    if (nodes.size() % 2 == 1) sums.push_back(nodes.back());
+    nodes.swap(sums);
+  }
+  test::graph::Send(g, nodes.back(), "b", ALICE, 1, ALICE);
+}
+
+TEST_F(StaticScheduleExecutorTest, Tree) {
+  for (int max_threads : {1, 2, 8}) {
+    auto g = absl::make_unique<Graph>(OpRegistry::Global());
+    BuildTree(1000, g.get());
+    Create(std::move(g), max_threads);
+    for (int iter = 0; iter < 4; ++iter) {
+      Rendezvous::Args args;
+      TF_ASSERT_OK(rendez_->Send(Key("a"), args, V(1.0), false));
+      TF_ASSERT_OK(Run());
+      Tensor out = V(-1);
+      bool is_dead = false;
+      TF_ASSERT_OK(rendez_->Recv(Key("b"), args, &out, &is_dead));
+      EXPECT_EQ(1000.0, V(out));
+    }
+  }
+}
+
+TEST_F(StaticScheduleExecutorTest, FallsBackForControlFlow) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, ALICE);
+  Tensor pred(DT_BOOL, TensorShape({}));
+  pred.scalar<bool>()() = true;
+  auto in1 = test::graph::Constant(g.get(), pred);
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", ALICE, 1, ALICE);
+  Create(std::move(g), 4);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key("a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run());
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(Key("c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
+TEST_F(StaticScheduleExecutorTest, Abort) {
+  // d = (a + b) + c, where "c" is never sent.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, ALICE);
+  auto in1 = test::graph::Recv(g.get(), "b", "float", ALICE, 1, ALICE);
+  auto in2 = test::graph::Recv(g.get(), "c", "float", ALICE, 1, ALICE);
+  auto add0 = test::graph::Add(g.get(), in0, in1);
+  auto add1 = test::graph::Add(g.get(), add0, in2);
+  test::graph::Send(g.get(), add1, "d", ALICE, 1, ALICE);
+  Create(std::move(g), 4);
+
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key("a"), args, V(1.0), false));
+  TF_ASSERT_OK(rendez_->Send(Key("b"), args, V(1.0), false));
+  rendez_->Ref();
+  SchedClosure([this]() {
+    Env::Default()->SleepForMicroseconds(100 * 1000);
+    rendez_->StartAbort(errors::Aborted(""));
+    rendez_->Unref();
+  });
+  EXPECT_TRUE(errors::IsAborted(Run()));
+  while (!rendez_->RefCountIsOne()) {
+  }
+}
+
+// Returns the scheduled partitions of the nodes named in `names`.
+std::vector<int> Partitions(const ImmutableExecutorState& state,
+                            const Graph& graph,
+                            const std::vector<string>& names) {
+  std::vector<int> partitions;
+  for (const string& name : names) {
+    for (const Node* n : graph.op_nodes()) {
+      if (n->name() == name) {
+        partitions.push_back(state.static_schedule()->partition_of[n->id()]);
+      }
+    }
+  }
+  return partitions;
+}
+
+TEST_F(StaticScheduleExecutorTest, ScheduleKeepsChainsTogether) {
+  // Two independent chains of three additions, joined by a last addition.
+  Graph g(OpRegistry::Global());
+  auto in = test::graph::Recv(&g, "a", "float", ALICE, 1, ALICE);
+  std::vector<string> chains[2];
+  Node* ends[2];
+  for (int c = 0; c < 2; ++c) {
+    Node* v = in;
+    for (int i = 0; i < 3; ++i) {
+      v = test::graph::Add(&g, v, v);
+      chains[c].push_back(v->name());
+    }
+    ends[c] = v;
+  }
+  test::graph::Send(&g, test::graph::Add(&g, ends[0], ends[1]), "b", ALICE, 1,
+                    ALICE);
+
+  {
+    ImmutableExecutorState state(Params(g.versions().producer()));
+    TF_ASSERT_OK(state.Initialize(g));
+    TF_ASSERT_OK(state.BuildStaticSchedule(g, 4));
+    EXPECT_EQ(2, state.static_schedule()->partitions.size());
+    for (int c = 0; c < 2; ++c) {
+      const std::vector<int> partitions = Partitions(state, g, chains[c]);
+      ASSERT_EQ(3, partitions.size());
+      EXPECT_EQ(partitions[0], partitions[1]);
+      EXPECT_EQ(partitions[0], partitions[2]);
+    }
+    EXPECT_NE(Partitions(state, g, chains[0])[0],
+              Partitions(state, g, chains[1])[0]);
+  }
+  {
+    ImmutableExecutorState state(Params(g.versions().producer()));
+    TF_ASSERT_OK(state.Initialize(g));
+    TF_ASSERT_OK(state.BuildStaticSchedule(g, 1));
+    EXPECT_EQ(1, state.static_schedule()->partitions.size());
+    // Every node except the source and sink is scheduled.
+    EXPECT_EQ(g.num_op_nodes(),
+              state.static_schedule()->partitions[0].size());
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,130 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, size_t chunk_size)
+    : base_(base), chunk_size_(chunk_size) {
+  CHECK_GT(chunk_size_, 0);
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  mutex_lock l(mu_);
+  DCHECK_EQ(num_live_, 0);
+  for (auto& chunk : chunks_) {
+    base_->DeallocateRaw(chunk.second.data);
+  }
+}
+
+void* StepArenaAllocator::AllocateFromChunk(Chunk* chunk, size_t alignment,
+                                            size_t num_bytes) {
+  const uintptr_t start = reinterpret_cast<uintptr_t>(chunk->data);
+  const uintptr_t aligned =
+      (start + chunk->used + alignment - 1) / alignment * alignment;
+  const size_t offset = aligned - start;
+  if (offset + num_bytes > chunk_size_) return nullptr;
+  chunk->used = offset + num_bytes;
+  ++chunk->num_live;
+  ++num_live_;
+  return chunk->data + offset;
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  // Zero-byte allocations still get an address of their own inside the chunk.
+  num_bytes = std::max<size_t>(num_bytes, 1);
+  if (num_bytes > chunk_size_ / kLargeAllocationFraction ||
+      alignment > Allocator::kAllocatorAlignment) {
+    void* ptr = base_->AllocateRaw(alignment, num_bytes);
+    if (ptr != nullptr) {
+      mutex_lock l(mu_);
+      DCHECK(!released_);
+      ++num_live_;
+    }
+    return ptr;
+  }
+
+  mutex_lock l(mu_);
+  DCHECK(!released_);
+  if (current_ != nullptr) {
+    void* ptr = AllocateFromChunk(current_, alignment, num_bytes);
+    if (ptr != nullptr) return ptr;
+  }
+  if (!idle_chunks_.empty()) {
+    current_ = idle_chunks_.back();
+    idle_chunks_.pop_back();
+  } else {
+    char* data = static_cast<char*>(
+        base_->AllocateRaw(Allocator::kAllocatorAlignment, chunk_size_));
+    if (data == nullptr) return nullptr;
+    current_ = &chunks_[data];
+    *current_ = Chunk{data, 0, 0};
+  }
+  return AllocateFromChunk(current_, alignment, num_bytes);
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  const char* p = static_cast<const char*>(ptr);
+  bool done = false;
+  {
+    mutex_lock l(mu_);
+    --num_live_;
+    auto it = chunks_.upper_bound(p);
+    if (it != chunks_.begin() && p < (--it)->first + chunk_size_) {
+      Chunk* chunk = &it->second;
+      if (--chunk->num_live == 0) {
+        chunk->used = 0;
+        if (released_) {
+          base_->DeallocateRaw(chunk->data);
+          chunks_.erase(it);
+        } else if (chunk != current_) {
+          idle_chunks_.push_back(chunk);
+        }
+      }
+    } else {
+      base_->DeallocateRaw(ptr);
+    }
+    done = released_ && num_live_ == 0;
+  }
+  if (done) delete this;
+}
+
+void StepArenaAllocator::Release() {
+  bool done = false;
+  {
+    mutex_lock l(mu_);
+    CHECK(!released_);
+    released_ = true;
+    current_ = nullptr;
+    idle_chunks_.clear();
+    for (auto it = chunks_.begin(); it != chunks_.end();) {
+      if (it->second.num_live == 0) {
+        base_->DeallocateRaw(it->second.data);
+        it = chunks_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    done = num_live_ == 0;
+  }
+  if (done) delete this;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,90 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator for the temporaries and intermediate outputs of the kernels run
+// by a single executor invocation, which are not expected to outlive it.
+//
+// Serves small allocations by bumping a pointer through fixed-size chunks
+// obtained from a base allocator, and larger ones from the base allocator
+// directly.  The space of a freed allocation is only reused once every
+// allocation from its chunk has been freed.
+//
+// The owner calls Release() when the invocation finishes, which returns the
+// idle chunks to the base allocator in bulk.  Tensors that outlive the
+// invocation keep their chunk alive, and the allocator deletes itself once
+// the last of its allocations is freed.  Thread-safe.
+class StepArenaAllocator : public Allocator {
+ public:
+  // Allocations larger than chunk_size / kLargeAllocationFraction bypass the
+  // chunks.
+  static constexpr size_t kLargeAllocationFraction = 4;
+
+  StepArenaAllocator(Allocator* base, size_t chunk_size);
+
+  // Returns the idle chunks to the base allocator, and deletes this allocator
+  // as soon as none of its allocations is live.  No allocations may be made
+  // afterwards.  Must be called exactly once.
+  void Release();
+
+  std::string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+ private:
+  // Deleted by Release() or DeallocateRaw().
+  ~StepArenaAllocator() override;
+
+  struct Chunk {
+    char* data;
+    size_t used;
+    int64 num_live;
+  };
+
+  // Carves "num_bytes" out of "chunk", or returns nullptr if it does not fit.
+  void* AllocateFromChunk(Chunk* chunk, size_t alignment, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;  // Not owned.
+  const size_t chunk_size_;
+
+  mutex mu_;
+  // All chunks, keyed by the address of their data.
+  std::map<const char*, Chunk> chunks_ TF_GUARDED_BY(mu_);
+  // The chunk that allocations are currently carved out of.
+  Chunk* current_ TF_GUARDED_BY(mu_) = nullptr;
+  // Chunks that no live allocation refers to, kept for reuse.
+  std::vector<Chunk*> idle_chunks_ TF_GUARDED_BY(mu_);
+  // Number of live allocations, including those that bypass the chunks.
+  int64 num_live_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
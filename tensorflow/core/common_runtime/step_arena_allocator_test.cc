@@ -0,0 +1,141 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the allocations made through it.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    ++num_live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations_ = 0;
+  int num_live_ = 0;
+};
+
+constexpr size_t kChunkSize = 1024;
+
+TEST(StepArenaAllocatorTest, SmallAllocationsShareChunks) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, kChunkSize);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) %
+                     Allocator::kAllocatorAlignment);
+    memset(ptr, i, 100);
+    ptrs.push_back(ptr);
+  }
+  // 8 allocations of 128 aligned bytes fill exactly one chunk.
+  EXPECT_EQ(1, base.num_allocations_);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(i, static_cast<char*>(ptrs[i])[99]);
+  }
+  ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment, 100));
+  EXPECT_EQ(2, base.num_allocations_);
+
+  // Allocations larger than a quarter chunk bypass the chunks.
+  void* large = arena->AllocateRaw(Allocator::kAllocatorAlignment, 512);
+  EXPECT_EQ(3, base.num_allocations_);
+  arena->DeallocateRaw(large);
+  EXPECT_EQ(2, base.num_live_);
+
+  // A chunk whose allocations are all freed is reused.
+  for (int i = 0; i < 8; ++i) arena->DeallocateRaw(ptrs[i]);
+  for (int i = 0; i < 8; ++i) {
+    ptrs[i] = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  }
+  EXPECT_EQ(3, base.num_allocations_);
+
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+  arena->Release();
+  EXPECT_EQ(0, base.num_live_);
+}
+
+TEST(StepArenaAllocatorTest, ReleaseFreesIdleChunks) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, kChunkSize);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 24; ++i) {
+    ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment, 100));
+  }
+  EXPECT_EQ(3, base.num_live_);
+  // Frees all of the first two chunks, and one allocation of the third.
+  for (int i = 0; i < 16; ++i) arena->DeallocateRaw(ptrs[i]);
+  arena->DeallocateRaw(ptrs[16]);
+  arena->Release();
+  EXPECT_EQ(1, base.num_live_);
+
+  // The remaining allocations outlive the release.
+  for (int i = 17; i < 24; ++i) arena->DeallocateRaw(ptrs[i]);
+  EXPECT_EQ(0, base.num_live_);
+}
+
+TEST(StepArenaAllocatorTest, TensorsOutliveRelease) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, kChunkSize);
+  Tensor small(arena, DT_FLOAT, TensorShape({4}));
+  Tensor large(arena, DT_FLOAT, TensorShape({1024}));
+  Tensor strings(arena, DT_STRING, TensorShape({2}));
+  {
+    Tensor temp(arena, DT_INT32, TensorShape({8}));
+    test::FillIota<int32>(&temp, 0);
+  }
+  test::FillIota<float>(&small, 1.f);
+  test::FillIota<float>(&large, 2.f);
+  strings.flat<tstring>()(0) = "a";
+  strings.flat<tstring>()(1) = string(100, 'b');
+  arena->Release();
+  EXPECT_EQ(2, base.num_live_);
+
+  test::ExpectTensorEqual<float>(
+      small, test::AsTensor<float>({1.f, 2.f, 3.f, 4.f}, TensorShape({4})));
+  EXPECT_EQ(1025.f, large.flat<float>()(1023));
+  EXPECT_EQ(string(100, 'b'), string(strings.flat<tstring>()(1)));
+  small = Tensor();
+  large = Tensor();
+  EXPECT_EQ(1, base.num_live_);
+  strings = Tensor();
+  EXPECT_EQ(0, base.num_live_);
+}
+
+TEST(StepArenaAllocatorTest, ReleaseWithoutAllocations) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, kChunkSize);
+  arena->Release();
+  EXPECT_EQ(0, base.num_allocations_);
+}
+
+}  // namespace
+}  // namespace tensorflow
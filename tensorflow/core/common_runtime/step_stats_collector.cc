@@ -158,6 +158,10 @@ void NodeExecStatsWrapper::SetMemory(OpKernelContext* ctx) {
   ms->set_persistent_memory_size(ctx->persistent_memory_allocated());
 }
 
+void NodeExecStatsWrapper::SetDeviceComputeTime(OpKernelContext* ctx) {
+  read_device_compute_nanos_ = ctx->release_device_compute_time();
+}
+
 void NodeExecStatsWrapper::SetOutput(int slot, const Tensor* tensor) {
   DCHECK(tensor);
   NodeOutput* node_output = stats_->add_output();
@@ -191,6 +195,13 @@ void NodeExecStatsWrapper::Finalize() {
     }
   }
   allocations_.clear();
+  if (read_device_compute_nanos_) {
+    const int64 device_compute_nanos = read_device_compute_nanos_();
+    if (device_compute_nanos >= 0) {
+      stats_->set_device_compute_nanos(device_compute_nanos);
+    }
+    read_device_compute_nanos_ = nullptr;
+  }
 }
 
 StepStatsCollector::StepStatsCollector(StepStats* step_stats)
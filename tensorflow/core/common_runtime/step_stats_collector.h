@@ -76,6 +76,10 @@ class NodeExecStatsInterface {
   // Takes ownership of any `TrackingAllocator` objects stored in `ctx`.
   virtual void SetMemory(OpKernelContext* ctx) = 0;
 
+  // Records the time the work of this node took on its device, if the device
+  // stored a way to read it in `ctx`.
+  virtual void SetDeviceComputeTime(OpKernelContext* ctx) = 0;
+
   // Records information about the tensor produced by this node at the given
   // output slot.
   virtual void SetOutput(int slot, const Tensor* tensor) = 0;
@@ -97,8 +101,12 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
                        const NodeDef* node,
                        StepStatsCollector* step_stats_collector);
 
-  // Destructor calls Finalize() to release the TrackingAllocators.
-  ~NodeExecStatsWrapper() override { Finalize(); }
+  // Destructor calls Finalize() to release the TrackingAllocators. The device
+  // compute time is dropped, since the device may still be running the node.
+  ~NodeExecStatsWrapper() override {
+    read_device_compute_nanos_ = nullptr;
+    Finalize();
+  }
 
   void Done(const string& device) override;
   void RecordExecutorStarted() override;
@@ -107,6 +115,7 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
   void RecordExecutorEnded() override;
   bool TrackAllocations() const override { return true; }
   void SetMemory(OpKernelContext* ctx) override;
+  void SetDeviceComputeTime(OpKernelContext* ctx) override;
   void SetOutput(int slot, const Tensor* tensor) override;
   void SetScheduled(int64 nanos) override;
 
@@ -115,7 +124,8 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
 
   NodeExecStats* stats() { return stats_.get(); }
 
-  // Populates stats_ and releases TrackingAllocator.
+  // Populates stats_, releases TrackingAllocator and reads the device compute
+  // time.
   void Finalize();
 
   // Does not take ownership of the `allocator`.
@@ -125,6 +135,7 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
 
   gtl::InlinedVector<std::pair<AllocatorMemoryUsed*, TrackingAllocator*>, 2>
       allocations_;
+  std::function<int64()> read_device_compute_nanos_;
   std::unique_ptr<NodeExecStats> stats_;
   const NodeDef* const node_;                       // Not owned.
   StepStatsCollector* const step_stats_collector_;  // Not owned.
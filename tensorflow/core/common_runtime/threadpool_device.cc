@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 
 #include "tensorflow/core/common_runtime/local_device.h"
+#include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/allocator_registry.h"
 #include "tensorflow/core/framework/device_base.h"
@@ -27,9 +29,11 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/types.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 #ifdef INTEL_MKL
@@ -41,6 +45,12 @@ limitations under the License.
 #endif
 
 namespace tensorflow {
+namespace {
+
+// Size of the chunks of the per-step arena allocators.
+constexpr size_t kStepArenaChunkSize = 1 << 20;
+
+}  // namespace
 
 ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                    const string& name, Bytes memory_limit,
@@ -50,6 +60,19 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  Status status = ReadBoolFromEnvVar("TF_CPU_STEP_ARENA_ALLOCATOR",
+                                     /*default_val=*/false,
+                                     &use_step_arena_allocator_);
+  if (!status.ok()) {
+    LOG(ERROR) << "ThreadPoolDevice: " << status.error_message();
+  }
+  // Devices bound to a NUMA node run their inter-op closures on threads of
+  // that node, so that the step's tensors stay in node-local memory.
+  if (options.config.experimental().use_numa_affinity() &&
+      locality.numa_node() != port::kNUMANoAffinity) {
+    set_tensorflow_device_thread_pool(
+        NumaComputePool(options, locality.numa_node()));
+  }
 #if !defined(ENABLE_MKLDNN_THREADPOOL) && defined(INTEL_MKL)
   // Early return when MKL is disabled
   if (DisableMKL()) return;
@@ -89,6 +112,11 @@ Allocator* ThreadPoolDevice::GetScopedAllocator(AllocatorAttributes attr,
   return allocator_;
 }
 
+StepArenaAllocator* ThreadPoolDevice::NewStepArenaAllocator() {
+  if (!use_step_arena_allocator_) return nullptr;
+  return new StepArenaAllocator(allocator_, kStepArenaChunkSize);
+}
+
 Status ThreadPoolDevice::MakeTensorFromProto(
     const TensorProto& tensor_proto, const AllocatorAttributes alloc_attrs,
     Tensor* tensor) {
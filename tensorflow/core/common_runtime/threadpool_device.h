@@ -44,9 +44,14 @@ class ThreadPoolDevice : public LocalDevice {
 
   Status Sync() override { return Status::OK(); }
 
+  // Returns nullptr unless the TF_CPU_STEP_ARENA_ALLOCATOR environment
+  // variable is set to true.
+  StepArenaAllocator* NewStepArenaAllocator() override;
+
  private:
   Allocator* allocator_;  // Not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
+  bool use_step_arena_allocator_ = false;
 };
 
 }  // namespace tensorflow
@@ -38,7 +38,9 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
   Status CreateDevices(const SessionOptions& options, const string& name_prefix,
                        std::vector<std::unique_ptr<Device>>* devices) override {
     int num_numa_nodes = port::NUMANumNodes();
-    int n = 1;
+    // With NUMA affinity, there is one CPU device per NUMA node by default.
+    int n = options.config.experimental().use_numa_affinity() ? num_numa_nodes
+                                                              : 1;
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
       n = iter->second;
@@ -14,15 +14,107 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <zlib.h>
+
+#include <cstring>
+
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/snappy.h"
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+Status ZlibCompress(const char* data, size_t size, string* out) {
+  uLongf compressed_size = compressBound(size);
+  out->resize(compressed_size);
+  int ret = compress2(reinterpret_cast<Bytef*>(&(*out)[0]), &compressed_size,
+                      reinterpret_cast<const Bytef*>(data), size,
+                      Z_DEFAULT_COMPRESSION);
+  if (ret != Z_OK) {
+    return errors::Internal("Failed to compress using zlib, error: ", ret);
+  }
+  out->resize(compressed_size);
+  return Status::OK();
+}
+
+// Decompresses zlib-compressed `data` into the buffers of `iov`, which must
+// hold exactly the uncompressed bytes.
+Status ZlibUncompressToIOVec(const string& data, struct iovec* iov,
+                             int num_iov) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit(&stream) != Z_OK) {
+    return errors::Internal("Failed to initialize zlib decompression.");
+  }
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  int ret = Z_OK;
+  // The number of bytes which did not fit in the buffers, or were missing.
+  size_t mismatch = 0;
+  for (int i = 0; i < num_iov; ++i) {
+    stream.next_out = reinterpret_cast<Bytef*>(iov[i].iov_base);
+    stream.avail_out = iov[i].iov_len;
+    while (stream.avail_out > 0 && ret == Z_OK) {
+      ret = inflate(&stream, Z_NO_FLUSH);
+    }
+    mismatch += stream.avail_out;
+  }
+  if (ret == Z_OK) {
+    // All the buffers are full, so the stream must end here.
+    uint8 extra;
+    stream.next_out = &extra;
+    stream.avail_out = 1;
+    ret = inflate(&stream, Z_FINISH);
+    mismatch += 1 - stream.avail_out;
+  }
+  inflateEnd(&stream);
+  if (ret != Z_STREAM_END) {
+    return errors::Internal("Failed to perform zlib decompression, error: ",
+                            ret);
+  }
+  if (mismatch > 0) {
+    return errors::Internal(
+        "Uncompressed size mismatch with the tensor metadata.");
+  }
+  return Status::OK();
+}
+
+Status SnappyUncompressToIOVec(const string& data, int64 total_size,
+                               struct iovec* iov, int num_iov) {
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                          &uncompressed_size)) {
+    return errors::Internal("Could not get snappy uncompressed length");
+  }
+  if (uncompressed_size != static_cast<size_t>(total_size)) {
+    return errors::Internal(
+        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+        " whereas the tensor metadata suggests ", total_size);
+  }
+  if (!port::Snappy_UncompressToIOVec(data.data(), data.size(), iov,
+                                      num_iov)) {
+    return errors::Internal("Failed to perform snappy decompression.");
+  }
+  return Status::OK();
+}
+
+}  // namespace
 
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
+  return CompressElement(element, io::compression::kSnappy, out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       const string& compression, CompressedElement* out) {
+  if (compression != io::compression::kSnappy &&
+      compression != io::compression::kZlib) {
+    return errors::InvalidArgument("Unsupported element compression: ",
+                                   compression);
+  }
   // Step 1: Determine the total uncompressed size. This requires serializing
   // non-memcopyable tensors, which we save to use again later.
   std::vector<TensorProto> non_memcpy_components;
@@ -64,8 +156,12 @@ Status CompressElement(const std::vector<Tensor>& element,
   }
   DCHECK_EQ(position, uncompressed.mdata() + total_size);
 
-  if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
-                             out->mutable_data())) {
+  if (compression == io::compression::kZlib) {
+    TF_RETURN_IF_ERROR(
+        ZlibCompress(uncompressed.data(), total_size, out->mutable_data()));
+    out->set_compression(compression);
+  } else if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
+                                    out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
   }
   VLOG(3) << "Compressed element from " << total_size << " bytes to "
@@ -111,20 +207,15 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal("Could not get snappy uncompressed length");
-  }
-  if (uncompressed_size != static_cast<size_t>(total_size)) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", total_size);
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.data(),
-                                      num_components)) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  if (compressed.compression() == io::compression::kZlib) {
+    TF_RETURN_IF_ERROR(
+        ZlibUncompressToIOVec(compressed_data, iov.data(), num_components));
+  } else if (!compressed.compression().empty()) {
+    return errors::Internal("Unsupported element compression: ",
+                            compressed.compression());
+  } else {
+    TF_RETURN_IF_ERROR(SnappyUncompressToIOVec(compressed_data, total_size,
+                                               iov.data(), num_components));
   }
 
   // Step 3: Deserialize tensor proto strings to tensors.
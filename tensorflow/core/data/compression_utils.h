@@ -26,6 +26,12 @@ namespace data {
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
 // out the per-component metadata for the `CompressedElement`.
+//
+// `compression` is `io::compression::kSnappy` (the default) or
+// `io::compression::kZlib`, which trades compression speed for a better
+// ratio.
+Status CompressElement(const std::vector<Tensor>& element,
+                       const string& compression, CompressedElement* out);
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
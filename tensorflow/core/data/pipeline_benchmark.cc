@@ -0,0 +1,270 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/pipeline_benchmark.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <memory>
+
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kModelDatasetOp[] = "ModelDataset";
+
+// Default share of available RAM that can be used by the buffers of the input
+// pipeline, as for `ModelDataset`.
+constexpr double kRamBudgetShare = 0.5;
+
+// Removes the `ModelDataset` nodes of `graph_def`, connecting their consumers
+// to their inputs.
+void RemoveModelDatasets(GraphDef* graph_def) {
+  absl::flat_hash_map<string, string> model_inputs;
+  for (const NodeDef& node : graph_def->node()) {
+    if (node.op() == kModelDatasetOp && node.input_size() > 0) {
+      model_inputs[node.name()] = node.input(0);
+    }
+  }
+  if (model_inputs.empty()) return;
+
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    for (string& input : *node.mutable_input()) {
+      while (true) {
+        const TensorId id = ParseTensorName(input);
+        auto it = model_inputs.find(string(id.node()));
+        if (it == model_inputs.end()) break;
+        if (id.index() == Graph::kControlSlot) {
+          input = strings::StrCat("^", ParseTensorName(it->second).node());
+        } else {
+          input = it->second;
+        }
+      }
+    }
+  }
+  auto* nodes = graph_def->mutable_node();
+  nodes->erase(std::remove_if(nodes->begin(), nodes->end(),
+                              [](const NodeDef& node) {
+                                return node.op() == kModelDatasetOp;
+                              }),
+               nodes->end());
+}
+
+// Returns the capacity of the buffer of a node with the given parameters, or 0
+// if it has no buffer.
+double BufferCapacity(const absl::flat_hash_map<string, double>& parameters) {
+  auto it = parameters.find(model::kBufferSize);
+  if (it == parameters.end()) it = parameters.find(model::kParallelism);
+  if (it == parameters.end()) return 0;
+  return std::max(it->second, 0.0);
+}
+
+// Samples the buffers of the nodes of a model and, with autotuning, tunes its
+// parameters, on a background thread.
+class ModelSampler {
+ public:
+  ModelSampler(std::shared_ptr<model::Model> model,
+               const PipelineBenchmarkOptions& options, int64 cpu_budget,
+               int64 ram_budget)
+      : model_(std::move(model)),
+        options_(options),
+        cpu_budget_(cpu_budget),
+        ram_budget_(ram_budget) {
+    thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "tf_data_pipeline_benchmark", [this] { Run(); }));
+  }
+
+  // Stops sampling and adds the averages of the samples to `node_stats`.
+  void Stop(std::vector<PipelineBenchmarkNodeStats>* node_stats) {
+    {
+      mutex_lock l(mu_);
+      stopped_ = true;
+      cond_var_.notify_all();
+    }
+    thread_.reset();
+    for (PipelineBenchmarkNodeStats& stats : *node_stats) {
+      auto it = samples_.find(stats.stats.name);
+      if (it == samples_.end() || it->second.num_samples == 0) continue;
+      const Samples& samples = it->second;
+      stats.average_buffered_elements =
+          samples.buffered_elements / samples.num_samples;
+      stats.buffer_utilization = samples.utilization / samples.num_samples;
+    }
+  }
+
+ private:
+  struct Samples {
+    int64 num_samples = 0;
+    double buffered_elements = 0;
+    double utilization = 0;
+  };
+
+  void Run() {
+    while (true) {
+      {
+        mutex_lock l(mu_);
+        if (!stopped_) {
+          cond_var_.wait_for(
+              l, std::chrono::milliseconds(options_.sampling_period_ms));
+        }
+        if (stopped_) return;
+      }
+      if (options_.autotune) {
+        model_->Optimize(options_.algorithm, cpu_budget_, ram_budget_,
+                         /*model_input_time=*/0);
+      }
+      for (const model::NodeStats& stats : model_->CollectNodeStats()) {
+        Samples& samples = samples_[stats.name];
+        ++samples.num_samples;
+        samples.buffered_elements += stats.buffered_elements;
+        const double capacity = BufferCapacity(stats.parameters);
+        if (capacity > 0) {
+          samples.utilization +=
+              std::min(stats.buffered_elements / capacity, 1.0);
+        }
+      }
+    }
+  }
+
+  const std::shared_ptr<model::Model> model_;
+  const PipelineBenchmarkOptions options_;
+  const int64 cpu_budget_;
+  const int64 ram_budget_;
+  mutex mu_;
+  condition_variable cond_var_;
+  bool stopped_ TF_GUARDED_BY(mu_) = false;
+  // Only accessed by the sampling thread until it is joined.
+  absl::flat_hash_map<string, Samples> samples_;
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace
+
+string PipelineBenchmarkResult::DebugString() const {
+  string report = absl::StrFormat(
+      "Produced %d elements in %.3f s: %.1f elements/s\n", num_elements,
+      wall_time_seconds, elements_per_second);
+  absl::StrAppendFormat(&report, "%-40s %10s %14s %12s %10s %8s  %s\n",
+                        "Node", "Elements", "Self (us/el)", "Total (ms)",
+                        "Buffered", "Util", "Parameters");
+  for (const PipelineBenchmarkNodeStats& node : node_stats) {
+    std::vector<string> parameters;
+    for (const auto& pair : node.stats.parameters) {
+      parameters.push_back(absl::StrFormat("%s=%g", pair.first, pair.second));
+    }
+    std::sort(parameters.begin(), parameters.end());
+    absl::StrAppendFormat(
+        &report, "%-40s %10d %14.3f %12.3f %10.1f %7.0f%%  %s\n",
+        node.stats.name, node.stats.num_elements,
+        node.stats.self_processing_time / 1e3,
+        node.stats.processing_time / 1e6, node.average_buffered_elements,
+        node.buffer_utilization * 100, absl::StrJoin(parameters, ", "));
+  }
+  for (const auto& what_if : what_if_parameters) {
+    std::vector<std::pair<string, double>> parameters(what_if.second.begin(),
+                                                      what_if.second.end());
+    std::sort(parameters.begin(), parameters.end());
+    absl::StrAppendFormat(&report, "Autotuned parameters for %d CPUs:",
+                          what_if.first);
+    if (parameters.empty()) absl::StrAppend(&report, " none");
+    for (const auto& pair : parameters) {
+      absl::StrAppendFormat(&report, " %s=%g", pair.first, pair.second);
+    }
+    absl::StrAppend(&report, "\n");
+  }
+  return report;
+}
+
+Status RunPipelineBenchmark(const GraphDef& graph_def,
+                            const PipelineBenchmarkOptions& options,
+                            PipelineBenchmarkResult* result) {
+  GraphDef pipeline = graph_def;
+  RemoveModelDatasets(&pipeline);
+
+  standalone::Dataset::Params params;
+  const int num_threads =
+      options.num_threads > 0 ? options.num_threads : port::MaxParallelism();
+  params.session_options.config.set_inter_op_parallelism_threads(num_threads);
+  params.session_options.config.set_intra_op_parallelism_threads(num_threads);
+  std::unique_ptr<standalone::Dataset> dataset;
+  TF_RETURN_IF_ERROR(
+      standalone::Dataset::FromGraph(params, pipeline, &dataset));
+
+  // Resource usage is needed for the processing times of all the nodes, not
+  // only of those with tunable parameters.
+  auto model = std::make_shared<model::Model>(/*collect_resource_usage=*/true);
+  std::unique_ptr<standalone::Iterator> iterator;
+  TF_RETURN_IF_ERROR(dataset->MakeIterator(model, &iterator));
+
+  const int64 cpu_budget = options.cpu_budget > 0 ? options.cpu_budget
+                                                  : port::NumSchedulableCPUs();
+  const int64 ram_budget = options.ram_budget > 0
+                               ? options.ram_budget
+                               : kRamBudgetShare * port::AvailableRam();
+  ModelSampler sampler(model, options, cpu_budget, ram_budget);
+
+  Env* env = Env::Default();
+  const uint64 start_micros = env->NowMicros();
+  const uint64 deadline_micros =
+      start_micros + options.max_duration_ms * EnvTime::kMillisToMicros;
+  int64 num_elements = 0;
+  Status status;
+  bool end_of_input = false;
+  while (options.max_elements <= 0 || num_elements < options.max_elements) {
+    if (options.max_duration_ms > 0 && env->NowMicros() >= deadline_micros) {
+      break;
+    }
+    std::vector<Tensor> outputs;
+    status = iterator->GetNext(&outputs, &end_of_input);
+    if (!status.ok() || end_of_input) break;
+    ++num_elements;
+  }
+  const uint64 end_micros = env->NowMicros();
+
+  result->num_elements = num_elements;
+  result->wall_time_seconds = (end_micros - start_micros) / 1e6;
+  result->elements_per_second =
+      result->wall_time_seconds > 0
+          ? num_elements / result->wall_time_seconds
+          : 0;
+  result->node_stats.clear();
+  for (model::NodeStats& stats : model->CollectNodeStats()) {
+    result->node_stats.emplace_back();
+    result->node_stats.back().stats = std::move(stats);
+  }
+  sampler.Stop(&result->node_stats);
+  result->what_if_parameters.clear();
+  for (int64 what_if_cpu_budget : options.what_if_cpu_budgets) {
+    result->what_if_parameters.emplace_back(
+        what_if_cpu_budget,
+        model->ProposeParameters(options.algorithm, what_if_cpu_budget,
+                                 ram_budget, /*model_input_time=*/0));
+  }
+  return status;
+}
+
+}  // namespace data
+}  // namespace tensorflow
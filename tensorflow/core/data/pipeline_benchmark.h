@@ -0,0 +1,115 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_PIPELINE_BENCHMARK_H_
+#define TENSORFLOW_CORE_DATA_PIPELINE_BENCHMARK_H_
+
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// Benchmarks a whole input pipeline offline: runs a serialized dataset graph,
+// e.g. the graph of a `tf.data.Dataset` ending in a `_Retval` node, with the
+// standalone tf.data runtime and reports its throughput together with the
+// metrics that the autotuning model records for each of its transformations.
+//
+// Example usage:
+//
+//   PipelineBenchmarkOptions options;
+//   options.num_threads = 8;
+//   options.what_if_cpu_budgets = {4, 16};
+//   PipelineBenchmarkResult result;
+//   TF_CHECK_OK(RunPipelineBenchmark(graph_def, options, &result));
+//   LOG(INFO) << result.DebugString();
+
+struct PipelineBenchmarkOptions {
+  // The number of threads of the runtime that runs the input pipeline. 0 uses
+  // the number of schedulable CPUs.
+  int num_threads = 0;
+
+  // The benchmark stops after producing `max_elements` elements, if positive,
+  // after `max_duration_ms` milliseconds, if positive, or at the end of the
+  // input.
+  int64 max_elements = -1;
+  int64 max_duration_ms = 10 * 1000;
+
+  // Whether to tune the AUTOTUNE parameters of the input pipeline while it
+  // runs, as `ModelDataset` does. The `ModelDataset` nodes of the graph are
+  // always removed, so that the benchmark can observe every transformation;
+  // without autotuning, AUTOTUNE parameters keep their initial values.
+  bool autotune = true;
+  model::AutotuneAlgorithm algorithm = model::AutotuneAlgorithm::HILL_CLIMB;
+  // 0 uses the number of schedulable CPUs.
+  int64 cpu_budget = 0;
+  // 0 uses half of the available RAM.
+  int64 ram_budget = 0;
+
+  // The period at which the benchmark samples the buffers of the input
+  // pipeline and, with autotuning, tunes its parameters.
+  int64 sampling_period_ms = 100;
+
+  // The CPU budgets for which to report the values that autotuning would pick
+  // for the tunable parameters given the metrics of the whole run.
+  std::vector<int64> what_if_cpu_budgets;
+};
+
+struct PipelineBenchmarkNodeStats {
+  // The metrics of the node at the end of the run.
+  model::NodeStats stats;
+
+  // The number of elements buffered by the node, averaged over the samples.
+  double average_buffered_elements = 0;
+
+  // The fraction of its buffer that the node filled, averaged over the
+  // samples, where the capacity of the buffer is the `buffer_size` parameter
+  // of the node or, if it has none, its `parallelism`. 0 for nodes without a
+  // buffer.
+  double buffer_utilization = 0;
+};
+
+struct PipelineBenchmarkResult {
+  int64 num_elements = 0;
+  double wall_time_seconds = 0;
+  double elements_per_second = 0;
+
+  // The stats of each transformation, in breadth-first order from the output
+  // of the input pipeline.
+  std::vector<PipelineBenchmarkNodeStats> node_stats;
+
+  // For each CPU budget of `what_if_cpu_budgets`, the values that autotuning
+  // would pick for the tunable parameters, by (unique) parameter name.
+  std::vector<std::pair<int64, absl::flat_hash_map<string, double>>>
+      what_if_parameters;
+
+  // Returns a human-readable report of the result.
+  string DebugString() const;
+};
+
+// Runs the input pipeline of `graph_def` according to `options`.
+Status RunPipelineBenchmark(const GraphDef& graph_def,
+                            const PipelineBenchmarkOptions& options,
+                            PipelineBenchmarkResult* result);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_PIPELINE_BENCHMARK_H_
@@ -0,0 +1,104 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks the input pipeline of a serialized dataset graph, e.g.
+//
+//   pipeline_benchmark_main --graph=/tmp/dataset.pb --num_threads=16 \
+//       --what_if_cpu_budgets=4,8,16
+//
+// Files ending in ".pbtxt" are read as text protos, other files as binary
+// protos.
+
+#include <cstdio>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/data/pipeline_benchmark.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+int main(int argc, char** argv) {
+  using tensorflow::Flag;
+  using tensorflow::int64;
+  using tensorflow::string;
+
+  string graph;
+  string algorithm = "hill_climb";
+  string what_if_cpu_budgets;
+  tensorflow::data::PipelineBenchmarkOptions options;
+  std::vector<Flag> flag_list = {
+      Flag("graph", &graph, "serialized GraphDef of the dataset"),
+      Flag("num_threads", &options.num_threads,
+           "threads of the runtime, 0 for the number of CPUs"),
+      Flag("max_elements", &options.max_elements,
+           "stop after this many elements, if positive"),
+      Flag("max_duration_ms", &options.max_duration_ms,
+           "stop after this many milliseconds, if positive"),
+      Flag("autotune", &options.autotune,
+           "whether to tune the AUTOTUNE parameters while running"),
+      Flag("algorithm", &algorithm,
+           "autotuning algorithm, hill_climb or gradient_descent"),
+      Flag("cpu_budget", &options.cpu_budget,
+           "autotuning CPU budget, 0 for the number of CPUs"),
+      Flag("ram_budget", &options.ram_budget,
+           "autotuning RAM budget in bytes, 0 for half of the available RAM"),
+      Flag("sampling_period_ms", &options.sampling_period_ms,
+           "period of the buffer samples and of the autotuning"),
+      Flag("what_if_cpu_budgets", &what_if_cpu_budgets,
+           "comma-separated CPU budgets to report autotuned parameters for"),
+  };
+  const string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  const bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (!parse_result || argc > 1 || graph.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  if (algorithm == "hill_climb") {
+    options.algorithm = tensorflow::data::model::AutotuneAlgorithm::HILL_CLIMB;
+  } else if (algorithm == "gradient_descent") {
+    options.algorithm =
+        tensorflow::data::model::AutotuneAlgorithm::GRADIENT_DESCENT;
+  } else {
+    LOG(ERROR) << "Unknown --algorithm " << algorithm << "\n" << usage;
+    return -1;
+  }
+  for (absl::string_view budget :
+       absl::StrSplit(what_if_cpu_budgets, ',', absl::SkipEmpty())) {
+    int64 cpu_budget;
+    if (!absl::SimpleAtoi(budget, &cpu_budget) || cpu_budget <= 0) {
+      LOG(ERROR) << "Invalid --what_if_cpu_budgets " << what_if_cpu_budgets;
+      return -1;
+    }
+    options.what_if_cpu_budgets.push_back(cpu_budget);
+  }
+
+  tensorflow::Env* env = tensorflow::Env::Default();
+  tensorflow::GraphDef graph_def;
+  if (absl::EndsWith(graph, ".pbtxt")) {
+    TF_CHECK_OK(tensorflow::ReadTextProto(env, graph, &graph_def));
+  } else {
+    TF_CHECK_OK(tensorflow::ReadBinaryProto(env, graph, &graph_def));
+  }
+  tensorflow::data::PipelineBenchmarkResult result;
+  TF_CHECK_OK(
+      tensorflow::data::RunPipelineBenchmark(graph_def, options, &result));
+  printf("%s", result.DebugString().c_str());
+  return 0;
+}
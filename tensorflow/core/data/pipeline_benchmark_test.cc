@@ -0,0 +1,186 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/pipeline_benchmark.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// range(1000).prefetch(AUTOTUNE) with autotuning enabled.
+constexpr const char* const kPrefetchGraphProto = R"proto(
+  node {
+    name: "start"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value { tensor { dtype: DT_INT64 tensor_shape {} int64_val: 0 } }
+    }
+  }
+  node {
+    name: "stop"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value { tensor { dtype: DT_INT64 tensor_shape {} int64_val: 1000 } }
+    }
+  }
+  node {
+    name: "step"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value { tensor { dtype: DT_INT64 tensor_shape {} int64_val: 1 } }
+    }
+  }
+  node {
+    name: "buffer_size"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value { tensor { dtype: DT_INT64 tensor_shape {} int64_val: -1 } }
+    }
+  }
+  node {
+    name: "range"
+    op: "RangeDataset"
+    input: "start"
+    input: "stop"
+    input: "step"
+    attr {
+      key: "output_shapes"
+      value { list { shape {} } }
+    }
+    attr {
+      key: "output_types"
+      value { list { type: DT_INT64 } }
+    }
+  }
+  node {
+    name: "prefetch"
+    op: "PrefetchDataset"
+    input: "range"
+    input: "buffer_size"
+    attr {
+      key: "output_shapes"
+      value { list { shape {} } }
+    }
+    attr {
+      key: "output_types"
+      value { list { type: DT_INT64 } }
+    }
+  }
+  node {
+    name: "model"
+    op: "ModelDataset"
+    input: "prefetch"
+    attr {
+      key: "output_shapes"
+      value { list { shape {} } }
+    }
+    attr {
+      key: "output_types"
+      value { list { type: DT_INT64 } }
+    }
+  }
+  node {
+    name: "dataset"
+    op: "_Retval"
+    input: "model"
+    attr {
+      key: "T"
+      value { type: DT_VARIANT }
+    }
+    attr {
+      key: "index"
+      value { i: 0 }
+    }
+  }
+  library {}
+  versions { producer: 96 }
+)proto";
+
+GraphDef PrefetchGraph() {
+  GraphDef graph_def;
+  CHECK(protobuf::TextFormat::ParseFromString(kPrefetchGraphProto, &graph_def));
+  return graph_def;
+}
+
+TEST(PipelineBenchmarkTest, RunsToEndOfInput) {
+  PipelineBenchmarkOptions options;
+  options.num_threads = 2;
+  options.max_duration_ms = 0;
+  options.sampling_period_ms = 1;
+  options.what_if_cpu_budgets = {1, 4};
+  PipelineBenchmarkResult result;
+  TF_ASSERT_OK(RunPipelineBenchmark(PrefetchGraph(), options, &result));
+
+  EXPECT_EQ(result.num_elements, 1000);
+  EXPECT_GT(result.elements_per_second, 0);
+  // The `ModelDataset` is removed, so the model sees every transformation.
+  ASSERT_EQ(result.node_stats.size(), 2);
+  EXPECT_TRUE(absl::StartsWith(result.node_stats[0].stats.name, "Prefetch"));
+  EXPECT_EQ(result.node_stats[0].stats.num_elements, 1000);
+  EXPECT_TRUE(result.node_stats[0].stats.parameters.contains("buffer_size"));
+  EXPECT_TRUE(absl::StartsWith(result.node_stats[1].stats.name, "Range"));
+  ASSERT_EQ(result.what_if_parameters.size(), 2);
+  EXPECT_EQ(result.what_if_parameters[0].first, 1);
+  EXPECT_EQ(result.what_if_parameters[1].first, 4);
+
+  const string report = result.DebugString();
+  EXPECT_TRUE(absl::StrContains(report, "Produced 1000 elements"));
+  EXPECT_TRUE(absl::StrContains(report, "Autotuned parameters for 4 CPUs"));
+}
+
+TEST(PipelineBenchmarkTest, StopsAfterMaxElements) {
+  PipelineBenchmarkOptions options;
+  options.max_elements = 10;
+  options.autotune = false;
+  PipelineBenchmarkResult result;
+  TF_ASSERT_OK(RunPipelineBenchmark(PrefetchGraph(), options, &result));
+  EXPECT_EQ(result.num_elements, 10);
+  EXPECT_TRUE(result.what_if_parameters.empty());
+}
+
+TEST(PipelineBenchmarkTest, RejectsGraphsWithoutDataset) {
+  PipelineBenchmarkResult result;
+  EXPECT_FALSE(
+      RunPipelineBenchmark(GraphDef(), PipelineBenchmarkOptions(), &result)
+          .ok());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
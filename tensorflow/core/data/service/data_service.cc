@@ -17,11 +17,13 @@ limitations under the License.
 
 #include "grpcpp/create_channel.h"
 #include "grpcpp/security/credentials.h"
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace data {
@@ -29,6 +31,17 @@ namespace data {
 namespace {
 constexpr const char kParallelEpochs[] = "parallel_epochs";
 constexpr const char kOneEpoch[] = "one_epoch";
+
+struct LocalWorkerRegistry {
+  mutex mu;
+  absl::flat_hash_map<std::string, std::shared_ptr<LocalWorker>> workers
+      TF_GUARDED_BY(mu);
+};
+
+LocalWorkerRegistry* GetLocalWorkerRegistry() {
+  static LocalWorkerRegistry* registry = new LocalWorkerRegistry;
+  return registry;
+}
 }  // namespace
 
 Status ParseProcessingMode(const std::string& s, ProcessingMode* mode) {
@@ -156,6 +169,30 @@ Status DataServiceDispatcherClient::EnsureInitialized() {
   return Status::OK();
 }
 
+void LocalWorkers::Add(const std::string& worker_address,
+                       std::shared_ptr<LocalWorker> worker) {
+  LocalWorkerRegistry* registry = GetLocalWorkerRegistry();
+  mutex_lock l(registry->mu);
+  registry->workers[worker_address] = std::move(worker);
+}
+
+std::shared_ptr<LocalWorker> LocalWorkers::Get(
+    const std::string& worker_address) {
+  LocalWorkerRegistry* registry = GetLocalWorkerRegistry();
+  mutex_lock l(registry->mu);
+  auto it = registry->workers.find(worker_address);
+  if (it == registry->workers.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+void LocalWorkers::Remove(const std::string& worker_address) {
+  LocalWorkerRegistry* registry = GetLocalWorkerRegistry();
+  mutex_lock l(registry->mu);
+  registry->workers.erase(worker_address);
+}
+
 Status DataServiceWorkerClient::GetElement(int64 task_id,
                                            CompressedElement* element,
                                            bool* end_of_sequence) {
@@ -163,10 +200,14 @@ Status DataServiceWorkerClient::GetElement(int64 task_id,
   GetElementRequest req;
   req.set_task_id(task_id);
   GetElementResponse resp;
-  grpc_impl::ClientContext ctx;
-  grpc::Status s = stub_->GetElement(&ctx, req, &resp);
-  if (!s.ok()) {
-    return grpc_util::WrapError("Failed to get element", s);
+  if (local_worker_ != nullptr) {
+    TF_RETURN_IF_ERROR(local_worker_->GetElement(&req, &resp));
+  } else {
+    grpc_impl::ClientContext ctx;
+    grpc::Status s = stub_->GetElement(&ctx, req, &resp);
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get element", s);
+    }
   }
   *end_of_sequence = resp.end_of_sequence();
   if (!*end_of_sequence) {
@@ -176,6 +217,14 @@ Status DataServiceWorkerClient::GetElement(int64 task_id,
 }
 
 Status DataServiceWorkerClient::EnsureInitialized() {
+  if (stub_ != nullptr || local_worker_ != nullptr) {
+    return Status::OK();
+  }
+  local_worker_ = LocalWorkers::Get(address_);
+  if (local_worker_ != nullptr) {
+    VLOG(2) << "Reading from worker " << address_ << " in process";
+    return Status::OK();
+  }
   std::shared_ptr<grpc::ChannelCredentials> credentials;
   TF_RETURN_IF_ERROR(
       CredentialsFactory::CreateClientCredentials(protocol_, &credentials));
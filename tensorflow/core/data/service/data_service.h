@@ -107,7 +107,30 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   std::unique_ptr<DispatcherService::Stub> stub_;
 };
 
-// Client for communicating with the tf.data service worker.
+// A tf.data service worker which clients running in the same process can call
+// directly, skipping gRPC and the serialization of elements.
+class LocalWorker {
+ public:
+  virtual ~LocalWorker() = default;
+
+  virtual Status GetElement(const GetElementRequest* request,
+                            GetElementResponse* response) = 0;
+};
+
+// Registry of the tf.data service workers running in this process, keyed by
+// the addresses they register with the dispatcher.
+class LocalWorkers {
+ public:
+  static void Add(const std::string& worker_address,
+                  std::shared_ptr<LocalWorker> worker);
+  // Returns the worker with the given address, or nullptr if it does not run in
+  // this process.
+  static std::shared_ptr<LocalWorker> Get(const std::string& worker_address);
+  static void Remove(const std::string& worker_address);
+};
+
+// Client for communicating with the tf.data service worker. If the worker runs
+// in the same process, the client calls it directly instead of over gRPC.
 class DataServiceWorkerClient : public DataServiceClientBase {
  public:
   DataServiceWorkerClient(const std::string& address,
@@ -125,6 +148,8 @@ class DataServiceWorkerClient : public DataServiceClientBase {
 
  private:
   std::unique_ptr<WorkerService::Stub> stub_;
+  // Set instead of `stub_` when the worker runs in this process.
+  std::shared_ptr<LocalWorker> local_worker_;
 };
 
 // Creates and initializes a new tf.data service dispatcher client.
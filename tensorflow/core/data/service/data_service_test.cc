@@ -73,5 +73,21 @@ TEST(DataService, GetWorkers) {
   EXPECT_EQ(1, workers.size());
 }
 
+TEST(DataService, LocalWorkers) {
+  std::string worker_address;
+  {
+    TestCluster cluster(1);
+    TF_ASSERT_OK(cluster.Initialize());
+    DataServiceDispatcherClient dispatcher(cluster.DispatcherAddress(),
+                                           kProtocol);
+    std::vector<WorkerInfo> workers;
+    TF_ASSERT_OK(dispatcher.GetWorkers(&workers));
+    ASSERT_EQ(1, workers.size());
+    worker_address = workers[0].address();
+    EXPECT_NE(LocalWorkers::Get(worker_address), nullptr);
+  }
+  EXPECT_EQ(LocalWorkers::Get(worker_address), nullptr);
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/dispatcher_impl.h"
 
+#include <algorithm>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/journal.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -45,6 +47,13 @@ namespace data {
 namespace {
 // The name of the journal directory inside the dispatcher's working directory.
 constexpr char kJournalDir[] = "tf_data_dispatcher_journal";
+// The default number of journaled updates between snapshots of the
+// dispatcher state.
+constexpr int64 kDefaultJournalSnapshotInterval = 10000;
+// The number of splits per registered worker that ONE_EPOCH jobs divide their
+// dataset into. Having more splits than workers lets faster workers pick up
+// the splits that slower workers would otherwise be left with.
+constexpr int64 kSplitsPerWorker = 4;
 
 using Dataset = DispatcherState::Dataset;
 using Worker = DispatcherState::Worker;
@@ -89,6 +98,8 @@ Status DataServiceDispatcherImpl::Start() {
       Env::Default(), JournalDir(config_.work_dir()));
   LOG(INFO) << "Restoring dispatcher state from journal in "
             << JournalDir(config_.work_dir());
+  const uint64 start_us = Env::Default()->NowMicros();
+  int64 num_updates = 0;
   Update update;
   bool end_of_journal = false;
   FileJournalReader reader(Env::Default(), JournalDir(config_.work_dir()));
@@ -100,12 +111,20 @@ Status DataServiceDispatcherImpl::Start() {
   } else {
     while (!end_of_journal) {
       TF_RETURN_IF_ERROR(ApplyWithoutJournaling(update));
+      ++num_updates;
       TF_RETURN_IF_ERROR(reader.Read(&update, &end_of_journal));
     }
   }
+  const uint64 duration_us = Env::Default()->NowMicros() - start_us;
+  metrics::RecordTFDataServiceDispatcherRecovery(duration_us, num_updates);
+  LOG(INFO) << "Restored dispatcher state from " << num_updates
+            << " journal updates in " << duration_us / 1000 << " ms.";
   // Initialize the journal writer in `Start` so that we fail fast in case it
   // can't be initialized.
   TF_RETURN_IF_ERROR(journal_writer_.value()->EnsureInitialized());
+  // Start the next restart from a snapshot if this one replayed many updates.
+  updates_since_snapshot_ = num_updates;
+  MaybeSnapshotJournal();
   return Status::OK();
 }
 
@@ -126,7 +145,12 @@ Status DataServiceDispatcherImpl::RegisterWorker(
 
   absl::flat_hash_map<int64, std::shared_ptr<const Task>> tasks_by_job;
   for (const auto& task : tasks) {
-    // Should never have multiple tasks on the same worker for the same job.
+    if (task->finished) {
+      // Jobs with splits keep the finished tasks of earlier splits around.
+      continue;
+    }
+    // Should never have multiple unfinished tasks on the same worker for the
+    // same job.
     auto& task_for_job = tasks_by_job[task->job_id];
     DCHECK(task_for_job == nullptr);
     task_for_job = task;
@@ -142,6 +166,9 @@ Status DataServiceDispatcherImpl::RegisterWorker(
     auto it = tasks_by_job.find(job->job_id);
     if (it != tasks_by_job.end()) {
       task = it->second;
+    } else if (job->num_splits > 0 && !job->HasUnassignedSplits()) {
+      // All splits are already being processed by other workers.
+      continue;
     } else {
       TF_RETURN_IF_ERROR(CreateTask(job, worker_address, &task));
     }
@@ -152,6 +179,10 @@ Status DataServiceDispatcherImpl::RegisterWorker(
     task_def->set_dataset_id(job->dataset_id);
     task_def->set_job_id(job->job_id);
     task_def->set_task_id(task->task_id);
+    if (job->num_splits > 0) {
+      task_def->set_num_splits(job->num_splits);
+      task_def->set_split_index(task->split_index);
+    }
   }
 
   VLOG(1) << "Registered worker at address " << request->worker_address();
@@ -160,25 +191,37 @@ Status DataServiceDispatcherImpl::RegisterWorker(
 
 Status DataServiceDispatcherImpl::WorkerUpdate(
     const WorkerUpdateRequest* request, WorkerUpdateResponse* response) {
-  mutex_lock l(mu_);
-  for (auto& update : request->updates()) {
-    int64 task_id = update.task_id();
-    std::shared_ptr<const Task> task;
-    TF_RETURN_IF_ERROR(state_.TaskFromId(task_id, &task));
-    if (update.completed()) {
-      if (task->finished) {
-        VLOG(1) << "Received completion update for already-finished task "
-                << task->task_id << " on worker " << task->worker_address;
-        continue;
+  std::vector<std::shared_ptr<const Task>> new_tasks;
+  {
+    mutex_lock l(mu_);
+    for (auto& update : request->updates()) {
+      int64 task_id = update.task_id();
+      std::shared_ptr<const Task> task;
+      TF_RETURN_IF_ERROR(state_.TaskFromId(task_id, &task));
+      if (update.completed()) {
+        if (task->finished) {
+          VLOG(1) << "Received completion update for already-finished task "
+                  << task->task_id << " on worker " << task->worker_address;
+          continue;
+        }
+        Update update;
+        update.mutable_finish_task()->set_task_id(task_id);
+        TF_RETURN_IF_ERROR(Apply(update));
+        VLOG(3) << "Task " << task_id << " from job " << task->job_id
+                << " completed";
+        // Hand the worker the next split of the job, if there is one left.
+        std::shared_ptr<const Job> job;
+        TF_RETURN_IF_ERROR(state_.JobFromId(task->job_id, &job));
+        if (job->HasUnassignedSplits()) {
+          std::shared_ptr<const Task> new_task;
+          TF_RETURN_IF_ERROR(
+              CreateTask(job, request->worker_address(), &new_task));
+          new_tasks.push_back(new_task);
+        }
       }
-      Update update;
-      update.mutable_finish_task()->set_task_id(task_id);
-      TF_RETURN_IF_ERROR(Apply(update));
-      VLOG(3) << "Task " << task_id << " from job " << task->job_id
-              << " completed";
     }
   }
-  return Status::OK();
+  return AssignTasks(new_tasks);
 }
 
 Status DataServiceDispatcherImpl::GetOrRegisterDataset(
@@ -303,13 +346,14 @@ Status DataServiceDispatcherImpl::CreateJob(
     int64 dataset_id, ProcessingMode processing_mode,
     absl::optional<NamedJobKey> named_job_key, std::shared_ptr<const Job>* job)
     EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  int64 num_splits = 0;
   switch (processing_mode) {
     case ProcessingMode::PARALLEL_EPOCHS:
       break;
     case ProcessingMode::ONE_EPOCH:
-      return errors::Unimplemented(
-          "CreateJob only supports the PARALLEL_EPOCHS job mode. "
-          "ONE_EPOCH is not currently supported.");
+      num_splits = kSplitsPerWorker *
+                   std::max<int64>(1, state_.ListWorkers().size());
+      break;
     default:
       return errors::Unimplemented("ProcessingMode ",
                                    ProcessingModeToString(processing_mode),
@@ -321,6 +365,7 @@ Status DataServiceDispatcherImpl::CreateJob(
   create_job->set_job_id(job_id);
   create_job->set_dataset_id(dataset_id);
   create_job->set_processing_mode(ProcessingModeDef(processing_mode));
+  create_job->set_num_splits(num_splits);
   if (named_job_key.has_value()) {
     NamedJobKeyDef* key = create_job->mutable_named_job_key();
     key->set_name(named_job_key->name);
@@ -339,6 +384,9 @@ Status DataServiceDispatcherImpl::CreateTasksForJob(
   tasks->clear();
   tasks->reserve(workers.size());
   for (const auto& worker : workers) {
+    if (job->num_splits > 0 && !job->HasUnassignedSplits()) {
+      break;
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(job, worker->address, &task));
     tasks->push_back(task);
@@ -357,6 +405,9 @@ Status DataServiceDispatcherImpl::CreateTask(std::shared_ptr<const Job> job,
   create_task->set_job_id(job->job_id);
   create_task->set_dataset_id(job->dataset_id);
   create_task->set_worker_address(worker_address);
+  if (job->num_splits > 0) {
+    create_task->set_split_index(job->next_split);
+  }
   TF_RETURN_IF_ERROR(Apply(update));
   TF_RETURN_IF_ERROR(state_.TaskFromId(task_id, task));
   return Status::OK();
@@ -407,6 +458,12 @@ Status DataServiceDispatcherImpl::AssignTask(std::shared_ptr<const Task> task)
     std::shared_ptr<const Dataset> dataset;
     TF_RETURN_IF_ERROR(state_.DatasetFromId(task->dataset_id, &dataset));
     *task_def->mutable_dataset() = dataset->dataset_def;
+    std::shared_ptr<const Job> job;
+    TF_RETURN_IF_ERROR(state_.JobFromId(task->job_id, &job));
+    if (job->num_splits > 0) {
+      task_def->set_num_splits(job->num_splits);
+      task_def->set_split_index(task->split_index);
+    }
   }
   task_def->set_task_id(task->task_id);
   ProcessTaskResponse resp;
@@ -427,14 +484,18 @@ Status DataServiceDispatcherImpl::GetTasks(const GetTasksRequest* request,
   VLOG(3) << "Looking up tasks for job id " << request->job_id();
   std::vector<std::shared_ptr<const Task>> tasks;
   TF_RETURN_IF_ERROR(state_.TasksForJob(request->job_id(), &tasks));
+  std::shared_ptr<const Job> job;
+  TF_RETURN_IF_ERROR(state_.JobFromId(request->job_id(), &job));
   for (const auto& task : tasks) {
+    if (job->num_splits > 0 && task->finished) {
+      // Finished splits have nothing left to read.
+      continue;
+    }
     TaskInfo* task_info = response->mutable_task_info()->Add();
     task_info->set_worker_address(task->worker_address);
     task_info->set_task_id(task->task_id);
     task_info->set_job_id(task->job_id);
   }
-  std::shared_ptr<const Job> job;
-  TF_RETURN_IF_ERROR(state_.JobFromId(request->job_id(), &job));
   response->set_job_finished(job->finished);
   VLOG(3) << "Found " << response->task_info_size() << " tasks for job id "
           << request->job_id();
@@ -465,7 +526,28 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
   if (journal_writer_.has_value()) {
     TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
   }
-  return state_.Apply(update);
+  TF_RETURN_IF_ERROR(state_.Apply(update));
+  if (journal_writer_.has_value()) {
+    ++updates_since_snapshot_;
+    MaybeSnapshotJournal();
+  }
+  return Status::OK();
+}
+
+void DataServiceDispatcherImpl::MaybeSnapshotJournal()
+    EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64 interval = config_.journal_snapshot_interval() > 0
+                             ? config_.journal_snapshot_interval()
+                             : kDefaultJournalSnapshotInterval;
+  if (updates_since_snapshot_ < interval) {
+    return;
+  }
+  // The journal stays complete if the snapshot fails, so keep serving.
+  Status s = journal_writer_.value()->WriteSnapshot(state_.Snapshot());
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to snapshot the dispatcher state: " << s;
+  }
+  updates_since_snapshot_ = 0;
 }
 
 }  // namespace data
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/dispatcher_state.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/data/service/journal.h"
 #include "tensorflow/core/data/service/journal.pb.h"
@@ -79,7 +81,7 @@ void DispatcherState::CreateJob(const CreateJobUpdate& create_job) {
   }
   auto job = std::make_shared<Job>(job_id, create_job.dataset_id(),
                                    ProcessingMode(create_job.processing_mode()),
-                                   named_job_key);
+                                   named_job_key, create_job.num_splits());
   DCHECK(!jobs_.contains(job_id));
   jobs_[job_id] = job;
   tasks_by_job_[job_id] = std::vector<std::shared_ptr<Task>>();
@@ -96,7 +98,13 @@ void DispatcherState::CreateTask(const CreateTaskUpdate& create_task) {
   DCHECK_EQ(task, nullptr);
   task = std::make_shared<Task>(task_id, create_task.job_id(),
                                 create_task.dataset_id(),
-                                create_task.worker_address());
+                                create_task.worker_address(),
+                                create_task.split_index());
+  auto& job = jobs_[create_task.job_id()];
+  DCHECK(job != nullptr);
+  if (job->num_splits > 0) {
+    job->next_split = std::max(job->next_split, create_task.split_index() + 1);
+  }
   tasks_by_job_[create_task.job_id()].push_back(task);
   tasks_by_worker_[create_task.worker_address()].push_back(task);
   next_available_task_id_ = std::max(next_available_task_id_, task_id + 1);
@@ -108,7 +116,9 @@ void DispatcherState::FinishTask(const FinishTaskUpdate& finish_task) {
   auto& task = tasks_[task_id];
   DCHECK(task != nullptr);
   task->finished = true;
-  bool all_finished = true;
+  // A job with splits left to hand out is not finished, even if all of its
+  // current tasks are.
+  bool all_finished = !jobs_[task->job_id]->HasUnassignedSplits();
   for (const auto& task_for_job : tasks_by_job_[task->job_id]) {
     if (!task_for_job->finished) {
       all_finished = false;
@@ -118,6 +128,82 @@ void DispatcherState::FinishTask(const FinishTaskUpdate& finish_task) {
   jobs_[task->job_id]->finished = all_finished;
 }
 
+std::vector<Update> DispatcherState::Snapshot() const {
+  std::vector<Update> updates;
+  std::vector<std::shared_ptr<Dataset>> datasets;
+  for (const auto& it : datasets_by_id_) {
+    datasets.push_back(it.second);
+  }
+  std::sort(datasets.begin(), datasets.end(),
+            [](const std::shared_ptr<Dataset>& a,
+               const std::shared_ptr<Dataset>& b) {
+              return a->dataset_id < b->dataset_id;
+            });
+  for (const auto& dataset : datasets) {
+    Update update;
+    RegisterDatasetUpdate* register_dataset = update.mutable_register_dataset();
+    register_dataset->set_dataset_id(dataset->dataset_id);
+    register_dataset->set_fingerprint(dataset->fingerprint);
+    *register_dataset->mutable_dataset_def() = dataset->dataset_def;
+    updates.push_back(std::move(update));
+  }
+  for (const auto& it : workers_) {
+    Update update;
+    update.mutable_register_worker()->set_worker_address(it.first);
+    updates.push_back(std::move(update));
+  }
+  std::vector<std::shared_ptr<Job>> jobs;
+  for (const auto& it : jobs_) {
+    jobs.push_back(it.second);
+  }
+  std::sort(jobs.begin(), jobs.end(),
+            [](const std::shared_ptr<Job>& a, const std::shared_ptr<Job>& b) {
+              return a->job_id < b->job_id;
+            });
+  for (const auto& job : jobs) {
+    Update update;
+    CreateJobUpdate* create_job = update.mutable_create_job();
+    create_job->set_job_id(job->job_id);
+    create_job->set_dataset_id(job->dataset_id);
+    create_job->set_processing_mode(ProcessingModeDef(job->processing_mode));
+    if (job->named_job_key.has_value()) {
+      NamedJobKeyDef* key = create_job->mutable_named_job_key();
+      key->set_name(job->named_job_key->name);
+      key->set_index(job->named_job_key->index);
+    }
+    create_job->set_num_splits(job->num_splits);
+    updates.push_back(std::move(update));
+  }
+  std::vector<std::shared_ptr<Task>> tasks;
+  for (const auto& it : tasks_) {
+    tasks.push_back(it.second);
+  }
+  std::sort(tasks.begin(), tasks.end(),
+            [](const std::shared_ptr<Task>& a, const std::shared_ptr<Task>& b) {
+              return a->task_id < b->task_id;
+            });
+  for (const auto& task : tasks) {
+    Update update;
+    CreateTaskUpdate* create_task = update.mutable_create_task();
+    create_task->set_task_id(task->task_id);
+    create_task->set_job_id(task->job_id);
+    create_task->set_dataset_id(task->dataset_id);
+    create_task->set_worker_address(task->worker_address);
+    create_task->set_split_index(task->split_index);
+    updates.push_back(std::move(update));
+  }
+  // Tasks are only created for unfinished jobs, so finishing the tasks after
+  // creating all of them finishes the same jobs.
+  for (const auto& task : tasks) {
+    if (task->finished) {
+      Update update;
+      update.mutable_finish_task()->set_task_id(task->task_id);
+      updates.push_back(std::move(update));
+    }
+  }
+  return updates;
+}
+
 int64 DispatcherState::NextAvailableDatasetId() const {
   return next_available_dataset_id_;
 }
@@ -58,6 +58,10 @@ class DispatcherState {
   // Applies the given update to the dispatcher's state.
   Status Apply(Update update);
 
+  // Returns updates which, applied to an empty state, rebuild the current
+  // state. Used to snapshot the state instead of replaying its whole journal.
+  std::vector<Update> Snapshot() const;
+
   // A dataset registered with the dispatcher.
   struct Dataset {
     explicit Dataset(int64 dataset_id, int64 fingerprint,
@@ -100,31 +104,45 @@ class DispatcherState {
   // A job for processing a dataset.
   struct Job {
     explicit Job(int64 job_id, int64 dataset_id, ProcessingMode processing_mode,
-                 absl::optional<NamedJobKey> named_job_key)
+                 absl::optional<NamedJobKey> named_job_key, int64 num_splits)
         : job_id(job_id),
           dataset_id(dataset_id),
           processing_mode(processing_mode),
-          named_job_key(named_job_key) {}
+          named_job_key(named_job_key),
+          num_splits(num_splits) {}
+
+    // Returns whether the job still has splits which no task has been created
+    // for.
+    bool HasUnassignedSplits() const { return next_split < num_splits; }
 
     const int64 job_id;
     const int64 dataset_id;
     const ProcessingMode processing_mode;
     const absl::optional<NamedJobKey> named_job_key;
+    // The number of splits the dataset is divided into, or 0 if the job is not
+    // split. Splits are handed out to workers one at a time, each as a task of
+    // its own, so that faster workers end up processing more splits.
+    const int64 num_splits;
+    // The index of the next split to hand out.
+    int64 next_split = 0;
     bool finished = false;
   };
 
   struct Task {
     explicit Task(int64 task_id, int64 job_id, int64 dataset_id,
-                  const std::string& worker_address)
+                  const std::string& worker_address, int64 split_index)
         : task_id(task_id),
           job_id(job_id),
           dataset_id(dataset_id),
-          worker_address(worker_address) {}
+          worker_address(worker_address),
+          split_index(split_index) {}
 
     const int64 task_id;
     const int64 job_id;
     const int64 dataset_id;
     const std::string worker_address;
+    // The split processed by the task. Only meaningful for jobs with splits.
+    const int64 split_index;
     bool finished = false;
   };
 
@@ -90,6 +90,32 @@ Status CreateTask(int64 task_id, int64 job_id, int64 dataset_id,
   return Status::OK();
 }
 
+Status CreateSplitJob(int64 job_id, int64 dataset_id, int64 num_splits,
+                      DispatcherState* state) {
+  Update update;
+  CreateJobUpdate* create_job = update.mutable_create_job();
+  create_job->set_job_id(job_id);
+  create_job->set_dataset_id(dataset_id);
+  create_job->set_processing_mode(ProcessingModeDef::ONE_EPOCH);
+  create_job->set_num_splits(num_splits);
+  TF_RETURN_IF_ERROR(state->Apply(update));
+  return Status::OK();
+}
+
+Status CreateSplitTask(int64 task_id, int64 job_id, int64 dataset_id,
+                       const std::string& worker_address, int64 split_index,
+                       DispatcherState* state) {
+  Update update;
+  CreateTaskUpdate* create_task = update.mutable_create_task();
+  create_task->set_task_id(task_id);
+  create_task->set_job_id(job_id);
+  create_task->set_dataset_id(dataset_id);
+  create_task->set_worker_address(worker_address);
+  create_task->set_split_index(split_index);
+  TF_RETURN_IF_ERROR(state->Apply(update));
+  return Status::OK();
+}
+
 Status FinishTask(int64 task_id, DispatcherState* state) {
   Update update;
   FinishTaskUpdate* finish_task = update.mutable_finish_task();
@@ -397,5 +423,81 @@ TEST(DispatcherState, FinishMultiTaskJob) {
   }
 }
 
+TEST(DispatcherState, FinishSplitJob) {
+  int64 job_id = 3;
+  int64 dataset_id = 10;
+  std::string worker_address = "test_worker_address";
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDatasetWithIdAndFingerprint(dataset_id, 1, &state));
+  TF_EXPECT_OK(CreateSplitJob(job_id, dataset_id, /*num_splits=*/2, &state));
+  std::shared_ptr<const Job> job;
+  TF_EXPECT_OK(state.JobFromId(job_id, &job));
+  EXPECT_EQ(job->num_splits, 2);
+  EXPECT_TRUE(job->HasUnassignedSplits());
+
+  TF_EXPECT_OK(CreateSplitTask(/*task_id=*/4, job_id, dataset_id,
+                               worker_address, /*split_index=*/0, &state));
+  EXPECT_EQ(job->next_split, 1);
+  // The job isn't finished while there are splits left to hand out.
+  TF_EXPECT_OK(FinishTask(4, &state));
+  EXPECT_FALSE(job->finished);
+
+  TF_EXPECT_OK(CreateSplitTask(/*task_id=*/5, job_id, dataset_id,
+                               worker_address, /*split_index=*/1, &state));
+  EXPECT_FALSE(job->HasUnassignedSplits());
+  std::shared_ptr<const Task> task;
+  TF_EXPECT_OK(state.TaskFromId(5, &task));
+  EXPECT_EQ(task->split_index, 1);
+  TF_EXPECT_OK(FinishTask(5, &state));
+  EXPECT_TRUE(job->finished);
+}
+
+TEST(DispatcherState, Snapshot) {
+  int64 dataset_id = 10;
+  std::string worker_address = "test_worker_address";
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDatasetWithIdAndFingerprint(dataset_id, 1, &state));
+  TF_EXPECT_OK(RegisterWorker(worker_address, &state));
+  TF_EXPECT_OK(CreateNamedJob(/*job_id=*/3, dataset_id,
+                              NamedJobKey("named", 1), &state));
+  TF_EXPECT_OK(CreateSplitJob(/*job_id=*/4, dataset_id, /*num_splits=*/3,
+                              &state));
+  TF_EXPECT_OK(CreateTask(/*task_id=*/5, /*job_id=*/3, dataset_id,
+                          worker_address, &state));
+  TF_EXPECT_OK(CreateSplitTask(/*task_id=*/6, /*job_id=*/4, dataset_id,
+                               worker_address, /*split_index=*/0, &state));
+  TF_EXPECT_OK(FinishTask(6, &state));
+  TF_EXPECT_OK(CreateSplitTask(/*task_id=*/7, /*job_id=*/4, dataset_id,
+                               worker_address, /*split_index=*/1, &state));
+  TF_EXPECT_OK(FinishTask(5, &state));
+
+  DispatcherState restored;
+  for (const Update& update : state.Snapshot()) {
+    TF_EXPECT_OK(restored.Apply(update));
+  }
+  EXPECT_EQ(restored.NextAvailableDatasetId(), state.NextAvailableDatasetId());
+  EXPECT_EQ(restored.NextAvailableJobId(), state.NextAvailableJobId());
+  EXPECT_EQ(restored.NextAvailableTaskId(), state.NextAvailableTaskId());
+  std::shared_ptr<const Dataset> dataset;
+  TF_EXPECT_OK(restored.DatasetFromFingerprint(1, &dataset));
+  EXPECT_EQ(dataset->dataset_id, dataset_id);
+  EXPECT_THAT(restored.ListWorkers(), SizeIs(1));
+  std::shared_ptr<const Job> job;
+  TF_EXPECT_OK(restored.NamedJobByKey(NamedJobKey("named", 1), &job));
+  EXPECT_EQ(job->job_id, 3);
+  EXPECT_TRUE(job->finished);
+  TF_EXPECT_OK(restored.JobFromId(4, &job));
+  EXPECT_EQ(job->processing_mode, ProcessingMode::ONE_EPOCH);
+  EXPECT_EQ(job->next_split, 2);
+  EXPECT_FALSE(job->finished);
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_EXPECT_OK(restored.TasksForWorker(worker_address, tasks));
+  ASSERT_THAT(tasks, SizeIs(3));
+  EXPECT_TRUE(tasks[0]->finished);
+  EXPECT_TRUE(tasks[1]->finished);
+  EXPECT_FALSE(tasks[2]->finished);
+  EXPECT_EQ(tasks[2]->split_index, 1);
+}
+
 }  // namespace data
 }  // namespace tensorflow
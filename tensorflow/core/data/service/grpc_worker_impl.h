@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_GRPC_WORKER_IMPL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_GRPC_WORKER_IMPL_H_
 
+#include <memory>
+#include <string>
+
 #include "grpcpp/server_builder.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/service/worker_impl.h"
@@ -37,7 +40,7 @@ class GrpcWorkerImpl : public WorkerService::Service {
  public:
   explicit GrpcWorkerImpl(grpc::ServerBuilder* server_builder,
                           const experimental::WorkerConfig& config);
-  ~GrpcWorkerImpl() override {}
+  ~GrpcWorkerImpl() override;
 
   Status Start(const std::string& worker_address);
 
@@ -50,7 +53,10 @@ class GrpcWorkerImpl : public WorkerService::Service {
 #undef HANDLER
 
  private:
-  DataServiceWorkerImpl impl_;
+  // Shared with the clients in this process which read from the worker
+  // directly.
+  std::shared_ptr<DataServiceWorkerImpl> impl_;
+  std::string worker_address_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcWorkerImpl);
 };
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/journal.h"
 
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
@@ -29,6 +30,9 @@ namespace data {
 
 namespace {
 constexpr StringPiece kJournal = "journal";
+constexpr StringPiece kSnapshot = "snapshot";
+// Suffix of snapshot files which are not completely written yet.
+constexpr StringPiece kTemporarySuffix = ".tmp";
 
 Status ParseSequenceNumber(const std::string& journal_file,
                            int64* sequence_number) {
@@ -38,6 +42,29 @@ Status ParseSequenceNumber(const std::string& journal_file,
   }
   return Status::OK();
 }
+
+// Sets the sequence numbers of the latest journal file and snapshot in
+// `journal_dir`, or -1 if there are none.
+Status LatestSequenceNumbers(Env* env, const std::string& journal_dir,
+                             int64* latest_journal, int64* latest_snapshot) {
+  std::vector<std::string> files;
+  TF_RETURN_IF_ERROR(env->GetChildren(journal_dir, &files));
+  *latest_journal = -1;
+  *latest_snapshot = -1;
+  for (const auto& file : files) {
+    if (absl::EndsWith(file, kTemporarySuffix)) {
+      continue;
+    }
+    int64 sequence_number;
+    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
+    if (absl::StartsWith(file, kSnapshot)) {
+      *latest_snapshot = std::max(*latest_snapshot, sequence_number);
+    } else {
+      *latest_journal = std::max(*latest_journal, sequence_number);
+    }
+  }
+  return Status::OK();
+}
 }  // namespace
 
 std::string DataServiceJournalFile(const std::string& journal_dir,
@@ -46,6 +73,12 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
                       absl::StrCat(kJournal, "_", sequence_number));
 }
 
+std::string DataServiceJournalSnapshotFile(const std::string& journal_dir,
+                                           int64 sequence_number) {
+  return io::JoinPath(journal_dir,
+                      absl::StrCat(kSnapshot, "_", sequence_number));
+}
+
 FileJournalWriter::FileJournalWriter(Env* env, const std::string& journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -53,19 +86,20 @@ Status FileJournalWriter::EnsureInitialized() {
   if (writer_) {
     return Status::OK();
   }
-  std::vector<std::string> journal_files;
   TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(journal_dir_));
-  TF_RETURN_IF_ERROR(env_->GetChildren(journal_dir_, &journal_files));
-  int64 latest_sequence_number = -1;
-  for (const auto& file : journal_files) {
-    int64 sequence_number;
-    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
-    latest_sequence_number = std::max(latest_sequence_number, sequence_number);
-  }
+  int64 latest_journal, latest_snapshot;
+  TF_RETURN_IF_ERROR(LatestSequenceNumbers(env_, journal_dir_, &latest_journal,
+                                           &latest_snapshot));
+  // The journal after the latest snapshot may not have been created yet.
+  return OpenJournalFile(std::max(latest_journal + 1, latest_snapshot));
+}
+
+Status FileJournalWriter::OpenJournalFile(int64 sequence_number) {
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
   writer_ = absl::make_unique<io::RecordWriter>(file_.get());
+  sequence_number_ = sequence_number;
   VLOG(1) << "Created journal writer to write to " << journal_file;
   return Status::OK();
 }
@@ -86,6 +120,62 @@ Status FileJournalWriter::Write(const Update& update) {
   return Status::OK();
 }
 
+Status FileJournalWriter::WriteSnapshot(const std::vector<Update>& state) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  const int64 sequence_number = sequence_number_ + 1;
+  const std::string snapshot_file =
+      DataServiceJournalSnapshotFile(journal_dir_, sequence_number);
+  // Readers only see the snapshot once it is complete.
+  const std::string temporary_file =
+      absl::StrCat(snapshot_file, kTemporarySuffix);
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(temporary_file, &file));
+    io::RecordWriter writer(file.get());
+    for (const auto& update : state) {
+      std::string s = update.SerializeAsString();
+      if (s.empty()) {
+        return errors::Internal("Failed to serialize update ",
+                                update.DebugString(), " to string");
+      }
+      TF_RETURN_IF_ERROR(writer.WriteRecord(s));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Sync());
+    TF_RETURN_IF_ERROR(file->Close());
+  }
+  TF_RETURN_IF_ERROR(env_->RenameFile(temporary_file, snapshot_file));
+
+  // The updates written to the current journal file are in the snapshot.
+  writer_.reset();
+  file_.reset();
+  TF_RETURN_IF_ERROR(OpenJournalFile(sequence_number));
+  VLOG(1) << "Wrote journal snapshot " << snapshot_file << " with "
+          << state.size() << " updates";
+  DeleteFilesBefore(sequence_number);
+  return Status::OK();
+}
+
+void FileJournalWriter::DeleteFilesBefore(int64 sequence_number) {
+  std::vector<std::string> files;
+  Status s = env_->GetChildren(journal_dir_, &files);
+  for (const auto& file : files) {
+    int64 file_sequence_number;
+    if (!ParseSequenceNumber(file, &file_sequence_number).ok() ||
+        file_sequence_number >= sequence_number) {
+      continue;
+    }
+    Status delete_status = env_->DeleteFile(io::JoinPath(journal_dir_, file));
+    if (!delete_status.ok()) {
+      s.Update(delete_status);
+    }
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete journal files before snapshot "
+                 << sequence_number << ": " << s;
+  }
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -93,7 +183,16 @@ Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return Status::OK();
   }
-  return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
+  int64 latest_journal, latest_snapshot;
+  TF_RETURN_IF_ERROR(LatestSequenceNumbers(env_, journal_dir_, &latest_journal,
+                                           &latest_snapshot));
+  if (latest_snapshot < 0) {
+    return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
+  }
+  sequence_number_ = latest_snapshot;
+  reading_snapshot_ = true;
+  return UpdateFile(
+      DataServiceJournalSnapshotFile(journal_dir_, latest_snapshot));
 }
 
 Status FileJournalReader::Read(Update* update, bool* end_of_journal) {
@@ -102,7 +201,13 @@ Status FileJournalReader::Read(Update* update, bool* end_of_journal) {
     tstring record;
     Status s = reader_->ReadRecord(&offset_, &record);
     if (errors::IsOutOfRange(s)) {
-      sequence_number_++;
+      // The journal continues after a snapshot with the file of the same
+      // sequence number.
+      if (reading_snapshot_) {
+        reading_snapshot_ = false;
+      } else {
+        sequence_number_++;
+      }
       std::string next_journal_file =
           DataServiceJournalFile(journal_dir_, sequence_number_);
       if (errors::IsNotFound(env_->FileExists(next_journal_file))) {
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 
+#include <vector>
+
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
@@ -28,12 +30,21 @@ namespace data {
 std::string DataServiceJournalFile(const std::string& journal_dir,
                                    int64 sequence_number);
 
+// Returns the location of the snapshot file within the journal directory.
+std::string DataServiceJournalSnapshotFile(const std::string& journal_dir,
+                                           int64 sequence_number);
+
 // Interface for writing to a journal.
 class JournalWriter {
  public:
   virtual ~JournalWriter() = default;
   // Writes and syncs an update to the journal.
   virtual Status Write(const Update& update) = 0;
+  // Writes and syncs a snapshot of the state built by the updates written so
+  // far, as the updates which rebuild it from an empty state. Reading the
+  // journal then starts from the snapshot, and the journal before the
+  // snapshot may be deleted.
+  virtual Status WriteSnapshot(const std::vector<Update>& state) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
 };
@@ -54,6 +65,11 @@ class JournalWriter {
 // "journal_0", "journal_1", and "journal_2", the writer will write to
 // "journal_3". The writer will flush updates as they are written, so that they
 // can be stored durably in case of machine failure.
+//
+// Writing a snapshot while writing to "journal_3" writes "snapshot_4", which
+// holds the state built by journal files 0 to 3, and continues the journal in
+// "journal_4". Once the snapshot is durable, the journal and snapshot files
+// before it are deleted.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -64,11 +80,19 @@ class FileJournalWriter : public JournalWriter {
   FileJournalWriter& operator=(const FileJournalWriter&) = delete;
 
   Status Write(const Update& update) override;
+  Status WriteSnapshot(const std::vector<Update>& state) override;
   Status EnsureInitialized() override;
 
  private:
+  // Starts writing to the journal file with the given sequence number.
+  Status OpenJournalFile(int64 sequence_number);
+  // Deletes the journal and snapshot files before the given sequence number.
+  void DeleteFilesBefore(int64 sequence_number);
+
   Env* env_;
   const std::string journal_dir_;
+  // Sequence number of the current journal file.
+  int64 sequence_number_ = 0;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
@@ -85,8 +109,9 @@ class JournalReader {
 // JournalReader is not thread-safe, requiring external synchronization when
 // used by multiple threads.
 //
-// The journal reader reads through all journal files in the configured journal
-// directory, in order of their sequence numbers. See FileJournalWriter above.
+// The journal reader reads the latest snapshot in the configured journal
+// directory, if any, then the journal files after it, in order of their
+// sequence numbers. See FileJournalWriter above.
 class FileJournalReader : public JournalReader {
  public:
   explicit FileJournalReader(Env* env, StringPiece journal_dir);
@@ -105,6 +130,9 @@ class FileJournalReader : public JournalReader {
   const std::string journal_dir_;
   // Sequence number of current journal file.
   int64 sequence_number_ = 0;
+  // Whether the current file is the snapshot preceding journal file
+  // `sequence_number_`.
+  bool reading_snapshot_ = false;
   // Current offset into `file_`.
   uint64 offset_ = 0;
   std::unique_ptr<RandomAccessFile> file_;
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/journal.h"
 
+#include <algorithm>
+
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -109,6 +112,67 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, Snapshot) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(&journal_dir));
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_EXPECT_OK(writer.Write(MakeCreateJobUpdate()));
+    TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+    TF_EXPECT_OK(writer.WriteSnapshot({MakeRegisterDatasetUpdate()}));
+    TF_EXPECT_OK(writer.Write(MakeCreateJobUpdate()));
+  }
+  // The journal before the snapshot is deleted.
+  std::vector<std::string> files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(journal_dir, &files));
+  std::sort(files.begin(), files.end());
+  EXPECT_EQ(files, std::vector<std::string>({"journal_1", "snapshot_1"}));
+
+  // Reading starts from the snapshot, then continues after it, also with
+  // updates written after restarting.
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+  }
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeRegisterDatasetUpdate(), MakeCreateJobUpdate(),
+                    MakeFinishTaskUpdate()}));
+
+  // Snapshots replace the earlier ones.
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_EXPECT_OK(writer.WriteSnapshot({MakeCreateJobUpdate()}));
+    TF_EXPECT_OK(writer.WriteSnapshot({}));
+  }
+  TF_ASSERT_OK(Env::Default()->GetChildren(journal_dir, &files));
+  std::sort(files.begin(), files.end());
+  EXPECT_EQ(files, std::vector<std::string>({"journal_5", "snapshot_5"}));
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, {}));
+}
+
+TEST(Journal, IncompleteSnapshot) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(&journal_dir));
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_EXPECT_OK(writer.Write(MakeCreateJobUpdate()));
+  }
+  // A snapshot which was interrupted before completing is ignored.
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_ASSERT_OK(Env::Default()->NewWritableFile(
+        absl::StrCat(DataServiceJournalSnapshotFile(journal_dir, 1), ".tmp"),
+        &file));
+    TF_ASSERT_OK(file->Append("partial snapshot"));
+  }
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+  }
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeCreateJobUpdate(), MakeFinishTaskUpdate()}));
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(&journal_dir));
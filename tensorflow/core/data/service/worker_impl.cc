@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "grpcpp/create_channel.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/c/c_api_internal.h"
 #include "tensorflow/c/tf_status_helper.h"
 #include "tensorflow/core/data/dataset.pb.h"
@@ -25,7 +26,11 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
@@ -43,6 +48,65 @@ auto* tf_data_service_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/data/service/created",
                                     "Whether a tf.data service server "
                                     "has been created.");
+
+constexpr char kShardNodePrefix[] = "tf_data_service_split";
+
+NodeDef MakeInt64Const(const std::string& name, int64 value) {
+  NodeDef node;
+  node.set_name(name);
+  node.set_op("Const");
+  AddNodeAttr("dtype", DT_INT64, &node);
+  TensorProto proto;
+  Tensor(value).AsProtoTensorContent(&proto);
+  AddNodeAttr("value", proto, &node);
+  return node;
+}
+
+// Rewrites `graph` so that it only produces split `split_index` of
+// `num_splits`, by sharding the fetched dataset with an `AutoShardDataset`.
+Status ShardGraph(int64 num_splits, int64 split_index, GraphDef* graph) {
+  NodeDef* retval = nullptr;
+  for (NodeDef& node : *graph->mutable_node()) {
+    if (node.op() == "_Retval") {
+      retval = &node;
+    }
+  }
+  if (retval == nullptr) {
+    return errors::NotFound("Failed to find a _Retval op in the given dataset");
+  }
+  const std::string fetch = retval->input(0);
+  const std::string fetch_node_name(ParseTensorName(fetch).node());
+  const NodeDef* fetch_node = nullptr;
+  for (const NodeDef& node : graph->node()) {
+    if (node.name() == fetch_node_name) {
+      fetch_node = &node;
+    }
+  }
+  if (fetch_node == nullptr || !fetch_node->attr().contains("output_types") ||
+      !fetch_node->attr().contains("output_shapes")) {
+    return errors::FailedPrecondition(
+        "Failed to split dataset: could not determine the output types and "
+        "shapes of node ",
+        fetch_node_name);
+  }
+  NodeDef shard;
+  shard.set_name(absl::StrCat(kShardNodePrefix, "/shard"));
+  shard.set_op("AutoShardDataset");
+  shard.add_input(fetch);
+  *graph->add_node() =
+      MakeInt64Const(absl::StrCat(kShardNodePrefix, "/num_splits"), num_splits);
+  shard.add_input(graph->node(graph->node_size() - 1).name());
+  *graph->add_node() = MakeInt64Const(
+      absl::StrCat(kShardNodePrefix, "/split_index"), split_index);
+  shard.add_input(graph->node(graph->node_size() - 1).name());
+  (*shard.mutable_attr())["output_types"] =
+      fetch_node->attr().at("output_types");
+  (*shard.mutable_attr())["output_shapes"] =
+      fetch_node->attr().at("output_shapes");
+  retval->set_input(0, shard.name());
+  *graph->add_node() = std::move(shard);
+  return Status::OK();
+}
 }  // namespace
 
 DataServiceWorkerImpl::DataServiceWorkerImpl(
@@ -95,10 +159,16 @@ Status DataServiceWorkerImpl::ProcessTask(const ProcessTaskRequest* request,
 Status DataServiceWorkerImpl::ProcessTaskInternal(const TaskDef& task_def)
     EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   VLOG(3) << "Received request to process task " << task_def.task_id();
+  GraphDef graph = task_def.dataset().graph();
+  if (task_def.num_splits() > 0) {
+    VLOG(3) << "Task " << task_def.task_id() << " processes split "
+            << task_def.split_index() << " of " << task_def.num_splits();
+    TF_RETURN_IF_ERROR(
+        ShardGraph(task_def.num_splits(), task_def.split_index(), &graph));
+  }
   standalone::Dataset::Params params;
   std::unique_ptr<standalone::Dataset> dataset;
-  TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph(
-      params, task_def.dataset().graph(), &dataset));
+  TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph(params, graph, &dataset));
 
   std::unique_ptr<standalone::Iterator> iterator;
   TF_RETURN_IF_ERROR(dataset->MakeIterator(&iterator));
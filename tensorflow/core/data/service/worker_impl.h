@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
@@ -27,11 +28,12 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
-// A TensorFlow DataService serves dataset elements over RPC.
-class DataServiceWorkerImpl {
+// A TensorFlow DataService serves dataset elements over RPC, and directly to
+// clients in the same process.
+class DataServiceWorkerImpl : public LocalWorker {
  public:
   explicit DataServiceWorkerImpl(const experimental::WorkerConfig& config);
-  ~DataServiceWorkerImpl();
+  ~DataServiceWorkerImpl() override;
 
   // Starts the worker. The worker needs to know its own address so that it can
   // register with the dispatcher. This is set in `Start` instead of in the
@@ -48,7 +50,7 @@ class DataServiceWorkerImpl {
 
   /// Client-facing API.
   Status GetElement(const GetElementRequest* request,
-                    GetElementResponse* response);
+                    GetElementResponse* response) override;
 
  private:
   Status MakeDispatcherStub(std::unique_ptr<DispatcherService::Stub>* stub);
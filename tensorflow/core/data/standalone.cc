@@ -100,6 +100,11 @@ Status Dataset::FromGraph(Params params, const GraphDef& graph_def,
 }  // static
 
 Status Dataset::MakeIterator(std::unique_ptr<Iterator>* result) {
+  return MakeIterator(/*model=*/nullptr, result);
+}
+
+Status Dataset::MakeIterator(std::shared_ptr<model::Model> model,
+                             std::unique_ptr<Iterator>* result) {
   // Create an `IteratorContext`, which bundles together the necessary runtime
   // support to create and get elements from an iterator.
   std::unique_ptr<IteratorContext> ctx;
@@ -116,6 +121,7 @@ Status Dataset::MakeIterator(std::unique_ptr<Iterator>* result) {
     params.function_handle_cache = function_handle_cache_.get();
     params.resource_mgr = &resource_mgr_;
     params.cancellation_manager = &cancellation_manager_;
+    params.model = std::move(model);
 
     ctx = absl::make_unique<IteratorContext>(std::move(params));
   }
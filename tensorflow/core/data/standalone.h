@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -99,6 +100,12 @@ class Dataset {
   // Creates an iterator for this dataset.
   Status MakeIterator(std::unique_ptr<Iterator>* result);
 
+  // Creates an iterator for this dataset that records the performance of the
+  // input pipeline in `model`, e.g. to profile it or to tune its parameters
+  // with `model::Model::Optimize`.
+  Status MakeIterator(std::shared_ptr<model::Model> model,
+                      std::unique_ptr<Iterator>* result);
+
  private:
   Dataset(DatasetBase* dataset, DeviceMgr* device_mgr,
           ProcessFunctionLibraryRuntime* pflr,
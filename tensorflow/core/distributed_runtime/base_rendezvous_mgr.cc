@@ -71,6 +71,13 @@ BaseRemoteRendezvous* BaseRendezvousMgr::FindOrCreate(int64 step_id) {
 void BaseRendezvousMgr::RecvLocalAsync(int64 step_id,
                                        const Rendezvous::ParsedKey& parsed,
                                        Rendezvous::DoneCallback done) {
+  RecvLocalAsync(step_id, parsed, Rendezvous::Args(), std::move(done));
+}
+
+void BaseRendezvousMgr::RecvLocalAsync(int64 step_id,
+                                       const Rendezvous::ParsedKey& parsed,
+                                       const Rendezvous::Args& recv_args,
+                                       Rendezvous::DoneCallback done) {
   auto rendez = FindOrCreate(step_id);
   auto done_cb = [rendez, done = std::move(done)](
                      const Status& s, const Rendezvous::Args& send_args,
@@ -79,7 +86,7 @@ void BaseRendezvousMgr::RecvLocalAsync(int64 step_id,
     rendez->Unref();
     done(s, send_args, recv_args, v, dead);
   };
-  rendez->RecvLocalAsync(parsed, std::move(done_cb));
+  rendez->RecvLocalAsync(parsed, recv_args, std::move(done_cb));
 }
 
 Status BaseRendezvousMgr::RecvLocal(int64 step_id,
@@ -155,7 +162,7 @@ Status BaseRemoteRendezvous::Initialize(WorkerSession* session) {
     std::swap(deferred_calls, deferred_calls_);
   }
   for (auto& call : deferred_calls) {
-    RecvLocalAsyncInternal(call.parsed, std::move(call.done));
+    RecvLocalAsyncInternal(call.parsed, call.args, std::move(call.done));
   }
   return Status::OK();
 }
@@ -342,6 +349,12 @@ void BaseRemoteRendezvous::RecvAsync(const ParsedKey& parsed,
 
 void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
                                           DoneCallback done) {
+  RecvLocalAsync(parsed, Args(), std::move(done));
+}
+
+void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
+                                          const Rendezvous::Args& args,
+                                          DoneCallback done) {
   // Test whether the rendezvous is initialized using a shared lock, to avoid
   // the need for exclusive access in the common case.
   if (TF_PREDICT_FALSE(!is_initialized())) {
@@ -354,22 +367,23 @@ void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
       // rendezvous logic. At some point after Initialize() is called, a Tensor
       // is produced locally that will then be sent in response to the incoming
       // RPC.
-      DeferredCall call(parsed, std::move(done));
+      DeferredCall call(parsed, args, std::move(done));
       deferred_calls_.push_back(call);
       return;
     }
   }
-  RecvLocalAsyncInternal(parsed, std::move(done));
+  RecvLocalAsyncInternal(parsed, args, std::move(done));
 }
 
 void BaseRemoteRendezvous::RecvLocalAsyncInternal(const ParsedKey& parsed,
+                                                  const Rendezvous::Args& args,
                                                   DoneCallback done) {
   Status s = ValidateDevices(parsed, true /* is_src */);
   if (!s.ok()) {
-    done(s, Args(), Args(), Tensor(), false);
+    done(s, Args(), args, Tensor(), false);
     return;
   }
-  local_->RecvAsync(parsed, Args(), std::move(done));
+  local_->RecvAsync(parsed, args, std::move(done));
 }
 
 void BaseRemoteRendezvous::StartAbort(const Status& s) {
@@ -440,7 +454,8 @@ void BaseRemoteRendezvous::DeregisterCall(BaseRecvTensorCall* call) {
 }
 
 BaseRemoteRendezvous::DeferredCall::DeferredCall(const ParsedKey& parsed,
+                                                 const Rendezvous::Args& args,
                                                  DoneCallback done)
-    : parsed(parsed), done(std::move(done)) {}
+    : parsed(parsed), args(args), done(std::move(done)) {}
 
 }  // end namespace tensorflow
@@ -77,6 +77,9 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
   // This method is used by the rpc handler of RecvTensor.
   void RecvLocalAsync(int64 step_id, const Rendezvous::ParsedKey& parsed,
                       Rendezvous::DoneCallback done) override;
+  void RecvLocalAsync(int64 step_id, const Rendezvous::ParsedKey& parsed,
+                      const Rendezvous::Args& recv_args,
+                      Rendezvous::DoneCallback done) override;
 
   // Synchronous wrapper for RecvLocalAsync.
   Status RecvLocal(int64 step_id, const Rendezvous::ParsedKey& parsed,
@@ -146,6 +149,10 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // REQUIRES: "parsed" is one that will be Saved into the local rendezvous.
   void RecvLocalAsync(const ParsedKey& parsed, DoneCallback done);
 
+  // Like above, but the receive from local_ uses `args`.
+  void RecvLocalAsync(const ParsedKey& parsed, const Rendezvous::Args& args,
+                      DoneCallback done);
+
  protected:
   virtual void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
                                    const Rendezvous::Args& args,
@@ -184,9 +191,11 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Data structures to handle calls when partially initialized.
   struct DeferredCall {
     const ParsedKey parsed;
+    const Rendezvous::Args args;
     DoneCallback done;
 
-    DeferredCall(const ParsedKey& parsed, DoneCallback done);
+    DeferredCall(const ParsedKey& parsed, const Rendezvous::Args& args,
+                 DoneCallback done);
   };
   std::vector<DeferredCall> deferred_calls_ TF_GUARDED_BY(mu_);
 
@@ -214,7 +223,8 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
                           Tensor* out, StatusCallback done);
 
   // Must be called only if fully initialized.
-  void RecvLocalAsyncInternal(const ParsedKey& parsed, DoneCallback done);
+  void RecvLocalAsyncInternal(const ParsedKey& parsed,
+                              const Rendezvous::Args& args, DoneCallback done);
 
   TF_DISALLOW_COPY_AND_ASSIGN(BaseRemoteRendezvous);
 };
@@ -22,6 +22,40 @@ limitations under the License.
 
 namespace tensorflow {
 namespace eager {
+namespace {
+
+// Sets the shapes of `retvals` from `queue_response` if `status` is OK, and
+// poisons them otherwise. Releases the references taken on `inputs` and
+// `retvals` for the request.
+void CompleteRemoteExecute(const Status& status,
+                           const QueueResponse* queue_response,
+                           const gtl::InlinedVector<TensorHandle*, 4>& inputs,
+                           const gtl::InlinedVector<TensorHandle*, 2>& retvals,
+                           Device* device, uint64 context_view_id) {
+  for (auto handle : inputs) {
+    handle->Unref();
+  }
+  for (size_t i = 0; i < retvals.size(); ++i) {
+    if (status.ok()) {
+      Status s = retvals[i]->SetRemoteShape(queue_response->shape(i), device,
+                                            context_view_id);
+      if (!s.ok()) {
+        LOG(ERROR) << "Ignoring an error encountered when setting "
+                      "remote shape of tensor handle: "
+                   << retvals[i]
+                   << " with execute status: " << status.ToString()
+                   << " and SetRemoteShape status: " << s.ToString()
+                   << "\nThis should never happen. "
+                      "Please file an issue with the TensorFlow Team.";
+      }
+    } else {
+      retvals[i]->PoisonRemote(status, device, context_view_id);
+    }
+    retvals[i]->Unref();
+  }
+}
+
+}  // namespace
 
 void RemoteExecuteNode::RunAsync(StatusCallback done) {
   EnqueueResponse* response = new EnqueueResponse;
@@ -60,37 +94,89 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
       request_.get(), response,
       [inputs, retvals, response, device, context_view_id = context_view_id_,
        rpc_description, done](const Status& status) {
-        for (auto handle : inputs) {
-          handle->Unref();
-        }
         if (status.ok()) {
           VLOG(3) << "Completed successfully: " << rpc_description;
         } else {
           VLOG(3) << "Failed: " << rpc_description << " with status "
                   << status.ToString();
         }
-        for (size_t i = 0; i < retvals.size(); ++i) {
-          if (status.ok()) {
-            Status s = retvals[i]->SetRemoteShape(
-                response->queue_response(0).shape(i), device, context_view_id);
-            if (!s.ok()) {
-              LOG(ERROR) << "Ignoring an error encountered when setting "
-                            "remote shape of tensor handle: "
-                         << retvals[i]
-                         << " with execute status: " << status.ToString()
-                         << " and SetRemoteShape status: " << s.ToString()
-                         << "\nThis should never happen. "
-                            "Please file an issue with the TensorFlow Team.";
-            }
-          } else {
-            retvals[i]->PoisonRemote(status, device, context_view_id);
-          }
-          retvals[i]->Unref();
-        }
+        CompleteRemoteExecute(
+            status, status.ok() ? &response->queue_response(0) : nullptr,
+            inputs, retvals, device, context_view_id);
         done(status);
         delete response;
       });
 }
 
+bool RemoteExecuteNode::CanBatchWith(
+    const AsyncRemoteExecuteNode& next) const {
+  const auto* next_node = dynamic_cast<const RemoteExecuteNode*>(&next);
+  return next_node != nullptr && next_node->eager_client_ == eager_client_ &&
+         next_node->device_ == device_ &&
+         next_node->context_view_id_ == context_view_id_ &&
+         next_node->request_->context_id() == request_->context_id() &&
+         !needs_remote_inputs_ && !next_node->needs_remote_inputs_ &&
+         request_->queue_size() == 1 && next_node->request_->queue_size() == 1;
+}
+
+void RemoteExecuteNode::RunAsyncBatch(
+    const std::vector<AsyncRemoteExecuteNode*>& next_nodes,
+    std::vector<StatusCallback> dones) {
+  std::vector<RemoteExecuteNode*> nodes = {this};
+  for (AsyncRemoteExecuteNode* next : next_nodes) {
+    nodes.push_back(static_cast<RemoteExecuteNode*>(next));
+  }
+  DCHECK_EQ(nodes.size(), dones.size());
+
+  // What the callback needs to complete a node, which may be destroyed once
+  // the node before it is done.
+  struct PendingNode {
+    gtl::InlinedVector<TensorHandle*, 4> inputs;
+    gtl::InlinedVector<TensorHandle*, 2> retvals;
+    StatusCallback done;
+  };
+  std::vector<PendingNode> pending_nodes;
+  pending_nodes.reserve(nodes.size());
+
+  // Each node holds exactly one queue item, so the i-th queue response is
+  // that of the i-th node.
+  EnqueueRequest* request = new EnqueueRequest;
+  EnqueueResponse* response = new EnqueueResponse;
+  request->set_context_id(request_->context_id());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    RemoteExecuteNode* node = nodes[i];
+    *request->add_queue() = node->request_->queue(0);
+    for (auto handle : node->inputs_) {
+      handle->Ref();
+    }
+    for (auto handle : node->retvals_) {
+      handle->Ref();
+    }
+    pending_nodes.push_back(
+        {node->inputs_, node->retvals_, std::move(dones[i])});
+  }
+  VLOG(3) << "Issuing a batch of " << nodes.size() << " remote operations";
+
+  eager_client_->StreamingEnqueueAsync(
+      request, response,
+      [request, response, pending_nodes = std::move(pending_nodes),
+       device = device_,
+       context_view_id = context_view_id_](const Status& status) {
+        if (!status.ok()) {
+          VLOG(3) << "Failed a batch of " << pending_nodes.size()
+                  << " remote operations with status " << status.ToString();
+        }
+        for (size_t i = 0; i < pending_nodes.size(); ++i) {
+          CompleteRemoteExecute(
+              status, status.ok() ? &response->queue_response(i) : nullptr,
+              pending_nodes[i].inputs, pending_nodes[i].retvals, device,
+              context_view_id);
+          pending_nodes[i].done(status);
+        }
+        delete request;
+        delete response;
+      });
+}
+
 }  // namespace eager
 }  // namespace tensorflow
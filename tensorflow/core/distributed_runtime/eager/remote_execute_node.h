@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_EXECUTE_NODE_H_
 
 #include <cstddef>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -111,6 +112,14 @@ class RemoteExecuteNode : public AsyncRemoteExecuteNode {
     return eager_client_->allow_multiple_pending_requests();
   }
 
+  // Nodes for the same remote context and device that don't need remote
+  // inputs can share a request. The worker runs the operations of a request
+  // in order, so a node can use the outputs of the nodes before it.
+  bool CanBatchWith(const AsyncRemoteExecuteNode& next) const override;
+
+  void RunAsyncBatch(const std::vector<AsyncRemoteExecuteNode*>& next_nodes,
+                     std::vector<StatusCallback> dones) override;
+
   string DebugString() const override {
     string out = "[RemoteExecuteNode]";
     strings::StrAppend(&out, " request: ", request_->DebugString());
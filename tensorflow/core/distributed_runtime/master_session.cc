@@ -26,12 +26,14 @@ limitations under the License.
 #include "tensorflow/core/debug/debug_graph_utils.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/scheduler.h"
+#include "tensorflow/core/distributed_runtime/step_critical_path.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/graph_def_util.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -965,6 +967,28 @@ void MasterSession::ReffedClientGraph::ProcessStats(int64 step_id,
                  Microseconds(0) /*cleanup_time*/, 0 /*total_runops*/,
                  Status::OK());
   }
+  // Find the stragglers and slow links of the step while the stats of the
+  // partitions are still apart.
+  if (pss->collect_timeline && partitions_.size() > 1) {
+    StepCriticalPathAnalyzer analyzer;
+    for (const StepStats& ss : pss->step_stats) {
+      analyzer.AddPartitionStats(ss);
+    }
+    analyzer.AddRpcStats(pss->rpc_stats);
+    const StepCriticalPath path = analyzer.Analyze();
+    for (const WorkerStepLateness& worker : path.workers) {
+      metrics::RecordDistributedStepLateness(
+          worker.worker, worker.lateness_micros, worker.is_straggler);
+    }
+    for (const LinkStats& link : path.links) {
+      if (link.is_slow) {
+        metrics::RecordDistributedStepSlowLink(link.src_worker,
+                                               link.dst_worker);
+      }
+    }
+    VLOG(1) << "Critical path of step " << step_id << ": "
+            << path.DebugString();
+  }
   // Assemble all stats for this timeline into a merged StepStats.
   if (pss->collect_timeline) {
     StepStats step_stats_proto;
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -84,6 +85,18 @@ class RendezvousMgrInterface {
                               const Rendezvous::ParsedKey& parsed,
                               Rendezvous::DoneCallback done) = 0;
 
+  // Like above, but the local receive uses `recv_args`, so that it can be
+  // cancelled with their cancellation manager while it waits.
+  //
+  // This method is used by the rpc handler of RecvTensorBatch.
+  virtual void RecvLocalAsync(int64 step_id,
+                              const Rendezvous::ParsedKey& parsed,
+                              const Rendezvous::Args& recv_args,
+                              Rendezvous::DoneCallback done) {
+    done(errors::Unimplemented("RecvLocalAsync() with receive arguments"),
+         Rendezvous::Args(), recv_args, Tensor(), false);
+  }
+
   // Synchronous wrapper for RecvLocalAsync.
   virtual Status RecvLocal(int64 step_id, const Rendezvous::ParsedKey& parsed,
                            Tensor* val, bool* is_dead) = 0;
@@ -489,11 +489,16 @@ class ServerBidirectionalStreamingCall
   const RequestMessage& request() const { return request_; }
   ResponseMessage* mutable_response() { return &response_; }
 
+  // Unlike request(), this message is kept for the whole call. A handler can
+  // use it to hold what it needs from the earlier requests of the stream.
+  RequestMessage* mutable_stream_state() { return &stream_state_; }
+
  private:
   // Request and response messages are reused for each request/response exchange
   // between the client and the server.
   RequestMessage request_;
   ResponseMessage response_;
+  RequestMessage stream_state_;
   ::grpc::ServerContext ctx_;
 
   HandleRequestFunction handle_request_function_;
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "grpcpp/grpcpp.h"
@@ -32,14 +34,147 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 const int kMaxWorkerRpcRetries = 10;
 
+namespace {
+
+bool EnableStreamingRunGraph() {
+  static const bool enabled = [] {
+    bool result;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_ENABLE_STREAMING_RUN_GRAPH", false, &result));
+    return result;
+  }();
+  return enabled;
+}
+
+// Sends RunGraph requests on long-lived StreamingRunGraph calls instead of
+// starting a new call for each of them. A request that runs the same graph
+// as the previous one on its stream omits the graph fields.
+//
+// A stream carries one request at a time: the worker handles the requests
+// of a stream in order, and the partitions of concurrent steps must not
+// wait for each other. Idle streams are kept for reuse.
+class StreamingRunGraphClient {
+ public:
+  StreamingRunGraphClient(::grpc::GenericStub* stub,
+                          ::grpc::CompletionQueue* cq,
+                          const ::grpc::string& method)
+      : stub_(stub), cq_(cq), method_(method) {}
+
+  ~StreamingRunGraphClient() {
+    for (const auto& stream : idle_) {
+      stream->dispatcher.CancelCall();
+    }
+  }
+
+  void RunGraphAsync(CallOptions* call_opts, const RunGraphRequest& request,
+                     RunGraphResponse* response, StatusCallback done) {
+    Stream* stream = Acquire();
+    StreamingRunGraphRequest streaming_request;
+    RunGraphRequest* delta = streaming_request.mutable_request();
+    if (stream->has_last && SameGraph(stream->last, request)) {
+      streaming_request.set_same_graph(true);
+      delta->set_step_id(request.step_id());
+      *delta->mutable_exec_opts() = request.exec_opts();
+      *delta->mutable_send() = request.send();
+      delta->set_is_partial(request.is_partial());
+      delta->set_is_last_partial_run(request.is_last_partial_run());
+      delta->set_request_id(request.request_id());
+    } else {
+      *delta = request;
+      stream->last.set_session_handle(request.session_handle());
+      stream->last.set_create_worker_session_called(
+          request.create_worker_session_called());
+      stream->last.set_graph_handle(request.graph_handle());
+      *stream->last.mutable_recv_key() = request.recv_key();
+      stream->last.set_store_errors_in_response_body(
+          request.store_errors_in_response_body());
+      stream->has_last = true;
+    }
+
+    call_opts->SetCancelCallback(
+        [stream]() { stream->dispatcher.CancelCall(); });
+    stream->dispatcher.SendNextRequest(
+        streaming_request, response,
+        [this, call_opts, stream, done = std::move(done)](const Status& s) {
+          call_opts->ClearCancelCallback();
+          if (!s.ok()) {
+            // The worker drops the stream state along with the call, and the
+            // next request starts a new one.
+            stream->has_last = false;
+          }
+          Release(stream);
+          done(s);
+        });
+  }
+
+ private:
+  struct Stream {
+    Stream(::grpc::GenericStub* stub, ::grpc::CompletionQueue* cq,
+           const ::grpc::string& method)
+        : dispatcher(stub, cq, method) {}
+
+    StreamingRPCDispatcher<RunGraphResponse> dispatcher;
+    // The graph fields of the last request sent on the stream.
+    RunGraphRequest last;
+    bool has_last = false;
+  };
+
+  static bool SameGraph(const RunGraphRequest& last,
+                        const RunGraphRequest& request) {
+    if (last.graph_handle() != request.graph_handle() ||
+        last.session_handle() != request.session_handle() ||
+        last.create_worker_session_called() !=
+            request.create_worker_session_called() ||
+        last.store_errors_in_response_body() !=
+            request.store_errors_in_response_body() ||
+        last.recv_key_size() != request.recv_key_size()) {
+      return false;
+    }
+    for (int i = 0; i < request.recv_key_size(); ++i) {
+      if (last.recv_key(i) != request.recv_key(i)) return false;
+    }
+    return true;
+  }
+
+  Stream* Acquire() {
+    {
+      mutex_lock l(mu_);
+      if (!idle_.empty()) {
+        Stream* stream = idle_.back().release();
+        idle_.pop_back();
+        return stream;
+      }
+    }
+    return new Stream(stub_, cq_, method_);
+  }
+
+  void Release(Stream* stream) {
+    mutex_lock l(mu_);
+    idle_.emplace_back(stream);
+  }
+
+  ::grpc::GenericStub* const stub_;
+  ::grpc::CompletionQueue* const cq_;
+  const ::grpc::string method_;
+
+  mutex mu_;
+  std::vector<std::unique_ptr<Stream>> idle_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StreamingRunGraphClient);
+};
+
+}  // namespace
+
 class GrpcRemoteWorker : public WorkerInterface {
  public:
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
@@ -66,8 +201,14 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
         logger_(logger),
-        target_(target) {}
+        target_(target) {
+    if (EnableStreamingRunGraph()) {
+      streaming_rungraph_.reset(new StreamingRunGraphClient(
+          &stub_, cq_, Method(GrpcWorkerMethod::kStreamingRunGraph)));
+    }
+  }
 
   ~GrpcRemoteWorker() override {}
 
@@ -111,6 +252,14 @@ class GrpcRemoteWorker : public WorkerInterface {
   void RunGraphAsync(CallOptions* call_opts, RunGraphRequestWrapper* request,
                      MutableRunGraphResponseWrapper* response,
                      StatusCallback done) override {
+    // Streams have no deadline, so requests with a timeout use their own
+    // call.
+    if (streaming_rungraph_ != nullptr && call_opts->GetTimeout() == 0) {
+      streaming_rungraph_->RunGraphAsync(call_opts, request->ToProto(),
+                                         get_proto_from_wrapper(response),
+                                         std::move(done));
+      return;
+    }
     IssueRequest(&request->ToProto(), get_proto_from_wrapper(response),
                  rungraph_, std::move(done), call_opts);
   }
@@ -155,7 +304,7 @@ class GrpcRemoteWorker : public WorkerInterface {
           const string& key = request->buf_rendezvous_key();
           logger_->RecordDataTransfer(
               step_id, send_start_usec, end_usec, key, request->src_device(),
-              request->dst_device(), num_bytes, "", "RecvBuf");
+              request->dst_device(), num_bytes, "", "RecvBuf", start_usec);
         }
         VLOG(2) << "done callback, req: " << request->DebugString()
                 << " response " << response->DebugString();
@@ -237,7 +386,7 @@ class GrpcRemoteWorker : public WorkerInterface {
                                       key_parts[3],  // tensor name
                                       key_parts[0],  // src_device
                                       key_parts[2],  // dst_device
-                                      bytes);
+                                      bytes, start_usec);
           }
         }
         VLOG(2) << "done callback, req: " << request->DebugString()
@@ -255,6 +404,14 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    IssueRequest(request, response, recvtensorbatch_, std::move(done),
+                 call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -320,11 +477,15 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string recvtensorbatch_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
   const string target_;
 
+  // Set if TF_ENABLE_STREAMING_RUN_GRAPH is true.
+  std::unique_ptr<StreamingRunGraphClient> streaming_rungraph_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcRemoteWorker);
 };
 
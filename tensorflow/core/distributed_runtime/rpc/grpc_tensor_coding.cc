@@ -19,6 +19,7 @@ limitations under the License.
 #include "grpcpp/support/slice.h"
 #include "absl/flags/flag.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -245,5 +246,29 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
 }
 
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              const TensorContentEncoding& encoding,
+                              ::grpc::ByteBuffer* result) {
+  EncodedTensorContent encoded;
+  if (is_dead || static_cast<int64>(val.TotalBytes()) < encoding.min_bytes ||
+      (encoding.compression == EncodedTensorContent::NONE &&
+       !encoding.float_as_bfloat16) ||
+      !EncodeTensorContent(val, encoding.compression,
+                           encoding.float_as_bfloat16, &encoded)) {
+    EncodeTensorToByteBuffer(is_dead, val, require_ack, result);
+    return;
+  }
+  RecvTensorResponse response;
+  response.set_require_ack(require_ack);
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  // The tensor only carries the dtype and shape, its content is in the
+  // transport options.
+  TensorProto* tensor = response.mutable_tensor();
+  tensor->set_dtype(val.dtype());
+  val.shape().AsProto(tensor->mutable_tensor_shape());
+  response.mutable_transport_options()->PackFrom(encoded);
+  EncodeRecvTensorResponseToByteBuffer(response, result);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
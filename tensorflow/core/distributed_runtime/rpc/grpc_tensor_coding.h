@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
 #include "grpcpp/impl/codegen/byte_buffer.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
 
 namespace tensorflow {
 class Tensor;
@@ -49,6 +51,22 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result);
 
+// How to encode the content of tensors for a receiver that accepts encoded
+// content (see RecvTensorRequest::accept_encoded_content).
+struct TensorContentEncoding {
+  EncodedTensorContent::Compression compression = EncodedTensorContent::NONE;
+  bool float_as_bfloat16 = false;
+  // Tensors with less content than this are sent as they are.
+  int64 min_bytes = 16384;
+};
+
+// Like above, but the content of "val" is encoded as described by "encoding"
+// if that makes it smaller. The result is then only parseable by a
+// TensorResponse, which decodes the content again.
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              const TensorContentEncoding& encoding,
+                              ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -0,0 +1,101 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_response_cache.h"
+
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+auto* tensor_response_cache_lookups = monitoring::Counter<1>::New(
+    "/tensorflow/core/grpc_tensor_response_cache_lookups",
+    "The number of RecvTensor responses looked up in the tensor response "
+    "cache, by whether they were found.",
+    "result");
+
+}  // namespace
+
+GrpcTensorResponseCache::GrpcTensorResponseCache(int64 max_bytes)
+    : max_bytes_(max_bytes) {}
+
+uint64 GrpcTensorResponseCache::Key(const Tensor& tensor, bool encoded,
+                                    bool require_ack) {
+  uint64 key = reinterpret_cast<uint64>(DMAHelper::base(&tensor));
+  key = Hash64Combine(key, tensor.TotalBytes());
+  return Hash64Combine(key, (encoded ? 2 : 0) | (require_ack ? 1 : 0));
+}
+
+bool GrpcTensorResponseCache::Lookup(const Tensor& tensor, bool encoded,
+                                     bool require_ack,
+                                     ::grpc::ByteBuffer* response) {
+  if (tensor.TotalBytes() == 0) return false;
+  mutex_lock l(mu_);
+  auto it = entries_.find(Key(tensor, encoded, require_ack));
+  if (it == entries_.end() || it->second.encoded != encoded ||
+      it->second.require_ack != require_ack ||
+      it->second.tensor.dtype() != tensor.dtype() ||
+      it->second.tensor.shape() != tensor.shape() ||
+      DMAHelper::base(&it->second.tensor) != DMAHelper::base(&tensor)) {
+    tensor_response_cache_lookups->GetCell("miss")->IncrementBy(1);
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+  *response = it->second.response;
+  tensor_response_cache_lookups->GetCell("hit")->IncrementBy(1);
+  return true;
+}
+
+void GrpcTensorResponseCache::Insert(const Tensor& tensor, bool encoded,
+                                     bool require_ack,
+                                     const ::grpc::ByteBuffer& response) {
+  const int64 bytes = response.Length();
+  if (tensor.TotalBytes() == 0 || bytes > max_bytes_) return;
+  const uint64 key = Key(tensor, encoded, require_ack);
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) EraseLocked(it);
+  while (bytes_ + bytes > max_bytes_) {
+    EraseLocked(entries_.find(lru_.back()));
+  }
+  lru_.push_front(key);
+  Entry& entry = entries_[key];
+  entry.tensor = tensor;
+  entry.encoded = encoded;
+  entry.require_ack = require_ack;
+  entry.response = response;
+  entry.bytes = bytes;
+  entry.lru_pos = lru_.begin();
+  bytes_ += bytes;
+  VLOG(2) << "Cached RecvTensor response of " << bytes << " bytes, "
+          << bytes_ << " bytes in " << entries_.size() << " responses";
+}
+
+int64 GrpcTensorResponseCache::bytes() const {
+  mutex_lock l(mu_);
+  return bytes_;
+}
+
+void GrpcTensorResponseCache::EraseLocked(
+    std::unordered_map<uint64, Entry>::iterator it) {
+  bytes_ -= it->second.bytes;
+  lru_.erase(it->second.lru_pos);
+  entries_.erase(it);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_RESPONSE_CACHE_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_RESPONSE_CACHE_H_
+
+#include <list>
+#include <unordered_map>
+
+#include "grpcpp/impl/codegen/byte_buffer.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Caches serialized RecvTensor responses by the buffer of the tensor they
+// hold, so that a tensor sent to many receivers, e.g. a variable of a
+// parameter server that all workers pull, is encoded only once.
+//
+// Unlike GrpcResponseCache, which replays the response to a retried request,
+// entries are shared by requests for different rendezvous keys and steps.
+// An entry keeps a reference to the buffer of its tensor. This keeps the
+// buffer from being reused for another tensor, and makes a resource variable
+// copy itself on its next update, so that an updated variable never matches
+// an entry. Entries of buffers that are no longer sent are evicted, least
+// recently used first, once the cache holds more than `max_bytes`.
+class GrpcTensorResponseCache {
+ public:
+  explicit GrpcTensorResponseCache(int64 max_bytes);
+
+  // If a response for `tensor` serialized the same way is cached, copies it
+  // into `response` and returns true. Copying a ByteBuffer only references
+  // its slices.
+  bool Lookup(const Tensor& tensor, bool encoded, bool require_ack,
+              ::grpc::ByteBuffer* response);
+
+  // Caches `response` as the serialization of `tensor`.
+  void Insert(const Tensor& tensor, bool encoded, bool require_ack,
+              const ::grpc::ByteBuffer& response);
+
+  // Returns the total size of the cached responses.
+  int64 bytes() const;
+
+ private:
+  struct Entry {
+    Tensor tensor;
+    bool encoded;
+    bool require_ack;
+    ::grpc::ByteBuffer response;
+    int64 bytes;
+    // Position of the key of this entry in `lru_`.
+    std::list<uint64>::iterator lru_pos;
+  };
+
+  static uint64 Key(const Tensor& tensor, bool encoded, bool require_ack);
+
+  void EraseLocked(std::unordered_map<uint64, Entry>::iterator it)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 max_bytes_;
+
+  mutable mutex mu_;
+  std::unordered_map<uint64, Entry> entries_ TF_GUARDED_BY(mu_);
+  // Keys of `entries_`, from the most to the least recently used.
+  std::list<uint64> lru_ TF_GUARDED_BY(mu_);
+  int64 bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GrpcTensorResponseCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_RESPONSE_CACHE_H_
@@ -0,0 +1,89 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_response_cache.h"
+
+#include "grpcpp/support/byte_buffer.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+::grpc::ByteBuffer Encode(const Tensor& t) {
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(/*is_dead=*/false, t, /*require_ack=*/false,
+                                 &buf);
+  return buf;
+}
+
+TEST(GrpcTensorResponseCacheTest, ServesSameBuffer) {
+  GrpcTensorResponseCache cache(1 << 20);
+  Tensor t = test::AsTensor<float>({1, 2, 3, 4});
+  ::grpc::ByteBuffer response;
+  EXPECT_FALSE(cache.Lookup(t, false, false, &response));
+  cache.Insert(t, false, false, Encode(t));
+
+  // A tensor that shares the buffer, e.g. the same variable sent to another
+  // worker, is served from the cache.
+  Tensor same = t;
+  ASSERT_TRUE(cache.Lookup(same, false, false, &response));
+  EXPECT_EQ(Encode(t).Length(), response.Length());
+
+  // Serializing the tensor differently, or another buffer, misses.
+  EXPECT_FALSE(cache.Lookup(t, true, false, &response));
+  EXPECT_FALSE(cache.Lookup(t, false, true, &response));
+  EXPECT_FALSE(
+      cache.Lookup(test::AsTensor<float>({1, 2, 3, 4}), false, false,
+                   &response));
+
+  // So does another shape of the same buffer.
+  Tensor reshaped;
+  ASSERT_TRUE(reshaped.CopyFrom(t, TensorShape({2, 2})));
+  EXPECT_FALSE(cache.Lookup(reshaped, false, false, &response));
+}
+
+TEST(GrpcTensorResponseCacheTest, EvictsLeastRecentlyUsed) {
+  Tensor a = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor b = test::AsTensor<float>({5, 6, 7, 8});
+  Tensor c = test::AsTensor<float>({9, 10, 11, 12});
+  const int64 size = Encode(a).Length();
+  GrpcTensorResponseCache cache(2 * size);
+  cache.Insert(a, false, false, Encode(a));
+  cache.Insert(b, false, false, Encode(b));
+  EXPECT_EQ(2 * size, cache.bytes());
+
+  ::grpc::ByteBuffer response;
+  EXPECT_TRUE(cache.Lookup(a, false, false, &response));
+  cache.Insert(c, false, false, Encode(c));
+  EXPECT_EQ(2 * size, cache.bytes());
+  EXPECT_TRUE(cache.Lookup(a, false, false, &response));
+  EXPECT_FALSE(cache.Lookup(b, false, false, &response));
+  EXPECT_TRUE(cache.Lookup(c, false, false, &response));
+}
+
+TEST(GrpcTensorResponseCacheTest, SkipsResponsesLargerThanCache) {
+  Tensor t = test::AsTensor<float>({1, 2, 3, 4});
+  GrpcTensorResponseCache cache(1);
+  cache.Insert(t, false, false, Encode(t));
+  EXPECT_EQ(0, cache.bytes());
+  ::grpc::ByteBuffer response;
+  EXPECT_FALSE(cache.Lookup(t, false, false, &response));
+}
+
+}  // namespace
+}  // namespace tensorflow
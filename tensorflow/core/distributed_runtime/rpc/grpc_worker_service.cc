@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_map>
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_call.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
@@ -147,6 +149,14 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(RecvTensorBatch, 100, true);
+    for (int i = 0;
+         i < gtl::FindWithDefault(
+                 queue_depth_,
+                 static_cast<int>(GrpcWorkerMethod::kStreamingRunGraph), 10);
+         ++i) {
+      EnqueueStreamingRunGraphRequest();
+    }
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -162,8 +172,8 @@ class GrpcWorkerServiceThread {
     bool ok;
 
     while (cq_->Next(&tag, &ok)) {
-      UntypedCall<GrpcWorkerServiceThread>::Tag* callback_tag =
-          static_cast<UntypedCall<GrpcWorkerServiceThread>::Tag*>(tag);
+      GrpcCallTag<GrpcWorkerServiceThread>* callback_tag =
+          static_cast<GrpcCallTag<GrpcWorkerServiceThread>*>(tag);
       CHECK(callback_tag);
       callback_tag->OnCompleted(this, ok);
     }
@@ -263,6 +273,71 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RunGraph, true);
   }
 
+  using StreamingRunGraphCall =
+      ServerBidirectionalStreamingCall<GrpcWorkerServiceThread,
+                                       grpc::WorkerService::AsyncService,
+                                       StreamingRunGraphRequest,
+                                       RunGraphResponse>;
+
+  // Runs the requests of a StreamingRunGraph stream as RunGraph calls. The
+  // call does not read the next request of the stream until this one has
+  // been responded to.
+  void StreamingRunGraphHandler(StreamingRunGraphCall* call) {
+    call->Ref();
+    Schedule([this, call]() {
+      if (call->RefCountIsOne()) {
+        // The stream has already been shut down.
+        call->Unref();
+        return;
+      }
+      // The stream state holds the last request of the stream.
+      RunGraphRequest* request =
+          call->mutable_stream_state()->mutable_request();
+      const StreamingRunGraphRequest& streaming_request = call->request();
+      if (streaming_request.same_graph()) {
+        if (request->graph_handle().empty()) {
+          call->Finish(ToGrpcStatus(errors::Internal(
+              "StreamingRunGraph request refers to a previous request that "
+              "was not received")));
+          call->Unref();
+          return;
+        }
+        RunGraphRequest graph_fields;
+        graph_fields.set_session_handle(request->session_handle());
+        graph_fields.set_create_worker_session_called(
+            request->create_worker_session_called());
+        graph_fields.set_graph_handle(request->graph_handle());
+        graph_fields.mutable_recv_key()->Swap(request->mutable_recv_key());
+        graph_fields.set_store_errors_in_response_body(
+            request->store_errors_in_response_body());
+        *request = streaming_request.request();
+        request->MergeFrom(graph_fields);
+      } else {
+        *request = streaming_request.request();
+      }
+
+      CallOptions* call_opts = new CallOptions;
+      ProtoRunGraphRequest* wrapped_request = new ProtoRunGraphRequest(request);
+      NonOwnedProtoRunGraphResponse* wrapped_response =
+          new NonOwnedProtoRunGraphResponse(call->mutable_response());
+      worker_->RunGraphAsync(call_opts, wrapped_request, wrapped_response,
+                             [call, call_opts, wrapped_request,
+                              wrapped_response](const Status& s) {
+                               delete call_opts;
+                               delete wrapped_request;
+                               delete wrapped_response;
+                               if (s.ok()) {
+                                 call->SendResponse();
+                               } else {
+                                 VLOG(1) << "Bad response from "
+                                         << "StreamingRunGraph:" << s;
+                                 call->Finish(ToGrpcStatus(s));
+                               }
+                               call->Unref();
+                             });
+    });
+  }
+
   void RecvTensorHandlerRaw(
       WorkerCall<RecvTensorRequest, ::grpc::ByteBuffer>* call) {
     Schedule([this, call]() {
@@ -300,6 +375,25 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RecvBuf, true);
   }
 
+  void RecvTensorBatchHandler(
+      WorkerCall<RecvTensorBatchRequest, RecvTensorBatchResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(1) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensorBatch, true);
+  }
+
   void CompleteGroupHandler(
       WorkerCall<CompleteGroupRequest, CompleteGroupResponse>* call) {
     Schedule([this, call]() {
@@ -352,6 +446,16 @@ class GrpcWorkerServiceThread {
     }
   }
 
+  void EnqueueStreamingRunGraphRequest() {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      StreamingRunGraphCall::EnqueueRequest(
+          worker_service_, cq_.get(),
+          &grpc::WorkerService::AsyncService::RequestStreamingRunGraph,
+          &GrpcWorkerServiceThread::StreamingRunGraphHandler);
+    }
+  }
+
   GrpcWorker* const worker_ = nullptr;  // Not owned.
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
   std::unique_ptr<Thread> thread_;
@@ -427,6 +531,24 @@ GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
   if (config.rpc_options().cache_rpc_response()) {
     EnableResponseCache();
   }
+  const ConfigProto::Experimental& experimental = config.experimental();
+  if (experimental.recv_tensor_compression() == "SNAPPY") {
+    recv_tensor_encoding_.compression = EncodedTensorContent::SNAPPY;
+  } else if (!experimental.recv_tensor_compression().empty()) {
+    LOG(WARNING) << "Unknown recv_tensor_compression "
+                 << experimental.recv_tensor_compression()
+                 << ", sending tensors uncompressed.";
+  }
+  recv_tensor_encoding_.float_as_bfloat16 =
+      experimental.recv_tensor_float_as_bfloat16();
+  if (experimental.recv_tensor_encoding_min_bytes() > 0) {
+    recv_tensor_encoding_.min_bytes =
+        experimental.recv_tensor_encoding_min_bytes();
+  }
+  if (experimental.recv_tensor_response_cache_bytes() > 0) {
+    tensor_response_cache_ = absl::make_unique<GrpcTensorResponseCache>(
+        experimental.recv_tensor_response_cache_bytes());
+  }
 }
 
 void GrpcWorker::EnableResponseCache() {
@@ -447,11 +569,30 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  const bool encode_content = request->accept_encoded_content();
+  auto do_response = [this, response, done, cache_enabled, encode_content](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
+    const bool use_tensor_cache =
+        status.ok() && !is_dead && tensor_response_cache_ != nullptr;
+    if (use_tensor_cache &&
+        tensor_response_cache_->Lookup(tensor, encode_content, cache_enabled,
+                                       response)) {
+      done(status);
+      return;
+    }
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      if (encode_content) {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       recv_tensor_encoding_, response);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
+    }
+    if (use_tensor_cache) {
+      tensor_response_cache_->Insert(tensor, encode_content, cache_enabled,
+                                     *response);
     }
     done(status);
   };
@@ -555,6 +696,125 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+// RecvTensorBatchAsync: responds as soon as at least one of the requested
+// tensors is ready, with every requested tensor that is ready by then. The
+// receives of the other tensors are cancelled and left in the local
+// rendezvous, so that the client can request them again. Waiting for all of
+// them instead could deadlock a step, since a tensor in the batch may depend
+// on another one that the client has yet to receive.
+void GrpcWorker::RecvTensorBatchAsync(CallOptions* opts,
+                                      const RecvTensorBatchRequest* request,
+                                      RecvTensorBatchResponse* response,
+                                      StatusCallback done) {
+  const int64 step_id = request->step_id();
+  Status s = recent_request_ids_.TrackUnique(
+      request->request_id(), "RecvTensorBatch (GrpcWorker)", *request);
+  const int num_keys = request->rendezvous_key_size();
+  std::vector<Rendezvous::ParsedKey> parsed(num_keys);
+  for (int i = 0; i < num_keys && s.ok(); ++i) {
+    s = Rendezvous::ParseKey(request->rendezvous_key(i), &parsed[i]);
+    Device* src_dev = nullptr;
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed[i], &src_dev);
+    }
+    if (s.ok() && src_dev->tensorflow_gpu_device_info() != nullptr) {
+      s = errors::InvalidArgument(
+          "RecvTensorBatch does not support tensors sent from ",
+          parsed[i].src_device);
+    }
+  }
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  if (num_keys == 0) {
+    done(errors::InvalidArgument("RecvTensorBatch requested no tensors"));
+    return;
+  }
+
+  struct Received {
+    int index;
+    Tensor val;
+    bool is_dead;
+  };
+  struct BatchState {
+    CancellationManager cm;
+    mutex mu;
+    int pending TF_GUARDED_BY(mu);
+    bool cancel_started TF_GUARDED_BY(mu) = false;
+    Status status TF_GUARDED_BY(mu);
+    std::vector<Received> received TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<BatchState>();
+  state->pending = num_keys;
+
+  // Cancel from another thread, since the local receives complete
+  // synchronously when they are cancelled, and their callbacks take the
+  // lock of `opts` to clear this callback.
+  opts->SetCancelCallback([state]() {
+    SchedClosure([state]() { state->cm.StartCancel(); });
+  });
+  auto finish = [this, opts, response, done, state]() {
+    opts->ClearCancelCallback();
+    mutex_lock l(state->mu);
+    if (!state->status.ok()) {
+      done(state->status);
+      return;
+    }
+    if (state->received.empty()) {
+      done(errors::Cancelled("RecvTensorBatch cancelled"));
+      return;
+    }
+    std::sort(state->received.begin(), state->received.end(),
+              [](const Received& a, const Received& b) {
+                return a.index < b.index;
+              });
+    const int64 send_start_micros = env_->env->NowMicros();
+    for (const Received& r : state->received) {
+      response->add_index(r.index);
+      RecvTensorResponse* resp = response->add_response();
+      resp->set_is_dead(r.is_dead);
+      resp->set_send_start_micros(send_start_micros);
+      if (!r.is_dead) {
+        r.val.AsProtoTensorContent(resp->mutable_tensor());
+      }
+    }
+    done(Status::OK());
+  };
+
+  Rendezvous::Args args;
+  args.cancellation_manager = &state->cm;
+  for (int i = 0; i < num_keys; ++i) {
+    env_->rendezvous_mgr->RecvLocalAsync(
+        step_id, parsed[i], args,
+        [i, state, finish](const Status& status,
+                           const Rendezvous::Args& send_args,
+                           const Rendezvous::Args& recv_args, const Tensor& val,
+                           const bool is_dead) {
+          bool start_cancel = false;
+          bool last = false;
+          {
+            mutex_lock l(state->mu);
+            if (status.ok()) {
+              state->received.push_back({i, val, is_dead});
+            } else if (!(errors::IsCancelled(status) &&
+                         state->cm.IsCancelled())) {
+              state->status.Update(status);
+            }
+            if (!state->cancel_started) {
+              state->cancel_started = true;
+              start_cancel = true;
+            }
+            last = --state->pending == 0;
+          }
+          // Stop waiting for the tensors that are not ready yet. The
+          // receives still pending complete with a cancelled status.
+          if (start_cancel) state->cm.StartCancel();
+          if (last) finish();
+        });
+  }
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -0,0 +1,346 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/rpc_benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "absl/strings/str_format.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/protobuf/cluster.pb.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/reporter.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kJobName[] = "worker";
+constexpr char kOutputName[] = "y";
+
+string TaskDevice(int task) {
+  return strings::StrCat("/job:", kJobName, "/replica:0/task:", task,
+                         "/device:CPU:0");
+}
+
+const char* BenchmarkName(RpcBenchmarkType type) {
+  switch (type) {
+    case RpcBenchmarkType::kRecvTensor:
+      return "RecvTensor";
+    case RpcBenchmarkType::kRunGraph:
+      return "RunGraph";
+    case RpcBenchmarkType::kCollectiveReduce:
+      return "CollectiveReduce";
+  }
+  return "Unknown";
+}
+
+// Returns a float vector of `tensor_bytes` bytes, filled on `task`.
+Output FillOnTask(const Scope& scope, int task, int64 tensor_bytes) {
+  const int64 num_floats = std::max<int64>(tensor_bytes / sizeof(float), 1);
+  Scope on_task = scope.WithDevice(TaskDevice(task));
+  return ops::Fill(on_task, ops::Const(on_task, {num_floats}), 1.0f);
+}
+
+// Builds the graph of a step of `type`.  The step runs the node named
+// kOutputName on task 0, which only outputs a scalar so that the client
+// doesn't fetch the transferred tensors.
+Status BuildBenchmarkGraph(RpcBenchmarkType type, int64 tensor_bytes,
+                           int num_tasks, int instance_key, GraphDef* graph) {
+  Scope scope = Scope::NewRootScope();
+  Scope task0 = scope.WithDevice(TaskDevice(0));
+  switch (type) {
+    case RpcBenchmarkType::kRecvTensor:
+      ops::Sum(task0.WithOpName(kOutputName),
+               FillOnTask(scope, 1, tensor_bytes), 0);
+      break;
+    case RpcBenchmarkType::kRunGraph:
+      ops::NoOp(scope.WithDevice(TaskDevice(1)).WithOpName(kOutputName));
+      break;
+    case RpcBenchmarkType::kCollectiveReduce: {
+      // Task 0 waits for the collectives of the other tasks.
+      Output reduced;
+      std::vector<Operation> other_reduced;
+      for (int task = 0; task < num_tasks; ++task) {
+        const Scope on_task = scope.WithDevice(TaskDevice(task));
+        Node* node;
+        NodeBuilder builder(on_task.GetUniqueNameForOp("CollectiveReduce"),
+                            "CollectiveReduce");
+        builder.Input(FillOnTask(scope, task, tensor_bytes).node())
+            .Attr("group_size", num_tasks)
+            .Attr("group_key", 1)
+            .Attr("instance_key", instance_key)
+            .Attr("merge_op", "Add")
+            .Attr("final_op", "Id")
+            .Attr("subdiv_offsets", {0});
+        on_task.UpdateBuilder(&builder);
+        on_task.UpdateStatus(builder.Finalize(on_task.graph(), &node));
+        if (!on_task.ok()) return on_task.status();
+        if (task == 0) {
+          reduced = Output(node);
+        } else {
+          other_reduced.push_back(Operation(node));
+        }
+      }
+      ops::Sum(
+          task0.WithOpName(kOutputName).WithControlDependencies(other_reduced),
+          reduced, 0);
+      break;
+    }
+  }
+  return scope.ToGraphDef(graph);
+}
+
+// Returns the number of tasks of the cluster of `session`.
+Status CountTasks(Session* session, int* num_tasks) {
+  std::vector<DeviceAttributes> devices;
+  TF_RETURN_IF_ERROR(session->ListDevices(&devices));
+  *num_tasks = 0;
+  for (const DeviceAttributes& device : devices) {
+    DeviceNameUtils::ParsedName parsed;
+    if (DeviceNameUtils::ParseFullName(device.name(), &parsed) &&
+        parsed.job == kJobName && parsed.has_task) {
+      *num_tasks = std::max(*num_tasks, parsed.task + 1);
+    }
+  }
+  if (*num_tasks < 2) {
+    return errors::FailedPrecondition(
+        "The RPC benchmarks need at least 2 tasks in job \"", kJobName,
+        "\", found ", *num_tasks);
+  }
+  return Status::OK();
+}
+
+double Percentile(const std::vector<int64>& sorted_latencies, double p) {
+  const size_t index = std::min(
+      static_cast<size_t>(p * sorted_latencies.size()),
+      sorted_latencies.size() - 1);
+  return sorted_latencies[index];
+}
+
+Status RunBenchmark(const RpcBenchmarkOptions& options, RpcBenchmarkType type,
+                    int64 tensor_bytes, int concurrency, int num_tasks,
+                    int instance_key, RpcBenchmarkResult* result) {
+  SessionOptions session_options;
+  session_options.target = options.target;
+  // Keeps the transferred tensors from being folded into constants.
+  session_options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  session_options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  session_options.config.mutable_experimental()->set_collective_group_leader(
+      strings::StrCat("/job:", kJobName, "/replica:0/task:0"));
+  std::unique_ptr<Session> session(NewSession(session_options));
+  if (session == nullptr) {
+    return errors::Internal("Failed to create a session for ",
+                            options.target);
+  }
+  GraphDef graph;
+  TF_RETURN_IF_ERROR(BuildBenchmarkGraph(type, tensor_bytes, num_tasks,
+                                         instance_key, &graph));
+  TF_RETURN_IF_ERROR(session->Create(graph));
+
+  const bool has_output = type != RpcBenchmarkType::kRunGraph;
+  const std::vector<string> fetches =
+      has_output ? std::vector<string>{strings::StrCat(kOutputName, ":0")}
+                 : std::vector<string>{};
+  const std::vector<string> targets =
+      has_output ? std::vector<string>{} : std::vector<string>{kOutputName};
+  auto run_step = [&session, &fetches, &targets]() {
+    std::vector<Tensor> outputs;
+    return session->Run({}, fetches, targets, &outputs);
+  };
+  for (int64 i = 0; i < options.warmup_steps; ++i) {
+    TF_RETURN_IF_ERROR(run_step());
+  }
+
+  // Each thread runs steps until both minimums are reached.
+  Env* env = Env::Default();
+  const uint64 start_micros = env->NowMicros();
+  const uint64 min_end_micros = start_micros + options.min_duration_ms * 1000;
+  std::atomic<int64> num_started{0};
+  mutex mu;
+  Status status;
+  std::vector<int64> latencies;
+  auto run_steps = [&]() {
+    std::vector<int64> thread_latencies;
+    Status thread_status;
+    while (num_started.fetch_add(1) < options.min_steps ||
+           env->NowMicros() < min_end_micros) {
+      const uint64 step_start_micros = env->NowMicros();
+      thread_status = run_step();
+      if (!thread_status.ok()) break;
+      thread_latencies.push_back(env->NowMicros() - step_start_micros);
+    }
+    mutex_lock l(mu);
+    status.Update(thread_status);
+    latencies.insert(latencies.end(), thread_latencies.begin(),
+                     thread_latencies.end());
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < concurrency; ++i) {
+      threads.emplace_back(
+          env->StartThread(ThreadOptions(), "rpc_benchmark", run_steps));
+    }
+  }
+  const double wall_time_seconds = (env->NowMicros() - start_micros) / 1e6;
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(session->Close());
+  if (latencies.empty()) {
+    return errors::InvalidArgument("No step of ", BenchmarkName(type),
+                                   " was run");
+  }
+
+  result->type = type;
+  result->protocol = options.protocol;
+  result->tensor_bytes = tensor_bytes;
+  result->concurrency = concurrency;
+  result->num_steps = latencies.size();
+  result->wall_time_seconds = wall_time_seconds;
+  std::sort(latencies.begin(), latencies.end());
+  int64 total_latency = 0;
+  for (int64 latency : latencies) total_latency += latency;
+  result->mean_latency_us =
+      static_cast<double>(total_latency) / latencies.size();
+  result->p50_latency_us = Percentile(latencies, 0.5);
+  result->p90_latency_us = Percentile(latencies, 0.9);
+  result->p99_latency_us = Percentile(latencies, 0.99);
+  result->max_latency_us = latencies.back();
+  result->steps_per_second = latencies.size() / wall_time_seconds;
+  const int64 senders =
+      type == RpcBenchmarkType::kCollectiveReduce ? num_tasks : 1;
+  result->bytes_per_second =
+      result->steps_per_second * tensor_bytes * senders;
+  return Status::OK();
+}
+
+}  // namespace
+
+string RpcBenchmarkResult::Name() const {
+  return strings::StrCat(BenchmarkName(type), "/", protocol, "/",
+                         tensor_bytes, "B/", concurrency);
+}
+
+string RpcBenchmarkResultHeader() {
+  return absl::StrFormat("%-40s %8s %10s %10s %10s %10s %10s %12s\n",
+                         "benchmark", "steps", "mean_us", "p50_us", "p90_us",
+                         "p99_us", "steps/s", "MB/s");
+}
+
+string RpcBenchmarkResultRow(const RpcBenchmarkResult& result) {
+  return absl::StrFormat(
+      "%-40s %8d %10.1f %10.1f %10.1f %10.1f %10.1f %12.2f\n", result.Name(),
+      result.num_steps, result.mean_latency_us, result.p50_latency_us,
+      result.p90_latency_us, result.p99_latency_us, result.steps_per_second,
+      result.bytes_per_second / 1e6);
+}
+
+Status StartRpcBenchmarkServer(const std::vector<string>& host_ports,
+                               int task_index, const string& protocol,
+                               std::unique_ptr<ServerInterface>* server) {
+  if (task_index < 0 || task_index >= host_ports.size()) {
+    return errors::InvalidArgument("Task index ", task_index,
+                                   " is invalid for ", host_ports.size(),
+                                   " tasks");
+  }
+  ServerDef server_def;
+  server_def.set_protocol(protocol);
+  server_def.set_job_name(kJobName);
+  server_def.set_task_index(task_index);
+  JobDef* job_def = server_def.mutable_cluster()->add_job();
+  job_def->set_name(kJobName);
+  for (int i = 0; i < host_ports.size(); ++i) {
+    (*job_def->mutable_tasks())[i] = host_ports[i];
+  }
+  // The collective params of the workers are resolved by task 0.
+  server_def.mutable_default_session_config()
+      ->mutable_experimental()
+      ->set_collective_group_leader(
+          strings::StrCat("/job:", kJobName, "/replica:0/task:0"));
+  TF_RETURN_IF_ERROR(NewServer(server_def, server));
+  return (*server)->Start();
+}
+
+Status RunRpcBenchmarks(const RpcBenchmarkOptions& options,
+                        std::vector<RpcBenchmarkResult>* results) {
+  SessionOptions session_options;
+  session_options.target = options.target;
+  std::unique_ptr<Session> session(NewSession(session_options));
+  if (session == nullptr) {
+    return errors::Internal("Failed to create a session for ",
+                            options.target);
+  }
+  int num_tasks;
+  TF_RETURN_IF_ERROR(CountTasks(session.get(), &num_tasks));
+  TF_RETURN_IF_ERROR(session->Close());
+
+  // Each collective graph uses its own instance, as the instances of a group
+  // are resolved once for a shape.
+  int instance_key = 0;
+  for (RpcBenchmarkType type : options.benchmarks) {
+    const std::vector<int64> tensor_bytes =
+        type == RpcBenchmarkType::kRunGraph ? std::vector<int64>{0}
+                                            : options.tensor_bytes;
+    const std::vector<int> concurrency =
+        type == RpcBenchmarkType::kCollectiveReduce ? std::vector<int>{1}
+                                                    : options.concurrency;
+    for (int64 bytes : tensor_bytes) {
+      for (int threads : concurrency) {
+        RpcBenchmarkResult result;
+        TF_RETURN_IF_ERROR(RunBenchmark(options, type, bytes, threads,
+                                        num_tasks, ++instance_key, &result));
+        results->push_back(result);
+      }
+    }
+  }
+  return Status::OK();
+}
+
+Status ReportRpcBenchmarkResults(
+    const std::vector<RpcBenchmarkResult>& results) {
+  for (const RpcBenchmarkResult& result : results) {
+    TestReporter reporter(result.Name());
+    TF_RETURN_IF_ERROR(reporter.Initialize());
+    TF_RETURN_IF_ERROR(reporter.Benchmark(
+        result.num_steps, 0.0, result.mean_latency_us * result.num_steps / 1e6,
+        result.bytes_per_second));
+    TF_RETURN_IF_ERROR(reporter.AddMetric("p50_latency_us",
+                                          result.p50_latency_us));
+    TF_RETURN_IF_ERROR(reporter.AddMetric("p99_latency_us",
+                                          result.p99_latency_us));
+    TF_RETURN_IF_ERROR(reporter.AddMetric("steps_per_second",
+                                          result.steps_per_second));
+    TF_RETURN_IF_ERROR(reporter.Close());
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
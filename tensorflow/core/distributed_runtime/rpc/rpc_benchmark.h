@@ -0,0 +1,135 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_BENCHMARK_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_BENCHMARK_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Benchmarks the RPCs of the distributed runtime between real processes,
+// typically on different hosts: each task of a "worker" job runs a server,
+// e.g. with
+//
+//   rpc_benchmark_main --mode=server --protocol=grpc
+//       --cluster=host0:2222,host1:2222 --task_index=1
+//
+// and a client runs the benchmarks through the master of task 0:
+//
+//   rpc_benchmark_main --mode=client --target=grpc://host0:2222
+//       --protocol=grpc --tensor_bytes=4,65536,16777216 --concurrency=1,8
+//
+// Each benchmark runs steps of a small graph from several client threads at
+// once, and reports the latency distribution of the steps and their
+// throughput.  To compare transports, start one cluster per protocol.
+
+// The benchmarks run by RunRpcBenchmarks().
+enum class RpcBenchmarkType {
+  // A tensor sent from task 1 to task 0 in each step.
+  kRecvTensor,
+  // A step running a NoOp on task 1, i.e. one RunGraph RPC to task 1 besides
+  // the step on task 0.
+  kRunGraph,
+  // An all-reduce of a tensor over all the tasks in each step.
+  kCollectiveReduce,
+};
+
+struct RpcBenchmarkOptions {
+  // The target of the sessions, e.g. "grpc://host0:2222", whose task is
+  // task 0 of the benchmark.
+  string target;
+
+  // The protocol of the servers of the cluster, for the reports.
+  string protocol = "grpc";
+
+  std::vector<RpcBenchmarkType> benchmarks = {
+      RpcBenchmarkType::kRecvTensor, RpcBenchmarkType::kRunGraph,
+      RpcBenchmarkType::kCollectiveReduce};
+
+  // The sizes of the transferred tensors, for the benchmarks that transfer
+  // tensors.
+  std::vector<int64> tensor_bytes = {4, 64 << 10, 1 << 20, 16 << 20};
+
+  // The numbers of client threads running steps at once.  Collective
+  // benchmarks always run one step at a time, as the collectives of a graph
+  // can't run concurrently with themselves.
+  std::vector<int> concurrency = {1, 8};
+
+  // Each benchmark runs `warmup_steps` untimed steps, then at least
+  // `min_steps` steps and for at least `min_duration_ms` milliseconds.
+  int64 warmup_steps = 5;
+  int64 min_steps = 20;
+  int64 min_duration_ms = 2000;
+};
+
+struct RpcBenchmarkResult {
+  RpcBenchmarkType type = RpcBenchmarkType::kRecvTensor;
+  string protocol;
+  int64 tensor_bytes = 0;
+  int concurrency = 1;
+
+  int64 num_steps = 0;
+  double wall_time_seconds = 0;
+
+  // The latency of the steps, in microseconds.
+  double mean_latency_us = 0;
+  double p50_latency_us = 0;
+  double p90_latency_us = 0;
+  double p99_latency_us = 0;
+  double max_latency_us = 0;
+
+  double steps_per_second = 0;
+  // The bytes sent per second, i.e. the tensor bytes of each step, times the
+  // number of senders of a collective, over the wall time.
+  double bytes_per_second = 0;
+
+  // Returns a stable name for the configuration of the benchmark, e.g.
+  // "RecvTensor/grpc/1048576B/8", to compare the results of several runs.
+  string Name() const;
+};
+
+// Returns the header of the table of RpcBenchmarkResultRow().
+string RpcBenchmarkResultHeader();
+
+// Returns a fixed-width row of `result` for a table of results.
+string RpcBenchmarkResultRow(const RpcBenchmarkResult& result);
+
+// Starts a server for task `task_index` of a "worker" job whose tasks run on
+// `host_ports`, with the given protocol.
+Status StartRpcBenchmarkServer(const std::vector<string>& host_ports,
+                               int task_index, const string& protocol,
+                               std::unique_ptr<ServerInterface>* server);
+
+// Runs the benchmarks of `options`, for each tensor size and concurrency.
+Status RunRpcBenchmarks(const RpcBenchmarkOptions& options,
+                        std::vector<RpcBenchmarkResult>* results);
+
+// Writes `results` with TestReporter, i.e. to files prefixed by the
+// TEST_REPORT_FILE_PREFIX environment variable if it is set, so that runs can
+// be compared with tools/benchmark:compare_benchmarks.  The time per
+// iteration of each result is its mean latency.
+Status ReportRpcBenchmarkResults(
+    const std::vector<RpcBenchmarkResult>& results);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_BENCHMARK_H_
@@ -0,0 +1,138 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Runs a server of an RPC benchmark cluster, or the benchmarks against a
+// running cluster.  See rpc_benchmark.h.
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/distributed_runtime/rpc/rpc_benchmark.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace {
+
+// Parses a comma-separated list of positive integers into `values`, unless
+// it is empty.
+template <typename T>
+bool ParseList(const tensorflow::string& list, std::vector<T>* values) {
+  if (list.empty()) return true;
+  values->clear();
+  for (absl::string_view item : absl::StrSplit(list, ',')) {
+    T value;
+    if (!absl::SimpleAtoi(item, &value) || value <= 0) return false;
+    values->push_back(value);
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  using tensorflow::Flag;
+  using tensorflow::string;
+
+  string mode = "client";
+  string cluster;
+  int task_index = 0;
+  string benchmarks;
+  string tensor_bytes;
+  string concurrency;
+  bool report = false;
+  tensorflow::RpcBenchmarkOptions options;
+  std::vector<Flag> flag_list = {
+      Flag("mode", &mode, "server or client"),
+      Flag("protocol", &options.protocol, "protocol of the servers"),
+      Flag("cluster", &cluster,
+           "server: comma-separated host:port of the tasks of the cluster"),
+      Flag("task_index", &task_index, "server: task index of this server"),
+      Flag("target", &options.target,
+           "client: target of task 0, e.g. grpc://host0:2222"),
+      Flag("benchmarks", &benchmarks,
+           "client: comma-separated subset of RecvTensor, RunGraph and "
+           "CollectiveReduce, all if empty"),
+      Flag("tensor_bytes", &tensor_bytes,
+           "client: comma-separated sizes of the transferred tensors"),
+      Flag("concurrency", &concurrency,
+           "client: comma-separated numbers of steps run at once"),
+      Flag("warmup_steps", &options.warmup_steps,
+           "client: untimed steps run first"),
+      Flag("min_steps", &options.min_steps,
+           "client: minimum number of timed steps"),
+      Flag("min_duration_ms", &options.min_duration_ms,
+           "client: minimum duration of each benchmark"),
+      Flag("report", &report,
+           "client: also write the results with TestReporter, to files "
+           "prefixed by TEST_REPORT_FILE_PREFIX"),
+  };
+  const string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  const bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (!parse_result || argc > 1) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+
+  if (mode == "server") {
+    const std::vector<string> host_ports =
+        absl::StrSplit(cluster, ',', absl::SkipEmpty());
+    std::unique_ptr<tensorflow::ServerInterface> server;
+    TF_QCHECK_OK(tensorflow::StartRpcBenchmarkServer(
+        host_ports, task_index, options.protocol, &server));
+    TF_QCHECK_OK(server->Join());
+    return 0;
+  }
+  if (mode != "client" || options.target.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  if (!benchmarks.empty()) {
+    options.benchmarks.clear();
+    for (absl::string_view name : absl::StrSplit(benchmarks, ',')) {
+      if (name == "RecvTensor") {
+        options.benchmarks.push_back(tensorflow::RpcBenchmarkType::kRecvTensor);
+      } else if (name == "RunGraph") {
+        options.benchmarks.push_back(tensorflow::RpcBenchmarkType::kRunGraph);
+      } else if (name == "CollectiveReduce") {
+        options.benchmarks.push_back(
+            tensorflow::RpcBenchmarkType::kCollectiveReduce);
+      } else {
+        LOG(ERROR) << "Unknown benchmark " << name << "\n" << usage;
+        return -1;
+      }
+    }
+  }
+  if (!ParseList(tensor_bytes, &options.tensor_bytes) ||
+      !ParseList(concurrency, &options.concurrency)) {
+    LOG(ERROR) << "Invalid --tensor_bytes or --concurrency\n" << usage;
+    return -1;
+  }
+
+  std::vector<tensorflow::RpcBenchmarkResult> results;
+  TF_QCHECK_OK(tensorflow::RunRpcBenchmarks(options, &results));
+  printf("%s", tensorflow::RpcBenchmarkResultHeader().c_str());
+  for (const tensorflow::RpcBenchmarkResult& result : results) {
+    printf("%s", tensorflow::RpcBenchmarkResultRow(result).c_str());
+  }
+  if (report) {
+    TF_QCHECK_OK(tensorflow::ReportRpcBenchmarkResults(results));
+  }
+  return 0;
+}
@@ -0,0 +1,90 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/rpc_benchmark.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the target of a cluster of 2 tasks.  The servers are never
+// destroyed, as started gRPC servers can't be stopped.
+const string& ClusterTarget() {
+  static const string* target = [] {
+    std::vector<string> host_ports;
+    for (int i = 0; i < 2; ++i) {
+      host_ports.push_back(
+          strings::StrCat("localhost:", testing::PickUnusedPortOrDie()));
+    }
+    for (int i = 0; i < host_ports.size(); ++i) {
+      std::unique_ptr<ServerInterface> server;
+      TF_CHECK_OK(StartRpcBenchmarkServer(host_ports, i, "grpc", &server));
+      server.release();
+    }
+    return new string(strings::StrCat("grpc://", host_ports[0]));
+  }();
+  return *target;
+}
+
+class RpcBenchmarkTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    options_.target = ClusterTarget();
+    options_.tensor_bytes = {4, 4096};
+    options_.concurrency = {1, 2};
+    options_.warmup_steps = 1;
+    options_.min_steps = 4;
+    options_.min_duration_ms = 0;
+  }
+
+  RpcBenchmarkOptions options_;
+};
+
+TEST_F(RpcBenchmarkTest, RunsEachConfiguration) {
+  std::vector<RpcBenchmarkResult> results;
+  TF_ASSERT_OK(RunRpcBenchmarks(options_, &results));
+
+  // 2 sizes x 2 concurrencies of RecvTensor, 2 concurrencies of RunGraph,
+  // and 2 sizes of CollectiveReduce.
+  ASSERT_EQ(results.size(), 8);
+  EXPECT_EQ(results[0].Name(), "RecvTensor/grpc/4B/1");
+  EXPECT_EQ(results[3].Name(), "RecvTensor/grpc/4096B/2");
+  EXPECT_EQ(results[4].Name(), "RunGraph/grpc/0B/1");
+  EXPECT_EQ(results[7].Name(), "CollectiveReduce/grpc/4096B/1");
+  for (const RpcBenchmarkResult& result : results) {
+    EXPECT_GE(result.num_steps, options_.min_steps) << result.Name();
+    EXPECT_GT(result.mean_latency_us, 0) << result.Name();
+    EXPECT_LE(result.p50_latency_us, result.p99_latency_us) << result.Name();
+    EXPECT_LE(result.p99_latency_us, result.max_latency_us) << result.Name();
+    EXPECT_GT(result.steps_per_second, 0) << result.Name();
+    EXPECT_TRUE(absl::StartsWith(RpcBenchmarkResultRow(result), result.Name()));
+  }
+  // CollectiveReduce sends the tensor of each task.
+  EXPECT_DOUBLE_EQ(results[7].bytes_per_second,
+                   results[7].steps_per_second * 4096 * 2);
+}
+
+TEST(RpcBenchmarkServerTest, RejectsInvalidTaskIndex) {
+  std::unique_ptr<ServerInterface> server;
+  EXPECT_FALSE(
+      StartRpcBenchmarkServer({"localhost:0"}, 1, "grpc", &server).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -27,21 +29,42 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+auto* recv_tensor_batch_size = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/rpc_recv_tensor_batch_size",
+     "The number of tensors per RecvTensorBatch RPC, by whether they were "
+     "requested or received.",
+     "kind"},
+    // Power of 2 with bucket count 12 (up to 4096 tensors)
+    {monitoring::Buckets::Exponential(1, 2, 12)});
+
+// A receive waiting to be sent to its source worker in a RecvTensorBatch.
+struct PendingRecv {
+  Rendezvous::ParsedKey parsed;
+  Rendezvous::Args recv_args;
+  Rendezvous::DoneCallback done;
+  Device* dst_device = nullptr;
+};
+
+class RpcRecvTensorBatchCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id, bool batch_recvs)
+      : BaseRemoteRendezvous(env, step_id), batch_recvs_(batch_recvs) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -51,6 +74,21 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Receives one tensor with a RecvTensor RPC.
+  void RecvTensorFromRemote(const Rendezvous::ParsedKey& parsed,
+                            const Rendezvous::Args& recv_args,
+                            DoneCallback done);
+
+  // Sends the receives pending for `src_worker` in one RecvTensorBatch RPC.
+  void FlushBatch(const string& src_worker);
+  void RecvBatchDone(RpcRecvTensorBatchCall* call, const Status& s);
+
+  const bool batch_recvs_;
+
+  mutex batch_mu_;
+  std::unordered_map<string, std::vector<PendingRecv>> pending_batches_
+      TF_GUARDED_BY(batch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -70,6 +108,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    req_.set_accept_encoded_content(true);
   }
 
   void Reset() {
@@ -230,10 +269,245 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Used only to retrieve a batch of tensors from a remote process.
+class RpcRecvTensorBatchCall : public BaseRecvTensorCall {
+ public:
+  RpcRecvTensorBatchCall(WorkerInterface* wi, const string& src_worker,
+                         int64 step_id, std::vector<PendingRecv> recvs)
+      : wi_(wi), src_worker_(src_worker), recvs_(std::move(recvs)) {
+    req_.set_step_id(step_id);
+    for (const PendingRecv& recv : recvs_) {
+      const StringPiece key = recv.parsed.FullKey();
+      req_.add_rendezvous_key(key.data(), key.size());
+    }
+    req_.set_request_id(GetUniqueRequestId());
+  }
+
+  ~RpcRecvTensorBatchCall() override {
+    CHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "Leaking WorkerInterface in RpcRecvTensorBatchCall destructor.";
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    auto abort_checked = std::make_shared<Notification>();
+    auto cb = [this, abort_checked,
+               recv_done = std::move(recv_done)](const Status& s) {
+      abort_checked->WaitForNotification();
+      if (!s.ok()) {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+    };
+    wi_->RecvTensorBatchAsync(&opts_, &req_, &resp_, std::move(cb));
+
+    // NOTE: As in RpcRecvTensorCall, check for an abort only after sending
+    // out the RPC, so that it is cancelled either way.
+    if (!status().ok()) {
+      opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  void ReleaseWorker(WorkerCacheInterface* worker_cache) {
+    worker_cache->ReleaseWorker(src_worker_, wi_);
+    wi_ = nullptr;
+  }
+
+  std::vector<PendingRecv>* recvs() { return &recvs_; }
+  const RecvTensorBatchResponse& response() const { return resp_; }
+
+ private:
+  WorkerInterface* wi_;  // Not owned.
+  const string src_worker_;
+  std::vector<PendingRecv> recvs_;
+  CallOptions opts_;
+  RecvTensorBatchRequest req_;
+  RecvTensorBatchResponse resp_;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorBatchCall);
+};
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
   CHECK(is_initialized());
+  string src_worker;
+  string src_rel_device;
+  // Only tensors sent from CPU devices are batched, since the sender would
+  // otherwise have to copy each of them to the host before responding.
+  if (!batch_recvs_ || parsed.src.type != "CPU" ||
+      !DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    RecvTensorFromRemote(parsed, recv_args, std::move(done));
+    return;
+  }
+  bool schedule_flush;
+  {
+    mutex_lock l(batch_mu_);
+    std::vector<PendingRecv>& pending = pending_batches_[src_worker];
+    schedule_flush = pending.empty();
+    pending.push_back({parsed, recv_args, std::move(done)});
+  }
+  // The receives issued until the flush runs join the same batch.
+  if (schedule_flush) {
+    Ref();
+    SchedClosure([this, src_worker]() {
+      FlushBatch(src_worker);
+      Unref();
+    });
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker) {
+  std::vector<PendingRecv> recvs;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(src_worker);
+    recvs.swap(it->second);
+    pending_batches_.erase(it);
+  }
+  if (recvs.size() == 1) {
+    RecvTensorFromRemote(recvs[0].parsed, recvs[0].recv_args,
+                         std::move(recvs[0].done));
+    return;
+  }
+
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+  WorkerInterface* rwi = worker_cache->GetOrCreateWorker(src_worker);
+  if (rwi == nullptr) {
+    Status s = errors::Internal("No worker known as ", src_worker);
+    for (PendingRecv& recv : recvs) {
+      recv.done(s, Args(), recv.recv_args, Tensor{}, false);
+    }
+    return;
+  }
+  std::vector<PendingRecv> batch;
+  batch.reserve(recvs.size());
+  for (PendingRecv& recv : recvs) {
+    Status s = sess->device_mgr()->LookupDevice(recv.parsed.dst_device,
+                                                &recv.dst_device);
+    if (s.ok()) {
+      batch.push_back(std::move(recv));
+    } else {
+      recv.done(s, Args(), recv.recv_args, Tensor{}, false);
+    }
+  }
+  if (batch.empty()) {
+    worker_cache->ReleaseWorker(src_worker, rwi);
+    return;
+  }
+  const Rendezvous::Args recv_args = batch[0].recv_args;
+  RpcRecvTensorBatchCall* call =
+      new RpcRecvTensorBatchCall(rwi, src_worker, step_id_, std::move(batch));
+
+  // Record "call" in active_ so that it can be aborted cleanly.
+  RegisterCall(call, recv_args);
+  if (!call->status().ok()) {
+    DeregisterCall(call);
+    call->ReleaseWorker(worker_cache.get());
+    RecvBatchDone(call, call->status());
+    delete call;
+    return;
+  }
+
+  Ref();
+  call->Start([this, call, worker_cache]() {
+    // Removes "call" from active_. Prevent StartAbort().
+    DeregisterCall(call);
+    Status s = call->status();
+    call->ReleaseWorker(worker_cache.get());
+    RecvBatchDone(call, s);
+    delete call;
+    Unref();
+  });
+}
+
+void RpcRemoteRendezvous::RecvBatchDone(RpcRecvTensorBatchCall* call,
+                                        const Status& s) {
+  std::vector<PendingRecv>& recvs = *call->recvs();
+  if (errors::IsUnimplemented(s)) {
+    // The source worker predates RecvTensorBatch.
+    for (PendingRecv& recv : recvs) {
+      RecvTensorFromRemote(recv.parsed, recv.recv_args, std::move(recv.done));
+    }
+    return;
+  }
+  const RecvTensorBatchResponse& resp = call->response();
+  Status status = s;
+  std::vector<bool> received(recvs.size(), false);
+  if (status.ok() && resp.index_size() != resp.response_size()) {
+    status = errors::Internal("RecvTensorBatch returned ", resp.index_size(),
+                              " indices for ", resp.response_size(),
+                              " tensors");
+  }
+  for (int j = 0; status.ok() && j < resp.index_size(); ++j) {
+    const int i = resp.index(j);
+    if (i < 0 || i >= static_cast<int>(recvs.size()) || received[i]) {
+      status = errors::Internal("RecvTensorBatch returned invalid index ", i);
+    } else {
+      received[i] = true;
+    }
+  }
+  if (!status.ok()) {
+    for (PendingRecv& recv : recvs) {
+      recv.done(status, Args(), recv.recv_args, Tensor{}, false);
+    }
+    return;
+  }
+
+  recv_tensor_batch_size->GetCell("requested")->Add(recvs.size());
+  recv_tensor_batch_size->GetCell("received")->Add(resp.index_size());
+  for (int j = 0; j < resp.index_size(); ++j) {
+    PendingRecv& recv = recvs[resp.index(j)];
+    const RecvTensorResponse& r = resp.response(j);
+    const AllocatorAttributes& attrs = recv.recv_args.alloc_attrs;
+    Tensor val;
+    Status decoded;
+    if (r.is_dead()) {
+      // A dead tensor has no value.
+    } else if (attrs.on_host() ||
+               recv.dst_device->tensorflow_gpu_device_info() == nullptr) {
+      if (!val.FromProto(recv.dst_device->GetAllocator(attrs), r.tensor())) {
+        decoded = errors::InvalidArgument("Cannot parse tensor from proto");
+      }
+    } else {
+      decoded =
+          recv.dst_device->MakeTensorFromProto(r.tensor(), attrs, &val);
+    }
+    recv.done(decoded, Args(), recv.recv_args, val, r.is_dead());
+  }
+  // The source worker only returns the tensors that were ready: ask again
+  // for the others.
+  for (size_t i = 0; i < recvs.size(); ++i) {
+    if (!received[i]) {
+      RecvFromRemoteAsync(recvs[i].parsed, recvs[i].recv_args,
+                          std::move(recvs[i].done));
+    }
+  }
+}
+
+void RpcRemoteRendezvous::RecvTensorFromRemote(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
   Status s;
 
   // Prepare a RecvTensor call that can handle being aborted.
@@ -308,11 +582,17 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : BaseRendezvousMgr(env) {
+  Status s = ReadBoolFromEnvVar("TF_RPC_BATCH_RECV_TENSORS", false,
+                                &batch_recvs_);
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to read TF_RPC_BATCH_RECV_TENSORS: " << s;
+  }
+}
 
 BaseRemoteRendezvous* RpcRendezvousMgr::Create(int64 step_id,
                                                const WorkerEnv* worker_env) {
-  return new RpcRemoteRendezvous(worker_env, step_id);
+  return new RpcRemoteRendezvous(worker_env, step_id, batch_recvs_);
 }
 
 }  // end namespace tensorflow
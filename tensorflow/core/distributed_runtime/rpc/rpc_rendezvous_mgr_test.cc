@@ -15,13 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/control_flow.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -66,6 +70,26 @@ class DummyWorker : public TestWorkerInterface {
       done(Status::OK());
     });
   }
+
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    num_batch_calls_.fetch_add(1);
+    SchedClosure([request, response, done = std::move(done)]() {
+      for (int i = 0; i < request->rendezvous_key_size(); ++i) {
+        response->add_index(i);
+        V("batched").AsProtoTensorContent(
+            response->add_response()->mutable_tensor());
+      }
+      done(Status::OK());
+    });
+  }
+
+  int num_batch_calls() const { return num_batch_calls_.load(); }
+
+ private:
+  std::atomic<int> num_batch_calls_{0};
 };
 
 // Fake cache implementation for WorkerEnv.
@@ -91,6 +115,8 @@ class DummyWorkerCache : public WorkerCacheInterface {
   void GetDeviceLocalityAsync(const string& device, DeviceLocality* locality,
                               StatusCallback done) override {}
 
+  DummyWorker* dummy_remote_worker() const { return dummy_remote_worker_; }
+
  private:
   DummyWorker* dummy_remote_worker_ = nullptr;
 };
@@ -100,7 +126,9 @@ static Device* CreateDevice(const char* type, const char* name) {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return Status::OK(); }
-    Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -344,4 +372,49 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncBatched) {
+  setenv("TF_RPC_BATCH_RECV_TENSORS", "true", 1);
+  RpcRendezvousMgr rmgr(&env);
+  unsetenv("TF_RPC_BATCH_RECV_TENSORS");
+  const int64 step_id = 123;
+  const int num_keys = 100;
+  {
+    RemoteRendezvous* rendez = rmgr.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    core::ScopedUnref unref(rendez);
+    Rendezvous::Args args;
+
+    mutex mu;
+    Status status = Status::OK();
+    std::vector<string> values(num_keys);
+    BlockingCounter counter(num_keys);
+    for (int i = 0; i < num_keys; i++) {
+      const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+          "/job:worker/replica:1/task:2/cpu:0", 7890,
+          "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("foo", i),
+          FrameAndIter(0, 0)));
+      rendez->RecvAsync(
+          key, args,
+          [i, &mu, &status, &values, &counter](
+              const Status& s, const Rendezvous::Args&,
+              const Rendezvous::Args&, const Tensor& val, const bool) {
+            {
+              mutex_lock l(mu);
+              status.Update(s);
+              if (s.ok()) values[i] = V(val);
+            }
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    TF_ASSERT_OK(status);
+    for (const string& value : values) {
+      EXPECT_EQ(value, "batched");
+    }
+  }
+  EXPECT_GT(cache_->dummy_remote_worker()->num_batch_calls(), 0);
+  EXPECT_LT(cache_->dummy_remote_worker()->num_batch_calls(), num_keys);
+  rmgr.Cleanup(step_id);
+}
+
 }  // namespace tensorflow
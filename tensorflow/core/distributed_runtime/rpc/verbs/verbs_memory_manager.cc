@@ -0,0 +1,456 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_memory_manager.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+
+#include "tensorflow/core/common_runtime/process_state.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The depth of the send and receive queues of each connection.
+constexpr int kQueueDepth = 1024;
+// The depth of the completion queue shared by all connections.
+constexpr int kCompletionQueueDepth = 16 * kQueueDepth;
+// How often Run() checks whether it was stopped.
+constexpr int kPollTimeoutMs = 100;
+
+ibv_qp_init_attr QueuePairAttributes(ibv_cq* cq) {
+  ibv_qp_init_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.send_cq = cq;
+  attr.recv_cq = cq;
+  attr.qp_type = IBV_QPT_RC;
+  attr.cap.max_send_wr = kQueueDepth;
+  attr.cap.max_recv_wr = kQueueDepth;
+  attr.cap.max_send_sge = 1;
+  attr.cap.max_recv_sge = 1;
+  return attr;
+}
+
+Status ErrnoError(const char* what) {
+  return errors::Unavailable(what, " failed: ", strerror(errno));
+}
+
+}  // namespace
+
+struct VerbsMemoryManager::WorkRequest {
+  enum Kind { kRead, kAck, kRecv };
+
+  Kind kind;
+  rdma_cm_id* id = nullptr;
+  uint32 tensor_key = 0;
+  StatusCallback done;
+};
+
+VerbsMemoryManager::VerbsMemoryManager(const string& host, const string& port)
+    : host_(host), port_(port) {}
+
+VerbsMemoryManager::~VerbsMemoryManager() {
+  Stop();
+  mutex_lock l(mu_);
+  for (auto& it : endpoints_) {
+    rdma_disconnect(it.second);
+    rdma_destroy_ep(it.second);
+  }
+  for (auto& it : accepted_) {
+    rdma_destroy_qp(it.first);
+    rdma_destroy_id(it.first);
+  }
+  if (listener_ != nullptr) rdma_destroy_id(listener_);
+  if (cq_ != nullptr) ibv_destroy_cq(cq_);
+  if (comp_channel_ != nullptr) ibv_destroy_comp_channel(comp_channel_);
+  // The memory regions and the protection domain are left registered, since
+  // the CPU allocators outlive this object.
+  if (event_channel_ != nullptr) rdma_destroy_event_channel(event_channel_);
+}
+
+Status VerbsMemoryManager::Init() {
+  rdma_addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_port_space = RDMA_PS_TCP;
+  hints.ai_flags = RAI_PASSIVE;
+  rdma_addrinfo* addrinfo;
+  if (rdma_getaddrinfo(const_cast<char*>(host_.c_str()),
+                       const_cast<char*>(port_.c_str()), &hints, &addrinfo)) {
+    return ErrnoError("rdma_getaddrinfo");
+  }
+  event_channel_ = rdma_create_event_channel();
+  if (event_channel_ == nullptr) {
+    rdma_freeaddrinfo(addrinfo);
+    return ErrnoError("rdma_create_event_channel");
+  }
+  if (rdma_create_id(event_channel_, &listener_, nullptr, RDMA_PS_TCP)) {
+    rdma_freeaddrinfo(addrinfo);
+    return ErrnoError("rdma_create_id");
+  }
+  const int bind_failed = rdma_bind_addr(listener_, addrinfo->ai_src_addr);
+  rdma_freeaddrinfo(addrinfo);
+  if (bind_failed) return ErrnoError("rdma_bind_addr");
+  if (listener_->verbs == nullptr) {
+    return errors::InvalidArgument(
+        "The verbs transport must listen on the address of an RDMA device, "
+        "not on ",
+        host_);
+  }
+  if (rdma_listen(listener_, kQueueDepth)) return ErrnoError("rdma_listen");
+  const int flags = fcntl(event_channel_->fd, F_GETFL);
+  if (fcntl(event_channel_->fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+    return ErrnoError("fcntl");
+  }
+
+  pd_ = ibv_alloc_pd(listener_->verbs);
+  if (pd_ == nullptr) return ErrnoError("ibv_alloc_pd");
+  comp_channel_ = ibv_create_comp_channel(listener_->verbs);
+  if (comp_channel_ == nullptr) return ErrnoError("ibv_create_comp_channel");
+  cq_ = ibv_create_cq(listener_->verbs, kCompletionQueueDepth, nullptr,
+                      comp_channel_, 0);
+  if (cq_ == nullptr) return ErrnoError("ibv_create_cq");
+  if (ibv_req_notify_cq(cq_, 0)) return ErrnoError("ibv_req_notify_cq");
+
+  ProcessState::singleton()->AddCPUAllocVisitor(
+      [this](void* ptr, int /*numa_node*/, size_t num_bytes) {
+        RegisterRegion(ptr, num_bytes);
+      });
+  ProcessState::singleton()->AddCPUFreeVisitor(
+      [this](void* ptr, int /*numa_node*/, size_t /*num_bytes*/) {
+        DeregisterRegion(ptr);
+      });
+  LOG(INFO) << "Verbs transport listening on " << host_ << ":" << port_;
+  return Status::OK();
+}
+
+void VerbsMemoryManager::Run() {
+  pollfd fds[2];
+  fds[0].fd = event_channel_->fd;
+  fds[0].events = POLLIN;
+  fds[1].fd = comp_channel_->fd;
+  fds[1].events = POLLIN;
+  while (!stopped_.load(std::memory_order_relaxed)) {
+    fds[0].revents = 0;
+    fds[1].revents = 0;
+    const int ret = poll(fds, 2, kPollTimeoutMs);
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      LOG(ERROR) << ErrnoError("poll");
+      return;
+    }
+    if (fds[0].revents & POLLIN) HandleConnectionEvent();
+    if (fds[1].revents & POLLIN) HandleCompletions();
+  }
+}
+
+void VerbsMemoryManager::Stop() {
+  stopped_.store(true, std::memory_order_relaxed);
+}
+
+ibv_mr* VerbsMemoryManager::FindRegion(const void* addr, size_t size) {
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(addr);
+  mutex_lock l(regions_mu_);
+  auto it = regions_.upper_bound(begin);
+  if (it == regions_.end()) return nullptr;
+  ibv_mr* mr = it->second;
+  if (begin < reinterpret_cast<uintptr_t>(mr->addr) ||
+      begin + size > it->first) {
+    return nullptr;
+  }
+  return mr;
+}
+
+void VerbsMemoryManager::RegisterRegion(void* ptr, size_t num_bytes) {
+  const int access = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ |
+                     IBV_ACCESS_REMOTE_WRITE;
+  ibv_mr* mr = ibv_reg_mr(pd_, ptr, num_bytes, access);
+  if (mr == nullptr) {
+    // Tensors in this region are sent and received through gRPC instead.
+    LOG(WARNING) << ErrnoError("ibv_reg_mr") << " for " << num_bytes
+                 << " bytes";
+    return;
+  }
+  mutex_lock l(regions_mu_);
+  regions_[reinterpret_cast<uintptr_t>(ptr) + num_bytes] = mr;
+}
+
+void VerbsMemoryManager::DeregisterRegion(void* ptr) {
+  ibv_mr* mr = nullptr;
+  {
+    mutex_lock l(regions_mu_);
+    auto it = regions_.upper_bound(reinterpret_cast<uintptr_t>(ptr));
+    if (it == regions_.end() || it->second->addr != ptr) return;
+    mr = it->second;
+    regions_.erase(it);
+  }
+  ibv_dereg_mr(mr);
+}
+
+bool VerbsMemoryManager::IsRegistered(const Tensor& tensor) {
+  const StringPiece buf = tensor.tensor_data();
+  return FindRegion(buf.data(), buf.size()) != nullptr;
+}
+
+Status VerbsMemoryManager::Expose(const Tensor& tensor,
+                                  RemoteMemoryRegion* region) {
+  const StringPiece buf = tensor.tensor_data();
+  ibv_mr* mr = FindRegion(buf.data(), buf.size());
+  if (mr == nullptr) {
+    return errors::FailedPrecondition("Tensor buffer is not registered");
+  }
+  region->set_host(host_);
+  region->set_port(port_);
+  region->set_addr(reinterpret_cast<uint64>(buf.data()));
+  region->set_size(buf.size());
+  region->set_rkey(mr->rkey);
+  mutex_lock l(mu_);
+  const uint32 tensor_key = next_tensor_key_++;
+  pinned_[tensor_key] = tensor;
+  region->set_tensor_key(tensor_key);
+  return Status::OK();
+}
+
+void VerbsMemoryManager::Read(const RemoteMemoryRegion& region,
+                              Tensor* tensor, StatusCallback done) {
+  const StringPiece buf = tensor->tensor_data();
+  rdma_cm_id* id = nullptr;
+  Status s = GetEndpoint(region.host(), region.port(), &id);
+  if (s.ok() && buf.size() != region.size()) {
+    s = errors::Internal("Expected ", buf.size(), " bytes, but the sender has ",
+                         region.size());
+  }
+  ibv_mr* mr = FindRegion(buf.data(), buf.size());
+  if (s.ok() && mr == nullptr) {
+    s = errors::FailedPrecondition("Tensor buffer is not registered");
+  }
+  if (!s.ok()) {
+    if (id != nullptr) PostAck(id, region.tensor_key());
+    done(s);
+    return;
+  }
+
+  WorkRequest* request = new WorkRequest;
+  request->kind = WorkRequest::kRead;
+  request->id = id;
+  request->tensor_key = region.tensor_key();
+  request->done = std::move(done);
+
+  ibv_sge sge;
+  sge.addr = reinterpret_cast<uint64>(buf.data());
+  sge.length = buf.size();
+  sge.lkey = mr->lkey;
+  ibv_send_wr wr;
+  memset(&wr, 0, sizeof(wr));
+  wr.wr_id = reinterpret_cast<uint64>(request);
+  wr.sg_list = &sge;
+  wr.num_sge = 1;
+  wr.opcode = IBV_WR_RDMA_READ;
+  wr.send_flags = IBV_SEND_SIGNALED;
+  wr.wr.rdma.remote_addr = region.addr();
+  wr.wr.rdma.rkey = region.rkey();
+  ibv_send_wr* bad_wr;
+  if (ibv_post_send(id->qp, &wr, &bad_wr)) {
+    s = ErrnoError("ibv_post_send");
+    PostAck(id, region.tensor_key());
+    StatusCallback cb = std::move(request->done);
+    delete request;
+    cb(s);
+  }
+}
+
+Status VerbsMemoryManager::GetEndpoint(const string& host, const string& port,
+                                       rdma_cm_id** id) {
+  const string key = strings::StrCat(host, ":", port);
+  mutex_lock l(mu_);
+  auto it = endpoints_.find(key);
+  if (it != endpoints_.end()) {
+    *id = it->second;
+    return Status::OK();
+  }
+  rdma_addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_port_space = RDMA_PS_TCP;
+  rdma_addrinfo* addrinfo;
+  if (rdma_getaddrinfo(const_cast<char*>(host.c_str()),
+                       const_cast<char*>(port.c_str()), &hints, &addrinfo)) {
+    return ErrnoError("rdma_getaddrinfo");
+  }
+  ibv_qp_init_attr attr = QueuePairAttributes(cq_);
+  const int create_failed = rdma_create_ep(id, addrinfo, pd_, &attr);
+  rdma_freeaddrinfo(addrinfo);
+  if (create_failed) return ErrnoError("rdma_create_ep");
+  if (rdma_connect(*id, nullptr)) {
+    const Status s = ErrnoError("rdma_connect");
+    rdma_destroy_ep(*id);
+    *id = nullptr;
+    return s;
+  }
+  VLOG(1) << "Verbs transport connected to " << key;
+  endpoints_[key] = *id;
+  return Status::OK();
+}
+
+void VerbsMemoryManager::HandleConnectionEvent() {
+  rdma_cm_event* event;
+  while (rdma_get_cm_event(event_channel_, &event) == 0) {
+    // The event must be acknowledged before its id can be destroyed.
+    const rdma_cm_event_type type = event->event;
+    rdma_cm_id* id = event->id;
+    rdma_ack_cm_event(event);
+    switch (type) {
+      case RDMA_CM_EVENT_CONNECT_REQUEST:
+        Accept(id);
+        break;
+      case RDMA_CM_EVENT_DISCONNECTED:
+        Disconnect(id);
+        break;
+      default:
+        VLOG(2) << "Ignoring " << rdma_event_str(type);
+        break;
+    }
+  }
+}
+
+void VerbsMemoryManager::Accept(rdma_cm_id* id) {
+  ibv_qp_init_attr attr = QueuePairAttributes(cq_);
+  if (rdma_create_qp(id, pd_, &attr)) {
+    LOG(ERROR) << ErrnoError("rdma_create_qp");
+    rdma_reject(id, nullptr, 0);
+    rdma_destroy_id(id);
+    return;
+  }
+  WorkRequest* request = new WorkRequest;
+  request->kind = WorkRequest::kRecv;
+  request->id = id;
+  {
+    mutex_lock l(mu_);
+    recv_requests_.emplace_back(request);
+    accepted_[id] = request;
+  }
+  for (int i = 0; i < kQueueDepth; ++i) {
+    const Status s = PostRecv(request);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      break;
+    }
+  }
+  if (rdma_accept(id, nullptr)) {
+    LOG(ERROR) << ErrnoError("rdma_accept");
+    Disconnect(id);
+  }
+}
+
+void VerbsMemoryManager::Disconnect(rdma_cm_id* id) {
+  {
+    mutex_lock l(mu_);
+    if (accepted_.erase(id) == 0) return;
+  }
+  rdma_disconnect(id);
+  rdma_destroy_qp(id);
+  rdma_destroy_id(id);
+}
+
+Status VerbsMemoryManager::PostRecv(WorkRequest* request) {
+  ibv_recv_wr wr;
+  memset(&wr, 0, sizeof(wr));
+  wr.wr_id = reinterpret_cast<uint64>(request);
+  ibv_recv_wr* bad_wr;
+  if (ibv_post_recv(request->id->qp, &wr, &bad_wr)) {
+    return ErrnoError("ibv_post_recv");
+  }
+  return Status::OK();
+}
+
+void VerbsMemoryManager::PostAck(rdma_cm_id* id, uint32 tensor_key) {
+  static WorkRequest* ack_request = [] {
+    WorkRequest* request = new WorkRequest;
+    request->kind = WorkRequest::kAck;
+    return request;
+  }();
+  ibv_send_wr wr;
+  memset(&wr, 0, sizeof(wr));
+  wr.wr_id = reinterpret_cast<uint64>(ack_request);
+  wr.opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+  wr.send_flags = IBV_SEND_SIGNALED;
+  wr.imm_data = htonl(tensor_key);
+  ibv_send_wr* bad_wr;
+  if (ibv_post_send(id->qp, &wr, &bad_wr)) {
+    // The sender keeps the tensor pinned until the connection is dropped.
+    LOG(WARNING) << ErrnoError("ibv_post_send") << " for tensor "
+                 << tensor_key;
+  }
+}
+
+void VerbsMemoryManager::HandleCompletions() {
+  ibv_cq* cq;
+  void* context;
+  if (ibv_get_cq_event(comp_channel_, &cq, &context)) return;
+  ibv_ack_cq_events(cq, 1);
+  if (ibv_req_notify_cq(cq, 0)) {
+    LOG(ERROR) << ErrnoError("ibv_req_notify_cq");
+  }
+  ibv_wc wcs[32];
+  int n;
+  while ((n = ibv_poll_cq(cq, 32, wcs)) > 0) {
+    for (int i = 0; i < n; ++i) {
+      const ibv_wc& wc = wcs[i];
+      WorkRequest* request = reinterpret_cast<WorkRequest*>(wc.wr_id);
+      switch (request->kind) {
+        case WorkRequest::kRecv: {
+          // Receives are flushed with an error when the connection closes.
+          if (wc.status != IBV_WC_SUCCESS) break;
+          {
+            mutex_lock l(mu_);
+            pinned_.erase(ntohl(wc.imm_data));
+          }
+          const Status s = PostRecv(request);
+          if (!s.ok()) LOG(ERROR) << s;
+          break;
+        }
+        case WorkRequest::kAck:
+          if (wc.status != IBV_WC_SUCCESS) {
+            LOG(WARNING) << "Release of remote tensor failed: "
+                         << ibv_wc_status_str(wc.status);
+          }
+          break;
+        case WorkRequest::kRead: {
+          Status s;
+          if (wc.status != IBV_WC_SUCCESS) {
+            s = errors::Unavailable("RDMA read failed: ",
+                                    ibv_wc_status_str(wc.status));
+          }
+          PostAck(request->id, request->tensor_key);
+          StatusCallback done = std::move(request->done);
+          delete request;
+          // The callback runs the receiving step, so it must not hold up
+          // the completion queue.
+          SchedClosure([done, s]() { done(s); });
+          break;
+        }
+      }
+    }
+  }
+  if (n < 0) LOG(ERROR) << "ibv_poll_cq failed";
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,123 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_MEMORY_MANAGER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_MEMORY_MANAGER_H_
+
+#include <rdma/rdma_cma.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+
+// Moves the content of host tensors between workers with one-sided RDMA
+// reads, leaving the RecvTensor RPC to carry only the tensor metadata.
+//
+// All host memory of the CPU allocators is registered with the RDMA device
+// when it is allocated. The sender pins a tensor with `Expose()` and returns
+// its memory region in the RecvTensor response; the receiver `Read()`s it
+// straight into the destination buffer and releases it with a zero-length
+// write whose immediate data is the tensor key. Reading rather than writing
+// saves the round trip the sender would need to learn the destination
+// buffer before it could transfer anything.
+//
+// Connections are made with the RDMA connection manager on the host and
+// port of the gRPC server.
+class VerbsMemoryManager {
+ public:
+  VerbsMemoryManager(const string& host, const string& port);
+  ~VerbsMemoryManager();
+
+  // Binds the listener and registers the allocation visitors of the CPU
+  // allocators.
+  // REQUIRES: must be called before ProcessState::GetCPUAllocator.
+  Status Init();
+
+  // Accepts connections and handles work completions until Stop().
+  void Run();
+  void Stop();
+
+  // Returns true if `tensor` can be the source or destination of a read.
+  bool IsRegistered(const Tensor& tensor);
+
+  // Pins `tensor` until the receiver has read it, and describes where to
+  // read it from in `region`.
+  Status Expose(const Tensor& tensor, RemoteMemoryRegion* region);
+
+  // Reads the tensor described by `region` into the registered buffer of
+  // `tensor`, releases the remote tensor, and then calls `done`.
+  void Read(const RemoteMemoryRegion& region, Tensor* tensor,
+            StatusCallback done);
+
+ private:
+  struct WorkRequest;
+
+  ibv_mr* FindRegion(const void* addr, size_t size);
+  void RegisterRegion(void* ptr, size_t num_bytes);
+  void DeregisterRegion(void* ptr);
+
+  Status GetEndpoint(const string& host, const string& port,
+                     rdma_cm_id** id);
+  void HandleConnectionEvent();
+  void HandleCompletions();
+  void Accept(rdma_cm_id* id);
+  void Disconnect(rdma_cm_id* id);
+  Status PostRecv(WorkRequest* request);
+  void PostAck(rdma_cm_id* id, uint32 tensor_key);
+
+  const string host_;
+  const string port_;
+  std::atomic<bool> stopped_{false};
+
+  rdma_event_channel* event_channel_ = nullptr;
+  rdma_cm_id* listener_ = nullptr;
+  ibv_pd* pd_ = nullptr;
+  ibv_comp_channel* comp_channel_ = nullptr;
+  ibv_cq* cq_ = nullptr;
+
+  mutex regions_mu_;
+  // Registered memory regions, keyed by their end address.
+  std::map<uintptr_t, ibv_mr*> regions_ TF_GUARDED_BY(regions_mu_);
+
+  mutex mu_;
+  uint32 next_tensor_key_ TF_GUARDED_BY(mu_) = 0;
+  std::unordered_map<uint32, Tensor> pinned_ TF_GUARDED_BY(mu_);
+  // Connections made to read from other workers, keyed by "host:port".
+  std::unordered_map<string, rdma_cm_id*> endpoints_ TF_GUARDED_BY(mu_);
+  // Connections accepted from other workers, with their receive requests.
+  std::unordered_map<rdma_cm_id*, WorkRequest*> accepted_ TF_GUARDED_BY(mu_);
+  // The receive requests of accepted connections. They are kept until
+  // destruction, since flushed completions can still refer to them after
+  // their connection is gone.
+  std::vector<std::unique_ptr<WorkRequest>> recv_requests_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(VerbsMemoryManager);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_MEMORY_MANAGER_H_
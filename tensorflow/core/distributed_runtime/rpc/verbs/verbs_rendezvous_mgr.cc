@@ -0,0 +1,255 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_rendezvous_mgr.h"
+
+#include <string.h>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_state.h"
+#include "tensorflow/core/distributed_runtime/request_id.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/worker_cache.h"
+#include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Used only to retrieve tensors from remote processes.
+class VerbsRecvTensorCall : public BaseRecvTensorCall {
+ public:
+  VerbsRecvTensorCall(WorkerInterface* wi, int64 step_id, StringPiece key,
+                      const string& src_worker, Device* dst_device,
+                      const Rendezvous::Args& recv_args,
+                      Rendezvous::DoneCallback done,
+                      VerbsMemoryManager* memory_manager)
+      : wi_(wi),
+        src_worker_(src_worker),
+        dst_device_(dst_device),
+        recv_args_(recv_args),
+        done_(std::move(done)),
+        memory_manager_(memory_manager) {
+    req_.set_step_id(step_id);
+    req_.set_rendezvous_key(key.data(), key.size());
+    req_.set_request_id(GetUniqueRequestId());
+    // Devices other than accelerators allocate their tensors from the CPU
+    // allocators, whose memory is registered for RDMA.
+    if (recv_args.alloc_attrs.on_host() ||
+        dst_device->tensorflow_gpu_device_info() == nullptr) {
+      req_.mutable_transport_options()->PackFrom(RemoteMemoryRegion());
+    }
+  }
+
+  ~VerbsRecvTensorCall() override {
+    CHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "Leaking WorkerInterface in VerbsRecvTensorCall destructor.";
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    resp_.InitAlloc(dst_device_, recv_args_.alloc_attrs);
+    auto abort_checked = std::make_shared<Notification>();
+    auto cb = [this, abort_checked,
+               recv_done = std::move(recv_done)](const Status& s) {
+      abort_checked->WaitForNotification();
+      if (!s.ok() || !resp_.metadata().has_transport_options() ||
+          resp_.metadata().is_dead()) {
+        SetStatus(s);
+        recv_done();
+        return;
+      }
+      ReadContent(std::move(recv_done));
+    };
+    wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
+
+    // NOTE: As in RpcRecvTensorCall, check for an abort only after sending
+    // out the RPC, so that it is cancelled either way.
+    if (!status().ok()) opts_.StartCancel();
+    abort_checked->Notify();
+  }
+
+  void StartAbort(const Status& s) override {
+    SetStatus(s);
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  void ReleaseWorker(WorkerCacheInterface* worker_cache) {
+    worker_cache->ReleaseWorker(src_worker_, wi_);
+    wi_ = nullptr;
+  }
+
+  const Tensor& tensor() const { return resp_.tensor(); }
+  bool is_dead() const { return resp_.metadata().is_dead(); }
+  const Rendezvous::Args& recv_args() const { return recv_args_; }
+  const Rendezvous::DoneCallback& done() const { return done_; }
+
+ private:
+  void SetStatus(const Status& s) {
+    mutex_lock l(mu_);
+    status_.Update(s);
+  }
+
+  // Reads the content of the tensor whose metadata was received. The
+  // destination tensor is read into directly if its buffer is registered,
+  // and through a registered staging buffer otherwise.
+  void ReadContent(std::function<void()> recv_done) {
+    auto region = std::make_shared<RemoteMemoryRegion>();
+    if (!resp_.metadata().transport_options().UnpackTo(region.get())) {
+      SetStatus(errors::Internal("Could not parse the RDMA memory region"));
+      recv_done();
+      return;
+    }
+    Tensor dst = resp_.tensor();
+    if (memory_manager_->IsRegistered(dst)) {
+      memory_manager_->Read(*region, &dst,
+                            [this, recv_done](const Status& s) {
+                              SetStatus(s);
+                              recv_done();
+                            });
+      return;
+    }
+    auto staging = std::make_shared<Tensor>(
+        ProcessState::singleton()->GetCPUAllocator(port::kNUMANoAffinity),
+        dst.dtype(), dst.shape());
+    memory_manager_->Read(
+        *region, staging.get(),
+        [this, dst, staging, recv_done](const Status& s) {
+          if (s.ok()) {
+            const StringPiece from = staging->tensor_data();
+            memcpy(const_cast<char*>(dst.tensor_data().data()), from.data(),
+                   from.size());
+          }
+          SetStatus(s);
+          recv_done();
+        });
+  }
+
+  WorkerInterface* wi_;  // Not owned.
+  const string src_worker_;
+  Device* const dst_device_;
+  const Rendezvous::Args recv_args_;
+  const Rendezvous::DoneCallback done_;
+  VerbsMemoryManager* const memory_manager_;  // Not owned.
+  CallOptions opts_;
+  RecvTensorRequest req_;
+  TensorResponse resp_;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(VerbsRecvTensorCall);
+};
+
+class VerbsRemoteRendezvous : public BaseRemoteRendezvous {
+ public:
+  VerbsRemoteRendezvous(const WorkerEnv* env, int64 step_id,
+                        VerbsMemoryManager* memory_manager)
+      : BaseRemoteRendezvous(env, step_id), memory_manager_(memory_manager) {}
+
+ protected:
+  void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                           const Rendezvous::Args& recv_args,
+                           DoneCallback done) override;
+
+ private:
+  ~VerbsRemoteRendezvous() override {}
+
+  VerbsMemoryManager* const memory_manager_;  // Not owned.
+
+  TF_DISALLOW_COPY_AND_ASSIGN(VerbsRemoteRendezvous);
+};
+
+void VerbsRemoteRendezvous::RecvFromRemoteAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
+  CHECK(is_initialized());
+
+  string src_worker;
+  string src_rel_device;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    done(errors::Internal(parsed.src_device,
+                          " is invalid remote source device."),
+         Args(), recv_args, Tensor{}, false);
+    return;
+  }
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+  WorkerInterface* rwi = worker_cache->GetOrCreateWorker(src_worker);
+  if (rwi == nullptr) {
+    done(errors::Internal("No worker known as ", src_worker), Args(),
+         recv_args, Tensor{}, false);
+    return;
+  }
+  Device* dst_device;
+  Status s = sess->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
+  if (!s.ok()) {
+    worker_cache->ReleaseWorker(src_worker, rwi);
+    done(s, Args(), recv_args, Tensor{}, false);
+    return;
+  }
+
+  VerbsRecvTensorCall* call = new VerbsRecvTensorCall(
+      rwi, step_id_, parsed.FullKey(), src_worker, dst_device, recv_args,
+      std::move(done), memory_manager_);
+
+  // Record "call" in active_ so that it can be aborted cleanly.
+  RegisterCall(call, recv_args);
+
+  // RendezvousMgr already aborted, shouldn't send RPC call any more
+  if (!call->status().ok()) {
+    DeregisterCall(call);
+    call->ReleaseWorker(worker_cache.get());
+    call->done()(call->status(), Args(), Args(), Tensor(), false);
+    delete call;
+    return;
+  }
+
+  Ref();
+  call->Start([this, call, worker_cache]() {
+    // Removes "call" from active_. Prevent StartAbort().
+    DeregisterCall(call);
+    Status s = call->status();
+    call->ReleaseWorker(worker_cache.get());
+    call->done()(s, Args(), call->recv_args(), call->tensor(),
+                 call->is_dead());
+    delete call;
+    Unref();
+  });
+}
+
+}  // namespace
+
+VerbsRendezvousMgr::VerbsRendezvousMgr(const WorkerEnv* env,
+                                       VerbsMemoryManager* memory_manager)
+    : BaseRendezvousMgr(env), memory_manager_(memory_manager) {}
+
+BaseRemoteRendezvous* VerbsRendezvousMgr::Create(int64 step_id,
+                                                 const WorkerEnv* worker_env) {
+  return new VerbsRemoteRendezvous(worker_env, step_id, memory_manager_);
+}
+
+}  // end namespace tensorflow
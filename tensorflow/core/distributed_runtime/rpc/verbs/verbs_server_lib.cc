@@ -0,0 +1,121 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_server_lib.h"
+
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_worker.h"
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+VerbsServer::VerbsServer(const ServerDef& server_def, Env* env)
+    : GrpcServer(server_def, env) {}
+
+VerbsServer::~VerbsServer() {
+  TF_CHECK_OK(Stop());
+  TF_CHECK_OK(Join());
+}
+
+Status VerbsServer::Init() {
+  // The RDMA listener shares the host and port of the gRPC server, and must
+  // register its allocation visitors before the devices are created.
+  string host;
+  int port;
+  TF_RETURN_IF_ERROR(GetHostAndPort(server_def(), &host, &port));
+  memory_manager_ = new VerbsMemoryManager(host, strings::StrCat(port));
+  TF_RETURN_IF_ERROR(memory_manager_->Init());
+
+  GrpcServerOptions opts;
+  opts.rendezvous_mgr_func = [this](const WorkerEnv* env) {
+    return new VerbsRendezvousMgr(env, memory_manager_);
+  };
+  opts.worker_func = [this](WorkerEnv* env, const ConfigProto& config) {
+    return NewVerbsWorker(env, config, memory_manager_);
+  };
+  return GrpcServer::Init(opts);
+}
+
+Status VerbsServer::Start() {
+  TF_RETURN_IF_ERROR(GrpcServer::Start());
+  mutex_lock l(mu_);
+  if (verbs_thread_ == nullptr) {
+    verbs_thread_.reset(worker_env()->env->StartThread(
+        ThreadOptions(), "TF_verbs_service",
+        [this]() { memory_manager_->Run(); }));
+  }
+  return Status::OK();
+}
+
+Status VerbsServer::Stop() {
+  TF_RETURN_IF_ERROR(GrpcServer::Stop());
+  if (memory_manager_ != nullptr) memory_manager_->Stop();
+  return Status::OK();
+}
+
+Status VerbsServer::Join() {
+  TF_RETURN_IF_ERROR(GrpcServer::Join());
+  mutex_lock l(mu_);
+  verbs_thread_.reset();
+  return Status::OK();
+}
+
+/* static */
+Status VerbsServer::Create(const ServerDef& server_def, Env* env,
+                           std::unique_ptr<ServerInterface>* out_server) {
+  std::unique_ptr<VerbsServer> ret(
+      new VerbsServer(server_def, env == nullptr ? Env::Default() : env));
+  Status s = ret->Init();
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return s;
+  }
+  *out_server = std::move(ret);
+  return Status::OK();
+}
+
+namespace {
+
+class VerbsServerFactory : public ServerFactory {
+ public:
+  bool AcceptsOptions(const ServerDef& server_def) override {
+    return server_def.protocol() == "grpc+verbs";
+  }
+
+  Status NewServer(const ServerDef& server_def, const Options& options,
+                   std::unique_ptr<ServerInterface>* out_server) override {
+    if (options.local_device_mgr != nullptr) {
+      return errors::Unimplemented(
+          "The grpc+verbs protocol registers host memory as the devices are "
+          "created, and cannot reuse a local device manager");
+    }
+    return VerbsServer::Create(server_def, Env::Default(), out_server);
+  }
+};
+
+// Registers a `ServerFactory` for `VerbsServer` instances.
+class VerbsServerRegistrar {
+ public:
+  VerbsServerRegistrar() {
+    ServerFactory::Register("VERBS_SERVER", new VerbsServerFactory());
+  }
+};
+static VerbsServerRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
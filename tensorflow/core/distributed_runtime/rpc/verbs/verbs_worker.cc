@@ -0,0 +1,132 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_worker.h"
+
+#include "tensorflow/core/common_runtime/copy_tensor.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+VerbsWorker::VerbsWorker(WorkerEnv* env, const ConfigProto& config,
+                         VerbsMemoryManager* memory_manager)
+    : GrpcWorker(env, config), memory_manager_(memory_manager) {
+  const Status s = ReadInt64FromEnvVar("TF_VERBS_MIN_RDMA_BYTES", 64 << 10,
+                                       &min_rdma_bytes_);
+  if (!s.ok()) {
+    LOG(ERROR) << s.error_message();
+  }
+}
+
+void VerbsWorker::GrpcRecvTensorAsync(CallOptions* opts,
+                                      const RecvTensorRequest* request,
+                                      ::grpc::ByteBuffer* response,
+                                      StatusCallback done) {
+  // Only VerbsRendezvousMgr sets transport options, when it can read the
+  // tensor by RDMA.
+  if (!request->has_transport_options()) {
+    GrpcWorker::GrpcRecvTensorAsync(opts, request, response, std::move(done));
+    return;
+  }
+  const int64 step_id = request->step_id();
+  const string& key = request->rendezvous_key();
+  TRACEPRINTF("RecvTensor: %lld %s", step_id, key.c_str());
+  Status s = recent_request_ids_.TrackUnique(
+      request->request_id(), "RecvTensor (VerbsWorker)", *request);
+  Rendezvous::ParsedKey parsed;
+  if (s.ok()) {
+    s = Rendezvous::ParseKey(key, &parsed);
+  }
+  Device* src_dev = nullptr;
+  if (s.ok()) {
+    s = PrepareRecvTensor(parsed, &src_dev);
+  }
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  // As in GrpcWorker, cancellations are logged but do not abort the step.
+  opts->SetCancelCallback(
+      [step_id]() { LOG(WARNING) << "RecvTensor cancelled for " << step_id; });
+  env_->rendezvous_mgr->RecvLocalAsync(
+      step_id, parsed,
+      [this, opts, request, response, src_dev, done](
+          const Status& status, const Rendezvous::Args& send_args,
+          const Rendezvous::Args& recv_args, const Tensor& val,
+          const bool is_dead) {
+        opts->ClearCancelCallback();
+        if (!status.ok()) {
+          done(status);
+          return;
+        }
+        if (src_dev->tensorflow_gpu_device_info() == nullptr ||
+            send_args.alloc_attrs.on_host()) {
+          EncodeResponse(val, is_dead, response);
+          done(Status::OK());
+          return;
+        }
+        // "val" is on an accelerator device, and is copied to host first.
+        AllocatorAttributes alloc_attrs;
+        alloc_attrs.set_gpu_compatible(true);
+        alloc_attrs.set_on_host(true);
+        Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
+        Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
+        StatusCallback copy_ready = [this, copy, is_dead, response,
+                                     done](const Status& s) {
+          if (s.ok()) EncodeResponse(*copy, is_dead, response);
+          delete copy;
+          done(s);
+        };
+        CopyDeviceToHost(&val, alloc, alloc, request->rendezvous_key(),
+                         src_dev, copy, send_args.device_context, copy_ready);
+      });
+}
+
+void VerbsWorker::EncodeResponse(const Tensor& val, bool is_dead,
+                                 ::grpc::ByteBuffer* response) {
+  if (!is_dead && DataTypeCanUseMemcpy(val.dtype()) &&
+      static_cast<int64>(val.TotalBytes()) >= min_rdma_bytes_) {
+    RemoteMemoryRegion region;
+    if (memory_manager_->Expose(val, &region).ok()) {
+      RecvTensorResponse proto;
+      proto.mutable_tensor()->set_dtype(val.dtype());
+      val.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+      proto.mutable_transport_options()->PackFrom(region);
+      grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+      return;
+    }
+  }
+  grpc::EncodeTensorToByteBuffer(is_dead, val, false /* require_ack */,
+                                 response);
+}
+
+std::unique_ptr<GrpcWorker> NewVerbsWorker(
+    WorkerEnv* env, const ConfigProto& config,
+    VerbsMemoryManager* memory_manager) {
+  return std::unique_ptr<GrpcWorker>(
+      new VerbsWorker(env, config, memory_manager));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,55 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_WORKER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_WORKER_H_
+
+#include <memory>
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_memory_manager.h"
+
+namespace tensorflow {
+
+// A GrpcWorker that answers RecvTensor requests from VerbsRendezvousMgr with
+// the memory region of the tensor rather than its content, when the tensor
+// is in registered host memory and has at least TF_VERBS_MIN_RDMA_BYTES
+// bytes (64KiB by default). Smaller tensors are cheaper to send inline.
+class VerbsWorker : public GrpcWorker {
+ public:
+  // `memory_manager` must outlive this object.
+  VerbsWorker(WorkerEnv* env, const ConfigProto& config,
+              VerbsMemoryManager* memory_manager);
+
+  void GrpcRecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                           ::grpc::ByteBuffer* response,
+                           StatusCallback done) override;
+
+ private:
+  // Encodes `val` into `response`, by its memory region if possible.
+  void EncodeResponse(const Tensor& val, bool is_dead,
+                      ::grpc::ByteBuffer* response);
+
+  VerbsMemoryManager* const memory_manager_;  // Not owned.
+  int64 min_rdma_bytes_;
+};
+
+std::unique_ptr<GrpcWorker> NewVerbsWorker(WorkerEnv* env,
+                                           const ConfigProto& config,
+                                           VerbsMemoryManager* memory_manager);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_WORKER_H_
@@ -0,0 +1,284 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/step_critical_path.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Sets `*task` to the task name of the full device name `device`.
+bool TaskName(const string& device, string* task) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(device, &parsed) &&
+         DeviceNameUtils::GetTaskName(parsed, task);
+}
+
+// Parses the tensor name and source device out of a transfer label of
+// WorkerCacheLogger::RecordDataTransfer(), which reads
+// "[<bytes>] [<rate>] <tensor_name> from <src_device> to <dst_device>".
+bool ParseTransferLabel(absl::string_view label, string* tensor_name,
+                        string* src_device) {
+  const size_t from = label.rfind(" from ");
+  if (from == absl::string_view::npos) return false;
+  const size_t to = label.find(" to ", from + 6);
+  if (to == absl::string_view::npos) return false;
+  const size_t rate_end = label.rfind("] ", from);
+  const size_t name_start =
+      rate_end == absl::string_view::npos ? 0 : rate_end + 2;
+  *tensor_name = string(label.substr(name_start, from - name_start));
+  *src_device = string(label.substr(from + 6, to - from - 6));
+  return true;
+}
+
+template <typename T>
+T Median(std::vector<T> values) {
+  if (values.empty()) return T();
+  auto middle = values.begin() + (values.size() - 1) / 2;
+  std::nth_element(values.begin(), middle, values.end());
+  return *middle;
+}
+
+const char* KindName(CriticalPathSegment::Kind kind) {
+  switch (kind) {
+    case CriticalPathSegment::kCompute:
+      return "compute";
+    case CriticalPathSegment::kTransfer:
+      return "transfer";
+  }
+  return "unknown";
+}
+
+}  // namespace
+
+void StepCriticalPathAnalyzer::AddPartitionStats(const StepStats& step_stats) {
+  for (const DeviceStepStats& ds : step_stats.dev_stats()) {
+    string task;
+    if (!TaskName(ds.device(), &task)) continue;
+    for (const NodeExecStats& ns : ds.node_stats()) {
+      const int64 start = ns.all_start_micros();
+      const int64 end = start + ns.all_end_rel_micros();
+      auto inserted = workers_.emplace(task, WorkerStepLateness());
+      WorkerStepLateness* worker = &inserted.first->second;
+      if (inserted.second) {
+        worker->worker = task;
+        worker->start_micros = start;
+        worker->end_micros = end;
+      } else {
+        worker->start_micros = std::min(worker->start_micros, start);
+        worker->end_micros = std::max(worker->end_micros, end);
+      }
+    }
+  }
+}
+
+void StepCriticalPathAnalyzer::AddRpcStats(const StepStats& rpc_stats) {
+  for (const DeviceStepStats& ds : rpc_stats.dev_stats()) {
+    Transfer transfer;
+    if (!TaskName(ds.device(), &transfer.dst_worker)) continue;
+    for (const NodeExecStats& ns : ds.node_stats()) {
+      string src_device;
+      if (!ParseTransferLabel(ns.timeline_label(), &transfer.tensor_name,
+                              &src_device) ||
+          !TaskName(src_device, &transfer.src_worker)) {
+        continue;
+      }
+      transfer.bytes = 0;
+      for (const NodeOutput& output : ns.output()) {
+        transfer.bytes += output.tensor_description()
+                              .allocation_description()
+                              .requested_bytes();
+      }
+      transfer.start_micros = ns.all_start_micros();
+      transfer.end_micros = ns.all_start_micros() + ns.all_end_rel_micros();
+      transfer.has_request = ns.scheduled_micros() > 0;
+      transfer.request_micros =
+          transfer.has_request ? ns.scheduled_micros() : transfer.start_micros;
+      transfers_.push_back(transfer);
+    }
+  }
+}
+
+StepCriticalPath StepCriticalPathAnalyzer::Analyze() const {
+  StepCriticalPath result;
+  if (workers_.empty()) return result;
+
+  // Stragglers.
+  std::vector<int64> ends;
+  std::vector<int64> durations;
+  result.start_micros = workers_.begin()->second.start_micros;
+  for (const auto& name_and_worker : workers_) {
+    const WorkerStepLateness& worker = name_and_worker.second;
+    result.start_micros = std::min(result.start_micros, worker.start_micros);
+    result.end_micros = std::max(result.end_micros, worker.end_micros);
+    ends.push_back(worker.end_micros);
+    durations.push_back(worker.end_micros - worker.start_micros);
+  }
+  const int64 median_end = Median(ends);
+  const int64 straggler_micros = std::max(
+      options_.straggler_min_micros,
+      static_cast<int64>(options_.straggler_fraction * Median(durations)));
+  for (const auto& name_and_worker : workers_) {
+    WorkerStepLateness worker = name_and_worker.second;
+    worker.lateness_micros = worker.end_micros - median_end;
+    worker.is_straggler =
+        workers_.size() > 1 && worker.lateness_micros >= straggler_micros;
+    result.workers.push_back(worker);
+  }
+  std::sort(result.workers.begin(), result.workers.end(),
+            [](const WorkerStepLateness& a, const WorkerStepLateness& b) {
+              return a.end_micros < b.end_micros;
+            });
+
+  // Slow links.
+  std::map<std::pair<string, string>, LinkStats> links;
+  for (const Transfer& transfer : transfers_) {
+    LinkStats* link = &links[{transfer.src_worker, transfer.dst_worker}];
+    link->src_worker = transfer.src_worker;
+    link->dst_worker = transfer.dst_worker;
+    ++link->num_transfers;
+    link->bytes += transfer.bytes;
+    link->transfer_micros += transfer.end_micros - transfer.start_micros;
+    link->queueing_micros += transfer.start_micros - transfer.request_micros;
+  }
+  std::vector<double> bandwidths;
+  for (auto& key_and_link : links) {
+    LinkStats& link = key_and_link.second;
+    link.bytes_per_micro = static_cast<double>(link.bytes) /
+                           std::max<int64>(link.transfer_micros, 1);
+    bandwidths.push_back(link.bytes_per_micro);
+  }
+  const double median_bandwidth = Median(bandwidths);
+  for (auto& key_and_link : links) {
+    LinkStats& link = key_and_link.second;
+    link.is_slow = links.size() > 1 &&
+                   link.bytes >= options_.slow_link_min_bytes &&
+                   link.bytes_per_micro * options_.slow_link_ratio <
+                       median_bandwidth;
+    result.links.push_back(link);
+  }
+  std::sort(result.links.begin(), result.links.end(),
+            [](const LinkStats& a, const LinkStats& b) {
+              return a.transfer_micros > b.transfer_micros;
+            });
+
+  // Critical path, walked backwards from the end of the last worker.  Each
+  // iteration moves `time` back, and at most one iteration per transfer is
+  // needed unless transfers take no time.
+  string worker = result.workers.back().worker;
+  int64 time = result.end_micros;
+  std::vector<CriticalPathSegment> segments;
+  for (size_t i = 0; i <= transfers_.size() && time > result.start_micros;
+       ++i) {
+    const Transfer* last = nullptr;
+    for (const Transfer& transfer : transfers_) {
+      if (transfer.dst_worker == worker && transfer.end_micros <= time &&
+          (last == nullptr || transfer.end_micros > last->end_micros)) {
+        last = &transfer;
+      }
+    }
+    auto it = workers_.find(worker);
+    const int64 worker_start =
+        it == workers_.end() ? time : it->second.start_micros;
+    const int64 compute_start =
+        last == nullptr ? worker_start
+                        : std::max(worker_start, last->end_micros);
+    if (compute_start < time) {
+      CriticalPathSegment segment;
+      segment.kind = CriticalPathSegment::kCompute;
+      segment.worker = worker;
+      segment.start_micros = compute_start;
+      segment.end_micros = time;
+      segments.push_back(segment);
+    }
+    if (last == nullptr || last->end_micros < worker_start) break;
+
+    CriticalPathSegment segment;
+    segment.kind = CriticalPathSegment::kTransfer;
+    segment.worker = last->dst_worker;
+    segment.src_worker = last->src_worker;
+    segment.tensor_name = last->tensor_name;
+    segment.start_micros = last->start_micros;
+    segment.end_micros = last->end_micros;
+    segment.queueing_micros = last->start_micros - last->request_micros;
+    segments.push_back(segment);
+    // A request that waited for its sender continues the path on the sender,
+    // from the time it started to send.  A request that did not wait was late
+    // itself, so the path continues on the receiver, before the request.
+    if (last->has_request && last->request_micros >= last->start_micros) {
+      time = last->request_micros;
+    } else {
+      worker = last->src_worker;
+      time = last->start_micros;
+    }
+  }
+  std::reverse(segments.begin(), segments.end());
+  for (const CriticalPathSegment& segment : segments) {
+    const int64 micros = segment.end_micros - segment.start_micros;
+    if (segment.kind == CriticalPathSegment::kCompute) {
+      result.critical_compute_micros += micros;
+    } else {
+      result.critical_transfer_micros += micros;
+    }
+  }
+  result.critical_path = std::move(segments);
+  return result;
+}
+
+string StepCriticalPath::DebugString() const {
+  string out = strings::StrCat(
+      "Step of ", end_micros - start_micros, "us: ", critical_compute_micros,
+      "us of compute and ", critical_transfer_micros,
+      "us of transfers on the critical path\n");
+  for (const WorkerStepLateness& worker : workers) {
+    strings::StrAppend(&out, "  ", worker.worker, " ended at +",
+                       worker.end_micros - start_micros, "us, ",
+                       worker.lateness_micros, "us after the median",
+                       worker.is_straggler ? " (straggler)" : "", "\n");
+  }
+  for (const LinkStats& link : links) {
+    strings::StrAppend(
+        &out, "  ", link.src_worker, " -> ", link.dst_worker, ": ",
+        link.num_transfers, " transfers of ", link.bytes, "B in ",
+        link.transfer_micros, "us (",
+        strings::Printf("%.1f", link.bytes_per_micro), "MB/s), ",
+        link.queueing_micros, "us queued", link.is_slow ? " (slow)" : "",
+        "\n");
+  }
+  strings::StrAppend(&out, "Critical path:\n");
+  for (const CriticalPathSegment& segment : critical_path) {
+    strings::StrAppend(&out, "  +", segment.start_micros - start_micros,
+                       "us ", KindName(segment.kind), " ",
+                       segment.end_micros - segment.start_micros, "us on ",
+                       segment.worker);
+    if (segment.kind != CriticalPathSegment::kCompute) {
+      strings::StrAppend(&out, " from ", segment.src_worker, " for ",
+                         segment.tensor_name, ", queued ",
+                         segment.queueing_micros, "us");
+    }
+    strings::StrAppend(&out, "\n");
+  }
+  return out;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,154 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STEP_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STEP_CRITICAL_PATH_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The activity of one worker task during a distributed step.
+struct WorkerStepLateness {
+  // The task name, e.g. "/job:worker/replica:0/task:1".
+  string worker;
+  int64 start_micros = 0;
+  int64 end_micros = 0;
+  // How much later than the median worker the worker finished.  Negative for
+  // the workers that finished early.
+  int64 lateness_micros = 0;
+  bool is_straggler = false;
+};
+
+// The tensor transfers of the step from one worker to another.
+struct LinkStats {
+  string src_worker;
+  string dst_worker;
+  int64 num_transfers = 0;
+  int64 bytes = 0;
+  // The time from the sender starting to send to the receiver receiving,
+  // summed over the transfers.
+  int64 transfer_micros = 0;
+  // The time that the requests waited for the sender, summed over the
+  // transfers.  Only known for the transfers logged with their request time.
+  int64 queueing_micros = 0;
+  // `bytes` over `transfer_micros`.
+  double bytes_per_micro = 0;
+  bool is_slow = false;
+};
+
+// A segment of the critical path of a step.
+struct CriticalPathSegment {
+  enum Kind { kCompute, kTransfer };
+  Kind kind = kCompute;
+  // The worker of a compute segment, and the receiver of a transfer.
+  string worker;
+  // The sender and the tensor of a transfer.
+  string src_worker;
+  string tensor_name;
+  int64 start_micros = 0;
+  int64 end_micros = 0;
+  // The time that the request of a transfer waited for the sender.  It
+  // overlaps with the segments before the transfer.
+  int64 queueing_micros = 0;
+};
+
+// The critical path report of a distributed step.
+struct StepCriticalPath {
+  int64 start_micros = 0;
+  int64 end_micros = 0;
+  // By increasing end time, so that the last worker ended the step.
+  std::vector<WorkerStepLateness> workers;
+  // By decreasing transfer time.
+  std::vector<LinkStats> links;
+  // The critical path, in time order.
+  std::vector<CriticalPathSegment> critical_path;
+  // The time on the critical path spent in each kind of segment.
+  int64 critical_compute_micros = 0;
+  int64 critical_transfer_micros = 0;
+
+  // Returns a human-readable report.
+  string DebugString() const;
+};
+
+// Finds the stragglers, slow links and critical path of a distributed step
+// from the StepStats of its partitions and the RPC logs of the
+// WorkerCacheLogger of the master.
+//
+// The StepStats have no dependencies between the nodes of different workers,
+// so the critical path is recovered backwards from the end of the step: on a
+// worker, the time up to the end of the latest incoming transfer is spent
+// waiting for that transfer.  If the request of the transfer waited for the
+// sender, the path continues on the sender from the time it started to send,
+// and otherwise on the receiver from the time of the request.  This
+// attributes the step to the chain of workers and links that it actually
+// waited for, which is enough to tell a slow worker from a slow or congested
+// link.
+class StepCriticalPathAnalyzer {
+ public:
+  struct Options {
+    // A worker is a straggler if it finished at least `straggler_min_micros`
+    // and `straggler_fraction` of the median worker duration after the median
+    // worker.
+    int64 straggler_min_micros = 1000;
+    double straggler_fraction = 0.2;
+
+    // A link is slow if its bandwidth is `slow_link_ratio` times less than the
+    // median bandwidth of the links of the step, and if it moved at least
+    // `slow_link_min_bytes` bytes.
+    double slow_link_ratio = 4.0;
+    int64 slow_link_min_bytes = 1 << 20;
+  };
+
+  StepCriticalPathAnalyzer() : StepCriticalPathAnalyzer(Options()) {}
+  explicit StepCriticalPathAnalyzer(const Options& options)
+      : options_(options) {}
+
+  // Adds the StepStats of a partition of the step.
+  void AddPartitionStats(const StepStats& step_stats);
+
+  // Adds the RPC logs of the step, as returned by
+  // WorkerCacheLogger::RetrieveLogs().
+  void AddRpcStats(const StepStats& rpc_stats);
+
+  // Analyzes the stats added so far.
+  StepCriticalPath Analyze() const;
+
+ private:
+  struct Transfer {
+    string src_worker;
+    string dst_worker;
+    string tensor_name;
+    int64 bytes = 0;
+    // The time the request was issued, if it was logged.
+    bool has_request = false;
+    int64 request_micros = 0;
+    int64 start_micros = 0;
+    int64 end_micros = 0;
+  };
+
+  const Options options_;
+  // By task name, the workers that reported partition stats.
+  std::map<string, WorkerStepLateness> workers_;
+  std::vector<Transfer> transfers_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STEP_CRITICAL_PATH_H_
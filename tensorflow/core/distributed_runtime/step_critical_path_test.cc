@@ -0,0 +1,164 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/step_critical_path.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kStepId = 7;
+
+string Device(int task) {
+  return strings::StrCat("/job:worker/replica:0/task:", task,
+                         "/device:CPU:0");
+}
+
+string Task(int task) {
+  return strings::StrCat("/job:worker/replica:0/task:", task);
+}
+
+// Returns the StepStats of a partition on `task` with a node running from
+// `start_micros` to `end_micros`.
+StepStats PartitionStats(int task, int64 start_micros, int64 end_micros) {
+  StepStats step_stats;
+  DeviceStepStats* ds = step_stats.add_dev_stats();
+  ds->set_device(Device(task));
+  NodeExecStats* ns = ds->add_node_stats();
+  ns->set_node_name("op");
+  ns->set_all_start_micros(start_micros);
+  ns->set_all_end_rel_micros(end_micros - start_micros);
+  return step_stats;
+}
+
+StepStats RpcStats(WorkerCacheLogger* logger) {
+  StepStats rpc_stats;
+  EXPECT_TRUE(logger->RetrieveLogs(kStepId, &rpc_stats));
+  return rpc_stats;
+}
+
+TEST(StepCriticalPathTest, FindsStragglerAndSlowLink) {
+  StepCriticalPathAnalyzer analyzer;
+  analyzer.AddPartitionStats(PartitionStats(0, 1000, 2000));
+  analyzer.AddPartitionStats(PartitionStats(1, 1000, 9000));
+  analyzer.AddPartitionStats(PartitionStats(2, 1000, 4200));
+  WorkerCacheLogger logger;
+  logger.RecordRecvTensor(kStepId, 1800, 1900, "a", Device(0), Device(1),
+                          2 << 20, 1700);
+  logger.RecordRecvTensor(kStepId, 1900, 2000, "b", Device(0), Device(2),
+                          1 << 20, 1200);
+  logger.RecordRecvTensor(kStepId, 4000, 4500, "c", Device(2), Device(1),
+                          1 << 20, 1500);
+  analyzer.AddRpcStats(RpcStats(&logger));
+
+  const StepCriticalPath path = analyzer.Analyze();
+  EXPECT_EQ(path.start_micros, 1000);
+  EXPECT_EQ(path.end_micros, 9000);
+  ASSERT_EQ(path.workers.size(), 3);
+  EXPECT_EQ(path.workers[0].worker, Task(0));
+  EXPECT_EQ(path.workers[0].lateness_micros, -2200);
+  EXPECT_FALSE(path.workers[0].is_straggler);
+  EXPECT_FALSE(path.workers[1].is_straggler);
+  EXPECT_EQ(path.workers[2].worker, Task(1));
+  EXPECT_EQ(path.workers[2].lateness_micros, 4800);
+  EXPECT_TRUE(path.workers[2].is_straggler);
+
+  ASSERT_EQ(path.links.size(), 3);
+  EXPECT_EQ(path.links[0].src_worker, Task(2));
+  EXPECT_EQ(path.links[0].dst_worker, Task(1));
+  EXPECT_EQ(path.links[0].bytes, 1 << 20);
+  EXPECT_EQ(path.links[0].transfer_micros, 500);
+  EXPECT_EQ(path.links[0].queueing_micros, 2500);
+  EXPECT_TRUE(path.links[0].is_slow);
+  EXPECT_FALSE(path.links[1].is_slow);
+  EXPECT_FALSE(path.links[2].is_slow);
+
+  // The step waited for task 1 to compute after receiving "c", which task 2
+  // sent once it had computed after receiving "b" from task 0.
+  ASSERT_EQ(path.critical_path.size(), 5);
+  EXPECT_EQ(path.critical_path[0].kind, CriticalPathSegment::kCompute);
+  EXPECT_EQ(path.critical_path[0].worker, Task(0));
+  EXPECT_EQ(path.critical_path[0].start_micros, 1000);
+  EXPECT_EQ(path.critical_path[0].end_micros, 1900);
+  EXPECT_EQ(path.critical_path[1].kind, CriticalPathSegment::kTransfer);
+  EXPECT_EQ(path.critical_path[1].tensor_name, "b");
+  EXPECT_EQ(path.critical_path[1].queueing_micros, 700);
+  EXPECT_EQ(path.critical_path[2].worker, Task(2));
+  EXPECT_EQ(path.critical_path[2].start_micros, 2000);
+  EXPECT_EQ(path.critical_path[2].end_micros, 4000);
+  EXPECT_EQ(path.critical_path[3].tensor_name, "c");
+  EXPECT_EQ(path.critical_path[3].src_worker, Task(2));
+  EXPECT_EQ(path.critical_path[4].worker, Task(1));
+  EXPECT_EQ(path.critical_path[4].start_micros, 4500);
+  EXPECT_EQ(path.critical_path[4].end_micros, 9000);
+  EXPECT_EQ(path.critical_compute_micros, 7400);
+  EXPECT_EQ(path.critical_transfer_micros, 600);
+
+  const string report = path.DebugString();
+  EXPECT_TRUE(absl::StrContains(report, "(straggler)"));
+  EXPECT_TRUE(absl::StrContains(report, "(slow)"));
+}
+
+TEST(StepCriticalPathTest, LateRequestStaysOnReceiver) {
+  StepCriticalPathAnalyzer analyzer;
+  analyzer.AddPartitionStats(PartitionStats(0, 0, 1000));
+  analyzer.AddPartitionStats(PartitionStats(1, 0, 3000));
+  WorkerCacheLogger logger;
+  logger.RecordRecvTensor(kStepId, 2000, 2100, "a", Device(0), Device(1), 8,
+                          2000);
+  analyzer.AddRpcStats(RpcStats(&logger));
+
+  const StepCriticalPath path = analyzer.Analyze();
+  EXPECT_TRUE(path.workers.back().is_straggler);
+  ASSERT_EQ(path.critical_path.size(), 3);
+  EXPECT_EQ(path.critical_path[0].worker, Task(1));
+  EXPECT_EQ(path.critical_path[0].start_micros, 0);
+  EXPECT_EQ(path.critical_path[0].end_micros, 2000);
+  EXPECT_EQ(path.critical_path[1].kind, CriticalPathSegment::kTransfer);
+  EXPECT_EQ(path.critical_path[2].worker, Task(1));
+}
+
+TEST(StepCriticalPathTest, TransferWithoutRequestTimeFollowsSender) {
+  StepCriticalPathAnalyzer analyzer;
+  analyzer.AddPartitionStats(PartitionStats(0, 0, 2000));
+  analyzer.AddPartitionStats(PartitionStats(1, 0, 3000));
+  WorkerCacheLogger logger;
+  logger.RecordRecvTensor(kStepId, 2000, 2100, "a", Device(0), Device(1), 8);
+  analyzer.AddRpcStats(RpcStats(&logger));
+
+  const StepCriticalPath path = analyzer.Analyze();
+  ASSERT_EQ(path.critical_path.size(), 3);
+  EXPECT_EQ(path.critical_path[0].worker, Task(0));
+  EXPECT_EQ(path.critical_path[0].end_micros, 2000);
+  EXPECT_EQ(path.critical_path[1].queueing_micros, 0);
+  EXPECT_EQ(path.links[0].queueing_micros, 0);
+}
+
+TEST(StepCriticalPathTest, SingleWorkerHasNoStraggler) {
+  StepCriticalPathAnalyzer analyzer;
+  analyzer.AddPartitionStats(PartitionStats(0, 0, 1000));
+  const StepCriticalPath path = analyzer.Analyze();
+  ASSERT_EQ(path.workers.size(), 1);
+  EXPECT_FALSE(path.workers[0].is_straggler);
+  ASSERT_EQ(path.critical_path.size(), 1);
+  EXPECT_EQ(path.critical_compute_micros, 1000);
+}
+
+}  // namespace
+}  // namespace tensorflow
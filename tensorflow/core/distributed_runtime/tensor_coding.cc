@@ -18,8 +18,12 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/snappy.h"
 
 namespace tensorflow {
 
@@ -30,6 +34,7 @@ void TensorResponse::Clear() {
   device_ = nullptr;
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
+  host_allocator_ = nullptr;
   already_used_ = false;
   ClearTensor();
 }
@@ -48,6 +53,13 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
     on_host_ = true;
   }
   allocator_ = device_->GetAllocator(alloc_attrs_);
+  // Only GPU devices copy from host buffers without decoding a TensorProto.
+  if (!on_host_ && device_->tensorflow_gpu_device_info() != nullptr) {
+    AllocatorAttributes host_alloc_attrs;
+    host_alloc_attrs.set_on_host(true);
+    host_alloc_attrs.set_gpu_compatible(true);
+    host_allocator_ = device_->GetAllocator(host_alloc_attrs);
+  }
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
@@ -56,9 +68,14 @@ Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   if (on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
+    } else {
+      s = DecodeContent(&tensor_);
     }
   } else {
-    s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    s = DecodeContent(meta_.mutable_tensor());
+    if (s.ok()) {
+      s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    }
   }
   {
     TensorProto empty;
@@ -81,6 +98,9 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
 
 Status TensorResponse::ParseFrom(Source* source) {
   if (!on_host_) {
+    Status s;
+    if (ParseFastToDevice(source, &s)) return s;
+
     protobuf::io::CodedInputStream input(source->contents());
     input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
 
@@ -88,8 +108,10 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
-    Status s =
-        device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    Status s = DecodeContent(meta_.mutable_tensor());
+    if (s.ok()) {
+      s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    }
     // Reduce memory usage for big tensors.
     {
       TensorProto empty;
@@ -102,12 +124,37 @@ Status TensorResponse::ParseFrom(Source* source) {
     ClearTensor();
   }
   already_used_ = true;
-  if (ParseFast(source)) return Status::OK();
+  if (ParseFast(source, allocator_)) return DecodeContent(&tensor_);
   meta_.Clear();
-  if (ParseSlow(source)) return Status::OK();
+  if (ParseSlow(source)) return DecodeContent(&tensor_);
   return errors::InvalidArgument("Cannot parse tensor from response");
 }
 
+Status TensorResponse::DecodeContent(Tensor* tensor) {
+  if (!meta_.transport_options().Is<EncodedTensorContent>()) {
+    return Status::OK();
+  }
+  EncodedTensorContent encoded;
+  if (!meta_.transport_options().UnpackTo(&encoded)) {
+    return errors::InvalidArgument("Cannot parse encoded tensor content");
+  }
+  meta_.clear_transport_options();
+  return DecodeTensorContent(encoded, tensor);
+}
+
+Status TensorResponse::DecodeContent(TensorProto* proto) {
+  if (!meta_.transport_options().Is<EncodedTensorContent>()) {
+    return Status::OK();
+  }
+  Tensor tensor;
+  if (!tensor.FromProto(cpu_allocator(), *proto)) {
+    return errors::InvalidArgument("Cannot parse tensor from response");
+  }
+  TF_RETURN_IF_ERROR(DecodeContent(&tensor));
+  tensor.AsProtoTensorContent(proto);
+  return Status::OK();
+}
+
 // Define some helper routines for decoding protocol buffer wire format data
 namespace {
 // We only need some of the wiretype values for this code
@@ -145,7 +192,8 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 }  // namespace
 
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta,
+    Allocator* allocator) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -156,7 +204,7 @@ bool TensorResponse::ParseTensorSubmessage(
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(allocator, tensor_meta->dtype(), shape);
         tensor_ = std::move(t);
       }
       return ok;
@@ -196,7 +244,7 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(allocator, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
         // TODO(jeff,sanjay): Figure out a way to avoid this copy if
@@ -216,7 +264,7 @@ bool TensorResponse::ParseTensorSubmessage(
   }
 }
 
-bool TensorResponse::ParseFast(Source* source) {
+bool TensorResponse::ParseFast(Source* source, Allocator* allocator) {
   protobuf::io::CodedInputStream input(source->contents());
   input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
   while (true) {
@@ -235,7 +283,8 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(&input, meta_.mutable_tensor(),
+                                   allocator)) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -277,6 +326,35 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
+bool TensorResponse::ParseFastToDevice(Source* source, Status* status) {
+  // Decode the contents straight into a host buffer that the device can copy
+  // from, instead of into a TensorProto that the device decodes again.
+  if (host_allocator_ == nullptr) return false;
+  meta_.Clear();
+  tensor_ = Tensor();
+  if (!ParseFast(source, host_allocator_) || !tensor_.IsInitialized()) {
+    meta_.Clear();
+    tensor_ = Tensor();
+    return false;
+  }
+  meta_.clear_tensor();
+  Status s = DecodeContent(&tensor_);
+  if (!s.ok()) {
+    *status = s;
+    return true;
+  }
+  const Tensor host_tensor = std::move(tensor_);
+  tensor_ = Tensor();
+  s = device_->MakeTensorFromHostTensor(host_tensor, alloc_attrs_, &tensor_);
+  if (errors::IsUnimplemented(s)) {
+    meta_.Clear();
+    tensor_ = Tensor();
+    return false;
+  }
+  *status = s;
+  return true;
+}
+
 bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
@@ -298,4 +376,90 @@ bool TensorResponse::ParseSlow(Source* source) {
   return true;
 }
 
+bool EncodeTensorContent(const Tensor& val,
+                         EncodedTensorContent::Compression compression,
+                         bool float_as_bfloat16,
+                         EncodedTensorContent* encoded) {
+  if (!DataTypeCanUseMemcpy(val.dtype())) return false;
+  StringPiece data = val.tensor_data();
+  const bool cast = float_as_bfloat16 && val.dtype() == DT_FLOAT;
+  string cast_data;
+  if (cast) {
+    // The conversion only keeps the high half of each value, which compilers
+    // vectorize.
+    cast_data.resize(val.NumElements() * sizeof(bfloat16));
+    FloatToBFloat16(reinterpret_cast<const float*>(data.data()),
+                    reinterpret_cast<bfloat16*>(&cast_data[0]),
+                    val.NumElements());
+    data = cast_data;
+  }
+  encoded->set_float_as_bfloat16(cast);
+  if (compression == EncodedTensorContent::SNAPPY) {
+    string compressed;
+    if (port::Snappy_Compress(data.data(), data.size(), &compressed) &&
+        compressed.size() < data.size()) {
+      encoded->set_compression(EncodedTensorContent::SNAPPY);
+      encoded->set_content(std::move(compressed));
+      return true;
+    }
+  }
+  if (!cast) return false;
+  encoded->set_compression(EncodedTensorContent::NONE);
+  encoded->set_content(std::move(cast_data));
+  return true;
+}
+
+Status DecodeTensorContent(const EncodedTensorContent& encoded,
+                           Tensor* tensor) {
+  const bool cast = encoded.float_as_bfloat16();
+  if (!DataTypeCanUseMemcpy(tensor->dtype()) ||
+      (cast && tensor->dtype() != DT_FLOAT)) {
+    return errors::InvalidArgument("Cannot decode encoded content into a ",
+                                   DataTypeString(tensor->dtype()),
+                                   " tensor");
+  }
+  const size_t num_bytes =
+      cast ? tensor->NumElements() * sizeof(bfloat16) : tensor->TotalBytes();
+  char* dst = const_cast<char*>(tensor->tensor_data().data());
+  StringPiece content = encoded.content();
+  string uncompressed;
+  switch (encoded.compression()) {
+    case EncodedTensorContent::NONE:
+      break;
+    case EncodedTensorContent::SNAPPY: {
+      size_t uncompressed_bytes;
+      if (!port::Snappy_GetUncompressedLength(content.data(), content.size(),
+                                              &uncompressed_bytes) ||
+          uncompressed_bytes != num_bytes) {
+        return errors::InvalidArgument(
+            "Encoded tensor content has the wrong size");
+      }
+      // Uncompress straight into the tensor unless it still has to be cast.
+      if (cast) {
+        uncompressed.resize(num_bytes);
+      }
+      if (!port::Snappy_Uncompress(content.data(), content.size(),
+                                   cast ? &uncompressed[0] : dst)) {
+        return errors::InvalidArgument("Cannot uncompress tensor content");
+      }
+      if (!cast) return Status::OK();
+      content = uncompressed;
+      break;
+    }
+    default:
+      return errors::Unimplemented("Unknown tensor content compression ",
+                                   encoded.compression());
+  }
+  if (content.size() != num_bytes) {
+    return errors::InvalidArgument("Encoded tensor content has the wrong size");
+  }
+  if (cast) {
+    BFloat16ToFloat(reinterpret_cast<const bfloat16*>(content.data()),
+                    reinterpret_cast<float*>(dst), tensor->NumElements());
+  } else if (num_bytes > 0) {
+    memcpy(dst, content.data(), num_bytes);
+  }
+  return Status::OK();
+}
+
 }  // namespace tensorflow
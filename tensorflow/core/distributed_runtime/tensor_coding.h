@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
@@ -93,19 +94,43 @@ class TensorResponse {
 
  private:
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
-                             TensorProto* tensor_meta);
-  bool ParseFast(Source* source);
+                             TensorProto* tensor_meta, Allocator* allocator);
+  bool ParseFast(Source* source, Allocator* allocator);
   bool ParseSlow(Source* source);
 
+  // Parses the response for a tensor that is not on the host. Returns false
+  // if the contents have to be decoded by the device from a TensorProto.
+  bool ParseFastToDevice(Source* source, Status* status);
+
+  // If the sender encoded the content of the tensor, decodes it from the
+  // transport options into `tensor`, or into the content of `proto`.
+  Status DecodeContent(Tensor* tensor);
+  Status DecodeContent(TensorProto* proto);
+
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
+  // Allocates the host buffers that tensors not on the host are decoded
+  // into before they are copied to the device.
+  Allocator* host_allocator_ = nullptr;
   bool already_used_ = false;
   Tensor tensor_;
   RecvTensorResponse meta_;
 };
 
+// Encodes the content of `val` into `encoded`, with `compression`, and as
+// bfloat16 if `float_as_bfloat16` is true and `val` is a float tensor.
+// Returns false, leaving `encoded` unspecified, if the encoded content would
+// not be smaller than the content of `val`.
+bool EncodeTensorContent(const Tensor& val,
+                         EncodedTensorContent::Compression compression,
+                         bool float_as_bfloat16, EncodedTensorContent* encoded);
+
+// Decodes `encoded` into the buffer of `tensor`, which must have the dtype
+// and shape of the tensor that was encoded.
+Status DecodeTensorContent(const EncodedTensorContent& encoded, Tensor* tensor);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODING_H_
@@ -18,7 +18,9 @@ limitations under the License.
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -46,6 +48,47 @@ class DummyDevice : public DeviceBase {
   DeviceAttributes attr_;
 };
 
+// A device that is not on the host, and counts how it makes tensors from
+// received contents.
+class FakeGpuDevice : public DeviceBase {
+ public:
+  explicit FakeGpuDevice(Env* env) : DeviceBase(env) {
+    attr_.set_device_type("GPU");
+    set_tensorflow_gpu_device_info(&gpu_device_info_);
+  }
+
+  const DeviceAttributes& attributes() const override { return attr_; }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+  Status MakeTensorFromProto(const TensorProto& tensor_proto,
+                             const AllocatorAttributes alloc_attrs,
+                             Tensor* tensor) override {
+    ++num_from_proto_;
+    if (!tensor->FromProto(cpu_allocator(), tensor_proto)) {
+      return errors::InvalidArgument("Cannot parse tensor from proto");
+    }
+    return Status::OK();
+  }
+
+  Status MakeTensorFromHostTensor(const Tensor& host_tensor,
+                                  const AllocatorAttributes alloc_attrs,
+                                  Tensor* tensor) override {
+    ++num_from_host_tensor_;
+    *tensor = tensor::DeepCopy(host_tensor);
+    return Status::OK();
+  }
+
+  int num_from_proto_ = 0;
+  int num_from_host_tensor_ = 0;
+
+ private:
+  DeviceAttributes attr_;
+  GpuDeviceInfo gpu_device_info_;
+};
+
 class StringSource : public TensorResponse::Source {
  public:
   explicit StringSource(const string* s, int block_size)
@@ -156,6 +199,84 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, DecodesIntoHostTensorForDevice) {
+  FakeGpuDevice gpu_device(Env::Default());
+  for (const Tensor& src :
+       {test::AsTensor<float>({1.0, 2.0, 3.0}),
+        Tensor(DT_FLOAT, TensorShape({0})),
+        test::AsTensor<tstring>({"a", "b"})}) {
+    RecvTensorResponse proto;
+    proto.set_send_start_micros(123456);
+    src.AsProtoTensorContent(proto.mutable_tensor());
+    string encoded;
+    proto.AppendToString(&encoded);
+    StringSource source(&encoded, 2);
+
+    gpu_device.num_from_proto_ = 0;
+    gpu_device.num_from_host_tensor_ = 0;
+    TensorResponse response;
+    response.InitAlloc(&gpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(123456, response.metadata().send_start_micros());
+    EXPECT_FALSE(response.metadata().has_tensor());
+    EXPECT_EQ(src.DebugString(), response.tensor().DebugString());
+    // Only tensors that can be copied with memcpy skip the TensorProto.
+    if (DataTypeCanUseMemcpy(src.dtype())) {
+      EXPECT_EQ(1, gpu_device.num_from_host_tensor_);
+      EXPECT_EQ(0, gpu_device.num_from_proto_);
+    } else {
+      EXPECT_EQ(0, gpu_device.num_from_host_tensor_);
+      EXPECT_EQ(1, gpu_device.num_from_proto_);
+    }
+  }
+}
+
+TEST_F(TensorResponseTest, DecodesEncodedContent) {
+  // Values that survive the cast to bfloat16, with runs snappy can compress.
+  std::vector<float> v(4096);
+  for (size_t i = 0; i < v.size(); i++) {
+    v[i] = static_cast<float>(i / 64);
+  }
+  Tensor src(DT_FLOAT, TensorShape({static_cast<int64>(v.size())}));
+  test::FillValues<float>(&src, v);
+  for (bool float_as_bfloat16 : {false, true}) {
+    EncodedTensorContent content;
+    ASSERT_TRUE(EncodeTensorContent(src, EncodedTensorContent::SNAPPY,
+                                    float_as_bfloat16, &content));
+    EXPECT_LT(content.content().size(), src.TotalBytes());
+
+    RecvTensorResponse proto;
+    proto.mutable_tensor()->set_dtype(src.dtype());
+    src.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+    proto.mutable_transport_options()->PackFrom(content);
+    string encoded;
+    proto.AppendToString(&encoded);
+    StringSource source(&encoded, 1024);
+
+    TensorResponse response;
+    DummyDevice cpu_device(Env::Default());
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    EXPECT_FALSE(response.metadata().has_transport_options());
+    test::ExpectTensorEqual<float>(src, response.tensor());
+  }
+
+  // Content that does not get smaller is not encoded.
+  EncodedTensorContent content;
+  EXPECT_FALSE(EncodeTensorContent(test::AsTensor<float>({1.0, 2.0}),
+                                   EncodedTensorContent::SNAPPY, false,
+                                   &content));
+}
+
+TEST_F(TensorResponseTest, RejectsEncodedContentOfWrongSize) {
+  EncodedTensorContent content;
+  content.set_content(string(7, 'a'));
+  Tensor tensor(DT_FLOAT, TensorShape({2}));
+  EXPECT_FALSE(DecodeTensorContent(content, &tensor).ok());
+  content.set_compression(EncodedTensorContent::SNAPPY);
+  EXPECT_FALSE(DecodeTensorContent(content, &tensor).ok());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
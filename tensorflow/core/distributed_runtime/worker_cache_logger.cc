@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor_description.pb.h"
@@ -87,9 +89,9 @@ void WorkerCacheLogger::RecordRecvTensor(int64 step_id, int64 start_usecs,
                                          const string& tensor_name,
                                          const string& src_device,
                                          const string& dst_device,
-                                         int64 bytes) {
+                                         int64 bytes, int64 request_usecs) {
   RecordDataTransfer(step_id, start_usecs, end_usecs, tensor_name, src_device,
-                     dst_device, bytes, "", "RecvTensor");
+                     dst_device, bytes, "", "RecvTensor", request_usecs);
 }
 
 void WorkerCacheLogger::RecordDataTransfer(int64 step_id, int64 start_usecs,
@@ -98,7 +100,8 @@ void WorkerCacheLogger::RecordDataTransfer(int64 step_id, int64 start_usecs,
                                            const string& src_device,
                                            const string& dst_device,
                                            int64 bytes, const string& details,
-                                           const string& transfer_method_name) {
+                                           const string& transfer_method_name,
+                                           int64 request_usecs) {
   NodeExecStats* ns = new NodeExecStats;
   ns->set_node_name(transfer_method_name);
   int64 elapsed_usecs = end_usecs - start_usecs;
@@ -119,6 +122,9 @@ void WorkerCacheLogger::RecordDataTransfer(int64 step_id, int64 start_usecs,
   }
 
   ns->set_all_start_micros(start_usecs);
+  if (request_usecs > 0) {
+    ns->set_scheduled_micros(std::min(request_usecs, start_usecs));
+  }
   ns->set_op_start_rel_micros(0);
   ns->set_op_end_rel_micros(elapsed_usecs);
   ns->set_all_end_rel_micros(elapsed_usecs);
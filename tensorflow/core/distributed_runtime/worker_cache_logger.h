@@ -55,10 +55,14 @@ class WorkerCacheLogger {
   }
 
   // Generates a NodeExecStats record with the given data, and saves for
-  // later retrieval by RetrieveLogs().
+  // later retrieval by RetrieveLogs().  `request_usecs` is the time at which
+  // the request was issued, and is saved as the scheduled time of the record
+  // if positive, so that the time that the request waited for the sender can
+  // be told apart from the time of the transfer itself.
   void RecordRecvTensor(int64 step_id, int64 start_usecs, int64 end_usecs,
                         const string& tensor_name, const string& src_device,
-                        const string& dst_device, int64 bytes);
+                        const string& dst_device, int64 bytes,
+                        int64 request_usecs = 0);
 
   // Generates a NodeExecStats record with the given data, and saves for
   // later retrieval by RetrieveLogs().
@@ -66,7 +70,8 @@ class WorkerCacheLogger {
                           const string& tensor_name, const string& src_device,
                           const string& dst_device, int64 bytes,
                           const string& details,
-                          const string& transfer_method_name);
+                          const string& transfer_method_name,
+                          int64 request_usecs = 0);
 
  private:
   mutex count_mu_;
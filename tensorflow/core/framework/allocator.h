@@ -420,6 +420,24 @@ bool CPUAllocatorStatsEnabled();
 void EnableCPUAllocatorFullStats(bool enable);
 bool CPUAllocatorFullStatsEnabled();
 
+// Statistics of the allocations that the default CPU allocator serves from
+// huge pages.  Allocations of at least TF_CPU_ALLOCATOR_HUGE_PAGE_THRESHOLD
+// bytes are mapped with transparent huge pages enabled, or, if
+// TF_CPU_ALLOCATOR_USE_HUGETLB is true, from the hugetlbfs pool when it has
+// enough free pages.  Only supported on Linux.
+struct CPUAllocatorHugePageStats {
+  int64 num_allocs = 0;  // Number of allocations mapped for huge pages.
+  // Number of allocations above the threshold that failed to be mapped, and
+  // were served by the regular allocator instead.
+  int64 num_fallbacks = 0;
+  int64 bytes_in_use = 0;          // Bytes mapped for allocations in use.
+  int64 hugetlb_bytes_in_use = 0;  // Those of `bytes_in_use` from hugetlbfs.
+  // Those of `bytes_in_use` that the kernel currently backs with huge pages,
+  // which it may not do for all of a transparent huge page mapping.
+  int64 huge_page_bytes = 0;
+};
+CPUAllocatorHugePageStats GetCPUAllocatorHugePageStats();
+
 // An object that does the underlying suballoc/free of memory for a higher-level
 // allocator.  The expectation is that the higher-level allocator is doing some
 // kind of cache or pool management so that it will call SubAllocator::Alloc and
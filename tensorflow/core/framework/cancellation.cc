@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/cancellation.h"
 
 #include <forward_list>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -25,6 +26,75 @@ namespace tensorflow {
 
 const CancellationToken CancellationManager::kInvalidToken = -1;
 
+constexpr int CancellationManager::State::kNumInlineCallbacks;
+
+CancellationManager::State::State() {
+  for (auto& slot : inline_callbacks) {
+    slot.first = kInvalidToken;
+  }
+}
+
+void CancellationManager::State::AddCallback(CancellationToken token,
+                                             CancelCallback callback) {
+  std::pair<CancellationToken, CancelCallback>* free_slot = nullptr;
+  for (auto& slot : inline_callbacks) {
+    if (slot.first == token) {
+      slot.second = std::move(callback);
+      return;
+    }
+    if (free_slot == nullptr && slot.first == kInvalidToken) {
+      free_slot = &slot;
+    }
+  }
+  if (callbacks) {
+    auto it = callbacks->find(token);
+    if (it != callbacks->end()) {
+      it->second = std::move(callback);
+      return;
+    }
+  }
+  if (free_slot != nullptr) {
+    free_slot->first = token;
+    free_slot->second = std::move(callback);
+    return;
+  }
+  if (!callbacks) {
+    callbacks =
+        absl::make_unique<gtl::FlatMap<CancellationToken, CancelCallback>>();
+  }
+  (*callbacks)[token] = std::move(callback);
+}
+
+void CancellationManager::State::RemoveCallback(CancellationToken token) {
+  for (auto& slot : inline_callbacks) {
+    if (slot.first == token) {
+      slot.first = kInvalidToken;
+      slot.second = nullptr;
+      return;
+    }
+  }
+  if (callbacks) {
+    callbacks->erase(token);
+  }
+}
+
+void CancellationManager::State::TakeCallbacks(
+    std::vector<CancelCallback>* callbacks_to_run) {
+  for (auto& slot : inline_callbacks) {
+    if (slot.first != kInvalidToken) {
+      callbacks_to_run->push_back(std::move(slot.second));
+      slot.first = kInvalidToken;
+      slot.second = nullptr;
+    }
+  }
+  if (callbacks) {
+    for (auto& key_and_value : *callbacks) {
+      callbacks_to_run->push_back(std::move(key_and_value.second));
+    }
+    callbacks.reset();
+  }
+}
+
 CancellationManager::CancellationManager()
     : is_cancelling_(false),
       is_cancelled_(false),
@@ -36,7 +106,7 @@ CancellationManager::CancellationManager(CancellationManager* parent)
 }
 
 void CancellationManager::StartCancel() {
-  gtl::FlatMap<CancellationToken, CancelCallback> callbacks_to_run;
+  std::vector<CancelCallback> callbacks_to_run;
   std::forward_list<CancellationManager*> children_to_cancel;
   Notification* cancelled_notification = nullptr;
   {
@@ -46,7 +116,7 @@ void CancellationManager::StartCancel() {
     }
     is_cancelling_ = true;
     if (state_) {
-      std::swap(state_->callbacks, callbacks_to_run);
+      state_->TakeCallbacks(&callbacks_to_run);
 
       // Remove all children from the list of children.
       CancellationManager* child = state_->first_child;
@@ -65,8 +135,8 @@ void CancellationManager::StartCancel() {
   // not block. The callbacks remain valid because any concurrent call
   // to DeregisterCallback will block until the
   // cancelled_notification_ is notified.
-  for (auto key_and_value : callbacks_to_run) {
-    key_and_value.second();
+  for (const CancelCallback& callback : callbacks_to_run) {
+    callback();
   }
   for (CancellationManager* child : children_to_cancel) {
     child->StartCancel();
@@ -90,7 +160,7 @@ bool CancellationManager::RegisterCallback(CancellationToken token,
     if (!state_) {
       state_ = absl::make_unique<State>();
     }
-    std::swap(state_->callbacks[token], callback);
+    state_->AddCallback(token, std::move(callback));
   }
   return should_register;
 }
@@ -114,7 +184,7 @@ bool CancellationManager::DeregisterCallback(CancellationToken token) {
     return false;
   } else {
     if (state_) {
-      state_->callbacks.erase(token);
+      state_->RemoveCallback(token);
     }
     mu_.unlock();
     return true;
@@ -186,7 +256,7 @@ bool CancellationManager::TryDeregisterCallback(CancellationToken token) {
     return false;
   } else {
     if (state_) {
-      state_->callbacks.erase(token);
+      state_->RemoveCallback(token);
     }
     return true;
   }
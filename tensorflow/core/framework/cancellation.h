@@ -18,6 +18,9 @@ limitations under the License.
 
 #include <atomic>
 #include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -148,8 +151,25 @@ class CancellationManager {
 
  private:
   struct State {
+    State();
+
+    // Registers `callback` for `token`, replacing a callback registered for
+    // the same token.
+    void AddCallback(CancellationToken token, CancelCallback callback);
+    // Deregisters the callback of `token`, if any.
+    void RemoveCallback(CancellationToken token);
+    // Moves the registered callbacks to `*callbacks_to_run`.
+    void TakeCallbacks(std::vector<CancelCallback>* callbacks_to_run);
+
     Notification cancelled_notification;
-    gtl::FlatMap<CancellationToken, CancelCallback> callbacks;
+
+    // Most steps register only a few callbacks at once, which are stored
+    // inline, and only the callbacks that don't fit go to a map allocated on
+    // demand.  The free inline slots have `kInvalidToken`.
+    static constexpr int kNumInlineCallbacks = 4;
+    std::pair<CancellationToken, CancelCallback>
+        inline_callbacks[kNumInlineCallbacks];
+    std::unique_ptr<gtl::FlatMap<CancellationToken, CancelCallback>> callbacks;
 
     // If this CancellationManager has any children, this member points to the
     // head of a doubly-linked list of its children.
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
@@ -99,6 +100,30 @@ TEST(Cancellation, CancelMultiple) {
   delete manager;
 }
 
+TEST(Cancellation, CancelMany) {
+  // More callbacks than are stored inline.
+  constexpr int kNumCallbacks = 10;
+  CancellationManager manager;
+  std::vector<CancellationToken> tokens;
+  std::vector<int> num_calls(kNumCallbacks, 0);
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    tokens.push_back(manager.get_cancellation_token());
+    EXPECT_TRUE(manager.RegisterCallback(
+        tokens[i], [&num_calls, i]() { ++num_calls[i]; }));
+  }
+  // Deregister some inline and some spilled callbacks, then reuse their slots.
+  EXPECT_TRUE(manager.DeregisterCallback(tokens[1]));
+  EXPECT_TRUE(manager.DeregisterCallback(tokens[6]));
+  tokens.push_back(manager.get_cancellation_token());
+  num_calls.push_back(0);
+  EXPECT_TRUE(manager.RegisterCallback(
+      tokens.back(), [&num_calls]() { ++num_calls[kNumCallbacks]; }));
+  manager.StartCancel();
+  for (int i = 0; i <= kNumCallbacks; ++i) {
+    EXPECT_EQ(num_calls[i], i == 1 || i == 6 ? 0 : 1) << i;
+  }
+}
+
 TEST(Cancellation, IsCancelled) {
   CancellationManager* cm = new CancellationManager();
   thread::ThreadPool w(Env::Default(), "test", 4);
@@ -256,4 +281,19 @@ TEST(Cancellation, Parent_RandomDestructionOrder) {
   }
 }
 
+static void BM_RegisterAndDeregisterCallbacks(int iters, int num_callbacks) {
+  std::vector<CancellationToken> tokens(num_callbacks);
+  while (iters-- > 0) {
+    CancellationManager manager;
+    for (int i = 0; i < num_callbacks; ++i) {
+      tokens[i] = manager.get_cancellation_token();
+      manager.RegisterCallback(tokens[i], []() {});
+    }
+    for (int i = 0; i < num_callbacks; ++i) {
+      manager.DeregisterCallback(tokens[i]);
+    }
+  }
+}
+BENCHMARK(BM_RegisterAndDeregisterCallbacks)->Arg(1)->Arg(4)->Arg(16);
+
 }  // namespace tensorflow
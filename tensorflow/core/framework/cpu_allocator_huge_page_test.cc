@@ -0,0 +1,60 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdlib>
+#include <cstring>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// The threshold is read on the first allocation of the CPU allocator.
+const bool kHugePagesEnabled =
+    setenv("TF_CPU_ALLOCATOR_HUGE_PAGE_THRESHOLD", "4194304", 1) == 0;
+
+#if defined(__linux__)
+
+TEST(CPUAllocatorHugePageTest, MapsLargeAllocations) {
+  ASSERT_TRUE(kHugePagesEnabled);
+  Allocator* a = cpu_allocator_base();
+  const CPUAllocatorHugePageStats before = GetCPUAllocatorHugePageStats();
+
+  void* small = a->AllocateRaw(Allocator::kAllocatorAlignment, 1 << 20);
+  void* large = a->AllocateRaw(Allocator::kAllocatorAlignment, (5 << 20) + 3);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % (2 << 20), 0);
+  memset(large, 1, (5 << 20) + 3);
+
+  CPUAllocatorHugePageStats stats = GetCPUAllocatorHugePageStats();
+  EXPECT_EQ(stats.num_allocs + stats.num_fallbacks,
+            before.num_allocs + before.num_fallbacks + 1);
+  if (stats.num_allocs > before.num_allocs) {
+    // Rounded up to huge pages.
+    EXPECT_EQ(stats.bytes_in_use, before.bytes_in_use + (6 << 20));
+    EXPECT_LE(stats.huge_page_bytes, stats.bytes_in_use);
+  }
+
+  a->DeallocateRaw(large);
+  a->DeallocateRaw(small);
+  stats = GetCPUAllocatorHugePageStats();
+  EXPECT_EQ(stats.bytes_in_use, before.bytes_in_use);
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+}  // namespace tensorflow
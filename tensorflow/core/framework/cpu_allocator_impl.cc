@@ -13,8 +13,22 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-#include <atomic>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/allocator_registry.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -60,6 +74,214 @@ static int64_t TotalAllocationWarningBytes() {
 
 namespace {
 
+// Maps the large allocations of the CPU allocator for huge pages, which
+// reduce the TLB misses of random accesses to them, e.g. by gathers from
+// embeddings.  See CPUAllocatorHugePageStats.
+class HugePageRegions {
+ public:
+  static HugePageRegions* Global() {
+    static HugePageRegions* regions = new HugePageRegions;
+    return regions;
+  }
+
+  // Returns a mapping of `num_bytes` for huge pages and sets `mapped_size`
+  // to its size, or returns nullptr if `num_bytes` is below the threshold or
+  // the mapping failed.
+  void* Allocate(size_t alignment, size_t num_bytes, size_t* mapped_size) {
+#if defined(__linux__)
+    if (threshold_ < 0 || num_bytes < static_cast<uint64>(threshold_) ||
+        alignment > kHugePageSize) {
+      return nullptr;
+    }
+    void* ptr = nullptr;
+    bool hugetlb = false;
+#ifdef MAP_HUGETLB
+    if (hugetlb_page_size_ > 0) {
+      *mapped_size = RoundUp(num_bytes, hugetlb_page_size_);
+      // Fails when the pool doesn't have enough free pages.
+      ptr = mmap(nullptr, *mapped_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      hugetlb = ptr != MAP_FAILED;
+    }
+#endif
+    if (!hugetlb) {
+      *mapped_size = RoundUp(num_bytes, kHugePageSize);
+      ptr = MapAligned(*mapped_size);
+    }
+    mutex_lock l(mu_);
+    if (ptr == nullptr) {
+      ++stats_.num_fallbacks;
+      return nullptr;
+    }
+    regions_[ptr] = {*mapped_size, hugetlb};
+    num_regions_.fetch_add(1, std::memory_order_relaxed);
+    ++stats_.num_allocs;
+    stats_.bytes_in_use += *mapped_size;
+    if (hugetlb) stats_.hugetlb_bytes_in_use += *mapped_size;
+    return ptr;
+#else
+    return nullptr;
+#endif
+  }
+
+  // If `ptr` was returned by Allocate, unmaps it and returns its size, and
+  // otherwise returns 0.
+  size_t Free(void* ptr) {
+#if defined(__linux__)
+    if (num_regions_.load(std::memory_order_relaxed) == 0 ||
+        reinterpret_cast<uintptr_t>(ptr) % kHugePageSize != 0) {
+      return 0;
+    }
+    Region region;
+    {
+      mutex_lock l(mu_);
+      auto it = regions_.find(ptr);
+      if (it == regions_.end()) return 0;
+      region = it->second;
+      regions_.erase(it);
+      num_regions_.fetch_sub(1, std::memory_order_relaxed);
+      stats_.bytes_in_use -= region.size;
+      if (region.hugetlb) stats_.hugetlb_bytes_in_use -= region.size;
+    }
+    munmap(ptr, region.size);
+    return region.size;
+#else
+    return 0;
+#endif
+  }
+
+  // Returns the size of the mapping at `ptr`, or 0.
+  size_t MappedSize(const void* ptr) {
+    if (num_regions_.load(std::memory_order_relaxed) == 0) return 0;
+    mutex_lock l(mu_);
+    auto it = regions_.find(const_cast<void*>(ptr));
+    return it == regions_.end() ? 0 : it->second.size;
+  }
+
+  CPUAllocatorHugePageStats GetStats() {
+    CPUAllocatorHugePageStats stats;
+    std::vector<std::pair<uintptr_t, uintptr_t>> transparent_regions;
+    {
+      mutex_lock l(mu_);
+      stats = stats_;
+      for (const auto& region : regions_) {
+        if (region.second.hugetlb) continue;
+        const uintptr_t start = reinterpret_cast<uintptr_t>(region.first);
+        transparent_regions.emplace_back(start, start + region.second.size);
+      }
+    }
+    stats.huge_page_bytes =
+        stats.hugetlb_bytes_in_use +
+        TransparentHugePageBytes(transparent_regions);
+    return stats;
+  }
+
+ private:
+  // Transparent huge pages, to whose size mappings are aligned.
+  static constexpr size_t kHugePageSize = 2 << 20;
+
+  struct Region {
+    size_t size;
+    bool hugetlb;  // Whether the region is from the hugetlbfs pool.
+  };
+
+  HugePageRegions() {
+    const char* threshold = getenv("TF_CPU_ALLOCATOR_HUGE_PAGE_THRESHOLD");
+    if (threshold != nullptr && !absl::SimpleAtoi(threshold, &threshold_)) {
+      LOG(ERROR) << "Invalid TF_CPU_ALLOCATOR_HUGE_PAGE_THRESHOLD: "
+                 << threshold;
+      threshold_ = -1;
+    }
+    const char* use_hugetlb = getenv("TF_CPU_ALLOCATOR_USE_HUGETLB");
+    if (threshold_ >= 0 && use_hugetlb != nullptr &&
+        (absl::EqualsIgnoreCase(use_hugetlb, "true") ||
+         absl::string_view(use_hugetlb) == "1")) {
+      hugetlb_page_size_ = HugetlbPageSize();
+    }
+  }
+
+  static size_t RoundUp(size_t num_bytes, size_t page_size) {
+    return (num_bytes + page_size - 1) / page_size * page_size;
+  }
+
+  // Returns the size of the pages of the default hugetlbfs pool, or 0.
+  static size_t HugetlbPageSize() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line)) {
+      absl::string_view value(line);
+      int64 kilobytes;
+      if (absl::ConsumePrefix(&value, "Hugepagesize:") &&
+          absl::ConsumeSuffix(&value, " kB") &&
+          absl::SimpleAtoi(value, &kilobytes)) {
+        return kilobytes << 10;
+      }
+    }
+    return 0;
+  }
+
+#if defined(__linux__)
+  // Maps `size` bytes aligned to huge pages, and advises the kernel to back
+  // them with transparent huge pages.
+  static void* MapAligned(size_t size) {
+    void* mapped = mmap(nullptr, size + kHugePageSize, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) return nullptr;
+    const uintptr_t start = reinterpret_cast<uintptr_t>(mapped);
+    const uintptr_t aligned = RoundUp(start, kHugePageSize);
+    if (aligned > start) munmap(mapped, aligned - start);
+    const size_t tail = kHugePageSize - (aligned - start);
+    if (tail > 0) munmap(reinterpret_cast<void*>(aligned + size), tail);
+#ifdef MADV_HUGEPAGE
+    // Fails if transparent huge pages are disabled, leaving regular pages.
+    madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<void*>(aligned);
+  }
+#endif
+
+  // Returns the bytes of `regions` backed by transparent huge pages,
+  // according to /proc/self/smaps.
+  static int64 TransparentHugePageBytes(
+      const std::vector<std::pair<uintptr_t, uintptr_t>>& regions) {
+    if (regions.empty()) return 0;
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    int64 bytes = 0;
+    int64 overlap = 0;  // Bytes of `regions` in the current mapping.
+    while (std::getline(smaps, line)) {
+      unsigned long long start, end;  // NOLINT(runtime/int)
+      if (sscanf(line.c_str(), "%llx-%llx ", &start, &end) == 2) {
+        overlap = 0;
+        for (const auto& region : regions) {
+          const uintptr_t from = std::max<uintptr_t>(region.first, start);
+          const uintptr_t to = std::min<uintptr_t>(region.second, end);
+          if (from < to) overlap += to - from;
+        }
+        continue;
+      }
+      absl::string_view value(line);
+      int64 kilobytes;
+      if (overlap > 0 && absl::ConsumePrefix(&value, "AnonHugePages:") &&
+          absl::ConsumeSuffix(&value, " kB") &&
+          absl::SimpleAtoi(value, &kilobytes)) {
+        // Adjacent regions may be merged into one mapping with other memory.
+        bytes += std::min(kilobytes << 10, overlap);
+      }
+    }
+    return bytes;
+  }
+
+  int64 threshold_ = -1;
+  size_t hugetlb_page_size_ = 0;
+  // Number of entries of `regions_`, to skip looking up freed pointers
+  // when there are none.
+  std::atomic<int64> num_regions_{0};
+  mutex mu_;
+  std::unordered_map<void*, Region> regions_ TF_GUARDED_BY(mu_);
+  CPUAllocatorHugePageStats stats_ TF_GUARDED_BY(mu_);
+};
+
 // A default Allocator for CPU devices.  ProcessState::GetCPUAllocator() will
 // return a different version that may perform better, but may also lack the
 // optional stats triggered by the functions above.  TODO(tucker): migrate all
@@ -83,9 +305,14 @@ class CPUAllocator : public Allocator {
                    << "% of free system memory.";
     }
 
-    void* p = port::AlignedMalloc(num_bytes, alignment);
+    size_t mapped_size = 0;
+    void* p = HugePageRegions::Global()->Allocate(alignment, num_bytes,
+                                                  &mapped_size);
+    if (p == nullptr) p = port::AlignedMalloc(num_bytes, alignment);
     if (cpu_allocator_collect_stats) {
-      const std::size_t alloc_size = port::MallocExtension_GetAllocatedSize(p);
+      const std::size_t alloc_size =
+          mapped_size > 0 ? mapped_size
+                          : port::MallocExtension_GetAllocatedSize(p);
       mutex_lock l(mu_);
       ++stats_.num_allocs;
       stats_.bytes_in_use += alloc_size;
@@ -106,13 +333,15 @@ class CPUAllocator : public Allocator {
   }
 
   void DeallocateRaw(void* ptr) override {
+    const size_t mapped_size = HugePageRegions::Global()->Free(ptr);
     if (cpu_allocator_collect_stats) {
       const std::size_t alloc_size =
-          port::MallocExtension_GetAllocatedSize(ptr);
+          mapped_size > 0 ? mapped_size
+                          : port::MallocExtension_GetAllocatedSize(ptr);
       mutex_lock l(mu_);
       stats_.bytes_in_use -= alloc_size;
     }
-    port::AlignedFree(ptr);
+    if (mapped_size == 0) port::AlignedFree(ptr);
   }
 
   absl::optional<AllocatorStats> GetStats() override {
@@ -128,6 +357,8 @@ class CPUAllocator : public Allocator {
   }
 
   size_t AllocatedSizeSlow(const void* ptr) const override {
+    const size_t mapped_size = HugePageRegions::Global()->MappedSize(ptr);
+    if (mapped_size > 0) return mapped_size;
     return port::MallocExtension_GetAllocatedSize(ptr);
   }
 
@@ -173,4 +404,8 @@ class CPUAllocatorFactory : public AllocatorFactory {
 REGISTER_MEM_ALLOCATOR("DefaultCPUAllocator", 100, CPUAllocatorFactory);
 }  // namespace
 
+CPUAllocatorHugePageStats GetCPUAllocatorHugePageStats() {
+  return HugePageRegions::Global()->GetStats();
+}
+
 }  // namespace tensorflow
@@ -252,6 +252,18 @@ class DeviceBase {
     return errors::Internal("Device does not implement MakeTensorFromProto()");
   }
 
+  // Copies 'host_tensor', whose contents are in host memory, into 'tensor'
+  // stored in Device memory. Receivers that decode tensor contents
+  // themselves use this instead of MakeTensorFromProto() to avoid copying
+  // them into a TensorProto first. 'host_tensor' is best allocated with the
+  // on_host and gpu_compatible attributes.
+  virtual Status MakeTensorFromHostTensor(const Tensor& host_tensor,
+                                          const AllocatorAttributes alloc_attrs,
+                                          Tensor* tensor) {
+    return errors::Unimplemented(
+        "Device does not implement MakeTensorFromHostTensor()");
+  }
+
   // Some devices (i.e. GPUs) may free device memory prior to its actual use
   // being completed on the assumption that subsequent allocations can only be
   // used serially with respect to pending uses.  If this function returns a
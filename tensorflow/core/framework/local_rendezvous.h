@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
+
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -62,10 +64,31 @@ class LocalRendezvous {
 
   typedef gtl::FlatMap<uint64, ItemQueue> Table;
 
-  // TODO(zhifengc): shard table_.
-  mutex mu_;
-  Table table_ TF_GUARDED_BY(mu_);
-  Status status_ TF_GUARDED_BY(mu_);
+  // The items are kept in one of kNumBuckets tables, chosen by the hash of
+  // their key, so that Send and Recv calls for different keys rarely wait
+  // on the same lock.
+  static constexpr int kNumBuckets = 16;
+  struct TableBucket {
+    mutex mu;
+    Table table TF_GUARDED_BY(mu);
+  };
+
+  TableBucket* GetBucket(uint64 key_hash) {
+    return &buckets_[key_hash % kNumBuckets];
+  }
+
+  // Returns the status the rendezvous was aborted with, if any.
+  // REQUIRES: the lock of the bucket to be accessed is held, so that an
+  // item added to it afterwards is seen by a concurrent StartAbort().
+  Status AbortedStatus();
+
+  TableBucket buckets_[kNumBuckets];
+
+  // Set once status_ is not OK, so that Send and Recv need not take
+  // status_mu_.
+  std::atomic<bool> aborted_{false};
+  mutex status_mu_;
+  Status status_ TF_GUARDED_BY(status_mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(LocalRendezvous);
 };
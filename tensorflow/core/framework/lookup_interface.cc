@@ -79,6 +79,12 @@ Status LookupInterface::CheckKeyTensorForRemove(const Tensor& keys) {
   return CheckKeyShape(keys.shape());
 }
 
+Status LookupInterface::Evict(OpKernelContext* ctx, int64 max_idle_steps,
+                              int64* num_evicted) {
+  return errors::Unimplemented(
+      "This lookup table does not support eviction of idle entries.");
+}
+
 Status LookupInterface::CheckFindArguments(const Tensor& key,
                                            const Tensor& default_value) {
   TF_RETURN_IF_ERROR(CheckKeyAndValueTypes(key, default_value));
@@ -91,6 +91,18 @@ class LookupInterface : public ResourceBase {
   virtual Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
                               const Tensor& values) = 0;
 
+  // Removes the entries that have not been looked up or inserted during the
+  // last `max_idle_steps` steps, and sets `*num_evicted` to their number.
+  // Steps are counted by the table itself. This method is only implemented in
+  // tables that track the last access of their entries.
+  //
+  // Returns the following statuses:
+  // - OK: when the eviction finishes successfully.
+  // - InvalidArgument: if `max_idle_steps` is negative.
+  // - Unimplemented: if the table does not track accesses.
+  virtual Status Evict(OpKernelContext* ctx, int64 max_idle_steps,
+                       int64* num_evicted);
+
   // Returns the data type of the key.
   virtual DataType key_dtype() const = 0;
 
@@ -14,8 +14,12 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/framework/metrics.h"
+
+#include <algorithm>
+
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
 namespace metrics {
@@ -42,6 +46,14 @@ auto* graph_run_time_usecs_histogram = monitoring::Sampler<0>::New(
     // Power of 2 with bucket count 20 (> 17 minutes)
     {monitoring::Buckets::Exponential(1000, 2, 20)});
 
+auto* direct_session_phase_time_nanos_histogram = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/direct_session_phase_time_nanos_histogram",
+     "The wall-clock time spent in each phase of a DirectSession step in "
+     "nanoseconds.",
+     "phase"},
+    // Power of 2 with bucket count 24 (> 0.8 seconds)
+    {monitoring::Buckets::Exponential(100, 2, 24)});
+
 auto* graph_run_input_tensor_bytes = monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -111,6 +123,20 @@ auto* tf_data_getnext_time_between_msecs_histogram =
 auto* tf_data_optimization_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/optimization", "tf.data optimization", "name");
 
+auto* tf_data_service_dispatcher_recovery_usecs_histogram =
+    monitoring::Sampler<0>::New(
+        {"/tensorflow/data/service/dispatcher_recovery_time",
+         "Microseconds spent by the tf.data service dispatcher restoring its "
+         "state from its journal on startup."},
+        // Power of 2 with bucket count 20 (> 17 minutes)
+        {monitoring::Buckets::Exponential(1000, 2, 20)});
+
+auto* tf_data_service_dispatcher_recovered_updates_counter =
+    monitoring::Counter<0>::New(
+        "/tensorflow/data/service/dispatcher_recovered_updates",
+        "The number of journal updates replayed by the tf.data service "
+        "dispatcher when restoring its state.");
+
 auto* parse_dense_feature_counter = monitoring::Counter<0>::New(
     "/tensorflow/data/dense_feature",
     "The number of dense features parsed by ops for parsing tf.Example.");
@@ -123,6 +149,30 @@ auto* parse_ragged_feature_counter = monitoring::Counter<0>::New(
     "/tensorflow/data/ragged_feature",
     "The number of ragged features parsed by ops for parsing tf.Example.");
 
+auto* tiered_lookup_table_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/tiered_lookup_table",
+    "The number of hits, misses, promotions and evictions of the tiers of "
+    "tiered lookup tables.",
+    "event");
+
+auto* lookup_table_admission_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/lookup_table_admission",
+    "The number of keys admitted, rejected and evicted by lookup tables with a "
+    "frequency-based admission policy.",
+    "event");
+
+auto* gpu_host_memory_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/gpu_host_memory",
+    "The number of times GPU staging allocators pinned or unpinned host "
+    "memory.",
+    "event");
+
+auto* gpu_host_memory_bytes_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/gpu_host_memory_bytes",
+    "The number of bytes of host memory GPU staging allocators pinned or "
+    "unpinned.",
+    "event");
+
 auto* build_graph_calls = monitoring::Counter<0>::New(
     "/tensorflow/core/graph_build_calls",
     "The number of times TensorFlow has created a new client graph. "
@@ -158,6 +208,40 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* run_handler_latency_usecs_histogram = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/run_handler_latency_usecs_histogram",
+     "The time between obtaining and releasing a RunHandler in microseconds, "
+     "by request priority.",
+     "priority"},
+    // Power of 2 with bucket count 20 (> 17 minutes)
+    {monitoring::Buckets::Exponential(1000, 2, 20)});
+
+auto* run_handler_missed_deadlines = monitoring::Counter<1>::New(
+    "/tensorflow/core/run_handler_missed_deadlines",
+    "The number of RunHandler requests released after their deadline, by "
+    "request priority.",
+    "priority");
+
+auto* distributed_step_lateness_usecs_histogram = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/distributed_step_lateness_usecs_histogram",
+     "How much later than the median worker each worker finished the traced "
+     "distributed steps, in microseconds, by worker task.",
+     "worker"},
+    // Power of 2 with bucket count 20 (> 17 minutes)
+    {monitoring::Buckets::Exponential(1000, 2, 20)});
+
+auto* distributed_step_stragglers = monitoring::Counter<1>::New(
+    "/tensorflow/core/distributed_step_stragglers",
+    "The number of traced distributed steps in which each worker task was a "
+    "straggler.",
+    "worker");
+
+auto* distributed_step_slow_links = monitoring::Counter<2>::New(
+    "/tensorflow/core/distributed_step_slow_links",
+    "The number of traced distributed steps in which the tensor transfers "
+    "between two worker tasks were slow.",
+    "src_worker", "dst_worker");
+
 }  // namespace
 
 void RecordTFDataAutotune(const string& name) {
@@ -210,6 +294,14 @@ void RecordTFDataOptimization(const string& name, int64 num_changes) {
   tf_data_optimization_counter->GetCell(name)->IncrementBy(num_changes);
 }
 
+void RecordTFDataServiceDispatcherRecovery(uint64 duration_us,
+                                           int64 num_updates) {
+  tf_data_service_dispatcher_recovery_usecs_histogram->GetCell()->Add(
+      duration_us);
+  tf_data_service_dispatcher_recovered_updates_counter->GetCell()->IncrementBy(
+      num_updates);
+}
+
 void RecordParseDenseFeature(int64 num_features) {
   static auto* parse_dense_feature_counter_cell =
       parse_dense_feature_counter->GetCell();
@@ -228,6 +320,22 @@ void RecordParseRaggedFeature(int64 num_features) {
   parse_ragged_feature_counter_cell->IncrementBy(num_features);
 }
 
+monitoring::CounterCell* GetTieredLookupTableCounter(const string& event) {
+  return tiered_lookup_table_counter->GetCell(event);
+}
+
+monitoring::CounterCell* GetLookupTableAdmissionCounter(const string& event) {
+  return lookup_table_admission_counter->GetCell(event);
+}
+
+monitoring::CounterCell* GetGpuHostMemoryCounter(const string& event) {
+  return gpu_host_memory_counter->GetCell(event);
+}
+
+monitoring::CounterCell* GetGpuHostMemoryBytesCounter(const string& event) {
+  return gpu_host_memory_bytes_counter->GetCell(event);
+}
+
 void RecordGraphInputTensors(const size_t size) {
   static auto* graph_run_input_tensor_bytes_cell =
       graph_run_input_tensor_bytes->GetCell();
@@ -252,6 +360,11 @@ void UpdateGraphExecTime(const uint64 running_time_usecs) {
   }
 }
 
+monitoring::SamplerCell* GetDirectSessionPhaseTimeHistogram(
+    const string& phase) {
+  return direct_session_phase_time_nanos_histogram->GetCell(phase);
+}
+
 void UpdateGraphOptimizationPassTime(const string& pass_name,
                                      const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
@@ -288,6 +401,30 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void RecordRunHandlerLatency(int64 priority, uint64 latency_usecs,
+                             bool missed_deadline) {
+  const string priority_str = strings::StrCat(priority);
+  run_handler_latency_usecs_histogram->GetCell(priority_str)
+      ->Add(latency_usecs);
+  if (missed_deadline) {
+    run_handler_missed_deadlines->GetCell(priority_str)->IncrementBy(1);
+  }
+}
+
+void RecordDistributedStepLateness(const string& worker, int64 lateness_usecs,
+                                   bool is_straggler) {
+  distributed_step_lateness_usecs_histogram->GetCell(worker)->Add(
+      std::max<int64>(lateness_usecs, 0));
+  if (is_straggler) {
+    distributed_step_stragglers->GetCell(worker)->IncrementBy(1);
+  }
+}
+
+void RecordDistributedStepSlowLink(const string& src_worker,
+                                   const string& dst_worker) {
+  distributed_step_slow_links->GetCell(src_worker, dst_worker)->IncrementBy(1);
+}
+
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   static auto* bfc_allocator_delay_cell = bfc_allocator_delay->GetCell();
   if (delay_usecs > 0) {
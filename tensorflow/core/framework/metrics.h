@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_FRAMEWORK_METRICS_H_
 
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -81,6 +82,11 @@ void RecordTFDataFingerprint(const string& name);
 // The `name` argument identifies the optimization (e.g. "noop_elimination").
 void RecordTFDataOptimization(const string& name, int64 num_changes);
 
+// Records that the tf.data service dispatcher restored its state in
+// `duration_us` microseconds, by replaying `num_updates` journal updates.
+void RecordTFDataServiceDispatcherRecovery(uint64 duration_us,
+                                           int64 num_updates);
+
 // Records parsing of dense tensor features.
 void RecordParseDenseFeature(int64 num_features);
 
@@ -90,12 +96,42 @@ void RecordParseSparseFeature(int64 num_features);
 // Records parsing of ragged tensor features.
 void RecordParseRaggedFeature(int64 num_features);
 
+// Returns a counter that can be used to record events of the tiers of a
+// tiered lookup table.
+//
+// The `event` argument identifies the kind of event, i.e. "hot_hit",
+// "cold_hit", "miss", "promotion" or "eviction".
+monitoring::CounterCell* GetTieredLookupTableCounter(const string& event);
+
+// Returns a counter that can be used to record admission decisions and
+// evictions of lookup tables with a frequency-based admission policy.
+//
+// The `event` argument identifies the kind of event, i.e. "admitted",
+// "rejected" or "evicted".
+monitoring::CounterCell* GetLookupTableAdmissionCounter(const string& event);
+
+// Returns counters that can be used to record how often, and how many bytes
+// of, pinned host memory GPU staging allocators obtain from and return to
+// the GPU runtime.
+//
+// The `event` argument is either "pinned" or "unpinned".
+monitoring::CounterCell* GetGpuHostMemoryCounter(const string& event);
+monitoring::CounterCell* GetGpuHostMemoryBytesCounter(const string& event);
+
 // Records the size of input/output tensors in bytes.
 void RecordGraphInputTensors(const size_t size);
 void RecordGraphOutputTensors(const size_t size);
 
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 
+// Returns a histogram that can be used to record the time, in nanoseconds,
+// spent in a phase of a DirectSession step outside of the kernels, e.g. in
+// setting up the call frame or the executor arguments.
+//
+// The `phase` argument identifies the phase (e.g. "call_frame").
+monitoring::SamplerCell* GetDirectSessionPhaseTimeHistogram(
+    const string& phase);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
@@ -126,6 +162,23 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs);
 
+// Records the latency of a RunHandler request of the given `priority`, from
+// RunHandlerPool::Get() until the handler is released, and whether the request
+// finished after its deadline.
+void RecordRunHandlerLatency(int64 priority, uint64 latency_usecs,
+                             bool missed_deadline);
+
+// Records how much later than the median worker `worker` finished a traced
+// distributed step, and whether it was a straggler.  Early workers are
+// recorded with a lateness of 0.
+void RecordDistributedStepLateness(const string& worker, int64 lateness_usecs,
+                                   bool is_straggler);
+
+// Records a traced distributed step in which the tensor transfers from
+// `src_worker` to `dst_worker` were slow.
+void RecordDistributedStepSlowLink(const string& src_worker,
+                                   const string& dst_worker);
+
 // Increment the number of jobs that failed during import to mlir.
 void IncrementMLIRImportFailureCount();
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/model.h"
 
+#include <limits>
 #include <memory>
 
 #include "absl/time/clock.h"
@@ -195,12 +196,12 @@ class AsyncInterleaveMany : public Node {
 
   // The output time is the sum of self processing time and expected wait time
   // from the buffer model estimated using
-  // `ComputeWaitTime(producer_time, consumer_time, parallelism, ...)`, where
+  // `ComputeWaitTime(producer_time, consumer_time, buffer_size, ...)`, where
   // `producer_time` is the average output time of inputs comprising the
   // interleave "cycle" divided by `parallelism`, `consumer_time` is the
   // `input_time` specified through `input_times` divided by `num_inputs() - 1`,
-  // and if the node has parallelism parameter, then `buffer_size` is derived
-  // from `parallelism`.
+  // and `buffer_size` is `parallelism` times the number of elements buffered
+  // per input, which is 1 unless the node has a buffer size parameter.
   void OutputTimeLocked(
       const absl::flat_hash_map<string, double>& input_times,
       absl::flat_hash_map<string, double>* gradients,
@@ -226,6 +227,12 @@ class AsyncInterleaveMany : public Node {
     if (parameter) {
       parallelism = std::min(parallelism, (*parameter)->value);
     }
+    double per_input_buffer_size = 1.0L;
+    auto* buffer_size_parameter = gtl::FindOrNull(parameters_, kBufferSize);
+    if (buffer_size_parameter) {
+      per_input_buffer_size = (*buffer_size_parameter)->value;
+    }
+    double buffer_size = parallelism * per_input_buffer_size;
     double output_time_for_inputs =
         OutputTimeForInputs(*output_times) -
         (*output_times)[inputs_.front()->long_name()];
@@ -236,7 +243,7 @@ class AsyncInterleaveMany : public Node {
       double producer_time_der = 0.0L;
       double consumer_time_der = 0.0L;
       double buffer_size_der = 0.0L;
-      wait_time = ComputeWaitTime(producer_time, consumer_time, parallelism,
+      wait_time = ComputeWaitTime(producer_time, consumer_time, buffer_size,
                                   &producer_time_der, &consumer_time_der,
                                   &buffer_size_der);
       double inputs_time_der_sum =
@@ -262,13 +269,15 @@ class AsyncInterleaveMany : public Node {
       for (auto& pair : first_input_parameters) {
         (*gradients)[pair.first] = 0.0L;
       }
-      // Add derivative w.r.t. own parallelism parameter.
+      // Add derivative w.r.t. own parallelism parameter. The buffer size
+      // parameter is only tuned by the hill climbing algorithm.
       if (parameter && (*parameter)->state->tunable) {
         (*gradients)[long_name()] =
-            buffer_size_der - producer_time_der * producer_time / parallelism;
+            buffer_size_der * per_input_buffer_size -
+            producer_time_der * producer_time / parallelism;
       }
     } else {
-      wait_time = ComputeWaitTime(producer_time, consumer_time, parallelism,
+      wait_time = ComputeWaitTime(producer_time, consumer_time, buffer_size,
                                   /*producer_time_derivative=*/nullptr,
                                   /*consumer_time_derivative=*/nullptr,
                                   /*buffer_size_derivative=*/nullptr);
@@ -446,9 +455,15 @@ class AsyncKnownRatio : public Node {
   // inputs, `consumer_time` is the product of `ratio_` and the `input_time`
   // specified through `input_times` (since for each element stored in the
   // buffer, the inputs need to be called `ratio_` times), and if the node has
-  // parallelism parameter, then `buffer_size` is derived from `parallelism`.
+  // parallelism parameter, then `buffer_size` is derived from `parallelism`,
+  // multiplied by the per-call buffer size if the node also has a buffer size
+  // parameter.
   //
-  // Current implementation assumes that there is at most 1 parameter per node.
+  // Nodes that buffer more than one element per parallel call do so to hide
+  // head-of-line stalls of an in-order buffer. Their output time also includes
+  // the recorded stall time per element, which is assumed to shrink in inverse
+  // proportion to the per-call buffer size. The buffer size parameter of such
+  // nodes is only tuned by the hill climbing algorithm.
   void OutputTimeLocked(
       const absl::flat_hash_map<string, double>& input_times,
       absl::flat_hash_map<string, double>* gradients,
@@ -457,11 +472,22 @@ class AsyncKnownRatio : public Node {
       TF_SHARED_LOCKS_REQUIRED(mu_) {
     double parallelism = 1.0;
     double buffer_size = 0.0;
+    double per_call_buffer_size = 1.0;
+    double stall_time = 0.0;
     auto* parallelism_parameter = gtl::FindOrNull(parameters_, kParallelism);
     auto* buffer_size_parameter = gtl::FindOrNull(parameters_, kBufferSize);
     if (parallelism_parameter) {
       parallelism = (*parallelism_parameter)->value;
       buffer_size = parallelism;
+      if (buffer_size_parameter) {
+        per_call_buffer_size = std::max((*buffer_size_parameter)->value, 1.0);
+        buffer_size *= per_call_buffer_size;
+        if (num_elements_ > 0) {
+          stall_time = static_cast<double>(weighted_stall_time_) /
+                       (static_cast<double>(num_elements_) *
+                        per_call_buffer_size);
+        }
+      }
     } else if (buffer_size_parameter) {
       buffer_size = (*buffer_size_parameter)->value;
     }
@@ -488,7 +514,7 @@ class AsyncKnownRatio : public Node {
           (*gradients)[long_name()] = -(1.0L + consumer_time_der) *
                                           self_processing_time /
                                           Square(parallelism) +
-                                      buffer_size_der;
+                                      buffer_size_der * per_call_buffer_size;
         } else if (buffer_size_parameter &&
                    (*buffer_size_parameter)->state->tunable) {
           (*gradients)[long_name()] = buffer_size_der;
@@ -499,7 +525,7 @@ class AsyncKnownRatio : public Node {
                                     /*consumer_time_derivative=*/nullptr,
                                     /*buffer_size_derivative=*/nullptr);
       }
-      output_time = self_processing_time / parallelism + wait_time;
+      output_time = self_processing_time / parallelism + wait_time + stall_time;
       (*output_times)[long_name()] = output_time;
       return;
     }
@@ -528,9 +554,10 @@ class AsyncKnownRatio : public Node {
       // Add derivative w.r.t. own parameter if it's tunable.
       if (parallelism_parameter && (*parallelism_parameter)->state->tunable) {
         (*gradients)[long_name()] =
-            buffer_size_der - (1.0L + consumer_time_der +
-                               producer_time_der * inputs_time_der_sum) *
-                                  self_processing_time / Square(parallelism);
+            buffer_size_der * per_call_buffer_size -
+            (1.0L + consumer_time_der +
+             producer_time_der * inputs_time_der_sum) *
+                self_processing_time / Square(parallelism);
       } else if (buffer_size_parameter &&
                  (*buffer_size_parameter)->state->tunable) {
         (*gradients)[long_name()] = buffer_size_der;
@@ -541,7 +568,7 @@ class AsyncKnownRatio : public Node {
                                   /*consumer_time_derivative=*/nullptr,
                                   /*buffer_size_derivative=*/nullptr);
     }
-    output_time = self_processing_time / parallelism + wait_time;
+    output_time = self_processing_time / parallelism + wait_time + stall_time;
     (*output_times)[long_name()] = output_time;
   }
 
@@ -966,6 +993,25 @@ double Node::OutputTime(absl::flat_hash_map<string, double>* input_times,
   return output_times[long_name()];
 }
 
+absl::flat_hash_map<string, double> Node::parameter_values() const {
+  // The parameters are copied first so that the node isn't locked while
+  // locking their state, which iterators may lock before updating the node.
+  std::vector<std::shared_ptr<Parameter>> parameters;
+  {
+    tf_shared_lock l(mu_);
+    parameters.reserve(parameters_.size());
+    for (const auto& pair : parameters_) {
+      parameters.push_back(pair.second);
+    }
+  }
+  absl::flat_hash_map<string, double> values;
+  for (const auto& parameter : parameters) {
+    mutex_lock l(*parameter->state->mu);
+    values[parameter->name] = parameter->state->value;
+  }
+  return values;
+}
+
 std::shared_ptr<Node> Node::Snapshot() const {
   NodePairList node_pairs;
   auto result = SnapshotHelper(nullptr, &node_pairs);
@@ -1144,9 +1190,16 @@ void Node::CollectTunableParametersHelper(
   if (!autotune_) {
     return;
   }
+  const bool has_parallelism = parameters_.contains(kParallelism);
   for (auto& pair : parameters_) {
     if (pair.second->state->tunable) {
-      parameters->insert(std::make_pair(long_name(), pair.second));
+      // The parallelism, or the only parameter, of a node is keyed by the name
+      // of the node, which is also the key of the gradient w.r.t. it.
+      string key = long_name();
+      if (has_parallelism && pair.first != kParallelism) {
+        key = strings::StrCat(key, ":", pair.first);
+      }
+      parameters->insert(std::make_pair(std::move(key), pair.second));
     }
   }
 }
@@ -1167,6 +1220,7 @@ void Node::DebugStringHelper(absl::flat_hash_map<string, string>* debug_strings)
   strings::StrAppend(&result, "  processing_time=", processing_time_.load(),
                      "\n");
   strings::StrAppend(&result, "  num_elements=", num_elements_.load(), "\n");
+  strings::StrAppend(&result, "  stall_time=", stall_time_.load(), "\n");
   string inputs;
   for (auto& input : inputs_) {
     strings::StrAppend(&inputs, input->long_name(), ",");
@@ -1195,6 +1249,8 @@ std::shared_ptr<Node> Node::SnapshotHelper(
     cloned_current->num_elements_.store(num_elements_);
     cloned_current->record_metrics_.store(false);
     cloned_current->processing_time_.store(processing_time_);
+    cloned_current->stall_time_.store(stall_time_);
+    cloned_current->weighted_stall_time_.store(weighted_stall_time_);
     mutex_lock l2(cloned_current->mu_);
     cloned_current->parameters_ = parameters_;
   }
@@ -1236,11 +1292,15 @@ void Node::TotalMaximumBufferedBytesHelper(
   }
 
   double result = 0;
-  auto* parameter = gtl::FindOrNull(parameters_, kBufferSize);
-  if (!parameter) {
-    parameter = gtl::FindOrNull(parameters_, kParallelism);
-  }
-  if (parameter) {
+  auto* buffer_size_parameter = gtl::FindOrNull(parameters_, kBufferSize);
+  auto* parallelism_parameter = gtl::FindOrNull(parameters_, kParallelism);
+  if (buffer_size_parameter && parallelism_parameter) {
+    // The buffer size is per input of the parallel computations.
+    result = (*parallelism_parameter)->value *
+             (*buffer_size_parameter)->value * AverageBufferedElementSize();
+  } else if (buffer_size_parameter || parallelism_parameter) {
+    auto* parameter =
+        buffer_size_parameter ? buffer_size_parameter : parallelism_parameter;
     result = (*parameter)->value * AverageBufferedElementSize();
   }
   for (auto& input : inputs_) {
@@ -1272,6 +1332,26 @@ void Model::AddNode(Node::Factory factory, const string& name,
   *out_node = std::move(node);
 }
 
+absl::flat_hash_map<string, int64> Model::BufferedBytes() {
+  absl::flat_hash_map<string, int64> buffered_bytes;
+  std::deque<std::shared_ptr<Node>> queue;
+  {
+    tf_shared_lock l(mu_);
+    if (output_) queue.push_back(output_);
+  }
+  while (!queue.empty()) {
+    auto node = queue.front();
+    queue.pop_front();
+    if (node->buffered_elements() > 0 || node->buffered_bytes() > 0) {
+      buffered_bytes[node->long_name()] = node->buffered_bytes();
+    }
+    for (auto input : node->inputs()) {
+      queue.push_back(input);
+    }
+  }
+  return buffered_bytes;
+}
+
 void Model::FlushMetrics() {
   std::deque<std::shared_ptr<Node>> queue;
   {
@@ -1288,16 +1368,85 @@ void Model::FlushMetrics() {
   }
 }
 
+std::vector<NodeStats> Model::CollectNodeStats() {
+  std::vector<NodeStats> node_stats;
+  std::deque<std::shared_ptr<Node>> queue;
+  {
+    tf_shared_lock l(mu_);
+    if (output_) queue.push_back(output_);
+  }
+  while (!queue.empty()) {
+    auto node = queue.front();
+    queue.pop_front();
+    NodeStats stats;
+    stats.name = node->long_name();
+    stats.num_elements = node->num_elements();
+    stats.processing_time = node->processing_time();
+    stats.self_processing_time = node->SelfProcessingTime();
+    stats.buffered_elements = node->buffered_elements();
+    stats.buffered_bytes = node->buffered_bytes();
+    stats.parameters = node->parameter_values();
+    node_stats.push_back(std::move(stats));
+    for (auto input : node->inputs()) {
+      queue.push_back(input);
+    }
+  }
+  return node_stats;
+}
+
 void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
                      int64 ram_budget, double model_input_time) {
+  absl::flat_hash_map<string, std::shared_ptr<Parameter>> parameters;
+  if (!OptimizeSnapshot(algorithm, cpu_budget, ram_budget, model_input_time,
+                        &parameters)) {
+    return;
+  }
+  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+  for (auto& pair : parameters) {
+    auto& parameter = pair.second;
+    VLOG(2) << "Setting tunable parameter " << pair.first << " to "
+            << parameter->value;
+    mutex_lock l(*parameter->state->mu);
+    parameter->state->value = parameter->value;
+    parameter->state->cond_var->notify_all();
+  }
+}
+
+absl::flat_hash_map<string, double> Model::ProposeParameters(
+    AutotuneAlgorithm algorithm, int64 cpu_budget, int64 ram_budget,
+    double model_input_time) {
+  absl::flat_hash_map<string, std::shared_ptr<Parameter>> parameters;
+  absl::flat_hash_map<string, double> values;
+  if (OptimizeSnapshot(algorithm, cpu_budget, ram_budget, model_input_time,
+                       &parameters)) {
+    for (const auto& pair : parameters) {
+      values[pair.first] = pair.second->value;
+    }
+  }
+  return values;
+}
+
+bool Model::OptimizeSnapshot(
+    AutotuneAlgorithm algorithm, int64 cpu_budget, int64 ram_budget,
+    double model_input_time,
+    absl::flat_hash_map<string, std::shared_ptr<Parameter>>* parameters) {
+  std::shared_ptr<Node> snapshot;
+  {
+    tf_shared_lock lock(mu_);
+    if (!output_) return false;
+    snapshot = output_->Snapshot();
+  }
+  *parameters = CollectTunableParameters(snapshot);
   switch (algorithm) {
     case AutotuneAlgorithm::HILL_CLIMB:
-      OptimizeHillClimb(cpu_budget, ram_budget, model_input_time);
-      break;
+      return OptimizeHillClimb(snapshot, cpu_budget, ram_budget,
+                               model_input_time, *parameters);
     case AutotuneAlgorithm::GRADIENT_DESCENT:
-      OptimizeGradientDescent(cpu_budget, ram_budget, model_input_time);
-      break;
+      OptimizeGradientDescent(snapshot, cpu_budget, ram_budget,
+                              model_input_time, *parameters);
+      return true;
   }
+  return false;
 }
 
 void Model::RemoveNode(std::shared_ptr<Node> node) {
@@ -1340,15 +1489,12 @@ Model::CollectEssentialParallelism(
   return essential_parameters;
 }
 
-void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
-                                    double model_input_time) {
-  std::shared_ptr<Node> snapshot;
-  {
-    tf_shared_lock lock(mu_);
-    snapshot = output_->Snapshot();
-  }
+void Model::OptimizeGradientDescent(
+    std::shared_ptr<Node> snapshot, int64 cpu_budget, int64 ram_budget,
+    double model_input_time,
+    const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
+        parameters) {
   VLOG(2) << "Starting optimization of tunable parameters with GradientDescent";
-  auto parameters = CollectTunableParameters(snapshot);
   auto essential_parameters = CollectEssentialParallelism(snapshot, parameters);
   // We add the number of model's buffered bytes because it is excluded from the
   // memory budget, but it is included in the maximum number of buffered bytes.
@@ -1405,28 +1551,19 @@ void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
     }
     output_time = new_output_time;
   }
-  VLOG(2) << "Number of tunable parameters: " << parameters.size();
   for (auto& pair : parameters) {
     pair.second->value = std::round(pair.second->value);
-    auto& parameter = pair.second;
-    VLOG(2) << "Setting tunable parameter " << pair.first << " to "
-            << parameter->value;
-    mutex_lock l(*parameter->state->mu);
-    parameter->state->value = parameter->value;
-    parameter->state->cond_var->notify_all();
   }
+  ShrinkToRamBudget(snapshot, ram_budget, model_input_time, parameters);
 }
 
-void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
-                              double model_input_time) {
-  std::shared_ptr<Node> snapshot;
-  {
-    tf_shared_lock lock(mu_);
-    snapshot = output_->Snapshot();
-  }
+bool Model::OptimizeHillClimb(
+    std::shared_ptr<Node> snapshot, int64 cpu_budget, int64 ram_budget,
+    double model_input_time,
+    const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
+        parameters) {
   VLOG(2) << "Starting optimization of tunable parameters with HillClimb";
   const double processing_time = TotalProcessingTime(snapshot);
-  auto parameters = CollectTunableParameters(snapshot);
   // We add the number of model's buffered bytes because it is excluded from the
   // memory budget, but it is included in the maximum number of buffered bytes.
   ram_budget += TotalBufferedBytes(snapshot);
@@ -1473,18 +1610,51 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
                  "output time. This means that the autotuning optimization got "
                  "stuck in a local maximum. The optimization attempt will be "
                  "aborted.";
-      return;
+      return false;
     }
     best_parameter->value++;
   }
-  VLOG(2) << "Number of tunable parameters: " << parameters.size();
-  for (auto& pair : parameters) {
-    auto& parameter = pair.second;
-    VLOG(2) << "Setting tunable parameter " << pair.first << " to "
-            << parameter->value;
-    mutex_lock l(*parameter->state->mu);
-    parameter->state->value = parameter->value;
-    parameter->state->cond_var->notify_all();
+  ShrinkToRamBudget(snapshot, ram_budget, model_input_time, parameters);
+  return true;
+}
+
+void Model::ShrinkToRamBudget(
+    std::shared_ptr<Node> node, int64 ram_budget, double model_input_time,
+    const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
+        parameters) {
+  double total_bytes = TotalMaximumBufferedBytes(node);
+  while (total_bytes > ram_budget) {
+    const double output_time =
+        OutputTime(node, model_input_time, /*gradients=*/nullptr);
+    double best_cost = std::numeric_limits<double>::infinity();
+    Parameter* best_parameter = nullptr;
+    for (auto& pair : parameters) {
+      if (pair.second->value - 1 < pair.second->min) {
+        continue;
+      }
+      pair.second->value--;
+      const double freed_bytes = total_bytes - TotalMaximumBufferedBytes(node);
+      if (freed_bytes > 0) {
+        const double cost =
+            (OutputTime(node, model_input_time, /*gradients=*/nullptr) -
+             output_time) /
+            freed_bytes;
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_parameter = pair.second.get();
+        }
+      }
+      pair.second->value++;
+    }
+    if (!best_parameter) {
+      VLOG(2) << "Failed to fit the buffers in the RAM budget of "
+              << ram_budget << " bytes.";
+      return;
+    }
+    VLOG(2) << "Decrementing tunable parameter " << best_parameter->name
+            << " to fit the RAM budget.";
+    best_parameter->value--;
+    total_bytes = TotalMaximumBufferedBytes(node);
   }
 }
 
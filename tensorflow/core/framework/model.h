@@ -146,6 +146,8 @@ class Node {
         bytes_produced_(0),
         num_elements_(0),
         processing_time_(0),
+        stall_time_(0),
+        weighted_stall_time_(0),
         record_metrics_(true),
         metrics_(name_),
         output_(args.output.get()) {}
@@ -244,11 +246,18 @@ class Node {
   // Returns the node output.
   Node* output() const { return output_; }
 
+  // Returns the current values of the parameters of the node, by name.
+  absl::flat_hash_map<string, double> parameter_values() const
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the aggregate processing time.
   int64 processing_time() const TF_LOCKS_EXCLUDED(mu_) {
     return processing_time_;
   }
 
+  // Returns the aggregate head-of-line stall time.
+  int64 stall_time() const TF_LOCKS_EXCLUDED(mu_) { return stall_time_; }
+
   // Records that the node consumed the given number of bytes.
   void record_bytes_consumed(int64 num_bytes) { bytes_consumed_ += num_bytes; }
 
@@ -261,6 +270,14 @@ class Node {
     buffered_elements_ += elements_delta;
   }
 
+  // Records that elements at the head of the node's in-order buffer stalled
+  // the node for `time_nanos` while the buffer could hold `buffer_size`
+  // elements per parallel call.
+  void record_stall(int64 time_nanos, int64 buffer_size) {
+    stall_time_ += time_nanos;
+    weighted_stall_time_ += time_nanos * buffer_size;
+  }
+
   // Records that the node produced an element.
   void record_element() TF_LOCKS_EXCLUDED(mu_) {
     num_elements_++;
@@ -531,6 +548,11 @@ class Node {
   std::atomic<int64> bytes_produced_;
   std::atomic<int64> num_elements_;
   std::atomic<int64> processing_time_;
+  // Time spent waiting for the element at the head of an in-order buffer while
+  // later elements were ready, and the same time multiplied by the per-call
+  // buffer size in effect when it was recorded.
+  std::atomic<int64> stall_time_;
+  std::atomic<int64> weighted_stall_time_;
   std::atomic<bool> record_metrics_;
   Metrics metrics_;
   absl::flat_hash_map<string, std::shared_ptr<Parameter>> parameters_
@@ -582,6 +604,22 @@ std::shared_ptr<Node> MakeUnknownRatioNode(Node::Args args);
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+// A snapshot of the metrics recorded by a node of a model.
+struct NodeStats {
+  // The unique name of the node.
+  string name;
+  int64 num_elements = 0;
+  // The aggregate processing time, in nanoseconds.
+  int64 processing_time = 0;
+  // The per-element processing time spent in the node, excluding its inputs,
+  // in nanoseconds.
+  double self_processing_time = 0;
+  int64 buffered_elements = 0;
+  int64 buffered_bytes = 0;
+  // The current values of the parameters of the node, by name.
+  absl::flat_hash_map<string, double> parameters;
+};
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -597,6 +635,12 @@ class Model {
   // Creates a new model.
   Model() : collect_resource_usage_(false) {}
 
+  // Creates a new model that, if `collect_resource_usage` is true, collects
+  // resource usage from the start instead of from its first node with tunable
+  // parameters, e.g. to profile input pipelines that aren't autotuned.
+  explicit Model(bool collect_resource_usage)
+      : collect_resource_usage_(collect_resource_usage) {}
+
   // Indicates whether to collect resource usage.
   bool collect_resource_usage() const { return collect_resource_usage_; }
 
@@ -605,13 +649,28 @@ class Model {
                std::shared_ptr<Node> parent, std::shared_ptr<Node>* out_node)
       TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns a mapping from the (unique) name of each node of the model that
+  // buffers elements to the number of bytes it currently buffers.
+  absl::flat_hash_map<string, int64> BufferedBytes() TF_LOCKS_EXCLUDED(mu_);
+
   // Flushes metrics record by the model.
   void FlushMetrics() TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns a snapshot of the metrics recorded by each node of the model, in
+  // breadth-first order from the output node.
+  std::vector<NodeStats> CollectNodeStats() TF_LOCKS_EXCLUDED(mu_);
+
   // Uses the given algorithm to perform the autotuning optimization.
   void Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget, int64 ram_budget,
                 double model_input_time) TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns the values that `Optimize` would set the tunable parameters to, by
+  // (unique) parameter name, without setting them. Returns an empty map if the
+  // optimization would be aborted.
+  absl::flat_hash_map<string, double> ProposeParameters(
+      AutotuneAlgorithm algorithm, int64 cpu_budget, int64 ram_budget,
+      double model_input_time) TF_LOCKS_EXCLUDED(mu_);
+
   // Removes the given node.
   void RemoveNode(std::shared_ptr<Node> node) TF_LOCKS_EXCLUDED(mu_);
 
@@ -632,14 +691,28 @@ class Model {
       const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
           parameters);
 
+  // Runs the given optimization algorithm over a snapshot of the model and
+  // stores the resulting tunable parameters of the snapshot in `parameters`.
+  // Their `value` is the optimized value, and their `state` is shared with the
+  // input pipeline. Returns false if the optimization was aborted.
+  bool OptimizeSnapshot(
+      AutotuneAlgorithm algorithm, int64 cpu_budget, int64 ram_budget,
+      double model_input_time,
+      absl::flat_hash_map<string, std::shared_ptr<Parameter>>* parameters)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // This optimization algorithm starts by setting all tunable parallelism
   // parameters to the minimum value. It then repeatedly identifies the
   // parameter whose increase in parallelism decreases the output time the most.
   // This process is repeated until all parameters reach their maximum values or
   // the projected output time is less than or equal to the processing time
-  // needed to produce an element divided by CPU budget.
-  void OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
-                         double model_input_time);
+  // needed to produce an element divided by CPU budget. Returns false if no
+  // parameter decreases the output time before that.
+  bool OptimizeHillClimb(
+      std::shared_ptr<Node> snapshot, int64 cpu_budget, int64 ram_budget,
+      double model_input_time,
+      const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
+          parameters);
 
   // This optimization algorithm starts by setting all tunable parallelism
   // parameters to the minimum value. It then improves current parameters by
@@ -648,8 +721,21 @@ class Model {
   // repeated until either the output time improvement is smaller than threshold
   // value or the output time is less than the processing time needed to produce
   // an element divided by CPU budget.
-  void OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
-                               double model_input_time);
+  void OptimizeGradientDescent(
+      std::shared_ptr<Node> snapshot, int64 cpu_budget, int64 ram_budget,
+      double model_input_time,
+      const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
+          parameters);
+
+  // Decrements tunable parameters until the worst-case total buffer size of the
+  // tree rooted in the given node fits in `ram_budget`. Each step decrements
+  // the parameter that increases the output time the least per byte of buffer
+  // it frees, so that the buffers of the transformations that matter the least
+  // for the output time are shrunk first.
+  void ShrinkToRamBudget(
+      std::shared_ptr<Node> node, int64 ram_budget, double model_input_time,
+      const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
+          parameters);
 
   // Collects the output time and if `gradients` is not `nullptr`, the output
   // time gradient w.r.t. tunable parameters of the subtree rooted in the given
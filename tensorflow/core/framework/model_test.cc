@@ -105,6 +105,58 @@ INSTANTIATE_TEST_SUITE_P(Test, AsyncInterleaveManyTest,
                                             ::testing::Values(0, 50, 100,
                                                               200)));
 
+TEST(AsyncInterleaveManyTest, BufferSize) {
+  std::shared_ptr<SharedState> parallelism =
+      std::make_shared<SharedState>(kAutotune, nullptr, nullptr);
+  std::shared_ptr<SharedState> buffer_size =
+      std::make_shared<SharedState>(kAutotune, nullptr, nullptr);
+  std::shared_ptr<Node> async_interleave_many =
+      model::MakeAsyncInterleaveManyNode(
+          {0, "async_interleave_many", nullptr},
+          {model::MakeParameter("parallelism", parallelism, 1, 4),
+           model::MakeParameter(kBufferSize, buffer_size, 1, 8)});
+  std::shared_ptr<Node> meta_source =
+      model::MakeSourceNode({1, "meta_source", async_interleave_many});
+  async_interleave_many->add_input(meta_source);
+  auto cleanup_meta = gtl::MakeCleanup([async_interleave_many, meta_source]() {
+    async_interleave_many->remove_input(meta_source);
+  });
+  std::shared_ptr<Node> source1 =
+      model::MakeSourceNode({2, "source1", async_interleave_many});
+  async_interleave_many->add_input(source1);
+  auto cleanup1 = gtl::MakeCleanup([async_interleave_many, source1]() {
+    async_interleave_many->remove_input(source1);
+  });
+
+  // Both parameters are tunable, under different keys.
+  absl::flat_hash_map<string, std::shared_ptr<Parameter>> parameters;
+  async_interleave_many->CollectTunableParameters(&parameters);
+  EXPECT_EQ(parameters.size(), 2);
+  EXPECT_TRUE(parameters.contains(async_interleave_many->long_name()));
+  parameters[async_interleave_many->long_name()]->value = 2;
+  for (auto& pair : parameters) {
+    if (pair.first != async_interleave_many->long_name()) {
+      pair.second->value = 3;
+    }
+  }
+
+  // Each of the parallel inputs buffers up to `buffer_size` elements.
+  async_interleave_many->record_buffer_event(100, 10);
+  EXPECT_EQ(async_interleave_many->TotalMaximumBufferedBytes(), 2 * 3 * 10);
+
+  // A larger buffer does not increase the output time.
+  absl::flat_hash_map<string, double> input_times;
+  input_times[kModelInputTimeKey] = 50;
+  async_interleave_many->record_element();
+  async_interleave_many->add_processing_time(100);
+  source1->record_element();
+  source1->add_processing_time(200);
+  double output_time = async_interleave_many->OutputTime(&input_times, nullptr);
+  buffer_size->value = 8;
+  EXPECT_LE(async_interleave_many->OutputTime(&input_times, nullptr),
+            output_time);
+}
+
 class AsyncKnownRatioTest
     : public ::testing::TestWithParam<std::tuple<int64, double, int64>> {};
 
@@ -189,6 +241,50 @@ INSTANTIATE_TEST_SUITE_P(Test, AsyncKnownRatioTest,
                                             ::testing::Values(0, 50, 100, 200),
                                             ::testing::Values(0, 1, 2, 4)));
 
+TEST(AsyncKnownRatioTest, StallTime) {
+  std::shared_ptr<SharedState> buffer_size =
+      std::make_shared<SharedState>(kAutotune, nullptr, nullptr);
+  std::shared_ptr<Node> async_known_many = model::MakeAsyncKnownRatioNode(
+      {0, "async_known_many", nullptr}, 1,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(2, nullptr, nullptr),
+                            1, 2),
+       model::MakeParameter(kBufferSize, buffer_size, 1, 8)});
+  std::shared_ptr<Node> source1 =
+      model::MakeSourceNode({1, "source1", async_known_many});
+  async_known_many->add_input(source1);
+  auto cleanup = gtl::MakeCleanup([async_known_many, source1]() {
+    async_known_many->remove_input(source1);
+  });
+
+  // The buffer holds up to `buffer_size` elements per parallel call.
+  buffer_size->value = 4;
+  async_known_many->record_buffer_event(100, 10);
+  EXPECT_EQ(async_known_many->TotalMaximumBufferedBytes(), 2 * 4 * 10);
+
+  absl::flat_hash_map<string, double> input_times;
+  input_times[kModelInputTimeKey] = 50;
+  source1->record_element();
+  source1->add_processing_time(100);
+  async_known_many->record_element();
+  async_known_many->record_element();
+  async_known_many->add_processing_time(200);
+  buffer_size->value = 1;
+  double output_time = async_known_many->OutputTime(&input_times, nullptr);
+
+  // A stall of 1000ns over two elements adds 500ns per element at the buffer
+  // size it was recorded with, and a quarter of that with a buffer four times
+  // as large.
+  async_known_many->record_stall(1000, 1);
+  EXPECT_EQ(async_known_many->stall_time(), 1000);
+  double stalled_output_time =
+      async_known_many->OutputTime(&input_times, nullptr);
+  EXPECT_NEAR(stalled_output_time, output_time + 500, 1e-6);
+  buffer_size->value = 4;
+  EXPECT_LE(async_known_many->OutputTime(&input_times, nullptr),
+            stalled_output_time - 375 + 1e-6);
+}
+
 TEST(InterleaveManyTest, Model) {
   std::shared_ptr<Node> interleave_many =
       model::MakeInterleaveManyNode({0, "interleave_many", nullptr});
@@ -494,6 +590,98 @@ TEST(TestManyElements, Model) {
             0);
 }
 
+TEST(ModelTest, BufferedBytes) {
+  Model model;
+  std::shared_ptr<Node> root;
+  model.AddNode(
+      [](Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(std::move(args), /*ratio=*/1,
+                                              /*parameters=*/{});
+      },
+      "Prefetch", nullptr, &root);
+  std::shared_ptr<Node> source;
+  model.AddNode(
+      [](Node::Args args) { return model::MakeSourceNode(std::move(args)); },
+      "Range", root, &source);
+  EXPECT_TRUE(model.BufferedBytes().empty());
+
+  root->record_buffer_event(100, 2);
+  auto buffered_bytes = model.BufferedBytes();
+  EXPECT_EQ(buffered_bytes.size(), 1);
+  EXPECT_EQ(buffered_bytes[root->long_name()], 100);
+}
+
+TEST(ModelTest, CollectNodeStats) {
+  Model model;
+  auto state = std::make_shared<SharedState>(
+      4, std::make_shared<mutex>(), std::make_shared<condition_variable>());
+  std::shared_ptr<Node> root;
+  model.AddNode(
+      [state](Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {model::MakeParameter(kBufferSize, state, /*min=*/1,
+                                  /*max=*/16)});
+      },
+      "Prefetch", nullptr, &root);
+  std::shared_ptr<Node> source;
+  model.AddNode(
+      [](Node::Args args) { return model::MakeSourceNode(std::move(args)); },
+      "Range", root, &source);
+  root->record_element();
+  root->add_processing_time(100);
+  root->record_buffer_event(50, 2);
+
+  const std::vector<NodeStats> node_stats = model.CollectNodeStats();
+  ASSERT_EQ(node_stats.size(), 2);
+  EXPECT_EQ(node_stats[0].name, root->long_name());
+  EXPECT_EQ(node_stats[0].num_elements, 1);
+  EXPECT_EQ(node_stats[0].processing_time, 100);
+  EXPECT_EQ(node_stats[0].buffered_elements, 2);
+  EXPECT_EQ(node_stats[0].buffered_bytes, 50);
+  EXPECT_EQ(node_stats[0].parameters.at(kBufferSize), 4);
+  EXPECT_EQ(node_stats[1].name, source->long_name());
+  EXPECT_TRUE(node_stats[1].parameters.empty());
+}
+
+TEST(ModelTest, ProposeParametersDoesNotSetThem) {
+  Model model;
+  auto state = std::make_shared<SharedState>(
+      kAutotune, std::make_shared<mutex>(),
+      std::make_shared<condition_variable>());
+  std::shared_ptr<Node> root;
+  model.AddNode(
+      [state](Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {model::MakeParameter(kParallelism, state, /*min=*/1,
+                                  /*max=*/16)});
+      },
+      "ParallelMap", nullptr, &root);
+  std::shared_ptr<Node> source;
+  model.AddNode(
+      [](Node::Args args) { return model::MakeSourceNode(std::move(args)); },
+      "Range", root, &source);
+  for (int i = 0; i < 10; ++i) {
+    root->record_element();
+    root->add_processing_time(1000);
+    source->record_element();
+    source->add_processing_time(10);
+  }
+
+  const auto proposed = model.ProposeParameters(
+      AutotuneAlgorithm::HILL_CLIMB, /*cpu_budget=*/4,
+      /*ram_budget=*/1 << 30, /*model_input_time=*/0);
+  ASSERT_EQ(proposed.size(), 1);
+  const double parallelism = proposed.at(root->long_name());
+  EXPECT_GT(parallelism, 1);
+  EXPECT_EQ(state->value, kAutotune);
+
+  model.Optimize(AutotuneAlgorithm::HILL_CLIMB, /*cpu_budget=*/4,
+                 /*ram_budget=*/1 << 30, /*model_input_time=*/0);
+  EXPECT_EQ(state->value, parallelism);
+}
+
 // Precision for comparison of the gradient and a relative output time change.
 constexpr double kComparisonPrecision = 1e-1;
 
@@ -346,12 +346,25 @@ OpKernelContext::OpKernelContext(Params* params, int num_outputs)
   }
 }
 
+OpKernelContext::OpKernelContext(
+    Params* params, int num_outputs,
+    gtl::InlinedVector<TensorValue, 4>* output_storage)
+    : OpKernelContext(params, 0) {
+  output_storage_ = output_storage;
+  outputs_.swap(*output_storage_);
+  outputs_.assign(num_outputs, TensorValue());
+}
+
 OpKernelContext::~OpKernelContext() {
   for (TensorValue& value : outputs_) {
     if (!value.is_ref()) {
       delete value.tensor;
     }
   }
+  if (output_storage_ != nullptr) {
+    outputs_.resize(0);  // Unlike clear(), keeps the heap storage.
+    output_storage_->swap(outputs_);
+  }
   if (params_->track_allocations &&
       !tracking_state_->wrapped_allocators.empty()) {
     LOG(WARNING) << "OpKernelContext is tracking allocations but they are not "
@@ -707,8 +720,15 @@ Status OpKernelContext::allocate_output(StringPiece name,
 
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
-    AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
+    AllocatorAttributes attr, const AllocationAttributes& allocation_attr,
+    bool step_local) {
+  Allocator* a;
+  if (step_local && params_->step_arena_allocator != nullptr &&
+      attr.value == 0 && attr.scope_id == 0 && !track_allocations()) {
+    a = params_->step_arena_allocator;
+  } else {
+    a = get_allocator(attr);
+  }
   Tensor new_tensor(
       a, type, shape,
       AllocationAttributes(
@@ -766,7 +786,9 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
   ScopedMemoryDebugAnnotation op_annotation(op_kernel().name_view().data(),
                                             step_id(), "output", type, &shape);
   auto output_tensor = MakeUnique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  Status s = allocate_tensor(type, shape, output_tensor.get(), attr,
+                             AllocationAttributes(),
+                             /*step_local=*/!params_->outputs_escape_step);
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
@@ -796,8 +818,8 @@ Status OpKernelContext::allocate_temp(
   }
   ScopedMemoryDebugAnnotation op_annotation(op_kernel().name_view().data(),
                                             step_id(), "temp", type, &shape);
-  Status s =
-      allocate_tensor(type, shape, out_temp, allocator_attr, allocation_attr);
+  Status s = allocate_tensor(type, shape, out_temp, allocator_attr,
+                             allocation_attr, /*step_local=*/true);
   if (track_allocations() && s.ok() && out_temp->TotalBytes() > 0) {
     Allocator* a = get_allocator(allocator_attr);
     if (a->TracksAllocationSizes()) {
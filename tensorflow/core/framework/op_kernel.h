@@ -633,6 +633,13 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If non-null, serves the temporaries and (unless "outputs_escape_step")
+    // the outputs that the kernel allocates with default AllocatorAttributes,
+    // when allocations are not tracked.  Meant for tensors that do not outlive
+    // the step, so stateful kernels should not be given one.
+    Allocator* step_arena_allocator = nullptr;
+    bool outputs_escape_step = false;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
@@ -710,6 +717,11 @@ class OpKernelContext {
   // params must outlive the OpKernelContext.
   explicit OpKernelContext(Params* params);
   OpKernelContext(Params* params, int num_outputs);
+  // Like above, but keeps the outputs in `*output_storage` while the context
+  // lives, and gives the storage back, cleared, when it is destroyed.  Lets
+  // callers reuse the storage of kernels with many outputs.
+  OpKernelContext(Params* params, int num_outputs,
+                  gtl::InlinedVector<TensorValue, 4>* output_storage);
   ~OpKernelContext();
 
   Env* env() const { return params_->device->env(); }
@@ -1241,6 +1253,20 @@ class OpKernelContext {
 
   void set_record_memory_consumption(bool v);
 
+  // Used by devices that time the work an op enqueues on them when step stats
+  // are collected. `read_device_compute_nanos` returns the time the work took
+  // on the device, or a negative value if it is unknown. It may block until
+  // the work is done, so it is only called once the step stats are finalized.
+  void set_device_compute_time(
+      std::function<int64()> read_device_compute_nanos) {
+    read_device_compute_nanos_ = std::move(read_device_compute_nanos);
+  }
+  std::function<int64()> release_device_compute_time() {
+    std::function<int64()> read_device_compute_nanos;
+    read_device_compute_nanos.swap(read_device_compute_nanos_);
+    return read_device_compute_nanos;
+  }
+
   // Used by OpKernel implementations to track actively running deferred ops.
   //
   // A deferred op is one whose Compute method returns (or whose ComputeAsync
@@ -1269,6 +1295,7 @@ class OpKernelContext {
 
  private:
   bool record_memory_consumption_ = false;
+  std::function<int64()> read_device_compute_nanos_;
 
   // Internal common method used when allocating tensor memory
   Status allocate_tensor(DataType type, const TensorShape& shape,
@@ -1278,9 +1305,13 @@ class OpKernelContext {
                            AllocationAttributes());
   }
 
+  //
+  // If "step_local", the tensor is not expected to outlive the step, and may
+  // be allocated by the step arena allocator.
   Status allocate_tensor(DataType type, const TensorShape& shape,
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
-                         const AllocationAttributes& allocation_attr);
+                         const AllocationAttributes& allocation_attr,
+                         bool step_local = false);
 
   // Helpers for `set_output()`.
 
@@ -1300,6 +1331,8 @@ class OpKernelContext {
   friend class CollectiveExecutor;  // for access to params_
   Params* params_;                  // not owned
   gtl::InlinedVector<TensorValue, 4> outputs_;
+  // Gets the storage of `outputs_` back on destruction, if not null.
+  gtl::InlinedVector<TensorValue, 4>* output_storage_ = nullptr;
 
   // Keep track of calls to ScopedAllocator.
   // TODO(ayushd): change to absl::flat_hash_set.
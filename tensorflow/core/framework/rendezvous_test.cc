@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -155,6 +156,33 @@ TEST_F(LocalRendezvousTest, PingPong) {
   EXPECT_EQ("secret msg", V(val));
 }
 
+// Sends and receives many keys at once, which spreads them over the buckets
+// of the rendezvous table.
+TEST_F(LocalRendezvousTest, ManyKeysConcurrently) {
+  const int kNumKeys = 100;
+  BlockingCounter done(2 * kNumKeys);
+  for (int i = 0; i < kNumKeys; ++i) {
+    SchedClosure([this, i, &done]() {
+      rendez_->RecvAsync(
+          MakeKey(strings::StrCat("key", i)), Rendezvous::Args(),
+          [i, &done](const Status& s, const Rendezvous::Args& send_args,
+                     const Rendezvous::Args& recv_args, const Tensor& val,
+                     bool is_dead) {
+            TF_EXPECT_OK(s);
+            EXPECT_EQ(strings::StrCat("value", i), V(val));
+            done.DecrementCount();
+          });
+    });
+    SchedClosure([this, i, &done]() {
+      TF_ASSERT_OK(rendez_->Send(MakeKey(strings::StrCat("key", i)),
+                                 Rendezvous::Args(),
+                                 V(strings::StrCat("value", i)), false));
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+}
+
 TEST_F(LocalRendezvousTest, CancelBeforeRecv) {
   auto* cm = new CancellationManager();
   Tensor val(DT_STRING);
@@ -477,6 +505,39 @@ void BM_RecvSend(int iters) {
 }
 BENCHMARK(BM_RecvSend);
 
+// Sends and receives on `num_threads` threads at once, each with its own
+// key.
+void BM_SendRecvContended(int iters, int num_threads) {
+  testing::StopTiming();
+  Rendezvous* rendez = NewLocalRendezvous();
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < num_threads; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("key", i)));
+  }
+  thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "test", num_threads);
+  BlockingCounter done(num_threads);
+  testing::StartTiming();
+  for (int i = 0; i < num_threads; ++i) {
+    pool->Schedule([rendez, &keys, &done, i, iters, num_threads]() {
+      Tensor orig = V("val");
+      Tensor val(DT_STRING, TensorShape({}));
+      bool is_dead = false;
+      Rendezvous::Args args;
+      for (int j = 0; j < iters / num_threads; ++j) {
+        TF_CHECK_OK(rendez->Send(keys[i], args, orig, is_dead));
+        TF_CHECK_OK(rendez->Recv(keys[i], args, &val, &is_dead));
+      }
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  testing::StopTiming();
+  delete pool;
+  rendez->Unref();
+}
+BENCHMARK(BM_SendRecvContended)->Arg(1)->Arg(8)->Arg(64);
+
 void BM_PingPong(int iters) {
   CHECK_GT(iters, 0);
   auto* cm = new CancellationManager();
@@ -25,7 +25,60 @@ ResourceHandle::ResourceHandle(const ResourceHandleProto& proto) {
   FromProto(proto);
 }
 
-ResourceHandle::~ResourceHandle() {}
+ResourceHandle::~ResourceHandle() { ClearLookupCache(); }
+
+ResourceHandle::ResourceHandle(const ResourceHandle& other)
+    : device_(other.device_),
+      container_(other.container_),
+      name_(other.name_),
+      hash_code_(other.hash_code_),
+      maybe_type_name_(other.maybe_type_name_),
+      dtypes_and_shapes_(other.dtypes_and_shapes_) {}
+
+ResourceHandle::ResourceHandle(ResourceHandle&& other) noexcept
+    : device_(std::move(other.device_)),
+      container_(std::move(other.container_)),
+      name_(std::move(other.name_)),
+      hash_code_(other.hash_code_),
+      maybe_type_name_(std::move(other.maybe_type_name_)),
+      dtypes_and_shapes_(std::move(other.dtypes_and_shapes_)) {}
+
+ResourceHandle& ResourceHandle::operator=(const ResourceHandle& other) {
+  if (this == &other) return *this;
+  device_ = other.device_;
+  container_ = other.container_;
+  name_ = other.name_;
+  hash_code_ = other.hash_code_;
+  maybe_type_name_ = other.maybe_type_name_;
+  dtypes_and_shapes_ = other.dtypes_and_shapes_;
+  ClearLookupCache();
+  return *this;
+}
+
+ResourceHandle& ResourceHandle::operator=(ResourceHandle&& other) noexcept {
+  if (this == &other) return *this;
+  device_ = std::move(other.device_);
+  container_ = std::move(other.container_);
+  name_ = std::move(other.name_);
+  hash_code_ = other.hash_code_;
+  maybe_type_name_ = std::move(other.maybe_type_name_);
+  dtypes_and_shapes_ = std::move(other.dtypes_and_shapes_);
+  ClearLookupCache();
+  return *this;
+}
+
+void ResourceHandle::SetLookupCache(
+    std::unique_ptr<ResourceHandleLookupCache> cache) const {
+  ResourceHandleLookupCache* expected = nullptr;
+  if (lookup_cache_.compare_exchange_strong(expected, cache.get(),
+                                            std::memory_order_acq_rel)) {
+    cache.release();
+  }
+}
+
+void ResourceHandle::ClearLookupCache() {
+  delete lookup_cache_.exchange(nullptr, std::memory_order_relaxed);
+}
 
 void ResourceHandle::AsProto(ResourceHandleProto* proto) const {
   proto->set_device(device());
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_FRAMEWORK_RESOURCE_HANDLE_H_
 #define TENSORFLOW_FRAMEWORK_RESOURCE_HANDLE_H_
 
+#include <atomic>
+#include <memory>
+
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/platform/tensor_coding.h"
@@ -25,6 +28,13 @@ namespace tensorflow {
 
 class ResourceHandleProto;
 
+// A lookup of a resource handle, cached in the handle by the ResourceMgr that
+// resolved it.  See ResourceMgr::Lookup(const ResourceHandle&, T**).
+class ResourceHandleLookupCache {
+ public:
+  virtual ~ResourceHandleLookupCache() {}
+};
+
 // Class representing a handle to a tensorflow resource. Handles are
 // not valid across executions, but can be serialized back and forth from within
 // a single run.
@@ -37,23 +47,51 @@ class ResourceHandle {
   ResourceHandle(const ResourceHandleProto& proto);
   ~ResourceHandle();
 
+  // Copies do not share the cached lookup of `other`.
+  ResourceHandle(const ResourceHandle& other);
+  ResourceHandle(ResourceHandle&& other) noexcept;
+  ResourceHandle& operator=(const ResourceHandle& other);
+  ResourceHandle& operator=(ResourceHandle&& other) noexcept;
+
   // Unique name for the device containing the resource.
   const std::string& device() const { return device_; }
 
-  void set_device(const std::string& device) { device_ = device; }
+  void set_device(const std::string& device) {
+    device_ = device;
+    ClearLookupCache();
+  }
 
   // Container in which this resource is placed.
   const std::string& container() const { return container_; }
-  void set_container(const std::string& container) { container_ = container; }
+  void set_container(const std::string& container) {
+    container_ = container;
+    ClearLookupCache();
+  }
 
   // Unique name of this resource.
   const std::string& name() const { return name_; }
-  void set_name(const std::string& name) { name_ = name; }
+  void set_name(const std::string& name) {
+    name_ = name;
+    ClearLookupCache();
+  }
 
   // Hash code for the type of the resource. Is only valid in the same device
   // and in the same execution.
   uint64 hash_code() const { return hash_code_; }
-  void set_hash_code(uint64 hash_code) { hash_code_ = hash_code; }
+  void set_hash_code(uint64 hash_code) {
+    hash_code_ = hash_code;
+    ClearLookupCache();
+  }
+
+  // Returns the lookup cached in this handle, or nullptr.  Thread-safe.
+  const ResourceHandleLookupCache* lookup_cache() const {
+    return lookup_cache_.load(std::memory_order_acquire);
+  }
+
+  // Caches `cache` in this handle unless a lookup is already cached, in which
+  // case `cache` is destroyed.  A cached lookup lives as long as the handle,
+  // as it may be read concurrently.  Thread-safe.
+  void SetLookupCache(std::unique_ptr<ResourceHandleLookupCache> cache) const;
 
   // For debug-only, the name of the type pointed to by this handle, if
   // available.
@@ -93,6 +131,14 @@ class ResourceHandle {
   uint64 hash_code_ = 0;
   std::string maybe_type_name_;
   std::vector<DtypeAndPartialTensorShape> dtypes_and_shapes_;
+
+ private:
+  // Drops the cached lookup, when the identity of the handle changes.  Not
+  // thread-safe, like the setters.
+  void ClearLookupCache();
+
+  // Owned.
+  mutable std::atomic<ResourceHandleLookupCache*> lookup_cache_{nullptr};
 };
 
 // For backwards compatibility for when this was a proto
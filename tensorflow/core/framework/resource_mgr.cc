@@ -99,20 +99,27 @@ ResourceMgr::ResourceAndName::ResourceAndName()
 
 ResourceMgr::ResourceAndName::ResourceAndName(ResourceBase* resource,
                                               string name)
-    : resource(resource), name(absl::make_unique<string>(std::move(name))) {}
+    : resource(resource),
+      name(absl::make_unique<string>(std::move(name))),
+      removed(std::make_shared<std::atomic<bool>>(false)) {}
 
 ResourceMgr::ResourceAndName::ResourceAndName(
     ResourceAndName&& other) noexcept {
   resource = std::move(other.resource);
   name = std::move(other.name);
+  removed = std::move(other.removed);
 }
 
-ResourceMgr::ResourceAndName::~ResourceAndName() {}
+ResourceMgr::ResourceAndName::~ResourceAndName() {
+  if (removed != nullptr) removed->store(true, std::memory_order_release);
+}
 
 ResourceMgr::ResourceAndName& ResourceMgr::ResourceAndName::operator=(
     ResourceAndName&& other) noexcept {
+  if (removed != nullptr) removed->store(true, std::memory_order_release);
   resource = std::move(other.resource);
   name = std::move(other.name);
+  removed = std::move(other.removed);
   return *this;
 }
 
@@ -208,6 +215,36 @@ Status ResourceMgr::DoLookup(const string& container, TypeIndex type,
   return Status::OK();
 }
 
+Status ResourceMgr::DoLookupAndCache(TypeIndex type,
+                                     const ResourceHandle& handle,
+                                     ResourceBase** resource) const {
+  // A handle caches its first lookup only, see SetLookupCache().
+  if (handle.lookup_cache() != nullptr) {
+    tf_shared_lock l(mu_);
+    return DoLookup(handle.container(), type, handle.name(), resource);
+  }
+  auto cached = absl::make_unique<CachedLookup>();
+  {
+    tf_shared_lock l(mu_);
+    const Container* b = gtl::FindPtrOrNull(containers_, handle.container());
+    auto iter = b == nullptr ? Container::const_iterator()
+                             : b->find({type.hash_code(), handle.name()});
+    if (b == nullptr || iter == b->end()) {
+      return DoLookup(handle.container(), type, handle.name(), resource);
+    }
+    *resource = const_cast<ResourceBase*>(iter->second.resource.get());
+    (*resource)->Ref();
+    cached->removed = iter->second.removed;
+  }
+  // The cache holds its own ref.
+  (*resource)->Ref();
+  cached->resource.reset(*resource);
+  cached->resource_mgr = this;
+  cached->type_hash_code = type.hash_code();
+  handle.SetLookupCache(std::move(cached));
+  return Status::OK();
+}
+
 Status ResourceMgr::DoDelete(const string& container, uint64 type_hash_code,
                              const string& resource_name,
                              const string& type_name) {
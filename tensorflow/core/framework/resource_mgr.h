@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -177,6 +178,19 @@ class ResourceMgr {
   Status Lookup(const std::string& container, const std::string& name,
                 T** resource) const TF_MUST_USE_RESULT;
 
+  // Like Lookup(handle.container(), handle.name(), resource), but caches the
+  // resource in `handle`, so that later lookups of the same handle return it
+  // without locking or hashing until it is deleted from *this.
+  //
+  // The cache holds a ref on the resource, so a deleted resource is only
+  // destroyed once the handles that cached it are.
+  //
+  // REQUIRES: std::is_base_of<ResourceBase, T>
+  // REQUIRES: resource != nullptr
+  template <typename T, bool use_dynamic_cast = false>
+  Status Lookup(const ResourceHandle& handle,
+                T** resource) const TF_MUST_USE_RESULT;
+
   // Similar to Lookup, but looks up multiple resources at once, with only a
   // single lock acquisition.  If containers_and_names[i] is uninitialized
   // then this function does not modify resources[i].
@@ -235,6 +249,9 @@ class ResourceMgr {
   struct ResourceAndName {
     core::RefCountPtr<ResourceBase> resource;
     std::unique_ptr<string> name;
+    // Set when the resource is removed from its container, for the lookups
+    // cached in resource handles.
+    std::shared_ptr<std::atomic<bool>> removed;
 
     ResourceAndName();
     ResourceAndName(ResourceBase* resource, std::string name);
@@ -248,6 +265,21 @@ class ResourceMgr {
   };
   typedef std::unordered_map<Key, ResourceAndName, KeyHash, KeyEqual> Container;
 
+  // A resource found by Lookup(const ResourceHandle&, T**).
+  struct CachedLookup : public ResourceHandleLookupCache {
+    const ResourceMgr* resource_mgr;
+    uint64 type_hash_code;
+    core::RefCountPtr<ResourceBase> resource;
+    std::shared_ptr<const std::atomic<bool>> removed;
+
+    // Returns true if the cached resource is still the one that `mgr` holds
+    // for the handle, with the given type.
+    bool IsValid(const ResourceMgr* mgr, uint64 type) const {
+      return resource_mgr == mgr && type_hash_code == type &&
+             !removed->load(std::memory_order_acquire);
+    }
+  };
+
   const std::string default_container_;
   mutable mutex mu_;
   std::unordered_map<string, Container*> containers_ TF_GUARDED_BY(mu_);
@@ -265,6 +297,10 @@ class ResourceMgr {
                   const std::string& name, ResourceBase** resource) const
       TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
 
+  // Like DoLookup(), but also caches the found resource in `handle`.
+  Status DoLookupAndCache(TypeIndex type, const ResourceHandle& handle,
+                          ResourceBase** resource) const TF_MUST_USE_RESULT;
+
   Status DoDelete(const std::string& container, uint64 type_hash_code,
                   const std::string& resource_name,
                   const std::string& type_name) TF_MUST_USE_RESULT;
@@ -648,6 +684,22 @@ Status ResourceMgr::LookupInternal(const std::string& container,
   return s;
 }
 
+template <typename T, bool use_dynamic_cast>
+Status ResourceMgr::Lookup(const ResourceHandle& handle, T** resource) const {
+  CheckDeriveFromResourceBase<T>();
+  const TypeIndex type = TypeIndex::Make<T>();
+  ResourceBase* found;
+  const auto* cached = static_cast<const CachedLookup*>(handle.lookup_cache());
+  if (cached != nullptr && cached->IsValid(this, type.hash_code())) {
+    found = cached->resource.get();
+    found->Ref();
+  } else {
+    TF_RETURN_IF_ERROR(DoLookupAndCache(type, handle, &found));
+  }
+  *resource = TypeCastFunctor<T, use_dynamic_cast>::Cast(found);
+  return Status::OK();
+}
+
 template <typename T, bool use_dynamic_cast>
 Status ResourceMgr::LookupOrCreate(const std::string& container,
                                    const std::string& name, T** resource,
@@ -736,8 +788,7 @@ template <typename T, bool use_dynamic_cast>
 Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p,
                       T** value) {
   TF_RETURN_IF_ERROR(internal::ValidateDeviceAndType<T>(ctx, p));
-  return ctx->resource_manager()->Lookup<T, use_dynamic_cast>(p.container(),
-                                                              p.name(), value);
+  return ctx->resource_manager()->Lookup<T, use_dynamic_cast>(p, value);
 }
 
 template <typename T>
@@ -352,4 +352,52 @@ TEST(ResourceHandleTest, DeleteUsingResourceHandle) {
   EXPECT_NE(LookupResource<StubResource>(&ctx, p, &lookup_r).ok(), true);
 }
 
+TEST(ResourceHandleTest, CachesLookupUntilDeleted) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  StubResource* r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, p, r));
+  EXPECT_EQ(p.lookup_cache(), nullptr);
+
+  core::RefCountPtr<StubResource> lookup_r;
+  TF_EXPECT_OK(LookupResource(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r);
+  const ResourceHandleLookupCache* cache = p.lookup_cache();
+  EXPECT_NE(cache, nullptr);
+  TF_EXPECT_OK(LookupResource(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r);
+  EXPECT_EQ(p.lookup_cache(), cache);
+
+  // Copies resolve their own lookups.
+  ResourceHandle copy = p;
+  EXPECT_EQ(copy.lookup_cache(), nullptr);
+
+  // The cached lookup doesn't outlive the resource in the manager.
+  TF_EXPECT_OK(DeleteResource(&ctx, p));
+  EXPECT_FALSE(LookupResource(&ctx, p, &lookup_r).ok());
+  StubResource* new_r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, p, new_r));
+  TF_EXPECT_OK(LookupResource(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), new_r);
+
+  // Nor its container.
+  TF_EXPECT_OK(LookupResource(&ctx, copy, &lookup_r));
+  TF_EXPECT_OK(resource_mgr.Cleanup("container"));
+  EXPECT_FALSE(LookupResource(&ctx, copy, &lookup_r).ok());
+
+  // Nor is it used for lookups of another type.
+  TF_EXPECT_OK(CreateResource(&ctx, p, new StubResource));
+  ResourceHandle fresh = p;
+  TF_EXPECT_OK(LookupResource(&ctx, fresh, &lookup_r));
+  OtherStubResource* other_r = nullptr;
+  EXPECT_FALSE(resource_mgr.Lookup(fresh, &other_r).ok());
+}
+
 }  // end namespace tensorflow
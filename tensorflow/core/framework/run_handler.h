@@ -57,6 +57,10 @@ class RunHandlerPool {
 
   // Returns an inactive RunHandler from the pool.
   //
+  // The work of active handlers is scheduled by decreasing
+  // `options.priority()`, then by earliest deadline (`options.deadline_in_ms()`
+  // after the call to Get()), then by the time of the call.
+  //
   // RunHandlers in RunHandlerPool are initially 'inactive'.
   // A RunHandler becomes 'active' when its unique_ptr its returned by Get()
   // and is being used by a client.  It becomes 'inactive' once more when the
@@ -72,6 +76,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids of the active handlers, in the order in which their work
+  // is scheduled.
+  std::vector<int64> GetActiveHandlerStepIdsForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -82,7 +90,7 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (priority and deadline of the request, then time of the Get() call).
 //
 // It can only be created via RunHandlerPool::Get().
 //
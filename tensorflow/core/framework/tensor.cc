@@ -50,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -140,6 +141,55 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// Tensors of at most this many bytes may keep their values in an InlineBuffer.
+constexpr size_t kMaxInlineBufferBytes = 16;
+
+// A buffer of at most kMaxInlineBufferBytes of simple values, stored right
+// before the buffer in the same allocation.  This saves the separate
+// allocation of the values of the many small tensors (shapes, indices, loop
+// counters, ...) that graphs create at every step.
+class InlineBuffer : public TensorBuffer {
+ public:
+  // Returns a new buffer of `size` bytes on behalf of `alloc`, or nullptr if
+  // the allocation failed.
+  static InlineBuffer* New(Allocator* alloc, size_t size) {
+    void* ptr = port::AlignedMalloc(
+        kMaxInlineBufferBytes + sizeof(InlineBuffer), EIGEN_MAX_ALIGN_BYTES);
+    if (ptr == nullptr) return nullptr;
+    return new (static_cast<char*>(ptr) + kMaxInlineBufferBytes)
+        InlineBuffer(alloc, ptr, size);
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name(alloc_->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // Frees the allocation holding both the values and the buffer, when
+  // `core::RefCounted::Unref()` deletes the buffer.
+  static void operator delete(void* ptr) {
+    port::AlignedFree(static_cast<char*>(ptr) - kMaxInlineBufferBytes);
+  }
+  static void operator delete(void*, void*) {}
+
+ private:
+  InlineBuffer(Allocator* alloc, void* data_ptr, size_t size)
+      : TensorBuffer(data_ptr), alloc_(alloc), size_(size) {}
+  ~InlineBuffer() override {}
+
+  Allocator* const alloc_;
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlineBuffer);
+};
+
+static_assert(kMaxInlineBufferBytes % alignof(InlineBuffer) == 0,
+              "InlineBuffer would be misaligned");
+
 void LogUnexpectedSize(int64 actual, int64 expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -769,12 +819,46 @@ bool Tensor::RefCountIsOne() const {
                      LOG(FATAL) << "Unexpected type: " << TYPE_ENUM; \
                      , LOG(FATAL) << "Type not set";)
 
+// NOTE(mrry): The default allocator for a Tensor (when none is specified) is
+// the default CPU allocator for NUMA zone 0. Accessing that currently involves
+// acquiring a lock, which guards initialization of the per-NUMA zone
+// allocators, and becomes highly contended.
+//
+// Note also that it would be better if all Tensor allocations required the user
+// to specify an allocator, for purposes of accounting, etc. However, the
+// default allocator is widely used throughout the codebase and in client code.
+static Allocator* get_default_cpu_allocator() {
+  static Allocator* default_cpu_allocator =
+      cpu_allocator(port::kNUMANoAffinity);
+  return default_cpu_allocator;
+}
+
+// Returns a buffer with inline storage for `n` values of `type` if they fit
+// and the tensor is allocated from the default CPU allocator, and nullptr
+// otherwise.  The inline buffers are not seen by the allocator, so they are not
+// used when its statistics or the memory logs are collected.
+static TensorBuffer* MaybeNewInlineBuffer(Allocator* a, DataType type,
+                                          int64 n) {
+  if (a != get_default_cpu_allocator() || !DataTypeCanUseMemcpy(type)) {
+    return nullptr;
+  }
+  const size_t bytes = n * DataTypeSize(type);
+  if (bytes == 0 || bytes > kMaxInlineBufferBytes || MemoryLoggingEnabled() ||
+      CPUAllocatorStatsEnabled() || CPUAllocatorFullStatsEnabled()) {
+    return nullptr;
+  }
+  return InlineBuffer::New(a, bytes);
+}
+
 Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    buf_ = MaybeNewInlineBuffer(a, type, shape_.num_elements());
+    if (buf_ == nullptr) {
+      CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    }
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
     LogMemory::RecordTensorAllocation("Unknown", LogMemory::UNKNOWN_STEP_ID,
@@ -788,7 +872,11 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    buf_ = MaybeNewInlineBuffer(a, type, shape_.num_elements());
+    if (buf_ == nullptr) {
+      CASES(type,
+            buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    }
   }
   if (MemoryLoggingEnabled() && !allocation_attr.allocation_will_be_logged &&
       buf_ != nullptr && buf_->data() != nullptr) {
@@ -797,20 +885,6 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
   }
 }
 
-// NOTE(mrry): The default allocator for a Tensor (when none is specified) is
-// the default CPU allocator for NUMA zone 0. Accessing that currently involves
-// acquiring a lock, which guards initialization of the per-NUMA zone
-// allocators, and becomes highly contended.
-//
-// Note also that it would be better if all Tensor allocations required the user
-// to specify an allocator, for purposes of accounting, etc. However, the
-// default allocator is widely used throughout the codebase and in client code.
-static Allocator* get_default_cpu_allocator() {
-  static Allocator* default_cpu_allocator =
-      cpu_allocator(port::kNUMANoAffinity);
-  return default_cpu_allocator;
-}
-
 Tensor::Tensor(DataType type, const TensorShape& shape)
     : Tensor(get_default_cpu_allocator(), type, shape) {}
 
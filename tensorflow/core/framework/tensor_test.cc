@@ -1476,6 +1476,14 @@ void BM_CreateAndDestroy(int iters) {
 }
 BENCHMARK(BM_CreateAndDestroy);
 
+void BM_CreateAndDestroySmall(int iters) {
+  TensorShape shape({2});
+  while (--iters) {
+    Tensor t(DT_INT64, shape);
+  }
+}
+BENCHMARK(BM_CreateAndDestroySmall);
+
 void BM_Assign(int iters) {
   Tensor a(DT_FLOAT, TensorShape({10, 20}));
   Tensor b(DT_FLOAT, TensorShape({10, 20}));
@@ -1497,6 +1505,42 @@ TEST(Tensor, EmptyTensorData) {
   EXPECT_EQ(empty.tensor_data().size(), 0);
 }
 
+TEST(Tensor, SmallTensors) {
+  for (int64 n = 1; n <= 5; ++n) {
+    Tensor x(DT_FLOAT, TensorShape({n}));
+    EXPECT_TRUE(x.IsAligned());
+    EXPECT_EQ(x.TotalBytes(), n * sizeof(float));
+    EXPECT_EQ(x.tensor_data().size(), n * sizeof(float));
+    auto flat = x.flat<float>();
+    for (int64 i = 0; i < n; ++i) flat(i) = i * 1.5f;
+    Tensor y(cpu_allocator(), DT_FLOAT, TensorShape({n}),
+             AllocationAttributes());
+    y.flat<float>() = x.flat<float>() * 2.0f;
+    Tensor z = tensor::DeepCopy(y);
+    for (int64 i = 0; i < n; ++i) EXPECT_EQ(z.flat<float>()(i), i * 3.0f);
+    Tensor slice = y.Slice(0, 1);
+    EXPECT_TRUE(slice.SharesBufferWith(y));
+    EXPECT_EQ(slice.flat<float>()(0), 0.0f);
+  }
+  Tensor b(DT_BOOL, TensorShape({16}));
+  b.flat<bool>().setConstant(true);
+  EXPECT_TRUE(b.flat<bool>()(15));
+  Tensor s(DT_STRING, TensorShape({1}));
+  s.flat<tstring>()(0) = "small";
+  EXPECT_EQ(s.flat<tstring>()(0), "small");
+}
+
+TEST(Tensor, SmallTensorsAreCountedByAllocatorStats) {
+  EnableCPUAllocatorStats(true);
+  Allocator* allocator = cpu_allocator();
+  allocator->ClearStats();
+  { Tensor x(DT_INT32, TensorShape({2})); }
+  absl::optional<AllocatorStats> stats = allocator->GetStats();
+  EnableCPUAllocatorStats(false);
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, 1);
+}
+
 // Benchmark create and destroy a tensor, with an allocated buffer.
 void BM_CreateAndDestroyWithBuf(int iters) {
   TensorShape shape({10, 20});
@@ -434,7 +434,8 @@ Node* Graph::AddNode(NodeDef node_def, Status* status) {
 
   Node* node = AllocateNode(
       std::make_shared<NodeProperties>(&op_reg_data->op_def,
-                                       std::move(node_def), inputs, outputs),
+                                       std::move(node_def), std::move(inputs),
+                                       std::move(outputs)),
       nullptr, node_class);
   return node;
 }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph.h"
 
+#include <memory>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
@@ -743,6 +745,39 @@ BENCHMARK(BM_GraphCreation)->ArgPair(1 << 9, 16);
 BENCHMARK(BM_GraphCreation)->ArgPair(1 << 12, 16);
 BENCHMARK(BM_GraphCreation)->ArgPair(1 << 15, 16);
 
+// Converts a validated GraphDef moved into ConvertGraphDefToGraph, with the
+// nodes prepared on `num_threads` threads if positive.
+static void BM_GraphCreationWithValidation(int iters, int num_nodes,
+                                           int num_threads) {
+  testing::StopTiming();
+  const GraphDef graph_def = test::CreateGraphDef(num_nodes, 4);
+  const auto registry = OpRegistry::Global();
+  std::unique_ptr<thread::ThreadPool> thread_pool;
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  if (num_threads > 0) {
+    thread_pool.reset(
+        new thread::ThreadPool(Env::Default(), "test", num_threads));
+    opts.thread_pool = thread_pool.get();
+  }
+  int64 sum = 0;
+  for (int i = 0; i < iters; ++i) {
+    GraphDef copy = graph_def;
+    Graph graph(registry);
+    testing::StartTiming();
+    TF_CHECK_OK(ConvertGraphDefToGraph(opts, std::move(copy), &graph));
+    testing::StopTiming();
+    sum += graph.num_node_ids();
+  }
+  VLOG(1) << sum;
+}
+BENCHMARK(BM_GraphCreationWithValidation)->ArgPair(1 << 12, 0);
+BENCHMARK(BM_GraphCreationWithValidation)->ArgPair(1 << 12, 8);
+BENCHMARK(BM_GraphCreationWithValidation)->ArgPair(1 << 15, 0);
+BENCHMARK(BM_GraphCreationWithValidation)->ArgPair(1 << 15, 8);
+BENCHMARK(BM_GraphCreationWithValidation)->ArgPair(1 << 18, 0);
+BENCHMARK(BM_GraphCreationWithValidation)->ArgPair(1 << 18, 8);
+
 static void BM_ToGraphDef(int iters, int num_nodes, int num_edges_per_node) {
   testing::StopTiming();
   const GraphDef graph_def =
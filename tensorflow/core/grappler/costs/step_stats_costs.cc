@@ -0,0 +1,150 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/step_stats_costs.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Predicts costs for a device that runs one operation and accesses one byte
+// per ns, so that the compute and memory times of the predicted costs are the
+// numbers of operations and bytes accessed.
+class UnitCostEstimator : public OpLevelCostEstimator {
+ public:
+  DeviceInfo GetDeviceInfo(const DeviceProperties& device) const override {
+    DeviceInfo device_info;
+    device_info.gigaops = 1;
+    device_info.gb_per_sec = 1;
+    device_info.intermediate_read_gb_per_sec = 1;
+    device_info.intermediate_write_gb_per_sec = 1;
+    return device_info;
+  }
+};
+
+// Returns the properties of the output `slot` of `stats`, or nullptr if the
+// output wasn't recorded.
+const TensorDescription* FindOutput(const NodeExecStats& stats, int slot) {
+  for (const NodeOutput& output : stats.output()) {
+    if (output.slot() == slot) return &output.tensor_description();
+  }
+  return nullptr;
+}
+
+OpInfo::TensorProperties ToTensorProperties(
+    const TensorDescription& description) {
+  OpInfo::TensorProperties properties;
+  properties.set_dtype(description.dtype());
+  *properties.mutable_shape() = description.shape();
+  return properties;
+}
+
+int64 OpDurationNanos(const NodeExecStats& stats) {
+  if (stats.op_end_rel_nanos() > 0) {
+    return stats.op_end_rel_nanos() - stats.op_start_rel_nanos();
+  }
+  return (stats.op_end_rel_micros() - stats.op_start_rel_micros()) * 1000;
+}
+
+}  // namespace
+
+void AnnotateStepStatsWithEstimatedCosts(
+    const std::unordered_map<string, const Graph*>& device_to_graph,
+    StepStats* step_stats) {
+  // The stats of the ops that ran, by name, to find the shapes of the inputs
+  // of their consumers. Devices may have several DeviceStepStats, e.g. one
+  // per GPU stream, so only the ones named after the devices are used.
+  std::unordered_map<string, const NodeExecStats*> node_stats_by_name;
+  for (const DeviceStepStats& dev_stats : step_stats->dev_stats()) {
+    if (device_to_graph.count(dev_stats.device()) == 0) continue;
+    for (const NodeExecStats& stats : dev_stats.node_stats()) {
+      node_stats_by_name.emplace(stats.node_name(), &stats);
+    }
+  }
+
+  const UnitCostEstimator unit_estimator;
+  const OpLevelCostEstimator estimator;
+  for (DeviceStepStats& dev_stats : *step_stats->mutable_dev_stats()) {
+    auto graph_it = device_to_graph.find(dev_stats.device());
+    if (graph_it == device_to_graph.end()) continue;
+    const Graph* graph = graph_it->second;
+    std::unordered_map<string, const Node*> nodes_by_name;
+    std::unordered_map<string, const NodeDef*> node_defs_by_name;
+    for (const Node* node : graph->op_nodes()) {
+      nodes_by_name.emplace(node->name(), node);
+      node_defs_by_name.emplace(node->name(), &node->def());
+    }
+    const DeviceProperties device = GetDeviceInfo(dev_stats.device());
+    const DeviceInfo peak = estimator.GetDeviceInfo(device);
+
+    for (NodeExecStats& stats : *dev_stats.mutable_node_stats()) {
+      auto node_it = nodes_by_name.find(stats.node_name());
+      if (node_it == nodes_by_name.end()) continue;
+      const Node* node = node_it->second;
+
+      std::vector<OpInfo::TensorProperties> inputs(node->num_inputs());
+      for (int i = 0; i < node->num_inputs(); ++i) {
+        inputs[i].set_dtype(node->input_type(i));
+        inputs[i].mutable_shape()->set_unknown_rank(true);
+      }
+      for (const Edge* edge : node->in_edges()) {
+        if (edge->IsControlEdge()) continue;
+        auto producer_it = node_stats_by_name.find(edge->src()->name());
+        if (producer_it == node_stats_by_name.end()) continue;
+        const TensorDescription* output =
+            FindOutput(*producer_it->second, edge->src_output());
+        if (output != nullptr) {
+          inputs[edge->dst_input()] = ToTensorProperties(*output);
+        }
+      }
+
+      OpContext op_context;
+      op_context.name = node->name();
+      op_context.device_name = dev_stats.device();
+      op_context.op_info =
+          BuildOpInfoWithoutDevice(node->def(), node_defs_by_name, inputs);
+      for (int i = 0; i < node->num_outputs(); ++i) {
+        const TensorDescription* output = FindOutput(stats, i);
+        if (output == nullptr) break;
+        *op_context.op_info.add_outputs() = ToTensorProperties(*output);
+      }
+      *op_context.op_info.mutable_device() = device;
+
+      const Costs costs = unit_estimator.PredictCosts(op_context);
+      if (costs.inaccurate) continue;
+      const int64 flops = costs.compute_time.count();
+      const int64 bytes_accessed = costs.memory_time.count();
+      stats.set_estimated_flops(flops);
+      stats.set_estimated_bytes_accessed(bytes_accessed);
+      const double roofline_nanos = std::max(flops / peak.gigaops,
+                                             bytes_accessed / peak.gb_per_sec);
+      const int64 duration_nanos = OpDurationNanos(stats);
+      if (duration_nanos > 0) {
+        stats.set_roofline_efficiency(roofline_nanos / duration_nanos);
+      }
+    }
+  }
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
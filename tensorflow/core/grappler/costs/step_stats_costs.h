@@ -0,0 +1,43 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_STEP_STATS_COSTS_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_STEP_STATS_COSTS_H_
+
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Sets the estimated_flops, estimated_bytes_accessed and roofline_efficiency
+// of the stats of the ops of `step_stats` that ran on a device of
+// `device_to_graph`, from the estimates of OpLevelCostEstimator. The shapes of
+// the inputs of an op are those of the outputs of the ops that produced them,
+// so `step_stats` must include the outputs of the ops. Ops that
+// OpLevelCostEstimator doesn't know, or whose input shapes are unknown, are
+// left as is.
+void AnnotateStepStatsWithEstimatedCosts(
+    const std::unordered_map<string, const Graph*>& device_to_graph,
+    StepStats* step_stats);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_STEP_STATS_COSTS_H_
@@ -0,0 +1,105 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/step_stats_costs.h"
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+NodeExecStats* AddNodeStats(const string& name, const TensorShape& shape,
+                            DeviceStepStats* dev_stats) {
+  NodeExecStats* stats = dev_stats->add_node_stats();
+  stats->set_node_name(name);
+  NodeOutput* output = stats->add_output();
+  output->set_slot(0);
+  output->mutable_tensor_description()->set_dtype(DT_FLOAT);
+  shape.AsProto(output->mutable_tensor_description()->mutable_shape());
+  return stats;
+}
+
+class StepStatsCostsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Scope s = Scope::NewRootScope();
+    auto a = ops::Placeholder(s.WithOpName("a"), DT_FLOAT);
+    auto b = ops::Placeholder(s.WithOpName("b"), DT_FLOAT);
+    ops::MatMul(s.WithOpName("matmul"), a, b);
+    TF_ASSERT_OK(s.ToGraph(&graph_));
+    device_to_graph_[kDevice] = &graph_;
+  }
+
+  Graph graph_{OpRegistry::Global()};
+  std::unordered_map<string, const Graph*> device_to_graph_;
+};
+
+TEST_F(StepStatsCostsTest, EstimatesMatMulCosts) {
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device(kDevice);
+  AddNodeStats("a", TensorShape({64, 128}), dev_stats);
+  AddNodeStats("b", TensorShape({128, 32}), dev_stats);
+  NodeExecStats* matmul =
+      AddNodeStats("matmul", TensorShape({64, 32}), dev_stats);
+  matmul->set_op_start_rel_nanos(1000);
+  matmul->set_op_end_rel_nanos(11000);
+
+  AnnotateStepStatsWithEstimatedCosts(device_to_graph_, &step_stats);
+
+  const NodeExecStats& stats = step_stats.dev_stats(0).node_stats(2);
+  EXPECT_EQ(2 * 64 * 128 * 32, stats.estimated_flops());
+  EXPECT_EQ((64 * 128 + 128 * 32 + 64 * 32) * sizeof(float),
+            stats.estimated_bytes_accessed());
+  EXPECT_GT(stats.roofline_efficiency(), 0);
+}
+
+TEST_F(StepStatsCostsTest, SkipsOpsWithUnknownInputShapes) {
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device(kDevice);
+  AddNodeStats("a", TensorShape({64, 128}), dev_stats);
+  AddNodeStats("matmul", TensorShape({64, 32}), dev_stats);
+
+  AnnotateStepStatsWithEstimatedCosts(device_to_graph_, &step_stats);
+
+  const NodeExecStats& stats = step_stats.dev_stats(0).node_stats(1);
+  EXPECT_EQ(0, stats.estimated_flops());
+  EXPECT_EQ(0, stats.estimated_bytes_accessed());
+}
+
+TEST_F(StepStatsCostsTest, SkipsOtherDevices) {
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device(string(kDevice) + "/stream:all");
+  AddNodeStats("a", TensorShape({64, 128}), dev_stats);
+  AddNodeStats("b", TensorShape({128, 32}), dev_stats);
+  AddNodeStats("matmul", TensorShape({64, 32}), dev_stats);
+
+  AnnotateStepStatsWithEstimatedCosts(device_to_graph_, &step_stats);
+
+  EXPECT_EQ(0, step_stats.dev_stats(0).node_stats(2).estimated_flops());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -62,6 +62,41 @@ NodeDef* AutoParallel::AddNodeDiv(const string& name, const string& input_a,
   return node;
 }
 
+// Sums `input` over all the replicas.
+NodeDef* AutoParallel::AddNodeAddN(const string& name, const string& input) {
+  NodeDef* node = graph_.add_node();
+  node->set_name(strings::StrCat(kAutoParallelPrefix, "-AddN-", name));
+  node->set_op("AddN");
+  for (int i = 0; i < num_replicas_; i++) {
+    string prefix = strings::StrCat(kAutoParallelPrefix, "-Replica-", i);
+    node->add_input(AddPrefixToNodeName(input, prefix));
+  }
+  AttrValue attr_type;
+  attr_type.set_type(DT_FLOAT);
+  node->mutable_attr()->insert({"T", attr_type});
+  AttrValue attr_n;
+  attr_n.set_i(num_replicas_);
+  node->mutable_attr()->insert({"N", attr_n});
+  return node;
+}
+
+// Splits the batch fed to `name` in one slice per replica.
+NodeDef* AutoParallel::AddNodeSplit(const string& name, const string& axis,
+                                    DataType type) {
+  NodeDef* node = graph_.add_node();
+  node->set_name(strings::StrCat(kAutoParallelPrefix, "-Split-", name));
+  node->set_op("Split");
+  node->add_input(axis);
+  node->add_input(name);
+  AttrValue attr_type;
+  attr_type.set_type(type);
+  node->mutable_attr()->insert({"T", attr_type});
+  AttrValue attr_num_split;
+  attr_num_split.set_i(num_replicas_);
+  node->mutable_attr()->insert({"num_split", attr_num_split});
+  return node;
+}
+
 NodeDef* AutoParallel::AddNodeControl(const string& name,
                                       const std::set<string>& deps,
                                       GraphDef* graph) {
@@ -121,8 +156,6 @@ Status AutoParallel::Initialize(const GrapplerItem& item) {
     }
   }
 
-  auto div_const_node = AddNodeDivConst();
-  all_nodes_.insert(std::make_pair(div_const_node->name(), div_const_node));
   std::map<string, int> gradient_pos = {{"ApplyGradientDescent", 2},
                                         {"ApplyProximalGradientDescent", 4},
                                         {"ApplyAdadelta", 6},
@@ -134,28 +167,33 @@ Status AutoParallel::Initialize(const GrapplerItem& item) {
                                         {"ApplyAdam", 9},
                                         {"ApplyRMSProp", 7},
                                         {"ApplyCenteredRMSProp", 8}};
+  std::vector<string> gradients;
   for (const auto& apply_gradient_node_name : apply_gradients_nodes_) {
-    auto apply_gradients_op = all_nodes_[apply_gradient_node_name]->op();
-    auto apply_gradients_node = all_nodes_[apply_gradient_node_name];
-
-    auto div_node = AddNodeDiv(
-        apply_gradient_node_name,
-        apply_gradients_node->input(gradient_pos[apply_gradients_op]),
-        div_const_node->name());
-    all_nodes_.insert(std::make_pair(div_node->name(), div_node));
-    *apply_gradients_node->mutable_input(gradient_pos[apply_gradients_op]) =
-        div_node->name();
+    const NodeDef* apply_gradients_node = all_nodes_[apply_gradient_node_name];
+    gradients.push_back(
+        apply_gradients_node->input(gradient_pos[apply_gradients_node->op()]));
   }
-  LOG(INFO) << "Graph size after adding div nodes: " << all_nodes_.size();
 
   std::vector<const NodeDef*> train_nodes;
   TF_RETURN_IF_ERROR(ComputeTransitiveFanin(graph_, item.fetch, &train_nodes));
   LOG(INFO) << "Number of training nodes: " << train_nodes.size();
 
-  const NodeDef* dequeue_node;
-  for (const auto& train_node : train_nodes) {
-    if (IsDequeueOp(*train_node)) {
-      dequeue_node = train_node;
+  // Only the computation of the gradients is replicated, the gradients are
+  // then averaged and applied once. Without gradients to apply, the whole
+  // step is replicated.
+  std::vector<const NodeDef*> gradient_nodes;
+  if (!gradients.empty()) {
+    TF_RETURN_IF_ERROR(
+        ComputeTransitiveFanin(graph_, gradients, &gradient_nodes));
+  } else {
+    gradient_nodes = train_nodes;
+  }
+  LOG(INFO) << "Number of gradient nodes: " << gradient_nodes.size();
+
+  const NodeDef* dequeue_node = nullptr;
+  for (const auto& gradient_node : gradient_nodes) {
+    if (IsDequeueOp(*gradient_node)) {
+      dequeue_node = gradient_node;
       break;
     }
   }
@@ -184,13 +222,65 @@ Status AutoParallel::Initialize(const GrapplerItem& item) {
     }
   }
 
-  for (const auto& node : train_nodes) {
+  // Fed batches are split, rather than fed to each replica.
+  std::map<string, DataType> fed_types;
+  for (const auto& feed : item.feed) {
+    fed_types[NodeName(feed.first)] = feed.second.dtype();
+    dont_replicate_nodes.insert(NodeName(feed.first));
+  }
+
+  for (const auto& node : gradient_nodes) {
     if (dont_replicate_nodes.find(node->name()) == dont_replicate_nodes.end()) {
       replica_nodes_.insert(node->name());
     }
   }
   LOG(INFO) << "Number of replica nodes: " << replica_nodes_.size();
 
+  NodeDef* split_axis_node = nullptr;
+  for (const auto& node : gradient_nodes) {
+    auto fed_type = fed_types.find(node->name());
+    if (fed_type == fed_types.end()) continue;
+    if (split_axis_node == nullptr) {
+      split_axis_node = graph_.add_node();
+      split_axis_node->set_name(
+          strings::StrCat(kAutoParallelPrefix, "-Split-Axis"));
+      split_axis_node->set_op("Const");
+      AttrValue attr_data_type;
+      attr_data_type.set_type(DT_INT32);
+      split_axis_node->mutable_attr()->insert({"dtype", attr_data_type});
+      AttrValue attr_tensor;
+      auto tensor = attr_tensor.mutable_tensor();
+      tensor->add_int_val(0);
+      tensor->set_dtype(DT_INT32);
+      split_axis_node->mutable_attr()->insert({"value", attr_tensor});
+      all_nodes_.insert(
+          std::make_pair(split_axis_node->name(), split_axis_node));
+    }
+    auto split_node =
+        AddNodeSplit(node->name(), split_axis_node->name(), fed_type->second);
+    all_nodes_.insert(std::make_pair(split_node->name(), split_node));
+    split_nodes_[node->name()] = split_node->name();
+  }
+
+  // Apply the average of the gradients of the replicas.
+  if (!gradients.empty()) {
+    auto div_const_node = AddNodeDivConst();
+    all_nodes_.insert(std::make_pair(div_const_node->name(), div_const_node));
+    for (const auto& apply_gradient_node_name : apply_gradients_nodes_) {
+      auto apply_gradients_node = all_nodes_[apply_gradient_node_name];
+      const int pos = gradient_pos[apply_gradients_node->op()];
+      auto add_node = AddNodeAddN(apply_gradient_node_name,
+                                  apply_gradients_node->input(pos));
+      all_nodes_.insert(std::make_pair(add_node->name(), add_node));
+      auto div_node = AddNodeDiv(apply_gradient_node_name, add_node->name(),
+                                 div_const_node->name());
+      all_nodes_.insert(std::make_pair(div_node->name(), div_node));
+      *apply_gradients_node->mutable_input(pos) = div_node->name();
+    }
+    LOG(INFO) << "Graph size after adding aggregation nodes: "
+              << all_nodes_.size();
+  }
+
   for (const auto& node : all_nodes_) {
     if (replica_nodes_.find(node.first) == replica_nodes_.end()) {
       shared_nodes_.insert(node.first);
@@ -200,8 +290,8 @@ Status AutoParallel::Initialize(const GrapplerItem& item) {
   return Status::OK();
 }
 
-bool AutoParallel::NotSharedNode(const string& name) {
-  return shared_nodes_.find(name) == shared_nodes_.end();
+bool AutoParallel::IsReplicaNode(const string& name) {
+  return replica_nodes_.find(name) != replica_nodes_.end();
 }
 
 void AutoParallel::AddSharedNodes(GraphDef* graph) {
@@ -210,7 +300,7 @@ void AutoParallel::AddSharedNodes(GraphDef* graph) {
     auto new_node = graph->add_node();
     *new_node = *all_nodes_[node];
     for (int i = 0; i < new_node->input_size(); i++) {
-      if (NotSharedNode(NodeName(new_node->input(i)))) {
+      if (IsReplicaNode(NodeName(new_node->input(i)))) {
         string new_name = AddPrefixToNodeName(new_node->input(i), prefix);
         *new_node->mutable_input(i) = new_name;
       }
@@ -223,16 +313,21 @@ void AutoParallel::AddOneReplica(GraphDef* graph, int number) {
   for (const auto& node : replica_nodes_) {
     auto new_node = graph->add_node();
     *new_node = *all_nodes_[node];
-    if (NotSharedNode(new_node->name())) {
-      new_node->set_name(AddPrefixToNodeName(new_node->name(), prefix));
-      if (num_gpus_ > 0) {
-        new_node->set_device(strings::StrCat("/gpu:", number % num_gpus_));
-      }
-      for (int i = 0; i < new_node->input_size(); i++) {
-        if (NotSharedNode(NodeName(new_node->input(i)))) {
-          string new_name = AddPrefixToNodeName(new_node->input(i), prefix);
-          *new_node->mutable_input(i) = new_name;
-        }
+    new_node->set_name(AddPrefixToNodeName(new_node->name(), prefix));
+    if (num_gpus_ > 0) {
+      new_node->set_device(strings::StrCat("/gpu:", number % num_gpus_));
+    }
+    for (int i = 0; i < new_node->input_size(); i++) {
+      const string& input = new_node->input(i);
+      auto split_node = split_nodes_.find(NodeName(input));
+      if (split_node != split_nodes_.end()) {
+        // Read the replica's slice of the fed batch.
+        *new_node->mutable_input(i) =
+            IsControlInput(input)
+                ? AsControlDependency(split_node->second)
+                : strings::StrCat(split_node->second, ":", number);
+      } else if (IsReplicaNode(NodeName(input))) {
+        *new_node->mutable_input(i) = AddPrefixToNodeName(input, prefix);
       }
     }
   }
@@ -243,20 +338,27 @@ void AutoParallel::BuildGraph(GraphDef* graph) {
   for (int i = 0; i < num_replicas_; i++) {
     AddOneReplica(graph, i);
   }
+  // Shared fetches, such as the training op, are kept as is. Replicated
+  // fetches are replaced by a control dependency on all their replicas.
   std::set<string> fetches;
+  std::vector<string> replica_fetches;
   for (size_t i = 0; i < item_->fetch.size(); i++) {
+    if (!IsReplicaNode(NodeName(item_->fetch[i]))) continue;
+    replica_fetches.push_back(item_->fetch[i]);
     for (int j = 0; j < num_replicas_; j++) {
       string prefix = strings::StrCat(kAutoParallelPrefix, "-Replica-", j);
       string fetch = AddPrefixToNodeName(item_->fetch[i], prefix);
       fetches.insert(fetch);
     }
   }
-  string name_control =
-      strings::StrCat(kAutoParallelPrefix, "-Control-", "Fetch");
-  auto control = AddNodeControl(name_control, fetches, graph);
+  if (!replica_fetches.empty()) {
+    string name_control =
+        strings::StrCat(kAutoParallelPrefix, "-Control-", "Fetch");
+    auto control = AddNodeControl(name_control, fetches, graph);
 
-  for (const auto& fetch : item_->fetch) {
-    AddNodeControl(fetch, {control->name()}, graph);
+    for (const auto& fetch : replica_fetches) {
+      AddNodeControl(fetch, {control->name()}, graph);
+    }
   }
   *graph->mutable_library() = item_->graph.library();
   *graph->mutable_versions() = item_->graph.versions();
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_PARALLEL_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_PARALLEL_H_
 
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variable.pb.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -24,6 +25,11 @@ namespace tensorflow {
 namespace grappler {
 
 // Automatically parallelize a graph by splitting in the batch dimension.
+//
+// The subgraph computing the gradients of a training step is replicated
+// num_replicas times, one replica per GPU. Each replica dequeues its own
+// batch, or gets a slice of the batch fed to the graph. The gradients of the
+// replicas are averaged, and applied once to the shared variables.
 class AutoParallel : public GraphOptimizer {
  public:
   AutoParallel(int num_replicas) : num_replicas_(num_replicas) {
@@ -47,6 +53,8 @@ class AutoParallel : public GraphOptimizer {
   std::set<string> apply_gradients_nodes_;
   std::set<string> replica_nodes_;
   std::set<string> shared_nodes_;
+  // The nodes splitting each fed batch among the replicas, by fed node.
+  std::map<string, string> split_nodes_;
   const GrapplerItem* item_;
   int num_replicas_;
   int num_gpus_;
@@ -54,9 +62,11 @@ class AutoParallel : public GraphOptimizer {
   NodeDef* AddNodeDivConst();
   NodeDef* AddNodeDiv(const string& name, const string& input_a,
                       const string& input_b);
+  NodeDef* AddNodeAddN(const string& name, const string& input);
+  NodeDef* AddNodeSplit(const string& name, const string& axis, DataType type);
   NodeDef* AddNodeControl(const string& name, const std::set<string>& deps,
                           GraphDef* graph);
-  bool NotSharedNode(const string& name);
+  bool IsReplicaNode(const string& name);
   void AddSharedNodes(GraphDef* graph);
   void AddOneReplica(GraphDef* graph, int number);
   void BuildGraph(GraphDef* graph);
@@ -52,78 +52,112 @@ TEST_F(AutoParallelTest, SimpleParallel) {
   GraphDef output;
   Status status = parallel.Optimize(nullptr, item, &output);
   TF_EXPECT_OK(status);
-  EXPECT_EQ(21, output.node_size());
+  EXPECT_EQ(16, output.node_size());
 
-  const NodeDef& node_assign = output.node(0);
+  // The gradients of the replicas are averaged and applied once.
+  const NodeDef& node_addn = output.node(0);
+  EXPECT_EQ("AutoParallel-AddN-apply_gradient", node_addn.name());
+  EXPECT_EQ("AddN", node_addn.op());
+  ASSERT_EQ(2, node_addn.input_size());
+  EXPECT_EQ("AutoParallel-Replica-0/add", node_addn.input(0));
+  EXPECT_EQ("AutoParallel-Replica-1/add", node_addn.input(1));
+
+  const NodeDef& node_div_const = output.node(1);
+  EXPECT_EQ("AutoParallel-Div-Const", node_div_const.name());
+
+  const NodeDef& node_div = output.node(2);
+  EXPECT_EQ("AutoParallel-Div-apply_gradient", node_div.name());
+  EXPECT_EQ("AutoParallel-AddN-apply_gradient", node_div.input(0));
+  EXPECT_EQ("AutoParallel-Div-Const", node_div.input(1));
+
+  const NodeDef& node_gradient = output.node(3);
+  EXPECT_EQ("apply_gradient", node_gradient.name());
+  EXPECT_EQ("var", node_gradient.input(0));
+  EXPECT_EQ("learning_rate", node_gradient.input(1));
+  EXPECT_EQ("AutoParallel-Div-apply_gradient", node_gradient.input(2));
+
+  const NodeDef& node_assign = output.node(4);
   EXPECT_EQ("assign", node_assign.name());
   EXPECT_EQ("AutoParallel-Replica-0/constant_a", node_assign.input(1));
 
-  const NodeDef& node_constant_b = output.node(1);
+  const NodeDef& node_constant_b = output.node(5);
   EXPECT_EQ("constant_b", node_constant_b.name());
 
-  const NodeDef& node_fifo_queue = output.node(2);
+  const NodeDef& node_fifo_queue = output.node(6);
   EXPECT_EQ("fifo_queue", node_fifo_queue.name());
 
-  const NodeDef& node_identity = output.node(3);
+  const NodeDef& node_identity = output.node(7);
   EXPECT_EQ("identity", node_identity.name());
   EXPECT_EQ("var", node_identity.input(0));
 
-  const NodeDef& node_var = output.node(4);
-  EXPECT_EQ("var", node_var.name());
+  const NodeDef& node_learning_rate = output.node(8);
+  EXPECT_EQ("learning_rate", node_learning_rate.name());
 
-  const NodeDef& node_div_const0 = output.node(5);
-  EXPECT_EQ("AutoParallel-Replica-0/AutoParallel-Div-Const",
-            node_div_const0.name());
+  const NodeDef& node_var = output.node(9);
+  EXPECT_EQ("var", node_var.name());
 
-  const NodeDef& node_div0 = output.node(6);
-  EXPECT_EQ("AutoParallel-Replica-0/AutoParallel-Div-apply_gradient",
-            node_div0.name());
-  const NodeDef& node_add0 = output.node(7);
+  const NodeDef& node_add0 = output.node(10);
   EXPECT_EQ("AutoParallel-Replica-0/add", node_add0.name());
 
-  const NodeDef& node_gradient0 = output.node(8);
-  EXPECT_EQ("AutoParallel-Replica-0/apply_gradient", node_gradient0.name());
-
-  const NodeDef& node_constant_a0 = output.node(9);
+  const NodeDef& node_constant_a0 = output.node(11);
   EXPECT_EQ("AutoParallel-Replica-0/constant_a", node_constant_a0.name());
 
-  const NodeDef& node_dequeue0 = output.node(10);
+  const NodeDef& node_dequeue0 = output.node(12);
   EXPECT_EQ("AutoParallel-Replica-0/dequeue", node_dequeue0.name());
+  EXPECT_EQ("fifo_queue", node_dequeue0.input(0));
 
-  const NodeDef& node_learning_rate0 = output.node(11);
-  EXPECT_EQ("AutoParallel-Replica-0/learning_rate", node_learning_rate0.name());
-
-  const NodeDef& node_div_const1 = output.node(12);
-  EXPECT_EQ("AutoParallel-Replica-1/AutoParallel-Div-Const",
-            node_div_const1.name());
-
-  const NodeDef& node_div1 = output.node(13);
-  EXPECT_EQ("AutoParallel-Replica-1/AutoParallel-Div-apply_gradient",
-            node_div1.name());
-
-  const NodeDef& node_add1 = output.node(14);
+  const NodeDef& node_add1 = output.node(13);
   EXPECT_EQ("AutoParallel-Replica-1/add", node_add1.name());
 
-  const NodeDef& node_gradient1 = output.node(15);
-  EXPECT_EQ("AutoParallel-Replica-1/apply_gradient", node_gradient1.name());
-
-  const NodeDef& node_constant_a1 = output.node(16);
+  const NodeDef& node_constant_a1 = output.node(14);
   EXPECT_EQ("AutoParallel-Replica-1/constant_a", node_constant_a1.name());
 
-  const NodeDef& node_dequeue1 = output.node(17);
+  const NodeDef& node_dequeue1 = output.node(15);
   EXPECT_EQ("AutoParallel-Replica-1/dequeue", node_dequeue1.name());
+}
 
-  const NodeDef& node_learning_rate1 = output.node(18);
-  EXPECT_EQ("AutoParallel-Replica-1/learning_rate", node_learning_rate1.name());
+TEST_F(AutoParallelTest, SplitFedBatch) {
+  tensorflow::Scope s = tensorflow::Scope::DisabledShapeInferenceScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output var = ops::Variable(s.WithOpName("var"), {1}, DT_FLOAT);
+  Output identity = ops::Identity(s.WithOpName("identity"), {var});
+  Output grad = ops::Mul(s.WithOpName("grad"), x, identity);
+  Output learning_rate = ops::Const(s.WithOpName("learning_rate"), 0.01f, {1});
+  Output apply_gradient = ops::ApplyGradientDescent(
+      s.WithOpName("apply_gradient"), {var}, {learning_rate}, {grad});
 
-  const NodeDef& node_fetch = output.node(19);
-  EXPECT_EQ("AutoParallel-Control-Fetch", node_fetch.name());
-  EXPECT_EQ("^AutoParallel-Replica-0/apply_gradient", node_fetch.input(0));
-  EXPECT_EQ("^AutoParallel-Replica-1/apply_gradient", node_fetch.input(1));
+  GrapplerItem item;
+  item.fetch.push_back("apply_gradient");
+  item.feed.emplace_back("x", Tensor(DT_FLOAT, TensorShape({4})));
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
 
-  const NodeDef& node_gradient = output.node(20);
-  EXPECT_EQ("apply_gradient", node_gradient.name());
-  EXPECT_EQ("^AutoParallel-Control-Fetch", node_gradient.input(0));
+  AutoParallel parallel(2);
+  GraphDef output;
+  TF_EXPECT_OK(parallel.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "x") {
+      EXPECT_EQ("Placeholder", node.op());
+      ++found;
+    } else if (node.name() == "AutoParallel-Split-x") {
+      EXPECT_EQ("Split", node.op());
+      ASSERT_EQ(2, node.input_size());
+      EXPECT_EQ("AutoParallel-Split-Axis", node.input(0));
+      EXPECT_EQ("x", node.input(1));
+      EXPECT_EQ(2, node.attr().at("num_split").i());
+      ++found;
+    } else if (node.name() == "AutoParallel-Replica-0/grad") {
+      EXPECT_EQ("AutoParallel-Split-x:0", node.input(0));
+      EXPECT_EQ("AutoParallel-Replica-0/identity", node.input(1));
+      ++found;
+    } else if (node.name() == "AutoParallel-Replica-1/grad") {
+      EXPECT_EQ("AutoParallel-Split-x:1", node.input(0));
+      EXPECT_EQ("AutoParallel-Replica-1/identity", node.input(1));
+      ++found;
+    }
+  }
+  EXPECT_EQ(4, found);
 }
 
 }  // namespace
@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
@@ -62,7 +63,49 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 // We only fold/materialize constants smaller than 10 MiB.
 const int64 kMaxConstantSize = 10 * 1024 * 1024;
 
+// Constants encoded in at least 64 KiB are pooled, and folding doesn't
+// duplicate them. Smaller ones are cheap to copy, or left to deduplication.
+const int64 kMinPooledConstantSize = 64 * 1024;
+
 namespace {
+uint64 ShapeFingerprint(DataType dtype, absl::Span<const int64> dims) {
+  uint64 fingerprint = dtype;
+  for (const int64 dim : dims) {
+    fingerprint = Hash64Combine(fingerprint, dim);
+  }
+  return fingerprint;
+}
+
+uint64 ValueFingerprint(const Tensor& value) {
+  const StringPiece data = value.tensor_data();
+  return Hash64Combine(
+      ShapeFingerprint(value.dtype(), value.shape().dim_sizes()),
+      Hash64(data.data(), data.size()));
+}
+
+bool IsPoolable(const Tensor& value) {
+  return DataTypeCanUseMemcpy(value.dtype()) &&
+         value.TotalBytes() >= kMinPooledConstantSize;
+}
+
+bool SameValue(const Tensor& a, const Tensor& b) {
+  return a.dtype() == b.dtype() && a.shape() == b.shape() &&
+         a.tensor_data() == b.tensor_data();
+}
+
+// Decodes the value of a large Const node without inputs.
+bool GetPoolableValue(const NodeDef& node, Tensor* value) {
+  if (!IsConstant(node) || node.input_size() > 0) return false;
+  const auto it = node.attr().find("value");
+  if (it == node.attr().end()) return false;
+  const TensorProto& proto = it->second.tensor();
+  if (!DataTypeCanUseMemcpy(proto.dtype()) ||
+      proto.ByteSizeLong() < kMinPooledConstantSize) {
+    return false;
+  }
+  return value->FromProto(proto);
+}
+
 template <typename T>
 bool AllValuesAre(const TensorProto& proto, const T& value) {
   Tensor tensor;
@@ -1008,10 +1051,13 @@ bool ConstantFolding::IsFoldableUncached(
       if (output_shape.IsFullyDefined()) {
         const int64 num_bytes =
             output_shape.num_elements() * DataTypeSize(output_prop.dtype());
-        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize) {
-          // Do not fold nodes if the in-memory size of output is too large.
-          // Notice that this is not exactly the same check used in
-          // CreateNodeDef() where the actual encoded size is checked.
+        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize &&
+            !pooled_shapes_.contains(ShapeFingerprint(
+                output_prop.dtype(), output_shape.dim_sizes()))) {
+          // Do not fold nodes if the in-memory size of output is too large,
+          // unless it may be a pooled constant. Notice that this is not
+          // exactly the same check used in CreateNodeDef() where the actual
+          // encoded size is checked.
           return false;
         }
       }
@@ -1323,6 +1369,9 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
   });
 
   size_t total_inputs_size = 0;
+  // Whether the folded constants will have control inputs, in which case they
+  // can't forward a pooled constant.
+  bool has_control_inputs = HasControlInputs(node);
   for (const auto& input : node.input()) {
     const TensorId input_tensor = ParseTensorName(input);
     if (input_tensor.index() < 0) {
@@ -1335,6 +1384,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
                     strings::StrCat("Can't fold ", node.name(), ", its ", input,
                                     " isn't constant"));
     }
+    has_control_inputs |= input_node->input_size() > 0;
     TF_RETURN_IF_ERROR(CheckAttrExists(*input_node, "value"));
     const TensorProto& raw_val = input_node->attr().at("value").tensor();
     Tensor* value = new Tensor(raw_val.dtype(), raw_val.tensor_shape());
@@ -1357,7 +1407,11 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     if (output_tensors[i].tensor) {
       Status s = CreateNodeDef(node_name, output_tensors[i], &outputs->at(i),
                                total_inputs_size);
-      if (!s.ok()) {
+      // A large result is fine if it's a copy of a pooled constant, since
+      // ShareLargeConstants() will turn it into an Identity of that constant.
+      if (!s.ok() &&
+          (has_control_inputs ||
+           !HasPooledConstant(*output_tensors[i].tensor, node.device()))) {
         *result_too_large = true;
         return s;
       }
@@ -1526,6 +1580,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
         node_map_->AddOutput(NodeName(input), node->name());
       }
       *node->mutable_attr() = const_node->attr();
+      AddToConstantPool(*node);
       break;
     } else {
       if (node_map_->GetNode(const_node->name())) {
@@ -1540,6 +1595,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
       for (const auto& input : added_node->input()) {
         node_map_->AddOutput(NodeName(input), added_node->name());
       }
+      AddToConstantPool(*added_node);
       // All the constant nodes encoding output values have the same control
       // dependencies (since these are the control dependencies of the node
       // we're trying to fold). Record one such constant node.
@@ -1588,9 +1644,90 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
   return Status::OK();
 }
 
+void ConstantFolding::AddToConstantPool(const NodeDef& node) {
+  Tensor value;
+  if (!IsReallyConstant(node) || !GetPoolableValue(node, &value)) return;
+  constant_pool_[ValueFingerprint(value)].push_back(node.name());
+  pooled_constants_.insert(node.name());
+  pooled_shapes_.insert(
+      ShapeFingerprint(value.dtype(), value.shape().dim_sizes()));
+}
+
+bool ConstantFolding::HasPooledConstant(const Tensor& value,
+                                        const string& device) const {
+  if (!IsPoolable(value)) return false;
+  const auto it = constant_pool_.find(ValueFingerprint(value));
+  if (it == constant_pool_.end()) return false;
+  for (const string& name : it->second) {
+    const NodeDef* node = node_map_->GetNode(name);
+    Tensor pooled_value;
+    if (node != nullptr && node->device() == device &&
+        GetPoolableValue(*node, &pooled_value) &&
+        SameValue(pooled_value, value)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ConstantFolding::ShareLargeConstants(
+    const absl::flat_hash_map<string, string>& forwarding_nodes) {
+  for (const auto& bucket : constant_pool_) {
+    // The constants of the bucket that are kept, with their values.
+    std::vector<std::pair<const NodeDef*, Tensor>> shared;
+    for (const string& name : bucket.second) {
+      NodeDef* node = node_map_->GetNode(name);
+      Tensor value;
+      if (node == nullptr || !GetPoolableValue(*node, &value)) continue;
+      const bool preserved = nodes_to_preserve_.count(name) > 0;
+      if (has_fetch_ && !preserved && node_map_->GetOutputs(name).empty()) {
+        // The constant is about to be dropped from the graph.
+        continue;
+      }
+      auto it = absl::c_find_if(
+          shared, [&](const std::pair<const NodeDef*, Tensor>& constant) {
+            return constant.first->device() == node->device() &&
+                   SameValue(constant.second, value);
+          });
+      if (it == shared.end()) {
+        shared.emplace_back(node, std::move(value));
+        continue;
+      }
+      if (preserved) continue;
+      const string& shared_name = it->first->name();
+      VLOG(2) << "Forwarding " << shared_name << " to " << name;
+      node->set_op("Identity");
+      node->clear_attr();
+      (*node->mutable_attr())["T"].set_type(value.dtype());
+      node->add_input(shared_name);
+      node_map_->AddOutput(shared_name, name);
+      auto forwarding = forwarding_nodes.find(name);
+      if (forwarding == forwarding_nodes.end() ||
+          forwarding->second != shared_name) {
+        graph_modified_ = true;
+      }
+    }
+  }
+}
+
 Status ConstantFolding::FoldGraph(
     const GraphProperties& properties, GraphDef* output,
     absl::flat_hash_set<string>* nodes_to_not_simplify) {
+  constant_pool_.clear();
+  pooled_constants_.clear();
+  pooled_shapes_.clear();
+  for (const NodeDef& node : graph_->node()) {
+    AddToConstantPool(node);
+  }
+  // Folding these Identities copies a pooled constant, which is undone below.
+  absl::flat_hash_map<string, string> forwarding_nodes;
+  for (const NodeDef& node : graph_->node()) {
+    if (IsIdentity(node) && node.input_size() == 1 &&
+        pooled_constants_.contains(node.input(0))) {
+      forwarding_nodes.emplace(node.name(), node.input(0));
+    }
+  }
+
   std::unordered_set<string> processed_nodes;
   std::deque<NodeDef*> queue;
   for (int i = 0; i < graph_->node_size(); i++) {
@@ -1628,6 +1765,8 @@ Status ConstantFolding::FoldGraph(
     }
   }
 
+  ShareLargeConstants(forwarding_nodes);
+
   // Delete the newly created nodes that don't feed anything.
   std::vector<int> nodes_to_delete;
   for (int i = 0; i < output->node_size(); i++) {
@@ -2073,6 +2212,7 @@ Status ConstantFolding::SimplifyNode(bool use_shape_info, NodeDef* node,
   SET_AND_RETURN_IF_MODIFIED(
       ConstantPushDownBiasAdd(properties, optimized_graph, node));
   SET_AND_RETURN_IF_MODIFIED(SimplifyCase(optimized_graph, node));
+  SET_AND_RETURN_IF_MODIFIED(SimplifyIf(optimized_graph, node));
   SET_AND_RETURN_IF_MODIFIED(
       SimplifySelect(*properties, optimized_graph, node));
   RETURN_IF_MODIFIED(
@@ -2472,6 +2612,64 @@ bool ConstantFolding::SimplifyCase(GraphDef* optimized_graph, NodeDef* node) {
   return true;
 }
 
+bool ConstantFolding::SimplifyIf(GraphDef* optimized_graph, NodeDef* node) {
+  if (node->op() != "If" && node->op() != "StatelessIf") return false;
+  const NodeDef* cond_node = node_map_->GetNode(node->input(0));
+  if (cond_node == nullptr || !CheckAttrExists(*cond_node, "value").ok()) {
+    return false;
+  }
+  Tensor cond_t;
+  if (!cond_t.FromProto(cond_node->attr().at("value").tensor())) return false;
+  // Only handle the common scalar predicates; the truthiness of the others
+  // (e.g. strings or non-scalars) is left to the op.
+  if (!TensorShapeUtils::IsScalar(cond_t.shape())) return false;
+  bool cond;
+  switch (cond_t.dtype()) {
+    case DT_BOOL:
+      cond = cond_t.scalar<bool>()();
+      break;
+    case DT_INT32:
+      cond = cond_t.scalar<int32>()() != 0;
+      break;
+    case DT_INT64:
+      cond = cond_t.scalar<int64>()() != 0;
+      break;
+    default:
+      return false;
+  }
+
+  NodeDef call_node = *node;
+  call_node.set_op(node->op() == "If" ? "StatefulPartitionedCall"
+                                      : "PartitionedCall");
+  call_node.clear_input();
+  for (int i = 1; i < node->input_size(); ++i) {
+    call_node.add_input(node->input(i));
+  }
+  *(*call_node.mutable_attr())["f"].mutable_func() =
+      node->attr().at(cond ? "then_branch" : "else_branch").func();
+
+  // Move the output shapes of the If to _output_shapes if they are known.
+  auto it = node->attr().find("output_shapes");
+  if (it != node->attr().end() && it->second.list().shape_size() > 0) {
+    *(*call_node.mutable_attr())["_output_shapes"].mutable_list() =
+        it->second.list();
+  }
+
+  call_node.mutable_attr()->erase("Tcond");
+  call_node.mutable_attr()->erase("then_branch");
+  call_node.mutable_attr()->erase("else_branch");
+  call_node.mutable_attr()->erase("output_shapes");
+
+  // The predicate is no longer an input, but the call must still run after it.
+  const string ctrl_dep = AddControlDependency(
+      node->input(0), optimized_graph, node_map_.get());
+  call_node.add_input(ctrl_dep);
+  node_map_->UpdateInput(node->name(), node->input(0), ctrl_dep);
+
+  *node = std::move(call_node);
+  return true;
+}
+
 bool ConstantFolding::SimplifySelect(const GraphProperties& properties,
                                      GraphDef* optimized_graph, NodeDef* node) {
   if (!IsSelect(*node)) return false;
@@ -96,6 +96,18 @@ class ConstantFolding : public GraphOptimizer {
   Status EvaluateOneFoldable(const NodeDef& node, std::vector<NodeDef>* outputs,
                              bool* result_too_large);
 
+  // Large constants without inputs are pooled by value, so that the copies
+  // folding produces of a pooled constant can forward it instead of
+  // materializing the value again.
+  void AddToConstantPool(const NodeDef& node);
+  bool HasPooledConstant(const Tensor& value, const string& device) const;
+  // Turns the copies of pooled constants into Identities of the constants.
+  // `forwarding_nodes` maps the Identities of pooled constants the graph had
+  // before folding to their input, which they get back without counting as a
+  // modification.
+  void ShareLargeConstants(
+      const absl::flat_hash_map<string, string>& forwarding_nodes);
+
   Status FoldMergeNode(NodeDef* node, GraphDef* output_graph);
   Status FoldNode(NodeDef* node, GraphDef* output_graph,
                   bool* result_too_large);
@@ -287,6 +299,10 @@ class ConstantFolding : public GraphOptimizer {
   // Simplify a Case operation where the output_idx is known.
   bool SimplifyCase(GraphDef* optimized_graph, NodeDef* node);
 
+  // Simplify an If operation whose predicate is known to a call of the branch
+  // it takes.
+  bool SimplifyIf(GraphDef* optimized_graph, NodeDef* node);
+
   // Simplify a Select operation where the predicates are all true or all false.
   bool SimplifySelect(const GraphProperties& properties,
                       GraphDef* optimized_graph, NodeDef* node);
@@ -333,6 +349,11 @@ class ConstantFolding : public GraphOptimizer {
   absl::flat_hash_set<string> nodes_allowlist_;
   absl::flat_hash_set<string> feed_nodes_;
   absl::flat_hash_map<string, bool> maybe_foldable_nodes_;
+  // Names of the pooled constants, by fingerprint of their value.
+  absl::flat_hash_map<uint64, std::vector<string>> constant_pool_;
+  absl::flat_hash_set<string> pooled_constants_;
+  // Fingerprints of the types and shapes of the pooled constants.
+  absl::flat_hash_set<uint64> pooled_shapes_;
   bool has_fetch_;
   bool graph_modified_;
   bool graph_contains_assign_or_inplace_op_;
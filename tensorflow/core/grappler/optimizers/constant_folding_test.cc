@@ -3029,6 +3029,57 @@ TEST_F(ConstantFoldingTest, LargeConstantNoSizeIncrease) {
   EXPECT_LT(output.ByteSizeLong(), sizeof(float) * large_constant_size + 500);
 }
 
+TEST_F(ConstantFoldingTest, LargeConstantIsShared) {
+  // Folding t2 yields a copy of the large constant w, which should forward w
+  // rather than duplicate it in the graph.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Tensor w_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({256, 256}));
+  Output w = ops::Const(s.WithOpName("w"), Input::Initializer(w_t));
+  Output perm = ops::Const(s.WithOpName("perm"), {1, 0}, {2});
+  Output t1 = ops::Transpose(s.WithOpName("t1"), w, perm);
+  Output t2 = ops::Transpose(s.WithOpName("t2"), t1, perm);
+  Output out = ops::Identity(s.WithOpName("out"), t2);
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape(TensorShape({1, 256})));
+  Output y = ops::MatMul(s.WithOpName("y"), x, w);
+
+  GrapplerItem item;
+  item.fetch = {"out", "y"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  auto x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({1, 256}));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x_t}});
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "t2") {
+      EXPECT_EQ("Identity", node.op());
+      ASSERT_EQ(1, node.input_size());
+      EXPECT_EQ("w", node.input(0));
+      ++found;
+    } else if (node.name() == "w") {
+      EXPECT_EQ("Const", node.op());
+      ++found;
+    }
+  }
+  EXPECT_EQ(2, found);
+  EXPECT_LT(output.ByteSizeLong(), w_t.TotalBytes() + 1000);
+
+  // The result is stable.
+  item.graph.Swap(&output);
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+  EXPECT_LT(output.ByteSizeLong(), w_t.TotalBytes() + 1000);
+
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x_t}});
+  ASSERT_EQ(2, tensors_expected.size());
+  ASSERT_EQ(2, tensors.size());
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+  test::ExpectTensorNear<float>(tensors_expected[1], tensors[1], 1e-5);
+}
+
 TEST_F(ConstantFoldingTest, MaterializeBroadcastGradientArgs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a =
@@ -4233,6 +4284,68 @@ TEST_F(ConstantFoldingTest, SimplifyCase) {
   }
 }
 
+TEST_F(ConstantFoldingTest, SimplifyIf) {
+  using test::function::NDef;
+
+  for (bool pred : {true, false}) {
+    // Build a graph to compute y = If(pred, x, XTimesTwo(x), NonZero(x))
+    GrapplerItem item;
+    constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+    AttrValue then_branch;
+    then_branch.mutable_func()->set_name("XTimesTwo");
+    (*then_branch.mutable_func()->mutable_attr())["T"].set_type(DT_FLOAT);
+    AttrValue else_branch = then_branch;
+    else_branch.mutable_func()->set_name("NonZero");
+
+    item.graph = test::function::GDef(
+        {NDef("pred", "Const", {},
+              {{"value", test::AsScalar<bool>(pred)}, {"dtype", DT_BOOL}},
+              kDevice),
+         NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+         NDef("if", "StatelessIf", {"pred", "x"},
+              {{"Tcond", DT_BOOL},
+               {"Tin", DataTypeSlice{DT_FLOAT}},
+               {"Tout", DataTypeSlice{DT_FLOAT}},
+               {"then_branch", then_branch},
+               {"else_branch", else_branch}},
+              kDevice),
+         NDef("y", "Identity", {"if"}, {{"T", DT_FLOAT}}, kDevice)},
+        // FunctionLib
+        {
+            test::function::XTimesTwo(),
+            test::function::NonZero(),
+        });
+
+    item.fetch = {"y"};
+    const Tensor kTwo = test::AsScalar<float>(2.0f);
+    auto tensors_expected =
+        EvaluateNodes(item.graph, item.fetch, {{"x", kTwo}});
+
+    ConstantFolding optimizer(/*cpu_device=*/nullptr);
+    GraphDef optimized_graph;
+    TF_ASSERT_OK(
+        optimizer.Optimize(/*cluster=*/nullptr, item, &optimized_graph));
+
+    int pco_count = 0;
+    for (const auto& node : optimized_graph.node()) {
+      EXPECT_NE(node.op(), "StatelessIf");
+      if (node.op() == "PartitionedCall") {
+        ++pco_count;
+        EXPECT_EQ(node.attr().at("f").func().name(),
+                  pred ? "XTimesTwo" : "NonZero");
+        ASSERT_EQ(node.input_size(), 2);
+        EXPECT_EQ(node.input(0), "x");
+        EXPECT_EQ(node.input(1), "^pred");
+      }
+    }
+    EXPECT_EQ(pco_count, 1);
+
+    auto tensors = EvaluateNodes(optimized_graph, item.fetch, {{"x", kTwo}});
+    ASSERT_EQ(tensors.size(), tensors_expected.size());
+    test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+  }
+}
+
 TEST_F(ConstantFoldingTest, SimplifySelect) {
   for (bool scalar_pred : {true, false}) {
     for (bool pred_val : {true, false}) {
@@ -27,8 +27,11 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
@@ -42,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/public/version.h"
@@ -714,6 +718,483 @@ Status CheckForDeadFanout(const MutableGraphView& view,
   return Status::OK();
 }
 
+// Functional While loops.
+
+// Max number of nodes in the body of an unrolled While loop.
+constexpr int kMaxUnrolledBodySize = 512;
+
+// Returns true if the nodes of `func` are registered ops without side
+// effects, so that executing them fewer times or in a different order doesn't
+// change the results.
+bool IsSideEffectFree(const FunctionDef& func,
+                      const FunctionLibraryDefinition& flib) {
+  if (func.control_ret_size() > 0) return false;
+  for (const NodeDef& node : func.node_def()) {
+    const OpDef* op_def = nullptr;
+    if (flib.Find(node.op()) != nullptr ||
+        !flib.LookUpOpDef(node.op(), &op_def).ok() || op_def->is_stateful()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the function called through the `attr` of `node`, if it isn't
+// parametrized.
+const FunctionDef* GetCalledFunction(const NodeDef& node, const string& attr,
+                                     const FunctionLibraryDefinition& flib) {
+  auto it = node.attr().find(attr);
+  if (it == node.attr().end() || !it->second.func().attr().empty()) {
+    return nullptr;
+  }
+  const FunctionDef* func = flib.Find(it->second.func().name());
+  if (func == nullptr || !func->signature().attr().empty()) return nullptr;
+  return func;
+}
+
+string UniqueFunctionName(const string& prefix,
+                          const FunctionLibraryDefinition& flib) {
+  string name = prefix;
+  for (int i = 1; flib.Contains(name); ++i) {
+    name = StrCat(prefix, "_", i);
+  }
+  return name;
+}
+
+// Returns the name of the node referenced by a function body input, or an
+// empty string if it references a function argument.
+string FunctionInputNode(const string& input) {
+  const string name = IsControlInput(input) ? input.substr(1) : input;
+  const size_t pos = name.find(':');
+  return pos == string::npos ? "" : name.substr(0, pos);
+}
+
+// Returns the loop variables the body of a While loop passes through.
+std::vector<bool> InvariantLoopVars(const FunctionDef& body) {
+  const OpDef& signature = body.signature();
+  std::vector<bool> invariant(signature.input_arg_size(), false);
+  if (signature.output_arg_size() != signature.input_arg_size()) {
+    return invariant;
+  }
+  for (int i = 0; i < signature.input_arg_size(); ++i) {
+    auto it = body.ret().find(signature.output_arg(i).name());
+    invariant[i] = it != body.ret().end() &&
+                   it->second == signature.input_arg(i).name();
+  }
+  return invariant;
+}
+
+bool GetScalarInt(const NodeDef* node, int64* value) {
+  if (node == nullptr || !IsConstant(*node)) return false;
+  auto it = node->attr().find("value");
+  Tensor tensor;
+  if (it == node->attr().end() || !tensor.FromProto(it->second.tensor()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  if (tensor.dtype() == DT_INT32) {
+    *value = tensor.flat<int32>()(0);
+  } else if (tensor.dtype() == DT_INT64) {
+    *value = tensor.flat<int64>()(0);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Appends a loop variable to the signature of a While body or condition.
+void AddLoopVar(const string& name, DataType type, bool is_body,
+                FunctionDef* func) {
+  OpDef::ArgDef* input_arg = func->mutable_signature()->add_input_arg();
+  input_arg->set_name(name);
+  input_arg->set_type(type);
+  if (is_body) {
+    OpDef::ArgDef* output_arg = func->mutable_signature()->add_output_arg();
+    output_arg->set_name(StrCat(name, "_out"));
+    output_arg->set_type(type);
+    (*func->mutable_ret())[output_arg->name()] = name;
+  }
+}
+
+// Moves the nodes of the body of `while_node` that only depend on loop
+// invariants out of the loop, so that they're computed once rather than once
+// per iteration. Their results are passed to the body as new loop variables.
+Status HoistWhileLoopInvariants(const NodeMap& node_map, NodeDef* while_node,
+                                FunctionLibraryDefinition* flib,
+                                GraphDef* optimized_graph) {
+  const FunctionDef* body = GetCalledFunction(*while_node, "body", *flib);
+  const FunctionDef* cond = GetCalledFunction(*while_node, "cond", *flib);
+  if (body == nullptr || cond == nullptr) return Status::OK();
+  const OpDef& signature = body->signature();
+  const std::vector<bool> invariant_vars = InvariantLoopVars(*body);
+  if (while_node->input_size() < signature.input_arg_size()) {
+    return Status::OK();
+  }
+  std::unordered_map<string, int> invariant_args;
+  for (int i = 0; i < signature.input_arg_size(); ++i) {
+    if (invariant_vars[i]) invariant_args[signature.input_arg(i).name()] = i;
+  }
+  if (invariant_args.empty()) return Status::OK();
+
+  std::unordered_set<string> control_outputs;
+  for (const auto& control_ret : body->control_ret()) {
+    control_outputs.insert(control_ret.second);
+  }
+
+  // Find the invariant nodes, in topological order.
+  std::vector<const NodeDef*> invariant_nodes;
+  std::unordered_map<string, const NodeDef*> invariant_node_map;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const NodeDef& node : body->node_def()) {
+      if (invariant_node_map.count(node.name()) ||
+          control_outputs.count(node.name())) {
+        continue;
+      }
+      const OpDef* op_def = nullptr;
+      if (flib->Find(node.op()) != nullptr ||
+          !flib->LookUpOpDef(node.op(), &op_def).ok() ||
+          op_def->is_stateful() ||
+          (node.input().empty() && !IsConstant(node))) {
+        continue;
+      }
+      bool is_invariant = true;
+      for (const auto& output_arg : op_def->output_arg()) {
+        is_invariant &= output_arg.number_attr().empty() &&
+                        output_arg.type_list_attr().empty();
+      }
+      for (const string& input : node.input()) {
+        if (!is_invariant) break;
+        const string input_node = FunctionInputNode(input);
+        is_invariant = !IsControlInput(input) &&
+                       (input_node.empty() ? invariant_args.count(input) > 0
+                                           : invariant_node_map.count(
+                                                 input_node) > 0);
+      }
+      if (is_invariant) {
+        invariant_nodes.push_back(&node);
+        invariant_node_map[node.name()] = &node;
+        changed = true;
+      }
+    }
+  }
+
+  // The invariant tensors the rest of the body reads, which become new loop
+  // variables. Constants aren't worth hoisting on their own.
+  std::map<string, DataType> hoisted_tensors;
+  const auto maybe_hoist = [&](const string& input) -> Status {
+    const string input_node = FunctionInputNode(input);
+    auto it = invariant_node_map.find(input_node);
+    if (IsControlInput(input) || it == invariant_node_map.end() ||
+        IsConstant(*it->second)) {
+      return Status::OK();
+    }
+    const std::vector<string> parts = str_util::Split(input, ':');
+    if (parts.size() != 3 || parts[2] != "0") {
+      return errors::Internal("Unexpected function input ", input);
+    }
+    const OpDef* op_def = nullptr;
+    TF_RETURN_IF_ERROR(flib->LookUpOpDef(it->second->op(), &op_def));
+    DataTypeVector output_types;
+    TF_RETURN_IF_ERROR(
+        OutputTypesForNode(*it->second, *op_def, &output_types));
+    for (int i = 0; i < op_def->output_arg_size(); ++i) {
+      if (op_def->output_arg(i).name() == parts[1]) {
+        hoisted_tensors[input] = output_types[i];
+        return Status::OK();
+      }
+    }
+    return errors::Internal("Unknown output ", input);
+  };
+  for (const NodeDef& node : body->node_def()) {
+    if (invariant_node_map.count(node.name())) continue;
+    for (const string& input : node.input()) {
+      TF_RETURN_IF_ERROR(maybe_hoist(input));
+    }
+  }
+  for (const auto& ret : body->ret()) {
+    TF_RETURN_IF_ERROR(maybe_hoist(ret.second));
+  }
+  if (hoisted_tensors.empty()) return Status::OK();
+
+  // Compute the invariant nodes before the loop.
+  const string prefix = StrCat(while_node->name(), "/hoisted");
+  for (const NodeDef* node : invariant_nodes) {
+    if (node_map.GetNode(AddPrefixToNodeName(node->name(), prefix))) {
+      return Status::OK();
+    }
+  }
+  const auto outer_tensor = [&](const string& input) -> string {
+    auto arg = invariant_args.find(input);
+    if (arg != invariant_args.end()) return while_node->input(arg->second);
+    const std::vector<string> parts = str_util::Split(input, ':');
+    const NodeDef* node = invariant_node_map.at(parts[0]);
+    const OpDef* op_def = nullptr;
+    TF_CHECK_OK(flib->LookUpOpDef(node->op(), &op_def));
+    int index = 0;
+    while (op_def->output_arg(index).name() != parts[1]) ++index;
+    return StrCat(AddPrefixToNodeName(parts[0], prefix), ":", index);
+  };
+  std::unordered_set<string> needed_nodes;
+  for (const auto& tensor : hoisted_tensors) {
+    needed_nodes.insert(FunctionInputNode(tensor.first));
+  }
+  for (auto it = invariant_nodes.rbegin(); it != invariant_nodes.rend(); ++it) {
+    if (!needed_nodes.count((*it)->name())) continue;
+    for (const string& input : (*it)->input()) {
+      needed_nodes.insert(FunctionInputNode(input));
+    }
+  }
+  for (const NodeDef* node : invariant_nodes) {
+    if (!needed_nodes.count(node->name())) continue;
+    NodeDef* hoisted_node = optimized_graph->add_node();
+    *hoisted_node = *node;
+    hoisted_node->set_name(AddPrefixToNodeName(node->name(), prefix));
+    hoisted_node->set_device(while_node->device());
+    for (int i = 0; i < node->input_size(); ++i) {
+      hoisted_node->set_input(i, outer_tensor(node->input(i)));
+    }
+  }
+
+  // Pass the hoisted tensors to new copies of the body and condition.
+  FunctionDef new_body = *body;
+  FunctionDef new_cond = *cond;
+  new_body.mutable_signature()->set_name(
+      UniqueFunctionName(StrCat(signature.name(), "_hoisted"), *flib));
+  new_cond.mutable_signature()->set_name(UniqueFunctionName(
+      StrCat(cond->signature().name(), "_hoisted"), *flib));
+  std::unordered_map<string, string> hoisted_args;
+  std::vector<string> loop_var_inputs(
+      while_node->input().begin(),
+      while_node->input().begin() + signature.input_arg_size());
+  AttrValue* types = &(*while_node->mutable_attr())["T"];
+  for (const auto& tensor : hoisted_tensors) {
+    const string arg_name = StrCat("hoisted_", hoisted_args.size());
+    AddLoopVar(arg_name, tensor.second, /*is_body=*/true, &new_body);
+    AddLoopVar(arg_name, tensor.second, /*is_body=*/false, &new_cond);
+    hoisted_args[tensor.first] = arg_name;
+    loop_var_inputs.push_back(outer_tensor(tensor.first));
+    types->mutable_list()->add_type(tensor.second);
+    for (const char* shapes_attr : {"output_shapes", "_output_shapes"}) {
+      auto it = while_node->mutable_attr()->find(shapes_attr);
+      if (it != while_node->mutable_attr()->end() &&
+          it->second.list().shape_size() > 0) {
+        it->second.mutable_list()->add_shape()->set_unknown_rank(true);
+      }
+    }
+  }
+  new_body.clear_node_def();
+  for (const NodeDef& node : body->node_def()) {
+    auto it = invariant_node_map.find(node.name());
+    if (it != invariant_node_map.end() && !IsConstant(node)) continue;
+    NodeDef* new_node = new_body.add_node_def();
+    *new_node = node;
+    new_node->clear_input();
+    for (const string& input : node.input()) {
+      auto arg = hoisted_args.find(input);
+      if (arg != hoisted_args.end()) {
+        new_node->add_input(arg->second);
+      } else if (!IsControlInput(input) ||
+                 !invariant_node_map.count(FunctionInputNode(input)) ||
+                 IsConstant(*invariant_node_map.at(FunctionInputNode(input)))) {
+        new_node->add_input(input);
+      }
+    }
+  }
+  for (auto& ret : *new_body.mutable_ret()) {
+    auto arg = hoisted_args.find(ret.second);
+    if (arg != hoisted_args.end()) ret.second = arg->second;
+  }
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(new_body));
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(new_cond));
+  (*while_node->mutable_attr())["body"].mutable_func()->set_name(
+      new_body.signature().name());
+  (*while_node->mutable_attr())["cond"].mutable_func()->set_name(
+      new_cond.signature().name());
+
+  for (int i = signature.input_arg_size(); i < while_node->input_size(); ++i) {
+    loop_var_inputs.push_back(while_node->input(i));
+  }
+  while_node->clear_input();
+  for (const string& input : loop_var_inputs) {
+    while_node->add_input(input);
+  }
+  VLOG(1) << "Hoisted " << needed_nodes.size() << " nodes out of "
+          << while_node->name();
+  return Status::OK();
+}
+
+// Unrolls `while_node` when it counts from a constant to a constant bound,
+// with a trip count that's a multiple of the unrolling factor: the condition
+// then only needs to be checked every `factor` iterations.
+Status UnrollWhileLoop(const NodeMap& node_map, NodeDef* while_node,
+                       FunctionLibraryDefinition* flib) {
+  const FunctionDef* body = GetCalledFunction(*while_node, "body", *flib);
+  const FunctionDef* cond = GetCalledFunction(*while_node, "cond", *flib);
+  if (body == nullptr || cond == nullptr ||
+      cond->signature().output_arg_size() != 1 ||
+      !IsSideEffectFree(*body, *flib) || !IsSideEffectFree(*cond, *flib)) {
+    return Status::OK();
+  }
+  const OpDef& signature = body->signature();
+  const int num_vars = signature.input_arg_size();
+  if (signature.output_arg_size() != num_vars ||
+      cond->signature().input_arg_size() != num_vars ||
+      while_node->input_size() < num_vars) {
+    return Status::OK();
+  }
+  std::unordered_map<string, const NodeDef*> cond_nodes;
+  for (const NodeDef& node : cond->node_def()) cond_nodes[node.name()] = &node;
+  std::unordered_map<string, const NodeDef*> body_nodes;
+  for (const NodeDef& node : body->node_def()) body_nodes[node.name()] = &node;
+
+  // The condition must be Less(counter, limit).
+  const auto cond_ret =
+      cond->ret().find(cond->signature().output_arg(0).name());
+  if (cond_ret == cond->ret().end()) return Status::OK();
+  auto it = cond_nodes.find(FunctionInputNode(cond_ret->second));
+  if (it == cond_nodes.end() || it->second->op() != "Less" ||
+      it->second->input_size() != 2) {
+    return Status::OK();
+  }
+  const NodeDef& less = *it->second;
+  int counter = -1;
+  for (int i = 0; i < num_vars; ++i) {
+    if (less.input(0) == cond->signature().input_arg(i).name()) counter = i;
+  }
+  int64 limit;
+  const string limit_node = FunctionInputNode(less.input(1));
+  if (counter < 0 || limit_node.empty() || !cond_nodes.count(limit_node) ||
+      !GetScalarInt(cond_nodes[limit_node], &limit)) {
+    return Status::OK();
+  }
+
+  // The body must increment the counter by one, from a constant start.
+  const auto body_ret = body->ret().find(signature.output_arg(counter).name());
+  if (body_ret == body->ret().end()) return Status::OK();
+  it = body_nodes.find(FunctionInputNode(body_ret->second));
+  if (it == body_nodes.end() ||
+      (it->second->op() != "Add" && it->second->op() != "AddV2") ||
+      it->second->input_size() != 2) {
+    return Status::OK();
+  }
+  const NodeDef& add = *it->second;
+  const string& counter_arg = signature.input_arg(counter).name();
+  const string step_input =
+      add.input(0) == counter_arg ? add.input(1) : add.input(0);
+  int64 step;
+  int64 start;
+  if ((add.input(0) != counter_arg && add.input(1) != counter_arg) ||
+      !body_nodes.count(FunctionInputNode(step_input)) ||
+      !GetScalarInt(body_nodes[FunctionInputNode(step_input)], &step) ||
+      step != 1 ||
+      !GetScalarInt(node_map.GetNode(while_node->input(counter)), &start)) {
+    return Status::OK();
+  }
+  const int64 trip_count = limit - start;
+  int factor = 0;
+  for (int f : {4, 3, 2}) {
+    if (trip_count >= f && trip_count % f == 0 &&
+        f * body->node_def_size() <= kMaxUnrolledBodySize) {
+      factor = f;
+      break;
+    }
+  }
+  if (factor == 0) return Status::OK();
+
+  std::unordered_map<string, int> arg_index;
+  for (int i = 0; i < num_vars; ++i) {
+    arg_index[signature.input_arg(i).name()] = i;
+    if (!body->ret().count(signature.output_arg(i).name())) {
+      return Status::OK();
+    }
+  }
+  for (const NodeDef& node : body->node_def()) {
+    for (int c = 1; c < factor; ++c) {
+      if (body_nodes.count(StrCat(node.name(), "/unrolled_", c))) {
+        return Status::OK();
+      }
+    }
+  }
+
+  FunctionDef unrolled = *body;
+  unrolled.mutable_signature()->set_name(UniqueFunctionName(
+      StrCat(signature.name(), "_unrolled_", factor), *flib));
+  unrolled.clear_node_def();
+  // The tensor holding each loop variable in the current copy of the body.
+  std::vector<string> vars;
+  for (int i = 0; i < num_vars; ++i) {
+    vars.push_back(signature.input_arg(i).name());
+  }
+  for (int c = 0; c < factor; ++c) {
+    const string suffix = c == 0 ? "" : StrCat("/unrolled_", c);
+    const auto rename = [&](const string& input) -> string {
+      const bool is_control = IsControlInput(input);
+      const string name = is_control ? input.substr(1) : input;
+      const size_t pos = name.find(':');
+      string tensor;
+      if (pos == string::npos) {
+        auto arg = arg_index.find(name);
+        tensor = arg == arg_index.end() ? name : vars[arg->second];
+      } else {
+        tensor = StrCat(name.substr(0, pos), suffix, name.substr(pos));
+      }
+      if (!is_control) return tensor;
+      const string node = FunctionInputNode(tensor);
+      return StrCat("^", node.empty() ? tensor : node);
+    };
+    for (const NodeDef& node : body->node_def()) {
+      NodeDef* copy = unrolled.add_node_def();
+      *copy = node;
+      copy->set_name(StrCat(node.name(), suffix));
+      for (int i = 0; i < node.input_size(); ++i) {
+        copy->set_input(i, rename(node.input(i)));
+      }
+    }
+    std::vector<string> next_vars;
+    for (int i = 0; i < num_vars; ++i) {
+      next_vars.push_back(
+          rename(body->ret().at(signature.output_arg(i).name())));
+    }
+    vars.swap(next_vars);
+  }
+  for (int i = 0; i < num_vars; ++i) {
+    (*unrolled.mutable_ret())[signature.output_arg(i).name()] = vars[i];
+  }
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(unrolled));
+  (*while_node->mutable_attr())["body"].mutable_func()->set_name(
+      unrolled.signature().name());
+  VLOG(1) << "Unrolled " << while_node->name() << " " << factor << " times";
+  return Status::OK();
+}
+
+Status OptimizeFunctionalWhileLoops(bool hoist_invariants, bool unroll,
+                                    GraphDef* optimized_graph) {
+  FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                 optimized_graph->library());
+  NodeMap node_map(optimized_graph);
+  bool has_while_loops = false;
+  // Hoisting invariants adds nodes to the graph, which don't need visiting.
+  const int num_nodes = optimized_graph->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = optimized_graph->mutable_node(i);
+    if (!IsWhile(*node)) continue;
+    has_while_loops = true;
+    if (hoist_invariants) {
+      TF_RETURN_IF_ERROR(
+          HoistWhileLoopInvariants(node_map, node, &flib, optimized_graph));
+    }
+    if (unroll) {
+      TF_RETURN_IF_ERROR(UnrollWhileLoop(node_map, node, &flib));
+    }
+  }
+  if (has_while_loops) {
+    *optimized_graph->mutable_library() = flib.ToProto();
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 LoopOptimizer::LoopOptimizer()
@@ -733,7 +1214,9 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
       !options_.enable_stack_push_removal &&
-      !options_.enable_dead_branch_removal) {
+      !options_.enable_dead_branch_removal &&
+      !options_.enable_while_invariant_hoisting &&
+      !options_.enable_while_unrolling) {
     return errors::Aborted("Nothing to do.");
   }
   *optimized_graph = item.graph;
@@ -754,6 +1237,12 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     TF_RETURN_IF_ERROR(RemoveDeadBranches(item.NodesToPreserve(), node_map,
                                           feed_nodes, optimized_graph));
   }
+  if (options_.enable_while_invariant_hoisting ||
+      options_.enable_while_unrolling) {
+    TF_RETURN_IF_ERROR(OptimizeFunctionalWhileLoops(
+        options_.enable_while_invariant_hoisting,
+        options_.enable_while_unrolling, optimized_graph));
+  }
 
   return Status::OK();
 }
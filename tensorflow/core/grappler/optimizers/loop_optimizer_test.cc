@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -70,11 +71,19 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_stack_push_removal = true;
   }
 
+  void EnableOnlyWhileLoopOptimizations(LoopOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_while_invariant_hoisting = true;
+    optimizer->options_.enable_while_unrolling = true;
+  }
+
  private:
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
     options.enable_loop_invariant_node_motion = false;
     options.enable_stack_push_removal = false;
+    options.enable_while_invariant_hoisting = false;
+    options.enable_while_unrolling = false;
     optimizer->options_ = options;
   }
 };
@@ -1689,5 +1698,116 @@ versions {
   EXPECT_TRUE(found);
 }
 
+TEST_F(LoopOptimizerTest, HoistAndUnrollFunctionalWhile) {
+  using test::function::NDef;
+  using FDH = FunctionDefHelper;
+
+  // for (i = 0; i < 8; ++i) x *= w * w;
+  FunctionDef body = FDH::Create(
+      "body", {"i: int32", "x: float", "w: float"},
+      {"i_out: int32", "x_out: float", "w_out: float"}, {},
+      {FDH::Const("one", 1),
+       {{"next_i"}, "AddV2", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+       {{"w2"}, "Mul", {"w", "w"}, {{"T", DT_FLOAT}}},
+       {{"y"}, "Mul", {"x", "w2:z:0"}, {{"T", DT_FLOAT}}}},
+      {{"i_out", "next_i:z:0"}, {"x_out", "y:z:0"}, {"w_out", "w"}});
+  FunctionDef cond = FDH::Create(
+      "cond", {"i: int32", "x: float", "w: float"}, {"z: bool"}, {},
+      {FDH::Const("limit", 8),
+       {{"less"}, "Less", {"i", "limit:output:0"}, {{"T", DT_INT32}}}},
+      {{"z", "less:z:0"}});
+
+  GrapplerItem item;
+  item.fetch = {"out"};
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {},
+            {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}),
+       NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("w", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("while", "While", {"start", "x", "w"},
+            {{"T", DataTypeSlice{DT_INT32, DT_FLOAT, DT_FLOAT}},
+             {"cond", FDH::FunctionRef("cond")},
+             {"body", FDH::FunctionRef("body")}}),
+       NDef("out", "Identity", {"while:1"}, {{"T", DT_FLOAT}})},
+      {body, cond});
+
+  LoopOptimizer optimizer;
+  EnableOnlyWhileLoopOptimizations(&optimizer);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // w * w is computed once, before the loop.
+  NodeMap node_map(&output);
+  const NodeDef* hoisted = node_map.GetNode("while/hoisted/w2");
+  ASSERT_NE(hoisted, nullptr);
+  EXPECT_EQ("Mul", hoisted->op());
+  EXPECT_EQ("w", hoisted->input(0));
+  EXPECT_EQ("w", hoisted->input(1));
+
+  const NodeDef* while_node = node_map.GetNode("while");
+  ASSERT_NE(while_node, nullptr);
+  ASSERT_EQ(4, while_node->input_size());
+  EXPECT_EQ("while/hoisted/w2:0", while_node->input(3));
+  EXPECT_EQ(4, while_node->attr().at("T").list().type_size());
+
+  // The 8 iterations run as 2 iterations of a body unrolled 4 times.
+  const string& body_name = while_node->attr().at("body").func().name();
+  EXPECT_EQ("body_hoisted_unrolled_4", body_name);
+  const FunctionDef* new_body = nullptr;
+  for (const FunctionDef& func : output.library().function()) {
+    if (func.signature().name() == body_name) new_body = &func;
+  }
+  ASSERT_NE(new_body, nullptr);
+  EXPECT_EQ(4, new_body->signature().input_arg_size());
+  int num_muls = 0;
+  for (const NodeDef& node : new_body->node_def()) {
+    EXPECT_NE("w2", node.name());
+    if (node.op() == "Mul") {
+      ++num_muls;
+      EXPECT_EQ("hoisted_0", node.input(1));
+    }
+  }
+  EXPECT_EQ(4, num_muls);
+  EXPECT_EQ("y/unrolled_3:z:0", new_body->ret().at("x_out"));
+  EXPECT_EQ("next_i/unrolled_3:z:0", new_body->ret().at("i_out"));
+}
+
+TEST_F(LoopOptimizerTest, DontUnrollFunctionalWhileWithOddTripCount) {
+  using test::function::NDef;
+  using FDH = FunctionDefHelper;
+
+  FunctionDef body = FDH::Create(
+      "body", {"i: int32"}, {"i_out: int32"}, {},
+      {FDH::Const("one", 1),
+       {{"next_i"}, "AddV2", {"i", "one:output:0"}, {{"T", DT_INT32}}}},
+      {{"i_out", "next_i:z:0"}});
+  FunctionDef cond = FDH::Create(
+      "cond", {"i: int32"}, {"z: bool"}, {},
+      {FDH::Const("limit", 7),
+       {{"less"}, "Less", {"i", "limit:output:0"}, {{"T", DT_INT32}}}},
+      {{"z", "less:z:0"}});
+
+  GrapplerItem item;
+  item.fetch = {"while"};
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {},
+            {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}),
+       NDef("while", "While", {"start"},
+            {{"T", DataTypeSlice{DT_INT32}},
+             {"cond", FDH::FunctionRef("cond")},
+             {"body", FDH::FunctionRef("body")}})},
+      {body, cond});
+
+  LoopOptimizer optimizer;
+  EnableOnlyWhileLoopOptimizations(&optimizer);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* while_node = node_map.GetNode("while");
+  ASSERT_NE(while_node, nullptr);
+  EXPECT_EQ("body", while_node->attr().at("body").func().name());
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -225,6 +225,98 @@ std::vector<RecomputedSubGraph> GetOpGroupsToRecompute(
   return subgraphs_to_recompute;
 }
 
+// Estimates the peak memory usage of `item` on the devices of `cluster`, and
+// sets `peak_usage` to that of the device with the highest peak. Returns false
+// if the memory usage can't be inferred.
+bool EstimatePeakMemoryUsage(Cluster* cluster, const GrapplerItem& item,
+                             GraphMemory::MemoryUsage* peak_usage) {
+  GraphMemory memory(item);
+  Status s = memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return false;
+  }
+  bool found = false;
+  for (const auto& device : cluster->GetDevices()) {
+    const GraphMemory::MemoryUsage& usage =
+        memory.GetPeakMemoryUsage(device.first);
+    if (usage.used_memory < 0) continue;
+    if (!found || usage.used_memory > peak_usage->used_memory) {
+      *peak_usage = usage;
+      found = true;
+    }
+  }
+  return found;
+}
+
+// Picks the subgraphs of `candidates` to recompute so that the peak memory
+// usage `peak_usage` drops to `peak_memory_budget`. Recomputing a subgraph
+// frees those of its outputs that are live at the peak, at the cost of
+// producing all of them again; since the ops we recompute are cheap and
+// memory bound, the bytes they write stand in for their run time. Subgraphs
+// are picked greedily, fewest bytes recomputed per byte freed first, until
+// the excess is covered. Subgraphs with manually annotated nodes are always
+// recomputed.
+std::vector<RecomputedSubGraph> SelectRecomputationsForBudget(
+    std::vector<RecomputedSubGraph> candidates,
+    const GraphMemory::MemoryUsage& peak_usage, int64 peak_memory_budget,
+    const GraphProperties& properties) {
+  std::unordered_map<string, int64> live_bytes;
+  for (const auto& live_tensor : peak_usage.live_tensors) {
+    live_bytes[live_tensor.node] += live_tensor.memory_used;
+  }
+
+  struct Candidate {
+    int index;
+    int64 bytes_freed;
+    int64 bytes_recomputed;
+  };
+  std::vector<RecomputedSubGraph> selected;
+  std::vector<Candidate> optional;
+  int64 required_savings = peak_usage.used_memory - peak_memory_budget;
+  for (int i = 0; i < candidates.size(); ++i) {
+    Candidate candidate = {i, 0, 0};
+    bool annotated = false;
+    for (const NodeDef* node : candidates[i].recomputed_source_nodes) {
+      annotated |= node->attr().count(kRecomputeHint) > 0;
+      auto it = live_bytes.find(node->name());
+      if (it != live_bytes.end()) {
+        candidate.bytes_freed += it->second;
+      }
+      if (properties.HasOutputProperties(node->name())) {
+        for (const auto& output :
+             properties.GetOutputProperties(node->name())) {
+          candidate.bytes_recomputed +=
+              std::max<int64>(0, CalculateTensorSize(output));
+        }
+      }
+    }
+    if (annotated) {
+      required_savings -= candidate.bytes_freed;
+      selected.push_back(std::move(candidates[i]));
+    } else if (candidate.bytes_freed > 0) {
+      optional.push_back(candidate);
+    }
+  }
+
+  std::stable_sort(optional.begin(), optional.end(),
+                   [](const Candidate& a, const Candidate& b) {
+                     return static_cast<double>(a.bytes_recomputed) /
+                                a.bytes_freed <
+                            static_cast<double>(b.bytes_recomputed) /
+                                b.bytes_freed;
+                   });
+  for (const Candidate& candidate : optional) {
+    if (required_savings <= 0) break;
+    required_savings -= candidate.bytes_freed;
+    selected.push_back(std::move(candidates[candidate.index]));
+  }
+  VLOG(1) << "Recomputing " << selected.size() << " of " << candidates.size()
+          << " candidate subgraphs to fit a peak memory budget of "
+          << peak_memory_budget << " bytes";
+  return selected;
+}
+
 // Computes the maximum topological numbers of (1) target node components
 // (gradient nodes being fed by the recomputation), and (2) child recompute node
 // components for each recomputed node. We will not attach any control
@@ -440,9 +532,13 @@ void RecomputeSubgraph(
   }
 }
 
+// If `peak_usage` is not null, only recomputes what is needed to bring it down
+// to `peak_memory_budget`.
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
-                                GraphDef* graph, const GrapplerItem& item) {
+                                const GraphMemory::MemoryUsage* peak_usage,
+                                int64 peak_memory_budget, GraphDef* graph,
+                                const GrapplerItem& item) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
   // looks up nodes which were in the original graph, and preserves the graph
@@ -497,6 +593,26 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
         },
         is_target);
   }
+  if (peak_usage != nullptr && !recomputed_subgraphs.empty()) {
+    if (peak_usage->used_memory <= peak_memory_budget) {
+      VLOG(1) << "Peak memory usage " << peak_usage->used_memory
+              << " is within the budget, skipping recomputation";
+      recomputed_subgraphs.clear();
+    } else {
+      const GrapplerItem properties_item = item.WithGraph(GraphDef(*graph));
+      GraphProperties properties(properties_item);
+      Status s = properties.InferStatically(
+          /*assume_valid_feeds=*/false,
+          /*aggressive_shape_inference=*/false,
+          /*include_tensor_values=*/false);
+      if (!s.ok()) {
+        VLOG(1) << "Failed to infer shapes: " << s.error_message();
+      }
+      recomputed_subgraphs = SelectRecomputationsForBudget(
+          std::move(recomputed_subgraphs), *peak_usage, peak_memory_budget,
+          properties);
+    }
+  }
   if (!recomputed_subgraphs.empty()) {
     std::unordered_map<const NodeDef*, int> topological_numbering;
     for (int node_number = 0; node_number < graph->node().size();
@@ -802,6 +918,12 @@ struct SwapInfo {
   Costs::NanoSeconds time_to_swap = 0;
 };
 
+// Returns the time it takes to copy `bytes` between host and device, assuming
+// PCIe running at 16 GBps.
+static Costs::NanoSeconds SwapTime(int64 bytes) {
+  return Costs::NanoSeconds(bytes / 16);
+}
+
 static const NodeDef* FindSwapInTrigger(
     const NodeDef* node, const SwapInfo& swap_info,
     const std::unordered_map<string, const NodeDef*>& name_map,
@@ -977,8 +1099,10 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
+// Swaps out tensors until the peak memory usage of each GPU fits in its
+// memory, or in `peak_memory_budget` if that is positive and smaller.
 static bool IdentifySwappingCandidates(
-    Cluster* cluster, GrapplerItem* item,
+    Cluster* cluster, GrapplerItem* item, int64 peak_memory_budget,
     std::unique_ptr<GraphMemory>* memory_ptr,
     std::unordered_set<string>* skip_list,
     std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
@@ -1000,16 +1124,21 @@ static bool IdentifySwappingCandidates(
     if (prop.type() != "GPU") {
       continue;
     }
-    if (prop.memory_size() <= 0) {
+    int64 memory_limit = prop.memory_size();
+    if (peak_memory_budget > 0 &&
+        (memory_limit <= 0 || peak_memory_budget < memory_limit)) {
+      memory_limit = peak_memory_budget;
+    }
+    if (memory_limit <= 0) {
       VLOG(1) << "Peak memory usage unknown for device " << name;
       continue;
     }
     const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
 
-    if (mem_usage.used_memory <= prop.memory_size()) {
+    if (mem_usage.used_memory <= memory_limit) {
       continue;
     }
-    int64 required_savings = mem_usage.used_memory - prop.memory_size();
+    int64 required_savings = mem_usage.used_memory - memory_limit;
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
     {
@@ -1052,8 +1181,10 @@ static bool IdentifySwappingCandidates(
         // Don't bother with small tensors.
         continue;
       }
+      // The tensor must stay unused long enough to be copied to the host and
+      // back, however long that takes for its size.
       if (live_tensor.deallocation_time - live_tensor.allocation_time <=
-          Costs::Duration(1e6)) {
+          SwapTime(2 * live_tensor.memory_used)) {
         // Not enough time to swap.
         VLOG(1) << "Not enough time to swap: skipping " << live_tensor.node;
         continue;
@@ -1147,15 +1278,16 @@ static bool IdentifySwappingCandidates(
 }
 
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
-                  Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
-                  GrapplerItem* item, std::unordered_set<string>* skip_list) {
+                  int64 peak_memory_budget, Cluster* cluster,
+                  std::unique_ptr<GraphMemory>* memory, GrapplerItem* item,
+                  std::unordered_set<string>* skip_list) {
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
       optimization_level == RewriterConfig::HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
-    IdentifySwappingCandidates(cluster, item, memory, skip_list,
-                               &nodes_to_swap);
+    IdentifySwappingCandidates(cluster, item, peak_memory_budget, memory,
+                               skip_list, &nodes_to_swap);
   }
   // Look for manual annotations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
@@ -1196,8 +1328,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
       const OpInfo::TensorProperties& t = props[input_id];
       bytes_to_swap += CalculateTensorSize(t);
     }
-    // Let's assume we're going to swap over PCIe running at 16 GBps.
-    swap_info.time_to_swap = bytes_to_swap / 16;
+    swap_info.time_to_swap = SwapTime(bytes_to_swap);
   }
 
   std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
@@ -1394,10 +1525,18 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   GrapplerItem optimized_item(item);
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
+  // With a peak memory budget, estimate the peak memory usage up front to
+  // decide how much to recompute, and report how close we got.
+  GraphMemory::MemoryUsage peak_usage_before;
+  const bool has_peak_usage_before =
+      peak_memory_budget_ > 0 && cluster != nullptr && !item.fetch.empty() &&
+      EstimatePeakMemoryUsage(cluster, optimized_item, &peak_usage_before);
+
   if (run_recomputation_pass) {
-    RecomputationRewritingPass(optimization_level_,
-                               recomputation_targets_name_scope_,
-                               &optimized_item.graph, item);
+    RecomputationRewritingPass(
+        optimization_level_, recomputation_targets_name_scope_,
+        has_peak_usage_before ? &peak_usage_before : nullptr,
+        peak_memory_budget_, &optimized_item.graph, item);
   }
 
   std::unordered_set<string> skip_list;
@@ -1428,8 +1567,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
            optimization_level_ == RewriterConfig::HEURISTICS ||
            optimization_level_ == RewriterConfig::MANUAL) &&
           cluster != nullptr) {
-        if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
-                         &skip_list)) {
+        if (SwappingPass(optimization_level_, peak_memory_budget_, cluster,
+                         &memory, &optimized_item, &skip_list)) {
           // Reset the inferred memory usage since the graph changed.
           memory.reset();
           updated_graph = true;
@@ -1438,6 +1577,16 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     }
   }
 
+  GraphMemory::MemoryUsage peak_usage_after;
+  if (has_peak_usage_before &&
+      EstimatePeakMemoryUsage(cluster, optimized_item, &peak_usage_after)) {
+    LOG(INFO) << "Estimated peak memory usage of " << item.id << ": "
+              << peak_usage_before.used_memory << " bytes before and "
+              << peak_usage_after.used_memory
+              << " bytes after memory optimization, for a budget of "
+              << peak_memory_budget_ << " bytes";
+  }
+
   optimized_graph->Swap(&optimized_item.graph);
   return Status::OK();
 }
@@ -448,6 +448,42 @@ TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   }
 }
 
+TEST_F(MemoryOptimizerTest, RecomputationPeakMemoryBudget) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
+                               {128, 128, 8}, DT_FLOAT);
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/cpu:0"), a);
+  Output c = ops::Exp(s.WithOpName("c").WithDevice("/cpu:0"), b);
+  Output d = ops::Mul(s.WithOpName("gradients/d").WithDevice("/cpu:0"), c, b);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/d"};
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // The graph already fits in the budget, so nothing is recomputed.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                              "gradients/", /*peak_memory_budget=*/1 << 30);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    NodeMap node_map(&output);
+    EXPECT_EQ(nullptr, node_map.GetNode("Recomputed/b"));
+    EXPECT_EQ("b", node_map.GetNode("gradients/d")->input(1));
+  }
+
+  // Recomputing b frees it before gradients/d runs.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                              "gradients/", /*peak_memory_budget=*/1);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    NodeMap node_map(&output);
+    EXPECT_NE(nullptr, node_map.GetNode("Recomputed/b"));
+    EXPECT_EQ("Recomputed/b", node_map.GetNode("gradients/d")->input(1));
+  }
+}
+
 class RelaxAllocatorConstraintsTest : public GrapplerTest {};
 
 TEST_F(RelaxAllocatorConstraintsTest, SameDevice) {
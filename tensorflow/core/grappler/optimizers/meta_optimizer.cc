@@ -41,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
@@ -51,8 +52,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -152,6 +159,39 @@ bool IsXlaGlobalJitOn(
 }
 
 // A helper function to decide whether to enable the memory optimizer.
+// Returns a fingerprint of everything that optimizing the body of `func`
+// depends on: the function and the functions it can call, the options of the
+// function item, the Grappler configuration, the devices of the cluster and
+// the TensorFlow build.
+uint64 OptimizedFunctionKey(const FunctionDef& func,
+                            const FunctionLibraryDefinition& flib,
+                            bool allow_non_differentiable_rewrites,
+                            int producer, const ConfigProto& config,
+                            const Cluster* cluster) {
+  uint64 key = Hash64(tf_git_version());
+  key = DeterministicProtoHash64(func, key);
+  const FunctionLibraryDefinition reachable = flib.ReachableDefinitions(func);
+  std::vector<string> reachable_names = reachable.ListFunctionNames();
+  std::sort(reachable_names.begin(), reachable_names.end());
+  for (const string& name : reachable_names) {
+    key = DeterministicProtoHash64(*reachable.Find(name), key);
+  }
+  key = Hash64Combine(key, allow_non_differentiable_rewrites);
+  key = Hash64Combine(key, producer);
+  key = DeterministicProtoHash64(config, key);
+  if (cluster != nullptr) {
+    const auto& devices = cluster->GetDevices();
+    std::vector<string> device_names;
+    for (const auto& device : devices) device_names.push_back(device.first);
+    std::sort(device_names.begin(), device_names.end());
+    for (const string& name : device_names) {
+      key = Hash64(name.data(), name.size(), key);
+      key = DeterministicProtoHash64(devices.at(name), key);
+    }
+  }
+  return key;
+}
+
 bool MemoryOptimizerEnabled(
     RewriterConfig::MemOptType mem_opt_type,
     OptimizerOptions::GlobalJitLevel jit_level_in_session_opts) {
@@ -290,11 +330,14 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->push_back(
           // Use the default target node name prefix "gradients/"
-          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization()));
+          MakeUnique<MemoryOptimizer>(
+              cfg_.memory_optimization(), "gradients/",
+              cfg_.memory_optimizer_peak_memory_budget()));
     } else {
       optimizers->push_back(MakeUnique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_peak_memory_budget()));
     }
   }
   if (cfg_.auto_parallel().enable()) {
@@ -397,13 +440,15 @@ void MetaOptimizer::InitializeVerifiers(
 }
 
 Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                                    GraphDef* optimized_graph) {
+                                    GraphDef* optimized_graph,
+                                    bool* all_optimizers_succeeded) {
+  if (all_optimizers_succeeded != nullptr) *all_optimizers_succeeded = true;
   int min_graph_nodes = cfg_.min_graph_nodes() == 0 ? kDefaultMinGraphNodes
                                                     : cfg_.min_graph_nodes();
   if (item.graph.node_size() < min_graph_nodes) {
     VLOG(3) << "Skipping optimization, graph has less than " << min_graph_nodes
             << " nodes.";
-    *optimized_graph = item.graph;
+    optimized_graph->Swap(&item.graph);
     return Status::OK();
   }
 
@@ -439,7 +484,7 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
 
   if (optimizers.empty()) {
     VLOG(3) << "Skipping graph optimization, no optimizers registered";
-    *optimized_graph = item.graph;
+    optimized_graph->Swap(&item.graph);
     return Status::OK();
   }
 
@@ -528,8 +573,19 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
                                      return result.status.ok();
                                    }) != optimization_result.results.end();
 
+  if (all_optimizers_succeeded != nullptr) {
+    *all_optimizers_succeeded =
+        absl::c_all_of(optimization_result.results,
+                       [](const OptimizerResult& result) {
+                         return result.status.ok();
+                       });
+  }
+
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(mu_);
+    optimization_results_.push_back(std::move(optimization_result));
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -572,6 +628,12 @@ Status MetaOptimizer::RunOptimizer(
   const uint64 end_us = Env::Default()->NowMicros();
   const float duration_ms = (end_us - start_us) / 1000.0f;
   metrics::UpdateGrapplerPassTime(optimizer->name(), end_us - start_us);
+  {
+    mutex_lock l(mu_);
+    PassTiming& timing = pass_timings_[optimizer->name()];
+    ++timing.num_runs;
+    timing.total_us += end_us - start_us;
+  }
 
   string message;
   if (!status.ok()) {
@@ -616,7 +678,11 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   const uint64 start_us = Env::Default()->NowMicros();
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock l(mu_);
+    optimization_results_.clear();
+    pass_timings_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -696,15 +762,19 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
     find_xla_compiled_functions(function.node_def());
   }
 
+  // Optimized function bodies are memoized across calls if enabled.
+  const bool is_tpu_graph = IsTPUGraphDef(*optimized_graph);
+  OptimizedFunctionCache* function_cache =
+      is_tpu_graph ? nullptr : OptimizedFunctionCache::Global();
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    // Collect the functions to optimize in this pass, in library order.
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -723,97 +793,81 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // Skip tf.data functions as they are optimized by tf.data meta optimizer.
       if (IsTFDataFunction(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
-
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
-
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
-      }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (IsTPUGraphDef(*optimized_graph)) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        FunctionDefLibrary func_item_function_library;
-        func_item_function_library.Swap(func_item.graph.mutable_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+      funcs.push_back(&func);
+    }
+    if (funcs.empty()) break;
+
+    // Function bodies are independent of each other, so optimize them
+    // concurrently against the library as of the start of this pass. The
+    // results do not depend on the order in which the functions finish.
+    std::vector<Status> statuses(funcs.size());
+    std::vector<FunctionDefLibrary> results(funcs.size());
+    const auto optimize_function = [&](int i) {
+      const FunctionDef& func = *funcs[i];
+      const string& func_name = func.signature().name();
+      VLOG(3) << "Optimize function: function=" << func_name << " [" << i
+              << " of " << funcs.size() << "]";
+      statuses[i] = [&]() -> Status {
+        GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+        // If we need to compute the gradient of optimized function at
+        // runtime, we can't perform non-differentiable rewrites.
+        const bool allow_non_differentiable_rewrites =
+            !differentiable_functions.contains(func_name);
+        return OptimizeFunction(cluster, func, flib, producer,
+                                allow_non_differentiable_rewrites,
+                                is_tpu_graph, function_cache, &results[i]);
+      }();
+    };
+    const int num_threads =
+        std::min<int>(port::MaxParallelism(), funcs.size());
+    if (num_threads > 1) {
+      thread::ThreadPool pool(Env::Default(), "grappler_functions",
+                              num_threads);
+      BlockingCounter counter(funcs.size());
+      for (int i = 0; i < funcs.size(); ++i) {
+        pool.Schedule([&, i]() {
+          optimize_function(i);
+          counter.DecrementCount();
+        });
       }
+      counter.Wait();
+    } else {
+      for (int i = 0; i < funcs.size(); ++i) optimize_function(i);
+    }
 
+    // Apply the results in library order, so that the optimized library does
+    // not depend on the number of threads.
+    for (int i = 0; i < funcs.size(); ++i) {
+      TF_RETURN_IF_ERROR(statuses[i]);
+      const FunctionDefLibrary& optimized = results[i];
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
+      for (int j = 1; j < optimized.function_size(); ++j) {
+        const FunctionDef& func_def = optimized.function(j);
         if (flib.Find(func_def.signature().name()) == nullptr) {
           TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
         }
       }
-
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
       // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      TF_RETURN_IF_ERROR(flib.ReplaceFunction(funcs[i]->signature().name(),
+                                              optimized.function(0)));
     }
 
-    // If optimized at least one function, update the graph library.
-    if (optimize_function_library) {
-      *optimized_graph->mutable_library() = flib.ToProto();
-    }
+    // Update the graph library. This invalidates `funcs`.
+    *optimized_graph->mutable_library() = flib.ToProto();
   }
 
   VLOG(1) << "Optimized " << optimized_funcs.size()
           << " functions: " << absl::StrJoin(optimized_funcs, ", ");
+  if (function_cache != nullptr) {
+    VLOG(1) << "Optimized function cache: " << function_cache->num_hits()
+            << " hits, " << function_cache->num_misses() << " misses";
+  }
+  LogPassTimings();
   VLOG(3) << "Optimized graph =\n" << optimized_graph->DebugString();
   if (VLOG_IS_ON(1)) {
     DumpGraphDefToFile(
@@ -828,8 +882,134 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   return Status::OK();
 }
 
+Status MetaOptimizer::OptimizeFunction(
+    Cluster* cluster, const FunctionDef& func,
+    const FunctionLibraryDefinition& flib, int producer,
+    bool allow_non_differentiable_rewrites, bool is_tpu_graph,
+    OptimizedFunctionCache* function_cache, FunctionDefLibrary* optimized) {
+  const string& func_name = func.signature().name();
+
+  // Reuse the result of a previous optimization of the same function in the
+  // same context.
+  uint64 cache_key = 0;
+  if (function_cache != nullptr) {
+    cache_key =
+        OptimizedFunctionKey(func, flib, allow_non_differentiable_rewrites,
+                             producer, config_proto_, cluster);
+    if (function_cache->Lookup(cache_key, optimized)) {
+      VLOG(3) << "Reuse optimized function: function=" << func_name;
+      return Status::OK();
+    }
+  }
+
+  // Make a GrapplerItem from a FunctionDef.
+  GrapplerFunctionItem func_item;
+  TF_RETURN_IF_ERROR(
+      MakeGrapplerFunctionItem(func, flib, producer, &func_item));
+
+  func_item.optimization_options().allow_non_differentiable_rewrites =
+      allow_non_differentiable_rewrites;
+
+  // Device set available to the function is defined only by the runtime,
+  // when we instantiate and execute the function. We can't use all devices
+  // available to the main graph, because after partitioning the function
+  // call node might execute on a remote worker.
+  if (!func_item.devices().empty()) {
+    return errors::Internal("GrapplerFunctionItem devices must be empty.");
+  }
+
+  // We are not allowed to prune certain types of ops from the graph
+  // instantiated by the function definition, because we must guarantee
+  // function execution semantics wrt side effects (see
+  // function_optimizer.cc).
+  func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
+      false;
+
+  // Optimize function body graph.
+  GraphDef optimized_func_graph;
+  bool all_optimizers_succeeded = true;
+  if (is_tpu_graph) {
+    // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+    // passes do not handle TPU functions correctly in a variety of ways
+    // (Note that due to the pre-placement TPU graph rewriting passes, the
+    // TPU-related ops are encapsulated away into functions). For example,
+    // TPU graphs contain TPUReplicateMetadata node that carries relevant
+    // TPU metadata and Grappler passes could prune that away. Grappler
+    // passes could also cause issues around shape inference. Since the
+    // desired and existing behavior is to not optimize TPU functions with
+    // Grappler, this check preserves that. The only exception is
+    // implementation selector what is required to swap in some TPU specific
+    // lowering code and is verified the work correctly on TPUs.
+    ImplementationSelector implementation_selector;
+
+    // Implementation selector needs to have access to valid function
+    // signature and attributes, and it doesn't need actual function body.
+    FunctionDefLibrary func_item_function_library;
+    func_item_function_library.Swap(func_item.graph.mutable_library());
+    *func_item.graph.mutable_library() =
+        GetFunctionDefLibraryStub(func_item_function_library);
+
+    TF_RETURN_IF_ERROR(implementation_selector.Optimize(
+        cluster, func_item, &optimized_func_graph));
+  } else {
+    // The function body is replaced by the optimized body below, so it is
+    // moved to the item to optimize instead of copied.
+    GraphDef func_body;
+    func_body.Swap(&func_item.graph);
+    GrapplerFunctionItem func_item_copy = func_item;
+    func_item_copy.graph.Swap(&func_body);
+    TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
+                                     &optimized_func_graph,
+                                     &all_optimizers_succeeded));
+  }
+
+  // The optimized body can only call functions in its own library: the ones
+  // reachable from the original body, and the new specialized functions that
+  // the optimization created for each instantiation context. Only the latter
+  // have to be added to the caller's library.
+  const FunctionLibraryDefinition func_flib(OpRegistry::Global(),
+                                            optimized_func_graph.library());
+  optimized->Clear();
+  FunctionDef* optimized_func = optimized->add_function();
+  for (const FunctionDef& func_def :
+       optimized_func_graph.library().function()) {
+    if (flib.Find(func_def.signature().name()) == nullptr) {
+      *optimized->add_function() = func_def;
+    }
+  }
+
+  // Convert optimized graph back to FunctionDef.
+  func_item.SwapFunctionBody(std::move(optimized_func_graph));
+  TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, func_flib, optimized_func));
+
+  // Only memoize results that no optimizer failed to produce, e.g. by running
+  // out of time.
+  if (function_cache != nullptr && all_optimizers_succeeded) {
+    function_cache->Insert(cache_key, *optimized);
+  }
+  return Status::OK();
+}
+
+void MetaOptimizer::LogPassTimings() const {
+  if (!VLOG_IS_ON(1)) return;
+  mutex_lock l(mu_);
+  std::vector<std::pair<string, PassTiming>> timings(pass_timings_.begin(),
+                                                     pass_timings_.end());
+  std::sort(timings.begin(), timings.end(),
+            [](const std::pair<string, PassTiming>& a,
+               const std::pair<string, PassTiming>& b) {
+              return a.second.total_us > b.second.total_us;
+            });
+  for (const auto& timing : timings) {
+    VLOG(1) << "Grappler pass " << timing.first << ": "
+            << timing.second.total_us / 1000.0f << "ms in "
+            << timing.second.num_runs << " runs";
+  }
+}
+
 string MetaOptimizer::GetResultString() const {
   std::string result_string;
+  mutex_lock l(mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
                     "Optimization results for grappler item: ", graph_result.id,
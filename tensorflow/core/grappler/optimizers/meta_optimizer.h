@@ -16,14 +16,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_H_
 
+#include <map>
+
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -84,9 +89,22 @@ class MetaOptimizer : public GraphOptimizer {
       const;
 
   // Run optimization pass over a single GrapplerItem. Meta optimizer might run
-  // multiple such passes: 1) for the main graph 2) for the function library
+  // multiple such passes: 1) for the main graph 2) for the function library.
+  // If `all_optimizers_succeeded` is not null, sets it to false if any
+  // optimizer failed. Safe to call concurrently for different items.
   Status OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                       GraphDef* optimized_graph);
+                       GraphDef* optimized_graph,
+                       bool* all_optimizers_succeeded = nullptr);
+
+  // Optimizes the body of `func` without modifying `flib`, and sets
+  // `optimized` to the optimized function followed by the functions that the
+  // optimization added to the library. Safe to call concurrently.
+  Status OptimizeFunction(Cluster* cluster, const FunctionDef& func,
+                          const FunctionLibraryDefinition& flib, int producer,
+                          bool allow_non_differentiable_rewrites,
+                          bool is_tpu_graph,
+                          OptimizedFunctionCache* function_cache,
+                          FunctionDefLibrary* optimized);
 
   DeviceBase* const cpu_device_;  // may be NULL
   ConfigProto config_proto_;
@@ -108,7 +126,23 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
-  std::vector<GraphOptimizationResult> optimization_results_;
+  // Logs the time spent in each optimizer, summed over the main graph and
+  // the functions.
+  void LogPassTimings() const;
+
+  // Guards the results below, which are updated by the concurrent
+  // optimizations of the function library.
+  mutable mutex mu_;
+
+  std::vector<GraphOptimizationResult> optimization_results_
+      TF_GUARDED_BY(mu_);
+
+  struct PassTiming {
+    int num_runs = 0;
+    uint64 total_us = 0;
+  };
+  // Time spent in each optimizer by the current OptimizeConsumeItem call.
+  std::map<string, PassTiming> pass_timings_ TF_GUARDED_BY(mu_);
 };
 
 bool MetaOptimizerEnabled(const ConfigProto& cfg);
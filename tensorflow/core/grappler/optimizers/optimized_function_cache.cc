@@ -0,0 +1,148 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
+
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+constexpr int64 kDefaultMaxBytes = 256 << 20;
+}  // namespace
+
+OptimizedFunctionCache::OptimizedFunctionCache(const string& cache_dir,
+                                               int64 max_bytes)
+    : cache_dir_(cache_dir), max_bytes_(max_bytes) {}
+
+OptimizedFunctionCache* OptimizedFunctionCache::Global() {
+  static OptimizedFunctionCache* cache = []() -> OptimizedFunctionCache* {
+    bool enabled = false;
+    string cache_dir;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_GRAPPLER_FUNCTION_CACHE",
+                                   /*default_val=*/false, &enabled));
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_FUNCTION_CACHE_DIR",
+                                     /*default_val=*/"", &cache_dir));
+    if (!cache_dir.empty()) {
+      Status status = Env::Default()->RecursivelyCreateDir(cache_dir);
+      if (!status.ok()) {
+        LOG(WARNING) << "Not persisting optimized functions to " << cache_dir
+                     << ": " << status;
+        cache_dir.clear();
+      } else {
+        enabled = true;
+      }
+    }
+    if (!enabled) return nullptr;
+    return new OptimizedFunctionCache(cache_dir, kDefaultMaxBytes);
+  }();
+  return cache;
+}
+
+bool OptimizedFunctionCache::Lookup(uint64 key,
+                                    FunctionDefLibrary* optimized) {
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      *optimized = it->second;
+      ++num_hits_;
+      return true;
+    }
+  }
+
+  if (!cache_dir_.empty()) {
+    const string file_name = FileName(key);
+    Env* env = Env::Default();
+    if (env->FileExists(file_name).ok()) {
+      Status status = ReadBinaryProto(env, file_name, optimized);
+      if (status.ok()) {
+        mutex_lock l(mu_);
+        InsertInMemory(key, *optimized);
+        ++num_hits_;
+        return true;
+      }
+      LOG(WARNING) << "Failed to read optimized function from " << file_name
+                   << ": " << status;
+    }
+  }
+
+  mutex_lock l(mu_);
+  ++num_misses_;
+  return false;
+}
+
+void OptimizedFunctionCache::Insert(uint64 key,
+                                    const FunctionDefLibrary& optimized) {
+  {
+    mutex_lock l(mu_);
+    if (entries_.contains(key)) return;
+    InsertInMemory(key, optimized);
+  }
+
+  if (!cache_dir_.empty()) {
+    // Write to a temporary file first, so that concurrent readers in other
+    // processes never see a partial entry.
+    Env* env = Env::Default();
+    const string file_name = FileName(key);
+    string tmp_name;
+    if (!env->LocalTempFilename(&tmp_name)) return;
+    tmp_name = io::JoinPath(cache_dir_, io::Basename(tmp_name));
+    Status status = WriteBinaryProto(env, tmp_name, optimized);
+    if (status.ok()) status = env->RenameFile(tmp_name, file_name);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to write optimized function to " << file_name
+                   << ": " << status;
+      env->DeleteFile(tmp_name).IgnoreError();
+    }
+  }
+}
+
+int64 OptimizedFunctionCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64 OptimizedFunctionCache::num_misses() const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
+string OptimizedFunctionCache::FileName(uint64 key) const {
+  return io::JoinPath(cache_dir_, absl::StrFormat("%016x.pb", key));
+}
+
+void OptimizedFunctionCache::InsertInMemory(
+    uint64 key, const FunctionDefLibrary& optimized) {
+  const int64 size = optimized.ByteSizeLong();
+  if (size > max_bytes_ || entries_.contains(key)) return;
+  while (bytes_ + size > max_bytes_ && !insertion_order_.empty()) {
+    auto it = entries_.find(insertion_order_.front());
+    bytes_ -= it->second.ByteSizeLong();
+    entries_.erase(it);
+    insertion_order_.pop_front();
+  }
+  entries_.emplace(key, optimized);
+  insertion_order_.push_back(key);
+  bytes_ += size;
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,84 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_FUNCTION_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_FUNCTION_CACHE_H_
+
+#include <deque>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Memoizes the function bodies optimized by the MetaOptimizer, so that
+// optimizing a graph whose function library is mostly unchanged (e.g. a model
+// with a newly added signature) only optimizes the new or changed functions.
+//
+// Entries are keyed by a fingerprint of everything the optimization depends
+// on, computed by the caller. Each entry is a FunctionDefLibrary holding the
+// optimized function first, followed by the functions that optimizing it
+// added to the library.
+//
+// The cache keeps at most `max_bytes` of entries in memory, evicting the
+// oldest first. If `cache_dir` is not empty, entries are also written there,
+// one file per key, and are read back on a miss, so that they survive across
+// processes.
+class OptimizedFunctionCache {
+ public:
+  OptimizedFunctionCache(const string& cache_dir, int64 max_bytes);
+
+  // Returns the process-wide cache, or nullptr if caching is disabled. It is
+  // enabled by setting TF_GRAPPLER_FUNCTION_CACHE=1, and made persistent by
+  // setting TF_GRAPPLER_FUNCTION_CACHE_DIR to a directory.
+  static OptimizedFunctionCache* Global();
+
+  // Returns true and sets `optimized` if there is an entry for `key`.
+  bool Lookup(uint64 key, FunctionDefLibrary* optimized);
+
+  void Insert(uint64 key, const FunctionDefLibrary& optimized);
+
+  int64 num_hits() const;
+  int64 num_misses() const;
+
+ private:
+  string FileName(uint64 key) const;
+  void InsertInMemory(uint64 key, const FunctionDefLibrary& optimized)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const string cache_dir_;
+  const int64 max_bytes_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<uint64, FunctionDefLibrary> entries_ TF_GUARDED_BY(mu_);
+  // Keys in insertion order, for eviction.
+  std::deque<uint64> insertion_order_ TF_GUARDED_BY(mu_);
+  int64 bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(OptimizedFunctionCache);
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_FUNCTION_CACHE_H_
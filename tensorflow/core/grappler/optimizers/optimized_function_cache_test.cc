@@ -0,0 +1,91 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+FunctionDefLibrary MakeEntry(const string& name, int num_nodes) {
+  FunctionDefLibrary library;
+  FunctionDef* func = library.add_function();
+  func->mutable_signature()->set_name(name);
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = func->add_node_def();
+    node->set_name(strings::StrCat("node_", i));
+    node->set_op("NoOp");
+  }
+  return library;
+}
+
+TEST(OptimizedFunctionCacheTest, LookupAndInsert) {
+  OptimizedFunctionCache cache(/*cache_dir=*/"", /*max_bytes=*/1 << 20);
+  FunctionDefLibrary found;
+  EXPECT_FALSE(cache.Lookup(1, &found));
+
+  cache.Insert(1, MakeEntry("f", 2));
+  ASSERT_TRUE(cache.Lookup(1, &found));
+  ASSERT_EQ(found.function_size(), 1);
+  EXPECT_EQ(found.function(0).signature().name(), "f");
+  EXPECT_EQ(found.function(0).node_def_size(), 2);
+  EXPECT_FALSE(cache.Lookup(2, &found));
+
+  EXPECT_EQ(cache.num_hits(), 1);
+  EXPECT_EQ(cache.num_misses(), 2);
+}
+
+TEST(OptimizedFunctionCacheTest, EvictsOldestEntries) {
+  const FunctionDefLibrary entry = MakeEntry("f", 10);
+  const int64 entry_bytes = entry.ByteSizeLong();
+  OptimizedFunctionCache cache(/*cache_dir=*/"", 3 * entry_bytes);
+  for (uint64 key = 0; key < 5; ++key) cache.Insert(key, entry);
+
+  FunctionDefLibrary found;
+  EXPECT_FALSE(cache.Lookup(0, &found));
+  EXPECT_FALSE(cache.Lookup(1, &found));
+  EXPECT_TRUE(cache.Lookup(2, &found));
+  EXPECT_TRUE(cache.Lookup(3, &found));
+  EXPECT_TRUE(cache.Lookup(4, &found));
+}
+
+TEST(OptimizedFunctionCacheTest, PersistsAcrossInstances) {
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "optimized_function_cache");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(cache_dir));
+
+  {
+    OptimizedFunctionCache cache(cache_dir, /*max_bytes=*/1 << 20);
+    cache.Insert(42, MakeEntry("g", 3));
+  }
+
+  OptimizedFunctionCache cache(cache_dir, /*max_bytes=*/1 << 20);
+  FunctionDefLibrary found;
+  ASSERT_TRUE(cache.Lookup(42, &found));
+  ASSERT_EQ(found.function_size(), 1);
+  EXPECT_EQ(found.function(0).signature().name(), "g");
+  EXPECT_EQ(found.function(0).node_def_size(), 3);
+  EXPECT_FALSE(cache.Lookup(43, &found));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
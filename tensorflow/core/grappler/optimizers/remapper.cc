@@ -16,8 +16,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -56,31 +62,107 @@ namespace grappler {
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
+// Gather + SparseSegment{Sum,Mean,SqrtN}[WithNumSegments]:
+//   (1) SparseSegmentX(Gather(params, ids), indices, segment_ids)
+//       -> SparseSegmentX(params, Gather(ids, indices), segment_ids)
+//
+//   This is the embedding_lookup_sparse pattern. SparseSegmentX already
+//   gathers the rows it reduces, so the rewrite avoids materializing the
+//   gathered embeddings in memory.
+//
+// Gather + Squeeze + Where -> _MaskedGather:
+//   (1) Gather(params, Squeeze(Where(mask), [1])) -> _MaskedGather(params, mask)
+//
+//   Boolean masking of rows, as in tf.boolean_mask. The fused kernel copies
+//   the selected rows without materializing their int64 indices.
+//
+// MatMul with constant pruned weights -> _BlockSparseMatMul:
+//   (1) MatMul(a, Const) -> _BlockSparseMatMul(a, values, indices, row_ptr)
+//
+//   Applies when most blocks of the weights are all zero, as in magnitude
+//   pruned models. Only the nonzero blocks are stored and multiplied.
+//
 // Both Conv2D and MatMul implemented as Tensor contraction (on CPU), so all the
 // patterns are "ContractionWith...".
+//
+// Where fusion is a trade-off, the choice is made with the analytical per-op
+// cost model (OpLevelCostEstimator) on the cluster's devices: an elementwise
+// producer with several consumers is recomputed inside each _FusedElementwise
+// only if that is estimated to be cheaper than materializing it. With
+// --vmodule=remapper=1, the estimated savings of every fusion are logged.
 namespace {
 
 constexpr char kFusedConv2D[] = "_FusedConv2D";
 constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
+constexpr char kMaskedGather[] = "_MaskedGather";
+constexpr char kBlockSparseMatMul[] = "_BlockSparseMatMul";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
 
 constexpr int kMissingIndex = -1;
 
+// Largest number of ops fused into a single _FusedElementwise node.
+constexpr int kMaxFusedElementwiseOps = 16;
+
+// Fixed cost of running one op in the executor, which fusion saves in addition
+// to the memory traffic of the intermediate results.
+constexpr double kOpOverheadNs = 1000;
+
+// Block shapes, [block_k, block_n], tried in turn for the weights of a
+// _BlockSparseMatMul. Wider blocks make better use of SIMD registers.
+constexpr int kBlockSparseShapes[][2] = {
+    {8, 16}, {4, 16}, {1, 16}, {4, 8}, {1, 8}};
+
+// Constant MatMul weights with at least this many elements are stored
+// block-sparse if at most kMaxBlockSparseDensity of their blocks are nonzero.
+constexpr int64 kMinBlockSparseWeights = 64 * 64;
+constexpr float kMaxBlockSparseDensity = 0.3f;
+
+// Exposes the cost of fused ops.
+class FusionCostEstimator : public OpLevelCostEstimator {
+ public:
+  using OpLevelCostEstimator::PredictFusedOp;
+};
+
+// Estimated run time of a fused op and of the ops it replaces.
+struct FusionEstimate {
+  string fused_op;
+  string root;
+  int num_ops = 0;
+  // False if the shapes were not inferred.
+  bool has_estimate = false;
+  double unfused_ns = 0;
+  double fused_ns = 0;
+};
+
 struct RemapperContext {
-  explicit RemapperContext(GrapplerItem* item, Status* status)
+  explicit RemapperContext(GrapplerItem* item, Cluster* cluster,
+                           Status* status)
       : nodes_to_preserve(item->NodesToPreserve()),
         graph_view(&item->graph, status),
         graph_properties(*item),
-        inferred_graph_properties(false) {}
+        inferred_graph_properties(false),
+        cluster(cluster) {}
 
   std::unordered_set<string> nodes_to_preserve;
   utils::MutableGraphView graph_view;
   GraphProperties graph_properties;
   bool inferred_graph_properties;
+
+  Cluster* cluster;  // may be null
+  FusionCostEstimator cost_estimator;
+  // Properties of the devices that nodes are placed on, by device name.
+  mutable std::unordered_map<string, DeviceProperties> device_properties;
+
+  // Nodes that some fused op recomputes instead of reading their output. They
+  // are removed once all their consumers are.
+  absl::flat_hash_set<int> recomputed_nodes;
+  // Fusions performed so far, for the savings report.
+  std::vector<FusionEstimate> fusions;
 };
 
 // FusedBatchNorm that can be replaced with a cheaper set of primitives.
@@ -103,6 +185,57 @@ struct FusedBatchNormEx {
   int invalidated = kMissingIndex;
 };
 
+// Gather (optionally followed by an Identity) feeding the data input of a
+// SparseSegment reduction.
+struct SparseSegmentWithGather {
+  SparseSegmentWithGather() = default;
+
+  int sparse_segment = kMissingIndex;
+  int identity = kMissingIndex;
+  int gather = kMissingIndex;
+};
+
+// Gather of the rows selected by a boolean mask:
+// Gather(params, Squeeze(Where(mask))).
+struct MaskedGather {
+  MaskedGather() = default;
+
+  int gather = kMissingIndex;
+  int squeeze = kMissingIndex;
+  int where = kMissingIndex;
+};
+
+// MatMul with constant weights that are mostly zero blocks, and the
+// block-sparse form of the weights (see the _BlockSparseMatMul op).
+struct BlockSparseMatMul {
+  BlockSparseMatMul() = default;
+
+  int matmul = kMissingIndex;
+  int weights = kMissingIndex;
+  // True if the MatMul is the only consumer of the weights.
+  bool delete_weights = false;
+  Tensor block_values;
+  Tensor block_indices;
+  Tensor block_row_ptr;
+};
+
+// Tree of unary and binary elementwise ops with a single output, evaluated by
+// one _FusedElementwise node that takes the place of the root.
+struct FusedElementwise {
+  FusedElementwise() = default;
+
+  int root = kMissingIndex;
+  // Nodes other than the root whose only consumer is in the tree.
+  std::vector<int> fused_nodes;
+  // Nodes with other consumers that the tree evaluates again.
+  std::vector<int> recomputed_nodes;
+  // Tensors read from outside the tree, and the program over them (see the
+  // _FusedElementwise op).
+  std::vector<string> args;
+  std::vector<string> op_names;
+  std::vector<int> operands;
+};
+
 // Contraction node followed by a BiasAdd.
 struct ContractionWithBiasAdd {
   ContractionWithBiasAdd() = default;
@@ -385,6 +518,151 @@ inline bool HasAtMostOneDataFanoutAtPort0(
   return absl::c_count_if(node_view.GetRegularFanout(0), predicate) <= 1;
 }
 
+// Returns the properties of the device that `node` is placed on, as known to
+// the cluster, or else those of the local device of the same type.
+const DeviceProperties& GetDeviceProperties(const RemapperContext& ctx,
+                                            const NodeDef& node) {
+  auto it = ctx.device_properties.find(node.device());
+  if (it != ctx.device_properties.end()) return it->second;
+
+  // The cost estimator only models CPUs, and GPUs of a known architecture.
+  const auto is_supported = [](const DeviceProperties& device) -> bool {
+    return device.type() == "CPU" ||
+           (device.type() == "GPU" &&
+            device.environment().count("architecture") > 0);
+  };
+  DeviceProperties device;
+  if (ctx.cluster != nullptr) {
+    const auto& devices = ctx.cluster->GetDevices();
+    auto device_it = devices.find(node.device());
+    if (device_it != devices.end()) device = device_it->second;
+  }
+  if (!is_supported(device)) device = GetDeviceInfo(node.device());
+  if (!is_supported(device)) device = GetLocalCPUInfo();
+  return ctx.device_properties.emplace(node.device(), std::move(device))
+      .first->second;
+}
+
+OpContext MakeOpContext(const RemapperContext& ctx, const NodeDef& node) {
+  OpContext op_context;
+  op_context.name = node.name();
+  op_context.device_name = node.device();
+  OpInfo& op_info = op_context.op_info;
+  op_info.set_op(node.op());
+  *op_info.mutable_attr() = node.attr();
+  for (const auto& input :
+       ctx.graph_properties.GetInputProperties(node.name())) {
+    *op_info.add_inputs() = input;
+  }
+  for (const auto& output :
+       ctx.graph_properties.GetOutputProperties(node.name())) {
+    *op_info.add_outputs() = output;
+  }
+  *op_info.mutable_device() = GetDeviceProperties(ctx, node);
+  return op_context;
+}
+
+// Returns the size of a tensor in bytes, or -1 if its shape is unknown.
+double TensorBytes(const OpInfo::TensorProperties& tensor) {
+  const int64 num_elements = PartialTensorShape(tensor.shape()).num_elements();
+  if (num_elements < 0) return -1;
+  return static_cast<double>(num_elements) * DataTypeSize(tensor.dtype());
+}
+
+// Estimates the run time of the node `root` fused with the nodes `removed`,
+// that the fusion deletes, and `recomputed`, that stay in the graph for other
+// consumers, against the run time of `root` and `removed` on their own.
+FusionEstimate EstimateFusion(const RemapperContext& ctx,
+                              absl::string_view fused_op, int root,
+                              const std::vector<int>& removed,
+                              const std::vector<int>& recomputed) {
+  FusionEstimate estimate;
+  estimate.fused_op = string(fused_op);
+  estimate.root = ctx.graph_view.GetNode(root)->GetName();
+  estimate.num_ops = 1 + removed.size() + recomputed.size();
+  if (!ctx.inferred_graph_properties) return estimate;
+
+  std::vector<int> nodes = {root};
+  nodes.insert(nodes.end(), removed.begin(), removed.end());
+  absl::flat_hash_set<absl::string_view> node_names;
+  for (int node : nodes) {
+    node_names.insert(ctx.graph_view.GetNode(node)->GetName());
+  }
+  for (int node : recomputed) {
+    node_names.insert(ctx.graph_view.GetNode(node)->GetName());
+  }
+
+  // The fused op reads the inputs that no fused node produces, and produces
+  // the outputs of the root.
+  OpContext fused = MakeOpContext(ctx, *ctx.graph_view.GetNode(root)->node());
+  fused.op_info.set_op(string(fused_op));
+  fused.op_info.clear_inputs();
+  std::vector<OpContext> fused_nodes;
+  const auto add_fused_node = [&](int node) -> OpContext* {
+    const NodeDef* node_def = ctx.graph_view.GetNode(node)->node();
+    fused_nodes.push_back(MakeOpContext(ctx, *node_def));
+    const OpInfo& op_info = fused_nodes.back().op_info;
+    for (int k = 0; k < op_info.inputs_size() && k < node_def->input_size();
+         ++k) {
+      if (!node_names.contains(ParseTensorName(node_def->input(k)).node())) {
+        *fused.op_info.add_inputs() = op_info.inputs(k);
+      }
+    }
+    return &fused_nodes.back();
+  };
+
+  for (int node : nodes) {
+    const OpContext* op_context = add_fused_node(node);
+    estimate.unfused_ns +=
+        kOpOverheadNs +
+        ctx.cost_estimator.PredictCosts(*op_context).execution_time.count();
+  }
+  for (int node : recomputed) add_fused_node(node);
+  estimate.fused_ns =
+      kOpOverheadNs +
+      ctx.cost_estimator.PredictFusedOp(fused, fused_nodes)
+          .execution_time.count();
+  estimate.has_estimate = true;
+  return estimate;
+}
+
+// Records the estimated savings of a fusion for the report, if it is logged.
+void RecordFusion(RemapperContext* ctx, absl::string_view fused_op, int root,
+                  const std::vector<int>& removed,
+                  const std::vector<int>& recomputed = {}) {
+  if (!VLOG_IS_ON(1)) return;
+  ctx->fusions.push_back(
+      EstimateFusion(*ctx, fused_op, root, removed, recomputed));
+}
+
+void LogFusionReport(const RemapperContext& ctx) {
+  if (ctx.fusions.empty()) return;
+  string report = "Remapper fusions, estimated time before -> after:";
+  double total_saved_ns = 0;
+  for (const FusionEstimate& fusion : ctx.fusions) {
+    absl::StrAppend(&report, "\n  ", fusion.fused_op, " ", fusion.root, " (",
+                    fusion.num_ops, " ops): ");
+    if (!fusion.has_estimate) {
+      absl::StrAppend(&report, "unknown shapes");
+      continue;
+    }
+    const double saved_ns = fusion.unfused_ns - fusion.fused_ns;
+    total_saved_ns += saved_ns;
+    absl::StrAppendFormat(&report, "%.2fus -> %.2fus, saves %.2fus",
+                          fusion.unfused_ns / 1e3, fusion.fused_ns / 1e3,
+                          saved_ns / 1e3);
+  }
+  absl::StrAppendFormat(&report, "\n  Total estimated savings: %.2fus",
+                        total_saved_ns / 1e3);
+  VLOG(1) << report;
+}
+
+const char* FusedContractionOp(const NodeDef& contraction) {
+  if (IsConv2D(contraction)) return kFusedConv2D;
+  if (IsDepthwiseConv2dNative(contraction)) return kFusedDepthwiseConv2dNative;
+  return kFusedMatMul;
+}
+
 bool FindContractionWithBias(const RemapperContext& ctx, int node_index,
                              ContractionWithBiasAdd* matched,
                              bool check_device_compatible = true) {
@@ -1553,6 +1831,655 @@ Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
   return mutation->Apply();
 }
 
+bool IsSparseSegmentReduction(const NodeDef& node) {
+  static const auto* kOps = new absl::flat_hash_set<string>(
+      {"SparseSegmentSum", "SparseSegmentMean", "SparseSegmentSqrtN",
+       "SparseSegmentSumWithNumSegments", "SparseSegmentMeanWithNumSegments",
+       "SparseSegmentSqrtNWithNumSegments"});
+  return kOps->contains(node.op());
+}
+
+bool FindSparseSegmentWithGather(const RemapperContext& ctx, int node_index,
+                                 SparseSegmentWithGather* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsSparseSegmentReduction(*node_def)) return false;
+  if (HasControlFaninOrFanout(*node_view)) return false;
+  if (node_view->NumRegularFanins() < 3) return false;
+
+  // Input to the SparseSegment reduction must be a Gather, possibly through a
+  // single Identity. The gathered tensor must have no other consumers.
+  const utils::MutableNodeView* data_view =
+      node_view->GetRegularFanin(0).node_view();
+  const utils::MutableNodeView* identity_view = nullptr;
+  if (IsIdentity(*data_view->node())) {
+    identity_view = data_view;
+    if (HasControlFaninOrFanout(*identity_view) ||
+        !HasAtMostOneFanoutAtPort0(*identity_view) ||
+        IsInPreserveSet(ctx, identity_view->node()) ||
+        identity_view->NumRegularFanins() < 1) {
+      return false;
+    }
+    data_view = identity_view->GetRegularFanin(0).node_view();
+  }
+
+  const auto* gather_def = data_view->node();
+  if (!IsGather(*gather_def)) return false;
+  if (HasControlFaninOrFanout(*data_view) ||
+      !HasAtMostOneFanoutAtPort0(*data_view) ||
+      IsInPreserveSet(ctx, gather_def)) {
+    return false;
+  }
+
+  if (!HasNodeAttr(*node_def, "Tidx") ||
+      !HasNodeAttr(*gather_def, "Tindices")) {
+    return false;
+  }
+
+  // Only a gather of whole rows can be folded into the segment indices.
+  if (gather_def->op() == "GatherV2") {
+    int batch_dims = 0;
+    if (TryGetNodeAttr(*gather_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0) {
+      return false;
+    }
+    if (data_view->NumRegularFanins() < 3) return false;
+    const auto* axis_def = data_view->GetRegularFanin(2).node_view()->node();
+    if (!IsConstant(*axis_def)) return false;
+    Tensor axis;
+    if (!axis.FromProto(axis_def->attr().at("value").tensor()) ||
+        axis.NumElements() != 1) {
+      return false;
+    }
+    const int64 axis_value = axis.dtype() == DT_INT32
+                                 ? axis.flat<int32>()(0)
+                                 : axis.flat<int64>()(0);
+    if (axis_value != 0) return false;
+  }
+
+  matched->sparse_segment = node_index;
+  matched->identity =
+      identity_view != nullptr ? identity_view->node_index() : kMissingIndex;
+  matched->gather = data_view->node_index();
+
+  return true;
+}
+
+Status AddSparseSegmentWithGatherNodes(RemapperContext* ctx,
+                                       const SparseSegmentWithGather& matched,
+                                       std::vector<bool>* invalidated_nodes,
+                                       std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& sparse_segment = graph->node(matched.sparse_segment);
+  const NodeDef& gather = graph->node(matched.gather);
+  VLOG(2) << "Fuse Gather with " << sparse_segment.op() << ":"
+          << " gather=" << gather.name() << " identity="
+          << (matched.identity != kMissingIndex
+                  ? graph->node(matched.identity).name()
+                  : "<none>")
+          << " sparse_segment=" << sparse_segment.name();
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+
+  // Look up embedding ids for the segment indices: ids[indices].
+  NodeDef axis;
+  axis.set_name(AddPrefixToNodeName("GatherAxis", sparse_segment.name()));
+  axis.set_op("Const");
+  axis.set_device(sparse_segment.device());
+  *axis.add_input() = AsControlDependency(NodeName(gather.input(1)));
+  (*axis.mutable_attr())["dtype"].set_type(DT_INT32);
+  Tensor t(DT_INT32, TensorShape({}));
+  t.scalar<int32>()() = 0;
+  t.AsProtoTensorContent((*axis.mutable_attr())["value"].mutable_tensor());
+
+  NodeDef ids;
+  ids.set_name(AddPrefixToNodeName("GatherIds", sparse_segment.name()));
+  ids.set_op("GatherV2");
+  ids.set_device(sparse_segment.device());
+  *ids.add_input() = gather.input(1);          // params: ids
+  *ids.add_input() = sparse_segment.input(1);  // indices
+  *ids.add_input() = axis.name();              // axis
+  (*ids.mutable_attr())["Tparams"] = gather.attr().at("Tindices");
+  (*ids.mutable_attr())["Tindices"] = sparse_segment.attr().at("Tidx");
+  (*ids.mutable_attr())["Taxis"].set_type(DT_INT32);
+
+  // Reduce rows of params directly, without materializing the gather.
+  NodeDef fused_op = sparse_segment;
+  fused_op.set_input(0, gather.input(0));
+  fused_op.set_input(1, ids.name());
+  (*fused_op.mutable_attr())["Tidx"] = gather.attr().at("Tindices");
+
+  mutation->AddNode(std::move(axis), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(ids), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.sparse_segment] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+  if (matched.identity != kMissingIndex) {
+    (*nodes_to_delete)[matched.identity] = true;
+  }
+
+  return Status::OK();
+}
+
+// Returns the number of inputs of an elementwise op that _FusedElementwise
+// supports, or 0 for any other op.
+int FusibleElementwiseArity(const NodeDef& node) {
+  static const auto* kUnaryOps = new absl::flat_hash_set<string>(
+      {"Abs", "Exp", "Inv", "Log", "Neg", "Reciprocal", "Relu", "Rsqrt",
+       "Sigmoid", "Sqrt", "Square", "Tanh"});
+  static const auto* kBinaryOps = new absl::flat_hash_set<string>(
+      {"Add", "AddV2", "Div", "Maximum", "Minimum", "Mul", "RealDiv",
+       "SquaredDifference", "Sub"});
+  if (kUnaryOps->contains(node.op())) return 1;
+  if (kBinaryOps->contains(node.op())) return 2;
+  return 0;
+}
+
+bool IsFusibleElementwise(const utils::MutableNodeView& node_view) {
+  const NodeDef* node_def = node_view.node();
+  if (FusibleElementwiseArity(*node_def) == 0) return false;
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE) return false;
+  if (!NodeIsOnCpu(node_def) || HasControlFaninOrFanout(node_view)) {
+    return false;
+  }
+  // Leave activations and adds that follow a contraction or a batch norm to
+  // the fusions into those ops.
+  for (int k = 0; k < node_view.NumRegularFanins(); ++k) {
+    const NodeDef* fanin = node_view.GetRegularFanin(k).node_view()->node();
+    if (IsBiasAdd(*fanin) || IsFusedBatchNorm(*fanin) || IsConv2D(*fanin) ||
+        IsDepthwiseConv2dNative(*fanin) || IsMatMul(*fanin)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if `shape`, without its leading dimensions of size 1, is a
+// suffix of `out_shape`, so that _FusedElementwise can broadcast it by
+// repetition.
+bool IsSuffixBroadcast(const TensorShapeProto& shape,
+                       const TensorShapeProto& out_shape) {
+  if (shape.unknown_rank()) return false;
+  int first = 0;
+  while (first < shape.dim_size() && shape.dim(first).size() == 1) ++first;
+  const int offset = out_shape.dim_size() - shape.dim_size();
+  if (shape.dim_size() - first > out_shape.dim_size()) return false;
+  for (int d = first; d < shape.dim_size(); ++d) {
+    if (shape.dim(d).size() < 0 ||
+        shape.dim(d).size() != out_shape.dim(offset + d).size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if every consumer of the elementwise `producer` can evaluate it
+// as part of a _FusedElementwise, and it is estimated to be cheaper for each
+// of them to recompute it from its inputs than to run it once and read its
+// output from memory.
+bool ShouldRecompute(const RemapperContext& ctx,
+                     const utils::MutableNodeView& producer) {
+  const auto& fanouts = producer.GetRegularFanout(0);
+  for (const auto& fanout : fanouts) {
+    if (!IsFusibleElementwise(*fanout.node_view())) return false;
+  }
+  const double num_consumers = fanouts.size();
+
+  const OpContext op_context = MakeOpContext(ctx, *producer.node());
+  const OpInfo& op_info = op_context.op_info;
+  if (op_info.outputs_size() != 1) return false;
+  double input_bytes = 0;
+  for (const auto& input : op_info.inputs()) {
+    const double bytes = TensorBytes(input);
+    if (bytes < 0) return false;
+    input_bytes += bytes;
+  }
+  const double output_bytes = TensorBytes(op_info.outputs(0));
+  if (output_bytes < 0) return false;
+
+  const DeviceInfo device = ctx.cost_estimator.GetDeviceInfo(op_info.device());
+  const auto memory_ns = [&device](double bytes) -> double {
+    return bytes / device.gb_per_sec;
+  };
+  const double compute_ns =
+      ctx.cost_estimator.PredictCosts(op_context).compute_time.count();
+  const double materialized_ns =
+      kOpOverheadNs + compute_ns + memory_ns(input_bytes + output_bytes) +
+      num_consumers * memory_ns(output_bytes);
+  const double recomputed_ns =
+      num_consumers * (compute_ns + memory_ns(input_bytes));
+  VLOG(3) << "Recompute " << producer.node()->name() << " in "
+          << num_consumers << " consumers: " << recomputed_ns
+          << "ns, materialize: " << materialized_ns << "ns";
+  return recomputed_ns < materialized_ns;
+}
+
+bool FindFusedElementwise(const RemapperContext& ctx, int node_index,
+                          FusedElementwise* matched) {
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  const auto* root_def = root_view->node();
+  if (!IsFusibleElementwise(*root_view)) return false;
+  if (!ctx.graph_properties.HasOutputProperties(root_def->name())) {
+    return false;
+  }
+  const auto& root_props =
+      ctx.graph_properties.GetOutputProperties(root_def->name());
+  if (root_props.empty() ||
+      !PartialTensorShape(root_props[0].shape()).IsFullyDefined()) {
+    return false;
+  }
+  const TensorShapeProto& out_shape = root_props[0].shape();
+  const DataType dtype = GetDataTypeFromAttr(*root_def, "T");
+
+  // A producer is fused if it computes a value of the output shape, so that
+  // broadcasts only happen on arguments. It is removed if the tree is its only
+  // consumer, and otherwise recomputed in the tree if the cost model says so.
+  enum class Use { kArgument, kFused, kRecomputed };
+  const auto producer_use = [&](const utils::MutableFanoutView& fanin) -> Use {
+    const auto* fanin_view = fanin.node_view();
+    const auto* fanin_def = fanin_view->node();
+    if (fanin.index() != 0 || !IsFusibleElementwise(*fanin_view)) {
+      return Use::kArgument;
+    }
+    if (GetDataTypeFromAttr(*fanin_def, "T") != dtype ||
+        fanin_def->device() != root_def->device() ||
+        IsInPreserveSet(ctx, fanin_def)) {
+      return Use::kArgument;
+    }
+    const auto& props =
+        ctx.graph_properties.GetOutputProperties(fanin_def->name());
+    if (props.empty() ||
+        !ShapesSymbolicallyEqual(props[0].shape(), out_shape)) {
+      return Use::kArgument;
+    }
+    if (HasAtMostOneFanoutAtPort0(*fanin_view)) return Use::kFused;
+    return ShouldRecompute(ctx, *fanin_view) ? Use::kRecomputed
+                                             : Use::kArgument;
+  };
+
+  // Operands are either arguments or results of earlier instructions.
+  struct Operand {
+    bool is_arg;
+    int index;
+  };
+  FusedElementwise fused;
+  std::vector<Operand> operands;
+  int num_binary_ops = 0;
+
+  // Appends the instructions computing `node_view` to the program, and sets
+  // `*result` to the last one. Returns false if an argument of the node can
+  // not be broadcast to the output. The inputs of recomputed nodes are always
+  // read as arguments, so that only the recomputed nodes have to stay in the
+  // graph for their other consumers.
+  std::function<bool(const utils::MutableNodeView&, bool, Operand*)> emit =
+      [&](const utils::MutableNodeView& node_view, bool fuse_producers,
+          Operand* result) -> bool {
+    const NodeDef* node_def = node_view.node();
+    const int arity = FusibleElementwiseArity(*node_def);
+    if (node_view.NumRegularFanins() != arity) return false;
+    const auto& input_props =
+        ctx.graph_properties.GetInputProperties(node_def->name());
+    if (static_cast<int>(input_props.size()) != arity) return false;
+
+    Operand inputs[2] = {{true, kMissingIndex}, {true, kMissingIndex}};
+    for (int k = 0; k < arity; ++k) {
+      const auto& fanin = node_view.GetRegularFanin(k);
+      const Use use = fuse_producers ? producer_use(fanin) : Use::kArgument;
+      if (use != Use::kArgument) {
+        // Try to fuse the producer, and read it as an argument if one of its
+        // own arguments does not broadcast.
+        const size_t num_ops = fused.op_names.size();
+        const size_t num_args = fused.args.size();
+        const size_t num_fused = fused.fused_nodes.size();
+        const size_t num_recomputed = fused.recomputed_nodes.size();
+        const int num_binary = num_binary_ops;
+        if (emit(*fanin.node_view(), use == Use::kFused, &inputs[k])) {
+          if (use == Use::kFused) {
+            fused.fused_nodes.push_back(fanin.node_index());
+          } else {
+            fused.recomputed_nodes.push_back(fanin.node_index());
+          }
+          continue;
+        }
+        fused.op_names.resize(num_ops);
+        operands.resize(2 * num_ops);
+        fused.args.resize(num_args);
+        fused.fused_nodes.resize(num_fused);
+        fused.recomputed_nodes.resize(num_recomputed);
+        num_binary_ops = num_binary;
+      }
+      if (!IsSuffixBroadcast(input_props[k].shape(), out_shape)) return false;
+      const string& input = node_def->input(k);
+      auto it = std::find(fused.args.begin(), fused.args.end(), input);
+      inputs[k] = {true, static_cast<int>(it - fused.args.begin())};
+      if (it == fused.args.end()) fused.args.push_back(input);
+    }
+
+    fused.op_names.push_back(node_def->op());
+    operands.push_back(inputs[0]);
+    operands.push_back(inputs[1]);
+    if (arity == 2) ++num_binary_ops;
+    *result = {false, static_cast<int>(fused.op_names.size()) - 1};
+    return fused.op_names.size() <= kMaxFusedElementwiseOps;
+  };
+
+  Operand result;
+  if (!emit(*root_view, /*fuse_producers=*/true, &result)) return false;
+  // Chains of unary ops are left to _UnaryOpsComposition.
+  if (fused.op_names.size() < 2 || num_binary_ops == 0) return false;
+
+  const int num_args = fused.args.size();
+  for (const Operand& operand : operands) {
+    if (operand.index == kMissingIndex) {
+      fused.operands.push_back(kMissingIndex);
+    } else {
+      fused.operands.push_back(operand.is_arg ? operand.index
+                                              : num_args + operand.index);
+    }
+  }
+  fused.root = node_index;
+  *matched = std::move(fused);
+  return true;
+}
+
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const FusedElementwise& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& root = graph->node(matched.root);
+  VLOG(2) << "Fuse elementwise ops into " << root.name() << ": ["
+          << absl::StrJoin(matched.op_names, ", ") << "]";
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.set_device(root.device());
+  for (const string& arg : matched.args) *fused_op.add_input() = arg;
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = root.attr().at("T");
+  SetAttrValue(static_cast<int>(matched.args.size()), &(*attr)["num_args"]);
+  SetAttrValue(matched.op_names, &(*attr)["op_names"]);
+  SetAttrValue(matched.operands, &(*attr)["operands"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.root] = true;
+  for (int node : matched.fused_nodes) (*nodes_to_delete)[node] = true;
+  ctx->recomputed_nodes.insert(matched.recomputed_nodes.begin(),
+                               matched.recomputed_nodes.end());
+
+  return Status::OK();
+}
+
+bool FindMaskedGather(const RemapperContext& ctx, int node_index,
+                      MaskedGather* matched) {
+  const auto* gather_view = ctx.graph_view.GetNode(node_index);
+  const auto* gather_def = gather_view->node();
+  if (!IsGather(*gather_def) || !NodeIsOnCpu(gather_def)) return false;
+  if (HasControlFaninOrFanout(*gather_view)) return false;
+  if (gather_view->NumRegularFanins() < 2) return false;
+
+  // Only a gather of whole rows, as in SparseSegmentWithGather.
+  if (gather_def->op() == "GatherV2") {
+    int batch_dims = 0;
+    if (TryGetNodeAttr(*gather_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0) {
+      return false;
+    }
+    if (gather_view->NumRegularFanins() < 3) return false;
+    const auto* axis_def = gather_view->GetRegularFanin(2).node_view()->node();
+    if (!IsConstant(*axis_def)) return false;
+    Tensor axis;
+    if (!axis.FromProto(axis_def->attr().at("value").tensor()) ||
+        axis.NumElements() != 1) {
+      return false;
+    }
+    const int64 axis_value = axis.dtype() == DT_INT32
+                                 ? axis.flat<int32>()(0)
+                                 : axis.flat<int64>()(0);
+    if (axis_value != 0) return false;
+  }
+
+  // Indices must be Where(mask) with its index column squeezed out. Without
+  // explicit squeeze dims a single true element would squeeze to a scalar.
+  const auto* squeeze_view = gather_view->GetRegularFanin(1).node_view();
+  const auto* squeeze_def = squeeze_view->node();
+  if (!IsSqueeze(*squeeze_def)) return false;
+  if (HasControlFaninOrFanout(*squeeze_view) ||
+      !HasAtMostOneFanoutAtPort0(*squeeze_view) ||
+      IsInPreserveSet(ctx, squeeze_def) ||
+      squeeze_view->NumRegularFanins() < 1) {
+    return false;
+  }
+  std::vector<int32> squeeze_dims;
+  if (!TryGetNodeAttr(*squeeze_def, "squeeze_dims", &squeeze_dims) ||
+      squeeze_dims.size() != 1 ||
+      (squeeze_dims[0] != 1 && squeeze_dims[0] != -1)) {
+    return false;
+  }
+
+  const auto* where_view = squeeze_view->GetRegularFanin(0).node_view();
+  const auto* where_def = where_view->node();
+  if (where_def->op() != "Where") return false;
+  if (HasControlFaninOrFanout(*where_view) ||
+      !HasAtMostOneFanoutAtPort0(*where_view) ||
+      IsInPreserveSet(ctx, where_def) || where_view->NumRegularFanins() < 1) {
+    return false;
+  }
+  DataType mask_dtype;
+  if (!TryGetNodeAttr(*where_def, "T", &mask_dtype) || mask_dtype != DT_BOOL) {
+    return false;
+  }
+
+  matched->gather = node_index;
+  matched->squeeze = squeeze_view->node_index();
+  matched->where = where_view->node_index();
+
+  return true;
+}
+
+Status AddMaskedGatherNode(RemapperContext* ctx, const MaskedGather& matched,
+                           std::vector<bool>* invalidated_nodes,
+                           std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& gather = graph->node(matched.gather);
+  const NodeDef& where = graph->node(matched.where);
+  VLOG(2) << "Fuse Where+Squeeze with " << gather.op() << ":"
+          << " where=" << where.name()
+          << " squeeze=" << graph->node(matched.squeeze).name()
+          << " gather=" << gather.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(gather.name());
+  fused_op.set_op(kMaskedGather);
+  fused_op.set_device(gather.device());
+  *fused_op.add_input() = gather.input(0);  // params
+  *fused_op.add_input() = where.input(0);   // mask
+  (*fused_op.mutable_attr())["T"] = gather.attr().at("Tparams");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.gather] = true;
+  (*nodes_to_delete)[matched.squeeze] = true;
+  (*nodes_to_delete)[matched.where] = true;
+
+  return Status::OK();
+}
+
+// Converts the [k, n] `weights`, or their transpose, to the block-sparse
+// format of _BlockSparseMatMul with the first block shape for which few
+// enough blocks are nonzero. Returns false if there is none.
+bool ToBlockSparse(const Tensor& weights, bool transpose,
+                   BlockSparseMatMul* matched) {
+  const auto w = weights.matrix<float>();
+  const int64 k = transpose ? w.dimension(1) : w.dimension(0);
+  const int64 n = transpose ? w.dimension(0) : w.dimension(1);
+  auto at = [&](int64 i, int64 j) { return transpose ? w(j, i) : w(i, j); };
+
+  for (const auto& shape : kBlockSparseShapes) {
+    const int64 block_k = shape[0];
+    const int64 block_n = shape[1];
+    if (k % block_k != 0 || n % block_n != 0) continue;
+    const int64 num_block_rows = k / block_k;
+    const int64 num_block_cols = n / block_n;
+
+    std::vector<bool> nonzero(num_block_rows * num_block_cols, false);
+    for (int64 i = 0; i < k; ++i) {
+      for (int64 j = 0; j < n; ++j) {
+        if (at(i, j) != 0) {
+          nonzero[(i / block_k) * num_block_cols + j / block_n] = true;
+        }
+      }
+    }
+    const int64 num_blocks = absl::c_count(nonzero, true);
+    if (num_blocks > kMaxBlockSparseDensity * nonzero.size()) continue;
+
+    // List the nonzero blocks of each block column, in order.
+    matched->block_values =
+        Tensor(DT_FLOAT, TensorShape({num_blocks, block_k, block_n}));
+    matched->block_indices = Tensor(DT_INT32, TensorShape({num_blocks}));
+    matched->block_row_ptr =
+        Tensor(DT_INT32, TensorShape({num_block_cols + 1}));
+    auto values = matched->block_values.tensor<float, 3>();
+    auto indices = matched->block_indices.vec<int32>();
+    auto row_ptr = matched->block_row_ptr.vec<int32>();
+    int64 p = 0;
+    row_ptr(0) = 0;
+    for (int64 col = 0; col < num_block_cols; ++col) {
+      for (int64 row = 0; row < num_block_rows; ++row) {
+        if (!nonzero[row * num_block_cols + col]) continue;
+        indices(p) = row;
+        for (int64 i = 0; i < block_k; ++i) {
+          for (int64 j = 0; j < block_n; ++j) {
+            values(p, i, j) = at(row * block_k + i, col * block_n + j);
+          }
+        }
+        ++p;
+      }
+      row_ptr(col + 1) = p;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool FindBlockSparseMatMul(const RemapperContext& ctx, int node_index,
+                           BlockSparseMatMul* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (node_def->op() != "MatMul" || !IsCpuCompatibleMatMul(node_def) ||
+      GetDataTypeFromAttr(*node_def, "T") != DT_FLOAT) {
+    return false;
+  }
+  if (HasControlFaninOrFanout(*node_view)) return false;
+  if (node_view->NumRegularFanins() < 2) return false;
+
+  bool transpose_a = false;
+  bool transpose_b = false;
+  if (!TryGetNodeAttr(*node_def, "transpose_a", &transpose_a) || transpose_a ||
+      !TryGetNodeAttr(*node_def, "transpose_b", &transpose_b)) {
+    return false;
+  }
+
+  // Weights must be a large enough constant matrix.
+  const auto* weights_view = node_view->GetRegularFanin(1).node_view();
+  const auto* weights_def = weights_view->node();
+  if (!IsConstant(*weights_def)) return false;
+  Tensor weights;
+  if (!weights.FromProto(weights_def->attr().at("value").tensor()) ||
+      weights.dtype() != DT_FLOAT || weights.dims() != 2 ||
+      weights.NumElements() < kMinBlockSparseWeights) {
+    return false;
+  }
+  if (!ToBlockSparse(weights, transpose_b, matched)) return false;
+
+  matched->matmul = node_index;
+  matched->weights = weights_view->node_index();
+  matched->delete_weights = !HasControlFaninOrFanout(*weights_view) &&
+                            HasAtMostOneFanoutAtPort0(*weights_view) &&
+                            !IsInPreserveSet(ctx, weights_def);
+
+  return true;
+}
+
+// Returns a Const node holding `value`, for the block-sparse weights of
+// `matmul`.
+NodeDef BlockSparseWeightsNode(const NodeDef& matmul, const string& suffix,
+                               const Tensor& value) {
+  NodeDef node;
+  node.set_name(AddPrefixToNodeName(suffix, matmul.name()));
+  node.set_op("Const");
+  node.set_device(matmul.device());
+  *node.add_input() = AsControlDependency(NodeName(matmul.input(0)));
+  (*node.mutable_attr())["dtype"].set_type(value.dtype());
+  value.AsProtoTensorContent((*node.mutable_attr())["value"].mutable_tensor());
+  return node;
+}
+
+Status AddBlockSparseMatMulNodes(RemapperContext* ctx,
+                                 const BlockSparseMatMul& matched,
+                                 std::vector<bool>* invalidated_nodes,
+                                 std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& matmul = graph->node(matched.matmul);
+  VLOG(2) << "Store the weights of " << matmul.name() << " block-sparse: "
+          << matched.block_indices.NumElements() << " blocks of "
+          << matched.block_values.dim_size(1) << "x"
+          << matched.block_values.dim_size(2);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+
+  NodeDef values =
+      BlockSparseWeightsNode(matmul, "BlockValues", matched.block_values);
+  NodeDef indices =
+      BlockSparseWeightsNode(matmul, "BlockIndices", matched.block_indices);
+  NodeDef row_ptr =
+      BlockSparseWeightsNode(matmul, "BlockRowPtr", matched.block_row_ptr);
+
+  NodeDef fused_op;
+  fused_op.set_name(matmul.name());
+  fused_op.set_op(kBlockSparseMatMul);
+  fused_op.set_device(matmul.device());
+  fused_op.add_input(matmul.input(0));  // 0: a
+  fused_op.add_input(values.name());    // 1: block_values
+  fused_op.add_input(indices.name());   // 2: block_indices
+  fused_op.add_input(row_ptr.name());   // 3: block_row_ptr
+  (*fused_op.mutable_attr())["T"] = matmul.attr().at("T");
+
+  mutation->AddNode(std::move(values), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(indices), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(row_ptr), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.matmul] = true;
+  if (matched.delete_weights) (*nodes_to_delete)[matched.weights] = true;
+
+  return Status::OK();
+}
+
 #ifdef INTEL_MKL
 bool IsConv2DWithAdd(const RemapperContext& ctx, int node_index) {
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -1670,12 +2597,18 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
+  // Candidate for an elementwise fusion.
+  const auto is_fused_elementwise_candidate = [&]() -> bool {
+    return FusibleElementwiseArity(*node_def) == 2 &&
+           IsFusibleElementwise(*node_view);
+  };
+
 #ifdef INTEL_MKL
   return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
-         IsConv2DWithAdd(ctx, node_index);
+         IsConv2DWithAdd(ctx, node_index) || is_fused_elementwise_candidate();
 #else
   return is_relu_biasadd_conv2d_candidate() || is_batch_norm_candidate() ||
-         is_batch_norm_fusion_candidate();
+         is_batch_norm_fusion_candidate() || is_fused_elementwise_candidate();
 #endif  // INTEL_MKL
 }
 
@@ -1685,7 +2618,7 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
                           GraphDef* optimized_graph) {
   GrapplerItem mutable_item = item;
   Status status;
-  RemapperContext ctx(&mutable_item, &status);
+  RemapperContext ctx(&mutable_item, cluster, &status);
   TF_RETURN_IF_ERROR(status);
   // Processing graph in reverse-topological sorted order allows to remap
   // longer chains of dependent ops in one pass.
@@ -1703,12 +2636,36 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool allow_non_differentiable_rewrites =
       item.optimization_options().allow_non_differentiable_rewrites;
 
+  // Store pruned constant MatMul weights block-sparse. This runs before the
+  // main loop, so that the contraction fusions below do not claim the MatMuls
+  // first; their BiasAdd and activation stay separate ops.
+  if (allow_non_differentiable_rewrites) {
+    for (int i = 0; i < num_nodes; ++i) {
+      BlockSparseMatMul block_sparse_matmul;
+      if (FindBlockSparseMatMul(ctx, i, &block_sparse_matmul)) {
+        TF_RETURN_IF_ERROR(AddBlockSparseMatMulNodes(
+            &ctx, block_sparse_matmul, &invalidated_nodes, &nodes_to_delete));
+      }
+    }
+  }
+
   for (int i = num_nodes - 1; i >= 0; --i) {
     // Check if node was invalidated by one of the previous remaps.
     if (invalidated_nodes[i] || nodes_to_delete[i]) {
       continue;
     }
 
+    // Remove nodes that all their consumers recompute. The consumers come
+    // first in reverse topological order.
+    if (ctx.recomputed_nodes.contains(i) &&
+        absl::c_all_of(ctx.graph_view.GetNode(i)->GetRegularFanout(0),
+                       [&](const utils::MutableFaninView& fanout) {
+                         return nodes_to_delete[fanout.node_index()];
+                       })) {
+      nodes_to_delete[i] = true;
+      continue;
+    }
+
     // Infer properties lazily in case they are not needed.
     if (!ctx.inferred_graph_properties && RequiresInferredShapes(ctx, i)) {
       const bool assume_valid_feeds = opt_level_ == RewriterConfig::AGGRESSIVE;
@@ -1728,6 +2685,13 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       // Remap Conv2D+BiasAdd+Add+relu into the _FusedConv2D.
       if (FindContractionWithBiasAndAddActivation(
               ctx, i, &contract_with_bias_and_add_activation)) {
+        const auto& matched = contract_with_bias_and_add_activation;
+        RecordFusion(
+            &ctx,
+            FusedContractionOp(
+                *ctx.graph_view.GetNode(matched.contraction)->node()),
+            matched.activation,
+            {matched.contraction, matched.bias_add, matched.add});
         TF_RETURN_IF_ERROR(
             AddFusedContractionNode(&ctx, contract_with_bias_and_add_activation,
                                     &invalidated_nodes, &nodes_to_delete));
@@ -1737,6 +2701,12 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       // Remap Conv2D+BiasAdd+Add into the _FusedConv2D.
       if (FindContractionWithBiasAddAndAdd(ctx, i,
                                            &contract_with_bias_and_add)) {
+        const auto& matched = contract_with_bias_and_add;
+        RecordFusion(
+            &ctx,
+            FusedContractionOp(
+                *ctx.graph_view.GetNode(matched.contraction)->node()),
+            matched.add, {matched.contraction, matched.bias_add});
         TF_RETURN_IF_ERROR(
             AddFusedContractionNode(&ctx, contract_with_bias_and_add,
                                     &invalidated_nodes, &nodes_to_delete));
@@ -1761,6 +2731,11 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     ContractionWithBiasAdd contract_with_bias;
     if (allow_non_differentiable_rewrites &&
         FindContractionWithBias(ctx, i, &contract_with_bias)) {
+      const auto& matched = contract_with_bias;
+      RecordFusion(&ctx,
+                   FusedContractionOp(
+                       *ctx.graph_view.GetNode(matched.contraction)->node()),
+                   matched.bias_add, {matched.contraction});
       TF_RETURN_IF_ERROR(AddFusedContractionNode(
           &ctx, contract_with_bias, &invalidated_nodes, &nodes_to_delete));
       continue;
@@ -1772,6 +2747,11 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     if (allow_non_differentiable_rewrites &&
         FindContractionWithBiasAndActivation(
             ctx, i, &contract_with_bias_and_activation)) {
+      const auto& matched = contract_with_bias_and_activation;
+      RecordFusion(&ctx,
+                   FusedContractionOp(
+                       *ctx.graph_view.GetNode(matched.contraction)->node()),
+                   matched.activation, {matched.contraction, matched.bias_add});
       TF_RETURN_IF_ERROR(
           AddFusedContractionNode(&ctx, contract_with_bias_and_activation,
                                   &invalidated_nodes, &nodes_to_delete));
@@ -1789,6 +2769,8 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     ContractionWithSqueezeAndBiasAdd contract_with_squeeze_and_bias;
     if (allow_non_differentiable_rewrites &&
         FindConv2DWithSqueezeAndBias(ctx, i, &contract_with_squeeze_and_bias)) {
+      RecordFusion(&ctx, kFusedConv2D, contract_with_squeeze_and_bias.bias_add,
+                   {contract_with_squeeze_and_bias.contraction});
       TF_RETURN_IF_ERROR(
           AddFusedConv2DNode(&ctx, contract_with_squeeze_and_bias,
                              &invalidated_nodes, &nodes_to_delete));
@@ -1799,6 +2781,9 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     ContractionWithBatchNorm contract_with_batch_norm;
     if (allow_non_differentiable_rewrites &&
         FindConv2DWithBatchNorm(ctx, i, &contract_with_batch_norm)) {
+      RecordFusion(&ctx, kFusedConv2D,
+                   contract_with_batch_norm.fused_batch_norm,
+                   {contract_with_batch_norm.contraction});
       TF_RETURN_IF_ERROR(AddFusedConv2DNode(&ctx, contract_with_batch_norm,
                                             &invalidated_nodes,
                                             &nodes_to_delete));
@@ -1811,6 +2796,9 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     if (allow_non_differentiable_rewrites &&
         FindConv2DWithBatchNormAndActivation(
             ctx, i, &contract_with_batch_norm_and_activation)) {
+      const auto& matched = contract_with_batch_norm_and_activation;
+      RecordFusion(&ctx, kFusedConv2D, matched.activation,
+                   {matched.contraction, matched.fused_batch_norm});
       TF_RETURN_IF_ERROR(
           AddFusedConv2DNode(&ctx, contract_with_batch_norm_and_activation,
                              &invalidated_nodes, &nodes_to_delete));
@@ -1822,6 +2810,12 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     FusedBatchNormEx fused_batch_norm_ex;
     if (allow_non_differentiable_rewrites &&
         FindFusedBatchNormEx(ctx, i, &fused_batch_norm_ex)) {
+      std::vector<int> removed = {fused_batch_norm_ex.fused_batch_norm};
+      if (fused_batch_norm_ex.invalidated != kMissingIndex) {
+        removed.push_back(fused_batch_norm_ex.invalidated);
+      }
+      RecordFusion(&ctx, kFusedBatchNormEx, fused_batch_norm_ex.activation,
+                   removed);
       TF_RETURN_IF_ERROR(AddFusedBatchNormExNode(
           &ctx, fused_batch_norm_ex, &invalidated_nodes, &nodes_to_delete));
       continue;
@@ -1834,6 +2828,39 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       TF_RETURN_IF_ERROR(AddBatchNormNodes(&ctx, fused_batch_norm));
       continue;
     }
+
+    // Remap Gather+SparseSegment{Sum,Mean,SqrtN} into a SparseSegment
+    // reduction that reads params directly.
+    SparseSegmentWithGather sparse_segment_with_gather;
+    if (FindSparseSegmentWithGather(ctx, i, &sparse_segment_with_gather)) {
+      TF_RETURN_IF_ERROR(AddSparseSegmentWithGatherNodes(
+          &ctx, sparse_segment_with_gather, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    // Remap Gather(params, Squeeze(Where(mask))) into _MaskedGather.
+    MaskedGather masked_gather;
+    if (allow_non_differentiable_rewrites &&
+        FindMaskedGather(ctx, i, &masked_gather)) {
+      RecordFusion(&ctx, kMaskedGather, masked_gather.gather,
+                   {masked_gather.squeeze, masked_gather.where});
+      TF_RETURN_IF_ERROR(AddMaskedGatherNode(
+          &ctx, masked_gather, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap trees of unary and binary elementwise ops into _FusedElementwise.
+    FusedElementwise fused_elementwise;
+    if (allow_non_differentiable_rewrites &&
+        FindFusedElementwise(ctx, i, &fused_elementwise)) {
+      RecordFusion(&ctx, kFusedElementwise, fused_elementwise.root,
+                   fused_elementwise.fused_nodes,
+                   fused_elementwise.recomputed_nodes);
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(
+          &ctx, fused_elementwise, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
   }
 
   // Remove invalidated nodes.
@@ -1845,6 +2872,7 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
   TF_RETURN_IF_ERROR(mutation->Apply());
 
+  LogFusionReport(ctx);
   *optimized_graph = std::move(mutable_item.graph);
 
   return Status::OK();
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
@@ -959,5 +960,328 @@ TEST_F(RemapperTest, FuseConv2DWithSqueezeAndBias) {
 }
 #endif
 
+TEST_F(RemapperTest, FuseGatherWithSparseSegmentMean) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto params_shape = ops::Placeholder::Shape({16, 8});
+  auto ids_shape = ops::Placeholder::Shape({6});
+
+  auto params = Placeholder(s.WithOpName("params"), DT_FLOAT, params_shape);
+  auto ids = Placeholder(s.WithOpName("ids"), DT_INT64, ids_shape);
+  auto unique = ops::Unique(s.WithOpName("unique"), ids);
+  auto axis = ops::Const(s.WithOpName("axis"), 0);
+  auto gather = ops::GatherV2(s.WithOpName("gather"), params, unique.y, axis);
+  auto identity = ops::Identity(s.WithOpName("identity"), gather);
+  auto segment_ids =
+      ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 2, 2, 2});
+  auto mean = ops::SparseSegmentMean(s.WithOpName("mean"), identity, unique.idx,
+                                     segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), mean);
+
+  auto params_t = GenerateRandomTensor<DT_FLOAT>({16, 8});
+  Tensor ids_t = test::AsTensor<int64>({3, 7, 3, 15, 0, 7});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"params", params_t}, {"ids", ids_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather");
+    EXPECT_NE(node.name(), "identity");
+    if (node.name() == "mean") {
+      EXPECT_EQ(node.op(), "SparseSegmentMean");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "params");
+      EXPECT_EQ(node.input(1), "mean/GatherIds");
+      EXPECT_EQ(node.input(2), "segment_ids");
+      EXPECT_EQ(node.attr().at("Tidx").type(), DT_INT64);
+      found++;
+    } else if (node.name() == "mean/GatherIds") {
+      EXPECT_EQ(node.op(), "GatherV2");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "unique");
+      EXPECT_EQ(node.input(1), "unique:1");
+      EXPECT_EQ(node.attr().at("Tparams").type(), DT_INT64);
+      EXPECT_EQ(node.attr().at("Tindices").type(), DT_INT32);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseElementwiseOps) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 16}));
+  auto y = Placeholder(s.WithOpName("y"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 16}));
+  auto b = Placeholder(s.WithOpName("b"), DT_FLOAT,
+                       ops::Placeholder::Shape({16}));
+  auto add = ops::Add(s.WithOpName("add"), x, b);
+  auto sigmoid = ops::Sigmoid(s.WithOpName("sigmoid"), y);
+  auto mul = ops::Mul(s.WithOpName("mul"), add, sigmoid);
+  auto square = ops::Square(s.WithOpName("square"), mul);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), square);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({8, 16});
+  auto y_t = GenerateRandomTensor<DT_FLOAT>({8, 16});
+  auto b_t = GenerateRandomTensor<DT_FLOAT>({16});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}, {"y", y_t}, {"b", b_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "add");
+    EXPECT_NE(node.name(), "sigmoid");
+    EXPECT_NE(node.name(), "mul");
+    if (node.name() == "square") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "b");
+      EXPECT_EQ(node.input(2), "y");
+
+      const auto op_names = node.attr().at("op_names").list().s();
+      ASSERT_EQ(op_names.size(), 4);
+      EXPECT_EQ(op_names[0], "Add");
+      EXPECT_EQ(op_names[1], "Sigmoid");
+      EXPECT_EQ(op_names[2], "Mul");
+      EXPECT_EQ(op_names[3], "Square");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseElementwiseOpsRecomputesSharedProducer) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({256, 256}));
+  auto y = Placeholder(s.WithOpName("y"), DT_FLOAT,
+                       ops::Placeholder::Shape({256, 256}));
+  auto b = Placeholder(s.WithOpName("b"), DT_FLOAT,
+                       ops::Placeholder::Shape({256}));
+  // `add` has two consumers. Reading x and b twice is cheaper than writing
+  // `add` and reading it twice, so both fused ops recompute it.
+  auto add = ops::Add(s.WithOpName("add"), x, b);
+  auto mul = ops::Mul(s.WithOpName("mul"), add, y);
+  auto sub = ops::Sub(s.WithOpName("sub"), add, y);
+  auto fetch0 = ops::Identity(s.WithOpName("fetch0"), mul);
+  auto fetch1 = ops::Identity(s.WithOpName("fetch1"), sub);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({256, 256});
+  auto y_t = GenerateRandomTensor<DT_FLOAT>({256, 256});
+  auto b_t = GenerateRandomTensor<DT_FLOAT>({256});
+
+  GrapplerItem item;
+  item.fetch = {"fetch0", "fetch1"};
+  item.feed = {{"x", x_t}, {"y", y_t}, {"b", b_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  // Costs are estimated for a memory bound CPU.
+  DeviceProperties cpu;
+  cpu.set_type("CPU");
+  cpu.set_num_cores(8);
+  cpu.set_frequency(3000);
+  cpu.set_bandwidth(32 * 1000 * 1000);  // 32 GB/s.
+  VirtualCluster cluster({{"/device:CPU:0", cpu}});
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(&cluster, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "add");
+    if (node.name() == "mul" || node.name() == "sub") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "b");
+      EXPECT_EQ(node.input(2), "y");
+
+      const auto op_names = node.attr().at("op_names").list().s();
+      ASSERT_EQ(op_names.size(), 2);
+      EXPECT_EQ(op_names[0], "Add");
+      EXPECT_EQ(op_names[1], node.name() == "mul" ? "Mul" : "Sub");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 2);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+  test::ExpectTensorNear<float>(tensors[1], tensors_expected[1], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseMaskedGather) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto params = Placeholder(s.WithOpName("params"), DT_FLOAT,
+                            ops::Placeholder::Shape({6, 3}));
+  auto mask =
+      Placeholder(s.WithOpName("mask"), DT_BOOL, ops::Placeholder::Shape({6}));
+  auto where = ops::Where(s.WithOpName("where"), mask);
+  auto squeeze = ops::Squeeze(s.WithOpName("squeeze"), where,
+                              ops::Squeeze::Axis({1}));
+  auto axis = ops::Const(s.WithOpName("axis"), 0);
+  auto gather = ops::GatherV2(s.WithOpName("gather"), params, squeeze, axis);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), gather);
+
+  auto params_t = GenerateRandomTensor<DT_FLOAT>({6, 3});
+  Tensor mask_t(DT_BOOL, TensorShape({6}));
+  test::FillValues<bool>(&mask_t, {true, false, false, true, true, false});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"params", params_t}, {"mask", mask_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "where");
+    EXPECT_NE(node.name(), "squeeze");
+    if (node.name() == "gather") {
+      EXPECT_EQ(node.op(), "_MaskedGather");
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "params");
+      EXPECT_EQ(node.input(1), "mask");
+      EXPECT_EQ(node.attr().at("T").type(), DT_FLOAT);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+}
+
+TEST_F(RemapperTest, FuseBlockSparseMatMul) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // Weights in which one 8x16 block in eight is nonzero.
+  Tensor weights_t(DT_FLOAT, TensorShape({128, 64}));
+  auto weights_matrix = weights_t.matrix<float>();
+  weights_matrix.setZero();
+  for (int row = 0; row < 16; ++row) {
+    for (int i = 0; i < 8; ++i) {
+      for (int j = 0; j < 16; ++j) {
+        weights_matrix(row * 8 + i, (row % 4) * 16 + j) =
+            row % 2 == 0 ? (i + 1) * 0.1f - j * 0.01f : 0.0f;
+      }
+    }
+  }
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({5, 128}));
+  auto weights = ops::Const(s.WithOpName("weights"), weights_t);
+  auto matmul = ops::MatMul(s.WithOpName("matmul"), x, weights);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({5, 128});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "weights");
+    if (node.name() == "matmul") {
+      EXPECT_EQ(node.op(), "_BlockSparseMatMul");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "matmul/BlockValues");
+      EXPECT_EQ(node.input(2), "matmul/BlockIndices");
+      EXPECT_EQ(node.input(3), "matmul/BlockRowPtr");
+      found++;
+    } else if (node.name() == "matmul/BlockValues") {
+      Tensor values;
+      ASSERT_TRUE(values.FromProto(node.attr().at("value").tensor()));
+      EXPECT_EQ(values.shape(), TensorShape({8, 8, 16}));
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
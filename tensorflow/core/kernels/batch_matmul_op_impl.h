@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/constant_weights_cache.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -741,6 +742,17 @@ class BaseBatchMatMulOp : public OpKernel {
                 out_reshaped.CopyFrom(*out, TensorShape({batch_size, d0, d3})),
                 errors::Internal("Failed to reshape output from ",
                                  out->shape().DebugString()));
+    // On CPU, multiply by the cached adjoint of constant weights rather than
+    // packing them transposed on every call.
+    Tensor in1_adjoint;
+    if (std::is_same<Device, CPUDevice>::value && adj_y_ &&
+        GetTransposedConstantWeights<Scalar>(
+            in1_reshaped, Eigen::NumTraits<Scalar>::IsComplex, &in1_adjoint)) {
+      LaunchBatchMatMul<Device, Scalar>::Launch(
+          ctx, in0_reshaped, in1_adjoint, adj_x_, /*adj_y=*/false,
+          /*trans_x=*/false, /*trans_y=*/false, bcast, &out_reshaped);
+      return;
+    }
     LaunchBatchMatMul<Device, Scalar>::Launch(
         ctx, in0_reshaped, in1_reshaped, adj_x_, adj_y_, /*trans_x=*/false,
         /*trans_y=*/false, bcast, &out_reshaped);
@@ -232,6 +232,12 @@ class BasicBatchScheduler : public BatchScheduler<TaskType> {
     // equal to `max_batch_size`.
     int max_execution_batch_size = 10;
 
+    // If positive, tasks with BatchTaskPriority::kBestEffort are held in a
+    // separate lane of at most this many batches' worth of tasks, and only
+    // fill the room critical tasks leave in batches. See
+    // SharedBatchScheduler::QueueOptions for details.
+    int max_enqueued_best_effort_batches = 0;
+
     // The following options are typically only overridden by test code.
 
     // The environment to use.
@@ -293,6 +299,8 @@ Status BasicBatchScheduler<TaskType>::Create(
       options.split_input_task_func;
   shared_scheduler_queue_options.max_execution_batch_size =
       options.max_execution_batch_size;
+  shared_scheduler_queue_options.max_enqueued_best_effort_batches =
+      options.max_enqueued_best_effort_batches;
   std::unique_ptr<BatchScheduler<TaskType>> shared_scheduler_queue;
   TF_RETURN_IF_ERROR(shared_scheduler->AddQueue(shared_scheduler_queue_options,
                                                 process_batch_callback,
@@ -72,6 +72,33 @@ void RecordBatchDelayMs(int64 batch_delay_ms, const string& model_name) {
   cell->GetCell(model_name)->Add(static_cast<double>(batch_delay_ms));
 }
 
+void RecordPaddingWastePercent(double padding_waste_percent,
+                               const string& model_name) {
+  static auto* cell = monitoring::PercentileSampler<1>::New(
+      {"/tensorflow/serving/batching/padding_waste_percent",
+       "Tracks the share of padding in the processed batches by model_name (if "
+       "available).",
+       "model_name"},
+      /*percentiles=*/{25.0, 50.0, 75.0, 90.0, 95.0, 99.0},
+      /*max_samples=*/1024, monitoring::UnitOfMeasure::kNumber);
+  cell->GetCell(model_name)->Add(padding_waste_percent);
+}
+
+// Returns the suffix of the batcher queue for a task with 'inputs'. Tasks can
+// only be concatenated if their inputs agree on all but the 0th dimension, so
+// tasks of different shapes (e.g. sequences of different lengths) go to
+// different queues instead of failing each other's batch.
+string NonBatchShapesQueueSuffix(const std::vector<Tensor>& inputs) {
+  string suffix;
+  for (const Tensor& input : inputs) {
+    absl::StrAppend(&suffix, "|");
+    for (int i = 1; i < input.dims(); ++i) {
+      absl::StrAppend(&suffix, i > 1 ? "," : "", input.dim_size(i));
+    }
+  }
+  return suffix;
+}
+
 const string& GetModelName(OpKernelContext* ctx) {
   static string* kModelNameUnset = new string("model_name_unset");
   if (!ctx->session_metadata()) return *kModelNameUnset;
@@ -126,8 +153,10 @@ Status BatchResourceBase::RegisterInput(
   batch_components->status = std::make_shared<ThreadSafeStatus>();
 
   BatcherQueueT* batcher_queue;
-  TF_RETURN_IF_ERROR(
-      LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+  TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(
+      absl::StrCat(batcher_queue_name,
+                   NonBatchShapesQueueSuffix(batch_components->inputs)),
+      &batcher_queue));
   return batcher_queue->Schedule(&batch_components);
 }
 
@@ -203,6 +232,10 @@ Status BatchResourceBase::ConcatInputTensors(
   const int padded_batch_size = RoundToLowestAllowedBatchSize(batch.size());
   const int padding_amount = padded_batch_size - batch.size();
   RecordPaddingSize(padding_amount, GetModelName(context), padded_batch_size);
+  if (padded_batch_size > 0) {
+    RecordPaddingWastePercent(100.0 * padding_amount / padded_batch_size,
+                              GetModelName(context));
+  }
   RecordProcessedBatchSize(padded_batch_size, GetModelName(context));
 
   // All tasks should have the same number of input edges.
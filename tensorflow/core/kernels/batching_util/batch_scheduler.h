@@ -46,6 +46,11 @@ limitations under the License.
 namespace tensorflow {
 namespace serving {
 
+// The priority lane of a task. Schedulers that support lanes fill batches with
+// critical tasks first, and only add best-effort tasks to the room left over;
+// under overload they shed best-effort tasks first.
+enum class BatchTaskPriority { kCritical, kBestEffort };
+
 // The abstract superclass for a unit of work to be done as part of a batch.
 //
 // An implementing subclass typically contains (or points to):
@@ -64,6 +69,11 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns the priority lane of the task.
+  virtual BatchTaskPriority priority() const {
+    return BatchTaskPriority::kCritical;
+  }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
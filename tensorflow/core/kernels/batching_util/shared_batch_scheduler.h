@@ -18,11 +18,13 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
@@ -195,6 +198,31 @@ class SharedBatchScheduler
     // submit batches whose size is in a small set of allowed sizes, that can be
     // done by adding padding in the process-batch callback.
     size_t max_execution_batch_size = 1000;
+
+    // If positive, the queue adapts its batch timeout and the size at which it
+    // closes batches online, to keep the 99th percentile latency of batches
+    // (from the arrival of their first task until they have been processed) at
+    // or below this target. The adaptation is driven by the observed task
+    // arrival rate and batch processing time, and 'batch_timeout_micros' and
+    // the maximum batch size above act as upper bounds.
+    //
+    // The chosen values are exported as the
+    // /tensorflow/serving/batching/adaptive_* gauges, labeled by 'model_name'.
+    int64 target_latency_micros = 0;
+
+    // The label of the metrics exported by the adaptive batching policy.
+    string model_name = "model_name_unset";
+
+    // If positive, tasks with BatchTaskPriority::kBestEffort are held in a
+    // separate lane of at most this many batches' worth of tasks, instead of
+    // being subject to 'max_enqueued_batches'. Batches are filled with
+    // critical tasks first, and best-effort tasks only take the room left when
+    // a batch is scheduled; a best-effort task that doesn't fit in the lane is
+    // rejected with an UNAVAILABLE error. If zero, all tasks are treated alike.
+    //
+    // With 'enable_large_batch_splitting', best-effort tasks larger than
+    // 'max_execution_batch_size' are treated as critical ones.
+    size_t max_enqueued_best_effort_batches = 0;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -288,6 +316,9 @@ class Queue {
   // 'ScheduleWithSplit'
   Status ScheduleWithSplit(std::unique_ptr<TaskType>* task);
 
+  // Adds a best-effort task to the best-effort lane.
+  Status ScheduleBestEffort(std::unique_ptr<TaskType>* task);
+
   // Returns the number of enqueued tasks, with the same semantics as
   // BatchScheduler::NumEnqueuedTasks().
   size_t NumEnqueuedTasks() const;
@@ -336,6 +367,9 @@ class Queue {
   // fresh open batch behind it.
   void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Moves best-effort tasks, in order, into the room left in the open batch.
+  void FillOpenBatchWithBestEffortTasks() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Split `input task` into `output_tasks` according to 'task_sizes'.
   Status SplitInputBatchIntoSubtasks(
       std::unique_ptr<TaskType>* input_task,
@@ -346,6 +380,28 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Whether the batch timeout and size limit adapt to a target latency.
+  bool adaptive_batching() const { return options_.target_latency_micros > 0; }
+
+  // The size at which batches are closed, which is at most
+  // max_execution_batch_size().
+  size_t batch_size_limit() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return adaptive_batching() ? adaptive_batch_size_limit_
+                               : max_execution_batch_size();
+  }
+
+  // Updates the estimate of the task arrival rate with a task of 'size' units
+  // arriving now.
+  void RecordTaskArrival(size_t size) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Feeds a batch that started collecting tasks at 'batch_start_micros', and
+  // was processed from 'processing_start_micros' to 'end_micros', into the
+  // adaptive batching policy.
+  void UpdateAdaptiveBatchingPolicy(uint64 batch_start_micros,
+                                    uint64 processing_start_micros,
+                                    uint64 end_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -369,6 +425,12 @@ class Queue {
   // The enqueued batches. See the invariants in the class comments above.
   std::deque<std::unique_ptr<Batch<TaskType>>> batches_ TF_GUARDED_BY(mu_);
 
+  // The best-effort tasks not yet added to a batch, with the times at which
+  // they were scheduled, and the sum of their sizes.
+  std::deque<std::pair<uint64, std::unique_ptr<TaskType>>> best_effort_tasks_
+      TF_GUARDED_BY(mu_);
+  size_t best_effort_tasks_size_ TF_GUARDED_BY(mu_) = 0;
+
   // The counter of the TraceMe context ids.
   uint64 traceme_context_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
@@ -376,6 +438,30 @@ class Queue {
   // in 'batches_'. Valid iff that batch contains at least one task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The following are only maintained if adaptive_batching().
+
+  // The times at which the first task was added to each closed batch in
+  // 'batches_', front to back.
+  std::deque<uint64> closed_batch_start_times_micros_ TF_GUARDED_BY(mu_);
+
+  // The times at which the first task was added to each batch being processed,
+  // by the batch's traceme context id.
+  std::unordered_map<uint64, uint64> processing_batch_start_times_micros_
+      TF_GUARDED_BY(mu_);
+
+  // The current batch timeout and size limit.
+  int64 adaptive_batch_timeout_micros_ TF_GUARDED_BY(mu_);
+  size_t adaptive_batch_size_limit_ TF_GUARDED_BY(mu_);
+
+  // Exponential moving averages of the time between the arrival of task units
+  // and of the time it takes to process a batch.
+  double task_unit_interval_micros_ TF_GUARDED_BY(mu_) = 0;
+  double batch_processing_micros_ TF_GUARDED_BY(mu_) = 0;
+  uint64 last_task_arrival_micros_ TF_GUARDED_BY(mu_) = 0;
+
+  // The latencies of the batches processed since the policy was last updated.
+  std::vector<uint64> batch_latencies_micros_ TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -468,6 +554,11 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "batch_timeout_micros must be non-negative; was ",
         options.batch_timeout_micros);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
   if (options.max_enqueued_batches < 0) {
     return errors::InvalidArgument(
         "max_enqueued_batches must be non-negative; was ",
@@ -592,7 +683,9 @@ Queue<TaskType>::Queue(
     : options_(options),
       env_(env),
       process_batch_callback_(process_batch_callback),
-      schedulable_batch_callback_(schedulable_batch_callback) {
+      schedulable_batch_callback_(schedulable_batch_callback),
+      adaptive_batch_timeout_micros_(options.batch_timeout_micros),
+      adaptive_batch_size_limit_(max_execution_batch_size()) {
   // Create an initial, open batch.
   batches_.emplace_back(new Batch<TaskType>);
 }
@@ -608,6 +701,11 @@ Queue<TaskType>::~Queue() {
 
 template <typename TaskType>
 Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
+  if (options_.max_enqueued_best_effort_batches > 0 &&
+      (*task)->priority() == BatchTaskPriority::kBestEffort &&
+      (*task)->size() <= max_execution_batch_size()) {
+    return ScheduleBestEffort(task);
+  }
   if (options_.enable_large_batch_splitting) {
     return ScheduleWithSplit(std::move(task));
   }
@@ -628,7 +726,12 @@ Status Queue<TaskType>::ScheduleWithoutSplit(std::unique_ptr<TaskType>* task) {
 
     DCHECK(!closed_);
 
-    if (batches_.back()->size() + (*task)->size() > options_.max_batch_size) {
+    if (adaptive_batching()) {
+      RecordTaskArrival((*task)->size());
+    }
+    // A task larger than the adaptive size limit is batched on its own.
+    if (batches_.back()->size() + (*task)->size() > batch_size_limit() &&
+        !batches_.back()->empty()) {
       if (batches_.size() >= options_.max_enqueued_batches) {
         return errors::Unavailable(
             "The batch scheduling queue to which this task was submitted is "
@@ -675,19 +778,24 @@ Status Queue<TaskType>::ScheduleWithSplit(std::unique_ptr<TaskType>* task) {
                                    options_.max_batch_size);
   }
 
-  // The max size to be enqueued.
-  const int max_execution_batch_size = options_.max_execution_batch_size;
-
   bool notify_of_schedulable_batch = false;
   {
     mutex_lock l(mu_);
 
     DCHECK(!closed_);
 
+    // The max size to be enqueued.
+    const int max_execution_batch_size = batch_size_limit();
+
+    if (adaptive_batching()) {
+      RecordTaskArrival((*task)->size());
+    }
+
     const int num_new_batches_schedulable =
         options_.max_enqueued_batches - batches_.size();
-    const int open_batch_capacity =
-        max_execution_batch_size - batches_.back()->size();
+    // The adaptive size limit may have dropped below the open batch's size.
+    const int open_batch_capacity = std::max<int>(
+        0, max_execution_batch_size - batches_.back()->size());
     const int scheduling_capacity =
         (num_new_batches_schedulable * max_execution_batch_size) +
         open_batch_capacity;
@@ -702,6 +810,9 @@ Status Queue<TaskType>::ScheduleWithSplit(std::unique_ptr<TaskType>* task) {
           "The batch scheduling queue to which this task was submitted is "
           "full");
     }
+    if (open_batch_capacity == 0 && !batches_.back()->empty()) {
+      StartNewBatch();
+    }
 
     const int64 open_batch_remaining_slot =
         max_execution_batch_size - batches_.back()->size();
@@ -719,7 +830,7 @@ Status Queue<TaskType>::ScheduleWithSplit(std::unique_ptr<TaskType>* task) {
 
     for (int i = 0; i < output_tasks.size(); ++i) {
       if (batches_.back()->size() + output_tasks[i]->size() >
-          options_.max_execution_batch_size) {
+          max_execution_batch_size) {
         StartNewBatch();
       }
       if (batches_.back()->empty()) {
@@ -743,10 +854,49 @@ Status Queue<TaskType>::ScheduleWithSplit(std::unique_ptr<TaskType>* task) {
   return Status::OK();
 }
 
+template <typename TaskType>
+Status Queue<TaskType>::ScheduleBestEffort(std::unique_ptr<TaskType>* task) {
+  if ((*task)->size() > options_.max_batch_size) {
+    return errors::InvalidArgument("Task size ", (*task)->size(),
+                                   " is larger than maximum input batch size ",
+                                   options_.max_batch_size);
+  }
+
+  bool notify_of_schedulable_batch = false;
+  {
+    mutex_lock l(mu_);
+
+    DCHECK(!closed_);
+
+    if (best_effort_tasks_size_ + (*task)->size() >
+        options_.max_enqueued_best_effort_batches *
+            max_execution_batch_size()) {
+      return errors::Unavailable(
+          "The best-effort lane of the batch scheduling queue to which this "
+          "task was submitted is full");
+    }
+    best_effort_tasks_size_ += (*task)->size();
+    best_effort_tasks_.emplace_back(env_->NowMicros(), std::move(*task));
+
+    if (!schedulable_batch_) {
+      if (batches_.size() > 1 || IsOpenBatchSchedulable()) {
+        schedulable_batch_ = true;
+        notify_of_schedulable_batch = true;
+      }
+    }
+  }
+
+  if (notify_of_schedulable_batch) {
+    schedulable_batch_callback_();
+  }
+
+  return Status::OK();
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::NumEnqueuedTasks() const {
   mutex_lock l(mu_);
-  size_t num_enqueued_tasks = 0;
+  size_t num_enqueued_tasks = best_effort_tasks_.size();
   for (const auto& batch : batches_) {
     num_enqueued_tasks += batch->num_tasks();
   }
@@ -759,8 +909,9 @@ size_t Queue<TaskType>::SchedulingCapacity() const {
   const int num_new_batches_schedulable =
       options_.max_enqueued_batches - batches_.size();
   const int open_batch_capacity =
-      max_execution_batch_size() - batches_.back()->size();
-  return (num_new_batches_schedulable * max_execution_batch_size()) +
+      batch_size_limit() - std::min(batches_.back()->size(),
+                                    batch_size_limit());
+  return (num_new_batches_schedulable * batch_size_limit()) +
          open_batch_capacity;
 }
 
@@ -775,6 +926,7 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
 
     // Consider closing the open batch at this time, to schedule it.
     if (batches_.size() == 1 && IsOpenBatchSchedulable()) {
+      FillOpenBatchWithBestEffortTasks();
       StartNewBatch();
     }
 
@@ -783,6 +935,12 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
       ++num_batches_being_processed_;
       batch_to_schedule = std::move(batches_.front());
       batches_.pop_front();
+      if (adaptive_batching()) {
+        processing_batch_start_times_micros_[batch_to_schedule
+                                                 ->traceme_context_id()] =
+            closed_batch_start_times_micros_.front();
+        closed_batch_start_times_micros_.pop_front();
+      }
     } else {
       schedulable_batch_ = false;
     }
@@ -797,10 +955,21 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       [&batch] { return strings::StrCat("ProcessBatch:", batch->size()); },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const uint64 batch_id = batch->traceme_context_id();
+  const uint64 processing_start_micros =
+      adaptive_batching() ? env_->NowMicros() : 0;
   process_batch_callback_(std::move(batch));
 
   {
     mutex_lock l(mu_);
+    if (adaptive_batching()) {
+      auto it = processing_batch_start_times_micros_.find(batch_id);
+      if (it != processing_batch_start_times_micros_.end()) {
+        UpdateAdaptiveBatchingPolicy(it->second, processing_start_micros,
+                                     env_->NowMicros());
+        processing_batch_start_times_micros_.erase(it);
+      }
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -833,35 +1002,176 @@ void Queue<TaskType>::CloseAndWaitUntilEmpty() {
 template <typename TaskType>
 bool Queue<TaskType>::IsEmptyInternal() const {
   return num_batches_being_processed_ == 0 && batches_.size() == 1 &&
-         batches_.back()->empty();
+         batches_.back()->empty() && best_effort_tasks_.empty();
 }
 
 template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
+  if (adaptive_batching()) {
+    closed_batch_start_times_micros_.push_back(open_batch_start_time_micros_);
+  }
   batches_.back()->Close();
   batches_.emplace_back(new Batch<TaskType>(++traceme_context_id_counter_));
 }
 
+template <typename TaskType>
+void Queue<TaskType>::FillOpenBatchWithBestEffortTasks() {
+  Batch<TaskType>* open_batch = batches_.back().get();
+  while (!best_effort_tasks_.empty()) {
+    auto& best_effort_task = best_effort_tasks_.front();
+    if (!open_batch->empty() &&
+        open_batch->size() + best_effort_task.second->size() >
+            batch_size_limit()) {
+      break;
+    }
+    if (open_batch->empty()) {
+      open_batch_start_time_micros_ = best_effort_task.first;
+    }
+    best_effort_tasks_size_ -= best_effort_task.second->size();
+    open_batch->AddTask(std::move(best_effort_task.second));
+    best_effort_tasks_.pop_front();
+  }
+}
+
 template <typename TaskType>
 Status Queue<TaskType>::SplitInputBatchIntoSubtasks(
     std::unique_ptr<TaskType>* input_task,
     std::vector<std::unique_ptr<TaskType>>* output_tasks) {
   const int open_batch_remaining_slot =
-      max_execution_batch_size() - batches_.back()->size();
-  return options_.split_input_task_func(
-      std::move(input_task), open_batch_remaining_slot,
-      max_execution_batch_size(), std::move(output_tasks));
+      batch_size_limit() - batches_.back()->size();
+  return options_.split_input_task_func(std::move(input_task),
+                                        open_batch_remaining_slot,
+                                        batch_size_limit(),
+                                        std::move(output_tasks));
 }
 
 template <typename TaskType>
 bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   Batch<TaskType>* open_batch = batches_.back().get();
-  if (open_batch->empty()) {
+  if (open_batch->empty() && best_effort_tasks_.empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
-         env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+  // The batch is due when its oldest task, critical or best-effort, times out.
+  uint64 start_time_micros = open_batch_start_time_micros_;
+  if (open_batch->empty()) {
+    start_time_micros = best_effort_tasks_.front().first;
+  } else if (!best_effort_tasks_.empty()) {
+    start_time_micros =
+        std::min(start_time_micros, best_effort_tasks_.front().first);
+  }
+  const int64 batch_timeout_micros = adaptive_batching()
+                                         ? adaptive_batch_timeout_micros_
+                                         : options_.batch_timeout_micros;
+  return closed_ ||
+         open_batch->size() + best_effort_tasks_size_ >= batch_size_limit() ||
+         env_->NowMicros() >= start_time_micros + batch_timeout_micros;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::RecordTaskArrival(size_t size) {
+  const uint64 now_micros = env_->NowMicros();
+  if (last_task_arrival_micros_ > 0 && size > 0) {
+    const double interval_micros =
+        static_cast<double>(now_micros - last_task_arrival_micros_) / size;
+    task_unit_interval_micros_ =
+        task_unit_interval_micros_ == 0
+            ? interval_micros
+            : 0.9 * task_unit_interval_micros_ + 0.1 * interval_micros;
+  }
+  last_task_arrival_micros_ = now_micros;
+}
+
+// Exports the batch timeout and size limit chosen by the adaptive batching
+// policy of a queue, and the 99th percentile batch latency they were chosen
+// from.
+inline void RecordAdaptiveBatchingPolicy(const string& model_name,
+                                         int64 batch_timeout_micros,
+                                         int64 batch_size_limit,
+                                         int64 p99_latency_micros) {
+  static auto* timeout_gauge = monitoring::Gauge<int64, 1>::New(
+      "/tensorflow/serving/batching/adaptive_batch_timeout_micros",
+      "Tracks the batch timeout chosen to meet the target latency by "
+      "model_name (if available).",
+      "model_name");
+  static auto* size_gauge = monitoring::Gauge<int64, 1>::New(
+      "/tensorflow/serving/batching/adaptive_batch_size_limit",
+      "Tracks the batch size limit chosen to meet the target latency by "
+      "model_name (if available).",
+      "model_name");
+  static auto* latency_gauge = monitoring::Gauge<int64, 1>::New(
+      "/tensorflow/serving/batching/adaptive_p99_batch_latency_micros",
+      "Tracks the observed 99th percentile batch latency by model_name (if "
+      "available).",
+      "model_name");
+  timeout_gauge->GetCell(model_name)->Set(batch_timeout_micros);
+  size_gauge->GetCell(model_name)->Set(batch_size_limit);
+  latency_gauge->GetCell(model_name)->Set(p99_latency_micros);
+}
+
+template <typename TaskType>
+void Queue<TaskType>::UpdateAdaptiveBatchingPolicy(
+    uint64 batch_start_micros, uint64 processing_start_micros,
+    uint64 end_micros) {
+  // The number of batches between policy updates.
+  constexpr int kNumLatencySamples = 32;
+
+  const double processing_micros = end_micros - processing_start_micros;
+  batch_processing_micros_ =
+      batch_processing_micros_ == 0
+          ? processing_micros
+          : 0.9 * batch_processing_micros_ + 0.1 * processing_micros;
+  batch_latencies_micros_.push_back(end_micros - batch_start_micros);
+  if (batch_latencies_micros_.size() < kNumLatencySamples) {
+    return;
+  }
+
+  auto p99 = batch_latencies_micros_.begin() +
+             (batch_latencies_micros_.size() * 99) / 100;
+  std::nth_element(batch_latencies_micros_.begin(), p99,
+                   batch_latencies_micros_.end());
+  const int64 p99_latency_micros = *p99;
+  batch_latencies_micros_.clear();
+
+  // Over the target, stop waiting for tasks first, and only then shrink
+  // batches; under it, grow them back in the reverse order. The margin keeps
+  // the policy from oscillating around the target.
+  const int64 target_micros = options_.target_latency_micros;
+  const size_t max_size = max_execution_batch_size();
+  if (p99_latency_micros > target_micros) {
+    if (adaptive_batch_timeout_micros_ > 0) {
+      adaptive_batch_timeout_micros_ /= 2;
+    } else {
+      adaptive_batch_size_limit_ =
+          std::max<size_t>(1, adaptive_batch_size_limit_ * 3 / 4);
+    }
+  } else if (p99_latency_micros < target_micros * 4 / 5) {
+    if (adaptive_batch_size_limit_ < max_size) {
+      adaptive_batch_size_limit_ = std::min(
+          max_size,
+          adaptive_batch_size_limit_ +
+              std::max<size_t>(1, adaptive_batch_size_limit_ / 4));
+    } else {
+      adaptive_batch_timeout_micros_ = std::min(
+          options_.batch_timeout_micros,
+          adaptive_batch_timeout_micros_ +
+              std::max<int64>(1, options_.batch_timeout_micros / 8));
+    }
+  }
+
+  // Waiting longer than the latency budget left after processing, or than it
+  // takes to fill a batch at the current arrival rate, only adds latency.
+  adaptive_batch_timeout_micros_ = std::min<int64>(
+      adaptive_batch_timeout_micros_,
+      std::max<int64>(0, target_micros - batch_processing_micros_));
+  if (task_unit_interval_micros_ > 0) {
+    adaptive_batch_timeout_micros_ = std::min<int64>(
+        adaptive_batch_timeout_micros_,
+        adaptive_batch_size_limit_ * task_unit_interval_micros_);
+  }
+
+  RecordAdaptiveBatchingPolicy(options_.model_name,
+                               adaptive_batch_timeout_micros_,
+                               adaptive_batch_size_limit_, p99_latency_micros);
 }
 
 template <typename TaskType>
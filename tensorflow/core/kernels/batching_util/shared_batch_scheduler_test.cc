@@ -28,22 +28,28 @@ namespace {
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size,
+                    BatchTaskPriority priority = BatchTaskPriority::kCritical)
+      : size_(size), priority_(priority) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  BatchTaskPriority priority() const override { return priority_; }
+
  private:
   const size_t size_;
+  const BatchTaskPriority priority_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
 
 // Creates a FakeTask of size 'task_size', and calls 'scheduler->Schedule()' on
 // that task. Returns the resulting status.
-Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
-  std::unique_ptr<FakeTask> task(new FakeTask(task_size));
+Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler,
+                    BatchTaskPriority priority = BatchTaskPriority::kCritical) {
+  std::unique_ptr<FakeTask> task(new FakeTask(task_size, priority));
   Status status = scheduler->Schedule(&task);
   // Schedule() should have consumed 'task' iff it returned Status::OK.
   CHECK_EQ(status.ok(), task == nullptr);
@@ -254,6 +260,124 @@ TEST(SharedBatchSchedulerTest, ObeysTimeout) {
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, AdaptsTimeoutToTargetLatency) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    // Enough full batches for the policy to update once, and an underfull one.
+    constexpr int kNumBatches = 33;
+    std::vector<Notification> batch_processed(kNumBatches);
+    int num_batches_processed = 0;
+    auto callback = [&env, &batch_processed, &num_batches_processed](
+                        std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      // Every batch takes longer to process than the target latency.
+      env.AdvanceByMicroseconds(200);
+      batch_processed[num_batches_processed++].Notify();
+    };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 4;
+    queue_options.batch_timeout_micros = 1000;
+    queue_options.target_latency_micros = 100;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    for (int i = 0; i < kNumBatches - 1; ++i) {
+      TF_ASSERT_OK(ScheduleTask(4, queue.get()));
+      batch_processed[i].WaitForNotification();
+    }
+
+    // Since the latency exceeds the target even without waiting for tasks, an
+    // underfull batch is now processed without waiting for the timeout.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    EXPECT_TRUE(WaitForNotificationWithTimeout(&batch_processed.back(),
+                                               10 * 1000 * 1000));
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerTest, FillsBatchesWithCriticalTasksFirst) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    // The priorities of the tasks in each processed batch, in order.
+    mutex mu;
+    std::vector<string> batches;
+    Notification first_batch_processed, second_batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      string priorities;
+      for (int i = 0; i < batch->num_tasks(); ++i) {
+        priorities += batch->task(i).priority() == BatchTaskPriority::kCritical
+                          ? "C"
+                          : "B";
+      }
+      mutex_lock l(mu);
+      batches.push_back(priorities);
+      if (batches.size() == 1) {
+        first_batch_processed.Notify();
+      } else {
+        second_batch_processed.Notify();
+      }
+    };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 3;
+    queue_options.batch_timeout_micros = 10;
+    queue_options.max_enqueued_batches = 2;
+    queue_options.max_enqueued_best_effort_batches = 1;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // Fill the best-effort lane, and overflow it.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(), BatchTaskPriority::kBestEffort));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(), BatchTaskPriority::kBestEffort));
+    Status status =
+        ScheduleTask(2, queue.get(), BatchTaskPriority::kBestEffort);
+    EXPECT_EQ(error::UNAVAILABLE, status.code());
+    EXPECT_EQ(2, queue->NumEnqueuedTasks());
+
+    // A critical task gets into the next batch ahead of the best-effort ones,
+    // which only take the room left.
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+    first_batch_processed.WaitForNotification();
+
+    // The remaining best-effort task is processed once it times out.
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(second_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(10);
+    second_batch_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(batches, std::vector<string>({"CB", "B"}));
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   Notification first_batch_processed, second_batch_processed;
   auto callback = [&first_batch_processed, &second_batch_processed](
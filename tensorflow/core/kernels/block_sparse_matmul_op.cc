@@ -0,0 +1,234 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Rows of `a` multiplied together, so that each row of a block is loaded once
+// for all of them.
+constexpr int64 kRowTile = 4;
+
+// Rows of `a` handled by each unit of sharded work.
+constexpr int64 kRowsPerShard = 64;
+
+// Computes rows [0, num_rows) of one block column of the product: out[r, :] is
+// the sum over the blocks [begin, end) of a[r, block_k * indices[p] + j] times
+// row j of block p. Each block is [block_k, block_n], row-major. The
+// accumulators have a fixed size for the common block widths, so that Eigen
+// keeps them in SIMD registers and updates them with packet multiply-adds.
+template <typename T, int kBlockN>
+void BlockColumnProduct(const T* a, int64 lda, const T* values,
+                        const int32* indices, int64 begin, int64 end,
+                        int64 block_k, int64 block_n, int64 num_rows, T* out,
+                        int64 ldo) {
+  using Row = Eigen::Matrix<T, 1, kBlockN>;
+  using ConstRowMap = Eigen::Map<const Row>;
+  using RowMap = Eigen::Map<Row>;
+  const int64 block_size = block_k * block_n;
+
+  int64 r = 0;
+  for (; r + kRowTile <= num_rows; r += kRowTile) {
+    Row acc0 = Row::Zero(block_n);
+    Row acc1 = Row::Zero(block_n);
+    Row acc2 = Row::Zero(block_n);
+    Row acc3 = Row::Zero(block_n);
+    for (int64 p = begin; p < end; ++p) {
+      const T* block = values + p * block_size;
+      const T* a0 = a + r * lda + indices[p] * block_k;
+      const T* a1 = a0 + lda;
+      const T* a2 = a1 + lda;
+      const T* a3 = a2 + lda;
+      for (int64 j = 0; j < block_k; ++j) {
+        ConstRowMap b(block + j * block_n, block_n);
+        acc0.noalias() += a0[j] * b;
+        acc1.noalias() += a1[j] * b;
+        acc2.noalias() += a2[j] * b;
+        acc3.noalias() += a3[j] * b;
+      }
+    }
+    RowMap(out + r * ldo, block_n) = acc0;
+    RowMap(out + (r + 1) * ldo, block_n) = acc1;
+    RowMap(out + (r + 2) * ldo, block_n) = acc2;
+    RowMap(out + (r + 3) * ldo, block_n) = acc3;
+  }
+  for (; r < num_rows; ++r) {
+    Row acc = Row::Zero(block_n);
+    for (int64 p = begin; p < end; ++p) {
+      const T* block = values + p * block_size;
+      const T* a_row = a + r * lda + indices[p] * block_k;
+      for (int64 j = 0; j < block_k; ++j) {
+        acc.noalias() += a_row[j] * ConstRowMap(block + j * block_n, block_n);
+      }
+    }
+    RowMap(out + r * ldo, block_n) = acc;
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class BlockSparseMatMulOp : public OpKernel {
+ public:
+  explicit BlockSparseMatMulOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& values = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& row_ptr = context->input(3);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("a must be a matrix, got shape ",
+                                        a.shape().DebugString()));
+    OP_REQUIRES(context, values.dims() == 3,
+                errors::InvalidArgument("block_values must be 3-D, got shape ",
+                                        values.shape().DebugString()));
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVector(indices.shape()),
+        errors::InvalidArgument("block_indices must be a vector, got shape ",
+                                indices.shape().DebugString()));
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsVector(row_ptr.shape()) &&
+            row_ptr.NumElements() >= 1,
+        errors::InvalidArgument("block_row_ptr must be a non-empty vector, ",
+                                "got shape ", row_ptr.shape().DebugString()));
+
+    const int64 num_blocks = values.dim_size(0);
+    const int64 block_k = values.dim_size(1);
+    const int64 block_n = values.dim_size(2);
+    OP_REQUIRES(context, block_k > 0 && block_n > 0,
+                errors::InvalidArgument("Blocks must not be empty, got shape ",
+                                        values.shape().DebugString()));
+    OP_REQUIRES(
+        context, indices.NumElements() == num_blocks,
+        errors::InvalidArgument("block_indices has ", indices.NumElements(),
+                                " entries but there are ", num_blocks,
+                                " blocks"));
+
+    const int64 m = a.dim_size(0);
+    const int64 k = a.dim_size(1);
+    OP_REQUIRES(context, k % block_k == 0,
+                errors::InvalidArgument("a.shape[1] = ", k,
+                                        " is not a multiple of block_k = ",
+                                        block_k));
+    const int64 num_block_rows = k / block_k;
+
+    const auto indices_flat = indices.flat<int32>();
+    for (int64 p = 0; p < num_blocks; ++p) {
+      OP_REQUIRES(context,
+                  indices_flat(p) >= 0 && indices_flat(p) < num_block_rows,
+                  errors::InvalidArgument("block_indices[", p,
+                                          "] = ", indices_flat(p),
+                                          " is not in [0, ", num_block_rows,
+                                          ")"));
+    }
+    const auto row_ptr_flat = row_ptr.flat<int32>();
+    const int64 num_block_cols = row_ptr.NumElements() - 1;
+    OP_REQUIRES(context, row_ptr_flat(0) == 0,
+                errors::InvalidArgument("block_row_ptr[0] must be 0, got ",
+                                        row_ptr_flat(0)));
+    for (int64 j = 0; j < num_block_cols; ++j) {
+      OP_REQUIRES(
+          context, row_ptr_flat(j) <= row_ptr_flat(j + 1),
+          errors::InvalidArgument("block_row_ptr must be non-decreasing"));
+    }
+    OP_REQUIRES(context, row_ptr_flat(num_block_cols) == num_blocks,
+                errors::InvalidArgument(
+                    "block_row_ptr ends at ", row_ptr_flat(num_block_cols),
+                    " but there are ", num_blocks, " blocks"));
+
+    const int64 n = num_block_cols * block_n;
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, TensorShape({m, n}), &output));
+    if (output->NumElements() == 0) return;
+
+    const T* a_data = a.flat<T>().data();
+    const T* values_data = values.flat<T>().data();
+    const int32* indices_data = indices_flat.data();
+    const int32* row_ptr_data = row_ptr_flat.data();
+    T* out_data = output->flat<T>().data();
+
+    // Each unit of work is one block column for kRowsPerShard rows of `a`.
+    const int64 num_row_shards = (m + kRowsPerShard - 1) / kRowsPerShard;
+    auto compute = [&](int64 begin, int64 end) {
+      for (int64 unit = begin; unit < end; ++unit) {
+        const int64 col = unit / num_row_shards;
+        const int64 row_begin = (unit % num_row_shards) * kRowsPerShard;
+        const int64 num_rows = std::min(kRowsPerShard, m - row_begin);
+        BlockColumnProductFor(block_n)(
+            a_data + row_begin * k, k, values_data, indices_data,
+            row_ptr_data[col], row_ptr_data[col + 1], block_k, block_n,
+            num_rows, out_data + row_begin * n + col * block_n, n);
+      }
+    };
+    const int64 blocks_per_col =
+        std::max<int64>(1, num_blocks / num_block_cols);
+    const int64 cost_per_unit =
+        std::min(kRowsPerShard, m) * blocks_per_col * block_k * block_n;
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_block_cols * num_row_shards, cost_per_unit, compute);
+  }
+
+ private:
+  using BlockColumnProductFn = void (*)(const T*, int64, const T*,
+                                        const int32*, int64, int64, int64,
+                                        int64, int64, T*, int64);
+
+  static BlockColumnProductFn BlockColumnProductFor(int64 block_n) {
+    switch (block_n) {
+      case 4:
+        return BlockColumnProduct<T, 4>;
+      case 8:
+        return BlockColumnProduct<T, 8>;
+      case 16:
+        return BlockColumnProduct<T, 16>;
+      case 32:
+        return BlockColumnProduct<T, 32>;
+      default:
+        return BlockColumnProduct<T, Eigen::Dynamic>;
+    }
+  }
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockSparseMatMulOp);
+};
+
+#define REGISTER_CPU(T)                                                     \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_BlockSparseMatMul").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      BlockSparseMatMulOp<T>);
+
+REGISTER_CPU(float);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
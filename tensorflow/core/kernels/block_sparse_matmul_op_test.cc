@@ -0,0 +1,228 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// The block-sparse representation of a [k, n] matrix, as produced by the
+// remapper.
+struct BlockSparse {
+  Tensor values;
+  Tensor indices;
+  Tensor row_ptr;
+};
+
+BlockSparse ToBlockSparse(const Tensor& b, int block_k, int block_n) {
+  const int64 k = b.dim_size(0);
+  const int64 n = b.dim_size(1);
+  auto dense = b.matrix<float>();
+  std::vector<float> values;
+  std::vector<int32> indices;
+  std::vector<int32> row_ptr = {0};
+  for (int64 col = 0; col < n / block_n; ++col) {
+    for (int64 row = 0; row < k / block_k; ++row) {
+      bool nonzero = false;
+      for (int i = 0; i < block_k; ++i) {
+        for (int j = 0; j < block_n; ++j) {
+          nonzero |= dense(row * block_k + i, col * block_n + j) != 0;
+        }
+      }
+      if (!nonzero) continue;
+      indices.push_back(row);
+      for (int i = 0; i < block_k; ++i) {
+        for (int j = 0; j < block_n; ++j) {
+          values.push_back(dense(row * block_k + i, col * block_n + j));
+        }
+      }
+    }
+    row_ptr.push_back(indices.size());
+  }
+
+  BlockSparse result;
+  const int64 num_blocks = indices.size();
+  result.values = Tensor(DT_FLOAT, TensorShape({num_blocks, block_k, block_n}));
+  std::copy(values.begin(), values.end(), result.values.flat<float>().data());
+  result.indices = test::AsTensor<int32>(indices);
+  result.row_ptr = test::AsTensor<int32>(row_ptr);
+  return result;
+}
+
+// Returns a [k, n] matrix in which one block in `1 / density` is nonzero.
+Tensor RandomBlockSparse(int k, int n, int block_k, int block_n,
+                         int density) {
+  random::PhiloxRandom philox(17, 42);
+  random::SimplePhilox rnd(&philox);
+  Tensor b(DT_FLOAT, TensorShape({k, n}));
+  auto dense = b.matrix<float>();
+  dense.setZero();
+  for (int row = 0; row < k / block_k; ++row) {
+    for (int col = 0; col < n / block_n; ++col) {
+      if (rnd.Uniform(density) != 0) continue;
+      for (int i = 0; i < block_k; ++i) {
+        for (int j = 0; j < block_n; ++j) {
+          dense(row * block_k + i, col * block_n + j) = rnd.RandFloat() - 0.5f;
+        }
+      }
+    }
+  }
+  return b;
+}
+
+class BlockSparseMatMulOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("block_sparse_matmul", "_BlockSparseMatMul")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+  }
+
+  template <typename T>
+  void AddInputFromTensor(const Tensor& t) {
+    AddInputFromArray<T>(
+        t.shape(), gtl::ArraySlice<T>(t.flat<T>().data(), t.NumElements()));
+  }
+
+  // Checks the product of `a` with the block-sparse form of `b` against a
+  // dense reference.
+  void RunAndCompare(const Tensor& a, const Tensor& b, int block_k,
+                     int block_n) {
+    MakeOp();
+    BlockSparse sparse = ToBlockSparse(b, block_k, block_n);
+    AddInputFromTensor<float>(a);
+    AddInputFromTensor<float>(sparse.values);
+    AddInputFromTensor<int32>(sparse.indices);
+    AddInputFromTensor<int32>(sparse.row_ptr);
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT, TensorShape({a.dim_size(0), b.dim_size(1)}));
+    Eigen::array<Eigen::IndexPair<int>, 1> contract_dims = {
+        Eigen::IndexPair<int>(1, 0)};
+    expected.matrix<float>() =
+        a.matrix<float>().contract(b.matrix<float>(), contract_dims);
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+  }
+};
+
+TEST_F(BlockSparseMatMulOpTest, Small) {
+  // b = [[1, 2, 0, 0],
+  //      [3, 4, 0, 0],
+  //      [0, 0, 0, 0],
+  //      [0, 0, 5, 6]] with 1x2 blocks.
+  Tensor a = test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8}, {2, 4});
+  Tensor b = test::AsTensor<float>(
+      {1, 2, 0, 0, 3, 4, 0, 0, 0, 0, 0, 0, 0, 0, 5, 6}, {4, 4});
+  RunAndCompare(a, b, 1, 2);
+}
+
+TEST_F(BlockSparseMatMulOpTest, VectorizedBlockWidths) {
+  for (int block_n : {4, 8, 16, 32}) {
+    for (int m : {1, 5, 67}) {
+      Tensor a(DT_FLOAT, TensorShape({m, 64}));
+      a.flat<float>().setRandom();
+      RunAndCompare(a, RandomBlockSparse(64, 4 * block_n, 4, block_n, 3), 4,
+                    block_n);
+    }
+  }
+}
+
+TEST_F(BlockSparseMatMulOpTest, OtherBlockWidth) {
+  Tensor a(DT_FLOAT, TensorShape({9, 30}));
+  a.flat<float>().setRandom();
+  RunAndCompare(a, RandomBlockSparse(30, 36, 3, 12, 2), 3, 12);
+}
+
+TEST_F(BlockSparseMatMulOpTest, EmptyBlockColumns) {
+  Tensor a(DT_FLOAT, TensorShape({3, 16}));
+  a.flat<float>().setRandom();
+  Tensor b(DT_FLOAT, TensorShape({16, 32}));
+  b.flat<float>().setZero();
+  RunAndCompare(a, b, 4, 8);
+}
+
+TEST_F(BlockSparseMatMulOpTest, RejectsOutOfRangeIndex) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({1, 4}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<int32>(TensorShape({1}), {2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "is not in [0, 2)")) << s;
+}
+
+// Performance benchmarks below.
+
+// Multiplies [m, k] by a [k, n] matrix with one block in `density` nonzero,
+// as a dense MatMul or a _BlockSparseMatMul.
+static Graph* BlockSparseMatMul(int m, int k, int n, int density,
+                                bool sparse) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor a(DT_FLOAT, TensorShape({m, k}));
+  a.flat<float>().setRandom();
+  Tensor b = RandomBlockSparse(k, n, 4, 16, density);
+  Node* a_node = test::graph::Constant(g, a);
+
+  if (sparse) {
+    BlockSparse b_sparse = ToBlockSparse(b, 4, 16);
+    TF_CHECK_OK(NodeBuilder(g->NewName("block_sparse_matmul"),
+                            "_BlockSparseMatMul")
+                    .Input(a_node)
+                    .Input(test::graph::Constant(g, b_sparse.values))
+                    .Input(test::graph::Constant(g, b_sparse.indices))
+                    .Input(test::graph::Constant(g, b_sparse.row_ptr))
+                    .Finalize(g, nullptr));
+  } else {
+    test::graph::Matmul(g, a_node, test::graph::Constant(g, b), false, false);
+  }
+  return g;
+}
+
+#define BM_BlockSparseMatMul(M, K, N, D, S, NAME)                          \
+  static void BM_BlockSparseMatMul_##NAME##_##M##_##K##_##N##_##D(         \
+      int iters) {                                                         \
+    testing::ItemsProcessed(static_cast<int64>(iters) * M * K * N * 2);    \
+    test::Benchmark("cpu", BlockSparseMatMul(M, K, N, D, S)).Run(iters);   \
+  }                                                                        \
+  BENCHMARK(BM_BlockSparseMatMul_##NAME##_##M##_##K##_##N##_##D);
+
+BM_BlockSparseMatMul(1, 1024, 1024, 10, false, Dense);
+BM_BlockSparseMatMul(1, 1024, 1024, 10, true, Sparse);
+BM_BlockSparseMatMul(32, 1024, 1024, 10, false, Dense);
+BM_BlockSparseMatMul(32, 1024, 1024, 10, true, Sparse);
+BM_BlockSparseMatMul(256, 2048, 2048, 10, false, Dense);
+BM_BlockSparseMatMul(256, 2048, 2048, 10, true, Sparse);
+
+}  // namespace
+}  // namespace tensorflow
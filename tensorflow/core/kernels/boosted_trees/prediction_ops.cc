@@ -235,6 +235,19 @@ class BoostedTreesPredictOp : public OpKernel {
       return;
     }
 
+    std::shared_ptr<const BoostedTreesFlatEnsemble> flat_ensemble;
+    {
+      tf_shared_lock l(*resource->get_mutex());
+      flat_ensemble = resource->GetFlatEnsemble(logits_dimension_);
+    }
+    if (flat_ensemble != nullptr) {
+      OP_REQUIRES_OK(context,
+                     flat_ensemble->ValidateFeatures(bucketized_features));
+      PredictWithFlatEnsemble(context, *flat_ensemble, bucketized_features,
+                              &output_logits);
+      return;
+    }
+
     const int32 last_tree = resource->num_trees() - 1;
     auto do_work = [&resource, &bucketized_features, &output_logits, last_tree,
                     this](int32 start, int32 end) {
@@ -278,6 +291,52 @@ class BoostedTreesPredictOp : public OpKernel {
   }
 
  private:
+  // Sets `output_logits` to the predictions of `flat_ensemble`.  The examples
+  // are processed by blocks, tree by tree, so that the nodes of a tree stay in
+  // cache while the examples of a block are routed through it.  The logits of
+  // each example are still added in tree order.
+  void PredictWithFlatEnsemble(
+      OpKernelContext* const context,
+      const BoostedTreesFlatEnsemble& flat_ensemble,
+      const std::vector<TTypes<int32>::ConstMatrix>& bucketized_features,
+      TTypes<float>::Matrix* output_logits) {
+    constexpr int32 kBlockSize = 16;
+    const int32 num_trees = flat_ensemble.num_trees();
+    auto do_work = [&flat_ensemble, &bucketized_features, output_logits,
+                    num_trees, this](int32 start, int32 end) {
+      std::vector<float> block_logits(kBlockSize * logits_dimension_);
+      for (int32 block_start = start; block_start < end;
+           block_start += kBlockSize) {
+        const int32 block_end = std::min(block_start + kBlockSize, end);
+        std::fill(block_logits.begin(), block_logits.end(), 0.0f);
+        for (int32 tree_id = 0; tree_id < num_trees; ++tree_id) {
+          const float tree_weight = flat_ensemble.tree_weight(tree_id);
+          for (int32 i = block_start; i < block_end; ++i) {
+            const float* leaf_logits =
+                flat_ensemble.FindLeafLogits(tree_id, i, bucketized_features);
+            float* tree_logits =
+                &block_logits[(i - block_start) * logits_dimension_];
+            for (int32 j = 0; j < logits_dimension_; ++j) {
+              tree_logits[j] += tree_weight * leaf_logits[j];
+            }
+          }
+        }
+        for (int32 i = block_start; i < block_end; ++i) {
+          for (int32 j = 0; j < logits_dimension_; ++j) {
+            (*output_logits)(i, j) =
+                block_logits[(i - block_start) * logits_dimension_ + j];
+          }
+        }
+      }
+    };
+    // Same cost as the unflattened prediction.
+    const int64 cost = num_trees * 10;
+    thread::ThreadPool* const worker_threads =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
+    Shard(worker_threads->NumThreads(), worker_threads,
+          output_logits->dimension(0), /*cost_per_unit=*/cost, do_work);
+  }
+
   int32
       logits_dimension_;  // Indicates the size of the output prediction vector.
   int32 num_bucketized_features_;  // Indicates the number of features.
@@ -15,14 +15,119 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/boosted_trees/resources.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/kernels/boosted_trees/boosted_trees.pb.h"
 #include "tensorflow/core/kernels/boosted_trees/tree_helper.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 
 namespace tensorflow {
 
+/* static */ std::unique_ptr<const BoostedTreesFlatEnsemble>
+BoostedTreesFlatEnsemble::Create(const boosted_trees::TreeEnsemble& ensemble,
+                                 const int32 logits_dimension) {
+  std::unique_ptr<BoostedTreesFlatEnsemble> flat(new BoostedTreesFlatEnsemble);
+  flat->roots_.reserve(ensemble.trees_size());
+  flat->tree_weights_.reserve(ensemble.trees_size());
+  for (int32 tree_id = 0; tree_id < ensemble.trees_size(); ++tree_id) {
+    const auto& tree = ensemble.trees(tree_id);
+    if (tree.nodes_size() == 0 || tree_id >= ensemble.tree_weights_size()) {
+      return nullptr;
+    }
+    const int32 root = flat->type_.size();
+    flat->roots_.push_back(root);
+    flat->tree_weights_.push_back(ensemble.tree_weights(tree_id));
+    for (const boosted_trees::Node& node : tree.nodes()) {
+      int32 feature_id = 0;
+      int32 dimension_id = 0;
+      switch (node.node_case()) {
+        case boosted_trees::Node::kLeaf: {
+          flat->type_.push_back(kLeaf);
+          flat->threshold_.push_back(0);
+          flat->left_.push_back(flat->leaf_logits_.size());
+          flat->right_.push_back(0);
+          const auto& leaf = node.leaf();
+          for (int32 j = 0; j < logits_dimension; ++j) {
+            float logit = 0;
+            if (leaf.has_vector()) {
+              if (j < leaf.vector().value_size()) {
+                logit = leaf.vector().value(j);
+              }
+            } else if (j == 0) {
+              logit = leaf.scalar();
+            }
+            flat->leaf_logits_.push_back(logit);
+          }
+          break;
+        }
+        case boosted_trees::Node::kBucketizedSplit: {
+          const auto& split = node.bucketized_split();
+          flat->type_.push_back(kBucketizedSplit);
+          feature_id = split.feature_id();
+          dimension_id = split.dimension_id();
+          flat->threshold_.push_back(split.threshold());
+          flat->left_.push_back(root + split.left_id());
+          flat->right_.push_back(root + split.right_id());
+          break;
+        }
+        case boosted_trees::Node::kCategoricalSplit: {
+          const auto& split = node.categorical_split();
+          flat->type_.push_back(kCategoricalSplit);
+          feature_id = split.feature_id();
+          dimension_id = split.dimension_id();
+          flat->threshold_.push_back(split.value());
+          flat->left_.push_back(root + split.left_id());
+          flat->right_.push_back(root + split.right_id());
+          break;
+        }
+        default:
+          return nullptr;
+      }
+      if (feature_id < 0 || dimension_id < 0) return nullptr;
+      flat->feature_id_.push_back(feature_id);
+      flat->dimension_id_.push_back(dimension_id);
+      if (flat->type_.back() != kLeaf) {
+        if (feature_id >= flat->feature_dimensions_.size()) {
+          flat->feature_dimensions_.resize(feature_id + 1, 0);
+        }
+        flat->feature_dimensions_[feature_id] =
+            std::max(flat->feature_dimensions_[feature_id], dimension_id + 1);
+      }
+    }
+    // The children of the splits must be nodes of the same tree.
+    const int32 end = flat->type_.size();
+    for (int32 node = root; node < end; ++node) {
+      if (flat->type_[node] != kLeaf &&
+          (flat->left_[node] < root || flat->left_[node] >= end ||
+           flat->right_[node] < root || flat->right_[node] >= end)) {
+        return nullptr;
+      }
+    }
+  }
+  return std::move(flat);
+}
+
+Status BoostedTreesFlatEnsemble::ValidateFeatures(
+    const std::vector<TTypes<int32>::ConstMatrix>& bucketized_features) const {
+  if (feature_dimensions_.size() > bucketized_features.size()) {
+    return errors::InvalidArgument(
+        "The ensemble splits on feature ", feature_dimensions_.size() - 1,
+        ", but there are only ", bucketized_features.size(), " features.");
+  }
+  for (int32 i = 0; i < feature_dimensions_.size(); ++i) {
+    if (feature_dimensions_[i] > bucketized_features[i].dimension(1)) {
+      return errors::InvalidArgument(
+          "The ensemble splits on dimension ", feature_dimensions_[i] - 1,
+          " of feature ", i, ", which has ",
+          bucketized_features[i].dimension(1), " dimensions.");
+    }
+  }
+  return Status::OK();
+}
+
 // Constructor.
 BoostedTreesEnsembleResource::BoostedTreesEnsembleResource()
     : tree_ensemble_(
@@ -366,9 +471,28 @@ boosted_trees::Node* BoostedTreesEnsembleResource::AddLeafNodes(
   return node;
 }
 
+std::shared_ptr<const BoostedTreesFlatEnsemble>
+BoostedTreesEnsembleResource::GetFlatEnsemble(const int32 logits_dimension) {
+  mutex_lock l(flat_ensemble_mu_);
+  if (!has_flat_ensemble_ || flat_ensemble_stamp_ != stamp() ||
+      flat_ensemble_logits_dimension_ != logits_dimension) {
+    flat_ensemble_ =
+        BoostedTreesFlatEnsemble::Create(*tree_ensemble_, logits_dimension);
+    has_flat_ensemble_ = true;
+    flat_ensemble_stamp_ = stamp();
+    flat_ensemble_logits_dimension_ = logits_dimension;
+  }
+  return flat_ensemble_;
+}
+
 void BoostedTreesEnsembleResource::Reset() {
   // Reset stamp.
   set_stamp(-1);
+  {
+    mutex_lock l(flat_ensemble_mu_);
+    flat_ensemble_.reset();
+    has_flat_ensemble_ = false;
+  }
 
   // Clear tree ensemle.
   arena_.Reset();
@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BOOSTED_TREES_RESOURCES_H_
 #define TENSORFLOW_CORE_KERNELS_BOOSTED_TREES_RESOURCES_H_
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/kernels/boosted_trees/tree_helper.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -45,6 +49,78 @@ class StampedResource : public ResourceBase {
   int64 stamp_;
 };
 
+// The trees of an ensemble flattened into arrays, for fast prediction.  The
+// nodes of all the trees are stored together, and a split node refers to its
+// children by their index in the arrays.
+class BoostedTreesFlatEnsemble {
+ public:
+  // Flattens `ensemble` for the prediction of `logits_dimension` logits.
+  // Returns nullptr if the ensemble has a node that can't be flattened.
+  static std::unique_ptr<const BoostedTreesFlatEnsemble> Create(
+      const boosted_trees::TreeEnsemble& ensemble, int32 logits_dimension);
+
+  int32 num_trees() const { return roots_.size(); }
+
+  float tree_weight(const int32 tree_id) const {
+    return tree_weights_[tree_id];
+  }
+
+  // Returns OK if `bucketized_features` has all the features and dimensions
+  // that the splits compare.
+  Status ValidateFeatures(const std::vector<TTypes<int32>::ConstMatrix>&
+                              bucketized_features) const;
+
+  // Returns the logits of the leaf of tree `tree_id` that example
+  // `index_in_batch` falls into.
+  const float* FindLeafLogits(const int32 tree_id, const int32 index_in_batch,
+                              const std::vector<TTypes<int32>::ConstMatrix>&
+                                  bucketized_features) const {
+    int32 node = roots_[tree_id];
+    while (true) {
+      switch (type_[node]) {
+        case kLeaf:
+          return &leaf_logits_[left_[node]];
+        case kBucketizedSplit:
+          node = bucketized_features[feature_id_[node]](
+                     index_in_batch, dimension_id_[node]) <= threshold_[node]
+                     ? left_[node]
+                     : right_[node];
+          break;
+        case kCategoricalSplit:
+          node = bucketized_features[feature_id_[node]](
+                     index_in_batch, dimension_id_[node]) == threshold_[node]
+                     ? left_[node]
+                     : right_[node];
+          break;
+      }
+    }
+  }
+
+ private:
+  enum NodeType : int8 { kLeaf, kBucketizedSplit, kCategoricalSplit };
+
+  BoostedTreesFlatEnsemble() = default;
+
+  // The index of the root node and the weight of each tree.
+  std::vector<int32> roots_;
+  std::vector<float> tree_weights_;
+  // The nodes.  A split compares dimension `dimension_id_` of feature
+  // `feature_id_` with `threshold_`, which is the category of categorical
+  // splits.  The `left_` of a leaf is the offset of its logits in
+  // `leaf_logits_`.
+  std::vector<NodeType> type_;
+  std::vector<int32> feature_id_;
+  std::vector<int32> dimension_id_;
+  std::vector<int32> threshold_;
+  std::vector<int32> left_;
+  std::vector<int32> right_;
+  std::vector<float> leaf_logits_;
+  // The number of dimensions of each feature that the splits compare.
+  std::vector<int32> feature_dimensions_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BoostedTreesFlatEnsemble);
+};
+
 // Keep a tree ensemble in memory for efficient evaluation and mutation.
 class BoostedTreesEnsembleResource : public StampedResource {
  public:
@@ -152,6 +228,13 @@ class BoostedTreesEnsembleResource : public StampedResource {
                               std::vector<float>* logit_updates) const;
   mutex* get_mutex() { return &mu_; }
 
+  // Returns the ensemble flattened for the prediction of `logits_dimension`
+  // logits, or nullptr if it can't be flattened.  The flattened ensemble is
+  // rebuilt once the stamp changed.
+  // Caller needs to hold the mutex (shared) while calling this.
+  std::shared_ptr<const BoostedTreesFlatEnsemble> GetFlatEnsemble(
+      const int32 logits_dimension);
+
  private:
   // Helper method to check whether a node is a terminal node in that it
   // only has leaf nodes as children.
@@ -176,6 +259,15 @@ class BoostedTreesEnsembleResource : public StampedResource {
   mutex mu_;
   boosted_trees::TreeEnsemble* tree_ensemble_;
 
+  mutex flat_ensemble_mu_;
+  std::shared_ptr<const BoostedTreesFlatEnsemble> flat_ensemble_
+      TF_GUARDED_BY(flat_ensemble_mu_);
+  // Whether `flat_ensemble_` was created, and for which stamp and logits
+  // dimension.
+  bool has_flat_ensemble_ TF_GUARDED_BY(flat_ensemble_mu_) = false;
+  int64 flat_ensemble_stamp_ TF_GUARDED_BY(flat_ensemble_mu_) = -1;
+  int32 flat_ensemble_logits_dimension_ TF_GUARDED_BY(flat_ensemble_mu_) = 0;
+
   boosted_trees::Node* AddLeafNodes(
       int32 tree_id,
       const std::pair<int32, boosted_trees::SplitCandidate>& split_entry,
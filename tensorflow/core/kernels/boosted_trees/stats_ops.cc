@@ -22,7 +22,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/boosted_trees/boosted_trees.pb.h"
 #include "tensorflow/core/kernels/boosted_trees/tree_helper.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -104,77 +106,113 @@ class BoostedTreesCalculateBestGainsPerFeatureOp : public OpKernel {
     // CalculateWeightsAndGains. This op only supports single dimension logits.
     Eigen::MatrixXf identity;
     identity.setIdentity(1, 1);
-    // Get the best split info per node for each feature.
-    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
-      std::vector<float> cum_grad;
-      std::vector<float> cum_hess;
-      cum_grad.reserve(num_buckets);
-      cum_hess.reserve(num_buckets);
-
-      std::vector<int32> output_node_ids;
-      std::vector<float> output_gains;
-      std::vector<int32> output_thresholds;
-      std::vector<float> output_left_node_contribs;
-      std::vector<float> output_right_node_contribs;
-      for (int node_id = node_id_first; node_id < node_id_last; ++node_id) {
-        // Calculate gains.
-        cum_grad.clear();
-        cum_hess.clear();
-        float total_grad = 0.0;
-        float total_hess = 0.0;
-        for (int bucket = 0; bucket < num_buckets; ++bucket) {
-          // TODO(nponomareva): Consider multi-dimensional gradients/hessians.
-          total_grad += stats_summary[feature_idx](node_id, bucket, 0);
-          total_hess += stats_summary[feature_idx](node_id, bucket, 1);
-          cum_grad.push_back(total_grad);
-          cum_hess.push_back(total_hess);
-        }
-        // Check if node has enough of average hessian.
-        if (total_hess < min_node_weight) {
-          // Do not split the node because not enough avg hessian.
-          continue;
-        }
-        float best_gain = std::numeric_limits<float>::lowest();
-        float best_bucket = 0;
-        float best_contrib_for_left = 0.0;
-        float best_contrib_for_right = 0.0;
-        // Parent gain.
-        float parent_gain;
-        Eigen::VectorXf unused(1);
-        CalculateWeightsAndGains(total_grad * identity, total_hess * identity,
-                                 l1, l2, &unused, &parent_gain);
-
-        for (int bucket = 0; bucket < num_buckets; ++bucket) {
-          const float cum_grad_bucket = cum_grad[bucket];
-          const float cum_hess_bucket = cum_hess[bucket];
-          // Left child.
-          Eigen::VectorXf contrib_for_left(1);
-          float gain_for_left;
-          CalculateWeightsAndGains(cum_grad_bucket * identity,
-                                   cum_hess_bucket * identity, l1, l2,
-                                   &contrib_for_left, &gain_for_left);
-          // Right child.
-          // use contrib_for_right.
-          Eigen::VectorXf contrib_for_right(1);
-          float gain_for_right;
-          CalculateWeightsAndGains((total_grad - cum_grad_bucket) * identity,
-                                   (total_hess - cum_hess_bucket) * identity,
-                                   l1, l2, &contrib_for_right, &gain_for_right);
-
-          if (GainIsLarger(gain_for_left + gain_for_right, best_gain)) {
-            best_gain = gain_for_left + gain_for_right;
-            best_bucket = bucket;
-            best_contrib_for_left = contrib_for_left[0];
-            best_contrib_for_right = contrib_for_right[0];
+    // Get the best split info per node for each feature.  The features are
+    // processed in parallel, and their outputs allocated afterwards.
+    struct FeatureSplits {
+      std::vector<int32> node_ids;
+      std::vector<float> gains;
+      std::vector<int32> thresholds;
+      std::vector<float> left_node_contribs;
+      std::vector<float> right_node_contribs;
+    };
+    std::vector<FeatureSplits> feature_splits(num_features_);
+    auto find_splits = [&](int64 start, int64 end) {
+      for (int feature_idx = start; feature_idx < end; ++feature_idx) {
+        std::vector<float> cum_grad;
+        std::vector<float> cum_hess;
+        cum_grad.reserve(num_buckets);
+        cum_hess.reserve(num_buckets);
+
+        std::vector<int32>& output_node_ids =
+            feature_splits[feature_idx].node_ids;
+        std::vector<float>& output_gains = feature_splits[feature_idx].gains;
+        std::vector<int32>& output_thresholds =
+            feature_splits[feature_idx].thresholds;
+        std::vector<float>& output_left_node_contribs =
+            feature_splits[feature_idx].left_node_contribs;
+        std::vector<float>& output_right_node_contribs =
+            feature_splits[feature_idx].right_node_contribs;
+        for (int node_id = node_id_first; node_id < node_id_last; ++node_id) {
+          // Calculate gains.
+          cum_grad.clear();
+          cum_hess.clear();
+          float total_grad = 0.0;
+          float total_hess = 0.0;
+          for (int bucket = 0; bucket < num_buckets; ++bucket) {
+            // TODO(nponomareva): Consider multi-dimensional gradients/hessians.
+            total_grad += stats_summary[feature_idx](node_id, bucket, 0);
+            total_hess += stats_summary[feature_idx](node_id, bucket, 1);
+            cum_grad.push_back(total_grad);
+            cum_hess.push_back(total_hess);
+          }
+          // Check if node has enough of average hessian.
+          if (total_hess < min_node_weight) {
+            // Do not split the node because not enough avg hessian.
+            continue;
           }
-        }  // for bucket
-        output_node_ids.push_back(node_id);
-        // Remove the parent gain for the parent node.
-        output_gains.push_back(best_gain - parent_gain);
-        output_thresholds.push_back(best_bucket);
-        output_left_node_contribs.push_back(best_contrib_for_left);
-        output_right_node_contribs.push_back(best_contrib_for_right);
-      }  // for node_id
+          float best_gain = std::numeric_limits<float>::lowest();
+          float best_bucket = 0;
+          float best_contrib_for_left = 0.0;
+          float best_contrib_for_right = 0.0;
+          // Parent gain.
+          float parent_gain;
+          Eigen::VectorXf unused(1);
+          CalculateWeightsAndGains(total_grad * identity, total_hess * identity,
+                                   l1, l2, &unused, &parent_gain);
+
+          for (int bucket = 0; bucket < num_buckets; ++bucket) {
+            const float cum_grad_bucket = cum_grad[bucket];
+            const float cum_hess_bucket = cum_hess[bucket];
+            // Left child.
+            Eigen::VectorXf contrib_for_left(1);
+            float gain_for_left;
+            CalculateWeightsAndGains(cum_grad_bucket * identity,
+                                     cum_hess_bucket * identity, l1, l2,
+                                     &contrib_for_left, &gain_for_left);
+            // Right child.
+            // use contrib_for_right.
+            Eigen::VectorXf contrib_for_right(1);
+            float gain_for_right;
+            CalculateWeightsAndGains(
+              (total_grad - cum_grad_bucket) * identity,
+              (total_hess - cum_hess_bucket) * identity, l1, l2,
+              &contrib_for_right, &gain_for_right);
+
+            if (GainIsLarger(gain_for_left + gain_for_right, best_gain)) {
+              best_gain = gain_for_left + gain_for_right;
+              best_bucket = bucket;
+              best_contrib_for_left = contrib_for_left[0];
+              best_contrib_for_right = contrib_for_right[0];
+            }
+          }  // for bucket
+          output_node_ids.push_back(node_id);
+          // Remove the parent gain for the parent node.
+          output_gains.push_back(best_gain - parent_gain);
+          output_thresholds.push_back(best_bucket);
+          output_left_node_contribs.push_back(best_contrib_for_left);
+          output_right_node_contribs.push_back(best_contrib_for_right);
+        }  // for node_id
+      }
+    };
+    // Each (node, bucket) pair costs about two CalculateWeightsAndGains().
+    const int64 cost_per_feature =
+        static_cast<int64>(node_id_last - node_id_first) * num_buckets * 100;
+    thread::ThreadPool* const worker_threads =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
+    Shard(worker_threads->NumThreads(), worker_threads, num_features_,
+          cost_per_feature, find_splits);
+
+    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
+      const std::vector<int32>& output_node_ids =
+          feature_splits[feature_idx].node_ids;
+      const std::vector<float>& output_gains =
+          feature_splits[feature_idx].gains;
+      const std::vector<int32>& output_thresholds =
+          feature_splits[feature_idx].thresholds;
+      const std::vector<float>& output_left_node_contribs =
+          feature_splits[feature_idx].left_node_contribs;
+      const std::vector<float>& output_right_node_contribs =
+          feature_splits[feature_idx].right_node_contribs;
       const int num_nodes = output_node_ids.size();
       // output_node_ids
       Tensor* output_node_ids_t;
@@ -1277,16 +1315,24 @@ class BoostedTreesMakeStatsSummaryOp : public OpKernel {
     auto temp_stats_double = temp_stats_double_t.tensor<double, 4>();
     temp_stats_double.setZero();
 
-    // Partition by node, and then bucketize.
-    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
-      const auto& features = bucketized_features_list[feature_idx].vec<int32>();
-      for (int i = 0; i < batch_size; ++i) {
-        const int32 node = node_ids(i);
-        const int32 bucket = features(i);
-        temp_stats_double(feature_idx, node, bucket, 0) += gradients(i, 0);
-        temp_stats_double(feature_idx, node, bucket, 1) += hessians(i, 0);
+    // Partition by node, and then bucketize.  The features accumulate into
+    // disjoint slices of the stats, so they are processed in parallel.
+    auto accumulate = [&](int64 start, int64 end) {
+      for (int feature_idx = start; feature_idx < end; ++feature_idx) {
+        const auto& features =
+            bucketized_features_list[feature_idx].vec<int32>();
+        for (int i = 0; i < batch_size; ++i) {
+          const int32 node = node_ids(i);
+          const int32 bucket = features(i);
+          temp_stats_double(feature_idx, node, bucket, 0) += gradients(i, 0);
+          temp_stats_double(feature_idx, node, bucket, 1) += hessians(i, 0);
+        }
       }
-    }
+    };
+    thread::ThreadPool* const worker_threads =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
+    Shard(worker_threads->NumThreads(), worker_threads, num_features_,
+          /*cost_per_unit=*/batch_size * 10, accumulate);
 
     // Copy temp tensor over to output tensor.
     Tensor* output_stats_summary_t = nullptr;
@@ -16,6 +16,9 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_COLLECTIVE_NCCL_H_
 
 #include "tensorflow/core/framework/collective.h"
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/nccl/nccl_manager.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 namespace tensorflow {
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -39,6 +42,9 @@ class NcclBase : public CollectiveImplementationInterface {
  protected:
   const string NcclCollectiveKey(const string& exec_key, int step_id);
 
+  // Maps the name of a merge op to the corresponding NCCL reduction.
+  static Status ReductionOp(const string& merge_op, ncclRedOp_t* reduction_op);
+
   const CollectiveType type_;
   const string name_;
   std::shared_ptr<CollectiveContext> col_ctx_;
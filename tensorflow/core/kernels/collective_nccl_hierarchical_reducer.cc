@@ -0,0 +1,291 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/collective_nccl_hierarchical_reducer.h"
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/nccl/nccl_manager.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+namespace {
+// Starts an asynchronous call with `start` and waits for the callback passed
+// to it.
+Status RunAndWait(const std::function<void(const StatusCallback&)>& start) {
+  Notification note;
+  Status status;
+  start([&note, &status](const Status& s) {
+    status = s;
+    note.Notify();
+  });
+  note.WaitForNotification();
+  return status;
+}
+
+// Returns true for the types that the parts run outside of NCCL support.
+bool IsSupportedType(DataType dtype) {
+  switch (dtype) {
+    case DT_HALF:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+    case DT_INT32:
+    case DT_INT64:
+      return true;
+    default:
+      return false;
+  }
+}
+}  // namespace
+
+Status NcclHierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE ||
+      col_params->instance.impl_details.collective_name != name_) {
+    return errors::Internal("Unexpected combination of collective type ",
+                            col_params->instance.type, " and collective name ",
+                            col_params->instance.impl_details.collective_name,
+                            ", expected type ", REDUCTION_COLLECTIVE,
+                            " and name ", name_);
+  }
+  return Status::OK();
+}
+
+void NcclHierarchicalReducer::Run(StatusCallback done) {
+  const CollInstanceParams& instance = col_params_->instance;
+  const string& task = instance.task_names[col_params_->default_rank];
+  const int num_local_devices = instance.num_devices_per_task.at(task);
+  const int64 num_elements = col_ctx_->output->NumElements();
+  const int64 slice_elements = num_elements / num_local_devices;
+  const DataType dtype = col_ctx_->output->dtype();
+  if (col_params_->group.num_tasks < 2 || num_local_devices < 2 ||
+      !instance.same_num_devices_per_task || !IsSupportedType(dtype) ||
+      num_elements % num_local_devices != 0 ||
+      (slice_elements * DataTypeSize(dtype)) %
+              Allocator::kAllocatorAlignment !=
+          0) {
+    // The slices would not be aligned, which the chunks reduced outside of
+    // NCCL need to be.
+    NcclReducer::Run(std::move(done));
+    return;
+  }
+
+  ncclRedOp_t reduction_op;
+  Status s = ReductionOp(col_params_->merge_op->type_string(), &reduction_op);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  // The position of this device among the devices of its task in rank order,
+  // and its rank in a single-node communicator, which NcclManager orders by
+  // GPU id.
+  int position = 0;
+  int local_rank = 0;
+  const int gpu_id = col_ctx_->device->tensorflow_gpu_device_info()->gpu_id;
+  for (int r = 0; r < col_params_->group.group_size; ++r) {
+    if (r == col_params_->default_rank || instance.task_names[r] != task) {
+      continue;
+    }
+    if (r < col_params_->default_rank) ++position;
+    Device* device;
+    s = col_ctx_->dev_mgr->LookupDevice(instance.device_names[r], &device);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+    if (device->tensorflow_gpu_device_info()->gpu_id < gpu_id) ++local_rank;
+  }
+
+  Tensor flat_output;
+  CHECK(flat_output.CopyFrom(*col_ctx_->output, TensorShape({num_elements})));
+  Tensor slice = flat_output.Slice(local_rank * slice_elements,
+                                   (local_rank + 1) * slice_elements);
+  const string nccl_collective_key =
+      NcclCollectiveKey(col_ctx_->exec_key, col_ctx_->step_id);
+  VLOG(1) << "NcclHierarchicalReducer device " << col_ctx_->device_name
+          << " position " << position << " local rank " << local_rank
+          << " of " << num_local_devices << " instance "
+          << instance.instance_key;
+
+  {
+    // As in NcclReducer, launch the NCCL kernels in the order of the
+    // collective instances.
+    profiler::TraceMe activity("WaitForDependencies",
+                               profiler::TraceMeLevel::kInfo);
+    col_ctx_->col_exec->WaitForDependencies(*col_params_);
+  }
+  {
+    profiler::TraceMe activity("ReduceScatter", profiler::TraceMeLevel::kInfo);
+    s = RunAndWait([&](const StatusCallback& local_done) {
+      AddToLocalCollective(strings::StrCat(nccl_collective_key, ":rs"),
+                           /*reduce_scatter=*/true, reduction_op,
+                           num_local_devices, col_ctx_->input, &slice,
+                           local_done);
+      col_ctx_->col_exec->UnblockDependencies(*col_params_);
+    });
+  }
+  if (s.ok()) {
+    profiler::TraceMe activity("RingAllReduce", profiler::TraceMeLevel::kInfo);
+    s = RingAllReduce(position, &slice);
+  }
+  if (s.ok()) {
+    profiler::TraceMe activity("AllGather", profiler::TraceMeLevel::kInfo);
+    s = RunAndWait([&](const StatusCallback& local_done) {
+      AddToLocalCollective(strings::StrCat(nccl_collective_key, ":ag"),
+                           /*reduce_scatter=*/false, reduction_op,
+                           num_local_devices, &slice, &flat_output,
+                           local_done);
+    });
+  }
+  if (s.ok() && col_params_->final_op) {
+    s = RunFinalOp();
+  }
+  done(s);
+}
+
+void NcclHierarchicalReducer::AddToLocalCollective(
+    const string& collective_key, bool reduce_scatter,
+    ncclRedOp_t reduction_op, int num_local_devices, const Tensor* input,
+    Tensor* output, StatusCallback done) {
+  auto* compute_stream = col_ctx_->op_ctx->op_device_context()->stream();
+  auto* gpu_info = col_ctx_->op_ctx->device()->tensorflow_gpu_device_info();
+  // Without a global rank, the participants are ranked by GPU id.
+  auto participant = absl::make_unique<NcclManager::Participant>(
+      compute_stream->parent(), compute_stream, gpu_info, input, output,
+      /*global_rank=*/-1, std::move(done));
+  if (reduce_scatter) {
+    NcclManager::instance()->AddToReduceScatter(
+        std::move(participant),
+        {collective_key, num_local_devices, num_local_devices,
+         /*communicator_key=*/"", /*source_rank=*/-1},
+        reduction_op);
+  } else {
+    NcclManager::instance()->AddToAllGather(
+        std::move(participant),
+        {collective_key, num_local_devices, num_local_devices,
+         /*communicator_key=*/"", /*source_rank=*/-1});
+  }
+}
+
+Status NcclHierarchicalReducer::RingAllReduce(int position, Tensor* slice) {
+  const CollInstanceParams& instance = col_params_->instance;
+  // The ranks of the devices at `position` on every task.
+  std::vector<int> ring;
+  int ring_index = -1;
+  std::unordered_map<string, int> num_seen;
+  for (int r = 0; r < col_params_->group.group_size; ++r) {
+    if (num_seen[instance.task_names[r]]++ == position) {
+      if (r == col_params_->default_rank) ring_index = ring.size();
+      ring.push_back(r);
+    }
+  }
+  const int ring_size = ring.size();
+  if (ring_index < 0 || ring_size != col_params_->group.num_tasks) {
+    return errors::Internal("Device ", col_ctx_->device_name,
+                            " is not at position ", position,
+                            " of every task");
+  }
+  const int send_to = ring[(ring_index + 1) % ring_size];
+  const int recv_from = ring[(ring_index + ring_size - 1) % ring_size];
+  auto buf_key = [this, position](int pass, int step, int sender) {
+    return strings::StrCat(name_, ":", col_ctx_->exec_key, ":", pass, ":",
+                           step, ":", sender, ":", position);
+  };
+
+  const AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+      slice, ring_size, col_ctx_->device->GetAllocator(attr)));
+  // In the first pass each chunk is reduced while it travels around the
+  // ring, in the second pass the reduced chunks are passed around.
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int step = 0; step < ring_size - 1; ++step) {
+      const int send_idx = (ring_index + pass - step + ring_size) % ring_size;
+      const int recv_idx = (send_idx + ring_size - 1) % ring_size;
+      Tensor send_chunk = ca->ChunkAlias(send_idx);
+      Tensor chunk = ca->ChunkAlias(recv_idx);
+      Tensor recv_chunk = (pass == 0) ? ca->TempChunk(recv_idx) : chunk;
+
+      Notification send_note;
+      Status send_status;
+      col_ctx_->col_exec->PostToPeer(
+          instance.device_names[send_to], instance.task_names[send_to],
+          buf_key(pass, step, ring_index), col_ctx_->device,
+          col_ctx_->op_ctx->op_device_context(), attr, &send_chunk,
+          col_ctx_->device_locality,
+          [&send_note, &send_status](const Status& s) {
+            send_status = s;
+            send_note.Notify();
+          });
+      Status s = RunAndWait([&](const StatusCallback& recv_done) {
+        col_ctx_->col_exec->RecvFromPeer(
+            instance.device_names[recv_from], instance.task_names[recv_from],
+            col_params_->task.is_local[recv_from],
+            buf_key(pass, step, (ring_index + ring_size - 1) % ring_size),
+            col_ctx_->device, col_ctx_->op_ctx->op_device_context(), attr,
+            &recv_chunk, col_ctx_->device_locality,
+            /*dev_to_dev_stream_index=*/0, recv_done);
+      });
+      if (!s.ok()) {
+        // Cancels the send if the peer is not going to receive it.
+        col_ctx_->col_exec->StartAbort(s);
+      }
+      send_note.WaitForNotification();
+      s.Update(send_status);
+      if (s.ok() && pass == 0) {
+        s = collective_util::ComputeBinOp(
+            col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+            col_params_->merge_op.get(), &chunk, &recv_chunk);
+      }
+      TF_RETURN_IF_ERROR(s);
+    }
+  }
+  return Status::OK();
+}
+
+Status NcclHierarchicalReducer::RunFinalOp() {
+  std::unique_ptr<CollectiveAdapter> ca(
+      MakeCollectiveAdapter(col_ctx_->output, 1, nullptr));
+  Tensor group_size_val = ca->Scalar(col_params_->group.group_size);
+  Tensor group_size(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+      col_ctx_->output->dtype(), TensorShape({}));
+  TF_RETURN_IF_ERROR(RunAndWait([&](const StatusCallback& copy_done) {
+    col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+        &group_size_val, col_ctx_->device, &group_size, copy_done);
+  }));
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op.get(), col_ctx_->output, &group_size);
+}
+
+REGISTER_COLLECTIVE(NcclHierarchicalReduce, NcclHierarchicalReducer);
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,63 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_COLLECTIVE_NCCL_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_KERNELS_COLLECTIVE_NCCL_HIERARCHICAL_REDUCER_H_
+
+#include "tensorflow/core/kernels/collective_nccl_reducer.h"
+
+namespace tensorflow {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// All-reduce for groups that span several tasks with several GPUs each.
+//
+// The devices of each task first reduce-scatter the tensor with NCCL, so that
+// each of them holds the task-wide reduction of 1/N of the tensor, N being
+// the number of devices per task. The devices holding the same slice on every
+// task then all-reduce it with a ring over the collective executor's remote
+// access, and finally the devices of each task all-gather the slices with
+// NCCL. Only 1/N of the tensor crosses tasks per device.
+//
+// Pairs devices across tasks by their position in the task, so every task is
+// expected to have the same GPU configuration. Tensors that do not divide
+// into aligned slices are reduced like NcclReducer does.
+class NcclHierarchicalReducer : public NcclReducer {
+ public:
+  NcclHierarchicalReducer() : NcclReducer("NcclHierarchicalReduce") {}
+  ~NcclHierarchicalReducer() override = default;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  void Run(StatusCallback done) override;
+
+ private:
+  // Adds this device to a NCCL reduce-scatter, or all-gather, among the
+  // `num_local_devices` devices of this task.
+  void AddToLocalCollective(const string& collective_key, bool reduce_scatter,
+                            ncclRedOp_t reduction_op, int num_local_devices,
+                            const Tensor* input, Tensor* output,
+                            StatusCallback done);
+
+  // All-reduces `slice` with the devices at the same position on the other
+  // tasks.
+  Status RingAllReduce(int position, Tensor* slice);
+
+  // Applies the final op of the reduction to the output.
+  Status RunFinalOp();
+};
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_COLLECTIVE_NCCL_HIERARCHICAL_REDUCER_H_
@@ -23,28 +23,6 @@ limitations under the License.
 
 namespace tensorflow {
 
-namespace {
-Status ReductionOp(const string& merge_op, ncclRedOp_t* reduction_op) {
-  if (merge_op == "Add") {
-    *reduction_op = ncclSum;
-    return Status::OK();
-  } else if (merge_op == "Mul") {
-    *reduction_op = ncclProd;
-    return Status::OK();
-  } else if (merge_op == "Maximum") {
-    *reduction_op = ncclMax;
-    return Status::OK();
-  } else if (merge_op == "Minimum") {
-    *reduction_op = ncclMin;
-    return Status::OK();
-  } else {
-    return errors::Internal(
-        "Expected merge_op to be in [Add, Mul, Maximum, Minimum], found ",
-        merge_op);
-  }
-}
-}  // namespace
-
 void NcclReducer::Run(StatusCallback done) {
   ncclRedOp_t reduction_op;
   Status s = ReductionOp(col_params_->merge_op->type_string(), &reduction_op);
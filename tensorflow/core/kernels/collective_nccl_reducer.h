@@ -27,6 +27,10 @@ class NcclReducer : public NcclBase {
 
   // Hands off all reduce to NcclManager.
   void Run(StatusCallback done) override;
+
+ protected:
+  explicit NcclReducer(const string& name)
+      : NcclBase(REDUCTION_COLLECTIVE, name) {}
 };
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
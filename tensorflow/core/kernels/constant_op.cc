@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/kernels/constant_weights_cache.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/macros.h"
 
@@ -85,6 +86,11 @@ ConstantOp::ConstantOp(OpKernelConstruction* ctx)
       errors::InvalidArgument("Type mismatch between value (",
                               DataTypeString(tensor_.dtype()), ") and dtype (",
                               DataTypeString(ctx->output_type(0)), ")"));
+  // Matrix multiplications may cache transposes of the constant on CPU.
+  if (ctx->device_type() == DEVICE_CPU) {
+    ConstantWeightsCache::Global()->RegisterConstant(tensor_);
+    registered_weights_ = true;
+  }
 }
 
 void ConstantOp::Compute(OpKernelContext* ctx) {
@@ -94,7 +100,11 @@ void ConstantOp::Compute(OpKernelContext* ctx) {
   }
 }
 
-ConstantOp::~ConstantOp() {}
+ConstantOp::~ConstantOp() {
+  if (registered_weights_) {
+    ConstantWeightsCache::Global()->UnregisterConstant(tensor_);
+  }
+}
 
 REGISTER_KERNEL_BUILDER(Name("Const").Device(DEVICE_CPU), ConstantOp);
 REGISTER_KERNEL_BUILDER(Name("Const").Device(DEVICE_TPU_SYSTEM), ConstantOp);
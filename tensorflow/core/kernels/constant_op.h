@@ -34,6 +34,8 @@ class ConstantOp : public OpKernel {
 
  private:
   Tensor tensor_;
+  // Whether `tensor_` is registered with the ConstantWeightsCache.
+  bool registered_weights_ = false;
   TF_DISALLOW_COPY_AND_ASSIGN(ConstantOp);
 };
 
@@ -0,0 +1,131 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/constant_weights_cache.h"
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+/* static */ ConstantWeightsCache* ConstantWeightsCache::Global() {
+  static ConstantWeightsCache* cache = [] {
+    int64 capacity_bytes;
+    Status status = ReadInt64FromEnvVar("TF_CONSTANT_WEIGHTS_CACHE_BYTES",
+                                        int64{1} << 30, &capacity_bytes);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      capacity_bytes = int64{1} << 30;
+    }
+    return new ConstantWeightsCache(capacity_bytes);
+  }();
+  return cache;
+}
+
+void ConstantWeightsCache::RegisterConstant(const Tensor& constant) {
+  if (constant.NumElements() == 0 ||
+      !DataTypeCanUseMemcpy(constant.dtype())) {
+    return;
+  }
+  mutex_lock l(mu_);
+  // Const kernels may share a buffer, e.g. when created from the same proto
+  // by a device that doesn't copy it.
+  auto& registration = constants_[constant.data()];
+  ++registration.first;
+  registration.second = constant.TotalBytes();
+}
+
+void ConstantWeightsCache::UnregisterConstant(const Tensor& constant) {
+  if (constant.NumElements() == 0 ||
+      !DataTypeCanUseMemcpy(constant.dtype())) {
+    return;
+  }
+  mutex_lock l(mu_);
+  auto it = constants_.find(constant.data());
+  if (it == constants_.end() || --it->second.first > 0) return;
+  constants_.erase(it);
+  Erase({constant.data(), false});
+  Erase({constant.data(), true});
+}
+
+bool ConstantWeightsCache::GetTransposed(
+    const Tensor& weights, bool conjugate,
+    const std::function<void(const Tensor&, Tensor*)>& transpose,
+    Tensor* transposed) {
+  if (capacity_bytes_ <= 0 || (weights.dims() != 2 && weights.dims() != 3) ||
+      weights.NumElements() == 0) {
+    return false;
+  }
+  const Key key(weights.data(), conjugate);
+  {
+    mutex_lock l(mu_);
+    auto constant = constants_.find(weights.data());
+    if (constant == constants_.end() ||
+        constant->second.second != weights.TotalBytes()) {
+      return false;
+    }
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.shape == weights.shape()) {
+      ++stats_.hits;
+      lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+      *transposed = it->second.transposed;
+      return true;
+    }
+    ++stats_.misses;
+  }
+  if (weights.TotalBytes() > capacity_bytes_) return false;
+
+  TensorShape shape = weights.shape();
+  const int rows = shape.dims() - 2;
+  shape.set_dim(rows, weights.dim_size(rows + 1));
+  shape.set_dim(rows + 1, weights.dim_size(rows));
+  Tensor result(weights.dtype(), shape);
+  transpose(weights, &result);
+
+  mutex_lock l(mu_);
+  // The constant may have been unregistered while transposing.
+  auto constant = constants_.find(weights.data());
+  if (constant == constants_.end() ||
+      constant->second.second != weights.TotalBytes()) {
+    return false;
+  }
+  Erase(key);
+  while (stats_.bytes + result.TotalBytes() > capacity_bytes_) {
+    Erase(lru_.back());
+    ++stats_.evictions;
+  }
+  lru_.push_front(key);
+  entries_[key] = {weights.shape(), result, lru_.begin()};
+  ++stats_.num_entries;
+  stats_.bytes += result.TotalBytes();
+  *transposed = std::move(result);
+  return true;
+}
+
+ConstantWeightsCache::Stats ConstantWeightsCache::GetStats() {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+void ConstantWeightsCache::Erase(const Key& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return;
+  lru_.erase(it->second.lru_position);
+  --stats_.num_entries;
+  stats_.bytes -= it->second.transposed.TotalBytes();
+  entries_.erase(it);
+}
+
+}  // namespace tensorflow
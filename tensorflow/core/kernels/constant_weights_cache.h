@@ -0,0 +1,128 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_CONSTANT_WEIGHTS_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_CONSTANT_WEIGHTS_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Caches the transposes of the constant weights of matrix multiplications on
+// CPU.  Eigen contractions read a transposed operand with strided accesses
+// when packing it, on every call; multiplying by a cached transpose instead
+// reads the weights contiguously.
+//
+// Only the buffers of constants, registered by the Const kernel for its
+// lifetime, are cached: nothing writes to them, so a cached transpose stays
+// valid until the constant is unregistered.  The cache holds at most
+// `capacity_bytes` of transposes, evicting the least recently used ones.
+class ConstantWeightsCache {
+ public:
+  struct Stats {
+    int64 hits = 0;
+    int64 misses = 0;
+    int64 evictions = 0;
+    int64 num_entries = 0;
+    int64 bytes = 0;
+  };
+
+  explicit ConstantWeightsCache(int64 capacity_bytes)
+      : capacity_bytes_(capacity_bytes) {}
+
+  // Returns the process-wide cache, whose capacity is read from the
+  // TF_CONSTANT_WEIGHTS_CACHE_BYTES environment variable.
+  static ConstantWeightsCache* Global();
+
+  // Registers the buffer of `constant` as not written to, until it is
+  // unregistered.
+  void RegisterConstant(const Tensor& constant);
+  void UnregisterConstant(const Tensor& constant);
+
+  // If `weights` is a registered constant of rank 2 or 3, sets `transposed`
+  // to the transpose of its two minor dimensions, conjugated if `conjugate`,
+  // and returns true.  `transpose` computes the transposes that aren't cached
+  // yet.
+  bool GetTransposed(
+      const Tensor& weights, bool conjugate,
+      const std::function<void(const Tensor&, Tensor*)>& transpose,
+      Tensor* transposed);
+
+  Stats GetStats();
+
+ private:
+  // The data of a constant, and whether its transpose is conjugated.
+  using Key = std::pair<const void*, bool>;
+  struct Entry {
+    TensorShape shape;  // Shape of the constant when it was transposed.
+    Tensor transposed;
+    std::list<Key>::iterator lru_position;
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return std::hash<const void*>()(key.first) * 2 + key.second;
+    }
+  };
+
+  void Erase(const Key& key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 capacity_bytes_;
+  mutex mu_;
+  // Number of registrations and size of the registered constants, by data.
+  std::unordered_map<const void*, std::pair<int, int64>> constants_
+      TF_GUARDED_BY(mu_);
+  std::unordered_map<Key, Entry, KeyHash> entries_ TF_GUARDED_BY(mu_);
+  // Keys of the entries, most recently used first.
+  std::list<Key> lru_ TF_GUARDED_BY(mu_);
+  Stats stats_ TF_GUARDED_BY(mu_);
+};
+
+// Sets `transposed` to the cached transpose of the two minor dimensions of
+// `weights`, conjugated if `conjugate`, if `weights` is a constant.
+template <typename T>
+bool GetTransposedConstantWeights(const Tensor& weights, bool conjugate,
+                                  Tensor* transposed) {
+  return ConstantWeightsCache::Global()->GetTransposed(
+      weights, conjugate,
+      [conjugate](const Tensor& in, Tensor* out) {
+        const int64 batch = in.dims() == 3 ? in.dim_size(0) : 1;
+        const int64 rows = in.dim_size(in.dims() - 2);
+        const int64 cols = in.dim_size(in.dims() - 1);
+        auto src = in.shaped<T, 3>({batch, rows, cols});
+        auto dst = out->shaped<T, 3>({batch, cols, rows});
+        const Eigen::array<int, 3> perm = {0, 2, 1};
+        if (conjugate) {
+          dst = src.shuffle(perm).conjugate();
+        } else {
+          dst = src.shuffle(perm);
+        }
+      },
+      transposed);
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_CONSTANT_WEIGHTS_CACHE_H_
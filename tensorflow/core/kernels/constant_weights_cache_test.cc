@@ -0,0 +1,132 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/constant_weights_cache.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Transposes float matrices, counting the calls.
+class CountingTranspose {
+ public:
+  std::function<void(const Tensor&, Tensor*)> Get() {
+    return [this](const Tensor& in, Tensor* out) {
+      ++num_calls_;
+      out->matrix<float>() = in.matrix<float>().shuffle(
+          Eigen::array<int, 2>{1, 0});
+    };
+  }
+  int num_calls() const { return num_calls_; }
+
+ private:
+  int num_calls_ = 0;
+};
+
+TEST(ConstantWeightsCacheTest, CachesTransposesOfConstants) {
+  ConstantWeightsCache cache(/*capacity_bytes=*/1 << 20);
+  CountingTranspose transpose;
+  Tensor weights = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {2, 3});
+  Tensor transposed;
+  // Tensors which aren't constants aren't cached.
+  EXPECT_FALSE(cache.GetTransposed(weights, false, transpose.Get(),
+                                   &transposed));
+
+  cache.RegisterConstant(weights);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(cache.GetTransposed(weights, false, transpose.Get(),
+                                    &transposed));
+    test::ExpectTensorEqual<float>(
+        transposed, test::AsTensor<float>({1, 4, 2, 5, 3, 6}, {3, 2}));
+  }
+  EXPECT_EQ(transpose.num_calls(), 1);
+  ConstantWeightsCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.num_entries, 1);
+  EXPECT_EQ(stats.bytes, 6 * sizeof(float));
+
+  // A reshaped constant gets another transpose.
+  Tensor reshaped;
+  ASSERT_TRUE(reshaped.CopyFrom(weights, TensorShape({3, 2})));
+  ASSERT_TRUE(cache.GetTransposed(reshaped, false, transpose.Get(),
+                                  &transposed));
+  test::ExpectTensorEqual<float>(
+      transposed, test::AsTensor<float>({1, 3, 5, 2, 4, 6}, {2, 3}));
+  EXPECT_EQ(transpose.num_calls(), 2);
+
+  cache.UnregisterConstant(weights);
+  EXPECT_EQ(cache.GetStats().num_entries, 0);
+  EXPECT_EQ(cache.GetStats().bytes, 0);
+  EXPECT_FALSE(cache.GetTransposed(weights, false, transpose.Get(),
+                                   &transposed));
+}
+
+TEST(ConstantWeightsCacheTest, EvictsLeastRecentlyUsed) {
+  ConstantWeightsCache cache(/*capacity_bytes=*/2 * 4 * sizeof(float));
+  CountingTranspose transpose;
+  std::vector<Tensor> weights;
+  for (int i = 0; i < 3; ++i) {
+    weights.push_back(test::AsTensor<float>({1, 2, 3, 4}, {2, 2}));
+    cache.RegisterConstant(weights.back());
+  }
+  Tensor transposed;
+  ASSERT_TRUE(cache.GetTransposed(weights[0], false, transpose.Get(),
+                                  &transposed));
+  ASSERT_TRUE(cache.GetTransposed(weights[1], false, transpose.Get(),
+                                  &transposed));
+  ASSERT_TRUE(cache.GetTransposed(weights[0], false, transpose.Get(),
+                                  &transposed));
+  // Evicts the transpose of weights[1].
+  ASSERT_TRUE(cache.GetTransposed(weights[2], false, transpose.Get(),
+                                  &transposed));
+  ConstantWeightsCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.evictions, 1);
+  EXPECT_EQ(stats.num_entries, 2);
+  EXPECT_EQ(stats.bytes, 2 * 4 * sizeof(float));
+  ASSERT_TRUE(cache.GetTransposed(weights[0], false, transpose.Get(),
+                                  &transposed));
+  EXPECT_EQ(transpose.num_calls(), 3);
+  ASSERT_TRUE(cache.GetTransposed(weights[1], false, transpose.Get(),
+                                  &transposed));
+  EXPECT_EQ(transpose.num_calls(), 4);
+}
+
+TEST(ConstantWeightsCacheTest, ConjugatesBatchesOfComplexWeights) {
+  Tensor weights = test::AsTensor<complex64>(
+      {{1, 1}, {2, 2}, {3, 3}, {4, 4}, {5, 5}, {6, 6}, {7, 7}, {8, 8}},
+      {2, 2, 2});
+  ConstantWeightsCache::Global()->RegisterConstant(weights);
+  Tensor adjoint;
+  ASSERT_TRUE(GetTransposedConstantWeights<complex64>(
+      weights, /*conjugate=*/true, &adjoint));
+  test::ExpectTensorEqual<complex64>(
+      adjoint, test::AsTensor<complex64>({{1, -1},
+                                          {3, -3},
+                                          {2, -2},
+                                          {4, -4},
+                                          {5, -5},
+                                          {7, -7},
+                                          {6, -6},
+                                          {8, -8}},
+                                         {2, 2, 2}));
+  ConstantWeightsCache::Global()->UnregisterConstant(weights);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,80 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_CSV_UTIL_H_
+#define TENSORFLOW_CORE_KERNELS_CSV_UTIL_H_
+
+#include <cstring>
+
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace csv_util {
+
+namespace internal {
+
+constexpr uint64 kOnes = 0x0101010101010101ULL;
+constexpr uint64 kHighBits = 0x8080808080808080ULL;
+
+// Returns a word with the high bit set in every byte of `word` that equals
+// `c`. Bytes above the lowest match may be falsely flagged because of borrow
+// propagation, so only the lowest set bit is meaningful.
+inline uint64 MatchByte(uint64 word, char c) {
+  const uint64 x = word ^ (kOnes * static_cast<uint8>(c));
+  return (x - kOnes) & ~x & kHighBits;
+}
+
+}  // namespace internal
+
+// Returns the position of the first byte in `data[pos, size)` that can end an
+// unquoted CSV field: `delim`, '\n', '\r', or '"' if `check_quote` is true.
+// Returns `size` if there is no such byte.
+//
+// On little-endian hosts the scan compares eight bytes per step using SWAR
+// (SIMD within a register) arithmetic, so long fields are skipped without a
+// branch per byte.
+inline size_t FindFieldEnd(const char* data, size_t pos, size_t size,
+                           char delim, bool check_quote) {
+  if (port::kLittleEndian) {
+    // When quotes are not special, search for `delim` twice instead.
+    const char quote = check_quote ? '"' : delim;
+    while (pos + sizeof(uint64) <= size) {
+      uint64 word;
+      std::memcpy(&word, data + pos, sizeof(word));
+      const uint64 match = internal::MatchByte(word, delim) |
+                           internal::MatchByte(word, '\n') |
+                           internal::MatchByte(word, '\r') |
+                           internal::MatchByte(word, quote);
+      if (match != 0) {
+        return pos + Log2Floor64(match & (~match + 1)) / 8;
+      }
+      pos += sizeof(uint64);
+    }
+  }
+  for (; pos < size; ++pos) {
+    const char c = data[pos];
+    if (c == delim || c == '\n' || c == '\r' || (check_quote && c == '"')) {
+      return pos;
+    }
+  }
+  return size;
+}
+
+}  // namespace csv_util
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_CSV_UTIL_H_
@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/csv_util.h"
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace csv_util {
+namespace {
+
+size_t Find(const string& s, size_t pos, bool check_quote = true) {
+  return FindFieldEnd(s.data(), pos, s.size(), ',', check_quote);
+}
+
+TEST(CsvUtilTest, FindFieldEnd) {
+  EXPECT_EQ(Find("", 0), 0);
+  EXPECT_EQ(Find("abc", 0), 3);
+  EXPECT_EQ(Find("a,b", 0), 1);
+  EXPECT_EQ(Find("a,b", 2), 3);
+  EXPECT_EQ(Find("abc\r\n", 0), 3);
+  EXPECT_EQ(Find("abc\n", 0), 3);
+  EXPECT_EQ(Find("ab\"c", 0), 2);
+  EXPECT_EQ(Find("ab\"c", 0, /*check_quote=*/false), 4);
+}
+
+TEST(CsvUtilTest, FindFieldEndAllPositions) {
+  // Covers matches in every byte of a word, in the tail, and after bytes that
+  // are one above a special character, which exercise borrow propagation.
+  for (int len = 1; len < 40; ++len) {
+    for (int match = 0; match < len; ++match) {
+      for (char special : {',', '\n', '\r', '"'}) {
+        string s(len, '-');
+        s[match] = special;
+        for (int i = match + 1; i < len; ++i) s[i] = special + 1;
+        EXPECT_EQ(Find(s, 0), match)
+            << "len=" << len << " match=" << match;
+      }
+    }
+  }
+}
+
+void BM_FindFieldEnd(int iters, int field_size) {
+  string s;
+  while (s.size() < (1 << 20)) {
+    s += string(field_size, 'x');
+    s += ',';
+  }
+  size_t fields = 0;
+  for (int i = 0; i < iters; ++i) {
+    for (size_t pos = 0; pos < s.size();) {
+      pos = Find(s, pos) + 1;
+      ++fields;
+    }
+  }
+  VLOG(1) << fields;
+  testing::BytesProcessed(static_cast<int64>(iters) * s.size());
+}
+
+BENCHMARK(BM_FindFieldEnd)->Arg(4)->Arg(16)->Arg(64);
+
+}  // namespace
+}  // namespace csv_util
+}  // namespace tensorflow
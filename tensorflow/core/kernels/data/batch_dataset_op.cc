@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -44,6 +45,57 @@ namespace data {
 constexpr char kInputImplEmpty[] = "input_impl_empty";
 constexpr char kBatchDataset[] = "BatchDataset";
 
+namespace {
+
+// Aliases adjacent slices of the buffer of a tensor, keeping that buffer alive.
+class AdjacentSlicesBuffer : public TensorBuffer {
+ public:
+  AdjacentSlicesBuffer(Tensor first_slice, size_t size)
+      : TensorBuffer(const_cast<char*>(first_slice.tensor_data().data())),
+        first_slice_(std::move(first_slice)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("AdjacentSlicesBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  ~AdjacentSlicesBuffer() override {}
+
+  const Tensor first_slice_;
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AdjacentSlicesBuffer);
+};
+
+// Returns whether the `component_index`-th components of `batch_elements` are
+// adjacent slices of one buffer, in order, such as the elements produced by
+// `from_tensor_slices`. The batch of such components can alias their buffer.
+bool AreAdjacentSlices(const std::vector<std::vector<Tensor>>& batch_elements,
+                       size_t component_index) {
+  const Tensor& first = batch_elements[0][component_index];
+  if (!DataTypeCanUseMemcpy(first.dtype()) || first.TotalBytes() == 0 ||
+      !first.IsAligned()) {
+    return false;
+  }
+  const char* expected_data = first.tensor_data().data();
+  for (const auto& element : batch_elements) {
+    const Tensor& t = element[component_index];
+    if (!t.SharesBufferWith(first) || t.tensor_data().data() != expected_data) {
+      return false;
+    }
+    expected_data += first.TotalBytes();
+  }
+  return true;
+}
+
+}  // namespace
+
 class BatchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, int64 batch_size, bool drop_remainder,
@@ -186,7 +238,8 @@ class BatchDatasetOp::Dataset : public DatasetBase {
       }
 
       // Copy the retrieved batch elements into one output tensor per tuple
-      // component.
+      // component, unless the elements are adjacent slices of one buffer, in
+      // which case the output tensor aliases that buffer.
       //
       // NOTE(mrry): If the input or output sizes are statically known, we
       // could potentially read the input values in-place into their
@@ -205,7 +258,31 @@ class BatchDatasetOp::Dataset : public DatasetBase {
         // element is moved into the output batch.
         TensorShape first_element_shape(first_element.shape());
         batch_component_shape.AppendShape(first_element_shape);
-        out_tensors->emplace_back(ctx->allocator({}), first_element.dtype(),
+        for (size_t i = 1; i < num_batch_elements; ++i) {
+          if (batch_elements[i][component_index].shape() !=
+              first_element_shape) {
+            return errors::InvalidArgument(
+                "Cannot batch tensors with different shapes in "
+                "component ",
+                component_index, ". First element had shape ",
+                first_element_shape.DebugString(), " and element ", i,
+                " had shape ",
+                batch_elements[i][component_index].shape().DebugString(), ".");
+          }
+        }
+        if (AreAdjacentSlices(batch_elements, component_index)) {
+          AdjacentSlicesBuffer* buffer = new AdjacentSlicesBuffer(
+              first_element, num_batch_elements * first_element.TotalBytes());
+          out_tensors->emplace_back(first_element.dtype(),
+                                    batch_component_shape, buffer);
+          buffer->Unref();
+          continue;
+        }
+        // Batches are allocated in GPU-compatible (pinned) host memory when a
+        // GPU is present, so that copying them to the GPU is asynchronous.
+        AllocatorAttributes attr;
+        attr.set_gpu_compatible(true);
+        out_tensors->emplace_back(ctx->allocator(attr), first_element.dtype(),
                                   batch_component_shape);
         if (!out_tensors->back().IsInitialized()) {
           return errors::ResourceExhausted(
@@ -226,16 +303,6 @@ class BatchDatasetOp::Dataset : public DatasetBase {
         Status status;
         mutex status_mu;
         for (size_t i = 0; i < num_batch_elements; ++i) {
-          if (batch_elements[i][component_index].shape() !=
-              first_element_shape) {
-            return errors::InvalidArgument(
-                "Cannot batch tensors with different shapes in "
-                "component ",
-                component_index, ". First element had shape ",
-                first_element_shape.DebugString(), " and element ", i,
-                " had shape ",
-                batch_elements[i][component_index].shape().DebugString(), ".");
-          }
           if (TF_PREDICT_FALSE(dataset()->parallel_copy_)) {
             (*ctx->runner())(
                 [i, &status, &status_mu, &counter, &copy_element_fn]() {
@@ -11,6 +11,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/batch_dataset_op.h"
 
+#include <numeric>
+
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
 
 namespace tensorflow {
@@ -283,6 +285,38 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(BatchDatasetOpTest, BatchDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+TEST_F(BatchDatasetOpTest, AliasesAdjacentSlices) {
+  // Rows of 16 floats are aligned, so the input elements are adjacent slices
+  // of one buffer.
+  std::vector<float> values(4 * 16);
+  std::iota(values.begin(), values.end(), 0);
+  auto batch_dataset_params = BatchDatasetParams(
+      TensorSliceDatasetParams(
+          /*components=*/{CreateTensor<float>(TensorShape({4, 16}), values)},
+          /*node_name=*/"tensor_slice"),
+      /*batch_size=*/2,
+      /*drop_remainder=*/false,
+      /*parallel_copy=*/false,
+      /*output_dtypes=*/{DT_FLOAT},
+      /*output_shapes=*/{PartialTensorShape({2, 16})},
+      /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(batch_dataset_params));
+  std::vector<Tensor> first_batch, second_batch;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &first_batch, &end_of_sequence));
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &second_batch, &end_of_sequence));
+  ASSERT_FALSE(end_of_sequence);
+  test::ExpectTensorEqual<float>(
+      second_batch[0],
+      CreateTensor<float>(TensorShape({2, 16}),
+                          std::vector<float>(values.begin() + 2 * 16,
+                                             values.end())));
+  EXPECT_EQ(second_batch[0].tensor_data().data(),
+            first_batch[0].tensor_data().data() + 2 * 16 * sizeof(float));
+}
+
 TEST_F(BatchDatasetOpTest, InvalidBatchSize) {
   auto batch_dataset_params = InvalidBatchSizeBatchDatasetParams();
   EXPECT_EQ(Initialize(batch_dataset_params).code(),
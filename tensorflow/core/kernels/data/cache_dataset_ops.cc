@@ -14,16 +14,19 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/serialization_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -58,6 +61,44 @@ constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
 
+namespace {
+
+// Whether the in-memory caches of datasets with the same elements are shared,
+// which is enabled by setting TF_DATA_SHARE_MEMORY_CACHE to true. This lets
+// several replicas of an input pipeline in one process, e.g. of concurrent
+// training jobs, cache their elements once.
+bool ShareMemoryCaches() {
+  static const bool share = [] {
+    bool share = false;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_DATA_SHARE_MEMORY_CACHE", false, &share));
+    return share;
+  }();
+  return share;
+}
+
+// Returns a new manager of the in-memory cache of `input`. If caches are
+// shared, inputs without external state are identified by the hash of their
+// graph, which includes the values of the tensors they are built from.
+MemoryCacheManager* NewMemoryCacheManager(OpKernelContext* ctx,
+                                          const DatasetBase* input) {
+  if (ShareMemoryCaches()) {
+    SerializationContext::Params params;
+    params.external_state_policy =
+        SerializationContext::ExternalStatePolicy::kFail;
+    GraphDef graph_def;
+    uint64 key;
+    Status s = AsGraphDef(ctx, input, SerializationContext(params), &graph_def);
+    if (s.ok()) s = HashGraph(graph_def, &key);
+    if (s.ok()) return new MemoryCacheManager(GetSharedMemoryCache(key));
+    VLOG(1) << "Not sharing the cache of " << input->DebugString() << ": "
+            << s;
+  }
+  return new MemoryCacheManager();
+}
+
+}  // namespace
+
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  public:
   FileDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
@@ -714,8 +755,10 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex_lock l(mu_);
       if (cache_->IsCompleted()) {
         TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCacheCompleted), ""));
+        std::vector<std::vector<Tensor>> elements;
+        TF_RETURN_IF_ERROR(cache_->GetElements(&elements));
         TF_RETURN_IF_ERROR(
-            WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
+            WriteElementsToCheckpoint(writer, prefix(), elements));
       }
       return SaveInput(ctx, writer, iterator_);
     }
@@ -724,12 +767,16 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                            IteratorStateReader* reader) override {
       mutex_lock l(mu_);
       iterator_.reset();
-      cache_->Reset();
-      if (reader->Contains(full_name(kCacheCompleted))) {
-        std::vector<std::vector<Tensor>> temp_cache;
-        TF_RETURN_IF_ERROR(
-            ReadElementsFromCheckpoint(reader, prefix(), &temp_cache));
-        cache_->Complete(std::move(temp_cache));
+      // A completed shared cache holds the same elements as the checkpoint,
+      // and may be read by other iterators, so it is kept as it is.
+      if (!cache_->shared() || !cache_->IsCompleted()) {
+        cache_->Reset();
+        if (reader->Contains(full_name(kCacheCompleted))) {
+          std::vector<std::vector<Tensor>> temp_cache;
+          TF_RETURN_IF_ERROR(
+              ReadElementsFromCheckpoint(reader, prefix(), &temp_cache));
+          cache_->Complete(std::move(temp_cache));
+        }
       }
       TF_RETURN_IF_ERROR(InitializeIterator(ctx));
       return RestoreInput(ctx, reader, iterator_);
@@ -829,10 +876,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         // dataset but performance modeling uses the iterator abstraction and
         // thus we record the memory allocated for the cache here. The caveat
         // is that this is incorrect if there are concurrent instances of this
-        // iterator.
+        // iterator. The elements of a spilled cache are not in memory.
         tf_shared_lock l(mu_);
+        if (cache_->IsSpilled()) {
+          return Status::OK();
+        }
+        std::vector<Tensor> element;
         for (size_t i = 0; i < cache_->size(); ++i) {
-          RecordBufferEnqueue(ctx, cache_->at(i));
+          TF_RETURN_IF_ERROR(cache_->Get(i, &element));
+          RecordBufferEnqueue(ctx, element);
         }
         return Status::OK();
       }
@@ -842,7 +894,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         if (index_ < cache_->size()) {
-          const std::vector<Tensor>& cache_tensors = cache_->at(index_);
+          std::vector<Tensor> cache_tensors;
+          TF_RETURN_IF_ERROR(cache_->Get(index_, &cache_tensors));
           out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
                               cache_tensors.end());
           index_++;
@@ -1026,8 +1079,9 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
         OP_REQUIRES_OK(
             ctx,
             ctx->resource_manager()->LookupOrCreate<MemoryCacheManager>(
-                container, name, &manager, [](MemoryCacheManager** manager) {
-                  *manager = new MemoryCacheManager();
+                container, name, &manager,
+                [ctx, input](MemoryCacheManager** manager) {
+                  *manager = NewMemoryCacheManager(ctx, input);
                   return Status::OK();
                 }));
         handle = MakeResourceHandle<MemoryCacheManager>(ctx, container, name);
@@ -1041,8 +1095,9 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       MemoryCacheManager* manager;
       OP_REQUIRES_OK(
           ctx, ctx->resource_manager()->LookupOrCreate<MemoryCacheManager>(
-                   container, name, &manager, [](MemoryCacheManager** manager) {
-                     *manager = new MemoryCacheManager();
+                   container, name, &manager,
+                   [ctx, input](MemoryCacheManager** manager) {
+                     *manager = NewMemoryCacheManager(ctx, input);
                      return Status::OK();
                    }));
       auto handle =
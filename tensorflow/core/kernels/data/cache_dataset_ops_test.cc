@@ -11,6 +11,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/platform/path.h"
@@ -365,6 +366,41 @@ INSTANTIATE_TEST_CASE_P(CacheDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+TEST(SharedMemoryCacheTest, SharedWhileInUse) {
+  std::shared_ptr<MemoryCache> cache = GetSharedMemoryCache(1);
+  EXPECT_TRUE(cache->shared());
+  EXPECT_EQ(cache, GetSharedMemoryCache(1));
+  EXPECT_NE(cache, GetSharedMemoryCache(2));
+
+  cache->Complete({{CreateTensor<int64>(TensorShape({}), {1})}});
+  EXPECT_TRUE(GetSharedMemoryCache(1)->IsCompleted());
+  cache.reset();
+  // The elements are released with the last user of the cache.
+  EXPECT_FALSE(GetSharedMemoryCache(1)->IsCompleted());
+}
+
+TEST(SharedMemoryCacheTest, Spill) {
+  std::shared_ptr<MemoryCache> cache = GetSharedMemoryCache(3);
+  cache->Complete({{CreateTensor<int64>(TensorShape({}), {1})},
+                   {CreateTensor<int64>(TensorShape({2}), {2, 3})}});
+  EXPECT_GT(cache->resident_bytes(), 0);
+  TF_ASSERT_OK(
+      cache->Spill(io::JoinPath(testing::TmpDir(), "spilled_memory_cache")));
+  EXPECT_TRUE(cache->IsSpilled());
+  EXPECT_EQ(cache->resident_bytes(), 0);
+  EXPECT_EQ(cache->size(), 2);
+
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(cache->Get(1, &element));
+  ASSERT_EQ(element.size(), 1);
+  test::ExpectTensorEqual<int64>(
+      element[0], CreateTensor<int64>(TensorShape({2}), {2, 3}));
+
+  cache->Reset();
+  EXPECT_FALSE(cache->IsSpilled());
+  EXPECT_EQ(cache->size(), 0);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -14,6 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_ops.h"
 
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -22,6 +26,9 @@ limitations under the License.
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -29,16 +36,109 @@ namespace {
 
 constexpr char kMemoryCache[] = "MemoryCache";
 
+// Returns the key of the `j`-th tensor of the `i`-th element in the bundle of
+// a spilled cache.
+string SpillKey(size_t i, size_t j) { return strings::StrCat(i, "_", j); }
+
+// Orders the reads of the elements of all caches.
+std::atomic<uint64> read_clock(0);
+
+// The registry of the shared caches of this process.
+struct SharedMemoryCaches {
+  mutex mu;
+  std::unordered_map<uint64, std::weak_ptr<MemoryCache>> caches
+      TF_GUARDED_BY(mu);
+};
+
+SharedMemoryCaches* GetSharedMemoryCaches() {
+  static SharedMemoryCaches* caches = new SharedMemoryCaches;
+  return caches;
+}
+
+int64 SharedMemoryCacheBudgetBytes() {
+  static const int64 budget = [] {
+    int64 budget_mb = 0;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_DATA_SHARED_MEMORY_CACHE_BUDGET_MB",
+                                    0, &budget_mb));
+    return budget_mb << 20;
+  }();
+  return budget;
+}
+
+string NewSpillPrefix() {
+  string dir;
+  TF_CHECK_OK(
+      ReadStringFromEnvVar("TF_DATA_SHARED_MEMORY_CACHE_SPILL_DIR", "", &dir));
+  if (dir.empty()) {
+    std::vector<string> dirs;
+    Env::Default()->GetLocalTempDirectories(&dirs);
+    dir = dirs.empty() ? "/tmp" : dirs[0];
+  }
+  return io::JoinPath(
+      dir, strings::StrCat("tf_data_memory_cache_", random::New64()));
+}
+
+// Spills the least recently read shared caches until the elements held in
+// memory by all of them fit the budget.
+void EnforceSharedMemoryCacheBudget() {
+  const int64 budget = SharedMemoryCacheBudgetBytes();
+  if (budget <= 0) return;
+  std::vector<std::shared_ptr<MemoryCache>> caches;
+  {
+    SharedMemoryCaches* shared = GetSharedMemoryCaches();
+    mutex_lock l(shared->mu);
+    for (auto& it : shared->caches) {
+      std::shared_ptr<MemoryCache> cache = it.second.lock();
+      if (cache != nullptr) caches.push_back(std::move(cache));
+    }
+  }
+  int64 total_bytes = 0;
+  for (const auto& cache : caches) {
+    total_bytes += cache->resident_bytes();
+  }
+  std::sort(caches.begin(), caches.end(),
+            [](const std::shared_ptr<MemoryCache>& a,
+               const std::shared_ptr<MemoryCache>& b) {
+              return a->last_use() < b->last_use();
+            });
+  for (const auto& cache : caches) {
+    if (total_bytes <= budget) break;
+    const int64 bytes = cache->resident_bytes();
+    if (bytes == 0) continue;
+    Status s = cache->Spill(NewSpillPrefix());
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to spill a shared memory cache to disk: " << s;
+      continue;
+    }
+    VLOG(2) << "Spilled " << bytes << " bytes of a shared memory cache.";
+    total_bytes -= bytes;
+  }
+}
+
 }  // namespace
 
 string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
-void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+MemoryCache::~MemoryCache() {
   mutex_lock l(mu_);
-  if (!completed_) {
+  DeleteSpillFiles();
+}
+
+void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+  {
+    mutex_lock l(mu_);
+    if (completed_) return;
     cache_ = std::move(cache);
+    resident_bytes_ = 0;
+    for (const auto& element : cache_) {
+      for (const Tensor& t : element) {
+        resident_bytes_ += t.TotalBytes();
+      }
+    }
     completed_ = true;
   }
+  last_use_ = read_clock.fetch_add(1);
+  if (shared_) EnforceSharedMemoryCacheBudget();
 }
 
 bool MemoryCache::IsCompleted() {
@@ -46,26 +146,140 @@ bool MemoryCache::IsCompleted() {
   return completed_;
 }
 
+bool MemoryCache::IsSpilled() {
+  tf_shared_lock l(mu_);
+  return spill_reader_ != nullptr;
+}
+
 void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  resident_bytes_ = 0;
+  DeleteSpillFiles();
 }
 
-const std::vector<Tensor>& MemoryCache::at(int64 index) {
-  tf_shared_lock l(mu_);
-  DCHECK(index < cache_.size());
-  return cache_[index];
+Status MemoryCache::Get(int64 index, std::vector<Tensor>* element) {
+  last_use_ = read_clock.fetch_add(1);
+  {
+    tf_shared_lock l(mu_);
+    if (spill_reader_ == nullptr) {
+      DCHECK(index < cache_.size());
+      *element = cache_[index];
+      return Status::OK();
+    }
+  }
+  mutex_lock l(mu_);
+  if (spill_reader_ == nullptr) {
+    *element = cache_[index];
+    return Status::OK();
+  }
+  DCHECK(index < spilled_element_sizes_.size());
+  element->resize(spilled_element_sizes_[index]);
+  for (size_t j = 0; j < element->size(); ++j) {
+    TF_RETURN_IF_ERROR(
+        spill_reader_->Lookup(SpillKey(index, j), &(*element)[j]));
+  }
+  return Status::OK();
 }
 
 size_t MemoryCache::size() {
   tf_shared_lock l(mu_);
-  return cache_.size();
+  return spill_reader_ == nullptr ? cache_.size()
+                                  : spilled_element_sizes_.size();
 }
 
-const std::vector<std::vector<Tensor>>& MemoryCache::data() {
+Status MemoryCache::GetElements(std::vector<std::vector<Tensor>>* elements) {
+  const size_t num_elements = size();
+  elements->clear();
+  elements->reserve(num_elements);
+  for (size_t i = 0; i < num_elements; ++i) {
+    elements->emplace_back();
+    TF_RETURN_IF_ERROR(Get(i, &elements->back()));
+  }
+  return Status::OK();
+}
+
+int64 MemoryCache::resident_bytes() {
   tf_shared_lock l(mu_);
-  return cache_;
+  return resident_bytes_;
+}
+
+Status MemoryCache::Spill(const string& prefix) {
+  mutex_lock l(mu_);
+  if (!completed_ || spill_reader_ != nullptr) {
+    return Status::OK();
+  }
+  Env* env = Env::Default();
+  Status s;
+  {
+    BundleWriter writer(env, prefix);
+    s = writer.status();
+    for (size_t i = 0; s.ok() && i < cache_.size(); ++i) {
+      for (size_t j = 0; s.ok() && j < cache_[i].size(); ++j) {
+        s = writer.Add(SpillKey(i, j), cache_[i][j]);
+      }
+    }
+    if (s.ok()) {
+      s = writer.Finish();
+    }
+  }
+  std::unique_ptr<BundleReader> reader;
+  if (s.ok()) {
+    reader = absl::make_unique<BundleReader>(env, prefix);
+    s = reader->status();
+  }
+  spill_prefix_ = prefix;
+  if (!s.ok()) {
+    reader.reset();
+    DeleteSpillFiles();
+    return s;
+  }
+  spilled_element_sizes_.clear();
+  spilled_element_sizes_.reserve(cache_.size());
+  for (const auto& element : cache_) {
+    spilled_element_sizes_.push_back(element.size());
+  }
+  spill_reader_ = std::move(reader);
+  std::vector<std::vector<Tensor>>().swap(cache_);
+  resident_bytes_ = 0;
+  return Status::OK();
+}
+
+void MemoryCache::DeleteSpillFiles() {
+  spill_reader_.reset();
+  spilled_element_sizes_.clear();
+  if (spill_prefix_.empty()) return;
+  Env* env = Env::Default();
+  std::vector<string> files;
+  Status s = env->GetMatchingPaths(strings::StrCat(spill_prefix_, "*"), &files);
+  for (const string& file : files) {
+    s.Update(env->DeleteFile(file));
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete the spilled memory cache "
+                 << spill_prefix_ << ": " << s;
+  }
+  spill_prefix_.clear();
+}
+
+std::shared_ptr<MemoryCache> GetSharedMemoryCache(uint64 key) {
+  SharedMemoryCaches* shared = GetSharedMemoryCaches();
+  mutex_lock l(shared->mu);
+  auto& caches = shared->caches;
+  for (auto it = caches.begin(); it != caches.end();) {
+    if (it->second.expired()) {
+      it = caches.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  std::shared_ptr<MemoryCache> cache = caches[key].lock();
+  if (cache == nullptr) {
+    cache = std::make_shared<MemoryCache>(/*shared=*/true);
+    caches[key] = cache;
+  }
+  return cache;
 }
 
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <atomic>
+
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace data {
@@ -30,6 +33,14 @@ namespace data {
 class MemoryCache {
  public:
   MemoryCache() = default;
+  // A shared cache is used by all the datasets of the same elements, see
+  // GetSharedMemoryCache.
+  explicit MemoryCache(bool shared) : shared_(shared) {}
+
+  ~MemoryCache();
+
+  // Returns whether the cache is shared by datasets of the same elements.
+  bool shared() const { return shared_; }
 
   // Marks the cache as completed.
   void Complete(std::vector<std::vector<Tensor>>&& cache);
@@ -37,30 +48,68 @@ class MemoryCache {
   // Returns whether the cache is completed.
   bool IsCompleted();
 
+  // Returns whether the elements of the cache have been spilled to disk.
+  bool IsSpilled();
+
   // Resets the cache.
   void Reset();
 
-  // Returns the element at the given index.
-  const std::vector<Tensor>& at(int64 index);
+  // Copies the element at the given index to `element`.
+  Status Get(int64 index, std::vector<Tensor>* element);
 
   // Returns the size of the cache.
   size_t size();
 
-  // Returns a reference to the cache's data. The returned reference will be
-  // invalidated by any call to Reset().
-  const std::vector<std::vector<Tensor>>& data();
+  // Copies all the elements of the cache to `elements`. For a spilled cache
+  // this reads all the elements back from disk.
+  Status GetElements(std::vector<std::vector<Tensor>>* elements);
+
+  // Returns the number of bytes of the elements held in memory.
+  int64 resident_bytes();
+
+  // Returns the time at which an element of the cache was last read, in the
+  // order of the reads of all caches.
+  uint64 last_use() const { return last_use_; }
+
+  // Moves the elements of a completed cache to a tensor bundle with the given
+  // prefix, from which they are read from then on. The bundle is deleted when
+  // the cache is reset or destroyed.
+  Status Spill(const string& prefix);
 
  private:
+  void DeleteSpillFiles() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   mutex mu_;
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  int64 resident_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // The bundle of a spilled cache and the number of tensors of each of its
+  // elements. Reads from the bundle are serialized by `mu_`.
+  string spill_prefix_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<BundleReader> spill_reader_ TF_GUARDED_BY(mu_);
+  std::vector<int64> spilled_element_sizes_ TF_GUARDED_BY(mu_);
+  std::atomic<uint64> last_use_{0};
+  const bool shared_ = false;
 };
 
+// Returns the cache of the elements of the datasets whose graph hashes to
+// `key`. All the datasets of this process that get the cache while another
+// one still holds it use the same cache, and thus the same copy of the
+// elements.
+//
+// The elements of the shared caches are kept in memory up to the budget set by
+// TF_DATA_SHARED_MEMORY_CACHE_BUDGET_MB, beyond which the least recently read
+// caches are spilled to TF_DATA_SHARED_MEMORY_CACHE_SPILL_DIR, by default a
+// local temporary directory.
+std::shared_ptr<MemoryCache> GetSharedMemoryCache(uint64 key);
+
 // A resource wrapping a shared instance of a memory cache.
 class MemoryCacheManager : public ResourceBase {
  public:
   MemoryCacheManager() : cache_(std::make_shared<MemoryCache>()) {}
+  explicit MemoryCacheManager(std::shared_ptr<MemoryCache> cache)
+      : cache_(std::move(cache)) {}
 
   string DebugString() const override;
 
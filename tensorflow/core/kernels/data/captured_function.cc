@@ -96,6 +96,8 @@ class SimpleStepStatsCollector : public StepStatsCollectorInterface {
 
     void SetMemory(OpKernelContext* ctx) override {}
 
+    void SetDeviceComputeTime(OpKernelContext* ctx) override {}
+
     void SetOutput(int slot, const Tensor* tensor) override {}
 
     void SetScheduled(int64 nanos) override {}
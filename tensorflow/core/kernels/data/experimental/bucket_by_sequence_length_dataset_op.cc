@@ -0,0 +1,525 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/stats_aggregator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/stats_utils.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBoundaries;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBatchSizes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kMaxBufferedBytes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kLengthComponent;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kExhausted[] = "exhausted";
+constexpr char kBucketSize[] = "bucket_size";
+
+// Share of the available RAM that partially filled buckets may hold when
+// `max_buffered_bytes` is autotuned.
+constexpr double kAutotuneRamShare = 0.1;
+
+int64 ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& t : element) {
+    bytes += t.TotalBytes();
+  }
+  return bytes;
+}
+
+}  // namespace
+
+class BucketBySequenceLengthDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input,
+          std::vector<int64> bucket_boundaries,
+          std::vector<int64> bucket_batch_sizes,
+          std::vector<Tensor> padding_values, bool drop_remainder,
+          int64 max_buffered_bytes, int64 length_component)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        padding_values_(std::move(padding_values)),
+        drop_remainder_(drop_remainder),
+        max_buffered_bytes_(max_buffered_bytes),
+        length_component_(length_component) {
+    input_->Ref();
+    for (const PartialTensorShape& shape : input_->output_shapes()) {
+      output_shapes_.push_back(PartialTensorShape({-1}).Concatenate(shape));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64 Cardinality() const override {
+    int64 n = input_->Cardinality();
+    if (n == kInfiniteCardinality) {
+      return n;
+    }
+    return kUnknownCardinality;
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* bucket_boundaries = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_boundaries_, &bucket_boundaries));
+    Node* bucket_batch_sizes = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_batch_sizes_, &bucket_batch_sizes));
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    Node* drop_remainder = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder));
+    Node* max_buffered_bytes = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(max_buffered_bytes_, &max_buffered_bytes));
+
+    AttrValue length_component;
+    b->BuildAttrValue(length_component_, &length_component);
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, input_graph_node},
+         {1, bucket_boundaries},
+         {2, bucket_batch_sizes},
+         {4, drop_remainder},
+         {5, max_buffered_bytes}},
+        {{3, padding_values}},
+        {{kLengthComponent, length_component}, {kToutputTypes, output_types}},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          buckets_(params.dataset->bucket_batch_sizes_.size()) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      max_buffered_bytes_ = dataset()->max_buffered_bytes_;
+      if (max_buffered_bytes_ == model::kAutotune) {
+        max_buffered_bytes_ = kAutotuneRamShare * port::AvailableRam();
+      }
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      while (input_impl_) {
+        std::vector<Tensor> element;
+        bool end_of_input;
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &element, &end_of_input));
+        if (end_of_input) {
+          input_impl_.reset();
+          break;
+        }
+        int64 bucket_index;
+        TF_RETURN_IF_ERROR(BucketIndex(element, &bucket_index));
+        Bucket& bucket = buckets_[bucket_index];
+        const int64 bytes = ElementBytes(element);
+        bucket.bytes += bytes;
+        buffered_bytes_ += bytes;
+        bucket.elements.push_back(std::move(element));
+        if (static_cast<int64>(bucket.elements.size()) ==
+            dataset()->bucket_batch_sizes_[bucket_index]) {
+          *end_of_sequence = false;
+          return EmitBatchLocked(ctx, bucket_index, out_tensors);
+        }
+        if (max_buffered_bytes_ > 0 && buffered_bytes_ > max_buffered_bytes_) {
+          // Emit the bucket holding the most bytes as a partial batch, which
+          // frees the most memory per batch.
+          int64 largest = 0;
+          for (int64 i = 1; i < buckets_.size(); ++i) {
+            if (buckets_[i].bytes > buckets_[largest].bytes) largest = i;
+          }
+          *end_of_sequence = false;
+          return EmitBatchLocked(ctx, largest, out_tensors);
+        }
+      }
+      // The input is exhausted, so flush the partial buckets in order.
+      for (int64 i = 0; i < buckets_.size(); ++i) {
+        if (buckets_[i].elements.empty()) continue;
+        if (dataset()->drop_remainder_) {
+          buckets_[i].elements.clear();
+          buckets_[i].bytes = 0;
+          continue;
+        }
+        *end_of_sequence = false;
+        return EmitBatchLocked(ctx, i, out_tensors);
+      }
+      buffered_bytes_ = 0;
+      *end_of_sequence = true;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      } else {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kExhausted), ""));
+      }
+      for (int64 i = 0; i < buckets_.size(); ++i) {
+        const auto& elements = buckets_[i].elements;
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(strings::StrCat(kBucketSize, "_", i)), elements.size()));
+        for (int64 j = 0; j < elements.size(); ++j) {
+          for (int64 k = 0; k < elements[j].size(); ++k) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                full_name(strings::StrCat("bucket_", i, "_", j, "_", k)),
+                elements[j][k]));
+          }
+        }
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      if (reader->Contains(full_name(kExhausted))) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      buffered_bytes_ = 0;
+      const int64 num_components = dataset()->output_dtypes().size();
+      for (int64 i = 0; i < buckets_.size(); ++i) {
+        Bucket& bucket = buckets_[i];
+        int64 bucket_size;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            full_name(strings::StrCat(kBucketSize, "_", i)), &bucket_size));
+        bucket.elements.clear();
+        bucket.elements.resize(bucket_size);
+        bucket.bytes = 0;
+        for (int64 j = 0; j < bucket_size; ++j) {
+          bucket.elements[j].resize(num_components);
+          for (int64 k = 0; k < num_components; ++k) {
+            TF_RETURN_IF_ERROR(reader->ReadTensor(
+                full_name(strings::StrCat("bucket_", i, "_", j, "_", k)),
+                &bucket.elements[j][k]));
+          }
+          bucket.bytes += ElementBytes(bucket.elements[j]);
+        }
+        buffered_bytes_ += bucket.bytes;
+      }
+      return Status::OK();
+    }
+
+   private:
+    // The elements buffered for one bucket, in input order.
+    struct Bucket {
+      std::vector<std::vector<Tensor>> elements;
+      int64 bytes = 0;
+    };
+
+    // Buckets are [0, b_0), [b_0, b_1), ..., [b_{n-1}, inf) for the
+    // boundaries b_i, applied to the first dimension of the length component.
+    Status BucketIndex(const std::vector<Tensor>& element,
+                       int64* bucket_index) {
+      const Tensor& t = element[dataset()->length_component_];
+      if (t.dims() < 1) {
+        return errors::InvalidArgument(
+            "The length component ", dataset()->length_component_,
+            " must have rank at least 1, but got shape ",
+            t.shape().DebugString());
+      }
+      const auto& boundaries = dataset()->bucket_boundaries_;
+      *bucket_index =
+          std::upper_bound(boundaries.begin(), boundaries.end(),
+                           t.dim_size(0)) -
+          boundaries.begin();
+      return Status::OK();
+    }
+
+    // Removes the elements of the given bucket and pads them into one batch
+    // per component, padding each dimension to its largest size in the batch.
+    Status EmitBatchLocked(IteratorContext* ctx, int64 bucket_index,
+                           std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Bucket& bucket = buckets_[bucket_index];
+      std::vector<std::vector<Tensor>> elements;
+      elements.swap(bucket.elements);
+      buffered_bytes_ -= bucket.bytes;
+      bucket.bytes = 0;
+      bucket.elements.reserve(dataset()->bucket_batch_sizes_[bucket_index]);
+
+      const int64 num_elements = elements.size();
+      int64 num_values = 0;
+      int64 num_padded_values = 0;
+      out_tensors->clear();
+      for (size_t c = 0; c < dataset()->output_dtypes().size(); ++c) {
+        const int rank = elements[0][c].dims();
+        TensorShape batch_shape({num_elements});
+        for (int dim = 0; dim < rank; ++dim) {
+          batch_shape.AddDim(0);
+        }
+        for (const auto& element : elements) {
+          const TensorShape& shape = element[c].shape();
+          if (shape.dims() != rank) {
+            return errors::InvalidArgument(
+                "All elements in a bucket must have the same rank for "
+                "component ",
+                c, ": expected rank ", rank, " but got element with rank ",
+                shape.dims());
+          }
+          for (int dim = 0; dim < rank; ++dim) {
+            if (shape.dim_size(dim) > batch_shape.dim_size(dim + 1)) {
+              batch_shape.set_dim(dim + 1, shape.dim_size(dim));
+            }
+          }
+          num_values += shape.num_elements();
+        }
+        num_padded_values += batch_shape.num_elements();
+
+        AllocatorAttributes attr;
+        attr.set_gpu_compatible(true);
+        out_tensors->emplace_back(ctx->allocator(attr),
+                                  dataset()->output_dtypes()[c], batch_shape);
+        Tensor& batch = out_tensors->back();
+        TF_RETURN_IF_ERROR(
+            batch_util::SetElementZero(&batch, dataset()->padding_values_[c]));
+        TensorShape component_shape = batch_shape;
+        component_shape.RemoveDim(0);
+        for (int64 i = 0; i < num_elements; ++i) {
+          if (elements[i][c].shape() == component_shape) {
+            TF_RETURN_IF_ERROR(
+                batch_util::CopyElementToSlice(elements[i][c], &batch, i));
+          } else {
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+                elements[i][c], &batch, i));
+          }
+        }
+      }
+
+      const float padding_fraction =
+          num_padded_values == 0
+              ? 0.0f
+              : 1.0f - static_cast<float>(num_values) / num_padded_values;
+      total_values_ += num_values;
+      total_padded_values_ += num_padded_values;
+      VLOG(3) << "Emitting a batch of " << num_elements << " from bucket "
+              << bucket_index << " with padding fraction " << padding_fraction
+              << "; overall padding fraction "
+              << 1.0 - static_cast<double>(total_values_) /
+                           total_padded_values_;
+      const auto& stats_aggregator = ctx->stats_aggregator();
+      if (stats_aggregator) {
+        stats_aggregator->AddToHistogram(
+            stats_utils::PaddingFractionHistogramName(dataset()->node_name()),
+            {padding_fraction}, num_elements);
+        stats_aggregator->AddScalar(
+            stats_utils::BufferedBytesScalarName(dataset()->node_name()),
+            static_cast<float>(buffered_bytes_), num_elements);
+      }
+      return Status::OK();
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+    int64 buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+    int64 max_buffered_bytes_ = 0;
+    // Counts of the values in emitted batches, without and with padding.
+    int64 total_values_ TF_GUARDED_BY(mu_) = 0;
+    int64 total_padded_values_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const DatasetBase* const input_;
+  const std::vector<int64> bucket_boundaries_;
+  const std::vector<int64> bucket_batch_sizes_;
+  const std::vector<Tensor> padding_values_;
+  const bool drop_remainder_;
+  const int64 max_buffered_bytes_;
+  const int64 length_component_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+BucketBySequenceLengthDatasetOp::BucketBySequenceLengthDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kLengthComponent, &length_component_));
+}
+
+void BucketBySequenceLengthDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                  DatasetBase* input,
+                                                  DatasetBase** output) {
+  OP_REQUIRES(ctx, length_component_ < input->output_dtypes().size(),
+              errors::InvalidArgument(
+                  "`length_component` is ", length_component_,
+                  " but the input dataset's elements have only ",
+                  input->output_dtypes().size(), " components"));
+
+  const Tensor* boundaries_t;
+  OP_REQUIRES_OK(ctx, ctx->input(kBucketBoundaries, &boundaries_t));
+  OP_REQUIRES(ctx, TensorShapeUtils::IsVector(boundaries_t->shape()),
+              errors::InvalidArgument("`bucket_boundaries` must be a vector"));
+  std::vector<int64> bucket_boundaries(
+      boundaries_t->vec<int64>().data(),
+      boundaries_t->vec<int64>().data() + boundaries_t->NumElements());
+  for (size_t i = 1; i < bucket_boundaries.size(); ++i) {
+    OP_REQUIRES(ctx, bucket_boundaries[i - 1] < bucket_boundaries[i],
+                errors::InvalidArgument(
+                    "`bucket_boundaries` must be strictly increasing"));
+  }
+
+  const Tensor* batch_sizes_t;
+  OP_REQUIRES_OK(ctx, ctx->input(kBucketBatchSizes, &batch_sizes_t));
+  OP_REQUIRES(ctx, TensorShapeUtils::IsVector(batch_sizes_t->shape()),
+              errors::InvalidArgument("`bucket_batch_sizes` must be a vector"));
+  std::vector<int64> bucket_batch_sizes(
+      batch_sizes_t->vec<int64>().data(),
+      batch_sizes_t->vec<int64>().data() + batch_sizes_t->NumElements());
+  OP_REQUIRES(ctx, bucket_batch_sizes.size() == bucket_boundaries.size() + 1,
+              errors::InvalidArgument(
+                  "`bucket_batch_sizes` must have one more element than "
+                  "`bucket_boundaries`, but got ",
+                  bucket_batch_sizes.size(), " and ", bucket_boundaries.size()));
+  for (int64 batch_size : bucket_batch_sizes) {
+    OP_REQUIRES(ctx, batch_size > 0,
+                errors::InvalidArgument(
+                    "All `bucket_batch_sizes` must be greater than zero."));
+  }
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == input->output_dtypes().size(),
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  input->output_dtypes().size(), ")"));
+  std::vector<Tensor> padding_values;
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  bool drop_remainder;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<bool>(ctx, kDropRemainder, &drop_remainder));
+
+  int64 max_buffered_bytes;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kMaxBufferedBytes,
+                                                 &max_buffered_bytes));
+  OP_REQUIRES(ctx,
+              max_buffered_bytes >= 0 || max_buffered_bytes == model::kAutotune,
+              errors::InvalidArgument(
+                  "`max_buffered_bytes` must be non-negative or ",
+                  model::kAutotune, " (AUTOTUNE)."));
+
+  *output = new Dataset(ctx, input, std::move(bucket_boundaries),
+                        std::move(bucket_batch_sizes),
+                        std::move(padding_values), drop_remainder,
+                        max_buffered_bytes, length_component_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(
+    Name("BucketBySequenceLengthDataset").Device(DEVICE_CPU),
+    BucketBySequenceLengthDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,203 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "bucket_by_sequence_length_dataset";
+
+class BucketBySequenceLengthDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BucketBySequenceLengthDatasetParams(
+      T input_dataset_params, std::vector<int64> bucket_boundaries,
+      std::vector<int64> bucket_batch_sizes, int64 padding_value,
+      bool drop_remainder, int64 max_buffered_bytes,
+      DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        padding_value_(padding_value),
+        drop_remainder_(drop_remainder),
+        max_buffered_bytes_(max_buffered_bytes) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {
+        CreateTensor<int64>(
+            TensorShape({static_cast<int64>(bucket_boundaries_.size())}),
+            bucket_boundaries_),
+        CreateTensor<int64>(
+            TensorShape({static_cast<int64>(bucket_batch_sizes_.size())}),
+            bucket_batch_sizes_),
+        CreateTensor<int64>(TensorShape({}), {padding_value_}),
+        CreateTensor<bool>(TensorShape({}), {drop_remainder_}),
+        CreateTensor<int64>(TensorShape({}), {max_buffered_bytes_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {BucketBySequenceLengthDatasetOp::kInputDataset,
+                    BucketBySequenceLengthDatasetOp::kBucketBoundaries,
+                    BucketBySequenceLengthDatasetOp::kBucketBatchSizes,
+                    strings::StrCat(
+                        BucketBySequenceLengthDatasetOp::kPaddingValues, "_0"),
+                    BucketBySequenceLengthDatasetOp::kDropRemainder,
+                    BucketBySequenceLengthDatasetOp::kMaxBufferedBytes};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {BucketBySequenceLengthDatasetOp::kLengthComponent, 0},
+        {BucketBySequenceLengthDatasetOp::kToutputTypes, output_dtypes_},
+        {BucketBySequenceLengthDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return BucketBySequenceLengthDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<int64> bucket_boundaries_;
+  std::vector<int64> bucket_batch_sizes_;
+  int64 padding_value_;
+  bool drop_remainder_;
+  int64 max_buffered_bytes_;
+};
+
+class BucketBySequenceLengthDatasetOpTest : public DatasetOpsTestBase {};
+
+// Produces [0, 1], [2, 3], [4, 5] followed by [6], [7], [8], [9].
+ConcatenateDatasetParams SequenceDatasetParams() {
+  auto tensor_slice_dataset_params_0 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64>(TensorShape{3, 2},
+                                          {{0, 1, 2, 3, 4, 5}}),
+      /*node_name=*/"tensor_slice_0");
+  auto tensor_slice_dataset_params_1 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64>(TensorShape{4, 1}, {{6, 7, 8, 9}}),
+      /*node_name=*/"tensor_slice_1");
+  return ConcatenateDatasetParams(std::move(tensor_slice_dataset_params_0),
+                                  std::move(tensor_slice_dataset_params_1),
+                                  /*output_dtypes=*/{DT_INT64},
+                                  /*output_shapes=*/{PartialTensorShape({-1})},
+                                  /*node_name=*/"concatenate");
+}
+
+BucketBySequenceLengthDatasetParams MakeDatasetParams(
+    std::vector<int64> bucket_boundaries, std::vector<int64> bucket_batch_sizes,
+    bool drop_remainder, int64 max_buffered_bytes) {
+  return BucketBySequenceLengthDatasetParams(
+      SequenceDatasetParams(), std::move(bucket_boundaries),
+      std::move(bucket_batch_sizes),
+      /*padding_value=*/-1, drop_remainder, max_buffered_bytes,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// Test case 1: lengths 1 and 2 go to separate buckets, and the partial
+// buckets are flushed in bucket order at the end of the input.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams1() {
+  return MakeDatasetParams(/*bucket_boundaries=*/{2},
+                           /*bucket_batch_sizes=*/{3, 2},
+                           /*drop_remainder=*/false,
+                           /*max_buffered_bytes=*/0);
+}
+
+// Test case 2: same as test case 1, but the partial buckets are dropped.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams2() {
+  return MakeDatasetParams(/*bucket_boundaries=*/{2},
+                           /*bucket_batch_sizes=*/{3, 2},
+                           /*drop_remainder=*/true,
+                           /*max_buffered_bytes=*/0);
+}
+
+// Test case 3: all elements share a bucket and are padded.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams3() {
+  return MakeDatasetParams(/*bucket_boundaries=*/{3},
+                           /*bucket_batch_sizes=*/{4, 4},
+                           /*drop_remainder=*/false,
+                           /*max_buffered_bytes=*/0);
+}
+
+// Test case 4: a one byte budget emits every element on its own.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams4() {
+  return MakeDatasetParams(/*bucket_boundaries=*/{3},
+                           /*bucket_batch_sizes=*/{4, 4},
+                           /*drop_remainder=*/false,
+                           /*max_buffered_bytes=*/1);
+}
+
+// Test case 5: the number of batch sizes does not match the boundaries.
+BucketBySequenceLengthDatasetParams InvalidBatchSizesDatasetParams() {
+  return MakeDatasetParams(/*bucket_boundaries=*/{2},
+                           /*bucket_batch_sizes=*/{3},
+                           /*drop_remainder=*/false,
+                           /*max_buffered_bytes=*/0);
+}
+
+std::vector<GetNextTestCase<BucketBySequenceLengthDatasetParams>>
+GetNextTestCases() {
+  return {
+      {/*dataset_params=*/BucketBySequenceLengthDatasetParams1(),
+       /*expected_outputs=*/
+       {CreateTensor<int64>(TensorShape({2, 2}), {0, 1, 2, 3}),
+        CreateTensor<int64>(TensorShape({3, 1}), {6, 7, 8}),
+        CreateTensor<int64>(TensorShape({1, 1}), {9}),
+        CreateTensor<int64>(TensorShape({1, 2}), {4, 5})}},
+      {/*dataset_params=*/BucketBySequenceLengthDatasetParams2(),
+       /*expected_outputs=*/
+       {CreateTensor<int64>(TensorShape({2, 2}), {0, 1, 2, 3}),
+        CreateTensor<int64>(TensorShape({3, 1}), {6, 7, 8})}},
+      {/*dataset_params=*/BucketBySequenceLengthDatasetParams3(),
+       /*expected_outputs=*/
+       {CreateTensor<int64>(TensorShape({4, 2}), {0, 1, 2, 3, 4, 5, 6, -1}),
+        CreateTensor<int64>(TensorShape({3, 1}), {7, 8, 9})}},
+      {/*dataset_params=*/BucketBySequenceLengthDatasetParams4(),
+       /*expected_outputs=*/
+       {CreateTensor<int64>(TensorShape({1, 2}), {0, 1}),
+        CreateTensor<int64>(TensorShape({1, 2}), {2, 3}),
+        CreateTensor<int64>(TensorShape({1, 2}), {4, 5}),
+        CreateTensor<int64>(TensorShape({1, 1}), {6}),
+        CreateTensor<int64>(TensorShape({1, 1}), {7}),
+        CreateTensor<int64>(TensorShape({1, 1}), {8}),
+        CreateTensor<int64>(TensorShape({1, 1}), {9})}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                         BucketBySequenceLengthDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, InvalidBatchSizes) {
+  EXPECT_EQ(Initialize(InvalidBatchSizesDatasetParams()).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
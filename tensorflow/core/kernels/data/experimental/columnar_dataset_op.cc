@@ -0,0 +1,321 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/data/experimental/columnar_util.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const ColumnarDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFileNames;
+/* static */ constexpr const char* const ColumnarDatasetOp::kColumns;
+/* static */ constexpr const char* const ColumnarDatasetOp::kBatchSize;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFilterColumn;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFilterMin;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFilterMax;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputShapes;
+
+constexpr char kCurrentFileIndex[] = "current_file_index";
+constexpr char kRowGroup[] = "row_group";
+constexpr char kRow[] = "row";
+
+class ColumnarDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          std::vector<string> columns, int64 batch_size, string filter_column,
+          double filter_min, double filter_max,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        batch_size_(batch_size),
+        filter_column_(std::move(filter_column)),
+        filter_min_(filter_min),
+        filter_max_(filter_max),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override { return output_types_; }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status CheckExternalState() const override { return Status::OK(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    Node* columns = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(columns_, &columns));
+    Node* batch_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+    Node* filter_column = nullptr;
+    TF_RETURN_IF_ERROR(
+        b->AddScalar(tstring(filter_column_), &filter_column));
+    Node* filter_min = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(filter_min_, &filter_min));
+    Node* filter_max = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(filter_max_, &filter_max));
+    TF_RETURN_IF_ERROR(b->AddDataset(this,
+                                     {filenames, columns, batch_size,
+                                      filter_column, filter_min, filter_max},
+                                     output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      const size_t num_columns = dataset()->columns_.size();
+      // The rows of the batch, as slices of the row groups they come from.
+      std::vector<std::vector<Tensor>> slices(num_columns);
+      int64 num_rows = 0;
+      while (num_rows < dataset()->batch_size_) {
+        if (reader_ == nullptr) {
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            break;
+          }
+          TF_RETURN_IF_ERROR(OpenFileLocked(ctx->env()));
+          continue;
+        }
+        const auto& footer = reader_->footer();
+        if (row_group_ == footer.row_group_size()) {
+          reader_.reset();
+          ++current_file_index_;
+          row_group_ = 0;
+          row_ = 0;
+          continue;
+        }
+        const int64 group_rows = footer.row_group(row_group_).num_rows();
+        if (row_ >= group_rows ||
+            (filter_index_ >= 0 &&
+             !reader_->MayMatch(row_group_, filter_index_,
+                                dataset()->filter_min_,
+                                dataset()->filter_max_))) {
+          ++row_group_;
+          row_ = 0;
+          continue;
+        }
+        const int64 n =
+            std::min(dataset()->batch_size_ - num_rows, group_rows - row_);
+        for (size_t i = 0; i < num_columns; ++i) {
+          slices[i].emplace_back();
+          TF_RETURN_IF_ERROR(reader_->ReadRows(row_group_, column_indices_[i],
+                                               row_, n, &slices[i].back()));
+        }
+        row_ += n;
+        num_rows += n;
+      }
+      if (num_rows == 0) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      for (size_t i = 0; i < num_columns; ++i) {
+        if (slices[i].size() == 1) {
+          out_tensors->push_back(std::move(slices[i][0]));
+        } else {
+          // Only batches spanning several row groups are copied.
+          out_tensors->emplace_back();
+          TF_RETURN_IF_ERROR(tensor::Concat(slices[i], &out_tensors->back()));
+        }
+      }
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kCurrentFileIndex),
+                              static_cast<int64>(current_file_index_)));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kRowGroup), row_group_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kRow), row_));
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      reader_.reset();
+      int64 current_file_index;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentFileIndex),
+                                            &current_file_index));
+      current_file_index_ = static_cast<size_t>(current_file_index);
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRowGroup), &row_group_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRow), &row_));
+      return Status::OK();
+    }
+
+   private:
+    // Opens the current file and resolves the projected and filtered columns
+    // against its schema.
+    Status OpenFileLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const string& filename = dataset()->filenames_[current_file_index_];
+      std::unique_ptr<columnar_util::Reader> reader;
+      TF_RETURN_IF_ERROR(columnar_util::Reader::Open(env, filename, &reader));
+      column_indices_.clear();
+      for (size_t i = 0; i < dataset()->columns_.size(); ++i) {
+        const string& name = dataset()->columns_[i];
+        const int index = reader->ColumnIndex(name);
+        if (index < 0) {
+          return errors::InvalidArgument("No column ", name, " in ", filename);
+        }
+        const DataType dtype = reader->footer().column(index).dtype();
+        if (dtype != dataset()->output_types_[i]) {
+          return errors::InvalidArgument(
+              "Column ", name, " in ", filename, " has type ",
+              DataTypeString(dtype), ", expected ",
+              DataTypeString(dataset()->output_types_[i]));
+        }
+        column_indices_.push_back(index);
+      }
+      filter_index_ = -1;
+      if (!dataset()->filter_column_.empty()) {
+        filter_index_ = reader->ColumnIndex(dataset()->filter_column_);
+        if (filter_index_ < 0) {
+          return errors::InvalidArgument("No column ",
+                                         dataset()->filter_column_, " in ",
+                                         filename);
+        }
+      }
+      if (row_group_ > reader->footer().row_group_size()) {
+        return errors::InvalidArgument("Row group ", row_group_,
+                                       " is out of range in ", filename);
+      }
+      reader_ = std::move(reader);
+      return Status::OK();
+    }
+
+    mutex mu_;
+    size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    // The next row to read is `row_` in row group `row_group_` of the current
+    // file.
+    int64 row_group_ TF_GUARDED_BY(mu_) = 0;
+    int64 row_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<columnar_util::Reader> reader_ TF_GUARDED_BY(mu_);
+    // The indices in the current file of the projected columns and of the
+    // filter column, or -1 if there is no filter.
+    std::vector<int> column_indices_ TF_GUARDED_BY(mu_);
+    int filter_index_ TF_GUARDED_BY(mu_) = -1;
+  };
+
+  const std::vector<string> filenames_;
+  const std::vector<string> columns_;
+  const int64 batch_size_;
+  const string filter_column_;
+  const double filter_min_;
+  const double filter_max_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+ColumnarDatasetOp::ColumnarDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void ColumnarDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                    DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+  }
+
+  std::vector<tstring> column_names;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<tstring>(ctx, kColumns,
+                                                   &column_names));
+  std::vector<string> columns(column_names.begin(), column_names.end());
+  OP_REQUIRES(ctx, columns.size() == output_types_.size(),
+              errors::InvalidArgument(
+                  "`columns` must have one name per output type, got ",
+                  columns.size(), " names and ", output_types_.size(),
+                  " types."));
+
+  int64 batch_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64>(ctx, kBatchSize, &batch_size));
+  OP_REQUIRES(ctx, batch_size > 0,
+              errors::InvalidArgument("`batch_size` must be positive."));
+
+  tstring filter_column;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kFilterColumn,
+                                                   &filter_column));
+  double filter_min;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<double>(ctx, kFilterMin, &filter_min));
+  double filter_max;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<double>(ctx, kFilterMax, &filter_max));
+
+  *output = new Dataset(ctx, std::move(filenames), std::move(columns),
+                        batch_size, filter_column, filter_min, filter_max,
+                        output_types_, output_shapes_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,364 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/columnar_util.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/mem.h"
+
+namespace tensorflow {
+namespace data {
+namespace columnar_util {
+namespace {
+
+constexpr int64 kTrailerSize = sizeof(uint64) + kMagicSize;
+
+// A memory region holding a copy of a file, for file systems that cannot map
+// files into memory.
+class CopiedMemoryRegion : public ReadOnlyMemoryRegion {
+ public:
+  CopiedMemoryRegion(void* data, uint64 length)
+      : data_(data), length_(length) {}
+  ~CopiedMemoryRegion() override { port::AlignedFree(data_); }
+
+  const void* data() override { return data_; }
+  uint64 length() override { return length_; }
+
+ private:
+  void* const data_;
+  const uint64 length_;
+};
+
+Status CopyFileToMemory(Env* env, const std::string& filename,
+                        std::unique_ptr<ReadOnlyMemoryRegion>* region) {
+  uint64 size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  char* data = static_cast<char*>(
+      port::AlignedMalloc(std::max<uint64>(size, 1), kChunkAlignment));
+  if (data == nullptr) {
+    return errors::ResourceExhausted("Failed to allocate ", size,
+                                     " bytes to read ", filename);
+  }
+  StringPiece result;
+  Status s = file->Read(0, size, &result, data);
+  if (s.ok() && result.size() != size) {
+    s = errors::DataLoss("Read ", result.size(), " of ", size, " bytes of ",
+                         filename);
+  }
+  if (!s.ok()) {
+    port::AlignedFree(data);
+    return s;
+  }
+  if (result.data() != data) {
+    memmove(data, result.data(), size);
+  }
+  region->reset(new CopiedMemoryRegion(data, size));
+  return Status::OK();
+}
+
+// A TensorBuffer aliasing rows of a chunk in a columnar file. Keeps the file
+// mapped for as long as the buffer lives.
+class ChunkTensorBuffer : public TensorBuffer {
+ public:
+  ChunkTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                    const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("ChunkTensorBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  ~ChunkTensorBuffer() override {}
+
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ChunkTensorBuffer);
+};
+
+template <typename T>
+void ComputeStats(const Tensor& t, experimental::ColumnarChunk* chunk) {
+  auto flat = t.flat<T>();
+  if (flat.size() == 0) return;
+  T min = flat(0);
+  T max = flat(0);
+  for (int64 i = 1; i < flat.size(); ++i) {
+    min = std::min(min, flat(i));
+    max = std::max(max, flat(i));
+  }
+  chunk->set_has_stats(true);
+  chunk->set_min(static_cast<double>(min));
+  chunk->set_max(static_cast<double>(max));
+}
+
+// Records the smallest and largest values of `t` in `chunk`, for the types
+// whose values convert to double.
+void SetStats(const Tensor& t, experimental::ColumnarChunk* chunk) {
+  switch (t.dtype()) {
+#define HANDLE_TYPE(T)         \
+  case DataTypeToEnum<T>::value: \
+    ComputeStats<T>(t, chunk);   \
+    break;
+    TF_CALL_INTEGRAL_TYPES(HANDLE_TYPE);
+    TF_CALL_float(HANDLE_TYPE);
+    TF_CALL_double(HANDLE_TYPE);
+#undef HANDLE_TYPE
+    default:
+      break;
+  }
+}
+
+Status ValidateColumn(const experimental::ColumnarColumn& column) {
+  if (!DataTypeCanUseMemcpy(column.dtype())) {
+    return errors::InvalidArgument("Column ", column.name(), " has type ",
+                                   DataTypeString(column.dtype()),
+                                   ", which is not a fixed-size type.");
+  }
+  return TensorShape::IsValidShape(column.shape());
+}
+
+}  // namespace
+
+Status Writer::Create(Env* env, const std::string& filename,
+                      const std::vector<experimental::ColumnarColumn>& columns,
+                      std::unique_ptr<Writer>* out_writer) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Columnar files can only be written on little-endian hosts.");
+  }
+  for (const auto& column : columns) {
+    TF_RETURN_IF_ERROR(ValidateColumn(column));
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  out_writer->reset(new Writer(std::move(file), columns));
+  return Status::OK();
+}
+
+Writer::Writer(std::unique_ptr<WritableFile> file,
+               const std::vector<experimental::ColumnarColumn>& columns)
+    : file_(std::move(file)) {
+  footer_.set_version(kVersion);
+  for (const auto& column : columns) {
+    *footer_.add_column() = column;
+  }
+}
+
+Writer::~Writer() {
+  if (file_ != nullptr) {
+    Status s = Close();
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to close columnar file: " << s;
+    }
+  }
+}
+
+Status Writer::WriteRowGroup(const std::vector<Tensor>& columns) {
+  if (file_ == nullptr) {
+    return errors::FailedPrecondition("The columnar writer is closed.");
+  }
+  if (columns.size() != footer_.column_size()) {
+    return errors::InvalidArgument("Expected ", footer_.column_size(),
+                                   " columns, got ", columns.size());
+  }
+  if (!columns.empty() && columns[0].dims() == 0) {
+    return errors::InvalidArgument("Columns must have a leading row dimension.");
+  }
+  const int64 num_rows = columns.empty() ? 0 : columns[0].dim_size(0);
+  for (int i = 0; i < columns.size(); ++i) {
+    const auto& column = footer_.column(i);
+    TensorShape expected_shape({num_rows});
+    expected_shape.AppendShape(TensorShape(column.shape()));
+    if (columns[i].dtype() != column.dtype() ||
+        columns[i].shape() != expected_shape) {
+      return errors::InvalidArgument(
+          "Column ", column.name(), " expects a ",
+          DataTypeString(column.dtype()), " tensor of shape ",
+          expected_shape.DebugString(), ", got a ",
+          DataTypeString(columns[i].dtype()), " tensor of shape ",
+          columns[i].shape().DebugString());
+    }
+  }
+  experimental::ColumnarRowGroup* row_group = footer_.add_row_group();
+  row_group->set_num_rows(num_rows);
+  for (const Tensor& t : columns) {
+    TF_RETURN_IF_ERROR(Pad());
+    const StringPiece data = t.tensor_data();
+    experimental::ColumnarChunk* chunk = row_group->add_chunk();
+    chunk->set_offset(offset_);
+    chunk->set_size_bytes(data.size());
+    SetStats(t, chunk);
+    TF_RETURN_IF_ERROR(file_->Append(data));
+    offset_ += data.size();
+  }
+  return Status::OK();
+}
+
+Status Writer::Pad() {
+  const int64 padding =
+      (kChunkAlignment - offset_ % kChunkAlignment) % kChunkAlignment;
+  if (padding > 0) {
+    TF_RETURN_IF_ERROR(file_->Append(string(padding, '\0')));
+    offset_ += padding;
+  }
+  return Status::OK();
+}
+
+Status Writer::Close() {
+  if (file_ == nullptr) {
+    return Status::OK();
+  }
+  string footer;
+  footer_.SerializeToString(&footer);
+  char footer_size[sizeof(uint64)];
+  core::EncodeFixed64(footer_size, footer.size());
+  Status s = file_->Append(footer);
+  if (s.ok()) s = file_->Append(StringPiece(footer_size, sizeof(uint64)));
+  if (s.ok()) s = file_->Append(StringPiece(kMagic, kMagicSize));
+  if (s.ok()) s = file_->Close();
+  file_.reset();
+  return s;
+}
+
+Status Reader::Open(Env* env, const std::string& filename,
+                    std::unique_ptr<Reader>* out_reader) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Columnar files can only be read on little-endian hosts.");
+  }
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  Status s = env->NewReadOnlyMemoryRegionFromFile(filename, &region);
+  if (errors::IsUnimplemented(s)) {
+    s = CopyFileToMemory(env, filename, &region);
+  }
+  TF_RETURN_IF_ERROR(s);
+
+  const char* data = static_cast<const char*>(region->data());
+  const int64 length = region->length();
+  if (length < kTrailerSize ||
+      memcmp(data + length - kMagicSize, kMagic, kMagicSize) != 0) {
+    return errors::DataLoss(filename, " is not a columnar file.");
+  }
+  const uint64 footer_size =
+      core::DecodeFixed64(data + length - kTrailerSize);
+  if (footer_size > length - kTrailerSize) {
+    return errors::DataLoss("Corrupted footer in ", filename);
+  }
+  const int64 footer_offset = length - kTrailerSize - footer_size;
+  experimental::ColumnarFooter footer;
+  if (!footer.ParseFromArray(data + footer_offset, footer_size)) {
+    return errors::DataLoss("Corrupted footer in ", filename);
+  }
+  if (footer.version() != kVersion) {
+    return errors::Unimplemented("Unsupported version ", footer.version(),
+                                 " of columnar file ", filename);
+  }
+  for (const auto& column : footer.column()) {
+    TF_RETURN_IF_ERROR(ValidateColumn(column));
+  }
+  std::unique_ptr<Reader> reader(
+      new Reader(std::move(region), std::move(footer)));
+  for (const auto& row_group : reader->footer_.row_group()) {
+    if (row_group.chunk_size() != reader->footer_.column_size()) {
+      return errors::DataLoss("Corrupted row group in ", filename);
+    }
+    for (int i = 0; i < row_group.chunk_size(); ++i) {
+      const auto& chunk = row_group.chunk(i);
+      if (chunk.offset() < 0 || chunk.offset() % kChunkAlignment != 0 ||
+          chunk.size_bytes() != row_group.num_rows() * reader->row_bytes_[i] ||
+          chunk.offset() + chunk.size_bytes() > footer_offset) {
+        return errors::DataLoss("Corrupted chunk in ", filename);
+      }
+    }
+  }
+  *out_reader = std::move(reader);
+  return Status::OK();
+}
+
+Reader::Reader(std::shared_ptr<ReadOnlyMemoryRegion> region,
+               experimental::ColumnarFooter footer)
+    : region_(std::move(region)), footer_(std::move(footer)) {
+  for (const auto& column : footer_.column()) {
+    row_shapes_.emplace_back(column.shape());
+    row_bytes_.push_back(row_shapes_.back().num_elements() *
+                         DataTypeSize(column.dtype()));
+  }
+}
+
+int Reader::ColumnIndex(const std::string& name) const {
+  for (int i = 0; i < footer_.column_size(); ++i) {
+    if (footer_.column(i).name() == name) return i;
+  }
+  return -1;
+}
+
+bool Reader::MayMatch(int64 row_group, int column, double min,
+                      double max) const {
+  const auto& chunk = footer_.row_group(row_group).chunk(column);
+  return !chunk.has_stats() || (chunk.max() >= min && chunk.min() <= max);
+}
+
+Status Reader::ReadRows(int64 row_group, int column, int64 start,
+                        int64 num_rows, Tensor* out) const {
+  if (row_group < 0 || row_group >= footer_.row_group_size() || column < 0 ||
+      column >= footer_.column_size()) {
+    return errors::OutOfRange("No column ", column, " in row group ",
+                              row_group);
+  }
+  const auto& group = footer_.row_group(row_group);
+  if (start < 0 || num_rows < 0 || start + num_rows > group.num_rows()) {
+    return errors::OutOfRange("Rows [", start, ", ", start + num_rows,
+                              ") are out of the ", group.num_rows(),
+                              " rows of row group ", row_group);
+  }
+  const DataType dtype = footer_.column(column).dtype();
+  TensorShape shape({num_rows});
+  shape.AppendShape(row_shapes_[column]);
+  const char* data = static_cast<const char*>(region_->data()) +
+                     group.chunk(column).offset() + start * row_bytes_[column];
+  const size_t size = num_rows * row_bytes_[column];
+  if (reinterpret_cast<intptr_t>(data) % EIGEN_MAX_ALIGN_BYTES == 0) {
+    ChunkTensorBuffer* buffer = new ChunkTensorBuffer(region_, data, size);
+    *out = Tensor(dtype, shape, buffer);
+    buffer->Unref();
+  } else {
+    *out = Tensor(dtype, shape);
+    memcpy(const_cast<char*>(out->tensor_data().data()), data, size);
+  }
+  return Status::OK();
+}
+
+}  // namespace columnar_util
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,115 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_UTIL_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_UTIL_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/data/experimental/columnar.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace columnar_util {
+
+// A columnar file stores rows of dense, fixed-size features column by column,
+// so that the features can be read without parsing, and only for the columns
+// that are needed. The file is laid out as
+//
+//   chunk* footer footer_size magic
+//
+// where each chunk holds the raw bytes of one column for the rows of one row
+// group and starts at a multiple of `kChunkAlignment`, `footer` is a
+// serialized `ColumnarFooter` indexing the chunks, `footer_size` is its size
+// as a fixed64 and `magic` is `kMagic`. Values are stored in the byte order
+// of little-endian hosts.
+constexpr char kMagic[] = "TFCOLMN1";
+constexpr int64 kMagicSize = 8;
+constexpr int64 kChunkAlignment = 64;
+constexpr int64 kVersion = 1;
+
+// Writes a columnar file one row group at a time.
+class Writer {
+ public:
+  // Creates a writer of a file with the given columns, whose dtypes must be
+  // fixed-size types.
+  static Status Create(Env* env, const std::string& filename,
+                       const std::vector<experimental::ColumnarColumn>& columns,
+                       std::unique_ptr<Writer>* out_writer);
+
+  // Appends a row group. `columns[i]` holds the rows of the i-th column, with
+  // shape `[num_rows] + shape` of the column. All columns must have the same
+  // number of rows.
+  Status WriteRowGroup(const std::vector<Tensor>& columns);
+
+  // Writes the footer and closes the file.
+  Status Close();
+
+  ~Writer();
+
+ private:
+  Writer(std::unique_ptr<WritableFile> file,
+         const std::vector<experimental::ColumnarColumn>& columns);
+
+  Status Pad();
+
+  std::unique_ptr<WritableFile> file_;
+  int64 offset_ = 0;
+  experimental::ColumnarFooter footer_;
+};
+
+// Reads a columnar file through a read-only memory mapping of it, or through a
+// copy of it in memory for file systems that cannot map files.
+class Reader {
+ public:
+  static Status Open(Env* env, const std::string& filename,
+                     std::unique_ptr<Reader>* out_reader);
+
+  const experimental::ColumnarFooter& footer() const { return footer_; }
+
+  // Returns the index of the column with the given name, or -1.
+  int ColumnIndex(const std::string& name) const;
+
+  // Returns whether the values of `column` in `row_group` may lie in
+  // [`min`, `max`]. Returns true for chunks without statistics.
+  bool MayMatch(int64 row_group, int column, double min, double max) const;
+
+  // Sets `out` to the rows [`start`, `start` + `num_rows`) of `column` in
+  // `row_group`. The tensor aliases the mapped file when the rows are aligned
+  // for Eigen, and is a copy of them otherwise.
+  Status ReadRows(int64 row_group, int column, int64 start, int64 num_rows,
+                  Tensor* out) const;
+
+ private:
+  Reader(std::shared_ptr<ReadOnlyMemoryRegion> region,
+         experimental::ColumnarFooter footer);
+
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const experimental::ColumnarFooter footer_;
+  // The shape of one row of each column, and its size in bytes.
+  std::vector<TensorShape> row_shapes_;
+  std::vector<int64> row_bytes_;
+};
+
+}  // namespace columnar_util
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_UTIL_H_
@@ -0,0 +1,110 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/columnar_util.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace columnar_util {
+namespace {
+
+experimental::ColumnarColumn MakeColumn(const string& name, DataType dtype,
+                                        const TensorShape& shape) {
+  experimental::ColumnarColumn column;
+  column.set_name(name);
+  column.set_dtype(dtype);
+  shape.AsProto(column.mutable_shape());
+  return column;
+}
+
+// Writes two row groups of an int64 scalar column "id" and a float vector
+// column "x", with ids 0..3 and 10..13.
+string WriteTestFile() {
+  string filename;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&filename));
+  std::unique_ptr<Writer> writer;
+  TF_EXPECT_OK(Writer::Create(
+      Env::Default(), filename,
+      {MakeColumn("id", DT_INT64, TensorShape({})),
+       MakeColumn("x", DT_FLOAT, TensorShape({2}))},
+      &writer));
+  for (int64 base : {0, 10}) {
+    TF_EXPECT_OK(writer->WriteRowGroup(
+        {test::AsTensor<int64>({base, base + 1, base + 2, base + 3}),
+         test::AsTensor<float>({0, 1, 2, 3, 4, 5, 6, 7}, TensorShape({4, 2}))}));
+  }
+  TF_EXPECT_OK(writer->Close());
+  return filename;
+}
+
+TEST(ColumnarUtilTest, RoundTrip) {
+  std::unique_ptr<Reader> reader;
+  TF_ASSERT_OK(Reader::Open(Env::Default(), WriteTestFile(), &reader));
+  ASSERT_EQ(reader->footer().row_group_size(), 2);
+  EXPECT_EQ(reader->ColumnIndex("x"), 1);
+  EXPECT_EQ(reader->ColumnIndex("y"), -1);
+
+  Tensor ids;
+  TF_ASSERT_OK(reader->ReadRows(1, 0, 0, 4, &ids));
+  test::ExpectTensorEqual<int64>(ids, test::AsTensor<int64>({10, 11, 12, 13}));
+  // Chunks are aligned, so whole chunks alias the mapped file.
+  Tensor ids_again;
+  TF_ASSERT_OK(reader->ReadRows(1, 0, 0, 4, &ids_again));
+  EXPECT_EQ(ids.tensor_data().data(), ids_again.tensor_data().data());
+
+  Tensor x;
+  TF_ASSERT_OK(reader->ReadRows(0, 1, 1, 2, &x));
+  test::ExpectTensorEqual<float>(
+      x, test::AsTensor<float>({2, 3, 4, 5}, TensorShape({2, 2})));
+
+  EXPECT_TRUE(errors::IsOutOfRange(reader->ReadRows(0, 0, 2, 3, &x)));
+}
+
+TEST(ColumnarUtilTest, RowGroupStats) {
+  std::unique_ptr<Reader> reader;
+  TF_ASSERT_OK(Reader::Open(Env::Default(), WriteTestFile(), &reader));
+  EXPECT_TRUE(reader->MayMatch(0, 0, 3, 5));
+  EXPECT_FALSE(reader->MayMatch(0, 0, 4, 9));
+  EXPECT_TRUE(reader->MayMatch(1, 0, 4, 10));
+  EXPECT_FALSE(reader->MayMatch(1, 0, 14, 20));
+}
+
+TEST(ColumnarUtilTest, RejectsVariableSizeColumns) {
+  string filename;
+  ASSERT_TRUE(Env::Default()->LocalTempFilename(&filename));
+  std::unique_ptr<Writer> writer;
+  EXPECT_TRUE(errors::IsInvalidArgument(Writer::Create(
+      Env::Default(), filename, {MakeColumn("s", DT_STRING, TensorShape({}))},
+      &writer)));
+}
+
+TEST(ColumnarUtilTest, RejectsOtherFiles) {
+  string filename;
+  ASSERT_TRUE(Env::Default()->LocalTempFilename(&filename));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, "not columnar"));
+  std::unique_ptr<Reader> reader;
+  EXPECT_TRUE(
+      errors::IsDataLoss(Reader::Open(Env::Default(), filename, &reader)));
+}
+
+}  // namespace
+}  // namespace columnar_util
+}  // namespace data
+}  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/csv_util.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
@@ -502,7 +503,8 @@ class CSVDatasetOp : public DatasetOpKernel {
         pos_++;  // Starting quotation mark
 
         Status parse_result;
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        // Each iteration scans to the next quote, filling buffer if necessary.
+        while (true) {
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             if (errors::IsOutOfRange(s)) {
@@ -514,49 +516,52 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
-          char ch = buffer_[pos_];
-          if (ch == '"') {
-            // When we encounter a quote, we look ahead to the next character to
-            // decide what to do
-            pos_++;
-            if (pos_ >= buffer_.size()) {
-              Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
-              if (errors::IsOutOfRange(s)) {
-                // This was the last field. We are done
-                *end_of_record = true;
-                parse_result.Update(QuotedFieldToOutput(
-                    ctx, StringPiece(), out_tensors, earlier_pieces, include));
-                return parse_result;
-              } else if (!s.ok()) {
-                return s;
-              }
-            }
-
-            char next = buffer_[pos_];
-            pos_++;
-            if (next == dataset()->delim_) {
-              parse_result.Update(QuotedFieldToOutput(
-                  ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
-                  out_tensors, earlier_pieces, include));
-              return parse_result;
+          // Skip ahead to the next quote; nothing else ends a quoted field.
+          const void* quote = std::memchr(&buffer_[pos_], '"',
+                                          buffer_.size() - pos_);
+          if (quote == nullptr) {
+            pos_ = buffer_.size();
+            continue;
+          }
+          pos_ = static_cast<const char*>(quote) - buffer_.data();
 
-            } else if (next == '\n' || next == '\r') {
+          // When we encounter a quote, we look ahead to the next character to
+          // decide what to do
+          pos_++;
+          if (pos_ >= buffer_.size()) {
+            Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
+            if (errors::IsOutOfRange(s)) {
+              // This was the last field. We are done
               *end_of_record = true;
               parse_result.Update(QuotedFieldToOutput(
-                  ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
-                  out_tensors, earlier_pieces, include));
-              if (next == '\r') SkipNewLineIfNecessary();
+                  ctx, StringPiece(), out_tensors, earlier_pieces, include));
               return parse_result;
-            } else if (next != '"') {
-              // Take note of the error, but keep going to end of field.
-              include = false;  // So we don't get funky errors when trying to
-                                // unescape the quotes.
-              parse_result.Update(errors::InvalidArgument(
-                  "Quote inside a string has to be escaped by another quote"));
+            } else if (!s.ok()) {
+              return s;
             }
+          }
 
-          } else {
-            pos_++;
+          char next = buffer_[pos_];
+          pos_++;
+          if (next == dataset()->delim_) {
+            parse_result.Update(QuotedFieldToOutput(
+                ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
+                out_tensors, earlier_pieces, include));
+            return parse_result;
+
+          } else if (next == '\n' || next == '\r') {
+            *end_of_record = true;
+            parse_result.Update(QuotedFieldToOutput(
+                ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
+                out_tensors, earlier_pieces, include));
+            if (next == '\r') SkipNewLineIfNecessary();
+            return parse_result;
+          } else if (next != '"') {
+            // Take note of the error, but keep going to end of field.
+            include = false;  // So we don't get funky errors when trying to
+                              // unescape the quotes.
+            parse_result.Update(errors::InvalidArgument(
+                "Quote inside a string has to be escaped by another quote"));
           }
         }
       }
@@ -635,7 +640,9 @@ class CSVDatasetOp : public DatasetOpKernel {
         size_t start = pos_;
         Status parse_result;
 
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        // Each iteration scans to the next delimiter, line break or quote,
+        // filling buffer if necessary.
+        while (true) {
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             // Handle errors
@@ -651,6 +658,12 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          pos_ = csv_util::FindFieldEnd(buffer_.data(), pos_, buffer_.size(),
+                                        dataset()->delim_,
+                                        dataset()->use_quote_delim_);
+          if (pos_ >= buffer_.size()) {
+            continue;
+          }
           char ch = buffer_[pos_];
 
           if (ch == dataset()->delim_) {
@@ -676,7 +689,6 @@ class CSVDatasetOp : public DatasetOpKernel {
             parse_result.Update(errors::InvalidArgument(
                 "Unquoted fields cannot have quotes inside"));
           }
-          // Otherwise, go to next character
           pos_++;
         }
       }
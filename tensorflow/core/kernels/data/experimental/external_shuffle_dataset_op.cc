@@ -0,0 +1,352 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/external_shuffle_dataset_op.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    ExternalShuffleDatasetOp::kInputDataset;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kBufferSize;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kSeed;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kSeed2;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kSpillDir;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const
+    ExternalShuffleDatasetOp::kOutputShapes;
+
+namespace {
+
+// Returns the key of the `j`-th tensor of the `i`-th element of a run.
+string RunKey(size_t i, size_t j) { return strings::StrCat(i, "_", j); }
+
+void DeleteRunFiles(const string& prefix) {
+  Env* env = Env::Default();
+  std::vector<string> files;
+  Status s = env->GetMatchingPaths(strings::StrCat(prefix, "*"), &files);
+  for (const string& file : files) {
+    s.Update(env->DeleteFile(file));
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete the shuffle run " << prefix << ": " << s;
+  }
+}
+
+}  // namespace
+
+class ExternalShuffleDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
+          int64 seed, int64 seed2, string spill_dir)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        buffer_size_(buffer_size),
+        seed_(seed),
+        seed2_(seed2),
+        spill_dir_(std::move(spill_dir)) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64 Cardinality() const override { return input_->Cardinality(); }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* buffer_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+    Node* seed = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
+    Node* seed2 = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
+    Node* spill_dir = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(tstring(spill_dir_), &spill_dir));
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node, buffer_size, seed, seed2, spill_dir},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          parent_generator_(params.dataset->seed_, params.dataset->seed2_),
+          generator_(&parent_generator_) {}
+
+    ~Iterator() override {
+      mutex_lock l(mu_);
+      for (Run& run : runs_) {
+        CloseRunLocked(&run);
+      }
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (input_impl_ != nullptr) {
+        TF_RETURN_IF_ERROR(ReadInputLocked(ctx));
+      }
+      if (num_remaining_ == 0) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      // Drawing the next element from a run with probability proportional to
+      // the number of elements left in it, and reading each run in its own
+      // random order, yields a uniformly random permutation of all elements.
+      uint64 index = RandomUint64Locked() % num_remaining_;
+      Run* run = nullptr;
+      for (Run& candidate : runs_) {
+        const uint64 left = candidate.size - candidate.next;
+        if (index < left) {
+          run = &candidate;
+          break;
+        }
+        index -= left;
+      }
+      DCHECK(run != nullptr);
+      if (run->reader == nullptr) {
+        *out_tensors = std::move(run->elements[run->next]);
+      } else {
+        out_tensors->resize(dataset()->output_dtypes().size());
+        for (size_t j = 0; j < out_tensors->size(); ++j) {
+          TF_RETURN_IF_ERROR(
+              run->reader->Lookup(RunKey(run->next, j), &(*out_tensors)[j]));
+        }
+      }
+      ++run->next;
+      --num_remaining_;
+      if (run->next == run->size) {
+        CloseRunLocked(run);
+      }
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      return errors::Unimplemented(
+          "ExternalShuffleDataset does not support checkpointing.");
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      return errors::Unimplemented(
+          "ExternalShuffleDataset does not support checkpointing.");
+    }
+
+   private:
+    // A randomly ordered run of elements, held in memory or spilled to disk.
+    struct Run {
+      std::vector<std::vector<Tensor>> elements;
+      string prefix;
+      std::unique_ptr<BundleReader> reader;
+      int64 size = 0;
+      // The index of the next element to read.
+      int64 next = 0;
+    };
+
+    uint64 RandomUint64Locked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const uint64 hi = generator_();
+      return (hi << 32) | generator_();
+    }
+
+    // Reads the whole input, spilling every `buffer_size` elements as a run.
+    // The last, partially filled buffer stays in memory.
+    Status ReadInputLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<std::vector<Tensor>> buffer;
+      bool end_of_input = false;
+      while (true) {
+        std::vector<Tensor> element;
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &element, &end_of_input));
+        if (end_of_input) break;
+        buffer.push_back(std::move(element));
+        if (static_cast<int64>(buffer.size()) == dataset()->buffer_size_) {
+          TF_RETURN_IF_ERROR(SpillRunLocked(ctx->env(), &buffer));
+        }
+      }
+      input_impl_.reset();
+      if (!buffer.empty()) {
+        ShuffleLocked(&buffer);
+        runs_.emplace_back();
+        Run& run = runs_.back();
+        run.size = buffer.size();
+        run.elements = std::move(buffer);
+        num_remaining_ += run.size;
+      }
+      VLOG(2) << "Shuffling " << num_remaining_ << " elements in "
+              << runs_.size() << " runs.";
+      return Status::OK();
+    }
+
+    void ShuffleLocked(std::vector<std::vector<Tensor>>* elements)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (size_t i = elements->size(); i > 1; --i) {
+        std::swap((*elements)[i - 1], (*elements)[RandomUint64Locked() % i]);
+      }
+    }
+
+    Status SpillRunLocked(Env* env, std::vector<std::vector<Tensor>>* buffer)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      ShuffleLocked(buffer);
+      string dir = dataset()->spill_dir_;
+      if (dir.empty()) {
+        std::vector<string> dirs;
+        env->GetLocalTempDirectories(&dirs);
+        dir = dirs.empty() ? "/tmp" : dirs[0];
+      }
+      runs_.emplace_back();
+      Run& run = runs_.back();
+      run.prefix = io::JoinPath(
+          dir, strings::StrCat("tf_data_external_shuffle_", random::New64()));
+      {
+        BundleWriter writer(env, run.prefix);
+        TF_RETURN_IF_ERROR(writer.status());
+        for (size_t i = 0; i < buffer->size(); ++i) {
+          for (size_t j = 0; j < (*buffer)[i].size(); ++j) {
+            TF_RETURN_IF_ERROR(writer.Add(RunKey(i, j), (*buffer)[i][j]));
+          }
+        }
+        TF_RETURN_IF_ERROR(writer.Finish());
+      }
+      run.reader = absl::make_unique<BundleReader>(env, run.prefix);
+      TF_RETURN_IF_ERROR(run.reader->status());
+      run.size = buffer->size();
+      num_remaining_ += run.size;
+      buffer->clear();
+      return Status::OK();
+    }
+
+    void CloseRunLocked(Run* run) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      run->elements.clear();
+      run->reader.reset();
+      if (!run->prefix.empty()) {
+        DeleteRunFiles(run->prefix);
+        run->prefix.clear();
+      }
+    }
+
+    mutex mu_;
+    // Reset once the whole input has been read into runs.
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::vector<Run> runs_ TF_GUARDED_BY(mu_);
+    // The number of elements left to produce across all runs.
+    int64 num_remaining_ TF_GUARDED_BY(mu_) = 0;
+    random::PhiloxRandom parent_generator_ TF_GUARDED_BY(mu_);
+    random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        TF_GUARDED_BY(mu_);
+  };
+
+  const DatasetBase* const input_;
+  const int64 buffer_size_;
+  const int64 seed_;
+  const int64 seed2_;
+  const string spill_dir_;
+};
+
+ExternalShuffleDatasetOp::ExternalShuffleDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {}
+
+void ExternalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                           DatasetBase* input,
+                                           DatasetBase** output) {
+  int64 buffer_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64>(ctx, kBufferSize, &buffer_size));
+  OP_REQUIRES(ctx, buffer_size > 0,
+              errors::InvalidArgument("`buffer_size` must be positive."));
+
+  int64 seed;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kSeed, &seed));
+  int64 seed2;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kSeed2, &seed2));
+  // As in `ShuffleDataset`, a seed pair of zeros means a random seed.
+  if (seed == 0 && seed2 == 0) {
+    seed = random::New64();
+    seed2 = random::New64();
+  }
+
+  tstring spill_dir;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<tstring>(ctx, kSpillDir, &spill_dir));
+
+  *output = new Dataset(ctx, input, buffer_size, seed, seed2, spill_dir);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("ExternalShuffleDataset").Device(DEVICE_CPU),
+                        ExternalShuffleDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,133 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/external_shuffle_dataset_op.h"
+
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "external_shuffle_dataset";
+
+class ExternalShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  ExternalShuffleDatasetParams(T input_dataset_params, int64 buffer_size,
+                               int64 seed, int64 seed2, string spill_dir,
+                               DataTypeVector output_dtypes,
+                               std::vector<PartialTensorShape> output_shapes,
+                               string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        buffer_size_(buffer_size),
+        seed_(seed),
+        seed2_(seed2),
+        spill_dir_(std::move(spill_dir)) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors = CreateTensors<int64>(
+        TensorShape({}), {{buffer_size_}, {seed_}, {seed2_}});
+    input_tensors.push_back(
+        CreateTensor<tstring>(TensorShape({}), {spill_dir_}));
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {ExternalShuffleDatasetOp::kInputDataset,
+                    ExternalShuffleDatasetOp::kBufferSize,
+                    ExternalShuffleDatasetOp::kSeed,
+                    ExternalShuffleDatasetOp::kSeed2,
+                    ExternalShuffleDatasetOp::kSpillDir};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{ExternalShuffleDatasetOp::kOutputTypes, output_dtypes_},
+                    {ExternalShuffleDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return ExternalShuffleDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64 buffer_size_;
+  int64 seed_;
+  int64 seed2_;
+  string spill_dir_;
+};
+
+class ExternalShuffleDatasetOpTest : public DatasetOpsTestBase {};
+
+ExternalShuffleDatasetParams MakeDatasetParams(int64 buffer_size) {
+  return ExternalShuffleDatasetParams(
+      RangeDatasetParams(0, 10, 1), buffer_size,
+      /*seed=*/1,
+      /*seed2=*/2,
+      /*spill_dir=*/testing::TmpDir(),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+// Test case 1: all elements fit in one in-memory run.
+ExternalShuffleDatasetParams ExternalShuffleDatasetParams1() {
+  return MakeDatasetParams(/*buffer_size=*/20);
+}
+
+// Test case 2: three runs are spilled, and the last element stays in memory.
+ExternalShuffleDatasetParams ExternalShuffleDatasetParams2() {
+  return MakeDatasetParams(/*buffer_size=*/3);
+}
+
+// Test case 3: the buffer size is not positive.
+ExternalShuffleDatasetParams InvalidBufferSizeDatasetParams() {
+  return MakeDatasetParams(/*buffer_size=*/0);
+}
+
+std::vector<GetNextTestCase<ExternalShuffleDatasetParams>> GetNextTestCases() {
+  return {
+      {/*dataset_params=*/ExternalShuffleDatasetParams1(),
+       /*expected_outputs=*/
+       CreateTensors<int64>(TensorShape({}),
+                            {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}}),
+       /*compare_order=*/false},
+      {/*dataset_params=*/ExternalShuffleDatasetParams2(),
+       /*expected_outputs=*/
+       CreateTensors<int64>(TensorShape({}),
+                            {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}}),
+       /*compare_order=*/false}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(ExternalShuffleDatasetOpTest,
+                         ExternalShuffleDatasetParams, GetNextTestCases())
+
+TEST_F(ExternalShuffleDatasetOpTest, InvalidBufferSize) {
+  EXPECT_EQ(Initialize(InvalidBufferSizeDatasetParams()).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -478,7 +478,9 @@ class RebatchDatasetV2Op : public UnaryDatasetOpKernel {
           TensorShape remaining_shape = slices_to_concatenate[0][i].shape();
           remaining_shape.RemoveDim(0);
           component_shape.AppendShape(remaining_shape);
-          out_tensors->emplace_back(ctx->allocator({}),
+          AllocatorAttributes attr;
+          attr.set_gpu_compatible(true);
+          out_tensors->emplace_back(ctx->allocator(attr),
                                     dataset()->output_dtypes()[i],
                                     component_shape);
           if (!out_tensors->back().IsInitialized()) {
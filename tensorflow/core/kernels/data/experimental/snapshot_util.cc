@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/snapshot_util.h"
 
+#include <map>
 #include <queue>
 
 #include "absl/memory/memory.h"
@@ -39,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/data/experimental/snapshot.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -79,6 +81,41 @@ std::string GetCheckpointFileName(const std::string& shard_directory,
                       static_cast<unsigned long long>(checkpoint_id)));
 }
 
+namespace {
+
+int64 ElementBytes(const std::vector<Tensor>& tensors) {
+  int64 bytes = 0;
+  for (const auto& tensor : tensors) {
+    bytes += tensor.TotalBytes();
+  }
+  return bytes;
+}
+
+int64 WriterMaxBufferedBytes() {
+  int64 max_buffered_mb;
+  Status s = ReadInt64FromEnvVar("TF_SNAPSHOT_WRITER_MAX_BUFFERED_MB",
+                                 kDefaultWriterMaxBufferedBytes >> 20,
+                                 &max_buffered_mb);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+    return kDefaultWriterMaxBufferedBytes;
+  }
+  return max_buffered_mb << 20;
+}
+
+int64 ReaderParallelFiles() {
+  int64 parallel_files;
+  Status s = ReadInt64FromEnvVar("TF_SNAPSHOT_READER_PARALLEL_FILES",
+                                 kDefaultReaderParallelFiles, &parallel_files);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+    return kDefaultReaderParallelFiles;
+  }
+  return parallel_files;
+}
+
+}  // namespace
+
 Status Writer::Create(Env* env, const std::string& filename,
                       const std::string& compression_type, int version,
                       const DataTypeVector& dtypes,
@@ -344,14 +381,16 @@ class Reader::Dataset : public DatasetBase {
   explicit Dataset(const std::string& shard_dir, const std::string& compression,
                    const int64 version, const DataTypeVector& dtypes,
                    const std::vector<PartialTensorShape>& shapes,
-                   const int64 start_index, DatasetContext::Params params)
+                   const int64 start_index, const int64 num_parallel_files,
+                   DatasetContext::Params params)
       : DatasetBase(DatasetContext(std::move(params))),
         shard_dir_(shard_dir),
         compression_(compression),
         version_(version),
         dtypes_(dtypes),
         shapes_(shapes),
-        start_index_(start_index) {}
+        start_index_(start_index),
+        num_parallel_files_(num_parallel_files) {}
 
   const DataTypeVector& output_dtypes() const override { return dtypes_; }
 
@@ -376,6 +415,10 @@ class Reader::Dataset : public DatasetBase {
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
+    if (num_parallel_files_ > 1) {
+      return absl::make_unique<ParallelIterator>(ParallelIterator::Params{
+          this, name_utils::IteratorPrefix(node_name(), prefix)});
+    }
     return absl::make_unique<Iterator>(Iterator::Params{
         this, name_utils::IteratorPrefix(node_name(), prefix)});
   }
@@ -454,12 +497,176 @@ class Reader::Dataset : public DatasetBase {
     uint64 current_checkpoint_id_;
   };
 
+  // Decodes up to `num_parallel_files_` checkpoint files of the shard on
+  // background threads and returns their elements in checkpoint order. Each
+  // file buffers at most kReaderMaxBufferedBytesPerFile of decoded elements.
+  class ParallelIterator : public DatasetIterator<Dataset> {
+   public:
+    explicit ParallelIterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    ~ParallelIterator() override {
+      {
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        cond_var_.notify_all();
+      }
+      // Blocks until the decoder threads exit.
+      threads_.clear();
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      for (int64 i = 0; i < dataset()->num_parallel_files_; ++i) {
+        threads_.push_back(ctx->StartThread(
+            absl::StrCat("snapshot_reader_thread_", i),
+            [this, env = ctx->env()] { DecoderThread(env); }));
+      }
+      bool end_of_sequence;
+      for (int64 i = 0; i < dataset()->start_index_; ++i) {
+        std::vector<Tensor> unused;
+        TF_RETURN_IF_ERROR(GetNextInternal(ctx, &unused, &end_of_sequence));
+      }
+      return Status::OK();
+    }
+
+   protected:
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      while (true) {
+        auto it = files_.find(next_file_to_return_);
+        if (it != files_.end()) {
+          FileBuffer& file = it->second;
+          if (!file.elements.empty()) {
+            *out_tensors = std::move(file.elements.front().value);
+            file.buffered_bytes -= file.elements.front().bytes;
+            file.elements.pop_front();
+            cond_var_.notify_all();
+            *end_of_sequence = false;
+            return Status::OK();
+          }
+          if (file.done) {
+            if (errors::IsNotFound(file.status)) {
+              *end_of_sequence = true;
+              return Status::OK();
+            }
+            TF_RETURN_IF_ERROR(file.status);
+            files_.erase(it);
+            ++next_file_to_return_;
+            cond_var_.notify_all();
+            continue;
+          }
+        }
+        cond_var_.wait(l);
+      }
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      // Not necessary to save any state as this iterator will be reconstructed
+      // from scratch when the parent snapshot dataset is restored from
+      // checkpoint.
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      // Not necessary to restore any state as this iterator will be
+      // reconstructed from scratch when the parent snapshot dataset is restored
+      // from checkpoint.
+      return Status::OK();
+    }
+
+   private:
+    struct FileBuffer {
+      std::deque<ElementOrEOF> elements;
+      int64 buffered_bytes = 0;
+      bool done = false;
+      // NotFound once the decoder has run past the last checkpoint file.
+      Status status;
+    };
+
+    void DecoderThread(Env* env) {
+      while (true) {
+        uint64 checkpoint_id;
+        {
+          mutex_lock l(mu_);
+          while (!cancelled_ && !end_of_files_ &&
+                 next_file_to_decode_ >=
+                     next_file_to_return_ + dataset()->num_parallel_files_) {
+            cond_var_.wait(l);
+          }
+          if (cancelled_ || end_of_files_) {
+            return;
+          }
+          checkpoint_id = next_file_to_decode_++;
+          files_[checkpoint_id];
+        }
+        Status s = DecodeFile(env, checkpoint_id);
+        mutex_lock l(mu_);
+        FileBuffer& file = files_[checkpoint_id];
+        file.done = true;
+        file.status = s;
+        if (!s.ok()) {
+          end_of_files_ = true;
+        }
+        cond_var_.notify_all();
+      }
+    }
+
+    Status DecodeFile(Env* env, uint64 checkpoint_id) {
+      const std::string filename =
+          GetCheckpointFileName(dataset()->shard_dir_, checkpoint_id);
+      TF_RETURN_IF_ERROR(env->FileExists(filename));
+      std::unique_ptr<Reader> reader;
+      TF_RETURN_IF_ERROR(Reader::Create(env, filename, dataset()->compression_,
+                                        dataset()->version_,
+                                        dataset()->dtypes_, &reader));
+      while (true) {
+        ElementOrEOF element;
+        Status s = reader->ReadTensors(&element.value);
+        if (errors::IsOutOfRange(s)) {
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(s);
+        element.bytes = ElementBytes(element.value);
+
+        mutex_lock l(mu_);
+        FileBuffer& file = files_[checkpoint_id];
+        while (!cancelled_ && file.buffered_bytes > 0 &&
+               file.buffered_bytes + element.bytes >
+                   kReaderMaxBufferedBytesPerFile) {
+          cond_var_.wait(l);
+        }
+        if (cancelled_) {
+          return errors::Cancelled("Snapshot reader was cancelled.");
+        }
+        file.buffered_bytes += element.bytes;
+        file.elements.push_back(std::move(element));
+        cond_var_.notify_all();
+      }
+    }
+
+    mutex mu_;
+    condition_variable cond_var_;
+    // Keyed by checkpoint id. `std::map` keeps references stable while the
+    // decoder threads insert new files.
+    std::map<uint64, FileBuffer> files_ TF_GUARDED_BY(mu_);
+    uint64 next_file_to_return_ TF_GUARDED_BY(mu_) = 0;
+    uint64 next_file_to_decode_ TF_GUARDED_BY(mu_) = 0;
+    bool end_of_files_ TF_GUARDED_BY(mu_) = false;
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    std::vector<std::unique_ptr<Thread>> threads_;
+  };
+
   const std::string shard_dir_;
   const std::string compression_;
   const int64 version_;
   const DataTypeVector dtypes_;
   const std::vector<PartialTensorShape> shapes_;
   const int64 start_index_;
+  const int64 num_parallel_files_;
 };
 
 class Reader::NestedDataset : public DatasetBase {
@@ -558,6 +765,7 @@ Status Reader::MakeNestedDataset(Env* env,
                                  const int64 start_index,
                                  DatasetBase** output) {
   std::vector<DatasetBase*> datasets;
+  const int64 num_parallel_files = ReaderParallelFiles();
 
   datasets.reserve(shard_dirs.size());
   for (const auto& shard_dir : shard_dirs) {
@@ -570,7 +778,7 @@ Status Reader::MakeNestedDataset(Env* env,
 
     datasets.push_back(
         new Dataset(shard_dir, compression_type, version, dtypes, shapes,
-                    dataset_start_index,
+                    dataset_start_index, num_parallel_files,
                     DatasetContext::Params({"snapshot_util::Reader::Dataset",
                                             "snapshot_util_reader_Dataset"})));
   }
@@ -924,20 +1132,29 @@ AsyncWriter::AsyncWriter(Env* env, int64 file_index,
                          const std::string& shard_directory,
                          uint64 checkpoint_id, const std::string& compression,
                          int64 version, const DataTypeVector& output_types,
-                         std::function<void(Status)> done) {
+                         std::function<void(Status)> done)
+    : max_buffered_bytes_(WriterMaxBufferedBytes()) {
   thread_ = absl::WrapUnique(env->StartThread(
       ThreadOptions(), absl::StrCat("writer_thread_", file_index),
       [this, env, shard_directory, checkpoint_id, compression, version,
        &output_types, done = std::move(done)] {
-        done(WriterThread(env, shard_directory, checkpoint_id, compression,
-                          version, output_types));
+        Status s = WriterThread(env, shard_directory, checkpoint_id,
+                                compression, version, output_types);
+        {
+          mutex_lock l(mu_);
+          finished_ = true;
+        }
+        done(s);
       }));
 }
 
 void AsyncWriter::Write(const std::vector<Tensor>& tensors) {
   mutex_lock l(mu_);
+  mu_.Await(tensorflow::Condition(this, &AsyncWriter::BufferAvailable));
   ElementOrEOF element;
   element.value = tensors;
+  element.bytes = ElementBytes(tensors);
+  buffered_bytes_ += element.bytes;
   deque_.push_back(std::move(element));
 }
 
@@ -951,12 +1168,20 @@ void AsyncWriter::SignalEOF() {
 void AsyncWriter::Consume(ElementOrEOF* be) {
   mutex_lock l(mu_);
   mu_.Await(tensorflow::Condition(this, &AsyncWriter::ElementAvailable));
-  *be = deque_.front();
+  *be = std::move(deque_.front());
   deque_.pop_front();
+  buffered_bytes_ -= be->bytes;
 }
 
 bool AsyncWriter::ElementAvailable() { return !deque_.empty(); }
 
+// An element is always admitted into an empty buffer, so elements larger than
+// the budget still make progress.
+bool AsyncWriter::BufferAvailable() {
+  return finished_ || max_buffered_bytes_ <= 0 || deque_.empty() ||
+         buffered_bytes_ < max_buffered_bytes_;
+}
+
 Status AsyncWriter::WriterThread(Env* env, const std::string& shard_directory,
                                  uint64 checkpoint_id,
                                  const std::string& compression, int64 version,
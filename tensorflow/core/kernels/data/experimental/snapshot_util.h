@@ -51,6 +51,19 @@ constexpr char kModeRead[] = "read";
 constexpr char kModePassthrough[] = "passthrough";
 constexpr char kShardDirectorySuffix[] = ".shard";
 
+// Default number of bytes of pending elements an `AsyncWriter` buffers before
+// `Write` blocks. Can be overridden with TF_SNAPSHOT_WRITER_MAX_BUFFERED_MB.
+constexpr int64 kDefaultWriterMaxBufferedBytes = 256 << 20;  // 256 MiB
+
+// Default number of checkpoint files of a shard that are decoded concurrently
+// when reading a snapshot. Can be overridden with
+// TF_SNAPSHOT_READER_PARALLEL_FILES.
+constexpr int64 kDefaultReaderParallelFiles = 1;
+
+// Number of bytes of decoded elements buffered per checkpoint file when
+// checkpoint files are decoded concurrently.
+constexpr int64 kReaderMaxBufferedBytesPerFile = 64 << 20;  // 64 MiB
+
 enum Mode { READER = 0, WRITER = 1, PASSTHROUGH = 2 };
 
 // Returns the name of the "hash" directory for the given base path and hash ID.
@@ -179,6 +192,10 @@ class Reader {
   // This function takes a vector of snapshot files, and returns a nested
   // dataset. Each element within the nested dataset is itself a dataset, and
   // contains all the elements written out to each individual snapshot file.
+  //
+  // Every checkpoint file of a shard is independently decodable, so up to
+  // TF_SNAPSHOT_READER_PARALLEL_FILES of them are decoded concurrently by
+  // background threads. Elements are still produced in file order.
   static Status MakeNestedDataset(Env* env,
                                   const std::vector<std::string>& shard_dirs,
                                   const string& compression_type, int version,
@@ -302,6 +319,8 @@ Status DetermineOpState(const std::string& mode_string, bool file_exists,
 struct ElementOrEOF {
   std::vector<Tensor> value;
   bool end_of_sequence = false;
+  // Total bytes of the tensors in `value`.
+  int64 bytes = 0;
 };
 
 // AsyncWriter provides API for asynchronously writing dataset elements
@@ -317,6 +336,11 @@ struct ElementOrEOF {
 // }
 // writer->SignalEOF();
 // writer = nullptr;  // This will block until writes are flushed.
+//
+// Pending elements are bounded by their size in bytes rather than by their
+// count, so that producers of large elements are throttled before the buffer
+// exhausts memory. The budget is kDefaultWriterMaxBufferedBytes, or
+// TF_SNAPSHOT_WRITER_MAX_BUFFERED_MB if set; 0 disables the bound.
 class AsyncWriter {
  public:
   explicit AsyncWriter(Env* env, int64 file_index,
@@ -325,8 +349,9 @@ class AsyncWriter {
                        const DataTypeVector& output_types,
                        std::function<void(Status)> done);
 
-  // Writes the given tensors. The method is non-blocking and returns without
-  // waiting for the element to be written.
+  // Writes the given tensors. The method returns without waiting for the
+  // element to be written, but blocks while the pending elements exceed the
+  // buffer budget.
   void Write(const std::vector<Tensor>& tensors) TF_LOCKS_EXCLUDED(mu_);
 
   // Signals the end of input. The method is non-blocking and returns without
@@ -336,12 +361,17 @@ class AsyncWriter {
  private:
   void Consume(ElementOrEOF* be) TF_LOCKS_EXCLUDED(mu_);
   bool ElementAvailable() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool BufferAvailable() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   Status WriterThread(Env* env, const std::string& shard_directory,
                       uint64 checkpoint_id, const std::string& compression,
                       int64 version, DataTypeVector output_types);
 
   mutex mu_;
   std::deque<ElementOrEOF> deque_ TF_GUARDED_BY(mu_);
+  const int64 max_buffered_bytes_;
+  int64 buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Set when the writer thread exits, after which `Write` no longer blocks.
+  bool finished_ TF_GUARDED_BY(mu_) = false;
 
   // This has to be last. During destruction, we need to make sure that the
   // Thread object is destroyed first as its destructor blocks on thread
@@ -38,6 +38,15 @@ void GenerateTensorVector(tensorflow::DataTypeVector& dtypes,
   }
 }
 
+// Returns the number of string bytes in `tensors`, for throughput reporting.
+int64 TensorVectorBytes(const std::vector<Tensor>& tensors) {
+  int64 bytes = 0;
+  for (const auto& t : tensors) {
+    bytes += t.scalar<tstring>()().size();
+  }
+  return bytes;
+}
+
 void SnapshotRoundTrip(std::string compression_type, int version) {
   // Generate ground-truth tensors for writing and reading.
   std::vector<Tensor> tensors;
@@ -91,6 +100,47 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kSnappy, 2);
 }
 
+TEST(SnapshotUtilTest, AsyncWriterBackpressure) {
+  // A 1 MiB budget is about 100 elements, so most writes have to wait for the
+  // writer thread.
+  setenv("TF_SNAPSHOT_WRITER_MAX_BUFFERED_MB", "1", /*overwrite=*/1);
+  std::vector<Tensor> tensors;
+  tensorflow::DataTypeVector dtypes;
+  GenerateTensorVector(dtypes, tensors);
+
+  std::string shard_dir;
+  ASSERT_TRUE(Env::Default()->LocalTempFilename(&shard_dir));
+  Status status;
+  {
+    AsyncWriter writer(Env::Default(), /*file_index=*/0, shard_dir,
+                       /*checkpoint_id=*/0, io::compression::kNone,
+                       /*version=*/2, dtypes,
+                       [&status](Status s) { status = s; });
+    for (int i = 0; i < 1000; ++i) {
+      writer.Write(tensors);
+    }
+    writer.SignalEOF();
+  }
+  unsetenv("TF_SNAPSHOT_WRITER_MAX_BUFFERED_MB");
+  TF_ASSERT_OK(status);
+
+  std::unique_ptr<Reader> reader;
+  TF_ASSERT_OK(Reader::Create(Env::Default(),
+                              GetCheckpointFileName(shard_dir, 0),
+                              io::compression::kNone, 2, dtypes, &reader));
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<Tensor> read_tensors;
+    TF_ASSERT_OK(reader->ReadTensors(&read_tensors));
+    EXPECT_EQ(read_tensors.size(), tensors.size());
+  }
+  std::vector<Tensor> read_tensors;
+  EXPECT_TRUE(errors::IsOutOfRange(reader->ReadTensors(&read_tensors)));
+
+  int64 undeleted_files, undeleted_dirs;
+  TF_ASSERT_OK(Env::Default()->DeleteRecursively(shard_dir, &undeleted_files,
+                                                 &undeleted_dirs));
+}
+
 void SnapshotReaderBenchmarkLoop(int iters, std::string compression_type,
                                  int version) {
   tensorflow::testing::StopTiming();
@@ -121,6 +171,8 @@ void SnapshotReaderBenchmarkLoop(int iters, std::string compression_type,
     reader->ReadTensors(&read_tensors).IgnoreError();
   }
   tensorflow::testing::StopTiming();
+  tensorflow::testing::BytesProcessed(static_cast<int64>(iters) *
+                                      TensorVectorBytes(tensors));
 
   TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
 }
@@ -172,6 +224,8 @@ void SnapshotWriterBenchmarkLoop(int iters, std::string compression_type,
   }
   writer->Close().IgnoreError();
   tensorflow::testing::StopTiming();
+  tensorflow::testing::BytesProcessed(static_cast<int64>(iters) *
+                                      TensorVectorBytes(tensors));
 
   TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
 }
@@ -207,6 +261,39 @@ BENCHMARK(SnapshotTFRecordWriterNoneBenchmark);
 BENCHMARK(SnapshotTFRecordWriterGzipBenchmark);
 BENCHMARK(SnapshotTFRecordWriterSnappyBenchmark);
 
+// Measures end-to-end throughput of the asynchronous writer, including the
+// time to drain the buffer on close.
+void SnapshotAsyncWriterBenchmark(int iters) {
+  tensorflow::testing::StopTiming();
+
+  tensorflow::DataTypeVector dtypes;
+  std::vector<Tensor> tensors;
+  GenerateTensorVector(dtypes, tensors);
+
+  std::string shard_dir;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&shard_dir));
+
+  tensorflow::testing::StartTiming();
+  {
+    AsyncWriter writer(Env::Default(), /*file_index=*/0, shard_dir,
+                       /*checkpoint_id=*/0, io::compression::kSnappy,
+                       /*version=*/2, dtypes, [](Status s) {});
+    for (int i = 0; i < iters; ++i) {
+      writer.Write(tensors);
+    }
+    writer.SignalEOF();
+  }
+  tensorflow::testing::StopTiming();
+  tensorflow::testing::BytesProcessed(static_cast<int64>(iters) *
+                                      TensorVectorBytes(tensors));
+
+  int64 undeleted_files, undeleted_dirs;
+  TF_ASSERT_OK(Env::Default()->DeleteRecursively(shard_dir, &undeleted_files,
+                                                 &undeleted_dirs));
+}
+
+BENCHMARK(SnapshotAsyncWriterBenchmark);
+
 }  // namespace
 }  // namespace snapshot_util
 }  // namespace data
@@ -18,7 +18,9 @@ limitations under the License.
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/stats_aggregator.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/stats_utils.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/util/ptr_util.h"
@@ -50,7 +52,17 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES(ctx, cpu_budget_ > 0,
                 errors::InvalidArgument("CPU budget must be positive but is ",
                                         cpu_budget_, "."));
-    ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    if (ctx->HasAttr("ram_budget")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("ram_budget", &ram_budget_));
+    } else {
+      ram_budget_ = 0;
+    }
+    if (ram_budget_ == 0) {
+      ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    }
+    OP_REQUIRES(ctx, ram_budget_ > 0,
+                errors::InvalidArgument("RAM budget must be positive but is ",
+                                        ram_budget_, "."));
   }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -205,6 +217,7 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
           }
           model_->Optimize(dataset()->algorithm_, dataset()->cpu_budget_,
                            dataset()->ram_budget_, /*model_input_time=*/0);
+          RecordBufferedBytes(ctx.get());
           // Exponentially increase the period of running the optimization
           // until a threshold is reached.
           if (optimization_period_ms != kOptimizationPeriodThresholdMs) {
@@ -217,6 +230,20 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
         }
       }
 
+      // Reports the number of bytes buffered by each node of the model.
+      void RecordBufferedBytes(IteratorContext* ctx) {
+        auto stats_aggregator = ctx->stats_aggregator();
+        if (!stats_aggregator) {
+          return;
+        }
+        const int64 num_elements = num_elements_.fetch_add(1);
+        for (const auto& pair : model_->BufferedBytes()) {
+          stats_aggregator->AddScalar(
+              stats_utils::BufferedBytesScalarName(pair.first),
+              static_cast<float>(pair.second), num_elements);
+        }
+      }
+
       void RecordInput(int64 time_nanos) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (last_output_time_ != 0) {
           DCHECK_LE(last_output_time_, time_nanos);
@@ -246,6 +273,8 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
       int64 num_input_events_ TF_GUARDED_BY(mu_) = 0;
       int64 input_time_ TF_GUARDED_BY(mu_) = 0;
       int64 last_output_time_ TF_GUARDED_BY(mu_) = 0;
+      // Number of times the buffered bytes have been reported.
+      std::atomic<int64> num_elements_{0};
     };
 
     const DatasetBase* input_;
@@ -115,6 +115,10 @@ constexpr double kDefaultCyclePrefetchFactor = 2.0L;
 // match the behavior of the original implementation.
 constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 
+// The maximum number of elements buffered per input, as a multiple of the block
+// length, that autotuning may set `buffer_output_elements` to.
+constexpr int64 kMaxPerIteratorPrefetchFactor = 16;
+
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
@@ -171,6 +175,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         block_length_(block_length),
         buffer_output_elements_(
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
+        autotune_buffer_output_elements_(buffer_output_elements ==
+                                         model::kAutotune),
         prefetch_input_elements_(ComputePrefetchInputElements(
             prefetch_input_elements, cycle_length)),
         num_parallel_calls_(num_parallel_calls),
@@ -252,8 +258,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
 
     if (op_version_ >= 4) {
       Node* buffer_output_elements_node;
-      TF_RETURN_IF_ERROR(
-          b->AddScalar(buffer_output_elements_, &buffer_output_elements_node));
+      TF_RETURN_IF_ERROR(b->AddScalar(autotune_buffer_output_elements_
+                                          ? model::kAutotune
+                                          : buffer_output_elements_,
+                                      &buffer_output_elements_node));
       inputs.emplace_back(input_index++, buffer_output_elements_node);
 
       Node* prefetch_input_elements_node;
@@ -301,6 +309,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           num_parallel_calls_(std::make_shared<model::SharedState>(
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
+          buffer_output_elements_(std::make_shared<model::SharedState>(
+              params.dataset->autotune_buffer_output_elements_
+                  ? model::kAutotune
+                  : params.dataset->buffer_output_elements_,
+              mu_, num_parallel_calls_cond_var_)),
           deterministic_(deterministic),
           current_elements_(params.dataset->cycle_length_) {}
 
@@ -331,6 +344,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       if (num_parallel_calls_->value == model::kAutotune) {
         num_parallel_calls_->value = dataset()->cycle_length_;
       }
+      if (buffer_output_elements_->value == model::kAutotune) {
+        buffer_output_elements_->value = dataset()->buffer_output_elements_;
+      }
       // TODO(jsimsa): Register cancellation callback once the implementation is
       // refactored not to hold mu_ while calling `GetNext` on the input.
       ctx_ = std::make_unique<IteratorContext>(*ctx);
@@ -382,10 +398,15 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
+      const int64 max_buffer_output_elements =
+          kMaxPerIteratorPrefetchFactor * dataset()->block_length_ + 1;
       return model::MakeAsyncInterleaveManyNode(
           std::move(args),
           {model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/1,
-                                /*max=*/dataset()->cycle_length_)});
+                                /*max=*/dataset()->cycle_length_),
+           model::MakeParameter(model::kBufferSize, buffer_output_elements_,
+                                /*min=*/1,
+                                /*max=*/max_buffer_output_elements)});
     }
 
     // TODO(aaudibert): Refactor the implementations to avoid the need for
@@ -949,7 +970,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= buffer_output_elements_->value) {
           break;
         }
       }
@@ -1047,7 +1068,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         return true;
       }
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             element->results.size() < buffer_output_elements_->value;
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1455,6 +1476,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Identifies the maximum number of parallel calls.
     const std::shared_ptr<model::SharedState> num_parallel_calls_;
 
+    // Identifies the maximum number of results buffered per current element.
+    // Autotuning changes it when `buffer_output_elements` is `kAutotune`. An
+    // element whose buffer was full is processed again, with the new value,
+    // once one of its results is consumed.
+    const std::shared_ptr<model::SharedState> buffer_output_elements_;
+
     // The number of current workers currently alive or scheduled to be started.
     // This includes current workers which are blocked waiting for work.
     int num_current_workers_ TF_GUARDED_BY(mu_) = 0;
@@ -1523,6 +1550,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64 cycle_length_;
   const int64 block_length_;
   const int64 buffer_output_elements_;
+  const bool autotune_buffer_output_elements_;
   const int64 prefetch_input_elements_;
   const int64 num_parallel_calls_;
   const DeterminismPolicy deterministic_;
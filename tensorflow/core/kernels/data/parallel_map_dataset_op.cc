@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/stats_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
@@ -66,6 +67,10 @@ constexpr char kErrorMessage[] = ".error_message";
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
+// Maximum number of results that deterministic autotuned iterators buffer per
+// parallel call.
+constexpr int64 kMaxPerCallBufferSize = 8;
+
 }  // namespace
 
 class ParallelMapDatasetOp::Dataset : public DatasetBase {
@@ -203,7 +208,10 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
           deterministic_(params.dataset->deterministic_.IsDeterministic() ||
                          params.dataset->deterministic_.IsDefault()),
           preserve_cardinality_(params.dataset->preserve_cardinality_),
-          autotune_(params.dataset->num_parallel_calls_ == model::kAutotune) {}
+          autotune_(params.dataset->num_parallel_calls_ == model::kAutotune),
+          per_call_buffer_size_(std::make_shared<model::SharedState>(
+              deterministic_ && autotune_ ? model::kAutotune : 1, mu_,
+              cond_var_)) {}
 
     ~Iterator() override {
       CancelThreads(/*wait=*/true);
@@ -215,6 +223,9 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       if (num_parallel_calls_->value == model::kAutotune) {
         num_parallel_calls_->value = ctx->runner_threadpool_size();
       }
+      if (per_call_buffer_size_->value == model::kAutotune) {
+        per_call_buffer_size_->value = 1;
+      }
       TF_RETURN_IF_ERROR(RegisterCancellationCallback(
           ctx->cancellation_manager(),
           [this]() { CancelThreads(/*wait=*/false); }, &deregister_fn_));
@@ -253,11 +264,18 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
-      return model::MakeAsyncKnownRatioNode(
-          std::move(args),
-          /*ratio=*/1,
-          {model::MakeParameter("parallelism", num_parallel_calls_, /*min=*/1,
-                                /*max=*/ctx->runner_threadpool_size())});
+      std::vector<std::shared_ptr<model::Parameter>> parameters = {
+          model::MakeParameter("parallelism", num_parallel_calls_, /*min=*/1,
+                               /*max=*/ctx->runner_threadpool_size())};
+      if (deterministic_) {
+        // Buffering more than one result per parallel call lets the calls run
+        // ahead of a slow element at the head of the in-order buffer.
+        parameters.push_back(model::MakeParameter(
+            model::kBufferSize, per_call_buffer_size_, /*min=*/1,
+            /*max=*/kMaxPerCallBufferSize));
+      }
+      return model::MakeAsyncKnownRatioNode(std::move(args),
+                                            /*ratio=*/1, std::move(parameters));
     }
 
     Status SaveInternal(SerializationContext* ctx,
@@ -502,7 +520,8 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       auto busy = [this]() TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) -> bool {
         int64 num_parallel_calls = num_parallel_calls_->value;
         return num_calls_ >= num_parallel_calls ||
-               invocation_results_.size() >= num_parallel_calls;
+               invocation_results_.size() >=
+                   num_parallel_calls * per_call_buffer_size_->value;
       };
       // Counts the total number of calls to use as an id of InvocationResult.
       int64 num_total_calls = 0;
@@ -510,9 +529,15 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         {
           mutex_lock l(*mu_);
           while (!cancelled_ && busy()) {
+            const bool stalled = HeadOfLineStalled();
+            const int64 stall_start = stalled ? EnvTime::NowNanos() : 0;
             RecordStop(ctx.get());
             cond_var_->wait(l);
             RecordStart(ctx.get());
+            if (stalled && model_node()) {
+              model_node()->record_stall(EnvTime::NowNanos() - stall_start,
+                                         per_call_buffer_size_->value);
+            }
           }
           if (cancelled_) {
             return;
@@ -532,6 +557,15 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Determines whether new calls are held back only because the result at
+    // the head of the full in-order buffer is not available yet, while some of
+    // the parallel calls are idle.
+    bool HeadOfLineStalled() TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      return deterministic_ && num_calls_ < num_parallel_calls_->value &&
+             !invocation_results_.empty() &&
+             !invocation_results_.front()->notification.HasBeenNotified();
+    }
+
     // Determines whether the caller needs to wait for a result. Upon returning
     // false, `result` will point to the result.
     bool ShouldWait(std::shared_ptr<InvocationResult>* result)
@@ -644,6 +678,10 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     const bool deterministic_;
     const bool preserve_cardinality_;
     const bool autotune_;
+    // Identifies the number of results buffered per parallel call. Results are
+    // produced in order, so in deterministic mode a larger buffer lets the
+    // parallel calls run ahead of a slow element instead of idling.
+    const std::shared_ptr<model::SharedState> per_call_buffer_size_;
     // Counts the number of outstanding calls.
     int64 num_calls_ TF_GUARDED_BY(*mu_) = 0;
     std::unique_ptr<InstantiatedCapturedFunction> instantiated_captured_func_;
@@ -27,8 +27,10 @@ ABSL_CONST_INIT const char kThreadUtilization[] = "thread_utilization";
 ABSL_CONST_INIT const char kBufferSize[] = "buffer_size";
 ABSL_CONST_INIT const char kBufferCapacity[] = "buffer_capacity";
 ABSL_CONST_INIT const char kBufferUtilization[] = "buffer_utilization";
+ABSL_CONST_INIT const char kBufferedBytes[] = "buffered_bytes";
 ABSL_CONST_INIT const char kFilteredElements[] = "filtered_elements";
 ABSL_CONST_INIT const char kDroppedElements[] = "dropped_elements";
+ABSL_CONST_INIT const char kPaddingFraction[] = "padding_fraction";
 ABSL_CONST_INIT const char kFeaturesCount[] = "features_count";
 ABSL_CONST_INIT const char kFeatureValuesCount[] = "feature_values_count";
 ABSL_CONST_INIT const char kExamplesCount[] = "examples_count";
@@ -53,6 +55,10 @@ string BufferUtilizationHistogramName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kBufferUtilization);
 }
 
+string BufferedBytesScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kBufferedBytes);
+}
+
 string FilterdElementsScalarName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kFilteredElements);
 }
@@ -61,6 +67,10 @@ string DroppedElementsScalarName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kDroppedElements);
 }
 
+string PaddingFractionHistogramName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kPaddingFraction);
+}
+
 string FeatureHistogramName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kFeaturesCount);
 }
@@ -49,12 +49,20 @@ string BufferCapacityScalarName(const string& prefix);
 // buffer size.) histogram metrics.
 string BufferUtilizationHistogramName(const string& prefix);
 
+// Name for the number of bytes buffered by a node of the autotuning model
+// scalar metrics.
+string BufferedBytesScalarName(const string& prefix);
+
 // Name for filtered elements scalar metrics.
 string FilterdElementsScalarName(const string& prefix);
 
 // Name for dropped elements scalar mereics.
 string DroppedElementsScalarName(const string& prefix);
 
+// Name for padding fraction (ratio of padding values and all values in a
+// padded batch) histogram metrics.
+string PaddingFractionHistogramName(const string& prefix);
+
 // Name for features count histogram metrics.
 string FeatureHistogramName(const string& prefix);
 
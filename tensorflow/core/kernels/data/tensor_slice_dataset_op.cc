@@ -121,6 +121,16 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
       out_tensors->reserve(dataset()->tensors_.size());
       for (size_t i = 0; i < dataset()->tensors_.size(); ++i) {
         const Tensor& t = dataset()->tensors_[i];
+        // Slices whose data is aligned alias the component instead of being
+        // copied. The component keeps its buffer from being forwarded, so the
+        // slices are never modified in place.
+        if (DataTypeCanUseMemcpy(t.dtype())) {
+          Tensor slice = t.SubSlice(index);
+          if (slice.IsAligned()) {
+            out_tensors->push_back(std::move(slice));
+            continue;
+          }
+        }
         out_tensors->emplace_back(ctx->allocator({}), t.dtype(),
                                   dataset()->shapes_[i]);
         TF_RETURN_IF_ERROR(
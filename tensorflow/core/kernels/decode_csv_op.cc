@@ -14,11 +14,15 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <cstring>
+#include <deque>
 #include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/csv_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 
@@ -81,10 +85,14 @@ class DecodeCSVOp : public OpKernel {
       OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
     }
 
+    // Reused across records to avoid per-record allocations.
+    std::vector<StringPiece> fields;
+    std::deque<string> unescaped;
     for (int64 i = 0; i < records_size; ++i) {
       const StringPiece record(records_t(i));
-      std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
+      fields.clear();
+      unescaped.clear();
+      OP_REQUIRES_OK(ctx, ExtractFields(record, &fields, &unescaped));
       OP_REQUIRES(ctx, fields.size() == out_type_.size(),
                   errors::InvalidArgument("Expect ", out_type_.size(),
                                           " fields but have ", fields.size(),
@@ -184,7 +192,8 @@ class DecodeCSVOp : public OpKernel {
               output[f]->flat<tstring>()(i) =
                   record_defaults[f].flat<tstring>()(0);
             } else {
-              output[f]->flat<tstring>()(i) = std::move(fields[f]);
+              output[f]->flat<tstring>()(i).assign(fields[f].data(),
+                                                   fields[f].size());
             }
             break;
           }
@@ -205,14 +214,17 @@ class DecodeCSVOp : public OpKernel {
   bool select_all_cols_;
   string na_value_;
 
-  void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
-    int64 current_idx = 0;
+  // Splits `input` into the selected fields. Fields point into `input`,
+  // except for quoted fields with escaped quotes, which are unescaped into
+  // `unescaped`.
+  Status ExtractFields(StringPiece input, std::vector<StringPiece>* result,
+                       std::deque<string>* unescaped) {
+    size_t current_idx = 0;
     int64 num_fields_parsed = 0;
     int64 selector_idx = 0;  // Keep track of index into select_cols
 
     if (!input.empty()) {
-      while (static_cast<size_t>(current_idx) < input.size()) {
+      while (current_idx < input.size()) {
         if (input[current_idx] == '\n' || input[current_idx] == '\r') {
           current_idx++;
           continue;
@@ -229,48 +241,55 @@ class DecodeCSVOp : public OpKernel {
         }
 
         // This is the body of the field;
-        string field;
+        StringPiece field;
         if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx,
-                        (!use_quote_delim_ || input[current_idx] != '"') &&
-                            input[current_idx] != '\n' &&
-                            input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            if (include) field += input[current_idx];
-            current_idx++;
+          const size_t end = csv_util::FindFieldEnd(
+              input.data(), current_idx, input.size(), delim_,
+              use_quote_delim_);
+          if (end < input.size() && input[end] != delim_) {
+            return errors::InvalidArgument(
+                "Unquoted fields cannot have quotes/CRLFs inside");
           }
+          field = StringPiece(input.data() + current_idx, end - current_idx);
 
           // Go to next field or the end
-          current_idx++;
-        } else if (use_quote_delim_) {
+          current_idx = end + 1;
+        } else {
           // Quoted field needs to be ended with '"' and delim or end
-          while (
-              (static_cast<size_t>(current_idx) < input.size() - 1) &&
-              (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
-            if (input[current_idx] != '"') {
-              if (include) field += input[current_idx];
-              current_idx++;
-            } else {
-              OP_REQUIRES(
-                  ctx, input[current_idx + 1] == '"',
-                  errors::InvalidArgument("Quote inside a string has to be "
-                                          "escaped by another quote"));
-              if (include) field += '"';
-              current_idx += 2;
+          const size_t start = current_idx;
+          bool escaped = false;
+          while (true) {
+            const void* quote =
+                std::memchr(input.data() + current_idx, '"',
+                            input.size() - current_idx);
+            if (quote == nullptr) {
+              return errors::InvalidArgument(
+                  "Quoted field has to end with quote followed by delim or "
+                  "end");
+            }
+            current_idx = static_cast<const char*>(quote) - input.data();
+            if (current_idx == input.size() - 1 ||
+                input[current_idx + 1] == delim_) {
+              break;
             }
+            if (input[current_idx + 1] != '"') {
+              return errors::InvalidArgument(
+                  "Quote inside a string has to be escaped by another quote");
+            }
+            escaped = true;
+            current_idx += 2;
+          }
+          field = StringPiece(input.data() + start, current_idx - start);
+          if (escaped && include) {
+            unescaped->emplace_back();
+            string& unescaped_field = unescaped->back();
+            unescaped_field.reserve(field.size());
+            for (size_t j = 0; j < field.size(); ++j) {
+              unescaped_field += field[j];
+              if (field[j] == '"') ++j;
+            }
+            field = unescaped_field;
           }
-
-          OP_REQUIRES(
-              ctx,
-              (static_cast<size_t>(current_idx) < input.size() &&
-               input[current_idx] == '"' &&
-               (static_cast<size_t>(current_idx) == input.size() - 1 ||
-                input[current_idx + 1] == delim_)),
-              errors::InvalidArgument("Quoted field has to end with quote "
-                                      "followed by delim or end"));
 
           current_idx += 2;
         }
@@ -279,7 +298,7 @@ class DecodeCSVOp : public OpKernel {
         if (include) {
           result->push_back(field);
           selector_idx++;
-          if (selector_idx == select_cols_.size()) return;
+          if (selector_idx == select_cols_.size()) return Status::OK();
         }
       }
 
@@ -288,8 +307,9 @@ class DecodeCSVOp : public OpKernel {
                                    static_cast<size_t>(num_fields_parsed));
       // Check if the last field is missing
       if (include && input[input.size() - 1] == delim_)
-        result->push_back(string());
+        result->push_back(StringPiece());
     }
+    return Status::OK();
   }
 };
 
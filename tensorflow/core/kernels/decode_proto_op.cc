@@ -27,6 +27,7 @@ limitations under the License.
 // are available at runtime but should be competitive in speed with approaches
 // that compile in the proto definitions.
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -60,6 +61,10 @@ using ::tensorflow::protobuf::io::CodedInputStream;
 
 const bool kFailOnDecodeError = true;
 
+// The largest field number which the table dispatching fields to outputs is
+// indexed by.
+const int kMaxDispatchTableFieldNumber = 4096;
+
 // Used to store the default value of a protocol message field, casted to the
 // type of the output tensor.
 //
@@ -214,6 +219,18 @@ struct FieldInfo {
     // inside. For that we go to the schema.
     type = static_cast<WireFormatLite::FieldType>(field_desc->type());
     is_repeated = field_desc->is_repeated();
+
+    // The tags this field is expected to have on the wire, so that parsing
+    // only compares them to the tag read. Packed repeated primitives are
+    // length-delimited.
+    const WireFormatLite::WireType wire_type =
+        WireFormatLite::WireTypeForFieldType(type);
+    tag = WireFormatLite::MakeTag(number, wire_type);
+    packed_tag =
+        wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED
+            ? 0
+            : WireFormatLite::MakeTag(
+                  number, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
   }
 
   // Disable copy and move.
@@ -233,6 +250,11 @@ struct FieldInfo {
   int number;
   bool is_repeated;
   DefaultValue default_value;
+
+  // The tag of a value of the field, and of a packed list of values, or 0 if
+  // the field can't be packed.
+  uint32 tag;
+  uint32 packed_tag;
 };
 
 // A CountCollector counts sizes of repeated and optional fields in a proto.
@@ -703,6 +725,22 @@ class DecodeProtoOp : public OpKernel {
           MakeUnique<FieldInfo>(field_descriptor, output_index, default_value));
     }
 
+    // Compile the table mapping field numbers to requested fields. Field
+    // numbers are usually small and dense, so it is indexed by number, up to
+    // a bound past which the sorted fields are searched instead.
+    if (!fields_.empty()) {
+      max_field_number_ = fields_.back()->number;
+      field_index_by_number_.assign(
+          std::min(max_field_number_, kMaxDispatchTableFieldNumber) + 1, -1);
+      // If a field is requested several times, only its first output gets
+      // values.
+      for (int i = fields_.size() - 1; i >= 0; --i) {
+        if (fields_[i]->number < field_index_by_number_.size()) {
+          field_index_by_number_[fields_[i]->number] = i;
+        }
+      }
+    }
+
     message_prototype_ = message_factory_.GetPrototype(message_desc);
     OP_REQUIRES(context, message_prototype_ != nullptr,
                 errors::InvalidArgument("Couldn't get prototype message: ",
@@ -776,8 +814,15 @@ class DecodeProtoOp : public OpKernel {
     // between real data and defaults using the repeat count matrix that is
     // returned by decode_proto.
     std::vector<int32> max_sizes(field_count, 1);
+    std::vector<int32> field_sizes(field_count);
+    std::vector<CountCollector> counters;
+    counters.reserve(field_count);
+    for (int i = 0; i < field_count; i++) {
+      counters.emplace_back(&field_sizes[i]);
+    }
     for (int mi = 0; mi < message_count; ++mi) {
-      CountFields(ctx, mi, *bufs[mi], sizes_tensor, &max_sizes);
+      CountFields(ctx, mi, *bufs[mi], sizes_tensor, &max_sizes, &field_sizes,
+                  absl::MakeSpan(counters));
       if (!ctx->status().ok()) {
         return;
       }
@@ -831,21 +876,20 @@ class DecodeProtoOp : public OpKernel {
   }
 
   // Count the number of occurrences of each requested field in a message batch.
+  // `counters` count into `field_sizes`, which are reused across messages.
   void CountFields(OpKernelContext* ctx, int message_index, const tstring& buf,
-                   Tensor* sizes_tensor, std::vector<int32>* max_sizes) {
+                   Tensor* sizes_tensor, std::vector<int32>* max_sizes,
+                   std::vector<int32>* field_sizes_ptr,
+                   absl::Span<CountCollector> counters) {
     int field_count = fields_.size();
 
     CodedInputStream input(reinterpret_cast<const uint8*>(buf.c_str()),
                            buf.size());
 
-    std::vector<int32> field_sizes(field_count, 0);
-    std::vector<CountCollector> counters;
-    counters.reserve(field_count);
-    for (int i = 0; i < field_count; i++) {
-      counters.emplace_back(&field_sizes[i]);
-    }
+    std::vector<int32>& field_sizes = *field_sizes_ptr;
+    std::fill(field_sizes.begin(), field_sizes.end(), 0);
 
-    Status st = Collect(&input, absl::MakeSpan(counters));
+    Status st = Collect(&input, counters);
     if (st.ok() && !input.ConsumedEntireMessage()) {
       st = errors::DataLoss("CountFields: Failed to consume entire buffer");
     }
@@ -917,11 +961,12 @@ class DecodeProtoOp : public OpKernel {
       tensors.emplace_back(outputs[fi]);
     }
 
+    std::vector<DenseCollector> collectors;
+    collectors.reserve(field_count);
     for (int message_index = 0; message_index < bufs.size(); ++message_index) {
       const tstring& buf = *bufs[message_index];
 
-      std::vector<DenseCollector> collectors;
-      collectors.reserve(field_count);
+      collectors.clear();
       for (int output_index = 0; output_index < field_count; ++output_index) {
         const TensorInfo& info = tensors[output_index];
         const FieldInfo* field_info = fields_[output_index].get();
@@ -956,73 +1001,38 @@ class DecodeProtoOp : public OpKernel {
     }
   }
 
+  // Returns the index in fields_ of the requested field with the given number,
+  // or -1 if the field isn't requested.
+  int FieldIndex(int field_number) const {
+    if (field_number > max_field_number_) {
+      return -1;
+    }
+    if (field_number < field_index_by_number_.size()) {
+      return field_index_by_number_[field_number];
+    }
+    auto it = std::lower_bound(
+        fields_.begin(), fields_.end(), field_number,
+        [](const std::unique_ptr<const FieldInfo>& field, int number) {
+          return field->number < number;
+        });
+    if (it == fields_.end() || (*it)->number != field_number) {
+      return -1;
+    }
+    return it - fields_.begin();
+  }
+
   // Traverses a serialized protobuf, dispatching values to the collectors.
   template <class CollectorClass>
   Status Collect(CodedInputStream* input,
                  absl::Span<CollectorClass> collectors) {
-    // At the beginning of each loop, the last field number that was seen,
-    // regardless of whether it was collected or not, or -1 if no field has
-    // been seen before.
-    int last_seen_field_number = -1;
-    // The FieldInfo that is expected to be used next.
-    // It was either used to collect the last seen field number, or if the
-    // last seen field number was not in fields_, it is the next FieldInfo after
-    // the last seen field number. At the beginning it is the first FieldInfo.
-    auto expected_field_info_iter = fields_.begin();
-
     // The 'tag' variable should always be treated as tainted.
     for (uint32 tag = input->ReadTag();
          tag != 0 && WireFormatLite::GetTagWireType(tag) !=
                          WireFormatLite::WIRETYPE_END_GROUP;
          tag = input->ReadTag()) {
-      DCHECK(expected_field_info_iter == fields_.begin() ||
-             last_seen_field_number >
-                 (*(expected_field_info_iter - 1))->number);
-      DCHECK(expected_field_info_iter == fields_.end() ||
-             last_seen_field_number <= (*expected_field_info_iter)->number);
-
-      // The field wire number.
-      const int field_number = WireFormatLite::GetTagFieldNumber(tag);
-      // The field info associated with the field wire number.
-      const FieldInfo* field_info = nullptr;
-
-      // fields_ are ordered by their field numbers. If the field numbers
-      // on wire are also ordered (which is a convention), then we can
-      // monotonically increment `expected_field_info_iter` as the field
-      // numbers on wire get larger. If we detect any out-of-order
-      // field number, we reset `expected_field_info_iter`, and expect that
-      // future wire numbers are ordered. This algorithm is quadratic in the
-      // worst case where field numbers on wire are in descending order, however
-      // it works well in the case where two serialized protobufs are
-      // concatenated together.
-      if (field_number < last_seen_field_number) {
-        expected_field_info_iter = fields_.begin();
-      }
-
-      // Advance expected_field_info_iter until
-      // field_number <= expected_field_number.
-      for (; expected_field_info_iter != fields_.end();
-           ++expected_field_info_iter) {
-        DCHECK(expected_field_info_iter == fields_.begin() ||
-               field_number > (*(expected_field_info_iter - 1))->number);
-        const FieldInfo* expected_field_info = expected_field_info_iter->get();
-        if (field_number <= expected_field_info->number) {
-          if (field_number == expected_field_info->number) {
-            field_info = expected_field_info;
-          }
-          break;
-        }
-      }
-      last_seen_field_number = field_number;
-      if (!field_info) {
-        // This DCHECK verifies that if we skip a field, we didn't want it.
-        // In particular, field_builders is empty or the field_number is either:
-        // before fields_.begin().number or  after (fields_.end() - 1).number or
-        // in-between expected_field_info_iter and expected_field_info_iter - 1.
-        DCHECK(fields_.empty() || (field_number < (*fields_.begin())->number) ||
-               (field_number > (*(fields_.end() - 1))->number) ||
-               (((*(expected_field_info_iter - 1))->number < field_number) &&
-                (field_number < (*(expected_field_info_iter))->number)));
+      const int field_index =
+          FieldIndex(WireFormatLite::GetTagFieldNumber(tag));
+      if (field_index < 0) {
         // Unknown and unrequested fields are skipped.
         if (!WireFormatLite::SkipField(input, tag)) {
           return errors::DataLoss("Failed skipping unrequested field");
@@ -1030,36 +1040,27 @@ class DecodeProtoOp : public OpKernel {
         continue;
       }
 
-      TF_RETURN_IF_ERROR(CollectField(
-          *field_info, WireFormatLite::GetTagWireType(tag), input,
-          &collectors[expected_field_info_iter - fields_.begin()]));
+      TF_RETURN_IF_ERROR(CollectField(*fields_[field_index], tag, input,
+                                      &collectors[field_index]));
     }
     return Status::OK();
   }
 
   // Collects values for a single field.
   template <class CollectorClass>
-  Status CollectField(const FieldInfo& field,
-                      WireFormatLite::WireType wire_type,
+  Status CollectField(const FieldInfo& field, uint32 tag,
                       CodedInputStream* input, CollectorClass* collector) {
-    // The wire format library defines the same constants used in
-    // descriptor.proto. This static_cast is safe because they are guaranteed to
-    // stay in sync.
-    //
-    // We need the field type from the FieldDescriptor here because the wire
-    // format doesn't tell us anything about what happens inside a packed
-    // repeated field: there is enough information in the wire format to skip
-    // the whole field but not enough to know how to parse what's inside. For
-    // that we go to the schema.
-    WireFormatLite::WireType schema_wire_type =
-        WireFormatLite::WireTypeForFieldType(field.type);
+    // Read ordinary values, including strings, bytes, and messages.
+    if (tag == field.tag) {
+      return collector->ReadValue(input, field);
+    }
 
     // Handle packed repeated fields. SkipField would skip the whole
     // length-delimited blob without letting us count the values, so we have to
-    // scan them ourselves.
-    if (wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED &&
-        schema_wire_type != WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
-      // Handle packed repeated primitives.
+    // scan them ourselves. The wire format doesn't tell us anything about what
+    // happens inside a packed repeated field, so the values are parsed
+    // according to the schema.
+    if (tag == field.packed_tag) {
       int length;
       if (!input->ReadVarintSizeAsInt(&length)) {
         return errors::DataLoss("CollectField: Failed reading packed size");
@@ -1067,16 +1068,10 @@ class DecodeProtoOp : public OpKernel {
       return collector->ReadPackedValues(input, field, length);
     }
 
-    // Read ordinary values, including strings, bytes, and messages.
-    if (wire_type != schema_wire_type) {
-      if (!WireFormatLite::SkipField(
-              input, WireFormatLite::MakeTag(field.number, wire_type))) {
-        return errors::DataLoss(
-            "CollectField: Failed skipping malformed field");
-      }
-      return Status::OK();
+    if (!WireFormatLite::SkipField(input, tag)) {
+      return errors::DataLoss("CollectField: Failed skipping malformed field");
     }
-    return collector->ReadValue(input, field);
+    return Status::OK();
   }
 
   string message_type_;
@@ -1084,6 +1079,11 @@ class DecodeProtoOp : public OpKernel {
   // general the order given by the user-specified field_names and output_types
   // Op attributes.
   std::vector<std::unique_ptr<const FieldInfo>> fields_;
+  // The index in fields_ of the field with each number up to
+  // kMaxDispatchTableFieldNumber, or -1 if the field isn't requested.
+  std::vector<int32> field_index_by_number_;
+  // The largest number of a requested field.
+  int max_field_number_ = -1;
 
   // Owned_desc_pool_ is null when using descriptor_source=local.
   std::unique_ptr<DescriptorPool> owned_desc_pool_;
@@ -392,6 +392,30 @@ struct LaunchDepthwiseConvBackpropInputOp<CPUDevice, T> {
             "Depthwise convolution on CPU is only supported for NHWC format"));
 
     static const int64 kPacketSize = (sizeof(Packet) / sizeof(T));
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+
+    if (functor::CanUseDepthwiseDirectKernels<T>(args)) {
+      // Reads 'out_backprop' and the unpadded filter in place, one input row
+      // per shard.
+      auto shard = [&args, out_backprop, depthwise_filter, in_backprop](
+                       int64 start, int64 limit) {
+        const int64 input_image_size =
+            args.in_rows * args.in_cols * args.in_depth;
+        const int64 output_image_size =
+            args.out_rows * args.out_cols * args.out_depth;
+        functor::DepthwiseConv2DBackpropInputDirectOp<T> conv;
+        for (int64 i = start; i < limit; ++i) {
+          const int64 b = i / args.in_rows;
+          conv(args, i % args.in_rows, out_backprop + b * output_image_size,
+               depthwise_filter, in_backprop + b * input_image_size);
+        }
+      };
+      const int64 shard_cost = args.in_cols * args.in_depth *
+                               args.filter_rows * args.filter_cols;
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            args.batch * args.in_rows, shard_cost, shard);
+      return;
+    }
 
     // Pad 'depthwise_filter' to vector register width (if needed).
     const bool pad_filter = (args.out_depth % kPacketSize) == 0 ? false : true;
@@ -462,7 +486,6 @@ struct LaunchDepthwiseConvBackpropInputOp<CPUDevice, T> {
     };
 
     const int64 shard_cost = args.in_rows * args.in_cols * args.out_depth;
-    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, args.batch,
           shard_cost, shard);
   }
@@ -878,8 +901,15 @@ struct LaunchDepthwiseConvBackpropFilterOp<CPUDevice, T> {
             "Depthwise convolution on CPU is only supported for NHWC format"));
 
     static const int64 kPacketSize = (sizeof(Packet) / sizeof(T));
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
 
     const int64 filter_spatial_size = args.filter_rows * args.filter_cols;
+    if (functor::CanUseDepthwiseDirectKernels<T>(args)) {
+      LaunchDirect(ctx, args, out_backprop, input, filter_backprop,
+                   worker_threads);
+      return;
+    }
+
     const int64 padded_out_depth_size =
         ((args.out_depth + kPacketSize - 1) / kPacketSize) * kPacketSize;
 
@@ -937,7 +967,6 @@ struct LaunchDepthwiseConvBackpropFilterOp<CPUDevice, T> {
       }
     };
     const int64 shard_cost = args.out_rows * args.out_cols * args.out_depth;
-    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, args.batch,
           shard_cost, shard);
 
@@ -980,6 +1009,72 @@ struct LaunchDepthwiseConvBackpropFilterOp<CPUDevice, T> {
       }
     }
   }
+
+ private:
+  // Splits the rows of all images into one block per thread, accumulates the
+  // filter backprop of each block in its own buffer with the direct kernel,
+  // and sums the buffers into 'filter_backprop'.
+  void LaunchDirect(OpKernelContext* ctx, const DepthwiseArgs& args,
+                    const T* out_backprop, const T* input, T* filter_backprop,
+                    const DeviceBase::CpuWorkerThreads& worker_threads) {
+    static const int64 kPacketSize = (sizeof(Packet) / sizeof(T));
+    const int64 filter_size =
+        args.filter_rows * args.filter_cols * args.out_depth;
+    const int64 total_rows = args.batch * args.out_rows;
+    const int64 num_blocks =
+        std::max<int64>(1, std::min<int64>(total_rows,
+                                           worker_threads.num_threads));
+    const int64 block_rows = (total_rows + num_blocks - 1) / num_blocks;
+
+    Tensor block_buffer;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                TensorShape({num_blocks, filter_size}),
+                                &block_buffer));
+    T* block_buffer_data = block_buffer.template flat<T>().data();
+
+    auto shard = [&args, out_backprop, input, block_buffer_data, filter_size,
+                  total_rows, block_rows](int64 start, int64 limit) {
+      const int64 input_image_size =
+          args.in_rows * args.in_cols * args.in_depth;
+      const int64 output_image_size =
+          args.out_rows * args.out_cols * args.out_depth;
+      functor::DepthwiseConv2DBackpropFilterDirectOp<T> conv;
+      for (int64 block = start; block < limit; ++block) {
+        T* buffer = block_buffer_data + block * filter_size;
+        memset(buffer, 0, filter_size * sizeof(T));
+        const int64 row_end = std::min(total_rows, (block + 1) * block_rows);
+        for (int64 i = block * block_rows; i < row_end; ++i) {
+          const int64 b = i / args.out_rows;
+          conv(args, i % args.out_rows, out_backprop + b * output_image_size,
+               input + b * input_image_size, buffer);
+        }
+      }
+    };
+    const int64 shard_cost = block_rows * args.out_cols * args.out_depth *
+                             args.filter_rows * args.filter_cols;
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          shard_cost, shard);
+
+    // Sum the buffers of the blocks into 'filter_backprop'.
+    const int64 vectorized_size = (filter_size / kPacketSize) * kPacketSize;
+    for (int64 j = 0; j < vectorized_size; j += kPacketSize) {
+      auto sum = Eigen::internal::ploadu<Packet>(block_buffer_data + j);
+      for (int64 block = 1; block < num_blocks; ++block) {
+        sum = Eigen::internal::padd<Packet>(
+            sum, Eigen::internal::ploadu<Packet>(block_buffer_data +
+                                                 block * filter_size + j));
+      }
+      Eigen::internal::pstoreu<T>(filter_backprop + j, sum);
+    }
+    for (int64 j = vectorized_size; j < filter_size; ++j) {
+      T sum = block_buffer_data[j];
+      for (int64 block = 1; block < num_blocks; ++block) {
+        sum += block_buffer_data[block * filter_size + j];
+      }
+      filter_backprop[j] = sum;
+    }
+  }
 };
 
 template <typename T>
@@ -167,6 +167,30 @@ struct LaunchDepthwiseConvOp<CPUDevice, T> {
         errors::Unimplemented(
             "Depthwise convolution on CPU is only supported for NHWC format"));
     static const int64 kPacketSize = (sizeof(Packet) / sizeof(T));
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+
+    if (functor::CanUseDepthwiseDirectKernels<T>(args)) {
+      // Reads the input and the unpadded filter in place, one output row per
+      // shard.
+      auto shard = [&args, input, depthwise_filter, output](int64 start,
+                                                            int64 limit) {
+        const int64 input_image_size =
+            args.in_rows * args.in_cols * args.in_depth;
+        const int64 output_image_size =
+            args.out_rows * args.out_cols * args.out_depth;
+        functor::DepthwiseConv2DDirectOp<T> conv;
+        for (int64 i = start; i < limit; ++i) {
+          const int64 b = i / args.out_rows;
+          conv(args, i % args.out_rows, input + b * input_image_size,
+               depthwise_filter, output + b * output_image_size);
+        }
+      };
+      const int64 shard_cost = args.out_cols * args.out_depth *
+                               args.filter_rows * args.filter_cols;
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            args.batch * args.out_rows, shard_cost, shard);
+      return;
+    }
 
     // Pad 'depthwise_filter' to vector register width (if needed).
     const bool pad_filter = (args.out_depth % kPacketSize) == 0 ? false : true;
@@ -240,7 +264,6 @@ struct LaunchDepthwiseConvOp<CPUDevice, T> {
     // flops/loads/stores required to compute one shard.
     const int64 shard_cost = kCostMultiplier * args.out_cols * args.out_depth;
 
-    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, total_shards,
           shard_cost, shard);
   }
@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DEPTHWISE_CONV_OP_H_
 #define TENSORFLOW_CORE_KERNELS_DEPTHWISE_CONV_OP_H_
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/util/tensor_format.h"
@@ -281,6 +285,324 @@ struct DepthwiseInputCopyOp {
   }
 };
 
+// The direct kernels below compute depthwise convolutions with a depth
+// multiplier of 1 on NHWC tensors.  Rather than copying the input region of
+// each output point into a padded buffer, they read the input in place, with
+// vector loads along the depth dimension, and skip the filter taps that fall
+// into the padding.  Each call computes one row of its result, so that the
+// callers can parallelize over batch and rows.
+template <typename T>
+bool CanUseDepthwiseDirectKernels(const DepthwiseArgs& args) {
+  typedef typename Eigen::internal::packet_traits<T>::type Packet;
+  static const int64 kPacketSize = (sizeof(Packet) / sizeof(T));
+  return args.depth_multiplier == 1 && args.in_depth >= kPacketSize;
+}
+
+// Computes output row 'out_r' of the depthwise convolution of the image
+// 'input' by 'filter' into the image 'output'.  Output columns whose filter
+// window lies within the input are computed kColBlock at a time, each in its
+// own accumulator register, so that every filter load is used kColBlock times.
+// 3x3 and 5x5 filters get their column loop unrolled.
+template <typename T>
+struct DepthwiseConv2DDirectOp {
+  typedef typename Eigen::internal::packet_traits<T>::type Packet;
+  static const int64 kPacketSize = (sizeof(Packet) / sizeof(T));
+  static const int kColBlock = 4;
+
+  void operator()(const DepthwiseArgs& args, const int64 out_r, const T* input,
+                  const T* filter, T* output) {
+    switch (args.filter_cols) {
+      case 3:
+        return ComputeRow<3>(args, out_r, input, filter, output);
+      case 5:
+        return ComputeRow<5>(args, out_r, input, filter, output);
+      default:
+        return ComputeRow<0>(args, out_r, input, filter, output);
+    }
+  }
+
+ private:
+  // 'kFilterCols' is args.filter_cols, or 0 if it is only known at runtime.
+  template <int kFilterCols>
+  static void ComputeRow(const DepthwiseArgs& args, const int64 out_r,
+                         const T* input, const T* filter, T* output) {
+    const int64 filter_cols = kFilterCols > 0 ? kFilterCols : args.filter_cols;
+    const int64 stride = args.stride;
+    const int64 in_r_start = out_r * stride - args.pad_rows;
+    const int64 f_r_begin = std::max<int64>(0, -in_r_start);
+    const int64 f_r_end =
+        std::min<int64>(args.filter_rows, args.in_rows - in_r_start);
+
+    // The output columns whose filter window lies within the input.
+    const int64 interior_begin =
+        std::min<int64>(args.out_cols, (args.pad_cols + stride - 1) / stride);
+    const int64 last_in_c_start = args.in_cols + args.pad_cols - filter_cols;
+    const int64 interior_end =
+        last_in_c_start < 0
+            ? interior_begin
+            : std::max(interior_begin, std::min<int64>(
+                                           args.out_cols,
+                                           last_in_c_start / stride + 1));
+
+    T* out_row = output + out_r * args.out_cols * args.out_depth;
+    int64 out_c = 0;
+    for (; out_c < interior_begin; ++out_c) {
+      ComputePoint(args, f_r_begin, f_r_end, in_r_start, out_c, input, filter,
+                   out_row);
+    }
+    for (; out_c + kColBlock <= interior_end; out_c += kColBlock) {
+      ComputeInteriorBlock<kFilterCols>(args, f_r_begin, f_r_end, in_r_start,
+                                        out_c, input, filter, out_row);
+    }
+    for (; out_c < args.out_cols; ++out_c) {
+      ComputePoint(args, f_r_begin, f_r_end, in_r_start, out_c, input, filter,
+                   out_row);
+    }
+  }
+
+  // Computes kColBlock output points starting at 'out_c', whose filter
+  // windows lie within the input columns.
+  template <int kFilterCols>
+  static void ComputeInteriorBlock(const DepthwiseArgs& args,
+                                   const int64 f_r_begin, const int64 f_r_end,
+                                   const int64 in_r_start, const int64 out_c,
+                                   const T* input, const T* filter,
+                                   T* out_row) {
+    const int64 filter_cols = kFilterCols > 0 ? kFilterCols : args.filter_cols;
+    const int64 depth = args.in_depth;
+    const int64 vectorized_size = (depth / kPacketSize) * kPacketSize;
+    const int64 col_step = args.stride * depth;
+    const int64 in_c_start = out_c * args.stride - args.pad_cols;
+
+    for (int64 d = 0; d < vectorized_size; d += kPacketSize) {
+      Packet accum[kColBlock];
+      for (int k = 0; k < kColBlock; ++k) {
+        accum[k] = Eigen::internal::pset1<Packet>(static_cast<T>(0));
+      }
+      for (int64 f_r = f_r_begin; f_r < f_r_end; ++f_r) {
+        const T* in = input +
+                      ((in_r_start + f_r) * args.in_cols + in_c_start) * depth +
+                      d;
+        const T* f = filter + f_r * filter_cols * depth + d;
+        for (int64 f_c = 0; f_c < filter_cols; ++f_c) {
+          const Packet filter_block =
+              Eigen::internal::ploadu<Packet>(f + f_c * depth);
+          for (int k = 0; k < kColBlock; ++k) {
+            accum[k] = Eigen::internal::pmadd<Packet>(
+                Eigen::internal::ploadu<Packet>(in + f_c * depth +
+                                                k * col_step),
+                filter_block, accum[k]);
+          }
+        }
+      }
+      for (int k = 0; k < kColBlock; ++k) {
+        Eigen::internal::pstoreu<T>(out_row + (out_c + k) * depth + d,
+                                    accum[k]);
+      }
+    }
+
+    for (int64 d = vectorized_size; d < depth; ++d) {
+      for (int k = 0; k < kColBlock; ++k) {
+        T sum = static_cast<T>(0);
+        for (int64 f_r = f_r_begin; f_r < f_r_end; ++f_r) {
+          const T* in = input +
+                        ((in_r_start + f_r) * args.in_cols + in_c_start) *
+                            depth +
+                        k * col_step + d;
+          const T* f = filter + f_r * filter_cols * depth + d;
+          for (int64 f_c = 0; f_c < filter_cols; ++f_c) {
+            sum += in[f_c * depth] * f[f_c * depth];
+          }
+        }
+        out_row[(out_c + k) * depth + d] = sum;
+      }
+    }
+  }
+
+  // Computes the output point in column 'out_c', skipping the filter taps
+  // that fall into the padding.
+  static void ComputePoint(const DepthwiseArgs& args, const int64 f_r_begin,
+                           const int64 f_r_end, const int64 in_r_start,
+                           const int64 out_c, const T* input, const T* filter,
+                           T* out_row) {
+    const int64 depth = args.in_depth;
+    const int64 vectorized_size = (depth / kPacketSize) * kPacketSize;
+    const int64 in_c_start = out_c * args.stride - args.pad_cols;
+    const int64 f_c_begin = std::max<int64>(0, -in_c_start);
+    const int64 f_c_end =
+        std::min<int64>(args.filter_cols, args.in_cols - in_c_start);
+    T* out = out_row + out_c * depth;
+
+    for (int64 d = 0; d < vectorized_size; d += kPacketSize) {
+      Packet accum = Eigen::internal::pset1<Packet>(static_cast<T>(0));
+      for (int64 f_r = f_r_begin; f_r < f_r_end; ++f_r) {
+        const T* in = input +
+                      ((in_r_start + f_r) * args.in_cols + in_c_start) * depth +
+                      d;
+        const T* f = filter + f_r * args.filter_cols * depth + d;
+        for (int64 f_c = f_c_begin; f_c < f_c_end; ++f_c) {
+          accum = Eigen::internal::pmadd<Packet>(
+              Eigen::internal::ploadu<Packet>(in + f_c * depth),
+              Eigen::internal::ploadu<Packet>(f + f_c * depth), accum);
+        }
+      }
+      Eigen::internal::pstoreu<T>(out + d, accum);
+    }
+
+    for (int64 d = vectorized_size; d < depth; ++d) {
+      T sum = static_cast<T>(0);
+      for (int64 f_r = f_r_begin; f_r < f_r_end; ++f_r) {
+        const T* in = input +
+                      ((in_r_start + f_r) * args.in_cols + in_c_start) * depth +
+                      d;
+        const T* f = filter + f_r * args.filter_cols * depth + d;
+        for (int64 f_c = f_c_begin; f_c < f_c_end; ++f_c) {
+          sum += in[f_c * depth] * f[f_c * depth];
+        }
+      }
+      out[d] = sum;
+    }
+  }
+};
+
+// Computes input row 'in_r' of the depthwise convolution backprop input of
+// the image 'out_backprop' by 'filter' into the image 'in_backprop'.  Each
+// input point gathers the output points it contributed to during the forward
+// pass.
+template <typename T>
+struct DepthwiseConv2DBackpropInputDirectOp {
+  typedef typename Eigen::internal::packet_traits<T>::type Packet;
+  static const int64 kPacketSize = (sizeof(Packet) / sizeof(T));
+
+  void operator()(const DepthwiseArgs& args, const int64 in_r,
+                  const T* out_backprop, const T* filter, T* in_backprop) {
+    const int64 depth = args.in_depth;
+    const int64 vectorized_size = (depth / kPacketSize) * kPacketSize;
+
+    // The offsets in 'out_backprop' and 'filter' of the pairs of output points
+    // and filter taps that each input point of the row gathers.
+    std::vector<std::pair<int64, int64>> taps;
+    taps.reserve(args.filter_rows * args.filter_cols);
+
+    for (int64 in_c = 0; in_c < args.in_cols; ++in_c) {
+      taps.clear();
+      for (int64 f_r = 0; f_r < args.filter_rows; ++f_r) {
+        const int64 out_r_stride = in_r + args.pad_rows - f_r;
+        if (out_r_stride < 0 || out_r_stride % args.stride != 0) continue;
+        const int64 out_r = out_r_stride / args.stride;
+        if (out_r >= args.out_rows) continue;
+        for (int64 f_c = 0; f_c < args.filter_cols; ++f_c) {
+          const int64 out_c_stride = in_c + args.pad_cols - f_c;
+          if (out_c_stride < 0 || out_c_stride % args.stride != 0) continue;
+          const int64 out_c = out_c_stride / args.stride;
+          if (out_c >= args.out_cols) continue;
+          taps.emplace_back((out_r * args.out_cols + out_c) * depth,
+                            (f_r * args.filter_cols + f_c) * depth);
+        }
+      }
+
+      T* in = in_backprop + (in_r * args.in_cols + in_c) * depth;
+      for (int64 d = 0; d < vectorized_size; d += kPacketSize) {
+        Packet accum = Eigen::internal::pset1<Packet>(static_cast<T>(0));
+        for (const auto& tap : taps) {
+          accum = Eigen::internal::pmadd<Packet>(
+              Eigen::internal::ploadu<Packet>(out_backprop + tap.first + d),
+              Eigen::internal::ploadu<Packet>(filter + tap.second + d), accum);
+        }
+        Eigen::internal::pstoreu<T>(in + d, accum);
+      }
+      for (int64 d = vectorized_size; d < depth; ++d) {
+        T sum = static_cast<T>(0);
+        for (const auto& tap : taps) {
+          sum += out_backprop[tap.first + d] * filter[tap.second + d];
+        }
+        in[d] = sum;
+      }
+    }
+  }
+};
+
+// Adds the depthwise convolution backprop filter of output row 'out_r' of the
+// image 'out_backprop', given the image 'input', to 'filter_backprop'.  For
+// each filter tap, the products along the row are summed in kColBlock
+// accumulator registers before 'filter_backprop' is updated once.
+template <typename T>
+struct DepthwiseConv2DBackpropFilterDirectOp {
+  typedef typename Eigen::internal::packet_traits<T>::type Packet;
+  static const int64 kPacketSize = (sizeof(Packet) / sizeof(T));
+  static const int kColBlock = 4;
+
+  void operator()(const DepthwiseArgs& args, const int64 out_r,
+                  const T* out_backprop, const T* input, T* filter_backprop) {
+    const int64 depth = args.in_depth;
+    const int64 vectorized_size = (depth / kPacketSize) * kPacketSize;
+    const int64 stride = args.stride;
+    const int64 in_r_start = out_r * stride - args.pad_rows;
+    const int64 f_r_begin = std::max<int64>(0, -in_r_start);
+    const int64 f_r_end =
+        std::min<int64>(args.filter_rows, args.in_rows - in_r_start);
+    const T* out_row = out_backprop + out_r * args.out_cols * depth;
+
+    for (int64 f_r = f_r_begin; f_r < f_r_end; ++f_r) {
+      const T* in_row = input + (in_r_start + f_r) * args.in_cols * depth;
+      for (int64 f_c = 0; f_c < args.filter_cols; ++f_c) {
+        // The output columns whose input column for this tap is within the
+        // input: in_c = out_c * stride + in_c_offset.
+        const int64 in_c_offset = f_c - args.pad_cols;
+        const int64 out_c_begin =
+            in_c_offset >= 0 ? 0 : (-in_c_offset + stride - 1) / stride;
+        const int64 out_c_end =
+            args.in_cols - 1 - in_c_offset < 0
+                ? 0
+                : std::min<int64>(args.out_cols,
+                                  (args.in_cols - 1 - in_c_offset) / stride +
+                                      1);
+        const T* in = in_row + in_c_offset * depth;
+        T* f = filter_backprop + (f_r * args.filter_cols + f_c) * depth;
+
+        for (int64 d = 0; d < vectorized_size; d += kPacketSize) {
+          Packet accum[kColBlock];
+          for (int k = 0; k < kColBlock; ++k) {
+            accum[k] = Eigen::internal::pset1<Packet>(static_cast<T>(0));
+          }
+          int64 out_c = out_c_begin;
+          for (; out_c + kColBlock <= out_c_end; out_c += kColBlock) {
+            for (int k = 0; k < kColBlock; ++k) {
+              accum[k] = Eigen::internal::pmadd<Packet>(
+                  Eigen::internal::ploadu<Packet>(out_row +
+                                                  (out_c + k) * depth + d),
+                  Eigen::internal::ploadu<Packet>(
+                      in + (out_c + k) * stride * depth + d),
+                  accum[k]);
+            }
+          }
+          for (; out_c < out_c_end; ++out_c) {
+            accum[0] = Eigen::internal::pmadd<Packet>(
+                Eigen::internal::ploadu<Packet>(out_row + out_c * depth + d),
+                Eigen::internal::ploadu<Packet>(in + out_c * stride * depth +
+                                                d),
+                accum[0]);
+          }
+          Packet sum = Eigen::internal::ploadu<Packet>(f + d);
+          for (int k = 0; k < kColBlock; ++k) {
+            sum = Eigen::internal::padd<Packet>(sum, accum[k]);
+          }
+          Eigen::internal::pstoreu<T>(f + d, sum);
+        }
+
+        for (int64 d = vectorized_size; d < depth; ++d) {
+          T sum = static_cast<T>(0);
+          for (int64 out_c = out_c_begin; out_c < out_c_end; ++out_c) {
+            sum += out_row[out_c * depth + d] *
+                   in[out_c * stride * depth + d];
+          }
+          f[d] += sum;
+        }
+      }
+    }
+  }
+};
+
 }  // namespace functor
 }  // namespace tensorflow
 
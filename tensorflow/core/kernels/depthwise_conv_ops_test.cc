@@ -102,6 +102,59 @@ TEST_F(DepthwiseConvOpTest, DepthwiseConvHalfCpu) {
   Run<Eigen::half>(Device::CPU);
 }
 
+// Covers the kernels which read the input in place, for a depth multiplier of
+// 1 and a depth that isn't a multiple of the vector width.
+TEST_F(DepthwiseConvOpTest, DepthwiseConvFloatCpuStrided) {
+  TF_EXPECT_OK(NodeDefBuilder("depthwise_conv2d", "DepthwiseConv2dNative")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("strides", {1, 2, 2, 1})
+                   .Attr("padding", "SAME")
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  const int batch = 2, rows = 7, cols = 9, depth = 18, filter_size = 3;
+  Tensor image(DT_FLOAT, {batch, rows, cols, depth});
+  auto image_t = image.tensor<float, 4>();
+  for (int i = 0; i < image.NumElements(); ++i) {
+    image.flat<float>()(i) = (i % 13) - 6;
+  }
+  Tensor filter(DT_FLOAT, {filter_size, filter_size, depth, 1});
+  auto filter_t = filter.tensor<float, 4>();
+  for (int i = 0; i < filter.NumElements(); ++i) {
+    filter.flat<float>()(i) = (i % 7) * 0.5f - 1;
+  }
+  AddInputFromArray<float>(image.shape(), image.flat<float>());
+  AddInputFromArray<float>(filter.shape(), filter.flat<float>());
+  TF_ASSERT_OK(RunOpKernel());
+
+  // 'SAME' padding pads a row above and a column to the left of the image.
+  const int out_rows = 4, out_cols = 5;
+  Tensor expected(DT_FLOAT, {batch, out_rows, out_cols, depth});
+  auto expected_t = expected.tensor<float, 4>();
+  for (int b = 0; b < batch; ++b) {
+    for (int out_r = 0; out_r < out_rows; ++out_r) {
+      for (int out_c = 0; out_c < out_cols; ++out_c) {
+        for (int d = 0; d < depth; ++d) {
+          float sum = 0;
+          for (int f_r = 0; f_r < filter_size; ++f_r) {
+            for (int f_c = 0; f_c < filter_size; ++f_c) {
+              const int in_r = out_r * 2 - 1 + f_r;
+              const int in_c = out_c * 2 - 1 + f_c;
+              if (in_r < 0 || in_r >= rows || in_c < 0 || in_c >= cols) {
+                continue;
+              }
+              sum += image_t(b, in_r, in_c, d) * filter_t(f_r, f_c, d, 0);
+            }
+          }
+          expected_t(b, out_r, out_c, d) = sum;
+        }
+      }
+    }
+  }
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
 #ifdef GOOGLE_CUDA
 TEST_F(DepthwiseConvOpTest, DepthwiseConvFloatGpu) { Run<float>(Device::GPU); }
 TEST_F(DepthwiseConvOpTest, DepthwiseConvDoubleGpu) {
@@ -15,17 +15,28 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <functional>
 #include <vector>
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Rows and bytes of data partitioned by each shard, at least.
+constexpr int64 kMinRowsPerShard = 4096;
+constexpr int64 kMinBytesPerShard = 256 << 10;
+
+}  // namespace
+
 // Shared code that is not dependent on the type of T.  We do this to reduce
 // code size by not duplicating all this for all T (float, double, int32, etc.)
 class DynamicPartitionOp_Shared : public OpKernel {
@@ -39,9 +50,13 @@ class DynamicPartitionOp_Shared : public OpKernel {
     //   in the graph?
   }
 
-  void ValidateAndAllocateOutputs(OpKernelContext* c, const Tensor** data,
-                                  const Tensor** partitions,
-                                  OpOutputList* Tout) {
+  // Validates the inputs and allocates the outputs.  The rows of data are
+  // split in shards of `shard_size` rows, and `shard_offsets[s][p]` is set to
+  // the row of output `p` where the rows of shard `s` in partition `p` start.
+  void ValidateAndAllocateOutputs(
+      OpKernelContext* c, const Tensor** data, const Tensor** partitions,
+      OpOutputList* Tout, int64* shard_size,
+      std::vector<gtl::InlinedVector<int64, 32>>* shard_offsets) {
     OP_REQUIRES_OK(c, c->input("data", data));
     OP_REQUIRES_OK(c, c->input("partitions", partitions));
     OP_REQUIRES(
@@ -52,17 +67,52 @@ class DynamicPartitionOp_Shared : public OpKernel {
             "got data.shape = ", (*data)->shape().DebugString(),
             ", partitions.shape = ", (*partitions)->shape().DebugString()));
 
-    // Count how many occurrences of each partition id we have in partitions
-    gtl::InlinedVector<int, 32> partition_count(num_partitions_);
+    // Count how many occurrences of each partition id we have in each shard
+    // of partitions.
     auto e_partitions = (*partitions)->flat<int32>();
     const int64 N = e_partitions.dimension(0);
-    for (int64 i = 0; i < N; i++) {
-      const int32 p = internal::SubtleMustCopy(e_partitions(i));
-      OP_REQUIRES(c, FastBoundsCheck(p, num_partitions_),
+    const int64 num_threads =
+        c->device()->tensorflow_cpu_worker_threads()->num_threads;
+    const int64 num_shards = std::max<int64>(
+        1, std::min({num_threads, N / kMinRowsPerShard,
+                     static_cast<int64>((*data)->TotalBytes()) /
+                         kMinBytesPerShard}));
+    *shard_size = (N + num_shards - 1) / num_shards;
+    shard_offsets->assign(num_shards,
+                          gtl::InlinedVector<int64, 32>(num_partitions_));
+    // The first row of each shard with an invalid partition id, and the id.
+    std::vector<int64> first_invalid(num_shards, N);
+    std::vector<int32> invalid_partition(num_shards);
+    RunShards(c, num_shards, [&](int64 shard) {
+      auto& counts = (*shard_offsets)[shard];
+      const int64 limit = std::min(N, (shard + 1) * *shard_size);
+      for (int64 i = shard * *shard_size; i < limit; i++) {
+        const int32 p = internal::SubtleMustCopy(e_partitions(i));
+        if (!FastBoundsCheck(p, num_partitions_)) {
+          first_invalid[shard] = i;
+          invalid_partition[shard] = p;
+          return;
+        }
+        counts[p]++;
+      }
+    });
+    for (int64 shard = 0; shard < num_shards; shard++) {
+      const int64 i = first_invalid[shard];
+      OP_REQUIRES(c, i == N,
                   errors::InvalidArgument(
                       "partitions", SliceDebugString((*partitions)->shape(), i),
-                      " = ", p, " is not in [0, ", num_partitions_, ")"));
-      partition_count[p]++;
+                      " = ", invalid_partition[shard], " is not in [0, ",
+                      num_partitions_, ")"));
+    }
+
+    // Each shard starts after the rows of the previous shards.
+    gtl::InlinedVector<int64, 32> partition_count(num_partitions_);
+    for (int p = 0; p < num_partitions_; p++) {
+      for (auto& offsets : *shard_offsets) {
+        const int64 count = offsets[p];
+        offsets[p] = partition_count[p];
+        partition_count[p] += count;
+      }
     }
 
     // Allocate output tensors of the right size
@@ -78,6 +128,23 @@ class DynamicPartitionOp_Shared : public OpKernel {
     }
   }
 
+  // Calls `fn` on each shard, in parallel if there are several.
+  static void RunShards(OpKernelContext* c, int64 num_shards,
+                        const std::function<void(int64)>& fn) {
+    if (num_shards == 1) {
+      fn(0);
+      return;
+    }
+    c->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        num_shards,
+        thread::ThreadPool::SchedulingParams(
+            thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+            absl::nullopt, /*block_size=*/1),
+        [&fn](int64 start, int64 limit) {
+          for (int64 shard = start; shard < limit; shard++) fn(shard);
+        });
+  }
+
  protected:
   int num_partitions_;
 };
@@ -91,13 +158,16 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
     const Tensor* data;
     const Tensor* partitions;
     OpOutputList outputs;
-    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs);
+    int64 shard_size;
+    std::vector<gtl::InlinedVector<int64, 32>> shard_offsets;
+    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs, &shard_size,
+                               &shard_offsets);
     if (!c->status().ok()) return;
     if (num_partitions_ == 0 || data->NumElements() == 0) return;
 
     auto e_partitions = partitions->flat<int32>();
     const int64 N = e_partitions.dimension(0);
-    gtl::InlinedVector<int, 32> output_index(num_partitions_);
+    const int64 num_shards = shard_offsets.size();
 
     if (partitions->dims() == data->dims()) {
       // Walk through data and copy the data to the appropriate output tensor
@@ -109,19 +179,23 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
       for (int p = 0; p < num_partitions_; p++) {
         out_vec.push_back(outputs[p]->vec<T>());
       }
-      for (int64 i = 0; i < N; i++) {
-        const int32 p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i, "] is out of range"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_vec[p].size()),
-                    errors::InvalidArgument(
-                        "out_vec[", p, "] size: ", out_vec[p].size(),
-                        " is not LTE output_index[", p, "] : ", oi));
-        out_vec[p](oi) = data_flat(i);
-        output_index[p]++;
-      }
+      RunShards(c, num_shards, [&](int64 shard) {
+        auto& output_index = shard_offsets[shard];
+        const int64 limit = std::min(N, (shard + 1) * shard_size);
+        for (int64 i = shard * shard_size; i < limit; i++) {
+          const int32 p = internal::SubtleMustCopy(e_partitions(i));
+          OP_REQUIRES(
+              c, FastBoundsCheck(p, num_partitions_),
+              errors::InvalidArgument("indices[", i, "] is out of range"));
+          auto oi = output_index[p];
+          OP_REQUIRES(c, FastBoundsCheck(oi, out_vec[p].size()),
+                      errors::InvalidArgument(
+                          "out_vec[", p, "] size: ", out_vec[p].size(),
+                          " is not LTE output_index[", p, "] : ", oi));
+          out_vec[p](oi) = data_flat(i);
+          output_index[p]++;
+        }
+      });
     } else {
       // If data has extra dimensions, use Eigen slices
       std::vector<Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
@@ -136,24 +210,28 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
       const int64 slice_size = data->NumElements() / N;
       const auto data_flat = data->shaped<T, 2>({N, slice_size});
       Eigen::DSizes<Eigen::DenseIndex, 2> sizes(1, slice_size);
-      for (int64 i = 0; i < N; i++) {
-        // outputs[p][output_index[p]++] = data[i]
-        const int32 p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i,
-                                    "] has been asynchronously overwritten and "
-                                    "is no longer in range!"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_flat[p].dimension(0)),
-                    errors::InvalidArgument("Size of output_index: ", oi,
-                                            " is no longer in range."));
-        Eigen::DSizes<Eigen::DenseIndex, 2> out_indices(oi, 0);
-        Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
-        out_flat[p].slice(out_indices, sizes) =
-            data_flat.slice(data_indices, sizes);
-        output_index[p]++;
-      }
+      RunShards(c, num_shards, [&](int64 shard) {
+        auto& output_index = shard_offsets[shard];
+        const int64 limit = std::min(N, (shard + 1) * shard_size);
+        for (int64 i = shard * shard_size; i < limit; i++) {
+          // outputs[p][output_index[p]++] = data[i]
+          const int32 p = internal::SubtleMustCopy(e_partitions(i));
+          OP_REQUIRES(c, FastBoundsCheck(p, num_partitions_),
+                      errors::InvalidArgument(
+                          "indices[", i,
+                          "] has been asynchronously overwritten and "
+                          "is no longer in range!"));
+          auto oi = output_index[p];
+          OP_REQUIRES(c, FastBoundsCheck(oi, out_flat[p].dimension(0)),
+                      errors::InvalidArgument("Size of output_index: ", oi,
+                                              " is no longer in range."));
+          Eigen::DSizes<Eigen::DenseIndex, 2> out_indices(oi, 0);
+          Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
+          out_flat[p].slice(out_indices, sizes) =
+              data_flat.slice(data_indices, sizes);
+          output_index[p]++;
+        }
+      });
     }
   }
 };
@@ -159,6 +159,54 @@ TEST_F(DynamicPartitionOpTest, Error_IndexOutOfRange) {
       << s;
 }
 
+TEST_F(DynamicPartitionOpTest, ManyShards) {
+  MakeOp();
+
+  // Enough rows to partition them in parallel.
+  const int kRows = 1 << 16;
+  std::vector<float> data(kRows * 4);
+  std::vector<int32> partitions(kRows);
+  for (int i = 0; i < kRows; i++) {
+    std::fill_n(&data[i * 4], 4, i);
+    partitions[i] = (i * 7) % 4;
+  }
+  AddInputFromArray<float>(TensorShape({kRows, 4}), data);
+  AddInputFromArray<int32>(TensorShape({kRows}), partitions);
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The rows of each partition keep their order.
+  for (int p = 0; p < 4; p++) {
+    const Tensor& output = *GetOutput(p);
+    ASSERT_EQ(output.shape(), TensorShape({kRows / 4, 4}));
+    auto rows = output.matrix<float>();
+    for (int j = 0; j < kRows / 4; j++) {
+      const int i = j * 4 + (p * 3) % 4;
+      ASSERT_EQ(rows(j, 0), i);
+      ASSERT_EQ(rows(j, 3), i);
+    }
+  }
+}
+
+TEST_F(DynamicPartitionOpTest, ManyShardsError_IndexOutOfRange) {
+  MakeOp();
+
+  // The first invalid partition id is reported.
+  const int kRows = 1 << 16;
+  std::vector<int32> partitions(kRows);
+  for (int i = 0; i < kRows; i++) {
+    partitions[i] = i % 4;
+  }
+  partitions[50000] = 99;
+  partitions[60000] = -1;
+  AddInputFromArray<float>(TensorShape({kRows, 4}),
+                           std::vector<float>(kRows * 4));
+  AddInputFromArray<int32>(TensorShape({kRows}), partitions);
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(),
+                                "partitions[50000] = 99 is not in [0, 4)"))
+      << s;
+}
+
 Node* DynamicPartitionNode(Graph* g, Node* in0, Node* in1, int num_partitions) {
   Node* ret;
   TF_CHECK_OK(NodeBuilder(g->NewName("n"), "DynamicPartition")
@@ -199,6 +247,7 @@ static Graph* DynamicPartition(int num_partitions, int dim) {
   BENCHMARK(BM_##DEVICE##_dynpart_##T##_##num)->Arg(1)->Arg(256)
 
 BM_DYNAMIC_PARTITION(cpu, float, 2);
+BM_DYNAMIC_PARTITION(cpu, float, 16);
 BM_DYNAMIC_PARTITION(cpu, float, 100);
 BM_DYNAMIC_PARTITION(cpu, double, 2);
 BM_DYNAMIC_PARTITION(cpu, double, 100);
@@ -15,6 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -32,6 +35,10 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+// Bytes of data stitched, above which the rows of the result are copied in
+// parallel.
+constexpr int64 kMinParallelStitchBytes = 256 << 10;
+
 template <class T>
 class DynamicStitchOpImplBase : public OpKernel {
  public:
@@ -251,6 +258,17 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
       auto merged_flat = merged->flat_outer_dims<T>();
       const int slice_size = merged_flat.dimension(1);
       const size_t slice_bytes = slice_size * sizeof(T);
+      size_t total_indices_size = 0;
+      for (int input_num = 0; input_num < indices_inputs.size(); ++input_num) {
+        total_indices_size += indices_inputs[input_num].NumElements();
+      }
+      auto thread_pool = c->device()->tensorflow_cpu_worker_threads()->workers;
+      if (thread_pool->NumThreads() > 1 &&
+          total_indices_size * slice_bytes >= kMinParallelStitchBytes) {
+        CopyRowsInParallel(c, indices_inputs, data_inputs, first_dim_size,
+                           slice_size, thread_pool, merged_flat.data());
+        return;
+      }
       auto OnInputNumber = [&](int input_num) {
         const Tensor& indices = indices_inputs[input_num];
         auto indices_vec = indices.flat<int32>();
@@ -285,13 +303,6 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
         }
       };
       if (Parallel) {
-        auto thread_pool =
-            c->device()->tensorflow_cpu_worker_threads()->workers;
-        size_t total_indices_size = 0;
-        for (int input_num = 0; input_num < indices_inputs.size();
-             ++input_num) {
-          total_indices_size += indices_inputs[input_num].NumElements();
-        }
         const double avg_indices_size =
             static_cast<double>(total_indices_size) / indices_inputs.size();
         auto bytes_processed = slice_bytes * avg_indices_size;
@@ -310,6 +321,37 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
       }
     }
   }
+
+ private:
+  // Copies each row of `merged` from the last data slice stitched to it, with
+  // the rows split among the threads of `thread_pool`.
+  static void CopyRowsInParallel(OpKernelContext* c,
+                                 const OpInputList& indices_inputs,
+                                 const OpInputList& data_inputs,
+                                 int first_dim_size, int slice_size,
+                                 thread::ThreadPool* thread_pool, T* merged) {
+    std::vector<const T*> sources(first_dim_size, nullptr);
+    for (int input_num = 0; input_num < indices_inputs.size(); ++input_num) {
+      auto indices_vec = indices_inputs[input_num].flat<int32>();
+      const T* data_base = data_inputs[input_num].flat<T>().data();
+      for (int i = 0; i < indices_vec.size(); i++) {
+        int32 index = internal::SubtleMustCopy(indices_vec(i));
+        OP_REQUIRES(
+            c, FastBoundsCheck(index, first_dim_size),
+            errors::InvalidArgument("indices[", i, "] is out of range"));
+        sources[index] = data_base + i * slice_size;
+      }
+    }
+    thread_pool->ParallelFor(
+        first_dim_size, slice_size * sizeof(T), [&](int64 start, int64 limit) {
+          for (int64 index = start; index < limit; ++index) {
+            if (sources[index] != nullptr) {
+              std::copy_n(sources[index], slice_size,
+                          merged + index * slice_size);
+            }
+          }
+        });
+  }
 };
 
 // Using inheritance rather than a typedef so that these classes might have more
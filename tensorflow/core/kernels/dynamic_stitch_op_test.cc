@@ -15,7 +15,9 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -23,13 +25,17 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -80,6 +86,40 @@ TEST_F(DynamicStitchOpTest, Simple_TwoD) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(DynamicStitchOpTest, Large_DuplicateIndices) {
+  MakeOp(2, DT_FLOAT);
+
+  // Enough rows to copy them in parallel.  The second input overwrites the
+  // even rows.
+  const int kRows = 1 << 16;
+  std::vector<int32> indices0(kRows);
+  std::vector<int32> indices1(kRows / 2);
+  std::vector<float> data0(kRows * 4);
+  std::vector<float> data1(kRows / 2 * 4);
+  for (int i = 0; i < kRows; i++) {
+    indices0[i] = i;
+    std::fill_n(&data0[i * 4], 4, i);
+  }
+  for (int i = 0; i < kRows / 2; i++) {
+    indices1[i] = i * 2;
+    std::fill_n(&data1[i * 4], 4, -i * 2);
+  }
+  AddInputFromArray<int32>(TensorShape({kRows}), indices0);
+  AddInputFromArray<int32>(TensorShape({kRows / 2}), indices1);
+  AddInputFromArray<float>(TensorShape({kRows, 4}), data0);
+  AddInputFromArray<float>(TensorShape({kRows / 2, 4}), data1);
+  TF_ASSERT_OK(RunOpKernel());
+
+  const Tensor& output = *GetOutput(0);
+  ASSERT_EQ(output.shape(), TensorShape({kRows, 4}));
+  auto rows = output.matrix<float>();
+  for (int i = 0; i < kRows; i++) {
+    const float expected = i % 2 == 0 ? -i : i;
+    ASSERT_EQ(rows(i, 0), expected);
+    ASSERT_EQ(rows(i, 3), expected);
+  }
+}
+
 TEST_F(DynamicStitchOpTest, Error_IndicesMultiDimensional) {
   MakeOp(2, DT_FLOAT);
 
@@ -142,5 +182,49 @@ TEST_F(DynamicStitchOpTest, Error_DataAndIndicesSizeMismatch) {
       << s;
 }
 
+// Stitches 128MB of rows of `dim` floats from `num_inputs` inputs, as
+// partitioned by DynamicPartition.
+static Graph* DynamicStitch(int num_inputs, int dim) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const int kRows = ((128 << 20) / sizeof(float)) / dim;
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<std::vector<int32>> indices(num_inputs);
+  for (int i = 0; i < kRows; i++) {
+    indices[rnd.Uniform(num_inputs)].push_back(i);
+  }
+  std::vector<NodeBuilder::NodeOut> indices_nodes;
+  std::vector<NodeBuilder::NodeOut> data_nodes;
+  for (int n = 0; n < num_inputs; n++) {
+    const int64 rows = indices[n].size();
+    Tensor indices_tensor(DT_INT32, TensorShape({rows}));
+    std::copy(indices[n].begin(), indices[n].end(),
+              indices_tensor.flat<int32>().data());
+    Tensor data(DT_FLOAT, TensorShape({rows, dim}));
+    data.flat<float>().setRandom();
+    indices_nodes.push_back(test::graph::Constant(g, indices_tensor));
+    data_nodes.push_back(test::graph::Constant(g, data));
+  }
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "DynamicStitch")
+                  .Input(indices_nodes)
+                  .Input(data_nodes)
+                  .Finalize(g, &ret));
+  return g;
+}
+
+#define BM_DYNAMIC_STITCH(num)                                             \
+  static void BM_cpu_dynstitch_float_##num(int iters, int dim) {           \
+    const int64 items = ((128 << 20) / sizeof(float));                     \
+    testing::ItemsProcessed(static_cast<int64>(iters) * items);            \
+    testing::UseRealTime();                                                \
+    test::Benchmark("cpu", DynamicStitch(num, dim)).Run(iters);            \
+  }                                                                        \
+  BENCHMARK(BM_cpu_dynstitch_float_##num)->Arg(1)->Arg(256)
+
+BM_DYNAMIC_STITCH(2);
+BM_DYNAMIC_STITCH(16);
+BM_DYNAMIC_STITCH(100);
+
 }  // namespace
 }  // namespace tensorflow
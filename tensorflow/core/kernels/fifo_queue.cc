@@ -51,12 +51,25 @@ void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
-  bool already_cancelled;
+  bool enqueued = false;
+  bool has_dequeue_attempts = false;
+  bool already_cancelled = false;
   {
     mutex_lock l(mu_);
-    already_cancelled = !cm->RegisterCallback(
-        token, [this, cm, token]() { Cancel(kEnqueue, cm, token); });
-    if (!already_cancelled) {
+    // Fast path: without pending enqueues and with room in the queue, the
+    // element is enqueued right away, without registering an attempt.
+    if (enqueue_attempts_.empty() && !closed_ && !cm->IsCancelled() &&
+        queues_[0].size() < static_cast<size_t>(capacity_)) {
+      for (int i = 0; i < num_components(); ++i) {
+        queues_[i].push_back(PersistentTensor(tuple[i]));
+      }
+      enqueued = true;
+      has_dequeue_attempts = !dequeue_attempts_.empty();
+    } else {
+      already_cancelled = !cm->RegisterCallback(
+          token, [this, cm, token]() { Cancel(kEnqueue, cm, token); });
+    }
+    if (!enqueued && !already_cancelled) {
       enqueue_attempts_.emplace_back(
           1, callback, ctx, cm, token,
           [tuple, this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -76,7 +89,11 @@ void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
           });
     }
   }
-  if (!already_cancelled) {
+  if (enqueued) {
+    // Only pending dequeues can make progress with the new element.
+    if (has_dequeue_attempts) FlushUnlocked();
+    callback();
+  } else if (!already_cancelled) {
     FlushUnlocked();
   } else {
     ctx->SetStatus(errors::Cancelled("Enqueue operation was cancelled"));
@@ -155,12 +172,24 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
-  bool already_cancelled;
+  Tuple tuple;
+  bool dequeued = false;
+  bool has_enqueue_attempts = false;
+  bool already_cancelled = false;
   {
     mutex_lock l(mu_);
-    already_cancelled = !cm->RegisterCallback(
-        token, [this, cm, token]() { Cancel(kDequeue, cm, token); });
-    if (!already_cancelled) {
+    // Fast path: without pending dequeues and with elements in the queue, an
+    // element is dequeued right away, without registering an attempt.
+    if (dequeue_attempts_.empty() && !cm->IsCancelled() &&
+        !queues_[0].empty()) {
+      DequeueLocked(ctx, &tuple);
+      dequeued = true;
+      has_enqueue_attempts = !enqueue_attempts_.empty();
+    } else {
+      already_cancelled = !cm->RegisterCallback(
+          token, [this, cm, token]() { Cancel(kDequeue, cm, token); });
+    }
+    if (!dequeued && !already_cancelled) {
       // TODO(josh11b): This makes two copies of callback, avoid this if possible.
       dequeue_attempts_.emplace_back(
           1, [callback]() { callback(Tuple()); }, ctx, cm, token,
@@ -184,7 +213,11 @@ void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
           });
     }
   }
-  if (!already_cancelled) {
+  if (dequeued) {
+    // Only pending enqueues can make progress with the freed capacity.
+    if (has_enqueue_attempts) FlushUnlocked();
+    callback(tuple);
+  } else if (!already_cancelled) {
     FlushUnlocked();
   } else {
     ctx->SetStatus(errors::Cancelled("Dequeue operation was cancelled"));
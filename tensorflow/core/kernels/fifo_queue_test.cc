@@ -0,0 +1,90 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Enqueues and dequeues a float vector through a FIFOQueue from
+// `num_producers` concurrent pairs of ops.  With `prefill`, the queue holds
+// an element before each dequeue, so that both ops take their fast path.
+Graph* EnqueueDequeue(int num_producers, bool prefill, Graph** init) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor element(DT_FLOAT, TensorShape({16}));
+  element.flat<float>().setRandom();
+  auto queue = [&](Graph* graph) {
+    Node* queue;
+    TF_CHECK_OK(NodeBuilder(graph->NewName("queue"), "FIFOQueueV2")
+                    .Attr("component_types", {DT_FLOAT})
+                    .Attr("shapes", {TensorShape({16})})
+                    .Attr("shared_name", "fifo_queue_benchmark")
+                    .Finalize(graph, &queue));
+    return queue;
+  };
+  auto enqueue = [&](Graph* graph, Node* queue) {
+    Node* enqueue;
+    TF_CHECK_OK(NodeBuilder(graph->NewName("enqueue"), "QueueEnqueueV2")
+                    .Input(queue)
+                    .Input({NodeBuilder::NodeOut(
+                        test::graph::Constant(graph, element))})
+                    .Finalize(graph, &enqueue));
+    return enqueue;
+  };
+
+  *init = nullptr;
+  if (prefill) {
+    *init = new Graph(OpRegistry::Global());
+    Node* init_queue = queue(*init);
+    for (int i = 0; i < num_producers; ++i) enqueue(*init, init_queue);
+  }
+  Node* q = queue(g);
+  for (int i = 0; i < num_producers; ++i) {
+    Node* enq = enqueue(g, q);
+    Node* deq;
+    NodeBuilder builder(g->NewName("dequeue"), "QueueDequeueV2");
+    builder.Input(q).Attr("component_types", {DT_FLOAT});
+    // Without prefill, each dequeue waits for an enqueue of the same step.
+    if (!prefill) builder.ControlInput(enq);
+    TF_CHECK_OK(builder.Finalize(g, &deq));
+  }
+  return g;
+}
+
+// Measures elements/sec through a FIFOQueue.
+static void BM_FIFOQueueEnqueueDequeue(int iters, int num_producers,
+                                       int prefill) {
+  testing::StopTiming();
+  Graph* init;
+  Graph* g = EnqueueDequeue(num_producers, prefill, &init);
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_producers);
+  testing::UseRealTime();
+  test::Benchmark("cpu", g, /*options=*/nullptr, init).Run(iters);
+}
+BENCHMARK(BM_FIFOQueueEnqueueDequeue)
+    ->ArgPair(1, 0)
+    ->ArgPair(8, 0)
+    ->ArgPair(64, 0)
+    ->ArgPair(1, 1)
+    ->ArgPair(8, 1)
+    ->ArgPair(64, 1);
+
+}  // namespace
+}  // namespace tensorflow
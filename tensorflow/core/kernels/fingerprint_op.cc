@@ -12,9 +12,11 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <cstddef>
 #include <string>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -56,10 +58,15 @@ void FarmhashFingerprint64(TTypes<tstring>::ConstFlat input,
                            TTypes<uint8, 2>::Matrix output) {
   DCHECK_EQ(output.dimension(0), input.dimension(0));
   DCHECK_EQ(output.dimension(1), sizeof(uint64));
-  for (int64 i = 0; i < input.dimension(0); ++i) {
-    const uint64 fingerprint =
-        Fingerprint64({input(i).data(), input(i).size()});
-    CopyToBuffer(fingerprint, &output(i, 0));
+  constexpr int64 kBatchSize = 256;
+  uint64 fingerprints[kBatchSize];
+  for (int64 start = 0; start < input.dimension(0); start += kBatchSize) {
+    const int64 size = std::min(kBatchSize, input.dimension(0) - start);
+    Fingerprint64Batch(absl::MakeConstSpan(input.data() + start, size),
+                       absl::MakeSpan(fingerprints, size));
+    for (int64 i = 0; i < size; ++i) {
+      CopyToBuffer(fingerprints[i], &output(start + i, 0));
+    }
   }
 }
 
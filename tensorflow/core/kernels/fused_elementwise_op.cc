@@ -0,0 +1,321 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+template <typename T>
+struct FusedElementwiseSupport {
+  // Computes out[0, n) from a[0, n) and, for binary ops, b[0, n).
+  using ComputeFn = void (*)(const T* a, const T* b, int64 n, T* out);
+
+  struct ComputeFnRegistration {
+    ComputeFn compute_fn;
+    int arity;
+    int cost;
+  };
+
+  FusedElementwiseSupport() {
+    RegisterUnary<functor::abs<T>>("Abs");
+    RegisterUnary<functor::exp<T>>("Exp");
+    RegisterUnary<functor::inverse<T>>("Inv");
+    RegisterUnary<functor::log<T>>("Log");
+    RegisterUnary<functor::neg<T>>("Neg");
+    RegisterUnary<functor::inverse<T>>("Reciprocal");
+    RegisterUnary<functor::rsqrt<T>>("Rsqrt");
+    RegisterUnary<functor::sigmoid<T>>("Sigmoid");
+    RegisterUnary<functor::sqrt<T>>("Sqrt");
+    RegisterUnary<functor::square<T>>("Square");
+    RegisterUnary<functor::tanh<T>>("Tanh");
+    compute_fns["Relu"] = {
+        ComputeRelu, 1,
+        Eigen::internal::functor_traits<
+            Eigen::internal::scalar_max_op<T>>::Cost};
+
+    RegisterBinary<functor::add<T>>("Add");
+    RegisterBinary<functor::add<T>>("AddV2");
+    RegisterBinary<functor::div<T>>("Div");
+    RegisterBinary<functor::maximum<T>>("Maximum");
+    RegisterBinary<functor::minimum<T>>("Minimum");
+    RegisterBinary<functor::mul<T>>("Mul");
+    RegisterBinary<functor::div<T>>("RealDiv");
+    RegisterBinary<functor::squared_difference<T>>("SquaredDifference");
+    RegisterBinary<functor::sub<T>>("Sub");
+  }
+
+  const ComputeFnRegistration* Find(const string& name) const {
+    auto it = compute_fns.find(name);
+    return it == compute_fns.end() ? nullptr : &it->second;
+  }
+
+ private:
+  template <typename Functor>
+  static void ComputeUnary(const T* a, const T* b, int64 n, T* out) {
+    typename TTypes<T>::UnalignedFlat(out, n) =
+        typename TTypes<T>::UnalignedConstFlat(a, n).unaryExpr(
+            typename Functor::func());
+  }
+
+  template <typename Functor>
+  static void ComputeBinary(const T* a, const T* b, int64 n, T* out) {
+    typename TTypes<T>::UnalignedFlat(out, n) =
+        typename TTypes<T>::UnalignedConstFlat(a, n).binaryExpr(
+            typename TTypes<T>::UnalignedConstFlat(b, n),
+            typename Functor::func());
+  }
+
+  static void ComputeRelu(const T* a, const T* b, int64 n, T* out) {
+    typename TTypes<T>::UnalignedFlat(out, n) =
+        typename TTypes<T>::UnalignedConstFlat(a, n).cwiseMax(
+            static_cast<T>(0));
+  }
+
+  template <typename Functor>
+  void RegisterUnary(const string& name) {
+    compute_fns[name] = {
+        ComputeUnary<Functor>, 1,
+        Eigen::internal::functor_traits<typename Functor::func>::Cost};
+  }
+
+  template <typename Functor>
+  void RegisterBinary(const string& name) {
+    compute_fns[name] = {
+        ComputeBinary<Functor>, 2,
+        Eigen::internal::functor_traits<typename Functor::func>::Cost};
+  }
+
+  std::unordered_map<string, ComputeFnRegistration> compute_fns;
+};
+
+// Evaluates a program of unary and binary elementwise ops over tiles of the
+// output, so that every input is read and the output written exactly once,
+// and the intermediate results of a tile stay in cache.
+//
+// Inputs must either have the shape of the output, or broadcast against it
+// by repeating: after dropping leading dimensions of size 1, their shape is a
+// suffix of the output shape. This covers scalars and bias-like vectors.
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  using Support = FusedElementwiseSupport<T>;
+  using ComputeFn = typename Support::ComputeFn;
+
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> op_names;
+    std::vector<int32> operands;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args_));
+    OP_REQUIRES_OK(context, context->GetAttr("op_names", &op_names));
+    OP_REQUIRES_OK(context, context->GetAttr("operands", &operands));
+    OP_REQUIRES(context, !op_names.empty(),
+                errors::InvalidArgument(
+                    "Fused elementwise program must have at least one op"));
+    OP_REQUIRES(context, operands.size() == 2 * op_names.size(),
+                errors::InvalidArgument(
+                    "Expected two operands per op, got ", operands.size(),
+                    " operands for ", op_names.size(), " ops"));
+
+    static const Support* support = new Support;
+    for (int i = 0; i < static_cast<int>(op_names.size()); ++i) {
+      const auto* reg = support->Find(op_names[i]);
+      OP_REQUIRES(context, reg != nullptr,
+                  errors::InvalidArgument(
+                      "Do not have a compute function registered for op: ",
+                      op_names[i]));
+      Instruction instr;
+      instr.fn = reg->compute_fn;
+      for (int k = 0; k < 2; ++k) {
+        const int operand = operands[2 * i + k];
+        if (k >= reg->arity) {
+          instr.operands[k] = instr.operands[0];
+          continue;
+        }
+        // Operands may only refer to inputs and earlier instructions.
+        OP_REQUIRES(context, operand >= 0 && operand < num_args_ + i,
+                    errors::InvalidArgument("Operand ", k, " of op ", i, " (",
+                                            op_names[i], ") is out of range: ",
+                                            operand));
+        instr.operands[k] = operand;
+      }
+      program_.push_back(instr);
+      cost_ += reg->cost;
+    }
+
+    VLOG(2) << "Fused elementwise program: [" << absl::StrJoin(op_names, ", ")
+            << "]; cost=" << cost_;
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    // The output has the shape of the largest input.
+    int largest = 0;
+    for (int i = 1; i < num_args_; ++i) {
+      const TensorShape& shape = ctx->input(i).shape();
+      const TensorShape& largest_shape = ctx->input(largest).shape();
+      if (shape.num_elements() > largest_shape.num_elements() ||
+          (shape.num_elements() == largest_shape.num_elements() &&
+           shape.dims() > largest_shape.dims())) {
+        largest = i;
+      }
+    }
+    const TensorShape& out_shape = ctx->input(largest).shape();
+
+    gtl::InlinedVector<int, 4> forwardable;
+    for (int i = 0; i < num_args_; ++i) {
+      const TensorShape& shape = ctx->input(i).shape();
+      OP_REQUIRES(ctx, IsSuffixBroadcast(shape, out_shape),
+                  errors::InvalidArgument(
+                      "Input ", i, " with shape ", shape.DebugString(),
+                      " does not broadcast to ", out_shape.DebugString(),
+                      " by repetition"));
+      if (shape == out_shape) forwardable.push_back(i);
+    }
+
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            forwardable, 0, out_shape, &out));
+    const int64 size = out_shape.num_elements();
+    if (size == 0) return;
+
+    std::vector<const T*> args(num_args_);
+    std::vector<int64> arg_sizes(num_args_);
+    for (int i = 0; i < num_args_; ++i) {
+      args[i] = ctx->input(i).template flat<T>().data();
+      arg_sizes[i] = ctx->input(i).NumElements();
+    }
+    T* out_data = out->template flat<T>().data();
+    const int num_instrs = program_.size();
+
+    auto compute_fn = [&](int64 begin, int64 end) {
+      // Tile buffers for broadcast inputs and for all instructions but the
+      // last, which writes to the output directly.
+      std::vector<T> scratch((num_args_ + num_instrs - 1) * kTileSize);
+      std::vector<const T*> values(num_args_ + num_instrs - 1);
+      for (int i = 0; i < num_args_; ++i) {
+        if (arg_sizes[i] == 1) {
+          std::fill_n(scratch.data() + i * kTileSize, kTileSize, args[i][0]);
+          values[i] = scratch.data() + i * kTileSize;
+        }
+      }
+
+      for (int64 pos = begin; pos < end; pos += kTileSize) {
+        const int64 len = std::min(kTileSize, end - pos);
+        for (int i = 0; i < num_args_; ++i) {
+          if (arg_sizes[i] == size) {
+            values[i] = args[i] + pos;
+          } else if (arg_sizes[i] > 1) {
+            T* buf = scratch.data() + i * kTileSize;
+            RepeatInto(args[i], arg_sizes[i], pos, len, buf);
+            values[i] = buf;
+          }
+        }
+        for (int j = 0; j < num_instrs; ++j) {
+          const Instruction& instr = program_[j];
+          T* dst = j + 1 == num_instrs
+                       ? out_data + pos
+                       : scratch.data() + (num_args_ + j) * kTileSize;
+          instr.fn(values[instr.operands[0]], values[instr.operands[1]], len,
+                   dst);
+          if (j + 1 < num_instrs) values[num_args_ + j] = dst;
+        }
+      }
+    };
+
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    const int kOverheadCycles = num_instrs * 10;
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * num_args_,
+                             /*bytes_stored=*/sizeof(T),
+                             kOverheadCycles + cost_);
+    device.parallelFor(size, cost, AlignBlockSize, std::move(compute_fn));
+  }
+
+ private:
+  // Number of elements evaluated by each instruction at a time. The tiles of
+  // a program with a dozen instructions fit in L2.
+  static constexpr int64 kTileSize = 2048;
+
+  static constexpr int kPacketSize = Eigen::internal::unpacket_traits<
+      typename Eigen::internal::packet_traits<T>::type>::size;
+
+  struct Instruction {
+    ComputeFn fn;
+    // Indices into the inputs followed by the instruction results.
+    int operands[2];
+  };
+
+  static inline int64 AlignBlockSize(int64 block_size) {
+    // Keep whole tiles in all blocks but the last.
+    if (block_size >= 4 * kTileSize) {
+      return (block_size + kTileSize - 1) / kTileSize * kTileSize;
+    }
+    return (block_size + kPacketSize - 1) & ~(kPacketSize - 1);
+  }
+
+  // True if `shape`, without its leading dimensions of size 1, is a suffix of
+  // `out_shape`.
+  static bool IsSuffixBroadcast(const TensorShape& shape,
+                                const TensorShape& out_shape) {
+    int first = 0;
+    while (first < shape.dims() && shape.dim_size(first) == 1) ++first;
+    const int offset = out_shape.dims() - shape.dims();
+    if (shape.dims() - first > out_shape.dims()) return false;
+    for (int d = first; d < shape.dims(); ++d) {
+      if (shape.dim_size(d) != out_shape.dim_size(offset + d)) return false;
+    }
+    return true;
+  }
+
+  // Sets buf[j] = in[(pos + j) % in_size] for j in [0, len).
+  static void RepeatInto(const T* in, int64 in_size, int64 pos, int64 len,
+                         T* buf) {
+    int64 start = pos % in_size;
+    while (len > 0) {
+      const int64 n = std::min(len, in_size - start);
+      std::copy_n(in + start, n, buf);
+      buf += n;
+      len -= n;
+      start = 0;
+    }
+  }
+
+  int num_args_;
+  std::vector<Instruction> program_;
+  int cost_ = 0;
+};
+
+#define REGISTER_CPU(T)                                                    \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+REGISTER_CPU(float);
+REGISTER_CPU(double);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
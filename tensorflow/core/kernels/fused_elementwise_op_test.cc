@@ -0,0 +1,162 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(int num_args, const std::vector<string>& op_names,
+                const std::vector<int32>& operands) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedElementwise")
+                           .Input(FakeInput(num_args, DT_FLOAT))
+                           .Attr("op_names", op_names)
+                           .Attr("operands", operands)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+float Sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+TEST_F(FusedElementwiseOpTest, MulAddSigmoid) {
+  // Mul(Add(x, b), Sigmoid(y)), where b is broadcast along rows.
+  TF_ASSERT_OK(MakeOp(3, {"Add", "Sigmoid", "Mul"}, {0, 1, 2, -1, 3, 4}));
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({3}), {10, 20, 30});
+  AddInputFromArray<float>(TensorShape({2, 3}), {0, 1, -1, 2, -2, 0.5});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(
+      &expected, {11 * Sigmoid(0), 22 * Sigmoid(1), 33 * Sigmoid(-1),
+                  14 * Sigmoid(2), 25 * Sigmoid(-2), 36 * Sigmoid(0.5)});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, ScalarAndReusedResult) {
+  // Square(Sub(x, c)) / Add(x, Sub(x, c)).
+  TF_ASSERT_OK(MakeOp(2, {"Sub", "Square", "Add", "RealDiv"},
+                      {0, 1, 2, -1, 0, 2, 3, 4}));
+  AddInputFromArray<float>(TensorShape({4}), {2, 3, 4, 5});
+  AddInputFromArray<float>(TensorShape({}), {1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&expected, {1.0f / 3, 4.0f / 5, 9.0f / 7, 16.0f / 9});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, LargeInputSpansTiles) {
+  TF_ASSERT_OK(MakeOp(2, {"Mul", "Relu"}, {0, 1, 2, -1}));
+  const int kRows = 1000;
+  const int kCols = 7;
+  std::vector<float> x(kRows * kCols);
+  for (int i = 0; i < x.size(); ++i) x[i] = i % 11 - 5;
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), x);
+  AddInputFromArray<float>(TensorShape({1, kCols}), {1, -1, 2, -2, 3, -3, 0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const float scale[] = {1, -1, 2, -2, 3, -3, 0};
+  Tensor expected(DT_FLOAT, TensorShape({kRows, kCols}));
+  auto expected_flat = expected.flat<float>();
+  for (int i = 0; i < x.size(); ++i) {
+    expected_flat(i) = std::max(0.0f, x[i] * scale[i % kCols]);
+  }
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsGeneralBroadcast) {
+  TF_ASSERT_OK(MakeOp(2, {"Add"}, {0, 1}));
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsForwardReference) {
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(MakeOp(1, {"Exp", "Neg"}, {2, -1, 0, -1})));
+}
+
+// Performance benchmarks below.
+
+// Mul(Add(x, b), Sigmoid(y)) as separate nodes or as one fused node.
+static Graph* MulAddSigmoid(int rows, int cols, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor x(DT_FLOAT, TensorShape({rows, cols}));
+  Tensor y(DT_FLOAT, TensorShape({rows, cols}));
+  Tensor b(DT_FLOAT, TensorShape({cols}));
+  x.flat<float>().setRandom();
+  y.flat<float>().setRandom();
+  b.flat<float>().setRandom();
+  Node* x_node = test::graph::Constant(g, x);
+  Node* y_node = test::graph::Constant(g, y);
+  Node* b_node = test::graph::Constant(g, b);
+
+  Node* out;
+  if (fused) {
+    std::vector<NodeBuilder::NodeOut> args = {x_node, b_node, y_node};
+    TF_CHECK_OK(NodeBuilder(g->NewName("fused"), "_FusedElementwise")
+                    .Input(args)
+                    .Attr("T", DT_FLOAT)
+                    .Attr("op_names",
+                          std::vector<string>{"Add", "Sigmoid", "Mul"})
+                    .Attr("operands", std::vector<int32>{0, 1, 2, -1, 3, 4})
+                    .Finalize(g, &out));
+  } else {
+    Node* add;
+    Node* sigmoid;
+    TF_CHECK_OK(NodeBuilder(g->NewName("add"), "Add")
+                    .Input(x_node)
+                    .Input(b_node)
+                    .Finalize(g, &add));
+    TF_CHECK_OK(NodeBuilder(g->NewName("sigmoid"), "Sigmoid")
+                    .Input(y_node)
+                    .Finalize(g, &sigmoid));
+    TF_CHECK_OK(NodeBuilder(g->NewName("mul"), "Mul")
+                    .Input(add)
+                    .Input(sigmoid)
+                    .Finalize(g, &out));
+  }
+  return g;
+}
+
+#define BM_MulAddSigmoid(R, C, F, NAME)                         \
+  static void BM_MulAddSigmoid_##NAME##_##R##_##C(int iters) {  \
+    testing::ItemsProcessed(static_cast<int64>(iters) * R * C); \
+    test::Benchmark("cpu", MulAddSigmoid(R, C, F)).Run(iters);  \
+  }                                                             \
+  BENCHMARK(BM_MulAddSigmoid_##NAME##_##R##_##C);
+
+BM_MulAddSigmoid(256, 256, false, Unfused);
+BM_MulAddSigmoid(256, 256, true, Fused);
+BM_MulAddSigmoid(4096, 1024, false, Unfused);
+BM_MulAddSigmoid(4096, 1024, true, Fused);
+
+}  // namespace
+}  // namespace tensorflow
@@ -110,6 +110,111 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
   return result;
 }
 
+// Copies slices of exactly kSliceBytes bytes of a simple type. With the size
+// known at compile time each copy becomes a few unrolled loads and stores,
+// which matters when slices are only a handful of elements and the
+// per-index overhead of HandleCopies would dominate.
+template <typename T, typename Index, typename SliceIndex, int kSliceBytes>
+SliceIndex HandleSmallCopies(OpKernelContext* ctx,
+                             typename TTypes<T, 3>::ConstTensor params,
+                             typename TTypes<Index>::ConstFlat indices,
+                             typename TTypes<T, 3>::Tensor out) {
+  constexpr SliceIndex kSliceElems = kSliceBytes / sizeof(T);
+  // How many indices ahead of the copy to prefetch the params slice.
+  constexpr SliceIndex kPrefetchDistance = 16;
+  const SliceIndex indices_size = static_cast<SliceIndex>(indices.dimension(0));
+  const SliceIndex batch_size = static_cast<SliceIndex>(params.dimension(0));
+  const Index limit = static_cast<Index>(params.dimension(1));
+  const Index* indices_base = indices.data();
+  auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  mutex mu;
+  SliceIndex result = -1;
+  auto work = [&](int64 start, int64 end) {
+    for (SliceIndex b = static_cast<SliceIndex>(start / indices_size);
+         b * static_cast<int64>(indices_size) < end; ++b) {
+      const int64 batch_start = b * static_cast<int64>(indices_size);
+      const SliceIndex i_begin =
+          static_cast<SliceIndex>(std::max<int64>(start - batch_start, 0));
+      const SliceIndex i_end = static_cast<SliceIndex>(
+          std::min<int64>(end - batch_start, indices_size));
+      const T* params_batch =
+          params.data() + b * static_cast<SliceIndex>(limit) * kSliceElems;
+      T* out_batch = out.data() + b * indices_size * kSliceElems;
+      for (SliceIndex i = i_begin; i < i_end; ++i) {
+        if (i + kPrefetchDistance < i_end) {
+          const Index ahead = indices_base[i + kPrefetchDistance];
+          if (FastBoundsCheck(ahead, limit)) {
+            port::prefetch<port::PREFETCH_HINT_T0>(
+                params_batch + static_cast<SliceIndex>(ahead) * kSliceElems);
+          }
+        }
+        const Index index = internal::SubtleMustCopy(indices_base[i]);
+        if (!FastBoundsCheck(index, limit)) {
+          mutex_lock l(mu);
+          result = i;
+          return;
+        }
+        memcpy(out_batch + i * kSliceElems,
+               params_batch + static_cast<SliceIndex>(index) * kSliceElems,
+               kSliceBytes);
+      }
+    }
+  };
+
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        batch_size * indices_size, kSliceBytes, work);
+  return result;
+}
+
+// Dispatches to HandleSmallCopies when the slices of a simple type are 4, 8,
+// 16, 32 or 64 bytes. Returns false, leaving *bad_i untouched, otherwise.
+template <typename T, typename Index, bool = is_simple_type<T>::value>
+struct SmallSliceGather {
+  static bool Run(OpKernelContext* ctx,
+                  typename TTypes<T, 3>::ConstTensor params,
+                  typename TTypes<Index>::ConstFlat indices,
+                  typename TTypes<T, 3>::Tensor out, bool use_large,
+                  int64* bad_i) {
+    return false;
+  }
+};
+
+template <typename T, typename Index>
+struct SmallSliceGather<T, Index, true> {
+  static bool Run(OpKernelContext* ctx,
+                  typename TTypes<T, 3>::ConstTensor params,
+                  typename TTypes<Index>::ConstFlat indices,
+                  typename TTypes<T, 3>::Tensor out, bool use_large,
+                  int64* bad_i) {
+#define CALL(bytes)                                                       \
+  do {                                                                    \
+    if (use_large) {                                                      \
+      *bad_i = HandleSmallCopies<T, Index, int64, bytes>(ctx, params,     \
+                                                         indices, out);   \
+    } else {                                                              \
+      *bad_i = HandleSmallCopies<T, Index, int32, bytes>(ctx, params,     \
+                                                         indices, out);   \
+    }                                                                     \
+    return true;                                                          \
+  } while (0)
+
+    switch (out.dimension(2) * sizeof(T)) {
+      case 4:
+        CALL(4);
+      case 8:
+        CALL(8);
+      case 16:
+        CALL(16);
+      case 32:
+        CALL(32);
+      case 64:
+        CALL(64);
+    }
+#undef CALL
+    return false;
+  }
+};
+
 template <typename T, typename Index>
 struct GatherFunctorCPU {
   int64 operator()(OpKernelContext* ctx,
@@ -139,6 +244,11 @@ struct GatherFunctorCPU {
     }                                                                    \
   } while (0)
 
+    if (SmallSliceGather<T, Index>::Run(ctx, params, indices, out, use_large,
+                                        &bad_i)) {
+      return bad_i;
+    }
+
     if (slice_size == 10)
       CALL(10);
     else if (slice_size == 20)
@@ -232,7 +232,11 @@ static Graph* Gather(int dim) {
   }                                                               \
   BENCHMARK(BM_##DEVICE##_gather_##INDEX)                         \
       ->Arg(1)                                                    \
+      ->Arg(2)                                                    \
+      ->Arg(4)                                                    \
+      ->Arg(8)                                                    \
       ->Arg(10)                                                   \
+      ->Arg(16)                                                   \
       ->Arg(20)                                                   \
       ->Arg(64)                                                   \
       ->Arg(100)                                                  \
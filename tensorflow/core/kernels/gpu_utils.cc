@@ -22,6 +22,10 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 #include "absl/algorithm/container.h"
 #include "absl/base/call_once.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logger.h"
 #include "tensorflow/core/protobuf/autotuning.pb.h"
 #include "tensorflow/core/protobuf/conv_autotuning.pb.h"
@@ -243,6 +247,174 @@ bool RequireCudnnDeterminism() {
   return require_cudnn_determinism;
 }
 
+namespace {
+
+// Bump when the format of the autotune cache file, or the meaning of the
+// parameters or configs recorded in it, changes.
+constexpr int kAutotuneCacheVersion = 1;
+
+string AlgorithmDescToString(const absl::optional<se::dnn::AlgorithmDesc>& a) {
+  if (!a.has_value()) return "-";
+  return strings::StrCat(a->algo_id(), ":", a->tensor_ops_enabled() ? 1 : 0);
+}
+
+bool AlgorithmDescFromString(StringPiece str,
+                             absl::optional<se::dnn::AlgorithmDesc>* a) {
+  if (str == "-") {
+    a->reset();
+    return true;
+  }
+  std::vector<StringPiece> parts = absl::StrSplit(str, ':');
+  int64 algo_id;
+  int32 tensor_ops;
+  if (parts.size() != 2 || !strings::safe_strto64(parts[0], &algo_id) ||
+      !strings::safe_strto32(parts[1], &tensor_ops)) {
+    return false;
+  }
+  *a = se::dnn::AlgorithmDesc(algo_id, tensor_ops != 0);
+  return true;
+}
+
+// Describes everything besides the op parameters that autotune results
+// depend on.
+string AutotuneCacheFingerprint(se::Platform* platform) {
+  string fingerprint =
+      strings::StrCat("v", kAutotuneCacheVersion, " ", platform->Name(),
+                      " deterministic=", RequireCudnnDeterminism() ? 1 : 0);
+  for (int i = 0; i < platform->VisibleDeviceCount(); ++i) {
+    auto stream_exec_or = platform->ExecutorForDevice(i);
+    if (!stream_exec_or.ok()) continue;
+    se::StreamExecutor* stream_exec = stream_exec_or.ValueOrDie();
+    const se::DeviceDescription& desc = stream_exec->GetDeviceDescription();
+    const ComputeCapability cc = GetComputeCapability(stream_exec);
+    const CudnnVersion cudnn = GetCudnnVersion(stream_exec);
+    strings::StrAppend(&fingerprint, " [", desc.name(), " cc=", cc.major(), ".",
+                       cc.minor(), " driver=", desc.driver_version(),
+                       " dnn=", cudnn.major(), ".", cudnn.minor(), ".",
+                       cudnn.patch(), "]");
+  }
+  return fingerprint;
+}
+
+}  // namespace
+
+bool AutotuneConfigToString(const se::dnn::AlgorithmConfig& config,
+                            string* out) {
+  *out = strings::StrCat(
+      AlgorithmDescToString(config.algorithm()), " ",
+      AlgorithmDescToString(config.algorithm_no_scratch()), " ",
+      config.scratch_size().has_value()
+          ? strings::StrCat(*config.scratch_size())
+          : "-");
+  return true;
+}
+
+bool AutotuneConfigFromString(StringPiece str,
+                              se::dnn::AlgorithmConfig* config) {
+  std::vector<StringPiece> fields = absl::StrSplit(str, ' ');
+  absl::optional<se::dnn::AlgorithmDesc> algorithm, algorithm_no_scratch;
+  if (fields.size() != 3 || !AlgorithmDescFromString(fields[0], &algorithm) ||
+      !AlgorithmDescFromString(fields[1], &algorithm_no_scratch)) {
+    return false;
+  }
+  *config = se::dnn::AlgorithmConfig();
+  if (algorithm.has_value()) config->set_algorithm(*algorithm);
+  if (algorithm_no_scratch.has_value()) {
+    config->set_algorithm_no_scratch(*algorithm_no_scratch);
+  }
+  if (fields[2] != "-") {
+    uint64 scratch_size;
+    if (!strings::safe_strtou64(fields[2], &scratch_size)) return false;
+    config->set_scratch_size(scratch_size);
+  }
+  return true;
+}
+
+bool AutotuneConfigToString(const se::blas::AlgorithmConfig& config,
+                            string* out) {
+  *out = strings::StrCat(config.algorithm());
+  return true;
+}
+
+bool AutotuneConfigFromString(StringPiece str,
+                              se::blas::AlgorithmConfig* config) {
+  int64 algorithm;
+  if (!strings::safe_strto64(str, &algorithm)) return false;
+  config->set_algorithm(algorithm);
+  return true;
+}
+
+/*static*/ AutotuneCacheFile* AutotuneCacheFile::Global() {
+  static AutotuneCacheFile* cache = []() -> AutotuneCacheFile* {
+    const char* filename = std::getenv("TF_AUTOTUNE_CACHE_FILE");
+    if (filename == nullptr || filename[0] == '\0') return nullptr;
+#if GOOGLE_CUDA
+    auto platform_or = se::MultiPlatformManager::PlatformWithName("CUDA");
+#else
+    auto platform_or = se::MultiPlatformManager::PlatformWithName("ROCM");
+#endif
+    if (!platform_or.ok()) {
+      LOG(WARNING) << "Not using the autotune cache file " << filename << ": "
+                   << platform_or.status();
+      return nullptr;
+    }
+    return new AutotuneCacheFile(
+        filename, AutotuneCacheFingerprint(platform_or.ValueOrDie()));
+  }();
+  return cache;
+}
+
+AutotuneCacheFile::AutotuneCacheFile(const string& filename,
+                                     const string& fingerprint)
+    : filename_(filename), fingerprint_(fingerprint) {
+  // Each line holds the fingerprint, map name, parameters and config of one
+  // result, separated by tabs.  Later lines override earlier ones.
+  string contents;
+  Status s = ReadFileToString(Env::Default(), filename_, &contents);
+  if (!s.ok() && !errors::IsNotFound(s)) {
+    LOG(WARNING) << "Could not read the autotune cache file " << filename_
+                 << ": " << s;
+  }
+  int num_results = 0;
+  for (StringPiece line : absl::StrSplit(contents, '\n')) {
+    std::vector<string> fields = absl::StrSplit(line, '\t');
+    if (fields.size() != 4 || fields[0] != fingerprint_) continue;
+    entries_[fields[1]].emplace_back(std::move(fields[2]),
+                                     std::move(fields[3]));
+    ++num_results;
+  }
+  VLOG(1) << "Loaded " << num_results << " results from the autotune cache "
+          << "file " << filename_ << " for " << fingerprint_;
+}
+
+std::vector<std::pair<string, string>> AutotuneCacheFile::Lookup(
+    const string& map_name) const {
+  auto it = entries_.find(map_name);
+  if (it == entries_.end()) return {};
+  return it->second;
+}
+
+void AutotuneCacheFile::Append(const string& map_name, const string& params,
+                               const string& config) {
+  mutex_lock l(mu_);
+  if (file_failed_) return;
+  Status s;
+  if (file_ == nullptr) {
+    s = Env::Default()->NewAppendableFile(filename_, &file_);
+  }
+  if (s.ok()) {
+    s = file_->Append(strings::StrCat(fingerprint_, "\t", map_name, "\t",
+                                      params, "\t", config, "\n"));
+  }
+  if (s.ok()) s = file_->Flush();
+  if (!s.ok()) {
+    LOG(WARNING) << "Could not write the autotune cache file " << filename_
+                 << ", no more results will be recorded: " << s;
+    file_.reset();
+    file_failed_ = true;
+  }
+}
+
 Status BestCudnnConvAlgorithm(absl::Span<const AutotuneResult> results,
                               se::dnn::AlgorithmConfig* algo) {
   std::vector<AutotuneResult> filtered_results;
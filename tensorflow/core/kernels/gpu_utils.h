@@ -18,7 +18,10 @@ limitations under the License.
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -26,7 +29,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 
 namespace stream_executor {
@@ -66,6 +71,62 @@ inline se::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory, uint64 size) {
   return typed;
 }
 
+// Converts autotune configs to and from the strings stored in the autotune
+// cache file.  Return false for configs that are not persisted.
+template <typename Config>
+bool AutotuneConfigToString(const Config& config, string* out) {
+  return false;
+}
+template <typename Config>
+bool AutotuneConfigFromString(StringPiece str, Config* config) {
+  return false;
+}
+bool AutotuneConfigToString(const se::dnn::AlgorithmConfig& config,
+                            string* out);
+bool AutotuneConfigFromString(StringPiece str,
+                              se::dnn::AlgorithmConfig* config);
+bool AutotuneConfigToString(const se::blas::AlgorithmConfig& config,
+                            string* out);
+bool AutotuneConfigFromString(StringPiece str,
+                              se::blas::AlgorithmConfig* config);
+
+// Autotune results persisted across processes.
+//
+// If TF_AUTOTUNE_CACHE_FILE names a file, every autotune map starts out with
+// the results recorded in it, and appends the results it accepts.  Results
+// are recorded with a fingerprint of the file format, the model, compute
+// capability and driver of every GPU of the process, the cuDNN version and
+// the determinism setting; results recorded under a different fingerprint
+// are ignored.
+class AutotuneCacheFile {
+ public:
+  // Returns nullptr if TF_AUTOTUNE_CACHE_FILE is not set or no GPU is
+  // available.
+  static AutotuneCacheFile* Global();
+
+  // Returns the (parameters, config) pairs recorded for the map `map_name`.
+  std::vector<std::pair<string, string>> Lookup(const string& map_name) const;
+
+  // Records that the map `map_name` accepted `config` for `params`.
+  void Append(const string& map_name, const string& params,
+              const string& config);
+
+ private:
+  AutotuneCacheFile(const string& filename, const string& fingerprint);
+
+  const string filename_;
+  const string fingerprint_;
+  // Results loaded from the file, by map name.  Immutable.
+  std::unordered_map<string, std::vector<std::pair<string, string>>>
+      entries_;
+
+  mutex mu_;
+  std::unique_ptr<WritableFile> file_ TF_GUARDED_BY(mu_);
+  bool file_failed_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AutotuneCacheFile);
+};
+
 // A helper class that looks up the best autotuned config from parameters.
 // Due to the noisy nature of autotune, especially with multiple devices, it
 // only accepts a config if its margin exceeds a threshold.
@@ -82,6 +143,20 @@ class AutoTuneMap {
   bool Find(const Parameters& params, Config* config) const {
     mutex_lock lock(mu_);
     auto iter = params_config_map_.find(params);
+    if (iter == params_config_map_.end() && !persisted_configs_.empty()) {
+      // Results from the cache file are only looked up on the first miss, as
+      // formatting `params` is not free.
+      auto persisted = persisted_configs_.find(params.ToString());
+      if (persisted != persisted_configs_.end()) {
+        VLOG(1) << GetActionSummary("restores", params, persisted->second);
+        iter = params_config_map_
+                   .insert(std::make_pair(
+                       params, ValueType{persisted->second,
+                                         min_score_threshold_, 1}))
+                   .first;
+        persisted_configs_.erase(persisted);
+      }
+    }
     if (iter == params_config_map_.end() ||
         (iter->second.score < min_score_threshold_ &&
          iter->second.count <= max_autotune_count_)) {
@@ -121,6 +196,7 @@ class AutoTuneMap {
     }
     if (new_score >= min_score_threshold_) {
       VLOG(1) << GetActionSummary("accepts", params, config);
+      Persist(params, config);
     } else if (autotune_global_count_ >= max_autotune_global_count_) {
       // The autotuning exceeds the max iteration threshold and we accept the
       // the winner if it exists in the map, otherwise we accept the current
@@ -141,6 +217,7 @@ class AutoTuneMap {
         winner->second.score = min_score_threshold_;
       }
       VLOG(1) << GetActionSummary("accepts", params, config);
+      Persist(params, params_config_map_.find(params)->second.config);
     }
     autotune_global_count_++;
   }
@@ -163,6 +240,25 @@ class AutoTuneMap {
         5 * min_score_threshold_ * min_score_threshold_, min_warmup_iterations);
     max_autotune_global_count_ = 2 * max_autotune_count_;
     autotune_global_count_ = 0;
+
+    if (AutotuneCacheFile* cache = AutotuneCacheFile::Global()) {
+      for (const auto& entry : cache->Lookup(name_)) {
+        Config config;
+        if (AutotuneConfigFromString(entry.second, &config)) {
+          persisted_configs_[entry.first] = config;
+        }
+      }
+      VLOG(1) << "autotune_map " << name_ << " loaded "
+              << persisted_configs_.size() << " results from the cache file";
+    }
+  }
+
+  void Persist(const Parameters& params, const Config& config) {
+    AutotuneCacheFile* cache = AutotuneCacheFile::Global();
+    string config_str;
+    if (cache != nullptr && AutotuneConfigToString(config, &config_str)) {
+      cache->Append(name_, params.ToString(), config_str);
+    }
   }
 
   template <class Group, class Params, class Cfg>
@@ -175,7 +271,7 @@ class AutoTuneMap {
   };
 
   std::string GetActionSummary(StringPiece action, const Parameters& params,
-                               const Config& config) {
+                               const Config& config) const {
     return strings::Printf("autotune_map %s %s: %s -> (%s)", name_.c_str(),
                            string(action).c_str(), params.ToString().c_str(),
                            config.ToString().c_str());
@@ -187,7 +283,11 @@ class AutoTuneMap {
     int32 score;
     int32 count;
   };
-  std::unordered_map<Parameters, ValueType, Hasher> params_config_map_
+  // Find() adds the results restored from the cache file.
+  mutable std::unordered_map<Parameters, ValueType, Hasher> params_config_map_
+      TF_GUARDED_BY(mu_);
+  // Results from the cache file not looked up yet, by formatted parameters.
+  mutable std::unordered_map<string, Config> persisted_configs_
       TF_GUARDED_BY(mu_);
   std::string name_;
   int32 min_score_threshold_;
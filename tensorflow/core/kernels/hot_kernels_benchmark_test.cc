@@ -0,0 +1,390 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the kernels that dominate the step times of our production
+// models, over a fixed set of shapes. The names of the benchmarks encode their
+// shapes, so that the results of different commits can be compared with
+// //tensorflow/tools/benchmark:compare_benchmarks:
+//
+//   for i in 0 1 2; do
+//     TEST_REPORT_FILE_PREFIX=/tmp/base/run${i}_ \
+//         bazel-bin/tensorflow/core/kernels/hot_kernels_benchmark_test \
+//         --benchmarks=all
+//   done
+//   (same for /tmp/cand at the candidate commit)
+//   bazel-bin/tensorflow/tools/benchmark/compare_benchmarks \
+//       --baseline='/tmp/base/run*' --candidate='/tmp/cand/run*'
+//
+// Do not change the shapes of existing benchmarks, add new ones instead.
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor RandomIndices(int64 num_indices, int64 limit, bool sorted) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  auto flat = indices.flat<int32>();
+  for (int64 i = 0; i < num_indices; ++i) {
+    flat(i) = rnd.Uniform(limit);
+  }
+  if (sorted) std::sort(flat.data(), flat.data() + num_indices);
+  return indices;
+}
+
+Tensor RandomFloats(const TensorShape& shape) {
+  Tensor tensor(DT_FLOAT, shape);
+  tensor.flat<float>().setRandom();
+  return tensor;
+}
+
+//----------------------------------------------------------------------------//
+// MatMul                                                                     //
+//----------------------------------------------------------------------------//
+
+Graph* MatMul(int m, int k, int n) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(
+      g, test::graph::Constant(g, RandomFloats(TensorShape({m, k}))),
+      test::graph::Constant(g, RandomFloats(TensorShape({k, n}))),
+      /*transpose_a=*/false, /*transpose_b=*/false);
+  return g;
+}
+
+#define BM_HOT_MATMUL(M, K, N)                                          \
+  static void BM_HotMatMul_##M##_##K##_##N(int iters) {                 \
+    testing::StopTiming();                                              \
+    testing::UseRealTime();                                             \
+    testing::ItemsProcessed(static_cast<int64>(iters) * M * K * N * 2); \
+    test::Benchmark("cpu", MatMul(M, K, N)).Run(iters);                 \
+  }                                                                     \
+  BENCHMARK(BM_HotMatMul_##M##_##K##_##N);
+
+BM_HOT_MATMUL(1, 512, 512);
+BM_HOT_MATMUL(32, 512, 512);
+BM_HOT_MATMUL(128, 1024, 1024);
+BM_HOT_MATMUL(512, 2048, 512);
+
+//----------------------------------------------------------------------------//
+// Conv2D                                                                     //
+//----------------------------------------------------------------------------//
+
+Graph* Conv2D(int batch, int size, int in_depth, int filter_size,
+              int out_depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* input = test::graph::Constant(
+      g, RandomFloats(TensorShape({batch, size, size, in_depth})));
+  Node* filter = test::graph::Constant(
+      g, RandomFloats(
+             TensorShape({filter_size, filter_size, in_depth, out_depth})));
+  TF_CHECK_OK(NodeBuilder(g->NewName("conv2d"), "Conv2D")
+                  .Input(input)
+                  .Input(filter)
+                  .Attr("T", DT_FLOAT)
+                  .Attr("strides", {1, 1, 1, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(g, nullptr));
+  return g;
+}
+
+// ResNet-50 like layers, in NHWC.
+#define BM_HOT_CONV2D(N, S, C, F, K)                                       \
+  static void BM_HotConv2D_##N##_##S##_##C##_##F##_##K(int iters) {        \
+    testing::StopTiming();                                                 \
+    testing::UseRealTime();                                                \
+    const int64 flops = static_cast<int64>(N) * S * S * F * F * C * K * 2; \
+    testing::ItemsProcessed(flops * iters);                                \
+    test::Benchmark("cpu", Conv2D(N, S, C, F, K)).Run(iters);              \
+  }                                                                        \
+  BENCHMARK(BM_HotConv2D_##N##_##S##_##C##_##F##_##K);
+
+BM_HOT_CONV2D(8, 56, 64, 3, 64);
+BM_HOT_CONV2D(8, 28, 128, 3, 128);
+BM_HOT_CONV2D(8, 14, 256, 3, 256);
+BM_HOT_CONV2D(8, 7, 512, 1, 2048);
+
+//----------------------------------------------------------------------------//
+// Gather                                                                     //
+//----------------------------------------------------------------------------//
+
+Graph* Gather(int rows, int dim, int num_indices) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor axis(DT_INT32, TensorShape({}));
+  axis.scalar<int32>()() = 0;
+  test::graph::Gather(
+      g, test::graph::Constant(g, RandomFloats(TensorShape({rows, dim}))),
+      test::graph::Constant(g, RandomIndices(num_indices, rows, false)),
+      test::graph::HostConstant(g, axis));
+  return g;
+}
+
+// Embedding lookups into tables of R rows of D floats.
+#define BM_HOT_GATHER(R, D, I)                           \
+  static void BM_HotGather_##R##_##D##_##I(int iters) {  \
+    testing::StopTiming();                               \
+    testing::UseRealTime();                              \
+    const int64 tot = static_cast<int64>(iters) * I * D; \
+    testing::ItemsProcessed(tot);                        \
+    testing::BytesProcessed(tot * sizeof(float));        \
+    test::Benchmark("cpu", Gather(R, D, I)).Run(iters);  \
+  }                                                      \
+  BENCHMARK(BM_HotGather_##R##_##D##_##I);
+
+BM_HOT_GATHER(100000, 64, 1024);
+BM_HOT_GATHER(100000, 256, 4096);
+BM_HOT_GATHER(1000000, 16, 16384);
+
+//----------------------------------------------------------------------------//
+// SparseSegmentSum, SparseSegmentMean, SparseSegmentSqrtN                    //
+//----------------------------------------------------------------------------//
+
+Graph* SparseSegmentReduction(const string& op, int rows, int dim,
+                              int num_indices, int num_segments) {
+  Graph* g = new Graph(OpRegistry::Global());
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), op)
+          .Input(test::graph::Constant(
+              g, RandomFloats(TensorShape({rows, dim}))))
+          .Input(test::graph::Constant(
+              g, RandomIndices(num_indices, rows, false)))
+          .Input(test::graph::Constant(
+              g, RandomIndices(num_indices, num_segments, true)))
+          .Attr("T", DT_FLOAT)
+          .Finalize(g, nullptr));
+  return g;
+}
+
+// Reductions of I embeddings of D floats, out of R rows, into S bags.
+#define BM_HOT_SPARSE_SEGMENT(OP, R, D, I, S)                       \
+  static void BM_Hot##OP##_##R##_##D##_##I##_##S(int iters) {       \
+    testing::StopTiming();                                          \
+    testing::UseRealTime();                                         \
+    const int64 tot = static_cast<int64>(iters) * I * D;            \
+    testing::ItemsProcessed(tot);                                   \
+    testing::BytesProcessed(tot * sizeof(float));                   \
+    test::Benchmark("cpu", SparseSegmentReduction(#OP, R, D, I, S)) \
+        .Run(iters);                                                \
+  }                                                                 \
+  BENCHMARK(BM_Hot##OP##_##R##_##D##_##I##_##S);
+
+#define BM_HOT_SPARSE_SEGMENTS(R, D, I, S)              \
+  BM_HOT_SPARSE_SEGMENT(SparseSegmentSum, R, D, I, S);  \
+  BM_HOT_SPARSE_SEGMENT(SparseSegmentMean, R, D, I, S); \
+  BM_HOT_SPARSE_SEGMENT(SparseSegmentSqrtN, R, D, I, S);
+
+BM_HOT_SPARSE_SEGMENTS(100000, 64, 4096, 128);
+BM_HOT_SPARSE_SEGMENTS(100000, 64, 65536, 1024);
+BM_HOT_SPARSE_SEGMENTS(1000000, 16, 65536, 65536);
+
+//----------------------------------------------------------------------------//
+// Unique                                                                     //
+//----------------------------------------------------------------------------//
+
+Graph* Unique(int size, int num_distinct) {
+  Graph* g = new Graph(OpRegistry::Global());
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor input(DT_INT64, TensorShape({size}));
+  auto flat = input.flat<int64>();
+  for (int i = 0; i < size; ++i) {
+    // Spread the values so that they don't hash to consecutive buckets.
+    flat(i) = static_cast<int64>(rnd.Uniform(num_distinct)) * 7919;
+  }
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Unique")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Attr("out_idx", DT_INT32)
+                  .Finalize(g, nullptr));
+  return g;
+}
+
+// Deduplication of N ids drawn from K distinct values.
+#define BM_HOT_UNIQUE(N, K)                                 \
+  static void BM_HotUnique_##N##_##K(int iters) {           \
+    testing::StopTiming();                                  \
+    testing::UseRealTime();                                 \
+    testing::ItemsProcessed(static_cast<int64>(iters) * N); \
+    test::Benchmark("cpu", Unique(N, K)).Run(iters);        \
+  }                                                         \
+  BENCHMARK(BM_HotUnique_##N##_##K);
+
+BM_HOT_UNIQUE(4096, 100);
+BM_HOT_UNIQUE(65536, 1024);
+BM_HOT_UNIQUE(1048576, 65536);
+
+//----------------------------------------------------------------------------//
+// ParseExample                                                               //
+//----------------------------------------------------------------------------//
+
+Tensor SerializedExamples(int batch_size, int num_keys, int feature_size,
+                          bool sparse) {
+  Example example;
+  for (int i = 0; i < num_keys; ++i) {
+    Feature& feature =
+        (*example.mutable_features()->mutable_feature())[strings::StrCat(
+            "feature_", i)];
+    for (int j = 0; j < feature_size; ++j) {
+      if (sparse) {
+        feature.mutable_int64_list()->add_value(j);
+      } else {
+        feature.mutable_float_list()->add_value(j);
+      }
+    }
+  }
+  Tensor serialized(DT_STRING, TensorShape({batch_size}));
+  auto flat = serialized.flat<tstring>();
+  const string serialized_example = example.SerializeAsString();
+  for (int i = 0; i < batch_size; ++i) {
+    flat(i) = serialized_example;
+  }
+  return serialized;
+}
+
+Graph* ParseExample(int batch_size, int num_keys, int feature_size,
+                    bool sparse) {
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<NodeBuilder::NodeOut> sparse_keys;
+  std::vector<NodeBuilder::NodeOut> dense_keys;
+  std::vector<NodeBuilder::NodeOut> dense_defaults;
+  std::vector<DataType> sparse_types;
+  std::vector<PartialTensorShape> dense_shapes;
+  for (int i = 0; i < num_keys; ++i) {
+    Tensor key(DT_STRING, TensorShape());
+    key.scalar<tstring>()() = strings::StrCat("feature_", i);
+    if (sparse) {
+      sparse_keys.emplace_back(test::graph::Constant(g, key));
+      sparse_types.push_back(DT_INT64);
+    } else {
+      dense_keys.emplace_back(test::graph::Constant(g, key));
+      Tensor dense_default(DT_FLOAT, TensorShape({feature_size}));
+      dense_default.flat<float>().setZero();
+      dense_defaults.emplace_back(test::graph::Constant(g, dense_default));
+      dense_shapes.push_back(PartialTensorShape({feature_size}));
+    }
+  }
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "ParseExample")
+                  .Input(test::graph::Constant(
+                      g, SerializedExamples(batch_size, num_keys, feature_size,
+                                            sparse)))
+                  .Input(test::graph::Constant(
+                      g, Tensor(DT_STRING, TensorShape({0}))))
+                  .Input(sparse_keys)
+                  .Input(dense_keys)
+                  .Input(dense_defaults)
+                  .Attr("sparse_types", sparse_types)
+                  .Attr("dense_shapes", dense_shapes)
+                  .Finalize(g, nullptr));
+  return g;
+}
+
+// Parsing of B examples with K features of F values each.
+#define BM_HOT_PARSE_EXAMPLE(TYPE, SPARSE, B, K, F)                    \
+  static void BM_HotParseExample_##TYPE##_##B##_##K##_##F(int iters) { \
+    testing::StopTiming();                                             \
+    testing::UseRealTime();                                            \
+    testing::ItemsProcessed(static_cast<int64>(iters) * B);            \
+    test::Benchmark("cpu", ParseExample(B, K, F, SPARSE)).Run(iters);  \
+  }                                                                    \
+  BENCHMARK(BM_HotParseExample_##TYPE##_##B##_##K##_##F);
+
+BM_HOT_PARSE_EXAMPLE(Dense, false, 128, 10, 1);
+BM_HOT_PARSE_EXAMPLE(Dense, false, 128, 10, 128);
+BM_HOT_PARSE_EXAMPLE(Dense, false, 512, 100, 1);
+BM_HOT_PARSE_EXAMPLE(Sparse, true, 128, 10, 16);
+BM_HOT_PARSE_EXAMPLE(Sparse, true, 512, 100, 4);
+
+//----------------------------------------------------------------------------//
+// Lookup tables                                                              //
+//----------------------------------------------------------------------------//
+
+// Adds a node for the table of type `table_op` that is shared by the
+// initialization and the benchmarked graphs.
+Node* Table(Graph* g, const string& table_op) {
+  Node* table;
+  TF_CHECK_OK(NodeBuilder(g->NewName("table"), table_op)
+                  .Attr("shared_name", "hot_kernels_benchmark_table")
+                  .Attr("key_dtype", DT_INT64)
+                  .Attr("value_dtype", DT_INT64)
+                  .Finalize(g, &table));
+  return table;
+}
+
+// Returns a graph that initializes a table of type `table_op` with the keys
+// [0, table_size).
+Graph* InitTable(const string& table_op, int table_size) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor keys(DT_INT64, TensorShape({table_size}));
+  for (int i = 0; i < table_size; ++i) keys.flat<int64>()(i) = i;
+  const bool mutable_table = table_op == "MutableHashTableV2";
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("init"),
+                  mutable_table ? "LookupTableImportV2" : "InitializeTableV2")
+          .Input(Table(g, table_op))
+          .Input(test::graph::Constant(g, keys))
+          .Input(test::graph::Constant(g, keys))
+          .Finalize(g, nullptr));
+  return g;
+}
+
+Graph* LookupTableFind(const string& table_op, int table_size,
+                       int num_keys) {
+  Graph* g = new Graph(OpRegistry::Global());
+  // Half of the keys are missing from the table.
+  Tensor keys(DT_INT64, TensorShape({num_keys}));
+  const Tensor indices = RandomIndices(num_keys, 2 * table_size, false);
+  for (int i = 0; i < num_keys; ++i) {
+    keys.flat<int64>()(i) = indices.flat<int32>()(i);
+  }
+  Tensor default_value(DT_INT64, TensorShape({}));
+  default_value.scalar<int64>()() = -1;
+  TF_CHECK_OK(NodeBuilder(g->NewName("find"), "LookupTableFindV2")
+                  .Input(Table(g, table_op))
+                  .Input(test::graph::Constant(g, keys))
+                  .Input(test::graph::Constant(g, default_value))
+                  .Finalize(g, nullptr));
+  return g;
+}
+
+// Lookups of K keys into a table of S entries.
+#define BM_HOT_LOOKUP(TABLE, S, K)                             \
+  static void BM_HotLookup_##TABLE##_##S##_##K(int iters) {    \
+    testing::StopTiming();                                     \
+    testing::UseRealTime();                                    \
+    testing::ItemsProcessed(static_cast<int64>(iters) * K);    \
+    test::Benchmark("cpu", LookupTableFind(#TABLE, S, K),      \
+                    /*options=*/nullptr, InitTable(#TABLE, S)) \
+        .Run(iters);                                           \
+  }                                                            \
+  BENCHMARK(BM_HotLookup_##TABLE##_##S##_##K);
+
+BM_HOT_LOOKUP(HashTableV2, 10000, 1024);
+BM_HOT_LOOKUP(HashTableV2, 1000000, 16384);
+BM_HOT_LOOKUP(MutableHashTableV2, 10000, 1024);
+BM_HOT_LOOKUP(MutableHashTableV2, 1000000, 16384);
+
+}  // namespace
+}  // namespace tensorflow
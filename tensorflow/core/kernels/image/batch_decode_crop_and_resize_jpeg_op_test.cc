@@ -0,0 +1,188 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns a JPEG-encoded RGB image with smooth gradients.
+tstring MakeJpeg(int height, int width) {
+  std::vector<uint8> pixels(height * width * 3);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      uint8* pixel = &pixels[(y * width + x) * 3];
+      pixel[0] = (x * 255) / width;
+      pixel[1] = (y * 255) / height;
+      pixel[2] = ((x + y) * 127) / (width + height);
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  flags.quality = 95;
+  return jpeg::Compress(pixels.data(), width, height, flags);
+}
+
+class BatchDecodeCropAndResizeJpegOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("op", "BatchDecodeCropAndResizeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("channels", 3)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(BatchDecodeCropAndResizeJpegOpTest, SameSizeMatchesDecodeAndCrop) {
+  MakeOp();
+  const tstring jpeg = MakeJpeg(64, 80);
+  AddInputFromArray<tstring>(TensorShape({2}), {jpeg, jpeg});
+  AddInputFromArray<int32>(TensorShape({2, 4}),
+                           {8, 16, 32, 40, 0, 0, 32, 40});
+  AddInputFromArray<int32>(TensorShape({2}), {32, 40});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Without resizing, the images are the decoded crop windows.
+  jpeg::UncompressFlags flags;
+  flags.components = 3;
+  flags.dct_method = JDCT_IFAST;
+  flags.crop = true;
+  flags.crop_height = 32;
+  flags.crop_width = 40;
+  Tensor expected(DT_FLOAT, TensorShape({2, 32, 40, 3}));
+  auto expected_flat = expected.flat<float>();
+  const int image_size = 32 * 40 * 3;
+  for (int i = 0; i < 2; ++i) {
+    flags.crop_y = i == 0 ? 8 : 0;
+    flags.crop_x = i == 0 ? 16 : 0;
+    int width, height, components;
+    std::unique_ptr<uint8[]> decoded(jpeg::Uncompress(
+        jpeg.data(), jpeg.size(), flags, &width, &height, &components,
+        /*nwarn=*/nullptr));
+    ASSERT_NE(decoded, nullptr);
+    for (int j = 0; j < image_size; ++j) {
+      expected_flat(i * image_size + j) = decoded[j];
+    }
+  }
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(BatchDecodeCropAndResizeJpegOpTest, DownscalesWhileDecoding) {
+  MakeOp();
+  const tstring jpeg = MakeJpeg(256, 320);
+  AddInputFromArray<tstring>(TensorShape({1}), {jpeg});
+  AddInputFromArray<int32>(TensorShape({1, 4}), {0, 0, 256, 320});
+  // Decoded at 1/8 scale, the size of the output.
+  AddInputFromArray<int32>(TensorShape({2}), {32, 40});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The gradients survive the downscaling.
+  const auto images = GetOutput(0)->tensor<float, 4>();
+  for (int y = 0; y < 32; ++y) {
+    for (int x = 0; x < 40; ++x) {
+      EXPECT_NEAR(images(0, y, x, 0), (x * 8 + 4) * 255.0f / 320, 8.0f);
+      EXPECT_NEAR(images(0, y, x, 1), (y * 8 + 4) * 255.0f / 256, 8.0f);
+    }
+  }
+}
+
+TEST_F(BatchDecodeCropAndResizeJpegOpTest, InvalidCropWindow) {
+  MakeOp();
+  const tstring jpeg = MakeJpeg(64, 80);
+  AddInputFromArray<tstring>(TensorShape({1}), {jpeg});
+  AddInputFromArray<int32>(TensorShape({1, 4}), {40, 0, 32, 40});
+  AddInputFromArray<int32>(TensorShape({2}), {16, 16});
+  const Status status = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+// Decodes, crops and resizes a batch of 32 1024x768 images to 224x224, either
+// with the fused op or with DecodeAndCropJpeg and ResizeBilinear.
+static void BM_DecodeCropAndResizeJpeg(int iters, int fused) {
+  testing::StopTiming();
+  constexpr int kBatchSize = 32;
+  const tstring jpeg = MakeJpeg(768, 1024);
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor size(DT_INT32, TensorShape({2}));
+  size.vec<int32>().setValues({224, 224});
+  if (fused) {
+    Tensor contents(DT_STRING, TensorShape({kBatchSize}));
+    Tensor crop_windows(DT_INT32, TensorShape({kBatchSize, 4}));
+    for (int i = 0; i < kBatchSize; ++i) {
+      contents.vec<tstring>()(i) = jpeg;
+      crop_windows.matrix<int32>()(i, 0) = 96;
+      crop_windows.matrix<int32>()(i, 1) = 128;
+      crop_windows.matrix<int32>()(i, 2) = 576;
+      crop_windows.matrix<int32>()(i, 3) = 768;
+    }
+    Node* node;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "BatchDecodeCropAndResizeJpeg")
+                    .Input(test::graph::Constant(g, contents))
+                    .Input(test::graph::Constant(g, crop_windows))
+                    .Input(test::graph::Constant(g, size))
+                    .Finalize(g, &node));
+  } else {
+    Tensor contents(DT_STRING, TensorShape({}));
+    contents.scalar<tstring>()() = jpeg;
+    Tensor crop_window(DT_INT32, TensorShape({4}));
+    crop_window.vec<int32>().setValues({96, 128, 576, 768});
+    Node* contents_node = test::graph::Constant(g, contents);
+    Node* crop_window_node = test::graph::Constant(g, crop_window);
+    Node* size_node = test::graph::Constant(g, size);
+    for (int i = 0; i < kBatchSize; ++i) {
+      Node* decode;
+      TF_CHECK_OK(NodeBuilder(g->NewName("decode"), "DecodeAndCropJpeg")
+                      .Input(contents_node)
+                      .Input(crop_window_node)
+                      .Attr("channels", 3)
+                      .Finalize(g, &decode));
+      Node* expand;
+      TF_CHECK_OK(NodeBuilder(g->NewName("expand"), "ExpandDims")
+                      .Input(decode)
+                      .Input(test::graph::Constant(g, test::AsScalar(0)))
+                      .Finalize(g, &expand));
+      Node* resize;
+      TF_CHECK_OK(NodeBuilder(g->NewName("resize"), "ResizeBilinear")
+                      .Input(expand)
+                      .Input(size_node)
+                      .Attr("half_pixel_centers", true)
+                      .Finalize(g, &resize));
+    }
+  }
+  testing::ItemsProcessed(static_cast<int64>(iters) * kBatchSize);
+  testing::UseRealTime();
+  test::Benchmark("cpu", g).Run(iters);
+}
+BENCHMARK(BM_DecodeCropAndResizeJpeg)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/list_kernels.h"
 
+#include <cstring>
 #include <limits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -126,6 +127,129 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32 input_index,
   return Status::OK();
 }
 
+namespace {
+
+// Returns the size of the rows of the contiguous storage of lists of
+// `element`, or 0 if `element` can't be stored there.  The rows keep the
+// alignment of the storage, which kernels reading the elements rely on.
+int64 ContiguousRowBytes(const Tensor& element) {
+  if (!DataTypeCanUseMemcpy(element.dtype())) return 0;
+  const int64 row_bytes = element.TotalBytes();
+  if (row_bytes == 0 || row_bytes % EIGEN_MAX_ALIGN_BYTES != 0) return 0;
+  return row_bytes;
+}
+
+// Returns true if the rows of `buffer` have the dtype and shape of `element`.
+bool HasRowsOf(const Tensor& buffer, const DataType dtype,
+               const TensorShape& element_shape) {
+  if (buffer.dtype() != dtype || buffer.dims() != element_shape.dims() + 1) {
+    return false;
+  }
+  for (int d = 0; d < element_shape.dims(); ++d) {
+    if (buffer.dim_size(d + 1) != element_shape.dim_size(d)) return false;
+  }
+  return true;
+}
+
+// Returns row `i` of `buffer`, with shape `element_shape`.
+Tensor StorageRow(const Tensor& buffer, int64 i,
+                  const TensorShape& element_shape) {
+  Tensor row;
+  CHECK(row.CopyFrom(buffer.Slice(i, i + 1), element_shape));
+  return row;
+}
+
+}  // namespace
+
+Status PushBackContiguous(OpKernelContext* c, const Tensor& element,
+                          TensorList* list) {
+  std::vector<Tensor>& tensors = list->tensors();
+  std::shared_ptr<TensorList::ContiguousStorage>& storage =
+      list->contiguous_storage();
+  const int64 row_bytes = ContiguousRowBytes(element);
+  const int64 n = tensors.size();
+  // Only empty lists start using contiguous storage, so that lists which
+  // stopped using it aren't copied again on every push.
+  if (row_bytes == 0 || (storage == nullptr && n > 0)) {
+    storage.reset();
+    tensors.push_back(element);
+    return Status::OK();
+  }
+
+  if (storage != nullptr) {
+    int64 size = storage->size.load(std::memory_order_relaxed);
+    // Another list sharing the storage may have claimed the next row, or
+    // this list may no longer hold the used rows, e.g. after a pop.
+    // Appending would then copy the whole list, so the list stops using
+    // contiguous storage instead.
+    const bool can_append =
+        size == n && n < storage->buffer.dim_size(0) &&
+        HasRowsOf(storage->buffer, element.dtype(), element.shape()) &&
+        storage->size.compare_exchange_strong(size, n + 1);
+    if (can_append) {
+      Tensor row = StorageRow(storage->buffer, n, element.shape());
+      std::memcpy(row.data(), element.data(), row_bytes);
+      tensors.push_back(std::move(row));
+      return Status::OK();
+    }
+    if (size != n || n < storage->buffer.dim_size(0)) {
+      storage.reset();
+      tensors.push_back(element);
+      return Status::OK();
+    }
+    // The storage is full, so the list moves to larger storage.
+  }
+
+  for (const Tensor& t : tensors) {
+    if (t.dtype() != element.dtype() || t.shape() != element.shape()) {
+      storage.reset();
+      tensors.push_back(element);
+      return Status::OK();
+    }
+  }
+  // Doubling the capacity keeps pushes amortized constant time.
+  TensorShape buffer_shape = element.shape();
+  buffer_shape.InsertDim(0, 2 * (n + 1));
+  auto new_storage = std::make_shared<TensorList::ContiguousStorage>();
+  TF_RETURN_IF_ERROR(
+      c->allocate_temp(element.dtype(), buffer_shape, &new_storage->buffer));
+  char* base = static_cast<char*>(new_storage->buffer.data());
+  for (int64 i = 0; i < n; ++i) {
+    std::memcpy(base + i * row_bytes, tensors[i].data(), row_bytes);
+    tensors[i] = StorageRow(new_storage->buffer, i, element.shape());
+  }
+  std::memcpy(base + n * row_bytes, element.data(), row_bytes);
+  tensors.push_back(StorageRow(new_storage->buffer, n, element.shape()));
+  new_storage->size = n + 1;
+  storage = std::move(new_storage);
+  return Status::OK();
+}
+
+bool GetContiguousElements(const TensorList& list,
+                           const TensorShape& element_shape, Tensor* stacked) {
+  const std::vector<Tensor>& tensors = list.tensors();
+  const std::shared_ptr<TensorList::ContiguousStorage>& storage =
+      list.contiguous_storage();
+  const int64 n = tensors.size();
+  if (n == 0 || storage == nullptr ||
+      n > storage->size.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  const Tensor& buffer = storage->buffer;
+  if (!HasRowsOf(buffer, list.element_dtype, element_shape)) return false;
+  const int64 row_bytes = buffer.TotalBytes() / buffer.dim_size(0);
+  const char* base = static_cast<const char*>(buffer.data());
+  for (int64 i = 0; i < n; ++i) {
+    const Tensor& t = tensors[i];
+    if (t.dtype() != buffer.dtype() || t.shape() != element_shape ||
+        t.data() != base + i * row_bytes) {
+      return false;
+    }
+  }
+  *stacked = buffer.Slice(0, n);
+  return true;
+}
+
 class EmptyTensorList : public OpKernel {
  public:
   explicit EmptyTensorList(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -171,7 +295,8 @@ REGISTER_KERNEL_BUILDER(Name("EmptyTensorList")
 
 class TensorListPushBack : public OpKernel {
  public:
-  explicit TensorListPushBack(OpKernelConstruction* c) : OpKernel(c) {
+  explicit TensorListPushBack(OpKernelConstruction* c)
+      : OpKernel(c), on_cpu_(c->device_type() == DEVICE_CPU) {
     OP_REQUIRES_OK(c, c->GetAttr("element_dtype", &element_dtype_));
   }
 
@@ -209,11 +334,16 @@ class TensorListPushBack : public OpKernel {
 
     TensorList* output_list = nullptr;
     OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
-    output_list->tensors().push_back(input);
+    if (on_cpu_) {
+      OP_REQUIRES_OK(c, PushBackContiguous(c, input, output_list));
+    } else {
+      output_list->tensors().push_back(input);
+    }
   }
 
  private:
   DataType element_dtype_;
+  bool on_cpu_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TensorListPushBack").Device(DEVICE_CPU),
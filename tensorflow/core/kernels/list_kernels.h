@@ -55,6 +55,18 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32 input_index,
                                    const TensorList& input_list,
                                    TensorList** output_list);
 
+// Appends `element` to `list`.  On CPU, when the elements of `list` have a
+// fixed shape, the element is copied to the contiguous storage of the list,
+// so that GetContiguousElements can stack the list without copying.
+Status PushBackContiguous(OpKernelContext* c, const Tensor& element,
+                          TensorList* list);
+
+// If the elements of `list` are the consecutive rows of its contiguous
+// storage, each of shape `element_shape`, sets `stacked` to those rows and
+// returns true.
+bool GetContiguousElements(const TensorList& list,
+                           const TensorShape& element_shape, Tensor* stacked);
+
 template <typename Device, typename T>
 class TensorListStack : public OpKernel {
  public:
@@ -111,6 +123,13 @@ class TensorListStack : public OpKernel {
                     "Tried to stack list which only contains uninitialized ",
                     "tensors and has a non-fully-defined element_shape: ",
                     partial_element_shape.DebugString()));
+    if (std::is_same<Device, CPUDevice>::value) {
+      Tensor stacked;
+      if (GetContiguousElements(*tensor_list, element_shape, &stacked)) {
+        c->set_output(0, stacked);
+        return;
+      }
+    }
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, tensor_list->tensors().size());
     Tensor* output;
@@ -16,16 +16,28 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <set>
 #include <string>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -301,6 +313,17 @@ inline uint64 HashScalar(const T& key) {
 
 inline uint64 HashScalar(const tstring& key) { return Hash64(key); }
 
+// Finalizer of MurmurHash3. HashScalar() is the identity for integral keys,
+// which bunches sequential ids together under linear probing.
+inline uint64 MixHash(uint64 h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
 // If the given shape is a scalar return {1} instead. Otherwise leave it alone.
 TensorShape MaybeVectorizeShape(const TensorShape& shape) {
   if (shape.dims() == 0) {
@@ -406,7 +429,10 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_matrix =
         deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
     const int64 bit_mask = num_buckets_ - 1;
-    // TODO(andreasst): parallelize using work_sharder
+    // Hash the whole batch before probing, so that the probe loop can prefetch
+    // the home buckets of the keys kFindPrefetchDistance ahead of the one it
+    // resolves instead of stalling on every bucket in turn.
+    std::vector<int64> home_buckets(num_elements);
     for (int64 i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
       if (empty_key_hash_ == key_hash &&
@@ -419,32 +445,58 @@ class MutableDenseHashTable final : public LookupInterface {
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
-      int64 bucket_index = key_hash & bit_mask;
-      int64 num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            // TODO(andreasst): check if we can get rid of SubtleMustCopy
-            // here and elsewhere in this file.
-            value_matrix(i, j) =
-                SubtleMustCopyIfIntegral(value_buckets_matrix(bucket_index, j));
-          }
-          break;
+      home_buckets[i] = key_hash & bit_mask;
+    }
+
+    const K* key_buckets_data = key_buckets_matrix.data();
+    const V* value_buckets_data = value_buckets_matrix.data();
+    const K* empty_key_data = empty_key_matrix.data();
+    std::atomic<bool> probe_failed(false);
+    auto resolve = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        if (i + kFindPrefetchDistance < end) {
+          const int64 ahead = home_buckets[i + kFindPrefetchDistance];
+          port::prefetch<port::PREFETCH_HINT_T0>(
+              &key_buckets_data[ahead * key_size]);
+          port::prefetch<port::PREFETCH_HINT_T0>(
+              &value_buckets_data[ahead * value_size]);
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+        const K* key_row = &key_matrix(i, 0);
+        int64 bucket_index = home_buckets[i];
+        int64 num_probes = 0;
+        while (true) {
+          const K* bucket_row = &key_buckets_data[bucket_index * key_size];
+          if (IsEqualKeyRow(bucket_row, key_row, key_size)) {
+            const V* bucket_values = &value_buckets_data[bucket_index *
+                                                         value_size];
+            for (int64 j = 0; j < value_size; ++j) {
+              // TODO(andreasst): check if we can get rid of SubtleMustCopy
+              // here and elsewhere in this file.
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(bucket_values[j]);
+            }
+            break;
+          }
+          if (IsEqualKeyRow(bucket_row, empty_key_data, key_size)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+            }
+            break;
+          }
+          ++num_probes;
+          bucket_index =
+              (bucket_index + num_probes) & bit_mask;  // quadratic probing
+          if (num_probes >= num_buckets_) {
+            probe_failed = true;
+            return;
           }
-          break;
-        }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable lookup");
         }
       }
+    };
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_elements,
+          kFindCostPerKey * (key_size + value_size), resolve);
+    if (probe_failed) {
+      return errors::Internal("Internal error in MutableDenseHashTable lookup");
     }
     return Status::OK();
   }
@@ -762,6 +814,31 @@ class MutableDenseHashTable final : public LookupInterface {
     return true;
   }
 
+  // Row-wise variant of IsEqualKey() for the batched Find() path. A single
+  // memcmp over the whole row lets libc compare multi-element integral keys
+  // with vector instructions.
+  static bool IsEqualKeyRow(const K* row1, const K* row2, int64 key_size) {
+    if (key_size == 1) {
+      return row1[0] == row2[0];
+    }
+    if (std::is_integral<K>::value) {
+      return std::memcmp(row1, row2, key_size * sizeof(K)) == 0;
+    }
+    for (int64 i = 0; i < key_size; ++i) {
+      if (row1[i] != row2[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // How many keys ahead of the one being resolved Find() prefetches buckets.
+  // Large enough to cover DRAM latency with a few probes per key in flight.
+  static constexpr int64 kFindPrefetchDistance = 16;
+  // Rough cost in cycles, per key and value element, of resolving one key in
+  // Find(), dominated by the cache misses on the buckets.
+  static constexpr int64 kFindCostPerKey = 100;
+
   TensorShape key_shape_;
   TensorShape value_shape_;
   float max_load_factor_;
@@ -776,157 +853,1325 @@ class MutableDenseHashTable final : public LookupInterface {
   uint64 deleted_key_hash_;
 };
 
-}  // namespace lookup
-
-// Base class for kernels that take a LookupTable handle as the 0th input.
-class LookupTableOpKernel : public OpKernel {
+// Lookup table that splits its keys over a fixed number of shards. Each shard
+// is an open-addressing table with linear probing and its own lock, so
+// operations on keys that land in different shards never contend.
+//
+// Every operation first hashes and groups its keys by shard, then takes each
+// shard lock at most once. Writers therefore only stall readers of the shard
+// they are updating, and only for that shard's slice of the batch. Large
+// batches are processed in parallel, one shard per unit of work.
+//
+// Values are scalars or vectors, as given by the value_shape attribute.
+template <class K, class V>
+class MutableShardedHashTable final : public LookupInterface {
  public:
-  explicit LookupTableOpKernel(OpKernelConstruction* ctx)
-      : OpKernel(ctx),
-        expected_input_0_(ctx->input_type(0) == DT_RESOURCE ? DT_RESOURCE
-                                                            : DT_STRING_REF) {}
+  MutableShardedHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    int64 num_shards;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "num_shards", &num_shards));
+    OP_REQUIRES(
+        ctx, num_shards > 0,
+        errors::InvalidArgument("num_shards must be positive, got: ",
+                                num_shards));
 
- protected:
-  Status GetTable(OpKernelContext* ctx, lookup::LookupInterface** table) {
-    if (expected_input_0_ == DT_RESOURCE) {
-      return GetResourceLookupTable("table_handle", ctx, table);
-    } else {
-      return GetReferenceLookupTable("table_handle", ctx, table);
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "initial_num_buckets",
+                                    &initial_num_buckets_));
+    OP_REQUIRES(ctx,
+                initial_num_buckets_ >= 4 &&
+                    (initial_num_buckets_ & (initial_num_buckets_ - 1)) == 0,
+                errors::InvalidArgument(
+                    "Number of buckets must be at least 4 and a power of 2, "
+                    "got: ",
+                    initial_num_buckets_));
+
+    OP_REQUIRES_OK(
+        ctx, GetNodeAttr(kernel->def(), "max_load_factor", &max_load_factor_));
+    OP_REQUIRES(ctx, max_load_factor_ > 0 && max_load_factor_ < 1,
+                errors::InvalidArgument(
+                    "max_load_factor must be between 0 and 1, got: ",
+                    max_load_factor_));
+
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(value_shape_) ||
+                    TensorShapeUtils::IsVector(value_shape_),
+                errors::InvalidArgument(
+                    "Default value must be a scalar or a vector, got shape ",
+                    value_shape_.DebugString()));
+    value_size_ = value_shape_.num_elements();
+
+    shards_.reserve(num_shards);
+    for (int64 s = 0; s < num_shards; ++s) {
+      shards_.emplace_back(new TableShard);
+      TableShard* shard = shards_.back().get();
+      mutex_lock l(shard->mu);
+      ResetShard(shard, initial_num_buckets_);
     }
   }
 
-  // Input 0 could be a STRING_REF or a RESOURCE
-  const DataType expected_input_0_;
-};
+  size_t size() const override {
+    size_t result = 0;
+    for (const auto& shard : shards_) {
+      tf_shared_lock l(shard->mu);
+      result += shard->num_entries;
+    }
+    return result;
+  }
 
-// Table lookup op. Perform the lookup operation on the given table.
-class LookupTableFindOp : public LookupTableOpKernel {
- public:
-  using LookupTableOpKernel::LookupTableOpKernel;
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto key_values = key.flat<K>();
+    const int64 num_keys = key_values.size();
+    auto value_matrix = value->shaped<V, 2>({num_keys, value_size_});
+    const auto default_flat = default_value.flat<V>();
 
-  void Compute(OpKernelContext* ctx) override {
-    lookup::LookupInterface* table;
-    OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
-    core::ScopedUnref unref_me(table);
+    ShardedKeys grouped;
+    GroupByShard(key_values, &grouped);
+    ForEachShard(ctx, num_keys, [&](int64 s) {
+      const TableShard& shard = *shards_[s];
+      tf_shared_lock l(shard.mu);
+      for (int64 o = grouped.offsets[s]; o < grouped.offsets[s + 1]; ++o) {
+        const int64 i = grouped.order[o];
+        const int64 bucket = FindBucket(
+            shard, SubtleMustCopyIfIntegral(key_values(i)), grouped.hashes[i]);
+        if (bucket >= 0) {
+          for (int64 j = 0; j < value_size_; ++j) {
+            value_matrix(i, j) = shard.values[bucket * value_size_ + j];
+          }
+        } else {
+          for (int64 j = 0; j < value_size_; ++j) {
+            value_matrix(i, j) = default_flat(j);
+          }
+        }
+      }
+    });
+    return Status::OK();
+  }
 
-    DataTypeVector expected_inputs = {expected_input_0_, table->key_dtype(),
-                                      table->value_dtype()};
-    DataTypeVector expected_outputs = {table->value_dtype()};
-    OP_REQUIRES_OK(ctx, ctx->MatchSignature(expected_inputs, expected_outputs));
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    const int64 num_keys = key_values.size();
+    const auto value_matrix = values.shaped<V, 2>({num_keys, value_size_});
+
+    ShardedKeys grouped;
+    GroupByShard(key_values, &grouped);
+    ForEachShard(ctx, num_keys, [&](int64 s) {
+      TableShard* shard = shards_[s].get();
+      mutex_lock l(shard->mu);
+      InsertIntoShard(shard, key_values, value_matrix, grouped, s);
+    });
+    return Status::OK();
+  }
 
-    const Tensor& key = ctx->input(1);
-    const Tensor& default_value = ctx->input(2);
-    OP_REQUIRES_OK(ctx, table->CheckFindArguments(key, default_value));
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    const auto key_values = keys.flat<K>();
+    const int64 num_keys = key_values.size();
+
+    ShardedKeys grouped;
+    GroupByShard(key_values, &grouped);
+    ForEachShard(ctx, num_keys, [&](int64 s) {
+      TableShard* shard = shards_[s].get();
+      mutex_lock l(shard->mu);
+      for (int64 o = grouped.offsets[s]; o < grouped.offsets[s + 1]; ++o) {
+        const int64 i = grouped.order[o];
+        const int64 bucket = FindBucket(
+            *shard, SubtleMustCopyIfIntegral(key_values(i)), grouped.hashes[i]);
+        if (bucket < 0) continue;
+        // Release any memory owned by the key and value, e.g. for strings.
+        shard->states[bucket] = kDeleted;
+        shard->keys[bucket] = K();
+        for (int64 j = 0; j < value_size_; ++j) {
+          shard->values[bucket * value_size_ + j] = V();
+        }
+        --shard->num_entries;
+        ++shard->num_deleted;
+      }
+    });
+    return Status::OK();
+  }
 
-    TensorShape output_shape = key.shape();
-    output_shape.RemoveLastDims(table->key_shape().dims());
-    output_shape.AppendShape(table->value_shape());
-    Tensor* out;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output("values", output_shape, &out));
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    const int64 num_keys = key_values.size();
+    const auto value_matrix = values.shaped<V, 2>({num_keys, value_size_});
+
+    ShardedKeys grouped;
+    GroupByShard(key_values, &grouped);
+    // Hold every shard lock so that concurrent readers never observe a
+    // partially restored table.
+    std::vector<mutex_lock> locks;
+    locks.reserve(shards_.size());
+    for (auto& shard : shards_) {
+      locks.emplace_back(shard->mu);
+      ResetShard(shard.get(), initial_num_buckets_);
+    }
+    ForEachShard(ctx, num_keys, [&](int64 s) {
+      InsertIntoShard(shards_[s].get(), key_values, value_matrix, grouped, s);
+    });
+    return Status::OK();
+  }
 
-    OP_REQUIRES_OK(ctx, table->Find(ctx, key, out, default_value));
+  Status ExportValues(OpKernelContext* ctx) override {
+    // Shards are always locked in index order, and every other operation
+    // holds at most one shard lock at a time, so this cannot deadlock.
+    std::vector<tf_shared_lock> locks;
+    locks.reserve(shards_.size());
+    int64 size = 0;
+    for (const auto& shard : shards_) {
+      locks.emplace_back(shard->mu);
+      size += shard->num_entries;
+    }
+
+    TensorShape values_shape({size});
+    values_shape.AppendShape(value_shape_);
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(ctx->allocate_output("values", values_shape, &values));
+
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->shaped<V, 2>({size, value_size_});
+    int64 i = 0;
+    for (const auto& shard : shards_) {
+      for (int64 bucket = 0; bucket < shard->num_buckets; ++bucket) {
+        if (shard->states[bucket] != kFull) continue;
+        keys_data(i) = shard->keys[bucket];
+        for (int64 j = 0; j < value_size_; ++j) {
+          values_data(i, j) = shard->values[bucket * value_size_ + j];
+        }
+        ++i;
+      }
+    }
+    return Status::OK();
   }
-};
 
-REGISTER_KERNEL_BUILDER(Name("LookupTableFind").Device(DEVICE_CPU),
-                        LookupTableFindOp);
-REGISTER_KERNEL_BUILDER(Name("LookupTableFindV2").Device(DEVICE_CPU),
-                        LookupTableFindOp);
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
 
-// Table insert op.
-class LookupTableInsertOp : public LookupTableOpKernel {
- public:
-  using LookupTableOpKernel::LookupTableOpKernel;
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
 
-  void Compute(OpKernelContext* ctx) override {
-    lookup::LookupInterface* table;
-    OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
-    core::ScopedUnref unref_me(table);
+  TensorShape key_shape() const final { return TensorShape(); }
 
-    DataTypeVector expected_inputs = {expected_input_0_, table->key_dtype(),
-                                      table->value_dtype()};
-    OP_REQUIRES_OK(ctx, ctx->MatchSignature(expected_inputs, {}));
+  TensorShape value_shape() const override { return value_shape_; }
 
-    const Tensor& keys = ctx->input(1);
-    const Tensor& values = ctx->input(2);
-    OP_REQUIRES_OK(ctx, table->CheckKeyAndValueTensorsForInsert(keys, values));
+  int64 MemoryUsed() const override {
+    int64 ret = sizeof(MutableShardedHashTable);
+    for (const auto& shard : shards_) {
+      tf_shared_lock l(shard->mu);
+      ret += sizeof(TableShard) +
+             shard->num_buckets *
+                 (sizeof(uint8) + sizeof(K) + value_size_ * sizeof(V));
+    }
+    return ret;
+  }
 
-    int64 memory_used_before = 0;
-    if (ctx->track_allocations()) {
-      memory_used_before = table->MemoryUsed();
+ private:
+  enum BucketState : uint8 { kEmpty = 0, kFull = 1, kDeleted = 2 };
+
+  struct TableShard {
+    mutable mutex mu;
+    int64 num_buckets TF_GUARDED_BY(mu) = 0;
+    int64 num_entries TF_GUARDED_BY(mu) = 0;
+    // Buckets left behind by Remove(). They keep probe sequences intact and
+    // are reclaimed by later inserts or dropped on rehash.
+    int64 num_deleted TF_GUARDED_BY(mu) = 0;
+    std::vector<uint8> states TF_GUARDED_BY(mu);
+    std::vector<K> keys TF_GUARDED_BY(mu);
+    // num_buckets x value_size_ values, stored row-major.
+    std::vector<V> values TF_GUARDED_BY(mu);
+  };
+
+  // The keys of one batch grouped by shard: the keys that belong to shard s
+  // are order[offsets[s]] ... order[offsets[s + 1] - 1], in batch order.
+  struct ShardedKeys {
+    std::vector<uint64> hashes;
+    std::vector<int64> order;
+    std::vector<int64> offsets;
+  };
+
+  // Batches smaller than this are not worth handing to the threadpool.
+  static constexpr int64 kMinParallelBatchSize = 1024;
+
+  uint64 HashKey(const K& key) const { return MixHash(HashScalar(key)); }
+
+  int64 ShardIndex(uint64 hash) const {
+    return static_cast<int64>((hash >> 32) % shards_.size());
+  }
+
+  void GroupByShard(typename TTypes<K>::ConstFlat key_values,
+                    ShardedKeys* grouped) const {
+    const int64 num_keys = key_values.size();
+    const int64 num_shards = shards_.size();
+    grouped->hashes.resize(num_keys);
+    grouped->order.resize(num_keys);
+    grouped->offsets.assign(num_shards + 1, 0);
+    std::vector<int64> shard_of(num_keys);
+    for (int64 i = 0; i < num_keys; ++i) {
+      grouped->hashes[i] = HashKey(SubtleMustCopyIfIntegral(key_values(i)));
+      shard_of[i] = ShardIndex(grouped->hashes[i]);
+      ++grouped->offsets[shard_of[i] + 1];
     }
-    OP_REQUIRES_OK(ctx, table->Insert(ctx, keys, values));
-    if (ctx->track_allocations()) {
-      ctx->record_persistent_memory_allocation(table->MemoryUsed() -
-                                               memory_used_before);
+    for (int64 s = 0; s < num_shards; ++s) {
+      grouped->offsets[s + 1] += grouped->offsets[s];
+    }
+    // Counting sort that keeps the batch order within each shard, so that
+    // repeated keys in one Insert keep their last value.
+    std::vector<int64> next(grouped->offsets.begin(),
+                            grouped->offsets.end() - 1);
+    for (int64 i = 0; i < num_keys; ++i) {
+      grouped->order[next[shard_of[i]]++] = i;
     }
   }
-};
-
-REGISTER_KERNEL_BUILDER(Name("LookupTableInsert").Device(DEVICE_CPU),
-                        LookupTableInsertOp);
-REGISTER_KERNEL_BUILDER(Name("LookupTableInsertV2").Device(DEVICE_CPU),
-                        LookupTableInsertOp);
 
-// Table remove op.
-class LookupTableRemoveOp : public LookupTableOpKernel {
- public:
-  using LookupTableOpKernel::LookupTableOpKernel;
+  // Runs fn(shard_index) for every shard, in parallel for large batches.
+  template <typename Fn>
+  void ForEachShard(OpKernelContext* ctx, int64 num_keys, const Fn& fn) const {
+    const int64 num_shards = shards_.size();
+    auto work = [&fn](int64 begin, int64 end) {
+      for (int64 s = begin; s < end; ++s) {
+        fn(s);
+      }
+    };
+    if (num_shards == 1 || num_keys < kMinParallelBatchSize) {
+      work(0, num_shards);
+      return;
+    }
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_shard =
+        (num_keys / num_shards + 1) * (value_size_ + 1) * 20;
+    Shard(worker_threads->num_threads, worker_threads->workers, num_shards,
+          cost_per_shard, work);
+  }
 
-  void Compute(OpKernelContext* ctx) override {
-    lookup::LookupInterface* table;
-    OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
-    core::ScopedUnref unref_me(table);
+  void ResetShard(TableShard* shard, int64 num_buckets) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    shard->num_buckets = num_buckets;
+    shard->num_entries = 0;
+    shard->num_deleted = 0;
+    shard->states.assign(num_buckets, kEmpty);
+    shard->keys.assign(num_buckets, K());
+    shard->values.assign(num_buckets * value_size_, V());
+  }
 
-    DataTypeVector expected_inputs = {expected_input_0_, table->key_dtype()};
-    OP_REQUIRES_OK(ctx, ctx->MatchSignature(expected_inputs, {}));
+  // Returns the bucket that holds `key`, or -1 if the shard does not contain
+  // it.
+  int64 FindBucket(const TableShard& shard, const K& key, uint64 hash) const
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) {
+    const int64 bit_mask = shard.num_buckets - 1;
+    int64 bucket = hash & bit_mask;
+    for (int64 num_probes = 0; num_probes < shard.num_buckets; ++num_probes) {
+      const uint8 state = shard.states[bucket];
+      if (state == kEmpty) {
+        return -1;
+      }
+      if (state == kFull && shard.keys[bucket] == key) {
+        return bucket;
+      }
+      bucket = (bucket + 1) & bit_mask;
+    }
+    return -1;
+  }
 
-    const Tensor& key = ctx->input(1);
-    OP_REQUIRES_OK(ctx, table->CheckKeyTensorForRemove(key));
+  // Grows the shard, dropping deleted buckets, so that `num_new` more entries
+  // fit under the maximum load factor.
+  void ReserveInShard(TableShard* shard, int64 num_new) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    // As in MutableDenseHashTable, assume every key is new. Deleted buckets
+    // count towards the load because they lengthen probe sequences.
+    if (shard->num_entries + shard->num_deleted + num_new <=
+        shard->num_buckets * max_load_factor_) {
+      return;
+    }
+    const int64 pending_num_entries = shard->num_entries + num_new;
+    int64 new_num_buckets = shard->num_buckets;
+    while (pending_num_entries > new_num_buckets * max_load_factor_) {
+      new_num_buckets <<= 1;
+    }
+    std::vector<uint8> old_states = std::move(shard->states);
+    std::vector<K> old_keys = std::move(shard->keys);
+    std::vector<V> old_values = std::move(shard->values);
+    const int64 old_num_buckets = shard->num_buckets;
+    ResetShard(shard, new_num_buckets);
+    for (int64 b = 0; b < old_num_buckets; ++b) {
+      if (old_states[b] != kFull) continue;
+      const int64 bucket = FreeBucket(*shard, HashKey(old_keys[b]));
+      shard->states[bucket] = kFull;
+      shard->keys[bucket] = std::move(old_keys[b]);
+      for (int64 j = 0; j < value_size_; ++j) {
+        shard->values[bucket * value_size_ + j] =
+            std::move(old_values[b * value_size_ + j]);
+      }
+      ++shard->num_entries;
+    }
+  }
 
-    int64 memory_used_before = 0;
-    if (ctx->track_allocations()) {
-      memory_used_before = table->MemoryUsed();
+  // Returns the first empty bucket on the probe sequence of `hash`. Only
+  // valid on a shard without deleted buckets, e.g. while rehashing.
+  int64 FreeBucket(const TableShard& shard, uint64 hash) const
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) {
+    const int64 bit_mask = shard.num_buckets - 1;
+    int64 bucket = hash & bit_mask;
+    while (shard.states[bucket] != kEmpty) {
+      bucket = (bucket + 1) & bit_mask;
     }
-    OP_REQUIRES_OK(ctx, table->Remove(ctx, key));
-    if (ctx->track_allocations()) {
-      ctx->record_persistent_memory_allocation(table->MemoryUsed() -
-                                               memory_used_before);
+    return bucket;
+  }
+
+  void InsertIntoShard(TableShard* shard,
+                       typename TTypes<K>::ConstFlat key_values,
+                       typename TTypes<V, 2>::ConstTensor value_matrix,
+                       const ShardedKeys& grouped, int64 s) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    const int64 begin = grouped.offsets[s];
+    const int64 end = grouped.offsets[s + 1];
+    if (begin == end) return;
+    ReserveInShard(shard, end - begin);
+    const int64 bit_mask = shard->num_buckets - 1;
+    for (int64 o = begin; o < end; ++o) {
+      const int64 i = grouped.order[o];
+      const K key = SubtleMustCopyIfIntegral(key_values(i));
+      int64 bucket = grouped.hashes[i] & bit_mask;
+      int64 first_deleted = -1;
+      while (true) {
+        const uint8 state = shard->states[bucket];
+        if (state == kFull && shard->keys[bucket] == key) {
+          break;
+        }
+        if (state == kDeleted && first_deleted < 0) {
+          first_deleted = bucket;
+        }
+        if (state == kEmpty) {
+          if (first_deleted >= 0) {
+            bucket = first_deleted;
+            --shard->num_deleted;
+          }
+          shard->states[bucket] = kFull;
+          shard->keys[bucket] = key;
+          ++shard->num_entries;
+          break;
+        }
+        bucket = (bucket + 1) & bit_mask;
+      }
+      for (int64 j = 0; j < value_size_; ++j) {
+        shard->values[bucket * value_size_ + j] =
+            SubtleMustCopyIfIntegral(value_matrix(i, j));
+      }
     }
   }
-};
 
-REGISTER_KERNEL_BUILDER(Name("LookupTableRemoveV2").Device(DEVICE_CPU),
-                        LookupTableRemoveOp);
+  TensorShape value_shape_;
+  int64 value_size_;
+  int64 initial_num_buckets_;
+  float max_load_factor_;
+  std::vector<std::unique_ptr<TableShard>> shards_;
+};
 
-// Op that returns the size of the given table.
-class LookupTableSizeOp : public LookupTableOpKernel {
+// Append-only file of fixed-size value records that backs the cold tier of
+// MutableTieredHashTable. The index from keys to record offsets stays in
+// memory. Writing a key appends a new record and leaves the previous one, if
+// any, as garbage; Compact() reclaims it by copying the live records into a
+// fresh file once garbage outnumbers them.
+//
+// Not thread safe; the owning table serializes access.
+template <class K>
+class TieredColdStore {
  public:
-  using LookupTableOpKernel::LookupTableOpKernel;
-
-  void Compute(OpKernelContext* ctx) override {
-    lookup::LookupInterface* table;
-    OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
-    core::ScopedUnref unref_me(table);
+  TieredColdStore(Env* env, const string& path, int64 record_size)
+      : env_(env), path_(path), record_size_(record_size) {}
+
+  ~TieredColdStore() {
+    reader_.reset();
+    if (writer_ != nullptr) {
+      writer_->Close().IgnoreError();
+      env_->DeleteFile(CurrentPath()).IgnoreError();
+    }
+  }
 
-    Tensor* out;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output("size", TensorShape({}), &out));
-    out->flat<int64>().setConstant(table->size());
+  // Creates an empty backing file, discarding any previous contents.
+  Status Reset() {
+    reader_.reset();
+    if (writer_ != nullptr) {
+      TF_RETURN_IF_ERROR(writer_->Close());
+      TF_RETURN_IF_ERROR(env_->DeleteFile(CurrentPath()));
+      writer_.reset();
+    }
+    index_.clear();
+    file_size_ = 0;
+    num_garbage_ = 0;
+    ++generation_;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(CurrentPath(), &writer_));
+    // Opening an empty file for reading is fine: reads only ever cover records
+    // that were appended and flushed before.
+    return env_->NewRandomAccessFile(CurrentPath(), &reader_);
   }
-};
 
-REGISTER_KERNEL_BUILDER(Name("LookupTableSize").Device(DEVICE_CPU),
-                        LookupTableSizeOp);
-REGISTER_KERNEL_BUILDER(Name("LookupTableSizeV2").Device(DEVICE_CPU),
-                        LookupTableSizeOp);
+  size_t size() const { return index_.size(); }
 
-// Op that outputs tensors of all keys and all values.
-class LookupTableExportOp : public LookupTableOpKernel {
- public:
-  using LookupTableOpKernel::LookupTableOpKernel;
+  // Appends `record` (record_size_ bytes) as the value of `key`.
+  Status Write(const K& key, const char* record) {
+    TF_RETURN_IF_ERROR(writer_->Append(StringPiece(record, record_size_)));
+    auto result = index_.insert({key, file_size_});
+    if (!result.second) {
+      result.first->second = file_size_;
+      ++num_garbage_;
+    }
+    file_size_ += record_size_;
+    unflushed_ = true;
+    return Status::OK();
+  }
 
-  void Compute(OpKernelContext* ctx) override {
-    lookup::LookupInterface* table;
+  // Reads the record of `key` into `record`. Sets *found to false, and leaves
+  // `record` alone, if `key` is not in the store.
+  Status Read(const K& key, char* record, bool* found) {
+    auto it = index_.find(key);
+    *found = it != index_.end();
+    if (!*found) {
+      return Status::OK();
+    }
+    return ReadAt(it->second, record);
+  }
+
+  // Drops `key` from the store. Returns whether it was present.
+  bool Erase(const K& key) {
+    if (index_.erase(key) == 0) {
+      return false;
+    }
+    ++num_garbage_;
+    return true;
+  }
+
+  // Calls fn(key, record) for every live record.
+  template <typename Fn>
+  Status ForEach(const Fn& fn) {
+    std::unique_ptr<char[]> record(new char[record_size_]);
+    for (const auto& entry : index_) {
+      TF_RETURN_IF_ERROR(ReadAt(entry.second, record.get()));
+      fn(entry.first, record.get());
+    }
+    return Status::OK();
+  }
+
+  // Rewrites the live records into a new file if at least half of the current
+  // one is garbage.
+  Status MaybeCompact() {
+    if (num_garbage_ < kMinGarbageToCompact ||
+        num_garbage_ < static_cast<int64>(index_.size())) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(Flush());
+    const string old_path = CurrentPath();
+    ++generation_;
+    std::unique_ptr<WritableFile> writer;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(CurrentPath(), &writer));
+    std::unique_ptr<char[]> record(new char[record_size_]);
+    uint64 offset = 0;
+    for (auto& entry : index_) {
+      TF_RETURN_IF_ERROR(ReadAt(entry.second, record.get()));
+      TF_RETURN_IF_ERROR(
+          writer->Append(StringPiece(record.get(), record_size_)));
+      entry.second = offset;
+      offset += record_size_;
+    }
+    TF_RETURN_IF_ERROR(writer->Flush());
+    reader_.reset();
+    TF_RETURN_IF_ERROR(writer_->Close());
+    TF_RETURN_IF_ERROR(env_->DeleteFile(old_path));
+    writer_ = std::move(writer);
+    file_size_ = offset;
+    num_garbage_ = 0;
+    unflushed_ = false;
+    return env_->NewRandomAccessFile(CurrentPath(), &reader_);
+  }
+
+  int64 MemoryUsed() const {
+    return index_.size() * (sizeof(K) + sizeof(uint64));
+  }
+
+ private:
+  // Compacting tiny files is not worth the extra file.
+  static constexpr int64 kMinGarbageToCompact = 1024;
+
+  string CurrentPath() const {
+    return strings::StrCat(path_, "-", generation_);
+  }
+
+  Status Flush() {
+    if (!unflushed_) {
+      return Status::OK();
+    }
+    unflushed_ = false;
+    return writer_->Flush();
+  }
+
+  Status ReadAt(uint64 offset, char* record) {
+    TF_RETURN_IF_ERROR(Flush());
+    StringPiece result;
+    TF_RETURN_IF_ERROR(reader_->Read(offset, record_size_, &result, record));
+    if (result.size() != record_size_) {
+      return errors::DataLoss("Truncated record at offset ", offset, " in ",
+                              CurrentPath());
+    }
+    if (result.data() != record) {
+      std::memmove(record, result.data(), record_size_);
+    }
+    return Status::OK();
+  }
+
+  Env* const env_;
+  const string path_;
+  const int64 record_size_;
+  int generation_ = 0;
+  std::unique_ptr<WritableFile> writer_;
+  std::unique_ptr<RandomAccessFile> reader_;
+  uint64 file_size_ = 0;
+  int64 num_garbage_ = 0;
+  bool unflushed_ = false;
+  absl::flat_hash_map<K, uint64> index_;
+};
+
+// Lookup table for tables larger than host memory. At most hot_capacity
+// entries live in an in-memory hot tier; the least recently ("lru") or least
+// frequently ("lfu") used entries beyond that are evicted to a file-backed
+// cold tier. Finding a cold key promotes it back into the hot tier, which may
+// in turn evict another entry.
+//
+// Export reads the cold tier straight from its file into the output tensors,
+// so exporting does not pull the table into memory. Hits, misses, promotions
+// and evictions are counted under /tensorflow/core/tiered_lookup_table.
+//
+// Values are scalars or vectors of a numeric type. Since lookups reorder the
+// tiers, every operation takes the table lock exclusively.
+template <class K, class V>
+class MutableTieredHashTable final : public LookupInterface {
+ public:
+  MutableTieredHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(value_shape_) ||
+                    TensorShapeUtils::IsVector(value_shape_),
+                errors::InvalidArgument(
+                    "Default value must be a scalar or a vector, got shape ",
+                    value_shape_.DebugString()));
+    value_size_ = value_shape_.num_elements();
+
+    OP_REQUIRES_OK(
+        ctx, GetNodeAttr(kernel->def(), "hot_capacity", &hot_capacity_));
+    OP_REQUIRES(ctx, hot_capacity_ > 0,
+                errors::InvalidArgument("hot_capacity must be positive, got: ",
+                                        hot_capacity_));
+
+    string eviction_policy;
+    OP_REQUIRES_OK(
+        ctx, GetNodeAttr(kernel->def(), "eviction_policy", &eviction_policy));
+    lfu_ = eviction_policy == "lfu";
+
+    string cold_storage_dir;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "cold_storage_dir",
+                                    &cold_storage_dir));
+    Env* env = ctx->env();
+    string path;
+    if (cold_storage_dir.empty()) {
+      OP_REQUIRES(ctx, env->LocalTempFilename(&path),
+                  errors::Internal("Failed to create a temporary file for the "
+                                   "cold tier of a tiered lookup table"));
+    } else {
+      OP_REQUIRES_OK(ctx, env->RecursivelyCreateDir(cold_storage_dir));
+      path = io::JoinPath(cold_storage_dir,
+                          strings::StrCat("tiered_lookup_table_",
+                                          random::New64(), ".cold"));
+    }
+    cold_.reset(new TieredColdStore<K>(env, path, value_size_ * sizeof(V)));
+    mutex_lock l(mu_);
+    OP_REQUIRES_OK(ctx, cold_->Reset());
+  }
+
+  size_t size() const override {
+    mutex_lock l(mu_);
+    return hot_.size() + cold_->size();
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto key_values = key.flat<K>();
+    const int64 num_keys = key_values.size();
+    auto value_matrix = value->shaped<V, 2>({num_keys, value_size_});
+    const auto default_flat = default_value.flat<V>();
+
+    int64 num_hot_hits = 0;
+    int64 num_cold_hits = 0;
+    int64 num_evictions = 0;
+    ValueArray record(value_size_);
+    mutex_lock l(mu_);
+    for (int64 i = 0; i < num_keys; ++i) {
+      const K k = SubtleMustCopyIfIntegral(key_values(i));
+      auto it = hot_.find(k);
+      if (it == hot_.end()) {
+        bool found;
+        TF_RETURN_IF_ERROR(
+            cold_->Read(k, reinterpret_cast<char*>(record.data()), &found));
+        if (!found) {
+          for (int64 j = 0; j < value_size_; ++j) {
+            value_matrix(i, j) = default_flat(j);
+          }
+          continue;
+        }
+        ++num_cold_hits;
+        cold_->Erase(k);
+        it = hot_.insert({k, HotEntry{record, MinFrequency(), 0}}).first;
+      } else {
+        ++num_hot_hits;
+        eviction_order_.erase(OrderKey(k, it->second));
+      }
+      Touch(k, &it->second);
+      for (int64 j = 0; j < value_size_; ++j) {
+        value_matrix(i, j) = it->second.value[j];
+      }
+      // The entry just found has the latest access and at least the minimum
+      // frequency, so it is never the one evicted here.
+      TF_RETURN_IF_ERROR(EvictToCapacity(&num_evictions));
+    }
+    TF_RETURN_IF_ERROR(cold_->MaybeCompact());
+
+    metrics::GetTieredLookupTableCounter("hot_hit")->IncrementBy(num_hot_hits);
+    metrics::GetTieredLookupTableCounter("cold_hit")
+        ->IncrementBy(num_cold_hits);
+    metrics::GetTieredLookupTableCounter("miss")->IncrementBy(
+        num_keys - num_hot_hits - num_cold_hits);
+    metrics::GetTieredLookupTableCounter("promotion")
+        ->IncrementBy(num_cold_hits);
+    metrics::GetTieredLookupTableCounter("eviction")
+        ->IncrementBy(num_evictions);
+    return Status::OK();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    mutex_lock l(mu_);
+    return DoInsert(keys, values);
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    const auto key_values = keys.flat<K>();
+    mutex_lock l(mu_);
+    for (int64 i = 0; i < key_values.size(); ++i) {
+      const K k = SubtleMustCopyIfIntegral(key_values(i));
+      auto it = hot_.find(k);
+      if (it != hot_.end()) {
+        eviction_order_.erase(OrderKey(k, it->second));
+        hot_.erase(it);
+      } else {
+        cold_->Erase(k);
+      }
+    }
+    return cold_->MaybeCompact();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    mutex_lock l(mu_);
+    hot_.clear();
+    eviction_order_.clear();
+    TF_RETURN_IF_ERROR(cold_->Reset());
+    return DoInsert(keys, values);
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    mutex_lock l(mu_);
+    const int64 size = hot_.size() + cold_->size();
+    TensorShape values_shape({size});
+    values_shape.AppendShape(value_shape_);
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(ctx->allocate_output("values", values_shape, &values));
+
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->shaped<V, 2>({size, value_size_});
+    int64 i = 0;
+    for (const auto& entry : hot_) {
+      keys_data(i) = entry.first;
+      for (int64 j = 0; j < value_size_; ++j) {
+        values_data(i, j) = entry.second.value[j];
+      }
+      ++i;
+    }
+    return cold_->ForEach([&](const K& key, const char* record) {
+      keys_data(i) = key;
+      std::memcpy(values_data.data() + i * value_size_, record,
+                  value_size_ * sizeof(V));
+      ++i;
+    });
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64 MemoryUsed() const override {
+    mutex_lock l(mu_);
+    const int64 hot_entry_size =
+        2 * sizeof(K) + sizeof(HotEntry) + value_size_ * sizeof(V);
+    return sizeof(MutableTieredHashTable) + hot_.size() * hot_entry_size +
+           cold_->MemoryUsed();
+  }
+
+ private:
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+
+  struct HotEntry {
+    ValueArray value;
+    // Number of accesses, for LFU.
+    uint64 frequency;
+    // Logical time of the last access, for LRU and to break LFU ties.
+    uint64 last_access;
+  };
+
+  // Entries are evicted in ascending order of (priority, last_access).
+  typedef std::tuple<uint64, uint64, K> EvictionKey;
+
+  EvictionKey OrderKey(const K& key, const HotEntry& entry) const {
+    return std::make_tuple(lfu_ ? entry.frequency : entry.last_access,
+                           entry.last_access, key);
+  }
+
+  // Initial frequency of entries entering the hot tier. Starting LFU entries
+  // at the current minimum instead of at zero keeps a promoted key from being
+  // the next victim, which would bounce it straight back to the cold tier.
+  uint64 MinFrequency() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (!lfu_ || eviction_order_.empty()) {
+      return 0;
+    }
+    return std::get<0>(*eviction_order_.begin());
+  }
+
+  // Records an access to the hot entry of `key`, which must not be in
+  // eviction_order_.
+  void Touch(const K& key, HotEntry* entry) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    ++entry->frequency;
+    entry->last_access = ++clock_;
+    eviction_order_.insert(OrderKey(key, *entry));
+  }
+
+  // Moves entries to the cold tier until the hot tier fits hot_capacity_.
+  Status EvictToCapacity(int64* num_evictions)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (static_cast<int64>(hot_.size()) > hot_capacity_) {
+      auto victim = eviction_order_.begin();
+      const K& key = std::get<2>(*victim);
+      auto it = hot_.find(key);
+      TF_RETURN_IF_ERROR(cold_->Write(
+          key, reinterpret_cast<const char*>(it->second.value.data())));
+      hot_.erase(it);
+      eviction_order_.erase(victim);
+      ++*num_evictions;
+    }
+    return Status::OK();
+  }
+
+  Status DoInsert(const Tensor& keys, const Tensor& values)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const auto key_values = keys.flat<K>();
+    const int64 num_keys = key_values.size();
+    const auto value_matrix = values.shaped<V, 2>({num_keys, value_size_});
+    int64 num_evictions = 0;
+    for (int64 i = 0; i < num_keys; ++i) {
+      const K k = SubtleMustCopyIfIntegral(key_values(i));
+      auto result = hot_.insert(
+          {k, HotEntry{ValueArray(value_size_), MinFrequency(), 0}});
+      HotEntry& entry = result.first->second;
+      if (result.second) {
+        // A new hot entry supersedes any cold copy of the key.
+        cold_->Erase(k);
+      } else {
+        eviction_order_.erase(OrderKey(k, entry));
+      }
+      for (int64 j = 0; j < value_size_; ++j) {
+        entry.value[j] = SubtleMustCopyIfIntegral(value_matrix(i, j));
+      }
+      Touch(k, &entry);
+      TF_RETURN_IF_ERROR(EvictToCapacity(&num_evictions));
+    }
+    metrics::GetTieredLookupTableCounter("eviction")
+        ->IncrementBy(num_evictions);
+    return cold_->MaybeCompact();
+  }
+
+  TensorShape value_shape_;
+  int64 value_size_;
+  int64 hot_capacity_;
+  bool lfu_;
+  mutable mutex mu_;
+  uint64 clock_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<K, HotEntry> hot_ TF_GUARDED_BY(mu_);
+  std::set<EvictionKey> eviction_order_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<TieredColdStore<K>> cold_ TF_GUARDED_BY(mu_);
+};
+
+// Count-min sketch of key frequencies with saturating counters. All counters
+// are halved after every kAgingFactor * width increments, so the estimates
+// follow recent traffic and keys that stop occurring lose their credit.
+template <class K>
+class CountMinSketch {
+ public:
+  CountMinSketch(int64 width, int64 depth)
+      : width_(width), depth_(depth), counters_(width * depth, 0) {}
+
+  // Records one occurrence of `key` and returns the estimated number of its
+  // occurrences, including this one.
+  uint32 Increment(const K& key) {
+    const uint64 hash = MixHash(HashScalar(key));
+    // Derives the hash of each row from the two halves of one 64-bit hash.
+    const uint32 h1 = static_cast<uint32>(hash);
+    const uint32 h2 = static_cast<uint32>(hash >> 32) | 1;
+    uint32 estimate = std::numeric_limits<uint32>::max();
+    for (int64 d = 0; d < depth_; ++d) {
+      const uint32 column = (h1 + static_cast<uint32>(d) * h2) % width_;
+      uint32& counter = counters_[d * width_ + column];
+      if (counter < std::numeric_limits<uint32>::max()) {
+        ++counter;
+      }
+      estimate = std::min(estimate, counter);
+    }
+    if (++num_increments_ >= kAgingFactor * width_) {
+      for (uint32& counter : counters_) {
+        counter >>= 1;
+      }
+      num_increments_ = 0;
+    }
+    return estimate;
+  }
+
+  int64 MemoryUsed() const { return counters_.size() * sizeof(uint32); }
+
+ private:
+  static constexpr int64 kAgingFactor = 10;
+
+  const int64 width_;
+  const int64 depth_;
+  std::vector<uint32> counters_;
+  int64 num_increments_ = 0;
+};
+
+// Mutable hash table that bounds its growth on streams of new keys. A key that
+// is not in the table is only admitted once it has been inserted
+// `min_frequency` times, as estimated by a count-min sketch; earlier inserts
+// of the key are dropped. The table also records the step of the last lookup
+// or insert of every entry, so that Evict() can remove the entries that have
+// been idle for a number of steps. The table counts one step per Insert call,
+// which matches one training step when the table is updated once per step.
+//
+// Restored entries are admitted unconditionally. The sketch is not part of
+// the exported state.
+template <class K, class V>
+class MutableAdmissionHashTable final : public LookupInterface {
+ public:
+  MutableAdmissionHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(value_shape_) ||
+                    TensorShapeUtils::IsVector(value_shape_),
+                errors::InvalidArgument(
+                    "Default value must be a scalar or a vector, got shape ",
+                    value_shape_.DebugString()));
+    value_size_ = value_shape_.num_elements();
+
+    OP_REQUIRES_OK(
+        ctx, GetNodeAttr(kernel->def(), "min_frequency", &min_frequency_));
+    int64 sketch_width;
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "sketch_width", &sketch_width));
+    int64 sketch_depth;
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "sketch_depth", &sketch_depth));
+    if (min_frequency_ > 1) {
+      sketch_.reset(new CountMinSketch<K>(sketch_width, sketch_depth));
+    }
+  }
+
+  size_t size() const override {
+    tf_shared_lock l(mu_);
+    return table_.size();
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto key_values = key.flat<K>();
+    const int64 num_keys = key_values.size();
+    auto value_matrix = value->shaped<V, 2>({num_keys, value_size_});
+    const auto default_flat = default_value.flat<V>();
+
+    tf_shared_lock l(mu_);
+    for (int64 i = 0; i < num_keys; ++i) {
+      auto it = table_.find(SubtleMustCopyIfIntegral(key_values(i)));
+      if (it == table_.end()) {
+        for (int64 j = 0; j < value_size_; ++j) {
+          value_matrix(i, j) = default_flat(j);
+        }
+        continue;
+      }
+      it->second.last_access.store(step_, std::memory_order_relaxed);
+      for (int64 j = 0; j < value_size_; ++j) {
+        value_matrix(i, j) = it->second.value[j];
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    const int64 num_keys = key_values.size();
+    const auto value_matrix = values.shaped<V, 2>({num_keys, value_size_});
+
+    int64 num_admitted = 0;
+    int64 num_rejected = 0;
+    mutex_lock l(mu_);
+    ++step_;
+    for (int64 i = 0; i < num_keys; ++i) {
+      const K k = SubtleMustCopyIfIntegral(key_values(i));
+      auto it = table_.find(k);
+      if (it == table_.end()) {
+        if (sketch_ != nullptr && sketch_->Increment(k) < min_frequency_) {
+          ++num_rejected;
+          continue;
+        }
+        ++num_admitted;
+        it = EmplaceEntry(k);
+      }
+      SetEntry(value_matrix, i, &it->second);
+    }
+    metrics::GetLookupTableAdmissionCounter("admitted")
+        ->IncrementBy(num_admitted);
+    metrics::GetLookupTableAdmissionCounter("rejected")
+        ->IncrementBy(num_rejected);
+    return Status::OK();
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    const auto key_values = keys.flat<K>();
+
+    mutex_lock l(mu_);
+    for (int64 i = 0; i < key_values.size(); ++i) {
+      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
+    }
+    return Status::OK();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    const int64 num_keys = key_values.size();
+    const auto value_matrix = values.shaped<V, 2>({num_keys, value_size_});
+
+    mutex_lock l(mu_);
+    table_.clear();
+    for (int64 i = 0; i < num_keys; ++i) {
+      auto it = EmplaceEntry(SubtleMustCopyIfIntegral(key_values(i)));
+      SetEntry(value_matrix, i, &it->second);
+    }
+    return Status::OK();
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    tf_shared_lock l(mu_);
+    const int64 size = table_.size();
+
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TensorShape values_shape({size});
+    values_shape.AppendShape(value_shape_);
+    TF_RETURN_IF_ERROR(ctx->allocate_output("values", values_shape, &values));
+
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->shaped<V, 2>({size, value_size_});
+    int64 i = 0;
+    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
+      keys_data(i) = it->first;
+      for (int64 j = 0; j < value_size_; ++j) {
+        values_data(i, j) = it->second.value[j];
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Evict(OpKernelContext* ctx, int64 max_idle_steps,
+               int64* num_evicted) override {
+    if (max_idle_steps < 0) {
+      return errors::InvalidArgument(
+          "max_idle_steps must be non-negative, got: ", max_idle_steps);
+    }
+    *num_evicted = 0;
+    mutex_lock l(mu_);
+    for (auto it = table_.begin(); it != table_.end();) {
+      if (step_ - it->second.last_access.load(std::memory_order_relaxed) >
+          max_idle_steps) {
+        it = table_.erase(it);
+        ++*num_evicted;
+      } else {
+        ++it;
+      }
+    }
+    metrics::GetLookupTableAdmissionCounter("evicted")
+        ->IncrementBy(*num_evicted);
+    return Status::OK();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64 MemoryUsed() const override {
+    tf_shared_lock l(mu_);
+    const int64 sketch_size = sketch_ == nullptr ? 0 : sketch_->MemoryUsed();
+    return sizeof(MutableAdmissionHashTable) + sketch_size +
+           table_.size() * (sizeof(K) + sizeof(Entry));
+  }
+
+ private:
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+
+  struct Entry {
+    Entry() : last_access(0) {}
+
+    ValueArray value;
+    // Step of the last lookup or insert. Lookups update it while holding the
+    // table lock in shared mode.
+    std::atomic<int64> last_access;
+  };
+
+  typedef std::unordered_map<K, Entry> Table;
+
+  typename Table::iterator EmplaceEntry(const K& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return table_
+        .emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                 std::forward_as_tuple())
+        .first;
+  }
+
+  void SetEntry(const typename TTypes<V, 2>::ConstTensor& values, int64 row,
+                Entry* entry) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    entry->value.resize(value_size_);
+    for (int64 j = 0; j < value_size_; ++j) {
+      entry->value[j] = SubtleMustCopyIfIntegral(values(row, j));
+    }
+    entry->last_access.store(step_, std::memory_order_relaxed);
+  }
+
+  TensorShape value_shape_;
+  int64 value_size_;
+  int64 min_frequency_;
+  mutable mutex mu_;
+  int64 step_ TF_GUARDED_BY(mu_) = 0;
+  Table table_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<CountMinSketch<K>> sketch_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace lookup
+
+// Base class for kernels that take a LookupTable handle as the 0th input.
+class LookupTableOpKernel : public OpKernel {
+ public:
+  explicit LookupTableOpKernel(OpKernelConstruction* ctx)
+      : OpKernel(ctx),
+        expected_input_0_(ctx->input_type(0) == DT_RESOURCE ? DT_RESOURCE
+                                                            : DT_STRING_REF) {}
+
+ protected:
+  Status GetTable(OpKernelContext* ctx, lookup::LookupInterface** table) {
+    if (expected_input_0_ == DT_RESOURCE) {
+      return GetResourceLookupTable("table_handle", ctx, table);
+    } else {
+      return GetReferenceLookupTable("table_handle", ctx, table);
+    }
+  }
+
+  // Input 0 could be a STRING_REF or a RESOURCE
+  const DataType expected_input_0_;
+};
+
+// Table lookup op. Perform the lookup operation on the given table.
+class LookupTableFindOp : public LookupTableOpKernel {
+ public:
+  using LookupTableOpKernel::LookupTableOpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    lookup::LookupInterface* table;
+    OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
+    core::ScopedUnref unref_me(table);
+
+    DataTypeVector expected_inputs = {expected_input_0_, table->key_dtype(),
+                                      table->value_dtype()};
+    DataTypeVector expected_outputs = {table->value_dtype()};
+    OP_REQUIRES_OK(ctx, ctx->MatchSignature(expected_inputs, expected_outputs));
+
+    const Tensor& key = ctx->input(1);
+    const Tensor& default_value = ctx->input(2);
+    OP_REQUIRES_OK(ctx, table->CheckFindArguments(key, default_value));
+
+    TensorShape output_shape = key.shape();
+    output_shape.RemoveLastDims(table->key_shape().dims());
+    output_shape.AppendShape(table->value_shape());
+    Tensor* out;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output("values", output_shape, &out));
+
+    OP_REQUIRES_OK(ctx, table->Find(ctx, key, out, default_value));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("LookupTableFind").Device(DEVICE_CPU),
+                        LookupTableFindOp);
+REGISTER_KERNEL_BUILDER(Name("LookupTableFindV2").Device(DEVICE_CPU),
+                        LookupTableFindOp);
+
+// Table insert op.
+class LookupTableInsertOp : public LookupTableOpKernel {
+ public:
+  using LookupTableOpKernel::LookupTableOpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    lookup::LookupInterface* table;
+    OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
+    core::ScopedUnref unref_me(table);
+
+    DataTypeVector expected_inputs = {expected_input_0_, table->key_dtype(),
+                                      table->value_dtype()};
+    OP_REQUIRES_OK(ctx, ctx->MatchSignature(expected_inputs, {}));
+
+    const Tensor& keys = ctx->input(1);
+    const Tensor& values = ctx->input(2);
+    OP_REQUIRES_OK(ctx, table->CheckKeyAndValueTensorsForInsert(keys, values));
+
+    int64 memory_used_before = 0;
+    if (ctx->track_allocations()) {
+      memory_used_before = table->MemoryUsed();
+    }
+    OP_REQUIRES_OK(ctx, table->Insert(ctx, keys, values));
+    if (ctx->track_allocations()) {
+      ctx->record_persistent_memory_allocation(table->MemoryUsed() -
+                                               memory_used_before);
+    }
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("LookupTableInsert").Device(DEVICE_CPU),
+                        LookupTableInsertOp);
+REGISTER_KERNEL_BUILDER(Name("LookupTableInsertV2").Device(DEVICE_CPU),
+                        LookupTableInsertOp);
+
+// Table remove op.
+class LookupTableRemoveOp : public LookupTableOpKernel {
+ public:
+  using LookupTableOpKernel::LookupTableOpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    lookup::LookupInterface* table;
+    OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
+    core::ScopedUnref unref_me(table);
+
+    DataTypeVector expected_inputs = {expected_input_0_, table->key_dtype()};
+    OP_REQUIRES_OK(ctx, ctx->MatchSignature(expected_inputs, {}));
+
+    const Tensor& key = ctx->input(1);
+    OP_REQUIRES_OK(ctx, table->CheckKeyTensorForRemove(key));
+
+    int64 memory_used_before = 0;
+    if (ctx->track_allocations()) {
+      memory_used_before = table->MemoryUsed();
+    }
+    OP_REQUIRES_OK(ctx, table->Remove(ctx, key));
+    if (ctx->track_allocations()) {
+      ctx->record_persistent_memory_allocation(table->MemoryUsed() -
+                                               memory_used_before);
+    }
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("LookupTableRemoveV2").Device(DEVICE_CPU),
+                        LookupTableRemoveOp);
+
+// Table evict op. Removes the entries that have been idle for longer than the
+// given number of steps.
+class LookupTableEvictOp : public LookupTableOpKernel {
+ public:
+  using LookupTableOpKernel::LookupTableOpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    lookup::LookupInterface* table;
+    OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
+    core::ScopedUnref unref_me(table);
+
+    const Tensor& max_idle_steps = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(max_idle_steps.shape()),
+                errors::InvalidArgument("max_idle_steps must be a scalar, got ",
+                                        max_idle_steps.shape().DebugString()));
+
+    int64 memory_used_before = 0;
+    if (ctx->track_allocations()) {
+      memory_used_before = table->MemoryUsed();
+    }
+    int64 num_evicted;
+    OP_REQUIRES_OK(ctx, table->Evict(ctx, max_idle_steps.scalar<int64>()(),
+                                     &num_evicted));
+    if (ctx->track_allocations()) {
+      ctx->record_persistent_memory_allocation(table->MemoryUsed() -
+                                               memory_used_before);
+    }
+
+    Tensor* out;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output("num_evicted", TensorShape({}), &out));
+    out->scalar<int64>()() = num_evicted;
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("LookupTableEvictV2").Device(DEVICE_CPU),
+                        LookupTableEvictOp);
+
+// Op that returns the size of the given table.
+class LookupTableSizeOp : public LookupTableOpKernel {
+ public:
+  using LookupTableOpKernel::LookupTableOpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    lookup::LookupInterface* table;
+    OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
+    core::ScopedUnref unref_me(table);
+
+    Tensor* out;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output("size", TensorShape({}), &out));
+    out->flat<int64>().setConstant(table->size());
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("LookupTableSize").Device(DEVICE_CPU),
+                        LookupTableSizeOp);
+REGISTER_KERNEL_BUILDER(Name("LookupTableSizeV2").Device(DEVICE_CPU),
+                        LookupTableSizeOp);
+
+// Op that outputs tensors of all keys and all values.
+class LookupTableExportOp : public LookupTableOpKernel {
+ public:
+  using LookupTableOpKernel::LookupTableOpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    lookup::LookupInterface* table;
     OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
     core::ScopedUnref unref_me(table);
 
@@ -1111,4 +2356,82 @@ REGISTER_KERNEL(tstring, ResourceHandle);
 
 #undef REGISTER_KERNEL
 
+// Register the MutableShardedHashTable op.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                              \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("MutableShardedHashTable")                                        \
+          .Device(DEVICE_CPU)                                                \
+          .TypeConstraint<key_dtype>("key_dtype")                            \
+          .TypeConstraint<value_dtype>("value_dtype"),                       \
+      LookupTableOp<lookup::MutableShardedHashTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int32, int32);
+REGISTER_KERNEL(int64, double);
+REGISTER_KERNEL(int64, float);
+REGISTER_KERNEL(int64, int32);
+REGISTER_KERNEL(int64, int64);
+REGISTER_KERNEL(int64, tstring);
+REGISTER_KERNEL(int64, Variant);
+REGISTER_KERNEL(tstring, bool);
+REGISTER_KERNEL(tstring, double);
+REGISTER_KERNEL(tstring, float);
+REGISTER_KERNEL(tstring, int32);
+REGISTER_KERNEL(tstring, int64);
+
+#undef REGISTER_KERNEL
+
+// Register the MutableAdmissionHashTable op.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                                \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("MutableAdmissionHashTable")                                        \
+          .Device(DEVICE_CPU)                                                  \
+          .TypeConstraint<key_dtype>("key_dtype")                              \
+          .TypeConstraint<value_dtype>("value_dtype"),                         \
+      LookupTableOp<lookup::MutableAdmissionHashTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int32, int32);
+REGISTER_KERNEL(int64, double);
+REGISTER_KERNEL(int64, float);
+REGISTER_KERNEL(int64, int32);
+REGISTER_KERNEL(int64, int64);
+REGISTER_KERNEL(int64, tstring);
+REGISTER_KERNEL(tstring, bool);
+REGISTER_KERNEL(tstring, double);
+REGISTER_KERNEL(tstring, float);
+REGISTER_KERNEL(tstring, int32);
+REGISTER_KERNEL(tstring, int64);
+
+#undef REGISTER_KERNEL
+
+// Register the MutableTieredHashTable op. The cold tier stores raw value
+// bytes, so only numeric value types are supported.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                             \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("MutableTieredHashTable")                                        \
+          .Device(DEVICE_CPU)                                               \
+          .TypeConstraint<key_dtype>("key_dtype")                           \
+          .TypeConstraint<value_dtype>("value_dtype"),                      \
+      LookupTableOp<lookup::MutableTieredHashTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int32, int32);
+REGISTER_KERNEL(int64, double);
+REGISTER_KERNEL(int64, float);
+REGISTER_KERNEL(int64, int32);
+REGISTER_KERNEL(int64, int64);
+REGISTER_KERNEL(tstring, double);
+REGISTER_KERNEL(tstring, float);
+REGISTER_KERNEL(tstring, int32);
+REGISTER_KERNEL(tstring, int64);
+
+#undef REGISTER_KERNEL
+
 }  // namespace tensorflow
@@ -0,0 +1,133 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kNumBuckets = 1 << 22;
+constexpr int kFindBatchSize = 100000;
+
+// Adds a MutableDenseHashTableV2 node to `g`. All graphs of one benchmark
+// share the table through its shared_name.
+Node* DenseHashTable(Graph* g) {
+  Tensor empty_key(DT_INT64, TensorShape({}));
+  empty_key.scalar<int64>()() = -1;
+  Tensor deleted_key(DT_INT64, TensorShape({}));
+  deleted_key.scalar<int64>()() = -2;
+  Node* table;
+  TF_CHECK_OK(NodeBuilder(g->NewName("table"), "MutableDenseHashTableV2")
+                  .Input(test::graph::Constant(g, empty_key))
+                  .Input(test::graph::Constant(g, deleted_key))
+                  .Attr("shared_name", "dense_hash_table_benchmark")
+                  .Attr("key_dtype", DT_INT64)
+                  .Attr("value_dtype", DT_FLOAT)
+                  .Attr("initial_num_buckets", kNumBuckets)
+                  .Attr("max_load_factor", 0.95f)
+                  .Finalize(g, &table));
+  return table;
+}
+
+// Returns `n` pseudo-random non-negative keys, none of which can collide with
+// the empty or deleted key.
+std::vector<int64> RandomKeys(int64 n) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<int64> keys(n);
+  for (int64 i = 0; i < n; ++i) {
+    keys[i] = rnd.Rand64() & std::numeric_limits<int64>::max();
+  }
+  return keys;
+}
+
+// Inserts `keys` into the table.
+Graph* DenseHashTableInsert(const std::vector<int64>& keys) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const int64 num_keys = keys.size();
+  Tensor keys_t(DT_INT64, TensorShape({num_keys}));
+  std::copy(keys.begin(), keys.end(), keys_t.flat<int64>().data());
+  Tensor values_t(DT_FLOAT, TensorShape({num_keys}));
+  values_t.flat<float>().setRandom();
+  Node* insert;
+  TF_CHECK_OK(NodeBuilder(g->NewName("insert"), "LookupTableInsertV2")
+                  .Input(DenseHashTable(g))
+                  .Input(test::graph::Constant(g, keys_t))
+                  .Input(test::graph::Constant(g, values_t))
+                  .Finalize(g, &insert));
+  return g;
+}
+
+// Looks up kFindBatchSize keys, a `hit_percent` share of which are present.
+Graph* DenseHashTableFind(const std::vector<int64>& keys, int hit_percent) {
+  Graph* g = new Graph(OpRegistry::Global());
+  random::PhiloxRandom philox(17, 301);
+  random::SimplePhilox rnd(&philox);
+  Tensor query(DT_INT64, TensorShape({kFindBatchSize}));
+  auto query_flat = query.flat<int64>();
+  for (int i = 0; i < kFindBatchSize; ++i) {
+    if (rnd.Uniform(100) < hit_percent) {
+      query_flat(i) = keys[rnd.Uniform64(keys.size())];
+    } else {
+      // Keys with the sign bit set are never inserted.
+      query_flat(i) = std::numeric_limits<int64>::min() + i;
+    }
+  }
+  Tensor default_value(DT_FLOAT, TensorShape({}));
+  default_value.scalar<float>()() = 0.0f;
+  Node* find;
+  TF_CHECK_OK(NodeBuilder(g->NewName("find"), "LookupTableFindV2")
+                  .Input(DenseHashTable(g))
+                  .Input(test::graph::Constant(g, query))
+                  .Input(test::graph::Constant(g, default_value))
+                  .Finalize(g, &find));
+  return g;
+}
+
+// Measures keys/sec of MutableDenseHashTable::Find as the load factor grows.
+static void BM_DenseHashTableFind(int iters, int load_percent,
+                                  int hit_percent) {
+  testing::StopTiming();
+  const std::vector<int64> keys =
+      RandomKeys(kNumBuckets * load_percent / 100);
+  Graph* init = DenseHashTableInsert(keys);
+  Graph* find = DenseHashTableFind(keys, hit_percent);
+  testing::ItemsProcessed(static_cast<int64>(iters) * kFindBatchSize);
+  testing::UseRealTime();
+  test::Benchmark("cpu", find, /*options=*/nullptr, init).Run(iters);
+}
+BENCHMARK(BM_DenseHashTableFind)
+    ->ArgPair(10, 100)
+    ->ArgPair(25, 100)
+    ->ArgPair(50, 100)
+    ->ArgPair(75, 100)
+    ->ArgPair(90, 100)
+    ->ArgPair(50, 50)
+    ->ArgPair(90, 50)
+    ->ArgPair(50, 0)
+    ->ArgPair(90, 0);
+
+}  // namespace
+}  // namespace tensorflow
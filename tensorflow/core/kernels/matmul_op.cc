@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/constant_weights_cache.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #if GOOGLE_CUDA
@@ -517,6 +518,18 @@ class MatMulOp : public OpKernel {
       FloatToBFloat16(out_float.flat<float>().data(),
                       out->flat<bfloat16>().data(), out->NumElements());
     } else {
+      // On CPU, multiply by the cached transpose of constant weights rather
+      // than packing them transposed on every call.
+      Tensor b_transposed;
+      if (std::is_same<Device, CPUDevice>::value && transpose_b_ &&
+          GetTransposedConstantWeights<T>(b, /*conjugate=*/false,
+                                          &b_transposed)) {
+        dim_pair[0].second = 0;
+        LaunchMatMul<Device, T, USE_CUBLAS>::launch(ctx, a, b_transposed,
+                                                    dim_pair, &algorithms_,
+                                                    use_autotune_, out);
+        return;
+      }
       LaunchMatMul<Device, T, USE_CUBLAS>::launch(
           ctx, a, b, dim_pair, &algorithms_, use_autotune_, out);
     }
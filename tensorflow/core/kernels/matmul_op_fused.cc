@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/constant_weights_cache.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
 #include "tensorflow/core/util/tensor_format.h"
@@ -169,6 +170,16 @@ class FusedMatMulOp : public OpKernel {
     }
 
     auto launch = LaunchFusedMatMulOp<Device, T>();
+    // Multiply by the cached transpose of constant weights rather than
+    // packing them transposed on every call.
+    Tensor b_transposed;
+    if (transpose_b_ && GetTransposedConstantWeights<T>(
+                            b, /*conjugate=*/false, &b_transposed)) {
+      dim_pair[0].second = 0;
+      launch(ctx, a, b_transposed, dim_pair, fused_computation_,
+             fused_computation_args_, out);
+      return;
+    }
     launch(ctx, a, b, dim_pair, fused_computation_, fused_computation_args_,
            out);
   }
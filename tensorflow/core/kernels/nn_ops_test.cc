@@ -660,6 +660,7 @@ BM_ConvFloatDepthwiseFwd(32, 112, 112, 3, 8, 24, 3, 3, 2, SAME, conv7);
 BM_ConvFloatDepthwiseFwd(32, 112, 112, 3, 8, 24, 3, 3, 2, VALID, conv8);
 BM_ConvFloatDepthwiseFwd(1, 100, 100, 72, 1, 72, 3, 3, 1, SAME, conv9);
 BM_ConvFloatDepthwiseFwd(1, 100, 100, 72, 1, 72, 5, 5, 1, SAME, conv10);
+BM_ConvFloatDepthwiseFwd(1, 100, 100, 72, 1, 72, 5, 5, 2, SAME, conv11);
 
 #define BM_ConvFloatDepthwiseBk(BS, R, C, ID, DM, OD, KR, KC, STR, PAD, LABEL) \
   static void BM_ConvFloatDepthwiseBkInCPU1_##LABEL(int iters) {               \
@@ -732,6 +733,10 @@ BM_ConvFloatDepthwiseBk(32, 112, 112, 8, 3, 24, 3, 3, 1, SAME, conv12);
 BM_ConvFloatDepthwiseBk(32, 112, 112, 12, 2, 24, 3, 3, 1, SAME, conv13);
 BM_ConvFloatDepthwiseBk(32, 112, 112, 24, 1, 24, 3, 3, 1, SAME, conv14);
 
+// Batch size 1, 5x5 filters.
+BM_ConvFloatDepthwiseBk(1, 100, 100, 72, 1, 72, 5, 5, 1, SAME, conv15);
+BM_ConvFloatDepthwiseBk(1, 100, 100, 72, 1, 72, 5, 5, 2, SAME, conv16);
+
 static void BM_LRNFloat(int iters, int depth, int cols, int rows,
                         int batch_size, int range, int num_threads,
                         const string& label) {
@@ -1455,6 +1460,18 @@ BM_TopKCPU(128, 1000, 100, 16, "topk_r_128_c_1000_k_100_th_16");
 BM_TopKCPU(128, 1000, 500, 16, "topk_r_128_c_1000_k_500_th_16");
 BM_TopKCPU(128, 1000, 1000, 16, "topk_r_128_c_1000_k_1000_th_16");
 
+// Retrieval scoring: a few rows with millions of candidates, which are split
+// across threads within each row.
+BM_TopKCPU(1, 1000000, 10, 1, "topk_r_1_c_1000000_k_10_th_1");
+BM_TopKCPU(1, 1000000, 10, 16, "topk_r_1_c_1000000_k_10_th_16");
+BM_TopKCPU(1, 1000000, 1000, 1, "topk_r_1_c_1000000_k_1000_th_1");
+BM_TopKCPU(1, 1000000, 1000, 16, "topk_r_1_c_1000000_k_1000_th_16");
+BM_TopKCPU(1, 10000000, 100, 1, "topk_r_1_c_10000000_k_100_th_1");
+BM_TopKCPU(1, 10000000, 100, 16, "topk_r_1_c_10000000_k_100_th_16");
+BM_TopKCPU(1, 10000000, 1000, 1, "topk_r_1_c_10000000_k_1000_th_1");
+BM_TopKCPU(1, 10000000, 1000, 16, "topk_r_1_c_10000000_k_1000_th_16");
+BM_TopKCPU(4, 1000000, 1000, 16, "topk_r_4_c_1000000_k_1000_th_16");
+
 // From NMT Codebase:
 //   batch_sizes: 16, 128
 //   vocab_sizes: 10000 for small dataset, 35000 for large.
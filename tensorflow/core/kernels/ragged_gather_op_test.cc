@@ -83,6 +83,48 @@ TEST_F(RaggedGatherOpTest, RaggedGather) {
       test::AsTensor<float>({.4, .5, .6, .7, .1, .2, .3, .8, .9}), 0.1);
 }
 
+TEST_F(RaggedGatherOpTest, RaggedGatherManyIndices) {
+  // Enough rows to be copied in parallel: params[i] = [[i, i]] * (i % 5),
+  // gathered in reverse order.
+  const int num_params = 2000;
+  std::vector<int64> splits = {0};
+  std::vector<int32> values;
+  for (int i = 0; i < num_params; ++i) {
+    for (int j = 0; j < i % 5; ++j) {
+      values.push_back(i);
+      values.push_back(i);
+    }
+    splits.push_back(values.size() / 2);
+  }
+  std::vector<int32> indices;
+  std::vector<int64> expected_splits = {0};
+  std::vector<int32> expected_values;
+  for (int i = num_params - 1; i >= 0; --i) {
+    indices.push_back(i);
+    for (int j = 0; j < i % 5; ++j) {
+      expected_values.push_back(i);
+      expected_values.push_back(i);
+    }
+    expected_splits.push_back(expected_values.size() / 2);
+  }
+  const int64 num_values = values.size() / 2;
+  BuildRaggedGatherGraph<int32, int32>(
+      TensorShape({num_params}),     // indices.shape
+      indices,                       // indices
+      {splits},                      // params_nested_splits
+      TensorShape({num_values, 2}),  // params_dense_values.shape
+      values                         // params_dense_values
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<int64>(*GetOutput(0),
+                                 test::AsTensor<int64>(expected_splits));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(1),
+      test::AsTensor<int32>(expected_values, TensorShape({num_values, 2})));
+}
+
 TEST_F(RaggedGatherOpTest, RaggedGather_3DParams) {
   // indices = [2, 1, 0, 2, 3]
   // params = [[[]], [[.1, 2], [.3]], [], [[.4, .5], [.6, .7, .8]], [[.9]]]
@@ -37,9 +37,11 @@ limitations under the License.
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -207,34 +209,58 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
     DCHECK_EQ(result->size(), first_dimension);
   }
 
-  void CalculateOutputIndexRowSplit(
-      const RowPartitionTensor& row_split,
+  // Calculates the output index of each element from the row splits.  The
+  // elements of each row are at row_split(i) in `result`, so the rows are
+  // computed in parallel.
+  Status CalculateOutputIndexRowSplit(
+      OpKernelContext* context, const RowPartitionTensor& row_split,
       const vector<INDEX_TYPE>& parent_output_index,
       INDEX_TYPE output_index_multiplier, INDEX_TYPE output_size,
       vector<INDEX_TYPE>* result) {
-    INDEX_TYPE row_split_size = row_split.size();
-    if (row_split_size > 0) {
-      result->reserve(row_split(row_split_size - 1));
+    const INDEX_TYPE row_split_size = row_split.size();
+    if (row_split_size == 0) {
+      return Status::OK();
     }
-    for (INDEX_TYPE i = 0; i < row_split_size - 1; ++i) {
-      INDEX_TYPE row_length = row_split(i + 1) - row_split(i);
-      INDEX_TYPE real_length = std::min(output_size, row_length);
-      INDEX_TYPE parent_output_index_current = parent_output_index[i];
-
-      if (parent_output_index_current == -1) {
-        real_length = 0;
-      }
-      for (INDEX_TYPE j = 0; j < real_length; ++j) {
-        result->push_back(parent_output_index_current);
-        parent_output_index_current += output_index_multiplier;
-      }
-      for (INDEX_TYPE j = 0; j < row_length - real_length; ++j) {
-        result->push_back(-1);
-      }
+    if (row_split(0) != 0) {
+      return errors::InvalidArgument("Row splits must start with 0, got ",
+                                     row_split(0));
     }
-    if (row_split_size > 0) {
-      DCHECK_EQ(result->size(), row_split(row_split_size - 1));
+    if (row_split_size - 1 > parent_output_index.size()) {
+      return errors::InvalidArgument("Row partition size ", row_split_size - 1,
+                                     " exceeds the number of parent rows ",
+                                     parent_output_index.size());
     }
+    for (INDEX_TYPE i = 1; i < row_split_size; ++i) {
+      if (row_split(i) < row_split(i - 1)) {
+        return errors::InvalidArgument("Row splits must be sorted");
+      }
+    }
+    const INDEX_TYPE num_values = row_split(row_split_size - 1);
+    result->resize(num_values);
+    INDEX_TYPE* const result_data = result->data();
+    auto calculate_rows = [&](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        INDEX_TYPE* row_result = result_data + row_split(i);
+        const INDEX_TYPE row_length = row_split(i + 1) - row_split(i);
+        INDEX_TYPE real_length = std::min(output_size, row_length);
+        INDEX_TYPE parent_output_index_current = parent_output_index[i];
+
+        if (parent_output_index_current == -1) {
+          real_length = 0;
+        }
+        for (INDEX_TYPE j = 0; j < real_length; ++j) {
+          row_result[j] = parent_output_index_current;
+          parent_output_index_current += output_index_multiplier;
+        }
+        std::fill(row_result + real_length, row_result + row_length, -1);
+      }
+    };
+    const int64 num_rows = row_split_size - 1;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+          std::max<int64>(num_values / std::max<int64>(num_rows, 1), 1) + 1,
+          calculate_rows);
+    return Status::OK();
   }
 
   // Calculate the output index of the first element of a list.
@@ -311,10 +337,9 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
             output_size, result);
         return tensorflow::Status::OK();
       case RowPartitionType::ROW_SPLITS:
-        CalculateOutputIndexRowSplit(row_partition_tensor, parent_output_index,
-                                     output_index_multiplier, output_size,
-                                     result);
-        return tensorflow::Status::OK();
+        return CalculateOutputIndexRowSplit(
+            context, row_partition_tensor, parent_output_index,
+            output_index_multiplier, output_size, result);
       default:
         return errors::InvalidArgument(
             "Unsupported partition type:",
@@ -453,7 +478,7 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
     TensorShape element_shape = output_tensor->shape();
     element_shape.RemoveDimRange(0, ragged_rank + 1);
     int value_element_size = element_shape.num_elements();
-    size_t output_index_size = output_index.size();
+    const int64 output_index_size = output_index.size();
 
     // Broadcast the default value to value_element_size.  (We can skip this
     // if default_value_tensor.NumElements() == 1, since we use std::fill
@@ -480,68 +505,83 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
       default_value = bcast_default.flat<VALUE_TYPE>().data();
     }
 
-    // Loop through the output_index vector, finding contiguous regions that
-    // should be copied.  Once we find the end of a contiguous region, copy it
-    // and add any necessary padding (with default_value).
-    INDEX_TYPE src_start = 0;  // Start of contiguous region (in values)
-    INDEX_TYPE dst_start = 0;  // Destination for contiguous region (in output)
-    INDEX_TYPE dst_end = 0;    // Destination for contiguous region (in output)
-    for (int src_i = 0; src_i <= output_index_size; ++src_i) {
-      // dst_i is the destination where the value at src_i should be copied.
-      INDEX_TYPE dst_i = src_i < output_index_size ? output_index[src_i] : -1;
-
-      // If we're still in a contiguous region, then update dst_end go to the
-      // next src_i.
-      if (dst_i == dst_end) {
-        ++dst_end;
-        continue;
-      }
-
-      // We found the end of contiguous region.  This can be because we found
-      // a gap (dst_i > dst_end), or a source value that shouldn't be copied
-      // because it's out-of-bounds (dst_i == -1), or the end of the tensor
-      // (dst_i = -1).
-      if (dst_start < dst_end) {
-        // Copy the contiguous region.
-        const VALUE_TYPE* src = values_base + src_start * value_element_size;
-        VALUE_TYPE* dst = output_base + dst_start * value_element_size;
-        INDEX_TYPE nvals = (dst_end - dst_start) * value_element_size;
-        copy_array<VALUE_TYPE, INDEX_TYPE>(dst, src, nvals);
-      }
-
-      // Add any necessary padding (w/ default_value).
-      if (src_i >= output_index_size) {
-        // We reached the end of values: pad to the end of output.
-        size_t output_size = output_tensor->NumElements();
-        dst_i = output_size / value_element_size;
+    // Pads the output rows [dst_start, dst_limit) with default_value.
+    const bool scalar_default = default_value_tensor.NumElements() == 1;
+    auto pad = [&](INDEX_TYPE dst_start, INDEX_TYPE dst_limit) {
+      if (scalar_default) {
+        std::fill(output_base + dst_start * value_element_size,
+                  output_base + dst_limit * value_element_size,
+                  *default_value);
+      } else {
+        for (INDEX_TYPE dst_i = dst_start; dst_i < dst_limit; ++dst_i) {
+          copy_array<VALUE_TYPE, INDEX_TYPE>(
+              output_base + dst_i * value_element_size, default_value,
+              value_element_size);
+        }
       }
-      if (dst_i > dst_end) {
-        if (default_value_tensor.NumElements() == 1) {
-          std::fill(output_base + dst_end * value_element_size,
-                    output_base + dst_i * value_element_size, *default_value);
-          dst_end = dst_i;
+    };
+
+    // Loops through the output_index vector from `start` to `limit`, finding
+    // contiguous regions that should be copied.  Once we find the end of a
+    // contiguous region, copy it and add any necessary padding (with
+    // default_value) up to the next value that is copied, which may be past
+    // `limit`.  The output indices of the values that are copied increase, so
+    // the shards write disjoint parts of the output; the first shard also pads
+    // the output before the first value.
+    const INDEX_TYPE output_rows = output_tensor->NumElements() /
+                                   value_element_size;
+    auto set_output = [&](int64 start, int64 limit) {
+      int64 src_i = start;
+      // End of the output written so far, or -1 if the padding before the
+      // first value belongs to the previous shard.
+      INDEX_TYPE dst_end = start == 0 ? 0 : -1;
+      while (true) {
+        // Skip the values that are out of bounds of the output.
+        while (src_i < limit && output_index[src_i] < 0) ++src_i;
+        INDEX_TYPE next_dst;
+        if (src_i < limit) {
+          next_dst = output_index[src_i];
         } else {
-          while (dst_i > dst_end) {
-            VALUE_TYPE* dst = output_base + dst_end * value_element_size;
-            copy_array<VALUE_TYPE, INDEX_TYPE>(dst, default_value,
-                                               value_element_size);
-            ++dst_end;
+          if (dst_end < 0) return;
+          int64 next_src = limit;
+          while (next_src < output_index_size && output_index[next_src] < 0) {
+            ++next_src;
           }
+          next_dst = next_src < output_index_size ? output_index[next_src]
+                                                  : output_rows;
         }
+        if (dst_end >= 0 && next_dst > dst_end) {
+          pad(dst_end, next_dst);
+        }
+        if (src_i >= limit) return;
+
+        // Copy the contiguous region starting at src_i.
+        const int64 src_start = src_i;
+        const INDEX_TYPE dst_start = next_dst;
+        ++src_i;
+        while (src_i < limit &&
+               output_index[src_i] == dst_start + (src_i - src_start)) {
+          ++src_i;
+        }
+        const VALUE_TYPE* src = values_base + src_start * value_element_size;
+        VALUE_TYPE* dst = output_base + dst_start * value_element_size;
+        INDEX_TYPE nvals = (src_i - src_start) * value_element_size;
+        copy_array<VALUE_TYPE, INDEX_TYPE>(dst, src, nvals);
+        dst_end = dst_start + (src_i - src_start);
       }
-
-      // Update indices.
-      if (dst_i < 0) {
-        // src_i should be skipped -- leave it out of the contiguous region.
-        src_start = src_i + 1;
-        dst_start = dst_end;
-      } else {
-        // src_i should be copied -- include it in the contiguous region.
-        src_start = src_i;
-        dst_start = dst_end;
-        dst_end = dst_start + 1;
-      }
+    };
+    if (output_index_size == 0) {
+      set_output(0, 0);
+      return;
     }
+    // Each value costs its copy and, on average, the padding that follows it.
+    const int64 cost_per_value =
+        std::max<int64>(output_tensor->NumElements() / output_index_size,
+                        value_element_size) *
+        (DataTypeCanUseMemcpy(DataTypeToEnum<VALUE_TYPE>::v()) ? 1 : 10);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          output_index_size, cost_per_value, set_output);
   }
 };
 
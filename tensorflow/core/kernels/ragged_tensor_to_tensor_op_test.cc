@@ -135,6 +135,49 @@ TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplits) {
       0.01);
 }
 
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorManyRows) {
+  // Enough rows to be converted in parallel, some truncated and some padded.
+  const int num_rows = 5000;
+  const int num_cols = 4;
+  std::vector<int32> row_splits = {0};
+  std::vector<int32> values;
+  Tensor expected(DT_INT32, TensorShape({num_rows, num_cols}));
+  auto expected_matrix = expected.matrix<int32>();
+  for (int i = 0; i < num_rows; ++i) {
+    const int row_length = i % 7;
+    for (int j = 0; j < row_length; ++j) {
+      const int value = static_cast<int>(values.size());
+      if (j < num_cols) expected_matrix(i, j) = value;
+      values.push_back(value);
+    }
+    for (int j = row_length; j < num_cols; ++j) expected_matrix(i, j) = -1;
+    row_splits.push_back(values.size());
+  }
+  BuildRaggedTensorToTensorGraph<int32, int32>(
+      TensorShape({num_rows, num_cols}),  // shape
+      {"ROW_SPLITS"},                     // row_partition_types
+      createVector<int32>(values),        // values
+      createScalar<int32>(-1),            // default_value
+      {createVector<int32>(row_splits)}   // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<int32>(*GetOutput(0), expected);
+}
+
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorUnsortedRowSplits) {
+  BuildRaggedTensorToTensorGraph<float, int32>(
+      TensorShape({4, 4}),  // shape
+      {"ROW_SPLITS"},       // row_partition_types
+      createVector<float>({.1, .2, .3, .4, .5, .6, .7, .8, .9}),  // values
+      createScalar<float>(1.5),               // default_value
+      {createVector<int32>({0, 3, 2, 7, 9})}  // row_partition_tensors
+  );
+
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
 TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensor_3DParams) {
   // params = [
   //           [[]],
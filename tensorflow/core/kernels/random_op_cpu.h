@@ -21,6 +21,8 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -77,6 +79,17 @@ struct FillPhiloxRandom {
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
 
+// Whether `Distribution` can transform samples of PhiloxRandom generated
+// ahead of time, with Transform().
+template <class Distribution, class = void>
+struct HasSampleTransform : std::false_type {};
+
+template <class Distribution>
+struct HasSampleTransform<
+    Distribution,
+    decltype(void(std::declval<const Distribution&>().Transform(
+        std::declval<const PhiloxRandom::ResultType&>())))> : std::true_type {};
+
 // Specialization for distribution that takes a fixed number of samples for
 // each output.
 template <class Distribution>
@@ -91,10 +104,10 @@ struct FillPhiloxRandomTask<Distribution, false> {
 
     // First fill all the full-size groups
     int64 limit_group_full = std::min(limit_group, size / kGroupSize);
-    for (int64 index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
-      std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
-      offset += kGroupSize;
+    if (limit_group_full > start_group) {
+      FillGroups(&gen, data + offset, limit_group_full - start_group, &dist,
+                 HasSampleTransform<Distribution>());
+      offset += (limit_group_full - start_group) * kGroupSize;
     }
 
     // If there are any remaining elements that need to be filled, process them
@@ -104,6 +117,37 @@ struct FillPhiloxRandomTask<Distribution, false> {
       std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
     }
   }
+
+ private:
+  // Fills `num_groups` full groups, generating the samples one at a time.
+  static void FillGroups(random::PhiloxRandom* gen, T* data, int64 num_groups,
+                         Distribution* dist, std::false_type) {
+    const int kGroupSize = Distribution::kResultElementCount;
+    for (int64 index = 0; index < num_groups; ++index) {
+      auto samples = (*dist)(gen);
+      std::copy(&samples[0], &samples[0] + kGroupSize, data);
+      data += kGroupSize;
+    }
+  }
+
+  // Fills `num_groups` full groups, generating the samples in vectorized
+  // batches.  The results are the same as generating them one at a time.
+  static void FillGroups(random::PhiloxRandom* gen, T* data, int64 num_groups,
+                         Distribution* dist, std::true_type) {
+    const int kGroupSize = Distribution::kResultElementCount;
+    PhiloxRandom::ResultType samples[PhiloxRandom::kMaxBatchSize];
+    while (num_groups > 0) {
+      const int batch_size =
+          std::min<int64>(num_groups, PhiloxRandom::kMaxBatchSize);
+      gen->GenerateBatch(samples, batch_size);
+      for (int i = 0; i < batch_size; ++i) {
+        auto result = dist->Transform(samples[i]);
+        std::copy(&result[0], &result[0] + kGroupSize, data);
+        data += kGroupSize;
+      }
+      num_groups -= batch_size;
+    }
+  }
 };
 
 // Specialization for distribution that takes a variable number of samples for
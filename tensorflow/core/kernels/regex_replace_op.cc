@@ -18,6 +18,7 @@ limitations under the License.
 #include "re2/re2.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/string_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -49,17 +50,22 @@ Status InternalCompute(const RE2& regex, const string& rewrite,
     output_tensor->flat<tstring>() = input_tensor->flat<tstring>();
   }
   auto output_flat = output_tensor->flat<tstring>();
-  for (size_t i = 0; i < output_flat.size(); ++i) {
-    // TODO(dero): Mitigate copy; Global and GlobalReplace below currently only
-    // accept std::string.
-    string buf = output_flat(i);
-    if (replace_global) {
-      RE2::GlobalReplace(&buf, regex, rewrite);
-    } else {
-      RE2::Replace(&buf, regex, rewrite);
-    }
-    output_flat(i) = std::move(buf);
-  }
+  // RE2 objects are safe to use from several threads at once.
+  ParallelForStrings(
+      ctx, input_tensor->flat<tstring>(), /*cost_per_byte=*/100,
+      [&](int64 start, int64 end) {
+        for (int64 i = start; i < end; ++i) {
+          // TODO(dero): Mitigate copy; Global and GlobalReplace below
+          // currently only accept std::string.
+          string buf = output_flat(i);
+          if (replace_global) {
+            RE2::GlobalReplace(&buf, regex, rewrite);
+          } else {
+            RE2::Replace(&buf, regex, rewrite);
+          }
+          output_flat(i) = std::move(buf);
+        }
+      });
   return Status::OK();
 }
 }  // namespace
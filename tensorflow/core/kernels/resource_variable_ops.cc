@@ -44,6 +44,12 @@ limitations under the License.
 //   that they want to perform the write without locks held
 //   (use_locking=false), we never copy even if the variable's
 //   reference count is >1.
+// * Scatter operations with relaxed=true hold the variable's mutex in
+//   "shared" mode only and serialize writes per row through
+//   StripedRowLocks. They do not switch the variable to copy-on-read
+//   mode; the buffer is copied only when a dense read still aliases
+//   it. A dense read that runs concurrently with a relaxed update may
+//   observe the update partially applied.
 
 #define EIGEN_USE_THREADS
 
@@ -78,6 +84,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -843,6 +850,74 @@ TF_CALL_GPU_NUMBER_TYPES(REGISTER_GATHER_ND_GPU);
 #undef REGISTER_GATHER_ND_ALL_INDICES
 #undef REGISTER_GATHER_ND_FULL
 
+namespace {
+
+// Applies `op` with the rows of `updates` (or with `*updates` for every
+// element when `updates_stride` is 0) to the rows of `params` selected by
+// `indices`, in parallel. Every row is updated under its stripe of
+// StripedRowLocks, so duplicate indices and concurrent relaxed updates of the
+// same row do not lose writes. Returns the position of the first out of range
+// index, or -1.
+template <typename T, typename Index, scatter_op::UpdateOp op>
+struct RelaxedScatterRows {
+  static Index Run(OpKernelContext* c, typename TTypes<T>::Matrix params,
+                   const T* updates, int64 updates_stride,
+                   typename TTypes<Index>::ConstFlat indices) {
+    const Index N = static_cast<Index>(indices.size());
+    const Index limit = static_cast<Index>(params.dimension(0));
+    const int64 cols = params.dimension(1);
+    for (Index i = 0; i < N; ++i) {
+      const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, limit)) return i;
+    }
+    StripedRowLocks* row_locks = StripedRowLocks::Global();
+    auto work = [&](int64 start, int64 end) {
+      for (int64 i = start; i < end; ++i) {
+        const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+        typename TTypes<T>::UnalignedVec row(params.data() + index * cols,
+                                             cols);
+        mutex_lock l(*row_locks->ForRow(row.data()));
+        if (updates_stride == 0) {
+          scatter_op::internal::Assign<op>::RunScalar(row, *updates);
+        } else {
+          scatter_op::internal::Assign<op>::Run(
+              row, typename TTypes<T>::UnalignedConstVec(
+                       updates + i * updates_stride, cols));
+        }
+      }
+    };
+    const float kMovingCost = 2.5f;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *(c->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, N,
+          kMovingCost * cols, work);
+    return -1;
+  }
+};
+
+// Relaxed updates are never enabled for non-POD types; see
+// ResourceScatterUpdateOp.
+template <typename Index, scatter_op::UpdateOp op>
+struct RelaxedScatterRows<tstring, Index, op> {
+  static Index Run(OpKernelContext* c, typename TTypes<tstring>::Matrix params,
+                   const tstring* updates, int64 updates_stride,
+                   typename TTypes<Index>::ConstFlat indices) {
+    LOG(FATAL) << "Relaxed scatter is not supported for strings.";
+    return -1;
+  }
+};
+template <typename Index, scatter_op::UpdateOp op>
+struct RelaxedScatterRows<Variant, Index, op> {
+  static Index Run(OpKernelContext* c, typename TTypes<Variant>::Matrix params,
+                   const Variant* updates, int64 updates_stride,
+                   typename TTypes<Index>::ConstFlat indices) {
+    LOG(FATAL) << "Relaxed scatter is not supported for variants.";
+    return -1;
+  }
+};
+
+}  // namespace
+
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 class ResourceScatterUpdateOp : public OpKernel {
  public:
@@ -853,11 +928,24 @@ class ResourceScatterUpdateOp : public OpKernel {
     if (!s.ok()) {
       use_exclusive_lock_ = false;
     }
+    s = c->GetAttr("relaxed", &relaxed_);
+    if (!s.ok()) {
+      relaxed_ = false;
+    }
+    // Relaxed updates are only implemented for plain-old-data types on CPU;
+    // everywhere else the attribute is ignored.
+    relaxed_ = relaxed_ && std::is_same<Device, CPUDevice>::value &&
+               DataTypeToEnum<T>::value != DT_STRING &&
+               DataTypeToEnum<T>::value != DT_VARIANT;
   }
 
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+    if (relaxed_) {
+      ComputeRelaxed(c, v.get());
+      return;
+    }
     OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
     const bool is_non_pod_dtype = c->input_dtype(0) == DT_RESOURCE ||
                                   c->input_dtype(0) == DT_STRING ||
@@ -874,6 +962,27 @@ class ResourceScatterUpdateOp : public OpKernel {
 
  private:
   bool use_exclusive_lock_;
+  bool relaxed_;
+
+  void ComputeRelaxed(OpKernelContext* c, Var* v) {
+    {
+      tf_shared_lock ml(*v->mu());
+      OP_REQUIRES(c, v->tensor()->IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(0)));
+      // In-place updates are safe unless a dense read still holds a
+      // reference to the buffer.
+      if (v->copy_on_read_mode.load() || v->tensor()->RefCountIsOne()) {
+        DoCompute(c);
+        return;
+      }
+    }
+    mutex_lock ml(*v->mu());
+    OP_REQUIRES_OK(c, PrepareToUpdateVariable<Device, T>(
+                          c, v->tensor(), v->copy_on_read_mode.load()));
+    DoCompute(c);
+  }
 
   void DoCompute(OpKernelContext* c) {
     core::RefCountPtr<Var> v;
@@ -915,9 +1024,16 @@ class ResourceScatterUpdateOp : public OpKernel {
       if (TensorShapeUtils::IsScalar(updates.shape())) {
         const auto update = updates.scalar<T>();
 
-        functor::ScatterScalarFunctor<Device, T, Index, op> functor;
-        const Index bad_i = functor(c, c->template eigen_device<Device>(),
-                                    params_flat, update, indices_flat);
+        Index bad_i;
+        if (relaxed_) {
+          bad_i = RelaxedScatterRows<T, Index, op>::Run(
+              c, params_flat, update.data(), /*updates_stride=*/0,
+              indices_flat);
+        } else {
+          functor::ScatterScalarFunctor<Device, T, Index, op> functor;
+          bad_i = functor(c, c->template eigen_device<Device>(), params_flat,
+                          update, indices_flat);
+        }
         OP_REQUIRES(c, bad_i < 0,
                     errors::InvalidArgument(
                         "indices", SliceDebugString(indices.shape(), bad_i),
@@ -932,9 +1048,16 @@ class ResourceScatterUpdateOp : public OpKernel {
                         updates.shape().DebugString(), ")"));
         auto updates_flat = updates.shaped<T, 2>({N, num_updates / N});
 
-        functor::ScatterFunctor<Device, T, Index, op> functor;
-        const Index bad_i = functor(c, c->template eigen_device<Device>(),
-                                    params_flat, updates_flat, indices_flat);
+        Index bad_i;
+        if (relaxed_) {
+          bad_i = RelaxedScatterRows<T, Index, op>::Run(
+              c, params_flat, updates_flat.data(),
+              /*updates_stride=*/num_updates / N, indices_flat);
+        } else {
+          functor::ScatterFunctor<Device, T, Index, op> functor;
+          bad_i = functor(c, c->template eigen_device<Device>(), params_flat,
+                          updates_flat, indices_flat);
+        }
         OP_REQUIRES(c, bad_i < 0,
                     errors::InvalidArgument(
                         "indices", SliceDebugString(indices.shape(), bad_i),
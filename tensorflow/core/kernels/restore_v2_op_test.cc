@@ -31,9 +31,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -356,5 +358,79 @@ TEST_F(RestoreV2OpTest, RestoreAfterSaveV2) { RunTest("SaveV2"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveSlicesV1) { RunTest("SaveSlices"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveV1) { RunTest("Save"); }
 
+TEST_F(RestoreV2OpTest, ParallelRestore) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "parallel_restore");
+  const int kNumTensors = 10;
+  std::vector<tstring> tensor_names;
+  std::vector<Tensor> expected;
+  {
+    // Spreads the tensors across several data files, and splits the larger
+    // ones into partitioned tensors.
+    BundleWriter::Options options;
+    options.num_shards = 3;
+    options.max_slice_bytes = 64;
+    BundleWriter writer(Env::Default(), prefix, options);
+    for (int i = 0; i < kNumTensors; ++i) {
+      tensor_names.push_back(strings::StrCat("tensor_", i));
+      expected.push_back(MakeInput<float>(
+          TensorShape({i + 1, 4}),
+          [i](int x) -> float { return 100 * i + x; }));
+      TF_ASSERT_OK(writer.Add(tensor_names.back(), expected.back()));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  TF_ASSERT_OK(NodeDefBuilder("myop", "RestoreV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Attr("dtypes", DataTypeVector(kNumTensors, DT_FLOAT))
+                   .Attr("num_threads", 4)
+                   .Attr("read_buffer_size", 32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({kNumTensors}), tensor_names);
+  AddInputFromArray<tstring>(TensorShape({kNumTensors}),
+                             std::vector<tstring>(kNumTensors, ""));
+  TF_ASSERT_OK(RunOpKernel());
+  for (int i = 0; i < kNumTensors; ++i) {
+    test::ExpectTensorEqual<float>(expected[i], *GetOutput(i));
+  }
+}
+
+TEST_F(RestoreV2OpTest, MemoryMappedRestore) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "mapped_restore");
+  const Tensor floats = MakeInput<float>(
+      TensorShape({3, 5}), [](int x) -> float { return x * 0.5f; });
+  const Tensor ints =
+      MakeInput<int64>(TensorShape({7}), [](int x) -> int64 { return x - 3; });
+  {
+    BundleWriter::Options options;
+    options.data_alignment = 64;
+    BundleWriter writer(Env::Default(), prefix, options);
+    TF_ASSERT_OK(writer.Add("floats", floats));
+    TF_ASSERT_OK(writer.Add("ints", ints));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  TF_ASSERT_OK(NodeDefBuilder("myop", "RestoreV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Attr("dtypes", {DT_FLOAT, DT_INT64, DT_FLOAT})
+                   .Attr("memory_map", true)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({3}), {"floats", "ints", "floats"});
+  // Slices are still read into copies.
+  AddInputFromArray<tstring>(TensorShape({3}), {"", "", "3 5 1,2:0,5"});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(floats, *GetOutput(0));
+  test::ExpectTensorEqual<int64>(ints, *GetOutput(1));
+  test::ExpectTensorEqual<float>(floats.Slice(1, 3), *GetOutput(2));
+}
+
 }  // namespace
 }  // namespace tensorflow
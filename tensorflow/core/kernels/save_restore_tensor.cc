@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
+#include <algorithm>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
@@ -30,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -256,8 +259,8 @@ struct RestoreOp {
   }
 
   // Run this restore operation using a new BundleReader.
-  void run_with_new_reader() {
-    BundleReader reader(Env::Default(), reader_prefix);
+  void run_with_new_reader(const BundleReader::Options& reader_options) {
+    BundleReader reader(Env::Default(), reader_prefix, reader_options);
     if (!reader.status().ok()) {
       status = reader.status();
       return;
@@ -274,7 +277,13 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && memory_map) {
+      // Lookup the full tensor, mapping rather than copying its data.
+      Tensor mapped;
+      TF_RETURN_IF_ERROR(reader->LookupMapped(tensor_name, &mapped));
+      context->set_output(idx, mapped);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -327,17 +336,126 @@ struct RestoreOp {
   string tensor_name;
   string shape_and_slice;
   string reader_prefix;
+  bool memory_map;
 
   ::tensorflow::Status status;
 };
 
+// A run of tensors restored back to back by one thread of the parallel mode.
+// The tensors of a run are stored in the same data file, in file order, so
+// that the reads of neighboring small tensors are served by the read buffer.
+struct RestoreRun {
+  int32 shard_id;  // -1 if the tensors are not stored in a single data file.
+  int64 bytes;
+  std::vector<RestoreOp*> ops;
+};
+
+// Restores "ops" from (at most) "num_threads" threads, each of which reads
+// through its own BundleReader.  The tensors are grouped by data file into runs
+// of roughly equal size, and the runs are spread across the threads, largest
+// first, to balance the number of bytes each thread reads.  Leaves the status
+// of each restore in its "status" field.
+Status RunRestoreOpsInParallel(
+    BundleReader* default_reader, const BundleReader::Options& reader_options,
+    int num_threads, const std::vector<std::unique_ptr<RestoreOp> >& ops) {
+  if (ops.empty()) return Status::OK();
+  const string& reader_prefix = ops.front()->reader_prefix;
+
+  struct Location {
+    int32 shard_id;
+    int64 offset;
+    int64 size;
+    RestoreOp* op;
+  };
+  std::vector<Location> locations;
+  locations.reserve(ops.size());
+  int64 total_bytes = 0;
+  for (const auto& op : ops) {
+    Location location{-1, 0, 0, op.get()};
+    TF_RETURN_IF_ERROR(default_reader->LookupDataLocation(
+        op->tensor_name, &location.shard_id, &location.offset,
+        &location.size));
+    total_bytes += location.size;
+    locations.push_back(location);
+  }
+  std::stable_sort(locations.begin(), locations.end(),
+                   [](const Location& a, const Location& b) {
+                     return std::make_pair(a.shard_id, a.offset) <
+                            std::make_pair(b.shard_id, b.offset);
+                   });
+
+  // Splits the data files into runs, so that a file holding most of the bytes
+  // is still read from several threads.
+  const int64 max_run_bytes =
+      std::max<int64>(1, (total_bytes + num_threads - 1) / num_threads);
+  std::vector<RestoreRun> runs;
+  for (const Location& location : locations) {
+    if (runs.empty() || location.shard_id < 0 ||
+        runs.back().shard_id != location.shard_id ||
+        runs.back().bytes + location.size > max_run_bytes) {
+      runs.push_back(RestoreRun{location.shard_id, 0, {}});
+    }
+    runs.back().bytes += location.size;
+    runs.back().ops.push_back(location.op);
+  }
+
+  const int num_workers =
+      std::min<int64>(num_threads, static_cast<int64>(runs.size()));
+  std::vector<RestoreRun*> sorted_runs;
+  sorted_runs.reserve(runs.size());
+  for (RestoreRun& run : runs) sorted_runs.push_back(&run);
+  std::stable_sort(sorted_runs.begin(), sorted_runs.end(),
+                   [](const RestoreRun* a, const RestoreRun* b) {
+                     return a->bytes > b->bytes;
+                   });
+  std::vector<std::vector<RestoreRun*> > worker_runs(num_workers);
+  std::vector<int64> worker_bytes(num_workers, 0);
+  for (RestoreRun* run : sorted_runs) {
+    const int worker =
+        std::min_element(worker_bytes.begin(), worker_bytes.end()) -
+        worker_bytes.begin();
+    worker_runs[worker].push_back(run);
+    // Counts every run, so that runs of empty tensors are spread as well.
+    worker_bytes[worker] += run->bytes + 1;
+  }
+
+  {
+    thread::ThreadPool reader_pool(Env::Default(), "restore_tensors",
+                                   num_workers);
+    for (const auto& runs_of_worker : worker_runs) {
+      reader_pool.Schedule([&runs_of_worker, &reader_prefix,
+                            &reader_options]() {
+        BundleReader reader(Env::Default(), reader_prefix, reader_options);
+        for (RestoreRun* run : runs_of_worker) {
+          profiler::TraceMe traceme([run] {
+            return profiler::TraceMeEncode(
+                "RestoreV2Shard", {{"shard", run->shard_id},
+                                   {"tensors", run->ops.size()},
+                                   {"bytes", run->bytes}});
+          });
+          for (RestoreOp* op : run->ops) {
+            op->status = reader.status().ok() ? op->run(&reader)
+                                              : reader.status();
+          }
+        }
+      });
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes) {
+                        gtl::ArraySlice<DataType> dtypes, int num_threads,
+                        int64 read_buffer_size, bool memory_map) {
   const string& prefix_string = prefix.scalar<tstring>()();
+  BundleReader::Options reader_options;
+  if (read_buffer_size > 0) {
+    reader_options.read_buffer_size = read_buffer_size;
+  }
 
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
@@ -353,7 +471,7 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   std::vector<std::unique_ptr<RestoreOp> > pool_restore_ops;
   std::vector<std::unique_ptr<RestoreOp> > direct_restore_ops;
 
-  BundleReader default_reader(Env::Default(), prefix_string);
+  BundleReader default_reader(Env::Default(), prefix_string, reader_options);
   TF_RETURN_IF_ERROR(default_reader.status());
 
   std::vector<string> mismatched_errors;
@@ -379,16 +497,19 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
-    auto op =
-        new RestoreOp{context, i, tensor_name, shape_and_slice, prefix_string};
-    if (op->should_run_in_pool(&default_reader)) {
+    auto op = new RestoreOp{
+        context, i, tensor_name, shape_and_slice, prefix_string, memory_map};
+    if (num_threads > 0 || op->should_run_in_pool(&default_reader)) {
       pool_restore_ops.emplace_back(op);
     } else {
       direct_restore_ops.emplace_back(op);
     }
   }
 
-  {
+  if (num_threads > 0) {
+    TF_RETURN_IF_ERROR(RunRestoreOpsInParallel(&default_reader, reader_options,
+                                               num_threads, pool_restore_ops));
+  } else {
     // Schedule any threaded operations first, skipping thread pool creation if
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
@@ -396,7 +517,9 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       reader_pool.reset(
           new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
       for (auto& op : pool_restore_ops) {
-        reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
+        reader_pool->Schedule([&op, &reader_options]() {
+          op->run_with_new_reader(reader_options);
+        });
       }
     }
 
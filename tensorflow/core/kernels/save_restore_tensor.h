@@ -63,10 +63,20 @@ void RestoreTensor(OpKernelContext* context,
 //   * "prefix" has 1 element, DT_STRING.
 //   * "tensor_names" and "shape_and_slices" shaped {N}, both DT_STRING.
 //   * "dtypes" has N elements, the datatypes of the to-restore tensors.
+//
+// If "num_threads" > 0, restores all tensors from that many threads, each with
+// its own reader: the tensors are grouped by the data file holding them, read
+// in file order, and the groups are balanced across the threads by size.
+// Otherwise only the largest tensors are read from a thread pool.
+// "read_buffer_size", if > 0, overrides the per-file read buffer (readahead)
+// size of the readers; see BundleReader::Options.
+// If "memory_map", full tensors are restored as read-only views of the
+// memory-mapped data files where possible; see BundleReader::LookupMapped().
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes);
+                        gtl::ArraySlice<DataType> dtypes, int num_threads = 0,
+                        int64 read_buffer_size = 0, bool memory_map = false);
 
 }  // namespace tensorflow
 
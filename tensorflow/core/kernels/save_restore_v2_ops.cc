@@ -88,11 +88,30 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
-class SaveV2 : public OpKernel {
+class SaveV2 : public AsyncOpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : AsyncOpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("num_shards", &num_shards_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("data_alignment", &data_alignment_));
+  }
 
-  void Compute(OpKernelContext* context) override {
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
+    if (num_shards_ == 1) {
+      Save(context);
+      done();
+      return;
+    }
+    // A parallel save runs in the background rather than holding on to an
+    // inter-op thread, so that the rest of the step can proceed meanwhile.
+    Env::Default()->SchedClosure([this, context, done]() {
+      Save(context);
+      done();
+    });
+  }
+
+ private:
+  void Save(OpKernelContext* context) {
     const Tensor& prefix = context->input(0);
     const Tensor& tensor_names = context->input(1);
     const Tensor& shape_and_slices = context->input(2);
@@ -105,7 +124,10 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
+    BundleWriter::Options options;
+    options.num_shards = num_shards_;
+    options.data_alignment = data_alignment_;
+    BundleWriter writer(Env::Default(), prefix_string, options);
     OP_REQUIRES_OK(context, writer.status());
     VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
 
@@ -157,6 +179,11 @@ class SaveV2 : public OpKernel {
     OP_REQUIRES_OK(context, writer.Finish());
     VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
   }
+
+  // Number of data files written concurrently.
+  int num_shards_;
+  // Alignment, in bytes, of the data of each tensor in its data file.
+  int data_alignment_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -165,6 +192,10 @@ class RestoreV2 : public OpKernel {
  public:
   explicit RestoreV2(OpKernelConstruction* context) : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("dtypes", &dtypes_));
+    OP_REQUIRES_OK(context, context->GetAttr("num_threads", &num_threads_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("read_buffer_size", &read_buffer_size_));
+    OP_REQUIRES_OK(context, context->GetAttr("memory_map", &memory_map_));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -201,13 +232,21 @@ class RestoreV2 : public OpKernel {
       return;
     }
     // If found, invokes the V2 reader.
-    OP_REQUIRES_OK(context, RestoreTensorsV2(context, prefix, tensor_names,
-                                             shape_and_slices, dtypes_));
+    OP_REQUIRES_OK(context,
+                   RestoreTensorsV2(context, prefix, tensor_names,
+                                    shape_and_slices, dtypes_, num_threads_,
+                                    read_buffer_size_, memory_map_));
   }
 
  private:
   // Expected dtypes of the to-restore tensors.
   std::vector<DataType> dtypes_;
+  // Number of threads restoring the tensors in parallel, or 0 for the default.
+  int num_threads_;
+  // Read buffer size of the data files, or 0 for the default.
+  int64 read_buffer_size_;
+  // Whether to restore read-only views of the mapped data files.
+  bool memory_map_;
 };
 REGISTER_KERNEL_BUILDER(Name("RestoreV2").Device(DEVICE_CPU), RestoreV2);
 
@@ -260,4 +299,31 @@ class MergeV2Checkpoints : public OpKernel {
 REGISTER_KERNEL_BUILDER(Name("MergeV2Checkpoints").Device(DEVICE_CPU),
                         MergeV2Checkpoints);
 
+// Folds a delta V2 checkpoint and its chain of base checkpoints into one.
+class CompactV2Checkpoint : public OpKernel {
+ public:
+  explicit CompactV2Checkpoint(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& checkpoint_prefix = context->input(0);
+    const Tensor& destination_prefix = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(checkpoint_prefix.shape()),
+                errors::InvalidArgument(
+                    "Input checkpoint_prefix should be a scalar tensor, got ",
+                    checkpoint_prefix.shape().DebugString(), " instead."));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(destination_prefix.shape()),
+                errors::InvalidArgument(
+                    "Input destination_prefix should be a scalar tensor, got ",
+                    destination_prefix.shape().DebugString(), " instead."));
+
+    OP_REQUIRES_OK(context,
+                   tensorflow::CompactBundles(
+                       Env::Default(), checkpoint_prefix.scalar<tstring>()(),
+                       destination_prefix.scalar<tstring>()()));
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("CompactV2Checkpoint").Device(DEVICE_CPU),
+                        CompactV2Checkpoint);
+
 }  // namespace tensorflow
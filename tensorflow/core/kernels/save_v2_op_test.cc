@@ -340,5 +340,85 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+TEST_F(SaveV2OpTest, ParallelSave) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_parallel");
+  TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Input(FakeInput({DT_FLOAT, DT_INT64}))  // tensors
+                   .Attr("num_shards", 2)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({2}), [](int x) -> tstring {
+    return x == 0 ? "tensor_float" : "tensor_int64";
+  });
+  AddInput<tstring>(TensorShape({2}), [](int x) -> tstring { return ""; });
+  AddInput<float>(TensorShape({4, 3}),
+                  [](int x) -> float { return static_cast<float>(x) / 4; });
+  AddInput<int64>(TensorShape({5}), [](int x) -> int64 { return x * 7; });
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Each tensor lands in its own data file.
+  Env* env = Env::Default();
+  TF_EXPECT_OK(env->FileExists(DataFilename(prefix, 0, 2)));
+  TF_EXPECT_OK(env->FileExists(DataFilename(prefix, 1, 2)));
+
+  BundleReader reader(env, prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor float_val;
+  TF_EXPECT_OK(reader.Lookup("tensor_float", &float_val));
+  ASSERT_EQ(DT_FLOAT, float_val.dtype());
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_EQ(static_cast<float>(i) / 4, float_val.flat<float>()(i));
+  }
+  Tensor int64_val;
+  TF_EXPECT_OK(reader.Lookup("tensor_int64", &int64_val));
+  ASSERT_EQ(DT_INT64, int64_val.dtype());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(i * 7, int64_val.flat<int64>()(i));
+  }
+}
+
+TEST_F(SaveV2OpTest, AlignedSave) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_aligned");
+  TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Input(FakeInput({DT_FLOAT, DT_INT64}))  // tensors
+                   .Attr("data_alignment", 64)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({2}), [](int x) -> tstring {
+    return x == 0 ? "tensor_float" : "tensor_int64";
+  });
+  AddInput<tstring>(TensorShape({2}), [](int x) -> tstring { return ""; });
+  AddInput<float>(TensorShape({3}),
+                  [](int x) -> float { return static_cast<float>(x) / 4; });
+  AddInput<int64>(TensorShape({5}), [](int x) -> int64 { return x * 7; });
+  TF_ASSERT_OK(RunOpKernel());
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  for (const char* key : {"tensor_float", "tensor_int64"}) {
+    int32 shard_id;
+    int64 offset, size;
+    TF_ASSERT_OK(reader.LookupDataLocation(key, &shard_id, &offset, &size));
+    EXPECT_EQ(offset % 64, 0) << key;
+  }
+  Tensor int64_val;
+  TF_EXPECT_OK(reader.Lookup("tensor_int64", &int64_val));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(i * 7, int64_val.flat<int64>()(i));
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -54,6 +54,43 @@ struct SegmentSumFunctor {
                   typename TTypes<T, 2>::Tensor output);
 };
 
+// Functor for SparseSegmentReductionGPUOp.  Gathers the rows of 'input'
+// listed in 'indices' and reduces them by segment in a single pass, without
+// materializing the gathered rows.
+// is_mean, is_sqrtn: whether to divide each sum by the number of rows in its
+//                segment, or by the square root of that number.
+// default_value: value of the output rows of empty segments.
+// input: input data tensor, reshaped to {rows, columns}.
+// indices: rows of 'input' to reduce.  Rows out of range contribute zeros,
+//                as in the GPU kernel of Gather.
+// segment_ids: sorted output segment of each of 'indices'.  Segments not
+//                below output.dimension(0) are dropped.
+// output: output reshaped to {output_rows, columns}.
+template <typename T, typename Index, typename SegmentId>
+struct SparseSegmentReductionFunctor {
+  Status operator()(OpKernelContext* ctx, bool is_mean, bool is_sqrtn,
+                    T default_value, typename TTypes<T, 2>::ConstTensor input,
+                    typename TTypes<Index>::ConstVec indices,
+                    typename TTypes<SegmentId>::ConstVec segment_ids,
+                    typename TTypes<T, 2>::Tensor output);
+};
+
+// Functor for SparseSegmentGradGPUOp, the gradient of SparseSegmentMean and
+// SparseSegmentSqrtN.  Scatters each row of 'input' to the 'indices' of its
+// segment, scaled as in the forward op.
+// input: gradient of the forward op's output, reshaped to
+//                {num_segments, columns}.
+// indices, segment_ids: the forward op's inputs of the same name.
+// output: output reshaped to {output_dim0, columns}.
+template <typename T, typename Index, typename SegmentId>
+struct SparseSegmentGradFunctor {
+  Status operator()(OpKernelContext* ctx, bool is_sqrtn,
+                    typename TTypes<T, 2>::ConstTensor input,
+                    typename TTypes<Index>::ConstVec indices,
+                    typename TTypes<SegmentId>::ConstVec segment_ids,
+                    typename TTypes<T, 2>::Tensor output);
+};
+
 #endif
 
 template <typename Device, typename T, typename Index, typename InitialValueF,
@@ -124,6 +124,114 @@ __global__ void UnsortedSegmentCustomKernel(
   }
 }
 
+// Sets offsets[s] to the position of the first of the sorted 'segment_ids'
+// that is not below s, so that segment s spans [offsets[s], offsets[s + 1]).
+template <typename SegmentId>
+__global__ void SegmentOffsetsKernel(const int64 num_ids,
+                                     const SegmentId* __restrict__ segment_ids,
+                                     const int64 num_offsets,
+                                     int64* __restrict__ offsets) {
+  for (int64 segment : GpuGridRangeX(num_offsets)) {
+    offsets[segment] = gpu_helper::lower_bound<SegmentId, int64>(
+        segment_ids, num_ids, static_cast<SegmentId>(segment));
+  }
+}
+
+// Sums are accumulated in float for half precision inputs.
+template <typename T>
+struct SparseSegmentAccumulator {
+  using type = T;
+};
+
+template <>
+struct SparseSegmentAccumulator<Eigen::half> {
+  using type = float;
+};
+
+// 'kVecWidth' consecutive elements, loaded and stored with one instruction.
+template <typename T, int kVecWidth>
+struct alignas(sizeof(T) * kVecWidth) SparseSegmentVector {
+  T values[kVecWidth];
+};
+
+// Each thread produces 'kVecWidth' consecutive columns of one output row, by
+// gathering and reducing those columns of the input rows of its segment.
+template <typename T, typename Index, int kVecWidth>
+__global__ void SparseSegmentReductionKernel(
+    const int64 input_rows, const int64 num_cols, const int64 output_rows,
+    const int64* __restrict__ offsets, const Index* __restrict__ indices,
+    const T* __restrict__ input, const bool is_mean, const bool is_sqrtn,
+    const T default_value, T* __restrict__ output) {
+  using Acc = typename SparseSegmentAccumulator<T>::type;
+  using Vector = SparseSegmentVector<T, kVecWidth>;
+  const int64 num_vecs = num_cols / kVecWidth;
+  for (int64 i : GpuGridRangeX(output_rows * num_vecs)) {
+    const int64 segment = i / num_vecs;
+    const int64 col = (i % num_vecs) * kVecWidth;
+    const int64 begin = ldg(offsets + segment);
+    const int64 end = ldg(offsets + segment + 1);
+    Vector result;
+    if (begin == end) {
+#pragma unroll
+      for (int k = 0; k < kVecWidth; ++k) result.values[k] = default_value;
+    } else {
+      Acc sum[kVecWidth];
+#pragma unroll
+      for (int k = 0; k < kVecWidth; ++k) sum[k] = Acc(0);
+      for (int64 j = begin; j < end; ++j) {
+        const Index row = ldg(indices + j);
+        if (row < 0 || row >= input_rows) continue;
+        const Vector value =
+            *reinterpret_cast<const Vector*>(input + row * num_cols + col);
+#pragma unroll
+        for (int k = 0; k < kVecWidth; ++k) {
+          sum[k] += static_cast<Acc>(value.values[k]);
+        }
+      }
+      Acc scale = Acc(1);
+      if (is_mean) {
+        scale = Acc(1) / static_cast<Acc>(end - begin);
+      } else if (is_sqrtn) {
+        scale = Acc(1) / sqrt(static_cast<Acc>(end - begin));
+      }
+#pragma unroll
+      for (int k = 0; k < kVecWidth; ++k) {
+        result.values[k] = static_cast<T>(sum[k] * scale);
+      }
+    }
+    *reinterpret_cast<Vector*>(output + segment * num_cols + col) = result;
+  }
+}
+
+// Each thread adds one element of the gradient of a segment, scaled as in
+// the forward op, to the row of 'output' that one of its indices refers to.
+template <typename T, typename Index, typename SegmentId>
+__global__ void SparseSegmentGradKernel(
+    const int64 num_ids, const int64 num_cols, const int64 num_segments,
+    const int64 output_rows, const int64* __restrict__ offsets,
+    const Index* __restrict__ indices,
+    const SegmentId* __restrict__ segment_ids, const T* __restrict__ input,
+    const bool is_sqrtn, T* __restrict__ output) {
+  using Acc = typename SparseSegmentAccumulator<T>::type;
+  for (int64 i : GpuGridRangeX(num_ids * num_cols)) {
+    const int64 id = i / num_cols;
+    const int64 col = i % num_cols;
+    const SegmentId segment = ldg(segment_ids + id);
+    const Index row = ldg(indices + id);
+    if (segment < 0 || segment >= num_segments || row < 0 ||
+        row >= output_rows) {
+      continue;
+    }
+    const Acc count =
+        static_cast<Acc>(ldg(offsets + segment + 1) - ldg(offsets + segment));
+    const Acc scale = is_sqrtn ? Acc(1) / sqrt(count) : Acc(1) / count;
+    GpuAtomicAdd(output + row * num_cols + col,
+                 static_cast<T>(static_cast<Acc>(
+                                    ldg(input + segment * num_cols + col)) *
+                                scale));
+  }
+}
+
 namespace functor {
 
 template <typename T, typename Index>
@@ -207,6 +315,96 @@ struct UnsortedSegmentFunctor<GPUDevice, T, Index, InitialValueF, ReductionF> {
   }
 };
 
+// Computes the offsets of the segments [0, num_segments) in the sorted
+// 'segment_ids' into a temporary of num_segments + 1 elements.
+template <typename SegmentId>
+Status ComputeSegmentOffsets(OpKernelContext* ctx,
+                             typename TTypes<SegmentId>::ConstVec segment_ids,
+                             const int64 num_segments, Tensor* offsets) {
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT64, TensorShape({num_segments + 1}), offsets));
+  const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_segments + 1, d);
+  return GpuLaunchKernel(SegmentOffsetsKernel<SegmentId>, config.block_count,
+                         config.thread_per_block, 0, d.stream(),
+                         segment_ids.size(), segment_ids.data(),
+                         num_segments + 1, offsets->flat<int64>().data());
+}
+
+template <typename T, typename Index, typename SegmentId>
+Status SparseSegmentReductionFunctor<T, Index, SegmentId>::operator()(
+    OpKernelContext* ctx, bool is_mean, bool is_sqrtn, T default_value,
+    typename TTypes<T, 2>::ConstTensor input,
+    typename TTypes<Index>::ConstVec indices,
+    typename TTypes<SegmentId>::ConstVec segment_ids,
+    typename TTypes<T, 2>::Tensor output) {
+  if (output.size() == 0) {
+    return Status::OK();
+  }
+  const int64 output_rows = output.dimension(0);
+  const int64 num_cols = output.dimension(1);
+  Tensor offsets;
+  TF_RETURN_IF_ERROR(ComputeSegmentOffsets<SegmentId>(ctx, segment_ids,
+                                                      output_rows, &offsets));
+
+  // Load and store four elements at a time when every row is aligned for it.
+  constexpr int kVecWidth = 4;
+  const bool vectorize =
+      num_cols % kVecWidth == 0 &&
+      reinterpret_cast<uintptr_t>(input.data()) % (sizeof(T) * kVecWidth) ==
+          0 &&
+      reinterpret_cast<uintptr_t>(output.data()) % (sizeof(T) * kVecWidth) ==
+          0;
+  const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+  if (vectorize) {
+    GpuLaunchConfig config =
+        GetGpuLaunchConfig(output_rows * (num_cols / kVecWidth), d);
+    return GpuLaunchKernel(
+        SparseSegmentReductionKernel<T, Index, kVecWidth>, config.block_count,
+        config.thread_per_block, 0, d.stream(), input.dimension(0), num_cols,
+        output_rows, offsets.flat<int64>().data(), indices.data(),
+        input.data(), is_mean, is_sqrtn, default_value, output.data());
+  }
+  GpuLaunchConfig config = GetGpuLaunchConfig(output_rows * num_cols, d);
+  return GpuLaunchKernel(
+      SparseSegmentReductionKernel<T, Index, 1>, config.block_count,
+      config.thread_per_block, 0, d.stream(), input.dimension(0), num_cols,
+      output_rows, offsets.flat<int64>().data(), indices.data(), input.data(),
+      is_mean, is_sqrtn, default_value, output.data());
+}
+
+template <typename T, typename Index, typename SegmentId>
+Status SparseSegmentGradFunctor<T, Index, SegmentId>::operator()(
+    OpKernelContext* ctx, bool is_sqrtn,
+    typename TTypes<T, 2>::ConstTensor input,
+    typename TTypes<Index>::ConstVec indices,
+    typename TTypes<SegmentId>::ConstVec segment_ids,
+    typename TTypes<T, 2>::Tensor output) {
+  if (output.size() == 0) {
+    return Status::OK();
+  }
+  const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+  GpuLaunchConfig config = GetGpuLaunchConfig(output.size(), d);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(SetZero<T>, config.block_count,
+                                     config.thread_per_block, 0, d.stream(),
+                                     output.size(), output.data()));
+  const int64 num_ids = indices.size();
+  const int64 num_segments = input.dimension(0);
+  const int64 num_cols = input.dimension(1);
+  if (num_ids == 0 || num_cols == 0) {
+    return Status::OK();
+  }
+  Tensor offsets;
+  TF_RETURN_IF_ERROR(ComputeSegmentOffsets<SegmentId>(ctx, segment_ids,
+                                                      num_segments, &offsets));
+  config = GetGpuLaunchConfig(num_ids * num_cols, d);
+  return GpuLaunchKernel(
+      SparseSegmentGradKernel<T, Index, SegmentId>, config.block_count,
+      config.thread_per_block, 0, d.stream(), num_ids, num_cols, num_segments,
+      output.dimension(0), offsets.flat<int64>().data(), indices.data(),
+      segment_ids.data(), input.data(), is_sqrtn, output.data());
+}
+
 #define DEFINE_SORTED_GPU_SPECS_INDEX(T, Index) \
   template struct SegmentSumFunctor<T, Index>
 
@@ -247,12 +445,26 @@ TF_CALL_int32(DEFINE_SUM_GPU_SPECS);
 TF_CALL_COMPLEX_TYPES(DEFINE_SUM_GPU_SPECS);
 #endif
 
+#define DEFINE_SPARSE_GPU_SPECS_INDEX(T, Index)                   \
+  template struct SparseSegmentReductionFunctor<T, Index, int32>; \
+  template struct SparseSegmentReductionFunctor<T, Index, int64>; \
+  template struct SparseSegmentGradFunctor<T, Index, int32>;      \
+  template struct SparseSegmentGradFunctor<T, Index, int64>
+
+#define DEFINE_SPARSE_GPU_SPECS(T)         \
+  DEFINE_SPARSE_GPU_SPECS_INDEX(T, int32); \
+  DEFINE_SPARSE_GPU_SPECS_INDEX(T, int64);
+
+TF_CALL_GPU_NUMBER_TYPES(DEFINE_SPARSE_GPU_SPECS);
+
 #undef DEFINE_SORTED_GPU_SPECS_INDEX
 #undef DEFINE_SORTED_GPU_SPECS
 #undef DEFINE_REAL_UNSORTED_GPU_SPECS_INDEX
 #undef DEFINE_SUM_UNSORTED_GPU_SPECS_INDEX
 #undef DEFINE_REAL_GPU_SPECS
 #undef DEFINE_SUM_GPU_SPECS
+#undef DEFINE_SPARSE_GPU_SPECS_INDEX
+#undef DEFINE_SPARSE_GPU_SPECS
 
 }  // namespace functor
 }  // namespace tensorflow
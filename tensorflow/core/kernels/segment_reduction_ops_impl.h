@@ -38,7 +38,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -508,67 +511,74 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    Tensor temp;
-    if (input.dtype() == DT_BFLOAT16) {
-      temp = tensorflow::Tensor(DT_FLOAT, output_shape);
-    }
-    auto temp_flat = temp.flat_outer_dims<float>();
-
-    int64 start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
-    SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      SegmentId next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
+    // Find where each segment starts, and check that the segment ids are
+    // sorted and in range.
+    std::vector<int64> segment_starts;
+    std::vector<SegmentId> segment_ids_seen;
+    for (int64 i = 0; i < num_indices; ++i) {
+      const SegmentId out_index = internal::SubtleMustCopy(segment_vec(i));
+      if (!segment_ids_seen.empty()) {
+        if (out_index == segment_ids_seen.back()) continue;
+        OP_REQUIRES(context, segment_ids_seen.back() < out_index,
                     errors::InvalidArgument("segment ids are not increasing"));
       }
-
       OP_REQUIRES(
           context, FastBoundsCheck(out_index, output_rows),
           errors::InvalidArgument(
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
-      }
-
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(out_index);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-      if (end > num_indices) break;
+      segment_starts.push_back(i);
+      segment_ids_seen.push_back(out_index);
     }
+    const int64 num_segments = segment_starts.size();
+    segment_starts.push_back(num_indices);
+
+    // Shards are balanced by the number of rows they gather rather than by
+    // the number of segments. Each segment, and the gap of missing segments
+    // before it, is reduced by the shard that holds its first index.
+    mutex mu;
+    int64 bad_offset = num_indices;
+    auto reduce_segments = [&](int64 begin, int64 end) {
+      const int64 first = std::lower_bound(segment_starts.begin(),
+                                           segment_starts.end() - 1, begin) -
+                          segment_starts.begin();
+      std::vector<Accumulator<T>> scratch(
+          std::min<int64>(num_col, kSegmentBlockCols));
+      for (int64 s = first; s < num_segments && segment_starts[s] < end; ++s) {
+        const SegmentId out_index = segment_ids_seen[s];
+        const SegmentId gap_start = s > 0 ? segment_ids_seen[s - 1] + 1 : 0;
+        if (out_index > gap_start) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              out_index - gap_start, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(gap_start, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+        const int64 start = segment_starts[s];
+        const int64 offset =
+            ReduceSegment(input_flat, indices_vec, start,
+                          segment_starts[s + 1] - start,
+                          &output_flat(out_index, 0), scratch.data());
+        if (offset >= 0) {
+          mutex_lock l(mu);
+          bad_offset = std::min(bad_offset, start + offset);
+          return;
+        }
+      }
+    };
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_indices,
+          num_col * Eigen::TensorOpCost::AddCost<T>() + 10, reduce_segments);
+    OP_REQUIRES(context, bad_offset == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_offset, "] == ",
+                    bad_offset < num_indices ? indices_vec(bad_offset) : 0,
+                    " out of range [0, ", input_flat.dimension(0), ")"));
 
     // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index = segment_ids_seen.back() + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -579,24 +589,15 @@ class SparseSegmentReductionOpBase : public OpKernel {
   }
 
  private:
-  template <typename Tin>
-  using EnableIfBfloat16 =
-      typename std::enable_if<std::is_same<Tin, bfloat16>::value, int>::type;
-  template <typename Tin>
-  using EnableIfNotBfloat16 =
-      typename std::enable_if<!std::is_same<Tin, bfloat16>::value, int>::type;
-
-  template <typename Tin, typename Tindex, EnableIfNotBfloat16<Tin> = 0>
-  EIGEN_ALWAYS_INLINE auto fetch_val(
-      const typename TTypes<Tin>::ConstMatrix& input_flat, Tindex index) {
-    return input_flat.template chip<0>(index);
-  }
+  // Number of columns reduced at a time. The accumulator for a block stays in
+  // L1 cache while the rows of the segment are streamed through it.
+  static constexpr int64 kSegmentBlockCols = 1024;
 
-  template <typename Tin, typename Tindex, EnableIfBfloat16<Tin> = 0>
-  EIGEN_ALWAYS_INLINE auto fetch_val(
-      const typename TTypes<Tin>::ConstMatrix& input_flat, Tindex index) {
-    return input_flat.template chip<0>(index).template cast<float>();
-  }
+  // bfloat16 is accumulated in float.
+  template <typename Tin>
+  using Accumulator =
+      typename std::conditional<std::is_same<Tin, bfloat16>::value, float,
+                                Tin>::type;
 
   template <typename Tout>
   EIGEN_ALWAYS_INLINE Tout get_scaling_factor(int64 num) {
@@ -610,151 +611,51 @@ class SparseSegmentReductionOpBase : public OpKernel {
     return Tout(1) / m;
   }
 
-  template <typename Tin, typename Tindex, EnableIfNotBfloat16<Tin> = 0>
-  int64 Reduce(
-      const typename TTypes<Tin>::ConstMatrix& input_flat,
-      const typename TTypes<Tindex>::ConstVec& indices_vec, int64 start,
-      int64 num, Eigen::TensorChippingOp<0, typename TTypes<Tin>::Matrix> out,
-      Eigen::TensorChippingOp<0, typename TTypes<float>::Matrix> temp) {
-    return ReduceImpl<Tin, Tindex, Tin>(input_flat, indices_vec, start, num,
-                                        out, get_scaling_factor<Tin>(num));
-  }
-
-  template <typename Tin, typename Tindex, EnableIfBfloat16<Tin> = 0>
-  int64 Reduce(
-      const typename TTypes<Tin>::ConstMatrix& input_flat,
-      const typename TTypes<Tindex>::ConstVec& indices_vec, int64 start,
-      int64 num, Eigen::TensorChippingOp<0, typename TTypes<Tin>::Matrix> out,
-      Eigen::TensorChippingOp<0, typename TTypes<float>::Matrix> temp) {
-    int64 res =
-        ReduceImpl<Tin, Tindex, float>(input_flat, indices_vec, start, num,
-                                       temp, get_scaling_factor<float>(num));
-    out = temp.template cast<bfloat16>();
-    return res;
-  }
-
-  template <typename Tin, typename Tindex, typename Tout>
-  int64 ReduceImpl(
-      const typename TTypes<Tin>::ConstMatrix& input_flat,
-      const typename TTypes<Tindex>::ConstVec& indices_vec, int64 start,
-      int64 num, Eigen::TensorChippingOp<0, typename TTypes<Tout>::Matrix> out,
-      const Tout scaling_factor) {
-#define INDEX(n, i)                               \
-  const auto index##n = indices_vec(start + (i)); \
-  if (!FastBoundsCheck(index##n, input_flat.dimension(0))) return (i);
-
-#define L(n) fetch_val<Tin, Tindex>(input_flat, index##n)
-
-    if (num == 1) {
-      INDEX(0, 0);
-      out = L(0);
-    } else {
-      int64 r = num & 7;
-      switch (r) {
-        case 2: {
-          INDEX(0, 0);
-          INDEX(1, 1);
-          out = (L(0) + L(1)) * scaling_factor;
-          break;
-        }
-        case 3: {
-          INDEX(0, 0);
-          INDEX(1, 1);
-          INDEX(2, 2);
-          out = (L(0) + L(1) + L(2)) * scaling_factor;
-          break;
-        }
-        case 4: {
-          INDEX(0, 0);
-          INDEX(1, 1);
-          INDEX(2, 2);
-          INDEX(3, 3);
-          out = (L(0) + L(1) + L(2) + L(3)) * scaling_factor;
-          break;
-        }
-        case 5: {
-          INDEX(0, 0);
-          INDEX(1, 1);
-          INDEX(2, 2);
-          INDEX(3, 3);
-          INDEX(4, 4);
-          out = (L(0) + L(1) + L(2) + L(3) + L(4)) * scaling_factor;
-          break;
-        }
-        case 6: {
-          INDEX(0, 0);
-          INDEX(1, 1);
-          INDEX(2, 2);
-          INDEX(3, 3);
-          INDEX(4, 4);
-          INDEX(5, 5);
-          out = (L(0) + L(1) + L(2) + L(3) + L(4) + L(5)) * scaling_factor;
-          break;
-        }
-        case 7: {
-          INDEX(0, 0);
-          INDEX(1, 1);
-          INDEX(2, 2);
-          INDEX(3, 3);
-          INDEX(4, 4);
-          INDEX(5, 5);
-          INDEX(6, 6);
-          out =
-              (L(0) + L(1) + L(2) + L(3) + L(4) + L(5) + L(6)) * scaling_factor;
-          break;
-        }
-        case 0: {
-          INDEX(0, 0);
-          INDEX(1, 1);
-          INDEX(2, 2);
-          INDEX(3, 3);
-          INDEX(4, 4);
-          INDEX(5, 5);
-          INDEX(6, 6);
-          INDEX(7, 7);
-          out = (L(0) + L(1) + L(2) + L(3) + L(4) + L(5) + L(6) + L(7)) *
-                scaling_factor;
-          r = 8;
-          break;
-        }
-        case 1: {
-          INDEX(0, 0);
-          INDEX(1, 1);
-          INDEX(2, 2);
-          INDEX(3, 3);
-          INDEX(4, 4);
-          INDEX(5, 5);
-          INDEX(6, 6);
-          INDEX(7, 7);
-          INDEX(8, 8);
-          out = (L(0) + L(1) + L(2) + L(3) + L(4) + L(5) + L(6) + L(7) + L(8)) *
-                scaling_factor;
-          r = 9;
-          break;
+  // Reduces the rows of `input_flat` selected by indices_vec[start, start +
+  // num) into the output row `out`, using `scratch` to accumulate
+  // kSegmentBlockCols columns at a time. Returns the offset from `start` of
+  // the first index that is out of range, or -1.
+  int64 ReduceSegment(const typename TTypes<T>::ConstMatrix& input_flat,
+                      const typename TTypes<Index>::ConstVec& indices_vec,
+                      int64 start, int64 num, T* out,
+                      Accumulator<T>* scratch) {
+    using Tacc = Accumulator<T>;
+    const Index num_rows = input_flat.dimension(0);
+    const int64 num_col = input_flat.dimension(1);
+    for (int64 i = 0; i < num; ++i) {
+      if (!FastBoundsCheck(indices_vec(start + i), num_rows)) return i;
+    }
+    const T* data = input_flat.data();
+    const Tacc scaling_factor = get_scaling_factor<Tacc>(num);
+    for (int64 col = 0; col < num_col; col += kSegmentBlockCols) {
+      const int64 width = std::min(kSegmentBlockCols, num_col - col);
+      typename TTypes<Tacc>::Vec acc(scratch, width);
+      auto row = [&](int64 i) {
+        return typename TTypes<T>::ConstVec(
+            data + indices_vec(start + i) * num_col + col, width);
+      };
+      acc = row(0).template cast<Tacc>();
+      for (int64 i = 1; i < num; ++i) {
+        // The rows are scattered across the input, so fetch the next one
+        // while this one is added.
+        if (i + 1 < num) {
+          port::prefetch<port::PREFETCH_HINT_T0>(
+              data + indices_vec(start + i + 1) * num_col + col);
         }
+        acc += row(i).template cast<Tacc>();
       }
-      for (; r < num; r += 8) {
-        INDEX(0, r);
-        INDEX(1, r + 1);
-        INDEX(2, r + 2);
-        INDEX(3, r + 3);
-        INDEX(4, r + 4);
-        INDEX(5, r + 5);
-        INDEX(6, r + 6);
-        INDEX(7, r + 7);
-        out += L(0) + L(1) + L(2) + L(3) + L(4) + L(5) + L(6) + L(7);
-      }
-      if (is_mean_ && num >= 10) {
-        out = out / static_cast<Tout>(num);
-      }
-      if (is_sqrtn_ && num >= 10) {
-        out = out / static_cast<Tout>(sqrt(num));
+      if (num > 1) {
+        if (num < 10) {
+          acc = acc * scaling_factor;
+        } else if (is_mean_) {
+          acc = acc / static_cast<Tacc>(num);
+        } else if (is_sqrtn_) {
+          acc = acc / static_cast<Tacc>(sqrt(num));
+        }
       }
+      typename TTypes<T>::Vec(out + col, width) = acc.template cast<T>();
     }
-
     return -1;
-#undef L
-#undef INDEX
   }
 
   const bool is_mean_;
@@ -955,6 +856,236 @@ class SparseSegmentSqrtNGradOp
                                                      true /*is_sqrtn*/) {}
 };
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// GPU implementation of the SparseSegmentReduction kernels.  Unlike the CPU
+// kernels, it does not check that 'segment_ids' are sorted or that 'indices'
+// are in range: rows out of range contribute zeros, like in the GPU kernel of
+// Gather, and segments out of range are dropped.
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentReductionGPUOp : public AsyncOpKernel {
+ public:
+  explicit SparseSegmentReductionGPUOp(OpKernelConstruction* context,
+                                       bool is_mean, bool is_sqrtn,
+                                       bool has_num_segments)
+      : AsyncOpKernel(context),
+        is_mean_(is_mean),
+        is_sqrtn_(is_sqrtn),
+        has_num_segments_(has_num_segments) {}
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
+    const Tensor& input = context->input(0);
+    const Tensor& indices = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+
+    OP_REQUIRES_ASYNC(context, TensorShapeUtils::IsVector(indices.shape()),
+                      errors::InvalidArgument("indices should be a vector."),
+                      done);
+    OP_REQUIRES_ASYNC(
+        context, TensorShapeUtils::IsVector(segment_ids.shape()),
+        errors::InvalidArgument("segment_ids should be a vector."), done);
+    const int64 num_indices = indices.NumElements();
+    OP_REQUIRES_ASYNC(context, num_indices == segment_ids.NumElements(),
+                      errors::InvalidArgument(
+                          "segment_ids and indices should have same size."),
+                      done);
+    OP_REQUIRES_ASYNC(
+        context, TensorShapeUtils::IsVectorOrHigher(input.shape()),
+        errors::InvalidArgument("input must be at least rank 1"), done);
+
+    if (has_num_segments_) {
+      const Tensor& num_segments = context->input(3);
+      OP_REQUIRES_ASYNC(
+          context, num_segments.shape().dims() == 0,
+          errors::InvalidArgument("num_segments should be a scalar, not shape ",
+                                  num_segments.shape().DebugString()),
+          done);
+      const int64 output_rows =
+          internal::SubtleMustCopy(num_segments.scalar<int32>()());
+      ComputeOutput(context, output_rows);
+      done();
+      return;
+    }
+    if (num_indices == 0) {
+      ComputeOutput(context, 0);
+      done();
+      return;
+    }
+
+    // The number of output rows is the last segment id plus one, which must
+    // be copied from the device first.
+    se::DeviceMemoryBase last_segment_id_device(
+        const_cast<Tensor&>(segment_ids).template flat<SegmentId>().data() +
+        (num_indices - 1));
+    ScratchSpace<SegmentId> last_segment_id_host(context, 1, /*on_host=*/true);
+    auto stream = context->op_device_context()->stream();
+    OP_REQUIRES_ASYNC(
+        context,
+        stream
+            ->ThenMemcpy(last_segment_id_host.mutable_data(),
+                         last_segment_id_device, sizeof(SegmentId))
+            .ok(),
+        errors::Internal("SparseSegmentReductionGPUOp: failed to copy "
+                         "output_rows from device"),
+        done);
+    context->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
+        stream, [this, context, last_segment_id_host, done]() {
+          // Ensure that within the callback, the proper GPU settings are
+          // configured.
+          auto stream = context->op_device_context()->stream();
+          ScopedActivateExecutorContext scoped_activation{stream->parent()};
+          ComputeOutput(context, *last_segment_id_host.data() + int64{1});
+          done();
+        });
+  }
+
+ private:
+  void ComputeOutput(OpKernelContext* context, int64 output_rows) {
+    OP_REQUIRES(context, output_rows >= 0,
+                errors::InvalidArgument("segment ids must be >= 0"));
+    const Tensor& input = context->input(0);
+    TensorShape output_shape = input.shape();
+    output_shape.set_dim(0, output_rows);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    functor::SparseSegmentReductionFunctor<T, Index, SegmentId> functor;
+    OP_REQUIRES_OK(
+        context,
+        functor(context, is_mean_, is_sqrtn_, T(0),
+                input.flat_outer_dims<T>(), context->input(1).vec<Index>(),
+                context->input(2).vec<SegmentId>(),
+                output->flat_outer_dims<T>()));
+  }
+
+  const bool is_mean_;
+  const bool is_sqrtn_;
+  const bool has_num_segments_;
+};
+
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentSumGPUOp
+    : public SparseSegmentReductionGPUOp<T, Index, SegmentId> {
+ public:
+  explicit SparseSegmentSumGPUOp(OpKernelConstruction* context)
+      : SparseSegmentReductionGPUOp<T, Index, SegmentId>(
+            context, false /*is_mean*/, false /*is_sqrtn*/,
+            false /*has_num_segments*/) {}
+};
+
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentSumWithNumSegmentsGPUOp
+    : public SparseSegmentReductionGPUOp<T, Index, SegmentId> {
+ public:
+  explicit SparseSegmentSumWithNumSegmentsGPUOp(OpKernelConstruction* context)
+      : SparseSegmentReductionGPUOp<T, Index, SegmentId>(
+            context, false /*is_mean*/, false /*is_sqrtn*/,
+            true /*has_num_segments*/) {}
+};
+
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentMeanGPUOp
+    : public SparseSegmentReductionGPUOp<T, Index, SegmentId> {
+ public:
+  explicit SparseSegmentMeanGPUOp(OpKernelConstruction* context)
+      : SparseSegmentReductionGPUOp<T, Index, SegmentId>(
+            context, true /*is_mean*/, false /*is_sqrtn*/,
+            false /*has_num_segments*/) {}
+};
+
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentMeanWithNumSegmentsGPUOp
+    : public SparseSegmentReductionGPUOp<T, Index, SegmentId> {
+ public:
+  explicit SparseSegmentMeanWithNumSegmentsGPUOp(
+      OpKernelConstruction* context)
+      : SparseSegmentReductionGPUOp<T, Index, SegmentId>(
+            context, true /*is_mean*/, false /*is_sqrtn*/,
+            true /*has_num_segments*/) {}
+};
+
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentSqrtNGPUOp
+    : public SparseSegmentReductionGPUOp<T, Index, SegmentId> {
+ public:
+  explicit SparseSegmentSqrtNGPUOp(OpKernelConstruction* context)
+      : SparseSegmentReductionGPUOp<T, Index, SegmentId>(
+            context, false /*is_mean*/, true /*is_sqrtn*/,
+            false /*has_num_segments*/) {}
+};
+
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentSqrtNWithNumSegmentsGPUOp
+    : public SparseSegmentReductionGPUOp<T, Index, SegmentId> {
+ public:
+  explicit SparseSegmentSqrtNWithNumSegmentsGPUOp(
+      OpKernelConstruction* context)
+      : SparseSegmentReductionGPUOp<T, Index, SegmentId>(
+            context, false /*is_mean*/, true /*is_sqrtn*/,
+            true /*has_num_segments*/) {}
+};
+
+// GPU implementation of SparseSegmentMeanGrad and SparseSegmentSqrtNGrad.
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentGradGPUOp : public OpKernel {
+ public:
+  explicit SparseSegmentGradGPUOp(OpKernelConstruction* context,
+                                  bool is_sqrtn)
+      : OpKernel(context), is_sqrtn_(is_sqrtn) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    const Tensor& indices = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+    const Tensor& output_dim0 = context->input(3);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(segment_ids.shape()),
+                errors::InvalidArgument("segment_ids should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(output_dim0.shape()),
+                errors::InvalidArgument("output_dim0 should be a scalar."));
+    OP_REQUIRES(context,
+                indices.NumElements() == segment_ids.NumElements(),
+                errors::InvalidArgument(
+                    "segment_ids and indices should have same size."));
+    const int64 output_rows =
+        internal::SubtleMustCopy(output_dim0.scalar<int32>()());
+    OP_REQUIRES(context, output_rows >= 0,
+                errors::InvalidArgument("output_dim0 must be >= 0"));
+
+    TensorShape output_shape = input.shape();
+    output_shape.set_dim(0, output_rows);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    functor::SparseSegmentGradFunctor<T, Index, SegmentId> functor;
+    OP_REQUIRES_OK(context,
+                   functor(context, is_sqrtn_, input.flat_outer_dims<T>(),
+                           indices.vec<Index>(), segment_ids.vec<SegmentId>(),
+                           output->flat_outer_dims<T>()));
+  }
+
+ private:
+  const bool is_sqrtn_;
+};
+
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentMeanGradGPUOp
+    : public SparseSegmentGradGPUOp<T, Index, SegmentId> {
+ public:
+  explicit SparseSegmentMeanGradGPUOp(OpKernelConstruction* context)
+      : SparseSegmentGradGPUOp<T, Index, SegmentId>(context,
+                                                    false /*is_sqrtn*/) {}
+};
+
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentSqrtNGradGPUOp
+    : public SparseSegmentGradGPUOp<T, Index, SegmentId> {
+ public:
+  explicit SparseSegmentSqrtNGradGPUOp(OpKernelConstruction* context)
+      : SparseSegmentGradGPUOp<T, Index, SegmentId>(context,
+                                                    true /*is_sqrtn*/) {}
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
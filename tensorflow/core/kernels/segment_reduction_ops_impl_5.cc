@@ -116,4 +116,61 @@ REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(double);
 #undef REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE
 #undef REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, index_type) \
+  REGISTER_GPU_SPARSE_KERNELS(type, index_type, int32)                         \
+  REGISTER_GPU_SPARSE_KERNELS(type, index_type, int64)
+#define REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(type)       \
+  REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int32) \
+  REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int64)
+
+#define REGISTER_GPU_SPARSE_KERNELS_FOR_OP(name, type, index_type,       \
+                                           segment_ids_type)             \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("SparseSegment" #name)                                        \
+          .Device(DEVICE_GPU)                                            \
+          .TypeConstraint<type>("T")                                     \
+          .TypeConstraint<index_type>("Tidx")                            \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),              \
+      SparseSegment##name##GPUOp<type, index_type, segment_ids_type>);   \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("SparseSegment" #name "WithNumSegments")                      \
+          .Device(DEVICE_GPU)                                            \
+          .TypeConstraint<type>("T")                                     \
+          .TypeConstraint<index_type>("Tidx")                            \
+          .TypeConstraint<segment_ids_type>("Tsegmentids")               \
+          .TypeConstraint<int32>("Tnumsegments")                         \
+          .HostMemory("num_segments"),                                   \
+      SparseSegment##name##WithNumSegmentsGPUOp<type, index_type,        \
+                                                segment_ids_type>);
+
+#define REGISTER_GPU_SPARSE_KERNELS(type, index_type, segment_ids_type)      \
+  REGISTER_GPU_SPARSE_KERNELS_FOR_OP(Sum, type, index_type, segment_ids_type) \
+  REGISTER_GPU_SPARSE_KERNELS_FOR_OP(Mean, type, index_type,                 \
+                                     segment_ids_type)                       \
+  REGISTER_GPU_SPARSE_KERNELS_FOR_OP(SqrtN, type, index_type,                \
+                                     segment_ids_type)                       \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("SparseSegmentMeanGrad")                                          \
+          .Device(DEVICE_GPU)                                                \
+          .TypeConstraint<type>("T")                                         \
+          .TypeConstraint<index_type>("Tidx")                                \
+          .TypeConstraint<segment_ids_type>("Tsegmentids")                   \
+          .HostMemory("output_dim0"),                                        \
+      SparseSegmentMeanGradGPUOp<type, index_type, segment_ids_type>);       \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("SparseSegmentSqrtNGrad")                                         \
+          .Device(DEVICE_GPU)                                                \
+          .TypeConstraint<type>("T")                                         \
+          .TypeConstraint<index_type>("Tidx")                                \
+          .TypeConstraint<segment_ids_type>("Tsegmentids")                   \
+          .HostMemory("output_dim0"),                                        \
+      SparseSegmentSqrtNGradGPUOp<type, index_type, segment_ids_type>);
+TF_CALL_GPU_NUMBER_TYPES(REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE);
+#undef REGISTER_GPU_SPARSE_KERNELS
+#undef REGISTER_GPU_SPARSE_KERNELS_FOR_OP
+#undef REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE
+#undef REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace tensorflow
@@ -166,4 +166,51 @@ static void BM_SparseSegmentMeanGrad_High(int iters, int size) {
 BENCHMARK(BM_SparseSegmentMeanGrad_Low)->Arg(1000)->Arg(100000);
 BENCHMARK(BM_SparseSegmentMeanGrad_High)->Arg(1000)->Arg(100000);
 
+// Reduces `num_indices` random rows of a [num_rows, num_cols] input into
+// segments of `segment_size` rows each.
+static void SparseSegmentReductionHelper(int iters, const string& op,
+                                         int num_indices, int num_cols,
+                                         int segment_size) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+  const int kNumRows = 100000;
+  Tensor input(DT_FLOAT, TensorShape({kNumRows, num_cols}));
+  input.flat<float>().setRandom();
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  Tensor segments(DT_INT32, TensorShape({num_indices}));
+  auto indices_flat = indices.flat<int32>();
+  auto segments_flat = segments.flat<int32>();
+  for (int i = 0; i < num_indices; ++i) {
+    indices_flat(i) = (i * 7919) % kNumRows;
+    segments_flat(i) = i / segment_size;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), op)
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  testing::UseRealTime();
+  testing::BytesProcessed(static_cast<int64>(iters) * num_indices * num_cols *
+                          sizeof(float));
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+static void BM_SparseSegmentSum(int iters, int num_cols) {
+  SparseSegmentReductionHelper(iters, "SparseSegmentSum", 100000, num_cols,
+                               20);
+}
+
+static void BM_SparseSegmentMean_LongSegments(int iters, int num_cols) {
+  SparseSegmentReductionHelper(iters, "SparseSegmentMean", 100000, num_cols,
+                               5000);
+}
+
+BENCHMARK(BM_SparseSegmentSum)->Arg(16)->Arg(128)->Arg(4096);
+BENCHMARK(BM_SparseSegmentMean_LongSegments)->Arg(16)->Arg(128)->Arg(4096);
+
 }  // namespace tensorflow
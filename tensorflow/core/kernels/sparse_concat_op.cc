@@ -122,6 +122,8 @@ class SparseConcatOp : public OpKernel {
     }
 
     std::vector<sparse::SparseTensor> sp_inputs;
+    thread::ThreadPool* pool =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
     for (int i = 0; i < N; ++i) {
       const TensorShape current_shape(shapes[i].vec<int64>());
       sparse::SparseTensor tensor;
@@ -130,11 +132,11 @@ class SparseConcatOp : public OpKernel {
                          tensor::DeepCopy(inds[i]), tensor::DeepCopy(vals[i]),
                          current_shape, std_order, &tensor));
       sp_inputs.push_back(std::move(tensor));
-      sp_inputs[i].Reorder<T>(concat_order);
+      sp_inputs[i].Reorder<T>(concat_order, pool);
     }
 
     sparse::SparseTensor concat = sparse::SparseTensor::Concat<T>(sp_inputs);
-    concat.Reorder<T>(std_order);
+    concat.Reorder<T>(std_order, pool);
 
     context->set_output(0, concat.indices());
     context->set_output(1, concat.values());
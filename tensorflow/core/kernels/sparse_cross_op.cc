@@ -16,6 +16,7 @@ limitations under the License.
 // Contains OP to generate sparse crosses.
 #include <assert.h>
 
+#include <algorithm>
 #include <limits>
 #include <string>
 #include <vector>
@@ -263,25 +264,72 @@ class OutputUpdater {
   OutputUpdater(const std::vector<int64>& output_start_indices,
                 Tensor* indices_out, Tensor* values_out)
       : output_start_indices_(output_start_indices),
-        indices_out_(indices_out),
-        values_out_(values_out) {}
+        indices_matrix_(indices_out->matrix<int64>()),
+        value_vec_(values_out->vec<OutType>()) {}
 
   void Update(const int64 batch_index, const int64 cross_count,
               const OutType& cross) const {
     const int64 output_index = output_start_indices_[batch_index] + cross_count;
 
-    auto indices_matrix = indices_out_->matrix<int64>();
-    indices_matrix(output_index, 0) = batch_index;
-    indices_matrix(output_index, 1) = cross_count;
+    indices_matrix_(output_index, 0) = batch_index;
+    indices_matrix_(output_index, 1) = cross_count;
 
-    auto value_vec = values_out_->vec<OutType>();
-    value_vec(output_index) = cross;
+    value_vec_(output_index) = cross;
   }
 
  private:
   const std::vector<int64>& output_start_indices_;
-  Tensor* indices_out_;
-  Tensor* values_out_;
+  typename TTypes<int64>::Matrix indices_matrix_;
+  typename TTypes<OutType>::Vec value_vec_;
+};
+
+// ProductIterator generates cartesian products based on indices.
+template <typename InternalType>
+class ProductIterator {
+ public:
+  explicit ProductIterator(
+      const std::vector<std::unique_ptr<ColumnInterface<InternalType>>>&
+          columns,
+      int64 batch_index)
+      : columns_(columns), batch_index_(batch_index) {
+    next_permutation_.resize(columns_.size(), 0);
+    // Sets has_next_ to false if any feature column has 0 features.
+    has_next_ = true;
+    for (int i = 0; i < columns_.size(); i++) {
+      if (columns_[i]->FeatureCount(batch_index_) == 0) {
+        has_next_ = false;
+        break;
+      }
+    }
+  }
+
+  std::vector<int> Next() {
+    std::vector<int> permutation(next_permutation_);
+
+    // Generates next permutation, if available.
+    bool carry = true;
+    for (int i = next_permutation_.size() - 1; i >= 0; i--) {
+      if (carry) {
+        next_permutation_[i] = next_permutation_[i] + 1;
+      }
+      if (next_permutation_[i] == columns_[i]->FeatureCount(batch_index_)) {
+        next_permutation_[i] = 0;
+      } else {
+        carry = false;
+        break;
+      }
+    }
+    has_next_ = !carry;
+    return permutation;
+  }
+
+  bool HasNext() { return has_next_; }
+
+ private:
+  bool has_next_;
+  const std::vector<std::unique_ptr<ColumnInterface<InternalType>>>& columns_;
+  const int64 batch_index_;
+  std::vector<int> next_permutation_;
 };
 
 // Generates the sparse crosses as concatenation of strings.
@@ -305,28 +353,99 @@ class StringCrosser {
     return absl::StrJoin(cross_vec, k_feature_separator_);
   }
 
+  // Writes all crosses of the batches in [begin, end) to `updater`.
+  void GenerateBatches(const int64 begin, const int64 end,
+                       bool unused_strong_hash,
+                       const OutputUpdater<tstring>& updater) const {
+    for (int64 b = begin; b < end; b++) {
+      ProductIterator<InternalType> product_iterator(columns_, b);
+      int64 cross_count = 0;
+      while (product_iterator.HasNext()) {
+        const auto permutation = product_iterator.Next();
+        updater.Update(b, cross_count, Generate(b, permutation, false));
+        cross_count++;
+      }
+    }
+  }
+
  private:
   const std::vector<std::unique_ptr<ColumnInterface<InternalType>>>& columns_;
   const tstring k_feature_separator_;
 };
 
 // Generates the sparse crosses as nested hash to avoid string manipulations.
-class HashCrosser {
+//
+// The features of each column are hashed once per batch, and the hash of
+// every prefix of the current cross is kept while the crosses are
+// enumerated. Advancing to the next cross only rehashes the columns whose
+// feature changed, so a cross costs one FingerprintCat64 on average instead
+// of one per column, and string features are fingerprinted once rather than
+// once per cross they appear in.
+class HashCrosserBase {
  public:
-  HashCrosser(
-      const std::vector<std::unique_ptr<ColumnInterface<int64>>>& columns,
-      const int64 num_buckets, const uint64 hash_key,
-      const tstring k_feature_separator_unused)
-      : columns_(columns), num_buckets_(num_buckets), hash_key_(hash_key) {}
-
-  int64 Generate(const int64 batch_index, const std::vector<int>& permutation,
-                 bool unused_strong_hash) const {
-    // Do the fingerprint concatenation on uint64.
-    uint64 hashed_output = hash_key_;
-    for (size_t i = 0; i < permutation.size(); ++i) {
-      uint64 hash_i = columns_[i]->Feature(batch_index, permutation[i], false);
-      hashed_output = FingerprintCat64(hashed_output, hash_i);
+  // Writes all crosses of the batches in [begin, end) to `updater`, in the
+  // order of ProductIterator.
+  void GenerateBatches(const int64 begin, const int64 end, bool strong_hash,
+                       const OutputUpdater<int64>& updater) const {
+    const int num_columns = columns_.size();
+    if (num_columns == 0) return;
+    std::vector<std::vector<uint64>> features(num_columns);
+    std::vector<size_t> positions(num_columns);
+    std::vector<uint64> prefix_hashes(num_columns);
+    for (int64 b = begin; b < end; b++) {
+      bool has_cross = true;
+      for (int i = 0; i < num_columns && has_cross; i++) {
+        const int64 feature_count = columns_[i]->FeatureCount(b);
+        has_cross = feature_count > 0;
+        features[i].resize(feature_count);
+        for (int64 n = 0; n < feature_count; n++) {
+          features[i][n] = columns_[i]->Feature(b, n, strong_hash);
+        }
+      }
+      if (!has_cross) continue;
+
+      std::fill(positions.begin(), positions.end(), 0);
+      int first_changed = 0;
+      int64 cross_count = 0;
+      while (true) {
+        for (int i = first_changed; i < num_columns; i++) {
+          const uint64 hash_i = features[i][positions[i]];
+          if (i > 0) {
+            prefix_hashes[i] = FingerprintCat64(prefix_hashes[i - 1], hash_i);
+          } else if (seeded_) {
+            prefix_hashes[i] = FingerprintCat64(seed_, hash_i);
+          } else {
+            prefix_hashes[i] = hash_i;
+          }
+        }
+        updater.Update(b, cross_count++,
+                       ToBucket(prefix_hashes[num_columns - 1]));
+
+        // Advances the last column first, carrying into the previous ones.
+        int i = num_columns - 1;
+        for (; i >= 0; i--) {
+          if (++positions[i] < features[i].size()) break;
+          positions[i] = 0;
+        }
+        if (i < 0) break;
+        first_changed = i;
+      }
     }
+  }
+
+ protected:
+  // If `seeded`, the hash of a cross starts from `seed`. Otherwise it starts
+  // from the hash of the feature of the first column.
+  HashCrosserBase(
+      const std::vector<std::unique_ptr<ColumnInterface<int64>>>& columns,
+      const int64 num_buckets, bool seeded, const uint64 seed)
+      : columns_(columns),
+        num_buckets_(num_buckets),
+        seeded_(seeded),
+        seed_(seed) {}
+
+ private:
+  int64 ToBucket(uint64 hashed_output) const {
     // The return value is int64 based on the number of buckets.
     if (num_buckets_ > 0) {
       return hashed_output % num_buckets_;
@@ -336,92 +455,30 @@ class HashCrosser {
     }
   }
 
- private:
   const std::vector<std::unique_ptr<ColumnInterface<int64>>>& columns_;
   const int64 num_buckets_;
-  const uint64 hash_key_;
+  const bool seeded_;
+  const uint64 seed_;
 };
 
-// Generates the sparse crosses as nested hash to avoid string manipulations.
-class HashCrosserV2 {
+// Generates hashed crosses that start from `hash_key`.
+class HashCrosser : public HashCrosserBase {
  public:
-  HashCrosserV2(
+  HashCrosser(
       const std::vector<std::unique_ptr<ColumnInterface<int64>>>& columns,
-      const int64 num_buckets, const uint64 hash_key_unused,
+      const int64 num_buckets, const uint64 hash_key,
       const tstring k_feature_separator_unused)
-      : columns_(columns), num_buckets_(num_buckets) {}
-
-  int64 Generate(const int64 batch_index, const std::vector<int>& permutation,
-                 bool strong_hash) const {
-    // Do the fingerprint concatenation on uint64.
-    uint64 hashed_output =
-        columns_[0]->Feature(batch_index, permutation[0], strong_hash);
-    for (size_t i = 1; i < permutation.size(); ++i) {
-      uint64 hash_i =
-          columns_[i]->Feature(batch_index, permutation[i], strong_hash);
-      hashed_output = FingerprintCat64(hashed_output, hash_i);
-    }
-    // The return value is int64 based on the number of buckets.
-    if (num_buckets_ > 0) {
-      return hashed_output % num_buckets_;
-    } else {
-      // To prevent negative output we take modulo to max int64.
-      return hashed_output % std::numeric_limits<int64>::max();
-    }
-  }
-
- private:
-  const std::vector<std::unique_ptr<ColumnInterface<int64>>>& columns_;
-  const int64 num_buckets_;
+      : HashCrosserBase(columns, num_buckets, /*seeded=*/true, hash_key) {}
 };
 
-// ProductIterator generates cartesian products based on indices.
-template <typename InternalType>
-class ProductIterator {
+// Generates hashed crosses that start from the first feature.
+class HashCrosserV2 : public HashCrosserBase {
  public:
-  explicit ProductIterator(
-      const std::vector<std::unique_ptr<ColumnInterface<InternalType>>>&
-          columns,
-      int64 batch_index)
-      : columns_(columns), batch_index_(batch_index) {
-    next_permutation_.resize(columns_.size(), 0);
-    // Sets has_next_ to false if any feature column has 0 features.
-    has_next_ = true;
-    for (int i = 0; i < columns_.size(); i++) {
-      if (columns_[i]->FeatureCount(batch_index_) == 0) {
-        has_next_ = false;
-        break;
-      }
-    }
-  }
-
-  std::vector<int> Next() {
-    std::vector<int> permutation(next_permutation_);
-
-    // Generates next permutation, if available.
-    bool carry = true;
-    for (int i = next_permutation_.size() - 1; i >= 0; i--) {
-      if (carry) {
-        next_permutation_[i] = next_permutation_[i] + 1;
-      }
-      if (next_permutation_[i] == columns_[i]->FeatureCount(batch_index_)) {
-        next_permutation_[i] = 0;
-      } else {
-        carry = false;
-        break;
-      }
-    }
-    has_next_ = !carry;
-    return permutation;
-  }
-
-  bool HasNext() { return has_next_; }
-
- private:
-  bool has_next_;
-  const std::vector<std::unique_ptr<ColumnInterface<InternalType>>>& columns_;
-  const int64 batch_index_;
-  std::vector<int> next_permutation_;
+  HashCrosserV2(
+      const std::vector<std::unique_ptr<ColumnInterface<int64>>>& columns,
+      const int64 num_buckets, const uint64 hash_key_unused,
+      const tstring k_feature_separator_unused)
+      : HashCrosserBase(columns, num_buckets, /*seeded=*/false, 0) {}
 };
 
 template <bool HASHED_OUTPUT, typename InternalType>
@@ -733,17 +790,8 @@ class SparseCrossOp : public OpKernel {
 
     typename CrossTraits<HASHED_OUTPUT, InternalType>::Updater updater(
         output_start_indices, indices_out, values_out);
-    auto do_work = [&columns, crosser, updater](int64 begin, int64 end) {
-      for (int b = begin; b < end; b++) {
-        ProductIterator<InternalType> product_iterator(columns, b);
-        int64 cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, false));
-          cross_count++;
-        }
-      }
+    auto do_work = [crosser, updater](int64 begin, int64 end) {
+      crosser.GenerateBatches(begin, end, /*strong_hash=*/false, updater);
     };
 
     auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
@@ -795,17 +843,8 @@ class SparseCrossV2Op : public OpKernel {
     StringCrosser<tstring> crosser(columns, 0, 0, separator);
     OutputUpdater<tstring> updater(output_start_indices, indices_out,
                                    values_out);
-    auto do_work = [&columns, crosser, updater](int64 begin, int64 end) {
-      for (int b = begin; b < end; b++) {
-        ProductIterator<tstring> product_iterator(columns, b);
-        int64 cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, false));
-          cross_count++;
-        }
-      }
+    auto do_work = [crosser, updater](int64 begin, int64 end) {
+      crosser.GenerateBatches(begin, end, /*strong_hash=*/false, updater);
     };
 
     auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
@@ -864,18 +903,8 @@ class SparseCrossHashedOp : public OpKernel {
     const tstring unused_sep;
     HashCrosserV2 crosser(columns, num_buckets, 0, unused_sep);
     OutputUpdater<int64> updater(output_start_indices, indices_out, values_out);
-    auto do_work = [&columns, crosser, updater, strong_hash](int64 begin,
-                                                             int64 end) {
-      for (int b = begin; b < end; b++) {
-        ProductIterator<int64> product_iterator(columns, b);
-        int64 cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, strong_hash));
-          cross_count++;
-        }
-      }
+    auto do_work = [crosser, updater, strong_hash](int64 begin, int64 end) {
+      crosser.GenerateBatches(begin, end, strong_hash, updater);
     };
 
     auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
@@ -56,6 +56,7 @@ class Buffer : public ResourceBase {
 
     // If buffer capacity is bounded wait until elements have been removed
     if (IsBounded()) {
+      ++num_waiting_inserters_;
       full_cond_var_.wait(lock, [tuple_bytes, this]() {
         // If there's a memory limit, check if there's space for insertion
         bool memory_limit_valid =
@@ -66,6 +67,7 @@ class Buffer : public ResourceBase {
         // Stop waiting upon success for both conditions
         return capacity_valid && memory_limit_valid;
       });
+      --num_waiting_inserters_;
     }
 
     // Update bytes in the Staging Area
@@ -74,13 +76,14 @@ class Buffer : public ResourceBase {
     // Store tuple
     buf_.push_back(std::move(*tuple));
 
+    const bool has_waiting_removers = num_waiting_removers_ > 0;
     lock.unlock();
     // Notify all removers. Removers
     // may be peeking at a specific element or waiting
     // for the element at the front of the deque.
     // As we don't know the appropriate one to wake up
     // we should wake them all.
-    non_empty_cond_var_.notify_all();
+    if (has_waiting_removers) non_empty_cond_var_.notify_all();
 
     return Status::OK();
   }
@@ -90,7 +93,9 @@ class Buffer : public ResourceBase {
     std::unique_lock<std::mutex> lock(mu_);
 
     // Wait for data if the buffer is empty
+    ++num_waiting_removers_;
     non_empty_cond_var_.wait(lock, [this]() { return !buf_.empty(); });
+    --num_waiting_removers_;
 
     // Move data into the output tuple
     *tuple = std::move(buf_.front());
@@ -107,8 +112,10 @@ class Buffer : public ResourceBase {
     std::unique_lock<std::mutex> lock(mu_);
 
     // Wait if the requested index is not available
+    ++num_waiting_removers_;
     non_empty_cond_var_.wait(
         lock, [index, this]() { return index < this->buf_.size(); });
+    --num_waiting_removers_;
 
     // Place tensors in the output tuple
     for (const auto& tensor : buf_[index]) {
@@ -141,7 +148,7 @@ class Buffer : public ResourceBase {
   // If the buffer is configured for bounded capacity, notify
   // waiting inserters that space is now available
   void notify_inserters_if_bounded(std::unique_lock<std::mutex>* lock) {
-    if (IsBounded()) {
+    if (IsBounded() && num_waiting_inserters_ > 0) {
       lock->unlock();
       // Notify all inserters. The removal of an element
       // may make memory available for many inserters
@@ -173,6 +180,10 @@ class Buffer : public ResourceBase {
   mutable std::mutex mu_;
   std::condition_variable non_empty_cond_var_;
   std::condition_variable full_cond_var_;
+  // Number of threads waiting on each condition variable, so that Put() and
+  // Get() only notify when some thread waits.
+  int num_waiting_removers_ = 0;
+  int num_waiting_inserters_ = 0;
   std::deque<Tuple> buf_;
 };
 
@@ -17,11 +17,11 @@ limitations under the License.
 
 #include <string>
 
-#include "absl/strings/ascii.h"
 #include "unicode/unistr.h"  // from @icu
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/string_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -49,17 +49,22 @@ class StringLowerOp : public OpKernel {
     auto output = output_tensor->flat<tstring>();
 
     if (encoding_.empty()) {
-      for (int64 i = 0; i < input.size(); ++i) {
-        StringPiece entry(input(i));
-        output(i) = absl::AsciiStrToLower(entry);
-      }
+      ParallelForStrings(ctx, input, /*cost_per_byte=*/1,
+                         [&input, &output](int64 start, int64 end) {
+                           for (int64 i = start; i < end; ++i) {
+                             AsciiStrToLower(input(i), &output(i));
+                           }
+                         });
     } else {
       // The validation of utf-8 has already been done in GetAttr above.
-      for (int64 i = 0; i < input.size(); ++i) {
-        icu::UnicodeString us(input(i).c_str(), "UTF-8");
-        us.toLower();
-        us.toUTF8String(output(i));
-      }
+      ParallelForStrings(ctx, input, /*cost_per_byte=*/50,
+                         [&input, &output](int64 start, int64 end) {
+                           for (int64 i = start; i < end; ++i) {
+                             icu::UnicodeString us(input(i).c_str(), "UTF-8");
+                             us.toLower();
+                             us.toUTF8String(output(i));
+                           }
+                         });
     }
   }
 
@@ -41,15 +41,22 @@ class LegacyStringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = Hash64(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    ParallelForStrings(
+        context, input_flat, /*cost_per_byte=*/1,
+        [&input_flat, &output_flat, this](int64 start, int64 end) {
+          // The hashes are computed in place of the bucket ids.
+          uint64* hashes = reinterpret_cast<uint64*>(output_flat.data());
+          Hash64Batch(absl::MakeConstSpan(input_flat.data() + start,
+                                          input_flat.data() + end),
+                      absl::MakeSpan(hashes + start, hashes + end));
+          for (int64 i = start; i < end; ++i) {
+            const uint64 bucket_id = hashes[i] % num_buckets_;
+            // The number of buckets is always in the positive range of int64
+            // so is the resulting bucket_id. Casting the bucket_id from uint64
+            // to int64 is safe.
+            output_flat(i) = static_cast<int64>(bucket_id);
+          }
+        });
   }
 
  private:
@@ -63,7 +70,7 @@ REGISTER_KERNEL_BUILDER(Name("StringToHashBucket").Device(DEVICE_CPU),
                         LegacyStringToHashBucketOp);
 
 REGISTER_KERNEL_BUILDER(Name("StringToHashBucketFast").Device(DEVICE_CPU),
-                        StringToHashBucketOp<Fingerprint64>);
+                        StringToHashBucketOp<Fingerprint64Batch>);
 
 REGISTER_KERNEL_BUILDER(Name("StringToHashBucketStrong").Device(DEVICE_CPU),
                         StringToKeyedHashBucketOp<StrongKeyedHash>);
@@ -18,15 +18,18 @@ limitations under the License.
 
 #include <string>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/string_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
 
-template <uint64 hash(StringPiece)>
+// Hashes the strings with `hash_batch`, e.g. Fingerprint64Batch().
+template <void hash_batch(absl::Span<const tstring>, absl::Span<uint64>)>
 class StringToHashBucketOp : public OpKernel {
  public:
   explicit StringToHashBucketOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -44,15 +47,22 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    ParallelForStrings(
+        context, input_flat, /*cost_per_byte=*/1,
+        [&input_flat, &output_flat, this](int64 start, int64 end) {
+          // The hashes are computed in place of the bucket ids.
+          uint64* hashes = reinterpret_cast<uint64*>(output_flat.data());
+          hash_batch(absl::MakeConstSpan(input_flat.data() + start,
+                                         input_flat.data() + end),
+                     absl::MakeSpan(hashes + start, hashes + end));
+          for (int64 i = start; i < end; ++i) {
+            const uint64 bucket_id = hashes[i] % num_buckets_;
+            // The number of buckets is always in the positive range of int64
+            // so is the resulting bucket_id. Casting the bucket_id from uint64
+            // to int64 is safe.
+            output_flat(i) = static_cast<int64>(bucket_id);
+          }
+        });
   }
 
  private:
@@ -86,15 +96,18 @@ class StringToKeyedHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(key_, input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    ParallelForStrings(
+        context, input_flat, /*cost_per_byte=*/1,
+        [&input_flat, &output_flat, this](int64 start, int64 end) {
+          for (int64 i = start; i < end; ++i) {
+            const uint64 input_hash = hash(key_, input_flat(i));
+            const uint64 bucket_id = input_hash % num_buckets_;
+            // The number of buckets is always in the positive range of int64
+            // so is the resulting bucket_id. Casting the bucket_id from uint64
+            // to int64 is safe.
+            output_flat(i) = static_cast<int64>(bucket_id);
+          }
+        });
   }
 
  private:
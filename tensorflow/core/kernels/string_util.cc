@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/string_util.h"
 
+#include <cstring>
+
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -61,4 +64,64 @@ int32 UTF8StrLen(const string& str) {
   return result;
 }
 
+namespace {
+
+// Converts the ASCII letters in [first, last] by flipping their 0x20 bit,
+// which maps between lower and upper case.
+template <char first, char last>
+void AsciiStrFlipCase(StringPiece in, tstring* out) {
+  const size_t size = in.size();
+  out->resize_uninitialized(size);
+  const char* src = in.data();
+  char* dst = out->mdata();
+
+  // Each byte is classified in its low seven bits, so that additions never
+  // carry into the next byte: adding 0x80 - c sets the high bit of a byte
+  // exactly when its low seven bits are >= c. Bytes that have their own high
+  // bit set are not ASCII and are never converted.
+  constexpr uint64 kOnes = 0x0101010101010101ULL;
+  constexpr uint64 kHighBits = 0x80 * kOnes;
+  size_t i = 0;
+  for (; i + sizeof(uint64) <= size; i += sizeof(uint64)) {
+    uint64 word;
+    std::memcpy(&word, src + i, sizeof(word));
+    const uint64 low_bits = word & ~kHighBits;
+    const uint64 at_least_first = low_bits + (0x80 - first) * kOnes;
+    const uint64 after_last = low_bits + (0x80 - last - 1) * kOnes;
+    const uint64 in_range = at_least_first & ~after_last & ~word & kHighBits;
+    word ^= in_range >> 2;
+    std::memcpy(dst + i, &word, sizeof(word));
+  }
+  for (; i < size; ++i) {
+    const char c = src[i];
+    dst[i] = (c >= first && c <= last) ? c ^ 0x20 : c;
+  }
+}
+
+}  // namespace
+
+void AsciiStrToLower(StringPiece in, tstring* out) {
+  AsciiStrFlipCase<'A', 'Z'>(in, out);
+}
+
+void AsciiStrToUpper(StringPiece in, tstring* out) {
+  AsciiStrFlipCase<'a', 'z'>(in, out);
+}
+
+void ParallelForStrings(OpKernelContext* ctx,
+                        typename TTypes<tstring>::ConstFlat input,
+                        int64 cost_per_byte,
+                        const std::function<void(int64, int64)>& work) {
+  const int64 num_strings = input.size();
+  if (num_strings == 0) return;
+  int64 total_bytes = 0;
+  for (int64 i = 0; i < num_strings; ++i) total_bytes += input(i).size();
+  // Every string has a fixed cost on top of its bytes.
+  const int64 cost_per_string =
+      (total_bytes / num_strings + 1) * cost_per_byte + 10;
+  const auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, num_strings,
+        cost_per_string, work);
+}
+
 }  // namespace tensorflow
@@ -15,6 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_STRING_UTIL_H_
 #define TENSORFLOW_CORE_KERNELS_STRING_UTIL_H_
 
+#include <functional>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/lib/core/status.h"
 
 namespace tensorflow {
@@ -82,6 +86,22 @@ bool BackNUTF8CharPositions(const StringPiece in,
   return utf8_chars_counted == num_utf8_chars_to_shift;
 }
 
+// Writes `in` to `out` with its ASCII letters converted to lower (or upper)
+// case, leaving all other bytes unchanged. `out` is resized once and
+// converted eight bytes at a time, so this is much cheaper than
+// absl::AsciiStrToLower() followed by a copy into the tstring.
+void AsciiStrToLower(StringPiece in, tstring* out);
+void AsciiStrToUpper(StringPiece in, tstring* out);
+
+// Calls `work(start, end)` on shards of [0, input.size()) on the intra-op
+// threads of `ctx`. The cost of each string is estimated as the average
+// length of the strings in `input` times `cost_per_byte`, so that batches of
+// short strings are not split more finely than they are worth.
+void ParallelForStrings(OpKernelContext* ctx,
+                        typename TTypes<tstring>::ConstFlat input,
+                        int64 cost_per_byte,
+                        const std::function<void(int64, int64)>& work);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_STRING_UTIL_H_
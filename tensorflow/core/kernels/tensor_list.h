@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TENSOR_LIST_H_
 #define TENSORFLOW_CORE_KERNELS_TENSOR_LIST_H_
 
+#include <atomic>
+#include <memory>
 #include <utility>
 
 #include "tensorflow/core/framework/tensor.h"
@@ -134,9 +136,28 @@ class TensorList {
     out.max_num_elements = max_num_elements;
     // This performs a copy of the std::vector.
     out.tensors_->values_ = tensors_->values_;
+    out.tensors_->contiguous_storage_ = tensors_->contiguous_storage_;
     return out;
   }
 
+  // Storage that TensorListPushBack copies the elements of some lists to, so
+  // that TensorListStack can return them without copying.  `buffer` has shape
+  // [capacity] + element_shape, and its first `size` rows are used by the
+  // elements of the list and of its copies, which share the storage.  Only a
+  // list whose elements are all the used rows may append to the storage, by
+  // claiming the next row.
+  struct ContiguousStorage {
+    Tensor buffer;
+    std::atomic<int64> size{0};
+  };
+
+  std::shared_ptr<ContiguousStorage>& contiguous_storage() {
+    return tensors_->contiguous_storage_;
+  }
+  const std::shared_ptr<ContiguousStorage>& contiguous_storage() const {
+    return tensors_->contiguous_storage_;
+  }
+
   // Is this TensorList the only one with a reference to the underlying
   // container?
   bool RefCountIsOne() const { return tensors_->RefCountIsOne(); }
@@ -145,6 +166,7 @@ class TensorList {
   class Tensors : public core::RefCounted {
    public:
     std::vector<Tensor> values_;
+    std::shared_ptr<ContiguousStorage> contiguous_storage_;
   };
   Tensors* tensors_;
 };
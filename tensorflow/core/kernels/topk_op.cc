@@ -99,6 +99,141 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+namespace {
+
+// Rows shorter than this are never split across threads.
+constexpr int64 kMinTopKChunkCols = 1 << 15;
+
+// Returns the number of chunks that each row should be split into, so that
+// a few long rows still keep all threads busy. Returns 1 if sharding by row
+// is enough.
+int64 NumTopKChunksPerRow(int64 num_rows, int64 num_cols, int k,
+                          int num_threads) {
+  if (k >= num_cols || num_rows >= num_threads) return 1;
+  // Every chunk keeps k candidates for the merge, so it should be much
+  // longer than k.
+  const int64 max_chunks =
+      num_cols / std::max(kMinTopKChunkCols, 4 * static_cast<int64>(k));
+  const int64 wanted_chunks = (num_threads + num_rows - 1) / num_rows;
+  return std::max<int64>(1, std::min(max_chunks, wanted_chunks));
+}
+
+// Orders indices into `row` by decreasing value, and by increasing index
+// among equal values.
+template <typename T>
+struct StableGreater {
+  bool operator()(const int32 a, const int32 b) const {
+    if (row[b] < row[a]) {
+      return true;
+    } else if (row[b] > row[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  }
+
+  const T* row;
+};
+
+// Collects into `top` the indices of the k largest elements of
+// row[begin, end), in the order of StableGreater, which is also the order
+// of the single-threaded kernel.
+//
+// The candidates are kept in a heap whose front is the worst of them.
+// Elements are visited in increasing index order, so an element can only
+// replace a candidate if its value is strictly larger than the worst one.
+// Most elements of a long row fail that test, so it is done for a block of
+// elements at a time, in a loop without branches that the compiler can
+// vectorize.
+template <typename T>
+void ChunkTopK(const T* row, int32 begin, int32 end, int k,
+               std::vector<int32>* top) {
+  const StableGreater<T> better{row};
+  top->clear();
+  int32 c = begin;
+  for (; c < end && static_cast<int>(top->size()) < k; ++c) {
+    top->push_back(c);
+    std::push_heap(top->begin(), top->end(), better);
+  }
+  if (top->empty()) return;
+
+  constexpr int32 kBlockSize = 64;
+  T threshold = row[top->front()];
+  while (c < end) {
+    const int32 block_end = std::min(end, c + kBlockSize);
+    bool any_above = false;
+    for (int32 i = c; i < block_end; ++i) {
+      any_above |= row[i] > threshold;
+    }
+    if (any_above) {
+      for (int32 i = c; i < block_end; ++i) {
+        if (!(row[i] > threshold)) continue;
+        std::pop_heap(top->begin(), top->end(), better);
+        top->back() = i;
+        std::push_heap(top->begin(), top->end(), better);
+        threshold = row[top->front()];
+      }
+    }
+    c = block_end;
+  }
+}
+
+// Computes the top k of each row by splitting the rows into
+// `chunks_per_row` chunks, finding the top k of every chunk in parallel,
+// and then merging the candidates of each row. The output is always sorted.
+template <typename T>
+void ChunkedTopK(OpKernelContext* context, int k,
+                 const typename TTypes<T, 2>::ConstTensor& input,
+                 const int64 num_rows, const int64 num_cols,
+                 const int64 chunks_per_row,
+                 typename TTypes<T, 2>::Tensor values,
+                 typename TTypes<int, 2>::Tensor indices) {
+  const auto& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const int64 chunk_cols = (num_cols + chunks_per_row - 1) / chunks_per_row;
+  std::vector<std::vector<int32>> candidates(num_rows * chunks_per_row);
+
+  const double cmp_cost = Eigen::TensorOpCost::AddCost<T>();
+  const int64 chunk_cost = static_cast<int64>(
+      cmp_cost * chunk_cols +
+      4 * cmp_cost * k * Eigen::numext::log2(static_cast<float>(k + 1)));
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        num_rows * chunks_per_row, chunk_cost,
+        [&](int64 start, int64 limit) {
+          for (int64 i = start; i < limit; ++i) {
+            const int64 row = i / chunks_per_row;
+            const int64 chunk = i % chunks_per_row;
+            const int32 begin = std::min(num_cols, chunk * chunk_cols);
+            const int32 end = std::min(num_cols, (chunk + 1) * chunk_cols);
+            ChunkTopK(&input(row, 0), begin, end, k, &candidates[i]);
+          }
+        });
+
+  const int64 merge_cost = static_cast<int64>(
+      4 * cmp_cost * chunks_per_row * k *
+      Eigen::numext::log2(static_cast<float>(k + 1)));
+  Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+        merge_cost, [&](int64 start, int64 limit) {
+          std::vector<int32> merged;
+          for (int64 b = start; b < limit; ++b) {
+            const T* row = &input(b, 0);
+            merged.clear();
+            for (int64 chunk = 0; chunk < chunks_per_row; ++chunk) {
+              const auto& chunk_top = candidates[b * chunks_per_row + chunk];
+              merged.insert(merged.end(), chunk_top.begin(), chunk_top.end());
+            }
+            std::partial_sort(merged.begin(), merged.begin() + k, merged.end(),
+                              StableGreater<T>{row});
+            for (int i = 0; i < k; ++i) {
+              indices(b, i) = merged[i];
+              values(b, i) = row[merged[i]];
+            }
+          }
+        });
+}
+
+}  // namespace
+
 template <typename T>
 struct TopKFunctor<CPUDevice, T> {
   static EIGEN_ALWAYS_INLINE Status
@@ -136,6 +271,15 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const int64 chunks_per_row = NumTopKChunksPerRow(
+        num_rows, num_cols, k, worker_threads.num_threads);
+    if (chunks_per_row > 1) {
+      ChunkedTopK<T>(context, k, input, num_rows, num_cols, chunks_per_row,
+                     values, indices);
+      return Status::OK();
+    }
+
     auto SortIndices = [&](int start_batch, int limit_batch) {
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -221,7 +365,6 @@ struct TopKFunctor<CPUDevice, T> {
     const int64 final_cost = (total_cost >= static_cast<double>(kint64max))
                                  ? kint64max
                                  : static_cast<int64>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
@@ -19,6 +19,10 @@ limitations under the License.
 
 namespace tensorflow {
 
+StripedRowLocks* StripedRowLocks::Global() {
+  static StripedRowLocks* locks = new StripedRowLocks;
+  return locks;
+}
 
 void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
                                      int output) {
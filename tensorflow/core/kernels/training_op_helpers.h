@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/dense_update_functor.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
@@ -188,6 +189,34 @@ VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
                                  std::move(shared_locks));
 }
 
+// A fixed pool of mutexes that serializes concurrent updates of a single row of
+// a variable, for kernels that hold the variable's own mutex only in shared
+// mode. Rows are mapped to stripes by the address of their first element, so
+// every kernel updating the same buffer agrees on the stripe for a row.
+class StripedRowLocks {
+ public:
+  static constexpr int kNumStripes = 4096;
+
+  // Returns the process-wide lock table.
+  static StripedRowLocks* Global();
+
+  // Returns the mutex guarding the row that starts at `row`.
+  mutex* ForRow(const void* row) {
+    const uint64 address = reinterpret_cast<uintptr_t>(row);
+    const uint64 hash = (address >> 4) * 0x9E3779B97F4A7C15ULL;
+    return &stripes_[(hash >> 32) % kNumStripes].mu;
+  }
+
+ private:
+  // Pads each mutex to its own cache line so that neighbouring stripes do not
+  // contend.
+  struct Stripe {
+    mutex mu;
+    char padding[64];
+  };
+  Stripe stripes_[kNumStripes];
+};
+
 void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
                                      int output);
 
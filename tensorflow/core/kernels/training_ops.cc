@@ -17,7 +17,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #ifdef TENSORFLOW_USE_SYCL
 #include "tensorflow/core/common_runtime/sycl/sycl_util.h"
@@ -2952,6 +2955,392 @@ TF_CALL_double(REGISTER_CPU_KERNELS);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+namespace {
+
+// Returns the partition that owns row `index` in the fused sparse-apply
+// kernels.
+template <typename Tindex>
+inline int64 FusedSparseApplyPartition(Tindex index, int64 num_partitions) {
+  const uint64 hash =
+      static_cast<uint64>(static_cast<int64>(index)) * 0x9E3779B97F4A7C15ULL;
+  return (hash >> 32) % num_partitions;
+}
+
+// Calls `fn(index, grad_row)` exactly once for every distinct value in
+// `indices`, where `grad_row` points at the sum of all rows of `grad` with that
+// index. The distinct indices are split by hash into disjoint partitions that
+// are deduplicated and applied in parallel, each with its own hash map, so
+// `fn` never sees the same index from two threads at once.
+template <typename T, typename Tindex, typename Fn>
+void ForEachDeduplicatedRow(OpKernelContext* ctx, const Tensor& indices,
+                            const Tensor& grad, int64 inner_dim,
+                            int64 cost_per_row, const Fn& fn) {
+  static constexpr int64 kMinRowsPerPartition = 256;
+
+  const auto indices_vec = indices.vec<Tindex>();
+  const T* grad_data = grad.flat<T>().data();
+  const int64 N = indices_vec.size();
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  const int64 num_partitions = std::max<int64>(
+      1, std::min<int64>(worker_threads->num_threads,
+                         N / kMinRowsPerPartition));
+
+  // Counting sort of the gradient rows by partition.
+  std::vector<int64> partition_starts(num_partitions + 1, 0);
+  std::vector<int64> partition_of(N);
+  for (int64 i = 0; i < N; ++i) {
+    partition_of[i] = FusedSparseApplyPartition(
+        internal::SubtleMustCopy(indices_vec(i)), num_partitions);
+    ++partition_starts[partition_of[i] + 1];
+  }
+  for (int64 p = 0; p < num_partitions; ++p) {
+    partition_starts[p + 1] += partition_starts[p];
+  }
+  std::vector<int64> order(N);
+  {
+    std::vector<int64> next(partition_starts.begin(),
+                            partition_starts.end() - 1);
+    for (int64 i = 0; i < N; ++i) {
+      order[next[partition_of[i]]++] = i;
+    }
+  }
+
+  auto work = [&](int64 start, int64 limit) {
+    for (int64 p = start; p < limit; ++p) {
+      absl::flat_hash_map<Tindex, int64> slots;
+      std::vector<Tindex> unique_indices;
+      std::vector<T> sums;
+      const int64 begin = partition_starts[p];
+      const int64 end = partition_starts[p + 1];
+      slots.reserve(end - begin);
+      for (int64 k = begin; k < end; ++k) {
+        const int64 i = order[k];
+        const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+        const T* g = grad_data + i * inner_dim;
+        auto inserted = slots.emplace(index, unique_indices.size());
+        if (inserted.second) {
+          unique_indices.push_back(index);
+          sums.insert(sums.end(), g, g + inner_dim);
+        } else {
+          T* sum = sums.data() + inserted.first->second * inner_dim;
+          for (int64 j = 0; j < inner_dim; ++j) {
+            sum[j] += g[j];
+          }
+        }
+      }
+      const int64 num_unique = unique_indices.size();
+      for (int64 u = 0; u < num_unique; ++u) {
+        fn(unique_indices[u], sums.data() + u * inner_dim);
+      }
+    }
+  };
+  const int64 cost_per_partition =
+      std::max<int64>(1, cost_per_row * (N / num_partitions));
+  Shard(worker_threads->num_threads, worker_threads->workers, num_partitions,
+        cost_per_partition, work);
+}
+
+// Validates the shapes of `grad` and `indices` against `var` for the fused
+// sparse-apply kernels, checks that every index is in range, and sets
+// `*inner_dim` to the number of elements in one row of `var`.
+template <typename Tindex>
+Status ValidateFusedSparseApplyInputs(const Tensor& var, const Tensor& grad,
+                                      const Tensor& indices,
+                                      int64* inner_dim) {
+  if (!TensorShapeUtils::IsVectorOrHigher(var.shape())) {
+    return errors::InvalidArgument("var must be at least 1 dimensional");
+  }
+  if (!TensorShapeUtils::IsVector(indices.shape())) {
+    return errors::InvalidArgument("indices must be one-dimensional");
+  }
+  if (grad.dims() != var.dims()) {
+    return errors::InvalidArgument("var and grad must have the same rank: ",
+                                   var.shape().DebugString(), " vs. ",
+                                   grad.shape().DebugString());
+  }
+  *inner_dim = 1;
+  for (int d = 1; d < var.dims(); d++) {
+    if (var.dim_size(d) != grad.dim_size(d)) {
+      return errors::InvalidArgument(
+          strings::StrCat("var and grad must match in dimension ", d));
+    }
+    *inner_dim *= grad.dim_size(d);
+  }
+  const int64 N = indices.dim_size(0);
+  if (grad.dim_size(0) != N) {
+    return errors::InvalidArgument(
+        "grad must be the same size as indices in the first dimension.");
+  }
+  if (*inner_dim <= 0) {
+    return errors::InvalidArgument(
+        "Inner dimension should be greater than zero.");
+  }
+  const auto indices_vec = indices.vec<Tindex>();
+  const Tindex first_dim_size = var.dim_size(0);
+  for (int64 i = 0; i < N; ++i) {
+    const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+    if (!FastBoundsCheck(index, first_dim_size)) {
+      return errors::InvalidArgument(strings::StrCat(
+          "Index ", index, " at offset ", i, " in indices is out of range"));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+// Sparse Adagrad update that sums the gradients of repeated indices itself
+// instead of relying on the caller to do so. The variables are only locked in
+// shared mode; each row is updated under its stripe of StripedRowLocks.
+template <typename T, typename Tindex>
+class FusedSparseApplyAdagradV2Op : public OpKernel {
+ public:
+  explicit FusedSparseApplyAdagradV2Op(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+  }
+
+  void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
+    const bool sparse = true;
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, /*do_lock=*/false, sparse, {0, 1});
+    Tensor var;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 0, /*lock_held=*/false, sparse, &var));
+    Tensor accum;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 1, /*lock_held=*/false, sparse, &accum));
+    OP_REQUIRES(
+        ctx, var.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(0)));
+    OP_REQUIRES(
+        ctx, accum.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(1)));
+    OP_REQUIRES(
+        ctx, var.shape().IsSameSize(accum.shape()),
+        errors::InvalidArgument("var and accum do not have the same shape",
+                                var.shape().DebugString(), " ",
+                                accum.shape().DebugString()));
+
+    const Tensor& lr = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar: ",
+                                        lr.shape().DebugString()));
+    const Tensor& epsilon = ctx->input(3);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(epsilon.shape()),
+                errors::InvalidArgument("epsilon is not a scalar: ",
+                                        epsilon.shape().DebugString()));
+    const Tensor& grad = ctx->input(4);
+    const Tensor& indices = ctx->input(5);
+    int64 inner_dim;
+    OP_REQUIRES_OK(ctx, ValidateFusedSparseApplyInputs<Tindex>(
+                            var, grad, indices, &inner_dim));
+    if (indices.NumElements() == 0) return;
+
+    T* var_data = var.flat<T>().data();
+    T* accum_data = accum.flat<T>().data();
+    const T lr_scalar = lr.scalar<T>()();
+    const T epsilon_scalar = epsilon.scalar<T>()();
+    const int64 cost_per_row =
+        inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 3 +
+                     Eigen::TensorOpCost::MulCost<T>() * 2 +
+                     Eigen::TensorOpCost::DivCost<T>());
+    StripedRowLocks* row_locks = StripedRowLocks::Global();
+
+    ForEachDeduplicatedRow<T, Tindex>(
+        ctx, indices, grad, inner_dim, cost_per_row,
+        [&](Tindex index, const T* g) {
+          T* v = var_data + index * inner_dim;
+          T* a = accum_data + index * inner_dim;
+          mutex_lock l(*row_locks->ForRow(v));
+          for (int64 j = 0; j < inner_dim; ++j) {
+            if (update_slots_) {
+              a[j] += g[j] * g[j];
+            }
+            v[j] -= lr_scalar * g[j] /
+                    (Eigen::numext::sqrt(a[j]) + epsilon_scalar);
+          }
+        });
+  }
+
+ private:
+  bool update_slots_;
+};
+
+#define REGISTER_KERNELS(T, Tindices)                                  \
+  REGISTER_KERNEL_BUILDER(Name("ResourceFusedSparseApplyAdagradV2")     \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<T>("T")                  \
+                              .TypeConstraint<Tindices>("Tindices"),   \
+                          FusedSparseApplyAdagradV2Op<T, Tindices>);
+#define REGISTER_CPU_KERNELS(T) \
+  REGISTER_KERNELS(T, int32);   \
+  REGISTER_KERNELS(T, int64);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
+// Sparse FTRL-proximal update, with L2 shrinkage, that sums the gradients of
+// repeated indices itself. Locking follows FusedSparseApplyAdagradV2Op.
+template <typename T, typename Tindex>
+class FusedSparseApplyFtrlOp : public OpKernel {
+ public:
+  explicit FusedSparseApplyFtrlOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr("multiply_linear_by_lr", &multiply_linear_by_lr_));
+  }
+
+  void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
+    const bool sparse = true;
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, /*do_lock=*/false, sparse, {0, 1, 2});
+    Tensor var;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 0, /*lock_held=*/false, sparse, &var));
+    Tensor accum;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 1, /*lock_held=*/false, sparse, &accum));
+    Tensor linear;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 2, /*lock_held=*/false, sparse, &linear));
+    OP_REQUIRES(
+        ctx, var.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(0)));
+    OP_REQUIRES(
+        ctx, accum.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(1)));
+    OP_REQUIRES(
+        ctx, linear.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(2)));
+    OP_REQUIRES(
+        ctx, var.shape().IsSameSize(accum.shape()),
+        errors::InvalidArgument("var and accum do not have the same shape",
+                                var.shape().DebugString(), " ",
+                                accum.shape().DebugString()));
+    OP_REQUIRES(
+        ctx, var.shape().IsSameSize(linear.shape()),
+        errors::InvalidArgument("var and linear do not have the same shape",
+                                var.shape().DebugString(), " ",
+                                linear.shape().DebugString()));
+
+    const Tensor& grad = ctx->input(3);
+    const Tensor& indices = ctx->input(4);
+    int64 inner_dim;
+    OP_REQUIRES_OK(ctx, ValidateFusedSparseApplyInputs<Tindex>(
+                            var, grad, indices, &inner_dim));
+
+    const Tensor& lr = ctx->input(5);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(lr.shape()) &&
+                    lr.scalar<T>()() > static_cast<T>(0),
+                errors::InvalidArgument("lr is not a positive scalar: ",
+                                        lr.shape().DebugString()));
+    const Tensor& l1 = ctx->input(6);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(l1.shape()) &&
+                    l1.scalar<T>()() >= static_cast<T>(0),
+                errors::InvalidArgument("l1 regularization strength is not a "
+                                        "non-negative scalar: ",
+                                        l1.shape().DebugString()));
+    const Tensor& l2 = ctx->input(7);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(l2.shape()) &&
+                    l2.scalar<T>()() >= static_cast<T>(0),
+                errors::InvalidArgument("l2 regularization strength is not a "
+                                        "non-negative scalar: ",
+                                        l2.shape().DebugString()));
+    const Tensor& l2_shrinkage = ctx->input(8);
+    OP_REQUIRES(
+        ctx,
+        TensorShapeUtils::IsScalar(l2_shrinkage.shape()) &&
+            l2_shrinkage.scalar<T>()() >= static_cast<T>(0),
+        errors::InvalidArgument("l2 shrinkage regularization strength "
+                                "is not a non-negative scalar: ",
+                                l2_shrinkage.shape().DebugString()));
+    const Tensor& lr_power = ctx->input(9);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(lr_power.shape()) &&
+                    lr_power.scalar<T>()() <= static_cast<T>(0),
+                errors::InvalidArgument("lr_power is not a "
+                                        "non-positive scalar: ",
+                                        lr_power.shape().DebugString()));
+    if (indices.NumElements() == 0) return;
+
+    T* var_data = var.flat<T>().data();
+    T* accum_data = accum.flat<T>().data();
+    T* linear_data = linear.flat<T>().data();
+    const T lr_scalar = lr.scalar<T>()();
+    const T l1_scalar = l1.scalar<T>()();
+    const T l2_scalar = l2.scalar<T>()();
+    const T l2_shrinkage_scalar = l2_shrinkage.scalar<T>()();
+    const T lr_power_scalar = lr_power.scalar<T>()();
+    const int64 cost_per_row =
+        inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 8 +
+                     Eigen::TensorOpCost::MulCost<T>() * 6 +
+                     Eigen::TensorOpCost::DivCost<T>() * 2);
+    StripedRowLocks* row_locks = StripedRowLocks::Global();
+
+    ForEachDeduplicatedRow<T, Tindex>(
+        ctx, indices, grad, inner_dim, cost_per_row,
+        [&](Tindex index, const T* grad_row) {
+          T* v = var_data + index * inner_dim;
+          T* a = accum_data + index * inner_dim;
+          T* l = linear_data + index * inner_dim;
+          mutex_lock lock(*row_locks->ForRow(v));
+          for (int64 j = 0; j < inner_dim; ++j) {
+            const T g =
+                grad_row[j] + static_cast<T>(2) * l2_shrinkage_scalar * v[j];
+            const T updated_a = a[j] + grad_row[j] * grad_row[j];
+            using Eigen::numext::pow;
+            T sigma =
+                pow(updated_a, -lr_power_scalar) - pow(a[j], -lr_power_scalar);
+            if (!multiply_linear_by_lr_) {
+              sigma /= lr_scalar;
+            }
+            const T updated_l =
+                (multiply_linear_by_lr_ ? l[j] + g * lr_scalar - sigma * v[j]
+                                        : l[j] + g - sigma * v[j]);
+            v[j] = FtrlCompute(updated_a, updated_l, lr_scalar, l1_scalar,
+                               l2_scalar, lr_power_scalar,
+                               multiply_linear_by_lr_);
+            a[j] = updated_a;
+            l[j] = updated_l;
+          }
+        });
+  }
+
+ private:
+  bool multiply_linear_by_lr_;
+};
+
+#define REGISTER_KERNELS(T, Tindices)                                \
+  REGISTER_KERNEL_BUILDER(Name("ResourceFusedSparseApplyFtrl")       \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("T")                \
+                              .TypeConstraint<Tindices>("Tindices"), \
+                          FusedSparseApplyFtrlOp<T, Tindices>);
+#define REGISTER_CPU_KERNELS(T) \
+  REGISTER_KERNELS(T, int32);   \
+  REGISTER_KERNELS(T, int64);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyMomentumOp : public OpKernel {
  public:
@@ -15,7 +15,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
+#include <type_traits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -65,12 +67,176 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Edge of the square tiles TransposeTiled works on. A tile of 8-byte
+// elements, read and written, stays well within L1.
+constexpr int64 kTransposeTileSize = 32;
+
+// Transposes a square block of kSize x kSize elements in registers. kSize is
+// the number of elements in an Eigen packet of the same width as T, so the
+// block is loaded, transposed and stored as kSize packets.
+template <typename T>
+struct TransposeBlock {
+  using Scalar = typename std::conditional<sizeof(T) == 4, float, double>::type;
+  using Packet = typename Eigen::internal::packet_traits<Scalar>::type;
+  static constexpr int kSize = Eigen::internal::unpacket_traits<Packet>::size;
+
+  static void Run(const T* in, int64 in_stride, T* out, int64 out_stride) {
+    Eigen::internal::PacketBlock<Packet, kSize> block;
+    for (int k = 0; k < kSize; ++k) {
+      block.packet[k] = Eigen::internal::ploadu<Packet>(
+          reinterpret_cast<const Scalar*>(in + k * in_stride));
+    }
+    Eigen::internal::ptranspose(block);
+    for (int k = 0; k < kSize; ++k) {
+      Eigen::internal::pstoreu(reinterpret_cast<Scalar*>(out + k * out_stride),
+                               block.packet[k]);
+    }
+  }
+};
+
+// Sets out[c * out_stride + r] = in[r * in_stride + c] for r in [0, rows)
+// and c in [0, cols).
+template <typename T>
+void TransposeTile(const T* in, int64 in_stride, T* out, int64 out_stride,
+                   int64 rows, int64 cols) {
+  constexpr int kBlock = TransposeBlock<T>::kSize;
+  int64 r = 0;
+  for (; r + kBlock <= rows; r += kBlock) {
+    int64 c = 0;
+    for (; c + kBlock <= cols; c += kBlock) {
+      TransposeBlock<T>::Run(in + r * in_stride + c, in_stride,
+                             out + c * out_stride + r, out_stride);
+    }
+    for (; c < cols; ++c) {
+      for (int k = 0; k < kBlock; ++k) {
+        out[c * out_stride + r + k] = in[(r + k) * in_stride + c];
+      }
+    }
+  }
+  for (; r < rows; ++r) {
+    for (int64 c = 0; c < cols; ++c) {
+      out[c * out_stride + r] = in[r * in_stride + c];
+    }
+  }
+}
+
+// Transposes 4- and 8-byte elements tile by tile, for any rank. Dimensions
+// that stay adjacent under `perm` are merged first. The input dimension that
+// is contiguous in the output (rows) and the one contiguous in the input
+// (cols) are then cut into tiles, and the tiles of all the remaining
+// dimensions are spread over the device's threads.
+template <typename T>
+void TransposeTiled(const CPUDevice& device, const Tensor& in,
+                    const gtl::ArraySlice<int32> perm, Tensor* out) {
+  if (in.NumElements() == 0) return;
+  internal::TransposePermsVec new_perm;
+  internal::TransposeDimsVec new_dims(in.dims());
+  internal::ReduceTransposeDimensions(in.shape(), perm, &new_perm, &new_dims);
+  const int ndims = new_perm.size();
+  // new_perm holds the output position of each merged input dimension;
+  // out_dims holds the input dimension at each output position.
+  internal::TransposePermsVec out_dims(ndims);
+  for (int i = 0; i < ndims; ++i) out_dims[new_perm[i]] = i;
+
+  // Strides of the merged input dimensions in the input and in the output.
+  internal::TransposeDimsVec in_strides(ndims);
+  internal::TransposeDimsVec out_strides(ndims);
+  int64 stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    in_strides[i] = stride;
+    stride *= new_dims[i];
+  }
+  stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    out_strides[out_dims[i]] = stride;
+    stride *= new_dims[out_dims[i]];
+  }
+  const int col_dim = ndims - 1;
+  const int row_dim = out_dims[ndims - 1];
+  gtl::InlinedVector<int, 8> batch_dims;
+  for (int i = 0; i < ndims; ++i) {
+    if (i != row_dim && i != col_dim) batch_dims.push_back(i);
+  }
+
+  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+  const int64 cols = new_dims[col_dim];
+  // When the innermost dimension does not move, whole rows are copied.
+  const int64 rows = row_dim == col_dim ? 1 : new_dims[row_dim];
+  const int64 tile_rows = row_dim == col_dim ? 1 : kTransposeTileSize;
+  const int64 tile_cols = row_dim == col_dim ? cols : kTransposeTileSize;
+  const int64 row_tiles = (rows + tile_rows - 1) / tile_rows;
+  const int64 col_tiles = (cols + tile_cols - 1) / tile_cols;
+  const int64 num_tiles = in.NumElements() / (rows * cols) * row_tiles *
+                          col_tiles;
+
+  auto transpose_fn = [&](int64 begin, int64 end) {
+    for (int64 tile = begin; tile < end; ++tile) {
+      int64 t = tile;
+      const int64 c0 = (t % col_tiles) * tile_cols;
+      t /= col_tiles;
+      const int64 r0 = (t % row_tiles) * tile_rows;
+      t /= row_tiles;
+      int64 in_offset = 0;
+      int64 out_offset = 0;
+      for (int k = batch_dims.size() - 1; k >= 0; --k) {
+        const int dim = batch_dims[k];
+        const int64 idx = t % new_dims[dim];
+        t /= new_dims[dim];
+        in_offset += idx * in_strides[dim];
+        out_offset += idx * out_strides[dim];
+      }
+      const int64 num_cols = std::min(tile_cols, cols - c0);
+      if (row_dim == col_dim) {
+        std::copy_n(p + in_offset + c0, num_cols, q + out_offset + c0);
+      } else {
+        TransposeTile(p + in_offset + r0 * in_strides[row_dim] + c0,
+                      in_strides[row_dim],
+                      q + out_offset + c0 * out_strides[col_dim] + r0,
+                      out_strides[col_dim], std::min(tile_rows, rows - r0),
+                      num_cols);
+      }
+    }
+  };
+  const int64 tile_elements = tile_rows * tile_cols;
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/tile_elements * sizeof(T),
+                           /*bytes_stored=*/tile_elements * sizeof(T),
+                           /*compute_cycles=*/tile_elements);
+  device.parallelFor(num_tiles, cost, std::move(transpose_fn));
+}
+
+// True for the types TransposeTiled handles.
+template <typename T>
+struct UseTiledTranspose {
+  static constexpr bool value =
+      std::is_integral<T>::value && (sizeof(T) == 4 || sizeof(T) == 8);
+};
+
+template <typename T, bool conjugate,
+          bool = !conjugate && UseTiledTranspose<T>::value>
+struct MaybeTransposeTiled {
+  static bool Run(const CPUDevice& device, const Tensor& in,
+                  const gtl::ArraySlice<int32> perm, Tensor* out) {
+    return false;
+  }
+};
+
+template <typename T, bool conjugate>
+struct MaybeTransposeTiled<T, conjugate, true> {
+  static bool Run(const CPUDevice& device, const Tensor& in,
+                  const gtl::ArraySlice<int32> perm, Tensor* out) {
+    TransposeTiled<T>(device, in, perm, out);
+    return true;
+  }
+};
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if (MaybeTransposeTiled<T, conjugate>::Run(d, in, perm, out)) return;
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -14,8 +14,10 @@ limitations under the License.
 ==============================================================================*/
 
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +71,231 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Inputs with fewer elements than this are uniquified on a single thread.
+constexpr int64 kParallelUniqueMinElements = 1 << 17;
+
+// Returns true if `Tin` is in non-decreasing order.
+template <typename T>
+bool IsSorted(typename TTypes<T>::ConstFlat Tin) {
+  for (Eigen::Index i = 1; i < Tin.size(); ++i) {
+    if (Tin(i) < Tin(i - 1)) return false;
+  }
+  return true;
+}
+
+// Uniquifies sorted input by comparing neighbours. Elements appear in the
+// output in sorted order, which is also the order of first occurrence.
+template <typename T, typename TIndex>
+Status UniqueSorted(OpKernelContext* context, typename TTypes<T>::ConstFlat Tin,
+                    TensorShape output_shape, int64 axis,
+                    typename TTypes<TIndex>::Vec idx_vec, int64* uniq_size) {
+  const Eigen::Index N = Tin.size();
+  TIndex j = 0;
+  for (Eigen::Index i = 0; i < N; ++i) {
+    if (i > 0 && Tin(i) != Tin(i - 1)) ++j;
+    idx_vec(i) = j;
+  }
+  *uniq_size = N > 0 ? static_cast<int64>(j) + 1 : 0;
+
+  output_shape.set_dim(axis, *uniq_size);
+  Tensor* output = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(0, output_shape, &output));
+  auto Tout = output->flat<T>();
+  for (Eigen::Index i = 0; i < N; ++i) {
+    if (i == 0 || Tin(i) != Tin(i - 1)) Tout(idx_vec(i)) = Tin(i);
+  }
+  return Status::OK();
+}
+
+// Uniquifies a large input on the intra-op threads.
+//
+// Elements are partitioned by a hash of their value, so that equal elements
+// land in the same partition, and each partition is uniquified with its own
+// hash map. Partitions keep the positions of their elements in increasing
+// order, so the first occurrence of a value is the one that inserts it. The
+// output index of a value is the number of first occurrences before it,
+// which keeps the output in the same order as the single-threaded kernel.
+template <typename T, typename TIndex>
+Status UniqueInParallel(OpKernelContext* context,
+                        typename TTypes<T>::ConstFlat Tin,
+                        TensorShape output_shape, int64 axis,
+                        typename TTypes<TIndex>::Vec idx_vec,
+                        int64* uniq_size) {
+  const auto& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const int64 N = Tin.size();
+  const int num_threads = worker_threads.num_threads;
+  int partition_bits = 0;
+  while ((1 << partition_bits) < num_threads && partition_bits < 8) {
+    ++partition_bits;
+  }
+  const int num_partitions = 1 << partition_bits;
+  const int64 num_blocks = num_threads;
+  const int64 block_size = (N + num_blocks - 1) / num_blocks;
+  // Every block and partition is a separate unit of work.
+  const int64 cost_per_unit = 1 << 30;
+
+  auto partition_of = [partition_bits](const T& value) -> int {
+    if (partition_bits == 0) return 0;
+    return static_cast<int>(
+        (static_cast<uint64>(value) * 0x9E3779B97F4A7C15ULL) >>
+        (64 - partition_bits));
+  };
+  auto for_each_block = [&](const std::function<void(int64, int64, int64)>&
+                                fn) {
+    Shard(num_threads, worker_threads.workers, num_blocks, cost_per_unit,
+          [&](int64 start, int64 end) {
+            for (int64 b = start; b < end; ++b) {
+              fn(b, std::min(N, b * block_size),
+                 std::min(N, (b + 1) * block_size));
+            }
+          });
+  };
+
+  // 1. Count the elements of each block that fall into each partition.
+  std::vector<int64> offsets(num_blocks * num_partitions, 0);
+  for_each_block([&](int64 b, int64 begin, int64 end) {
+    int64* counts = &offsets[b * num_partitions];
+    for (int64 i = begin; i < end; ++i) ++counts[partition_of(Tin(i))];
+  });
+
+  // 2. Turn the counts into the offset at which each block writes into each
+  // partition, with partitions laid out one after another.
+  std::vector<int64> partition_begin(num_partitions + 1, 0);
+  int64 running = 0;
+  for (int p = 0; p < num_partitions; ++p) {
+    partition_begin[p] = running;
+    for (int64 b = 0; b < num_blocks; ++b) {
+      const int64 count = offsets[b * num_partitions + p];
+      offsets[b * num_partitions + p] = running;
+      running += count;
+    }
+  }
+  partition_begin[num_partitions] = running;
+
+  // 3. Scatter the positions of the elements into their partitions.
+  std::vector<int32> positions(N);
+  for_each_block([&](int64 b, int64 begin, int64 end) {
+    int64* next = &offsets[b * num_partitions];
+    for (int64 i = begin; i < end; ++i) {
+      positions[next[partition_of(Tin(i))]++] = static_cast<int32>(i);
+    }
+  });
+
+  // 4. Uniquify each partition. `local_ids` holds, for each entry of
+  // `positions`, the index of its value among the partition's unique values,
+  // and `first_positions` the position where each of them first occurs.
+  // Marks first occurrences with 1 in `idx_vec`, and all others with 0.
+  std::vector<int32> local_ids(N);
+  std::vector<std::vector<int32>> first_positions(num_partitions);
+  Shard(num_threads, worker_threads.workers, num_partitions, cost_per_unit,
+        [&](int64 start, int64 end) {
+          for (int64 p = start; p < end; ++p) {
+            const int64 begin = partition_begin[p];
+            const int64 size = partition_begin[p + 1] - begin;
+            absl::flat_hash_map<T, int32> uniq;
+            uniq.reserve(size);
+            std::vector<int32>& firsts = first_positions[p];
+            for (int64 k = begin; k < begin + size; ++k) {
+              const int32 i = positions[k];
+              auto it = uniq.emplace(Tin(i), firsts.size());
+              if (it.second) firsts.push_back(i);
+              idx_vec(i) = it.second ? 1 : 0;
+              local_ids[k] = it.first->second;
+            }
+          }
+        });
+
+  // 5. Number the first occurrences in input order, storing each number in
+  // `idx_vec` at the position of the occurrence.
+  std::vector<int64> block_uniques(num_blocks, 0);
+  for_each_block([&](int64 b, int64 begin, int64 end) {
+    int64 count = 0;
+    for (int64 i = begin; i < end; ++i) count += idx_vec(i);
+    block_uniques[b] = count;
+  });
+  running = 0;
+  for (int64 b = 0; b < num_blocks; ++b) {
+    const int64 count = block_uniques[b];
+    block_uniques[b] = running;
+    running += count;
+  }
+  *uniq_size = running;
+  for_each_block([&](int64 b, int64 begin, int64 end) {
+    TIndex next = static_cast<TIndex>(block_uniques[b]);
+    for (int64 i = begin; i < end; ++i) {
+      if (idx_vec(i) == 1) idx_vec(i) = next++;
+    }
+  });
+
+  output_shape.set_dim(axis, *uniq_size);
+  Tensor* output = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(0, output_shape, &output));
+  auto Tout = output->flat<T>();
+
+  // 6. Write the unique values, and the output index of every element.
+  Shard(num_threads, worker_threads.workers, num_partitions, cost_per_unit,
+        [&](int64 start, int64 end) {
+          std::vector<TIndex> output_ids;
+          for (int64 p = start; p < end; ++p) {
+            const std::vector<int32>& firsts = first_positions[p];
+            output_ids.resize(firsts.size());
+            for (size_t l = 0; l < firsts.size(); ++l) {
+              output_ids[l] = idx_vec(firsts[l]);
+              Tout(output_ids[l]) = Tin(firsts[l]);
+            }
+            for (int64 k = partition_begin[p]; k < partition_begin[p + 1];
+                 ++k) {
+              idx_vec(positions[k]) = output_ids[local_ids[k]];
+            }
+          }
+        });
+  return Status::OK();
+}
+
+// `UniqueVector` uniquifies a vector of elements without the generic hash
+// map when a faster algorithm applies, and sets `*done` if it did. Only
+// integer elements are supported: they have a total order and are cheap to
+// hash into partitions.
+template <typename T, typename TIndex, typename Enable = void>
+struct UniqueVector {
+  static Status Compute(OpKernelContext* context,
+                        typename TTypes<T>::ConstFlat Tin,
+                        const TensorShape& output_shape, int64 axis,
+                        typename TTypes<TIndex>::Vec idx_vec, int64* uniq_size,
+                        bool* done) {
+    *done = false;
+    return Status::OK();
+  }
+};
+
+template <typename T, typename TIndex>
+struct UniqueVector<
+    T, TIndex,
+    typename std::enable_if<std::is_integral<T>::value &&
+                            !std::is_same<T, bool>::value>::type> {
+  static Status Compute(OpKernelContext* context,
+                        typename TTypes<T>::ConstFlat Tin,
+                        const TensorShape& output_shape, int64 axis,
+                        typename TTypes<TIndex>::Vec idx_vec, int64* uniq_size,
+                        bool* done) {
+    *done = true;
+    // Checking the order is cheap next to hashing, and stops at the first
+    // element out of order.
+    if (IsSorted<T>(Tin)) {
+      return UniqueSorted<T, TIndex>(context, Tin, output_shape, axis,
+                                     idx_vec, uniq_size);
+    }
+    if (Tin.size() >= kParallelUniqueMinElements &&
+        context->device()->tensorflow_cpu_worker_threads()->num_threads > 1) {
+      return UniqueInParallel<T, TIndex>(context, Tin, output_shape, axis,
+                                         idx_vec, uniq_size);
+    }
+    *done = false;
+    return Status::OK();
+  }
+};
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -150,6 +378,15 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64 N = static_cast<int64>(Tin.size());
 
+      bool done = false;
+      OP_REQUIRES_OK(context, UniqueVector<T, TIndex>::Compute(
+                                  context, Tin, input.shape(), axis, idx_vec,
+                                  &uniq_size, &done));
+      if (done) {
+        if (num_outputs() > 2) ComputeCounts(context, idx_vec, uniq_size);
+        return;
+      }
+
       typename UniqueOpHashMap<T, TIndex>::map_type uniq;
       uniq.reserve(2 * N);
       for (Eigen::Index i = 0, j = 0; i < N; ++i) {
@@ -225,16 +462,20 @@ class UniqueOp : public OpKernel {
       }
     }
 
-    if (num_outputs() > 2) {
-      Tensor* output = nullptr;
-      OP_REQUIRES_OK(context, context->allocate_output(
-                                  2, TensorShape({uniq_size}), &output));
-      auto count_output_vec = output->template vec<TIndex>();
-      count_output_vec.setZero();
-      const int N = idx_vec.size();
-      for (int64 i = 0; i < N; ++i) {
-        count_output_vec(idx_vec(i))++;
-      }
+    if (num_outputs() > 2) ComputeCounts(context, idx_vec, uniq_size);
+  }
+
+ private:
+  void ComputeCounts(OpKernelContext* context,
+                     typename TTypes<TIndex>::Vec idx_vec, int64 uniq_size) {
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                2, TensorShape({uniq_size}), &output));
+    auto count_output_vec = output->template vec<TIndex>();
+    count_output_vec.setZero();
+    const int N = idx_vec.size();
+    for (int64 i = 0; i < N; ++i) {
+      count_output_vec(idx_vec(i))++;
     }
   }
 };
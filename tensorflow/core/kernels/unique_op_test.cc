@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 
@@ -110,6 +112,48 @@ static void BM_Unique_INT32_Repeat(int iters, int dim, int max_int) {
       .Run(iters);
 }
 
+// Uniquifies `dim` int64 ids drawn from `max_int` values, with `num_threads`
+// intra-op threads. A single thread runs the serial hash map kernel.
+static void BM_Unique_INT64(int iters, int dim, int max_int, int num_threads,
+                            bool sorted) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_INT64, TensorShape({dim}));
+  auto input_flat = input.flat<int64>();
+  for (int i = 0; i < dim; ++i) {
+    input_flat(i) = std::rand() % max_int;
+  }
+  if (sorted) {
+    std::sort(input_flat.data(), input_flat.data() + dim);
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Unique")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+  FixupSourceAndSinkEdges(g);
+
+  SessionOptions options;
+  options.config.set_intra_op_parallelism_threads(num_threads);
+
+  testing::BytesProcessed(static_cast<int64>(iters) * dim * sizeof(int64));
+  testing::UseRealTime();
+  testing::StartTiming();
+  test::Benchmark("cpu", g, &options, nullptr, nullptr,
+                  "SINGLE_THREADED_EXECUTOR")
+      .Run(iters);
+}
+
+static void BM_Unique_INT64_Random(int iters, int dim, int num_threads) {
+  BM_Unique_INT64(iters, dim, 1 << 30, num_threads, /*sorted=*/false);
+}
+
+static void BM_Unique_INT64_Sorted(int iters, int dim, int num_threads) {
+  BM_Unique_INT64(iters, dim, 1 << 30, num_threads, /*sorted=*/true);
+}
+
 TensorProto GetRandomStringsTensorProto(int dim, int max_str_len) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_STRING);
@@ -191,6 +235,19 @@ BENCHMARK(BM_Unique_INT32_Repeat)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024);
 
+BENCHMARK(BM_Unique_INT64_Random)
+    ->ArgPair(64 * 1024, 1)
+    ->ArgPair(64 * 1024, 8)
+    ->ArgPair(1024 * 1024, 1)
+    ->ArgPair(1024 * 1024, 8)
+    ->ArgPair(5 * 1024 * 1024, 1)
+    ->ArgPair(5 * 1024 * 1024, 8)
+    ->ArgPair(5 * 1024 * 1024, 32);
+
+BENCHMARK(BM_Unique_INT64_Sorted)
+    ->ArgPair(1024 * 1024, 1)
+    ->ArgPair(5 * 1024 * 1024, 1);
+
 BENCHMARK(BM_Unique_STRING)
     ->Arg(32)
     ->Arg(256)
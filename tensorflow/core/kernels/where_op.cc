@@ -23,8 +23,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/where_op.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <numeric>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -36,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -54,9 +59,15 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
-namespace functor {
-
 namespace {
+
+// Number of input elements in each block of the parallel count and write
+// passes of the CPU kernels.
+constexpr int64 kWhereBlockSize = 1 << 14;
+
+// Number of indices compacted at a time while writing a block.
+constexpr int64 kWhereChunkSize = 512;
+
 template <typename T>
 int64 CountAccumulator(const T* begin, const T* end) {
   return std::accumulate(begin, end, 0LL, [](int64 accum, const T& val) {
@@ -66,63 +77,67 @@ int64 CountAccumulator(const T* begin, const T* end) {
 
 template <>
 int64 CountAccumulator<bool>(const bool* begin, const bool* end) {
-  return std::accumulate(begin, end, 0LL);
+  // Summing the bytes rather than testing them lets the loop vectorize.
+  const uint8* p = reinterpret_cast<const uint8*>(begin);
+  const uint8* p_end = reinterpret_cast<const uint8*>(end);
+  int64 count = 0;
+  while (p != p_end) {
+    // Sums of at most 255 bytes of 0 or 1 fit in a uint8 accumulator.
+    const int64 n = std::min<int64>(p_end - p, 255);
+    uint8 sum = 0;
+    for (int64 i = 0; i < n; ++i) sum += p[i];
+    count += sum;
+    p += n;
+  }
+  return count;
 }
 
-}  // namespace
-
+// Counts the true elements of each kWhereBlockSize block of `input` in
+// parallel, and returns the exclusive prefix sums of the counts, followed by
+// the total.
 template <typename T>
-struct NumTrue<CPUDevice, T, int64> {
-  static Status Compute(OpKernelContext* ctx, const CPUDevice& d,
-                        typename TTypes<T>::ConstFlat input,
-                        TTypes<int64>::UnalignedScalar num_true) {
-    num_true() = CountAccumulator<T>(input.data(), input.data() + input.size());
-    return Status::OK();
-  }
-};
-
-template <int DIMS, typename T, typename TIndex>
-struct Where<CPUDevice, DIMS, T, TIndex> {
-  EIGEN_ALWAYS_INLINE static void WriteIndexRowMajor(
-      typename TTypes<int64>::Matrix output,
-      const typename Eigen::DSizes<TIndex, DIMS>& strides, TIndex true_n,
-      TIndex index) {
-    for (int i = 0; i < DIMS; ++i) {
-      output(true_n, i) = index / strides[i];
-      index -= output(true_n, i) * strides[i];
-    }
-  }
-
-  EIGEN_ALWAYS_INLINE static Status Compute(
-      OpKernelContext* ctx, const CPUDevice& d,
-      typename TTypes<T, DIMS>::ConstTensor input,
-      typename TTypes<int64>::Matrix output, TIndex* found_true) {
-    Eigen::DSizes<Eigen::DenseIndex, DIMS> dims = input.dimensions();
-    Eigen::DSizes<TIndex, DIMS> strides;
-
-    EIGEN_STATIC_ASSERT((static_cast<int>(decltype(input)::Layout) ==
-                         static_cast<int>(Eigen::RowMajor)),
-                        INTERNAL_ERROR_INPUT_SHOULD_BE_ROWMAJOR);
-
-    strides[DIMS - 1] = 1;
-    for (int i = DIMS - 2; i >= 0; --i) {
-      strides[i] = strides[i + 1] * dims[i + 1];
+std::vector<int64> BlockOffsets(OpKernelContext* ctx, const T* input,
+                                int64 size) {
+  const int64 num_blocks = (size + kWhereBlockSize - 1) / kWhereBlockSize;
+  std::vector<int64> offsets(num_blocks + 1, 0);
+  auto count_blocks = [&](int64 begin, int64 end) {
+    for (int64 b = begin; b < end; ++b) {
+      const int64 start = b * kWhereBlockSize;
+      offsets[b + 1] = CountAccumulator<T>(
+          input + start, input + std::min(size, start + kWhereBlockSize));
     }
+  };
+  const auto& worker_threads = *ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        kWhereBlockSize, count_blocks);
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  return offsets;
+}
 
-    Eigen::DenseIndex output_size = output.dimension(0);
-    for (Eigen::DenseIndex n = 0; n < input.size(); ++n) {
-      if (input.data()[n] != T(0)) {
-        if (FastBoundsCheck(*found_true, output_size)) {
-          WriteIndexRowMajor(output, strides, *found_true, n);
-        }
-        ++*found_true;
-      }
+// Calls write(first_row, positions, n) with the positions in [begin, end) of
+// the true elements of `input`, in order, kWhereChunkSize at a time. The
+// positions are compacted without branching on the input. Stops, and
+// returns false, if the block holds more than `max_rows` true elements.
+template <typename T, typename WriteFn>
+bool CompactBlock(const T* input, int64 begin, int64 end, int64 max_rows,
+                  WriteFn write) {
+  int64 positions[kWhereChunkSize];
+  int64 row = 0;
+  for (int64 chunk = begin; chunk < end; chunk += kWhereChunkSize) {
+    const int64 chunk_end = std::min(end, chunk + kWhereChunkSize);
+    int64 n = 0;
+    for (int64 i = chunk; i < chunk_end; ++i) {
+      positions[n] = i;
+      n += (input[i] != T(0));
     }
-    return Status::OK();
+    if (row + n > max_rows) return false;
+    write(row, positions, n);
+    row += n;
   }
-};
+  return row == max_rows;
+}
 
-}  // namespace functor
+}  // namespace
 
 template <typename T>
 class WhereCPUOp : public OpKernel {
@@ -139,56 +154,62 @@ class WhereCPUOp : public OpKernel {
                               "creating costly copies from device."));
 
     const int input_dims = input.dims();
-
-    int64 num_true;
-    TTypes<int64>::UnalignedScalar num_true_t(&num_true);
-
-    Status s = functor::NumTrue<CPUDevice, T, int64>::Compute(
-        context, context->eigen_device<CPUDevice>(), input.flat<T>(),
-        num_true_t);
-    OP_REQUIRES_OK(context, s);
+    OP_REQUIRES(context, input_dims >= 1 && input_dims <= 8,
+                errors::InvalidArgument(
+                    "WhereOp : Unhandled input dimensions: ", input_dims));
+
+    // Count the true elements of each block, then write the indices of every
+    // block to its own rows of the output.
+    const T* input_data = input.flat<T>().data();
+    const int64 size = input.NumElements();
+    const std::vector<int64> offsets =
+        BlockOffsets<T>(context, input_data, size);
+    const int64 num_true = offsets.back();
     TensorShape output_shape({num_true, input_dims});
     Tensor* output = nullptr;
     OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
 
-    // TODO(ebrevdo): Replace single-threaded copy with a
-    // multithreaded block copy by getting block counts above instead
-    // of a global NumTrue, then having each block filled in in
-    // separate threads below.
-    int64 found_true = 0;
-
-#define HANDLE_DIM(NDIM)                                                      \
-  case NDIM: {                                                                \
-    Status s = functor::Where<CPUDevice, NDIM, T, int64>::Compute(            \
-        context, context->eigen_device<CPUDevice>(), input.tensor<T, NDIM>(), \
-        output->matrix<int64>(), &found_true);                                \
-    OP_REQUIRES_OK(context, s);                                               \
-  } break;
-
-    switch (input_dims) {
-      HANDLE_DIM(1);
-      HANDLE_DIM(2);
-      HANDLE_DIM(3);
-      HANDLE_DIM(4);
-      HANDLE_DIM(5);
-      HANDLE_DIM(6);
-      HANDLE_DIM(7);
-      HANDLE_DIM(8);
-
-      default:
-        OP_REQUIRES(context, false,
-                    errors::InvalidArgument(
-                        "WhereOp : Unhandled input dimensions: ", input_dims));
+    Eigen::DSizes<int64, 8> strides;
+    strides[input_dims - 1] = 1;
+    for (int i = input_dims - 2; i >= 0; --i) {
+      strides[i] = strides[i + 1] * input.dim_size(i + 1);
     }
-#undef HANDLE_DIM
+    int64* output_data = output->matrix<int64>().data();
+
+    std::atomic<bool> counts_match(true);
+    auto write_blocks = [&](int64 begin, int64 end) {
+      for (int64 b = begin; b < end; ++b) {
+        int64* block_output = output_data + offsets[b] * input_dims;
+        auto write = [&](int64 row, const int64* positions, int64 n) {
+          int64* out = block_output + row * input_dims;
+          for (int64 j = 0; j < n; ++j) {
+            int64 index = positions[j];
+            for (int i = 0; i < input_dims; ++i) {
+              *out = index / strides[i];
+              index -= *out++ * strides[i];
+            }
+          }
+        };
+        const int64 start = b * kWhereBlockSize;
+        if (!CompactBlock(input_data, start,
+                          std::min(size, start + kWhereBlockSize),
+                          offsets[b + 1] - offsets[b], write)) {
+          counts_match = false;
+        }
+      }
+    };
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          offsets.size() - 1, kWhereBlockSize * input_dims, write_blocks);
 
     OP_REQUIRES(
-        context, found_true == num_true_t(),
+        context, counts_match,
         errors::InvalidArgument(
             "WhereOp: Race condition between counting the number of true "
             "elements and writing them.  When counting, saw ",
-            num_true_t(), " elements; but when writing their indices, saw ",
-            found_true, " elements."));
+            num_true, " elements; but the input changed while writing their "
+            "indices."));
   }
 
  private:
@@ -204,6 +225,87 @@ TF_CALL_bool(REGISTER_WHERE_OP);
 
 #undef REGISTER_WHERE_OP
 
+// Gathers the rows of `params` whose entry in the boolean `mask` is true, like
+// Gather(params, Squeeze(Where(mask))) but without materializing the indices.
+template <typename T>
+class MaskedGatherCPUOp : public OpKernel {
+ public:
+  explicit MaskedGatherCPUOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& params = context->input(0);
+    const Tensor& mask = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(mask.shape()),
+                errors::InvalidArgument("mask must be a vector, got shape ",
+                                        mask.shape().DebugString()));
+    OP_REQUIRES(context, params.dims() >= 1,
+                errors::InvalidArgument("params must be at least 1-D"));
+    OP_REQUIRES(
+        context, params.dim_size(0) == mask.dim_size(0),
+        errors::InvalidArgument("params.shape[0] = ", params.dim_size(0),
+                                " does not match mask.shape[0] = ",
+                                mask.dim_size(0)));
+
+    const bool* mask_data = mask.vec<bool>().data();
+    const int64 size = mask.NumElements();
+    const std::vector<int64> offsets =
+        BlockOffsets<bool>(context, mask_data, size);
+    TensorShape output_shape = params.shape();
+    output_shape.set_dim(0, offsets.back());
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    const int64 row_size = params.NumElements() / params.dim_size(0);
+    const T* params_data = params.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+
+    std::atomic<bool> counts_match(true);
+    auto gather_blocks = [&](int64 begin, int64 end) {
+      for (int64 b = begin; b < end; ++b) {
+        T* block_output = output_data + offsets[b] * row_size;
+        auto write = [&](int64 row, const int64* positions, int64 n) {
+          T* out = block_output + row * row_size;
+          for (int64 j = 0; j < n; ++j) {
+            const T* in = params_data + positions[j] * row_size;
+            std::copy(in, in + row_size, out);
+            out += row_size;
+          }
+        };
+        const int64 start = b * kWhereBlockSize;
+        if (!CompactBlock(mask_data, start,
+                          std::min(size, start + kWhereBlockSize),
+                          offsets[b + 1] - offsets[b], write)) {
+          counts_match = false;
+        }
+      }
+    };
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          offsets.size() - 1, kWhereBlockSize * row_size * sizeof(T),
+          gather_blocks);
+
+    OP_REQUIRES(context, counts_match,
+                errors::InvalidArgument(
+                    "MaskedGather: the mask changed while gathering rows."));
+  }
+
+ private:
+  TF_DISALLOW_COPY_AND_ASSIGN(MaskedGatherCPUOp);
+};
+
+#define REGISTER_MASKED_GATHER_OP(T)                                     \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("_MaskedGather").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      MaskedGatherCPUOp<T>);
+
+TF_CALL_ALL_TYPES(REGISTER_MASKED_GATHER_OP);
+TF_CALL_QUANTIZED_TYPES(REGISTER_MASKED_GATHER_OP);
+
+#undef REGISTER_MASKED_GATHER_OP
+
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 namespace functor {
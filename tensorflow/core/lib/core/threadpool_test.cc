@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/threadpool.h"
 
+#include <stdlib.h>
+
 #include <atomic>
 
 #include "absl/synchronization/barrier.h"
@@ -352,6 +354,89 @@ TEST(ThreadPool, ParallelForWithWorkerId) {
   }
 }
 
+TEST(ThreadPool, ParallelForWorkStealing) {
+  Context outer_context(ContextKind::kThread);
+  for (int num_threads = 1; num_threads < kNumThreads; num_threads++) {
+    for (int64 cost_per_unit : {1, 1000, 1 << 30}) {
+      const int kWorkItems = 1000;
+      std::atomic<bool> work[kWorkItems];
+      ThreadPool pool(Env::Default(), "test", num_threads);
+      for (int i = 0; i < kWorkItems; i++) {
+        work[i] = false;
+      }
+      pool.ParallelForWorkStealing(
+          kWorkItems, cost_per_unit, num_threads + 1,
+          [&outer_context, &work](int64 begin, int64 end) {
+            Context inner_context(ContextKind::kThread);
+            ASSERT_EQ(outer_context, inner_context);
+            for (int64 i = begin; i < end; ++i) {
+              ASSERT_FALSE(work[i].exchange(true));
+            }
+          });
+      for (int i = 0; i < kWorkItems; i++) {
+        ASSERT_TRUE(work[i]);
+      }
+    }
+  }
+}
+
+TEST(ThreadPool, ParallelForWorkStealingMaxParallelism) {
+  const int64 kHugeCost = 1 << 30;
+  ThreadPool pool(Env::Default(), "test", 8);
+  for (int max_parallelism : {1, 2, 4}) {
+    std::atomic<int> running(0);
+    std::atomic<int> max_running(0);
+    pool.ParallelForWorkStealing(
+        64, kHugeCost, max_parallelism,
+        [&running, &max_running](int64 begin, int64 end) {
+          const int now = ++running;
+          int prev = max_running.load();
+          while (prev < now && !max_running.compare_exchange_weak(prev, now)) {
+          }
+          Env::Default()->SleepForMicroseconds(100);
+          --running;
+        });
+    EXPECT_LE(max_running.load(), max_parallelism);
+  }
+}
+
+TEST(ThreadPool, NestedParallelForWorkStealing) {
+  // Every thread of the pool runs an outer shard that blocks on an inner
+  // ParallelFor, which its caller can always finish by itself.
+  constexpr int64 kHugeCost = 1 << 30;
+  for (int num_threads : {1, 2, 4}) {
+    ThreadPool pool(Env::Default(), "test", num_threads);
+    std::atomic<int64> num_done(0);
+    pool.ParallelForWorkStealing(
+        16, kHugeCost, num_threads + 1,
+        [&pool, &num_done, num_threads](int64 begin, int64 end) {
+          for (int64 i = begin; i < end; ++i) {
+            pool.ParallelForWorkStealing(
+                16, kHugeCost, num_threads + 1,
+                [&num_done](int64 start, int64 limit) {
+                  num_done += limit - start;
+                });
+          }
+        });
+    EXPECT_EQ(16 * 16, num_done.load());
+  }
+}
+
+TEST(ThreadPool, ParallelForUsesWorkStealingFromEnvironment) {
+  setenv("TF_WORK_STEALING_PARALLEL_FOR", "true", 1 /* replace */);
+  ThreadPool pool(Env::Default(), "test", 4);
+  unsetenv("TF_WORK_STEALING_PARALLEL_FOR");
+  EXPECT_TRUE(pool.UsesWorkStealingParallelFor());
+  EXPECT_FALSE(
+      ThreadPool(Env::Default(), "test", 4).UsesWorkStealingParallelFor());
+
+  std::atomic<int64> num_done(0);
+  pool.ParallelFor(1000, 1 << 20, [&num_done](int64 begin, int64 end) {
+    num_done += end - begin;
+  });
+  EXPECT_EQ(1000, num_done.load());
+}
+
 TEST(ThreadPool, Parallelism) {
   // Test that if we have N threads and schedule N tasks,
   // all tasks will be scheduled at the same time.
@@ -67,6 +67,18 @@ TEST(Hash, SignedUnsignedIssue) {
   }
 }
 
+TEST(Hash, Batch) {
+  std::vector<tstring> inputs;
+  for (int i = 0; i < 20; ++i) {
+    inputs.emplace_back(std::string(i * 3, 'a' + i));
+  }
+  std::vector<uint64> hashes(inputs.size());
+  Hash64Batch(inputs, absl::MakeSpan(hashes));
+  for (int i = 0; i < inputs.size(); ++i) {
+    EXPECT_EQ(Hash64(inputs[i]), hashes[i]);
+  }
+}
+
 TEST(Hash, HashPtrIsNotIdentityFunction) {
   int* ptr = reinterpret_cast<int*>(0xcafe0000);
   EXPECT_NE(hash<int*>()(ptr), size_t{0xcafe0000});
@@ -0,0 +1,236 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/block_record_io.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/notification.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+uint32 MaskedCrc(const char* data, size_t n) {
+  return crc32c::Mask(crc32c::Value(data, n));
+}
+
+}  // namespace
+
+BlockRecordWriter::BlockRecordWriter(WritableFile* dest,
+                                     const BlockRecordWriterOptions& options)
+    : dest_(dest), options_(options) {}
+
+BlockRecordWriter::~BlockRecordWriter() {
+  if (dest_ != nullptr) {
+    Status s = Close();
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not finish writing file: " << s;
+    }
+  }
+}
+
+Status BlockRecordWriter::WriteRecord(StringPiece data) {
+  if (dest_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Writer not initialized or previously closed");
+  }
+  char header[RecordWriter::kHeaderSize];
+  char footer[RecordWriter::kFooterSize];
+  RecordWriter::PopulateHeader(header, data.data(), data.size());
+  RecordWriter::PopulateFooter(footer, data.data(), data.size());
+  block_.append(header, sizeof(header));
+  block_.append(data.data(), data.size());
+  block_.append(footer, sizeof(footer));
+  if (block_.size() >= options_.block_size) {
+    return WriteBlock();
+  }
+  return Status::OK();
+}
+
+Status BlockRecordWriter::Close() {
+  if (dest_ == nullptr) return Status::OK();
+  Status s;
+  if (!block_.empty()) {
+    s = WriteBlock();
+  }
+  dest_ = nullptr;
+  return s;
+}
+
+Status BlockRecordWriter::WriteBlock() {
+  uLongf compressed_size = compressBound(block_.size());
+  string compressed(compressed_size, '\0');
+  int ret = compress2(reinterpret_cast<Bytef*>(&compressed[0]),
+                      &compressed_size,
+                      reinterpret_cast<const Bytef*>(block_.data()),
+                      block_.size(), options_.compression_level);
+  if (ret != Z_OK) {
+    return errors::Internal("Could not compress a block, zlib error: ", ret);
+  }
+  compressed.resize(compressed_size);
+
+  char header[kBlockHeaderSize];
+  core::EncodeFixed64(header, compressed.size());
+  core::EncodeFixed64(header + sizeof(uint64), block_.size());
+  core::EncodeFixed32(header + 2 * sizeof(uint64),
+                      MaskedCrc(header, 2 * sizeof(uint64)));
+  char footer[kBlockFooterSize];
+  core::EncodeFixed32(footer, MaskedCrc(compressed.data(), compressed.size()));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
+  TF_RETURN_IF_ERROR(dest_->Append(compressed));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  block_.clear();
+  return Status::OK();
+}
+
+struct BlockRecordReader::Block {
+  // The compressed data and its footer, until the block is decompressed.
+  string compressed;
+  uint64 uncompressed_size;
+
+  Notification done;
+  Status status;
+  string data;
+  // The offset of the next record in `data`.
+  size_t position = 0;
+
+  // Checks and decompresses `compressed` into `data`.
+  void Decompress() {
+    const size_t compressed_size =
+        compressed.size() - BlockRecordWriter::kBlockFooterSize;
+    const uint32 masked_crc =
+        core::DecodeFixed32(compressed.data() + compressed_size);
+    if (crc32c::Unmask(masked_crc) !=
+        crc32c::Value(compressed.data(), compressed_size)) {
+      status = errors::DataLoss("corrupted block");
+    } else {
+      data.resize(uncompressed_size);
+      uLongf size = uncompressed_size;
+      int ret = uncompress(reinterpret_cast<Bytef*>(&data[0]), &size,
+                           reinterpret_cast<const Bytef*>(compressed.data()),
+                           compressed_size);
+      if (ret != Z_OK || size != uncompressed_size) {
+        status = errors::DataLoss("could not decompress a block, zlib error: ",
+                                  ret);
+      }
+    }
+    string().swap(compressed);
+    done.Notify();
+  }
+};
+
+BlockRecordReader::BlockRecordReader(RandomAccessFile* file,
+                                     thread::ThreadPool* pool,
+                                     int max_blocks_in_flight)
+    : file_(file),
+      pool_(pool),
+      max_blocks_in_flight_(std::max(max_blocks_in_flight, 1)) {}
+
+BlockRecordReader::~BlockRecordReader() {
+  for (const auto& block : blocks_) {
+    block->done.WaitForNotification();
+  }
+}
+
+Status BlockRecordReader::ReadBlocks() {
+  while (!end_of_file_ && blocks_.size() < static_cast<size_t>(max_blocks_in_flight_)) {
+    char header[BlockRecordWriter::kBlockHeaderSize];
+    StringPiece result;
+    Status s = file_->Read(offset_, sizeof(header), &result, header);
+    if (errors::IsOutOfRange(s) && result.empty()) {
+      end_of_file_ = true;
+      break;
+    }
+    if (result.size() != sizeof(header)) {
+      if (errors::IsOutOfRange(s)) {
+        return errors::DataLoss("truncated block header at ", offset_);
+      }
+      return s;
+    }
+    const uint32 masked_crc =
+        core::DecodeFixed32(result.data() + 2 * sizeof(uint64));
+    if (crc32c::Unmask(masked_crc) !=
+        crc32c::Value(result.data(), 2 * sizeof(uint64))) {
+      return errors::DataLoss("corrupted block header at ", offset_);
+    }
+    const uint64 compressed_size = core::DecodeFixed64(result.data());
+
+    auto block = std::make_shared<Block>();
+    block->uncompressed_size =
+        core::DecodeFixed64(result.data() + sizeof(uint64));
+    block->compressed.resize(compressed_size +
+                             BlockRecordWriter::kBlockFooterSize);
+    s = file_->Read(offset_ + sizeof(header), block->compressed.size(),
+                    &result, &block->compressed[0]);
+    if (errors::IsOutOfRange(s)) {
+      return errors::DataLoss("truncated block at ", offset_);
+    }
+    TF_RETURN_IF_ERROR(s);
+    if (result.data() != block->compressed.data()) {
+      memmove(&block->compressed[0], result.data(), result.size());
+    }
+    offset_ += sizeof(header) + block->compressed.size();
+    blocks_.push_back(block);
+    if (pool_ != nullptr) {
+      pool_->Schedule([block]() { block->Decompress(); });
+    } else {
+      block->Decompress();
+    }
+  }
+  return Status::OK();
+}
+
+Status BlockRecordReader::ReadRecord(tstring* record) {
+  TF_RETURN_IF_ERROR(ReadBlocks());
+  while (!blocks_.empty()) {
+    Block* block = blocks_.front().get();
+    block->done.WaitForNotification();
+    TF_RETURN_IF_ERROR(block->status);
+    const size_t remaining = block->data.size() - block->position;
+    if (remaining > 0) {
+      // The block checksum covers the records, so their own checksums are
+      // not checked again.
+      if (remaining < RecordWriter::kHeaderSize) {
+        return errors::DataLoss("truncated record header");
+      }
+      const char* header = block->data.data() + block->position;
+      const uint64 length = core::DecodeFixed64(header);
+      if (remaining - RecordWriter::kHeaderSize <
+          length + RecordWriter::kFooterSize) {
+        return errors::DataLoss("truncated record");
+      }
+      record->assign(header + RecordWriter::kHeaderSize, length);
+      block->position +=
+          RecordWriter::kHeaderSize + length + RecordWriter::kFooterSize;
+      return Status::OK();
+    }
+    blocks_.pop_front();
+    TF_RETURN_IF_ERROR(ReadBlocks());
+  }
+  return errors::OutOfRange("end of file");
+}
+
+}  // namespace io
+}  // namespace tensorflow
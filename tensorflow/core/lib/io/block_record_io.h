@@ -0,0 +1,134 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_BLOCK_RECORD_IO_H_
+#define TENSORFLOW_CORE_LIB_IO_BLOCK_RECORD_IO_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class RandomAccessFile;
+class WritableFile;
+
+namespace io {
+
+// A block-compressed variant of TFRecord files. Records keep the TFRecord
+// framing, but are grouped into blocks which are zlib-compressed
+// independently, so that a reader can decompress several blocks at once.
+//
+// Format of a block:
+//  uint64    compressed length
+//  uint64    uncompressed length
+//  uint32    masked crc of the above
+//  byte      data[compressed length]
+//  uint32    masked crc of data
+//
+// The uncompressed data of a block holds whole records.
+
+struct BlockRecordWriterOptions {
+  // The uncompressed size at which a block is compressed and written. Records
+  // are never split, so blocks may be larger.
+  size_t block_size = 1 << 20;
+  // The zlib compression level, from 0 (none) to 9 (best).
+  int compression_level = 6;
+};
+
+// Writes block-compressed TFRecord files.
+//
+// Note: this class is not thread safe; external synchronization required.
+class BlockRecordWriter {
+ public:
+  static constexpr size_t kBlockHeaderSize = 2 * sizeof(uint64) + sizeof(uint32);
+  static constexpr size_t kBlockFooterSize = sizeof(uint32);
+
+  // Create a writer that will append data to "*dest".
+  // "*dest" must remain live while this Writer is in use.
+  explicit BlockRecordWriter(
+      WritableFile* dest,
+      const BlockRecordWriterOptions& options = BlockRecordWriterOptions());
+
+  // Calls Close() and logs if an error occurs.
+  ~BlockRecordWriter();
+
+  Status WriteRecord(StringPiece data);
+
+  // Writes the last block. Does *not* close the WritableFile.
+  //
+  // After calling Close(), any further calls to `WriteRecord()` are invalid.
+  Status Close();
+
+ private:
+  Status WriteBlock();
+
+  WritableFile* dest_;
+  const BlockRecordWriterOptions options_;
+  // The framed records of the block being filled.
+  string block_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockRecordWriter);
+};
+
+// Reads block-compressed TFRecord files, decompressing up to
+// `max_blocks_in_flight` blocks ahead of the records being returned on a
+// thread pool, which can be shared by many readers. Records are returned in
+// the order in which they were written.
+//
+// Note: this class is not thread safe; external synchronization required.
+class BlockRecordReader {
+ public:
+  // Create a reader that will return records from "*file". "*file" must
+  // remain live while this Reader is in use. `pool` may be shared, and must
+  // remain live while this Reader is in use. If it is null, blocks are
+  // decompressed on the calling thread.
+  BlockRecordReader(RandomAccessFile* file, thread::ThreadPool* pool,
+                    int max_blocks_in_flight);
+
+  // Waits for the blocks being decompressed.
+  ~BlockRecordReader();
+
+  // Read the next record in the file into *record. Returns OK on success,
+  // OUT_OF_RANGE for end of file, or something else for an error.
+  Status ReadRecord(tstring* record);
+
+ private:
+  struct Block;
+
+  // Reads the next blocks of the file and starts decompressing them, until
+  // `max_blocks_in_flight_` blocks are pending.
+  Status ReadBlocks();
+
+  RandomAccessFile* const file_;
+  thread::ThreadPool* const pool_;
+  const int max_blocks_in_flight_;
+  // The offset of the next block to read.
+  uint64 offset_ = 0;
+  bool end_of_file_ = false;
+  std::deque<std::shared_ptr<Block>> blocks_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockRecordReader);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_BLOCK_RECORD_IO_H_
@@ -0,0 +1,168 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/block_record_io.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+string Record(int i) {
+  return strings::StrCat("record ", i, string(i % 7, 'x'));
+}
+
+// Writes `num_records` records in blocks of about `block_size` bytes.
+void WriteBlockRecordFile(const string& fname, int num_records,
+                          size_t block_size) {
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(fname, &file));
+  BlockRecordWriterOptions options;
+  options.block_size = block_size;
+  BlockRecordWriter writer(file.get(), options);
+  for (int i = 0; i < num_records; ++i) {
+    TF_ASSERT_OK(writer.WriteRecord(Record(i)));
+  }
+  TF_ASSERT_OK(writer.Close());
+  TF_ASSERT_OK(file->Close());
+}
+
+TEST(BlockRecordIOTest, RoundTrip) {
+  const string fname = testing::TmpDir() + "/block_record_io_round_trip";
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  for (size_t block_size : {1, 100, 1 << 20}) {
+    WriteBlockRecordFile(fname, 1000, block_size);
+    for (bool use_pool : {true, false}) {
+      std::unique_ptr<RandomAccessFile> file;
+      TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+      BlockRecordReader reader(file.get(), use_pool ? &pool : nullptr,
+                               /*max_blocks_in_flight=*/8);
+      tstring record;
+      for (int i = 0; i < 1000; ++i) {
+        TF_ASSERT_OK(reader.ReadRecord(&record));
+        EXPECT_EQ(Record(i), record);
+      }
+      EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+    }
+  }
+}
+
+TEST(BlockRecordIOTest, EmptyFile) {
+  const string fname = testing::TmpDir() + "/block_record_io_empty";
+  WriteBlockRecordFile(fname, 0, 100);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  BlockRecordReader reader(file.get(), nullptr, 1);
+  tstring record;
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+}
+
+TEST(BlockRecordIOTest, Corruption) {
+  const string fname = testing::TmpDir() + "/block_record_io_corruption";
+  WriteBlockRecordFile(fname, 100, 1 << 20);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), fname, &contents));
+  contents[BlockRecordWriter::kBlockHeaderSize + 3] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, contents));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  BlockRecordReader reader(file.get(), nullptr, 1);
+  tstring record;
+  EXPECT_TRUE(errors::IsDataLoss(reader.ReadRecord(&record)));
+}
+
+constexpr int kBenchmarkRecords = 20000;
+constexpr int kBenchmarkRecordSize = 1000;
+
+string BenchmarkRecord(int i) {
+  string record(kBenchmarkRecordSize, 'a' + i % 26);
+  for (int j = 0; j < kBenchmarkRecordSize; j += 17) record[j] = j * i;
+  return record;
+}
+
+// Reads a ZLIB-compressed TFRecord file with RecordReader.
+void BM_ReadZlibRecords(int iters) {
+  testing::StopTiming();
+  const string fname = testing::TmpDir() + "/block_record_io_bm_zlib";
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(Env::Default()->NewWritableFile(fname, &file));
+    RecordWriter writer(file.get(),
+                        RecordWriterOptions::CreateRecordWriterOptions("ZLIB"));
+    for (int i = 0; i < kBenchmarkRecords; ++i) {
+      TF_CHECK_OK(writer.WriteRecord(BenchmarkRecord(i)));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * kBenchmarkRecords *
+                          kBenchmarkRecordSize);
+  testing::StartTiming();
+  for (int it = 0; it < iters; ++it) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_CHECK_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+    SequentialRecordReader reader(
+        file.get(), RecordReaderOptions::CreateRecordReaderOptions("ZLIB"));
+    tstring record;
+    while (reader.ReadRecord(&record).ok()) {
+    }
+  }
+}
+BENCHMARK(BM_ReadZlibRecords);
+
+// Reads a block-compressed file with `num_threads` decompression threads.
+void BM_ReadBlockRecords(int iters, int num_threads) {
+  testing::StopTiming();
+  const string fname = testing::TmpDir() + "/block_record_io_bm_block";
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(Env::Default()->NewWritableFile(fname, &file));
+    BlockRecordWriter writer(file.get());
+    for (int i = 0; i < kBenchmarkRecords; ++i) {
+      TF_CHECK_OK(writer.WriteRecord(BenchmarkRecord(i)));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  std::unique_ptr<thread::ThreadPool> pool;
+  if (num_threads > 0) {
+    pool.reset(new thread::ThreadPool(Env::Default(), "bm", num_threads));
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * kBenchmarkRecords *
+                          kBenchmarkRecordSize);
+  testing::StartTiming();
+  for (int it = 0; it < iters; ++it) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_CHECK_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+    BlockRecordReader reader(file.get(), pool.get(),
+                             /*max_blocks_in_flight=*/2 * num_threads);
+    tstring record;
+    while (reader.ReadRecord(&record).ok()) {
+    }
+  }
+}
+BENCHMARK(BM_ReadBlockRecords)->Arg(0)->Arg(1)->Arg(4)->Arg(8);
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
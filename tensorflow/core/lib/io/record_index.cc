@@ -0,0 +1,85 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// Format of an index file:
+//  uint64    magic
+//  uint64    interval
+//  uint64    number of offsets
+//  uint64    offsets[number of offsets]
+//  uint32    masked crc of the above
+constexpr uint64 kRecordIndexMagic = 0x78646e4964726354ull;  // "TcrdIndx"
+constexpr size_t kRecordIndexHeaderSize = 3 * sizeof(uint64);
+
+}  // namespace
+
+string RecordIndexFilename(const string& filename) {
+  return strings::StrCat(filename, ".tfrecord_index");
+}
+
+Status WriteRecordIndex(Env* env, const string& filename,
+                        const RecordIndex& index) {
+  string contents;
+  core::PutFixed64(&contents, kRecordIndexMagic);
+  core::PutFixed64(&contents, index.interval);
+  core::PutFixed64(&contents, index.offsets.size());
+  for (uint64 offset : index.offsets) {
+    core::PutFixed64(&contents, offset);
+  }
+  core::PutFixed32(&contents,
+                   crc32c::Mask(crc32c::Value(contents.data(), contents.size())));
+  return WriteStringToFile(env, filename, contents);
+}
+
+Status ReadRecordIndex(Env* env, const string& filename, RecordIndex* index) {
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &contents));
+  if (contents.size() < kRecordIndexHeaderSize + sizeof(uint32) ||
+      core::DecodeFixed64(contents.data()) != kRecordIndexMagic) {
+    return errors::DataLoss("Not a TFRecord index file: ", filename);
+  }
+  const uint64 num_offsets =
+      core::DecodeFixed64(contents.data() + 2 * sizeof(uint64));
+  const size_t data_size = contents.size() - sizeof(uint32);
+  if (data_size != kRecordIndexHeaderSize + num_offsets * sizeof(uint64)) {
+    return errors::DataLoss("Truncated TFRecord index file: ", filename);
+  }
+  const uint32 masked_crc = core::DecodeFixed32(contents.data() + data_size);
+  if (crc32c::Unmask(masked_crc) !=
+      crc32c::Value(contents.data(), data_size)) {
+    return errors::DataLoss("Corrupted TFRecord index file: ", filename);
+  }
+  index->interval = core::DecodeFixed64(contents.data() + sizeof(uint64));
+  index->offsets.resize(num_offsets);
+  for (uint64 i = 0; i < num_offsets; ++i) {
+    index->offsets[i] = core::DecodeFixed64(
+        contents.data() + kRecordIndexHeaderSize + i * sizeof(uint64));
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
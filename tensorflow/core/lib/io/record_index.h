@@ -0,0 +1,53 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Env;
+
+namespace io {
+
+// A sparse index of a TFRecord file, written next to it by the producer of the
+// file. `offsets[i]` is the offset of record `i * interval` in the
+// (uncompressed) record stream, so a reader can seek to any record by reading
+// at most `interval - 1` record headers.
+struct RecordIndex {
+  int64 interval = 0;
+  std::vector<uint64> offsets;
+};
+
+// Returns the name of the index file of the TFRecord file `filename`.
+string RecordIndexFilename(const string& filename);
+
+// Writes `index` to the file `filename`.
+Status WriteRecordIndex(Env* env, const string& filename,
+                        const RecordIndex& index);
+
+// Reads the index written to `filename` by WriteRecordIndex(). Returns
+// NOT_FOUND if there is no such file, and DATA_LOSS if it is corrupted.
+Status ReadRecordIndex(Env* env, const string& filename, RecordIndex* index);
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
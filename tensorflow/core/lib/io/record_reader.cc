@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
@@ -211,11 +213,24 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
 
 Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
                                  int* num_skipped) {
+  *num_skipped = 0;
+  if (index_.interval > 0 && num_to_skip > 0) {
+    const auto& offsets = index_.offsets;
+    auto it = std::lower_bound(offsets.begin(), offsets.end(), *offset);
+    if (it != offsets.end() && *it == *offset) {
+      const int64 first = it - offsets.begin();
+      const int64 last = std::min<int64>(
+          first + num_to_skip / index_.interval, offsets.size() - 1);
+      const int64 skipped = (last - first) * index_.interval;
+      *offset = offsets[last];
+      *num_skipped = skipped;
+      num_to_skip -= skipped;
+    }
+  }
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
 
   Status s;
   tstring record;
-  *num_skipped = 0;
   for (int i = 0; i < num_to_skip; ++i) {
     s = ReadChecksummed(*offset, sizeof(uint64), &record);
     if (!s.ok()) {
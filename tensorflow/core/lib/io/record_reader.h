@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_inputstream.h"
@@ -102,8 +103,16 @@ class RecordReader {
   // Return OK on success, OUT_OF_RANGE for end of file, or something
   // else for an error. "*num_skipped" records the number of records that
   // are actually skipped. It should be equal to num_to_skip on success.
+  //
+  // If an index was set and "*offset" is an indexed offset, seeks to the
+  // last indexed record at or before the target instead of reading the
+  // headers of all the skipped records.
   Status SkipRecords(uint64* offset, int num_to_skip, int* num_skipped);
 
+  // Sets the index of the file, as written by RecordWriter, for SkipRecords()
+  // to seek with.
+  void SetIndex(RecordIndex index) { index_ = std::move(index); }
+
   // Return the metadata of the Record file.
   //
   // The current implementation scans the file to completion,
@@ -125,6 +134,8 @@ class RecordReader {
 
   std::unique_ptr<Metadata> cached_metadata_;
 
+  RecordIndex index_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(RecordReader);
 };
 
@@ -155,6 +166,9 @@ class SequentialRecordReader {
     return underlying_.SkipRecords(&offset_, num_to_skip, num_skipped);
   }
 
+  // Sets the index of the file, see RecordReader::SetIndex().
+  void SetIndex(RecordIndex index) { underlying_.SetIndex(std::move(index)); }
+
   // Return the current offset in the file.
   uint64 TellOffset() { return offset_; }
 
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 
 #include <zlib.h>
@@ -194,6 +195,53 @@ TEST(RecordReaderWriterTest, TestSkipBasic) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestSkipWithIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_skip_index_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+    io::RecordWriterOptions options;
+    options.index_interval = 3;
+    io::RecordWriter writer(file.get(), options);
+    for (int i = 0; i < 10; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record", i)));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+    EXPECT_EQ(4, writer.index().offsets.size());
+    TF_CHECK_OK(io::WriteRecordIndex(env, io::RecordIndexFilename(fname),
+                                     writer.index()));
+  }
+
+  io::RecordIndex index;
+  TF_CHECK_OK(
+      io::ReadRecordIndex(env, io::RecordIndexFilename(fname), &index));
+  EXPECT_EQ(3, index.interval);
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  reader.SetIndex(index);
+  uint64 offset = 0;
+  int num_skipped;
+  tstring record;
+  TF_CHECK_OK(reader.SkipRecords(&offset, 7, &num_skipped));
+  EXPECT_EQ(7, num_skipped);
+  TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+  EXPECT_EQ("record7", record);
+
+  // Skipping past the end stops at the last record.
+  offset = 0;
+  EXPECT_TRUE(errors::IsOutOfRange(reader.SkipRecords(&offset, 12,
+                                                      &num_skipped)));
+  EXPECT_EQ(10, num_skipped);
+
+  EXPECT_TRUE(errors::IsNotFound(io::ReadRecordIndex(
+      env, io::RecordIndexFilename(fname + "_missing"), &index)));
+}
+
 TEST(RecordReaderWriterTest, TestSkipOutOfRange) {
   Env* env = Env::Default();
   string fname =
@@ -60,6 +60,7 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
 RecordWriter::RecordWriter(WritableFile* dest,
                            const RecordWriterOptions& options)
     : dest_(dest), options_(options) {
+  index_.interval = options.index_interval;
 #if defined(IS_SLIM_BUILD)
   if (compression_type != compression::kNone) {
     LOG(FATAL) << "Compression is unsupported on mobile platforms.";
@@ -112,7 +113,9 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  UpdateIndex(data.size());
+  return Status::OK();
 }
 
 #if defined(PLATFORM_GOOGLE)
@@ -132,10 +135,20 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  UpdateIndex(data.size());
+  return Status::OK();
 }
 #endif
 
+void RecordWriter::UpdateIndex(size_t n) {
+  if (index_.interval > 0 && num_records_ % index_.interval == 0) {
+    index_.offsets.push_back(offset_);
+  }
+  offset_ += kHeaderSize + n + kFooterSize;
+  ++num_records_;
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
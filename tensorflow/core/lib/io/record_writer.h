@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
@@ -48,6 +49,10 @@ struct RecordWriterOptions {
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
+  // If positive, the writer indexes the offset of every `index_interval`-th
+  // record, see `RecordWriter::index()`.
+  int64 index_interval = 0;
+
 #if !defined(IS_SLIM_BUILD)
   // Options specific to compression.
   tensorflow::io::ZlibCompressionOptions zlib_options;
@@ -94,6 +99,11 @@ class RecordWriter {
   // are invalid.
   Status Close();
 
+  // Returns the index of the records written so far, which is empty unless
+  // `RecordWriterOptions::index_interval` is positive. Producers of indexed
+  // files write it with `WriteRecordIndex()` after closing the writer.
+  const RecordIndex& index() const { return index_; }
+
   // Utility method to populate TFRecord headers.  Populates record-header in
   // "header[0,kHeaderSize-1]".  The record-header is based on data[0, n-1].
   inline static void PopulateHeader(char* header, const char* data, size_t n);
@@ -111,6 +121,15 @@ class RecordWriter {
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+  // Adds the offset of the next record to `index_` if it is indexed, and
+  // advances past a record of `n` bytes.
+  void UpdateIndex(size_t n);
+
+  // The offset of the next record in the (uncompressed) record stream.
+  uint64 offset_ = 0;
+  int64 num_records_ = 0;
+  RecordIndex index_;
+
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }
@@ -68,6 +68,35 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that generating samples in batches is equivalent to
+// generating them one at a time, including across counter carries.
+TEST(PhiloxRandomTest, GenerateBatchMatchTest) {
+  PhiloxRandom::ResultType counter;
+  counter[0] = 0xfffffff0;
+  counter[1] = 0xffffffff;
+  counter[2] = 7;
+  counter[3] = 0;
+  PhiloxRandom::Key key;
+  key[0] = 0x12345678;
+  key[1] = 0x9abcdef0;
+  PhiloxRandom batch_gen(counter, key);
+  PhiloxRandom single_gen(counter, key);
+  PhiloxRandom::ResultType batch[PhiloxRandom::kMaxBatchSize];
+  for (int batch_size = 1; batch_size <= PhiloxRandom::kMaxBatchSize;
+       ++batch_size) {
+    batch_gen.GenerateBatch(batch, batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+      const PhiloxRandom::ResultType single = single_gen();
+      for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+        ASSERT_EQ(batch[i][j], single[j]);
+      }
+    }
+    ASSERT_EQ(batch_gen.counter()[0], single_gen.counter()[0]);
+    ASSERT_EQ(batch_gen.counter()[1], single_gen.counter()[1]);
+    ASSERT_EQ(batch_gen.counter()[2], single_gen.counter()[2]);
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tensorflow
@@ -129,8 +129,12 @@ class UniformDistribution<Generator, float> {
   typedef float ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return Transform((*gen)()); }
+
+  // Returns the result for one sample of the generator, for callers that
+  // generate the samples in batches.
+  PHILOX_DEVICE_INLINE
+  ResultType Transform(const typename Generator::ResultType& sample) const {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = Uint32ToFloat(sample[i]);
@@ -153,8 +157,12 @@ class UniformDistribution<Generator, double> {
   typedef double ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return Transform((*gen)()); }
+
+  // Returns the result for one sample of the generator, for callers that
+  // generate the samples in batches.
+  PHILOX_DEVICE_INLINE
+  ResultType Transform(const typename Generator::ResultType& sample) const {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = Uint64ToDouble(sample[2 * i], sample[2 * i + 1]);
@@ -458,8 +466,12 @@ class NormalDistribution<Generator, float> {
   typedef float ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return Transform((*gen)()); }
+
+  // Returns the result for one sample of the generator, for callers that
+  // generate the samples in batches.
+  PHILOX_DEVICE_INLINE
+  ResultType Transform(const typename Generator::ResultType& sample) const {
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
       BoxMullerFloat(sample[i], sample[i + 1], &result[i], &result[i + 1]);
@@ -482,8 +494,12 @@ class NormalDistribution<Generator, double> {
   typedef double ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return Transform((*gen)()); }
+
+  // Returns the result for one sample of the generator, for callers that
+  // generate the samples in batches.
+  PHILOX_DEVICE_INLINE
+  ResultType Transform(const typename Generator::ResultType& sample) const {
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
       const int i2 = 2 * i;
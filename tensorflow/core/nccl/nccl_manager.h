@@ -180,6 +180,12 @@ class NcclManager {
   void AddToAllGather(std::unique_ptr<Participant> participant,
                       const Context& context);
 
+  // Adds one participant to a reduce-scatter. `output` receives the reduction
+  // of the slice of `input` at the rank of the participant, and must have
+  // 1/num_global_devices of the elements of `input`.
+  void AddToReduceScatter(std::unique_ptr<Participant> participant,
+                          const Context& context, ncclRedOp_t reduction_op);
+
   // AddBroadcastSend and AddBroadcastRecv combine to send data from one sender
   // to all receivers.
   void AddBroadcastSend(std::unique_ptr<Participant> participant,
@@ -208,6 +214,7 @@ class NcclManager {
     kBroadcast = 2,
     kReduce = 3,
     kAllGather = 4,
+    kReduceScatter = 5,
   };
   struct Collective;
   struct Communicator;
@@ -566,6 +566,62 @@ TYPED_TEST(NcclManagerTest, MultipleCallers) {
   }
 }
 
+// Launches many small all-reduces at once, as for the gradients of a model
+// with many small variables.  They queue up on the communication streams and
+// are launched in NCCL groups; the logged rate compares with the ungrouped
+// launches of TF_NCCL_MAX_GROUPED_LAUNCHES=1.
+TYPED_TEST(NcclManagerTest, ManySmallReductions) {
+  const int num_ranks = this->NumGPUs();
+  const int num_collectives = 256;
+  const int num_iterations = 10;
+
+  int64 total_micros = 0;
+  for (int iter = 0; iter < num_iterations; ++iter) {
+    std::vector<std::unique_ptr<typename TestFixture::TestCase>> test_cases;
+    for (int i = 0; i < num_collectives; ++i) {
+      test_cases.emplace_back(this->MakeReductionTestCase(
+          /*num_nodes=*/1, num_ranks, ncclSum, TensorShape({i % 16 + 1}),
+          0.1f * i));
+    }
+    for (int rank = 0; rank < num_ranks; ++rank) {
+      auto* device = this->GetDevice(num_ranks, /*node=*/0, rank);
+      auto* stream = device->tensorflow_gpu_device_info()->stream;
+      SE_ASSERT_OK(stream->BlockHostUntilDone());
+    }
+
+    const int64 start = Env::Default()->NowMicros();
+    for (int i = 0; i < num_collectives; ++i) {
+      typename TestFixture::TestCase* test_case = test_cases[i].get();
+      for (int rank = 0; rank < num_ranks; ++rank) {
+        auto* device = this->GetDevice(num_ranks, /*node=*/0, rank);
+        auto* info = device->tensorflow_gpu_device_info();
+        auto* stream = device->tensorflow_gpu_device_info()->stream;
+        auto participant = absl::make_unique<NcclManager::Participant>(
+            device->executor(), stream, info, &test_case->ins[rank],
+            &test_case->outs[rank], /*global_rank=*/-1,
+            this->CreateDoneCallback(test_case));
+        NcclManager::instance()->AddToAllReduce(
+            std::move(participant),
+            {strings::StrCat("small_allreduce", i),
+             /*num_local_devices=*/num_ranks,
+             /*num_global_devices=*/num_ranks,
+             /*communicator_key=*/"", /*source_rank=*/-1},
+            ncclSum);
+      }
+    }
+    for (int i = 0; i < num_collectives; ++i) {
+      this->WaitForTestCompletion(test_cases[i].get());
+    }
+    total_micros += Env::Default()->NowMicros() - start;
+
+    for (int i = 0; i < num_collectives; ++i) {
+      this->VerifyResults(test_cases[i].get());
+    }
+  }
+  LOG(INFO) << "Ran " << num_iterations * num_collectives
+            << " small all-reduces in " << total_micros << " microsecs";
+}
+
 // Test basic all-gather.
 TYPED_TEST(NcclManagerTest, BasicAllGather) {
   const int num_ranks = this->NumGPUs();
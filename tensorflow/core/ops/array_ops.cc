@@ -1833,6 +1833,30 @@ REGISTER_OP("Where")
       return Status::OK();
     });
 
+// --------------------------------------------------------------------------
+// Gathers the rows of `params` whose entry in `mask` is true.  Equivalent to
+// GatherV2(params, Squeeze(Where(mask), [1]), axis=0); produced by the
+// remapper.
+REGISTER_OP("_MaskedGather")
+    .Input("params: T")
+    .Input("mask: bool")
+    .Output("output: T")
+    .Attr("T: type")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle params;
+      ShapeHandle mask;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &params));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &mask));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(params, 0), c->Dim(mask, 0), &unused));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(
+          c->ReplaceDim(params, 0, c->UnknownDim(), &output));
+      c->set_output(0, output);
+      return Status::OK();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("BroadcastArgs")
     .Input("s0: T")
@@ -63,6 +63,8 @@ REGISTER_OP("SaveV2")
     .Input("shape_and_slices: string")
     .Input("tensors: dtypes")
     .Attr("dtypes: list(type)")
+    .Attr("num_shards: int >= 1 = 1")
+    .Attr("data_alignment: int >= 1 = 1")
     .SetIsStateful()
     .SetShapeFn([](InferenceContext* c) {
       ShapeHandle unused;
@@ -89,6 +91,9 @@ REGISTER_OP("RestoreV2")
     .Input("shape_and_slices: string")
     .Output("tensors: dtypes")
     .Attr("dtypes: list(type)")
+    .Attr("num_threads: int >= 0 = 0")
+    .Attr("read_buffer_size: int >= 0 = 0")
+    .Attr("memory_map: bool = false")
     .SetIsStateful()
     .SetShapeFn([](InferenceContext* c) {
       ShapeHandle shape0, shape1, shape2;
@@ -141,6 +146,17 @@ REGISTER_OP("MergeV2Checkpoints")
       return Status::OK();
     });
 
+REGISTER_OP("CompactV2Checkpoint")
+    .Input("checkpoint_prefix: string")
+    .Input("destination_prefix: string")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      return Status::OK();
+    });
+
 REGISTER_OP("Save")
     .Input("filename: string")
     .Input("tensor_names: string")
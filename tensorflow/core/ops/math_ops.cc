@@ -312,6 +312,34 @@ expected to create these operators.
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
 
+REGISTER_OP("_FusedElementwise")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("num_args: int >= 1")
+    .Attr("op_names: list(string)")
+    .Attr("operands: list(int)")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle out = c->input(0);
+      for (int i = 1; i < c->num_inputs(); ++i) {
+        TF_RETURN_IF_ERROR(BroadcastBinaryOpOutputShapeFnHelper(
+            c, out, c->input(i), /*incompatible_shape_error=*/true, &out));
+      }
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Evaluates a program of elementwise ops in a single pass over its inputs.
+
+Instruction i applies op_names[i] to operands[2 * i] and, for binary ops,
+operands[2 * i + 1]. Operands below num_args refer to inputs, the others to
+the result of instruction (operand - num_args). The result of the last
+instruction is the output.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("IsNan")
     .Input("x: T")
     .Output("y: bool")
@@ -981,6 +1009,47 @@ _FusedConv2D output.
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_BlockSparseMatMul")
+    .Input("a: T")
+    .Input("block_values: T")
+    .Input("block_indices: int32")
+    .Input("block_row_ptr: int32")
+    .Output("product: T")
+    .Attr("T: {float}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle a;
+      ShapeHandle block_values;
+      ShapeHandle block_indices;
+      ShapeHandle block_row_ptr;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &a));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 3, &block_values));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &block_indices));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &block_row_ptr));
+      DimensionHandle num_block_rows;
+      TF_RETURN_IF_ERROR(
+          c->Subtract(c->Dim(block_row_ptr, 0), 1, &num_block_rows));
+      DimensionHandle n;
+      TF_RETURN_IF_ERROR(
+          c->Multiply(num_block_rows, c->Dim(block_values, 2), &n));
+      c->set_output(0, c->Matrix(c->Dim(a, 0), n));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Multiplies `a` by a constant matrix `b` that is stored block-sparse.
+
+`b` has shape [K, N] and is divided into blocks of [block_k, block_n] elements,
+where block_k and block_n are the last two dimensions of `block_values`. Its
+transpose is stored in block compressed sparse row (CSR) format: the nonzero
+blocks of the block columns of `b` are listed in order, block column j holding
+the entries [block_row_ptr[j], block_row_ptr[j + 1]). For each of them,
+`block_indices` is the block row of `b` and `block_values` the dense,
+row-major block. Each block column thus produces block_n columns of the
+product, independently of the others.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators from constant pruned weights.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
@@ -343,6 +343,7 @@ REGISTER_OP("ResourceScatterAdd")
     .Input("updates: dtype")
     .Attr("dtype: numbertype")
     .Attr("Tindices: {int32, int64}")
+    .Attr("relaxed: bool = false")
     .SetShapeFn(ResourceScatterUpdateShape);
 
 REGISTER_OP("ResourceScatterSub")
@@ -351,6 +352,7 @@ REGISTER_OP("ResourceScatterSub")
     .Input("updates: dtype")
     .Attr("dtype: numbertype")
     .Attr("Tindices: {int32, int64}")
+    .Attr("relaxed: bool = false")
     .SetShapeFn(ResourceScatterUpdateShape);
 
 REGISTER_OP("ResourceScatterMul")
@@ -359,6 +361,7 @@ REGISTER_OP("ResourceScatterMul")
     .Input("updates: dtype")
     .Attr("dtype: numbertype")
     .Attr("Tindices: {int32, int64}")
+    .Attr("relaxed: bool = false")
     .SetShapeFn(ResourceScatterUpdateShape);
 
 REGISTER_OP("ResourceScatterDiv")
@@ -367,6 +370,7 @@ REGISTER_OP("ResourceScatterDiv")
     .Input("updates: dtype")
     .Attr("dtype: numbertype")
     .Attr("Tindices: {int32, int64}")
+    .Attr("relaxed: bool = false")
     .SetShapeFn(ResourceScatterUpdateShape);
 
 REGISTER_OP("ResourceScatterMin")
@@ -375,6 +379,7 @@ REGISTER_OP("ResourceScatterMin")
     .Input("updates: dtype")
     .Attr("dtype: numbertype")
     .Attr("Tindices: {int32, int64}")
+    .Attr("relaxed: bool = false")
     .SetShapeFn(ResourceScatterUpdateShape);
 
 REGISTER_OP("ResourceScatterMax")
@@ -383,6 +388,7 @@ REGISTER_OP("ResourceScatterMax")
     .Input("updates: dtype")
     .Attr("dtype: numbertype")
     .Attr("Tindices: {int32, int64}")
+    .Attr("relaxed: bool = false")
     .SetShapeFn(ResourceScatterUpdateShape);
 
 REGISTER_OP("ResourceScatterUpdate")
@@ -391,6 +397,7 @@ REGISTER_OP("ResourceScatterUpdate")
     .Input("updates: dtype")
     .Attr("dtype: type")
     .Attr("Tindices: {int32, int64}")
+    .Attr("relaxed: bool = false")
     .SetShapeFn(ResourceScatterUpdateShape);
 
 REGISTER_OP("MutexV2")
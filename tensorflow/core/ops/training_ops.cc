@@ -372,6 +372,19 @@ REGISTER_OP("ResourceSparseApplyAdagradV2")
     .SetShapeFn(
         ApplyAdagradV2ShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
 
+REGISTER_OP("ResourceFusedSparseApplyAdagradV2")
+    .Input("var: resource")
+    .Input("accum: resource")
+    .Input("lr: T")
+    .Input("epsilon: T")
+    .Input("grad: T")
+    .Input("indices: Tindices")
+    .Attr("T: {half, bfloat16, float, double}")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("update_slots: bool = true")
+    .SetShapeFn(
+        ApplyAdagradV2ShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
+
 template <bool is_sparse, bool is_resource>
 static Status ApplyProximalAdagradShapeFn(InferenceContext* c) {
   ShapeHandle unused;
@@ -675,6 +688,22 @@ REGISTER_OP("ResourceSparseApplyFtrlV2")
     .Attr("multiply_linear_by_lr: bool = false")
     .SetShapeFn(ApplyFtrlShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
 
+REGISTER_OP("ResourceFusedSparseApplyFtrl")
+    .Input("var: resource")
+    .Input("accum: resource")
+    .Input("linear: resource")
+    .Input("grad: T")
+    .Input("indices: Tindices")
+    .Input("lr: T")
+    .Input("l1: T")
+    .Input("l2: T")
+    .Input("l2_shrinkage: T")
+    .Input("lr_power: T")
+    .Attr("T: {half, bfloat16, float, double}")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("multiply_linear_by_lr: bool = false")
+    .SetShapeFn(ApplyFtrlShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
+
 template <bool is_sparse, bool is_resource>
 static Status ApplyMomentumShapeFn(InferenceContext* c) {
   ShapeHandle unused;
@@ -22,7 +22,9 @@ limitations under the License.
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <fstream>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/platform/strcat.h"
@@ -56,6 +58,34 @@ limitations under the License.
 #endif
 
 namespace tensorflow {
+
+// Bounds the memory held by the readahead of all files of a file system.
+class GcsReadaheadBudget {
+ public:
+  explicit GcsReadaheadBudget(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+  // Reserves `bytes` if they fit in the budget, and returns whether they did.
+  bool TryReserve(size_t bytes) {
+    mutex_lock l(mu_);
+    if (used_bytes_ + bytes > max_bytes_) {
+      return false;
+    }
+    used_bytes_ += bytes;
+    return true;
+  }
+
+  void Release(size_t bytes) {
+    mutex_lock l(mu_);
+    DCHECK_GE(used_bytes_, bytes);
+    used_bytes_ -= bytes;
+  }
+
+ private:
+  const size_t max_bytes_;
+  mutex mu_;
+  size_t used_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
 namespace {
 
 constexpr char kGcsUriBase[] = "https://www.googleapis.com/storage/v1/";
@@ -385,6 +415,230 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   mutable string buffer_ TF_GUARDED_BY(buffer_mutex_);
 };
 
+/// A GCS-based implementation of a random access file which, once it detects
+/// sequential reads, keeps several range reads in flight ahead of them.
+class ReadaheadGcsRandomAccessFile : public RandomAccessFile {
+ public:
+  using ReadFn =
+      std::function<Status(const string& filename, uint64 offset, size_t n,
+                           StringPiece* result, char* scratch)>;
+  using ReportFn =
+      std::function<void(const string& filename, size_t bytes_transferred,
+                         int64 num_requests, uint64 total_latency_micros)>;
+
+  // Provided read_fn should be thread safe.
+  ReadaheadGcsRandomAccessFile(const string& filename, size_t chunk_size,
+                               int max_requests,
+                               std::shared_ptr<GcsReadaheadBudget> budget,
+                               ReadFn read_fn, ReportFn report_fn)
+      : filename_(filename),
+        chunk_size_(chunk_size),
+        max_requests_(max_requests),
+        budget_(std::move(budget)),
+        read_fn_(std::move(read_fn)),
+        report_fn_(std::move(report_fn)) {}
+
+  ~ReadaheadGcsRandomAccessFile() override {
+    mutex_lock l(mu_);
+    while (num_in_flight_ > 0) {
+      cv_.wait(l);
+    }
+    while (!chunks_.empty()) {
+      DropFirstChunkLocked();
+    }
+    if (num_requests_ > 0) {
+      VLOG(1) << "Read " << bytes_transferred_ << " bytes of " << filename_
+              << " in " << num_requests_ << " range reads, with a mean latency"
+              << " of " << total_latency_micros_ / num_requests_ << " us.";
+      report_fn_(filename_, bytes_transferred_, num_requests_,
+                 total_latency_micros_);
+    }
+  }
+
+  Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return Status::OK();
+  }
+
+  /// Thread safe. Returns `OUT_OF_RANGE` if fewer than n bytes were stored in
+  /// `*result` because of EOF.
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    mutex_lock l(mu_);
+    if (offset == next_offset_) {
+      ++sequential_reads_;
+    } else {
+      sequential_reads_ = 0;
+    }
+    next_offset_ = offset + n;
+    // Chunks before `offset` will not be read again by sequential readers.
+    while (!chunks_.empty() && chunks_.front()->done &&
+           chunks_.front()->start + chunks_.front()->data.size() <= offset) {
+      DropFirstChunkLocked();
+    }
+    if (sequential_reads_ == 0) {
+      // A random read: drop the readahead, and wait for the reads in flight
+      // so that their chunks can be dropped too.
+      while (num_in_flight_ > 0) {
+        cv_.wait(l);
+      }
+      while (!chunks_.empty()) {
+        DropFirstChunkLocked();
+      }
+    }
+    size_t copied = 0;
+    Status status;
+    while (copied < n) {
+      const uint64 position = offset + copied;
+      if (eof_offset_ >= 0 && position >= static_cast<uint64>(eof_offset_)) {
+        break;
+      }
+      std::shared_ptr<Chunk> chunk = FindChunkLocked(position);
+      if (chunk == nullptr) {
+        chunk = StartChunkLocked(position, /*reserved=*/false);
+      }
+      while (!chunk->done) {
+        cv_.wait(l);
+      }
+      if (!chunk->status.ok()) {
+        status = chunk->status;
+        // Drop all chunks so that a retried read fetches them again.
+        while (num_in_flight_ > 0) {
+          cv_.wait(l);
+        }
+        while (!chunks_.empty()) {
+          DropFirstChunkLocked();
+        }
+        break;
+      }
+      if (position >= chunk->start + chunk->data.size()) break;
+      const size_t available = chunk->start + chunk->data.size() - position;
+      const size_t to_copy = std::min(n - copied, available);
+      memcpy(scratch + copied, chunk->data.data() + (position - chunk->start),
+             to_copy);
+      copied += to_copy;
+    }
+    *result = StringPiece(scratch, copied);
+    if (!status.ok()) return status;
+    if (sequential_reads_ > 0) {
+      StartReadaheadLocked();
+    }
+    if (copied < n) {
+      return errors::OutOfRange("EOF reached. Requested to read ", n,
+                                " bytes from ", offset, ".");
+    }
+    return Status::OK();
+  }
+
+ private:
+  struct Chunk {
+    uint64 start;
+    string data;
+    bool done = false;
+    Status status;
+    // Whether `data` is counted in the readahead budget.
+    bool reserved;
+  };
+
+  std::shared_ptr<Chunk> FindChunkLocked(uint64 position) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (const auto& chunk : chunks_) {
+      const size_t size = chunk->done ? chunk->data.size() : chunk_size_;
+      if (chunk->start <= position && position < chunk->start + size) {
+        return chunk;
+      }
+    }
+    return nullptr;
+  }
+
+  // Starts a range read of a chunk at `start` in the background.
+  std::shared_ptr<Chunk> StartChunkLocked(uint64 start, bool reserved) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto chunk = std::make_shared<Chunk>();
+    chunk->start = start;
+    chunk->reserved = reserved;
+    auto it = chunks_.begin();
+    while (it != chunks_.end() && (*it)->start < start) ++it;
+    chunks_.insert(it, chunk);
+    ++num_in_flight_;
+    Env::Default()->SchedClosure([this, chunk]() {
+      string data(chunk_size_, '\0');
+      StringPiece piece;
+      const uint64 start_micros = Env::Default()->NowMicros();
+      Status s = read_fn_(filename_, chunk->start, chunk_size_, &piece,
+                          &data[0]);
+      const uint64 latency_micros = Env::Default()->NowMicros() - start_micros;
+      data.resize(piece.size());
+      mutex_lock l(mu_);
+      if (s.ok() || errors::IsOutOfRange(s)) {
+        if (errors::IsOutOfRange(s)) {
+          eof_offset_ = chunk->start + data.size();
+        }
+        chunk->data = std::move(data);
+        bytes_transferred_ += chunk->data.size();
+      } else {
+        chunk->status = s;
+      }
+      ++num_requests_;
+      total_latency_micros_ += latency_micros;
+      chunk->done = true;
+      --num_in_flight_;
+      cv_.notify_all();
+    });
+    return chunk;
+  }
+
+  // Keeps up to `sequential_reads_` (at most `max_requests_`) chunks in flight
+  // after the last chunk, within the readahead budget.
+  void StartReadaheadLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int target = std::min<int64>(max_requests_, sequential_reads_);
+    while (num_in_flight_ < target) {
+      uint64 start = next_offset_;
+      if (!chunks_.empty()) {
+        const Chunk& last = *chunks_.back();
+        start = std::max<uint64>(start, last.start + chunk_size_);
+      }
+      if (eof_offset_ >= 0 && start >= static_cast<uint64>(eof_offset_)) {
+        return;
+      }
+      if (!budget_->TryReserve(chunk_size_)) return;
+      StartChunkLocked(start, /*reserved=*/true);
+    }
+  }
+
+  void DropFirstChunkLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (chunks_.front()->reserved) {
+      budget_->Release(chunk_size_);
+    }
+    chunks_.pop_front();
+  }
+
+  const string filename_;
+  // The size of each range read.
+  const size_t chunk_size_;
+  const int max_requests_;
+  const std::shared_ptr<GcsReadaheadBudget> budget_;
+  // The implementation of the read operation (provided by the GCSFileSystem).
+  const ReadFn read_fn_;
+  const ReportFn report_fn_;
+
+  // The following members are mutable in order to provide a const Read.
+  mutable mutex mu_;
+  mutable condition_variable cv_;
+  // Chunks read or being read, ordered by their start offsets.
+  mutable std::deque<std::shared_ptr<Chunk>> chunks_ TF_GUARDED_BY(mu_);
+  mutable int num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  // The offset following the last read, and the number of reads in a row
+  // which started there.
+  mutable uint64 next_offset_ TF_GUARDED_BY(mu_) = 0;
+  mutable int64 sequential_reads_ TF_GUARDED_BY(mu_) = 0;
+  // The size of the file, or -1 until a range read reaches its end.
+  mutable int64 eof_offset_ TF_GUARDED_BY(mu_) = -1;
+  mutable size_t bytes_transferred_ TF_GUARDED_BY(mu_) = 0;
+  mutable int64 num_requests_ TF_GUARDED_BY(mu_) = 0;
+  mutable uint64 total_latency_micros_ TF_GUARDED_BY(mu_) = 0;
+};
+
 // Function object declaration with params needed to create upload sessions.
 typedef std::function<Status(
     uint64 start_offset, const std::string& object_to_upload,
@@ -786,6 +1040,23 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
           << "block size = " << block_size_ << " ; "
           << "max staleness = " << max_staleness;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
+
+  // Apply the overrides for the parallel readahead of uncached files, if
+  // provided.
+  int64 readahead_max_requests = 0;
+  size_t readahead_chunk_size = kDefaultReadaheadChunkSize;
+  size_t readahead_max_size = kDefaultReadaheadMaxSize;
+  GetEnvVar(kReadaheadMaxRequests, strings::safe_strto64,
+            &readahead_max_requests);
+  if (GetEnvVar(kReadaheadChunkSize, strings::safe_strtou64, &value)) {
+    readahead_chunk_size = value * 1024 * 1024;
+  }
+  if (GetEnvVar(kReadaheadMaxSize, strings::safe_strtou64, &value)) {
+    readahead_max_size = value * 1024 * 1024;
+  }
+  SetReadaheadConfig(readahead_max_requests, readahead_chunk_size,
+                     readahead_max_size);
+
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
   size_t stat_cache_max_entries = kStatCacheDefaultMaxEntries;
@@ -941,10 +1212,31 @@ Status GcsFileSystem::NewRandomAccessFile(
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
   TF_RETURN_IF_ERROR(CheckBucketLocationConstraint(bucket));
   bool cache_enabled;
+  int readahead_max_requests;
+  size_t readahead_chunk_size;
+  std::shared_ptr<GcsReadaheadBudget> readahead_budget;
   {
     mutex_lock l(block_cache_lock_);
     cache_enabled = file_block_cache_->IsCacheEnabled();
-  }
+    readahead_max_requests = readahead_max_requests_;
+    readahead_chunk_size = readahead_chunk_size_;
+    readahead_budget = readahead_budget_;
+  }
+  auto uncached_read_fn = [this, bucket, object](
+                              const string& fname, uint64 offset, size_t n,
+                              StringPiece* result, char* scratch) {
+    *result = StringPiece();
+    size_t bytes_transferred;
+    TF_RETURN_IF_ERROR(
+        LoadBufferFromGCS(fname, offset, n, scratch, &bytes_transferred));
+    *result = StringPiece(scratch, bytes_transferred);
+    if (bytes_transferred < n) {
+      return errors::OutOfRange("EOF reached, ", result->size(),
+                                " bytes were read out of ", n,
+                                " bytes requested.");
+    }
+    return Status::OK();
+  };
   if (cache_enabled) {
     result->reset(new GcsRandomAccessFile(fname, [this, bucket, object](
                                                      const string& fname,
@@ -976,27 +1268,36 @@ Status GcsFileSystem::NewRandomAccessFile(
       }
       return Status::OK();
     }));
-  } else {
-    result->reset(new BufferedGcsRandomAccessFile(
-        fname, block_size_,
-        [this, bucket, object](const string& fname, uint64 offset, size_t n,
-                               StringPiece* result, char* scratch) {
-          *result = StringPiece();
-          size_t bytes_transferred;
-          TF_RETURN_IF_ERROR(
-              LoadBufferFromGCS(fname, offset, n, scratch, &bytes_transferred));
-          *result = StringPiece(scratch, bytes_transferred);
-          if (bytes_transferred < n) {
-            return errors::OutOfRange("EOF reached, ", result->size(),
-                                      " bytes were read out of ", n,
-                                      " bytes requested.");
+  } else if (readahead_max_requests > 0) {
+    result->reset(new ReadaheadGcsRandomAccessFile(
+        fname, readahead_chunk_size, readahead_max_requests,
+        std::move(readahead_budget), uncached_read_fn,
+        [this](const string& fname, size_t bytes_transferred,
+               int64 num_requests, uint64 total_latency_micros) {
+          if (stats_ != nullptr) {
+            stats_->RecordReadaheadFile(fname, bytes_transferred, num_requests,
+                                        total_latency_micros);
           }
-          return Status::OK();
         }));
+  } else {
+    result->reset(
+        new BufferedGcsRandomAccessFile(fname, block_size_, uncached_read_fn));
   }
   return Status::OK();
 }
 
+void GcsFileSystem::SetReadaheadConfig(int max_requests, size_t chunk_size,
+                                       size_t max_bytes) {
+  mutex_lock l(block_cache_lock_);
+  readahead_max_requests_ = max_requests;
+  readahead_chunk_size_ = chunk_size;
+  // Files opened before keep reserving from their own budget.
+  readahead_budget_ = std::make_shared<GcsReadaheadBudget>(max_bytes);
+  VLOG(1) << "GCS readahead max requests = " << max_requests << " ; "
+          << "chunk size = " << chunk_size << " ; "
+          << "max size = " << max_bytes;
+}
+
 void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
                                         size_t max_bytes,
                                         uint64 max_staleness_secs) {
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_GCS_FILE_SYSTEM_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_GCS_FILE_SYSTEM_H_
 
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -36,6 +37,7 @@ limitations under the License.
 namespace tensorflow {
 
 class GcsFileSystem;
+class GcsReadaheadBudget;
 
 // The environment variable that overrides the block size for aligned reads from
 // GCS. Specified in MB (e.g. "16" = 16 x 1024 x 1024 = 16777216 bytes).
@@ -50,6 +52,19 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets how many range reads each file keeps in
+// flight ahead of its sequential reads when the block cache is disabled. The
+// number of reads in flight grows with the length of the sequential run, up to
+// this maximum. A value of 0 (the default) disables readahead.
+constexpr char kReadaheadMaxRequests[] = "GCS_READAHEAD_MAX_REQUESTS";
+// The environment variable that overrides the size of each readahead range
+// read. Specified in MB.
+constexpr char kReadaheadChunkSize[] = "GCS_READAHEAD_CHUNK_SIZE_MB";
+constexpr size_t kDefaultReadaheadChunkSize = 8 * 1024 * 1024;
+// The environment variable that overrides the maximum number of bytes held by
+// readahead over all files of the file system. Specified in MB.
+constexpr char kReadaheadMaxSize[] = "GCS_READAHEAD_MAX_SIZE_MB";
+constexpr size_t kDefaultReadaheadMaxSize = 512 * 1024 * 1024;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -92,6 +107,13 @@ class GcsStatsInterface {
   // is about to be made.
   virtual void RecordStatObjectRequest() = 0;
 
+  /// RecordReadaheadFile is called when a file read with readahead is closed,
+  /// with the number of bytes and range requests fetched for it, and the total
+  /// latency of those requests.
+  virtual void RecordReadaheadFile(const string& file, size_t bytes_transferred,
+                                   int64 num_requests,
+                                   uint64 total_latency_micros) {}
+
   /// HttpStats is called to optionally provide a RequestStats listener
   /// to be annotated on every HTTP request made to the GCS API.
   ///
@@ -183,6 +205,11 @@ class GcsFileSystem : public FileSystem {
   /// Set an object to collect file block cache stats.
   void SetCacheStats(FileBlockCacheStatsInterface* cache_stats);
 
+  /// Configures the readahead of files opened from now on. See
+  /// `kReadaheadMaxRequests`.
+  void SetReadaheadConfig(int max_requests, size_t chunk_size,
+                          size_t max_bytes);
+
   /// These accessors are mainly for testing purposes, to verify that the
   /// environment variables that control these parameters are handled correctly.
   size_t block_size() {
@@ -424,6 +451,15 @@ class GcsFileSystem : public FileSystem {
 
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
+  // Readahead of files read without the block cache, see
+  // `kReadaheadMaxRequests`.
+  int readahead_max_requests_ TF_GUARDED_BY(block_cache_lock_) = 0;
+  size_t readahead_chunk_size_ TF_GUARDED_BY(block_cache_lock_) =
+      kDefaultReadaheadChunkSize;
+  // Shared by all files read with readahead.
+  std::shared_ptr<GcsReadaheadBudget> readahead_budget_
+      TF_GUARDED_BY(block_cache_lock_);
+
   // Additional header material to be transmitted with all GCS requests
   std::unique_ptr<std::pair<const string, const string>> additional_header_;
 
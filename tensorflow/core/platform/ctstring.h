@@ -56,7 +56,9 @@ inline size_t TF_TString_GetCapacity(const TF_TString *str);
 //    less than 22-bytes are stored in the TF_TString struct. This avoids any
 //    heap allocations.
 // TF_TSTR_LARGE:
-//    Heap allocated string.
+//    Heap allocated string.  The reference counted heap buffer is shared by
+//    the LARGE strings assigned from one another, and copied when one of them
+//    is mutated.
 // TF_TSTR_OFFSET: (currently unused)
 //    An offset defined string.  The string buffer begins at an internally
 //    defined little-endian offset from `str'; i.e. GetDataPointer() = str +
@@ -78,7 +80,8 @@ inline TF_TString_Type TF_TString_GetType(const TF_TString *str);
 inline const char *TF_TString_GetDataPointer(const TF_TString *str);
 // Returns a char pointer to a mutable representation of the underlying string.
 // In the case of VIEW and OFFSET types, `src' is converted to an owned type
-// (SMALL/LARGE).  The underlying character buffer may not be null-terminated.
+// (SMALL/LARGE), and a shared LARGE buffer is copied.  The underlying
+// character buffer may not be null-terminated.
 inline char *TF_TString_GetMutableDataPointer(TF_TString *str);
 
 // Sets `dst' as a VIEW type to `src'.  `dst' will not take ownership of `src'.
@@ -102,15 +105,16 @@ inline void TF_TString_AppendN(TF_TString *dst, const char *src, size_t size);
 // Assign | SMALL   |  SMALL       | fixed
 // Assign | OFFSET  |  VIEW        | fixed
 // Assign | VIEW    |  VIEW        | fixed
-// Assign | LARGE   |  LARGE       | O(size)
+// Assign | LARGE   |  LARGE       | fixed
 // Move   | *       |  same as src | fixed
 
 // Copies `src' to `dst'. `dst' will be an owned type (SMALL/LARGE). `src'
 // should not point to memory owned by `dst'.
 inline void TF_TString_Copy(TF_TString *dst, const char *src, size_t size);
 // Assigns a `src' tstring to `dst'.  An OFFSET `src' type will yield a `VIEW'
-// `dst'.  LARGE `src' types will be copied to a new buffer; all other `src'
-// types will incur a fixed cost.
+// `dst'.  A LARGE `dst' will share the reference counted buffer of a LARGE
+// `src', which is only copied when either string is mutated.  This function
+// incurs a fixed cost for all inputs.
 inline void TF_TString_Assign(TF_TString *dst, const TF_TString *src);
 // Moves a `src' tstring to `dst'.  Moving a LARGE `src' to `dst' will result in
 // a valid but unspecified `src'.  This function incurs a fixed cost for all
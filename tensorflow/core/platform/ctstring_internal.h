@@ -21,6 +21,10 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
 #if (defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && \
      __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) ||                  \
     defined(_WIN32)
@@ -168,6 +172,67 @@ static inline size_t TF_TString_ToInternalSizeT(size_t size,
 #endif  // TF_TSTRING_LITTLE_ENDIAN
 }
 
+// The buffer of a LARGE string is prefixed by a reference count, so that
+// assigning a LARGE string shares its buffer instead of copying it.  A shared
+// buffer is copied when one of the strings sharing it is mutated.
+typedef struct TF_TString_LargeHeader {  // NOLINT
+  int64_t refcount;
+} TF_TString_LargeHeader;
+
+static inline TF_TString_LargeHeader *TF_TString_GetLargeHeader(
+    const char *ptr) {
+  return (TF_TString_LargeHeader *)(ptr -                     // NOLINT
+                                    sizeof(TF_TString_LargeHeader));
+}
+
+// Returns an unshared LARGE buffer with room for `cap' characters and a null
+// delimiter.
+static inline char *TF_TString_LargeAlloc(size_t cap) {
+  TF_TString_LargeHeader *header = (TF_TString_LargeHeader *)malloc(  // NOLINT
+      sizeof(TF_TString_LargeHeader) + cap + 1);
+  header->refcount = 1;
+  return (char *)(header + 1);  // NOLINT
+}
+
+// Resizes the unshared LARGE buffer `ptr' to hold `cap' characters and a null
+// delimiter.
+static inline char *TF_TString_LargeRealloc(char *ptr, size_t cap) {
+  TF_TString_LargeHeader *header = (TF_TString_LargeHeader *)realloc(  // NOLINT
+      TF_TString_GetLargeHeader(ptr), sizeof(TF_TString_LargeHeader) + cap + 1);
+  return (char *)(header + 1);  // NOLINT
+}
+
+static inline int TF_TString_LargeIsShared(const char *ptr) {
+  TF_TString_LargeHeader *header = TF_TString_GetLargeHeader(ptr);
+#if defined(_MSC_VER) && !defined(__clang__)
+  return *(volatile int64_t *)&header->refcount > 1;  // NOLINT
+#else
+  return __atomic_load_n(&header->refcount, __ATOMIC_ACQUIRE) > 1;
+#endif
+}
+
+static inline void TF_TString_LargeRef(const char *ptr) {
+  TF_TString_LargeHeader *header = TF_TString_GetLargeHeader(ptr);
+#if defined(_MSC_VER) && !defined(__clang__)
+  _InterlockedIncrement64(&header->refcount);
+#else
+  __atomic_fetch_add(&header->refcount, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline void TF_TString_LargeUnref(const char *ptr) {
+  TF_TString_LargeHeader *header = TF_TString_GetLargeHeader(ptr);
+  // The common case of an unshared buffer needs no atomic decrement.
+  if (TF_TString_LargeIsShared(ptr)) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    if (_InterlockedDecrement64(&header->refcount) != 0) return;
+#else
+    if (__atomic_sub_fetch(&header->refcount, 1, __ATOMIC_ACQ_REL) != 0) return;
+#endif
+  }
+  free(header);
+}
+
 static inline void TF_TString_Init(TF_TString *str) {
   memset(str->u.raw.raw, 0, sizeof(TF_TString_Raw));
 }
@@ -175,7 +240,7 @@ static inline void TF_TString_Init(TF_TString *str) {
 static inline void TF_TString_Dealloc(TF_TString *str) {
   if (TF_TString_GetType(str) == TF_TSTR_LARGE &&
       str->u.large.ptr != NULL) {  // NOLINT
-    free(str->u.large.ptr);
+    TF_TString_LargeUnref(str->u.large.ptr);
     TF_TString_Init(str);
   }
 }
@@ -242,7 +307,7 @@ static inline char *TF_TString_ResizeUninitialized(TF_TString *str,
     }
 
     if (curr_type == TF_TSTR_LARGE) {
-      free((void *)curr_ptr);  // NOLINT
+      TF_TString_LargeUnref(curr_ptr);
     }
 
     // We do not clear out the newly excluded region.
@@ -268,12 +333,18 @@ static inline char *TF_TString_ResizeUninitialized(TF_TString *str,
   }
 
   char *new_ptr;
-  if (new_cap == curr_cap) {
+  if (curr_type == TF_TSTR_LARGE && TF_TString_LargeIsShared(curr_ptr)) {
+    new_ptr = TF_TString_LargeAlloc(new_cap);
+    if (copy_size) {
+      memcpy(new_ptr, curr_ptr, copy_size);
+    }
+    TF_TString_LargeUnref(curr_ptr);
+  } else if (new_cap == curr_cap) {
     new_ptr = str->u.large.ptr;
   } else if (curr_type == TF_TSTR_LARGE) {
-    new_ptr = (char *)realloc(str->u.large.ptr, new_cap + 1);  // NOLINT
+    new_ptr = TF_TString_LargeRealloc(str->u.large.ptr, new_cap);
   } else {
-    new_ptr = (char *)malloc(new_cap + 1);  // NOLINT
+    new_ptr = TF_TString_LargeAlloc(new_cap);
     if (copy_size) {
       memcpy(new_ptr, curr_ptr, copy_size);
     }
@@ -298,6 +369,13 @@ static inline char *TF_TString_GetMutableDataPointer(TF_TString *str) {
       return (TF_TString_GetType(str) == TF_TSTR_SMALL) ? str->u.smll.str
                                                         : str->u.large.ptr;
     case TF_TSTR_LARGE:
+      if (TF_TString_LargeIsShared(str->u.large.ptr)) {
+        // Copy the shared buffer before it is mutated.
+        char *new_ptr = TF_TString_LargeAlloc(str->u.large.cap);
+        memcpy(new_ptr, str->u.large.ptr, TF_TString_GetSize(str) + 1);
+        TF_TString_LargeUnref(str->u.large.ptr);
+        str->u.large.ptr = new_ptr;
+      }
       return str->u.large.ptr;
     default:
       // Unreachable.
@@ -330,13 +408,15 @@ static inline void TF_TString_Reserve(TF_TString *str, size_t new_cap) {
   // So we make sure we have enough room in the VIEW and OFFSET cases.
   new_cap = TF_align16(TF_max(new_cap, curr_size) + 1) - 1;
 
-  if (curr_type == TF_TSTR_LARGE) {
-    str->u.large.ptr =
-        (char *)realloc(str->u.large.ptr, new_cap + 1);  // NOLINT
+  if (curr_type == TF_TSTR_LARGE && !TF_TString_LargeIsShared(curr_ptr)) {
+    str->u.large.ptr = TF_TString_LargeRealloc(str->u.large.ptr, new_cap);
   } else {
-    // Convert to Large
-    char *new_ptr = (char *)malloc(new_cap + 1);  // NOLINT
+    // Convert to Large, or copy the shared buffer of a Large.
+    char *new_ptr = TF_TString_LargeAlloc(new_cap);
     memcpy(new_ptr, curr_ptr, curr_size);
+    if (curr_type == TF_TSTR_LARGE) {
+      TF_TString_LargeUnref(curr_ptr);
+    }
 
     str->u.large.size = TF_TString_ToInternalSizeT(curr_size, TF_TSTR_LARGE);
     str->u.large.ptr = new_ptr;
@@ -401,12 +481,9 @@ static inline void TF_TString_Assign(TF_TString *dst, const TF_TString *src) {
     case TF_TSTR_VIEW:
       *dst = *src;
       return;
-    case TF_TSTR_LARGE: {
-      const char *src_c = TF_TString_GetDataPointer(src);
-      size_t size = TF_TString_GetSize(src);
-
-      TF_TString_Copy(dst, src_c, size);
-    }
+    case TF_TSTR_LARGE:
+      *dst = *src;
+      TF_TString_LargeRef(dst->u.large.ptr);
       return;
     case TF_TSTR_OFFSET: {
       const char *src_c = TF_TString_GetDataPointer(src);
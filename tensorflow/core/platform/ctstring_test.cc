@@ -329,3 +329,43 @@ TEST(TF_CTStringTest, ResizeReserve) {
     TF_TString_Dealloc(&s70);
   }
 }
+
+TEST(TF_CTStringTest, SharedLarge) {
+  TF_TString s80, s81, s82;
+  TF_TString_Init(&s80);
+  TF_TString_Init(&s81);
+  TF_TString_Init(&s82);
+
+  TF_TString_Copy(&s80, kLongString, strlen(kLongString));
+  TF_TString_Assign(&s81, &s80);
+  TF_TString_Assign(&s82, &s81);
+
+  // Assigned LARGE strings share their buffer.
+  EXPECT_EQ(TF_TSTR_LARGE, TF_TString_GetType(&s81));
+  EXPECT_EQ(TF_TString_GetDataPointer(&s80), TF_TString_GetDataPointer(&s81));
+  EXPECT_EQ(TF_TString_GetDataPointer(&s80), TF_TString_GetDataPointer(&s82));
+
+  // Mutating a string copies the shared buffer.
+  char *data = TF_TString_GetMutableDataPointer(&s81);
+  EXPECT_NE(TF_TString_GetDataPointer(&s80), data);
+  data[0] = '0';
+  EXPECT_STREQ(kLongString, TF_TString_GetDataPointer(&s80));
+  EXPECT_EQ('0', TF_TString_GetDataPointer(&s81)[0]);
+  EXPECT_EQ(data, TF_TString_GetMutableDataPointer(&s81));
+
+  // As does resizing or appending.
+  TF_TString_AppendN(&s82, "x", 1);
+  EXPECT_NE(TF_TString_GetDataPointer(&s80), TF_TString_GetDataPointer(&s82));
+  EXPECT_STREQ(kLongString, TF_TString_GetDataPointer(&s80));
+  EXPECT_EQ(strlen(kLongString) + 1, TF_TString_GetSize(&s82));
+
+  // The last string sharing a buffer frees it.
+  TF_TString_Assign(&s81, &s80);
+  TF_TString_Dealloc(&s80);
+  EXPECT_STREQ(kLongString, TF_TString_GetDataPointer(&s81));
+  TF_TString_ResizeUninitialized(&s81, 1);
+  EXPECT_EQ(TF_TSTR_SMALL, TF_TString_GetType(&s81));
+
+  TF_TString_Dealloc(&s81);
+  TF_TString_Dealloc(&s82);
+}
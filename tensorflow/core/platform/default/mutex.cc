@@ -22,6 +22,17 @@ limitations under the License.
 #include "nsync_mu_wait.h"  // NOLINT
 #include "nsync_time.h"     // NOLINT
 
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/mutex_contention.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TF_MUTEX_CALLER() _ReturnAddress()
+#else
+#define TF_MUTEX_CALLER() __builtin_return_address(0)
+#endif
+#endif  // TF_MUTEX_CONTENTION_PROFILING
+
 namespace tensorflow {
 
 // Check that the MuData struct used to reserve space for the mutex
@@ -40,13 +51,45 @@ mutex::mutex() { nsync::nsync_mu_init(mu_cast(&mu_)); }
 
 mutex::mutex(LinkerInitialized x) {}
 
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+// Acquires `mu` with `lock`, and records the time blocked at `site` if `mu`
+// was held and the acquisition is sampled.
+static inline void LockAndRecordContention(nsync::nsync_mu *mu,
+                                           int (*try_lock)(nsync::nsync_mu *),
+                                           void (*lock)(nsync::nsync_mu *),
+                                           const void *site) {
+  if (try_lock(mu)) return;
+  const int64 weight = internal::SampleMutexContention();
+  if (weight == 0) {
+    lock(mu);
+    return;
+  }
+  const uint64 start_nanos = EnvTime::NowNanos();
+  lock(mu);
+  internal::RecordMutexContention(site, EnvTime::NowNanos() - start_nanos,
+                                  weight);
+}
+
+void mutex::lock() {
+  LockAndRecordContention(mu_cast(&mu_), &nsync::nsync_mu_trylock,
+                          &nsync::nsync_mu_lock, TF_MUTEX_CALLER());
+}
+#else
 void mutex::lock() { nsync::nsync_mu_lock(mu_cast(&mu_)); }
+#endif  // TF_MUTEX_CONTENTION_PROFILING
 
 bool mutex::try_lock() { return nsync::nsync_mu_trylock(mu_cast(&mu_)) != 0; };
 
 void mutex::unlock() { nsync::nsync_mu_unlock(mu_cast(&mu_)); }
 
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+void mutex::lock_shared() {
+  LockAndRecordContention(mu_cast(&mu_), &nsync::nsync_mu_rtrylock,
+                          &nsync::nsync_mu_rlock, TF_MUTEX_CALLER());
+}
+#else
 void mutex::lock_shared() { nsync::nsync_mu_rlock(mu_cast(&mu_)); }
+#endif  // TF_MUTEX_CONTENTION_PROFILING
 
 bool mutex::try_lock_shared() {
   return nsync::nsync_mu_rtrylock(mu_cast(&mu_)) != 0;
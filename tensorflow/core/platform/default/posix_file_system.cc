@@ -18,6 +18,7 @@ limitations under the License.
 #include <fcntl.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <sys/mman.h>
 #if defined(__linux__)
 #include <sys/sendfile.h>
@@ -35,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
 namespace tensorflow {
@@ -42,6 +44,30 @@ namespace tensorflow {
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+// The default number of threads issuing the reads of `ReadAsync()`, overridden
+// by TF_POSIX_ASYNC_READ_THREADS. This bounds the reads in flight on the local
+// disks, so it is sized to keep an NVMe queue busy.
+constexpr int kDefaultAsyncReadThreads = 32;
+
+namespace {
+
+// Returns the process-wide pool of threads which issue the reads of
+// `PosixRandomAccessFile::ReadAsync()`.
+thread::ThreadPool* AsyncReadThreadPool() {
+  static thread::ThreadPool* pool = [] {
+    int num_threads = kDefaultAsyncReadThreads;
+    const char* num_threads_str = getenv("TF_POSIX_ASYNC_READ_THREADS");
+    if (num_threads_str != nullptr && atoi(num_threads_str) > 0) {
+      num_threads = atoi(num_threads_str);
+    }
+    return new thread::ThreadPool(Env::Default(), "posix_async_read",
+                                  num_threads);
+  }();
+  return pool;
+}
+
+}  // namespace
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -92,6 +118,18 @@ class PosixRandomAccessFile : public RandomAccessFile {
     *result = StringPiece(scratch, dst - scratch);
     return s;
   }
+
+  // Issues the pread() from a shared pool of I/O threads, so that few callers
+  // can keep many reads in flight.
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadDoneCallback done) const override {
+    AsyncReadThreadPool()->Schedule(
+        [this, offset, n, scratch, done = std::move(done)]() {
+          StringPiece result;
+          Status s = Read(offset, n, &result, scratch);
+          done(s, result);
+        });
+  }
 };
 
 class PosixWritableFile : public WritableFile {
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/path.h"
@@ -90,6 +91,35 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadAsync) {
+  const string filename = io::JoinPath(BaseDir(), "read_async");
+  const string input = CreateTestFile(env_, filename, 1000);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  // Keeps all the reads in flight at once, including one past EOF.
+  constexpr int kNumReads = 11;
+  std::vector<string> scratch(kNumReads, string(100, '\0'));
+  std::vector<Status> statuses(kNumReads);
+  std::vector<StringPiece> results(kNumReads);
+  BlockingCounter counter(kNumReads);
+  for (int i = 0; i < kNumReads; ++i) {
+    f->ReadAsync(i * 100, 100, &scratch[i][0],
+                 [&, i](const Status& status, StringPiece result) {
+                   statuses[i] = status;
+                   results[i] = result;
+                   counter.DecrementCount();
+                 });
+  }
+  counter.Wait();
+  for (int i = 0; i < kNumReads - 1; ++i) {
+    TF_EXPECT_OK(statuses[i]);
+    EXPECT_EQ(input.substr(i * 100, 100), results[i]);
+  }
+  EXPECT_EQ(error::OUT_OF_RANGE, statuses[kNumReads - 1].code());
+  EXPECT_TRUE(results[kNumReads - 1].empty());
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
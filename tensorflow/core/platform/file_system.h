@@ -751,6 +751,29 @@ class RandomAccessFile {
   virtual tensorflow::Status Read(uint64 offset, size_t n, StringPiece* result,
                                   char* scratch) const = 0;
 
+  /// Called with the status and the data of a `ReadAsync()`.
+  typedef std::function<void(const Status& status, StringPiece result)>
+      ReadDoneCallback;
+
+  /// \brief Reads up to `n` bytes from the file starting at `offset`, and
+  /// calls `done` once the read is complete.
+  ///
+  /// Has the same contract as `Read()`, with `scratch[0..n-1]` required to
+  /// stay live, and the file open, until `done` is called. `done` may be
+  /// called from another thread, or before `ReadAsync()` returns. Lets a few
+  /// threads keep many reads in flight on file systems which can serve them
+  /// concurrently.
+  ///
+  /// The default implementation reads synchronously.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(uint64 offset, size_t n, char* scratch,
+                         ReadDoneCallback done) const {
+    StringPiece result;
+    Status status = Read(offset, n, &result, scratch);
+    done(status, result);
+  }
+
   // TODO(ebrevdo): Remove this ifdef when absl is updated.
 #if defined(PLATFORM_GOOGLE)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_FINGERPRINT_H_
 #define TENSORFLOW_CORE_PLATFORM_FINGERPRINT_H_
 
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -90,6 +92,22 @@ inline uint64 Fingerprint64(const StringPiece s) {
 #endif
 }
 
+// Sets `fingerprints[i]` to Fingerprint64(`inputs[i]`) for each of the
+// `inputs`.  On large batches this is faster than calling Fingerprint64() on
+// each string, since the characters of the next strings are prefetched while a
+// string is fingerprinted.
+inline void Fingerprint64Batch(absl::Span<const tstring> inputs,
+                               absl::Span<uint64> fingerprints) {
+  constexpr size_t kPrefetchDistance = 8;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (i + kPrefetchDistance < inputs.size()) {
+      port::prefetch<port::PREFETCH_HINT_T0>(
+          inputs[i + kPrefetchDistance].data());
+    }
+    fingerprints[i] = Fingerprint64(inputs[i]);
+  }
+}
+
 // 32-bit variant of Fingerprint64 above (same properties and caveats apply).
 inline uint32 Fingerprint32(const StringPiece s) {
 #ifdef USE_OSS_FARMHASH
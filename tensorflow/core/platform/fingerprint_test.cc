@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/platform/fingerprint.h"
 
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
@@ -28,6 +29,18 @@ TEST(Fingerprint64, IsForeverFrozen) {
   EXPECT_EQ(18308117990299812472ULL, Fingerprint64("World"));
 }
 
+TEST(Fingerprint64, Batch) {
+  std::vector<tstring> inputs;
+  for (int i = 0; i < 20; ++i) {
+    inputs.emplace_back(std::string(i * 3, 'a' + i));
+  }
+  std::vector<uint64> fingerprints(inputs.size());
+  Fingerprint64Batch(inputs, absl::MakeSpan(fingerprints));
+  for (int i = 0; i < inputs.size(); ++i) {
+    EXPECT_EQ(Fingerprint64(inputs[i]), fingerprints[i]);
+  }
+}
+
 TEST(Fingerprint128, IsForeverFrozen) {
   {
     const Fprint128 fingerprint = Fingerprint128("Hello");
@@ -24,6 +24,8 @@ limitations under the License.
 #include <functional>
 #include <string>
 
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -46,6 +48,20 @@ inline uint64 Hash64(const tstring& str) {
   return Hash64(str.data(), str.size());
 }
 
+// Sets `hashes[i]` to Hash64(`inputs[i]`) for each of the `inputs`, like
+// Fingerprint64Batch() does for Fingerprint64().
+inline void Hash64Batch(absl::Span<const tstring> inputs,
+                        absl::Span<uint64> hashes) {
+  constexpr size_t kPrefetchDistance = 8;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (i + kPrefetchDistance < inputs.size()) {
+      port::prefetch<port::PREFETCH_HINT_T0>(
+          inputs[i + kPrefetchDistance].data());
+    }
+    hashes[i] = Hash64(inputs[i]);
+  }
+}
+
 inline uint64 Hash64Combine(uint64 a, uint64 b) {
   return a ^ (b + 0x9e3779b97f4a7800ULL + (a << 10) + (a >> 4));
 }
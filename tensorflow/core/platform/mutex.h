@@ -48,6 +48,10 @@ class Condition;
 // constructor interface.  This type is as fast as mutex, but is also a shared
 // lock, and provides conditional critical sections (via Await()), as an
 // alternative to condition variables.
+//
+// When built with -DTF_MUTEX_CONTENTION_PROFILING, lock() and lock_shared()
+// record the time blocked by a sample of the contended acquisitions per call
+// site; see mutex_contention.h.
 class TF_LOCKABLE mutex {
  public:
   mutex();
@@ -0,0 +1,171 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/mutex_contention.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+#include "absl/debugging/symbolize.h"
+#include "absl/strings/numbers.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr int64 kDefaultSamplingPeriod = 10;
+
+// The size of the table of call sites, and the number of slots probed for a
+// call site before its samples are dropped.
+constexpr int kNumSites = 4096;
+constexpr int kMaxProbes = 64;
+
+struct Site {
+  std::atomic<uintptr_t> site;
+  std::atomic<int64> num_samples;
+  std::atomic<int64> num_contentions;
+  std::atomic<uint64> total_wait_nanos;
+  std::atomic<uint64> max_wait_nanos;
+};
+
+// Zero-initialized before any mutex can be locked.
+Site sites[kNumSites];
+
+// -1 until it is read from the environment.
+std::atomic<int64> sampling_period{-1};
+
+int64 SamplingPeriod() {
+  int64 period = sampling_period.load(std::memory_order_relaxed);
+  if (period < 0) {
+    period = kDefaultSamplingPeriod;
+    const char* env = std::getenv("TF_MUTEX_CONTENTION_SAMPLING_PERIOD");
+    int64 env_period;
+    if (env != nullptr && absl::SimpleAtoi(env, &env_period) &&
+        env_period > 0) {
+      period = env_period;
+    }
+    sampling_period.store(period, std::memory_order_relaxed);
+  }
+  return period;
+}
+
+// Returns the slot of `site`, claiming a free one if needed, or nullptr if
+// the table is full around its hash.
+Site* FindOrAddSite(uintptr_t site) {
+  size_t index = (site >> 4) * 0x9E3779B97F4A7C15ull >> 52;
+  for (int probe = 0; probe < kMaxProbes; ++probe) {
+    Site* slot = &sites[(index + probe) % kNumSites];
+    uintptr_t current = slot->site.load(std::memory_order_acquire);
+    if (current == site) return slot;
+    if (current == 0 &&
+        (slot->site.compare_exchange_strong(current, site,
+                                            std::memory_order_acq_rel) ||
+         current == site)) {
+      return slot;
+    }
+  }
+  return nullptr;
+}
+
+std::string Symbolize(const void* site) {
+  char buffer[1024];
+  // The return address may be the first instruction of the next function, so
+  // the call instruction before it is symbolized.
+  if (absl::Symbolize(static_cast<const char*>(site) - 1, buffer,
+                      sizeof(buffer))) {
+    return buffer;
+  }
+  snprintf(buffer, sizeof(buffer), "%p", site);
+  return buffer;
+}
+
+}  // namespace
+
+bool MutexContentionProfilingEnabled() {
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+  return true;
+#else
+  return false;
+#endif
+}
+
+void SetMutexContentionSamplingPeriod(int64 period) {
+  sampling_period.store(std::max<int64>(period, 1), std::memory_order_relaxed);
+}
+
+std::vector<MutexContentionStats> GetMutexContentionStats() {
+  std::vector<MutexContentionStats> result;
+  for (Site& slot : sites) {
+    const uintptr_t site = slot.site.load(std::memory_order_acquire);
+    if (site == 0) continue;
+    MutexContentionStats stats;
+    stats.num_samples = slot.num_samples.load(std::memory_order_relaxed);
+    if (stats.num_samples == 0) continue;
+    stats.site = reinterpret_cast<const void*>(site);
+    stats.num_contentions =
+        slot.num_contentions.load(std::memory_order_relaxed);
+    stats.total_wait_nanos =
+        slot.total_wait_nanos.load(std::memory_order_relaxed);
+    stats.max_wait_nanos = slot.max_wait_nanos.load(std::memory_order_relaxed);
+    result.push_back(stats);
+  }
+  std::sort(result.begin(), result.end(),
+            [](const MutexContentionStats& a, const MutexContentionStats& b) {
+              return a.total_wait_nanos > b.total_wait_nanos;
+            });
+  for (MutexContentionStats& stats : result) {
+    stats.function = Symbolize(stats.site);
+  }
+  return result;
+}
+
+void ResetMutexContentionStats() {
+  for (Site& slot : sites) {
+    slot.num_samples.store(0, std::memory_order_relaxed);
+    slot.num_contentions.store(0, std::memory_order_relaxed);
+    slot.total_wait_nanos.store(0, std::memory_order_relaxed);
+    slot.max_wait_nanos.store(0, std::memory_order_relaxed);
+  }
+}
+
+namespace internal {
+
+int64 SampleMutexContention() {
+  static thread_local int64 countdown = 0;
+  if (--countdown > 0) return 0;
+  countdown = SamplingPeriod();
+  return countdown;
+}
+
+void RecordMutexContention(const void* site, uint64 wait_nanos, int64 weight) {
+  // 0 marks the free slots, so unknown call sites are recorded as 1.
+  Site* slot =
+      FindOrAddSite(std::max<uintptr_t>(reinterpret_cast<uintptr_t>(site), 1));
+  if (slot == nullptr) return;
+  slot->num_samples.fetch_add(1, std::memory_order_relaxed);
+  slot->num_contentions.fetch_add(weight, std::memory_order_relaxed);
+  slot->total_wait_nanos.fetch_add(wait_nanos * weight,
+                                   std::memory_order_relaxed);
+  uint64 max_wait = slot->max_wait_nanos.load(std::memory_order_relaxed);
+  while (wait_nanos > max_wait &&
+         !slot->max_wait_nanos.compare_exchange_weak(
+             max_wait, wait_nanos, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace internal
+}  // namespace tensorflow
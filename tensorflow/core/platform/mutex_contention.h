@@ -0,0 +1,79 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_MUTEX_CONTENTION_H_
+#define TENSORFLOW_CORE_PLATFORM_MUTEX_CONTENTION_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
+// Contention profiling of tensorflow::mutex.
+//
+// When TensorFlow is built with -DTF_MUTEX_CONTENTION_PROFILING, mutex::lock()
+// and mutex::lock_shared() time a sample of the acquisitions that find the
+// mutex held, and add the time blocked to the stats of the call site of the
+// acquisition.  Uncontended acquisitions only pay for a try-lock, so the build
+// mode is cheap enough for production jobs.  The stats are kept in a fixed
+// lock-free table, since they can't be guarded by a mutex themselves.
+
+namespace tensorflow {
+
+// The estimated contention of the mutexes acquired at a call site.
+struct MutexContentionStats {
+  // The return address of the call to mutex::lock() or
+  // mutex::lock_shared(), and the name of the function that contains it, or
+  // the address if it can't be symbolized.
+  const void* site = nullptr;
+  std::string function;
+  // The number of sampled acquisitions that blocked.
+  int64 num_samples = 0;
+  // The estimated number of acquisitions that blocked, and the total time
+  // that they were blocked.
+  int64 num_contentions = 0;
+  uint64 total_wait_nanos = 0;
+  // The longest time that a sampled acquisition was blocked.
+  uint64 max_wait_nanos = 0;
+};
+
+// Returns true if TensorFlow was built with TF_MUTEX_CONTENTION_PROFILING.
+bool MutexContentionProfilingEnabled();
+
+// Sets the sampling period: one in every `period` acquisitions that block is
+// timed on each thread.  Defaults to the
+// TF_MUTEX_CONTENTION_SAMPLING_PERIOD environment variable, or 10.
+void SetMutexContentionSamplingPeriod(int64 period);
+
+// Returns the stats of all the call sites with contention, by decreasing
+// total wait time.
+std::vector<MutexContentionStats> GetMutexContentionStats();
+
+// Clears the stats of all the call sites.
+void ResetMutexContentionStats();
+
+namespace internal {
+
+// Returns the weight of the current blocking acquisition if it is sampled,
+// and 0 otherwise.
+int64 SampleMutexContention();
+
+// Records that a sampled acquisition at `site` was blocked for `wait_nanos`.
+void RecordMutexContention(const void* site, uint64 wait_nanos, int64 weight);
+
+}  // namespace internal
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_MUTEX_CONTENTION_H_
@@ -0,0 +1,96 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/mutex_contention.h"
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(MutexContentionTest, RanksSitesByTotalWait) {
+  ResetMutexContentionStats();
+  static const char kSites[2] = {};
+  internal::RecordMutexContention(&kSites[0], 100, 10);
+  internal::RecordMutexContention(&kSites[1], 50, 1);
+  internal::RecordMutexContention(&kSites[1], 400, 10);
+
+  std::vector<MutexContentionStats> stats = GetMutexContentionStats();
+  ASSERT_GE(stats.size(), 2);
+  EXPECT_EQ(stats[0].site, &kSites[1]);
+  EXPECT_EQ(stats[0].num_samples, 2);
+  EXPECT_EQ(stats[0].num_contentions, 11);
+  EXPECT_EQ(stats[0].total_wait_nanos, 4050);
+  EXPECT_EQ(stats[0].max_wait_nanos, 400);
+  EXPECT_FALSE(stats[0].function.empty());
+  EXPECT_EQ(stats[1].site, &kSites[0]);
+  EXPECT_EQ(stats[1].total_wait_nanos, 1000);
+
+  ResetMutexContentionStats();
+  for (const MutexContentionStats& s : GetMutexContentionStats()) {
+    EXPECT_NE(s.site, &kSites[0]);
+    EXPECT_NE(s.site, &kSites[1]);
+  }
+}
+
+TEST(MutexContentionTest, SamplesOneInPeriod) {
+  SetMutexContentionSamplingPeriod(4);
+  // Starts right after a sample.
+  while (internal::SampleMutexContention() == 0) {
+  }
+  int num_sampled = 0;
+  for (int i = 0; i < 400; ++i) {
+    const int64 weight = internal::SampleMutexContention();
+    if (weight != 0) {
+      EXPECT_EQ(weight, 4);
+      ++num_sampled;
+    }
+  }
+  EXPECT_EQ(num_sampled, 100);
+  SetMutexContentionSamplingPeriod(1);
+  EXPECT_EQ(internal::SampleMutexContention(), 1);
+  EXPECT_EQ(internal::SampleMutexContention(), 1);
+}
+
+TEST(MutexContentionTest, RecordsBlockedLock) {
+  if (!MutexContentionProfilingEnabled()) {
+    GTEST_SKIP() << "Built without TF_MUTEX_CONTENTION_PROFILING";
+  }
+  ResetMutexContentionStats();
+  SetMutexContentionSamplingPeriod(1);
+  mutex mu;
+  Notification locked;
+  std::unique_ptr<Thread> holder(Env::Default()->StartThread(
+      ThreadOptions(), "holder", [&mu, &locked] {
+        mutex_lock l(mu);
+        locked.Notify();
+        Env::Default()->SleepForMicroseconds(20000);
+      }));
+  locked.WaitForNotification();
+  { mutex_lock l(mu); }
+  holder.reset();
+
+  uint64 total_wait_nanos = 0;
+  for (const MutexContentionStats& s : GetMutexContentionStats()) {
+    total_wait_nanos += s.total_wait_nanos;
+  }
+  EXPECT_GE(total_wait_nanos, 1000000);
+}
+
+}  // namespace
+}  // namespace tensorflow
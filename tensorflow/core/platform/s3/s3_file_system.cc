@@ -28,6 +28,7 @@ limitations under the License.
 #include <aws/s3/model/CompletedMultipartUpload.h>
 #include <aws/s3/model/CompletedPart.h>
 #include <aws/s3/model/CopyObjectRequest.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
 #include <aws/s3/model/DeleteObjectRequest.h>
 #include <aws/s3/model/GetObjectRequest.h>
 #include <aws/s3/model/HeadBucketRequest.h>
@@ -35,6 +36,7 @@ limitations under the License.
 #include <aws/s3/model/ListObjectsRequest.h>
 #include <aws/s3/model/PutObjectRequest.h>
 #include <aws/s3/model/UploadPartCopyRequest.h>
+#include <aws/s3/model/UploadPartRequest.h>
 
 #include <cmath>
 #include <cstdlib>
@@ -62,6 +64,8 @@ static const int64 kS3TimeoutMsec = 300000;                           // 5 min
 static const uint64 kS3MultiPartUploadChunkSize = 50 * 1024 * 1024;   // 50 MB
 static const uint64 kS3MultiPartDownloadChunkSize = 2 * 1024 * 1024;  // 50 MB
 static const int kS3GetChildrenMaxKeys = 100;
+static const int kS3MaxParts = 10000;
+static const int kS3DefaultMaxPartsInFlight = 4;
 
 // With this change multiple threads are used in one single download.
 // Increasing the thread pool size since multiple downloads
@@ -436,6 +440,289 @@ class S3WritableFile : public WritableFile {
   std::shared_ptr<Aws::Utils::TempFile> outfile_;
 };
 
+// The state of a multipart upload shared with the callbacks of its parts.
+struct StreamingUploadState {
+  string bucket;
+  string object;
+  Aws::String upload_id;
+  std::shared_ptr<Aws::S3::S3Client> s3_client;
+
+  mutex mu;
+  condition_variable cv;
+  int parts_in_flight TF_GUARDED_BY(mu) = 0;
+  // The first error of a part which failed after its retries.
+  Status status TF_GUARDED_BY(mu);
+  // The ETags of the uploaded parts, by part number.
+  std::map<int, Aws::String> etags TF_GUARDED_BY(mu);
+};
+
+// Uploads part `part_number` with the contents of `body`, retrying it up to
+// kUploadRetries times.
+void UploadPartAsync(std::shared_ptr<StreamingUploadState> state,
+                     std::shared_ptr<Aws::StringStream> body, int64 size,
+                     int part_number, int retries) {
+  body->clear();
+  body->seekg(0);
+  Aws::S3::Model::UploadPartRequest request;
+  request.WithBucket(state->bucket.c_str())
+      .WithKey(state->object.c_str())
+      .WithUploadId(state->upload_id)
+      .WithPartNumber(part_number)
+      .WithContentLength(size);
+  request.SetBody(body);
+  state->s3_client->UploadPartAsync(
+      request,
+      [state, body, size, part_number, retries](
+          const Aws::S3::S3Client* client,
+          const Aws::S3::Model::UploadPartRequest& request,
+          const Aws::S3::Model::UploadPartOutcome& outcome,
+          const std::shared_ptr<const Aws::Client::AsyncCallerContext>&
+              context) {
+        if (!outcome.IsSuccess() && retries < kUploadRetries) {
+          VLOG(1) << "Retrying upload of part " << part_number << " of s3://"
+                  << state->bucket << "/" << state->object
+                  << " after failure. Current retry count:" << retries + 1;
+          UploadPartAsync(state, body, size, part_number, retries + 1);
+          return;
+        }
+        mutex_lock l(state->mu);
+        if (outcome.IsSuccess()) {
+          state->etags[part_number] = outcome.GetResult().GetETag();
+        } else if (state->status.ok()) {
+          state->status = CreateStatusFromAwsError(outcome.GetError());
+        }
+        --state->parts_in_flight;
+        state->cv.notify_all();
+      });
+}
+
+// A writable file which uploads its contents as a multipart upload while it is
+// being written, instead of uploading a local copy on each Sync(). Up to
+// `max_parts_in_flight` parts are uploaded at once, and Append() blocks when
+// that many are in flight. Files smaller than one part are uploaded with a
+// single request on Close().
+//
+// The object is only created on Close(): Flush() and Sync() do not make the
+// contents written so far visible to readers.
+class S3StreamingWritableFile : public WritableFile {
+ public:
+  S3StreamingWritableFile(const string& bucket, const string& object,
+                          uint64 part_size, int max_parts_in_flight,
+                          std::shared_ptr<Aws::S3::S3Client> s3_client)
+      : part_size_(part_size),
+        max_parts_in_flight_(max_parts_in_flight),
+        state_(std::make_shared<StreamingUploadState>()),
+        buffer_(NewBuffer()) {
+    state_->bucket = bucket;
+    state_->object = object;
+    state_->s3_client = std::move(s3_client);
+  }
+
+  ~S3StreamingWritableFile() override {
+    if (!closed_ && !aborted_) {
+      // The file was not closed: drop what was written.
+      WaitForParts().IgnoreError();
+      AbortUpload();
+    }
+  }
+
+  Status Append(StringPiece data) override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    while (!data.empty()) {
+      const size_t n = std::min<uint64>(data.size(), part_size_ - buffer_size_);
+      buffer_->write(data.data(), n);
+      if (!buffer_->good()) {
+        return errors::Internal("Could not append to the upload buffer.");
+      }
+      buffer_size_ += n;
+      data.remove_prefix(n);
+      if (buffer_size_ == part_size_) {
+        TF_RETURN_IF_ERROR(UploadBuffer());
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Close() override {
+    if (closed_) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(CheckWritable());
+    if (state_->upload_id.empty()) {
+      TF_RETURN_IF_ERROR(PutObject());
+      closed_ = true;
+      return Status::OK();
+    }
+    Status status;
+    if (buffer_size_ > 0) {
+      status = UploadBuffer();
+    }
+    if (status.ok()) {
+      status = WaitForParts();
+    }
+    if (status.ok()) {
+      status = CompleteUpload();
+    }
+    if (!status.ok()) {
+      AbortUpload();
+      return status;
+    }
+    closed_ = true;
+    return Status::OK();
+  }
+
+  // The contents are uploaded as parts fill up, and only become visible on
+  // Close().
+  Status Flush() override { return CheckWritable(); }
+
+  Status Name(StringPiece* result) const override {
+    return errors::Unimplemented(
+        "S3StreamingWritableFile does not support Name()");
+  }
+
+  // Waits for the parts in flight, and returns the first error of a part.
+  Status Sync() override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    return WaitForParts();
+  }
+
+ private:
+  static std::shared_ptr<Aws::StringStream> NewBuffer() {
+    return Aws::MakeShared<Aws::StringStream>(kS3FileSystemAllocationTag);
+  }
+
+  Status CheckWritable() {
+    if (closed_) {
+      return errors::FailedPrecondition("The file is closed.");
+    }
+    if (aborted_) {
+      return errors::FailedPrecondition("The upload of s3://", state_->bucket,
+                                        "/", state_->object,
+                                        " was aborted after an error.");
+    }
+    return Status::OK();
+  }
+
+  // Starts the upload of the buffered part, once fewer than
+  // `max_parts_in_flight_` parts are in flight.
+  Status UploadBuffer() {
+    if (state_->upload_id.empty()) {
+      TF_RETURN_IF_ERROR(CreateUpload());
+    }
+    if (num_parts_ == kS3MaxParts) {
+      return errors::Unimplemented(
+          "S3 uploads of more than ", kS3MaxParts, " parts are not supported. ",
+          "Set S3_MULTI_PART_UPLOAD_CHUNK_SIZE to a larger part size.");
+    }
+    {
+      mutex_lock l(state_->mu);
+      while (state_->parts_in_flight >= max_parts_in_flight_) {
+        state_->cv.wait(l);
+      }
+      TF_RETURN_IF_ERROR(state_->status);
+      ++state_->parts_in_flight;
+    }
+    UploadPartAsync(state_, buffer_, buffer_size_, ++num_parts_,
+                    /*retries=*/0);
+    buffer_ = NewBuffer();
+    buffer_size_ = 0;
+    return Status::OK();
+  }
+
+  Status WaitForParts() {
+    mutex_lock l(state_->mu);
+    while (state_->parts_in_flight > 0) {
+      state_->cv.wait(l);
+    }
+    return state_->status;
+  }
+
+  Status CreateUpload() {
+    VLOG(1) << "Starting multipart upload of s3://" << state_->bucket << "/"
+            << state_->object;
+    Aws::S3::Model::CreateMultipartUploadRequest request;
+    request.WithBucket(state_->bucket.c_str())
+        .WithKey(state_->object.c_str())
+        .WithContentType("application/octet-stream");
+    auto outcome = state_->s3_client->CreateMultipartUpload(request);
+    if (!outcome.IsSuccess()) {
+      return CreateStatusFromAwsError(outcome.GetError());
+    }
+    state_->upload_id = outcome.GetResult().GetUploadId();
+    return Status::OK();
+  }
+
+  Status CompleteUpload() {
+    Aws::S3::Model::CompletedMultipartUpload completed_upload;
+    {
+      mutex_lock l(state_->mu);
+      for (const auto& part : state_->etags) {
+        Aws::S3::Model::CompletedPart completed_part;
+        completed_part.SetPartNumber(part.first);
+        completed_part.SetETag(part.second);
+        completed_upload.AddParts(completed_part);
+      }
+    }
+    Aws::S3::Model::CompleteMultipartUploadRequest request;
+    request.WithBucket(state_->bucket.c_str())
+        .WithKey(state_->object.c_str())
+        .WithUploadId(state_->upload_id)
+        .WithMultipartUpload(completed_upload);
+    auto outcome = state_->s3_client->CompleteMultipartUpload(request);
+    if (!outcome.IsSuccess()) {
+      return CreateStatusFromAwsError(outcome.GetError());
+    }
+    return Status::OK();
+  }
+
+  void AbortUpload() {
+    aborted_ = true;
+    if (state_->upload_id.empty()) {
+      return;
+    }
+    Aws::S3::Model::AbortMultipartUploadRequest request;
+    request.WithBucket(state_->bucket.c_str())
+        .WithKey(state_->object.c_str())
+        .WithUploadId(state_->upload_id);
+    auto outcome = state_->s3_client->AbortMultipartUpload(request);
+    if (!outcome.IsSuccess()) {
+      LOG(WARNING) << "Could not abort the multipart upload of s3://"
+                   << state_->bucket << "/" << state_->object << ": "
+                   << outcome.GetError().GetMessage();
+    }
+  }
+
+  // Uploads a file smaller than one part with a single request. The buffer is
+  // kept on failure, so that Close() can be retried.
+  Status PutObject() {
+    VLOG(1) << "WriteFileToS3: s3://" << state_->bucket << "/"
+            << state_->object;
+    buffer_->clear();
+    buffer_->seekg(0);
+    Aws::S3::Model::PutObjectRequest request;
+    request.WithBucket(state_->bucket.c_str())
+        .WithKey(state_->object.c_str())
+        .WithContentType("application/octet-stream")
+        .WithContentLength(buffer_size_);
+    request.SetBody(buffer_);
+    auto outcome = state_->s3_client->PutObject(request);
+    if (!outcome.IsSuccess()) {
+      return CreateStatusFromAwsError(outcome.GetError());
+    }
+    return Status::OK();
+  }
+
+  const uint64 part_size_;
+  const int max_parts_in_flight_;
+  const std::shared_ptr<StreamingUploadState> state_;
+  // The contents of the part being written.
+  std::shared_ptr<Aws::StringStream> buffer_;
+  uint64 buffer_size_ = 0;
+  int num_parts_ = 0;
+  bool closed_ = false;
+  bool aborted_ = false;
+};
+
 class S3ReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
  public:
   S3ReadOnlyMemoryRegion(std::unique_ptr<char[]> data, uint64 length)
@@ -478,6 +765,25 @@ S3FileSystem::S3FileSystem()
     }
   }
 
+  // Streaming uploads are opt-in, since they only create objects on Close().
+  use_streaming_upload_ = false;
+  const char* streaming_upload = getenv("S3_STREAMING_UPLOAD");
+  if (streaming_upload) {
+    if (streaming_upload[0] == '1') {
+      use_streaming_upload_ = true;
+    }
+  }
+  max_parts_in_flight_ = kS3DefaultMaxPartsInFlight;
+  const char* max_parts_in_flight_str =
+      getenv("S3_STREAMING_UPLOAD_MAX_PARTS_IN_FLIGHT");
+  if (max_parts_in_flight_str) {
+    int32 max_parts_in_flight;
+    if (strings::safe_strto32(max_parts_in_flight_str, &max_parts_in_flight) &&
+        max_parts_in_flight > 0) {
+      max_parts_in_flight_ = max_parts_in_flight;
+    }
+  }
+
   use_multi_part_download_ = true;
   const char* disable_transfer_mgr = getenv("S3_DISABLE_MULTI_PART_DOWNLOAD");
   if (disable_transfer_mgr) {
@@ -588,15 +894,26 @@ Status S3FileSystem::NewRandomAccessFile(
   return Status::OK();
 }
 
+WritableFile* S3FileSystem::NewS3WritableFile(const string& bucket,
+                                             const string& object) {
+  if (use_streaming_upload_) {
+    return new S3StreamingWritableFile(
+        bucket, object,
+        multi_part_chunk_size_[Aws::Transfer::TransferDirection::UPLOAD],
+        max_parts_in_flight_, this->GetS3Client());
+  }
+  return new S3WritableFile(
+      bucket, object,
+      this->GetTransferManager(Aws::Transfer::TransferDirection::UPLOAD),
+      this->GetS3Client());
+}
+
 Status S3FileSystem::NewWritableFile(const string& fname,
                                      TransactionToken* token,
                                      std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3WritableFile(
-      bucket, object,
-      this->GetTransferManager(Aws::Transfer::TransferDirection::UPLOAD),
-      this->GetS3Client()));
+  result->reset(NewS3WritableFile(bucket, object));
 
   return Status::OK();
 }
@@ -613,10 +930,7 @@ Status S3FileSystem::NewAppendableFile(const string& fname,
 
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3WritableFile(
-      bucket, object,
-      this->GetTransferManager(Aws::Transfer::TransferDirection::UPLOAD),
-      this->GetS3Client()));
+  result->reset(NewS3WritableFile(bucket, object));
 
   while (true) {
     status = reader->Read(offset, kS3ReadAppendableFileBufferSize, &read_chunk,
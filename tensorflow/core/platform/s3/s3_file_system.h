@@ -123,6 +123,9 @@ class S3FileSystem : public FileSystem {
   std::shared_ptr<Aws::Utils::Threading::PooledThreadExecutor> GetExecutor();
   std::shared_ptr<Aws::Utils::Threading::PooledThreadExecutor> executor_;
 
+  // Returns a new writable file for the object, see `use_streaming_upload_`.
+  WritableFile* NewS3WritableFile(const string& bucket, const string& object);
+
   Status CopyFile(const Aws::String& source_bucket,
                   const Aws::String& source_key,
                   const Aws::String& target_bucket,
@@ -151,6 +154,12 @@ class S3FileSystem : public FileSystem {
   std::map<Aws::Transfer::TransferDirection, uint64> multi_part_chunk_size_;
 
   bool use_multi_part_download_;
+
+  // Whether writable files upload their contents in parts while they are
+  // written (S3_STREAMING_UPLOAD=1), with at most `max_parts_in_flight_` parts
+  // uploading at once per file (S3_STREAMING_UPLOAD_MAX_PARTS_IN_FLIGHT).
+  bool use_streaming_upload_;
+  int max_parts_in_flight_;
 };
 
 /// S3 implementation of a file system with retry on failures.
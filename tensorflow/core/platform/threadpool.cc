@@ -17,6 +17,13 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #include "absl/types/optional.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/platform/blocking_counter.h"
@@ -86,6 +93,58 @@ struct EigenEnvironment {
   }
 };
 
+namespace {
+
+bool WorkStealingParallelForFromEnvironment() {
+  const char* val = getenv("TF_WORK_STEALING_PARALLEL_FOR");
+  return val != nullptr && (strcmp(val, "1") == 0 || strcmp(val, "true") == 0);
+}
+
+// Below this cost (in cycles), a shard is not worth handing to another thread.
+constexpr int64 kMinCostPerShard = 10000;
+
+// Number of shards per thread, so that threads which start late or run slower
+// shards still finish at about the same time.
+constexpr int64 kShardsPerThread = 4;
+
+// Shared by the caller of ParallelForWorkStealing and the closures helping it.
+// It outlives the call, since a closure may only get to run after all the
+// shards are done.
+struct WorkStealingState {
+  WorkStealingState(const std::function<void(int64, int64)>* fn, int64 total,
+                    int64 block_size)
+      : fn(fn),
+        total(total),
+        block_size(block_size),
+        num_blocks((total + block_size - 1) / block_size) {}
+
+  // Runs unclaimed shards until there are none left.  `fn` is only used after
+  // claiming a shard, i.e. while the caller is still waiting.
+  void RunBlocks() {
+    for (;;) {
+      const int64 block = next_block.fetch_add(1, std::memory_order_relaxed);
+      if (block >= num_blocks) return;
+      const int64 start = block * block_size;
+      (*fn)(start, std::min(start + block_size, total));
+      if (num_done.fetch_add(1, std::memory_order_acq_rel) + 1 == num_blocks) {
+        mutex_lock l(mu);
+        all_done.notify_all();
+      }
+    }
+  }
+
+  const std::function<void(int64, int64)>* const fn;
+  const int64 total;
+  const int64 block_size;
+  const int64 num_blocks;
+  std::atomic<int64> next_block{0};
+  std::atomic<int64> num_done{0};
+  mutex mu;
+  condition_variable all_done;
+};
+
+}  // namespace
+
 ThreadPool::ThreadPool(Env* env, const string& name, int num_threads)
     : ThreadPool(env, ThreadOptions(), name, num_threads, true, nullptr) {}
 
@@ -95,7 +154,10 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
 
 ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
                        const string& name, int num_threads,
-                       bool low_latency_hint, Eigen::Allocator* allocator) {
+                       bool low_latency_hint, Eigen::Allocator* allocator)
+    : use_work_stealing_parallel_for_(
+          WorkStealingParallelForFromEnvironment()),
+      num_parallel_for_helpers_(std::make_shared<std::atomic<int>>(0)) {
   CHECK_GE(num_threads, 1);
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
       num_threads, low_latency_hint,
@@ -105,7 +167,10 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
                                                        num_threads, allocator));
 }
 
-ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool) {
+ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool)
+    : use_work_stealing_parallel_for_(
+          WorkStealingParallelForFromEnvironment()),
+      num_parallel_for_helpers_(std::make_shared<std::atomic<int>>(0)) {
   underlying_threadpool_ = user_threadpool;
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(
       underlying_threadpool_, underlying_threadpool_->NumThreads(), nullptr));
@@ -204,11 +269,56 @@ void ThreadPool::ParallelFor(int64 total, int64 cost_per_unit,
                              const std::function<void(int64, int64)>& fn) {
   CHECK_GE(total, 0);
   CHECK_EQ(total, (int64)(Eigen::Index)total);
+  if (use_work_stealing_parallel_for_) {
+    ParallelForWorkStealing(total, cost_per_unit, NumThreads() + 1, fn);
+    return;
+  }
   threadpool_device_->parallelFor(
       total, Eigen::TensorOpCost(0, 0, cost_per_unit),
       [&fn](Eigen::Index first, Eigen::Index last) { fn(first, last); });
 }
 
+void ThreadPool::ParallelForWorkStealing(
+    int64 total, int64 cost_per_unit, int max_parallelism,
+    const std::function<void(int64, int64)>& fn) {
+  CHECK_GE(total, 0);
+  if (total == 0) return;
+  cost_per_unit = std::max(int64{1}, cost_per_unit);
+  const int64 max_shards =
+      cost_per_unit >= kMinCostPerShard
+          ? total
+          : std::max<int64>(1, total * cost_per_unit / kMinCostPerShard);
+  // Threads of the pool that are not helping another call.  A caller from
+  // the pool itself occupies one of them.
+  int num_free =
+      NumThreads() - num_parallel_for_helpers_->load(std::memory_order_relaxed);
+  if (CurrentThreadId() >= 0) --num_free;
+  const int num_helpers = static_cast<int>(std::min<int64>(
+      std::min(max_parallelism - 1, num_free), max_shards - 1));
+  if (num_helpers <= 0) {
+    fn(0, total);
+    return;
+  }
+  const int64 num_blocks =
+      std::min(max_shards, (num_helpers + 1) * kShardsPerThread);
+  auto state = std::make_shared<WorkStealingState>(
+      &fn, total, (total + num_blocks - 1) / num_blocks);
+  num_parallel_for_helpers_->fetch_add(num_helpers,
+                                       std::memory_order_relaxed);
+  for (int i = 0; i < num_helpers; ++i) {
+    Schedule([helpers = num_parallel_for_helpers_, state]() {
+      state->RunBlocks();
+      helpers->fetch_sub(1, std::memory_order_relaxed);
+    });
+  }
+  state->RunBlocks();
+  // Only the shards already claimed by other threads are left.
+  mutex_lock l(state->mu);
+  while (state->num_done.load(std::memory_order_acquire) < state->num_blocks) {
+    state->all_done.wait(l);
+  }
+}
+
 void ThreadPool::ParallelForWithWorkerId(
     int64 total, int64 cost_per_unit,
     const std::function<void(int64, int64, int)>& fn) {
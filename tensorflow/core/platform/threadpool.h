@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_THREADPOOL_H_
 #define TENSORFLOW_CORE_PLATFORM_THREADPOOL_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 
@@ -165,9 +166,31 @@ class ThreadPool {
   // Context creation. Underestimating may not fully make use of the specified
   // parallelism, and may also cause inefficiencies due to load balancing
   // issues and stragglers.
+  //
+  // If the TF_WORK_STEALING_PARALLEL_FOR environment variable is true when the
+  // pool is created, this is ParallelForWorkStealing(total, cost_per_unit,
+  // NumThreads() + 1, fn).
   void ParallelFor(int64 total, int64 cost_per_unit,
                    const std::function<void(int64, int64)>& fn);
 
+  // Like ParallelFor, but the shards are claimed dynamically: the calling
+  // thread and the threads of the pool that help it take the next unclaimed
+  // shard until none is left, so the caller runs its own shards rather than
+  // blocking while they wait in the queues of a busy pool, and a nested call
+  // from a thread of the pool cannot starve it.
+  //
+  // At most `max_parallelism` threads, including the caller, run the shards.
+  // Threads already helping other calls are not asked to help, and the shards
+  // get fewer and larger as the pool gets busier.
+  void ParallelForWorkStealing(int64 total, int64 cost_per_unit,
+                               int max_parallelism,
+                               const std::function<void(int64, int64)>& fn);
+
+  // Returns true if ParallelFor uses ParallelForWorkStealing.
+  bool UsesWorkStealingParallelFor() const {
+    return use_work_stealing_parallel_for_;
+  }
+
   // Similar to ParallelFor above, but takes the specified scheduling strategy
   // into account.
   void ParallelFor(int64 total, const SchedulingParams& scheduling_params,
@@ -234,6 +257,11 @@ class ThreadPool {
   // user_threadpool is not in the constructor.
   std::unique_ptr<Eigen::ThreadPoolTempl<EigenEnvironment>> eigen_threadpool_;
   std::unique_ptr<Eigen::ThreadPoolDevice> threadpool_device_;
+  const bool use_work_stealing_parallel_for_;
+  // Number of closures scheduled by ParallelForWorkStealing that have not
+  // finished yet.  Shared with the closures, which may run after a pool
+  // wrapping a user_threadpool is destroyed.
+  const std::shared_ptr<std::atomic<int>> num_parallel_for_helpers_;
   TF_DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
 
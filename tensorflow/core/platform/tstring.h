@@ -70,6 +70,10 @@ namespace tensorflow {
 // assignment, mutation, or non-const access to data() of tstrings will result
 // in the conversion to an owned SMALL/LARGE type.
 //
+// Copies of a LARGE tstring share its heap buffer, so slicing, concatenating
+// or gathering string tensors doesn't copy the strings.  The buffer is copied
+// on the first mutation or non-const access to data() of a copy.
+//
 // The interface for tstring largely overlaps with std::string. Except where
 // noted, expect equivalent semantics with synonymous std::string methods.
 class tstring {
@@ -188,9 +192,10 @@ class tstring {
 
   // Mutable Element Access
   // NOTE: For VIEW/OFFSET types, calling these methods will result in the
-  // conversion to a SMALL or heap allocated LARGE type.  As a result,
-  // previously obtained pointers, references, or iterators to the underlying
-  // buffer will point to the original VIEW/OFFSET and not the new allocation.
+  // conversion to a SMALL or heap allocated LARGE type, and the buffer of a
+  // LARGE type shared with copies is copied.  As a result, previously obtained
+  // pointers, references, or iterators to the underlying buffer will point to
+  // the original buffer and not the new allocation.
   char* mdata();
   char* data();  // DEPRECATED: Use mdata().
   char& operator[](size_t i);
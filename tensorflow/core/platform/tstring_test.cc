@@ -75,6 +75,21 @@ TEST(TF_TStringTest, CopyMove) {
   EXPECT_EQ(tstring::Type::SMALL, s21.type());
 }
 
+TEST(TF_TStringTest, CopyOnWrite) {
+  const tstring s23(kLongString);
+  tstring s24(s23);
+
+  EXPECT_EQ(tstring::Type::LARGE, s24.type());
+  EXPECT_EQ(s23.data(), static_cast<const tstring&>(s24).data());
+
+  s24[0] = '0';
+
+  EXPECT_NE(s23.data(), static_cast<const tstring&>(s24).data());
+  EXPECT_EQ(kLongString, s23);
+  EXPECT_EQ('0', s24[0]);
+  EXPECT_EQ(std::string(kLongString).substr(1), std::string(s24).substr(1));
+}
+
 TEST(TF_TStringTest, Assignment) {
   tstring s30("123456789012345678901234567890");
   tstring s31;
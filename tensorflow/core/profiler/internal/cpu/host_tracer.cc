@@ -86,7 +86,7 @@ Status HostTracer::Start() {
   if (!recording_) {
     return errors::Internal("Failed to start TraceMeRecorder");
   }
-  start_timestamp_ns_ = EnvTime::NowNanos();
+  start_timestamp_ns_ = TraceMeRecorder::NowNanos();
   return Status::OK();
 }
 
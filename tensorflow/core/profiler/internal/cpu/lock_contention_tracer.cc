@@ -0,0 +1,142 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex_contention.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/profiler/internal/profiler_factory.h"
+#include "tensorflow/core/profiler/internal/profiler_interface.h"
+#include "tensorflow/core/profiler/profiler_options.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// LockContentionTracer exports the mutex contention of the profiled period,
+// when TensorFlow is built with TF_MUTEX_CONTENTION_PROFILING.
+//
+// The call sites are laid out back to back on a single line of the lock
+// contention plane, by decreasing total time blocked, with one event per call
+// site lasting the total time blocked there.  The trace viewer thus shows
+// them ranked, with their stats on selection.  The max wait of a call site is
+// its maximum since the process started, as maxima can't be subtracted.
+//
+// Thread-safety: This class is go/thread-compatible.
+class LockContentionTracer : public ProfilerInterface {
+ public:
+  LockContentionTracer() = default;
+
+  Status Start() override {
+    start_stats_ = GetMutexContentionStats();
+    start_time_ns_ = EnvTime::NowNanos();
+    return Status::OK();
+  }
+
+  Status Stop() override {
+    stop_stats_ = GetMutexContentionStats();
+    return Status::OK();
+  }
+
+  Status CollectData(RunMetadata* run_metadata) override {
+    return Status::OK();  // legacy session is not supported.
+  }
+
+  Status CollectData(XSpace* space) override {
+    // The stats of the profiled period.
+    absl::flat_hash_map<const void*, const MutexContentionStats*> start;
+    for (const MutexContentionStats& stats : start_stats_) {
+      start[stats.site] = &stats;
+    }
+    std::vector<MutexContentionStats> sites;
+    for (MutexContentionStats stats : stop_stats_) {
+      auto it = start.find(stats.site);
+      if (it != start.end() &&
+          it->second->num_samples <= stats.num_samples) {
+        stats.num_samples -= it->second->num_samples;
+        stats.num_contentions -= it->second->num_contentions;
+        stats.total_wait_nanos -= it->second->total_wait_nanos;
+      }
+      if (stats.num_samples > 0) sites.push_back(std::move(stats));
+    }
+    std::sort(sites.begin(), sites.end(),
+              [](const MutexContentionStats& a, const MutexContentionStats& b) {
+                return a.total_wait_nanos > b.total_wait_nanos;
+              });
+    start_stats_.clear();
+    stop_stats_.clear();
+    if (sites.empty()) return Status::OK();
+
+    XPlaneBuilder plane(
+        FindOrAddMutablePlaneWithName(space, kLockContentionPlaneName));
+    XLineBuilder line = plane.GetOrCreateLine(0);
+    line.SetName(kLockContentionLineName);
+    line.SetTimestampNs(start_time_ns_);
+    const XStatMetadata& num_contentions_stat =
+        *plane.GetOrCreateStatMetadata("num_contentions");
+    const XStatMetadata& num_samples_stat =
+        *plane.GetOrCreateStatMetadata("num_samples");
+    const XStatMetadata& max_wait_stat =
+        *plane.GetOrCreateStatMetadata("max_wait_ns");
+    int64 offset_ns = 0;
+    for (const MutexContentionStats& stats : sites) {
+      XEventBuilder event =
+          line.AddEvent(*plane.GetOrCreateEventMetadata(stats.function));
+      event.SetOffsetNs(offset_ns);
+      event.SetDurationNs(stats.total_wait_nanos);
+      event.AddStatValue(num_contentions_stat, stats.num_contentions);
+      event.AddStatValue(num_samples_stat, stats.num_samples);
+      event.AddStatValue(max_wait_stat, stats.max_wait_nanos);
+      offset_ns += stats.total_wait_nanos;
+    }
+    return Status::OK();
+  }
+
+ private:
+  std::vector<MutexContentionStats> start_stats_;
+  std::vector<MutexContentionStats> stop_stats_;
+  uint64 start_time_ns_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(LockContentionTracer);
+};
+
+std::unique_ptr<ProfilerInterface> CreateLockContentionTracer(
+    const ProfileOptions& options) {
+  if (!MutexContentionProfilingEnabled() || options.host_tracer_level() == 0) {
+    return nullptr;
+  }
+  return absl::make_unique<LockContentionTracer>();
+}
+
+}  // namespace
+
+auto register_lock_contention_tracer_factory = [] {
+  RegisterProfilerFactory(&CreateLockContentionTracer);
+  return 0;
+}();
+
+}  // namespace profiler
+}  // namespace tensorflow
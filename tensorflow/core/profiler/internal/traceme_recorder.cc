@@ -16,6 +16,10 @@ limitations under the License.
 
 #include <stddef.h>
 
+#ifdef TF_TRACEME_RECORDER_HAS_TSC
+#include <cpuid.h>
+#endif
+
 #include <algorithm>
 #include <atomic>
 #include <new>
@@ -40,10 +44,53 @@ std::atomic<int> g_trace_level(TraceMeRecorder::kTracingDisabled);
 // might be slow (even when tracing is disabled).
 static_assert(ATOMIC_INT_LOCK_FREE == 2, "Assumed atomic<int> was lock free");
 
+std::atomic<uint64> g_tsc_base_ticks(0);
+std::atomic<uint64> g_tsc_base_nanos(0);
+std::atomic<double> g_tsc_nanos_per_tick(0);
+
 }  // namespace internal
 
 namespace {
 
+#ifdef TF_TRACEME_RECORDER_HAS_TSC
+// Returns the ns per tick of the timestamp counter of the CPU, or 0 if it
+// isn't invariant, i.e. if its rate changes with the frequency of the CPU, or
+// if it stops in deep sleep states.
+double CalibrateTsc() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+    return 0;
+  }
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  constexpr unsigned int kInvariantTsc = 1 << 8;
+  if ((edx & kInvariantTsc) == 0) return 0;
+
+  const uint64 start_ticks = __rdtsc();
+  const uint64 start_nanos = EnvTime::NowNanos();
+  Env::Default()->SleepForMicroseconds(10 * EnvTime::kMillisToMicros);
+  const uint64 end_ticks = __rdtsc();
+  const uint64 end_nanos = EnvTime::NowNanos();
+  if (end_ticks <= start_ticks || end_nanos <= start_nanos) return 0;
+  return static_cast<double>(end_nanos - start_nanos) /
+         static_cast<double>(end_ticks - start_ticks);
+}
+#endif
+
+// Resets the reference point of TraceMeRecorder::NowNanos().
+// REQUIRES: Tracing is disabled.
+void ResetClock() {
+#ifdef TF_TRACEME_RECORDER_HAS_TSC
+  static const double nanos_per_tick = CalibrateTsc();
+  if (nanos_per_tick > 0) {
+    internal::g_tsc_base_ticks.store(__rdtsc(), std::memory_order_relaxed);
+    internal::g_tsc_base_nanos.store(EnvTime::NowNanos(),
+                                     std::memory_order_relaxed);
+    internal::g_tsc_nanos_per_tick.store(nanos_per_tick,
+                                         std::memory_order_relaxed);
+  }
+#endif
+}
+
 // A single-producer single-consumer queue of Events.
 //
 // Implemented as a linked-list of blocks containing numbered slots, with start
@@ -243,6 +290,13 @@ TraceMeRecorder::Events TraceMeRecorder::Clear() {
 bool TraceMeRecorder::StartRecording(int level) {
   level = std::max(0, level);
   mutex_lock lock(mutex_);
+  if (internal::g_trace_level.load(std::memory_order_acquire) !=
+      kTracingDisabled) {
+    return false;
+  }
+  // The store to g_trace_level below publishes the clock to the threads that
+  // see that tracing is active.
+  ResetClock();
   // Change trace_level_ while holding mutex_.
   int expected = kTracingDisabled;
   bool started = internal::g_trace_level.compare_exchange_strong(
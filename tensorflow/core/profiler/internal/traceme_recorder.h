@@ -20,11 +20,17 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define TF_TRACEME_RECORDER_HAS_TSC 1
+#endif
+
 namespace tensorflow {
 namespace profiler {
 namespace internal {
@@ -34,6 +40,14 @@ namespace internal {
 // Modified by TraceMeRecorder singleton when tracing starts/stops.
 TF_EXPORT extern std::atomic<int> g_trace_level;
 
+// Reference point and rate of the CPU timestamp counter, which converts its
+// ticks into ns since the Unix epoch. The rate is 0 if the CPU doesn't have
+// an invariant timestamp counter. Set by TraceMeRecorder::Start() before it
+// sets g_trace_level.
+TF_EXPORT extern std::atomic<uint64> g_tsc_base_ticks;
+TF_EXPORT extern std::atomic<uint64> g_tsc_base_nanos;
+TF_EXPORT extern std::atomic<double> g_tsc_nanos_per_tick;
+
 }  // namespace internal
 
 // TraceMeRecorder is a singleton repository of TraceMe events.
@@ -90,6 +104,26 @@ class TraceMeRecorder {
   // Returns an activity_id for TraceMe::ActivityStart.
   static uint64 NewActivityId();
 
+  // Returns the current time in ns since the Unix epoch, for the timestamps of
+  // events. It reads the CPU timestamp counter if it is invariant, which is
+  // several times cheaper than EnvTime::NowNanos(). The first Start()
+  // calibrates the rate of the counter, and each Start() resets the reference
+  // point so that the clock doesn't drift across sessions.
+  static inline uint64 NowNanos() {
+#ifdef TF_TRACEME_RECORDER_HAS_TSC
+    const double nanos_per_tick =
+        internal::g_tsc_nanos_per_tick.load(std::memory_order_relaxed);
+    if (TF_PREDICT_TRUE(nanos_per_tick > 0)) {
+      const int64 ticks = static_cast<int64>(
+          __rdtsc() -
+          internal::g_tsc_base_ticks.load(std::memory_order_relaxed));
+      return internal::g_tsc_base_nanos.load(std::memory_order_relaxed) +
+             static_cast<int64>(ticks * nanos_per_tick);
+    }
+#endif
+    return EnvTime::NowNanos();
+  }
+
  private:
   class ThreadLocalRecorder;
 
@@ -29,7 +29,9 @@ limitations under the License.
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
 
 namespace tensorflow {
 namespace profiler {
@@ -192,6 +194,54 @@ TEST(RecorderTest, Multithreaded) {
   }
 }
 
+TEST(RecorderTest, NowNanosFollowsEnvTime) {
+  TraceMeRecorder::Start(/*level=*/1);
+  uint64 previous = TraceMeRecorder::NowNanos();
+  for (int i = 0; i < 10; ++i) {
+    Env::Default()->SleepForMicroseconds(1 * EnvTime::kMillisToMicros);
+    const uint64 now = TraceMeRecorder::NowNanos();
+    const uint64 env_now = EnvTime::NowNanos();
+    EXPECT_GE(now, previous);
+    EXPECT_NEAR(static_cast<double>(now), static_cast<double>(env_now),
+                1 * EnvTime::kMillisToNanos);
+    previous = now;
+  }
+  TraceMeRecorder::Stop();
+}
+
+void BM_NowNanos(int iters) {
+  TraceMeRecorder::Start(/*level=*/1);
+  uint64 sum = 0;
+  for (int i = 0; i < iters; ++i) {
+    sum += TraceMeRecorder::NowNanos();
+  }
+  TraceMeRecorder::Stop();
+  CHECK_NE(sum, 0);
+}
+BENCHMARK(BM_NowNanos);
+
+void BM_EnvTimeNowNanos(int iters) {
+  uint64 sum = 0;
+  for (int i = 0; i < iters; ++i) {
+    sum += EnvTime::NowNanos();
+  }
+  CHECK_NE(sum, 0);
+}
+BENCHMARK(BM_EnvTimeNowNanos);
+
+// Measures the cost of a TraceMe of level kInfo while recording at
+// `trace_level`: 0 if tracing is off, 1 if the TraceMe is filtered out, 2 and
+// 3 if it is recorded.
+void BM_TraceMe(int iters, int trace_level) {
+  if (trace_level > 0) TraceMeRecorder::Start(trace_level);
+  for (int i = 0; i < iters; ++i) {
+    TraceMe traceme("BM_TraceMe", TraceMeLevel::kInfo);
+  }
+  testing::StopTiming();
+  TraceMeRecorder::Stop();
+}
+BENCHMARK(BM_TraceMe)->Arg(0)->Arg(1)->Arg(2)->Arg(3);
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
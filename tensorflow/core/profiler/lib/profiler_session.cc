@@ -149,7 +149,8 @@ ProfilerSession::ProfilerSession(ProfileOptions options)
     return;
   }
 
-  LOG(INFO) << "Profiler session started.";
+  // Sampling profilers start a session every period, so keep this quiet.
+  VLOG(1) << "Profiler session started.";
 
 #if !defined(IS_MOBILE_PLATFORM)
   CreateProfilers(options_, &profilers_);
@@ -0,0 +1,196 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/sampling_profiler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+
+namespace tensorflow {
+namespace {
+
+mutex active_profiler_mu(LINKER_INITIALIZED);
+SamplingProfiler* active_profiler TF_GUARDED_BY(active_profiler_mu) = nullptr;
+
+SamplingProfilerOptions GetOptions(const SamplingProfilerOptions& opts) {
+  if (opts.profile_options.version()) return opts;
+  SamplingProfilerOptions options = opts;
+  options.profile_options = ProfilerSession::DefaultOptions();
+  options.profile_options.set_device_tracer_level(0);
+  return options;
+}
+
+int64 NumEvents(const profiler::XSpace& space) {
+  int64 num_events = 0;
+  for (const auto& plane : space.planes()) {
+    for (const auto& line : plane.lines()) {
+      num_events += line.events_size();
+    }
+  }
+  return num_events;
+}
+
+}  // namespace
+
+/*static*/ Status SamplingProfiler::Create(
+    const SamplingProfilerOptions& options,
+    std::unique_ptr<SamplingProfiler>* profiler) {
+  if (options.sample_duration_ms <= 0 ||
+      options.sample_duration_ms > options.sampling_period_ms) {
+    return errors::InvalidArgument(
+        "The sample duration must be positive and at most the sampling "
+        "period, got ",
+        options.sample_duration_ms, "ms and ", options.sampling_period_ms,
+        "ms");
+  }
+  mutex_lock l(active_profiler_mu);
+  if (active_profiler != nullptr) {
+    return errors::AlreadyExists("A sampling profiler is already running.");
+  }
+  profiler->reset(new SamplingProfiler(GetOptions(options)));
+  active_profiler = profiler->get();
+  return Status::OK();
+}
+
+SamplingProfiler::SamplingProfiler(const SamplingProfilerOptions& options)
+    : options_(options) {
+  thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "sampling_profiler", [this] { SampleUntilStopped(); }));
+}
+
+SamplingProfiler::~SamplingProfiler() {
+  {
+    mutex_lock l(active_profiler_mu);
+    if (active_profiler == this) active_profiler = nullptr;
+  }
+  stopped_.Notify();
+  thread_.reset();
+}
+
+void SamplingProfiler::SampleUntilStopped() {
+  const int64 sample_duration_us =
+      options_.sample_duration_ms * EnvTime::kMillisToMicros;
+  const int64 idle_duration_us =
+      options_.sampling_period_ms * EnvTime::kMillisToMicros -
+      sample_duration_us;
+  while (!WaitForNotificationWithTimeout(&stopped_, idle_duration_us)) {
+    std::unique_ptr<ProfilerSession> session =
+        ProfilerSession::Create(options_.profile_options);
+    const bool stopped =
+        WaitForNotificationWithTimeout(&stopped_, sample_duration_us);
+    profiler::XSpace space;
+    if (session->Status().ok() && session->CollectData(&space).ok()) {
+      AddSample(std::move(space));
+    } else {
+      mutex_lock l(mu_);
+      ++num_skipped_samples_;
+    }
+    if (stopped) break;
+  }
+}
+
+void SamplingProfiler::AddSample(profiler::XSpace space) {
+  const int64 num_events = NumEvents(space);
+  const profiler::XPlane* host_plane =
+      profiler::FindPlaneWithName(space, profiler::kHostThreadsPlaneName);
+  mutex_lock l(mu_);
+  ++num_samples_;
+  if (host_plane != nullptr) {
+    for (const auto& line : host_plane->lines()) {
+      for (const auto& event : line.events()) {
+        auto it = host_plane->event_metadata().find(event.metadata_id());
+        if (it == host_plane->event_metadata().end()) continue;
+        SampledEventStats& stats = event_stats_[it->second.name()];
+        ++stats.count;
+        stats.total_duration_ps += event.duration_ps();
+        stats.max_duration_ps = std::max<uint64>(stats.max_duration_ps,
+                                                 event.duration_ps());
+      }
+    }
+  }
+  samples_.push_back({std::move(space), num_events});
+  num_buffered_events_ += num_events;
+  while (num_buffered_events_ > options_.max_buffered_events) {
+    num_buffered_events_ -= samples_.front().num_events;
+    samples_.pop_front();
+  }
+}
+
+absl::flat_hash_map<string, SampledEventStats>
+SamplingProfiler::GetEventStats() {
+  mutex_lock l(mu_);
+  return event_stats_;
+}
+
+std::vector<profiler::XSpace> SamplingProfiler::GetRecentSamples() {
+  mutex_lock l(mu_);
+  std::vector<profiler::XSpace> samples;
+  samples.reserve(samples_.size());
+  for (const Sample& sample : samples_) {
+    samples.push_back(sample.space);
+  }
+  return samples;
+}
+
+string SamplingProfiler::Summary(int max_num_events) {
+  std::vector<std::pair<string, SampledEventStats>> event_stats;
+  string summary;
+  {
+    mutex_lock l(mu_);
+    event_stats.assign(event_stats_.begin(), event_stats_.end());
+    absl::StrAppendFormat(&summary,
+                          "%d samples of %dms every %dms, %d skipped while "
+                          "another profiler was active.\n",
+                          num_samples_, options_.sample_duration_ms,
+                          options_.sampling_period_ms, num_skipped_samples_);
+  }
+  const int num_events =
+      std::min<int>(std::max(max_num_events, 0), event_stats.size());
+  std::partial_sort(
+      event_stats.begin(), event_stats.begin() + num_events, event_stats.end(),
+      [](const std::pair<string, SampledEventStats>& a,
+         const std::pair<string, SampledEventStats>& b) {
+        return a.second.total_duration_ps > b.second.total_duration_ps;
+      });
+  absl::StrAppendFormat(&summary, "%12s %14s %12s %12s  %s\n", "Count",
+                        "Total (us)", "Avg (us)", "Max (us)", "Event");
+  for (int i = 0; i < num_events; ++i) {
+    const SampledEventStats& stats = event_stats[i].second;
+    absl::StrAppendFormat(
+        &summary, "%12d %14.1f %12.3f %12.3f  %s\n", stats.count,
+        stats.total_duration_ps / 1e6,
+        stats.total_duration_ps / 1e6 / stats.count,
+        stats.max_duration_ps / 1e6, event_stats[i].first);
+  }
+  return summary;
+}
+
+/*static*/ Status SamplingProfiler::SummarizeActive(int max_num_events,
+                                                    string* summary) {
+  mutex_lock l(active_profiler_mu);
+  if (active_profiler == nullptr) {
+    return errors::FailedPrecondition("No sampling profiler is running.");
+  }
+  *summary = active_profiler->Summary(max_num_events);
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,124 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_LIB_SAMPLING_PROFILER_H_
+#define TENSORFLOW_CORE_PROFILER_LIB_SAMPLING_PROFILER_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/profiler_options.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+
+struct SamplingProfilerOptions {
+  // What each sample traces. If the version is not set, only the host is
+  // traced, at the default level.
+  ProfileOptions profile_options;
+
+  // Time between the starts of two samples.
+  int64 sampling_period_ms = 1000;
+
+  // Length of each sample. Tracing costs only while sampling, so the overhead
+  // is sample_duration_ms / sampling_period_ms of that of tracing all along.
+  int64 sample_duration_ms = 10;
+
+  // Largest number of events kept from the most recent samples.
+  int64 max_buffered_events = 1000000;
+};
+
+// Stats of the events with a given name over all samples.
+struct SampledEventStats {
+  int64 count = 0;
+  uint64 total_duration_ps = 0;
+  uint64 max_duration_ps = 0;
+};
+
+// A profiler that traces continuously at a low overhead, by running a short
+// ProfilerSession once per sampling period on a background thread. It adds
+// up the stats of the host events of all samples by name, e.g. per op, and
+// keeps the most recent samples in a bounded buffer.
+//
+// Samples are skipped while another ProfilerSession is active, so explicit
+// captures keep working while it runs. At most one SamplingProfiler may run
+// in a process, and the profiler service reports its stats on Monitor().
+// Thread-safety: SamplingProfiler is thread-safe.
+class SamplingProfiler {
+ public:
+  // Creates a SamplingProfiler and starts sampling until it is destroyed.
+  static Status Create(const SamplingProfilerOptions& options,
+                       std::unique_ptr<SamplingProfiler>* profiler);
+
+  // Stops sampling, and waits for the current sample to finish.
+  ~SamplingProfiler();
+
+  // Returns the stats of the events of all samples so far, by event name.
+  absl::flat_hash_map<string, SampledEventStats> GetEventStats()
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the buffered samples, oldest first.
+  std::vector<profiler::XSpace> GetRecentSamples() TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns a table of the stats of the `max_num_events` events with the
+  // largest total duration.
+  string Summary(int max_num_events) TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets `summary` to the Summary() of the SamplingProfiler running in this
+  // process. Returns an error if none is running.
+  static Status SummarizeActive(int max_num_events, string* summary);
+
+ private:
+  struct Sample {
+    profiler::XSpace space;
+    int64 num_events;
+  };
+
+  explicit SamplingProfiler(const SamplingProfilerOptions& options);
+
+  // SamplingProfiler is neither copyable or movable.
+  SamplingProfiler(const SamplingProfiler&) = delete;
+  SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+  // Runs on thread_ until stopped_ is notified.
+  void SampleUntilStopped();
+
+  void AddSample(profiler::XSpace space) TF_LOCKS_EXCLUDED(mu_);
+
+  const SamplingProfilerOptions options_;
+  Notification stopped_;
+
+  mutex mu_;
+  absl::flat_hash_map<string, SampledEventStats> event_stats_
+      TF_GUARDED_BY(mu_);
+  std::deque<Sample> samples_ TF_GUARDED_BY(mu_);
+  int64 num_buffered_events_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_samples_ TF_GUARDED_BY(mu_) = 0;
+  // Samples skipped because another ProfilerSession was active.
+  int64 num_skipped_samples_ TF_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_PROFILER_LIB_SAMPLING_PROFILER_H_
@@ -0,0 +1,104 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/sampling_profiler.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+using profiler::TraceMe;
+
+// Traces "sampled" events until the profiler has recorded some of them.
+void TraceUntilSampled(SamplingProfiler* profiler) {
+  for (int i = 0; i < 10000; ++i) {
+    for (int j = 0; j < 100; ++j) {
+      TraceMe traceme("sampled");
+    }
+    if (profiler->GetEventStats().contains("sampled")) return;
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+}
+
+TEST(SamplingProfilerTest, AggregatesEventStats) {
+  SamplingProfilerOptions options;
+  options.sampling_period_ms = 2;
+  options.sample_duration_ms = 1;
+  std::unique_ptr<SamplingProfiler> profiler;
+  TF_ASSERT_OK(SamplingProfiler::Create(options, &profiler));
+  TraceUntilSampled(profiler.get());
+
+  const auto event_stats = profiler->GetEventStats();
+  auto it = event_stats.find("sampled");
+  ASSERT_NE(it, event_stats.end());
+  EXPECT_GT(it->second.count, 0);
+  EXPECT_GE(it->second.total_duration_ps, it->second.max_duration_ps);
+  EXPECT_FALSE(profiler->GetRecentSamples().empty());
+
+  string summary;
+  TF_ASSERT_OK(SamplingProfiler::SummarizeActive(10, &summary));
+  EXPECT_NE(summary.find("sampled"), string::npos);
+}
+
+TEST(SamplingProfilerTest, BoundsBufferedEvents) {
+  SamplingProfilerOptions options;
+  options.sampling_period_ms = 2;
+  options.sample_duration_ms = 1;
+  // Less than the events traced in one go by TraceUntilSampled().
+  options.max_buffered_events = 50;
+  std::unique_ptr<SamplingProfiler> profiler;
+  TF_ASSERT_OK(SamplingProfiler::Create(options, &profiler));
+  TraceUntilSampled(profiler.get());
+
+  EXPECT_TRUE(profiler->GetEventStats().contains("sampled"));
+  int64 num_buffered_events = 0;
+  for (const profiler::XSpace& space : profiler->GetRecentSamples()) {
+    for (const profiler::XPlane& plane : space.planes()) {
+      for (const profiler::XLine& line : plane.lines()) {
+        num_buffered_events += line.events_size();
+      }
+    }
+  }
+  EXPECT_LE(num_buffered_events, options.max_buffered_events);
+}
+
+TEST(SamplingProfilerTest, AllowsOneProfilerPerProcess) {
+  std::unique_ptr<SamplingProfiler> profiler;
+  TF_ASSERT_OK(SamplingProfiler::Create(SamplingProfilerOptions(), &profiler));
+  std::unique_ptr<SamplingProfiler> other_profiler;
+  EXPECT_FALSE(
+      SamplingProfiler::Create(SamplingProfilerOptions(), &other_profiler)
+          .ok());
+
+  profiler.reset();
+  string summary;
+  EXPECT_FALSE(SamplingProfiler::SummarizeActive(10, &summary).ok());
+  TF_EXPECT_OK(
+      SamplingProfiler::Create(SamplingProfilerOptions(), &other_profiler));
+}
+
+TEST(SamplingProfilerTest, RejectsInvalidDurations) {
+  SamplingProfilerOptions options;
+  options.sampling_period_ms = 10;
+  options.sample_duration_ms = 20;
+  std::unique_ptr<SamplingProfiler> profiler;
+  EXPECT_FALSE(SamplingProfiler::Create(options, &profiler).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
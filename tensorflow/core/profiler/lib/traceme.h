@@ -20,7 +20,6 @@ limitations under the License.
 #include <utility>
 
 #include "absl/strings/string_view.h"
-#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/platform.h"
@@ -92,7 +91,7 @@ class TraceMe {
 #if !defined(IS_MOBILE_PLATFORM)
     if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
       new (&no_init_.name) std::string(name);
-      start_time_ = EnvTime::NowNanos();
+      start_time_ = TraceMeRecorder::NowNanos();
     }
 #endif
   }
@@ -135,7 +134,7 @@ class TraceMe {
 #if !defined(IS_MOBILE_PLATFORM)
     if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
       new (&no_init_.name) std::string(name_generator());
-      start_time_ = EnvTime::NowNanos();
+      start_time_ = TraceMeRecorder::NowNanos();
     }
 #endif
   }
@@ -158,7 +157,7 @@ class TraceMe {
     if (TF_PREDICT_FALSE(start_time_ != kUntracedActivity)) {
       if (TF_PREDICT_TRUE(TraceMeRecorder::Active())) {
         TraceMeRecorder::Record({kCompleteActivity, std::move(no_init_.name),
-                                 start_time_, EnvTime::NowNanos()});
+                                 start_time_, TraceMeRecorder::NowNanos()});
       }
       no_init_.name.~string();
       start_time_ = kUntracedActivity;
@@ -196,7 +195,7 @@ class TraceMe {
     if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
       uint64 activity_id = TraceMeRecorder::NewActivityId();
       TraceMeRecorder::Record({activity_id, std::string(name),
-                               /*start_time=*/EnvTime::NowNanos(),
+                               /*start_time=*/TraceMeRecorder::NowNanos(),
                                /*end_time=*/0});
       return activity_id;
     }
@@ -212,7 +211,7 @@ class TraceMe {
       if (TF_PREDICT_TRUE(TraceMeRecorder::Active())) {
         TraceMeRecorder::Record({activity_id, /*name=*/std::string(),
                                  /*start_time=*/0,
-                                 /*end_time=*/EnvTime::NowNanos()});
+                                 /*end_time=*/TraceMeRecorder::NowNanos()});
       }
     }
 #endif
@@ -223,7 +222,7 @@ class TraceMe {
   static void InstantActivity(NameGeneratorT name_generator, int level = 1) {
 #if !defined(IS_MOBILE_PLATFORM)
     if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
-      uint64 now = EnvTime::NowNanos();
+      uint64 now = TraceMeRecorder::NowNanos();
       TraceMeRecorder::Record({kCompleteActivity, name_generator(),
                                /*start_time=*/now, /*end_time=*/now});
     }
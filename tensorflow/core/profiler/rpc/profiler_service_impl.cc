@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/profiler/internal/profiler_interface.h"
 #include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/lib/sampling_profiler.h"
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
 #include "tensorflow/core/profiler/profiler_service.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
@@ -38,6 +39,9 @@ namespace {
 
 const absl::string_view kXPlanePb = "xplane.pb";
 
+// Number of events with the largest total duration reported by Monitor().
+constexpr int kMaxMonitoredEvents = 50;
+
 Status CollectDataToResponse(const ProfileRequest& req,
                              ProfilerSession* profiler,
                              ProfileResponse* response) {
@@ -53,7 +57,17 @@ class ProfilerServiceImpl : public grpc::ProfilerService::Service {
  public:
   ::grpc::Status Monitor(::grpc::ServerContext* ctx, const MonitorRequest* req,
                          MonitorResponse* response) override {
-    return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "unimplemented.");
+    // Reports the event stats of the sampling profiler running in this
+    // process, if any.
+    string summary;
+    Status status = SamplingProfiler::SummarizeActive(kMaxMonitoredEvents,
+                                                      &summary);
+    if (!status.ok()) {
+      return ::grpc::Status(::grpc::StatusCode::FAILED_PRECONDITION,
+                            status.error_message());
+    }
+    response->set_data(summary);
+    return ::grpc::Status::OK;
   }
 
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
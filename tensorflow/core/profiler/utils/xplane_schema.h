@@ -36,6 +36,8 @@ ABSL_CONST_INIT extern const absl::string_view kCuptiDriverApiPlaneName;
 ABSL_CONST_INIT extern const absl::string_view kMetadataPlaneName;
 // Name of XPlane that contains kpi related metrics.
 ABSL_CONST_INIT extern const absl::string_view kTFStreamzPlaneName;
+// Name of XPlane that contains the mutex contention per call site.
+ABSL_CONST_INIT extern const absl::string_view kLockContentionPlaneName;
 
 // Names of XLines that contain ML-level events.
 ABSL_CONST_INIT extern const absl::string_view kStepLineName;
@@ -44,6 +46,7 @@ ABSL_CONST_INIT extern const absl::string_view kTensorFlowOpLineName;
 ABSL_CONST_INIT extern const absl::string_view kXlaModuleLineName;
 ABSL_CONST_INIT extern const absl::string_view kXlaOpLineName;
 ABSL_CONST_INIT extern const absl::string_view kKernelLaunchLineName;
+ABSL_CONST_INIT extern const absl::string_view kLockContentionLineName;
 
 // Interesting event types (i.e., TraceMe names).
 enum HostEventType {
@@ -273,6 +273,23 @@ class Session {
         "RunCallable with threadpool is not supported for this session.");
   }
 
+  /// \brief Binds caller-owned `output_buffers` to the outputs of the
+  /// subgraph named by `handle`.
+  ///
+  /// Later calls to `RunCallable()` copy the i-th fetched value into
+  /// `output_buffers[i]`, and return a tensor sharing that buffer in
+  /// `fetch_tensors`, so that the outputs land in the same memory on every
+  /// call. Each fetched value must have the dtype and shape of its buffer,
+  /// otherwise the call fails. The outputs returned by a previous call are
+  /// overwritten, and calls with bound outputs must not run concurrently.
+  /// An empty `output_buffers` unbinds the outputs.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status BindCallableOutputs(
+      CallableHandle handle, const std::vector<Tensor>& output_buffers) {
+    return errors::Unimplemented(
+        "BindCallableOutputs is not supported for this session.");
+  }
+
   /// \brief Releases resources associated with the given `handle` in this
   /// session.
   /// NOTE: This API is still experimental and may change.
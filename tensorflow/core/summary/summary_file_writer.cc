@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -27,6 +29,12 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// Events are written to the file by a background thread, so that the ops
+// writing summaries don't wait on the file system.  WriteEvent() only queues
+// the event and wakes the thread once max_queue events are pending or
+// flush_millis have elapsed.  The thread writes all the pending events at
+// once, then flushes the file.  Errors are returned by the next call to
+// WriteEvent() or Flush().
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
   SummaryFileWriter(int max_queue, int flush_millis, Env* env)
@@ -34,6 +42,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
         is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
+        max_pending_(2 * std::max(max_queue, 0) + 2),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -52,19 +61,37 @@ class SummaryFileWriter : public SummaryWriterInterface {
         "Could not initialize events writer.");
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    writer_thread_.reset(env_->StartThread(ThreadOptions(),
+                                           "summary_file_writer",
+                                           [this]() { WriterLoop(); }));
     return Status::OK();
   }
 
+  // Waits until the events written so far are written and flushed.
   Status Flush() override {
     mutex_lock ml(mu_);
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    const int64 num_events = num_queued_;
+    if (num_flushed_ < num_events) {
+      flush_requested_ = true;
+      work_cv_.notify_one();
+      while (num_flushed_ < num_events) {
+        flushed_cv_.wait(ml);
+      }
+    }
+    return ConsumeStatus();
   }
 
   ~SummaryFileWriter() override {
-    (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      shutting_down_ = true;
+    }
+    work_cv_.notify_one();
+    // Joins the writer thread, which writes the pending events first.
+    writer_thread_.reset();
   }
 
   Status WriteTensor(int64 global_step, Tensor t, const string& tag,
@@ -140,12 +167,19 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    // Bounds the memory of the pending events when the writer thread can't
+    // keep up: the callers wait for it rather than drop summaries.
+    while (queue_.size() >= max_pending_) {
+      flushed_cv_.wait(ml);
+    }
     queue_.emplace_back(std::move(event));
+    ++num_queued_;
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+      flush_requested_ = true;
+      work_cv_.notify_one();
     }
-    return Status::OK();
+    return ConsumeStatus();
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -155,26 +189,75 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // Returns the first error of the writer thread since the last call.
+  Status ConsumeStatus() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status s = status_;
+    status_ = Status::OK();
+    return s;
+  }
+
+  // Writes and flushes `events`.  Only called by the writer thread.
+  Status WriteAndFlush(const std::vector<std::unique_ptr<Event>>& events) {
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
+  void WriterLoop() {
+    std::vector<std::unique_ptr<Event>> events;
+    while (true) {
+      int64 num_events;
+      bool shutting_down;
+      {
+        mutex_lock ml(mu_);
+        while (!flush_requested_ && !shutting_down_) {
+          work_cv_.wait(ml);
+        }
+        events.swap(queue_);
+        num_events = num_queued_;
+        shutting_down = shutting_down_;
+        flush_requested_ = false;
+      }
+      // The callers blocked on a full queue can proceed while this batch is
+      // written.
+      flushed_cv_.notify_all();
+      const Status s = WriteAndFlush(events);
+      events.clear();
+      {
+        mutex_lock ml(mu_);
+        status_.Update(s);
+        num_flushed_ = num_events;
+        last_flush_ = env_->NowMicros();
+      }
+      flushed_cv_.notify_all();
+      if (shutting_down) return;
+    }
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
+  // Number of pending events above which WriteEvent() blocks.
+  const size_t max_pending_;
+  uint64 last_flush_ TF_GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
+  condition_variable work_cv_;
+  condition_variable flushed_cv_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
-  // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  bool flush_requested_ TF_GUARDED_BY(mu_) = false;
+  bool shutting_down_ TF_GUARDED_BY(mu_) = false;
+  // Number of events ever queued, and number of them written and flushed.
+  int64 num_queued_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_flushed_ TF_GUARDED_BY(mu_) = 0;
+  Status status_ TF_GUARDED_BY(mu_);
+  // A pointer to allow deferred construction.  Only used by the writer thread
+  // once initialized.
+  std::unique_ptr<EventsWriter> events_writer_;
+  std::unique_ptr<Thread> writer_thread_;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
@@ -0,0 +1,158 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/benchmark_comparison.h"
+
+#include <cmath>
+#include <map>
+
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace {
+
+struct RunStats {
+  int runs = 0;
+  double mean = 0.0;
+  double variance = 0.0;  // Unbiased sample variance.
+};
+
+// Returns the times per iteration, in nanoseconds, of the runs of each
+// benchmark of `entries`, by name.
+std::map<string, std::vector<double>> TimesByName(
+    const BenchmarkEntries& entries) {
+  std::map<string, std::vector<double>> times;
+  for (const BenchmarkEntry& entry : entries.entry()) {
+    if (entry.iters() <= 0) continue;
+    times[entry.name()].push_back(entry.wall_time() * 1e9 / entry.iters());
+  }
+  return times;
+}
+
+RunStats ComputeRunStats(const std::vector<double>& times) {
+  RunStats stats;
+  stats.runs = times.size();
+  if (times.empty()) return stats;
+  for (double time : times) stats.mean += time;
+  stats.mean /= times.size();
+  if (times.size() < 2) return stats;
+  for (double time : times) {
+    stats.variance += (time - stats.mean) * (time - stats.mean);
+  }
+  stats.variance /= times.size() - 1;
+  return stats;
+}
+
+}  // namespace
+
+Status ReadBenchmarkEntries(Env* env, const string& file_pattern,
+                            BenchmarkEntries* entries) {
+  std::vector<string> files;
+  TF_RETURN_IF_ERROR(env->GetMatchingPaths(file_pattern, &files));
+  if (files.empty()) {
+    return errors::NotFound("No benchmark results match ", file_pattern);
+  }
+  for (const string& file : files) {
+    BenchmarkEntries file_entries;
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(
+        ReadBinaryProto(env, file, &file_entries), "reading ", file);
+    entries->MergeFrom(file_entries);
+  }
+  return Status::OK();
+}
+
+std::vector<BenchmarkComparison> CompareBenchmarks(
+    const BenchmarkEntries& baseline, const BenchmarkEntries& candidate,
+    const BenchmarkComparisonOptions& options) {
+  const auto baseline_times = TimesByName(baseline);
+  const auto candidate_times = TimesByName(candidate);
+  std::map<string, BenchmarkComparison> comparisons;
+  for (const auto& it : baseline_times) {
+    const RunStats stats = ComputeRunStats(it.second);
+    BenchmarkComparison& comparison = comparisons[it.first];
+    comparison.baseline_runs = stats.runs;
+    comparison.baseline_mean_nanos = stats.mean;
+    comparison.baseline_stddev_nanos = std::sqrt(stats.variance);
+  }
+  for (const auto& it : candidate_times) {
+    const RunStats stats = ComputeRunStats(it.second);
+    BenchmarkComparison& comparison = comparisons[it.first];
+    comparison.candidate_runs = stats.runs;
+    comparison.candidate_mean_nanos = stats.mean;
+    comparison.candidate_stddev_nanos = std::sqrt(stats.variance);
+  }
+
+  std::vector<BenchmarkComparison> result;
+  result.reserve(comparisons.size());
+  for (auto& it : comparisons) {
+    BenchmarkComparison& comparison = it.second;
+    comparison.name = it.first;
+    if (comparison.baseline_runs > 0 && comparison.candidate_runs > 0 &&
+        comparison.baseline_mean_nanos > 0) {
+      const double change =
+          comparison.candidate_mean_nanos - comparison.baseline_mean_nanos;
+      comparison.relative_change = change / comparison.baseline_mean_nanos;
+      bool significant =
+          std::abs(comparison.relative_change) >= options.min_relative_change;
+      if (comparison.baseline_runs > 1 && comparison.candidate_runs > 1) {
+        const double standard_error = std::sqrt(
+            comparison.baseline_stddev_nanos *
+                comparison.baseline_stddev_nanos / comparison.baseline_runs +
+            comparison.candidate_stddev_nanos *
+                comparison.candidate_stddev_nanos / comparison.candidate_runs);
+        if (standard_error > 0) {
+          comparison.t_statistic = change / standard_error;
+          significant = significant && std::abs(comparison.t_statistic) >=
+                                           options.min_t_statistic;
+        }
+      }
+      comparison.regressed = significant && change > 0;
+      comparison.improved = significant && change < 0;
+    }
+    result.push_back(std::move(comparison));
+  }
+  return result;
+}
+
+string FormatBenchmarkComparisons(
+    const std::vector<BenchmarkComparison>& comparisons) {
+  string table = absl::StrFormat("%-60s %14s %14s %9s %8s  %s\n", "Benchmark",
+                                 "Baseline(ns)", "Candidate(ns)", "Change",
+                                 "t", "Verdict");
+  for (const BenchmarkComparison& comparison : comparisons) {
+    if (comparison.baseline_runs == 0 || comparison.candidate_runs == 0) {
+      absl::StrAppendFormat(
+          &table, "%-60s %14.0f %14.0f %9s %8s  %s\n", comparison.name,
+          comparison.baseline_mean_nanos, comparison.candidate_mean_nanos, "",
+          "", comparison.baseline_runs == 0 ? "new" : "missing");
+      continue;
+    }
+    const char* verdict = "";
+    if (comparison.regressed) {
+      verdict = "REGRESSED";
+    } else if (comparison.improved) {
+      verdict = "improved";
+    }
+    absl::StrAppendFormat(&table, "%-60s %14.0f %14.0f %+8.1f%% %8.2f  %s\n",
+                          comparison.name, comparison.baseline_mean_nanos,
+                          comparison.candidate_mean_nanos,
+                          comparison.relative_change * 100,
+                          comparison.t_statistic, verdict);
+  }
+  return table;
+}
+
+}  // namespace tensorflow
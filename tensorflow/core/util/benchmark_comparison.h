@@ -0,0 +1,100 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_BENCHMARK_COMPARISON_H_
+#define TENSORFLOW_CORE_UTIL_BENCHMARK_COMPARISON_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/test_log.pb.h"
+
+namespace tensorflow {
+
+// Compares the benchmark results written by TestReporter for two builds, e.g.
+// the results of a benchmark target at a baseline commit and at a candidate
+// commit:
+//
+//   TEST_REPORT_FILE_PREFIX=/tmp/base/run0_ bazel-bin/.../foo_test \
+//       --benchmarks=all
+//   ...
+//   BenchmarkEntries baseline, candidate;
+//   TF_CHECK_OK(ReadBenchmarkEntries(env, "/tmp/base/run*", &baseline));
+//   TF_CHECK_OK(ReadBenchmarkEntries(env, "/tmp/cand/run*", &candidate));
+//   std::vector<BenchmarkComparison> comparisons =
+//       CompareBenchmarks(baseline, candidate, BenchmarkComparisonOptions());
+//   LOG(INFO) << FormatBenchmarkComparisons(comparisons);
+//
+// A benchmark that ran several times, e.g. with one file prefix per run, is
+// compared with Welch's t-test on the times per iteration of its runs.
+
+struct BenchmarkComparisonOptions {
+  // The smallest relative change of the mean time per iteration that is
+  // reported as a regression or an improvement.
+  double min_relative_change = 0.05;
+
+  // The smallest absolute value of Welch's t statistic for which a change is
+  // reported as a regression or an improvement, when both builds ran the
+  // benchmark at least twice. 2.0 roughly corresponds to a 95% confidence for
+  // large numbers of runs; increase it for few runs.
+  double min_t_statistic = 2.0;
+};
+
+struct BenchmarkComparison {
+  string name;
+
+  // The number of runs of the benchmark and the mean and standard deviation
+  // of their times per iteration, in nanoseconds. A benchmark missing from
+  // one of the builds has no runs there.
+  int baseline_runs = 0;
+  double baseline_mean_nanos = 0.0;
+  double baseline_stddev_nanos = 0.0;
+  int candidate_runs = 0;
+  double candidate_mean_nanos = 0.0;
+  double candidate_stddev_nanos = 0.0;
+
+  // (candidate_mean_nanos - baseline_mean_nanos) / baseline_mean_nanos.
+  double relative_change = 0.0;
+
+  // Welch's t statistic of the change, or 0 if a build has fewer than 2 runs.
+  double t_statistic = 0.0;
+
+  // Whether the candidate is significantly slower or faster, according to the
+  // options of the comparison.
+  bool regressed = false;
+  bool improved = false;
+};
+
+// Appends the entries of the files written by TestReporter that match
+// `file_pattern` (see Env::GetMatchingPaths) to `entries`.
+Status ReadBenchmarkEntries(Env* env, const string& file_pattern,
+                            BenchmarkEntries* entries);
+
+// Compares the benchmarks of `baseline` and `candidate` by name. Returns one
+// comparison per benchmark of either build, sorted by name.
+std::vector<BenchmarkComparison> CompareBenchmarks(
+    const BenchmarkEntries& baseline, const BenchmarkEntries& candidate,
+    const BenchmarkComparisonOptions& options);
+
+// Returns a human-readable table of `comparisons`.
+string FormatBenchmarkComparisons(
+    const std::vector<BenchmarkComparison>& comparisons);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_BENCHMARK_COMPARISON_H_
@@ -0,0 +1,130 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/benchmark_comparison.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/reporter.h"
+
+namespace tensorflow {
+namespace {
+
+// Adds one run of `name` that took `nanos` per iteration to `entries`.
+void AddRun(const string& name, double nanos, BenchmarkEntries* entries) {
+  BenchmarkEntry* entry = entries->add_entry();
+  entry->set_name(name);
+  entry->set_iters(1000);
+  entry->set_wall_time(nanos * 1000 * 1e-9);
+}
+
+TEST(BenchmarkComparisonTest, DetectsRegressionsAndImprovements) {
+  BenchmarkEntries baseline;
+  BenchmarkEntries candidate;
+  for (double noise : {-1.0, 0.0, 1.0}) {
+    AddRun("BM_Slower", 100 + noise, &baseline);
+    AddRun("BM_Slower", 120 + noise, &candidate);
+    AddRun("BM_Faster", 100 + noise, &baseline);
+    AddRun("BM_Faster", 80 + noise, &candidate);
+    AddRun("BM_Same", 100 + noise, &baseline);
+    AddRun("BM_Same", 101 + noise, &candidate);
+  }
+
+  const std::vector<BenchmarkComparison> comparisons =
+      CompareBenchmarks(baseline, candidate, BenchmarkComparisonOptions());
+  ASSERT_EQ(3, comparisons.size());
+
+  EXPECT_EQ("BM_Faster", comparisons[0].name);
+  EXPECT_EQ(3, comparisons[0].baseline_runs);
+  EXPECT_NEAR(100, comparisons[0].baseline_mean_nanos, 1e-6);
+  EXPECT_NEAR(1, comparisons[0].baseline_stddev_nanos, 1e-6);
+  EXPECT_NEAR(-0.2, comparisons[0].relative_change, 1e-6);
+  EXPECT_LT(comparisons[0].t_statistic, -2);
+  EXPECT_TRUE(comparisons[0].improved);
+  EXPECT_FALSE(comparisons[0].regressed);
+
+  EXPECT_EQ("BM_Same", comparisons[1].name);
+  EXPECT_FALSE(comparisons[1].improved);
+  EXPECT_FALSE(comparisons[1].regressed);
+
+  EXPECT_EQ("BM_Slower", comparisons[2].name);
+  EXPECT_NEAR(0.2, comparisons[2].relative_change, 1e-6);
+  EXPECT_GT(comparisons[2].t_statistic, 2);
+  EXPECT_TRUE(comparisons[2].regressed);
+
+  const string table = FormatBenchmarkComparisons(comparisons);
+  EXPECT_TRUE(absl::StrContains(table, "REGRESSED"));
+  EXPECT_TRUE(absl::StrContains(table, "improved"));
+}
+
+TEST(BenchmarkComparisonTest, IgnoresChangesWithinNoise) {
+  BenchmarkEntries baseline;
+  BenchmarkEntries candidate;
+  for (double noise : {-30.0, 0.0, 30.0}) {
+    AddRun("BM_Noisy", 100 + noise, &baseline);
+    AddRun("BM_Noisy", 110 + noise, &candidate);
+  }
+
+  const std::vector<BenchmarkComparison> comparisons =
+      CompareBenchmarks(baseline, candidate, BenchmarkComparisonOptions());
+  ASSERT_EQ(1, comparisons.size());
+  EXPECT_NEAR(0.1, comparisons[0].relative_change, 1e-6);
+  EXPECT_FALSE(comparisons[0].regressed);
+}
+
+TEST(BenchmarkComparisonTest, ComparesSingleRunsByRelativeChange) {
+  BenchmarkEntries baseline;
+  BenchmarkEntries candidate;
+  AddRun("BM_Foo", 100, &baseline);
+  AddRun("BM_Foo", 110, &candidate);
+  AddRun("BM_Removed", 100, &baseline);
+  AddRun("BM_Added", 100, &candidate);
+
+  const std::vector<BenchmarkComparison> comparisons =
+      CompareBenchmarks(baseline, candidate, BenchmarkComparisonOptions());
+  ASSERT_EQ(3, comparisons.size());
+  EXPECT_EQ("BM_Added", comparisons[0].name);
+  EXPECT_EQ(0, comparisons[0].baseline_runs);
+  EXPECT_FALSE(comparisons[0].regressed);
+  EXPECT_EQ("BM_Foo", comparisons[1].name);
+  EXPECT_EQ(0, comparisons[1].t_statistic);
+  EXPECT_TRUE(comparisons[1].regressed);
+  EXPECT_EQ("BM_Removed", comparisons[2].name);
+  EXPECT_EQ(0, comparisons[2].candidate_runs);
+}
+
+TEST(BenchmarkComparisonTest, ReadsTestReporterFiles) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "comparison_run_");
+  for (const string& name : {"BM_Foo/1", "BM_Bar"}) {
+    TestReporter reporter(prefix, name);
+    TF_ASSERT_OK(reporter.Initialize());
+    TF_ASSERT_OK(reporter.Benchmark(10, 0.0, 1.0, 0.0));
+    TF_ASSERT_OK(reporter.Close());
+  }
+
+  BenchmarkEntries entries;
+  TF_ASSERT_OK(ReadBenchmarkEntries(Env::Default(), prefix + "*", &entries));
+  ASSERT_EQ(2, entries.entry_size());
+  EXPECT_EQ(10, entries.entry(0).iters());
+
+  EXPECT_FALSE(ReadBenchmarkEntries(Env::Default(), prefix + "missing*",
+                                    &entries)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <cstring>
 #include <vector>
 
 #include "absl/base/casts.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/presized_cuckoo_map.h"
@@ -109,6 +111,91 @@ uint8 PeekTag(protobuf::io::CodedInputStream* stream) {
   return *static_cast<const uint8*>(ptr);
 }
 
+// Returns a pointer to the next `size` bytes of `stream` and skips them, or
+// nullptr if fewer bytes are left.
+const uint8* ReadPackedBytes(protobuf::io::CodedInputStream* stream,
+                             uint32 size) {
+  static const uint8 kEmpty = 0;
+  if (size == 0) return &kEmpty;
+  const void* ptr;
+  int available;
+  if (!stream->GetDirectBufferPointer(&ptr, &available) ||
+      available < static_cast<int64>(size) || !stream->Skip(size)) {
+    return nullptr;
+  }
+  return static_cast<const uint8*>(ptr);
+}
+
+constexpr uint64 kVarintContinuationBits = 0x8080808080808080ULL;
+
+// Returns the number of varints packed in the `size` bytes at `ptr`, or -1 if
+// the last one is truncated. The bytes that end a varint are counted eight at
+// a time.
+inline int64 CountPackedVarints(const uint8* ptr, size_t size) {
+  if (size > 0 && (ptr[size - 1] & 0x80)) return -1;
+  int64 count = 0;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64 word;
+    memcpy(&word, ptr + i, sizeof(word));
+    // One bit per varint-ending byte, summed across the bytes of the word.
+    const uint64 ends = (~word & kVarintContinuationBits) >> 7;
+    count += (ends * 0x0101010101010101ULL) >> 56;
+  }
+  for (; i < size; ++i) {
+    count += (ptr[i] & 0x80) == 0;
+  }
+  return count;
+}
+
+// Decodes the varints packed in the `size` bytes at `ptr`, storing the first
+// `capacity` of them in `out`. Returns false if a varint is malformed. Runs of
+// eight one-byte varints, i.e. of small values, are decoded from a single
+// 64-bit load.
+inline bool DecodePackedVarints(const uint8* ptr, size_t size, int64* out,
+                                size_t capacity) {
+  const uint8* const end = ptr + size;
+  size_t n = 0;
+  while (ptr < end) {
+    if (end - ptr >= 8 && n + 8 <= capacity) {
+      uint64 word;
+      memcpy(&word, ptr, sizeof(word));
+      if ((word & kVarintContinuationBits) == 0) {
+        for (int k = 0; k < 8; ++k) {
+          out[n + k] = ptr[k];
+        }
+        ptr += 8;
+        n += 8;
+        continue;
+      }
+    }
+    uint64 value = 0;
+    int shift = 0;
+    uint8 byte;
+    do {
+      if (ptr == end || shift > 63) return false;
+      byte = *ptr++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    if (n < capacity) out[n] = static_cast<int64>(value);
+    ++n;
+  }
+  return true;
+}
+
+// Copies the `size` bytes of packed little-endian floats at `ptr` to `out`.
+inline void DecodePackedFloats(const uint8* ptr, size_t size, float* out) {
+  if (port::kLittleEndian) {
+    memcpy(out, ptr, size);
+  } else {
+    for (size_t i = 0; i < size / sizeof(float); ++i) {
+      out[i] = absl::bit_cast<float>(core::DecodeFixed32(
+          reinterpret_cast<const char*>(ptr) + i * sizeof(float)));
+    }
+  }
+}
+
 constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
@@ -295,15 +382,20 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
+        const uint8* packed = ReadPackedBytes(&stream, packed_length);
+        if (packed == nullptr) return false;
+        const int64 num_elements = CountPackedVarints(packed, packed_length);
+        if (num_elements < 0) return false;
+
+        // As for floats, a LimitedArraySlice may hold fewer elements than
+        // requested in resize.
+        const size_t initial_size = int64_list->size();
+        int64_list->resize(initial_size + num_elements);
+        if (!DecodePackedVarints(packed, packed_length,
+                                 int64_list->data() + initial_size,
+                                 int64_list->size() - initial_size)) {
+          return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -1900,18 +1992,14 @@ inline int ParseFloatFeature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        uint32 buffer32;
-        if (!stream->ReadLittleEndian32(&buffer32)) {
-          return -1;
-        }
-        if (out != nullptr) {
-          *out++ = absl::bit_cast<float>(buffer32);
-        }
-        num_elements++;
+      const uint8* packed = ReadPackedBytes(stream, packed_length);
+      if (packed == nullptr || packed_length % sizeof(float) != 0) {
+        return -1;
+      }
+      if (out != nullptr) {
+        DecodePackedFloats(packed, packed_length, out);
       }
-      stream->PopLimit(packed_limit);
+      num_elements = packed_length / sizeof(float);
     } else if (peek_tag == kFixed32Tag(1)) {
       while (!stream->ExpectAtEnd()) {
         uint32 buffer32;
@@ -1951,18 +2039,19 @@ inline int ParseInt64Feature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        protobuf_uint64 n;  // There is no API for int64
-        if (!stream->ReadVarint64(&n)) {
-          return -1;
-        }
-        if (out != nullptr) {
-          *out++ = n;
-        }
-        num_elements++;
+      const uint8* packed = ReadPackedBytes(stream, packed_length);
+      if (packed == nullptr) {
+        return -1;
+      }
+      const int64 count = CountPackedVarints(packed, packed_length);
+      if (count < 0) {
+        return -1;
+      }
+      if (out != nullptr &&
+          !DecodePackedVarints(packed, packed_length, out, count)) {
+        return -1;
       }
-      stream->PopLimit(packed_limit);
+      num_elements = count;
     } else if (peek_tag == kVarintTag(1)) {
       while (!stream->ExpectAtEnd()) {
         protobuf_uint64 n;  // There is no API for int64
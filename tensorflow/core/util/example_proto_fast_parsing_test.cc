@@ -170,6 +170,17 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedMixedWidthInt64) {
+  Example example;
+  auto* values = (*example.mutable_features()->mutable_feature())["age"]
+                     .mutable_int64_list();
+  // Runs of small values interleaved with multi-byte and negative ones.
+  for (int i = 0; i < 100; ++i) {
+    values->add_value(i % 10 == 9 ? -i * 100000 : i % 7);
+  }
+  TestCorrectness(Serialize(example));
+}
+
 TEST(FastParse, EmptyFeatures) {
   Example example;
   example.mutable_features();
@@ -423,6 +434,48 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+// Parses batches of Examples with `num_values` packed int64 (`is_float` = 0)
+// or float (`is_float` = 1) values in each of a wanted and an unwanted feature.
+static void BM_FastParseExample(int iters, int num_values, int is_float) {
+  testing::StopTiming();
+  Example example;
+  auto& features = *example.mutable_features()->mutable_feature();
+  for (const char* key : {"wanted", "unwanted"}) {
+    Feature& feature = features[key];
+    for (int i = 0; i < num_values; ++i) {
+      if (is_float) {
+        feature.mutable_float_list()->add_value(i * 0.5f);
+      } else {
+        // Mostly small values, with some that take several bytes.
+        feature.mutable_int64_list()->add_value(i % 16 == 0 ? i * 1000
+                                                            : i % 100);
+      }
+    }
+  }
+  constexpr int kBatchSize = 128;
+  std::vector<tstring> serialized(kBatchSize, Serialize(example));
+
+  FastParseExampleConfig config;
+  config.sparse.push_back({"wanted", is_float ? DT_FLOAT : DT_INT64});
+  testing::BytesProcessed(static_cast<int64>(iters) * kBatchSize *
+                          serialized[0].size());
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    Result result;
+    TF_CHECK_OK(FastParseExample(config, serialized,
+                                 gtl::ArraySlice<tstring>(), nullptr,
+                                 &result));
+  }
+}
+
+BENCHMARK(BM_FastParseExample)
+    ->ArgPair(1, 0)
+    ->ArgPair(64, 0)
+    ->ArgPair(1024, 0)
+    ->ArgPair(1, 1)
+    ->ArgPair(64, 1)
+    ->ArgPair(1024, 1);
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
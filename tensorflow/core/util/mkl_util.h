@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_MKL_UTIL_H_
 #ifdef INTEL_MKL
 
+#include <atomic>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
@@ -1982,6 +1984,12 @@ class LRUCache {
     cache_.emplace(std::make_pair(key, std::move(entry)));
   }
 
+  size_t Size() const { return lru_list_.size(); }
+
+  // Removes the least recently accessed entry, if any.  Returns whether an
+  // entry was removed.
+  bool DeleteLeastRecentlyUsed() { return Delete(); }
+
   void Clear() {
     if (lru_list_.empty()) return;
 
@@ -2039,6 +2047,60 @@ class LRUCache {
   std::list<string> lru_list_;
 };
 
+// Statistics of the MKL primitive caches of all the threads and factories
+// of the process.
+struct MklPrimitiveCacheStats {
+  int64 hits = 0;
+  int64 misses = 0;
+  int64 evictions = 0;
+  // The number of primitives currently cached.
+  int64 num_primitives = 0;
+};
+
+namespace mkl_primitive_cache {
+
+struct Counters {
+  std::atomic<int64> hits{0};
+  std::atomic<int64> misses{0};
+  std::atomic<int64> evictions{0};
+  std::atomic<int64> num_primitives{0};
+};
+
+inline Counters& GetCounters() {
+  static Counters* counters = new Counters;
+  return *counters;
+}
+
+// The largest number of primitives cached by all the threads together, from
+// TF_MKL_PRIMITIVE_CACHE_CAPACITY.  Each thread caches its own primitives,
+// since they hold the memory handles of the executions that use them, so
+// with many inference threads the per-thread bound alone lets the caches
+// grow with the number of threads.
+inline int64 GetProcessCapacity() {
+  static const int64 capacity = [] {
+    int64 capacity;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_MKL_PRIMITIVE_CACHE_CAPACITY",
+                                    std::numeric_limits<int64>::max(),
+                                    &capacity));
+    return capacity;
+  }();
+  return capacity;
+}
+
+}  // namespace mkl_primitive_cache
+
+// Returns the statistics of the MKL primitive caches of the process.
+inline MklPrimitiveCacheStats GetMklPrimitiveCacheStats() {
+  const auto& counters = mkl_primitive_cache::GetCounters();
+  MklPrimitiveCacheStats stats;
+  stats.hits = counters.hits.load(std::memory_order_relaxed);
+  stats.misses = counters.misses.load(std::memory_order_relaxed);
+  stats.evictions = counters.evictions.load(std::memory_order_relaxed);
+  stats.num_primitives =
+      counters.num_primitives.load(std::memory_order_relaxed);
+  return stats;
+}
+
 template <typename T>
 class MklPrimitiveFactory {
  public:
@@ -2048,12 +2110,28 @@ class MklPrimitiveFactory {
 
   MklPrimitive* GetOp(const string& key) {
     auto& lru_cache = MklPrimitiveFactory<T>::GetLRUCache();
-    return lru_cache.GetOp(key);
+    MklPrimitive* op = lru_cache.GetOp(key);
+    auto& counters = mkl_primitive_cache::GetCounters();
+    (op != nullptr ? counters.hits : counters.misses)
+        .fetch_add(1, std::memory_order_relaxed);
+    return op;
   }
 
   void SetOp(const string& key, MklPrimitive* op) {
     auto& lru_cache = MklPrimitiveFactory<T>::GetLRUCache();
+    auto& counters = mkl_primitive_cache::GetCounters();
+    // Evict the least recently used primitives of this thread while either
+    // its cache or the caches of all the threads are full.
+    while (lru_cache.Size() >= kCapacity ||
+           (counters.num_primitives.load(std::memory_order_relaxed) >=
+                mkl_primitive_cache::GetProcessCapacity() &&
+            lru_cache.Size() > 0)) {
+      if (!lru_cache.DeleteLeastRecentlyUsed()) break;
+      counters.num_primitives.fetch_sub(1, std::memory_order_relaxed);
+      counters.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
     lru_cache.SetOp(key, op);
+    counters.num_primitives.fetch_add(1, std::memory_order_relaxed);
   }
 
   /// Function to decide whether HW has AVX512 or AVX2
@@ -2073,9 +2151,21 @@ class MklPrimitiveFactory {
   }
 
  private:
+  static constexpr int kCapacity = 1024;  // cache capacity per thread
+
+  // The cache of the thread, which accounts for its primitives in the
+  // process-wide count when the thread exits.
+  class ThreadCache : public LRUCache<MklPrimitive> {
+   public:
+    ThreadCache() : LRUCache<MklPrimitive>(kCapacity) {}
+    ~ThreadCache() {
+      mkl_primitive_cache::GetCounters().num_primitives.fetch_sub(
+          Size(), std::memory_order_relaxed);
+    }
+  };
+
   static inline LRUCache<MklPrimitive>& GetLRUCache() {
-    static const int kCapacity = 1024;  // cache capacity
-    static thread_local LRUCache<MklPrimitive> lru_cache_(kCapacity);
+    static thread_local ThreadCache lru_cache_;
     return lru_cache_;
   }
 };
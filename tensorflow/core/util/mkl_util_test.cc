@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/mkl_util.h"
 
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/mkl_types.h"
 
@@ -121,6 +122,34 @@ TEST(MklUtilTest, LRUCacheTest) {
   }
 }
 
+class TestPrimitiveFactory : public MklPrimitiveFactory<float> {};
+
+TEST(MklUtilTest, PrimitiveCacheStats) {
+  const MklPrimitiveCacheStats before = GetMklPrimitiveCacheStats();
+  TestPrimitiveFactory factory;
+  EXPECT_EQ(nullptr, factory.GetOp("primitive_cache_stats"));
+  factory.SetOp("primitive_cache_stats", new MklPrimitive());
+  EXPECT_NE(nullptr, factory.GetOp("primitive_cache_stats"));
+
+  const MklPrimitiveCacheStats after = GetMklPrimitiveCacheStats();
+  EXPECT_EQ(after.hits, before.hits + 1);
+  EXPECT_EQ(after.misses, before.misses + 1);
+  EXPECT_EQ(after.num_primitives, before.num_primitives + 1);
+}
+
+TEST(MklUtilTest, PrimitiveCacheStatsOfExitedThreads) {
+  const MklPrimitiveCacheStats before = GetMklPrimitiveCacheStats();
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread(ThreadOptions(), "cache_primitive", [] {
+        TestPrimitiveFactory factory;
+        factory.SetOp("primitive_cache_thread", new MklPrimitive());
+      }));
+  // Joins the thread, which releases its cache.
+  thread.reset();
+  EXPECT_EQ(GetMklPrimitiveCacheStats().num_primitives,
+            before.num_primitives);
+}
+
 }  // namespace
 }  // namespace tensorflow
 
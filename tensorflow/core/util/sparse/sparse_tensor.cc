@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
@@ -36,6 +41,11 @@ Status GetDimsFromIx(const Tensor& ix, int* result) {
   return Status();
 }
 
+// Entries sorted by each shard of the radix sort.
+constexpr int64 kMinEntriesPerSortShard = 1 << 16;
+constexpr int kRadixBits = 8;
+constexpr int kRadix = 1 << kRadixBits;
+
 }  // namespace
 
 /* static */ Status SparseTensor::Create(Tensor ix, Tensor vals,
@@ -308,5 +318,121 @@ Status SparseTensor::IndicesValid() const {
   }
 }
 
+/* static */ void SparseTensor::ParallelFor(
+    thread::ThreadPool* pool, int64 total, int64 cost_per_unit,
+    const std::function<void(int64, int64)>& fn) {
+  if (pool == nullptr) {
+    fn(0, total);
+  } else {
+    pool->ParallelFor(total, cost_per_unit, fn);
+  }
+}
+
+bool SparseTensor::RadixSortIndices(const VarDimArray& order,
+                                    thread::ThreadPool* pool,
+                                    std::vector<int64>* reorder) const {
+  const int64 n = num_entries();
+  if (dims_ == 0) return false;
+
+  // Strides of the dimensions in `order`, the last one varying fastest.
+  std::vector<int64> strides(dims_);
+  int64 num_keys = 1;
+  for (int d = dims_ - 1; d >= 0; --d) {
+    const int64 dim_size = shape_[order[d]];
+    if (dim_size <= 0) return false;
+    strides[order[d]] = num_keys;
+    if (num_keys > std::numeric_limits<int64>::max() / dim_size) return false;
+    num_keys *= dim_size;
+  }
+
+  const auto ix_t = ix_.matrix<int64>();
+  std::vector<int64> keys(n);
+  std::atomic<bool> in_bounds(true);
+  ParallelFor(pool, n, 2 * dims_, [&](int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      int64 key = 0;
+      for (int d = 0; d < dims_; ++d) {
+        const int64 index = ix_t(i, d);
+        if (index < 0 || index >= shape_[d]) {
+          in_bounds.store(false, std::memory_order_relaxed);
+          return;
+        }
+        key += index * strides[d];
+      }
+      keys[i] = key;
+    }
+  });
+  if (!in_bounds.load()) return false;
+
+  // Sorts (key, position) pairs by kRadixBits bits of the keys per pass,
+  // least significant first.  Each shard counts the digits of a fixed range
+  // of entries, and scatters them after the entries of the same digit in
+  // earlier shards, which keeps the sort stable.
+  reorder->resize(n);
+  std::iota(reorder->begin(), reorder->end(), 0);
+  std::vector<int64> next_keys(n);
+  std::vector<int64> next_reorder(n);
+  const int64 num_shards =
+      pool == nullptr ? 1
+                      : std::max<int64>(
+                            1, std::min<int64>(pool->NumThreads(),
+                                               n / kMinEntriesPerSortShard));
+  const int64 shard_size = (n + num_shards - 1) / num_shards;
+  std::vector<std::array<int64, kRadix>> offsets(num_shards);
+  auto for_each_shard = [&](const std::function<void(int64, int64, int64)>&
+                                fn) {
+    auto run_shard = [&](int64 shard) {
+      fn(shard, shard * shard_size, std::min(n, (shard + 1) * shard_size));
+    };
+    if (num_shards == 1) {
+      run_shard(0);
+    } else {
+      pool->ParallelFor(num_shards, kMinEntriesPerSortShard * 8,
+                        [&](int64 start, int64 limit) {
+                          for (int64 s = start; s < limit; ++s) run_shard(s);
+                        });
+    }
+  };
+
+  int num_bits = 0;
+  while (num_bits < 63 && (int64{1} << num_bits) < num_keys) ++num_bits;
+  for (int shift = 0; shift < num_bits; shift += kRadixBits) {
+    for_each_shard([&](int64 shard, int64 start, int64 limit) {
+      auto& counts = offsets[shard];
+      counts.fill(0);
+      for (int64 i = start; i < limit; ++i) {
+        ++counts[(keys[i] >> shift) & (kRadix - 1)];
+      }
+    });
+    // Skips the pass if all the keys have the same digit.
+    bool one_digit = false;
+    for (int digit = 0; digit < kRadix; ++digit) {
+      int64 count = 0;
+      for (int64 s = 0; s < num_shards; ++s) count += offsets[s][digit];
+      if (count == n) one_digit = true;
+    }
+    if (one_digit) continue;
+    int64 offset = 0;
+    for (int digit = 0; digit < kRadix; ++digit) {
+      for (int64 s = 0; s < num_shards; ++s) {
+        const int64 count = offsets[s][digit];
+        offsets[s][digit] = offset;
+        offset += count;
+      }
+    }
+    for_each_shard([&](int64 shard, int64 start, int64 limit) {
+      auto& positions = offsets[shard];
+      for (int64 i = start; i < limit; ++i) {
+        const int64 position = positions[(keys[i] >> shift) & (kRadix - 1)]++;
+        next_keys[position] = keys[i];
+        next_reorder[position] = (*reorder)[i];
+      }
+    });
+    keys.swap(next_keys);
+    reorder->swap(next_reorder);
+  }
+  return true;
+}
+
 }  // namespace sparse
 }  // namespace tensorflow
@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_SPARSE_SPARSE_TENSOR_H_
 #define TENSORFLOW_CORE_UTIL_SPARSE_SPARSE_TENSOR_H_
 
+#include <functional>
 #include <limits>
 #include <numeric>
+#include <utility>
 #include <vector>
 
 #include "absl/base/macros.h"
@@ -36,6 +38,11 @@ limitations under the License.
 #include "tensorflow/core/util/sparse/group_iterator.h"
 
 namespace tensorflow {
+
+namespace thread {
+class ThreadPool;
+}  // namespace thread
+
 namespace sparse {
 
 class SparseTensor {
@@ -119,8 +126,10 @@ class SparseTensor {
   VarDimArray order() const { return order_; }
 
   // Resorts the indices and values according to the dimensions in order.
+  // When all indices are in bounds, sorts them with a radix sort of their
+  // linearized values, parallelized over `pool` if not null.
   template <typename T>
-  void Reorder(const VarDimArray& order);
+  void Reorder(const VarDimArray& order, thread::ThreadPool* pool = nullptr);
 
   // Returns a group iterable that can be used for clumping indices
   // and values according to the group indices of interest.
@@ -210,6 +219,19 @@ class SparseTensor {
   // REQUIRES: `shape_.size() == 2`.
   bool IndicesValidMatrix32BitFastPath() const;
 
+  // Sets `reorder` to the positions of the entries sorted by `order`, with a
+  // stable LSD radix sort of their indices linearized in that order, and
+  // returns true.  Returns false if an index is out of bounds or the
+  // linearized indices don't fit in an `int64`.
+  bool RadixSortIndices(const VarDimArray& order, thread::ThreadPool* pool,
+                        std::vector<int64>* reorder) const;
+
+  // Calls `fn` on contiguous ranges of [0, total), in parallel on `pool` if
+  // not null.
+  static void ParallelFor(thread::ThreadPool* pool, int64 total,
+                          int64 cost_per_unit,
+                          const std::function<void(int64, int64)>& fn);
+
   template <bool standard_order>
   Status IndicesValidHelper() const;
 
@@ -269,14 +291,39 @@ class SparseTensor {
 // an in-place algorithm.  It requires O(N log N) time and O(N)
 // temporary space.
 template <typename T>
-inline void SparseTensor::Reorder(const VarDimArray& order) {
+inline void SparseTensor::Reorder(const VarDimArray& order,
+                                  thread::ThreadPool* pool) {
   DCHECK_EQ(DataTypeToEnum<T>::v(), dtype())
       << "Reorder requested with the wrong datatype";
   DCHECK_EQ(order.size(), dims_) << "Order length must be SparseTensor rank";
   auto ix_t = ix_.matrix<int64>();
   auto vals_t = vals_.vec<T>();
 
-  std::vector<int64> reorder(num_entries());
+  std::vector<int64> reorder;
+  if (RadixSortIndices(order, pool, &reorder)) {
+    // Gathers the entries in sorted order, then copies them back.
+    const int64 n = num_entries();
+    std::vector<int64> sorted_ix(n * dims_);
+    std::vector<T> sorted_vals(n);
+    ParallelFor(pool, n, 2 * (dims_ + 1), [&](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        std::copy_n(&ix_t(reorder[i], 0), dims_, &sorted_ix[i * dims_]);
+        sorted_vals[i] = std::move(vals_t(reorder[i]));
+      }
+    });
+    ParallelFor(pool, n, dims_ + 1, [&](int64 start, int64 limit) {
+      std::copy(sorted_ix.begin() + start * dims_,
+                sorted_ix.begin() + limit * dims_, &ix_t(start, 0));
+      for (int64 i = start; i < limit; ++i) {
+        vals_t(i) = std::move(sorted_vals[i]);
+      }
+    });
+    order_ = ShapeArray(order.begin(), order.end());
+    return;
+  }
+
+  // Some indices are out of bounds, so sort them by comparing dimensions.
+  reorder.resize(num_entries());
   std::iota(reorder.begin(), reorder.end(), 0);
 
   // Sort to get order of indices
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
@@ -270,6 +271,44 @@ TEST(SparseTensorTest, SortingWorksCorrectly) {
   }
 }
 
+TEST(SparseTensorTest, ParallelSortMatchesComparatorSort) {
+  // Enough entries for several shards, with many duplicate indices.
+  const int N = 300000;
+  const int NDIM = 3;
+  thread::ThreadPool pool(Env::Default(), "sparse_sort", 4);
+
+  Tensor ix(DT_INT64, TensorShape({N, NDIM}));
+  Tensor vals(DT_INT64, TensorShape({N}));
+  TensorShape shape({7, 300, 200});
+  SparseTensor st;
+  TF_ASSERT_OK(SparseTensor::Create(ix, vals, shape, &st));
+
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  auto ix_t = ix.matrix<int64>();
+  auto vals_t = vals.vec<int64>();
+  for (const std::vector<int64>& order :
+       std::vector<std::vector<int64>>{{0, 1, 2}, {2, 0, 1}, {1, 2, 0}}) {
+    for (int n = 0; n < N; ++n) {
+      for (int d = 0; d < NDIM; ++d) {
+        ix_t(n, d) = rnd.Uniform(shape.dim_size(d));
+      }
+      vals_t(n) = n;
+    }
+    std::vector<int64> expected(N);
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(), expected.end(),
+                     DimComparator(ix_t, order, shape.dim_sizes()));
+
+    st.Reorder<int64>(order, &pool);
+    EXPECT_EQ(st.order(), order);
+    // Entries with the same indices keep their order.
+    for (int n = 0; n < N; ++n) {
+      ASSERT_EQ(vals_t(n), expected[n]);
+    }
+  }
+}
+
 TEST(SparseTensorTest, ValidateIndicesFindsInvalid) {
   int N = 2;
   const int NDIM = 3;
@@ -19,8 +19,10 @@ limitations under the License.
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <set>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -34,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -54,9 +57,6 @@ const int kTensorBundleMinProducer = 0;
 const int kTensorBundleMinConsumer = 0;
 const int kTensorBundleVersion = 1;
 
-// Size of our input buffer for streaming reads
-static const int kBufferSize = 1024 * 1024;
-
 // Key to the special BundleHeaderProto entry.  Do not change this, as clients
 // can make the assumption that the header is always the first entry in the
 // bundle.
@@ -403,6 +403,111 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64* size) {
   return status;
 }
 
+// Appends the bytes of "val" to "out", whose first "*size" bytes are already
+// written, and records their location and checksum in "entry".  Then pads the
+// data to "alignment".
+Status WriteEntryData(const Tensor& val, int alignment, FileOutputBuffer* out,
+                      int64* size, BundleEntryProto* entry) {
+  entry->set_offset(*size);
+
+  // Updates the data file.
+  size_t data_bytes_written = 0;
+  uint32 crc32c = 0;
+  out->clear_crc32c();
+  if (val.dtype() == DT_STRING) {
+    TF_RETURN_IF_ERROR(
+        WriteStringTensor(val, out, &data_bytes_written, &crc32c));
+  } else if (val.dtype() == DT_VARIANT) {
+    TF_RETURN_IF_ERROR(
+        WriteVariantTensor(val, out, &data_bytes_written, &crc32c));
+  } else {
+    TF_RETURN_IF_ERROR(WriteTensor(val, out, &data_bytes_written));
+    crc32c = out->crc32c();
+  }
+
+  entry->set_size(data_bytes_written);
+  entry->set_crc32c(crc32c::Mask(crc32c));
+  *size += data_bytes_written;
+  return PadAlignment(out, alignment, size);
+}
+
+// Appends the row indices of a delta entry right after its rows, in the same
+// fashion as WriteEntryData().
+Status WriteDeltaRowIndices(gtl::ArraySlice<int64> row_indices, int alignment,
+                            FileOutputBuffer* out, int64* size,
+                            BundleDeltaProto* delta) {
+  delta->set_num_rows(row_indices.size());
+  delta->set_indices_offset(*size);
+  const size_t indices_bytes = row_indices.size() * sizeof(int64);
+  out->clear_crc32c();
+  if (indices_bytes > 0) {
+    TF_RETURN_IF_ERROR(out->Append(StringPiece(
+        reinterpret_cast<const char*>(row_indices.data()), indices_bytes)));
+  }
+  delta->set_indices_crc32c(crc32c::Mask(out->crc32c()));
+  *size += indices_bytes;
+  return PadAlignment(out, alignment, size);
+}
+
+// Returns the number of rows per slice that a parallel writer splits "val"
+// into, or 0 if "val" is written as a whole.  Only splits dtypes whose slices
+// BundleReader::GetSliceValue() can reassemble.
+int64 RowsPerSlice(const Tensor& val, int64 max_slice_bytes) {
+  if (max_slice_bytes <= 0 || val.dims() < 1 || val.dim_size(0) < 2 ||
+      val.TotalBytes() <= max_slice_bytes) {
+    return 0;
+  }
+  switch (val.dtype()) {
+    case DT_FLOAT:
+    case DT_DOUBLE:
+    case DT_INT32:
+    case DT_UINT8:
+    case DT_INT16:
+    case DT_INT8:
+    case DT_COMPLEX64:
+    case DT_COMPLEX128:
+    case DT_INT64:
+    case DT_BOOL:
+    case DT_QINT32:
+    case DT_QUINT8:
+    case DT_QINT8:
+    case DT_BFLOAT16:
+      break;
+    default:
+      return 0;
+  }
+  const int64 row_bytes = val.TotalBytes() / val.dim_size(0);
+  return std::max<int64>(1, max_slice_bytes / std::max<int64>(1, row_bytes));
+}
+
+// A TensorBuffer aliasing the bytes of a tensor in a memory-mapped data file.
+// Keeps the file mapped for as long as the buffer lives.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("MappedTensorBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  ~MappedTensorBuffer() override {}
+
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedTensorBuffer);
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -410,7 +515,8 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
       options_(options),
       prefix_(prefix),
       out_(nullptr),
-      size_(0) {
+      size_(0),
+      num_data_files_(1) {
   status_ = env_->HasAtomicMove(prefix_, &use_temp_file_);
   if (!status_.ok()) return;
 
@@ -426,6 +532,10 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
   if (!status_.ok() && !errors::IsAlreadyExists(status_)) {
     return;
   }
+  status_ = Status::OK();
+
+  // The data files of a parallel writer are created by Finish().
+  if (options_.num_shards > 1) return;
 
   std::unique_ptr<WritableFile> wrapper;
   status_ = env_->NewWritableFile(data_path_, &wrapper);
@@ -439,6 +549,29 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   if (!status_.ok()) return status_;
   CHECK_NE(key, kHeaderEntryKey);
+  const int64 rows_per_slice =
+      options_.num_shards > 1 ? RowsPerSlice(val, options_.max_slice_bytes)
+                              : 0;
+  if (rows_per_slice == 0) return AddEntry(key, val);
+
+  // Splits "val" so that its slices can go to different data files.
+  if (entries_.find(string(key)) != entries_.end()) {
+    status_ = errors::InvalidArgument("Adding duplicate key: ", key);
+    return status_;
+  }
+  const int64 num_rows = val.dim_size(0);
+  for (int64 start = 0; start < num_rows; start += rows_per_slice) {
+    const int64 length = std::min(rows_per_slice, num_rows - start);
+    TensorSlice slice_spec(val.dims());
+    slice_spec.set_start(0, start);
+    slice_spec.set_length(0, length);
+    TF_RETURN_IF_ERROR(AddSlice(key, val.shape(), slice_spec,
+                                val.Slice(start, start + length)));
+  }
+  return status_;
+}
+
+Status BundleWriter::AddEntry(StringPiece key, const Tensor& val) {
   const string key_string(key);
   if (entries_.find(key_string) != entries_.end()) {
     status_ = errors::InvalidArgument("Adding duplicate key: ", key);
@@ -448,29 +581,25 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
-  entry->set_shard_id(0);
-  entry->set_offset(size_);
-
-  // Updates the data file.
-  size_t data_bytes_written = 0;
-  uint32 crc32c = 0;
-  out_->clear_crc32c();
-  if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32c();
-  }
+  status_ = WriteData(val, {}, entry);
+  return status_;
+}
 
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
+Status BundleWriter::WriteData(const Tensor& val,
+                               gtl::ArraySlice<int64> row_indices,
+                               BundleEntryProto* entry) {
+  if (options_.num_shards > 1) {
+    pending_.push_back(
+        {entry, val,
+         std::vector<int64>(row_indices.begin(), row_indices.end())});
+    return Status::OK();
   }
-  return status_;
+  entry->set_shard_id(0);
+  TF_RETURN_IF_ERROR(WriteEntryData(val, options_.data_alignment, out_.get(),
+                                    &size_, entry));
+  if (!entry->has_delta()) return Status::OK();
+  return WriteDeltaRowIndices(row_indices, options_.data_alignment, out_.get(),
+                              &size_, entry->mutable_delta());
 }
 
 Status BundleWriter::AddSlice(StringPiece full_tensor_key,
@@ -506,14 +635,144 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
   TensorSliceProto* slice_proto = full_entry->add_slices();
   slice_spec.AsProto(slice_proto);
 
-  // The slice itself is handled by a regular Add(), which includes adding its
-  // own metadata entry, and writing out the slice's values.
+  // The slice itself is handled by a regular AddEntry(), which includes adding
+  // its own metadata entry, and writing out the slice's values.
   const string slice_name =
       checkpoint::EncodeTensorNameSlice(full_tensor_key_string, slice_spec);
-  status_ = Add(slice_name, slice_tensor);
+  status_ = AddEntry(slice_name, slice_tensor);
   return status_;
 }
 
+Status BundleWriter::AddRows(StringPiece key,
+                             const TensorShape& full_tensor_shape,
+                             gtl::ArraySlice<int64> row_indices,
+                             const Tensor& rows) {
+  if (!status_.ok()) return status_;
+  CHECK_NE(key, kHeaderEntryKey);
+  if (options_.base_prefix.empty()) {
+    status_ = errors::FailedPrecondition(
+        "Adding rows of ", key, " to a bundle without a base bundle");
+    return status_;
+  }
+  const string key_string(key);
+  if (entries_.find(key_string) != entries_.end()) {
+    status_ = errors::InvalidArgument("Adding duplicate key: ", key);
+    return status_;
+  }
+
+  // "rows" must be [len(row_indices)] + full_tensor_shape[1:].
+  bool valid_shape = full_tensor_shape.dims() >= 1 &&
+                     rows.dims() == full_tensor_shape.dims() &&
+                     rows.dim_size(0) == static_cast<int64>(row_indices.size());
+  for (int d = 1; valid_shape && d < rows.dims(); ++d) {
+    valid_shape = rows.dim_size(d) == full_tensor_shape.dim_size(d);
+  }
+  if (!valid_shape) {
+    status_ = errors::InvalidArgument(
+        "Rows of ", key, " have shape ", rows.shape().DebugString(), " but ",
+        row_indices.size(), " rows of a tensor of shape ",
+        full_tensor_shape.DebugString(), " are being added");
+    return status_;
+  }
+  for (const int64 row : row_indices) {
+    if (row < 0 || row >= full_tensor_shape.dim_size(0)) {
+      status_ = errors::InvalidArgument("Row index ", row, " of ", key,
+                                        " is out of range [0, ",
+                                        full_tensor_shape.dim_size(0), ")");
+      return status_;
+    }
+  }
+
+  BundleEntryProto* entry = &entries_[key_string];
+  entry->set_dtype(rows.dtype());
+  full_tensor_shape.AsProto(entry->mutable_shape());
+  entry->mutable_delta();
+  status_ = WriteData(rows, row_indices, entry);
+  return status_;
+}
+
+Status BundleWriter::WriteShards() {
+  // Never creates a data file without tensors, since MergeBundles() only
+  // accounts for the data files that entries point to.
+  const int num_shards = std::max<int>(
+      1, std::min<int64>(options_.num_shards, pending_.size()));
+
+  // Assigns the largest tensors first, each to the data file with the fewest
+  // bytes so far.  Counts one extra byte per tensor so that empty tensors are
+  // spread as well.
+  std::vector<PendingWrite*> by_size;
+  by_size.reserve(pending_.size());
+  for (PendingWrite& write : pending_) by_size.push_back(&write);
+  std::stable_sort(by_size.begin(), by_size.end(),
+                   [](const PendingWrite* a, const PendingWrite* b) {
+                     return a->val.TotalBytes() > b->val.TotalBytes();
+                   });
+  std::vector<std::vector<PendingWrite*>> shard_writes(num_shards);
+  std::vector<int64> shard_bytes(num_shards, 0);
+  for (PendingWrite* write : by_size) {
+    const int shard = std::min_element(shard_bytes.begin(), shard_bytes.end()) -
+                      shard_bytes.begin();
+    shard_writes[shard].push_back(write);
+    shard_bytes[shard] += write->val.TotalBytes() + 1;
+  }
+
+  std::vector<string> paths(num_shards);
+  std::vector<Status> statuses(num_shards);
+  {
+    thread::ThreadPool pool(env_, "bundle_writer", num_shards);
+    for (int shard = 0; shard < num_shards; ++shard) {
+      paths[shard] = DataFilename(prefix_, shard, num_shards);
+      if (use_temp_file_) {
+        paths[shard] =
+            strings::StrCat(paths[shard], ".tempstate", random::New64());
+      }
+      pool.Schedule([this, shard, &paths, &shard_writes, &statuses]() {
+        statuses[shard] =
+            WriteShard(paths[shard], shard, shard_writes[shard]);
+      });
+    }
+    // The pool's destructor waits for all shards to be written.
+  }
+  pending_.clear();
+
+  Status status;
+  for (const Status& s : statuses) status.Update(s);
+  for (int shard = 0; shard < num_shards; ++shard) {
+    if (!status.ok()) {
+      env_->DeleteFile(paths[shard]).IgnoreError();
+    } else if (use_temp_file_) {
+      status = env_->RenameFile(paths[shard],
+                                DataFilename(prefix_, shard, num_shards));
+    }
+  }
+  num_data_files_ = num_shards;
+  return status;
+}
+
+Status BundleWriter::WriteShard(const string& path, int32 shard_id,
+                                const std::vector<PendingWrite*>& writes) {
+  VLOG(1) << "Writing " << writes.size() << " tensors to file " << path;
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(path, &file));
+  FileOutputBuffer out(file.release(), 8 << 20 /* 8MB write buffer */);
+  int64 size = 0;
+  Status status;
+  for (PendingWrite* write : writes) {
+    BundleEntryProto* entry = write->entry;
+    entry->set_shard_id(shard_id);
+    status = WriteEntryData(write->val, options_.data_alignment, &out, &size,
+                            entry);
+    if (status.ok() && entry->has_delta()) {
+      status = WriteDeltaRowIndices(write->row_indices,
+                                    options_.data_alignment, &out, &size,
+                                    entry->mutable_delta());
+    }
+    if (!status.ok()) break;
+  }
+  status.Update(out.Close());
+  return status;
+}
+
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
@@ -528,6 +787,8 @@ Status BundleWriter::Finish() {
     } else {
       Env::Default()->DeleteFile(data_path_).IgnoreError();
     }
+  } else if (options_.num_shards > 1 && status_.ok()) {
+    status_ = WriteShards();
   }
   if (!status_.ok()) return status_;
   // Build key -> BundleEntryProto table.
@@ -542,12 +803,13 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(num_data_files_);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
     version->set_min_consumer(kTensorBundleMinConsumer);
+    header.set_base_prefix(options_.base_prefix);
 
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
@@ -582,6 +844,9 @@ struct MergeState {
   bool seen_first_bundle = false;
   BundleHeaderProto_Endianness endianness;
   VersionDef version;
+  // Derived from the first bundle merged as well.  All bundles of a sharded
+  // delta checkpoint share the same base.
+  string base_prefix;
 
   // Tensor key -> BundleEntryProto.
   std::map<string, BundleEntryProto> entries;
@@ -623,6 +888,7 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
       merge_state->seen_first_bundle = true;
       merge_state->endianness = header.endianness();
       merge_state->version = header.version();
+      merge_state->base_prefix = header.base_prefix();
     } else {
       // Validates "endianness".
       if (merge_state->endianness != header.endianness()) {
@@ -638,6 +904,12 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
             "Merging bundles with different format versions: merged ",
             merge_version, " vs. curr ", curr_version);
       }
+      // Validates "base_prefix".
+      if (merge_state->base_prefix != header.base_prefix()) {
+        return errors::InvalidArgument(
+            "Merging bundles with different base bundles: merged ",
+            merge_state->base_prefix, " vs. curr ", header.base_prefix());
+      }
     }
     num_shards = header.num_shards();
     iter->Next();
@@ -721,6 +993,7 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
     header.set_num_shards(merge.num_shards);
     header.set_endianness(merge.endianness);
     *header.mutable_version() = merge.version;
+    header.set_base_prefix(merge.base_prefix);
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
     // All others.
     for (const auto& p : merge.entries) {
@@ -739,11 +1012,60 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
   return status;
 }
 
+Status CompactBundles(Env* env, StringPiece prefix,
+                      StringPiece compacted_prefix) {
+  if (prefix == compacted_prefix) {
+    return errors::InvalidArgument("Compacting bundle ", prefix,
+                                   " onto itself");
+  }
+  BundleReader reader(env, prefix);
+  TF_RETURN_IF_ERROR(reader.status());
+  std::vector<string> keys;
+  TF_RETURN_IF_ERROR(reader.ListTensorKeys(&keys));
+
+  BundleWriter writer(env, compacted_prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  for (const string& key : keys) {
+    DataType dtype;
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(reader.LookupDtypeAndShape(key, &dtype, &shape));
+    std::vector<TensorSlice> slices;
+    TF_RETURN_IF_ERROR(reader.LookupTensorSlices(key, &slices));
+    if (slices.empty()) {
+      Tensor val(dtype, shape);
+      TF_RETURN_IF_ERROR(reader.Lookup(key, &val));
+      TF_RETURN_IF_ERROR(writer.Add(key, val));
+      continue;
+    }
+    for (const TensorSlice& slice : slices) {
+      TensorShape slice_shape;
+      TF_RETURN_IF_ERROR(slice.SliceTensorShape(shape, &slice_shape));
+      Tensor val(dtype, slice_shape);
+      TF_RETURN_IF_ERROR(reader.LookupSlice(key, slice, &val));
+      TF_RETURN_IF_ERROR(writer.AddSlice(key, shape, slice, val));
+    }
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Compacted bundle " << prefix << " to:" << compacted_prefix;
+  return Status::OK();
+}
+
 // Interface for reading a tensor bundle.
 
-BundleReader::BundleReader(Env* env, StringPiece prefix)
+// Longest chain of delta bundles a reader follows, which also guards against
+// cycles among the "base_prefix" pointers.  Every bundle in the chain keeps its
+// files open, so chains are meant to be compacted long before this.
+static const int kMaxDeltaChainLength = 64;
+
+BundleReader::BundleReader(Env* env, StringPiece prefix,
+                           const Options& options)
+    : BundleReader(env, prefix, options, /*delta_depth=*/0) {}
+
+BundleReader::BundleReader(Env* env, StringPiece prefix, const Options& options,
+                           int delta_depth)
     : env_(env),
       prefix_(prefix),
+      options_(options),
       metadata_(nullptr),
       table_(nullptr),
       index_cache_(nullptr),
@@ -751,6 +1073,12 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
       need_to_swap_bytes_(false) {
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
+  if (options_.read_buffer_size <= 0) {
+    status_ = errors::InvalidArgument("Non-positive read buffer size ",
+                                      options_.read_buffer_size,
+                                      " for bundle ", prefix_);
+    return;
+  }
   status_ = env_->GetFileSize(filename, &file_size);
   if (!status_.ok()) return;
 
@@ -794,6 +1122,21 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
   }
   status_ = CheckVersions(header.version(), kTensorBundleVersion,
                           kTensorBundleMinProducer, "Checkpoint", "checkpoint");
+  if (!status_.ok() || header.base_prefix().empty()) return;
+
+  // Opens the chain of base bundles.
+  if (delta_depth >= kMaxDeltaChainLength) {
+    status_ = errors::DataLoss("Chain of delta bundles ending at ", prefix_,
+                               " is longer than ", kMaxDeltaChainLength,
+                               "; base bundles form a cycle?");
+    return;
+  }
+  string base_prefix = header.base_prefix();
+  if (!io::IsAbsolutePath(base_prefix)) {
+    base_prefix = io::JoinPath(io::Dirname(prefix_), base_prefix);
+  }
+  base_.reset(new BundleReader(env_, base_prefix, options_, delta_depth + 1));
+  status_ = base_->status();
 }
 
 BundleReader::~BundleReader() {
@@ -840,6 +1183,23 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return Status::OK();
 }
 
+Status BundleReader::GetDataFile(int32 shard_id, io::InputBuffer** file) {
+  // Open the data file if it has not been opened.
+  io::InputBuffer* buffered_file = data_[shard_id];
+  if (buffered_file == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &file));
+    buffered_file =
+        new io::InputBuffer(file.release(), options_.read_buffer_size);
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    data_[shard_id] = buffered_file;
+  }
+  CHECK(buffered_file != nullptr);
+  *file = buffered_file;
+  return Status::OK();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
@@ -869,17 +1229,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file = new io::InputBuffer(file.release(), kBufferSize);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
-  }
-  CHECK(buffered_file != nullptr);
+  io::InputBuffer* buffered_file = nullptr;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
 
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
@@ -887,7 +1238,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
-    if (entry.size() > kBufferSize) {
+    if (entry.size() > static_cast<uint64>(options_.read_buffer_size)) {
       StringPiece sp;
       TF_RETURN_IF_ERROR(buffered_file->file()->Read(
           entry.offset(), entry.size(), &sp, backing_buffer));
@@ -936,12 +1287,110 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   return Status::OK();
 }
 
+Status BundleReader::GetDeltaValue(StringPiece key,
+                                   const BundleEntryProto& entry,
+                                   Tensor* val) {
+  DCHECK(entry.has_delta());
+  if (base_ == nullptr) {
+    return errors::DataLoss("Delta entry for key ", key, " in bundle ",
+                            prefix_, ", which has no base bundle");
+  }
+  const TensorShape full_shape(entry.shape());
+  if (full_shape.dims() < 1) {
+    return errors::DataLoss("Invalid shape of delta entry for key ", key, ": ",
+                            full_shape.DebugString());
+  }
+  TF_RETURN_IF_ERROR(base_->Lookup(key, val));
+  if (val->dtype() != entry.dtype() || val->shape() != full_shape) {
+    return errors::DataLoss(
+        "Delta entry for key ", key, " is ", DataTypeString(entry.dtype()),
+        full_shape.DebugString(), " but the base bundle holds ",
+        DataTypeString(val->dtype()), val->shape().DebugString());
+  }
+
+  // Reads the stored rows.
+  const int64 num_rows = entry.delta().num_rows();
+  if (num_rows < 0) {
+    return errors::DataLoss("Invalid number of rows in delta entry for key ",
+                            key, ": ", num_rows);
+  }
+  TensorShape rows_shape(full_shape);
+  rows_shape.set_dim(0, num_rows);
+  BundleEntryProto rows_entry(entry);
+  rows_entry.clear_delta();
+  rows_shape.AsProto(rows_entry.mutable_shape());
+  Tensor rows(entry.dtype(), rows_shape);
+  TF_RETURN_IF_ERROR(GetValue(rows_entry, &rows));
+
+  // Reads the row indices.
+  std::vector<int64> row_indices(num_rows);
+  const size_t indices_bytes = num_rows * sizeof(int64);
+  if (indices_bytes > 0) {
+    io::InputBuffer* buffered_file = nullptr;
+    TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
+    TF_RETURN_IF_ERROR(buffered_file->Seek(entry.delta().indices_offset()));
+    char* backing_buffer = reinterpret_cast<char*>(row_indices.data());
+    size_t unused_bytes_read;
+    TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(indices_bytes, backing_buffer,
+                                                 &unused_bytes_read));
+  }
+  const uint32 actual_crc32c = crc32c::Value(
+      reinterpret_cast<const char*>(row_indices.data()), indices_bytes);
+  if (crc32c::Unmask(entry.delta().indices_crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(),
+        ": Checksum of row indices of ", key, " does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.delta().indices_crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+
+  // Overlays the stored rows on the base tensor.
+  const int64 num_base_rows = full_shape.dim_size(0);
+  const int64 row_elements =
+      num_base_rows == 0 ? 0 : full_shape.num_elements() / num_base_rows;
+  for (int64 i = 0; i < num_rows; ++i) {
+    int64 row = row_indices[i];
+    if (need_to_swap_bytes_) {
+      row = static_cast<int64>(BYTE_SWAP_64(static_cast<uint64>(row)));
+    }
+    if (row < 0 || row >= num_base_rows) {
+      return errors::DataLoss("Row index ", row, " of delta entry for key ",
+                              key, " is out of range [0, ", num_base_rows,
+                              ")");
+    }
+    if (DataTypeCanUseMemcpy(entry.dtype())) {
+      const size_t row_bytes = row_elements * DataTypeSize(entry.dtype());
+      memcpy(GetBackingBuffer(*val) + row * row_bytes,
+             GetBackingBuffer(rows) + i * row_bytes, row_bytes);
+    } else if (entry.dtype() == DT_STRING) {
+      auto dst = val->flat<tstring>();
+      auto src = rows.flat<tstring>();
+      for (int64 j = 0; j < row_elements; ++j) {
+        dst(row * row_elements + j) = src(i * row_elements + j);
+      }
+    } else {
+      auto dst = val->flat<Variant>();
+      auto src = rows.flat<Variant>();
+      for (int64 j = 0; j < row_elements; ++j) {
+        dst(row * row_elements + j) = src(i * row_elements + j);
+      }
+    }
+  }
+  return Status::OK();
+}
+
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Status s = GetBundleEntryProto(key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) {
+    return base_->Lookup(key, val);
+  }
+  TF_RETURN_IF_ERROR(s);
 
-  if (entry.slices().empty()) {
+  if (entry.has_delta()) {
+    return GetDeltaValue(key, entry, val);
+  } else if (entry.slices().empty()) {
     return GetValue(entry, val);
   } else {
     return GetSliceValue(
@@ -950,6 +1399,67 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+std::shared_ptr<ReadOnlyMemoryRegion> BundleReader::GetMappedDataFile(
+    int32 shard_id) {
+  auto it = mapped_data_.find(shard_id);
+  if (it != mapped_data_.end()) return it->second;
+
+  const string filename = DataFilename(prefix_, shard_id, num_shards_);
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+  if (!s.ok()) {
+    // Not retried; lookups of this file fall back to copies.
+    VLOG(1) << "Unable to memory-map " << filename << ": " << s;
+  }
+  std::shared_ptr<ReadOnlyMemoryRegion>& mapped = mapped_data_[shard_id];
+  mapped = std::move(region);
+  return mapped;
+}
+
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  Status s = GetBundleEntryProto(key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) {
+    return base_->LookupMapped(key, val);
+  }
+  TF_RETURN_IF_ERROR(s);
+
+  const TensorShape shape(entry.shape());
+  if (entry.slices().empty() && !entry.has_delta() &&
+      DataTypeCanUseMemcpy(entry.dtype()) && !need_to_swap_bytes_ &&
+      shape.num_elements() > 0 &&
+      entry.size() == shape.num_elements() * DataTypeSize(entry.dtype())) {
+    std::shared_ptr<ReadOnlyMemoryRegion> region =
+        GetMappedDataFile(entry.shard_id());
+    if (region != nullptr && entry.offset() >= 0 &&
+        static_cast<uint64>(entry.offset() + entry.size()) <=
+            region->length()) {
+      const char* data =
+          static_cast<const char*>(region->data()) + entry.offset();
+      if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES == 0) {
+        const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+        if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+          return errors::DataLoss(
+              "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+              entry.size(), " bytes): Checksum does not match: stored ",
+              strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+              " vs. calculated on the mapped bytes ", actual_crc32c);
+        }
+        MappedTensorBuffer* buf =
+            new MappedTensorBuffer(std::move(region), data, entry.size());
+        *val = Tensor(entry.dtype(), shape, buf);
+        buf->Unref();
+        return Status::OK();
+      }
+    }
+  }
+
+  // Falls back to a copy.
+  *val = Tensor(entry.dtype(), shape);
+  return Lookup(key, val);
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -959,7 +1469,9 @@ Status BundleReader::ReadCurrent(Tensor* val) {
                             entry.shape().ShortDebugString());
   }
 
-  if (entry.slices().empty()) {
+  if (entry.has_delta()) {
+    return GetDeltaValue(iter_->key(), entry, val);
+  } else if (entry.slices().empty()) {
     return GetValue(entry, val);
   } else {
     return GetSliceValue(
@@ -972,7 +1484,11 @@ Status BundleReader::LookupTensorSlices(StringPiece key,
                                         std::vector<TensorSlice>* slices) {
   slices->clear();
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Status s = GetBundleEntryProto(key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) {
+    return base_->LookupTensorSlices(key, slices);
+  }
+  TF_RETURN_IF_ERROR(s);
   slices->reserve(entry.slices_size());
   for (const auto& slice : entry.slices()) {
     slices->emplace_back(slice);
@@ -984,7 +1500,16 @@ Status BundleReader::LookupSlice(StringPiece full_tensor_key,
                                  const TensorSlice& slice_spec, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(full_tensor_key, &entry));
+  Status s = GetBundleEntryProto(full_tensor_key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) {
+    return base_->LookupSlice(full_tensor_key, slice_spec, val);
+  }
+  TF_RETURN_IF_ERROR(s);
+  if (entry.has_delta()) {
+    return errors::Unimplemented("Reading a slice of ", full_tensor_key,
+                                 ", which is stored as a delta in bundle ",
+                                 prefix_, "; compact the bundle first");
+  }
   return GetSliceValue(full_tensor_key, entry, slice_spec, val);
 }
 
@@ -1105,23 +1630,71 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 
 bool BundleReader::Contains(StringPiece key) {
   Seek(key);
-  return Valid() && (this->key() == key);
+  if (Valid() && (this->key() == key)) return true;
+  return base_ != nullptr && base_->Contains(key);
 }
 
 Status BundleReader::LookupDtypeAndShape(StringPiece key, DataType* dtype,
                                          TensorShape* shape) {
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Status s = GetBundleEntryProto(key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) {
+    return base_->LookupDtypeAndShape(key, dtype, shape);
+  }
+  TF_RETURN_IF_ERROR(s);
   *dtype = entry.dtype();
   *shape = TensorShape(entry.shape());
   return Status::OK();
 }
 
+Status BundleReader::LookupDataLocation(StringPiece key, int32* shard_id,
+                                        int64* offset, int64* size) {
+  BundleEntryProto entry;
+  Status s = GetBundleEntryProto(key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) {
+    TF_RETURN_IF_ERROR(base_->LookupDataLocation(key, shard_id, offset, size));
+    *shard_id = -1;
+    *offset = 0;
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(s);
+  if (entry.slices().empty() && !entry.has_delta()) {
+    *shard_id = entry.shard_id();
+    *offset = entry.offset();
+    *size = entry.size();
+  } else {
+    *shard_id = -1;
+    *offset = 0;
+    *size = std::max<int64>(entry.size(),
+                            TensorShape(entry.shape()).num_elements() *
+                                DataTypeSize(entry.dtype()));
+  }
+  return Status::OK();
+}
+
 Status BundleReader::LookupTensorShape(StringPiece key, TensorShape* shape) {
   DataType ignored;
   return LookupDtypeAndShape(key, &ignored, shape);
 }
 
+Status BundleReader::ListTensorKeys(std::vector<string>* keys) {
+  std::set<string> key_set;
+  CollectTensorKeys(&key_set);
+  keys->assign(key_set.begin(), key_set.end());
+  return iter_->status();
+}
+
+void BundleReader::CollectTensorKeys(std::set<string>* keys) {
+  Seek(kHeaderEntryKey);
+  for (Next(); Valid(); Next()) {
+    // All the tensor slice keys start with a 0 byte; see
+    // checkpoint::EncodeTensorNameSlice().
+    if (key().empty() || key()[0] == '\0') continue;
+    keys->emplace(key());
+  }
+  if (base_ != nullptr) base_->CollectTensorKeys(keys);
+}
+
 string BundleReader::DebugString() {
   // Format used below emulates that of TensorSliceReader::DebugString().
   string shape_str;
@@ -62,8 +62,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -104,7 +107,8 @@ extern const char* const kHeaderEntryKey;
 // On construction, attempts to create a directory given by the dirname of
 // "prefix", so "status()" must be checked before calling any member functions.
 //
-// All threads accessing the same BundleWriter must synchronize.
+// All threads accessing the same BundleWriter must synchronize.  With
+// Options::num_shards > 1, the writer itself uses that many threads.
 class BundleWriter {
  public:
   struct Options {
@@ -112,6 +116,22 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // If non-empty, writes a delta bundle on top of the bundle at this prefix.
+    // Readers of the delta see every tensor of the base bundle that is not
+    // overwritten here, and AddRows() may be used to store only the rows of a
+    // tensor that changed since the base was written.  A relative prefix is
+    // interpreted with respect to the directory of "prefix".
+    string base_prefix;
+    // Number of data files to write concurrently, each from its own thread.
+    // If > 1, the data of all added tensors is written out by Finish(), so the
+    // tensors must not be modified until it returns.  The result is read by
+    // BundleReader like any other bundle.
+    int num_shards{1};
+    // If num_shards > 1, tensors larger than this many bytes are split along
+    // dimension 0 into slices of at most this size (but at least one row), so
+    // that a single large tensor is spread across the data files.  The tensor
+    // is then stored as a partitioned tensor.  Non-positive to disable.
+    int64 max_slice_bytes{64 << 20};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -140,12 +160,47 @@ class BundleWriter {
                   const TensorShape& full_tensor_shape,
                   const TensorSlice& slice_spec, const Tensor& slice_tensor);
 
+  // Delta bundles support.
+  // Stores rows "row_indices" (slices along dimension 0) of the tensor keyed by
+  // "key", whose full shape is "full_tensor_shape"; "rows" holds the values of
+  // these rows, in the same order.  The other rows are read from the base
+  // bundle, which must hold a tensor of the same dtype and shape under "key".
+  // If "row_indices" contains duplicates, the last occurrence wins.
+  //
+  // Partitioned tensors are not supported; add their slices in full with
+  // AddSlice() instead.
+  //
+  // REQUIRES: !options.base_prefix.empty()
+  Status AddRows(StringPiece key, const TensorShape& full_tensor_shape,
+                 gtl::ArraySlice<int64> row_indices, const Tensor& rows);
+
   // Finishes the writer and flushes.
   Status Finish() TF_MUST_USE_RESULT;
 
   Status status() const { return status_; }
 
  private:
+  // The data of a tensor that Finish() writes to one of the data files, if
+  // Options::num_shards > 1.
+  struct PendingWrite {
+    BundleEntryProto* entry;  // Points into "entries_".
+    Tensor val;
+    std::vector<int64> row_indices;  // The stored rows iff entry->has_delta().
+  };
+
+  // Adds "val" under "key" as a single entry.
+  Status AddEntry(StringPiece key, const Tensor& val);
+
+  // Writes out the data of "entry", or defers it to Finish() if writing in
+  // parallel.
+  Status WriteData(const Tensor& val, gtl::ArraySlice<int64> row_indices,
+                   BundleEntryProto* entry);
+
+  // Spreads "pending_" over the data files and writes them concurrently.
+  Status WriteShards();
+  Status WriteShard(const string& path, int32 shard_id,
+                    const std::vector<PendingWrite*>& writes);
+
   Env* const env_;  // Not owned.
   const Options options_;
   const string prefix_;
@@ -155,6 +210,8 @@ class BundleWriter {
   std::unique_ptr<FileOutputBuffer> out_;
   int64 size_;  // Number of bytes written into out_.
   std::map<string, BundleEntryProto> entries_;
+  std::vector<PendingWrite> pending_;
+  int num_data_files_;
   Status status_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleWriter);
@@ -176,13 +233,33 @@ class BundleWriter {
 Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
                     StringPiece merged_prefix);
 
+// Folds the delta bundle at "prefix" and the chain of base bundles beneath it
+// into a single self-contained bundle with the given "compacted_prefix", which
+// must not be the prefix of any bundle in the chain.  The input bundles are
+// left untouched; the caller may delete them once the compaction succeeds.
+Status CompactBundles(Env* env, StringPiece prefix,
+                      StringPiece compacted_prefix);
+
 // On construction, silently attempts to read the metadata associated with
 // "prefix".  If caller intends to call any function afterwards, "status()"
 // must be checked.
+//
+// If "prefix" is a delta bundle, the reader also opens its chain of base
+// bundles, and lookups return the full view of each tensor.  Iteration with
+// Seek() and Next() only visits the entries stored in "prefix" itself.
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
-  BundleReader(Env* const env, StringPiece prefix);
+  struct Options {
+    Options() {}
+    // Size, in bytes, of the read buffer of every data file.  Tensors that are
+    // stored contiguously in a data file are read through it, so it acts as
+    // the readahead for restoring many small tensors in file order.  Larger
+    // tensors are read directly into their own buffers.  Must be > 0.
+    int64 read_buffer_size{1 << 20};
+  };
+  BundleReader(Env* const env, StringPiece prefix,
+               const Options& options = Options());
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -219,6 +296,22 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the tensor keyed by "key" like Lookup(), but allocates "val"
+  // itself, and where possible makes "val" alias the bytes of the memory-mapped
+  // data file instead of holding a copy.  Mapping requires:
+  //   - a file system that supports NewReadOnlyMemoryRegionFromFile(),
+  //   - a non-partitioned, non-delta tensor of a memcpy-able dtype,
+  //   - tensor data aligned to EIGEN_MAX_ALIGN_BYTES within the data file (see
+  //     BundleWriter::Options::data_alignment), and
+  //   - a bundle of the same endianness as this machine.
+  // Otherwise falls back to reading a copy, as Lookup() does.
+  //
+  // A mapped "val" is read-only; writing to it crashes the process.  It keeps
+  // its data file mapped for as long as it lives, also after the reader is
+  // destroyed.  Validates the stored crc32c checksum against the mapped bytes.
+  // REQUIRES: status().ok()
+  Status LookupMapped(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -244,6 +337,16 @@ class BundleReader {
   Status LookupSlice(StringPiece full_tensor_key, const TensorSlice& slice_spec,
                      Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up where the bytes of the tensor keyed by "key" are stored: the data
+  // file "shard_id", starting at "offset" and spanning "size" bytes.  Sets
+  // "shard_id" to -1 if the tensor is not stored contiguously in a data file
+  // of this bundle, i.e. if it is partitioned, a delta entry, or inherited
+  // from a base bundle; "size" is then an estimate.  Useful to order and
+  // group lookups by data file.
+  // REQUIRES: status().ok()
+  Status LookupDataLocation(StringPiece key, int32* shard_id, int64* offset,
+                            int64* size) TF_MUST_USE_RESULT;
+
   // Seeks to the first position in the bundle whose key is no less than "key".
   // REQUIRES: status().ok()
   void Seek(StringPiece key) { return iter_->Seek(key); }
@@ -261,9 +364,29 @@ class BundleReader {
   // REQUIRES: status().ok() && Valid()
   StringPiece value() const { return iter_->value(); }
 
+  // Returns the sorted keys of all tensors visible through this bundle,
+  // including those inherited from base bundles.  The keys of the individual
+  // slices of partitioned tensors are not returned.  Invalidates the reader's
+  // current position.
+  // REQUIRES: status().ok()
+  Status ListTensorKeys(std::vector<string>* keys) TF_MUST_USE_RESULT;
+
   string DebugString();
 
  private:
+  BundleReader(Env* const env, StringPiece prefix, const Options& options,
+               int delta_depth);
+
+  // Adds the keys of this bundle and its base bundles to "keys".
+  void CollectTensorKeys(std::set<string>* keys);
+
+  // Returns the buffered data file "shard_id", opening it if needed.
+  Status GetDataFile(int32 shard_id, io::InputBuffer** file) TF_MUST_USE_RESULT;
+
+  // Returns the memory-mapped data file "shard_id", mapping it if needed, or
+  // nullptr if the file cannot be mapped.
+  std::shared_ptr<ReadOnlyMemoryRegion> GetMappedDataFile(int32 shard_id);
+
   // Seeks for "key" and reads the metadata proto.
   // On non-OK return, clears "entry" for the caller.
   // REQUIRES: status().ok()
@@ -283,8 +406,15 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Reads the tensor keyed by "key" from the base bundle and overlays the rows
+  // stored by the delta entry "entry".
+  // REQUIRES: entry.has_delta()
+  Status GetDeltaValue(StringPiece key, const BundleEntryProto& entry,
+                       Tensor* val) TF_MUST_USE_RESULT;
+
   Env* env_;  // Not owned.
   const string prefix_;
+  const Options options_;
 
   Status status_;
   RandomAccessFile* metadata_;  // Owned.
@@ -293,6 +423,10 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // The memory-mapped data files, shared with the tensors that alias them.
+  // Holds nullptr for the files that cannot be mapped.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -306,6 +440,9 @@ class BundleReader {
   // differs from that of the current system's processor architecture.
   bool need_to_swap_bytes_;
 
+  // The reader of the base bundle, iff this bundle is a delta bundle.
+  std::unique_ptr<BundleReader> base_;
+
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleReader);
@@ -18,6 +18,8 @@ limitations under the License.
 #include <random>
 #include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -882,6 +884,409 @@ TEST(TensorBundleTest, DirectoryStructure) {
                           "merged.data-00001-of-00002"});
 }
 
+// Returns a [num_rows, 3] float tensor whose row r holds value + r.
+Tensor Rows(int64 num_rows, float value) {
+  Tensor ret(DT_FLOAT, TensorShape({num_rows, 3}));
+  test::FillFn<float>(&ret,
+                      [value](int offset) { return value + offset / 3; });
+  return ret;
+}
+
+// Sets all elements of row "row" of the float matrix "t" to "value".
+void SetRow(Tensor* t, int64 row, float value) {
+  auto matrix = t->matrix<float>();
+  for (int64 j = 0; j < matrix.dimension(1); ++j) matrix(row, j) = value;
+}
+
+TEST(TensorBundleTest, DeltaBundles) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("delta_base"));
+    TF_EXPECT_OK(writer.Add("embedding", Rows(5, 0.f)));
+    TF_EXPECT_OK(writer.Add("unchanged", Constant_2x3<int32>(7)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    // A relative base prefix is resolved against the delta's directory.
+    BundleWriter::Options options;
+    options.base_prefix = "delta_base";
+    BundleWriter writer(env, Prefix("delta_1"), options);
+    TF_EXPECT_OK(writer.AddRows("embedding", TensorShape({5, 3}), {3, 1},
+                                Rows(2, 10.f)));
+    TF_EXPECT_OK(writer.Add("added", Constant_2x3<float>(2.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options options;
+    options.base_prefix = Prefix("delta_1");
+    BundleWriter writer(env, Prefix("delta_2"), options);
+    TF_EXPECT_OK(writer.AddRows("embedding", TensorShape({5, 3}), {4, 3},
+                                Rows(2, 20.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader reader(env, Prefix("delta_2"));
+  TF_ASSERT_OK(reader.status());
+  Tensor expected = Rows(5, 0.f);
+  SetRow(&expected, 1, 11.f);
+  SetRow(&expected, 3, 21.f);
+  SetRow(&expected, 4, 20.f);
+  Expect<float>(&reader, "embedding", expected);
+  Expect<int32>(&reader, "unchanged", Constant_2x3<int32>(7));
+  Expect<float>(&reader, "added", Constant_2x3<float>(2.f));
+  EXPECT_FALSE(reader.Contains("nonexistent"));
+
+  std::vector<string> keys;
+  TF_ASSERT_OK(reader.ListTensorKeys(&keys));
+  EXPECT_EQ(keys, std::vector<string>({"added", "embedding", "unchanged"}));
+  // Iteration only visits the entries stored in the delta itself.
+  EXPECT_EQ(AllTensorKeys(&reader), std::vector<string>({"embedding"}));
+}
+
+TEST(TensorBundleTest, DeltaStringRows) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("delta_strings_base"));
+    TF_EXPECT_OK(writer.Add("strs", test::AsTensor<tstring>(
+                                        {"a", "b", "c", "d"}, {2, 2})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options options;
+    options.base_prefix = Prefix("delta_strings_base");
+    BundleWriter writer(env, Prefix("delta_strings"), options);
+    TF_EXPECT_OK(writer.AddRows("strs", TensorShape({2, 2}), {1},
+                                test::AsTensor<tstring>({"x", "y"}, {1, 2})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(env, Prefix("delta_strings"));
+  TF_ASSERT_OK(reader.status());
+  Expect<tstring>(&reader, "strs",
+                  test::AsTensor<tstring>({"a", "b", "x", "y"}, {2, 2}));
+}
+
+TEST(TensorBundleTest, MergeDeltaBundles) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("merge_delta_base"));
+    TF_EXPECT_OK(writer.Add("a", Rows(4, 0.f)));
+    TF_EXPECT_OK(writer.Add("b", Rows(4, 0.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // A sharded delta save writes one delta bundle per shard.
+  BundleWriter::Options options;
+  options.base_prefix = Prefix("merge_delta_base");
+  const std::vector<tstring> kShards = {Prefix("merge_delta_shard0"),
+                                        Prefix("merge_delta_shard1")};
+  {
+    BundleWriter writer(env, kShards[0], options);
+    TF_EXPECT_OK(
+        writer.AddRows("a", TensorShape({4, 3}), {2}, Rows(1, 5.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(env, kShards[1], options);
+    TF_EXPECT_OK(
+        writer.AddRows("b", TensorShape({4, 3}), {0}, Rows(1, 6.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(env, kShards, Prefix("merge_delta")));
+
+  BundleReader reader(env, Prefix("merge_delta"));
+  TF_ASSERT_OK(reader.status());
+  Tensor expected_a = Rows(4, 0.f);
+  SetRow(&expected_a, 2, 5.f);
+  Expect<float>(&reader, "a", expected_a);
+  Tensor expected_b = Rows(4, 0.f);
+  SetRow(&expected_b, 0, 6.f);
+  Expect<float>(&reader, "b", expected_b);
+
+  // Shards of one delta checkpoint must share the same base.
+  {
+    BundleWriter writer(env, Prefix("merge_delta_other"));
+    TF_EXPECT_OK(writer.Add("c", Rows(1, 0.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Status s = MergeBundles(
+      env, {Prefix("merge_delta"), Prefix("merge_delta_other")},
+      Prefix("merge_delta_bad"));
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "different base bundles")) << s;
+}
+
+TEST(TensorBundleTest, CompactBundles) {
+  Env* env = Env::Default();
+  const TensorShape kFullShape({5, 10});
+  {
+    BundleWriter writer(env, Prefix("compact_base"));
+    TF_EXPECT_OK(writer.Add("embedding", Rows(3, 0.f)));
+    TF_EXPECT_OK(writer.AddSlice("partitioned", kFullShape,
+                                 TensorSlice::ParseOrDie("-:0,1"),
+                                 Constant<float>(0., TensorShape({5, 1}))));
+    TF_EXPECT_OK(writer.AddSlice("partitioned", kFullShape,
+                                 TensorSlice::ParseOrDie("-:1,9"),
+                                 Constant<float>(1., TensorShape({5, 9}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options options;
+    options.base_prefix = Prefix("compact_base");
+    BundleWriter writer(env, Prefix("compact_delta"), options);
+    TF_EXPECT_OK(writer.AddRows("embedding", TensorShape({3, 3}), {0},
+                                Rows(1, 9.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  EXPECT_FALSE(
+      CompactBundles(env, Prefix("compact_delta"), Prefix("compact_delta"))
+          .ok());
+  TF_ASSERT_OK(
+      CompactBundles(env, Prefix("compact_delta"), Prefix("compacted")));
+
+  BundleReader reader(env, Prefix("compacted"));
+  TF_ASSERT_OK(reader.status());
+  Tensor expected = Rows(3, 0.f);
+  SetRow(&expected, 0, 9.f);
+  Expect<float>(&reader, "embedding", expected);
+  std::vector<TensorSlice> slices;
+  TF_ASSERT_OK(reader.LookupTensorSlices("partitioned", &slices));
+  EXPECT_EQ(2, slices.size());
+  Tensor val(DT_FLOAT, TensorShape({5, 9}));
+  TF_ASSERT_OK(reader.LookupSlice(
+      "partitioned", TensorSlice::ParseOrDie("-:1,9"), &val));
+  test::ExpectTensorEqual<float>(val,
+                                 Constant<float>(1., TensorShape({5, 9})));
+
+  // The compacted bundle stands on its own.
+  TF_ASSERT_OK(env->DeleteFile(MetaFilename(Prefix("compact_base"))));
+  BundleReader standalone(env, Prefix("compacted"));
+  TF_ASSERT_OK(standalone.status());
+  Expect<float>(&standalone, "embedding", expected);
+}
+
+TEST(TensorBundleTest, DeltaErrors) {
+  Env* env = Env::Default();
+  {  // Rows without a base bundle.
+    BundleWriter writer(env, Prefix("delta_no_base"));
+    EXPECT_FALSE(
+        writer.AddRows("foo", TensorShape({2, 3}), {0}, Rows(1, 0.f)).ok());
+  }
+  BundleWriter::Options options;
+  options.base_prefix = Prefix("delta_errors_base");
+  {  // Out-of-range row index.
+    BundleWriter writer(env, Prefix("delta_errors"), options);
+    Status s = writer.AddRows("foo", TensorShape({2, 3}), {2}, Rows(1, 0.f));
+    EXPECT_TRUE(absl::StrContains(s.ToString(), "out of range")) << s;
+  }
+  {  // Mismatched rows shape.
+    BundleWriter writer(env, Prefix("delta_errors"), options);
+    EXPECT_FALSE(
+        writer.AddRows("foo", TensorShape({2, 4}), {0}, Rows(1, 0.f)).ok());
+  }
+  {  // Missing base bundle.
+    BundleWriter writer(env, Prefix("delta_errors"), options);
+    TF_EXPECT_OK(
+        writer.AddRows("foo", TensorShape({2, 3}), {0}, Rows(1, 0.f)));
+    TF_ASSERT_OK(writer.Finish());
+    BundleReader reader(env, Prefix("delta_errors"));
+    EXPECT_TRUE(errors::IsNotFound(reader.status())) << reader.status();
+  }
+  {  // A bundle that is its own base.
+    BundleWriter::Options cyclic;
+    cyclic.base_prefix = Prefix("delta_cycle");
+    BundleWriter writer(env, Prefix("delta_cycle"), cyclic);
+    TF_ASSERT_OK(writer.Finish());
+    BundleReader reader(env, Prefix("delta_cycle"));
+    EXPECT_TRUE(absl::StrContains(reader.status().ToString(), "cycle"))
+        << reader.status();
+  }
+}
+
+TEST(TensorBundleTest, ParallelWriter) {
+  Env* env = Env::Default();
+  BundleWriter::Options options;
+  options.num_shards = 3;
+  options.max_slice_bytes = 40;
+  const Tensor big = Rows(10, 0.f);  // 120 bytes, split into 4 slices.
+  Tensor half(DT_HALF, TensorShape({8, 4}));  // Large, but never split.
+  test::FillFn<Eigen::half>(
+      &half, [](int offset) { return static_cast<Eigen::half>(offset); });
+  const Tensor strs = test::AsTensor<tstring>({"a", "bb", "ccc"});
+  {
+    BundleWriter writer(env, Prefix("parallel"), options);
+    TF_EXPECT_OK(writer.Add("big", big));
+    TF_EXPECT_OK(writer.Add("half", half));
+    TF_EXPECT_OK(writer.Add("small", Constant_2x3<int32>(3)));
+    TF_EXPECT_OK(writer.Add("strs", strs));
+    EXPECT_FALSE(writer.Add("big", big).ok());
+  }
+  {
+    BundleWriter writer(env, Prefix("parallel"), options);
+    TF_EXPECT_OK(writer.Add("big", big));
+    TF_EXPECT_OK(writer.Add("half", half));
+    TF_EXPECT_OK(writer.Add("small", Constant_2x3<int32>(3)));
+    TF_EXPECT_OK(writer.Add("strs", strs));
+    TF_ASSERT_OK(writer.Finish());
+    EXPECT_FALSE(writer.Finish().ok());
+  }
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("parallel"), i, 3)));
+  }
+
+  BundleReader reader(env, Prefix("parallel"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "big", big);
+  Expect<Eigen::half>(&reader, "half", half);
+  Expect<int32>(&reader, "small", Constant_2x3<int32>(3));
+  Expect<tstring>(&reader, "strs", strs);
+  std::vector<TensorSlice> slices;
+  TF_ASSERT_OK(reader.LookupTensorSlices("big", &slices));
+  EXPECT_EQ(4, slices.size());
+  TF_ASSERT_OK(reader.LookupTensorSlices("half", &slices));
+  EXPECT_TRUE(slices.empty());
+
+  // Fewer tensors than shards only creates as many data files as needed, and
+  // parallel bundles merge like any others.
+  {
+    BundleWriter writer(env, Prefix("parallel_one"), options);
+    TF_EXPECT_OK(writer.Add("other", Constant_2x3<float>(5.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  EXPECT_TRUE(errors::IsNotFound(
+      env->FileExists(DataFilename(Prefix("parallel_one"), 0, 3))));
+  TF_ASSERT_OK(MergeBundles(env, {Prefix("parallel"), Prefix("parallel_one")},
+                            Prefix("parallel_merged")));
+  BundleReader merged(env, Prefix("parallel_merged"));
+  TF_ASSERT_OK(merged.status());
+  Expect<float>(&merged, "big", big);
+  Expect<float>(&merged, "other", Constant_2x3<float>(5.f));
+}
+
+TEST(TensorBundleTest, ParallelDeltaWriter) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("parallel_delta_base"));
+    TF_EXPECT_OK(writer.Add("a", Rows(4, 0.f)));
+    TF_EXPECT_OK(writer.Add("b", Rows(4, 0.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options options;
+    options.base_prefix = Prefix("parallel_delta_base");
+    options.num_shards = 2;
+    BundleWriter writer(env, Prefix("parallel_delta"), options);
+    TF_EXPECT_OK(writer.AddRows("a", TensorShape({4, 3}), {1}, Rows(1, 8.f)));
+    TF_EXPECT_OK(
+        writer.AddRows("b", TensorShape({4, 3}), {3, 0}, Rows(2, 9.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(env, Prefix("parallel_delta"));
+  TF_ASSERT_OK(reader.status());
+  Tensor expected_a = Rows(4, 0.f);
+  SetRow(&expected_a, 1, 8.f);
+  Expect<float>(&reader, "a", expected_a);
+  Tensor expected_b = Rows(4, 0.f);
+  SetRow(&expected_b, 3, 9.f);
+  SetRow(&expected_b, 0, 10.f);
+  Expect<float>(&reader, "b", expected_b);
+}
+
+// Returns whether "t" aliases a memory-mapped data file.
+bool IsMapped(const Tensor& t) {
+  TensorDescription description;
+  t.FillDescription(&description);
+  return description.allocation_description().allocator_name() ==
+         "MappedTensorBuffer";
+}
+
+TEST(TensorBundleTest, LookupMapped) {
+  Env* env = Env::Default();
+  const Tensor floats = Rows(6, 1.f);
+  const Tensor strs = test::AsTensor<tstring>({"a", "bb"});
+  {
+    BundleWriter::Options options;
+    options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(env, Prefix("mapped"), options);
+    TF_EXPECT_OK(writer.Add("floats", floats));
+    TF_EXPECT_OK(writer.Add("ints", Constant_2x3<int64>(4)));
+    TF_EXPECT_OK(writer.Add("strs", strs));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor mapped_floats, mapped_ints, mapped_strs;
+  {
+    BundleReader reader(env, Prefix("mapped"));
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.LookupMapped("floats", &mapped_floats));
+    TF_ASSERT_OK(reader.LookupMapped("ints", &mapped_ints));
+    TF_ASSERT_OK(reader.LookupMapped("strs", &mapped_strs));
+    EXPECT_TRUE(errors::IsNotFound(
+        reader.LookupMapped("nonexistent", &mapped_strs)));
+  }
+  // The mapped tensors outlive the reader.
+  EXPECT_TRUE(IsMapped(mapped_floats));
+  EXPECT_TRUE(IsMapped(mapped_ints));
+  test::ExpectTensorEqual<float>(mapped_floats, floats);
+  test::ExpectTensorEqual<int64>(mapped_ints, Constant_2x3<int64>(4));
+  // String tensors are read as copies.
+  EXPECT_FALSE(IsMapped(mapped_strs));
+  test::ExpectTensorEqual<tstring>(mapped_strs, strs);
+}
+
+TEST(TensorBundleTest, LookupMappedUnaligned) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("mapped_unaligned"));
+    TF_EXPECT_OK(writer.Add("a_byte", Constant<uint8>(1, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("b_floats", Constant_2x3<float>(2.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(env, Prefix("mapped_unaligned"));
+  TF_ASSERT_OK(reader.status());
+  // "b_floats" starts at byte 1 of the data file, so it is read as a copy.
+  Tensor val;
+  TF_ASSERT_OK(reader.LookupMapped("b_floats", &val));
+  EXPECT_FALSE(IsMapped(val));
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(2.f));
+}
+
+TEST(TensorBundleTest, LookupDataLocation) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("location"));
+    TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1.f)));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(2.f)));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("0,2:-"),
+                                 Constant_2x3<float>(3.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options options;
+  options.read_buffer_size = 8;  // Smaller than any of the tensors.
+  BundleReader reader(env, Prefix("location"), options);
+  TF_ASSERT_OK(reader.status());
+  int32 shard_id;
+  int64 offset, size;
+  TF_ASSERT_OK(reader.LookupDataLocation("a", &shard_id, &offset, &size));
+  EXPECT_EQ(0, shard_id);
+  EXPECT_EQ(0, offset);
+  EXPECT_EQ(24, size);
+  TF_ASSERT_OK(reader.LookupDataLocation("b", &shard_id, &offset, &size));
+  EXPECT_EQ(0, shard_id);
+  EXPECT_EQ(24, offset);
+  EXPECT_EQ(24, size);
+  // Partitioned tensors are not stored contiguously.
+  TF_ASSERT_OK(reader.LookupDataLocation("part", &shard_id, &offset, &size));
+  EXPECT_EQ(-1, shard_id);
+  EXPECT_EQ(48, size);
+  EXPECT_TRUE(errors::IsNotFound(
+      reader.LookupDataLocation("nonexistent", &shard_id, &offset, &size)));
+
+  Expect<float>(&reader, "a", Constant_2x3<float>(1.f));
+  Expect<float>(&reader, "b", Constant_2x3<float>(2.f));
+
+  options.read_buffer_size = 0;
+  BundleReader bad_reader(env, Prefix("location"), options);
+  EXPECT_TRUE(errors::IsInvalidArgument(bad_reader.status()));
+}
+
 TEST(TensorBundleTest, Error) {
   {  // Dup keys.
     BundleWriter writer(Env::Default(), Prefix("dup"));
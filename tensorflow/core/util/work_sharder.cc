@@ -41,6 +41,11 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
     work(0, total);
     return;
   }
+  if (workers->UsesWorkStealingParallelFor()) {
+    workers->ParallelForWorkStealing(total, cost_per_unit, max_parallelism,
+                                     work);
+    return;
+  }
   if (max_parallelism >= workers->NumThreads()) {
     workers->ParallelFor(total, cost_per_unit, work);
     return;
@@ -52,6 +52,10 @@ namespace tensorflow {
 // call SetMaxParallelism() so that all Shard() calls later limits the
 // thread parallelism.
 //
+// If "workers" uses work-stealing ParallelFor (see
+// ThreadPool::ParallelForWorkStealing), max_parallelism bounds the number of
+// threads running the shards at once rather than the number of shards.
+//
 // REQUIRES: max_parallelism >= 0
 // REQUIRES: workers != nullptr
 // REQUIRES: total >= 0
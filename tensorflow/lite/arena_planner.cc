@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <numeric>
 #include <set>
 #include <type_traits>
 #include <utility>
@@ -52,6 +53,25 @@ std::intptr_t ArenaPlanner::BasePointer(TfLiteAllocationType type) {
   return 0;
 }
 
+void ArenaPlanner::SetOfflineOffsets(std::vector<int32_t> offsets) {
+  offline_offsets_ = std::move(offsets);
+}
+
+std::vector<int32_t> ArenaPlanner::GetArenaOffsets() {
+  std::vector<int32_t> offsets(graph_info_->num_tensors(), -1);
+  for (int i = 0; i < static_cast<int>(offsets.size()) &&
+                  i < static_cast<int>(allocs_.size());
+       ++i) {
+    if (graph_info_->tensor(i)->allocation_type == kTfLiteArenaRw &&
+        allocs_[i].size != 0 &&
+        allocs_[i].offset <=
+            static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+      offsets[i] = static_cast<int32_t>(allocs_[i].offset);
+    }
+  }
+  return offsets;
+}
+
 TfLiteStatus ArenaPlanner::ResetAllocations() {
   TF_LITE_ENSURE_STATUS(arena_.ClearPlan());
   TF_LITE_ENSURE_STATUS(persistent_arena_.ClearPlan());
@@ -262,19 +282,24 @@ TfLiteStatus ArenaPlanner::Commit() {
 std::vector<int32_t> ArenaPlanner::CreateTensorAllocationVector(int first_node,
                                                                 int last_node) {
   auto tensor_compare = [this](int idx1, int idx2) {
+    // Tensors with an offline offset are placed first, so that no tensor
+    // planned at runtime takes their place.
+    if (this->HasOfflineOffset(idx1) != this->HasOfflineOffset(idx2)) {
+      return this->HasOfflineOffset(idx1);
+    }
+    if (this->HasOfflineOffset(idx1)) {
+      return idx1 < idx2;
+    }
     // Tensors that have lifespan through the whole model inference time are
     // allocated at the beginning of memory slice. Their respective order
     // doesn't matter in fact, so here they are sorted by index.
-    if (this->alloc_node_[idx1] == 0 &&
-        this->dealloc_node_[idx1] == kNodeNotAssigned) {
-      if (this->alloc_node_[idx2] == 0 &&
-          this->dealloc_node_[idx2] == kNodeNotAssigned) {
+    if (this->IsWholeLifetime(idx1)) {
+      if (this->IsWholeLifetime(idx2)) {
         return idx1 < idx2;
       }
       return true;
     }
-    if (this->alloc_node_[idx2] == 0 &&
-        this->dealloc_node_[idx2] == kNodeNotAssigned) {
+    if (this->IsWholeLifetime(idx2)) {
       return false;
     }
 
@@ -302,7 +327,7 @@ std::vector<int32_t> ArenaPlanner::CreateTensorAllocationVector(int first_node,
 
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   // Indices of tensors in order their allocation offsets will be calculated.
-  const std::vector<int32_t> tensor_order =
+  std::vector<int32_t> tensor_order =
       CreateTensorAllocationVector(first_node, last_node);
 
   // Deallocate if the tensor was already allocated.
@@ -314,14 +339,20 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     }
   }
 
+  // The ordering matters most when the whole graph is planned at once.
+  if (compare_orderings_ && first_node == 0) {
+    std::vector<int32_t> breadth_order = ReorderByBreadth(tensor_order);
+    if (PlannedArenaSize(breadth_order) < PlannedArenaSize(tensor_order)) {
+      tensor_order.swap(breadth_order);
+    }
+  }
+
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : tensor_order) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
     if (tensor.allocation_type == kTfLiteArenaRw) {
       TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+          AllocateInArena(&arena_, tensor_index, &allocs_[tensor_index]));
     }
     if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
       TF_LITE_ENSURE_STATUS(persistent_arena_.Allocate(
@@ -334,6 +365,103 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+std::vector<int32_t> ArenaPlanner::ReorderByBreadth(
+    const std::vector<int32_t>& tensor_order) {
+  std::vector<int32_t> reordered;
+  std::vector<int32_t> intermediates;
+  for (int32_t tensor_index : tensor_order) {
+    if (graph_info_->tensor(tensor_index)->allocation_type == kTfLiteArenaRw &&
+        !HasOfflineOffset(tensor_index) && !IsWholeLifetime(tensor_index)) {
+      intermediates.push_back(tensor_index);
+    } else {
+      reordered.push_back(tensor_index);
+    }
+  }
+
+  // The total size of the tensors in use while each node runs.
+  const int num_nodes = graph_info_->num_nodes();
+  auto last_node = [this, num_nodes](int32_t tensor_index) {
+    return std::min(dealloc_node_[tensor_index], num_nodes - 1);
+  };
+  std::vector<size_t> breadth(num_nodes, 0);
+  for (int32_t tensor_index : intermediates) {
+    for (int node = alloc_node_[tensor_index]; node <= last_node(tensor_index);
+         ++node) {
+      breadth[node] += graph_info_->tensor(tensor_index)->bytes;
+    }
+  }
+  std::vector<int> nodes(num_nodes);
+  std::iota(nodes.begin(), nodes.end(), 0);
+  std::stable_sort(nodes.begin(), nodes.end(), [&breadth](int a, int b) {
+    return breadth[a] > breadth[b];
+  });
+
+  std::vector<bool> visited(graph_info_->num_tensors(), false);
+  for (int node : nodes) {
+    for (int32_t tensor_index : intermediates) {
+      if (!visited[tensor_index] && alloc_node_[tensor_index] <= node &&
+          node <= last_node(tensor_index)) {
+        visited[tensor_index] = true;
+        reordered.push_back(tensor_index);
+      }
+    }
+  }
+  for (int32_t tensor_index : intermediates) {
+    if (!visited[tensor_index]) {
+      reordered.push_back(tensor_index);
+    }
+  }
+  return reordered;
+}
+
+size_t ArenaPlanner::PlannedArenaSize(
+    const std::vector<int32_t>& tensor_order) {
+  SimpleMemoryArena arena(kDefaultArenaAlignment);
+  ArenaAllocWithUsageInterval alloc;
+  for (int32_t tensor_index : tensor_order) {
+    if (graph_info_->tensor(tensor_index)->allocation_type == kTfLiteArenaRw &&
+        AllocateInArena(&arena, tensor_index, &alloc) != kTfLiteOk) {
+      return std::numeric_limits<size_t>::max();
+    }
+  }
+  return arena.RequiredBufferSize();
+}
+
+TfLiteStatus ArenaPlanner::AllocateInArena(SimpleMemoryArena* arena,
+                                           int tensor_index,
+                                           ArenaAllocWithUsageInterval* alloc) {
+  const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+  const int32_t first_node = FirstConcurrentNode(alloc_node_[tensor_index]);
+  const int32_t last_node = LastConcurrentNode(dealloc_node_[tensor_index]);
+  if (HasOfflineOffset(tensor_index) &&
+      arena->AllocateAt(offline_offsets_[tensor_index], tensor_alignment_,
+                        tensor.bytes, tensor_index, first_node, last_node,
+                        alloc)) {
+    return kTfLiteOk;
+  }
+  return arena->Allocate(context_, tensor_alignment_, tensor.bytes,
+                         tensor_index, first_node, last_node, alloc);
+}
+
+bool ArenaPlanner::IsWholeLifetime(int tensor_index) const {
+  return alloc_node_[tensor_index] == 0 &&
+         dealloc_node_[tensor_index] == kNodeNotAssigned;
+}
+
+int32_t ArenaPlanner::FirstConcurrentNode(int32_t node) const {
+  if (node < 0 || static_cast<size_t>(node) >= graph_info_->num_nodes()) {
+    return node;
+  }
+  return graph_info_->first_concurrent_node(node);
+}
+
+int32_t ArenaPlanner::LastConcurrentNode(int32_t node) const {
+  if (node < 0 || static_cast<size_t>(node) >= graph_info_->num_nodes()) {
+    return node;
+  }
+  return graph_info_->last_concurrent_node(node);
+}
+
 TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
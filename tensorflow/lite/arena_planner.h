@@ -28,6 +28,16 @@ limitations under the License.
 namespace tflite {
 
 constexpr const int kDefaultArenaAlignment = 64;
+
+// The name of the model metadata that caches the arena offsets of the tensors
+// of a subgraph, see ArenaPlanner::SetOfflineOffsets(). Its buffer holds
+// int32 values: the version of the format (kArenaOffsetsMetadataVersion), the
+// index of the subgraph, the number of tensors N, and then N offsets in
+// bytes, one per tensor, or -1 for tensors that are planned at runtime. A
+// model may hold one such metadata per subgraph.
+constexpr const char kArenaOffsetsMetadataName[] = "ArenaPlannerOffsets";
+constexpr const int kArenaOffsetsMetadataVersion = 1;
+
 struct AllocationInfo;
 
 // A memory planner that makes all the allocations using arenas.
@@ -67,6 +77,28 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Places each tensor with a non-negative entry in `offsets`, indexed by
+  // tensor, at that offset of the arena, e.g. as returned by GetArenaOffsets()
+  // on an earlier run and cached in the model. These tensors are placed
+  // before the others. A tensor the offset doesn't suit anymore, e.g. because
+  // it overlaps another tensor there after an input was resized, is planned
+  // like the others.
+  void SetOfflineOffsets(std::vector<int32_t> offsets);
+
+  // If true, allocations that plan the whole graph at once also try ordering
+  // the tensors greedy-by-breadth, i.e. the tensors used by the nodes that
+  // need the most memory first, besides ordering them greedy-by-size, and use
+  // whichever order needs the smaller arena. This costs more planning time,
+  // so it is meant to be used ahead of time, with the resulting offsets
+  // cached by GetArenaOffsets().
+  void SetCompareOrderings(bool compare_orderings) {
+    compare_orderings_ = compare_orderings;
+  }
+
+  // Returns the offset in the arena of each tensor, or -1 for tensors that
+  // aren't allocated in it.
+  std::vector<int32_t> GetArenaOffsets();
+
  private:
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
@@ -79,13 +111,46 @@ class ArenaPlanner : public MemoryPlanner {
   // - Other tensors (e.g. intermediate and temporary ones) are sorted in
   // non-increasing order of their size. If sizes of two tensors are equal, the
   // one that needs to be allocated earlier goes first.
+  // - Tensors with an offline offset go before all of these.
   std::vector<int32_t> CreateTensorAllocationVector(int first_node,
                                                     int last_node);
 
+  // Returns `tensor_order` reordered greedy-by-breadth: the nodes are visited
+  // in non-increasing order of the total size of the tensors in use while
+  // they run, and the tensors of each node that weren't visited yet follow in
+  // their order in `tensor_order`. Tensors with an offline offset and those
+  // with a lifespan through the whole inference stay first.
+  std::vector<int32_t> ReorderByBreadth(
+      const std::vector<int32_t>& tensor_order);
+
+  // Returns the size of the arena needed to allocate the tensors in the given
+  // order on their own.
+  size_t PlannedArenaSize(const std::vector<int32_t>& tensor_order);
+
+  // Reserves space in `arena` for the kTfLiteArenaRw tensor `tensor_index`, at
+  // its offline offset if it has one that fits.
+  TfLiteStatus AllocateInArena(SimpleMemoryArena* arena, int tensor_index,
+                               ArenaAllocWithUsageInterval* alloc);
+
+  bool HasOfflineOffset(int tensor_index) const {
+    return tensor_index < static_cast<int>(offline_offsets_.size()) &&
+           offline_offsets_[tensor_index] >= 0;
+  }
+
+  // Returns true if the tensor is in use through the whole inference.
+  bool IsWholeLifetime(int tensor_index) const;
+
   // Traverse the allocation queue and reserve space in the appropriate arena
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
 
+  // Returns the first and last of the nodes that may run concurrently with
+  // `node`. A tensor is kept alive from the first of those of the node that
+  // allocates it to the last of those of the node that deallocates it, so that
+  // it never shares memory with a tensor a concurrent node is using.
+  int32_t FirstConcurrentNode(int32_t node) const;
+  int32_t LastConcurrentNode(int32_t node) const;
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
@@ -131,6 +196,13 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // The offset of each tensor planned ahead of time, or -1, see
+  // SetOfflineOffsets().
+  std::vector<int32_t> offline_offsets_;
+
+  // See SetCompareOrderings().
+  bool compare_orderings_ = false;
 };
 
 }  // namespace tflite
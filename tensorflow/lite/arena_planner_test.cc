@@ -710,6 +710,80 @@ TEST_F(ArenaPlannerTest, GraphWithIntermediates) {
   EXPECT_EQ(GetOffset(2), GetOffsetAfter(5));
 }
 
+TEST_F(ArenaPlannerTest, OfflineOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  // Tensor 5 doesn't fit where it should go, since tensor 3 is already
+  // there when the third op uses them both.
+  planner_->SetOfflineOffsets({-1, -1, -1, 100, 200, 100});
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(3), 100);
+  EXPECT_EQ(GetOffset(4), 200);
+  EXPECT_TRUE(GetOffsetAfter(5) <= GetOffset(3) ||
+              GetOffset(5) >= GetOffsetAfter(3));
+  EXPECT_TRUE(GetOffsetAfter(5) <= GetOffset(4) ||
+              GetOffset(5) >= GetOffsetAfter(4));
+
+  const std::vector<int32_t> offsets = planner_->GetArenaOffsets();
+  ASSERT_EQ(offsets.size(), 6);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(offsets[i], GetOffset(i));
+  }
+}
+
+TEST_F(ArenaPlannerTest, CompareOrderings) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},  // First op
+                      {{1}, {2}, {}},  // Second op
+                      {{2}, {3}, {}},  // Third op
+                      {{3}, {4}, {}}   // Fourth op
+                  },
+                  {4});
+  const std::vector<size_t> bytes = {28, 24, 12, 20, 16};
+  for (int i = 0; i < bytes.size(); ++i) {
+    (*graph.tensors())[i].bytes = bytes[i];
+  }
+  auto arena_size = [this, &bytes]() {
+    std::ptrdiff_t size = 0;
+    for (int i = 0; i < bytes.size(); ++i) {
+      size = std::max(size, GetOffsetAfter(i));
+    }
+    return size;
+  };
+
+  // Greedy-by-size places tensors 1 and 0 first, leaving no room for tensor 2
+  // next to tensor 3.
+  SetGraph(&graph);
+  Execute(0, 10);
+  EXPECT_EQ(arena_size(), 64);
+
+  // Greedy-by-breadth places the tensors used by the first op, which needs
+  // the most memory, first.
+  SetGraph(&graph);
+  planner_->SetCompareOrderings(true);
+  Execute(0, 10);
+  EXPECT_EQ(arena_size(), 52);
+
+  // The plan can be reused without comparing again.
+  const std::vector<int32_t> offsets = planner_->GetArenaOffsets();
+  SetGraph(&graph);
+  planner_->SetOfflineOffsets(offsets);
+  Execute(0, 10);
+  for (int i = 0; i < bytes.size(); ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -0,0 +1,93 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
+
+#include <algorithm>
+
+namespace tflite {
+namespace impl {
+
+InterOpThreadPool::InterOpThreadPool(int num_threads)
+    : num_threads_(std::max(num_threads, 1)) {
+  threads_.reserve(num_threads_ - 1);
+  for (int worker = 1; worker < num_threads_; ++worker) {
+    threads_.emplace_back([this, worker]() { WorkerLoop(worker); });
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void InterOpThreadPool::Run(int num_tasks,
+                            const std::function<void(int, int)>& task) {
+  if (num_tasks <= 1 || threads_.empty()) {
+    for (int i = 0; i < num_tasks; ++i) {
+      task(i, /*worker=*/0);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    num_busy_workers_ = threads_.size();
+    ++generation_;
+  }
+  work_available_.notify_all();
+  RunTasks(/*worker=*/0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this]() { return num_busy_workers_ == 0; });
+  task_ = nullptr;
+}
+
+void InterOpThreadPool::WorkerLoop(int worker) {
+  int64_t last_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [this, last_generation]() {
+        return shutting_down_ || generation_ != last_generation;
+      });
+      if (shutting_down_) return;
+      last_generation = generation_;
+    }
+    RunTasks(worker);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--num_busy_workers_ == 0) work_done_.notify_one();
+    }
+  }
+}
+
+void InterOpThreadPool::RunTasks(int worker) {
+  for (int i = next_task_++; i < num_tasks_; i = next_task_++) {
+    (*task_)(i, worker);
+  }
+}
+
+}  // namespace impl
+}  // namespace tflite
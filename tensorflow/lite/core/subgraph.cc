@@ -152,6 +152,32 @@ TfLiteStatus ValidateCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+// Returns true if `node` may have effects besides writing its outputs, or may
+// read state other nodes write, so that it has to keep its place in the
+// execution plan relative to other such nodes.
+bool RunsInPlanOrder(const TfLiteContext& context, const TfLiteNode& node,
+                     const TfLiteRegistration& registration) {
+  if (node.delegate != nullptr ||
+      registration.builtin_code == BuiltinOperator_CUSTOM ||
+      registration.builtin_code == BuiltinOperator_DELEGATE ||
+      registration.builtin_code == BuiltinOperator_IF ||
+      registration.builtin_code == BuiltinOperator_WHILE) {
+    return true;
+  }
+  for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+    if (tensor_index != kTfLiteOptionalTensor &&
+        context.tensors[tensor_index].is_variable) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The cpu backend context of the inter-op thread running on this thread, if
+// any. Ops running on it use it instead of the interpreter's, which can only
+// be used by one op at a time.
+thread_local TfLiteExternalContext* inter_op_cpu_backend_context = nullptr;
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -186,6 +212,17 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  size_t first_concurrent_node(size_t index) const override {
+    if (subgraph_->inter_op_wave_of_node_.empty()) return index;
+    return subgraph_->inter_op_wave_starts_
+        [subgraph_->inter_op_wave_of_node_[index]];
+  }
+  size_t last_concurrent_node(size_t index) const override {
+    if (subgraph_->inter_op_wave_of_node_.empty()) return index;
+    return subgraph_->inter_op_wave_starts_
+               [subgraph_->inter_op_wave_of_node_[index] + 1] -
+           1;
+  }
 
  public:
   Subgraph* subgraph_;
@@ -424,6 +461,10 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext &&
+      inter_op_cpu_backend_context != nullptr) {
+    return inter_op_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -635,7 +676,7 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // Explicit (re)allocation is necessary if nodes have been changed or tensors
   // have been resized. For inputs marked as dynamic, we can't short-circuit the
   // allocation as the client may have done the resize manually.
-  if (state_ != kStateUninvokable &&
+  if (state_ != kStateUninvokable && state_ != kStateInputsResized &&
       !HasDynamicTensorImpl(context_, inputs())) {
     if (memory_planner_ && !memory_planner_->HasNonPersistentMemory()) {
       // If the only change was the release of non-persistent memory via
@@ -647,6 +688,10 @@ TfLiteStatus Subgraph::AllocateTensors() {
     return kTfLiteOk;
   }
 
+  if (!input_upper_bounds_.empty() && !input_upper_bounds_planned_) {
+    TF_LITE_ENSURE_STATUS(PlanInputUpperBounds());
+  }
+
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
@@ -654,7 +699,12 @@ TfLiteStatus Subgraph::AllocateTensors() {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
 
-  TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  const TfLiteStatus status = PrepareOpsAndTensors();
+  resized_tensors_.clear();
+  if (status != kTfLiteOk) {
+    state_ = kStateUninvokable;
+    return status;
+  }
 
   state_ = kStateInvokable;
 
@@ -779,7 +829,17 @@ TfLiteStatus Subgraph::ResizeInputTensor(int tensor_index,
     // Undo delegation if it resulted in the graph being immutable.
     TF_LITE_ENSURE_STATUS(UndoAllDelegates());
   }
-  state_ = kStateUninvokable;
+  if (incremental_resize_ && (state_ == kStateInvokable ||
+                              state_ == kStateInputsResized)) {
+    if (state_ == kStateInvokable) {
+      resized_tensors_.clear();
+    }
+    resized_tensors_.resize(tensors_.size(), false);
+    resized_tensors_[tensor_index] = true;
+    state_ = kStateInputsResized;
+  } else {
+    state_ = kStateUninvokable;
+  }
   return ResizeTensorImpl(tensor, ConvertVectorToTfLiteIntArray(dims));
 }
 
@@ -813,6 +873,85 @@ TfLiteStatus Subgraph::ResizeInputTensorStrict(int tensor_index,
   return ResizeInputTensor(tensor_index, dims);
 }
 
+TfLiteStatus Subgraph::SetIncrementalResize(bool incremental_resize) {
+  incremental_resize_ = incremental_resize;
+  if (!incremental_resize_ && state_ == kStateInputsResized) {
+    state_ = kStateUninvokable;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::SetInputTensorUpperBound(int tensor_index,
+                                                const std::vector<int>& dims) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(
+        "SetInputTensorUpperBound is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  if (std::find(inputs_.begin(), inputs_.end(), tensor_index) ==
+      inputs_.end()) {
+    ReportError("Tensor %d is not an input of the subgraph.", tensor_index);
+    return kTfLiteError;
+  }
+  for (int dim : dims) {
+    TF_LITE_ENSURE(&context_, dim >= 0);
+  }
+  input_upper_bounds_[tensor_index] = dims;
+  input_upper_bounds_planned_ = false;
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::PlanInputUpperBounds() {
+  std::vector<std::pair<int, std::vector<int>>> input_dims;
+  for (const auto& upper_bound : input_upper_bounds_) {
+    TfLiteTensor* tensor = &context_.tensors[upper_bound.first];
+    input_dims.emplace_back(
+        upper_bound.first,
+        std::vector<int>(tensor->dims->data,
+                         tensor->dims->data + tensor->dims->size));
+    TF_LITE_ENSURE_STATUS(ResizeTensorImpl(
+        tensor, ConvertVectorToTfLiteIntArray(upper_bound.second)));
+  }
+
+  // Every node is prepared for the upper bounds.
+  state_ = kStateUninvokable;
+  next_execution_plan_index_to_prepare_ = 0;
+  next_execution_plan_index_to_plan_allocation_ = 0;
+  next_original_execution_plan_index_to_prepare_ = 0;
+  if (memory_planner_) {
+    TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
+  }
+  TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  input_upper_bounds_planned_ = true;
+
+  if (incremental_resize_) {
+    resized_tensors_.assign(tensors_.size(), false);
+    state_ = kStateInputsResized;
+  }
+  for (const auto& dims : input_dims) {
+    if (incremental_resize_) {
+      resized_tensors_[dims.first] = true;
+    }
+    TF_LITE_ENSURE_STATUS(
+        ResizeTensorImpl(&context_.tensors[dims.first],
+                         ConvertVectorToTfLiteIntArray(dims.second)));
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::IsAnyTensorResized(const TfLiteIntArray* tensors) const {
+  for (int i = 0; i < tensors->size; ++i) {
+    const int tensor_index = tensors->data[i];
+    if (tensor_index != kTfLiteOptionalTensor &&
+        (tensor_index >= resized_tensors_.size() ||
+         resized_tensors_[tensor_index])) {
+      return true;
+    }
+  }
+  return false;
+}
+
 TfLiteStatus Subgraph::ReleaseNonPersistentMemory() {
   if (memory_planner_) {
     TF_LITE_ENSURE_STATUS(memory_planner_->ReleaseNonPersistentMemory());
@@ -854,9 +993,41 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
     EnsureTensorsVectorCapacity();
-    if (OpPrepare(registration, &node) != kTfLiteOk) {
-      return ReportOpError(&context_, node, registration, node_index,
-                           "failed to prepare");
+    // After only inputs were resized, the nodes none of whose inputs changed
+    // shape are left as they were last prepared, and the outputs of the others
+    // are marked resized in turn if their shapes change.
+    const bool only_inputs_resized = state_ == kStateInputsResized;
+    if (!only_inputs_resized || IsAnyTensorResized(node.inputs)) {
+      std::vector<std::vector<int>> output_dims;
+      if (only_inputs_resized) {
+        for (int i = 0; i < node.outputs->size; ++i) {
+          const int tensor_index = node.outputs->data[i];
+          const TfLiteIntArray* dims =
+              tensor_index != kTfLiteOptionalTensor
+                  ? context_.tensors[tensor_index].dims
+                  : nullptr;
+          output_dims.push_back(dims ? std::vector<int>(dims->data,
+                                                        dims->data + dims->size)
+                                     : std::vector<int>());
+        }
+      }
+      if (OpPrepare(registration, &node) != kTfLiteOk) {
+        return ReportOpError(&context_, node, registration, node_index,
+                             "failed to prepare");
+      }
+      for (int i = 0; i < output_dims.size(); ++i) {
+        const int tensor_index = node.outputs->data[i];
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        const TfLiteIntArray* dims = context_.tensors[tensor_index].dims;
+        if (dims == nullptr ||
+            !EqualArrayAndTfLiteIntArray(dims, output_dims[i].size(),
+                                         output_dims[i].data())) {
+          if (tensor_index >= resized_tensors_.size()) {
+            resized_tensors_.resize(tensor_index + 1, false);
+          }
+          resized_tensors_[tensor_index] = true;
+        }
+      }
     }
 
     *last_execution_plan_index_prepared = execution_plan_index;
@@ -874,10 +1045,14 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
 
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   if (!memory_planner_) {
-    memory_planner_.reset(new ArenaPlanner(
+    ArenaPlanner* arena_planner = new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
         /*preserve_inputs=*/true, /*preserve_intermediates*/ false,
-        kDefaultTensorAlignment));
+        kDefaultTensorAlignment);
+    arena_planner->SetOfflineOffsets(offline_arena_offsets_);
+    arena_planner->SetCompareOrderings(compare_arena_orderings_);
+    memory_planner_.reset(arena_planner);
+    PlanInterOpWaves();
     memory_planner_->PlanAllocations();
   }
 
@@ -941,7 +1116,7 @@ TfLiteStatus Subgraph::Invoke() {
   }
 
   TfLiteStatus status = kTfLiteOk;
-  if (state_ == kStateUninvokable) {
+  if (state_ == kStateUninvokable || state_ == kStateInputsResized) {
     ReportError("Invoke called on model that is not ready.");
     return kTfLiteError;
   } else if (memory_planner_ && !memory_planner_->HasNonPersistentMemory()) {
@@ -956,6 +1131,12 @@ TfLiteStatus Subgraph::Invoke() {
     applied_nnapi_delegate_ = true;
   }
 
+  if (!inter_op_wave_starts_.empty() && !has_dynamic_tensors_ &&
+      !profiler_ &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size()) {
+    return InvokeInterOpWaves();
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1029,6 +1210,200 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+TfLiteStatus Subgraph::SetNumInterOpThreads(int num_threads) {
+  if (num_threads < 1) {
+    ReportError("num_threads should be >= 1 to set inter-op threads.");
+    return kTfLiteError;
+  }
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError("SetNumInterOpThreads is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  inter_op_thread_pool_.reset();
+  inter_op_cpu_backend_contexts_.clear();
+  if (num_threads > 1) {
+    inter_op_thread_pool_.reset(new InterOpThreadPool(num_threads));
+    for (int i = 1; i < num_threads; ++i) {
+      inter_op_cpu_backend_contexts_.emplace_back(
+          new ExternalCpuBackendContext());
+    }
+  }
+  // The memory plan depends on which nodes run concurrently.
+  inter_op_wave_starts_.clear();
+  inter_op_wave_of_node_.clear();
+  state_ = kStateUninvokable;
+  if (memory_planner_) {
+    PlanInterOpWaves();
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::SetOfflineArenaOffsets(std::vector<int32_t> offsets) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(
+        "SetOfflineArenaOffsets is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  offline_arena_offsets_ = std::move(offsets);
+  if (memory_planner_) {
+    // The memory planner of a subgraph is always an ArenaPlanner.
+    static_cast<ArenaPlanner*>(memory_planner_.get())
+        ->SetOfflineOffsets(offline_arena_offsets_);
+    state_ = kStateUninvokable;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::SetCompareArenaOrderings(bool compare_orderings) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(
+        "SetCompareArenaOrderings is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  compare_arena_orderings_ = compare_orderings;
+  if (memory_planner_) {
+    static_cast<ArenaPlanner*>(memory_planner_.get())
+        ->SetCompareOrderings(compare_arena_orderings_);
+    state_ = kStateUninvokable;
+  }
+  return kTfLiteOk;
+}
+
+std::vector<int32_t> Subgraph::GetArenaOffsets() {
+  if (!memory_planner_) {
+    return std::vector<int32_t>(tensors_size(), -1);
+  }
+  return static_cast<ArenaPlanner*>(memory_planner_.get())->GetArenaOffsets();
+}
+
+void Subgraph::PlanInterOpWaves() {
+  inter_op_wave_starts_.clear();
+  inter_op_wave_of_node_.clear();
+  if (!inter_op_thread_pool_ || execution_plan_.empty()) return;
+
+  // A node goes in the wave after the last one that produces any of its
+  // inputs or outputs. Nodes that must keep their order also go after the
+  // last such node.
+  std::vector<int> producer_wave(tensors_.size(), -1);
+  int last_ordered_wave = -1;
+  std::vector<int> wave_of_node(execution_plan_.size());
+  int num_waves = 0;
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    const auto& node_and_reg = nodes_and_registration_[execution_plan_[i]];
+    const TfLiteNode& node = node_and_reg.first;
+    int wave = 0;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      wave = std::max(wave, producer_wave[tensor_index] + 1);
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      wave = std::max(wave, producer_wave[tensor_index] + 1);
+    }
+    const bool ordered =
+        RunsInPlanOrder(context_, node, node_and_reg.second);
+    if (ordered) {
+      wave = std::max(wave, last_ordered_wave + 1);
+      last_ordered_wave = wave;
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      producer_wave[tensor_index] = wave;
+    }
+    wave_of_node[i] = wave;
+    num_waves = std::max(num_waves, wave + 1);
+  }
+
+  // Sort the execution plan by wave, which keeps it in dependency order, so
+  // that the nodes of each wave are contiguous.
+  std::vector<int> order(execution_plan_.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return wave_of_node[a] < wave_of_node[b];
+  });
+  std::vector<int> sorted_plan;
+  sorted_plan.reserve(execution_plan_.size());
+  inter_op_wave_of_node_.reserve(execution_plan_.size());
+  for (int i : order) {
+    sorted_plan.push_back(execution_plan_[i]);
+    inter_op_wave_of_node_.push_back(wave_of_node[i]);
+  }
+  execution_plan_ = std::move(sorted_plan);
+
+  inter_op_wave_starts_.reserve(num_waves + 1);
+  for (int i = 0; i < inter_op_wave_of_node_.size(); ++i) {
+    if (i == 0 || inter_op_wave_of_node_[i] != inter_op_wave_of_node_[i - 1]) {
+      inter_op_wave_starts_.push_back(i);
+    }
+  }
+  inter_op_wave_starts_.push_back(execution_plan_.size());
+}
+
+TfLiteStatus Subgraph::InvokeInterOpWaves() {
+  std::vector<TfLiteStatus> statuses;
+  for (int wave = 0; wave + 1 < inter_op_wave_starts_.size(); ++wave) {
+    const int first_index = inter_op_wave_starts_[wave];
+    const int num_nodes = inter_op_wave_starts_[wave + 1] - first_index;
+
+    // Copying data out of delegate buffers, and checking for cancellation,
+    // happen on this thread before the nodes of the wave run.
+    for (int execution_plan_index = first_index;
+         execution_plan_index < first_index + num_nodes;
+         ++execution_plan_index) {
+      const TfLiteNode& node =
+          nodes_and_registration_[execution_plan_[execution_plan_index]].first;
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        TfLiteTensor* tensor = &tensors_[tensor_index];
+        if (tensor->delegate && tensor->delegate != node.delegate &&
+            tensor->data_is_stale) {
+          TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+        }
+      }
+    }
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    EnsureTensorsVectorCapacity();
+    statuses.assign(num_nodes, kTfLiteOk);
+    inter_op_thread_pool_->Run(num_nodes, [&](int task, int worker) {
+      auto& node_and_reg =
+          nodes_and_registration_[execution_plan_[first_index + task]];
+      TfLiteExternalContext* previous_context = inter_op_cpu_backend_context;
+      if (worker > 0) {
+        inter_op_cpu_backend_context =
+            inter_op_cpu_backend_contexts_[worker - 1].get();
+      }
+      statuses[task] = OpInvoke(node_and_reg.second, &node_and_reg.first);
+      inter_op_cpu_backend_context = previous_context;
+    });
+    for (int task = 0; task < num_nodes; ++task) {
+      if (statuses[task] != kTfLiteOk) {
+        const int node_index = execution_plan_[first_index + task];
+        auto& node_and_reg = nodes_and_registration_[node_index];
+        return ReportOpError(&context_, node_and_reg.first,
+                             node_and_reg.second, node_index,
+                             "failed to invoke");
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+void Subgraph::RefreshInterOpCpuBackendContexts() {
+  if (context_.recommended_num_threads == -1) return;
+  for (auto& cpu_backend_context : inter_op_cpu_backend_contexts_) {
+    if (cpu_backend_context->internal_backend_context()) {
+      cpu_backend_context->internal_backend_context()->SetMaxNumThreads(
+          context_.recommended_num_threads);
+    }
+  }
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1236,6 +1611,9 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  // The waves are planned again along with the allocations.
+  inter_op_wave_starts_.clear();
+  inter_op_wave_of_node_.clear();
   return kTfLiteOk;
 }
 
@@ -1340,6 +1718,8 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  inter_op_wave_starts_.clear();
+  inter_op_wave_of_node_.clear();
 
   // Delegate nodes are appended to nodes_and_registration_. Therefore,
   // cleanup nodes_and_registration_ to only contain nodes from
@@ -1397,6 +1777,7 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    PlanInterOpWaves();
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
@@ -1416,6 +1797,10 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegate(TfLiteDelegate* delegate) {
         "ModifyGraphWithDelegate is disallowed when graph is immutable.");
     return kTfLiteError;
   }
+  // The delegate changes the nodes, so they all need to be prepared again.
+  if (state_ == kStateInputsResized) {
+    state_ = kStateUninvokable;
+  }
 
   if (!(delegate->flags & kTfLiteDelegateFlagsAllowDynamicTensors)) {
     int last_execution_plan_index_prepared;
@@ -24,9 +24,11 @@ limitations under the License.
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/util.h"
 
@@ -40,10 +42,12 @@ namespace impl {
 
 // Forward declare since NNAPIDelegate uses Interpreter.
 class NNAPIDelegate;
+class InterpreterInfo;
 
 class Subgraph {
  public:
   friend class Interpreter;
+  friend class InterpreterInfo;
 
   Subgraph(ErrorReporter* error_reporter,
            TfLiteExternalContext** external_contexts,
@@ -231,6 +235,24 @@ class Subgraph {
   TfLiteStatus ResizeInputTensorStrict(int tensor_index,
                                        const std::vector<int>& dims);
 
+  // If true, AllocateTensors() after input tensors were resized, and nothing
+  // else about the graph changed, only re-prepares the nodes whose input
+  // shapes changed, transitively, instead of every node. Nodes none of whose
+  // inputs changed keep their outputs and temporaries, so their kernels must
+  // not depend on being prepared again. The arena is still replanned.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetIncrementalResize(bool incremental_resize);
+
+  // Sets the largest shape the input tensor `tensor_index` will be resized to.
+  // The next call to AllocateTensors() first plans the arena with every input
+  // at its upper bound, so that it is allocated at its largest size once, and
+  // resizing inputs within their bounds afterwards doesn't reallocate it.
+  // Inputs may still be resized beyond their bounds, at the cost of growing
+  // the arena.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetInputTensorUpperBound(int tensor_index,
+                                        const std::vector<int>& dims);
+
   // This releases memory held by non-persistent tensors. It does NOT re-perform
   // memory planning.
   // AllocateTensors needs to be called before next invocation.
@@ -276,6 +298,43 @@ class Subgraph {
   // WARNING: This is an experimental API and subject to change.
   void SetCancellationFunction(void* data, bool (*check_cancelled_func)(void*));
 
+  // Sets the number of threads that run nodes that don't depend on each other
+  // concurrently, in waves: each wave holds the nodes whose inputs have all
+  // been computed by the previous waves. With 1 thread (the default), nodes
+  // run one after the other. Nodes that use variable or resource tensors,
+  // control flow, custom and delegate nodes keep their relative order. The
+  // waves are only used for graphs without dynamic tensors and without a
+  // profiler; other graphs run one node after the other.
+  //
+  // Each extra thread uses its own cpu backend context, so every node may
+  // still use up to the number of threads set by
+  // Interpreter::SetNumThreads() for itself. The memory planned for the
+  // subgraph grows, since tensors used by nodes of the same wave can't share
+  // memory. Takes effect at the next call to AllocateTensors().
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetNumInterOpThreads(int num_threads);
+
+  // Places each tensor with a non-negative entry in `offsets`, indexed by
+  // tensor, at that offset of the arena, e.g. as cached in the model by
+  // GetArenaOffsets() ahead of time, so that a plan that is costly to find
+  // doesn't need to be found again. Tensors the offset doesn't suit anymore
+  // are planned as usual. Takes effect at the next call to AllocateTensors().
+  // See ArenaPlanner::SetOfflineOffsets().
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetOfflineArenaOffsets(std::vector<int32_t> offsets);
+
+  // If true, the memory plan also tries a greedy-by-breadth ordering of the
+  // tensors, and keeps it if it needs less memory than the default
+  // greedy-by-size one. Takes effect at the next call to AllocateTensors().
+  // See ArenaPlanner::SetCompareOrderings().
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetCompareArenaOrderings(bool compare_orderings);
+
+  // Returns the offset of each tensor in the arena planned by the last call
+  // to AllocateTensors(), or -1 for tensors that aren't in it.
+  // WARNING: This is an experimental API and subject to change.
+  std::vector<int32_t> GetArenaOffsets();
+
   // Ensure the data in `tensor.data` is readable. In case delegate is used,
   // it might require to copy the data from delegate buffer to raw memory.
   // WARNING: This is an experimental API and subject to change.
@@ -596,9 +655,31 @@ class Subgraph {
   // Ensures the memory required is planned and allocated.
   TfLiteStatus EnsureMemoryAllocations();
 
+  // If inter-op threads are set, sorts the execution plan into waves of nodes
+  // that may run concurrently. Must be called before planning allocations,
+  // which depend on the waves.
+  void PlanInterOpWaves();
+
+  // Runs the nodes of each wave concurrently on the inter-op thread pool.
+  TfLiteStatus InvokeInterOpWaves();
+
+  // Sets the number of threads of the cpu backend contexts of the inter-op
+  // threads that have been created, like Interpreter::SetNumThreads() does
+  // for the interpreter's own context.
+  void RefreshInterOpCpuBackendContexts();
+
   // Returns true if cancellation function returns true.
   bool IsCancelled();
 
+  // Returns true if any of `tensors` was resized since the subgraph was last
+  // prepared, see kStateInputsResized.
+  bool IsAnyTensorResized(const TfLiteIntArray* tensors) const;
+
+  // Prepares the nodes and plans the arena with each input that has an upper
+  // bound resized to it, and then resizes the inputs back, so that the arena
+  // is allocated at its largest size. See SetInputTensorUpperBound().
+  TfLiteStatus PlanInputUpperBounds();
+
   // The state of the Interpreter.
   enum State {
     // The interpreter isn't ready to be invoked.
@@ -611,6 +692,11 @@ class Subgraph {
     // `ModifyGraphWithDelegate` and the delegate doesn't support dynamic
     // tensors.
     kStateInvokableAndImmutable,
+    // The interpreter isn't ready to be invoked, but only input tensors were
+    // resized since it was, and incremental resizes are enabled. The tensors
+    // resized since are marked in `resized_tensors_`, so that
+    // `AllocateTensors` only prepares the nodes they affect.
+    kStateInputsResized,
   };
   State state_ = kStateUninvokable;
 
@@ -703,6 +789,21 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // See SetOfflineArenaOffsets() and SetCompareArenaOrderings().
+  std::vector<int32_t> offline_arena_offsets_;
+  bool compare_arena_orderings_ = false;
+
+  // See SetIncrementalResize().
+  bool incremental_resize_ = false;
+  // Whether each tensor was resized since the subgraph was last prepared,
+  // indexed by tensor. Only used in kStateInputsResized.
+  std::vector<bool> resized_tensors_;
+
+  // See SetInputTensorUpperBound(), and whether the arena was planned for the
+  // current bounds yet.
+  std::map<int, std::vector<int>> input_upper_bounds_;
+  bool input_upper_bounds_planned_ = false;
+
   // Contains <tensor idx, custom allocation> pairs for all applicable tensors.
   std::vector<std::pair<int, TfLiteCustomAllocation>> custom_allocations_;
 
@@ -734,6 +835,22 @@ class Subgraph {
 
   // A map of resources. Owned by interpreter and shared by multiple subgraphs.
   resource::ResourceMap* resources_ = nullptr;
+
+  // The threads that run the nodes of a wave, see SetNumInterOpThreads(). Null
+  // if nodes run one after the other.
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+
+  // The cpu backend contexts used by inter-op threads 1 and up, instead of the
+  // interpreter's. Thread 0 is the one calling Invoke().
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      inter_op_cpu_backend_contexts_;
+
+  // The execution plan index of the first node of each wave, followed by the
+  // size of the execution plan. Empty if there is no inter-op thread pool.
+  std::vector<int> inter_op_wave_starts_;
+
+  // The wave of each execution plan index.
+  std::vector<int> inter_op_wave_of_node_;
 };
 
 }  // namespace impl
@@ -125,7 +125,7 @@ int main(int argc, char** argv) {
     std::cerr << "Failed to build GPU inference." << std::endl;
     return -1;
   }
-  TfLiteGpuDelegateOptionsV2 options;
+  TfLiteGpuDelegateOptionsV2 options = TfLiteGpuDelegateOptionsV2Default();
   options.is_precision_loss_allowed = -1;
   options.inference_preference =
       TFLITE_GPU_INFERENCE_PREFERENCE_FAST_SINGLE_ANSWER;
@@ -94,6 +94,39 @@ class Delegate {
   }
   int num_delegate_kernels() const { return num_delegate_kernels_; }
 
+  absl::Status BindBufferToTensor(int tensor_index, TensorObject object) {
+    const ObjectType type = GetType(object);
+    auto it = bound_objects_.find(tensor_index);
+    if (is_graph_modified_) {
+      // The object definitions are fixed once the kernels are built.
+      if (it == bound_objects_.end() || GetType(it->second) != type) {
+        return absl::FailedPreconditionError(
+            "Only tensors bound before ModifyGraphWithDelegate can be "
+            "re-bound, to buffers of the same kind");
+      }
+    } else if (!bound_objects_.empty() && BoundObjectType() != type) {
+      return absl::InvalidArgumentError(
+          "OpenCL and OpenGL buffers can't be bound at the same time");
+    }
+    bound_objects_[tensor_index] = object;
+    return absl::OkStatus();
+  }
+
+  // Returns the kind of buffers bound to tensors, or ObjectType::UNKNOWN when
+  // there are none.
+  ObjectType BoundObjectType() const {
+    return bound_objects_.empty() ? ObjectType::UNKNOWN
+                                  : GetType(bound_objects_.begin()->second);
+  }
+
+  // Returns the buffer bound to the tensor, or nullptr.
+  const TensorObject* GetBoundObject(int tensor_index) const {
+    auto it = bound_objects_.find(tensor_index);
+    return it == bound_objects_.end() ? nullptr : &it->second;
+  }
+
+  void MarkGraphModified() { is_graph_modified_ = true; }
+
  private:
   TfLiteDelegate delegate_ = {
       .data_ = reinterpret_cast<void*>(this),
@@ -106,6 +139,9 @@ class Delegate {
 
   TfLiteGpuDelegateOptionsV2 options_;
   int num_delegate_kernels_ = 0;
+  // GPU buffers bound to input and output tensors, by tensor index.
+  absl::flat_hash_map<int, TensorObject> bound_objects_;
+  bool is_graph_modified_ = false;
 
   friend class DelegateKernel;
 };
@@ -133,10 +169,21 @@ class DelegateKernel {
     std::unique_ptr<InferenceBuilder> builder;
     bool graph_is_destroyed;
     const int experimental_flags = delegate_->options().experimental_flags;
-    if (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY) {
+    // Bound buffers can only be used by the backend of their kind.
+    const ObjectType bound_type = delegate_->BoundObjectType();
+    if ((bound_type == ObjectType::OPENCL_BUFFER &&
+         (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY)) ||
+        (bound_type == ObjectType::OPENGL_SSBO &&
+         (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY))) {
+      return absl::InvalidArgumentError(
+          "Bound buffers don't match the backend set by experimental_flags");
+    }
+    if ((experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY) ||
+        bound_type == ObjectType::OPENCL_BUFFER) {
       RETURN_IF_ERROR(
           InitializeOpenClApi(&graph, &builder, &graph_is_destroyed));
-    } else if (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY) {
+    } else if ((experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY) ||
+               bound_type == ObjectType::OPENGL_SSBO) {
       RETURN_IF_ERROR(InitializeOpenGlApi(&graph, &builder));
     } else {
       // By default, we try CL first & fall back to GL if that fails.
@@ -245,10 +292,16 @@ class DelegateKernel {
     default_object_def.data_layout = DataLayout::BHWC;
     default_object_def.object_type = ObjectType::CPU_MEMORY;
     default_object_def.user_provided = true;
+    if (const TensorObject* bound_object = delegate_->GetBoundObject(index)) {
+      default_object_def.object_type = GetType(*bound_object);
+    }
     return default_object_def;
   }
 
   TensorObject GetTensorObject(int index, TfLiteContext* context) const {
+    if (const TensorObject* bound_object = delegate_->GetBoundObject(index)) {
+      return *bound_object;
+    }
     auto& tensor = context->tensors[index];
     return MakeCpuMemory(absl::MakeSpan(tensor.data.raw, tensor.bytes));
   }
@@ -287,11 +340,17 @@ class DelegateKernel {
                                    std::unique_ptr<InferenceBuilder>* builder,
                                    bool* graph_is_destroyed) {
     *graph_is_destroyed = false;
+    auto delegate_options = delegate_->options();
     cl::InferenceEnvironmentOptions env_options;
+    env_options.device =
+        reinterpret_cast<cl_device_id>(delegate_options.cl_device);
+    env_options.context =
+        reinterpret_cast<cl_context>(delegate_options.cl_context);
+    env_options.command_queue =
+        reinterpret_cast<cl_command_queue>(delegate_options.cl_command_queue);
     cl::InferenceEnvironmentProperties properties;
     RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
                                                 &properties));
-    auto delegate_options = delegate_->options();
     cl::InferenceOptions options;
     // If is_precision_loss_allowed == -1, then just use priorities instead
     // of paying attention to is_precision_loss_allowed value.
@@ -424,6 +483,7 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   };
 
   auto* gpu_delegate = GetDelegate(delegate);
+  gpu_delegate->MarkGraphModified();
   TfLiteIntArray* ops_to_replace =
       GetOpsToReplace(context, gpu_delegate->IsQuantOpsAllowed(),
                       gpu_delegate->MaxDelegatedPartitions());
@@ -450,6 +510,9 @@ TfLiteGpuDelegateOptionsV2 TfLiteGpuDelegateOptionsV2Default() {
       .inference_priority3 = TFLITE_GPU_INFERENCE_PRIORITY_AUTO,
       .experimental_flags = TFLITE_GPU_EXPERIMENTAL_FLAGS_NONE,
       .max_delegated_partitions = 1,
+      .cl_device = nullptr,
+      .cl_context = nullptr,
+      .cl_command_queue = nullptr,
   };
   return options;
 }
@@ -465,3 +528,41 @@ TfLiteDelegate* TfLiteGpuDelegateV2Create(
 void TfLiteGpuDelegateV2Delete(TfLiteDelegate* delegate) {
   delete tflite::gpu::GetDelegate(delegate);
 }
+
+TfLiteStatus TfLiteGpuDelegateV2BindOpenClBufferToTensor(
+    TfLiteDelegate* delegate, void* cl_buffer, int tensor_index) {
+  auto* gpu_delegate = tflite::gpu::GetDelegate(delegate);
+  if (!gpu_delegate || !cl_buffer) {
+    return kTfLiteError;
+  }
+  const auto status = gpu_delegate->BindBufferToTensor(
+      tensor_index,
+      tflite::gpu::OpenClBuffer(reinterpret_cast<cl_mem>(cl_buffer)));
+  if (!status.ok()) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR, "TfLiteGpuDelegate Bind: %s",
+                    std::string(status.message()).c_str());
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus TfLiteGpuDelegateV2BindGlBufferToTensor(TfLiteDelegate* delegate,
+                                                     uint32_t gl_buffer_id,
+                                                     int tensor_index) {
+#ifdef CL_DELEGATE_NO_GL
+  return kTfLiteError;
+#else
+  auto* gpu_delegate = tflite::gpu::GetDelegate(delegate);
+  if (!gpu_delegate) {
+    return kTfLiteError;
+  }
+  const auto status = gpu_delegate->BindBufferToTensor(
+      tensor_index, tflite::gpu::OpenGlBuffer(gl_buffer_id));
+  if (!status.ok()) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR, "TfLiteGpuDelegate Bind: %s",
+                    std::string(status.message()).c_str());
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+#endif
+}
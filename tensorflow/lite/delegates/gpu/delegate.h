@@ -100,6 +100,16 @@ typedef struct {
   // This limits the maximum number of partitions to be delegated. By default,
   // it's set to 1 in TfLiteGpuDelegateOptionsV2Default().
   int32_t max_delegated_partitions;
+
+  // [Optional]
+  // A cl_device_id, a cl_context on it and an in-order cl_command_queue of that
+  // context, which the OpenCL backend then uses instead of creating its own.
+  // They must outlive the delegate. Buffers bound with
+  // TfLiteGpuDelegateV2BindOpenClBufferToTensor must belong to this context,
+  // and the caller synchronizes with the inference through this queue.
+  void* cl_device;
+  void* cl_context;
+  void* cl_command_queue;
 } TfLiteGpuDelegateOptionsV2;
 
 // Populates TfLiteGpuDelegateOptionsV2 as follows:
@@ -108,6 +118,7 @@ typedef struct {
 //   priority1 = TFLITE_GPU_INFERENCE_PRIORITY_MAX_PRECISION
 //   priority2 = TFLITE_GPU_INFERENCE_PRIORITY_AUTO
 //   priority3 = TFLITE_GPU_INFERENCE_PRIORITY_AUTO
+//   cl_device = cl_context = cl_command_queue = nullptr
 TFL_CAPI_EXPORT TfLiteGpuDelegateOptionsV2 TfLiteGpuDelegateOptionsV2Default();
 
 // Creates a new delegate instance that need to be destroyed with
@@ -123,6 +134,33 @@ TFL_CAPI_EXPORT TfLiteDelegate* TfLiteGpuDelegateV2Create(
 // Destroys a delegate created with `TfLiteGpuDelegateV2Create` call.
 TFL_CAPI_EXPORT void TfLiteGpuDelegateV2Delete(TfLiteDelegate* delegate);
 
+// Binds an OpenCL buffer (a cl_mem created in `cl_context` of the options) to
+// an input or an output float tensor of the delegated graph, so that the
+// delegate reads or writes it directly instead of copying the tensor's CPU
+// memory from or to the GPU. The buffer holds the tensor in BHWC layout, like
+// its CPU memory, which the delegate then neither reads nor writes.
+//
+// When all outputs are bound, Invoke() returns as soon as the inference is
+// enqueued, without waiting for the GPU. Work that the caller enqueues on
+// `cl_command_queue` before and after Invoke() is ordered with the inference,
+// and an event for its completion can be had with clEnqueueMarkerWithWaitList.
+// Frames can be pipelined by re-binding the tensors to other buffers for the
+// next Invoke().
+//
+// Tensors must first be bound *before* `Interpreter::ModifyGraphWithDelegate`,
+// which then uses the OpenCL backend. After it, only those tensors can be
+// re-bound, to buffers of the same kind.
+TFL_CAPI_EXPORT TfLiteStatus TfLiteGpuDelegateV2BindOpenClBufferToTensor(
+    TfLiteDelegate* delegate, void* cl_buffer, int tensor_index);
+
+// Same as TfLiteGpuDelegateV2BindOpenClBufferToTensor, for an OpenGL shader
+// storage buffer, which makes `Interpreter::ModifyGraphWithDelegate` use the
+// OpenGL backend. The EGL context that owns the buffer must be current when
+// the graph is modified and invoked, and the caller synchronizes with the
+// inference through it, e.g. with glFenceSync after Invoke().
+TFL_CAPI_EXPORT TfLiteStatus TfLiteGpuDelegateV2BindGlBufferToTensor(
+    TfLiteDelegate* delegate, uint32_t gl_buffer_id, int tensor_index);
+
 #ifdef __cplusplus
 }
 #endif  // __cplusplus
@@ -166,6 +166,13 @@ class DepthwiseConv2DTester {
 
   inline bool SparseWeights() const { return sparse_weights_; }
 
+  inline DepthwiseConv2DTester& INT8Weights() {
+    int8_weights_ = true;
+    return *this;
+  }
+
+  inline bool INT8Weights() const { return int8_weights_; }
+
   inline DepthwiseConv2DTester& SamePadding() {
     padding_ = ::tflite::Padding_SAME;
     return *this;
@@ -225,6 +232,7 @@ class DepthwiseConv2DTester {
   int32_t dilation_width_ = 1;
   bool fp16_weights_ = false;
   bool sparse_weights_ = false;
+  bool int8_weights_ = false;
   ::tflite::Padding padding_ = ::tflite::Padding_VALID;
   ::tflite::ActivationFunctionType activation_ =
       ::tflite::ActivationFunctionType_NONE;
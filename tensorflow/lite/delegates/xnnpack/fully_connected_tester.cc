@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/xnnpack/fully_connected_tester.h"
 
 #include <array>
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <numeric>
@@ -100,9 +101,14 @@ void FullyConnectedTester::Test(TfLiteDelegate* delegate) const {
   float* delegate_output_data = delegate_interpreter->typed_tensor<float>(
       delegate_interpreter->outputs()[0]);
 
+  // With dynamic-range quantization, TFLite also quantizes the input, while
+  // XNNPACK computes on dequantized weights in FP32.
+  const float relative_tolerance = DynamicRangeQuantization()
+                                       ? 2.0e-3f
+                                       : std::numeric_limits<float>::epsilon();
   for (size_t i = 0; i < ComputeSize(OutputShape()); i++) {
     ASSERT_NEAR(default_output_data[i], delegate_output_data[i],
-                std::numeric_limits<float>::epsilon() *
+                relative_tolerance *
                     std::max(std::abs(default_output_data[i]) * 10.0f, 1.0f));
   }
 }
@@ -119,6 +125,7 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
   std::vector<flatbuffers::Offset<Operator>> operators;
   std::vector<flatbuffers::Offset<Buffer>> buffers{
       {CreateBuffer(builder, builder.CreateVector({}))}};
+  float filter_scale = 1.0f;
 
   if (FP16Weights()) {
     operator_codes.emplace_back(
@@ -191,14 +198,46 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
       }
     }
 
-    buffers.emplace_back(CreateBuffer(
-        builder, builder.CreateVector(
-                     reinterpret_cast<const uint8_t*>(filter_data.data()),
-                     sizeof(float) * filter_data.size())));
+    if (INT8Weights() || DynamicRangeQuantization()) {
+      // Quantize the filter symmetrically, with a single scale.
+      float max_abs_filter = 0.0f;
+      for (float value : filter_data) {
+        max_abs_filter = std::max(max_abs_filter, std::abs(value));
+      }
+      filter_scale = std::max(max_abs_filter, 1.0f) / 127.0f;
+      std::vector<int8_t> quantized_filter_data(filter_data.size());
+      for (size_t i = 0; i < filter_data.size(); i++) {
+        quantized_filter_data[i] =
+            static_cast<int8_t>(std::lrint(filter_data[i] / filter_scale));
+      }
+      buffers.emplace_back(CreateBuffer(
+          builder, builder.CreateVector(reinterpret_cast<const uint8_t*>(
+                                            quantized_filter_data.data()),
+                                        quantized_filter_data.size())));
+    } else {
+      buffers.emplace_back(CreateBuffer(
+          builder, builder.CreateVector(
+                       reinterpret_cast<const uint8_t*>(filter_data.data()),
+                       sizeof(float) * filter_data.size())));
+    }
     buffers.emplace_back(CreateBuffer(
         builder,
         builder.CreateVector(reinterpret_cast<const uint8_t*>(bias_data.data()),
                              sizeof(float) * bias_data.size())));
+
+    if (INT8Weights()) {
+      operator_codes.emplace_back(
+          CreateOperatorCode(builder, BuiltinOperator_DEQUANTIZE));
+
+      const std::array<int32_t, 1> dequantize_filter_inputs{{0}};
+      const std::array<int32_t, 1> dequantize_filter_outputs{{2}};
+      operators.emplace_back(CreateOperator(
+          builder, /*opcode_index=*/1,
+          builder.CreateVector<int32_t>(dequantize_filter_inputs.data(),
+                                        dequantize_filter_inputs.size()),
+          builder.CreateVector<int32_t>(dequantize_filter_outputs.data(),
+                                        dequantize_filter_outputs.size())));
+    }
   }
 
   const std::array<int32_t, 2> filter_shape{
@@ -217,14 +256,37 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
         builder.CreateVector<int32_t>(bias_shape.data(), bias_shape.size()),
         TensorType_FLOAT16, /*buffer=*/2));
   }
+  const std::array<float, 1> filter_scales{{filter_scale}};
+  const std::array<int64_t, 1> filter_zero_points{{0}};
+  flatbuffers::Offset<QuantizationParameters> filter_quantization =
+      CreateQuantizationParameters(
+          builder, /*min=*/0, /*max=*/0,
+          builder.CreateVector<float>(filter_scales.data(),
+                                      filter_scales.size()),
+          builder.CreateVector<int64_t>(filter_zero_points.data(),
+                                        filter_zero_points.size()));
+  if (INT8Weights()) {
+    tensors.emplace_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
+        TensorType_INT8, /*buffer=*/1, /*name=*/0, filter_quantization));
+  }
   tensors.emplace_back(CreateTensor(
       builder,
       builder.CreateVector<int32_t>(InputShape().data(), InputShape().size()),
       TensorType_FLOAT32));
-  tensors.emplace_back(CreateTensor(
-      builder,
-      builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
-      TensorType_FLOAT32, /*buffer=*/FP16Weights() ? 0 : 1));
+  if (DynamicRangeQuantization()) {
+    tensors.emplace_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
+        TensorType_INT8, /*buffer=*/1, /*name=*/0, filter_quantization));
+  } else {
+    tensors.emplace_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
+        TensorType_FLOAT32,
+        /*buffer=*/FP16Weights() || INT8Weights() ? 0 : 1));
+  }
   tensors.emplace_back(CreateTensor(
       builder,
       builder.CreateVector<int32_t>(bias_shape.data(), bias_shape.size()),
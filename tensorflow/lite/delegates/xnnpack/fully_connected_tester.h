@@ -78,6 +78,22 @@ class FullyConnectedTester {
 
   inline bool FP16Weights() const { return fp16_weights_; }
 
+  inline FullyConnectedTester& INT8Weights() {
+    int8_weights_ = true;
+    return *this;
+  }
+
+  inline bool INT8Weights() const { return int8_weights_; }
+
+  inline FullyConnectedTester& DynamicRangeQuantization() {
+    dynamic_range_quantization_ = true;
+    return *this;
+  }
+
+  inline bool DynamicRangeQuantization() const {
+    return dynamic_range_quantization_;
+  }
+
   inline FullyConnectedTester& ReluActivation() {
     activation_ = ::tflite::ActivationFunctionType_RELU;
     return *this;
@@ -110,6 +126,8 @@ class FullyConnectedTester {
   int32_t output_channels_ = 1;
   bool keep_dims_ = false;
   bool fp16_weights_ = false;
+  bool int8_weights_ = false;
+  bool dynamic_range_quantization_ = false;
   ::tflite::ActivationFunctionType activation_ =
       ::tflite::ActivationFunctionType_NONE;
 };
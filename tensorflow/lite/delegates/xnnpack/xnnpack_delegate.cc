@@ -42,6 +42,82 @@ namespace {
 // Forward declaration.
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate);
 
+// Returns the per-channel affine quantization of `tensor`, or nullptr if it is
+// quantized per tensor (or not quantized at all).
+const TfLiteAffineQuantization* GetPerChannelQuantization(
+    const TfLiteTensor& tensor) {
+  if (tensor.quantization.type != kTfLiteAffineQuantization) {
+    return nullptr;
+  }
+  const auto* quantization = static_cast<const TfLiteAffineQuantization*>(
+      tensor.quantization.params);
+  if (quantization == nullptr || quantization->scale == nullptr ||
+      quantization->scale->size <= 1) {
+    return nullptr;
+  }
+  return quantization;
+}
+
+// Checks if `tensor` holds static INT8 weights with symmetric quantization, as
+// the hybrid kernels of dynamic-range quantized operators expect. Per-channel
+// quantization is accepted only along `quantized_dimension`, and not at all if
+// it is negative.
+bool IsDynamicRangeQuantizedWeights(const TfLiteTensor& tensor,
+                                    int quantized_dimension) {
+  if (tensor.type != kTfLiteInt8 || tensor.allocation_type != kTfLiteMmapRo ||
+      tensor.data.raw_const == nullptr || tensor.sparsity != nullptr) {
+    return false;
+  }
+  const TfLiteAffineQuantization* quantization =
+      GetPerChannelQuantization(tensor);
+  if (quantization == nullptr) {
+    return tensor.params.scale > 0.0f && tensor.params.zero_point == 0;
+  }
+  if (quantized_dimension < 0 ||
+      quantization->quantized_dimension != quantized_dimension ||
+      quantized_dimension >= tensor.dims->size ||
+      tensor.dims->data[quantized_dimension] != quantization->scale->size ||
+      quantization->zero_point == nullptr ||
+      quantization->zero_point->size != quantization->scale->size) {
+    return false;
+  }
+  for (int c = 0; c < quantization->scale->size; c++) {
+    if (quantization->scale->data[c] <= 0.0f ||
+        quantization->zero_point->data[c] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Dequantizes the INT8 or UINT8 data of a static tensor into FP32 `output`,
+// per channel if the tensor is quantized per channel, and per tensor otherwise.
+void DequantizeStaticTensor(const TfLiteTensor& tensor, float* output) {
+  const size_t num_elements = tensor.bytes;
+  const float* scales = &tensor.params.scale;
+  const int32_t* zero_points = &tensor.params.zero_point;
+  size_t num_channels = 1;
+  size_t channel_stride = 1;
+  const TfLiteAffineQuantization* quantization =
+      GetPerChannelQuantization(tensor);
+  if (quantization != nullptr) {
+    scales = quantization->scale->data;
+    zero_points = quantization->zero_point->data;
+    num_channels = quantization->scale->size;
+    for (int d = quantization->quantized_dimension + 1; d < tensor.dims->size;
+         d++) {
+      channel_stride *= tensor.dims->data[d];
+    }
+  }
+  for (size_t i = 0; i < num_elements; i++) {
+    const size_t c = (i / channel_stride) % num_channels;
+    const int32_t value = tensor.type == kTfLiteInt8
+                              ? static_cast<int32_t>(tensor.data.int8[i])
+                              : static_cast<int32_t>(tensor.data.uint8[i]);
+    output[i] = scales[c] * static_cast<float>(value - zero_points[c]);
+  }
+}
+
 class Delegate {
   friend class Subgraph;
 
@@ -187,7 +263,11 @@ class Subgraph {
     // XNNPACK Value IDs for TFLite tensors
     std::vector<uint32_t> xnnpack_tensors(tensors.back() + 1);
     for (int t : tensors) {
-      if (context->tensors[t].type != kTfLiteFloat32) {
+      // Quasi-static tensors, including dequantized INT8 weights, are
+      // represented with their unpacked FP32 data.
+      const auto it = delegate->static_unpacked_data_map_.find(t);
+      const bool is_unpacked = it != delegate->static_unpacked_data_map_.end();
+      if (!is_unpacked && context->tensors[t].type != kTfLiteFloat32) {
         TF_LITE_KERNEL_LOG(
             context,
             "unsupported datatype (%s) of tensor %d in XNNPACK delegate",
@@ -197,14 +277,10 @@ class Subgraph {
 
       uint32_t flags = 0;
       const void* data = nullptr;
-      if (context->tensors[t].allocation_type == kTfLiteMmapRo) {
+      if (is_unpacked) {
+        data = delegate->static_unpacked_data_.data() + it->second;
+      } else if (context->tensors[t].allocation_type == kTfLiteMmapRo) {
         data = context->tensors[t].data.raw_const;
-      } else {
-        // Check for quasi-static data.
-        const auto it = delegate->static_unpacked_data_map_.find(t);
-        if (it != delegate->static_unpacked_data_map_.end()) {
-          data = delegate->static_unpacked_data_.data() + it->second;
-        }
       }
       if (inputs.count(t) != 0) {
         flags |= XNN_VALUE_FLAG_EXTERNAL_INPUT;
@@ -625,6 +701,28 @@ class Subgraph {
                            node_index);
   }
 
+  // Filters may also be static INT8 weights of dynamic-range quantized
+  // operators, which the delegate dequantizes ahead of time. Per-channel
+  // quantization is supported only along `quantized_dimension`, if it is not
+  // negative.
+  static TfLiteStatus CheckFilterTensorType(TfLiteContext* context,
+                                            const TfLiteTensor& tensor,
+                                            int quantized_dimension,
+                                            int tensor_index, int node_index) {
+    if (tensor.type == kTfLiteInt8) {
+      if (!IsDynamicRangeQuantizedWeights(tensor, quantized_dimension)) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            context,
+            "unsupported quantization of INT8 tensor #%d in node #%d: "
+            "expected static symmetrically quantized weights",
+            tensor_index, node_index);
+        return kTfLiteError;
+      }
+      return kTfLiteOk;
+    }
+    return CheckTensorFloatType(context, tensor, tensor_index, node_index);
+  }
+
   static TfLiteStatus CheckTensorShape(TfLiteContext* context,
                                        const TfLiteTensor& tensor,
                                        int min_num_dims, int max_num_dims,
@@ -1205,8 +1303,9 @@ class Subgraph {
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckFilterTensorType(
+        logging_context, filter_tensor, /*quantized_dimension=*/0,
+        node->inputs->data[1], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 4,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1216,7 +1315,7 @@ class Subgraph {
 
     const TfLiteTensor& bias_tensor = tensors[node->inputs->data[2]];
     TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[2], node_index));
+        logging_context, bias_tensor, node->inputs->data[2], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, bias_tensor, 1,
                                            node->inputs->data[2]));
     if (quasi_static_tensors.count(node->inputs->data[2]) == 0) {
@@ -1293,8 +1392,9 @@ class Subgraph {
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckFilterTensorType(
+        logging_context, filter_tensor, /*quantized_dimension=*/3,
+        node->inputs->data[1], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 4,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1304,7 +1404,7 @@ class Subgraph {
 
     const TfLiteTensor& bias_tensor = tensors[node->inputs->data[2]];
     TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[2], node_index));
+        logging_context, bias_tensor, node->inputs->data[2], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, bias_tensor, 1,
                                            node->inputs->data[2]));
     if (quasi_static_tensors.count(node->inputs->data[2]) == 0) {
@@ -1438,8 +1538,9 @@ class Subgraph {
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckFilterTensorType(
+        logging_context, filter_tensor, /*quantized_dimension=*/-1,
+        node->inputs->data[1], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 2,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1449,7 +1550,7 @@ class Subgraph {
 
     const TfLiteTensor& bias_tensor = tensors[node->inputs->data[2]];
     TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[2], node_index));
+        logging_context, bias_tensor, node->inputs->data[2], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, bias_tensor, 1,
                                            node->inputs->data[2]));
     if (quasi_static_tensors.count(node->inputs->data[2]) == 0) {
@@ -1912,7 +2013,7 @@ class Subgraph {
 
     const TfLiteTensor& bias_tensor = tensors[node->inputs->data[2]];
     TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[2], node_index));
+        logging_context, bias_tensor, node->inputs->data[2], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, bias_tensor, 1,
                                            node->inputs->data[2]));
     if (quasi_static_tensors.count(node->inputs->data[2]) == 0) {
@@ -2809,6 +2910,9 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
   std::unordered_set<int> quasi_static_tensors;
   // Set of quasi-static tensors consumed by the delegated nodes.
   std::unordered_set<int> quasi_static_tensors_to_unpack;
+  // Set of static INT8 weights of dynamic-range quantized nodes, which are
+  // dequantized to FP32 ahead of time for the delegated nodes.
+  std::unordered_set<int> quantized_weights_to_unpack;
 
   TfLiteIntArray* nodes_to_delegate =
       TfLiteIntArrayCreate(execution_plan->size);
@@ -2827,15 +2931,21 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       continue;  // Soft error (skip this node).
     }
 
-    // Prepare to unpack FP16 tensors.
+    // Prepare to unpack FP16 tensors, and INT8 or UINT8 tensors quantized per
+    // tensor.
     if (registration->builtin_code == kTfLiteBuiltinDequantize &&
         node->inputs->size == 1 && node->outputs->size == 1) {
       const TfLiteTensor& input_tensor =
           context->tensors[node->inputs->data[0]];
       const TfLiteTensor& output_tensor =
           context->tensors[node->outputs->data[0]];
+      const bool is_quantized_per_tensor =
+          (input_tensor.type == kTfLiteInt8 ||
+           input_tensor.type == kTfLiteUInt8) &&
+          input_tensor.sparsity == nullptr &&
+          GetPerChannelQuantization(input_tensor) == nullptr;
       if (input_tensor.allocation_type == kTfLiteMmapRo &&
-          input_tensor.type == kTfLiteFloat16 &&
+          (input_tensor.type == kTfLiteFloat16 || is_quantized_per_tensor) &&
           output_tensor.type == kTfLiteFloat32) {
         static_unpack_nodes_.insert(i);
         quasi_static_tensors_producers[node->outputs->data[0]] = i;
@@ -2893,6 +3003,10 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       if (quasi_static_tensors.count(node->inputs->data[j]) != 0) {
         quasi_static_tensors_to_unpack.insert(node->inputs->data[j]);
       }
+      // The only INT8 inputs delegated nodes accept are static weights.
+      if (context->tensors[node->inputs->data[j]].type == kTfLiteInt8) {
+        quantized_weights_to_unpack.insert(node->inputs->data[j]);
+      }
     }
 
     nodes_to_delegate->data[nodes_to_delegate->size++] = node_index;
@@ -2959,7 +3073,9 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
         reinterpret_cast<float*>(static_unpacked_data_.data() + tensor_offset);
     switch (registration->builtin_code) {
       case kTfLiteBuiltinDequantize: {
-        if (input_tensor.type != kTfLiteFloat16) {
+        if (input_tensor.type != kTfLiteFloat16 &&
+            input_tensor.type != kTfLiteInt8 &&
+            input_tensor.type != kTfLiteUInt8) {
           TF_LITE_KERNEL_LOG(
               context, "unexpected tensor %d data type (%s) in node %d",
               node->inputs->data[0], TfLiteTypeGetName(input_tensor.type),
@@ -2969,13 +3085,17 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
         }
 
         if (input_tensor.sparsity != nullptr) {
-          TF_LITE_KERNEL_LOG(context,
-                             "unexpected FP16 sparse tensor %d in node %d",
+          TF_LITE_KERNEL_LOG(context, "unexpected sparse tensor %d in node %d",
                              node->inputs->data[0], producer_index);
           TfLiteIntArrayFree(nodes_to_delegate);
           return nullptr;  // Hard error.
         }
 
+        if (input_tensor.type != kTfLiteFloat16) {
+          DequantizeStaticTensor(input_tensor, unpacked_data);
+          break;
+        }
+
         const uint16_t* packed_data =
             static_cast<const uint16_t*>(input_tensor.data.data);
         for (size_t i = 0; i < tensor_elements; i++) {
@@ -3026,6 +3146,24 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
     static_unpacked_data_map_[t] = tensor_offset;
   }
 
+  // Dequantize static weights of dynamic-range quantized nodes. The original
+  // INT8 tensors stay in place for any nodes left to TFLite.
+  for (int t : quantized_weights_to_unpack) {
+    const TfLiteTensor& tensor = context->tensors[t];
+
+    // Align to XNN_EXTRA_BYTES bytes
+    while (static_unpacked_data_.size() % XNN_EXTRA_BYTES != 0) {
+      static_unpacked_data_.push_back(0);
+    }
+    const size_t tensor_offset = static_unpacked_data_.size();
+    static_unpacked_data_.resize(tensor_offset + tensor.bytes * sizeof(float));
+
+    float* unpacked_data =
+        reinterpret_cast<float*>(static_unpacked_data_.data() + tensor_offset);
+    DequantizeStaticTensor(tensor, unpacked_data);
+    static_unpacked_data_map_[t] = tensor_offset;
+  }
+
   // Add nodes that unpack static data consumed by delegated nodes.
   // Note: this is done purely to avoid the overhead of running these nodes
   // again in TFLite interpreter which would allocate memory for their outputs.
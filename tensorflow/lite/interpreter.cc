@@ -240,6 +240,15 @@ TfLiteStatus Interpreter::ResizeInputTensorStrict(
   return primary_subgraph().ResizeInputTensorStrict(tensor_index, dims);
 }
 
+TfLiteStatus Interpreter::SetIncrementalResize(bool incremental_resize) {
+  return primary_subgraph().SetIncrementalResize(incremental_resize);
+}
+
+TfLiteStatus Interpreter::SetInputTensorUpperBound(
+    int tensor_index, const std::vector<int>& dims) {
+  return primary_subgraph().SetInputTensorUpperBound(tensor_index, dims);
+}
+
 TfLiteStatus Interpreter::ReleaseNonPersistentMemory() {
   // TODO(b/138790287): We could do this for all subgraphs whose tensors have
   // been allocated. However, AllocateTensors() relies on Control Flow ops to
@@ -332,6 +341,7 @@ TfLiteStatus Interpreter::SetNumThreads(int num_threads) {
 
   for (auto& subgraph : subgraphs_) {
     subgraph->context()->recommended_num_threads = num_threads;
+    subgraph->RefreshInterOpCpuBackendContexts();
   }
 
   for (int i = 0; i < kTfLiteMaxExternalContexts; ++i) {
@@ -343,6 +353,10 @@ TfLiteStatus Interpreter::SetNumThreads(int num_threads) {
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::SetNumInterOpThreads(int num_threads) {
+  return primary_subgraph().SetNumInterOpThreads(num_threads);
+}
+
 void Interpreter::SetAllowFp16PrecisionForFp32(bool allow) {
   for (auto& subgraph : subgraphs_) {
     subgraph->context()->allow_fp32_relax_to_fp16 = allow;
@@ -342,6 +342,21 @@ class Interpreter {
   TfLiteStatus ResizeInputTensorStrict(int tensor_index,
                                        const std::vector<int>& dims);
 
+  /// Enable or disable incremental resizes of the primary subgraph. When
+  /// enabled, AllocateTensors() after only input tensors were resized
+  /// re-prepares just the nodes whose input shapes changed, instead of every
+  /// node. See Subgraph::SetIncrementalResize().
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetIncrementalResize(bool incremental_resize);
+
+  /// Set the largest shape an input tensor will be resized to, so that the
+  /// next AllocateTensors() allocates the arena for it at once, and resizing
+  /// the input within that bound afterwards doesn't reallocate the arena.
+  /// See Subgraph::SetInputTensorUpperBound().
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetInputTensorUpperBound(int tensor_index,
+                                        const std::vector<int>& dims);
+
   // This releases memory held by non-persistent tensors. It does NOT re-perform
   // memory planning.
   // AllocateTensors needs to be called before next invocation.
@@ -380,6 +395,17 @@ class Interpreter {
   /// available to itself.
   TfLiteStatus SetNumThreads(int num_threads);
 
+  /// Set the number of threads that run the nodes of the primary subgraph
+  /// that don't depend on each other concurrently, e.g. the branches of a
+  /// multi-tower model. Each of these threads may also use up to the number
+  /// of threads set by SetNumThreads() within an op. Takes effect at the next
+  /// call to AllocateTensors(). See Subgraph::SetNumInterOpThreads().
+  ///
+  /// NOTE: num_threads should be >= 1. The default of 1 runs nodes one after
+  /// the other.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetNumInterOpThreads(int num_threads);
+
   /// Allow float16 precision for FP32 calculation when possible.
   /// default: not allow.
   /// WARNING: This is an experimental API and subject to change.
@@ -21,7 +21,10 @@ limitations under the License.
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <cstring>
+
 #include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/arena_planner.h"
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -550,6 +553,44 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
   return status;
 }
 
+// Hands the arena offsets cached in the model's metadata, if any, to the
+// subgraphs they were planned for. A plan that doesn't match the model is
+// ignored, since the tensors are then planned at runtime as usual.
+void InterpreterBuilder::ParseArenaOffsets(Interpreter* interpreter) {
+  if (!model_->metadata() || !model_->buffers()) return;
+  for (const Metadata* metadata : *model_->metadata()) {
+    if (!metadata->name() ||
+        strcmp(metadata->name()->c_str(), kArenaOffsetsMetadataName) != 0 ||
+        metadata->buffer() >= model_->buffers()->size()) {
+      continue;
+    }
+    const Buffer* buffer = (*model_->buffers())[metadata->buffer()];
+    if (!buffer->data() || buffer->data()->size() < 3 * sizeof(int32_t)) {
+      TF_LITE_REPORT_ERROR(error_reporter_, "Ignoring truncated %s.\n",
+                           kArenaOffsetsMetadataName);
+      continue;
+    }
+    const size_t size = buffer->data()->size() / sizeof(int32_t);
+    std::vector<int32_t> values(size);
+    memcpy(values.data(), buffer->data()->data(), size * sizeof(int32_t));
+    const int32_t version = values[0];
+    const size_t subgraph_index = static_cast<uint32_t>(values[1]);
+    const size_t num_tensors = static_cast<uint32_t>(values[2]);
+    if (version != kArenaOffsetsMetadataVersion ||
+        subgraph_index >= interpreter->subgraphs_size() ||
+        num_tensors != interpreter->subgraph(subgraph_index)->tensors_size() ||
+        num_tensors != size - 3) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Ignoring %s that doesn't match the model.\n",
+                           kArenaOffsetsMetadataName);
+      continue;
+    }
+    interpreter->subgraph(subgraph_index)
+        ->SetOfflineArenaOffsets(
+            std::vector<int32_t>(values.begin() + 3, values.end()));
+  }
+}
+
 TfLiteStatus InterpreterBuilder::ApplyDelegates(Interpreter* interpreter,
                                                 int num_threads) {
   // Apply Flex delegate if applicable.
@@ -674,6 +715,8 @@ TfLiteStatus InterpreterBuilder::operator()(
     modified_subgraph->SetVariables(std::move(variables));
   }
 
+  ParseArenaOffsets(interpreter->get());
+
   if (num_fp32_tensors_ > 0) {
     (*interpreter)->lazy_delegate_provider_ =
         MaybeCreateXNNPACKDelegate(num_threads);
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <memory>
 
 #include <gmock/gmock.h>
@@ -1062,6 +1063,177 @@ TEST(BasicInterpreter, DynamicTensorsResizeDescendants) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 10 * 14);
 }
 
+TEST(BasicInterpreter, InterOpThreadsRunIndependentBranches) {
+  // Assemble two branches of two negate ops each, with the nodes of the first
+  // branch added before those of the second.
+  Interpreter interpreter;
+  interpreter.AddTensors(5);
+  interpreter.SetInputs({0});
+  interpreter.SetOutputs({2, 4});
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 5; ++i) {
+    interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {64},
+                                             quant);
+  }
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, neg_op);
+  interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, neg_op);
+  interpreter.AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr, neg_op);
+  interpreter.AddNodeWithParameters({3}, {4}, nullptr, 0, nullptr, neg_op);
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(0), kTfLiteError);
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The first op of each branch runs in the first wave, and the second op of
+  // each branch in the second one.
+  EXPECT_EQ(interpreter.execution_plan(), std::vector<int>({0, 2, 1, 3}));
+  // The intermediate tensors of the branches are alive at the same time.
+  EXPECT_NE(interpreter.tensor(1)->data.raw, interpreter.tensor(3)->data.raw);
+
+  for (int run = 0; run < 3; ++run) {
+    for (int i = 0; i < 64; ++i) {
+      interpreter.typed_tensor<float>(0)[i] = i + run;
+    }
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    for (int i = 0; i < 64; ++i) {
+      EXPECT_EQ(interpreter.typed_tensor<float>(1)[i], -(i + run));
+      EXPECT_EQ(interpreter.typed_tensor<float>(2)[i], i + run);
+      EXPECT_EQ(interpreter.typed_tensor<float>(3)[i], -(i + run));
+      EXPECT_EQ(interpreter.typed_tensor<float>(4)[i], i + run);
+    }
+  }
+
+  // Going back to a single thread keeps the results.
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(1), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  for (int i = 0; i < 64; ++i) {
+    interpreter.typed_tensor<float>(0)[i] = i + 2;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(interpreter.typed_tensor<float>(2)[5], 7);
+  EXPECT_EQ(interpreter.typed_tensor<float>(4)[5], 7);
+}
+
+// Adds a node that gives tensor `output` the shape of tensor `input` and copies
+// it, and returns the number of times it was prepared, which the interpreter
+// owns.
+int* AddPrepareCountingCopyNode(Interpreter* interpreter, int input,
+                                int output) {
+  TfLiteRegistration registration = {nullptr, nullptr, nullptr, nullptr};
+  registration.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    ++*static_cast<int*>(node->builtin_data);
+    const TfLiteTensor* input = GetInput(context, node, 0);
+    TfLiteTensor* output = GetOutput(context, node, 0);
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  registration.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = GetInput(context, node, 0);
+    TfLiteTensor* output = GetOutput(context, node, 0);
+    std::copy(input->data.f, input->data.f + NumElements(input),
+              output->data.f);
+    return kTfLiteOk;
+  };
+  // The interpreter frees the builtin data with free().
+  int* prepare_count = static_cast<int*>(malloc(sizeof(int)));
+  *prepare_count = 0;
+  EXPECT_EQ(interpreter->AddNodeWithParameters({input}, {output}, nullptr, 0,
+                                               prepare_count, &registration),
+            kTfLiteOk);
+  return prepare_count;
+}
+
+TEST(BasicInterpreter, IncrementalResizePreparesAffectedNodes) {
+  // Copies input 0 to tensor 2 and then to 3, and input 1 to tensor 4.
+  Interpreter interpreter;
+  interpreter.AddTensors(5);
+  interpreter.SetInputs({0, 1});
+  interpreter.SetOutputs({3, 4});
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 5; ++i) {
+    interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {2},
+                                             quant);
+  }
+  const int* first = AddPrepareCountingCopyNode(&interpreter, 0, 2);
+  const int* second = AddPrepareCountingCopyNode(&interpreter, 2, 3);
+  const int* third = AddPrepareCountingCopyNode(&interpreter, 1, 4);
+  ASSERT_EQ(interpreter.SetIncrementalResize(true), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(*first, 1);
+  EXPECT_EQ(*second, 1);
+  EXPECT_EQ(*third, 1);
+
+  // Only the nodes that depend on input 0 are prepared again.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {3}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(*first, 2);
+  EXPECT_EQ(*second, 2);
+  EXPECT_EQ(*third, 1);
+  ASSERT_EQ(interpreter.tensor(3)->dims->size, 1);
+  EXPECT_EQ(interpreter.tensor(3)->dims->data[0], 3);
+
+  for (int i = 0; i < 3; ++i) {
+    interpreter.typed_tensor<float>(0)[i] = i;
+  }
+  for (int i = 0; i < 2; ++i) {
+    interpreter.typed_tensor<float>(1)[i] = 10 + i;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(3)[i], i);
+  }
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(4)[i], 10 + i);
+  }
+
+  // Without incremental resizes, every node is prepared again.
+  ASSERT_EQ(interpreter.SetIncrementalResize(false), kTfLiteOk);
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {4}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(*first, 3);
+  EXPECT_EQ(*second, 3);
+  EXPECT_EQ(*third, 2);
+}
+
+TEST(BasicInterpreter, InputUpperBoundAllocatesArenaOnce) {
+  Interpreter interpreter;
+  interpreter.AddTensors(3);
+  interpreter.SetInputs({0});
+  interpreter.SetOutputs({2});
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 3; ++i) {
+    interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {2},
+                                             quant);
+  }
+  AddPrepareCountingCopyNode(&interpreter, 0, 1);
+  AddPrepareCountingCopyNode(&interpreter, 1, 2);
+  ASSERT_EQ(interpreter.SetInputTensorUpperBound(1, {16}), kTfLiteError);
+  ASSERT_EQ(interpreter.SetInputTensorUpperBound(0, {16}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetIncrementalResize(true), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(2)->dims->data[0], 2);
+
+  // Some tensor is always at the start of the arena.
+  auto arena_start = [&interpreter]() {
+    return std::min({interpreter.tensor(0)->data.raw,
+                     interpreter.tensor(1)->data.raw,
+                     interpreter.tensor(2)->data.raw});
+  };
+  const char* start = arena_start();
+  for (int size : {16, 5, 1}) {
+    ASSERT_EQ(interpreter.ResizeInputTensor(0, {size}), kTfLiteOk);
+    ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+    EXPECT_EQ(arena_start(), start);
+    for (int i = 0; i < size; ++i) {
+      interpreter.typed_tensor<float>(0)[i] = i;
+    }
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    for (int i = 0; i < size; ++i) {
+      EXPECT_EQ(interpreter.typed_tensor<float>(2)[i], i);
+    }
+  }
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
@@ -65,6 +65,10 @@ struct OpData {
   int scratch_tensor_index;
   bool rhs_transposed;
   bool compute_row_sums = false;
+  // Whether the operands of the GEMM, which are swapped w.r.t. those of the
+  // op (see Eval), don't change across invocations.
+  bool gemm_lhs_cacheable = false;
+  bool gemm_rhs_cacheable = false;
 };
 
 struct OpContext {
@@ -192,7 +196,6 @@ TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
       scratch_buffer->allocation_type = kTfLiteArenaRw;
     }
     scratch_buffer->type = op_context->rhs->type;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
     TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                      scratch_buffer_size));
   }
@@ -284,6 +287,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   OpContext op_context(context, node);
   TF_LITE_ENSURE_OK(context, InitializeTemporaries(context, node, &op_context));
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  // The temporaries may have been reallocated.
+  op_data->rhs_transposed = false;
 
   bool adj_x = op_context.params->adj_x;
   bool adj_y = op_context.params->adj_y;
@@ -292,6 +297,11 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* rhs_data = GetInput(context, node, kInputRHSTensor);
   TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
 
+  // A constant RHS is transposed once, into a persistent temporary, while a
+  // transposed LHS is rewritten on every invocation.
+  op_data->gemm_lhs_cacheable = IsConstantTensor(rhs_data);
+  op_data->gemm_rhs_cacheable = IsConstantTensor(lhs_data) && !adj_x;
+
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
   if (lhs_data->type == kTfLiteInt8) {
@@ -477,8 +487,8 @@ TfLiteStatus EvalInt8(TfLiteContext* context, const OpData* data,
   op_params.output_shift = data->output_shift;
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
-  op_params.lhs_cacheable = IsConstantTensor(lhs);
-  op_params.rhs_cacheable = IsConstantTensor(rhs);
+  op_params.lhs_cacheable = data->gemm_lhs_cacheable;
+  op_params.rhs_cacheable = data->gemm_rhs_cacheable;
 
   if (kernel_type == kReference) {
     reference_ops::BatchMatMul(op_params, rhs_shape, GetTensorData<int8_t>(rhs),
@@ -589,7 +599,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     case kTfLiteFloat32:
       // Note we pass RHS args first, LHS args second. See note above.
       if (kernel_type == kGenericOptimized) {
-        optimized_ops::BatchMatMul(rhs_shape, GetTensorData<float>(rhs_tensor),
+        FullyConnectedParams op_params;
+        op_params.lhs_cacheable = op_data->gemm_lhs_cacheable;
+        op_params.rhs_cacheable = op_data->gemm_rhs_cacheable;
+        optimized_ops::BatchMatMul(op_params, rhs_shape,
+                                   GetTensorData<float>(rhs_tensor),
                                    lhs_shape, GetTensorData<float>(lhs_tensor),
                                    GetTensorShape(output),
                                    GetTensorData<float>(output),
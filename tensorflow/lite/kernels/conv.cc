@@ -17,6 +17,7 @@ limitations under the License.
 #include <stddef.h>
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/c/builtin_op_data.h"
@@ -30,14 +31,17 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/reference/sparse_ops/conv.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/kernels/shared_weights_cache.h"
 
 namespace tflite {
 namespace ops {
@@ -100,9 +104,22 @@ struct OpData {
   bool have_weights_been_transposed = false;
   bool need_im2col = false;
 
+  // If the filter is a constant of the model, the HWCN weights are shared
+  // with the other interpreters running the same model through the
+  // SharedWeightsCache, instead of living in a temporary tensor.
+  bool share_hwcn_weights = false;
+  std::shared_ptr<const void> shared_hwcn_weights;
+
   bool supports_multithreaded_kernel = false;
   bool is_hybrid_per_channel = false;
   bool compute_hybrid_row_sums = true;
+
+  // A sparse filter is a 1x1 filter, which the optimized kernels multiply
+  // like the [output_depth, input_depth] weights of a FULLY_CONNECTED. This
+  // is the sparsity of that 2-D view of the filter, which shares the index
+  // arrays of the filter's own sparsity.
+  TfLiteDimensionMetadata sparse_filter_dim_metadata[3];
+  TfLiteSparsity sparse_filter = {};
 };
 
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
@@ -134,11 +151,8 @@ void Free(TfLiteContext* context, void* buffer) {
 // Naive implementation of transpose for floats. Could be optimized to be more
 // cache friendly, but for now it's a one-time cost on first run, and we would
 // prefer to remove the need to do this at all eventually.
-void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
-  const int rows = output->dims->data[1];
-  const int cols = output->dims->data[0];
-  const float* input_data = GetTensorData<float>(input);
-  float* output_data = GetTensorData<float>(output);
+void TransposeFloatData(const float* input_data, int rows, int cols,
+                        float* output_data) {
   for (int i = 0; i < rows; ++i) {
     for (int j = 0; j < cols; ++j) {
       const float in_value = input_data[i * cols + j];
@@ -147,6 +161,91 @@ void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
   }
 }
 
+void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
+  TransposeFloatData(GetTensorData<float>(input), output->dims->data[1],
+                     output->dims->data[0], GetTensorData<float>(output));
+}
+
+// Returns the HWCN weights of a constant `filter`, transposing it only if no
+// other interpreter holds them already.
+std::shared_ptr<const void> GetSharedHwcnWeights(const TfLiteTensor* filter) {
+  const int rows = filter->dims->data[0];
+  const int cols = NumElements(filter) / rows;
+  return SharedWeightsCache::Get()->GetOrDerive(
+      filter->data.raw, filter->bytes, "conv_hwcn_weights", filter->bytes,
+      [filter, rows, cols](void* hwcn_weights) {
+        TransposeFloatData(GetTensorData<float>(filter), rows, cols,
+                           static_cast<float*>(hwcn_weights));
+      });
+}
+
+// Checks that the sparse `filter` is one the kernels support, i.e. a 1x1
+// filter applied with unit strides and dilations, whose only sparse dimension
+// is the input depth, optionally in blocks. Then sets up the 2-D view of its
+// sparsity that the optimized kernels use.
+TfLiteStatus PrepareSparseFilter(TfLiteContext* context,
+                                 const TfLiteConvParams* params,
+                                 const TfLiteTensor* input,
+                                 const TfLiteTensor* filter, OpData* data) {
+  const TfLiteSparsity& sparsity = *filter->sparsity;
+  TF_LITE_ENSURE(context, (input->type == kTfLiteFloat32 &&
+                           filter->type == kTfLiteFloat32) ||
+                              (input->type == kTfLiteInt8 &&
+                               filter->type == kTfLiteInt8));
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(filter, 1), 1);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(filter, 2), 1);
+  TF_LITE_ENSURE_EQ(context, params->stride_width, 1);
+  TF_LITE_ENSURE_EQ(context, params->stride_height, 1);
+  TF_LITE_ENSURE_EQ(context, params->dilation_width_factor, 1);
+  TF_LITE_ENSURE_EQ(context, params->dilation_height_factor, 1);
+
+  const int num_dims = NumDimensions(filter);
+  TF_LITE_ENSURE(context, sparsity.dim_metadata_size == num_dims ||
+                              sparsity.dim_metadata_size == num_dims + 1);
+  TF_LITE_ENSURE(context, sparsity.traversal_order != nullptr);
+  TF_LITE_ENSURE_EQ(context, sparsity.traversal_order->size,
+                    sparsity.dim_metadata_size);
+  for (int i = 0; i < sparsity.dim_metadata_size; ++i) {
+    TF_LITE_ENSURE_EQ(context, sparsity.traversal_order->data[i], i);
+    const TfLiteDimensionType expected_format =
+        i == num_dims - 1 ? kTfLiteDimSparseCSR : kTfLiteDimDense;
+    TF_LITE_ENSURE_EQ(context, sparsity.dim_metadata[i].format,
+                      expected_format);
+  }
+  const bool is_block_sparse = sparsity.dim_metadata_size > num_dims;
+  if (is_block_sparse) {
+    TF_LITE_ENSURE(context, sparsity.block_map != nullptr);
+    TF_LITE_ENSURE_EQ(context, sparsity.block_map->size, 1);
+    TF_LITE_ENSURE_EQ(context, sparsity.block_map->data[0], num_dims - 1);
+  }
+
+  // The int8 kernels only visit the non-zero weights, so the filter must be
+  // symmetrically quantized.
+  if (filter->type == kTfLiteInt8) {
+    const auto* affine_quantization =
+        reinterpret_cast<TfLiteAffineQuantization*>(
+            filter->quantization.params);
+    TF_LITE_ENSURE(context, affine_quantization);
+    if (affine_quantization->zero_point) {
+      for (int i = 0; i < affine_quantization->zero_point->size; ++i) {
+        TF_LITE_ENSURE_EQ(context, affine_quantization->zero_point->data[i],
+                          0);
+      }
+    }
+  }
+
+  data->sparse_filter_dim_metadata[0] = sparsity.dim_metadata[0];
+  data->sparse_filter_dim_metadata[1] = sparsity.dim_metadata[num_dims - 1];
+  if (is_block_sparse) {
+    data->sparse_filter_dim_metadata[2] = sparsity.dim_metadata[num_dims];
+  }
+  data->sparse_filter.traversal_order = nullptr;
+  data->sparse_filter.block_map = nullptr;
+  data->sparse_filter.dim_metadata = data->sparse_filter_dim_metadata;
+  data->sparse_filter.dim_metadata_size = is_block_sparse ? 3 : 2;
+  return kTfLiteOk;
+}
+
 // Check if im2col needs to be allocated, as some version of optimized Conv dont
 // use it. If any change is supporting im2col in any of the Conv versions, then
 // it should be updated here as well
@@ -225,6 +324,8 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
   // we're running with that data type.
   data->need_hwcn_weights =
       input->type == kTfLiteFloat32 && data->supports_multithreaded_kernel;
+  data->share_hwcn_weights =
+      data->need_hwcn_weights && IsConstantTensor(filter);
 
   // We don't always need to allocate im2col. It is only used in some versions
   // of the optimized Conv. This test just mimics something that happens inside
@@ -240,7 +341,7 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
     }
     ++temporaries_count;
   }
-  if (data->need_hwcn_weights) {
+  if (data->need_hwcn_weights && !data->share_hwcn_weights) {
     data->hwcn_weights_index = temporaries_count;
     if (data->hwcn_weights_id == kTensorNotAllocated) {
       context->AddTensors(context, 1, &data->hwcn_weights_id);
@@ -367,15 +468,21 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     }
   }
 
-  // The multi-threaded kernel supports neither dilation nor hybrid kernels, and
-  // is incompatible with mutable input filters that might change between evals.
+  // The multi-threaded kernel supports neither dilation, hybrid kernels nor
+  // sparse filters, and is incompatible with mutable input filters that might
+  // change between evals.
   data->supports_multithreaded_kernel =
       (kernel_type == kMultithreadOptimized) &&
       (context->recommended_num_threads != 1) && !is_hybrid &&
       (params->dilation_width_factor == 1) &&
       (params->dilation_height_factor == 1) &&
       (filter->allocation_type != kTfLiteArenaRw) &&
-      !IsDynamicTensor(filter);
+      !IsDynamicTensor(filter) && filter->sparsity == nullptr;
+
+  if (filter->sparsity != nullptr) {
+    TF_LITE_ENSURE_STATUS(
+        PrepareSparseFilter(context, params, input, filter, data));
+  }
 
   TF_LITE_ENSURE_STATUS(AllocateTemporaryTensorsIfRequired(
       context, node, is_hybrid, data->is_hybrid_per_channel, kernel_type));
@@ -453,7 +560,10 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     if (im2col_status != kTfLiteOk) return im2col_status;
   }
 
-  if (data->need_hwcn_weights) {
+  if (data->share_hwcn_weights) {
+    data->shared_hwcn_weights.reset();
+    data->have_weights_been_transposed = false;
+  } else if (data->need_hwcn_weights) {
     node->temporaries->data[data->hwcn_weights_index] = data->hwcn_weights_id;
     TfLiteIntArray* hwcn_weights_size = TfLiteIntArrayCreate(2);
 
@@ -608,6 +718,8 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   op_params.output_shift = -data->output_shift;
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
+  op_params.lhs_cacheable = IsConstantTensor(filter);
+  op_params.rhs_cacheable = IsConstantTensor(input);
   switch (effective_kernel_type) {
     case kReference: {
       reference_ops::Conv(
@@ -653,6 +765,36 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
   op_params.padding_values.width = data->padding.width;
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
+  op_params.lhs_cacheable = IsConstantTensor(filter);
+  op_params.rhs_cacheable = IsConstantTensor(input);
+
+  if (filter->sparsity != nullptr) {
+    if (kernel_type == kReference) {
+      reference_ops::ConvPerChannelSparseWeight(
+          *filter->sparsity, op_params,
+          data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data(), GetTensorShape(input),
+          GetTensorData<int8>(input), GetTensorShape(filter),
+          GetTensorData<int8>(filter), GetTensorShape(bias),
+          GetTensorData<int32>(bias), GetTensorShape(output),
+          GetTensorData<int8>(output));
+    } else {
+      // A 1x1 convolution is a fully connected layer over all the pixels.
+      const int input_depth = SizeOfDimension(filter, 3);
+      const int output_depth = SizeOfDimension(filter, 0);
+      optimized_ops::SparseWeightMatMulInt8(
+          data->sparse_filter, op_params.input_offset,
+          data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data(), /*per_channel=*/true,
+          op_params.output_offset, op_params.quantized_activation_min,
+          op_params.quantized_activation_max,
+          NumElements(input) / input_depth, input_depth, output_depth,
+          GetTensorData<int8>(input), GetTensorData<int8>(filter),
+          GetTensorData<int32>(bias), GetTensorData<int8>(output),
+          CpuBackendContext::GetFromContext(context));
+    }
+    return;
+  }
 
   switch (kernel_type) {
     case kReference: {
@@ -700,6 +842,8 @@ void EvalQuantizedPerChannel16x8(TfLiteContext* context, TfLiteNode* node,
   op_params.padding_values.width = data->padding.width;
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
+  op_params.lhs_cacheable = IsConstantTensor(filter);
+  op_params.rhs_cacheable = IsConstantTensor(input);
 
   switch (kernel_type) {
     case kGenericOptimized:
@@ -718,6 +862,51 @@ void EvalQuantizedPerChannel16x8(TfLiteContext* context, TfLiteNode* node,
   }
 }
 
+template <KernelType kernel_type>
+void EvalSparseFloat(TfLiteContext* context, const ConvParams& op_params,
+                     const OpData* data, const TfLiteTensor* input,
+                     const TfLiteTensor* filter, const TfLiteTensor* bias,
+                     TfLiteTensor* output) {
+  const TfLiteSparsity& sparse_filter = data->sparse_filter;
+  const bool has_optimized_kernel =
+      sparse_filter.dim_metadata_size == 2 ||
+      sparse_filter.dim_metadata[2].dense_size == 4;
+  if (kernel_type == kReference || !has_optimized_kernel) {
+    reference_ops::ConvSparseWeight(
+        *filter->sparsity, op_params, GetTensorShape(input),
+        GetTensorData<float>(input), GetTensorShape(filter),
+        GetTensorData<float>(filter), GetTensorShape(bias),
+        GetTensorData<float>(bias), GetTensorShape(output),
+        GetTensorData<float>(output));
+    return;
+  }
+
+  // A 1x1 convolution is a fully connected layer over all the pixels.
+  const int input_depth = SizeOfDimension(filter, 3);
+  const int output_depth = SizeOfDimension(filter, 0);
+  const int pixels = NumElements(input) / input_depth;
+  const RuntimeShape fc_input_shape({pixels, input_depth});
+  const RuntimeShape fc_weights_shape({output_depth, input_depth});
+  const RuntimeShape fc_output_shape({pixels, output_depth});
+  FullyConnectedParams fc_params;
+  fc_params.float_activation_min = op_params.float_activation_min;
+  fc_params.float_activation_max = op_params.float_activation_max;
+  if (sparse_filter.dim_metadata_size == 2) {
+    optimized_ops::FullyConnectedSparseWeight(
+        sparse_filter, fc_params, fc_input_shape, GetTensorData<float>(input),
+        fc_weights_shape, GetTensorData<float>(filter), GetTensorShape(bias),
+        GetTensorData<float>(bias), fc_output_shape,
+        GetTensorData<float>(output));
+  } else {
+    optimized_ops::FullyConnectedSparseWeight1x4(
+        sparse_filter, fc_params, fc_input_shape, GetTensorData<float>(input),
+        fc_weights_shape, GetTensorData<float>(filter), GetTensorShape(bias),
+        GetTensorData<float>(bias), fc_output_shape,
+        GetTensorData<float>(output),
+        CpuBackendContext::GetFromContext(context));
+  }
+}
+
 template <KernelType kernel_type>
 void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteConvParams* params, OpData* data,
@@ -743,6 +932,13 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.dilation_height_factor = params->dilation_height_factor;
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
+  op_params.lhs_cacheable = IsConstantTensor(filter);
+  op_params.rhs_cacheable = IsConstantTensor(input);
+  if (filter->sparsity != nullptr) {
+    EvalSparseFloat<kernel_type>(context, op_params, data, input, filter, bias,
+                                 output);
+    return;
+  }
   switch (effective_kernel_type) {
     case kReference: {
       reference_ops::Conv(op_params, GetTensorShape(input),
@@ -772,7 +968,10 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
       TFLITE_DCHECK(false);
 #else
       const float* filter_data;
-      if (data->need_hwcn_weights) {
+      if (data->share_hwcn_weights) {
+        filter_data =
+            static_cast<const float*>(data->shared_hwcn_weights.get());
+      } else if (data->need_hwcn_weights) {
         filter_data = GetTensorData<float>(hwcn_weights);
       } else {
         filter_data = GetTensorData<float>(filter);
@@ -835,6 +1034,8 @@ void EvalHybridPerChannel(TfLiteContext* context, TfLiteNode* node,
   op_params.dilation_height_factor = 1;
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
+  op_params.lhs_cacheable = IsConstantTensor(filter);
+  op_params.rhs_cacheable = false;
   switch (kernel_type) {
     case kReference:
       reference_ops::HybridConvPerChannel(
@@ -916,6 +1117,8 @@ void EvalHybrid(TfLiteContext* context, TfLiteNode* node,
       op_params.dilation_height_factor = 1;
       op_params.float_activation_min = output_activation_min;
       op_params.float_activation_max = output_activation_max;
+      op_params.lhs_cacheable = IsConstantTensor(filter);
+      op_params.rhs_cacheable = false;
       optimized_ops::HybridConv(
           op_params, scaling_factors_ptr, GetTensorShape(input),
           quantized_input_ptr_batch, GetTensorShape(filter),
@@ -945,12 +1148,16 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
           ? &context->tensors[node->temporaries->data[data->im2col_index]]
           : nullptr;
   TfLiteTensor* hwcn_weights =
-      data->need_hwcn_weights
+      data->need_hwcn_weights && !data->share_hwcn_weights
           ? &context->tensors[node->temporaries->data[data->hwcn_weights_index]]
           : nullptr;
 
   if (data->need_hwcn_weights && !data->have_weights_been_transposed) {
-    TransposeFloatTensor(filter, hwcn_weights);
+    if (data->share_hwcn_weights) {
+      data->shared_hwcn_weights = GetSharedHwcnWeights(filter);
+    } else {
+      TransposeFloatTensor(filter, hwcn_weights);
+    }
     data->have_weights_been_transposed = true;
   }
 
@@ -60,7 +60,9 @@ class BaseConvolutionOpModel : public SingleOpModel {
       std::initializer_list<FilterType> filter_data = {}) {
     input_ = AddInput(input);
 
-    if (filter_data.size()) {
+    if (filter_data.size() && !filter.traversal_order.empty()) {
+      filter_ = AddConstSparseInput(filter, filter_data);
+    } else if (filter_data.size()) {
       filter_ = AddConstInput(filter, filter_data);
     } else {
       filter_ = AddInput(filter);
@@ -451,6 +453,64 @@ TEST_P(ConvolutionOpTest, PointwiseFloat32) {
                              }));
 }
 
+TEST_P(ConvolutionOpTest, PointwiseSparseFloat32) {
+  TensorData filter = {TensorType_FLOAT32, {3, 1, 1, 8}};
+  filter.traversal_order = {0, 1, 2, 3};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  ConvolutionOpModel m(GetRegistration(), {TensorType_FLOAT32, {1, 1, 2, 8}},
+                       filter, {TensorType_FLOAT32, {}}, /*stride_width=*/1,
+                       /*stride_height=*/1, Padding_VALID,
+                       ActivationFunctionType_NONE,
+                       /*dilation_width_factor=*/1,
+                       /*dilation_height_factor=*/1, /*num_threads=*/-1,
+                       {
+                           1, 2, 3, 4, 0, 0, 0,  0,   // first filter
+                           0, 0, 0, 0, 0, 0, 0,  0,   // second filter
+                           0, 0, 0, 0, 1, 1, -1, -1,  // third filter
+                       });
+
+  m.SetInput({
+      1, 2, 3, 4, 5,  6,  7,  8,   // x = 0
+      1, 1, 1, 1, -1, -2, -3, -4,  // x = 1
+  });
+  m.SetBias({1, 2, 3});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({31, 2, -1, 11, 2, 7}));
+}
+
+TEST_P(ConvolutionOpTest, PointwiseBlockSparseFloat32) {
+  TensorData filter = {TensorType_FLOAT32, {3, 1, 1, 8}};
+  filter.traversal_order = {0, 1, 2, 3, 4};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {3};
+  filter.block_size = {4};
+  ConvolutionOpModel m(GetRegistration(), {TensorType_FLOAT32, {1, 1, 2, 8}},
+                       filter, {TensorType_FLOAT32, {}}, /*stride_width=*/1,
+                       /*stride_height=*/1, Padding_VALID,
+                       ActivationFunctionType_NONE,
+                       /*dilation_width_factor=*/1,
+                       /*dilation_height_factor=*/1, /*num_threads=*/-1,
+                       {
+                           1, 2, 3, 4, 0, 0, 0,  0,   // first filter
+                           0, 0, 0, 0, 0, 0, 0,  0,   // second filter
+                           0, 0, 0, 0, 1, 1, -1, -1,  // third filter
+                       });
+
+  m.SetInput({
+      1, 2, 3, 4, 5,  6,  7,  8,   // x = 0
+      1, 1, 1, 1, -1, -2, -3, -4,  // x = 1
+  });
+  m.SetBias({1, 2, 3});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({31, 2, -1, 11, 2, 7}));
+}
+
 // TODO(alanchiao): this passes locally, but fails on continuous build system.
 // Re-enable when root cause found.
 TEST_P(ConvolutionOpTest, DISABLED_PointwiseMultifilterFloat32) {
@@ -1579,6 +1639,45 @@ TEST_P(ConvolutionOpTest, SimplePerChannelTest) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({61, 127, -115, -93}));
 }
 
+TEST_P(ConvolutionOpTest, PointwiseBlockSparsePerChannelTest) {
+  TensorData filter = {TensorType_INT8,
+                       {3, 1, 1, 8},
+                       0,
+                       0,
+                       0,
+                       0,
+                       /*per_channel_quantization=*/true,
+                       /*per_channel_quantization_scales=*/{1, 1, 2},
+                       /*per_channel_quantization_offsets=*/{0, 0, 0},
+                       /*channel_index=*/0};
+  filter.traversal_order = {0, 1, 2, 3, 4};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {3};
+  filter.block_size = {4};
+  PerChannelQuantizedConvolutionOpModel m(
+      GetRegistration(), {TensorType_INT8, {1, 1, 2, 8}, -63.5, 64, 0.5, -1},
+      filter, {TensorType_INT8, {}, -63.5, 64, 0.5, -1},
+      /*stride_width=*/1, /*stride_height=*/1, Padding_VALID,
+      ActivationFunctionType_NONE, /*dilation_width_factor=*/1,
+      /*dilation_height_factor=*/1, /*num_threads=*/-1,
+      {
+          1, 2, 3, 4, 0, 0, 0,  0,   // out channel = 0
+          0, 0, 0, 0, 0, 0, 0,  0,   // out channel = 1
+          0, 0, 0, 0, 1, 1, -1, -1,  // out channel = 2
+      });
+  m.SetInput({
+      1, 2, 3, 4, 5,  6,  7,  8,   // x = 0
+      1, 1, 1, 1, -1, -2, -3, -4,  // x = 1
+  });
+  m.SetBias({1, 2, 3});
+
+  m.Invoke();
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear({31, 2, -5, 11, 2, 11})));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({61, 3, -11, 21, 3, 21}));
+}
+
 class HybridPerChannelConvolutionOpModel
     : public BaseConvolutionOpModel<int8_t> {
  public:
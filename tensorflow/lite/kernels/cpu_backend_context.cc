@@ -79,4 +79,21 @@ void CpuBackendContext::SetMaxNumThreads(int max_num_threads) {
 
 void CpuBackendContext::SetUseCaching(bool flag) { use_caching_ = flag; }
 
+bool CpuBackendContext::MayCachePrepacked(const void* data, int64_t bytes) {
+  if (max_prepacked_cache_bytes_ < 0) return true;
+  if (prepacked_matrices_.count(data)) return true;
+  if (prepacked_cache_bytes_ + bytes > max_prepacked_cache_bytes_) {
+    return false;
+  }
+  prepacked_cache_bytes_ += bytes;
+  prepacked_matrices_.insert(data);
+  return true;
+}
+
+void CpuBackendContext::ClearCaches() {
+  ruy_context_->ClearPrepackedCache();
+  prepacked_cache_bytes_ = 0;
+  prepacked_matrices_.clear();
+}
+
 }  // namespace tflite
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_CONTEXT_H_
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_CONTEXT_H_
 
+#include <cstdint>
 #include <memory>
+#include <unordered_set>
 
 #include "public/gemmlowp.h"
 #include "ruy/context.h"  // from @ruy
@@ -48,7 +50,23 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   bool use_caching() const { return use_caching_; }
 
-  void ClearCaches() override { ruy_context_->ClearPrepackedCache(); }
+  // Sets the maximum number of bytes of constant matrices whose packed form
+  // may be cached when caching is enabled. A negative value, the default,
+  // means no limit beyond ruy's own.
+  void SetMaxPrepackedCacheBytes(int64_t max_bytes) {
+    max_prepacked_cache_bytes_ = max_bytes;
+  }
+
+  int64_t max_prepacked_cache_bytes() const {
+    return max_prepacked_cache_bytes_;
+  }
+
+  // Returns whether the packed form of the constant matrix at 'data', of about
+  // 'bytes' bytes, may be cached. The first time a matrix is allowed, it is
+  // counted against the limit until the caches are cleared.
+  bool MayCachePrepacked(const void* data, int64_t bytes);
+
+  void ClearCaches() override;
 
  private:
   // To enable a smooth transition from the current direct usage
@@ -76,6 +94,10 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   // CpuBackendGem operations to a library that permits such an optimization
   // (currently the Ruy library only).
   bool use_caching_;
+  // The bytes of the matrices allowed to be cached so far, and their data.
+  int64_t max_prepacked_cache_bytes_ = -1;
+  int64_t prepacked_cache_bytes_ = 0;
+  std::unordered_set<const void*> prepacked_matrices_;
 
   CpuBackendContext(const CpuBackendContext&) = delete;
 };
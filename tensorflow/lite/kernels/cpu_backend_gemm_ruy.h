@@ -119,6 +119,22 @@ void MakeRuyMulParams(
       params, ruy_mul_params);
 }
 
+// Returns whether ruy may cache the packed form of a matrix, which it would
+// only do for constant data, within the limit set on the context.
+template <typename Scalar>
+bool UseCaching(const MatrixParams<Scalar>& params, const Scalar* data,
+                CpuBackendContext* context) {
+  if (!context->use_caching() ||
+      params.cache_policy == CachePolicy::kNeverCache) {
+    return false;
+  }
+  // Packing pads the matrix a little and may add sums of rows or columns,
+  // which this leaves out.
+  const std::int64_t bytes =
+      static_cast<std::int64_t>(params.rows) * params.cols * sizeof(Scalar);
+  return context->MayCachePrepacked(data, bytes);
+}
+
 template <typename LhsScalar, typename RhsScalar, typename AccumScalar,
           typename DstScalar, QuantizationFlavor quantization_flavor>
 struct GemmImplUsingRuy {
@@ -131,8 +147,10 @@ struct GemmImplUsingRuy {
     ruy::Matrix<LhsScalar> ruy_lhs;
     ruy::Matrix<RhsScalar> ruy_rhs;
     ruy::Matrix<DstScalar> ruy_dst;
-    MakeRuyMatrix(lhs_params, lhs_data, &ruy_lhs, context->use_caching());
-    MakeRuyMatrix(rhs_params, rhs_data, &ruy_rhs, context->use_caching());
+    MakeRuyMatrix(lhs_params, lhs_data, &ruy_lhs,
+                  UseCaching(lhs_params, lhs_data, context));
+    MakeRuyMatrix(rhs_params, rhs_data, &ruy_rhs,
+                  UseCaching(rhs_params, rhs_data, context));
     MakeRuyMatrix(dst_params, dst_data, &ruy_dst);
 
     ruy::MulParams<AccumScalar, DstScalar> ruy_mul_params;
@@ -524,6 +524,24 @@ TEST(CpuBackendGemmSimpleTestAgainstGolden, Int8Int16) {
       3, 5, 4, {19, 48, 77, 48, 149, 250, 76, 249, 422, 105, 350, 595});
 }
 
+TEST(CpuBackendContextTest, MaxPrepackedCacheBytes) {
+  CpuBackendContext cpu_backend_context;
+  const char matrices[3] = {};
+  // There is no limit by default.
+  EXPECT_TRUE(cpu_backend_context.MayCachePrepacked(&matrices[0], 1 << 30));
+  cpu_backend_context.ClearCaches();
+
+  cpu_backend_context.SetMaxPrepackedCacheBytes(100);
+  EXPECT_TRUE(cpu_backend_context.MayCachePrepacked(&matrices[0], 60));
+  EXPECT_FALSE(cpu_backend_context.MayCachePrepacked(&matrices[1], 60));
+  // Matrices allowed before are only counted once.
+  EXPECT_TRUE(cpu_backend_context.MayCachePrepacked(&matrices[0], 60));
+  EXPECT_TRUE(cpu_backend_context.MayCachePrepacked(&matrices[2], 40));
+
+  cpu_backend_context.ClearCaches();
+  EXPECT_TRUE(cpu_backend_context.MayCachePrepacked(&matrices[1], 60));
+}
+
 template <typename tLhsScalar, typename tRhsScalar, typename tAccumScalar,
           typename tDstScalar>
 struct TypesTuple {
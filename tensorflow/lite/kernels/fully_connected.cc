@@ -182,6 +182,25 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node) {
     TF_LITE_ENSURE_EQ(context, NumElements(bias), SizeOfDimension(filter, 0));
   }
 
+  if (filter->sparsity != nullptr) {
+    // Sparse weights are supported for float and int8 inference. The int8
+    // kernels only visit the non-zero weights, so they must be symmetrically
+    // quantized.
+    const auto& sparsity = *filter->sparsity;
+    TF_LITE_ENSURE(context,
+                   sparsity.dim_metadata_size == kDimMetadataSizeRandomSparse ||
+                       sparsity.dim_metadata_size ==
+                           kDimMetadataSizeBlockSparse);
+    TF_LITE_ENSURE(context, SupportedSparsityFormat(sparsity));
+    if (filter->type == kTfLiteInt8) {
+      TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+      TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteInt8);
+      TF_LITE_ENSURE_EQ(context, filter->params.zero_point, 0);
+    } else {
+      TF_LITE_ENSURE_TYPES_EQ(context, filter->type, kTfLiteFloat32);
+    }
+  }
+
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
   if (input->type == kTfLiteUInt8 || input->type == kTfLiteInt8 ||
@@ -437,7 +456,24 @@ void FullyConnectedInt8(const OpData* data, const TfLiteTensor* input,
   op_params.quantized_activation_max = data->output_activation_max;
   op_params.lhs_cacheable = IsConstantTensor(filter);
   op_params.rhs_cacheable = IsConstantTensor(input);
-  if (kernel_type == kReference) {
+  if (filter->sparsity != nullptr) {
+    const auto& sparsity = *filter->sparsity;
+    if (kernel_type == kReference) {
+      reference_ops::FullyConnectedSparseWeight(
+          sparsity, op_params, GetTensorShape(input),
+          GetTensorData<int8_t>(input), GetTensorShape(filter),
+          GetTensorData<int8_t>(filter), GetTensorShape(bias),
+          GetTensorData<int32_t>(bias), GetTensorShape(output),
+          GetTensorData<int8_t>(output));
+    } else {
+      optimized_ops::FullyConnectedSparseWeight(
+          sparsity, op_params, GetTensorShape(input),
+          GetTensorData<int8_t>(input), GetTensorShape(filter),
+          GetTensorData<int8_t>(filter), GetTensorShape(bias),
+          GetTensorData<int32_t>(bias), GetTensorShape(output),
+          GetTensorData<int8_t>(output), cpu_backend_context);
+    }
+  } else if (kernel_type == kReference) {
     reference_integer_ops::FullyConnected(
         op_params, GetTensorShape(input), GetTensorData<int8_t>(input),
         GetTensorShape(filter), GetTensorData<int8_t>(filter),
@@ -1355,6 +1355,114 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreadedMoreBatches) {
                                            ));
   }
 }
+
+class SparseQuantizedFullyConnectedOpModel : public SingleOpModel {
+ public:
+  SparseQuantizedFullyConnectedOpModel(
+      TfLiteRegistration* registration, int units, const TensorData& input,
+      const TensorData& weights, std::initializer_list<int8_t> weights_data,
+      const TensorData& output, int num_threads = 1) {
+    input_ = AddInput(input);
+    weights_ = AddConstSparseInput(weights, weights_data);
+    bias_ = AddInput({TensorType_INT32, {units}, 0, 0,
+                      GetScale(input_) * GetScale(weights_)});
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)},
+                     num_threads, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+  }
+  void SetBias(const std::vector<float>& data) {
+    QuantizeAndPopulate<int32_t>(bias_, data);
+  }
+  void SetInput(const std::vector<float>& data) {
+    QuantizeAndPopulate<int8_t>(input_, data);
+  }
+  std::vector<int8_t> GetOutput() { return ExtractVector<int8_t>(output_); }
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<int8_t>(ExtractVector<int8_t>(output_), GetScale(output_),
+                              GetZeroPoint(output_));
+  }
+
+ protected:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(SparseFullyConnectedOpTest, SimpleTestInt8) {
+  std::initializer_list<int8_t> weight_data = {
+      1, 2, 3, 4, 0, 0, 0, 0, 1, 0, -1, 0,  // u = 0
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0,  // u = 1
+      0, 0, 0, 0, 2, 2, 2, 2, 0, 0, 0,  0,  // u = 2
+  };
+  TensorData weight = {};
+  weight.type = TensorType_INT8;
+  weight.shape = {3, 12};
+  weight.scale = 1.0f;
+  weight.traversal_order = {0, 1};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  SparseQuantizedFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3,
+      /*input=*/{TensorType_INT8, {2, 12}, -63.5, 64}, weight, weight_data,
+      /*output=*/{TensorType_INT8, {}, -127, 128});
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10, 11,  12,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10, -11, 12,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear({11, 2, 55, 51, 2, 23})));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(10, 1, 54, 50, 1, 22));
+}
+
+TEST_P(SparseFullyConnectedOpTest, Simple1x4TestInt8MultiThreaded) {
+  std::initializer_list<int8_t> weight_data = {
+      1, 2, 3, 4, 0, 0, 0, 0, 1, 0, -1, 0,  // u = 0
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0,  // u = 1
+      0, 0, 0, 0, 2, 2, 2, 2, 0, 0, 0,  0,  // u = 2
+  };
+  TensorData weight = {};
+  weight.type = TensorType_INT8;
+  weight.shape = {3, 12};
+  weight.scale = 1.0f;
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {4};
+  for (int num_threads = 1; num_threads <= 4; num_threads++) {
+    SparseQuantizedFullyConnectedOpModel m(
+        GetRegistration(), /*units=*/3,
+        /*input=*/{TensorType_INT8, {4, 12}, -63.5, 64}, weight, weight_data,
+        /*output=*/{TensorType_INT8, {}, -127, 128}, num_threads);
+    m.SetBias({1, 2, 3});
+
+    m.SetInput({
+        1, 2, 3, 4, 5, 6, 7, 8,  -9, -10, 11,  12,  // b = 0
+        1, 2, 3, 4, 5, 6, 7, -8, 9,  -10, -11, 12,  // b = 1
+        1, 2, 3, 4, 5, 6, 7, 8,  -9, -10, 11,  12,  // b = 2
+        1, 2, 3, 4, 5, 6, 7, -8, 9,  -10, -11, 12,  // b = 3
+    });
+
+    m.Invoke();
+
+    EXPECT_THAT(m.GetOutput(), ElementsAre(10, 1, 54, 50, 1, 22,  // b = 0, 1
+                                           10, 1, 54, 50, 1, 22   // b = 2, 3
+                                           ));
+  }
+}
+
 // TODO(b/148391360): Add tests for unsupported sparsity format.
 // TEST_P(SparseFullyConnectedOpTest, TestUnsupportedSparsityFormat)
 
@@ -25,7 +25,8 @@ limitations under the License.
 namespace tflite {
 namespace optimized_ops {
 
-inline void BatchMatMul(const RuntimeShape& lhs_shape, const float* lhs_data,
+inline void BatchMatMul(const FullyConnectedParams& params,
+                        const RuntimeShape& lhs_shape, const float* lhs_data,
                         const RuntimeShape& rhs_shape, const float* rhs_data,
                         const RuntimeShape& output_shape, float* output_data,
                         CpuBackendContext* context) {
@@ -81,11 +82,15 @@ inline void BatchMatMul(const RuntimeShape& lhs_shape, const float* lhs_data,
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
   lhs_params.rows = lhs_rows;
   lhs_params.cols = accum_depth;
+  lhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.lhs_cacheable);
 
   MatrixParams<float> rhs_params;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
   rhs_params.rows = accum_depth;
   rhs_params.cols = rhs_cols;
+  rhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.rhs_cacheable);
 
   MatrixParams<float> dst_params;
   dst_params.order = cpu_backend_gemm::Order::kColMajor;
@@ -340,12 +345,16 @@ inline void BatchMatMul(const FullyConnectedParams& params,
   lhs_params.rows = lhs_rows;
   lhs_params.cols = accum_depth;
   lhs_params.zero_point = -filter_offset;
+  lhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.lhs_cacheable);
 
   MatrixParams<int8_t> rhs_params;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
   rhs_params.rows = accum_depth;
   rhs_params.cols = rhs_cols;
   rhs_params.zero_point = -input_offset;
+  rhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.rhs_cacheable);
 
   MatrixParams<int8_t> dst_params;
   dst_params.order = cpu_backend_gemm::Order::kColMajor;
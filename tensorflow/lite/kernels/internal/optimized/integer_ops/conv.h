@@ -99,11 +99,16 @@ inline void ConvPerChannel(
   lhs_params.cols = filter_cols;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
   lhs_params.zero_point = 0;  // filter is symmetric-quantized
+  lhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.lhs_cacheable);
   cpu_backend_gemm::MatrixParams<int8> rhs_params;
   rhs_params.rows = gemm_input_rows;
   rhs_params.cols = gemm_input_cols;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
   rhs_params.zero_point = -input_offset;
+  // The im2col buffer is rewritten on every call.
+  rhs_params.cache_policy = cpu_backend_gemm::DefaultCachePolicy(
+      params.rhs_cacheable && gemm_input_data == input_data);
   cpu_backend_gemm::MatrixParams<int8> dst_params;
   dst_params.rows = output_rows;
   dst_params.cols = output_cols;
@@ -2542,6 +2542,8 @@ inline void Conv(const float* input_data, const Dims<4>& input_dims,
   op_params.dilation_height_factor = dilation_height_factor;
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
+  op_params.lhs_cacheable = false;
+  op_params.rhs_cacheable = false;
 
   Conv(op_params, DimsToShape(input_dims), input_data, DimsToShape(filter_dims),
        filter_data, DimsToShape(bias_dims), bias_data, DimsToShape(output_dims),
@@ -2755,6 +2757,8 @@ inline void Conv(const uint8* input_data, const Dims<4>& input_dims,
   op_params.output_shift = kReverseShift * output_shift;
   op_params.quantized_activation_min = output_activation_min;
   op_params.quantized_activation_max = output_activation_max;
+  op_params.lhs_cacheable = false;
+  op_params.rhs_cacheable = false;
 
   Conv(op_params, DimsToShape(input_dims), input_data, DimsToShape(filter_dims),
        filter_data, DimsToShape(bias_dims), bias_data, DimsToShape(output_dims),
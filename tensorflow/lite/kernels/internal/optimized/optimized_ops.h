@@ -1351,10 +1351,15 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape,
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
   lhs_params.rows = n;
   lhs_params.cols = k;
+  lhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.lhs_cacheable);
   cpu_backend_gemm::MatrixParams<float> rhs_params;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
   rhs_params.rows = k;
   rhs_params.cols = m;
+  // The im2col buffer is rewritten on every call.
+  rhs_params.cache_policy = cpu_backend_gemm::DefaultCachePolicy(
+      params.rhs_cacheable && gemm_input_data == input_data);
   cpu_backend_gemm::MatrixParams<float> dst_params;
   dst_params.order = cpu_backend_gemm::Order::kColMajor;
   dst_params.rows = n;
@@ -1527,6 +1532,8 @@ inline void HybridConvPerChannel(
   lhs_params.rows = filter_rows;
   lhs_params.cols = filter_cols;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.lhs_cacheable);
 
   cpu_backend_gemm::MatrixParams<int8> rhs_params;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
@@ -1647,11 +1654,16 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape,
   lhs_params.cols = filter_cols;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
   lhs_params.zero_point = -filter_offset;
+  lhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.lhs_cacheable);
   cpu_backend_gemm::MatrixParams<uint8> rhs_params;
   rhs_params.rows = gemm_input_rows;
   rhs_params.cols = gemm_input_cols;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
   rhs_params.zero_point = -input_offset;
+  // The im2col buffer is rewritten on every call.
+  rhs_params.cache_policy = cpu_backend_gemm::DefaultCachePolicy(
+      params.rhs_cacheable && gemm_input_data == input_data);
   cpu_backend_gemm::MatrixParams<uint8> dst_params;
   dst_params.rows = output_rows;
   dst_params.cols = output_cols;
@@ -201,6 +201,172 @@ inline void FullyConnectedSparseWeight1x4(
                                   cpu_backend_context);
 }
 
+// Multiplies the batches of int8 input in [thread_start, thread_end) by int8
+// weights in the compressed sparse row format of `sparsity`, whose non-zero
+// values come in blocks of 1x`block_size`, and requantizes the results. The
+// weights must be symmetrically quantized, since only their non-zero values
+// are visited. The output multipliers and shifts are per output channel if
+// `per_channel` is set, and per tensor otherwise.
+inline void SparseWeightMatMulInt8Impl(
+    const TfLiteSparsity& sparsity, int block_size, int32_t input_offset,
+    const int32_t* output_multiplier, const int* output_shift,
+    bool per_channel, int32_t output_offset, int32_t output_activation_min,
+    int32_t output_activation_max, int input_depth, int output_depth,
+    const int8_t* input_data, const int8_t* weights_data,
+    const int32_t* bias_data, int8_t* output_data, int thread_start,
+    int thread_end) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("Int8 Sparse");
+  const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
+  const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
+
+  for (int b = thread_start; b < thread_end; ++b) {
+    const int8_t* input_ptr = input_data + b * input_depth;
+    int8_t* output_ptr = output_data + b * output_depth;
+    const int8_t* weights_ptr = weights_data;
+    for (int row = 0; row < output_depth; ++row) {
+      int32_t acc = 0;
+      for (int i = w1_segments[row]; i < w1_segments[row + 1]; ++i) {
+        const int8_t* input_block = input_ptr + w1_indices[i] * block_size;
+        for (int c = 0; c < block_size; ++c) {
+          acc += static_cast<int32_t>(*weights_ptr++) *
+                 (static_cast<int32_t>(input_block[c]) + input_offset);
+        }
+      }
+      if (bias_data) {
+        acc += bias_data[row];
+      }
+      const int channel = per_channel ? row : 0;
+      acc = MultiplyByQuantizedMultiplier(acc, output_multiplier[channel],
+                                          output_shift[channel]);
+      acc += output_offset;
+      acc = std::max(acc, output_activation_min);
+      acc = std::min(acc, output_activation_max);
+      output_ptr[row] = static_cast<int8_t>(acc);
+    }
+  }
+}
+
+struct SparseWeightMatMulInt8Task : cpu_backend_threadpool::Task {
+  SparseWeightMatMulInt8Task(
+      const TfLiteSparsity& sparsity, int block_size, int32_t input_offset,
+      const int32_t* output_multiplier, const int* output_shift,
+      bool per_channel, int32_t output_offset, int32_t output_activation_min,
+      int32_t output_activation_max, int input_depth, int output_depth,
+      const int8_t* input_data, const int8_t* weights_data,
+      const int32_t* bias_data, int8_t* output_data, int thread_start,
+      int thread_end)
+      : sparsity(sparsity),
+        block_size(block_size),
+        input_offset(input_offset),
+        output_multiplier(output_multiplier),
+        output_shift(output_shift),
+        per_channel(per_channel),
+        output_offset(output_offset),
+        output_activation_min(output_activation_min),
+        output_activation_max(output_activation_max),
+        input_depth(input_depth),
+        output_depth(output_depth),
+        input_data(input_data),
+        weights_data(weights_data),
+        bias_data(bias_data),
+        output_data(output_data),
+        thread_start(thread_start),
+        thread_end(thread_end) {}
+
+  void Run() override {
+    SparseWeightMatMulInt8Impl(
+        sparsity, block_size, input_offset, output_multiplier, output_shift,
+        per_channel, output_offset, output_activation_min,
+        output_activation_max, input_depth, output_depth, input_data,
+        weights_data, bias_data, output_data, thread_start, thread_end);
+  }
+
+ private:
+  const TfLiteSparsity& sparsity;
+  int block_size;
+  int32_t input_offset;
+  const int32_t* output_multiplier;
+  const int* output_shift;
+  bool per_channel;
+  int32_t output_offset;
+  int32_t output_activation_min;
+  int32_t output_activation_max;
+  int input_depth;
+  int output_depth;
+  const int8_t* input_data;
+  const int8_t* weights_data;
+  const int32_t* bias_data;
+  int8_t* output_data;
+  int thread_start;
+  int thread_end;
+};
+
+// Multiplies `batches` rows of int8 input by the [output_depth, input_depth]
+// sparse int8 weights. Both the random sparse format and the block sparse
+// format with 1xN blocks are supported. Like the float kernels above, the
+// workload is sliced along the batch dimension.
+inline void SparseWeightMatMulInt8(
+    const TfLiteSparsity& sparsity, int32_t input_offset,
+    const int32_t* output_multiplier, const int* output_shift,
+    bool per_channel, int32_t output_offset, int32_t output_activation_min,
+    int32_t output_activation_max, int batches, int input_depth,
+    int output_depth, const int8_t* input_data, const int8_t* weights_data,
+    const int32_t* bias_data, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  const int block_size =
+      sparsity.dim_metadata_size == 3 ? sparsity.dim_metadata[2].dense_size : 1;
+  const int max_threads = cpu_backend_context->max_num_threads();
+  const int thread_count = std::max(1, std::min(batches, max_threads));
+  if (thread_count == 1) {
+    return SparseWeightMatMulInt8Impl(
+        sparsity, block_size, input_offset, output_multiplier, output_shift,
+        per_channel, output_offset, output_activation_min,
+        output_activation_max, input_depth, output_depth, input_data,
+        weights_data, bias_data, output_data, 0, batches);
+  }
+  std::vector<SparseWeightMatMulInt8Task> tasks;
+  tasks.reserve(thread_count);
+  int thread_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int thread_end = thread_start + batches / thread_count;
+    if (i < batches % thread_count) thread_end++;
+
+    tasks.emplace_back(sparsity, block_size, input_offset, output_multiplier,
+                       output_shift, per_channel, output_offset,
+                       output_activation_min, output_activation_max,
+                       input_depth, output_depth, input_data, weights_data,
+                       bias_data, output_data, thread_start, thread_end);
+    thread_start = thread_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+inline void FullyConnectedSparseWeight(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& weights_shape, const int8_t* weights_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  TFLITE_DCHECK_EQ(params.weights_offset, 0);
+  const int input_dims_count = input_shape.DimensionsCount();
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int input_depth = MatchingDim(weights_shape, weights_dims_count - 1,
+                                      input_shape, input_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+  SparseWeightMatMulInt8(
+      sparsity, params.input_offset, &params.output_multiplier,
+      &params.output_shift, /*per_channel=*/false, params.output_offset,
+      params.quantized_activation_min, params.quantized_activation_max,
+      batches, input_depth, output_depth, input_data, weights_data, bias_data,
+      output_data, cpu_backend_context);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 #endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
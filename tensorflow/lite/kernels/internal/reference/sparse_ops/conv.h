@@ -0,0 +1,68 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_SPARSE_OPS_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_SPARSE_OPS_CONV_H_
+
+#include "tensorflow/lite/kernels/internal/reference/conv.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/tools/optimize/sparsity/format_converter.h"
+
+namespace tflite {
+namespace reference_ops {
+
+// Convert filter to dense format and run dense convolution.
+inline void ConvSparseWeight(
+    const TfLiteSparsity& sparsity, const ConvParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& filter_shape, const float* filter_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data) {
+  std::vector<int> filter_shape_vector(filter_shape.DimensionsCount());
+  for (int i = 0; i < filter_shape.DimensionsCount(); i++) {
+    filter_shape_vector[i] = filter_shape.Dims(i);
+  }
+  tflite::optimize::sparsity::FormatConverter<float> converter(
+      filter_shape_vector, sparsity);
+  converter.SparseToDense(filter_data);
+  const std::vector<float> dense_filter_data = converter.GetData();
+  Conv(params, input_shape, input_data, filter_shape, dense_filter_data.data(),
+       bias_shape, bias_data, output_shape, output_data, RuntimeShape(),
+       nullptr);
+}
+
+inline void ConvPerChannelSparseWeight(
+    const TfLiteSparsity& sparsity, const ConvParams& params,
+    const int32_t* output_multiplier, const int32_t* output_shift,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& filter_shape, const int8_t* filter_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data) {
+  std::vector<int> filter_shape_vector(filter_shape.DimensionsCount());
+  for (int i = 0; i < filter_shape.DimensionsCount(); i++) {
+    filter_shape_vector[i] = filter_shape.Dims(i);
+  }
+  tflite::optimize::sparsity::FormatConverter<int8_t> converter(
+      filter_shape_vector, sparsity);
+  converter.SparseToDense(filter_data);
+  const std::vector<int8_t> dense_filter_data = converter.GetData();
+  reference_integer_ops::ConvPerChannel(
+      params, output_multiplier, output_shift, input_shape, input_data,
+      filter_shape, dense_filter_data.data(), bias_shape, bias_data,
+      output_shape, output_data);
+}
+
+}  // namespace reference_ops
+}  // namespace tflite
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_SPARSE_OPS_CONV_H_
@@ -838,6 +838,10 @@ struct ConvParams {
   // float activation params.
   float float_activation_min;
   float float_activation_max;
+  // Mark the operands of the GEMM, i.e. the filter (LHS) and the input (RHS),
+  // as cacheable if they are unchanging.
+  bool lhs_cacheable;
+  bool rhs_cacheable;
 };
 
 struct DepthToSpaceParams {
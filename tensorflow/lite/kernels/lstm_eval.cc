@@ -160,6 +160,11 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   activation                                 - activation to use.
 //   is_input_all_zeros, is_aux_input_all_zeros - if input vectors are all zero.
 //   use_layer_norm                             - if doing layer norm LSTM.
+//
+// If precomputed_gate_input is not null, it holds the bias (unless layer norm
+// is used) and the input contribution of the n_batch vectors, as computed by
+// PrecomputeLstmGateInputFloat, and input is not read. There is no auxiliary
+// input in this case.
 inline void CalculateLstmGateFloat(
     const float* input, const float* input_to_gate_weights,
     const float* aux_input, const float* aux_input_to_gate_weights,
@@ -169,29 +174,36 @@ inline void CalculateLstmGateFloat(
     const int n_batch, const int n_input, const int n_aux_input,
     const int n_output, const int n_cell,
     const TfLiteFusedActivation activation, float* gate,
-    const bool is_input_all_zeros, const bool is_aux_input_all_zeros) {
+    const bool is_input_all_zeros, const bool is_aux_input_all_zeros,
+    const float* precomputed_gate_input) {
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
-  // Initialize scratch buffers with bias for regular lstm or initialize with
-  // zero for layer norm lstm.
-  if (use_layer_norm) {
-    std::fill_n(gate, n_cell * n_batch, 0.0f);
+  if (precomputed_gate_input != nullptr) {
+    // The bias and the input contribution were computed ahead of the
+    // recurrence.
+    std::copy_n(precomputed_gate_input, n_cell * n_batch, gate);
   } else {
-    tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
-  }
-  // For each batch and cell: compute input_weight * input.
-  // Skip if input is all zeros.
-  if (!is_input_all_zeros) {
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        input_to_gate_weights, n_cell, n_input, input, n_batch, gate);
-  }
-  // For each batch and cell: compute aux_input_weight * aux_input.
-  // Skip if auxiliary input is not available or all zeros.
-  if (!is_aux_input_all_zeros) {
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(aux_input_to_gate_weights,
-                                                      n_cell, n_aux_input,
-                                                      aux_input, n_batch, gate);
+    // Initialize scratch buffers with bias for regular lstm or initialize with
+    // zero for layer norm lstm.
+    if (use_layer_norm) {
+      std::fill_n(gate, n_cell * n_batch, 0.0f);
+    } else {
+      tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
+    }
+    // For each batch and cell: compute input_weight * input.
+    // Skip if input is all zeros.
+    if (!is_input_all_zeros) {
+      tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+          input_to_gate_weights, n_cell, n_input, input, n_batch, gate);
+    }
+    // For each batch and cell: compute aux_input_weight * aux_input.
+    // Skip if auxiliary input is not available or all zeros.
+    if (!is_aux_input_all_zeros) {
+      tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+          aux_input_to_gate_weights, n_cell, n_aux_input, aux_input, n_batch,
+          gate);
+    }
   }
   // For each batch and cell: compute recurrent_weight * output_state.
   tensor_utils::MatrixBatchVectorMultiplyAccumulate(
@@ -213,6 +225,33 @@ inline void CalculateLstmGateFloat(
                                         gate);
 }
 
+// Computes the part of an LSTM gate that does not depend on the recurrent
+// state, i.e. the bias (unless layer norm is used, in which case it's added
+// after normalization) plus input_weight * input, for n_rows input vectors at
+// once. Doing this for several time steps in one batched multiplication streams
+// the input weights once for all of them, instead of once per step.
+//
+// Parameters:
+//   input                     - n_rows * n_input
+//   input_to_gate_weights     - n_cell * n_input
+//   gate_bias                 - n_cell
+//   gate_input                - output, n_rows * n_cell
+inline void PrecomputeLstmGateInputFloat(const float* input,
+                                         const float* input_to_gate_weights,
+                                         const float* gate_bias,
+                                         const bool use_layer_norm,
+                                         const int n_rows, const int n_input,
+                                         const int n_cell, float* gate_input) {
+  if (use_layer_norm) {
+    std::fill_n(gate_input, n_cell * n_rows, 0.0f);
+  } else {
+    tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_rows,
+                                          gate_input);
+  }
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      input_to_gate_weights, n_cell, n_input, input, n_rows, gate_input);
+}
+
 // Updates the LSTM cell state, used by both float and hybrid LSTM versions.
 //
 // Implements the following formula:
@@ -771,6 +810,15 @@ void CalculateLstmOutputInteger8x8_8(
 //   cell_layer_norm_coefficients_ptr   - optional
 //   output_layer_norm_coefficients_ptr - optional
 //
+// Precomputed gate inputs of size 'n_batch * n_cell' (see
+// PrecomputeLstmGateInputFloat), either all nullptr or all set, except for the
+// input gate with CIFG:
+//   input_gate_input_ptr               - optional
+//   forget_gate_input_ptr              - optional
+//   cell_gate_input_ptr                - optional
+//   output_gate_input_ptr              - optional
+// When they are set, input_ptr is not read and there is no auxiliary input.
+//
 // The pointers to the cell and output state and the output are updated.
 //
 // The pointers input_ptr, aux_input_ptr, and output_ptr point to data aligned
@@ -807,6 +855,8 @@ inline void LstmStepFloat(
     const float* input_gate_bias_ptr, const float* forget_gate_bias_ptr,
     const float* cell_gate_bias_ptr, const float* output_gate_bias_ptr,
     const float* projection_weights_ptr, const float* projection_bias_ptr,
+    const float* input_gate_input_ptr, const float* forget_gate_input_ptr,
+    const float* cell_gate_input_ptr, const float* output_gate_input_ptr,
     const TfLiteLSTMParams* params, int n_batch, int n_cell, int n_input,
     int n_aux_input, int n_output, int output_batch_leading_dim,
     float* output_state_ptr, float* cell_state_ptr, float* scratch0,
@@ -822,8 +872,10 @@ inline void LstmStepFloat(
   float* cell_gate_scratch = scratch2;
   float* output_gate_scratch = scratch3;
 
-  // Check if inputs are all zeros so we can skip some computations.
+  // Check if inputs are all zeros so we can skip some computations. This isn't
+  // needed when the input contributions were precomputed.
   const bool is_input_all_zeros =
+      forget_gate_input_ptr == nullptr &&
       tensor_utils::IsZeroVector(input_ptr, n_batch * n_input);
   const bool is_aux_input_all_zeros =
       (aux_input_ptr == nullptr ||
@@ -837,7 +889,7 @@ inline void LstmStepFloat(
         cell_to_input_weights_ptr, input_layer_norm_coefficients_ptr,
         input_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
         /*activation=*/kTfLiteActSigmoid, input_gate_scratch,
-        is_input_all_zeros, is_aux_input_all_zeros);
+        is_input_all_zeros, is_aux_input_all_zeros, input_gate_input_ptr);
   }
   // Calculate the forget gate.
   CalculateLstmGateFloat(
@@ -847,7 +899,7 @@ inline void LstmStepFloat(
       cell_to_forget_weights_ptr, forget_layer_norm_coefficients_ptr,
       forget_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, forget_gate_scratch, is_input_all_zeros,
-      is_aux_input_all_zeros);
+      is_aux_input_all_zeros, forget_gate_input_ptr);
   // Calculate the cell update gate.
   CalculateLstmGateFloat(input_ptr, input_to_cell_weights_ptr, aux_input_ptr,
                          aux_input_to_cell_weights_ptr, output_state_ptr,
@@ -856,7 +908,8 @@ inline void LstmStepFloat(
                          cell_layer_norm_coefficients_ptr, cell_gate_bias_ptr,
                          n_batch, n_input, n_aux_input, n_output, n_cell,
                          params->activation, cell_gate_scratch,
-                         is_input_all_zeros, is_aux_input_all_zeros);
+                         is_input_all_zeros, is_aux_input_all_zeros,
+                         cell_gate_input_ptr);
   // Update the cell state.
   UpdateLstmCellFloat(n_batch, n_cell, cell_state_ptr, input_gate_scratch,
                       forget_gate_scratch, cell_gate_scratch, use_cifg,
@@ -869,7 +922,7 @@ inline void LstmStepFloat(
       cell_to_output_weights_ptr, output_layer_norm_coefficients_ptr,
       output_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, output_gate_scratch, is_input_all_zeros,
-      is_aux_input_all_zeros);
+      is_aux_input_all_zeros, output_gate_input_ptr);
   // Update the output state.
   CalculateLstmOutputFloat(n_batch, n_cell, n_output, cell_state_ptr,
                            output_gate_scratch, params->activation,
@@ -1711,6 +1764,62 @@ TfLiteStatus EvalFloat(
     output_gate_scratch = scratch_buffer_ptr + 3 * n_cell * n_batch;
   }
 
+  // If the scratch buffer has room for them after the gate scratches, the
+  // input contributions to the gates of up to kMaxPrecomputedTimeSteps steps
+  // are computed ahead of the recurrence, in one multiplication per gate. They
+  // are laid out like the gate scratches, with precomputed_steps times as many
+  // rows. This isn't done with an auxiliary input, whose steps are laid out
+  // with the stride of the input.
+  const int n_gates = use_cifg ? 3 : 4;
+  const int precomputed_steps = std::min(max_time, kMaxPrecomputedTimeSteps);
+  const int gate_input_size = precomputed_steps * n_batch * n_cell;
+  float* input_gate_input = nullptr;
+  float* forget_gate_input = nullptr;
+  float* cell_gate_input = nullptr;
+  float* output_gate_input = nullptr;
+  if (forward_sequence && max_time > 1 && aux_input == nullptr &&
+      scratch_buffer->bytes / sizeof(float) >=
+          n_gates * (n_batch * n_cell + gate_input_size)) {
+    float* gate_input_buffer = scratch_buffer_ptr + n_gates * n_batch * n_cell;
+    if (use_cifg) {
+      cell_gate_input = gate_input_buffer;
+      forget_gate_input = gate_input_buffer + gate_input_size;
+      output_gate_input = gate_input_buffer + 2 * gate_input_size;
+    } else {
+      input_gate_input = gate_input_buffer;
+      cell_gate_input = gate_input_buffer + gate_input_size;
+      forget_gate_input = gate_input_buffer + 2 * gate_input_size;
+      output_gate_input = gate_input_buffer + 3 * gate_input_size;
+    }
+  }
+  const bool use_layer_norm = (forget_layer_norm_coefficients != nullptr);
+  // Computes the gate inputs of n_rows rows of the input, starting at
+  // first_row.
+  auto precompute_gate_inputs = [&](int first_row, int n_rows) {
+    const float* input_ptr = GetTensorData<float>(input) + first_row * n_input;
+    if (!use_cifg) {
+      PrecomputeLstmGateInputFloat(
+          input_ptr, GetTensorData<float>(input_to_input_weights),
+          GetTensorData<float>(input_gate_bias), use_layer_norm, n_rows,
+          n_input, n_cell, input_gate_input);
+    }
+    PrecomputeLstmGateInputFloat(
+        input_ptr, GetTensorData<float>(input_to_forget_weights),
+        GetTensorData<float>(forget_gate_bias), use_layer_norm, n_rows, n_input,
+        n_cell, forget_gate_input);
+    PrecomputeLstmGateInputFloat(
+        input_ptr, GetTensorData<float>(input_to_cell_weights),
+        GetTensorData<float>(cell_gate_bias), use_layer_norm, n_rows, n_input,
+        n_cell, cell_gate_input);
+    PrecomputeLstmGateInputFloat(
+        input_ptr, GetTensorData<float>(input_to_output_weights),
+        GetTensorData<float>(output_gate_bias), use_layer_norm, n_rows, n_input,
+        n_cell, output_gate_input);
+  };
+  auto gate_input_at = [](const float* gate_input, int offset) -> const float* {
+    return gate_input ? gate_input + offset : nullptr;
+  };
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
@@ -1729,6 +1838,16 @@ TfLiteStatus EvalFloat(
       float* output_ptr =
           GetTensorData<float>(output) + t_rel * output_step + output_offset;
 
+      int gate_input_offset = 0;
+      if (forget_gate_input != nullptr) {
+        const int step = t % precomputed_steps;
+        if (step == 0) {
+          precompute_gate_inputs(
+              t * n_batch, std::min(precomputed_steps, max_time - t) * n_batch);
+        }
+        gate_input_offset = step * n_batch * n_cell;
+      }
+
       LstmStepFloat(
           input_ptr, GetTensorData<float>(input_to_input_weights),
           GetTensorData<float>(input_to_forget_weights),
@@ -1754,8 +1873,12 @@ TfLiteStatus EvalFloat(
           GetTensorData<float>(cell_gate_bias),
           GetTensorData<float>(output_gate_bias),
           GetTensorData<float>(projection_weights),
-          GetTensorData<float>(projection_bias), params, n_batch, n_cell,
-          n_input, aux_input_size, n_output, output_batch_leading_dim,
+          GetTensorData<float>(projection_bias),
+          gate_input_at(input_gate_input, gate_input_offset),
+          gate_input_at(forget_gate_input, gate_input_offset),
+          gate_input_at(cell_gate_input, gate_input_offset),
+          gate_input_at(output_gate_input, gate_input_offset), params, n_batch,
+          n_cell, n_input, aux_input_size, n_output, output_batch_leading_dim,
           GetTensorData<float>(output_state), GetTensorData<float>(cell_state),
           input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
           output_gate_scratch, output_ptr);
@@ -1790,6 +1913,16 @@ TfLiteStatus EvalFloat(
         float* cell_gate_scratch_ptr = cell_gate_scratch + b * n_cell;
         float* output_gate_scratch_ptr = output_gate_scratch + b * n_cell;
 
+        int gate_input_offset = 0;
+        if (forget_gate_input != nullptr) {
+          const int step = t % precomputed_steps;
+          if (step == 0) {
+            precompute_gate_inputs(time_offset,
+                                   std::min(precomputed_steps, max_time - t));
+          }
+          gate_input_offset = step * n_cell;
+        }
+
         LstmStepFloat(
             input_ptr, GetTensorData<float>(input_to_input_weights),
             GetTensorData<float>(input_to_forget_weights),
@@ -1815,9 +1948,14 @@ TfLiteStatus EvalFloat(
             GetTensorData<float>(cell_gate_bias),
             GetTensorData<float>(output_gate_bias),
             GetTensorData<float>(projection_weights),
-            GetTensorData<float>(projection_bias), params, /*n_batch=*/1,
-            n_cell, n_input, aux_input_size, n_output, output_batch_leading_dim,
-            output_state_ptr, cell_state_ptr, input_gate_scratch_ptr,
+            GetTensorData<float>(projection_bias),
+            gate_input_at(input_gate_input, gate_input_offset),
+            gate_input_at(forget_gate_input, gate_input_offset),
+            gate_input_at(cell_gate_input, gate_input_offset),
+            gate_input_at(output_gate_input, gate_input_offset), params,
+            /*n_batch=*/1, n_cell, n_input, aux_input_size, n_output,
+            output_batch_leading_dim, output_state_ptr, cell_state_ptr,
+            input_gate_scratch_ptr,
             forget_gate_scratch_ptr, cell_gate_scratch_ptr,
             output_gate_scratch_ptr, output_ptr);
       }
@@ -95,6 +95,14 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// The maximum number of time steps whose input contributions to the gates
+// EvalFloat computes ahead of the recurrence, in one batched multiplication per
+// gate. It only does so for forward sequences without auxiliary input, and when
+// the scratch buffer has room for them after the gate scratches, i.e. when it
+// holds n_batch * (1 + min(max_time, kMaxPrecomputedTimeSteps)) rows of
+// n_gates * n_cell floats.
+constexpr int kMaxPrecomputedTimeSteps = 16;
+
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
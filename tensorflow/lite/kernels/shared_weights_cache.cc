@@ -0,0 +1,63 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/shared_weights_cache.h"
+
+namespace tflite {
+
+SharedWeightsCache* SharedWeightsCache::Get() {
+  static SharedWeightsCache* cache = new SharedWeightsCache;
+  return cache;
+}
+
+std::shared_ptr<const void> SharedWeightsCache::GetOrDerive(
+    const void* weights, size_t weights_bytes, const std::string& kind,
+    size_t derived_bytes, const std::function<void(void*)>& derive) {
+  const Key key(weights, weights_bytes, kind);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    std::shared_ptr<const void> derived = it->second.lock();
+    if (derived) return derived;
+  }
+
+  // Deriving under the lock keeps interpreters that prepare the same model
+  // at the same time from each deriving their own copy.
+  std::shared_ptr<char> derived(new char[derived_bytes],
+                                std::default_delete<char[]>());
+  derive(derived.get());
+
+  // Drop the entries that no kernel holds anymore.
+  for (auto entry = entries_.begin(); entry != entries_.end();) {
+    if (entry->second.expired()) {
+      entry = entries_.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+  entries_[key] = derived;
+  return derived;
+}
+
+int SharedWeightsCache::num_entries() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int num_entries = 0;
+  for (const auto& entry : entries_) {
+    if (!entry.second.expired()) ++num_entries;
+  }
+  return num_entries;
+}
+
+}  // namespace tflite
@@ -0,0 +1,67 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_KERNELS_SHARED_WEIGHTS_CACHE_H_
+#define TENSORFLOW_LITE_KERNELS_SHARED_WEIGHTS_CACHE_H_
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <tuple>
+
+namespace tflite {
+
+// A process-wide cache of data that kernels derive from constant weights,
+// such as filters repacked into the layout an optimized kernel expects.
+//
+// Constant weights of interpreters built from the same FlatBufferModel point
+// into the same MMAPAllocation, so interpreters running the same model on
+// different threads find the same entries, and hold a single copy of the
+// derived data instead of one each. Each interpreter then only has its own
+// arena for activations.
+//
+// Entries are only kept alive by the kernels holding them. Weights that are
+// not constants of the model (i.e. not kTfLiteMmapRo) must not be cached,
+// since their contents could change under the same address.
+class SharedWeightsCache {
+ public:
+  // Returns the process-wide cache.
+  static SharedWeightsCache* Get();
+
+  // Returns the `derived_bytes` bytes of data derived as `kind` from the
+  // `weights_bytes` bytes of constant weights at `weights`. If no kernel holds
+  // them yet, `derive` is called to fill a new buffer. This is thread-safe,
+  // and `derive` is called once even if several interpreters ask for the same
+  // data at the same time.
+  std::shared_ptr<const void> GetOrDerive(
+      const void* weights, size_t weights_bytes, const std::string& kind,
+      size_t derived_bytes, const std::function<void(void*)>& derive);
+
+  // Returns the number of derived buffers currently alive.
+  int num_entries();
+
+ private:
+  using Key = std::tuple<const void*, size_t, std::string>;
+
+  std::mutex mutex_;
+  std::map<Key, std::weak_ptr<const void>> entries_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_SHARED_WEIGHTS_CACHE_H_
@@ -0,0 +1,73 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/shared_weights_cache.h"
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+TEST(SharedWeightsCache, SharesDerivedWeights) {
+  const float weights[4] = {1, 2, 3, 4};
+  int num_derivations = 0;
+  auto double_weights = [&](void* derived) {
+    ++num_derivations;
+    for (int i = 0; i < 4; ++i) {
+      static_cast<float*>(derived)[i] = 2 * weights[i];
+    }
+  };
+
+  SharedWeightsCache cache;
+  std::shared_ptr<const void> first = cache.GetOrDerive(
+      weights, sizeof(weights), "double", sizeof(weights), double_weights);
+  std::shared_ptr<const void> second = cache.GetOrDerive(
+      weights, sizeof(weights), "double", sizeof(weights), double_weights);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(num_derivations, 1);
+  EXPECT_EQ(static_cast<const float*>(first.get())[3], 8);
+
+  // Other kinds of derived data are kept apart.
+  std::shared_ptr<const void> other = cache.GetOrDerive(
+      weights, sizeof(weights), "other", sizeof(weights), double_weights);
+  EXPECT_NE(first.get(), other.get());
+  EXPECT_EQ(num_derivations, 2);
+  EXPECT_EQ(cache.num_entries(), 2);
+}
+
+TEST(SharedWeightsCache, DerivesAgainOnceReleased) {
+  const float weights[2] = {1, 2};
+  int num_derivations = 0;
+  auto copy_weights = [&](void* derived) {
+    ++num_derivations;
+    std::copy(weights, weights + 2, static_cast<float*>(derived));
+  };
+
+  SharedWeightsCache cache;
+  std::shared_ptr<const void> derived = cache.GetOrDerive(
+      weights, sizeof(weights), "copy", sizeof(weights), copy_weights);
+  derived.reset();
+  EXPECT_EQ(cache.num_entries(), 0);
+
+  derived = cache.GetOrDerive(weights, sizeof(weights), "copy",
+                              sizeof(weights), copy_weights);
+  EXPECT_EQ(num_derivations, 2);
+  EXPECT_EQ(cache.num_entries(), 1);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -75,13 +75,40 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   // Update the required buffer size.
   high_water_mark_ = std::max(high_water_mark_, best_offset + size);
   new_alloc->offset = best_offset;
+  InsertOrdered(*new_alloc);
+  return kTfLiteOk;
+}
 
-  auto insertion_it = ordered_allocs_.begin();
-  while (insertion_it != ordered_allocs_.end() && *insertion_it < *new_alloc) {
-    ++insertion_it;
+bool SimpleMemoryArena::AllocateAt(size_t offset, size_t alignment,
+                                   size_t size, int32_t tensor,
+                                   int32_t first_node, int32_t last_node,
+                                   ArenaAllocWithUsageInterval* new_alloc) {
+  if (alignment > arena_alignment_ || offset % alignment != 0) {
+    return false;
   }
-  ordered_allocs_.insert(insertion_it, *new_alloc);
-  return kTfLiteOk;
+  if (size != 0) {
+    for (const auto& alloc : ordered_allocs_) {
+      if (alloc.last_node < first_node || alloc.first_node > last_node) {
+        continue;
+      }
+      if (alloc.offset < offset + size && offset < alloc.offset + alloc.size) {
+        return false;
+      }
+    }
+  }
+
+  new_alloc->tensor = tensor;
+  new_alloc->first_node = first_node;
+  new_alloc->last_node = last_node;
+  new_alloc->size = size;
+  if (size == 0) {
+    new_alloc->offset = 0;
+    return true;
+  }
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+  new_alloc->offset = offset;
+  InsertOrdered(*new_alloc);
+  return true;
 }
 
 TfLiteStatus SimpleMemoryArena::Deallocate(
@@ -153,6 +180,15 @@ TfLiteStatus SimpleMemoryArena::ClearPlan() {
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::InsertOrdered(
+    const ArenaAllocWithUsageInterval& alloc) {
+  auto insertion_it = ordered_allocs_.begin();
+  while (insertion_it != ordered_allocs_.end() && *insertion_it < alloc) {
+    ++insertion_it;
+  }
+  ordered_allocs_.insert(insertion_it, alloc);
+}
+
 TfLiteStatus SimpleMemoryArena::ReleaseBuffer() {
   committed_ = false;
   underlying_buffer_size_ = 0;
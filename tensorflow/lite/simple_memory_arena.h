@@ -73,6 +73,14 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedule memory allocation for a tensor like Allocate() does, but at the
+  // given offset, e.g. one that was planned ahead of time. Returns false and
+  // leaves the arena unchanged if the offset isn't aligned, or if the tensor
+  // would overlap another one there whose usage interval intersects its own.
+  bool AllocateAt(size_t offset, size_t alignment, size_t size, int32_t tensor,
+                  int32_t first_node, int32_t last_node,
+                  ArenaAllocWithUsageInterval* new_alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context,
                           const ArenaAllocWithUsageInterval& alloc);
 
@@ -106,6 +114,9 @@ class SimpleMemoryArena {
   }
 
  private:
+  // Adds `alloc` to ordered_allocs_, keeping them sorted by offset.
+  void InsertOrdered(const ArenaAllocWithUsageInterval& alloc);
+
   bool committed_;
   size_t arena_alignment_;
   size_t high_water_mark_;
@@ -61,6 +61,24 @@ TEST(SimpleMemoryArenaTest, BasicZeroAlloc) {
   EXPECT_EQ(resolved_ptr, nullptr);
 }
 
+TEST(SimpleMemoryArenaTest, AllocateAtGivenOffset) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval allocs[4];
+
+  EXPECT_TRUE(arena.AllocateAt(2048, 32, 2047, 0, 0, 2, &allocs[0]));
+  EXPECT_EQ(allocs[0].offset, 2048);
+  // Overlaps tensor 0 while it is in use.
+  EXPECT_FALSE(arena.AllocateAt(1024, 32, 2047, 1, 1, 3, &allocs[1]));
+  // Isn't aligned.
+  EXPECT_FALSE(arena.AllocateAt(16, 32, 1023, 1, 1, 3, &allocs[1]));
+  // Uses the memory of tensor 0 after it was freed.
+  EXPECT_TRUE(arena.AllocateAt(2048, 32, 1023, 2, 3, 4, &allocs[2]));
+  // Online allocations fill the gap before the fixed ones.
+  ASSERT_EQ(arena.Allocate(&context, 32, 2047, 3, 1, 3, &allocs[3]), kTfLiteOk);
+  EXPECT_EQ(allocs[3].offset, 0);
+}
+
 TEST(SimpleMemoryArenaTest, InterleavedZeroAlloc) {
   TfLiteContext context;
   SimpleMemoryArena arena(64);
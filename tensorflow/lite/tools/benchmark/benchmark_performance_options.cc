@@ -353,12 +353,16 @@ void BenchmarkPerformanceOptions::Run() {
     single_option_run_->RemoveListeners(num_external_listeners);
 
     all_run_stats_->MarkBenchmarkStart(*single_option_run_params_);
-    single_option_run_->Run();
+    RunSingleOption();
   }
 
   all_run_stats_->OutputStats();
 }
 
+void BenchmarkPerformanceOptions::RunSingleOption() {
+  single_option_run_->Run();
+}
+
 void BenchmarkPerformanceOptions::Run(int argc, char** argv) {
   // We first parse flags for single-option runs to get information like
   // parameters of the input model etc.
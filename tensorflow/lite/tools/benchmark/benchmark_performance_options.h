@@ -107,6 +107,10 @@ class BenchmarkPerformanceOptions {
   virtual void ResetPerformanceOptions();
   virtual void CreatePerformanceOptions();
 
+  // Benchmarks the performance option currently set in
+  // 'single_option_run_params_'.
+  virtual void RunSingleOption();
+
   BenchmarkParams params_;
   std::vector<std::string> perf_options_;
 
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/lite/testing/util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_performance_options.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_throughput.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
 #include "tensorflow/lite/tools/delegates/delegate_provider.h"
 #include "tensorflow/lite/tools/logging.h"
@@ -373,6 +374,47 @@ TEST(BenchmarkTest, RunWithUseCaching) {
   EXPECT_EQ(kTfLiteOk, status);
 }
 
+class TestBenchmarkThroughput : public BenchmarkThroughput {
+ public:
+  explicit TestBenchmarkThroughput(BenchmarkModel* single_option_run)
+      : BenchmarkThroughput(single_option_run, []() {
+          return absl::make_unique<TestBenchmark>(CreateFp32Params());
+        }) {}
+
+  int num_outputs() const { return num_outputs_; }
+
+ protected:
+  void OutputThroughput(const ThroughputStats& stats) override {
+    BenchmarkThroughput::OutputThroughput(stats);
+    ++num_outputs_;
+
+    // Both instances run at least 'num_runs' inferences.
+    EXPECT_EQ(2, stats.num_instances);
+    EXPECT_GE(stats.num_inferences, 4);
+    EXPECT_GT(stats.inferences_per_second, 0.0);
+    EXPECT_GT(stats.p50_latency_us, 0);
+    EXPECT_LE(stats.p50_latency_us, stats.p90_latency_us);
+    EXPECT_LE(stats.p90_latency_us, stats.p99_latency_us);
+    for (const auto& cpu : stats.cpu_utilization) {
+      EXPECT_GE(cpu.second, 0.0);
+      EXPECT_LE(cpu.second, 1.0);
+    }
+  }
+
+ private:
+  int num_outputs_ = 0;
+};
+
+TEST(BenchmarkTest, DoesntCrashThroughput) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  TestBenchmark benchmark(CreateFp32Params());
+  TestBenchmarkThroughput throughput_benchmark(&benchmark);
+  ScopedCommandlineArgs scoped_argv(
+      {"--perf_options_list=none", "--num_instances=2", "--cpu_affinity=all"});
+  throughput_benchmark.Run(scoped_argv.argc(), scoped_argv.argv());
+  EXPECT_EQ(1, throughput_benchmark.num_outputs());
+}
+
 class MaxDurationWorksTestListener : public BenchmarkListener {
   void OnBenchmarkEnd(const BenchmarkResults& results) override {
     const int64_t num_actual_runs = results.inference_time_us().count();
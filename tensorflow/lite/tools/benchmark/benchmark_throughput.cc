@@ -0,0 +1,255 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_throughput.h"
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <iomanip>
+#include <mutex>  // NOLINT(build/c++11)
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/memory/memory.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Holds back the instances until all of them are about to start their regular
+// runs, or have failed before, and samples the CPU times when it releases them.
+class StartBarrier {
+ public:
+  explicit StartBarrier(int num_instances) : num_waiting_(num_instances) {}
+
+  void Arrive() {
+    std::unique_lock<std::mutex> lock(mu_);
+    if (--num_waiting_ == 0) {
+      Release();
+    } else {
+      released_.wait(lock, [this] { return num_waiting_ == 0; });
+    }
+  }
+
+  void Withdraw() {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (--num_waiting_ == 0) Release();
+  }
+
+  // Only valid once all the instances have arrived or withdrawn.
+  int64_t release_us() const { return release_us_; }
+  const std::vector<util::CpuTimes>& release_cpu_times() const {
+    return release_cpu_times_;
+  }
+
+ private:
+  void Release() {
+    release_cpu_times_ = util::GetCpuTimes();
+    release_us_ = profiling::time::NowMicros();
+    released_.notify_all();
+  }
+
+  std::mutex mu_;
+  std::condition_variable released_;
+  int num_waiting_;
+  int64_t release_us_ = 0;
+  std::vector<util::CpuTimes> release_cpu_times_;
+};
+
+// Records the latency of each regular run of an instance.
+class InstanceLatencyRecorder : public BenchmarkListener {
+ public:
+  explicit InstanceLatencyRecorder(StartBarrier* barrier) : barrier_(barrier) {}
+
+  void OnSingleRunStart(RunType run_type) override {
+    is_regular_run_ = run_type == REGULAR;
+    if (is_regular_run_ && !arrived_) {
+      arrived_ = true;
+      barrier_->Arrive();
+    }
+    run_start_us_ = profiling::time::NowMicros();
+  }
+
+  void OnSingleRunEnd() override {
+    if (!is_regular_run_) return;
+    last_run_end_us_ = profiling::time::NowMicros();
+    latencies_us_.push_back(last_run_end_us_ - run_start_us_);
+  }
+
+  // Lets the other instances go on if this one failed before its regular runs.
+  void OnInstanceEnd() {
+    if (!arrived_) barrier_->Withdraw();
+  }
+
+  const std::vector<int64_t>& latencies_us() const { return latencies_us_; }
+  int64_t last_run_end_us() const { return last_run_end_us_; }
+
+ private:
+  StartBarrier* const barrier_;
+  bool arrived_ = false;
+  bool is_regular_run_ = false;
+  int64_t run_start_us_ = 0;
+  int64_t last_run_end_us_ = 0;
+  std::vector<int64_t> latencies_us_;
+};
+
+// Returns the nearest-rank 'percentile' of the sorted 'values'.
+int64_t Percentile(const std::vector<int64_t>& values, int percentile) {
+  if (values.empty()) return 0;
+  const size_t rank = (values.size() * percentile + 99) / 100;
+  return values[std::max<size_t>(rank, 1) - 1];
+}
+
+}  // namespace
+
+BenchmarkThroughput::BenchmarkThroughput(BenchmarkModel* single_option_run,
+                                         InstanceFactory create_instance)
+    : BenchmarkPerformanceOptions(DefaultParams(), single_option_run,
+                                  absl::make_unique<MultiRunStatsRecorder>()),
+      create_instance_(std::move(create_instance)) {}
+
+BenchmarkParams BenchmarkThroughput::DefaultParams() {
+  BenchmarkParams params = BenchmarkPerformanceOptions::DefaultParams();
+  params.AddParam("num_instances", BenchmarkParam::Create<int32_t>(1));
+  params.AddParam("cpu_affinity", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("pin_instances_to_cpus", BenchmarkParam::Create<bool>(false));
+  return params;
+}
+
+std::vector<Flag> BenchmarkThroughput::GetFlags() {
+  std::vector<Flag> flags = BenchmarkPerformanceOptions::GetFlags();
+  flags.push_back(CreateFlag<int32_t>(
+      "num_instances", &params_,
+      "The number of instances of the model to run concurrently, each with "
+      "its own interpreter."));
+  flags.push_back(CreateFlag<std::string>(
+      "cpu_affinity", &params_,
+      "The CPUs to run the instances on, as a comma-separated list of CPU ids "
+      "and ranges like '0-3,6', or 'big' or 'little' for a cluster of an ARM "
+      "big.LITTLE SoC, or 'all'. By default, the instances aren't pinned."));
+  flags.push_back(CreateFlag<bool>(
+      "pin_instances_to_cpus", &params_,
+      "Whether to pin each instance to a single CPU of --cpu_affinity, in "
+      "turn, instead of letting all instances share them."));
+  return flags;
+}
+
+void BenchmarkThroughput::RunSingleOption() {
+  const int num_instances = params_.Get<int32_t>("num_instances");
+  if (num_instances < 1) {
+    TFLITE_LOG(ERROR) << "--num_instances must be positive, but is "
+                      << num_instances;
+    return;
+  }
+  std::vector<int> cpus;
+  const std::string& cpu_affinity = params_.Get<std::string>("cpu_affinity");
+  if (!cpu_affinity.empty() && !util::ParseCpuSet(cpu_affinity, &cpus)) {
+    TFLITE_LOG(ERROR) << "Cannot parse --cpu_affinity: '" << cpu_affinity
+                      << "'. Please double-check its value.";
+    return;
+  }
+  const bool pin_instances = params_.Get<bool>("pin_instances_to_cpus");
+
+  std::vector<BenchmarkModel*> instances = {single_option_run_};
+  std::vector<std::unique_ptr<BenchmarkModel>> owned_instances;
+  for (int i = 1; i < num_instances; ++i) {
+    owned_instances.push_back(create_instance_());
+    owned_instances.back()->mutable_params()->Merge(*single_option_run_params_,
+                                                    true /* overwrite */);
+    instances.push_back(owned_instances.back().get());
+  }
+
+  StartBarrier barrier(num_instances);
+  std::vector<std::unique_ptr<InstanceLatencyRecorder>> recorders;
+  const int num_listeners = single_option_run_->NumListeners();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_instances; ++i) {
+    recorders.push_back(absl::make_unique<InstanceLatencyRecorder>(&barrier));
+    instances[i]->AddListener(recorders.back().get());
+    std::vector<int> instance_cpus = cpus;
+    if (pin_instances && !cpus.empty()) {
+      instance_cpus = {cpus[i % cpus.size()]};
+    }
+    threads.emplace_back([instance = instances[i],
+                          recorder = recorders.back().get(), instance_cpus]() {
+      if (!instance_cpus.empty() &&
+          !util::SetCurrentThreadAffinity(instance_cpus)) {
+        TFLITE_LOG(WARN) << "Failed to set the CPU affinity of an instance.";
+      }
+      instance->Run();
+      recorder->OnInstanceEnd();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  const auto end_cpu_times = util::GetCpuTimes();
+  single_option_run_->RemoveListeners(num_listeners);
+
+  ThroughputStats stats;
+  stats.num_instances = num_instances;
+  std::vector<int64_t> latencies_us;
+  int64_t end_us = barrier.release_us();
+  for (const auto& recorder : recorders) {
+    latencies_us.insert(latencies_us.end(), recorder->latencies_us().begin(),
+                        recorder->latencies_us().end());
+    end_us = std::max(end_us, recorder->last_run_end_us());
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  stats.num_inferences = latencies_us.size();
+  if (end_us > barrier.release_us()) {
+    stats.inferences_per_second =
+        stats.num_inferences * 1e6 / (end_us - barrier.release_us());
+  }
+  stats.p50_latency_us = Percentile(latencies_us, 50);
+  stats.p90_latency_us = Percentile(latencies_us, 90);
+  stats.p99_latency_us = Percentile(latencies_us, 99);
+
+  // Only report the CPUs the instances were pinned to, if any.
+  const auto& start_cpu_times = barrier.release_cpu_times();
+  const int num_cpus = std::min(start_cpu_times.size(), end_cpu_times.size());
+  for (int cpu = 0; cpu < num_cpus; ++cpu) {
+    if (!cpus.empty() &&
+        std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+      continue;
+    }
+    const auto total = end_cpu_times[cpu].total - start_cpu_times[cpu].total;
+    if (total == 0) continue;
+    const auto busy = end_cpu_times[cpu].busy - start_cpu_times[cpu].busy;
+    stats.cpu_utilization.emplace_back(cpu, static_cast<double>(busy) / total);
+  }
+  OutputThroughput(stats);
+}
+
+void BenchmarkThroughput::OutputThroughput(const ThroughputStats& stats) {
+  std::stringstream stream;
+  stream << std::fixed << std::setprecision(1) << stats.num_instances
+         << " instance(s) ran " << stats.num_inferences << " inferences at "
+         << stats.inferences_per_second << " QPS, with latencies (us) of p50="
+         << stats.p50_latency_us << " p90=" << stats.p90_latency_us
+         << " p99=" << stats.p99_latency_us << ".";
+  if (!stats.cpu_utilization.empty()) {
+    stream << " CPU utilization:";
+    for (const auto& cpu : stats.cpu_utilization) {
+      stream << " cpu" << cpu.first << "=" << cpu.second * 100.0 << "%";
+    }
+  }
+  TFLITE_LOG(INFO) << stream.str();
+}
+
+}  // namespace benchmark
+}  // namespace tflite
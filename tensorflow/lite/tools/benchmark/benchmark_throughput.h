@@ -0,0 +1,82 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_THROUGHPUT_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_THROUGHPUT_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_performance_options.h"
+
+namespace tflite {
+namespace benchmark {
+
+struct ThroughputStats {
+  int num_instances = 0;
+  // The number of inferences all instances ran, and how many of them ran per
+  // second.
+  int64_t num_inferences = 0;
+  double inferences_per_second = 0.0;
+  // Percentiles of the latency of all inferences.
+  int64_t p50_latency_us = 0;
+  int64_t p90_latency_us = 0;
+  int64_t p99_latency_us = 0;
+  // The fraction of the time each CPU was busy, as (CPU id, utilization) pairs.
+  // Empty if the CPU times aren't available.
+  std::vector<std::pair<int, double>> cpu_utilization;
+};
+
+// Benchmarks the throughput of a model by running several instances of it
+// concurrently, for each performance option like BenchmarkPerformanceOptions,
+// e.g. to size servers. The instances start their regular runs together, after
+// their warmup runs.
+//
+// The instances can be pinned to a set of CPUs, either all sharing the set or
+// each one having a CPU of it to itself. The threads an instance creates, like
+// those of the interpreter, inherit its affinity.
+class BenchmarkThroughput : public BenchmarkPerformanceOptions {
+ public:
+  // Creates another instance of the model of 'single_option_run'.
+  using InstanceFactory = std::function<std::unique_ptr<BenchmarkModel>()>;
+
+  // Doesn't own the memory of 'single_option_run', which runs as the first
+  // instance.
+  BenchmarkThroughput(BenchmarkModel* single_option_run,
+                      InstanceFactory create_instance);
+
+  ~BenchmarkThroughput() override {}
+
+ protected:
+  static BenchmarkParams DefaultParams();
+
+  std::vector<Flag> GetFlags() override;
+  void RunSingleOption() override;
+
+  virtual void OutputThroughput(const ThroughputStats& stats);
+
+ private:
+  InstanceFactory create_instance_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_THROUGHPUT_H_
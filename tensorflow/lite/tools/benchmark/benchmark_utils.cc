@@ -15,6 +15,15 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <thread>  // NOLINT(build/c++11)
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sched.h>
+#endif
+
 #include "tensorflow/lite/profiling/time.h"
 
 namespace tflite {
@@ -32,6 +41,122 @@ void SleepForSeconds(double sleep_seconds) {
       static_cast<uint64_t>(sleep_seconds * 1e6));
 }
 
+namespace {
+
+// Parses a list like "0-3,6" as used by the Linux sysfs.
+bool ParseCpuList(const std::string& list, std::vector<int>* cpus) {
+  std::vector<std::string> ranges;
+  if (!SplitAndParse(list, ',', &ranges)) return false;
+  for (const auto& range : ranges) {
+    std::vector<int> bounds;
+    if (range.empty() || !std::isdigit(range.front()) ||
+        !std::isdigit(range.back()) ||
+        range.find_first_not_of("0123456789-") != std::string::npos ||
+        !SplitAndParse(range, '-', &bounds) || bounds.size() > 2 ||
+        bounds.back() < bounds.front()) {
+      return false;
+    }
+    for (int cpu = bounds.front(); cpu <= bounds.back(); ++cpu) {
+      cpus->push_back(cpu);
+    }
+  }
+  return true;
+}
+
+std::vector<int> GetOnlineCpus() {
+  std::vector<int> cpus;
+  std::ifstream online("/sys/devices/system/cpu/online");
+  std::string list;
+  if (online >> list && ParseCpuList(list, &cpus) && !cpus.empty()) {
+    return cpus;
+  }
+  cpus.clear();
+  const int num_cpus = std::max(1u, std::thread::hardware_concurrency());
+  for (int cpu = 0; cpu < num_cpus; ++cpu) cpus.push_back(cpu);
+  return cpus;
+}
+
+// Returns the maximum frequency of 'cpu' in kHz, or 0 if it's unknown.
+int64_t GetCpuMaxFreq(int cpu) {
+  std::ifstream max_freq("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                         "/cpufreq/cpuinfo_max_freq");
+  int64_t freq = 0;
+  return max_freq >> freq ? freq : 0;
+}
+
+}  // namespace
+
+bool ParseCpuSet(const std::string& spec, std::vector<int>* cpus) {
+  cpus->clear();
+  if (spec != "all" && spec != "big" && spec != "little") {
+    if (!ParseCpuList(spec, cpus)) return false;
+    std::sort(cpus->begin(), cpus->end());
+    cpus->erase(std::unique(cpus->begin(), cpus->end()), cpus->end());
+    return !cpus->empty();
+  }
+
+  *cpus = GetOnlineCpus();
+  if (spec == "all") return true;
+
+  // If the frequencies are unknown, the CPUs are treated as all alike.
+  std::vector<int64_t> max_freqs;
+  for (const int cpu : *cpus) max_freqs.push_back(GetCpuMaxFreq(cpu));
+  const int64_t bound =
+      spec == "big" ? *std::max_element(max_freqs.begin(), max_freqs.end())
+                    : *std::min_element(max_freqs.begin(), max_freqs.end());
+  std::vector<int> selected;
+  for (int i = 0; i < cpus->size(); ++i) {
+    if (max_freqs[i] == bound) selected.push_back((*cpus)[i]);
+  }
+  cpus->swap(selected);
+  return true;
+}
+
+bool SetCurrentThreadAffinity(const std::vector<int>& cpus) {
+#if defined(__linux__) || defined(__ANDROID__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (const int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    CPU_SET(cpu, &cpu_set);
+  }
+  // A pid of 0 stands for the calling thread.
+  return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#else
+  return false;
+#endif
+}
+
+std::vector<CpuTimes> GetCpuTimes() {
+  std::vector<CpuTimes> cpu_times;
+  std::ifstream stat("/proc/stat");
+  std::string line;
+  while (std::getline(stat, line)) {
+    // Lines look like "cpu3 user nice system idle iowait irq softirq ...",
+    // after one "cpu ..." line with the totals of all CPUs.
+    int cpu;
+    if (line.compare(0, 3, "cpu") != 0 || line.size() < 4 ||
+        !std::isdigit(line[3]) ||
+        !(std::istringstream(line.substr(3)) >> cpu)) {
+      continue;
+    }
+    std::istringstream fields(line.substr(line.find(' ')));
+    CpuTimes times;
+    uint64_t value;
+    for (int i = 0; fields >> value; ++i) {
+      // Steal time and later fields are either accounted elsewhere or not
+      // spent on this system.
+      if (i >= 7) break;
+      times.total += value;
+      // Idle and iowait time.
+      if (i != 3 && i != 4) times.busy += value;
+    }
+    if (cpu >= cpu_times.size()) cpu_times.resize(cpu + 1);
+    cpu_times[cpu] = times;
+  }
+  return cpu_times;
+}
+
 }  // namespace util
 }  // namespace benchmark
 }  // namespace tflite
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_UTILS_H_
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_UTILS_H_
 
+#include <cstdint>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -45,6 +46,26 @@ bool SplitAndParse(const std::string& str, char delim, std::vector<T>* values) {
   return true;
 }
 
+// Parses a set of CPUs given as a comma-separated list of CPU ids and ranges,
+// e.g. "0-3,6". Besides, "all" selects every online CPU, while "big" and
+// "little" select the CPUs with the highest and the lowest maximum frequency
+// respectively, which are the big and LITTLE clusters on ARM big.LITTLE SoCs.
+bool ParseCpuSet(const std::string& spec, std::vector<int>* cpus);
+
+// Restricts the calling thread, and threads it creates afterwards, to 'cpus'.
+// Returns false if the affinity can't be set, e.g. on unsupported platforms.
+bool SetCurrentThreadAffinity(const std::vector<int>& cpus);
+
+// Cumulative time of one CPU, in clock ticks.
+struct CpuTimes {
+  uint64_t busy = 0;
+  uint64_t total = 0;
+};
+
+// Returns the cumulative times of each CPU, indexed by CPU id, or an empty
+// vector if they aren't available.
+std::vector<CpuTimes> GetCpuTimes();
+
 }  // namespace util
 }  // namespace benchmark
 }  // namespace tflite
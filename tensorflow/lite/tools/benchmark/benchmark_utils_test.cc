@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -75,6 +76,44 @@ TEST(BenchmarkHelpersTest, SplitAndParseInts) {
   EXPECT_EQ(2, results[1]);
 }
 
+TEST(BenchmarkHelpersTest, ParseCpuSet) {
+  std::vector<int> cpus;
+  EXPECT_TRUE(util::ParseCpuSet("4-6,0,5", &cpus));
+  EXPECT_THAT(cpus, testing::ElementsAre(0, 4, 5, 6));
+
+  EXPECT_FALSE(util::ParseCpuSet("", &cpus));
+  EXPECT_FALSE(util::ParseCpuSet("3-1", &cpus));
+  EXPECT_FALSE(util::ParseCpuSet("0,-1", &cpus));
+  EXPECT_FALSE(util::ParseCpuSet("middle", &cpus));
+}
+
+TEST(BenchmarkHelpersTest, ParseCpuSetOfClusters) {
+  std::vector<int> all_cpus;
+  ASSERT_TRUE(util::ParseCpuSet("all", &all_cpus));
+  EXPECT_FALSE(all_cpus.empty());
+
+  // Every CPU is either in the big or in the LITTLE cluster, or in both if
+  // they're all alike.
+  std::vector<int> big_cpus;
+  std::vector<int> little_cpus;
+  ASSERT_TRUE(util::ParseCpuSet("big", &big_cpus));
+  ASSERT_TRUE(util::ParseCpuSet("little", &little_cpus));
+  EXPECT_FALSE(big_cpus.empty());
+  EXPECT_FALSE(little_cpus.empty());
+  for (const int cpu : all_cpus) {
+    EXPECT_TRUE(std::count(big_cpus.begin(), big_cpus.end(), cpu) ||
+                std::count(little_cpus.begin(), little_cpus.end(), cpu))
+        << cpu;
+  }
+}
+
+TEST(BenchmarkHelpersTest, GetCpuTimes) {
+  const auto cpu_times = util::GetCpuTimes();
+  for (const auto& times : cpu_times) {
+    EXPECT_LE(times.busy, times.total);
+  }
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tflite
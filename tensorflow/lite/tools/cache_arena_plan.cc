@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/cache_arena_plan.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/arena_planner.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+
+namespace tflite {
+
+TfLiteStatus CacheArenaPlan(const Model* model, const OpResolver& op_resolver,
+                            flatbuffers::FlatBufferBuilder* builder,
+                            ErrorReporter* error_reporter) {
+  std::unique_ptr<Interpreter> interpreter;
+  if (InterpreterBuilder(model, op_resolver, error_reporter)(&interpreter) !=
+      kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Failed to build the interpreter.");
+    return kTfLiteError;
+  }
+  // Plan from scratch, rather than from the offsets cached already.
+  for (int i = 0; i < interpreter->subgraphs_size(); ++i) {
+    Subgraph* subgraph = interpreter->subgraph(i);
+    TF_LITE_ENSURE_STATUS(subgraph->SetOfflineArenaOffsets({}));
+    TF_LITE_ENSURE_STATUS(subgraph->SetCompareArenaOrderings(true));
+  }
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Failed to allocate the tensors.");
+    return kTfLiteError;
+  }
+
+  std::unique_ptr<ModelT> model_t(model->UnPack());
+  // Drop the offsets cached earlier. Their buffers are emptied rather than
+  // removed, so that the indices of the other buffers don't change.
+  for (auto it = model_t->metadata.begin(); it != model_t->metadata.end();) {
+    if ((*it)->name == kArenaOffsetsMetadataName) {
+      if ((*it)->buffer < model_t->buffers.size()) {
+        model_t->buffers[(*it)->buffer]->data.clear();
+      }
+      it = model_t->metadata.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (int i = 0; i < static_cast<int>(model_t->subgraphs.size()); ++i) {
+    // Offsets are only cached for the tensors of the model, not for the
+    // temporaries kernels add to it.
+    const int num_tensors = model_t->subgraphs[i]->tensors.size();
+    std::vector<int32_t> offsets = interpreter->subgraph(i)->GetArenaOffsets();
+    offsets.resize(num_tensors, -1);
+    bool has_offsets = false;
+    for (int32_t offset : offsets) {
+      has_offsets |= offset >= 0;
+    }
+    if (!has_offsets) continue;
+
+    std::vector<int32_t> values = {kArenaOffsetsMetadataVersion, i,
+                                   num_tensors};
+    values.insert(values.end(), offsets.begin(), offsets.end());
+    std::unique_ptr<BufferT> buffer(new BufferT);
+    buffer->data.resize(values.size() * sizeof(int32_t));
+    memcpy(buffer->data.data(), values.data(), buffer->data.size());
+    std::unique_ptr<MetadataT> metadata(new MetadataT);
+    metadata->name = kArenaOffsetsMetadataName;
+    metadata->buffer = model_t->buffers.size();
+    model_t->buffers.push_back(std::move(buffer));
+    model_t->metadata.push_back(std::move(metadata));
+  }
+
+  builder->Clear();
+  FinishModelBuffer(*builder, Model::Pack(*builder, model_t.get()));
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
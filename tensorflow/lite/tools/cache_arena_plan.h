@@ -0,0 +1,43 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_CACHE_ARENA_PLAN_H_
+#define TENSORFLOW_LITE_TOOLS_CACHE_ARENA_PLAN_H_
+
+#include "flatbuffers/flatbuffers.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Plans the memory arena of each subgraph of `model`, trying both the
+// greedy-by-size and the greedy-by-breadth orderings of its tensors and
+// keeping whichever needs less memory, and writes the model with the
+// resulting offsets cached in its metadata to `builder`. Loading that model
+// then places the tensors at these offsets instead of planning them again.
+// Offsets cached by an earlier call are replaced.
+//
+// The plan is made for the shapes the model's inputs have in the model, and
+// for an interpreter without delegates other than the default ones; tensors
+// whose cached offset doesn't suit the interpreter that loads the model are
+// planned at runtime as usual.
+TfLiteStatus CacheArenaPlan(const Model* model, const OpResolver& op_resolver,
+                            flatbuffers::FlatBufferBuilder* builder,
+                            ErrorReporter* error_reporter);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_CACHE_ARENA_PLAN_H_
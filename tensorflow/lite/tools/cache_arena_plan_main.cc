@@ -0,0 +1,58 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/stderr_reporter.h"
+#include "tensorflow/lite/tools/cache_arena_plan.h"
+
+// Plans the memory arena of a model ahead of time, and caches the plan in the
+// model's metadata, see tflite::CacheArenaPlan().
+//
+// Note: This is a private API, subject to change.
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    printf(
+        "Wrong number of arguments. Example: cache_arena_plan_main "
+        "${input} ${output}\n");
+    return 1;
+  }
+
+  tflite::ErrorReporter* error_reporter = tflite::DefaultErrorReporter();
+  std::unique_ptr<tflite::FlatBufferModel> model =
+      tflite::FlatBufferModel::BuildFromFile(argv[1], error_reporter);
+  if (!model) {
+    printf("Failed to read %s\n", argv[1]);
+    return 1;
+  }
+  tflite::ops::builtin::BuiltinOpResolver resolver;
+  flatbuffers::FlatBufferBuilder builder;
+  if (tflite::CacheArenaPlan(model->GetModel(), resolver, &builder,
+                             error_reporter) != kTfLiteOk) {
+    return 1;
+  }
+
+  std::ofstream output(argv[2], std::ios::out | std::ios::binary);
+  output.write(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+               builder.GetSize());
+  if (!output) {
+    printf("Failed to write %s\n", argv[2]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,90 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/cache_arena_plan.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/arena_planner.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+
+namespace tflite {
+namespace {
+
+// Returns the offsets cached in `model`, or nothing if there are none or
+// more than one set of them.
+std::vector<int32_t> GetCachedValues(const Model* model) {
+  std::vector<int32_t> values;
+  if (!model->metadata()) return values;
+  int num_found = 0;
+  for (const Metadata* metadata : *model->metadata()) {
+    if (metadata->name()->str() != kArenaOffsetsMetadataName) continue;
+    const flatbuffers::Vector<uint8_t>* data =
+        model->buffers()->Get(metadata->buffer())->data();
+    values.resize(data->size() / sizeof(int32_t));
+    memcpy(values.data(), data->data(), values.size() * sizeof(int32_t));
+    ++num_found;
+  }
+  if (num_found != 1) values.clear();
+  return values;
+}
+
+TEST(CacheArenaPlanTest, LoadedModelUsesCachedOffsets) {
+  std::unique_ptr<FlatBufferModel> model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_add.bin");
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  flatbuffers::FlatBufferBuilder builder;
+  ASSERT_EQ(CacheArenaPlan(model->GetModel(), resolver, &builder,
+                           DefaultErrorReporter()),
+            kTfLiteOk);
+
+  const Model* cached_model = GetModel(builder.GetBufferPointer());
+  const std::vector<int32_t> values = GetCachedValues(cached_model);
+  const int num_tensors = cached_model->subgraphs()->Get(0)->tensors()->size();
+  ASSERT_EQ(values.size(), 3 + num_tensors);
+  EXPECT_EQ(values[0], kArenaOffsetsMetadataVersion);
+  EXPECT_EQ(values[1], 0);
+  EXPECT_EQ(values[2], num_tensors);
+
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(cached_model, resolver)(&interpreter),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  std::vector<int32_t> offsets = interpreter->subgraph(0)->GetArenaOffsets();
+  offsets.resize(num_tensors);
+  EXPECT_EQ(offsets, std::vector<int32_t>(values.begin() + 3, values.end()));
+
+  // Caching the plan again replaces it.
+  flatbuffers::FlatBufferBuilder recached_builder;
+  ASSERT_EQ(CacheArenaPlan(cached_model, resolver, &recached_builder,
+                           DefaultErrorReporter()),
+            kTfLiteOk);
+  EXPECT_EQ(GetCachedValues(GetModel(recached_builder.GetBufferPointer())),
+            values);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
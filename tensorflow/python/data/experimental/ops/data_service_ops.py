@@ -35,11 +35,12 @@ from tensorflow.python.util.tf_export import tf_export
 
 class ProcessingMode(object):
   PARALLEL_EPOCHS = "parallel_epochs"
+  ONE_EPOCH = "one_epoch"
 
   @staticmethod
   def validate(mode):
     """Raises a ValueError if the given object is not a valid processing mode."""
-    valid_modes = [ProcessingMode.PARALLEL_EPOCHS]
+    valid_modes = [ProcessingMode.PARALLEL_EPOCHS, ProcessingMode.ONE_EPOCH]
     if mode not in valid_modes:
       raise ValueError(
           "{0} is not a valid processing mode. Valid modes: {1}".format(
@@ -303,7 +304,7 @@ def distribute(processing_mode,
   iteration.
 
   The `processing_mode` argument controls what data is produced by a tf.data
-  service job. Currently, the only supported mode is "parallel_epochs".
+  service job. The supported modes are "parallel_epochs" and "one_epoch".
 
   processing_mode="parallel_epochs" means that multiple tf.data workers will
   iterate through the dataset in parallel, each producing all elements of the
@@ -314,9 +315,13 @@ def distribute(processing_mode,
   your dataset, so that different tf.data workers will iterate through the
   dataset in different orders.
 
-  In the future, there will be additional processing modes. For example,
-  a "one_epoch" mode which partitions the dataset across the tf.data
-  workers, so that the consumers see each element of the dataset only once.
+  processing_mode="one_epoch" means that the dataset is divided into splits
+  which are handed out to the tf.data workers one at a time, so that the
+  consumers see each element of the dataset only once. Workers which finish
+  their split early are given another one, so faster workers process more of
+  the dataset. The dataset is split the same way
+  `tf.data.experimental.AutoShardPolicy.AUTO` shards it: by files when it reads
+  from files, and by elements otherwise.
 
   ```
   dataset = tf.data.Dataset.range(5)
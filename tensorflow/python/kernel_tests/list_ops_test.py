@@ -175,6 +175,28 @@ class ListOpsTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     with context.device("gpu:0"):
       self._testStack(max_num_elements)
 
+  def testStackAfterPushesOfLargeElements(self):
+    # Elements of 64 bytes are appended in place to the storage of the list.
+    l = list_ops.empty_tensor_list(
+        element_dtype=dtypes.float32, element_shape=[16])
+    for i in range(20):
+      l = list_ops.tensor_list_push_back(l, array_ops.fill([16], float(i)))
+    # Lists pushed to from the same list don't overwrite each other.
+    l1 = list_ops.tensor_list_push_back(l, array_ops.fill([16], 20.0))
+    l2 = list_ops.tensor_list_push_back(l, array_ops.fill([16], 21.0))
+    l3, _ = list_ops.tensor_list_pop_back(l, element_dtype=dtypes.float32)
+    l3 = list_ops.tensor_list_push_back(l3, array_ops.fill([16], 22.0))
+    t, t1, t2, t3 = self.evaluate([
+        list_ops.tensor_list_stack(x, element_dtype=dtypes.float32)
+        for x in (l, l1, l2, l3)
+    ])
+    expected = np.tile(np.arange(20, dtype=np.float32)[:, None], [1, 16])
+    self.assertAllEqual(t, expected)
+    self.assertAllEqual(t1, np.concatenate([expected, np.full([1, 16], 20.0)]))
+    self.assertAllEqual(t2, np.concatenate([expected, np.full([1, 16], 21.0)]))
+    self.assertAllEqual(
+        t3, np.concatenate([expected[:19], np.full([1, 16], 22.0)]))
+
   @parameterized.named_parameters(("NoMaxNumElements", None),
                                   ("WithMaxNumElements", 3))
   @test_util.run_deprecated_v1
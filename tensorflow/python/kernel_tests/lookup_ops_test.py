@@ -41,6 +41,7 @@ from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import control_flow_ops
+from tensorflow.python.ops import gen_lookup_ops
 from tensorflow.python.ops import lookup_ops
 from tensorflow.python.ops import map_fn
 from tensorflow.python.ops import string_ops
@@ -1249,6 +1250,28 @@ class DenseHashTableOpTest(test.TestCase):
       result = self.evaluate(output)
       self.assertAllEqual([0, -1, -1], result)
 
+  def testLookupLargeBatch(self):
+    with self.cached_session():
+      num_keys = 20000
+      keys = np.arange(1, num_keys + 1, dtype=np.int64)
+      values = np.stack([keys * 2, keys * 3], axis=1)
+      table = lookup_ops.DenseHashTable(
+          dtypes.int64,
+          dtypes.int64,
+          default_value=[-1, -1],
+          empty_key=0,
+          deleted_key=-1)
+      self.evaluate(table.insert(keys, values))
+      self.assertAllEqual(num_keys, self.evaluate(table.size()))
+
+      # Enough keys for the batched probe loop to run on several threads, half
+      # of them missing from the table.
+      query = np.arange(1, 2 * num_keys + 1, dtype=np.int64)
+      expected = np.where(
+          np.expand_dims(query <= num_keys, 1),
+          np.stack([query * 2, query * 3], axis=1), [-1, -1])
+      self.assertAllEqual(expected, self.evaluate(table.lookup(query)))
+
   def testBasicBool(self):
     with self.cached_session():
 
@@ -3535,6 +3558,265 @@ class MutableHashTableOpTest(test.TestCase):
       result = self.evaluate(output)
       self.assertAllEqual((b"brain", b"salad", b"n/a"), result)
 
+  def testMutableShardedHashTable(self):
+    with self.cached_session():
+      default_val = -1
+      keys = constant_op.constant(["brain", "salad", "surgery", "tarkus"])
+      values = constant_op.constant([0, 1, 2, 3], dtypes.int64)
+      table = lookup_ops.MutableHashTable(
+          dtypes.string, dtypes.int64, default_val, num_shards=3)
+      self.assertAllEqual(0, self.evaluate(table.size()))
+
+      self.evaluate(table.insert(keys, values))
+      self.assertAllEqual(4, self.evaluate(table.size()))
+
+      remove_string = constant_op.constant(["tarkus", "tank"])
+      self.evaluate(table.remove(remove_string))
+      self.assertAllEqual(3, self.evaluate(table.size()))
+
+      input_string = constant_op.constant(["brain", "salad", "tank"])
+      output = table.lookup(input_string)
+      self.assertAllEqual([3], output.get_shape())
+      self.assertAllEqual([0, 1, -1], self.evaluate(output))
+
+      # Reinserting a removed key reuses its deleted bucket.
+      self.evaluate(table.insert(["tarkus"], [7]))
+      self.assertAllEqual(4, self.evaluate(table.size()))
+      self.assertAllEqual([7], self.evaluate(table.lookup(["tarkus"])))
+
+      exported_keys, exported_values = table.export()
+      sorted_keys = np.sort(self.evaluate(exported_keys))
+      sorted_values = np.sort(self.evaluate(exported_values))
+      self.assertAllEqual([b"brain", b"salad", b"surgery", b"tarkus"],
+                          sorted_keys)
+      self.assertAllEqual([0, 1, 2, 7], sorted_values)
+
+  def testMutableShardedHashTableOfTensors(self):
+    with self.cached_session():
+      default_val = constant_op.constant([-1, -1], dtypes.int64)
+      keys = constant_op.constant([3, 1, 4, 1], dtypes.int64)
+      values = constant_op.constant([[0, 1], [2, 3], [4, 5], [6, 7]],
+                                    dtypes.int64)
+      table = lookup_ops.MutableHashTable(
+          dtypes.int64, dtypes.int64, default_val, num_shards=2)
+
+      # The last value of a repeated key wins.
+      self.evaluate(table.insert(keys, values))
+      self.assertAllEqual(3, self.evaluate(table.size()))
+
+      output = table.lookup(constant_op.constant([[1, 3], [4, 5]],
+                                                 dtypes.int64))
+      self.assertAllEqual([2, 2, 2], output.get_shape())
+      self.assertAllEqual([[[6, 7], [0, 1]], [[4, 5], [-1, -1]]],
+                          self.evaluate(output))
+
+      exported_keys, exported_values = table.export()
+      self.assertAllEqual(3, self.evaluate(exported_keys).size)
+      self.assertAllEqual(6, self.evaluate(exported_values).size)
+
+  def testMutableShardedHashTableLargeBatch(self):
+    with self.cached_session():
+      num_keys = 10000
+      keys = np.arange(num_keys, dtype=np.int64) * 7
+      values = np.arange(num_keys, dtype=np.float32)
+      table = lookup_ops.MutableHashTable(
+          dtypes.int64, dtypes.float32, -1.0, num_shards=8)
+
+      # Large enough to grow every shard and to run on the threadpool.
+      self.evaluate(table.insert(keys, values))
+      self.assertAllEqual(num_keys, self.evaluate(table.size()))
+      self.assertAllEqual(values, self.evaluate(table.lookup(keys)))
+      self.assertAllEqual(
+          np.full([num_keys], -1.0, dtype=np.float32),
+          self.evaluate(table.lookup(keys + 1)))
+
+      self.evaluate(table.remove(keys[::2]))
+      self.assertAllEqual(num_keys // 2, self.evaluate(table.size()))
+      expected = np.where(np.arange(num_keys) % 2 == 0, -1.0, values)
+      self.assertAllEqual(expected, self.evaluate(table.lookup(keys)))
+
+      # Import replaces the contents of the table.
+      table2 = lookup_ops.MutableHashTable(
+          dtypes.int64, dtypes.float32, -1.0, num_shards=4)
+      self.evaluate(table2.insert([1], [5.0]))
+      exported_keys, exported_values = table.export()
+      self.evaluate(
+          gen_lookup_ops.lookup_table_import_v2(table2.resource_handle,
+                                                exported_keys,
+                                                exported_values))
+      self.assertAllEqual(num_keys // 2, self.evaluate(table2.size()))
+      self.assertAllEqual(expected, self.evaluate(table2.lookup(keys)))
+      self.assertAllEqual([-1.0], self.evaluate(table2.lookup([1])))
+
+  def testMutableShardedHashTableInvalidNumShards(self):
+    with self.assertRaisesRegex(ValueError, "num_shards must be positive"):
+      lookup_ops.MutableHashTable(
+          dtypes.int64, dtypes.float32, -1.0, num_shards=0)
+
+
+class TieredHashTableOpTest(test.TestCase):
+
+  def testLookupAcrossTiers(self):
+    with self.cached_session():
+      default_val = constant_op.constant([-1, -1], dtypes.int64)
+      keys = constant_op.constant([1, 2, 3, 4, 5], dtypes.int64)
+      values = constant_op.constant([[1, 1], [2, 2], [3, 3], [4, 4], [5, 5]],
+                                    dtypes.int64)
+      table = lookup_ops.TieredHashTable(
+          dtypes.int64,
+          dtypes.int64,
+          default_val,
+          hot_capacity=2,
+          cold_storage_dir=self.get_temp_dir())
+      self.evaluate(table.insert(keys, values))
+      # Entries evicted to the cold tier still count.
+      self.assertAllEqual(5, self.evaluate(table.size()))
+
+      output = table.lookup(constant_op.constant([1, 5, 3, 6], dtypes.int64))
+      self.assertAllEqual([[1, 1], [5, 5], [3, 3], [-1, -1]],
+                          self.evaluate(output))
+
+      self.evaluate(table.remove(constant_op.constant([1, 4], dtypes.int64)))
+      self.assertAllEqual(3, self.evaluate(table.size()))
+      output = table.lookup(constant_op.constant([1, 2, 4], dtypes.int64))
+      self.assertAllEqual([[-1, -1], [2, 2], [-1, -1]], self.evaluate(output))
+
+      # Overwriting a cold key replaces its value.
+      self.evaluate(table.insert([2], [[7, 7]]))
+      self.assertAllEqual([[7, 7]], self.evaluate(table.lookup([2])))
+
+  def testLfuEviction(self):
+    with self.cached_session():
+      table = lookup_ops.TieredHashTable(
+          dtypes.string,
+          dtypes.float32,
+          -1.0,
+          hot_capacity=2,
+          eviction_policy="lfu")
+      self.evaluate(table.insert(["a", "b"], [1.0, 2.0]))
+      for _ in range(3):
+        self.evaluate(table.lookup(["a"]))
+      self.evaluate(table.insert(["c", "d"], [3.0, 4.0]))
+      self.assertAllEqual(4, self.evaluate(table.size()))
+      self.assertAllClose([1.0, 2.0, 3.0, 4.0, -1.0],
+                          self.evaluate(table.lookup(["a", "b", "c", "d",
+                                                      "e"])))
+
+  def testExportImport(self):
+    with self.cached_session():
+      num_keys = 3000
+      keys = np.arange(num_keys, dtype=np.int64)
+      values = keys.astype(np.float32) * 0.5
+      table = lookup_ops.TieredHashTable(
+          dtypes.int64, dtypes.float32, -1.0, hot_capacity=100)
+      self.evaluate(table.insert(keys, values))
+      # Rewriting every key leaves enough garbage to compact the cold tier.
+      self.evaluate(table.insert(keys, values))
+      self.assertAllEqual(num_keys, self.evaluate(table.size()))
+
+      exported_keys, exported_values = self.evaluate(table.export())
+      order = np.argsort(exported_keys)
+      self.assertAllEqual(keys, exported_keys[order])
+      self.assertAllClose(values, exported_values[order])
+
+      table2 = lookup_ops.TieredHashTable(
+          dtypes.int64, dtypes.float32, -1.0, hot_capacity=10)
+      self.evaluate(table2.insert([num_keys], [1.0]))
+      self.evaluate(
+          gen_lookup_ops.lookup_table_import_v2(table2.resource_handle,
+                                                exported_keys,
+                                                exported_values))
+      self.assertAllEqual(num_keys, self.evaluate(table2.size()))
+      self.assertAllClose(values, self.evaluate(table2.lookup(keys)))
+
+  def testInvalidArguments(self):
+    with self.assertRaisesRegex(ValueError, "hot_capacity must be positive"):
+      lookup_ops.TieredHashTable(
+          dtypes.int64, dtypes.float32, -1.0, hot_capacity=0)
+    with self.assertRaisesRegex(ValueError, "eviction_policy"):
+      lookup_ops.TieredHashTable(
+          dtypes.int64,
+          dtypes.float32,
+          -1.0,
+          hot_capacity=1,
+          eviction_policy="fifo")
+
+
+class AdmissionHashTableOpTest(test.TestCase):
+
+  def testAdmissionThreshold(self):
+    with self.cached_session():
+      table = lookup_ops.AdmissionHashTable(
+          dtypes.int64, dtypes.float32, -1.0, min_frequency=3)
+      for value in [1.0, 2.0]:
+        self.evaluate(table.insert([1], [value]))
+        self.assertAllEqual(0, self.evaluate(table.size()))
+      self.evaluate(table.insert([1], [3.0]))
+      self.assertAllClose([3.0], self.evaluate(table.lookup([1])))
+
+      # Repeats within one batch count, and the admitting insert's value wins.
+      self.evaluate(table.insert([2, 2, 2], [4.0, 5.0, 6.0]))
+      self.assertAllClose([3.0, 6.0, -1.0],
+                          self.evaluate(table.lookup([1, 2, 3])))
+
+      # Admitted keys are updated on every insert.
+      self.evaluate(table.insert([1], [7.0]))
+      self.assertAllClose([7.0], self.evaluate(table.lookup([1])))
+
+  def testEvictIdleEntries(self):
+    with self.cached_session():
+      default_val = constant_op.constant([-1, -1], dtypes.int64)
+      table = lookup_ops.AdmissionHashTable(dtypes.int64, dtypes.int64,
+                                            default_val)
+      self.evaluate(table.insert([1, 2, 3], [[1, 1], [2, 2], [3, 3]]))
+      self.evaluate(table.insert([4], [[4, 4]]))
+      self.evaluate(table.lookup([1]))
+      self.evaluate(table.insert([5], [[5, 5]]))
+
+      # Keys 2 and 3 were last touched two inserts ago.
+      self.assertAllEqual(2, self.evaluate(table.evict(max_idle_steps=1)))
+      self.assertAllEqual(3, self.evaluate(table.size()))
+      self.assertAllEqual([[1, 1], [-1, -1], [-1, -1], [4, 4], [5, 5]],
+                          self.evaluate(table.lookup([1, 2, 3, 4, 5])))
+      self.assertAllEqual(0, self.evaluate(table.evict(max_idle_steps=1)))
+
+  def testExportImport(self):
+    with self.cached_session():
+      keys = ["a", "b", "c"]
+      values = [[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]]
+      table = lookup_ops.AdmissionHashTable(dtypes.string, dtypes.float32,
+                                            [0.0, 0.0])
+      self.evaluate(table.insert(keys, values))
+      exported_keys, exported_values = self.evaluate(table.export())
+      self.assertAllEqual([3, 2], exported_values.shape)
+
+      table2 = lookup_ops.AdmissionHashTable(
+          dtypes.string, dtypes.float32, [0.0, 0.0], min_frequency=5)
+      # Restored entries are admitted regardless of min_frequency.
+      self.evaluate(
+          gen_lookup_ops.lookup_table_import_v2(table2.resource_handle,
+                                                exported_keys,
+                                                exported_values))
+      self.assertAllClose(values, self.evaluate(table2.lookup(keys)))
+
+  def testInvalidArguments(self):
+    with self.assertRaisesRegex(ValueError, "min_frequency must be positive"):
+      lookup_ops.AdmissionHashTable(
+          dtypes.int64, dtypes.float32, -1.0, min_frequency=0)
+    with self.cached_session():
+      table = lookup_ops.AdmissionHashTable(dtypes.int64, dtypes.float32, -1.0)
+      with self.assertRaisesOpError("must be non-negative"):
+        self.evaluate(table.evict(max_idle_steps=-1))
+
+  def testEvictUnsupported(self):
+    with self.cached_session():
+      table = lookup_ops.MutableHashTable(dtypes.int64, dtypes.float32, -1.0)
+      with self.assertRaisesOpError("does not support eviction"):
+        self.evaluate(
+            gen_lookup_ops.lookup_table_evict_v2(
+                table.resource_handle,
+                constant_op.constant(1, dtypes.int64)))
+
 
 class MutableHashTableBenchmark(test.Benchmark):
 
@@ -3584,6 +3866,13 @@ class MutableHashTableBenchmark(test.Benchmark):
       assert sess.run(size) >= 1000 * 32
 
 
+class MutableShardedHashTableBenchmark(MutableHashTableBenchmark):
+
+  def _create_table(self):
+    return lookup_ops.MutableHashTable(
+        dtypes.int64, dtypes.float32, 0.0, num_shards=16)
+
+
 class DenseHashTableBenchmark(MutableHashTableBenchmark):
 
   def _create_table(self):
@@ -298,6 +298,58 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
     read = resource_variable_ops.read_variable_op(handle, dtype=dtypes.int32)
     self.assertEqual(self.evaluate(read), [[3]])
 
+  @test_util.run_in_graph_and_eager_modes
+  def testScatterAddRelaxed(self):
+    handle = resource_variable_ops.var_handle_op(
+        dtype=dtypes.float32, shape=[4, 2])
+    self.evaluate(
+        resource_variable_ops.assign_variable_op(
+            handle, array_ops.zeros([4, 2], dtype=dtypes.float32)))
+    indices = np.random.randint(0, 4, size=5000)
+    updates = np.random.rand(5000, 2).astype(np.float32)
+    self.evaluate(
+        resource_variable_ops.resource_scatter_add(
+            handle, indices, updates, relaxed=True))
+    expected = np.zeros([4, 2], dtype=np.float32)
+    np.add.at(expected, indices, updates)
+    read = resource_variable_ops.read_variable_op(handle, dtype=dtypes.float32)
+    self.assertAllClose(expected, self.evaluate(read), rtol=1e-4)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testScatterUpdateRelaxedScalarUpdate(self):
+    handle = resource_variable_ops.var_handle_op(
+        dtype=dtypes.int32, shape=[3, 2])
+    self.evaluate(
+        resource_variable_ops.assign_variable_op(
+            handle, constant_op.constant([[1, 2], [3, 4], [5, 6]])))
+    self.evaluate(
+        resource_variable_ops.resource_scatter_update(
+            handle, [0, 2], 7, relaxed=True))
+    read = resource_variable_ops.read_variable_op(handle, dtype=dtypes.int32)
+    self.assertAllEqual([[7, 7], [3, 4], [7, 7]], self.evaluate(read))
+
+  def testScatterAddRelaxedDoesNotMutateEarlierRead(self):
+    with context.eager_mode():
+      v = resource_variable_ops.ResourceVariable([[1.0], [2.0]])
+      before = v.read_value()
+      self.evaluate(
+          resource_variable_ops.resource_scatter_add(
+              v.handle, [1], [[3.0]], relaxed=True))
+      self.assertAllEqual([[1.0], [2.0]], before)
+      self.assertAllEqual([[1.0], [5.0]], v.read_value())
+
+  @test_util.run_in_graph_and_eager_modes
+  def testScatterAddRelaxedOutOfRange(self):
+    handle = resource_variable_ops.var_handle_op(
+        dtype=dtypes.float32, shape=[2, 1])
+    self.evaluate(
+        resource_variable_ops.assign_variable_op(
+            handle, constant_op.constant([[1.0], [2.0]])))
+    with self.assertRaisesOpError("is not in"):
+      self.evaluate(
+          resource_variable_ops.resource_scatter_add(
+              handle, [2], [[1.0]], relaxed=True))
+
   @test_util.run_in_graph_and_eager_modes
   def testGradientGatherNd(self):
     v = resource_variable_ops.ResourceVariable(
@@ -59,6 +59,25 @@ class UniqueTest(test.TestCase):
     for i in range(len(x)):
       self.assertEqual(x[i], tf_y[tf_idx[i]].decode('ascii'))
 
+  def _assertUniqueInFirstOccurrenceOrder(self, x, tf_y, tf_idx):
+    _, first = np.unique(x, return_index=True)
+    self.assertAllEqual(x[np.sort(first)], tf_y)
+    self.assertAllEqual(x, tf_y[tf_idx])
+
+  def testInt64Large(self):
+    # Large enough to be uniquified on several threads.
+    x = np.random.randint(-2**40, high=2**40, size=1 << 18, dtype=np.int64)
+    x = np.concatenate([x, x[::-3]])
+    y, idx = array_ops.unique(x)
+    tf_y, tf_idx = self.evaluate([y, idx])
+    self._assertUniqueInFirstOccurrenceOrder(x, tf_y, tf_idx)
+
+  def testInt64Sorted(self):
+    x = np.sort(np.random.randint(0, high=1000, size=7000, dtype=np.int64))
+    y, idx = array_ops.unique(x)
+    tf_y, tf_idx = self.evaluate([y, idx])
+    self._assertUniqueInFirstOccurrenceOrder(x, tf_y, tf_idx)
+
   def testInt32Axis(self):
     for dtype in [np.int32, np.int64]:
       with self.subTest(dtype=dtype):
@@ -349,6 +349,39 @@ class BatchOpsTest(test.TestCase):
                                   ".*2 arguments.*but 1.*"):
         sess.run([result], feed_dict={inp: [2]})
 
+  def testBatchFunctionOpWithDifferentShapes(self):
+    """Tests that inputs of different shapes are batched separately."""
+    if context.executing_eagerly():
+      return
+    with self.cached_session() as sess:
+      inp = array_ops.placeholder(dtype=dtypes.int32)
+
+      @function.Defun(dtypes.int32)
+      def computation(in_t):
+        return in_t + 1
+
+      result = gen_batch_ops.batch_function(
+          num_batch_threads=1,
+          max_batch_size=10,
+          batch_timeout_micros=100000,  # 100ms
+          batching_queue="",
+          f=computation,
+          in_tensors=[inp],
+          captured_tensors=computation.captured_inputs,
+          Tout=[o.type for o in computation.definition.signature.output_arg])
+
+      thread_results = []
+
+      def worker():
+        thread_results.extend(sess.run([result], feed_dict={inp: [[1, 2]]}))
+
+      worker_thread = threading.Thread(target=worker)
+      worker_thread.start()
+      main_results = sess.run([result], feed_dict={inp: [[3, 4, 5]]})
+      worker_thread.join()
+      self.assertAllEqual(thread_results[0], [[2, 3]])
+      self.assertAllEqual(main_results[0], [[4, 5, 6]])
+
   def testBatchFunctionOpWithLargeBatchSplitted(self):
     """Tests that the batch_function op works with large batch splitted."""
     if context.executing_eagerly():
@@ -1695,7 +1695,8 @@ class MutableHashTable(LookupInterface):
                value_dtype,
                default_value,
                name="MutableHashTable",
-               checkpoint=True):
+               checkpoint=True,
+               num_shards=None):
     """Creates an empty `MutableHashTable` object.
 
     Creates a table, the type of its keys and values are specified by key_dtype
@@ -1709,17 +1710,24 @@ class MutableHashTable(LookupInterface):
       checkpoint: if True, the contents of the table are saved to and restored
         from checkpoints. If `shared_name` is empty for a checkpointed table, it
         is shared using the table node name.
+      num_shards: If set, the table is split over this many independently
+        locked shards, which reduces lock contention when many sessions or
+        threads look up and insert keys concurrently.
 
     Returns:
       A `MutableHashTable` object.
 
     Raises:
-      ValueError: If checkpoint is True and no name was specified.
+      ValueError: If checkpoint is True and no name was specified, or if
+        num_shards is not positive.
     """
+    if num_shards is not None and num_shards <= 0:
+      raise ValueError("num_shards must be positive, got %d." % num_shards)
     self._default_value = ops.convert_to_tensor(
         default_value, dtype=value_dtype)
     self._value_shape = self._default_value.get_shape()
     self._checkpoint = checkpoint
+    self._num_shards = num_shards
     self._key_dtype = key_dtype
     self._value_dtype = value_dtype
     self._name = name
@@ -1745,7 +1753,16 @@ class MutableHashTable(LookupInterface):
     # training to work correctly. Use the node name if no shared_name has been
     # explicitly specified.
     use_node_name_sharing = self._checkpoint and self._shared_name is None
-    if self._default_value.get_shape().ndims == 0:
+    if self._num_shards is not None:
+      table_ref = gen_lookup_ops.mutable_sharded_hash_table(
+          shared_name=self._shared_name,
+          use_node_name_sharing=use_node_name_sharing,
+          key_dtype=self._key_dtype,
+          value_dtype=self._value_dtype,
+          value_shape=self._default_value.get_shape(),
+          num_shards=self._num_shards,
+          name=self._name)
+    elif self._default_value.get_shape().ndims == 0:
       table_ref = gen_lookup_ops.mutable_hash_table_v2(
           shared_name=self._shared_name,
           use_node_name_sharing=use_node_name_sharing,
@@ -1911,6 +1928,186 @@ class MutableHashTable(LookupInterface):
                                                        restored_tensors[1])
 
 
+class TieredHashTable(MutableHashTable):
+  """A mutable hash table that keeps only its hottest entries in memory.
+
+  At most `hot_capacity` entries are held in memory. Beyond that, the least
+  recently or least frequently used entries are evicted to a file in
+  `cold_storage_dir` and promoted back into memory when they are looked up.
+  Values must be numeric.
+
+  Example usage:
+
+  ```python
+  table = TieredHashTable(key_dtype=tf.int64, value_dtype=tf.float32,
+                          default_value=[0.0] * 64, hot_capacity=1 << 20,
+                          cold_storage_dir="/mnt/ssd/embeddings")
+  sess.run(table.insert(keys, values))
+  out = table.lookup(query_keys)
+  ```
+  """
+
+  def __init__(self,
+               key_dtype,
+               value_dtype,
+               default_value,
+               hot_capacity,
+               eviction_policy="lru",
+               cold_storage_dir=None,
+               name="TieredHashTable",
+               checkpoint=True):
+    """Creates an empty `TieredHashTable` object.
+
+    Args:
+      key_dtype: the type of the key tensors.
+      value_dtype: the type of the value tensors.
+      default_value: The value to use if a key is missing in the table.
+      hot_capacity: The maximum number of entries kept in memory.
+      eviction_policy: Either "lru" or "lfu", the order in which entries are
+        evicted from memory.
+      cold_storage_dir: Directory for the file that holds evicted entries. A
+        local temporary file is used if not set.
+      name: A name for the operation (optional).
+      checkpoint: if True, the contents of the table are saved to and restored
+        from checkpoints. If `shared_name` is empty for a checkpointed table, it
+        is shared using the table node name.
+
+    Returns:
+      A `TieredHashTable` object.
+
+    Raises:
+      ValueError: If hot_capacity is not positive or eviction_policy is not
+        supported.
+    """
+    if hot_capacity <= 0:
+      raise ValueError("hot_capacity must be positive, got %d." % hot_capacity)
+    if eviction_policy not in ("lru", "lfu"):
+      raise ValueError("eviction_policy must be 'lru' or 'lfu', got %s." %
+                       eviction_policy)
+    self._hot_capacity = hot_capacity
+    self._eviction_policy = eviction_policy
+    self._cold_storage_dir = cold_storage_dir or ""
+    super(TieredHashTable, self).__init__(
+        key_dtype, value_dtype, default_value, name=name, checkpoint=checkpoint)
+
+  def _create_resource(self):
+    use_node_name_sharing = self._checkpoint and self._shared_name is None
+    table_ref = gen_lookup_ops.mutable_tiered_hash_table(
+        shared_name=self._shared_name,
+        use_node_name_sharing=use_node_name_sharing,
+        key_dtype=self._key_dtype,
+        value_dtype=self._value_dtype,
+        value_shape=self._default_value.get_shape(),
+        hot_capacity=self._hot_capacity,
+        eviction_policy=self._eviction_policy,
+        cold_storage_dir=self._cold_storage_dir,
+        name=self._name)
+    if context.executing_eagerly():
+      self._table_name = None
+    else:
+      self._table_name = table_ref.op.name.split("/")[-1]
+    return table_ref
+
+
+class AdmissionHashTable(MutableHashTable):
+  """A mutable hash table that only admits keys once they are frequent.
+
+  A key that is not in the table is admitted only once it has been inserted
+  `min_frequency` times, as estimated by a count-min sketch; earlier inserts of
+  the key are dropped. The table counts one step per `insert` call and records
+  the step of the last lookup or insert of each entry, so that `evict` can
+  remove the entries that have been idle for a number of steps. Together they
+  bound the memory and checkpoint size of tables keyed by streaming ids.
+
+  Example usage:
+
+  ```python
+  table = AdmissionHashTable(key_dtype=tf.int64, value_dtype=tf.float32,
+                             default_value=[0.0] * 64, min_frequency=3)
+  sess.run(table.insert(keys, values))
+  out = table.lookup(query_keys)
+  num_evicted = sess.run(table.evict(max_idle_steps=10000))
+  ```
+  """
+
+  def __init__(self,
+               key_dtype,
+               value_dtype,
+               default_value,
+               min_frequency=1,
+               sketch_width=1 << 18,
+               sketch_depth=4,
+               name="AdmissionHashTable",
+               checkpoint=True):
+    """Creates an empty `AdmissionHashTable` object.
+
+    Args:
+      key_dtype: the type of the key tensors.
+      value_dtype: the type of the value tensors.
+      default_value: The value to use if a key is missing in the table.
+      min_frequency: The number of inserts of a key before it is admitted.
+      sketch_width: The number of counters in each row of the count-min sketch.
+      sketch_depth: The number of rows of the count-min sketch.
+      name: A name for the operation (optional).
+      checkpoint: if True, the contents of the table are saved to and restored
+        from checkpoints. If `shared_name` is empty for a checkpointed table, it
+        is shared using the table node name.
+
+    Returns:
+      An `AdmissionHashTable` object.
+
+    Raises:
+      ValueError: If min_frequency, sketch_width or sketch_depth is not
+        positive.
+    """
+    for arg_name, value in (("min_frequency", min_frequency),
+                            ("sketch_width", sketch_width),
+                            ("sketch_depth", sketch_depth)):
+      if value < 1:
+        raise ValueError("%s must be positive, got %d." % (arg_name, value))
+    self._min_frequency = min_frequency
+    self._sketch_width = sketch_width
+    self._sketch_depth = sketch_depth
+    super(AdmissionHashTable, self).__init__(
+        key_dtype, value_dtype, default_value, name=name, checkpoint=checkpoint)
+
+  def _create_resource(self):
+    use_node_name_sharing = self._checkpoint and self._shared_name is None
+    table_ref = gen_lookup_ops.mutable_admission_hash_table(
+        shared_name=self._shared_name,
+        use_node_name_sharing=use_node_name_sharing,
+        key_dtype=self._key_dtype,
+        value_dtype=self._value_dtype,
+        value_shape=self._default_value.get_shape(),
+        min_frequency=self._min_frequency,
+        sketch_width=self._sketch_width,
+        sketch_depth=self._sketch_depth,
+        name=self._name)
+    if context.executing_eagerly():
+      self._table_name = None
+    else:
+      self._table_name = table_ref.op.name.split("/")[-1]
+    return table_ref
+
+  def evict(self, max_idle_steps, name=None):
+    """Removes the entries that have been idle for `max_idle_steps` steps.
+
+    Args:
+      max_idle_steps: A scalar int64. Entries that have not been looked up or
+        inserted during this many `insert` calls are removed.
+      name: A name for the operation (optional).
+
+    Returns:
+      A scalar int64 tensor with the number of removed entries.
+    """
+    with ops.name_scope(name, "%s_lookup_table_evict" % self.name,
+                        (self.resource_handle, max_idle_steps)):
+      max_idle_steps = ops.convert_to_tensor(
+          max_idle_steps, dtype=dtypes.int64, name="max_idle_steps")
+      return gen_lookup_ops.lookup_table_evict_v2(self.resource_handle,
+                                                  max_idle_steps)
+
+
 @tf_export("lookup.experimental.DenseHashTable")
 class DenseHashTable(LookupInterface):
   """A generic mutable hash table implementation using tensors as backing store.
@@ -2227,3 +2424,7 @@ ops.NotDifferentiable("MutableHashTable")
 ops.NotDifferentiable("MutableHashTableV2")
 ops.NotDifferentiable("MutableHashTableOfTensors")
 ops.NotDifferentiable("MutableHashTableOfTensorsV2")
+ops.NotDifferentiable("MutableShardedHashTable")
+ops.NotDifferentiable("MutableTieredHashTable")
+ops.NotDifferentiable("MutableAdmissionHashTable")
+ops.NotDifferentiable("LookupTableEvictV2")
@@ -389,6 +389,110 @@ class TrainingOpsTest(TensorFlowTestCase):
       indices = np.array([0, 2]).astype(index_type)
       self._testTypesForSparseFtrlMultiplyLinearByLr(x, y, z, lr, grad, indices)
 
+  def _dedupe(self, grad, indices):
+    unique_indices, inverse = np.unique(indices, return_inverse=True)
+    summed = np.zeros((len(unique_indices),) + grad.shape[1:], grad.dtype)
+    np.add.at(summed, inverse, grad)
+    return summed, unique_indices.astype(indices.dtype)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceFusedSparseApplyAdagradV2DuplicateIndices(self):
+    for (dtype, index_type) in itertools.product([np.float32, np.float64],
+                                                 [np.int32, np.int64]):
+      x = np.arange(12).reshape(4, 3).astype(dtype)
+      y = np.arange(1, 13).reshape(4, 3).astype(dtype)
+      lr = np.array(0.5).astype(dtype)
+      epsilon = np.array(0.1).astype(dtype)
+      grad = np.arange(18).reshape(6, 3).astype(dtype)
+      indices = np.array([2, 0, 2, 3, 0, 2]).astype(index_type)
+
+      var = resource_variable_ops.ResourceVariable(x)
+      accum = resource_variable_ops.ResourceVariable(y)
+      self.evaluate(variables.global_variables_initializer())
+      self.evaluate(
+          training_ops.resource_fused_sparse_apply_adagrad_v2(
+              var.handle, accum.handle, lr, epsilon, grad, indices))
+
+      summed, unique_indices = self._dedupe(grad, indices)
+      y[unique_indices] += summed * summed
+      x[unique_indices] -= lr * summed / (np.sqrt(y[unique_indices]) + epsilon)
+      self.assertAllCloseAccordingToType(y, self.evaluate(accum))
+      self.assertAllCloseAccordingToType(x, self.evaluate(var))
+
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceFusedSparseApplyAdagradV2LargeBatch(self):
+    np.random.seed(0)
+    x = np.random.rand(100, 4)
+    y = np.random.rand(100, 4) + 0.1
+    grad = np.random.rand(20000, 4)
+    indices = np.random.randint(0, 100, size=20000).astype(np.int64)
+
+    var = resource_variable_ops.ResourceVariable(x)
+    accum = resource_variable_ops.ResourceVariable(y)
+    self.evaluate(variables.global_variables_initializer())
+    self.evaluate(
+        training_ops.resource_fused_sparse_apply_adagrad_v2(
+            var.handle, accum.handle, np.float64(0.01), np.float64(1e-7),
+            grad, indices))
+
+    summed, unique_indices = self._dedupe(grad, indices)
+    y[unique_indices] += summed * summed
+    x[unique_indices] -= 0.01 * summed / (np.sqrt(y[unique_indices]) + 1e-7)
+    self.assertAllClose(y, self.evaluate(accum))
+    self.assertAllClose(x, self.evaluate(var))
+
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceFusedSparseApplyFtrlMatchesDedupedFtrlV2(self):
+    for multiply_linear_by_lr in [False, True]:
+      np.random.seed(1)
+      x = np.random.rand(10, 2)
+      y = np.random.rand(10, 2) + 0.1
+      z = np.random.rand(10, 2)
+      grad = np.random.rand(50, 2)
+      indices = np.random.randint(0, 10, size=50).astype(np.int32)
+      summed, unique_indices = self._dedupe(grad, indices)
+
+      fused_vars = [
+          resource_variable_ops.ResourceVariable(v) for v in (x, y, z)
+      ]
+      ref_vars = [resource_variable_ops.ResourceVariable(v) for v in (x, y, z)]
+      self.evaluate(variables.global_variables_initializer())
+      self.evaluate(
+          training_ops.resource_fused_sparse_apply_ftrl(
+              *[v.handle for v in fused_vars],
+              grad=grad,
+              indices=indices,
+              lr=0.1,
+              l1=0.01,
+              l2=0.02,
+              l2_shrinkage=0.03,
+              lr_power=-0.5,
+              multiply_linear_by_lr=multiply_linear_by_lr))
+      self.evaluate(
+          training_ops.resource_sparse_apply_ftrl_v2(
+              *[v.handle for v in ref_vars],
+              grad=summed,
+              indices=unique_indices,
+              lr=0.1,
+              l1=0.01,
+              l2=0.02,
+              l2_shrinkage=0.03,
+              lr_power=-0.5,
+              multiply_linear_by_lr=multiply_linear_by_lr))
+      for fused, ref in zip(fused_vars, ref_vars):
+        self.assertAllClose(self.evaluate(ref), self.evaluate(fused))
+
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceFusedSparseApplyAdagradV2OutOfRange(self):
+    var = resource_variable_ops.ResourceVariable(np.zeros((3, 2)))
+    accum = resource_variable_ops.ResourceVariable(np.ones((3, 2)))
+    self.evaluate(variables.global_variables_initializer())
+    with self.assertRaisesOpError("out of range"):
+      self.evaluate(
+          training_ops.resource_fused_sparse_apply_adagrad_v2(
+              var.handle, accum.handle, np.float64(0.1), np.float64(0.1),
+              np.ones((2, 2)), np.array([0, 3], np.int32)))
+
   @test_util.run_v1_only("ApplyAdam op returns a ref, so it is not "
                          "supported in eager mode.")
   def testApplyAdam(self):
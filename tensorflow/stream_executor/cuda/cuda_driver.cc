@@ -925,6 +925,110 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return res;
 }
 
+#if CUDA_VERSION >= 10010
+
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_THREAD_LOCAL),
+      "Error beginning capture on CUDA stream");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      CUgraph* graph) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, graph),
+                           "Error ending capture on CUDA stream");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(GpuContext* context,
+                                                      CUgraph graph,
+                                                      CUgraphExec* graph_exec) {
+  ScopedActivateContext activated{context};
+  char log[256] = {};
+  CUresult res = cuGraphInstantiate(graph_exec, graph, /*phErrorNode=*/nullptr,
+                                    log, sizeof(log));
+  if (res != CUDA_SUCCESS) {
+    return port::InternalError(absl::StrCat(
+        "Error instantiating CUDA graph: ", ToString(res), ": ", log));
+  }
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 CUgraphExec graph_exec,
+                                                 CUstream stream) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(graph_exec, stream),
+                           "Error launching CUDA graph");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::DestroyGraph(GpuContext* context,
+                                                  CUgraph* graph) {
+  if (*graph == nullptr) {
+    return port::Status::OK();
+  }
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphDestroy(*graph);
+  *graph = nullptr;
+  RETURN_IF_CUDA_RES_ERROR(res, "Error destroying CUDA graph");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::DestroyGraphExec(GpuContext* context,
+                                                      CUgraphExec* graph_exec) {
+  if (*graph_exec == nullptr) {
+    return port::Status::OK();
+  }
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphExecDestroy(*graph_exec);
+  *graph_exec = nullptr;
+  RETURN_IF_CUDA_RES_ERROR(res, "Error destroying CUDA graph executable");
+  return port::Status::OK();
+}
+
+#else  // CUDA_VERSION < 10010
+
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+  return port::UnimplementedError("CUDA graphs require CUDA 10.1 or later");
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      GpuGraphHandle* graph) {
+  return port::UnimplementedError("CUDA graphs require CUDA 10.1 or later");
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(
+    GpuContext* context, GpuGraphHandle graph,
+    GpuGraphExecHandle* graph_exec) {
+  return port::UnimplementedError("CUDA graphs require CUDA 10.1 or later");
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 GpuGraphExecHandle graph_exec,
+                                                 CUstream stream) {
+  return port::UnimplementedError("CUDA graphs require CUDA 10.1 or later");
+}
+
+/* static */ port::Status GpuDriver::DestroyGraph(GpuContext* context,
+                                                  GpuGraphHandle* graph) {
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::DestroyGraphExec(
+    GpuContext* context, GpuGraphExecHandle* graph_exec) {
+  return port::Status::OK();
+}
+
+#endif  // CUDA_VERSION >= 10010
+
 /* static */ bool GpuDriver::GetEventElapsedTime(GpuContext* context,
                                                  float* elapsed_milliseconds,
                                                  CUevent start, CUevent stop) {
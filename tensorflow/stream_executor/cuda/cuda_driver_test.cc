@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "third_party/gpus/cuda/include/cuda_runtime_api.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace stream_executor {
@@ -70,6 +71,53 @@ TEST(CudaDriverTest, ScopedActivateContextTest) {
   }
 }
 
+#if CUDA_VERSION >= 10010
+TEST(CudaDriverTest, GraphCaptureAndReplayTest) {
+  CHECK_CUDA(cuInit(0));
+  CUdevice device;
+  CHECK_CUDA(cuDeviceGet(&device, 0));
+  CUcontext context;
+  CHECK_CUDA(cuCtxCreate(&context, 0, device));
+  GpuContext se_context(context, /*id=*/102);
+  ScopedActivateContext scope(&se_context);
+  CUstream stream;
+  CHECK_CUDA(cuStreamCreate(&stream, CU_STREAM_NON_BLOCKING));
+  constexpr int kNumElements = 256;
+  CUdeviceptr buffer;
+  CHECK_CUDA(cuMemAlloc(&buffer, kNumElements * sizeof(uint32)));
+  CHECK_CUDA(cuMemsetD32(buffer, 0, kNumElements));
+
+  // Nothing is executed while the stream is being captured.
+  TF_ASSERT_OK(GpuDriver::StreamBeginCapture(&se_context, stream));
+  CHECK_CUDA(cuMemsetD32Async(buffer, 42, kNumElements, stream));
+  GpuGraphHandle graph = nullptr;
+  TF_ASSERT_OK(GpuDriver::StreamEndCapture(&se_context, stream, &graph));
+  GpuGraphExecHandle graph_exec = nullptr;
+  TF_ASSERT_OK(GpuDriver::GraphInstantiate(&se_context, graph, &graph_exec));
+  TF_ASSERT_OK(GpuDriver::DestroyGraph(&se_context, &graph));
+  EXPECT_EQ(graph, nullptr);
+  std::vector<uint32> host(kNumElements);
+  CHECK_CUDA(cuMemcpyDtoH(host.data(), buffer, kNumElements * sizeof(uint32)));
+  EXPECT_EQ(host[0], 0);
+
+  // Every launch replays the captured work.
+  for (int i = 0; i < 2; ++i) {
+    CHECK_CUDA(cuMemsetD32(buffer, 0, kNumElements));
+    TF_ASSERT_OK(GpuDriver::GraphLaunch(&se_context, graph_exec, stream));
+    CHECK_CUDA(cuStreamSynchronize(stream));
+    CHECK_CUDA(
+        cuMemcpyDtoH(host.data(), buffer, kNumElements * sizeof(uint32)));
+    EXPECT_EQ(host[0], 42);
+    EXPECT_EQ(host[kNumElements - 1], 42);
+  }
+
+  TF_ASSERT_OK(GpuDriver::DestroyGraphExec(&se_context, &graph_exec));
+  EXPECT_EQ(graph_exec, nullptr);
+  CHECK_CUDA(cuMemFree(buffer));
+  CHECK_CUDA(cuStreamDestroy(stream));
+}
+#endif  // CUDA_VERSION >= 10010
+
 }  // namespace gpu
 }  // namespace stream_executor
 
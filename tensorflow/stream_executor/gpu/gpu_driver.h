@@ -374,6 +374,44 @@ class GpuDriver {
   static port::StatusOr<GpuStatus> QueryEvent(GpuContext* context,
                                               GpuEventHandle event);
 
+  // -- Graph capture and replay calls.
+
+  // Starts capturing the work enqueued on `stream` into a graph instead of
+  // executing it, via cuStreamBeginCapture. Only work enqueued by the calling
+  // thread may be captured, and the stream may not be synchronized or queried
+  // until capture ends. Requires CUDA 10.1 or later.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Ends capturing on `stream` and stores the captured graph in `graph`, via
+  // cuStreamEndCapture. The caller owns the graph.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html
+  static port::Status StreamEndCapture(GpuContext* context,
+                                       GpuStreamHandle stream,
+                                       GpuGraphHandle* graph);
+
+  // Creates an executable graph from `graph`, via cuGraphInstantiate. The
+  // executable graph does not depend on `graph`, which may be destroyed.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static port::Status GraphInstantiate(GpuContext* context,
+                                       GpuGraphHandle graph,
+                                       GpuGraphExecHandle* graph_exec);
+
+  // Enqueues the work of `graph_exec` onto `stream` with a single launch, via
+  // cuGraphLaunch.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static port::Status GraphLaunch(GpuContext* context,
+                                  GpuGraphExecHandle graph_exec,
+                                  GpuStreamHandle stream);
+
+  // Destroys `*graph` and sets it to null, via cuGraphDestroy.
+  static port::Status DestroyGraph(GpuContext* context, GpuGraphHandle* graph);
+
+  // Destroys `*graph_exec` and sets it to null, via cuGraphExecDestroy.
+  static port::Status DestroyGraphExec(GpuContext* context,
+                                       GpuGraphExecHandle* graph_exec);
+
   // -- Pointer-specific calls.
 
   // Returns the context in which pointer was allocated or registered.
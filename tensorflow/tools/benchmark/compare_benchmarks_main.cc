@@ -0,0 +1,81 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary that compares the results of benchmark runs written with
+// TEST_REPORT_FILE_PREFIX at two commits, and fails if any benchmark regressed,
+// e.g. for the benchmarks of
+// //tensorflow/core/kernels:hot_kernels_benchmark_test.
+
+#include <cstdio>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/benchmark_comparison.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+int main(int argc, char** argv) {
+  using tensorflow::Flag;
+  using tensorflow::string;
+
+  string baseline_pattern;
+  string candidate_pattern;
+  tensorflow::BenchmarkComparisonOptions options;
+  float min_relative_change = options.min_relative_change;
+  float min_t_statistic = options.min_t_statistic;
+  std::vector<Flag> flag_list = {
+      Flag("baseline", &baseline_pattern,
+           "pattern of the benchmark result files of the baseline"),
+      Flag("candidate", &candidate_pattern,
+           "pattern of the benchmark result files of the candidate"),
+      Flag("min_relative_change", &min_relative_change,
+           "smallest relative change of a benchmark reported as a regression"),
+      Flag("min_t_statistic", &min_t_statistic,
+           "smallest absolute value of Welch's t statistic reported as a "
+           "regression, for benchmarks with several runs"),
+  };
+  const string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  const bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (!parse_result || argc > 1 || baseline_pattern.empty() ||
+      candidate_pattern.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  options.min_relative_change = min_relative_change;
+  options.min_t_statistic = min_t_statistic;
+
+  tensorflow::Env* env = tensorflow::Env::Default();
+  tensorflow::BenchmarkEntries baseline;
+  tensorflow::BenchmarkEntries candidate;
+  TF_CHECK_OK(
+      tensorflow::ReadBenchmarkEntries(env, baseline_pattern, &baseline));
+  TF_CHECK_OK(
+      tensorflow::ReadBenchmarkEntries(env, candidate_pattern, &candidate));
+  const std::vector<tensorflow::BenchmarkComparison> comparisons =
+      tensorflow::CompareBenchmarks(baseline, candidate, options);
+  printf("%s", tensorflow::FormatBenchmarkComparisons(comparisons).c_str());
+
+  int num_regressions = 0;
+  for (const auto& comparison : comparisons) {
+    if (comparison.regressed) ++num_regressions;
+  }
+  if (num_regressions > 0) {
+    LOG(ERROR) << num_regressions << " benchmarks regressed.";
+    return 1;
+  }
+  return 0;
+}
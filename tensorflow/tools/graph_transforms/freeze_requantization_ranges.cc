@@ -98,32 +98,13 @@ Status ExtractMinMaxRecords(const string& log_file_name,
   return Status::OK();
 }
 
-// Uses the observed min/max values for requantization captured in a log file to
-// replace costly RequantizationRange ops with simple Consts.
-Status FreezeRequantizationRanges(const GraphDef& input_graph_def,
-                                  const TransformFuncContext& context,
-                                  GraphDef* output_graph_def) {
-  string min_max_log_file;
-  TF_RETURN_IF_ERROR(
-      context.GetOneStringParameter("min_max_log_file", "", &min_max_log_file));
-  if (min_max_log_file.empty()) {
-    return errors::InvalidArgument(
-        "You must pass a file name to min_max_log_file");
-  }
-  float min_percentile;
-  TF_RETURN_IF_ERROR(
-      context.GetOneFloatParameter("min_percentile", 5.0f, &min_percentile));
-  float max_percentile;
-  TF_RETURN_IF_ERROR(
-      context.GetOneFloatParameter("max_percentile", 5.0f, &max_percentile));
-
-  std::vector<MinMaxRecord> records;
-  TF_RETURN_IF_ERROR(ExtractMinMaxRecords(min_max_log_file, &records));
-  if (records.empty()) {
-    return errors::InvalidArgument(
-        "No min/max range logs were found in the log file");
-  }
-
+// Replaces the RequantizationRange ops named in `records` with Consts holding
+// the overall min/max values observed for them, discarding the lowest
+// `min_percentile` percent of the mins and the highest `max_percentile`
+// percent of the maxes.
+Status FreezeRequantizationRangesFromRecords(
+    const GraphDef& input_graph_def, const std::vector<MinMaxRecord>& records,
+    float min_percentile, float max_percentile, GraphDef* output_graph_def) {
   std::map<string, const NodeDef*> node_map;
   MapNamesToNodes(input_graph_def, &node_map);
   bool any_missing_nodes = false;
@@ -203,6 +184,36 @@ Status FreezeRequantizationRanges(const GraphDef& input_graph_def,
                           std::unordered_set<string>(), output_graph_def);
 }
 
+// Uses the observed min/max values for requantization captured in a log file to
+// replace costly RequantizationRange ops with simple Consts.
+Status FreezeRequantizationRanges(const GraphDef& input_graph_def,
+                                  const TransformFuncContext& context,
+                                  GraphDef* output_graph_def) {
+  string min_max_log_file;
+  TF_RETURN_IF_ERROR(
+      context.GetOneStringParameter("min_max_log_file", "", &min_max_log_file));
+  if (min_max_log_file.empty()) {
+    return errors::InvalidArgument(
+        "You must pass a file name to min_max_log_file");
+  }
+  float min_percentile;
+  TF_RETURN_IF_ERROR(
+      context.GetOneFloatParameter("min_percentile", 5.0f, &min_percentile));
+  float max_percentile;
+  TF_RETURN_IF_ERROR(
+      context.GetOneFloatParameter("max_percentile", 5.0f, &max_percentile));
+
+  std::vector<MinMaxRecord> records;
+  TF_RETURN_IF_ERROR(ExtractMinMaxRecords(min_max_log_file, &records));
+  if (records.empty()) {
+    return errors::InvalidArgument(
+        "No min/max range logs were found in the log file");
+  }
+  return FreezeRequantizationRangesFromRecords(
+      input_graph_def, records, min_percentile, max_percentile,
+      output_graph_def);
+}
+
 REGISTER_GRAPH_TRANSFORM("freeze_requantization_ranges",
                          FreezeRequantizationRanges);
 
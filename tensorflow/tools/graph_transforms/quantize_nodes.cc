@@ -640,6 +640,15 @@ Status QuantizeNodes(const GraphDef& input_graph_def,
     }
   }
 
+  // Individual nodes can also be kept in float, for example because they are
+  // too sensitive to quantization errors.
+  std::set<string> nodes_to_ignore;
+  if (context.params.count("ignore_node") > 0) {
+    for (const string& name : context.params.at("ignore_node")) {
+      nodes_to_ignore.insert(name);
+    }
+  }
+
   const std::vector<QuantizedOpInfo>& op_list = GetQuantizedOpList();
   string op_pattern;
   bool is_first = true;
@@ -692,13 +701,19 @@ Status QuantizeNodes(const GraphDef& input_graph_def,
   GraphDef quantized_graph_def;
   TF_RETURN_IF_ERROR(ReplaceMatchingOpTypes(
       converted_graph_def, {op_pattern},
-      [&op_map, fallback_min, fallback_max, has_fallback_range](
-          const NodeMatch& match, const std::set<string>& input_nodes,
-          const std::set<string>& output_nodes,
-          std::vector<NodeDef>* new_nodes) {
+      [&op_map, &nodes_to_ignore, fallback_min, fallback_max,
+       has_fallback_range](const NodeMatch& match,
+                           const std::set<string>& input_nodes,
+                           const std::set<string>& output_nodes,
+                           std::vector<NodeDef>* new_nodes) {
         const NodeDef& float_node = match.node;
         const QuantizedOpInfo& op_info = op_map[float_node.op()];
 
+        if (nodes_to_ignore.count(float_node.name())) {
+          CopyOriginalMatch(match, new_nodes);
+          return Status::OK();
+        }
+
         DataTypeVector input_types;
         DataTypeVector output_types;
         TF_RETURN_IF_ERROR(
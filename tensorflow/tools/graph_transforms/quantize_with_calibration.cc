@@ -0,0 +1,321 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/tools/graph_transforms/transform_utils.h"
+
+namespace tensorflow {
+namespace graph_transforms {
+
+// Declare here, so we don't need a public header.
+Status QuantizeNodes(const GraphDef& input_graph_def,
+                     const TransformFuncContext& context,
+                     GraphDef* output_graph_def);
+struct MinMaxRecord {
+  string name;
+  float min;
+  float max;
+};
+Status FreezeRequantizationRangesFromRecords(
+    const GraphDef& input_graph_def, const std::vector<MinMaxRecord>& records,
+    float min_percentile, float max_percentile, GraphDef* output_graph_def);
+
+namespace {
+
+// The values fed into the graph's inputs for one run.
+typedef std::vector<std::pair<string, Tensor>> Sample;
+
+// Reads representative inputs from a TFRecord file of serialized TensorProtos,
+// which go to each of `input_names` in turn, one sample after the other.
+Status ReadCalibrationSamples(const string& file_name,
+                              const std::vector<string>& input_names,
+                              std::vector<Sample>* samples) {
+  if (input_names.empty()) {
+    return errors::InvalidArgument(
+        "You must pass the graph's inputs to calibrate it");
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(file_name, &file));
+  io::SequentialRecordReader reader(file.get());
+  Sample sample;
+  tstring record;
+  while (true) {
+    Status status = reader.ReadRecord(&record);
+    if (errors::IsOutOfRange(status)) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(status);
+    TensorProto proto;
+    Tensor tensor;
+    if (!proto.ParseFromString(string(record)) || !tensor.FromProto(proto)) {
+      return errors::InvalidArgument("Invalid tensor in ", file_name);
+    }
+    sample.emplace_back(input_names[sample.size()], tensor);
+    if (sample.size() == input_names.size()) {
+      samples->push_back(std::move(sample));
+      sample.clear();
+    }
+  }
+  if (!sample.empty()) {
+    return errors::InvalidArgument(
+        file_name, " doesn't hold a whole number of samples of ",
+        input_names.size(), " inputs");
+  }
+  if (samples->empty()) {
+    return errors::InvalidArgument("No calibration samples were found in ",
+                                   file_name);
+  }
+  return Status::OK();
+}
+
+// Runs the graph on every sample, and returns the fetched tensors of each run.
+Status RunOnSamples(const GraphDef& graph_def,
+                    const std::vector<Sample>& samples,
+                    const std::vector<string>& fetch_names,
+                    std::vector<std::vector<Tensor>>* outputs) {
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_RETURN_IF_ERROR(session->Create(graph_def));
+  outputs->clear();
+  outputs->reserve(samples.size());
+  for (const Sample& sample : samples) {
+    outputs->emplace_back();
+    TF_RETURN_IF_ERROR(
+        session->Run(sample, fetch_names, {}, &outputs->back()));
+  }
+  return session->Close();
+}
+
+// Replaces the RequantizationRange ops in the graph with Consts holding the
+// ranges they compute over all the samples.
+Status CalibrateRequantizationRanges(const GraphDef& input_graph_def,
+                                     const std::vector<Sample>& samples,
+                                     float min_percentile, float max_percentile,
+                                     GraphDef* output_graph_def) {
+  std::vector<string> range_names;
+  std::vector<string> fetch_names;
+  for (const NodeDef& node : input_graph_def.node()) {
+    if (node.op() == "RequantizationRange") {
+      range_names.push_back(node.name());
+      fetch_names.push_back(node.name() + ":0");
+      fetch_names.push_back(node.name() + ":1");
+    }
+  }
+  if (range_names.empty()) {
+    *output_graph_def = input_graph_def;
+    return Status::OK();
+  }
+
+  std::vector<std::vector<Tensor>> outputs;
+  TF_RETURN_IF_ERROR(
+      RunOnSamples(input_graph_def, samples, fetch_names, &outputs));
+  std::vector<MinMaxRecord> records;
+  for (const std::vector<Tensor>& ranges : outputs) {
+    for (int i = 0; i < range_names.size(); ++i) {
+      records.push_back({range_names[i], ranges[2 * i].scalar<float>()(),
+                         ranges[2 * i + 1].scalar<float>()()});
+    }
+  }
+  return FreezeRequantizationRangesFromRecords(input_graph_def, records,
+                                               min_percentile, max_percentile,
+                                               output_graph_def);
+}
+
+// The L2 norm of the difference between two float tensors, relative to that of
+// `expected`.
+double RelativeError(const Tensor& expected, const Tensor& actual) {
+  if (expected.dtype() != DT_FLOAT || actual.dtype() != DT_FLOAT ||
+      expected.NumElements() != actual.NumElements()) {
+    return 0.0;
+  }
+  auto expected_flat = expected.flat<float>();
+  auto actual_flat = actual.flat<float>();
+  double error = 0.0;
+  double norm = 0.0;
+  for (int64 i = 0; i < expected.NumElements(); ++i) {
+    const double diff = actual_flat(i) - expected_flat(i);
+    error += diff * diff;
+    norm += static_cast<double>(expected_flat(i)) * expected_flat(i);
+  }
+  return std::sqrt(error / std::max(norm, 1e-12));
+}
+
+}  // namespace
+
+// Quantizes the graph like quantize_nodes does, and then runs it on
+// representative inputs to calibrate the requantization ranges, replacing the
+// RequantizationRange ops with Consts like freeze_requantization_ranges does.
+//
+// If the outputs of the calibrated graph then deviate from those of the float
+// graph by more than max_relative_error, the quantized op that adds the most
+// error is kept in float and the graph is quantized again, until the outputs
+// are within the error budget.
+Status QuantizeWithCalibration(const GraphDef& input_graph_def,
+                               const TransformFuncContext& context,
+                               GraphDef* output_graph_def) {
+  string calibration_data;
+  TF_RETURN_IF_ERROR(
+      context.GetOneStringParameter("calibration_data", "", &calibration_data));
+  if (calibration_data.empty()) {
+    return errors::InvalidArgument(
+        "You must pass a file name to calibration_data");
+  }
+  float min_percentile;
+  TF_RETURN_IF_ERROR(
+      context.GetOneFloatParameter("min_percentile", 5.0f, &min_percentile));
+  float max_percentile;
+  TF_RETURN_IF_ERROR(
+      context.GetOneFloatParameter("max_percentile", 5.0f, &max_percentile));
+  float max_relative_error;
+  TF_RETURN_IF_ERROR(context.GetOneFloatParameter(
+      "max_relative_error", 0.05f, &max_relative_error));
+  if (context.output_names.empty()) {
+    return errors::InvalidArgument(
+        "You must pass the graph's outputs to calibrate it");
+  }
+
+  std::vector<Sample> samples;
+  TF_RETURN_IF_ERROR(
+      ReadCalibrationSamples(calibration_data, context.input_names, &samples));
+
+  std::map<string, const NodeDef*> float_node_map;
+  MapNamesToNodes(input_graph_def, &float_node_map);
+
+  TransformFuncContext quantize_context(context);
+  std::set<string> float_nodes;
+  if (context.params.count("ignore_node") > 0) {
+    for (const string& name : context.params.at("ignore_node")) {
+      float_nodes.insert(name);
+    }
+  }
+
+  // The graph's outputs, followed by every op the first quantization pass
+  // replaced, and their values in the float graph for each sample.
+  const int num_outputs = context.output_names.size();
+  std::vector<string> reference_names;
+  std::vector<std::vector<Tensor>> reference_outputs;
+
+  while (true) {
+    quantize_context.params["ignore_node"].assign(float_nodes.begin(),
+                                                  float_nodes.end());
+    GraphDef quantized_graph_def;
+    TF_RETURN_IF_ERROR(
+        QuantizeNodes(input_graph_def, quantize_context, &quantized_graph_def));
+    GraphDef calibrated_graph_def;
+    TF_RETURN_IF_ERROR(CalibrateRequantizationRanges(
+        quantized_graph_def, samples, min_percentile, max_percentile,
+        &calibrated_graph_def));
+
+    std::map<string, const NodeDef*> node_map;
+    MapNamesToNodes(calibrated_graph_def, &node_map);
+    if (reference_names.empty()) {
+      reference_names = context.output_names;
+      for (const NodeDef& node : calibrated_graph_def.node()) {
+        if (absl::EndsWith(node.name(), "/eightbit")) {
+          reference_names.push_back(
+              node.name().substr(0, node.name().size() - 9));
+        }
+      }
+      TF_RETURN_IF_ERROR(RunOnSamples(input_graph_def, samples,
+                                      reference_names, &reference_outputs));
+    }
+
+    // Compare the outputs, and the results of the quantized ops that are still
+    // converted back to float, with their float values.
+    std::vector<string> fetch_names(context.output_names);
+    std::vector<int> reference_indices;
+    for (int i = 0; i < num_outputs; ++i) {
+      reference_indices.push_back(i);
+    }
+    for (int i = num_outputs; i < reference_names.size(); ++i) {
+      const string& name = reference_names[i];
+      if (node_map.count(name) && node_map.count(name + "/eightbit")) {
+        fetch_names.push_back(name);
+        reference_indices.push_back(i);
+      }
+    }
+    std::vector<std::vector<Tensor>> outputs;
+    TF_RETURN_IF_ERROR(
+        RunOnSamples(calibrated_graph_def, samples, fetch_names, &outputs));
+    std::vector<double> errors(fetch_names.size(), 0.0);
+    for (int s = 0; s < samples.size(); ++s) {
+      for (int i = 0; i < fetch_names.size(); ++i) {
+        errors[i] = std::max(
+            errors[i], RelativeError(reference_outputs[s][reference_indices[i]],
+                                     outputs[s][i]));
+      }
+    }
+    double output_error = 0.0;
+    for (int i = 0; i < num_outputs; ++i) {
+      output_error = std::max(output_error, errors[i]);
+    }
+    LOG(INFO) << "Quantized graph with " << float_nodes.size()
+              << " ops kept in float has a relative output error of "
+              << output_error;
+    if (output_error <= max_relative_error) {
+      *output_graph_def = calibrated_graph_def;
+      return Status::OK();
+    }
+
+    // The error an op adds is estimated as that of its result, less the
+    // largest error of its float inputs.
+    std::map<string, double> op_errors;
+    for (int i = num_outputs; i < fetch_names.size(); ++i) {
+      op_errors[fetch_names[i]] = errors[i];
+    }
+    string worst_op;
+    double worst_added_error = -1.0;
+    for (const auto& op_error : op_errors) {
+      double input_error = 0.0;
+      for (const string& input : float_node_map[op_error.first]->input()) {
+        auto it = op_errors.find(NodeNameFromInput(input));
+        if (it != op_errors.end()) {
+          input_error = std::max(input_error, it->second);
+        }
+      }
+      if (op_error.second - input_error > worst_added_error) {
+        worst_added_error = op_error.second - input_error;
+        worst_op = op_error.first;
+      }
+    }
+    if (worst_op.empty()) {
+      LOG(WARNING) << "Couldn't bring the relative output error of "
+                   << output_error << " within " << max_relative_error;
+      *output_graph_def = calibrated_graph_def;
+      return Status::OK();
+    }
+    LOG(INFO) << "Keeping " << worst_op << " in float";
+    float_nodes.insert(worst_op);
+  }
+}
+
+REGISTER_GRAPH_TRANSFORM("quantize_with_calibration", QuantizeWithCalibration);
+
+}  // namespace graph_transforms
+}  // namespace tensorflow
@@ -0,0 +1,129 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <map>
+
+#include "absl/strings/match.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/tools/graph_transforms/transform_utils.h"
+
+namespace tensorflow {
+namespace graph_transforms {
+
+// Declare here, so we don't need a public header.
+Status QuantizeWithCalibration(const GraphDef& input_graph_def,
+                               const TransformFuncContext& context,
+                               GraphDef* output_graph_def);
+
+class QuantizeWithCalibrationTest : public ::testing::Test {
+ protected:
+  // Builds output = Relu(MatMul(input, weights) + bias), and writes random
+  // calibration samples for it.
+  void SetUp() override {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor weights(DT_FLOAT, TensorShape({8, 4}));
+    test::FillFn<float>(&weights, [](int i) { return (i % 7) - 3.0f; });
+    Tensor bias(DT_FLOAT, TensorShape({4}));
+    test::FillValues<float>(&bias, {0.5f, -0.5f, 1.0f, -1.0f});
+
+    Output input = Placeholder(root.WithOpName("input"), DT_FLOAT);
+    Output matmul =
+        MatMul(root.WithOpName("matmul"), input,
+               Const(root.WithOpName("weights"), Input::Initializer(weights)));
+    Output bias_add =
+        BiasAdd(root.WithOpName("bias_add"), matmul,
+                Const(root.WithOpName("bias"), Input::Initializer(bias)));
+    Relu(root.WithOpName("output"), bias_add);
+    TF_ASSERT_OK(root.ToGraphDef(&float_graph_def_));
+
+    calibration_data_ =
+        io::JoinPath(testing::TmpDir(), "quantize_with_calibration_data");
+    std::unique_ptr<WritableFile> file;
+    TF_ASSERT_OK(Env::Default()->NewWritableFile(calibration_data_, &file));
+    io::RecordWriter writer(file.get());
+    for (int sample = 0; sample < 10; ++sample) {
+      Tensor input_tensor(DT_FLOAT, TensorShape({2, 8}));
+      test::FillFn<float>(&input_tensor, [sample](int i) {
+        return ((i * 13 + sample * 5) % 17) / 4.0f - 2.0f;
+      });
+      TensorProto proto;
+      input_tensor.AsProtoTensorContent(&proto);
+      TF_ASSERT_OK(writer.WriteRecord(proto.SerializeAsString()));
+    }
+    TF_ASSERT_OK(writer.Close());
+    TF_ASSERT_OK(file->Close());
+  }
+
+  Status Quantize(const string& max_relative_error, GraphDef* output) {
+    TransformFuncContext context;
+    context.input_names = {"input"};
+    context.output_names = {"output"};
+    context.params["calibration_data"] = {calibration_data_};
+    context.params["max_relative_error"] = {max_relative_error};
+    return QuantizeWithCalibration(float_graph_def_, context, output);
+  }
+
+  GraphDef float_graph_def_;
+  string calibration_data_;
+};
+
+TEST_F(QuantizeWithCalibrationTest, FreezesRanges) {
+  GraphDef quantized_graph_def;
+  TF_ASSERT_OK(Quantize("1.0", &quantized_graph_def));
+
+  std::map<string, const NodeDef*> node_map;
+  MapNamesToNodes(quantized_graph_def, &node_map);
+  ASSERT_EQ(1, node_map.count("matmul/eightbit"));
+  EXPECT_EQ("QuantizedMatMul", node_map.at("matmul/eightbit")->op());
+  for (const NodeDef& node : quantized_graph_def.node()) {
+    EXPECT_NE("RequantizationRange", node.op()) << node.name();
+  }
+  EXPECT_EQ(1, node_map.count("matmul/eightbit/requant_range/frozen_min"));
+  EXPECT_EQ(1, node_map.count("matmul/eightbit/requant_range/frozen_max"));
+}
+
+TEST_F(QuantizeWithCalibrationTest, KeepsOpsInFloatWithinErrorBudget) {
+  GraphDef quantized_graph_def;
+  TF_ASSERT_OK(Quantize("0.0", &quantized_graph_def));
+
+  // No quantized op can be exact, so everything ends up in float.
+  for (const NodeDef& node : quantized_graph_def.node()) {
+    EXPECT_FALSE(absl::EndsWith(node.name(), "/eightbit")) << node.name();
+  }
+  std::map<string, const NodeDef*> node_map;
+  MapNamesToNodes(quantized_graph_def, &node_map);
+  EXPECT_EQ("MatMul", node_map.at("matmul")->op());
+}
+
+TEST_F(QuantizeWithCalibrationTest, RequiresCalibrationData) {
+  TransformFuncContext context;
+  context.input_names = {"input"};
+  context.output_names = {"output"};
+  GraphDef output;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      QuantizeWithCalibration(float_graph_def_, context, &output)));
+}
+
+}  // namespace graph_transforms
+}  // namespace tensorflow